@@ -0,0 +1,219 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <anchor/anchor_aggregator.h>
+#include <logging.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace evm_anchor {
+
+// ============================================================================
+// Global Instance
+// ============================================================================
+
+static AnchorAggregator g_anchor_aggregator;
+
+AnchorAggregator& GetAnchorAggregator() {
+    return g_anchor_aggregator;
+}
+
+// ============================================================================
+// AggregateAnchor Implementation
+// ============================================================================
+
+std::vector<uint8_t> AggregateAnchor::Serialize() const {
+    std::vector<uint8_t> result;
+    result.reserve(AGGREGATE_ANCHOR_SIZE);
+
+    // Tag and version
+    result.push_back(AGGREGATE_ANCHOR_TAG);
+    result.push_back(version);
+
+    // Item count (4 bytes, little-endian)
+    for (int i = 0; i < 4; i++) {
+        result.push_back((item_count >> (i * 8)) & 0xFF);
+    }
+
+    // Merkle root (32 bytes)
+    result.insert(result.end(), root.begin(), root.end());
+
+    // Timestamp (8 bytes, little-endian)
+    for (int i = 0; i < 8; i++) {
+        result.push_back((timestamp >> (i * 8)) & 0xFF);
+    }
+
+    return result;
+}
+
+bool AggregateAnchor::Deserialize(const std::vector<uint8_t>& data) {
+    if (data.size() < AGGREGATE_ANCHOR_SIZE || data[0] != AGGREGATE_ANCHOR_TAG) {
+        return false;
+    }
+
+    version = data[1];
+    if (version != ANCHOR_VERSION) {
+        return false;
+    }
+
+    size_t pos = 2;
+    item_count = 0;
+    for (int i = 0; i < 4; i++) {
+        item_count |= static_cast<uint32_t>(data[pos + i]) << (i * 8);
+    }
+    pos += 4;
+
+    std::memcpy(root.data(), &data[pos], 32);
+    pos += 32;
+
+    timestamp = 0;
+    for (int i = 0; i < 8; i++) {
+        timestamp |= (static_cast<int64_t>(data[pos + i]) << (i * 8));
+    }
+
+    return item_count > 0;
+}
+
+// ============================================================================
+// AnchorAggregator Implementation
+// ============================================================================
+
+void AnchorAggregator::SetOptions(const Options& options) {
+    LOCK(m_mutex);
+    m_options = options;
+}
+
+AnchorAggregator::Options AnchorAggregator::GetOptions() const {
+    LOCK(m_mutex);
+    return m_options;
+}
+
+bool AnchorAggregator::Add(const uint256& commitment, int64_t now) {
+    LOCK(m_mutex);
+
+    if (m_pending_set.count(commitment) || m_proofs.count(commitment)) {
+        return false;
+    }
+
+    if (m_pending.empty()) {
+        m_window_start = now;
+    }
+    m_pending.push_back(commitment);
+    m_pending_set.insert(commitment);
+    return true;
+}
+
+std::optional<AggregateAnchor> AnchorAggregator::Poll(int64_t now) {
+    LOCK(m_mutex);
+
+    if (m_pending.empty()) {
+        return std::nullopt;
+    }
+    if (m_pending.size() < m_options.max_items && now - m_window_start < m_options.max_age) {
+        return std::nullopt;
+    }
+    return FlushLocked(now);
+}
+
+std::optional<AggregateAnchor> AnchorAggregator::Flush(int64_t now) {
+    LOCK(m_mutex);
+    return FlushLocked(now);
+}
+
+std::optional<AggregateAnchor> AnchorAggregator::FlushLocked(int64_t now) {
+    AssertLockHeld(m_mutex);
+
+    if (m_pending.empty()) {
+        return std::nullopt;
+    }
+
+    // All branches come from one pass over the tree, rather than a walk per commitment
+    std::vector<CMerkleBranch> branches = ComputeMerkleBranches(m_pending);
+
+    AggregateAnchor aggregate;
+    aggregate.item_count = m_pending.size();
+    aggregate.root = branches[0].GetRoot(m_pending[0]);
+    aggregate.timestamp = now;
+
+    for (size_t i = 0; i < m_pending.size(); i++) {
+        m_proofs.emplace(m_pending[i], std::make_pair(aggregate.root, std::move(branches[i])));
+    }
+    m_aggregates.emplace_back(aggregate, std::move(m_pending));
+    m_pending.clear();
+    m_pending_set.clear();
+
+    // Forget the proofs of the oldest aggregates
+    while (m_aggregates.size() > std::max<size_t>(m_options.max_aggregates, 1)) {
+        for (const auto& commitment : m_aggregates.front().second) {
+            m_proofs.erase(commitment);
+        }
+        m_aggregates.pop_front();
+    }
+
+    LogPrintf("EVMAnchor: Aggregated %u commitments under root %s\n",
+              aggregate.item_count, aggregate.root.GetHex().substr(0, 16));
+
+    return aggregate;
+}
+
+std::optional<AggregateAnchor> AnchorAggregator::GetLastAggregate() const {
+    LOCK(m_mutex);
+    if (m_aggregates.empty()) {
+        return std::nullopt;
+    }
+    return m_aggregates.back().first;
+}
+
+bool AnchorAggregator::GetProof(const uint256& commitment, AnchorInclusionProof& out) const {
+    LOCK(m_mutex);
+
+    auto it = m_proofs.find(commitment);
+    if (it == m_proofs.end()) {
+        return false;
+    }
+
+    out.commitment = commitment;
+    out.root = it->second.first;
+    out.branch = it->second.second;
+    return true;
+}
+
+bool AnchorAggregator::IsPending(const uint256& commitment) const {
+    LOCK(m_mutex);
+    return m_pending_set.count(commitment) > 0;
+}
+
+size_t AnchorAggregator::GetPendingCount() const {
+    LOCK(m_mutex);
+    return m_pending.size();
+}
+
+std::vector<uint8_t> AnchorAggregator::BuildAggregateTag(const AggregateAnchor& aggregate) {
+    auto aggregate_bytes = aggregate.Serialize();
+
+    // TX_EXTRA_NONCE, length, subtag, as for single anchors
+    std::vector<uint8_t> tag;
+    tag.push_back(0x02);  // TX_EXTRA_NONCE
+    tag.push_back(static_cast<uint8_t>(aggregate_bytes.size() + 1));  // Length + 1 for subtag
+    tag.push_back(AGGREGATE_ANCHOR_TAG);
+    tag.insert(tag.end(), aggregate_bytes.begin(), aggregate_bytes.end());
+
+    return tag;
+}
+
+std::vector<AggregateAnchor> AnchorAggregator::ParseAggregateTags(const std::vector<uint8_t>& extra) {
+    std::vector<AggregateAnchor> aggregates;
+
+    for (const auto& payload : FindAnchorTags(extra, AGGREGATE_ANCHOR_TAG)) {
+        AggregateAnchor aggregate;
+        if (aggregate.Deserialize(payload)) {
+            aggregates.push_back(aggregate);
+        }
+    }
+
+    return aggregates;
+}
+
+}  // namespace evm_anchor
@@ -0,0 +1,130 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_ANCHOR_ANCHOR_AGGREGATOR_H
+#define WATTX_ANCHOR_ANCHOR_AGGREGATOR_H
+
+#include <anchor/evm_anchor.h>
+#include <auxpow/auxpow.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace evm_anchor {
+
+// Subtag of an aggregate anchor in the Monero extra field
+static constexpr uint8_t AGGREGATE_ANCHOR_TAG = 0x41;  // 'A' for Aggregate
+
+// Serialized size: tag(1) + version(1) + count(4) + root(32) + time(8)
+static constexpr size_t AGGREGATE_ANCHOR_SIZE = 46;
+
+/**
+ * AggregateAnchor - One merkle root committing to many anchor commitments
+ * (EVMAnchorData::GetHash(), or any 32 byte commitment of a relayer)
+ */
+struct AggregateAnchor {
+    uint8_t version{ANCHOR_VERSION};
+    uint32_t item_count{0};               // Number of commitments under the root
+    uint256 root;                         // Merkle root of the commitments
+    int64_t timestamp{0};                 // When the window was closed
+
+    std::vector<uint8_t> Serialize() const;
+    bool Deserialize(const std::vector<uint8_t>& data);
+};
+
+/**
+ * AnchorInclusionProof - Branch of a commitment to an aggregate root
+ */
+struct AnchorInclusionProof {
+    uint256 commitment;
+    uint256 root;
+    CMerkleBranch branch;
+
+    bool Verify() const { return branch.GetRoot(commitment) == root; }
+};
+
+/**
+ * AnchorAggregator - Collects anchor commitments over a window and anchors
+ * their merkle root in place of one anchor per commitment
+ *
+ * A window closes once it holds max_items commitments or its first one is
+ * max_age seconds old. The branch of every commitment of a closed window is
+ * kept for its inclusion proof, for the last max_aggregates windows.
+ */
+class AnchorAggregator {
+public:
+    struct Options {
+        size_t max_items{256};
+        int64_t max_age{600};
+        size_t max_aggregates{1024};
+        // Whether the merged mining jobs anchor aggregates rather than one anchor per block
+        bool aggregate_block_anchors{false};
+    };
+
+    void SetOptions(const Options& options);
+    Options GetOptions() const;
+
+    /**
+     * Add a commitment to the open window
+     * @return false if it is already in the open window or a kept aggregate
+     */
+    bool Add(const uint256& commitment, int64_t now);
+
+    /**
+     * Close the open window if it is full or old enough
+     * @return the aggregate anchor of the closed window
+     */
+    std::optional<AggregateAnchor> Poll(int64_t now);
+
+    // Close the open window, if it holds any commitment
+    std::optional<AggregateAnchor> Flush(int64_t now);
+
+    // Aggregate anchor of the last closed window
+    std::optional<AggregateAnchor> GetLastAggregate() const;
+
+    // Inclusion proof of a commitment of a kept aggregate
+    bool GetProof(const uint256& commitment, AnchorInclusionProof& out) const;
+
+    // Whether a commitment waits in the open window
+    bool IsPending(const uint256& commitment) const;
+    size_t GetPendingCount() const;
+
+    /**
+     * Build the anchor tag for Monero coinbase extra field
+     */
+    static std::vector<uint8_t> BuildAggregateTag(const AggregateAnchor& aggregate);
+
+    /**
+     * Parse aggregate anchors from Monero coinbase extra field
+     */
+    static std::vector<AggregateAnchor> ParseAggregateTags(const std::vector<uint8_t>& extra);
+
+private:
+    mutable Mutex m_mutex;
+
+    Options m_options GUARDED_BY(m_mutex);
+
+    std::vector<uint256> m_pending GUARDED_BY(m_mutex);
+    std::set<uint256> m_pending_set GUARDED_BY(m_mutex);
+    int64_t m_window_start GUARDED_BY(m_mutex){0};
+
+    // Commitment -> (root, branch), and the commitments of each kept root, oldest first
+    std::map<uint256, std::pair<uint256, CMerkleBranch>> m_proofs GUARDED_BY(m_mutex);
+    std::deque<std::pair<AggregateAnchor, std::vector<uint256>>> m_aggregates GUARDED_BY(m_mutex);
+
+    std::optional<AggregateAnchor> FlushLocked(int64_t now) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+// Global anchor aggregator instance
+AnchorAggregator& GetAnchorAggregator();
+
+}  // namespace evm_anchor
+
+#endif // WATTX_ANCHOR_ANCHOR_AGGREGATOR_H
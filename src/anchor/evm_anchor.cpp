@@ -323,28 +323,34 @@ std::vector<uint8_t> EVMAnchorManager::BuildAnchorTag(const EVMAnchorData& data)
     return tag;
 }
 
-bool EVMAnchorManager::ParseAnchorTag(const std::vector<uint8_t>& extra, EVMAnchorData& out) {
-    LOCK(m_mutex);
+std::vector<std::vector<uint8_t>> FindAnchorTags(const std::vector<uint8_t>& extra, uint8_t subtag) {
+    std::vector<std::vector<uint8_t>> tags;
 
-    // Search for WATTx anchor tag in extra field
     for (size_t i = 0; i + 3 < extra.size(); i++) {
-        // Look for TX_EXTRA_NONCE (0x02) followed by length and WATTx tag
+        // Look for TX_EXTRA_NONCE (0x02) followed by length and the subtag
         if (extra[i] == 0x02) {
             size_t len = extra[i + 1];
-            if (i + 2 + len <= extra.size() && extra[i + 2] == ANCHOR_TAG) {
-                // Found WATTx anchor tag
-                std::vector<uint8_t> anchor_data(extra.begin() + i + 3,
-                                                  extra.begin() + i + 2 + len);
-
-                ViewKeyAnchor vk_anchor;
-                if (ViewKeyAnchor::Deserialize(anchor_data, m_view_public_key, vk_anchor)) {
-                    out = vk_anchor.anchor_data;
-                    return true;
-                }
+            if (len > 0 && i + 2 + len <= extra.size() && extra[i + 2] == subtag) {
+                tags.emplace_back(extra.begin() + i + 3, extra.begin() + i + 2 + len);
             }
         }
     }
 
+    return tags;
+}
+
+bool EVMAnchorManager::ParseAnchorTag(const std::vector<uint8_t>& extra, EVMAnchorData& out) {
+    LOCK(m_mutex);
+
+    // Search for WATTx anchor tag in extra field
+    for (const auto& anchor_data : FindAnchorTags(extra, ANCHOR_TAG)) {
+        ViewKeyAnchor vk_anchor;
+        if (ViewKeyAnchor::Deserialize(anchor_data, m_view_public_key, vk_anchor)) {
+            out = vk_anchor.anchor_data;
+            return true;
+        }
+    }
+
     return false;
 }
 
@@ -29,6 +29,14 @@ static constexpr size_t BLOCK_HEIGHT_SIZE = 4;
 static constexpr size_t TX_COUNT_SIZE = 2;
 static constexpr size_t CHECKSUM_SIZE = 4;
 
+/**
+ * Find the TX_EXTRA_NONCE entries of a Monero extra field, or of a script,
+ * that carry @p subtag (ANCHOR_TAG or PRIVATE_SWAP_TAG)
+ *
+ * @return the payload of each entry, after the subtag
+ */
+std::vector<std::vector<uint8_t>> FindAnchorTags(const std::vector<uint8_t>& extra, uint8_t subtag);
+
 /**
  * EVMAnchorData - Reference data for WATTx EVM transactions
  * This is the compact representation that gets anchored to Monero blocks
@@ -190,19 +190,34 @@ bool PrivateSwapData::IsValid() const {
 // EncryptedSwapAnchor Implementation
 // ============================================================================
 
-EncryptedSwapAnchor EncryptedSwapAnchor::Create(const PrivateSwapData& data,
-                                                 const std::array<uint8_t, 32>& view_key) {
-    EncryptedSwapAnchor anchor;
-
+std::array<uint8_t, 32> EncryptedSwapAnchor::DeriveSwapKeyTag(const uint256& swap_id,
+                                                              const std::array<uint8_t, 32>& view_key) {
     // Derive swap key tag from view key and swap ID
     CSHA256 hasher;
     hasher.Write(view_key.data(), 32);
-    hasher.Write(data.swap_id.data(), 32);
+    hasher.Write(swap_id.data(), 32);
     hasher.Write((const uint8_t*)"PRIVATE_SWAP_TAG", 16);
 
-    uint8_t tag_full[32];
-    hasher.Finalize(tag_full);
-    std::memcpy(anchor.swap_key_tag.data(), tag_full, 32);
+    std::array<uint8_t, 32> tag;
+    hasher.Finalize(tag.data());
+    return tag;
+}
+
+std::array<uint8_t, 32> EncryptedSwapAnchor::DeriveViewTag(const std::array<uint8_t, 32>& view_key) {
+    CSHA256 hasher;
+    hasher.Write(view_key.data(), 32);
+    hasher.Write((const uint8_t*)"PRIVATE_SWAP_VIEW", 17);
+
+    std::array<uint8_t, 32> tag;
+    hasher.Finalize(tag.data());
+    return tag;
+}
+
+EncryptedSwapAnchor EncryptedSwapAnchor::Create(const PrivateSwapData& data,
+                                                 const std::array<uint8_t, 32>& view_key) {
+    EncryptedSwapAnchor anchor;
+
+    anchor.swap_key_tag = DeriveSwapKeyTag(data.swap_id, view_key);
 
     // Serialize and encrypt data
     auto plaintext = data.Serialize();
@@ -295,9 +310,8 @@ bool EncryptedSwapAnchor::Decrypt(const EncryptedSwapAnchor& anchor,
         return false;
     }
 
-    // Verify by re-encrypting and comparing
-    auto re_anchor = Create(out, view_key);
-    return re_anchor.swap_key_tag == anchor.swap_key_tag;
+    // The key tag only matches for the right view key and swap
+    return DeriveSwapKeyTag(out.swap_id, view_key) == anchor.swap_key_tag;
 }
 
 std::vector<uint8_t> EncryptedSwapAnchor::Serialize() const {
@@ -432,6 +446,7 @@ std::pair<uint256, std::array<uint8_t, 32>> PrivateSwapManager::InitiateSwap(
     // Store encrypted swap
     auto encrypted = EncryptedSwapAnchor::Create(swap, view_key);
     m_swaps[swap.swap_id] = encrypted;
+    m_swaps_by_view_tag[EncryptedSwapAnchor::DeriveViewTag(view_key)].insert(swap.swap_id);
 
     m_total_swaps++;
     m_active_swaps++;
@@ -447,13 +462,8 @@ std::pair<uint256, std::array<uint8_t, 32>> PrivateSwapManager::InitiateSwap(
 bool PrivateSwapManager::JoinSwap(const uint256& swap_id, const std::array<uint8_t, 32>& view_key) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    auto it = m_swaps.find(swap_id);
-    if (it == m_swaps.end()) {
-        return false;
-    }
-
     PrivateSwapData swap;
-    if (!EncryptedSwapAnchor::Decrypt(it->second, view_key, swap)) {
+    if (!DecryptSwapLocked(swap_id, view_key, swap)) {
         return false;
     }
 
@@ -476,13 +486,22 @@ bool PrivateSwapManager::GetSwap(const uint256& swap_id,
                                   const std::array<uint8_t, 32>& view_key,
                                   PrivateSwapData& out) {
     std::lock_guard<std::mutex> lock(m_mutex);
+    return DecryptSwapLocked(swap_id, view_key, out);
+}
 
+bool PrivateSwapManager::DecryptSwapLocked(const uint256& swap_id,
+                                            const std::array<uint8_t, 32>& view_key,
+                                            PrivateSwapData& out) const {
     auto it = m_swaps.find(swap_id);
     if (it == m_swaps.end()) {
         return false;
     }
 
-    return EncryptedSwapAnchor::Decrypt(it->second, view_key, out);
+    if (it->second.swap_key_tag != EncryptedSwapAnchor::DeriveSwapKeyTag(swap_id, view_key)) {
+        return false;
+    }
+
+    return EncryptedSwapAnchor::Decrypt(it->second, view_key, out) && out.swap_id == swap_id;
 }
 
 bool PrivateSwapManager::UpdateSwapState(const uint256& swap_id,
@@ -490,13 +509,8 @@ bool PrivateSwapManager::UpdateSwapState(const uint256& swap_id,
                                           PrivateSwapData::SwapState new_state) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    auto it = m_swaps.find(swap_id);
-    if (it == m_swaps.end()) {
-        return false;
-    }
-
     PrivateSwapData swap;
-    if (!EncryptedSwapAnchor::Decrypt(it->second, view_key, swap)) {
+    if (!DecryptSwapLocked(swap_id, view_key, swap)) {
         return false;
     }
 
@@ -525,13 +539,8 @@ bool PrivateSwapManager::RecordEVMTransaction(const uint256& swap_id,
                                                const std::vector<uint8_t>& receipt) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    auto it = m_swaps.find(swap_id);
-    if (it == m_swaps.end()) {
-        return false;
-    }
-
     PrivateSwapData swap;
-    if (!EncryptedSwapAnchor::Decrypt(it->second, view_key, swap)) {
+    if (!DecryptSwapLocked(swap_id, view_key, swap)) {
         return false;
     }
 
@@ -570,19 +579,11 @@ bool PrivateSwapManager::ParseSwapAnchor(const std::vector<uint8_t>& extra,
                                           const std::array<uint8_t, 32>& view_key,
                                           PrivateSwapData& out) {
     // Search for private swap tag in extra field
-    for (size_t i = 0; i + 3 < extra.size(); i++) {
-        if (extra[i] == 0x02) {
-            size_t len = extra[i + 1];
-            if (i + 2 + len <= extra.size() && extra[i + 2] == PRIVATE_SWAP_TAG) {
-                std::vector<uint8_t> anchor_data(extra.begin() + i + 3,
-                                                  extra.begin() + i + 2 + len);
-
-                EncryptedSwapAnchor encrypted;
-                if (EncryptedSwapAnchor::Deserialize(anchor_data, encrypted)) {
-                    if (EncryptedSwapAnchor::Decrypt(encrypted, view_key, out)) {
-                        return true;
-                    }
-                }
+    for (const auto& anchor_data : evm_anchor::FindAnchorTags(extra, PRIVATE_SWAP_TAG)) {
+        EncryptedSwapAnchor encrypted;
+        if (EncryptedSwapAnchor::Deserialize(anchor_data, encrypted)) {
+            if (EncryptedSwapAnchor::Decrypt(encrypted, view_key, out)) {
+                return true;
             }
         }
     }
@@ -596,9 +597,14 @@ std::vector<PrivateSwapData> PrivateSwapManager::GetSwapsForViewKey(
     std::lock_guard<std::mutex> lock(m_mutex);
     std::vector<PrivateSwapData> result;
 
-    for (const auto& [id, encrypted] : m_swaps) {
+    auto tagged = m_swaps_by_view_tag.find(EncryptedSwapAnchor::DeriveViewTag(view_key));
+    if (tagged == m_swaps_by_view_tag.end()) {
+        return result;
+    }
+
+    for (const uint256& swap_id : tagged->second) {
         PrivateSwapData swap;
-        if (EncryptedSwapAnchor::Decrypt(encrypted, view_key, swap)) {
+        if (DecryptSwapLocked(swap_id, view_key, swap)) {
             result.push_back(swap);
         }
     }
@@ -12,6 +12,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -108,6 +109,13 @@ struct EncryptedSwapAnchor {
     std::vector<uint8_t> encrypted_data;  // XOR-encrypted swap data
     std::array<uint8_t, 4> checksum;      // Integrity check
 
+    // Tag identifying the anchor of a swap to holders of its view key
+    static std::array<uint8_t, 32> DeriveSwapKeyTag(const uint256& swap_id,
+                                                    const std::array<uint8_t, 32>& view_key);
+
+    // Blinded tag of a view key alone, for finding its swaps without a swap ID
+    static std::array<uint8_t, 32> DeriveViewTag(const std::array<uint8_t, 32>& view_key);
+
     // Create from swap data and view key
     static EncryptedSwapAnchor Create(const PrivateSwapData& data,
                                        const std::array<uint8_t, 32>& view_key);
@@ -218,10 +226,20 @@ private:
     // Swap storage (encrypted)
     std::map<uint256, EncryptedSwapAnchor> m_swaps;
 
+    // Swap IDs by the view tag of their view key, so GetSwapsForViewKey
+    // only decrypts the swaps it can open
+    std::map<std::array<uint8_t, 32>, std::set<uint256>> m_swaps_by_view_tag;
+
     // Statistics
     uint64_t m_total_swaps{0};
     uint64_t m_active_swaps{0};
 
+    // Decrypt a stored swap, skipping the decryption when the key tag shows
+    // the view key does not open it
+    bool DecryptSwapLocked(const uint256& swap_id,
+                           const std::array<uint8_t, 32>& view_key,
+                           PrivateSwapData& out) const;
+
     // Generate hash lock for HTLC
     uint256 GenerateHashLock(const uint256& preimage);
 
@@ -8,9 +8,65 @@
 #include <logging.h>
 #include <node/randomx_miner.h>
 #include <streams.h>
+#include <sync.h>
+#include <util/hasher.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
 #include <cstring>
+#include <deque>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * RandomX hashes of parent headers, by their serialization hash
+ *
+ * Several merged-mined blocks can share one parent, and a block's parent is
+ * hashed again on header sync, block receipt and reindex. Entries are only
+ * valid for the RandomX key they were computed with.
+ */
+class ParentPoWHashCache
+{
+public:
+    static constexpr size_t MAX_ENTRIES{8192};
+
+    bool Get(const uint256& parent, uint64_t generation, uint256& pow_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (generation != m_generation) return false;
+        const auto it = m_hashes.find(parent);
+        if (it == m_hashes.end()) return false;
+        pow_hash = it->second;
+        return true;
+    }
+
+    void Put(const uint256& parent, uint64_t generation, const uint256& pow_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (generation != m_generation) {
+            m_hashes.clear();
+            m_order.clear();
+            m_generation = generation;
+        }
+        if (!m_hashes.emplace(parent, pow_hash).second) return;
+        m_order.push_back(parent);
+        if (m_order.size() > MAX_ENTRIES) {
+            m_hashes.erase(m_order.front());
+            m_order.pop_front();
+        }
+    }
+
+private:
+    Mutex m_mutex;
+    std::unordered_map<uint256, uint256, SaltedTxidHasher> m_hashes GUARDED_BY(m_mutex);
+    std::deque<uint256> m_order GUARDED_BY(m_mutex);
+    uint64_t m_generation GUARDED_BY(m_mutex){0};
+};
+
+ParentPoWHashCache g_parent_pow_hashes;
+
+} // namespace
 
 // ============================================================================
 // CMoneroBlockHeader
@@ -115,6 +171,31 @@ uint256 CMerkleBranch::GetRoot(const uint256& leaf) const {
     return hash;
 }
 
+std::vector<CMerkleBranch> ComputeMerkleBranches(const std::vector<uint256>& hashes)
+{
+    std::vector<CMerkleBranch> branches(hashes.size());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        branches[i].nIndex = i;
+    }
+    if (hashes.size() < 2) return branches;
+
+    // Walk up the tree a level at a time, a lone node is its own sibling
+    std::vector<uint256> level = hashes;
+    for (size_t shift = 0; level.size() > 1; ++shift) {
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            const size_t node = i >> shift;
+            branches[i].vHash.push_back(level[std::min(node ^ 1, level.size() - 1)]);
+        }
+        std::vector<uint256> parents;
+        parents.reserve((level.size() + 1) / 2);
+        for (size_t node = 0; node < level.size(); node += 2) {
+            parents.push_back(Hash(level[node], level[std::min(node + 1, level.size() - 1)]));
+        }
+        level = std::move(parents);
+    }
+    return branches;
+}
+
 // ============================================================================
 // CAuxPow
 // ============================================================================
@@ -177,7 +258,20 @@ bool CAuxPow::Check(const uint256& hashAuxBlock, int expectedChainId) const {
 }
 
 uint256 CAuxPow::GetParentBlockPoWHash() const {
-    return parentBlock.GetPoWHash();
+    // GetHash() leaves out the merkle root, which the PoW hash commits to
+    const uint256 parent = (HashWriter{} << parentBlock).GetHash();
+
+    auto& miner = node::GetRandomXMiner();
+    const uint64_t generation = miner.GetGeneration();
+    uint256 pow_hash;
+    if (g_parent_pow_hashes.Get(parent, generation, pow_hash)) return pow_hash;
+
+    pow_hash = parentBlock.GetPoWHash();
+    // Not the SHA256d fallback, nor a hash the key changed under
+    if (miner.IsInitialized() && miner.GetGeneration() == generation) {
+        g_parent_pow_hashes.Put(parent, generation, pow_hash);
+    }
+    return pow_hash;
 }
 
 bool CAuxPow::GetAuxChainMerkleRoot(uint256& hashOut) const {
@@ -73,6 +73,16 @@ public:
     void SetNull() { vHash.clear(); nIndex = -1; }
 };
 
+/**
+ * Branch of every hash of the list to the root of the Bitcoin-style tree
+ * over it, where a lone node is paired with itself and a single hash is its
+ * own root
+ *
+ * The tree is built once, so all branches cost O(n log n) hashes copied and
+ * O(n) hashed, rather than a tree walk per hash.
+ */
+std::vector<CMerkleBranch> ComputeMerkleBranches(const std::vector<uint256>& hashes);
+
 /**
  * Merge mining tag in Monero coinbase extra field
  */
@@ -143,6 +153,11 @@ public:
 
 /**
  * Extended block header with optional AuxPoW
+ *
+ * This is not the header's wire or disk format: headers messages, block index
+ * records and header sync all use CBlockHeader, which carries no proof. The
+ * proof only travels with a block (CBlock::auxpow), so merged-mined headers
+ * cost no more to sync or keep than standalone ones.
  */
 class CAuxPowBlockHeader : public CBlockHeader {
 public:
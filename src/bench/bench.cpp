@@ -65,6 +65,33 @@ void GenerateTemplateResults(const std::vector<ankerl::nanobench::Result>& bench
     }
 }
 
+/**
+ * Median time of each benchmark in a CSV file written with -output-csv.
+ * Throws if the file cannot be read, since a missing baseline would let
+ * every regression through.
+ */
+std::map<std::string, double> ReadBaseline(const fs::path& file)
+{
+    std::ifstream fin{file};
+    if (!fin.is_open()) {
+        throw std::runtime_error(strprintf("Could not read baseline %s", fs::PathToString(file)));
+    }
+    std::map<std::string, double> medians;
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        // name, evals, iterations, total, min, max, median
+        const std::vector<std::string> fields = util::SplitString(line, ',');
+        if (fields.size() != 7) continue;
+        try {
+            medians[std::string{util::TrimStringView(fields[0])}] = std::stod(fields[6]);
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+    return medians;
+}
+
 } // namespace
 
 namespace benchmark {
@@ -102,8 +129,10 @@ BenchRunner::BenchRunner(std::string name, BenchFunction func, PriorityLevel lev
     benchmarks().insert(std::make_pair(name, std::make_pair(func, level)));
 }
 
-void BenchRunner::RunAll(const Args& args)
+bool BenchRunner::RunAll(const Args& args)
 {
+    const std::map<std::string, double> baseline{args.baseline.empty() ? std::map<std::string, double>{} : ReadBaseline(args.baseline)};
+
     std::regex reFilter(args.regex_filter);
     std::smatch baseMatch;
 
@@ -168,6 +197,20 @@ void BenchRunner::RunAll(const Args& args)
                                                                "{{#result}}{{name}}, {{epochs}}, {{average(iterations)}}, {{sumProduct(iterations, elapsed)}}, {{minimum(elapsed)}}, {{maximum(elapsed)}}, {{median(elapsed)}}\n"
                                                                "{{/result}}");
     GenerateTemplateResults(benchmarkResults, args.output_json, ankerl::nanobench::templates::json());
+
+    bool regressed{false};
+    for (const auto& result : benchmarkResults) {
+        const auto it = baseline.find(result.config().mBenchmarkName);
+        if (it == baseline.end() || it->second <= 0) continue;
+        const double median = result.median(ankerl::nanobench::Result::Measure::elapsed);
+        const double change = (median / it->second - 1) * 100;
+        if (change > args.max_regression) {
+            std::cout << strprintf("Regression: %s is %.1f%% slower than the baseline (%.3g s -> %.3g s)",
+                                   result.config().mBenchmarkName, change, it->second, median) << std::endl;
+            regressed = true;
+        }
+    }
+    return !regressed;
 }
 
 } // namespace benchmark
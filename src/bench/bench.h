@@ -53,8 +53,10 @@ std::string ListPriorities();
 uint8_t StringToPriority(const std::string& str);
 
 struct Args {
+    fs::path baseline;
     bool is_list_only;
     bool sanity_check;
+    double max_regression;
     std::chrono::milliseconds min_time;
     std::vector<double> asymptote;
     fs::path output_csv;
@@ -73,7 +75,8 @@ class BenchRunner
 public:
     BenchRunner(std::string name, BenchFunction func, PriorityLevel level);
 
-    static void RunAll(const Args& args);
+    // Returns false if a benchmark regressed against args.baseline
+    static bool RunAll(const Args& args);
 };
 } // namespace benchmark
 
@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 #include <common/args.h>
 #include <crypto/sha256.h>
+#include <crypto/sha3.h>
 #include <tinyformat.h>
 #include <util/fs.h>
 #include <util/string.h>
@@ -22,6 +23,7 @@ using util::SplitString;
 
 static const char* DEFAULT_BENCH_FILTER = ".*";
 static constexpr int64_t DEFAULT_MIN_TIME_MS{10};
+static constexpr int64_t DEFAULT_MAX_REGRESSION_PERCENT{10};
 /** Priority level default value, run "all" priority levels */
 static const std::string DEFAULT_PRIORITY{"all"};
 
@@ -30,9 +32,11 @@ static void SetupBenchArgs(ArgsManager& argsman)
     SetupHelpOptions(argsman);
     SetupCommonTestArgs(argsman);
 
+    argsman.AddArg("-baseline=<results.csv>", "Compare the median time of each benchmark with a CSV file written by -output-csv, and fail if one regressed by more than -max-regression", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-asymptote=<n1,n2,n3,...>", "Test asymptotic growth of the runtime of an algorithm, if supported by the benchmark", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-filter=<regex>", strprintf("Regular expression filter to select benchmark by name (default: %s)", DEFAULT_BENCH_FILTER), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-list", "List benchmarks without executing them", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-max-regression=<percent>", strprintf("Slowdown against -baseline at which a benchmark fails (default: %d)", DEFAULT_MAX_REGRESSION_PERCENT), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
     argsman.AddArg("-min-time=<milliseconds>", strprintf("Minimum runtime per benchmark, in milliseconds (default: %d)", DEFAULT_MIN_TIME_MS), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
     argsman.AddArg("-output-csv=<output.csv>", "Generate CSV file with the most important benchmark results", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-output-json=<output.json>", "Generate JSON file with all benchmark results", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -79,6 +83,7 @@ int main(int argc, char** argv)
     ArgsManager argsman;
     SetupBenchArgs(argsman);
     SHA256AutoDetect();
+    SHA3AutoDetect();
     std::string error;
     if (!argsman.ParseParameters(argc, argv, error)) {
         tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error);
@@ -138,7 +143,9 @@ int main(int argc, char** argv)
     try {
         benchmark::Args args;
         args.asymptote = parseAsymptote(argsman.GetArg("-asymptote", ""));
+        args.baseline = argsman.GetPathArg("-baseline");
         args.is_list_only = argsman.GetBoolArg("-list", false);
+        args.max_regression = argsman.GetIntArg("-max-regression", DEFAULT_MAX_REGRESSION_PERCENT);
         args.min_time = std::chrono::milliseconds(argsman.GetIntArg("-min-time", DEFAULT_MIN_TIME_MS));
         args.output_csv = argsman.GetPathArg("-output-csv");
         args.output_json = argsman.GetPathArg("-output-json");
@@ -147,9 +154,7 @@ int main(int argc, char** argv)
         args.priority = parsePriorityLevel(argsman.GetArg("-priority-level", DEFAULT_PRIORITY));
         args.setup_args = parseTestSetupArgs(argsman);
 
-        benchmark::BenchRunner::RunAll(args);
-
-        return EXIT_SUCCESS;
+        return benchmark::BenchRunner::RunAll(args) ? EXIT_SUCCESS : EXIT_FAILURE;
     } catch (const std::exception& e) {
         tfm::format(std::cerr, "Error: %s\n", e.what());
         return EXIT_FAILURE;
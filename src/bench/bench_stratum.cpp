@@ -0,0 +1,721 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#include <chainparams.h>
+#include <common/args.h>
+#include <consensus/amount.h>
+#include <consensus/merkle.h>
+#include <crypto/sha256.h>
+#include <hash.h>
+#include <interfaces/mining.h>
+#include <logging.h>
+#include <node/context.h>
+#include <node/randomx_miner.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <stratum/stratum_metrics.h>
+#include <stratum/stratum_server.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <util/chaintype.h>
+#include <util/fs_helpers.h>
+#include <util/strencodings.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using stratum::LatencyHistogram;
+
+const std::function<void(const std::string&)> G_TEST_LOG_FUN{};
+const std::function<std::vector<const char*>()> G_TEST_COMMAND_LINE_ARGUMENTS{[] { return std::vector<const char*>{}; }};
+const std::function<std::string()> G_TEST_GET_FULL_NAME{[] { return std::string{"bench_stratum"}; }};
+
+namespace {
+
+constexpr int DEFAULT_CLIENTS{1000};
+constexpr int DEFAULT_CLIENT_THREADS{4};
+constexpr int DEFAULT_DURATION{10};
+constexpr int DEFAULT_WARMUP{2};
+constexpr double DEFAULT_SUBMIT_RATE{0.5};
+constexpr int DEFAULT_INVALID_PERCENT{0};
+constexpr int DEFAULT_JOB_INTERVAL_MS{1000};
+constexpr uint16_t DEFAULT_PORT{28335};
+constexpr uint64_t DEFAULT_DIFFICULTY{1};
+const std::string DEFAULT_PROTOCOL{"xmrig"};
+
+//! Ids of the handshake requests; submits count up from SUBMIT_ID_BASE
+constexpr uint64_t LOGIN_ID{1};
+constexpr uint64_t AUTHORIZE_ID{2};
+constexpr uint64_t SUBMIT_ID_BASE{100};
+//! Clients not holding a job after this long fail the run
+constexpr auto READY_TIMEOUT{60s};
+
+void SetupBenchArgs(ArgsManager& argsman)
+{
+    SetupHelpOptions(argsman);
+
+    argsman.AddArg("-clients=<n>", strprintf("Number of simulated miners (default: %d)", DEFAULT_CLIENTS), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-client-threads=<n>", strprintf("Threads driving the simulated miners (default: %d)", DEFAULT_CLIENT_THREADS), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-connect=<host:port>", "Load an already running stratum server, e.g. a merged mining one, instead of starting one in-process. Job latency is then measured from the first miner receiving a job and server CPU is not reported", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-difficulty=<n>", strprintf("Starting share difficulty of the in-process server (default: %u)", DEFAULT_DIFFICULTY), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-duration=<seconds>", strprintf("Length of the measurement (default: %d)", DEFAULT_DURATION), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-invalid=<percent>", strprintf("Share of submits sent for an unknown job, which the server must reject (default: %d)", DEFAULT_INVALID_PERCENT), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-io-threads=<n>", strprintf("Event loop threads of the in-process server (default: %d)", stratum::DEFAULT_STRATUM_IO_THREADS), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-job-interval=<ms>", strprintf("Time between new blocks, each broadcasting a new job; 0 for none (default: %d)", DEFAULT_JOB_INTERVAL_MS), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-node", "Build jobs from a regtest node instead of the mocked mining interface. On regtest nearly every share is a block candidate, so this mostly measures block submission", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-port=<port>", strprintf("Port of the in-process server (default: %u)", DEFAULT_PORT), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-protocol=<xmrig|stratum>", strprintf("Handshake of the miners: XMRig login or mining.subscribe and mining.authorize (default: %s)", DEFAULT_PROTOCOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-submit-rate=<shares/s>", strprintf("Average submits per second of each miner, Poisson distributed (default: %s)", DEFAULT_SUBMIT_RATE), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-validation-queue=<n>", strprintf("Submits waiting for validation beyond which the in-process server answers busy (default: %u)", stratum::DEFAULT_SHARE_VALIDATION_QUEUE), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-validation-threads=<n>", strprintf("Share validation threads of the in-process server (default: %d)", stratum::DEFAULT_SHARE_VALIDATION_THREADS), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-vardiff", "Let the in-process server retarget each miner's difficulty (default: off, so every well-formed share is accepted)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-warmup=<seconds>", strprintf("Time the load runs before it is measured (default: %d)", DEFAULT_WARMUP), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+}
+
+/**
+ * Template of a block with only a coinbase, on a chain that advances when
+ * told to. Its target is out of reach, so no share is a block candidate and
+ * the server's cost is job building, fan-out and share validation alone.
+ */
+class MockBlockTemplate : public interfaces::BlockTemplate
+{
+public:
+    explicit MockBlockTemplate(CBlock block) : m_block(std::move(block)) {}
+
+    CBlockHeader getBlockHeader() override { return m_block; }
+    CBlock getBlock() override { return m_block; }
+    std::vector<CAmount> getTxFees() override { return {}; }
+    std::vector<int64_t> getTxSigops() override { return {}; }
+    CTransactionRef getCoinbaseTx() override { return m_block.vtx[0]; }
+    std::vector<unsigned char> getCoinbaseCommitment() override { return {}; }
+    int getWitnessCommitmentIndex() override { return -1; }
+    std::vector<uint256> getCoinbaseMerklePath() override { return {}; }
+    bool submitSolution(uint32_t, uint32_t, uint32_t, CTransactionRef) override { return false; }
+    bool submitAuxPowSolution(uint32_t, uint32_t, uint32_t, CTransactionRef, std::shared_ptr<CAuxPow>) override { return false; }
+
+private:
+    const CBlock m_block;
+};
+
+class MockMining : public interfaces::Mining
+{
+public:
+    bool isTestChain() override { return true; }
+    bool isInitialBlockDownload() override { return false; }
+
+    std::optional<interfaces::BlockRef> getTip() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tip;
+    }
+
+    interfaces::BlockRef waitTipChanged(uint256, MillisecondsDouble) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tip;
+    }
+
+    std::unique_ptr<interfaces::BlockTemplate> createNewBlock(const node::BlockCreateOptions&, bool, int64_t*, int32_t, int32_t) override
+    {
+        const interfaces::BlockRef tip{*getTip()};
+
+        CMutableTransaction coinbase;
+        coinbase.vin.resize(1);
+        coinbase.vin[0].prevout.SetNull();
+        coinbase.vin[0].scriptSig = CScript() << (tip.height + 1) << OP_0;
+        coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+
+        CBlock block;
+        block.nVersion = 0x20000000;
+        block.hashPrevBlock = tip.hash;
+        block.nTime = static_cast<uint32_t>(GetTime());
+        block.nBits = 0x03000001;
+        block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+        block.hashMerkleRoot = BlockMerkleRoot(block);
+        return std::make_unique<MockBlockTemplate>(std::move(block));
+    }
+
+    void AdvanceTip()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tip.hash = Hash(m_tip.hash);
+        ++m_tip.height;
+    }
+
+private:
+    std::mutex m_mutex;
+    interfaces::BlockRef m_tip{.hash = uint256::ONE, .height = 0};
+};
+
+int64_t SteadyNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now().time_since_epoch()).count();
+}
+
+std::chrono::microseconds ThreadCpuTime()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{ts.tv_nsec});
+}
+
+std::chrono::microseconds ProcessCpuTime()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    const auto tv = [](const timeval& t) { return std::chrono::seconds{t.tv_sec} + std::chrono::microseconds{t.tv_usec}; };
+    return tv(usage.ru_utime) + tv(usage.ru_stime);
+}
+
+/** The string value of @p key in a JSON line, without unescaping */
+std::string_view FindString(std::string_view line, std::string_view key)
+{
+    const size_t pos = line.find(key);
+    if (pos == std::string_view::npos) return {};
+    const size_t start = pos + key.size();
+    const size_t end = line.find('"', start);
+    if (end == std::string_view::npos) return {};
+    return line.substr(start, end - start);
+}
+
+std::optional<uint64_t> FindId(std::string_view line)
+{
+    constexpr std::string_view key{"\"id\":"};
+    const size_t pos = line.find(key);
+    if (pos == std::string_view::npos) return std::nullopt;
+    uint64_t id;
+    const char* start = line.data() + pos + key.size();
+    if (std::from_chars(start, line.data() + line.size(), id).ec != std::errc{}) return std::nullopt;
+    return id;
+}
+
+enum class Phase { WARMUP, MEASURE, DONE };
+
+/**
+ * When each job started on its way to the miners.
+ *
+ * The driver stamps a new-block notification before raising it and the
+ * first miner to see a new job id claims the stamp. Jobs nobody stamped,
+ * as with -connect, start when the first miner receives them, so their
+ * latency is the fan-out spread.
+ */
+class JobClock
+{
+public:
+    void Expect(int64_t notified_ns)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_ns = notified_ns;
+    }
+
+    int64_t Origin(const std::string& job_id, int64_t now_ns)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto [it, inserted] = m_origin_ns.try_emplace(job_id, now_ns);
+        if (inserted && m_pending_ns != 0) {
+            it->second = m_pending_ns;
+            m_pending_ns = 0;
+        }
+        return it->second;
+    }
+
+private:
+    std::mutex m_mutex;
+    int64_t m_pending_ns{0};
+    std::unordered_map<std::string, int64_t> m_origin_ns;
+};
+
+struct LoadOptions {
+    std::string host;
+    uint16_t port{0};
+    bool xmrig{true};
+    double submit_rate{DEFAULT_SUBMIT_RATE};
+    int invalid_percent{DEFAULT_INVALID_PERCENT};
+};
+
+/** Results of the measured window; histograms and counters are shared by all client threads */
+struct LoadResults {
+    LatencyHistogram job_latency;
+    LatencyHistogram submit_rtt;
+    std::atomic<uint64_t> connected{0};
+    std::atomic<uint64_t> ready{0};
+    std::atomic<uint64_t> disconnected{0};
+    std::atomic<uint64_t> jobs{0};
+    std::atomic<uint64_t> submits{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> busy{0};
+    std::atomic<int64_t> client_cpu_us{0};
+};
+
+struct SimClient {
+    int fd{-1};
+    std::string in;
+    std::string out;
+    std::string session;
+    std::string job_id;
+    bool ready{false};
+    uint64_t next_id{SUBMIT_ID_BASE};
+    int64_t next_submit_ns{0};
+    //! Send times of the submits awaiting an answer
+    std::unordered_map<uint64_t, int64_t> pending;
+};
+
+/** One thread's share of the miners, multiplexed with poll() */
+class ClientGroup
+{
+public:
+    ClientGroup(const LoadOptions& options, LoadResults& results, JobClock& clock, const std::atomic<Phase>& phase)
+        : m_options(options), m_results(results), m_clock(clock), m_phase(phase) {}
+
+    ~ClientGroup()
+    {
+        for (SimClient& client : m_clients) {
+            if (client.fd >= 0) close(client.fd);
+        }
+    }
+
+    bool Connect(size_t count)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_options.port);
+        if (inet_pton(AF_INET, m_options.host.c_str(), &addr.sin_addr) != 1) return false;
+
+        m_clients.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            SimClient& client = m_clients[i];
+            client.fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (client.fd < 0 || connect(client.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                tfm::format(std::cerr, "Error: connecting miner failed: %s\n", strerror(errno));
+                return false;
+            }
+            const int one = 1;
+            setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fcntl(client.fd, F_SETFL, fcntl(client.fd, F_GETFL, 0) | O_NONBLOCK);
+            ++m_results.connected;
+
+            const std::string login{strprintf("bench.%u", i)};
+            if (m_options.xmrig) {
+                Queue(client, strprintf("{\"id\":%u,\"jsonrpc\":\"2.0\",\"method\":\"login\",\"params\":{\"login\":\"%s\",\"pass\":\"x\",\"agent\":\"bench_stratum\"}}\n", LOGIN_ID, login));
+            } else {
+                Queue(client, strprintf("{\"id\":%u,\"method\":\"mining.subscribe\",\"params\":[\"bench_stratum\"]}\n", LOGIN_ID));
+                Queue(client, strprintf("{\"id\":%u,\"method\":\"mining.authorize\",\"params\":[\"%s\",\"x\"]}\n", AUTHORIZE_ID, login));
+            }
+        }
+        return true;
+    }
+
+    void Run()
+    {
+        std::vector<pollfd> pfds(m_clients.size());
+        Phase seen{Phase::WARMUP};
+        std::chrono::microseconds cpu_start{0};
+        while (true) {
+            const Phase phase{m_phase.load()};
+            if (phase != seen) {
+                if (phase == Phase::MEASURE) cpu_start = ThreadCpuTime();
+                if (phase == Phase::DONE) {
+                    if (seen == Phase::MEASURE) m_results.client_cpu_us += (ThreadCpuTime() - cpu_start).count();
+                    return;
+                }
+                seen = phase;
+            }
+            m_measuring = phase == Phase::MEASURE;
+
+            for (size_t i = 0; i < m_clients.size(); ++i) {
+                pfds[i].fd = m_clients[i].fd;
+                pfds[i].events = POLLIN | (m_clients[i].out.empty() ? 0 : POLLOUT);
+                pfds[i].revents = 0;
+            }
+            if (poll(pfds.data(), pfds.size(), 5) < 0 && errno != EINTR) return;
+
+            const int64_t now{SteadyNanos()};
+            for (size_t i = 0; i < m_clients.size(); ++i) {
+                SimClient& client = m_clients[i];
+                if (client.fd < 0) continue;
+                if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) Receive(client, now);
+                if (client.fd >= 0 && client.ready && client.next_submit_ns <= now) Submit(client, now);
+                if (client.fd >= 0 && !client.out.empty()) Flush(client);
+            }
+        }
+    }
+
+private:
+    void Queue(SimClient& client, const std::string& message)
+    {
+        client.out += message;
+        Flush(client);
+    }
+
+    void Flush(SimClient& client)
+    {
+        while (!client.out.empty()) {
+            const ssize_t sent = send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+            if (sent <= 0) {
+                if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+                Drop(client);
+                return;
+            }
+            client.out.erase(0, sent);
+        }
+    }
+
+    void Drop(SimClient& client)
+    {
+        close(client.fd);
+        client.fd = -1;
+        if (client.ready) --m_results.ready;
+        client.ready = false;
+        ++m_results.disconnected;
+    }
+
+    void Receive(SimClient& client, int64_t now)
+    {
+        char buf[16384];
+        while (true) {
+            const ssize_t got = recv(client.fd, buf, sizeof(buf), 0);
+            if (got > 0) {
+                client.in.append(buf, got);
+                continue;
+            }
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            Drop(client);
+            return;
+        }
+
+        size_t start = 0;
+        for (size_t end; (end = client.in.find('\n', start)) != std::string::npos; start = end + 1) {
+            HandleLine(client, std::string_view{client.in}.substr(start, end - start), now);
+        }
+        client.in.erase(0, start);
+    }
+
+    void HandleLine(SimClient& client, std::string_view line, int64_t now)
+    {
+        if (line.find("\"method\":\"job\"") != std::string_view::npos) {
+            OnJob(client, FindString(line, "\"job_id\":\""), now);
+            return;
+        }
+
+        const std::optional<uint64_t> id{FindId(line)};
+        if (!id) return;
+        if (*id == LOGIN_ID && m_options.xmrig) {
+            client.session = FindString(line, "\"result\":{\"id\":\"");
+            OnJob(client, FindString(line, "\"job_id\":\""), now);
+            return;
+        }
+        if (*id < SUBMIT_ID_BASE) return;
+
+        const auto it = client.pending.find(*id);
+        if (it == client.pending.end()) return;
+        const int64_t sent_ns{it->second};
+        client.pending.erase(it);
+        if (!m_measuring) return;
+
+        m_results.submit_rtt.Record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{now - sent_ns}));
+        if (line.find("\"status\":\"OK\"") != std::string_view::npos) {
+            ++m_results.accepted;
+        } else if (line.find("\"error\":[24,") != std::string_view::npos) {
+            ++m_results.busy;
+        } else {
+            ++m_results.rejected;
+        }
+    }
+
+    void OnJob(SimClient& client, std::string_view job_id, int64_t now)
+    {
+        // A retarget resends the current job with a new target only
+        if (job_id.empty() || job_id == client.job_id) return;
+        client.job_id = job_id;
+        const int64_t origin_ns{m_clock.Origin(client.job_id, now)};
+        if (!client.ready) {
+            client.ready = true;
+            ++m_results.ready;
+            client.next_submit_ns = now + NextSubmitDelay();
+        }
+        if (!m_measuring) return;
+        ++m_results.jobs;
+        m_results.job_latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{now - origin_ns}));
+    }
+
+    int64_t NextSubmitDelay()
+    {
+        if (m_options.submit_rate <= 0) return std::numeric_limits<int64_t>::max() / 2;
+        const std::chrono::microseconds mean{static_cast<int64_t>(1e6 / m_options.submit_rate)};
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(m_rng.rand_exp_duration(mean)).count();
+    }
+
+    void Submit(SimClient& client, int64_t now)
+    {
+        client.next_submit_ns = now + NextSubmitDelay();
+        if (!m_measuring) return;
+
+        const bool invalid{static_cast<int>(m_rng.randrange(100)) < m_options.invalid_percent};
+        const std::string job_id{invalid ? "ffffffffffffffff" : client.job_id};
+        const uint64_t id{client.next_id++};
+        const uint32_t nonce{m_rng.rand32()};
+        std::string message;
+        if (m_options.xmrig) {
+            message = strprintf("{\"id\":%u,\"jsonrpc\":\"2.0\",\"method\":\"submit\",\"params\":{\"id\":\"%s\",\"job_id\":\"%s\",\"nonce\":\"%08x\",\"result\":\"%s\"}}\n",
+                                id, client.session, job_id, nonce, std::string(64, '0'));
+        } else {
+            message = strprintf("{\"id\":%u,\"method\":\"mining.submit\",\"params\":[\"bench\",\"%s\",\"00000000\",\"00000000\",\"%08x\"]}\n",
+                                id, job_id, nonce);
+        }
+        client.pending.emplace(id, now);
+        ++m_results.submits;
+        Queue(client, message);
+    }
+
+    const LoadOptions& m_options;
+    LoadResults& m_results;
+    JobClock& m_clock;
+    const std::atomic<Phase>& m_phase;
+    bool m_measuring{false};
+    FastRandomContext m_rng;
+    std::vector<SimClient> m_clients;
+};
+
+void PrintHistogram(const std::string& name, const LatencyHistogram& histogram)
+{
+    const LatencyHistogram::Snapshot snapshot{histogram.Read()};
+    if (snapshot.count == 0) {
+        tfm::format(std::cout, "  %-20s no samples\n", name);
+        return;
+    }
+    const auto ms = [](uint64_t us) { return us / 1000.0; };
+    tfm::format(std::cout, "  %-20s n=%-9u mean=%.3fms p50=%.3fms p90=%.3fms p99=%.3fms p99.9=%.3fms max=%.3fms\n",
+                name, snapshot.count, ms(snapshot.sum_us) / snapshot.count,
+                ms(snapshot.Percentile(0.50)), ms(snapshot.Percentile(0.90)), ms(snapshot.Percentile(0.99)),
+                ms(snapshot.Percentile(0.999)), ms(snapshot.max_us));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ArgsManager argsman;
+    SetupBenchArgs(argsman);
+    SHA256AutoDetect();
+    std::string error;
+    if (!argsman.ParseParameters(argc, argv, error)) {
+        tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    if (HelpRequested(argsman)) {
+        std::cout << "Usage:  bench_stratum [options]\n"
+                     "\n"
+                  << argsman.GetHelpMessage()
+                  << "Description:\n"
+                     "\n"
+                     "  bench_stratum loads a stratum server with simulated miners over loopback.\n"
+                     "  Each miner logs in, follows the jobs it is sent and submits shares at\n"
+                     "  random. It reports how long new jobs take to reach the miners, the round\n"
+                     "  trip of submits and the CPU the server used, next to the server's own\n"
+                     "  per-stage metrics.\n"
+                     "\n"
+                     "  By default the server runs in-process on a mocked mining interface whose\n"
+                     "  blocks no share can solve. Shares are hashed with RandomX in light mode,\n"
+                     "  as in production. With -connect any running server, including the merged\n"
+                     "  mining ones, can be loaded instead.\n"
+                     "\n";
+        return EXIT_SUCCESS;
+    }
+
+    const int clients{static_cast<int>(std::max<int64_t>(1, argsman.GetIntArg("-clients", DEFAULT_CLIENTS)))};
+    const int client_threads{static_cast<int>(std::clamp<int64_t>(argsman.GetIntArg("-client-threads", DEFAULT_CLIENT_THREADS), 1, clients))};
+    const auto duration{std::chrono::seconds{std::max<int64_t>(1, argsman.GetIntArg("-duration", DEFAULT_DURATION))}};
+    const auto warmup{std::chrono::seconds{std::max<int64_t>(0, argsman.GetIntArg("-warmup", DEFAULT_WARMUP))}};
+    const auto job_interval{std::chrono::milliseconds{std::max<int64_t>(0, argsman.GetIntArg("-job-interval", DEFAULT_JOB_INTERVAL_MS))}};
+
+    LoadOptions options;
+    options.xmrig = argsman.GetArg("-protocol", DEFAULT_PROTOCOL) != "stratum";
+    options.invalid_percent = static_cast<int>(std::clamp<int64_t>(argsman.GetIntArg("-invalid", DEFAULT_INVALID_PERCENT), 0, 100));
+    if (const auto rate{argsman.GetArg("-submit-rate")}) {
+        const auto [end, ec]{std::from_chars(rate->data(), rate->data() + rate->size(), options.submit_rate)};
+        if (ec != std::errc{} || end != rate->data() + rate->size() || options.submit_rate < 0) {
+            tfm::format(std::cerr, "Error: invalid -submit-rate '%s'\n", *rate);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Both ends of every connection live in this process
+    if (RaiseFileDescriptorLimit(2 * clients + 64) < 2 * clients + 64) {
+        tfm::format(std::cerr, "Error: not enough file descriptors for %d miners, raise the limit with ulimit -n\n", clients);
+        return EXIT_FAILURE;
+    }
+
+    const bool in_process{!argsman.IsArgSet("-connect")};
+    std::unique_ptr<TestingSetup> node_setup;
+    std::unique_ptr<interfaces::Mining> mining;
+    MockMining* mock{nullptr};
+    stratum::StratumServer server;
+    if (in_process) {
+        if (argsman.GetBoolArg("-node", false)) {
+            node_setup = MakeNoLogFileContext<TestingSetup>(ChainType::REGTEST);
+            mining = interfaces::MakeMining(node_setup->m_node);
+        } else {
+            LogInstance().DisableLogging();
+            SelectParams(ChainType::REGTEST);
+            auto mock_mining{std::make_unique<MockMining>()};
+            mock = mock_mining.get();
+            mining = std::move(mock_mining);
+        }
+
+        // Initialize RandomX up front rather than in the first share's validation
+        const uint256 genesis{Params().GenesisBlock().GetHash()};
+        auto& miner{node::GetRandomXMiner()};
+        if (!miner.IsInitialized() && !miner.Initialize(genesis.data(), genesis.size(), node::RandomXMiner::Mode::LIGHT)) {
+            tfm::format(std::cerr, "Error: RandomX initialization failed\n");
+            return EXIT_FAILURE;
+        }
+
+        stratum::StratumConfig config;
+        config.bind_address = "127.0.0.1";
+        config.port = static_cast<uint16_t>(argsman.GetIntArg("-port", DEFAULT_PORT));
+        config.max_clients = clients + 16;
+        config.job_timeout_seconds = 24 * 60 * 60; // new jobs come from -job-interval only
+        config.io_threads = static_cast<int>(argsman.GetIntArg("-io-threads", stratum::DEFAULT_STRATUM_IO_THREADS));
+        config.validation_threads = static_cast<int>(argsman.GetIntArg("-validation-threads", stratum::DEFAULT_SHARE_VALIDATION_THREADS));
+        config.validation_queue = static_cast<size_t>(argsman.GetIntArg("-validation-queue", stratum::DEFAULT_SHARE_VALIDATION_QUEUE));
+        config.default_wallet = "bench";
+        config.share_difficulty = static_cast<uint64_t>(std::max<int64_t>(1, argsman.GetIntArg("-difficulty", DEFAULT_DIFFICULTY)));
+        config.vardiff.enabled = argsman.GetBoolArg("-vardiff", false);
+        config.vardiff.min_difficulty = std::min(config.vardiff.min_difficulty, config.share_difficulty);
+        if (!server.Start(config, mining.get())) {
+            tfm::format(std::cerr, "Error: starting the stratum server on port %u failed\n", config.port);
+            return EXIT_FAILURE;
+        }
+        options.host = "127.0.0.1";
+        options.port = config.port;
+    } else {
+        const std::string target{argsman.GetArg("-connect", "")};
+        const size_t colon{target.rfind(':')};
+        uint16_t port{0};
+        if (colon == std::string::npos || !ParseUInt16(target.substr(colon + 1), &port) || port == 0) {
+            tfm::format(std::cerr, "Error: invalid -connect '%s', expected <host:port>\n", target);
+            return EXIT_FAILURE;
+        }
+        options.host = target.substr(0, colon);
+        options.port = port;
+    }
+
+    LoadResults results;
+    JobClock clock;
+    std::atomic<Phase> phase{Phase::WARMUP};
+    std::vector<std::unique_ptr<ClientGroup>> groups;
+    bool connected{true};
+    for (int i = 0; i < client_threads && connected; ++i) {
+        const int count{clients / client_threads + (i < clients % client_threads ? 1 : 0)};
+        groups.push_back(std::make_unique<ClientGroup>(options, results, clock, phase));
+        connected = groups.back()->Connect(count);
+    }
+    std::vector<std::thread> threads;
+    if (connected) {
+        for (auto& group : groups) {
+            threads.emplace_back([&group] { group->Run(); });
+        }
+    }
+
+    // Start measuring once every miner holds a job and the warmup has passed
+    const auto ready_deadline{SteadyClock::now() + READY_TIMEOUT};
+    while (connected && results.ready.load() < static_cast<uint64_t>(clients) && SteadyClock::now() < ready_deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    const bool all_ready{connected && results.ready.load() == static_cast<uint64_t>(clients)};
+    if (all_ready) std::this_thread::sleep_for(warmup);
+
+    const uint64_t accepted_before{server.GetTotalSharesAccepted()};
+    const uint64_t rejected_before{server.GetTotalSharesRejected()};
+    const auto cpu_before{ProcessCpuTime()};
+    const auto start{SteadyClock::now()};
+    int blocks{0};
+    if (all_ready) {
+        phase = Phase::MEASURE;
+        auto next_block{start + job_interval};
+        while (SteadyClock::now() < start + duration) {
+            if (job_interval.count() > 0 && in_process && SteadyClock::now() >= next_block) {
+                if (mock) mock->AdvanceTip();
+                clock.Expect(SteadyNanos());
+                server.NotifyNewBlock();
+                ++blocks;
+                next_block += job_interval;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    const double elapsed{Ticks<SecondsDouble>(SteadyClock::now() - start)};
+    const auto cpu_total{ProcessCpuTime() - cpu_before};
+    phase = Phase::DONE;
+    for (std::thread& thread : threads) thread.join();
+    groups.clear();
+    if (in_process) server.Stop();
+
+    if (!all_ready) {
+        tfm::format(std::cerr, "Error: only %u of %d miners connected and received a job\n", results.ready.load(), clients);
+        return EXIT_FAILURE;
+    }
+
+    const double client_cpu{results.client_cpu_us.load() / 1e6};
+    tfm::format(std::cout, "bench_stratum: %d miners on %d threads, %s protocol, %.1fs measured\n",
+                clients, client_threads, options.xmrig ? "xmrig" : "stratum", elapsed);
+    tfm::format(std::cout, "  submits              %u sent (%.1f/s), %u accepted, %u rejected, %u busy, %u unanswered\n",
+                results.submits.load(), results.submits.load() / elapsed, results.accepted.load(), results.rejected.load(),
+                results.busy.load(), results.submits.load() - results.accepted.load() - results.rejected.load() - results.busy.load());
+    tfm::format(std::cout, "  jobs                 %u received, %d new blocks, %u miners disconnected\n",
+                results.jobs.load(), blocks, results.disconnected.load());
+    PrintHistogram(in_process ? "job latency" : "job fan-out spread", results.job_latency);
+    PrintHistogram("submit rtt", results.submit_rtt);
+    tfm::format(std::cout, "  client cpu           %.2fs (%.1f%% of a core)\n", client_cpu, 100 * client_cpu / elapsed);
+
+    if (in_process) {
+        const double server_cpu{std::max(0.0, Ticks<SecondsDouble>(cpu_total) - client_cpu)};
+        tfm::format(std::cout, "  server cpu           %.2fs (%.1f%% of a core), %.1fus per submit\n",
+                    server_cpu, 100 * server_cpu / elapsed, results.submits.load() ? 1e6 * server_cpu / results.submits.load() : 0.0);
+        tfm::format(std::cout, "  server shares        %u accepted, %u rejected\n",
+                    server.GetTotalSharesAccepted() - accepted_before, server.GetTotalSharesRejected() - rejected_before);
+        tfm::format(std::cout, "server stages (whole run):\n");
+        for (const auto& stage : server.GetMetrics().Histograms()) {
+            PrintHistogram(stage.name, stage.histogram);
+        }
+        for (size_t i = 0; i < stratum::SHARE_REJECT_COUNT; ++i) {
+            const uint64_t count{server.GetMetrics().rejects[i].load()};
+            if (count) tfm::format(std::cout, "  reject %-13s %u\n", stratum::ShareRejectString(static_cast<stratum::ShareReject>(i)), count);
+        }
+    }
+
+    // A run in which no submit was answered measured nothing
+    return results.submits.load() > 0 && results.accepted.load() + results.rejected.load() + results.busy.load() == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
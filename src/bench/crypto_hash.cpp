@@ -93,6 +93,53 @@ static void SHA3_256_1M(benchmark::Bench& bench)
     });
 }
 
+static void KECCAK256_64b(benchmark::Bench& bench)
+{
+    // An uncompressed public key, as hashed for Ethereum addresses
+    uint8_t hash[KECCAK256_OUTPUT_SIZE];
+    std::vector<uint8_t> in(64, 0);
+    bench.batch(in.size()).unit("byte").run([&] {
+        Keccak256(in, hash);
+        in[0] = hash[0];
+    });
+}
+
+static void KeccakBatch(benchmark::Bench& bench, const char* name, sha3_implementation::UseImplementation use_implementation, size_t size)
+{
+    bench.name(strprintf("%s using the '%s' Keccak implementation", name, SHA3AutoDetect(use_implementation)));
+    std::vector<uint8_t> data(size * 1024, 0);
+    std::vector<Span<const unsigned char>> inputs;
+    for (size_t i = 0; i < 1024; ++i) inputs.emplace_back(data.data() + i * size, size);
+    std::vector<uint8_t> out(1024 * KECCAK256_OUTPUT_SIZE);
+    bench.batch(data.size()).unit("byte").run([&] {
+        Keccak256Many(inputs, out);
+        data[0] = out[0];
+    });
+    SHA3AutoDetect();
+}
+
+// Public keys hashed into addresses in bulk
+static void KECCAK256_ADDRESSES_1024_STANDARD(benchmark::Bench& bench)
+{
+    KeccakBatch(bench, __func__, sha3_implementation::STANDARD, 64);
+}
+
+static void KECCAK256_ADDRESSES_1024_AVX2(benchmark::Bench& bench)
+{
+    KeccakBatch(bench, __func__, sha3_implementation::USE_AVX2, 64);
+}
+
+// Full trie branch nodes, as checked when loading the contract state of a snapshot
+static void KECCAK256_TRIE_NODES_1024_STANDARD(benchmark::Bench& bench)
+{
+    KeccakBatch(bench, __func__, sha3_implementation::STANDARD, 532);
+}
+
+static void KECCAK256_TRIE_NODES_1024_AVX2(benchmark::Bench& bench)
+{
+    KeccakBatch(bench, __func__, sha3_implementation::USE_AVX2, 532);
+}
+
 static void SHA256_32b_STANDARD(benchmark::Bench& bench)
 {
     bench.name(strprintf("%s using the '%s' SHA256 implementation", __func__, SHA256AutoDetect(sha256_implementation::STANDARD)));
@@ -270,6 +317,11 @@ BENCHMARK(SHA256_AVX2, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256_SHANI, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA512, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA3_256_1M, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KECCAK256_64b, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KECCAK256_ADDRESSES_1024_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KECCAK256_ADDRESSES_1024_AVX2, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KECCAK256_TRIE_NODES_1024_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KECCAK256_TRIE_NODES_1024_AVX2, benchmark::PriorityLevel::HIGH);
 
 BENCHMARK(SHA256_32b_STANDARD, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256_32b_SSE4, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,317 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <privacy/confidential.h>
+#include <privacy/curvetree/curve_tree.h>
+#include <privacy/curvetree/flat_storage.h>
+#include <privacy/ed25519/pedersen.h>
+#include <privacy/fcmp_tx.h>
+#include <privacy/keyimage_db.h>
+#include <privacy/ring_signature.h>
+#include <privacy/stealth.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Outputs appended per AddOutputs() call, about one full block
+static constexpr size_t TREE_BLOCK_OUTPUTS{1000};
+
+static curvetree::OutputTuple RandomOutput()
+{
+    return {ed25519::Point::Random(), ed25519::Point::Random(), ed25519::Point::Random()};
+}
+
+/**
+ * Curve tree with the given number of leaves, built once per process and
+ * shared by the benchmarks of that size. Leaves repeat a small pool of
+ * outputs, which hash like distinct ones, and are hashed by Rebuild() rather
+ * than appended so that setting up 10M leaves takes minutes, not hours.
+ * The 10M tree takes a few GB of memory.
+ */
+static curvetree::CurveTree& BenchTree(uint64_t leaves)
+{
+    static std::map<uint64_t, std::unique_ptr<curvetree::CurveTree>> trees;
+    auto& tree = trees[leaves];
+    if (!tree) {
+        std::vector<curvetree::OutputTuple> pool(1024);
+        for (auto& output : pool) output = RandomOutput();
+        auto storage = std::make_shared<curvetree::FlatTreeStorage>();
+        for (uint64_t i = 0; i < leaves; ++i) {
+            storage->StoreOutput(i, pool[i % pool.size()]);
+        }
+        tree = std::make_unique<curvetree::CurveTree>(storage);
+        assert(tree->Rebuild());
+    }
+    return *tree;
+}
+
+// The tree grows by a block per run, which is negligible next to its size
+static void CurveTreeAddOutputs(benchmark::Bench& bench, uint64_t leaves)
+{
+    auto& tree = BenchTree(leaves);
+    std::vector<curvetree::OutputTuple> block(TREE_BLOCK_OUTPUTS);
+    for (auto& output : block) output = RandomOutput();
+
+    bench.batch(block.size()).unit("output").run([&] {
+        curvetree::TreeUndo undo;
+        tree.AddOutputs(block, &undo);
+        ankerl::nanobench::doNotOptimizeAway(undo.nodes.size());
+    });
+}
+
+static void CurveTreeGetBranch(benchmark::Bench& bench, uint64_t leaves)
+{
+    auto& tree = BenchTree(leaves);
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    bench.run([&] {
+        auto branch = tree.GetBranch(rng.randrange(leaves));
+        assert(branch);
+    });
+}
+
+static void CurveTreeAddOutputs1M(benchmark::Bench& bench) { CurveTreeAddOutputs(bench, 1'000'000); }
+static void CurveTreeAddOutputs10M(benchmark::Bench& bench) { CurveTreeAddOutputs(bench, 10'000'000); }
+static void CurveTreeGetBranch1M(benchmark::Bench& bench) { CurveTreeGetBranch(bench, 1'000'000); }
+static void CurveTreeGetBranch10M(benchmark::Bench& bench) { CurveTreeGetBranch(bench, 10'000'000); }
+
+static privacy::CRing MakeRing(size_t size, std::vector<CKey>& keys)
+{
+    privacy::CRing ring;
+    keys.resize(size);
+    ring.members.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        keys[i].MakeNewKey(true);
+        ring.members[i].outpoint = COutPoint(Txid::FromUint256(GetRandHash()), 0);
+        ring.members[i].pubKey = keys[i].GetPubKey();
+    }
+    return ring;
+}
+
+static void RingSignatureCreate(benchmark::Bench& bench, size_t ring_size)
+{
+    ECC_Context ecc_context{};
+    std::vector<CKey> keys;
+    const privacy::CRing ring = MakeRing(ring_size, keys);
+    const size_t real_index = ring_size / 2;
+    const uint256 message = GetRandHash();
+
+    bench.run([&] {
+        privacy::CRingSignature sig;
+        assert(privacy::CreateRingSignature(message, ring, real_index, keys[real_index], sig));
+    });
+}
+
+static void RingSignatureVerify(benchmark::Bench& bench, size_t ring_size)
+{
+    ECC_Context ecc_context{};
+    std::vector<CKey> keys;
+    const privacy::CRing ring = MakeRing(ring_size, keys);
+    const size_t real_index = ring_size / 2;
+    const uint256 message = GetRandHash();
+    privacy::CRingSignature sig;
+    assert(privacy::CreateRingSignature(message, ring, real_index, keys[real_index], sig));
+
+    bench.run([&] {
+        assert(privacy::VerifyRingSignature(message, sig));
+    });
+}
+
+static void RingSignatureCreate11(benchmark::Bench& bench) { RingSignatureCreate(bench, 11); }
+static void RingSignatureCreate16(benchmark::Bench& bench) { RingSignatureCreate(bench, 16); }
+static void RingSignatureCreate64(benchmark::Bench& bench) { RingSignatureCreate(bench, 64); }
+static void RingSignatureVerify11(benchmark::Bench& bench) { RingSignatureVerify(bench, 11); }
+static void RingSignatureVerify16(benchmark::Bench& bench) { RingSignatureVerify(bench, 16); }
+static void RingSignatureVerify64(benchmark::Bench& bench) { RingSignatureVerify(bench, 64); }
+
+// Outputs covered by the aggregated range proof benchmarks
+static constexpr size_t RANGE_PROOF_OUTPUTS{16};
+
+struct RangeProofOutputs {
+    std::vector<CAmount> amounts;
+    std::vector<privacy::CBlindingFactor> blinds;
+    std::vector<privacy::CPedersenCommitment> commitments;
+
+    explicit RangeProofOutputs(size_t count)
+    {
+        FastRandomContext rng{/*fDeterministic=*/true};
+        for (size_t i = 0; i < count; ++i) {
+            amounts.push_back(rng.randrange(21'000'000 * COIN));
+            blinds.push_back(privacy::CBlindingFactor::Random());
+            commitments.emplace_back();
+            assert(privacy::CreateCommitment(amounts.back(), blinds.back(), commitments.back()));
+        }
+    }
+};
+
+static void RangeProofCreate(benchmark::Bench& bench)
+{
+    ECC_Context ecc_context{};
+    const RangeProofOutputs outputs{1};
+
+    bench.run([&] {
+        privacy::CRangeProof proof;
+        assert(privacy::CreateRangeProof(outputs.amounts[0], outputs.blinds[0], outputs.commitments[0], proof));
+    });
+}
+
+static void RangeProofVerify(benchmark::Bench& bench)
+{
+    ECC_Context ecc_context{};
+    const RangeProofOutputs outputs{1};
+    privacy::CRangeProof proof;
+    assert(privacy::CreateRangeProof(outputs.amounts[0], outputs.blinds[0], outputs.commitments[0], proof));
+
+    bench.run([&] {
+        assert(privacy::VerifyRangeProof(outputs.commitments[0], proof));
+    });
+}
+
+// Reported per output, to compare with the single proof benchmarks
+static void AggregatedRangeProofCreate(benchmark::Bench& bench)
+{
+    ECC_Context ecc_context{};
+    const RangeProofOutputs outputs{RANGE_PROOF_OUTPUTS};
+
+    bench.batch(RANGE_PROOF_OUTPUTS).unit("output").run([&] {
+        privacy::CRangeProof proof;
+        assert(privacy::CreateAggregatedRangeProof(outputs.amounts, outputs.blinds, outputs.commitments, proof));
+    });
+}
+
+static void AggregatedRangeProofVerify(benchmark::Bench& bench)
+{
+    ECC_Context ecc_context{};
+    const RangeProofOutputs outputs{RANGE_PROOF_OUTPUTS};
+    privacy::CRangeProof proof;
+    assert(privacy::CreateAggregatedRangeProof(outputs.amounts, outputs.blinds, outputs.commitments, proof));
+
+    bench.batch(RANGE_PROOF_OUTPUTS).unit("output").run([&] {
+        assert(privacy::VerifyAggregatedRangeProof(outputs.commitments, proof));
+    });
+}
+
+static void KeyImageLookup(benchmark::Bench& bench, bool spent)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    privacy::CKeyImageSpendDB db(testing_setup->m_args.GetDataDirBase() / "keyimages", 8 << 20, /*fMemory=*/true, /*fWipe=*/true, 'k');
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<std::pair<uint256, privacy::CKeyImageEntry>> spends;
+    for (int i = 0; i < 100'000; ++i) {
+        spends.emplace_back(rng.rand256(), privacy::CKeyImageEntry{rng.rand256(), i});
+    }
+    assert(db.WriteSpends(spends));
+
+    size_t i = 0;
+    bench.run([&] {
+        const uint256 hash = spent ? spends[i++ % spends.size()].first : rng.rand256();
+        assert(db.IsSpent(hash) == spent);
+    });
+}
+
+static void KeyImageLookupSpent(benchmark::Bench& bench) { KeyImageLookup(bench, /*spent=*/true); }
+static void KeyImageLookupUnspent(benchmark::Bench& bench) { KeyImageLookup(bench, /*spent=*/false); }
+
+// FCMP inputs spending outputs of a small tree, with a dummy output
+// balancing them
+static std::vector<privacy::CFcmpInput> MakeFcmpInputs(size_t count, ed25519::Point& root)
+{
+    auto tree = std::make_shared<curvetree::CurveTree>();
+    std::vector<curvetree::OutputTuple> decoys(100);
+    for (auto& output : decoys) output = RandomOutput();
+    tree->AddOutputs(decoys);
+
+    privacy::CFcmpTransactionBuilder builder(tree);
+    const CAmount amount{COIN};
+    for (size_t i = 0; i < count; ++i) {
+        const auto key = ed25519::KeyPair::Generate();
+        const ed25519::Scalar blinding = ed25519::Scalar::Random();
+        curvetree::OutputTuple output;
+        output.O = key.public_key;
+        output.I = ed25519::Point::HashToPoint(std::vector<uint8_t>(output.O.data.begin(), output.O.data.end()));
+        output.C = ed25519::PedersenCommitment::CommitAmount(amount, blinding).GetPoint();
+        const uint64_t leaf = tree->AddOutput(output);
+        assert(builder.AddInput(leaf, output, key.secret, amount, blinding));
+    }
+    assert(builder.AddOutput(RandomOutput(), amount * static_cast<CAmount>(count), ed25519::Scalar::Random()));
+
+    auto inputs = builder.BuildInputs();
+    assert(inputs.size() == count);
+    root = tree->GetRoot();
+    return inputs;
+}
+
+static void FcmpInputVerify(benchmark::Bench& bench)
+{
+    ed25519::Point root;
+    const auto inputs = MakeFcmpInputs(1, root);
+
+    bench.run([&] {
+        assert(privacy::VerifyFcmpInput(inputs[0], root, uint256{}));
+    });
+}
+
+static void FcmpInputBatchVerify(benchmark::Bench& bench)
+{
+    ed25519::Point root;
+    const auto inputs = MakeFcmpInputs(16, root);
+    std::vector<const privacy::CFcmpInput*> batch;
+    for (const auto& input : inputs) batch.push_back(&input);
+
+    bench.batch(batch.size()).unit("input").run([&] {
+        assert(privacy::BatchVerifyFcmpInputs(batch, root));
+    });
+}
+
+static void StealthScanOutput(benchmark::Bench& bench, bool ours)
+{
+    ECC_Context ecc_context{};
+    CKey scan, spend, other;
+    scan.MakeNewKey(true);
+    spend.MakeNewKey(true);
+    other.MakeNewKey(true);
+    const privacy::CStealthAddress address(ours ? scan.GetPubKey() : other.GetPubKey(), spend.GetPubKey());
+
+    CKey ephemeral;
+    privacy::CStealthOutput output;
+    assert(privacy::GenerateStealthDestination(address, ephemeral, output));
+
+    bench.run([&] {
+        CKey derived;
+        assert(privacy::ScanStealthOutput(output, scan, spend.GetPubKey(), derived) == ours);
+    });
+}
+
+static void StealthScanOutputOwned(benchmark::Bench& bench) { StealthScanOutput(bench, /*ours=*/true); }
+static void StealthScanOutputForeign(benchmark::Bench& bench) { StealthScanOutput(bench, /*ours=*/false); }
+
+BENCHMARK(CurveTreeAddOutputs1M, benchmark::PriorityLevel::LOW);
+BENCHMARK(CurveTreeAddOutputs10M, benchmark::PriorityLevel::LOW);
+BENCHMARK(CurveTreeGetBranch1M, benchmark::PriorityLevel::LOW);
+BENCHMARK(CurveTreeGetBranch10M, benchmark::PriorityLevel::LOW);
+BENCHMARK(RingSignatureCreate11, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RingSignatureCreate16, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RingSignatureCreate64, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RingSignatureVerify11, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RingSignatureVerify16, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RingSignatureVerify64, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RangeProofCreate, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RangeProofVerify, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AggregatedRangeProofCreate, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AggregatedRangeProofVerify, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KeyImageLookupSpent, benchmark::PriorityLevel::HIGH);
+BENCHMARK(KeyImageLookupUnspent, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FcmpInputVerify, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FcmpInputBatchVerify, benchmark::PriorityLevel::HIGH);
+BENCHMARK(StealthScanOutputOwned, benchmark::PriorityLevel::HIGH);
+BENCHMARK(StealthScanOutputForeign, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,146 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <crypto/common.h>
+#include <crypto/equihash/equihash.h>
+#include <crypto/sphlib/x11.h>
+#include <crypto/x25x/x11_hasher.h>
+#include <crypto/x25x/x25x.h>
+#include <node/randomx_miner.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <uint256.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+static CBlockHeader BenchHeader(x25x::Algorithm algo)
+{
+    CBlockHeader header;
+    header.nVersion = x25x::SetBlockAlgorithm(0x20000000, algo);
+    header.hashPrevBlock = uint256{"00000000000000000001a0c2bd7d2a1b0bb5e5bd2d9b4a37e3f4b1cbb3d8c0f1"};
+    header.hashMerkleRoot = uint256{"4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b"};
+    header.nTime = 1700000000;
+    header.nBits = 0x1d00ffff;
+    return header;
+}
+
+static std::vector<unsigned char> SerializedHeader()
+{
+    DataStream ss{};
+    ss << BenchHeader(x25x::Algorithm::X11);
+    const auto* bytes = reinterpret_cast<const unsigned char*>(ss.data());
+    return {bytes, bytes + ss.size()};
+}
+
+static void X11_REFERENCE(benchmark::Bench& bench)
+{
+    std::vector<unsigned char> data = SerializedHeader();
+    uint256 hash;
+    uint32_t nonce = 0;
+    bench.run([&] {
+        WriteLE32(data.data() + x25x::HeaderHasher::NONCE_OFFSET, nonce++);
+        x11_hash(data.data(), data.size(), hash.begin());
+    });
+}
+
+static void X11_ENGINE(benchmark::Bench& bench)
+{
+    std::vector<unsigned char> data = SerializedHeader();
+    x25x::X11Hasher hasher;
+    uint256 hash;
+    uint32_t nonce = 0;
+    bench.run([&] {
+        WriteLE32(data.data() + x25x::HeaderHasher::NONCE_OFFSET, nonce++);
+        hash = hasher.Hash(data.data(), data.size());
+    });
+}
+
+//! HashBlockHeader() at successive nonces, as a block check or a miner sees it
+static void HashHeaders(benchmark::Bench& bench, x25x::Algorithm algo)
+{
+    CBlockHeader header = BenchHeader(algo);
+    uint256 hash;
+    // Builds the Ethash epoch cache or the RandomX light cache outside the timing
+    hash = x25x::HashBlockHeader(header, algo);
+    bench.unit("hash").run([&] {
+        ++header.nNonce;
+        hash = x25x::HashBlockHeader(header, algo);
+        ankerl::nanobench::doNotOptimizeAway(hash);
+    });
+}
+
+static void X25X_HASH_SHA256D(benchmark::Bench& bench) { HashHeaders(bench, x25x::Algorithm::SHA256D); }
+static void X25X_HASH_SCRYPT(benchmark::Bench& bench) { HashHeaders(bench, x25x::Algorithm::SCRYPT); }
+static void X25X_HASH_ETHASH(benchmark::Bench& bench) { HashHeaders(bench, x25x::Algorithm::ETHASH); }
+static void X25X_HASH_RANDOMX_LIGHT(benchmark::Bench& bench) { HashHeaders(bench, x25x::Algorithm::RANDOMX); }
+static void X25X_HASH_X11(benchmark::Bench& bench) { HashHeaders(bench, x25x::Algorithm::X11); }
+static void X25X_HASH_KHEAVYHASH(benchmark::Bench& bench) { HashHeaders(bench, x25x::Algorithm::KHEAVYHASH); }
+
+static void X25X_HASH_RANDOMX_FULL(benchmark::Bench& bench)
+{
+    // The 2 GB dataset takes a while to build, so this one only runs at low priority
+    node::RandomXMiner miner;
+    const uint256 key{"4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b"};
+    if (!miner.Initialize(key.data(), key.size(), node::RandomXMiner::Mode::FULL)) return;
+
+    std::vector<unsigned char> blob = node::RandomXMiner::SerializeMiningBlob(BenchHeader(x25x::Algorithm::RANDOMX));
+    uint256 hash;
+    uint32_t nonce = 0;
+    bench.unit("hash").run([&] {
+        WriteLE32(blob.data() + 39, nonce++);
+        miner.CalculateHash(blob.data(), blob.size(), hash.begin());
+    });
+}
+
+static std::vector<unsigned char> EquihashInput()
+{
+    DataStream ss{};
+    ss << BenchHeader(x25x::Algorithm::EQUIHASH);
+    return {UCharCast(ss.data()), UCharCast(ss.data()) + ss.size()};
+}
+
+static void X25X_VERIFY_EQUIHASH(benchmark::Bench& bench)
+{
+    const std::vector<unsigned char> input = EquihashInput();
+    std::vector<unsigned char> solution;
+    equihash::Solver solver;
+    solver.Solve(input.data(), input.size(), [&](const std::vector<uint32_t>& indices) {
+        return equihash::CompressSolution(indices, solution);
+    });
+    assert(equihash::VerifySolution(input.data(), input.size(), solution));
+
+    bench.unit("verify").run([&] {
+        const bool valid = equihash::VerifySolution(input.data(), input.size(), solution);
+        ankerl::nanobench::doNotOptimizeAway(valid);
+    });
+}
+
+static void X25X_SOLVE_EQUIHASH(benchmark::Bench& bench)
+{
+    std::vector<unsigned char> input = EquihashInput();
+    equihash::Solver solver(std::max(1U, std::thread::hardware_concurrency()));
+    uint32_t nonce = 0;
+    bench.unit("solve").epochIterations(1).run([&] {
+        WriteLE32(input.data() + x25x::HeaderHasher::NONCE_OFFSET, nonce++);
+        const size_t found = solver.Solve(input.data(), input.size(), [](const std::vector<uint32_t>&) { return true; });
+        ankerl::nanobench::doNotOptimizeAway(found);
+    });
+}
+
+BENCHMARK(X11_REFERENCE, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X11_ENGINE, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_HASH_SHA256D, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_HASH_SCRYPT, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_HASH_ETHASH, benchmark::PriorityLevel::LOW);
+BENCHMARK(X25X_HASH_RANDOMX_LIGHT, benchmark::PriorityLevel::LOW);
+BENCHMARK(X25X_HASH_RANDOMX_FULL, benchmark::PriorityLevel::LOW);
+BENCHMARK(X25X_HASH_X11, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_HASH_KHEAVYHASH, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_VERIFY_EQUIHASH, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_SOLVE_EQUIHASH, benchmark::PriorityLevel::LOW);
@@ -0,0 +1,71 @@
+// Copyright (c) 2024-2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <bench/bench.h>
+#include <chain.h>
+#include <crypto/x25x/x25x.h>
+#include <kernel/chainparams.h>
+#include <primitives/block.h>
+
+#include <vector>
+
+static void CheckPow(benchmark::Bench& bench, x25x::Algorithm algo)
+{
+    const auto chain_params = CChainParams::Main();
+    const Consensus::Params& params = chain_params->GetConsensus();
+
+    CBlockHeader header;
+    header.nVersion = x25x::SetBlockAlgorithm(0x20000000, algo);
+    header.nTime = 1700000000;
+    header.nBits = UintToArith256(x25x::GetAlgorithmPowLimit(algo, params)).GetCompact();
+    // Builds the Ethash epoch cache or the RandomX light cache outside the timing
+    x25x::CheckProofOfWork(header, header.nBits, params);
+
+    bench.unit("verify").run([&] {
+        ++header.nNonce;
+        ankerl::nanobench::doNotOptimizeAway(x25x::CheckProofOfWork(header, header.nBits, params));
+    });
+}
+
+static void X25X_CHECKPOW_SHA256D(benchmark::Bench& bench) { CheckPow(bench, x25x::Algorithm::SHA256D); }
+static void X25X_CHECKPOW_SCRYPT(benchmark::Bench& bench) { CheckPow(bench, x25x::Algorithm::SCRYPT); }
+static void X25X_CHECKPOW_ETHASH(benchmark::Bench& bench) { CheckPow(bench, x25x::Algorithm::ETHASH); }
+static void X25X_CHECKPOW_RANDOMX(benchmark::Bench& bench) { CheckPow(bench, x25x::Algorithm::RANDOMX); }
+static void X25X_CHECKPOW_X11(benchmark::Bench& bench) { CheckPow(bench, x25x::Algorithm::X11); }
+static void X25X_CHECKPOW_KHEAVYHASH(benchmark::Bench& bench) { CheckPow(bench, x25x::Algorithm::KHEAVYHASH); }
+
+static void X25X_NEXT_WORK_REQUIRED(benchmark::Bench& bench)
+{
+    const auto chain_params = CChainParams::Main();
+    const Consensus::Params& params = chain_params->GetConsensus();
+
+    // 100k blocks with a skewed mix: mostly SHA256D and Scrypt, RandomX rare
+    std::vector<CBlockIndex> blocks(100000);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        x25x::Algorithm algo = (i % 97 == 5) ? x25x::Algorithm::RANDOMX :
+                               (i % 3 == 0) ? x25x::Algorithm::SCRYPT : x25x::Algorithm::SHA256D;
+        blocks[i].nHeight = i;
+        blocks[i].nTime = 1700000000 + i * 60 + (i % 7);
+        blocks[i].nBits = 0x1d00ffff;
+        blocks[i].nVersion = x25x::SetBlockAlgorithm(0x20000000, algo);
+        blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+        blocks[i].BuildSkip();
+    }
+
+    const std::vector<x25x::Algorithm> algos = x25x::GetEnabledAlgorithms();
+    bench.batch(algos.size()).unit("algorithm").run([&] {
+        for (x25x::Algorithm algo : algos) {
+            ankerl::nanobench::doNotOptimizeAway(x25x::GetNextWorkRequiredForAlgorithm(&blocks.back(), algo, params));
+        }
+    });
+}
+
+BENCHMARK(X25X_CHECKPOW_SHA256D, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_CHECKPOW_SCRYPT, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_CHECKPOW_ETHASH, benchmark::PriorityLevel::LOW);
+BENCHMARK(X25X_CHECKPOW_RANDOMX, benchmark::PriorityLevel::LOW);
+BENCHMARK(X25X_CHECKPOW_X11, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_CHECKPOW_KHEAVYHASH, benchmark::PriorityLevel::HIGH);
+BENCHMARK(X25X_NEXT_WORK_REQUIRED, benchmark::PriorityLevel::HIGH);
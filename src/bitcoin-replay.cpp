@@ -0,0 +1,304 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+//
+// wattx-replay reconnects a range of blocks of a copied datadir and reports
+// where the time went, so validation changes can be measured on real blocks
+// without running the P2P node.
+//
+// It is built with wattx-chainstate and, like it, is experimental.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <chainparamsbase.h>
+#include <common/args.h>
+#include <consensus/validation.h>
+#include <kernel/checks.h>
+#include <kernel/context.h>
+#include <kernel/notifications_interface.h>
+#include <kernel/warning.h>
+#include <logging.h>
+#include <node/blockmanager_args.h>
+#include <node/blockstorage.h>
+#include <node/caches.h>
+#include <node/chainstate.h>
+#include <node/chainstatemanager_args.h>
+#include <node/connect_stats.h>
+#include <node/wattx_state.h>
+#include <tinyformat.h>
+#include <util/signalinterrupt.h>
+#include <util/task_runner.h>
+#include <util/time.h>
+#include <util/translation.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using node::BlockConnectStats;
+using node::ConnectPhase;
+
+static constexpr int DEFAULT_SLOWEST{10};
+
+namespace {
+
+void SetupReplayArgs(ArgsManager& argsman)
+{
+    SetupHelpOptions(argsman);
+    SetupChainParamsBaseOptions(argsman);
+
+    argsman.AddArg("-datadir=<dir>", "Copy of a node's data directory. Its blocks are disconnected and connected again, so never point this at the datadir of a node in use", ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-from=<height>", "Last block kept connected; the replay starts with the block after it", ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-to=<height>", "Last block replayed (default: the tip of the datadir)", ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+    argsman.AddArg("-assumevalid=<hex>", "As for wattxd; pass 0 to verify the scripts of every replayed block (default: the chain's)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-dbcache=<n>", strprintf("As for wattxd, in MiB (default: %d)", DEFAULT_DB_CACHE >> 20), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-par=<n>", strprintf("As for wattxd (default: %d)", DEFAULT_SCRIPTCHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-printtoconsole", "Print the node's log to the console", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-slowest=<n>", strprintf("Number of slowest blocks listed (default: %d)", DEFAULT_SLOWEST), ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
+}
+
+class ReplayNotifications : public kernel::Notifications
+{
+public:
+    kernel::InterruptResult blockTip(SynchronizationState, CBlockIndex&) override { return {}; }
+    void headerTip(SynchronizationState, int64_t, int64_t, bool) override {}
+    void progress(const bilingual_str&, int, bool) override {}
+    void warningSet(kernel::Warning, const bilingual_str& message) override
+    {
+        tfm::format(std::cerr, "Warning: %s\n", message.original);
+    }
+    void warningUnset(kernel::Warning) override {}
+    void flushError(const bilingual_str& message) override
+    {
+        tfm::format(std::cerr, "Error flushing block data to disk: %s\n", message.original);
+    }
+    void fatalError(const bilingual_str& message) override
+    {
+        tfm::format(std::cerr, "Error: %s\n", message.original);
+    }
+};
+
+void PrintReport(const BlockConnectStats::Summary& summary, int blocks, uint64_t transactions, SteadyClock::duration wall)
+{
+    const double seconds{Ticks<SecondsDouble>(wall)};
+    tfm::format(std::cout, "Replayed %d blocks, %d transactions, in %.3fs: %.1f blocks/s, %.1f tx/s\n\n",
+                blocks, transactions, seconds, blocks / seconds, transactions / seconds);
+
+    const auto& total{summary.phases[node::CONNECT_PHASE_COUNT]};
+    tfm::format(std::cout, "%-12s %9s %9s %9s %9s %9s %6s\n", "phase (ms)", "mean", "p50", "p90", "p99", "max", "share");
+    for (size_t phase = 0; phase <= node::CONNECT_PHASE_COUNT; ++phase) {
+        const auto& stats{summary.phases[phase]};
+        const std::string name{phase < node::CONNECT_PHASE_COUNT ? node::ConnectPhaseName(static_cast<ConnectPhase>(phase)) : "total"};
+        tfm::format(std::cout, "%-12s %9.3f %9.3f %9.3f %9.3f %9.3f %5.1f%%\n", name,
+                    stats.mean_ms, stats.p50_ms, stats.p90_ms, stats.p99_ms, stats.max_ms,
+                    total.mean_ms > 0 ? 100 * stats.mean_ms / total.mean_ms : 0.0);
+    }
+    if (summary.window_blocks < static_cast<size_t>(blocks)) {
+        tfm::format(std::cout, "(percentiles over the last %d blocks)\n", summary.window_blocks);
+    }
+
+    if (summary.slowest.empty()) return;
+    tfm::format(std::cout, "\nSlowest blocks:\n");
+    for (const auto& times : summary.slowest) {
+        ConnectPhase slowest_phase{ConnectPhase::LOAD};
+        for (size_t phase = 0; phase < node::CONNECT_PHASE_COUNT; ++phase) {
+            if (times.phases[phase] > times.Get(slowest_phase)) slowest_phase = static_cast<ConnectPhase>(phase);
+        }
+        tfm::format(std::cout, "%8d %s %9.3fms, most in %s (%.3fms)\n", times.height, times.hash.ToString(),
+                    Ticks<MillisecondsDouble>(times.Total()), node::ConnectPhaseName(slowest_phase),
+                    Ticks<MillisecondsDouble>(times.Get(slowest_phase)));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    SetupReplayArgs(gArgs);
+    std::string error;
+    if (!gArgs.ParseParameters(argc, argv, error)) {
+        tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error);
+        return EXIT_FAILURE;
+    }
+    if (HelpRequested(gArgs) || !gArgs.IsArgSet("-datadir") || !gArgs.IsArgSet("-from")) {
+        std::cout << "Usage:  wattx-replay -datadir=<dir> -from=<height> [-to=<height>] [options]\n"
+                     "\n"
+                  << gArgs.GetHelpMessage()
+                  << "Description:\n"
+                     "\n"
+                     "  wattx-replay disconnects the blocks of a copied datadir down to -from and\n"
+                     "  connects them again up to -to, with the EVM, validator, trust and privacy\n"
+                     "  state set up as in wattxd. The blocks come from the datadir's own blk*.dat\n"
+                     "  files, which must hold them and their undo data, so the datadir must not be\n"
+                     "  pruned below -from. It reports the throughput and the time of each phase of\n"
+                     "  connecting a block, as getblockconnectstats does.\n"
+                     "\n"
+                     "  Blocks after -to are disconnected too and left to be connected again the\n"
+                     "  next time the datadir is used. Copy the datadir again for the next run.\n"
+                     "\n"
+                     "IMPORTANT: THIS EXECUTABLE IS EXPERIMENTAL, FOR TESTING ONLY, AND EXPECTED TO\n"
+                     "           BREAK IN FUTURE VERSIONS. DO NOT USE ON YOUR ACTUAL DATADIR.\n";
+        return HelpRequested(gArgs) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!CheckDataDirOption(gArgs)) {
+        tfm::format(std::cerr, "Error: Specified data directory \"%s\" does not exist.\n", gArgs.GetArg("-datadir", ""));
+        return EXIT_FAILURE;
+    }
+    try {
+        SelectParams(gArgs.GetChainType());
+    } catch (const std::exception& e) {
+        tfm::format(std::cerr, "Error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    const fs::path datadir{gArgs.GetDataDirNet()};
+
+    if (gArgs.GetBoolArg("-printtoconsole", false)) {
+        LogInstance().m_print_to_console = true;
+        LogInstance().m_print_to_file = false;
+        LogInstance().StartLogging();
+    } else {
+        LogInstance().DisableLogging();
+    }
+
+    kernel::Context kernel_context{};
+    if (auto result{kernel::SanityChecks(kernel_context)}; !result) {
+        tfm::format(std::cerr, "Error: %s\n", util::ErrorString(result).original);
+        return EXIT_FAILURE;
+    }
+
+    ValidationSignals validation_signals{std::make_unique<util::ImmediateTaskRunner>()};
+    ReplayNotifications notifications;
+    const auto [index_cache_sizes, kernel_cache_sizes] = node::CalculateCacheSizes(gArgs);
+
+    ChainstateManager::Options chainman_opts{
+        .chainparams = Params(),
+        .datadir = datadir,
+        .notifications = notifications,
+        .signals = &validation_signals,
+    };
+    node::BlockManager::Options blockman_opts{
+        .chainparams = chainman_opts.chainparams,
+        .blocks_dir = gArgs.GetBlocksDirPath(),
+        .notifications = chainman_opts.notifications,
+        .block_tree_db_params = DBParams{
+            .path = datadir / "blocks" / "index",
+            .cache_bytes = kernel_cache_sizes.block_tree_db,
+        },
+    };
+    if (auto result{node::ApplyArgsManOptions(gArgs, chainman_opts)}; !result) {
+        tfm::format(std::cerr, "Error: %s\n", util::ErrorString(result).original);
+        return EXIT_FAILURE;
+    }
+    if (auto result{node::ApplyArgsManOptions(gArgs, blockman_opts)}; !result) {
+        tfm::format(std::cerr, "Error: %s\n", util::ErrorString(result).original);
+        return EXIT_FAILURE;
+    }
+    util::SignalInterrupt interrupt;
+    ChainstateManager chainman{interrupt, chainman_opts, blockman_opts};
+    int exit_status{EXIT_FAILURE};
+
+    // Keep the datadir's EVM log indexes, loading without them would wipe them
+    bool logevents{DEFAULT_LOGEVENTS};
+    chainman.m_blockman.m_block_tree_db->ReadFlag("logevents", logevents);
+    node::ChainstateLoadOptions options;
+    options.logevents = logevents;
+    options.check_blocks = 0;
+
+    std::unique_ptr<Chainstate> no_chainstate;
+    CBlockIndex* first{nullptr};
+    CBlockIndex* after{nullptr};
+    int blocks{0};
+    uint64_t transactions{0};
+    auto [status, load_error] = node::LoadChainstate(chainman, kernel_cache_sizes, options);
+    if (status != node::ChainstateLoadStatus::SUCCESS) {
+        tfm::format(std::cerr, "Error: failed to load the chainstate: %s\n", load_error.original);
+        goto epilogue;
+    }
+    if (auto result{node::InitWattxState(chainman, datadir, {.curve_tree_cache = index_cache_sizes.curve_tree})}; !result) {
+        tfm::format(std::cerr, "Error: %s\n", util::ErrorString(result).original);
+        goto epilogue;
+    }
+
+    {
+        LOCK(cs_main);
+        const CChain& chain{chainman.ActiveChain()};
+        const int tip{chain.Height()};
+        const int64_t from{gArgs.GetIntArg("-from", 0)};
+        const int64_t to{gArgs.GetIntArg("-to", tip)};
+        if (chainman.IsSnapshotActive()) {
+            tfm::format(std::cerr, "Error: the datadir uses an assumeutxo snapshot\n");
+            goto epilogue;
+        }
+        if (from < 0 || to <= from || to > tip) {
+            tfm::format(std::cerr, "Error: the range %d to %d must lie within the connected chain, 0 to %d\n", from, to, tip);
+            goto epilogue;
+        }
+        for (int height = from + 1; height <= tip; ++height) {
+            if (!(chain[height]->nStatus & BLOCK_HAVE_DATA) || !(chain[height]->nStatus & BLOCK_HAVE_UNDO)) {
+                tfm::format(std::cerr, "Error: block %d or its undo data is missing, the datadir is pruned\n", height);
+                goto epilogue;
+            }
+        }
+        first = chain[from + 1];
+        after = to < tip ? chain[to + 1] : nullptr;
+        blocks = to - from;
+        for (int height = from + 1; height <= to; ++height) transactions += chain[height]->nTx;
+    }
+
+    {
+        Chainstate& chainstate{chainman.ActiveChainstate()};
+        BlockValidationState state;
+        tfm::format(std::cout, "Disconnecting blocks down to %d...\n", first->nHeight - 1);
+        if (!chainstate.InvalidateBlock(state, first)) {
+            tfm::format(std::cerr, "Error: failed to disconnect the blocks: %s\n", state.ToString());
+            goto epilogue;
+        }
+        {
+            LOCK(cs_main);
+            chainstate.ResetBlockFailureFlags(first);
+        }
+        // Park the blocks after the range so connecting stops at its end
+        if (after && !chainstate.InvalidateBlock(state, after)) {
+            tfm::format(std::cerr, "Error: failed to mark the end of the range: %s\n", state.ToString());
+            goto epilogue;
+        }
+
+        tfm::format(std::cout, "Connecting blocks %d to %d...\n", first->nHeight, first->nHeight + blocks - 1);
+        node::g_block_connect_stats.Reset();
+        const auto start{SteadyClock::now()};
+        if (!chainstate.ActivateBestChain(state, nullptr)) {
+            tfm::format(std::cerr, "Error: failed to connect the blocks: %s\n", state.ToString());
+            goto epilogue;
+        }
+        const auto wall{SteadyClock::now() - start};
+        if (WITH_LOCK(cs_main, return chainstate.m_chain.Height()) != first->nHeight + blocks - 1) {
+            tfm::format(std::cerr, "Error: stopped at block %d\n", WITH_LOCK(cs_main, return chainstate.m_chain.Height()));
+            goto epilogue;
+        }
+        PrintReport(node::g_block_connect_stats.GetSummary(gArgs.GetIntArg("-slowest", DEFAULT_SLOWEST)), blocks, transactions, wall);
+        exit_status = EXIT_SUCCESS;
+    }
+
+epilogue:
+    // Leave the blocks after the range to be connected the next time
+    if (after) {
+        LOCK(cs_main);
+        chainman.ActiveChainstate().ResetBlockFailureFlags(after);
+    }
+    validation_signals.FlushBackgroundCallbacks();
+    {
+        LOCK(cs_main);
+        for (Chainstate* chainstate : chainman.GetAll()) {
+            if (chainstate->CanFlushToDisk()) {
+                chainstate->ForceFlushStateToDisk();
+                chainstate->ResetCoinsViews();
+            }
+        }
+        node::UnloadEvmState();
+    }
+    node::ShutdownWattxState();
+    return exit_status;
+}
@@ -19,13 +19,20 @@
 
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce) :
         nonce(nonce),
-        shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
+        header(block) {
     FillShortTxIDSelector();
     //TODO: Use our mempool prior to block acceptance to predictively fill more than just the coinbase
+    // The coinstake of a PoS block is never in the receiver's mempool, so send it along with the
+    // coinbase rather than costing every receiver a getblocktxn round trip.
+    const size_t prefilled{block.IsProofOfStake() && block.vtx.size() > 1 ? 2U : 1U};
+    prefilledtxn.resize(prefilled);
+    shorttxids.resize(block.vtx.size() - prefilled);
     prefilledtxn[0] = {0, block.vtx[0]};
-    for (size_t i = 1; i < block.vtx.size(); i++) {
+    // Prefilled indexes are differentially encoded
+    if (prefilled > 1) prefilledtxn[1] = {0, block.vtx[1]};
+    for (size_t i = prefilled; i < block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
-        shorttxids[i - 1] = GetShortID(tx.GetWitnessHash());
+        shorttxids[i - prefilled] = GetShortID(tx.GetWitnessHash());
     }
 }
 
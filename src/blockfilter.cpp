@@ -20,6 +20,7 @@ using util::Join;
 
 static const std::map<BlockFilterType, std::string> g_filter_types = {
     {BlockFilterType::BASIC, "basic"},
+    {BlockFilterType::EVM_LOG, "evmlog"},
 };
 
 uint64_t GCSFilter::HashToRange(const Element& element) const
@@ -224,13 +225,27 @@ BlockFilter::BlockFilter(BlockFilterType filter_type, const CBlock& block, const
     if (!BuildParams(params)) {
         throw std::invalid_argument("unknown filter_type");
     }
+    if (filter_type != BlockFilterType::BASIC) {
+        throw std::invalid_argument("filter_type is not built from block data");
+    }
     m_filter = GCSFilter(params, BasicFilterElements(block, block_undo));
 }
 
+BlockFilter::BlockFilter(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& elements)
+    : m_filter_type(filter_type), m_block_hash(block_hash)
+{
+    GCSFilter::Params params;
+    if (!BuildParams(params)) {
+        throw std::invalid_argument("unknown filter_type");
+    }
+    m_filter = GCSFilter(params, elements);
+}
+
 bool BlockFilter::BuildParams(GCSFilter::Params& params) const
 {
     switch (m_filter_type) {
     case BlockFilterType::BASIC:
+    case BlockFilterType::EVM_LOG:
         params.m_siphash_k0 = m_block_hash.GetUint64(0);
         params.m_siphash_k1 = m_block_hash.GetUint64(1);
         params.m_P = BASIC_FILTER_P;
@@ -92,6 +92,7 @@ constexpr uint32_t BASIC_FILTER_M = 784931;
 enum class BlockFilterType : uint8_t
 {
     BASIC = 0,
+    EVM_LOG = 1, //!< contract addresses and topics of the EVM logs of a block
     INVALID = 255,
 };
 
@@ -131,6 +132,9 @@ public:
     //! Construct a new BlockFilter of the specified type from a block.
     BlockFilter(BlockFilterType filter_type, const CBlock& block, const CBlockUndo& block_undo);
 
+    //! Construct a new BlockFilter from elements gathered outside the block, like EVM logs.
+    BlockFilter(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& elements);
+
     BlockFilterType GetFilterType() const { return m_filter_type; }
     const uint256& GetBlockHash() const LIFETIMEBOUND { return m_block_hash; }
     const GCSFilter& GetFilter() const LIFETIMEBOUND { return m_filter; }
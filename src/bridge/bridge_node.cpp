@@ -3,21 +3,24 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bridge/bridge_node.h>
+#include <chain.h>
 #include <crypto/sha256.h>
+#include <dbwrapper.h>
 #include <hash.h>
+#include <kernel/chain.h>
 #include <logging.h>
+#include <primitives/block.h>
 #include <random.h>
 #include <span.h>
+#include <stratum/rpc_client.h>
+#include <univalue.h>
 #include <util/strencodings.h>
 #include <util/time.h>
+#include <validationinterface.h>
 
 #include <algorithm>
 #include <cstring>
-#include <netdb.h>
-#include <netinet/in.h>
 #include <sstream>
-#include <sys/socket.h>
-#include <unistd.h>
 
 namespace bridge {
 
@@ -31,6 +34,59 @@ BridgeNode& GetBridgeNode() {
     return g_bridge_node;
 }
 
+// ============================================================================
+// Batch Policy
+// ============================================================================
+
+BatchFlush CheckBatchFlush(const BridgeConfig& config, size_t size, int64_t age, int64_t& wait) {
+    const int64_t interval = std::max(config.batch_interval, 1);
+    wait = interval;
+    if (size == 0) return BatchFlush::NONE;
+
+    if (size >= config.batch_max_transactions) return BatchFlush::SIZE;
+
+    // A commitment costs about the same whatever the batch size, share it out
+    wait = std::max<int64_t>(interval - age, 0);
+    if (config.batch_commit_fee > 0 && size * config.batch_target_fee_per_tx >= config.batch_commit_fee) {
+        if (age >= config.batch_min_interval) return BatchFlush::FEE;
+        wait = std::min<int64_t>(wait, config.batch_min_interval - age);
+    }
+
+    if (wait == 0) return BatchFlush::AGE;
+    return BatchFlush::NONE;
+}
+
+static const char* BatchFlushName(BatchFlush reason) {
+    switch (reason) {
+    case BatchFlush::NONE: return "forced";
+    case BatchFlush::SIZE: return "size";
+    case BatchFlush::FEE: return "fee";
+    case BatchFlush::AGE: return "age";
+    }
+    return "";
+}
+
+// ============================================================================
+// Chain Notifications
+// ============================================================================
+
+/**
+ * Hands the blocks connected to the active chain to the bridge
+ */
+class WattxBlockListener final : public CValidationInterface {
+public:
+    explicit WattxBlockListener(BridgeNode& bridge) : m_bridge(bridge) {}
+
+protected:
+    void BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override {
+        if (role == ChainstateRole::BACKGROUND) return;
+        m_bridge.ProcessWattxBlock(*block, pindex->nHeight);
+    }
+
+private:
+    BridgeNode& m_bridge;
+};
+
 // ============================================================================
 // BridgeNode Implementation
 // ============================================================================
@@ -41,21 +97,87 @@ BridgeNode::~BridgeNode() {
     Stop();
 }
 
-bool BridgeNode::Start(const BridgeConfig& config) {
+bool BridgeNode::Start(const BridgeConfig& config, ValidationSignals& signals) {
     if (m_running.load()) {
         LogPrintf("BridgeNode: Already running\n");
         return false;
     }
 
     m_config = config;
+
+    try {
+        m_store.reset();
+        m_store = std::make_unique<BridgeStore>(m_config.data_dir / "bridge", m_config.db_cache_bytes,
+                                                /*memory_only=*/m_config.data_dir.empty());
+    } catch (const dbwrapper_error& e) {
+        LogPrintf("BridgeNode: Failed to open the bridge database: %s\n", e.what());
+        return false;
+    }
+
+    // Load the open state, the closed one stays in the store
+    {
+        std::lock_guard<std::mutex> lock(m_tx_mutex);
+        m_pending_txs.clear();
+        for (PendingTransaction& tx : m_store->ReadOpenTransactions()) {
+            m_pending_txs.emplace(tx.tx_hash, std::move(tx));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_swap_mutex);
+        m_swaps.clear();
+        m_swap_deadlines = {};
+        m_swaps_awaiting_monero.clear();
+        for (AtomicSwap& swap : m_store->ReadActiveSwaps()) {
+            m_swap_deadlines.emplace(swap.timelock, swap.swap_id);
+            if (!swap.monero_lock_txid.empty() && !swap.monero_side_complete) {
+                m_swaps_awaiting_monero.insert(swap.swap_id);
+            }
+            m_swaps.emplace(swap.swap_id, std::move(swap));
+        }
+    }
+    LogPrintf("BridgeNode: Loaded %zu open transactions, %zu active swaps\n", GetPendingCount(), m_swap_deadlines.size());
+    uint64_t wattx_height = 0, monero_height = 0;
+    if (m_store->ReadHeights(wattx_height, monero_height)) {
+        m_wattx_height = wattx_height;
+        m_monero_height = monero_height;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_batch_mutex);
+        TransactionBatch logged;
+        if (m_store->ReadBatchCommitLog(logged)) {
+            // A crash interrupted the commit of this batch, submit it again
+            LogPrintf("BridgeNode: Finishing the commit of batch %lu\n", logged.batch_id);
+            m_current_batch = std::move(logged);
+            SubmitBatchToWattx();
+            FinishBatch();
+        } else if (!m_store->ReadCurrentBatch(m_current_batch, m_merkle)) {
+            m_current_batch = TransactionBatch{};
+            m_current_batch.batch_id = 0;
+            m_current_batch.created_at = GetTime();
+            m_merkle = IncrementalMerkle{};
+        }
+    }
+
     m_running.store(true);
 
-    // Initialize current batch
-    m_current_batch.batch_id = 0;
-    m_current_batch.created_at = GetTime();
+    // Follow WATTx blocks in-process
+    m_signals = &signals;
+    m_wattx_listener = std::make_shared<WattxBlockListener>(*this);
+    m_signals->RegisterSharedValidationInterface(m_wattx_listener);
+
+    // Have monerod announce its blocks, the monitor thread polls less then
+    if (!m_config.monero_zmq_endpoint.empty()) {
+        m_monero_subscriber.Start("bridge-monero", m_config.monero_zmq_endpoint, stratum::MONERO_ZMQ_BLOCK_TOPIC, [this] {
+            {
+                std::lock_guard<std::mutex> lock(m_cv_mutex);
+                ++m_monero_notifications;
+            }
+            m_cv.notify_all();
+        });
+    }
 
     // Start worker threads
-    m_wattx_monitor_thread = std::thread(&BridgeNode::WattxMonitorThread, this);
     m_monero_monitor_thread = std::thread(&BridgeNode::MoneroMonitorThread, this);
     m_batch_processor_thread = std::thread(&BridgeNode::BatchProcessorThread, this);
     m_swap_monitor_thread = std::thread(&BridgeNode::SwapMonitorThread, this);
@@ -63,6 +185,8 @@ bool BridgeNode::Start(const BridgeConfig& config) {
     LogPrintf("BridgeNode: Started\n");
     LogPrintf("BridgeNode: WATTx RPC: %s:%d\n", m_config.wattx_rpc_host, m_config.wattx_rpc_port);
     LogPrintf("BridgeNode: Monero daemon: %s:%d\n", m_config.monero_daemon_host, m_config.monero_daemon_port);
+    LogPrintf("BridgeNode: Monero block notifications: %s\n",
+              m_monero_subscriber.IsRunning() ? m_config.monero_zmq_endpoint : "disabled, polling");
     LogPrintf("BridgeNode: Validator mode: %s\n", m_config.is_validator ? "enabled" : "disabled");
 
     return true;
@@ -72,17 +196,26 @@ void BridgeNode::Stop() {
     if (!m_running.load()) return;
 
     LogPrintf("BridgeNode: Stopping...\n");
-    m_running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(m_cv_mutex);
+        m_running.store(false);
+    }
 
     // Wake up any waiting threads
     m_cv.notify_all();
 
+    if (m_signals && m_wattx_listener) m_signals->UnregisterSharedValidationInterface(m_wattx_listener);
+    m_wattx_listener.reset();
+    m_signals = nullptr;
+    m_monero_subscriber.Stop();
+
     // Join all threads
-    if (m_wattx_monitor_thread.joinable()) m_wattx_monitor_thread.join();
     if (m_monero_monitor_thread.joinable()) m_monero_monitor_thread.join();
     if (m_batch_processor_thread.joinable()) m_batch_processor_thread.join();
     if (m_swap_monitor_thread.joinable()) m_swap_monitor_thread.join();
 
+    m_store->WriteHeights(m_wattx_height, m_monero_height);
+
     LogPrintf("BridgeNode: Stopped\n");
 }
 
@@ -114,19 +247,40 @@ uint256 BridgeNode::SubmitTransaction(const std::string& from_chain,
     tx.destination = destination;
     tx.created_at = now;
     tx.confirmed_at = 0;
+    tx.start_height = from_chain == "monero" ? m_monero_height.load() : m_wattx_height.load();
     tx.confirmations = 0;
     tx.completed = false;
     tx.refunded = false;
 
+    // Add to current batch, the transaction and the batch are written together
+    bool wake_batcher;
     {
-        std::lock_guard<std::mutex> lock(m_tx_mutex);
-        m_pending_txs[tx_hash] = tx;
+        std::lock_guard<std::mutex> lock(m_batch_mutex);
+        if (m_current_batch.tx_hashes.empty()) m_current_batch.created_at = now;
+        m_current_batch.tx_hashes.push_back(tx_hash);
+        m_merkle.Append(tx_hash);
+        if (m_store) m_store->AddTransaction(tx, m_current_batch, m_merkle);
+
+        // The batch processor waits for the batch to come due, which this may have brought forward
+        int64_t wait, previous_wait;
+        const size_t size = m_current_batch.tx_hashes.size();
+        const int64_t age = now - m_current_batch.created_at;
+        wake_batcher = size == 1 ||
+                       CheckBatchFlush(m_config, size, age, wait) != BatchFlush::NONE ||
+                       CheckBatchFlush(m_config, size - 1, age, previous_wait) != BatchFlush::NONE ||
+                       wait != previous_wait;
+    }
+    if (wake_batcher) {
+        {
+            std::lock_guard<std::mutex> lock(m_cv_mutex);
+            ++m_batch_changes;
+        }
+        m_cv.notify_all();
     }
 
-    // Add to current batch
     {
-        std::lock_guard<std::mutex> lock(m_batch_mutex);
-        m_current_batch.tx_hashes.push_back(tx_hash);
+        std::lock_guard<std::mutex> lock(m_tx_mutex);
+        m_pending_txs[tx_hash] = tx;
     }
 
     m_total_transactions++;
@@ -138,34 +292,36 @@ uint256 BridgeNode::SubmitTransaction(const std::string& from_chain,
 }
 
 PendingTransaction BridgeNode::GetTransaction(const uint256& tx_hash) {
-    std::lock_guard<std::mutex> lock(m_tx_mutex);
-    auto it = m_pending_txs.find(tx_hash);
-    if (it != m_pending_txs.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock(m_tx_mutex);
+        auto it = m_pending_txs.find(tx_hash);
+        if (it != m_pending_txs.end()) {
+            return it->second;
+        }
     }
-    return PendingTransaction{};
+    PendingTransaction tx{};
+    if (m_store) m_store->ReadTransaction(tx_hash, tx);
+    return tx;
 }
 
 std::vector<PendingTransaction> BridgeNode::GetPendingTransactions() {
     std::lock_guard<std::mutex> lock(m_tx_mutex);
     std::vector<PendingTransaction> result;
+    result.reserve(m_pending_txs.size());
     for (const auto& [hash, tx] : m_pending_txs) {
-        if (!tx.completed && !tx.refunded) {
-            result.push_back(tx);
-        }
+        result.push_back(tx);
     }
     return result;
 }
 
+std::vector<uint256> BridgeNode::GetTransactionsByDestination(const std::string& destination) {
+    if (!m_store) return {};
+    return m_store->ReadTransactionsByDestination(destination);
+}
+
 uint64_t BridgeNode::GetPendingCount() const {
     std::lock_guard<std::mutex> lock(m_tx_mutex);
-    uint64_t count = 0;
-    for (const auto& [hash, tx] : m_pending_txs) {
-        if (!tx.completed && !tx.refunded) {
-            count++;
-        }
-    }
-    return count;
+    return m_pending_txs.size();
 }
 
 // ============================================================================
@@ -206,6 +362,8 @@ uint256 BridgeNode::InitiateSwap(uint64_t wtx_amount, const std::string& xmr_des
     {
         std::lock_guard<std::mutex> lock(m_swap_mutex);
         m_swaps[swap_id] = swap;
+        m_swap_deadlines.emplace(swap.timelock, swap_id);
+        if (m_store) m_store->WriteSwap(swap);
     }
 
     // Create HTLC on WATTx chain
@@ -217,13 +375,20 @@ uint256 BridgeNode::InitiateSwap(uint64_t wtx_amount, const std::string& xmr_des
 
     m_total_swaps++;
 
+    // Wake the swap monitor for the new timelock
+    {
+        std::lock_guard<std::mutex> lock(m_cv_mutex);
+        ++m_swap_changes;
+    }
+    m_cv.notify_all();
+
     LogPrintf("BridgeNode: Initiated swap %s (WTX: %lu -> XMR: %s)\n",
               swap_id.GetHex().substr(0, 16), wtx_amount, xmr_destination.substr(0, 16));
 
     return swap_id;
 }
 
-bool BridgeNode::ParticipateSwap(const uint256& swap_id, uint64_t xmr_amount) {
+bool BridgeNode::ParticipateSwap(const uint256& swap_id, uint64_t xmr_amount, const std::string& monero_lock_txid) {
     std::lock_guard<std::mutex> lock(m_swap_mutex);
     auto it = m_swaps.find(swap_id);
     if (it == m_swaps.end()) {
@@ -244,6 +409,13 @@ bool BridgeNode::ParticipateSwap(const uint256& swap_id, uint64_t xmr_amount) {
         return false;
     }
 
+    // Watch the lock transaction on each Monero block
+    if (!monero_lock_txid.empty()) {
+        swap.monero_lock_txid = monero_lock_txid;
+        if (m_store) m_store->WriteSwap(swap);
+        m_swaps_awaiting_monero.insert(swap_id);
+    }
+
     LogPrintf("BridgeNode: Participated in swap %s (XMR: %lu)\n",
               swap_id.GetHex().substr(0, 16), xmr_amount);
 
@@ -276,6 +448,9 @@ bool BridgeNode::ClaimSwap(const uint256& swap_id, const uint256& preimage) {
 
     swap.preimage = preimage;
     swap.state = "claimed";
+    if (m_store) m_store->WriteSwap(swap);
+    m_swaps_awaiting_monero.erase(swap_id);
+    m_swaps.erase(it);
 
     // Call claim on both chains' contracts
     // ... (would interact with contracts via RPC)
@@ -303,6 +478,9 @@ bool BridgeNode::RefundSwap(const uint256& swap_id) {
     }
 
     swap.state = "refunded";
+    if (m_store) m_store->WriteSwap(swap);
+    m_swaps_awaiting_monero.erase(swap_id);
+    m_swaps.erase(it);
 
     // Call refund on contracts
     // ... (would interact with contracts via RPC)
@@ -313,12 +491,16 @@ bool BridgeNode::RefundSwap(const uint256& swap_id) {
 }
 
 AtomicSwap BridgeNode::GetSwap(const uint256& swap_id) {
-    std::lock_guard<std::mutex> lock(m_swap_mutex);
-    auto it = m_swaps.find(swap_id);
-    if (it != m_swaps.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock(m_swap_mutex);
+        auto it = m_swaps.find(swap_id);
+        if (it != m_swaps.end()) {
+            return it->second;
+        }
     }
-    return AtomicSwap{};
+    AtomicSwap swap{};
+    if (m_store) m_store->ReadSwap(swap_id, swap);
+    return swap;
 }
 
 // ============================================================================
@@ -330,6 +512,12 @@ TransactionBatch BridgeNode::GetCurrentBatch() {
     return m_current_batch;
 }
 
+std::optional<TransactionBatch> BridgeNode::GetBatch(uint64_t batch_id) {
+    TransactionBatch batch;
+    if (!m_store || !m_store->ReadBatch(batch_id, batch)) return std::nullopt;
+    return batch;
+}
+
 bool BridgeNode::CommitBatch() {
     if (!m_config.is_validator) {
         LogPrintf("BridgeNode: Only validators can commit batches\n");
@@ -343,30 +531,55 @@ bool BridgeNode::CommitBatch() {
         return false;
     }
 
-    CreateBatch();
+    CreateBatch(BatchFlush::NONE);
     return true;
 }
 
-void BridgeNode::CreateBatch() {
-    // Calculate merkle root
-    m_current_batch.merkle_root = ComputeMerkleRoot(m_current_batch.tx_hashes);
+std::optional<BatchInclusionProof> BridgeNode::GetInclusionProof(const uint256& tx_hash) {
+    if (!m_store) return std::nullopt;
+
+    BatchInclusionProof proof;
+    TransactionBatch batch;
+    if (!m_store->ReadInclusionProof(tx_hash, proof.batch_id, proof.branch) ||
+        !m_store->ReadBatch(proof.batch_id, batch)) {
+        return std::nullopt;
+    }
+    proof.merkle_root = batch.merkle_root;
+    proof.committed_to_wattx = batch.committed_to_wattx;
+    return proof;
+}
+
+void BridgeNode::CreateBatch(BatchFlush reason) {
+    // The merkle root grew with the batch
+    m_current_batch.merkle_root = m_merkle.Root();
     m_current_batch.committed_at = GetTime();
 
+    // Log the batch before it leaves the node, a restart submits it again
+    m_store->LogBatchCommit(m_current_batch);
+
     // Submit to WATTx contract
     SubmitBatchToWattx();
 
-    // Store in committed batches
-    m_committed_batches.push_back(m_current_batch);
+    LogPrintf("BridgeNode: Batch %lu due by %s\n", m_current_batch.batch_id, BatchFlushName(reason));
+    FinishBatch();
+}
 
+void BridgeNode::FinishBatch() {
     LogPrintf("BridgeNode: Committed batch %lu with %zu transactions, merkle root: %s\n",
               m_current_batch.batch_id,
               m_current_batch.tx_hashes.size(),
               m_current_batch.merkle_root.GetHex().substr(0, 16));
 
     // Start new batch
-    m_current_batch = TransactionBatch{};
-    m_current_batch.batch_id = m_committed_batches.back().batch_id + 1;
-    m_current_batch.created_at = GetTime();
+    TransactionBatch next{};
+    next.batch_id = m_current_batch.batch_id + 1;
+    next.created_at = GetTime();
+
+    // Store the committed batch and drop its log
+    m_store->FinishBatchCommit(m_current_batch, next);
+
+    m_current_batch = std::move(next);
+    m_merkle = IncrementalMerkle{};
 }
 
 uint256 BridgeNode::ComputeMerkleRoot(const std::vector<uint256>& hashes) {
@@ -432,43 +645,10 @@ void BridgeNode::ConfirmBatchOnMonero() {
 // Worker Threads
 // ============================================================================
 
-void BridgeNode::WattxMonitorThread() {
-    LogPrintf("BridgeNode: WATTx monitor thread started\n");
-
-    while (m_running.load()) {
-        // Get current block height
-        std::string result = WattxRPC("getblockcount", "[]");
-
-        if (!result.empty()) {
-            // Parse height from result
-            // For simplicity, assume JSON parsing here
-            uint64_t height = 0;
-            size_t pos = result.find("result");
-            if (pos != std::string::npos) {
-                pos = result.find(":", pos);
-                if (pos != std::string::npos) {
-                    height = std::stoull(result.substr(pos + 1));
-                }
-            }
-
-            if (height > m_wattx_height) {
-                for (uint64_t h = m_wattx_height + 1; h <= height; h++) {
-                    ProcessWattxBlock(h);
-                }
-                m_wattx_height = height;
-            }
-        }
-
-        // Sleep for 10 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(10));
-    }
-
-    LogPrintf("BridgeNode: WATTx monitor thread stopped\n");
-}
-
 void BridgeNode::MoneroMonitorThread() {
     LogPrintf("BridgeNode: Monero monitor thread started\n");
 
+    uint64_t notifications = 0;
     while (m_running.load()) {
         // Get current block height
         std::string result = MoneroRPC("get_block_count", "{}");
@@ -484,16 +664,28 @@ void BridgeNode::MoneroMonitorThread() {
                 }
             }
 
-            if (height > m_monero_height) {
+            // Follow the chain from where it was when the bridge started
+            if (m_monero_height == 0) {
+                m_monero_height = height;
+            } else if (height > m_monero_height) {
                 for (uint64_t h = m_monero_height + 1; h <= height; h++) {
                     ProcessMoneroBlock(h);
                 }
                 m_monero_height = height;
+                ConfirmBatchOnMonero();
+                UpdateTransactionConfirmations("monero", height);
+                CheckMoneroSwapLocks(height);
+                m_store->WriteHeights(m_wattx_height, m_monero_height);
             }
         }
 
-        // Sleep for 30 seconds (Monero has ~2 min blocks)
-        std::this_thread::sleep_for(std::chrono::seconds(30));
+        // Wait for the next block notification, polling only to catch up on lost ones
+        std::unique_lock<std::mutex> lock(m_cv_mutex);
+        const std::chrono::seconds interval = m_monero_subscriber.IsRunning() ? MONERO_NOTIFIED_POLL_INTERVAL : MONERO_POLL_INTERVAL;
+        m_cv.wait_for(lock, interval, [&] {
+            return !m_running.load() || m_monero_notifications != notifications;
+        });
+        notifications = m_monero_notifications;
     }
 
     LogPrintf("BridgeNode: Monero monitor thread stopped\n");
@@ -502,26 +694,26 @@ void BridgeNode::MoneroMonitorThread() {
 void BridgeNode::BatchProcessorThread() {
     LogPrintf("BridgeNode: Batch processor thread started\n");
 
+    uint64_t changes = 0;
     while (m_running.load()) {
-        // Check if batch interval has passed
-        {
+        // Commit the batch once it is full, fee-efficient or old enough
+        int64_t wait = std::max(m_config.batch_interval, 1);
+        if (m_config.is_validator) {
             std::lock_guard<std::mutex> lock(m_batch_mutex);
-            int64_t now = GetTime();
-
-            if (m_config.is_validator &&
-                !m_current_batch.tx_hashes.empty() &&
-                now - m_current_batch.created_at >= m_config.batch_interval) {
-
-                CreateBatch();
+            const int64_t age = GetTime() - m_current_batch.created_at;
+            const BatchFlush reason = CheckBatchFlush(m_config, m_current_batch.tx_hashes.size(), age, wait);
+            if (reason != BatchFlush::NONE) {
+                CreateBatch(reason);
+                wait = 0;
             }
         }
 
-        // Update confirmations for pending batches
-        ConfirmBatchOnMonero();
-
-        // Sleep for batch interval
+        // Wait for the batch to come due, or for a submission to bring it forward
         std::unique_lock<std::mutex> lock(m_cv_mutex);
-        m_cv.wait_for(lock, std::chrono::seconds(60));
+        m_cv.wait_for(lock, std::chrono::seconds(wait), [&] {
+            return !m_running.load() || m_batch_changes != changes;
+        });
+        changes = m_batch_changes;
     }
 
     LogPrintf("BridgeNode: Batch processor thread stopped\n");
@@ -530,27 +722,33 @@ void BridgeNode::BatchProcessorThread() {
 void BridgeNode::SwapMonitorThread() {
     LogPrintf("BridgeNode: Swap monitor thread started\n");
 
+    uint64_t changes = 0;
     while (m_running.load()) {
-        MonitorSwapTimeouts();
+        // Sleep until the next active swap expires, or a swap is added
+        std::chrono::seconds wait = std::chrono::hours(1);
+        if (const std::optional<int64_t> next = MonitorSwapTimeouts()) {
+            wait = std::min(wait, std::chrono::seconds(std::max<int64_t>(*next - GetTime(), 0)));
+        }
 
-        // Sleep for 30 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(30));
+        std::unique_lock<std::mutex> lock(m_cv_mutex);
+        m_cv.wait_for(lock, wait, [&] {
+            return !m_running.load() || m_swap_changes != changes;
+        });
+        changes = m_swap_changes;
     }
 
     LogPrintf("BridgeNode: Swap monitor thread stopped\n");
 }
 
-void BridgeNode::ProcessWattxBlock(uint64_t height) {
-    // Get block at height and process relevant transactions
-    // Look for:
+void BridgeNode::ProcessWattxBlock(const CBlock& block, uint64_t height) {
+    // Look in the block's transactions for:
     // - Bridge contract events
     // - Atomic swap contract events
 
-    std::ostringstream params;
-    params << "[" << height << "]";
-    std::string result = WattxRPC("getblockhash", params.str());
+    m_wattx_height = height;
+    UpdateTransactionConfirmations("wattx", height);
+    if (m_store) m_store->WriteHeights(m_wattx_height, m_monero_height);
 
-    // Process transactions...
     LogPrintf("BridgeNode: Processed WATTx block %lu\n", height);
 }
 
@@ -566,32 +764,100 @@ void BridgeNode::ProcessMoneroBlock(uint64_t height) {
     LogPrintf("BridgeNode: Processed Monero block %lu\n", height);
 }
 
-void BridgeNode::UpdateTransactionConfirmations() {
+void BridgeNode::UpdateTransactionConfirmations(const std::string& chain, uint64_t height) {
+    const int threshold = chain == "wattx" ? m_config.wattx_confirmations : m_config.confirmation_threshold;
+
     std::lock_guard<std::mutex> lock(m_tx_mutex);
 
-    for (auto& [hash, tx] : m_pending_txs) {
-        if (tx.completed || tx.refunded) continue;
+    for (auto it = m_pending_txs.begin(); it != m_pending_txs.end();) {
+        PendingTransaction& tx = it->second;
+        if (tx.from_chain != chain) {
+            ++it;
+            continue;
+        }
 
-        // Update confirmations based on chain
-        // Mark as completed if enough confirmations
-        if (tx.confirmations >= m_config.confirmation_threshold) {
-            tx.completed = true;
-            LogPrintf("BridgeNode: Transaction %s completed with %d confirmations\n",
-                      hash.GetHex().substr(0, 16), tx.confirmations);
+        // Blocks of the source chain since the transaction was submitted
+        tx.confirmations = height > tx.start_height ? height - tx.start_height : 0;
+        if (tx.confirmations < threshold) {
+            ++it;
+            continue;
         }
+
+        tx.completed = true;
+        tx.confirmed_at = GetTime();
+        LogPrintf("BridgeNode: Transaction %s completed with %d confirmations\n",
+                  it->first.GetHex().substr(0, 16), tx.confirmations);
+
+        // Completed transactions are only kept in the store
+        if (m_store) m_store->WriteTransaction(tx);
+        it = m_pending_txs.erase(it);
     }
 }
 
-void BridgeNode::MonitorSwapTimeouts() {
+std::optional<int64_t> BridgeNode::MonitorSwapTimeouts() {
     std::lock_guard<std::mutex> lock(m_swap_mutex);
     int64_t now = GetTime();
 
-    for (auto& [id, swap] : m_swaps) {
-        if (swap.state == "active" && now >= swap.timelock) {
-            LogPrintf("BridgeNode: Swap %s timed out\n", id.GetHex().substr(0, 16));
-            // Would trigger refund process
+    // Only the swaps whose timelock has passed come off the heap, each once
+    while (!m_swap_deadlines.empty() && m_swap_deadlines.top().first <= now) {
+        const auto [timelock, id] = m_swap_deadlines.top();
+        m_swap_deadlines.pop();
+        if (!m_swaps.contains(id)) continue; // claimed or refunded since
+
+        LogPrintf("BridgeNode: Swap %s timed out\n", id.GetHex().substr(0, 16));
+        // Would trigger refund process
+    }
+
+    if (m_swap_deadlines.empty()) return std::nullopt;
+    return m_swap_deadlines.top().first;
+}
+
+void BridgeNode::CheckMoneroSwapLocks(uint64_t height) {
+    std::vector<std::pair<uint256, std::string>> locks;
+    {
+        std::lock_guard<std::mutex> lock(m_swap_mutex);
+        for (const uint256& id : m_swaps_awaiting_monero) {
+            locks.emplace_back(id, m_swaps.at(id).monero_lock_txid);
+        }
+    }
+    if (locks.empty()) return;
+
+    // Look up every lock transaction in one request
+    UniValue txs_hashes(UniValue::VARR);
+    for (const auto& [id, txid] : locks) {
+        txs_hashes.push_back(txid);
+    }
+    UniValue params(UniValue::VOBJ);
+    params.pushKV("txs_hashes", std::move(txs_hashes));
+    const std::string result = HttpPost(m_config.monero_daemon_host, m_config.monero_daemon_port,
+                                        "/get_transactions", params.write());
+
+    UniValue reply;
+    if (result.empty() || !reply.read(result) || !reply.isObject() || !reply["txs"].isArray()) return;
+
+    std::set<std::string> confirmed;
+    for (const UniValue& tx : reply["txs"].getValues()) {
+        const UniValue& block_height = tx.find_value("block_height");
+        const UniValue& tx_hash = tx.find_value("tx_hash");
+        if (tx.find_value("in_pool").isTrue() || !block_height.isNum() || !tx_hash.isStr()) continue;
+
+        const uint64_t mined_at = block_height.getInt<uint64_t>();
+        const uint64_t confirmations = height > mined_at ? height - mined_at : 0;
+        if (confirmations >= uint64_t(std::max(m_config.confirmation_threshold, 0))) {
+            confirmed.insert(tx_hash.get_str());
         }
     }
+
+    std::lock_guard<std::mutex> lock(m_swap_mutex);
+    for (const auto& [id, txid] : locks) {
+        auto it = m_swaps.find(id);
+        if (!confirmed.contains(txid) || it == m_swaps.end()) continue;
+
+        it->second.monero_side_complete = true;
+        if (m_store) m_store->WriteSwap(it->second);
+        m_swaps_awaiting_monero.erase(id);
+        LogPrintf("BridgeNode: Monero side of swap %s confirmed\n", id.GetHex().substr(0, 16));
+    }
 }
 
 bool BridgeNode::CreateWattxHTLC(const AtomicSwap& swap) {
@@ -653,84 +919,7 @@ std::string BridgeNode::MoneroWalletRPC(const std::string& method, const std::st
 std::string BridgeNode::HttpPost(const std::string& host, uint16_t port,
                                   const std::string& path, const std::string& body,
                                   const std::string& auth) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) return "";
-
-    // Set timeout
-    struct timeval tv;
-    tv.tv_sec = 10;
-    tv.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-    struct sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-
-    struct hostent* he = gethostbyname(host.c_str());
-    if (!he) {
-        close(sock);
-        return "";
-    }
-    std::memcpy(&addr.sin_addr, he->h_addr, he->h_length);
-
-    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(sock);
-        return "";
-    }
-
-    std::ostringstream request;
-    request << "POST " << path << " HTTP/1.1\r\n";
-    request << "Host: " << host << ":" << port << "\r\n";
-    request << "Content-Type: application/json\r\n";
-    request << "Content-Length: " << body.length() << "\r\n";
-
-    if (!auth.empty()) {
-        // Base64 encode auth
-        static const char* base64_chars =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        std::string encoded;
-        int val = 0, valb = -6;
-        for (unsigned char c : auth) {
-            val = (val << 8) + c;
-            valb += 8;
-            while (valb >= 0) {
-                encoded.push_back(base64_chars[(val >> valb) & 0x3F]);
-                valb -= 6;
-            }
-        }
-        if (valb > -6) encoded.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-        while (encoded.size() % 4) encoded.push_back('=');
-
-        request << "Authorization: Basic " << encoded << "\r\n";
-    }
-
-    request << "Connection: close\r\n\r\n";
-    request << body;
-
-    std::string req_str = request.str();
-    if (send(sock, req_str.c_str(), req_str.length(), 0) < 0) {
-        close(sock);
-        return "";
-    }
-
-    std::string response;
-    char buffer[4096];
-    ssize_t bytes;
-    while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes] = '\0';
-        response += buffer;
-    }
-
-    close(sock);
-
-    // Extract body
-    size_t body_start = response.find("\r\n\r\n");
-    if (body_start != std::string::npos) {
-        return response.substr(body_start + 4);
-    }
-
-    return response;
+    return stratum::GetRpcClient(host, port, auth)->Post(path, body);
 }
 
 }  // namespace bridge
@@ -6,19 +6,30 @@
 #define WATTX_BRIDGE_NODE_H
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include <bridge/bridge_store.h>
+#include <serialize.h>
 #include <uint256.h>
 #include <compat/endian.h>
+#include <util/fs.h>
+#include <stratum/parent_notify.h>
 #include <wallet/monero_wallet.h>
 
+class CBlock;
+class CValidationInterface;
+class ValidationSignals;
+
 // Custom hash specialization for uint256 to use in std::unordered_map
 namespace std {
 template<>
@@ -47,6 +58,8 @@ struct BridgeConfig {
     uint16_t monero_daemon_port = 18081;
     std::string monero_wallet_host = "127.0.0.1";
     uint16_t monero_wallet_port = 18083;
+    // monerod --zmq-pub endpoint for block notifications, empty to poll only
+    std::string monero_zmq_endpoint;
 
     // Bridge contract address
     std::string bridge_contract_address;
@@ -57,9 +70,17 @@ struct BridgeConfig {
     std::string validator_private_key;
 
     // Operational settings
-    int batch_interval = 600;           // 10 minutes
+    int batch_interval = 600;           // Longest a transaction waits for its batch, 10 minutes
+    int batch_min_interval = 30;        // Shortest wait before a fee-efficient batch is committed
+    size_t batch_max_transactions = 1000; // Batch committed as soon as it has this many
+    uint64_t batch_commit_fee = 0;      // Estimated fee of a commitment, 0 to ignore fees
+    uint64_t batch_target_fee_per_tx = 0; // Commitment fee per transaction a batch is committed at
     int confirmation_threshold = 6;     // Monero confirmations
     int wattx_confirmations = 10;       // WATTx confirmations
+
+    // Directory of the bridge database, empty to keep the state in memory only
+    fs::path data_dir;
+    size_t db_cache_bytes = 8 << 20;
 };
 
 /**
@@ -73,9 +94,15 @@ struct PendingTransaction {
     std::string destination;    // Address on destination chain
     int64_t created_at;
     int64_t confirmed_at;
+    uint64_t start_height;      // Height of from_chain when submitted
     int confirmations;
     bool completed;
     bool refunded;
+
+    SERIALIZE_METHODS(PendingTransaction, obj) {
+        READWRITE(obj.tx_hash, obj.from_chain, obj.to_chain, obj.amount, obj.destination, obj.created_at,
+                  obj.confirmed_at, obj.start_height, obj.confirmations, obj.completed, obj.refunded);
+    }
 };
 
 /**
@@ -85,14 +112,47 @@ struct TransactionBatch {
     uint64_t batch_id;
     std::vector<uint256> tx_hashes;
     uint256 merkle_root;
-    int64_t created_at;
+    int64_t created_at;                 // When the first transaction joined
     int64_t committed_at;
     bool committed_to_wattx;
     bool confirmed_on_monero;
     std::string monero_block_hash;
     uint64_t monero_height;
+
+    SERIALIZE_METHODS(TransactionBatch, obj) {
+        READWRITE(obj.batch_id, obj.tx_hashes, obj.merkle_root, obj.created_at, obj.committed_at,
+                  obj.committed_to_wattx, obj.confirmed_on_monero, obj.monero_block_hash, obj.monero_height);
+    }
 };
 
+/**
+ * Proof that a transaction is in a committed batch
+ */
+struct BatchInclusionProof {
+    uint64_t batch_id;
+    uint256 merkle_root;
+    CMerkleBranch branch;               // nIndex is the position in the batch
+    bool committed_to_wattx;
+};
+
+/**
+ * Why a batch is committed
+ */
+enum class BatchFlush {
+    NONE,   //!< not yet
+    SIZE,   //!< batch_max_transactions reached
+    FEE,    //!< commitment fee per transaction at target, batch_min_interval passed
+    AGE,    //!< batch_interval passed
+};
+
+/**
+ * Decide whether a batch of @p size transactions, the first @p age seconds
+ * old, is committed now
+ *
+ * @param[out] wait seconds until the batch is due unless more transactions join
+ */
+BatchFlush CheckBatchFlush(const BridgeConfig& config, size_t size, int64_t age, int64_t& wait);
+
 /**
  * Atomic swap state
  */
@@ -107,6 +167,12 @@ struct AtomicSwap {
     std::string state;              // "active", "claimed", "refunded"
     bool wattx_side_complete;
     bool monero_side_complete;
+    std::string monero_lock_txid;   // Participant's Monero lock transaction, once known
+
+    SERIALIZE_METHODS(AtomicSwap, obj) {
+        READWRITE(obj.swap_id, obj.initiator, obj.participant, obj.amount, obj.hash_lock, obj.preimage,
+                  obj.timelock, obj.state, obj.wattx_side_complete, obj.monero_side_complete, obj.monero_lock_txid);
+    }
 };
 
 /**
@@ -117,16 +183,30 @@ struct AtomicSwap {
  * - Batches WATTx transactions for Monero commitment
  * - Validates and confirms cross-chain proofs
  * - Facilitates atomic swaps via HTLC coordination
+ *
+ * Transactions, swaps and batches are kept in a BridgeStore. Only open
+ * transactions, active swaps and the current batch are held in memory;
+ * the rest is read from the store when asked for.
  */
 class BridgeNode {
 public:
+    //! Monero polls between block notifications, to catch up on lost ones
+    static constexpr std::chrono::minutes MONERO_NOTIFIED_POLL_INTERVAL{5};
+    //! Monero polls without block notifications (~2 min blocks)
+    static constexpr std::chrono::seconds MONERO_POLL_INTERVAL{30};
+
     BridgeNode();
     ~BridgeNode();
 
     /**
      * Start the bridge node
+     *
+     * The state is loaded from the store in config.data_dir, finishing a
+     * batch commit a crash interrupted. WATTx blocks are followed in-process through @p signals. Monero blocks
+     * are announced by monerod's ZMQ publisher when configured, with a
+     * slower poll as a fallback.
      */
-    bool Start(const BridgeConfig& config);
+    bool Start(const BridgeConfig& config, ValidationSignals& signals);
 
     /**
      * Stop the bridge node
@@ -160,6 +240,11 @@ public:
      */
     std::vector<PendingTransaction> GetPendingTransactions();
 
+    /**
+     * Get the hashes of all transactions to a destination, in no particular order
+     */
+    std::vector<uint256> GetTransactionsByDestination(const std::string& destination);
+
     // ============================================================================
     // Atomic Swap Management
     // ============================================================================
@@ -171,8 +256,11 @@ public:
 
     /**
      * Participate in an atomic swap (XMR -> WTX)
+     *
+     * The Monero side completes once @p monero_lock_txid, when given, has
+     * confirmation_threshold confirmations.
      */
-    bool ParticipateSwap(const uint256& swap_id, uint64_t xmr_amount);
+    bool ParticipateSwap(const uint256& swap_id, uint64_t xmr_amount, const std::string& monero_lock_txid = "");
 
     /**
      * Claim a swap (reveal secret)
@@ -198,11 +286,21 @@ public:
      */
     TransactionBatch GetCurrentBatch();
 
+    /**
+     * Get a committed batch
+     */
+    std::optional<TransactionBatch> GetBatch(uint64_t batch_id);
+
     /**
      * Force commit current batch (validators only)
      */
     bool CommitBatch();
 
+    /**
+     * Get the proof of a transaction against the merkle root of its committed batch
+     */
+    std::optional<BatchInclusionProof> GetInclusionProof(const uint256& tx_hash);
+
     // ============================================================================
     // Statistics
     // ============================================================================
@@ -212,8 +310,9 @@ public:
     uint64_t GetPendingCount() const;
 
 private:
+    friend class WattxBlockListener;
+
     // Worker threads
-    void WattxMonitorThread();
     void MoneroMonitorThread();
     void BatchProcessorThread();
     void SwapMonitorThread();
@@ -224,18 +323,20 @@ private:
     std::string MoneroWalletRPC(const std::string& method, const std::string& params);
 
     // Transaction handling
-    void ProcessWattxBlock(uint64_t height);
+    void ProcessWattxBlock(const CBlock& block, uint64_t height);
     void ProcessMoneroBlock(uint64_t height);
-    void UpdateTransactionConfirmations();
+    void UpdateTransactionConfirmations(const std::string& chain, uint64_t height);
 
     // Batch handling
-    void CreateBatch();
+    void CreateBatch(BatchFlush reason);
+    void FinishBatch();
     void SubmitBatchToWattx();
     void ConfirmBatchOnMonero();
     uint256 ComputeMerkleRoot(const std::vector<uint256>& hashes);
 
     // Swap handling
-    void MonitorSwapTimeouts();
+    std::optional<int64_t> MonitorSwapTimeouts();
+    void CheckMoneroSwapLocks(uint64_t height);
     bool CreateWattxHTLC(const AtomicSwap& swap);
     bool CreateMoneroHTLC(const AtomicSwap& swap);
 
@@ -251,35 +352,49 @@ private:
     std::atomic<bool> m_running{false};
 
     // Threads
-    std::thread m_wattx_monitor_thread;
     std::thread m_monero_monitor_thread;
     std::thread m_batch_processor_thread;
     std::thread m_swap_monitor_thread;
 
+    // Chain notifications
+    ValidationSignals* m_signals{nullptr};
+    std::shared_ptr<CValidationInterface> m_wattx_listener;
+    stratum::ParentBlockSubscriber m_monero_subscriber;
+
+    // Persistent state
+    std::unique_ptr<BridgeStore> m_store;
+
     // Chain state
-    uint64_t m_wattx_height{0};
-    uint64_t m_monero_height{0};
+    std::atomic<uint64_t> m_wattx_height{0};
+    std::atomic<uint64_t> m_monero_height{0};
 
-    // Pending transactions
+    // Open transactions, completed and refunded ones are only in the store
     mutable std::mutex m_tx_mutex;
     std::unordered_map<uint256, PendingTransaction, std::hash<uint256>> m_pending_txs;
 
-    // Batch management
+    // Batch management, m_merkle holds the tree of m_current_batch
     mutable std::mutex m_batch_mutex;
     TransactionBatch m_current_batch;
-    std::vector<TransactionBatch> m_committed_batches;
+    IncrementalMerkle m_merkle;
 
-    // Atomic swaps
+    // Active swaps, and a min-heap of their timelocks; claimed and refunded
+    // swaps are skipped when their timelock comes up
     mutable std::mutex m_swap_mutex;
     std::unordered_map<uint256, AtomicSwap, std::hash<uint256>> m_swaps;
+    std::priority_queue<std::pair<int64_t, uint256>, std::vector<std::pair<int64_t, uint256>>, std::greater<>> m_swap_deadlines;
+    // Active swaps whose Monero lock is waiting for confirmations
+    std::set<uint256> m_swaps_awaiting_monero;
 
     // Statistics
     std::atomic<uint64_t> m_total_transactions{0};
     std::atomic<uint64_t> m_total_swaps{0};
 
-    // Synchronization
+    // Synchronization, the counters are guarded by m_cv_mutex
     std::condition_variable m_cv;
     std::mutex m_cv_mutex;
+    uint64_t m_monero_notifications{0};
+    uint64_t m_swap_changes{0};
+    uint64_t m_batch_changes{0};
 };
 
 /**
@@ -0,0 +1,273 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bridge/bridge_store.h>
+
+#include <bridge/bridge_node.h>
+#include <hash.h>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+
+namespace bridge {
+
+// Database keys
+static constexpr uint8_t DB_TX{'t'};
+static constexpr uint8_t DB_TX_OPEN{'o'};
+static constexpr uint8_t DB_TX_DESTINATION{'d'};
+static constexpr uint8_t DB_SWAP{'s'};
+static constexpr uint8_t DB_SWAP_EXPIRY{'e'};
+static constexpr uint8_t DB_BATCH{'b'};
+static constexpr uint8_t DB_BATCH_MEMBER{'m'};
+static constexpr uint8_t DB_CURRENT_BATCH{'c'};
+static constexpr uint8_t DB_BATCH_LOG{'w'};
+static constexpr uint8_t DB_PROOF{'p'};
+static constexpr uint8_t DB_HEIGHTS{'h'};
+
+//! Numbers in keys are big endian, so keys sort by them
+struct OrderedKey {
+    uint64_t first{0};
+    uint64_t second{0};
+    uint256 hash;
+
+    SERIALIZE_METHODS(OrderedKey, obj) {
+        READWRITE(Using<BigEndianFormatter<8>>(obj.first), Using<BigEndianFormatter<8>>(obj.second), obj.hash);
+    }
+};
+
+static std::pair<uint8_t, OrderedKey> BatchKey(uint64_t batch_id)
+{
+    return {DB_BATCH, OrderedKey{batch_id, 0, uint256()}};
+}
+
+static std::pair<uint8_t, OrderedKey> MemberKey(uint64_t batch_id, uint64_t position)
+{
+    return {DB_BATCH_MEMBER, OrderedKey{batch_id, position, uint256()}};
+}
+
+static std::pair<uint8_t, OrderedKey> ExpiryKey(const AtomicSwap& swap)
+{
+    return {DB_SWAP_EXPIRY, OrderedKey{static_cast<uint64_t>(std::max<int64_t>(swap.timelock, 0)), 0, swap.swap_id}};
+}
+
+static bool IsOpen(const PendingTransaction& tx)
+{
+    return !tx.completed && !tx.refunded;
+}
+
+// ============================================================================
+// IncrementalMerkle
+// ============================================================================
+
+void IncrementalMerkle::Append(const uint256& hash)
+{
+    // Merge the complete subtrees the new hash completes, as a binary counter carries
+    uint256 node = hash;
+    size_t level = 0;
+    while ((m_size >> level) & 1) {
+        node = Hash(m_frontier[level], node);
+        ++level;
+    }
+    if (m_frontier.size() <= level) m_frontier.resize(level + 1);
+    m_frontier[level] = node;
+    ++m_size;
+}
+
+uint256 IncrementalMerkle::Root() const
+{
+    if (m_size == 0) return uint256{};
+
+    // Close the subtrees from the smallest up, a lone node pairing with itself
+    std::optional<uint256> carry;
+    for (size_t level = 0; (m_size >> level) != 0; ++level) {
+        const bool complete = (m_size >> level) & 1;
+        const bool higher = (m_size >> (level + 1)) != 0;
+        if (complete && carry) {
+            carry = Hash(m_frontier[level], *carry);
+        } else if (complete) {
+            if (!higher) return m_frontier[level];
+            carry = Hash(m_frontier[level], m_frontier[level]);
+        } else if (carry) {
+            carry = Hash(*carry, *carry);
+        }
+        if (!higher) break;
+    }
+    return *carry;
+}
+
+// ============================================================================
+// BridgeStore
+// ============================================================================
+
+BridgeStore::BridgeStore(const fs::path& path, size_t cache_size, bool memory_only)
+    : m_db(DBParams{.path = path, .cache_bytes = cache_size, .memory_only = memory_only, .wipe_data = false, .obfuscate = true, .shared_cache = true})
+{
+}
+
+bool BridgeStore::WriteTransaction(const PendingTransaction& tx)
+{
+    CDBBatch batch(m_db);
+    batch.Write(std::make_pair(DB_TX, tx.tx_hash), tx);
+    batch.Write(std::make_pair(DB_TX_DESTINATION, std::make_pair(tx.destination, tx.tx_hash)), uint8_t{0});
+    if (IsOpen(tx)) {
+        batch.Write(std::make_pair(DB_TX_OPEN, tx.tx_hash), uint8_t{0});
+    } else {
+        batch.Erase(std::make_pair(DB_TX_OPEN, tx.tx_hash));
+    }
+    return m_db.WriteBatch(batch);
+}
+
+bool BridgeStore::ReadTransaction(const uint256& tx_hash, PendingTransaction& tx) const
+{
+    return m_db.Read(std::make_pair(DB_TX, tx_hash), tx);
+}
+
+std::vector<PendingTransaction> BridgeStore::ReadOpenTransactions()
+{
+    std::vector<PendingTransaction> result;
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(std::make_pair(DB_TX_OPEN, uint256())); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, uint256> key;
+        if (!pcursor->GetKey(key) || key.first != DB_TX_OPEN) break;
+        PendingTransaction tx;
+        if (ReadTransaction(key.second, tx)) result.push_back(std::move(tx));
+    }
+    return result;
+}
+
+std::vector<uint256> BridgeStore::ReadTransactionsByDestination(const std::string& destination)
+{
+    std::vector<uint256> result;
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(std::make_pair(DB_TX_DESTINATION, std::make_pair(destination, uint256()))); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, std::pair<std::string, uint256>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_TX_DESTINATION || key.second.first != destination) break;
+        result.push_back(key.second.second);
+    }
+    return result;
+}
+
+bool BridgeStore::AddTransaction(const PendingTransaction& tx, const TransactionBatch& batch, const IncrementalMerkle& merkle)
+{
+    // The header is written without the hashes, which have an entry each
+    TransactionBatch header = batch;
+    header.tx_hashes.clear();
+
+    CDBBatch write(m_db);
+    write.Write(std::make_pair(DB_TX, tx.tx_hash), tx);
+    write.Write(std::make_pair(DB_TX_DESTINATION, std::make_pair(tx.destination, tx.tx_hash)), uint8_t{0});
+    if (IsOpen(tx)) write.Write(std::make_pair(DB_TX_OPEN, tx.tx_hash), uint8_t{0});
+    write.Write(MemberKey(batch.batch_id, merkle.Size() - 1), tx.tx_hash);
+    write.Write(DB_CURRENT_BATCH, std::make_pair(header, merkle));
+    return m_db.WriteBatch(write);
+}
+
+bool BridgeStore::ReadCurrentBatch(TransactionBatch& batch, IncrementalMerkle& merkle)
+{
+    std::pair<TransactionBatch, IncrementalMerkle> current;
+    if (!m_db.Read(DB_CURRENT_BATCH, current)) return false;
+    batch = std::move(current.first);
+    merkle = std::move(current.second);
+
+    batch.tx_hashes.clear();
+    batch.tx_hashes.reserve(merkle.Size());
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(MemberKey(batch.batch_id, 0)); pcursor->Valid() && batch.tx_hashes.size() < merkle.Size(); pcursor->Next()) {
+        std::pair<uint8_t, OrderedKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_BATCH_MEMBER || key.second.first != batch.batch_id) break;
+        uint256 tx_hash;
+        if (!pcursor->GetValue(tx_hash)) break;
+        batch.tx_hashes.push_back(tx_hash);
+    }
+    return batch.tx_hashes.size() == merkle.Size();
+}
+
+bool BridgeStore::WriteSwap(const AtomicSwap& swap)
+{
+    CDBBatch batch(m_db);
+    batch.Write(std::make_pair(DB_SWAP, swap.swap_id), swap);
+    if (swap.state == "active") {
+        batch.Write(ExpiryKey(swap), uint8_t{0});
+    } else {
+        batch.Erase(ExpiryKey(swap));
+    }
+    return m_db.WriteBatch(batch);
+}
+
+bool BridgeStore::ReadSwap(const uint256& swap_id, AtomicSwap& swap) const
+{
+    return m_db.Read(std::make_pair(DB_SWAP, swap_id), swap);
+}
+
+std::vector<AtomicSwap> BridgeStore::ReadActiveSwaps()
+{
+    std::vector<AtomicSwap> result;
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(std::make_pair(DB_SWAP_EXPIRY, OrderedKey{})); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, OrderedKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_SWAP_EXPIRY) break;
+        AtomicSwap swap;
+        if (ReadSwap(key.second.hash, swap)) result.push_back(std::move(swap));
+    }
+    return result;
+}
+
+bool BridgeStore::LogBatchCommit(const TransactionBatch& batch)
+{
+    return m_db.Write(DB_BATCH_LOG, batch, /*fSync=*/true);
+}
+
+bool BridgeStore::ReadBatchCommitLog(TransactionBatch& batch) const
+{
+    return m_db.Read(DB_BATCH_LOG, batch);
+}
+
+bool BridgeStore::FinishBatchCommit(const TransactionBatch& committed, const TransactionBatch& next)
+{
+    CDBBatch batch(m_db);
+    batch.Write(BatchKey(committed.batch_id), committed);
+    for (uint64_t position = 0; position < committed.tx_hashes.size(); ++position) {
+        batch.Erase(MemberKey(committed.batch_id, position));
+    }
+    const std::vector<CMerkleBranch> branches = ComputeMerkleBranches(committed.tx_hashes);
+    for (size_t i = 0; i < branches.size(); ++i) {
+        batch.Write(std::make_pair(DB_PROOF, committed.tx_hashes[i]), std::make_pair(committed.batch_id, branches[i]));
+    }
+    TransactionBatch header = next;
+    header.tx_hashes.clear();
+    batch.Write(DB_CURRENT_BATCH, std::make_pair(header, IncrementalMerkle{}));
+    batch.Erase(DB_BATCH_LOG);
+    return m_db.WriteBatch(batch, /*fSync=*/true);
+}
+
+bool BridgeStore::ReadBatch(uint64_t batch_id, TransactionBatch& batch) const
+{
+    return m_db.Read(BatchKey(batch_id), batch);
+}
+
+bool BridgeStore::ReadInclusionProof(const uint256& tx_hash, uint64_t& batch_id, CMerkleBranch& branch) const
+{
+    std::pair<uint64_t, CMerkleBranch> proof;
+    if (!m_db.Read(std::make_pair(DB_PROOF, tx_hash), proof)) return false;
+    batch_id = proof.first;
+    branch = std::move(proof.second);
+    return true;
+}
+
+bool BridgeStore::WriteHeights(uint64_t wattx_height, uint64_t monero_height)
+{
+    return m_db.Write(DB_HEIGHTS, std::make_pair(wattx_height, monero_height));
+}
+
+bool BridgeStore::ReadHeights(uint64_t& wattx_height, uint64_t& monero_height) const
+{
+    std::pair<uint64_t, uint64_t> heights;
+    if (!m_db.Read(DB_HEIGHTS, heights)) return false;
+    wattx_height = heights.first;
+    monero_height = heights.second;
+    return true;
+}
+
+}  // namespace bridge
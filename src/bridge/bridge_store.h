@@ -0,0 +1,105 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_BRIDGE_STORE_H
+#define WATTX_BRIDGE_STORE_H
+
+#include <auxpow/auxpow.h>
+#include <dbwrapper.h>
+#include <serialize.h>
+#include <uint256.h>
+#include <util/fs.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bridge {
+
+struct AtomicSwap;
+struct PendingTransaction;
+struct TransactionBatch;
+
+/**
+ * Merkle root of a list of hashes that grows one hash at a time
+ *
+ * Keeps the root of each complete subtree waiting for a sibling, one per
+ * set bit of the size, so appending and taking the root both cost
+ * O(log n) hashes. The root is the one BridgeNode::ComputeMerkleRoot gives
+ * for the whole list: a lone node is paired with itself, and a single hash
+ * is its own root.
+ */
+class IncrementalMerkle {
+public:
+    void Append(const uint256& hash);
+    uint256 Root() const;
+    uint64_t Size() const { return m_size; }
+
+    SERIALIZE_METHODS(IncrementalMerkle, obj) { READWRITE(obj.m_size, obj.m_frontier); }
+
+private:
+    uint64_t m_size{0};
+    //! Root of a complete subtree of 2^i hashes, valid where bit i of m_size is set
+    std::vector<uint256> m_frontier;
+};
+
+/**
+ * LevelDB store of the bridge's transactions, swaps and batches
+ *
+ * Records are keyed by id. Index entries are written in the same batch as
+ * their record:
+ * - open transactions, not completed or refunded;
+ * - transactions by destination;
+ * - active swaps by expiry.
+ * A restart loads only what the indexes list, and the current batch;
+ * closed transactions and swaps are read on demand.
+ *
+ * The transactions of the current batch are stored one entry each, with
+ * the batch header and its incremental merkle tree, so joining a batch
+ * does not rewrite it. Committing a batch is logged before the batch is
+ * submitted, and the log is dropped in the same write that records the
+ * batch as committed, so a crash in between is finished on the next start.
+ * The inclusion proof of each transaction of the batch is written with it.
+ */
+class BridgeStore {
+public:
+    BridgeStore(const fs::path& path, size_t cache_size, bool memory_only = false);
+
+    /** Write a transaction, updating its indexes for a changed status */
+    bool WriteTransaction(const PendingTransaction& tx);
+    bool ReadTransaction(const uint256& tx_hash, PendingTransaction& tx) const;
+    std::vector<PendingTransaction> ReadOpenTransactions();
+    std::vector<uint256> ReadTransactionsByDestination(const std::string& destination);
+
+    /** Write a new transaction as it joins the current batch, whose header and tree include it */
+    bool AddTransaction(const PendingTransaction& tx, const TransactionBatch& batch, const IncrementalMerkle& merkle);
+    /** Read the current batch with its transactions, false if there is none yet */
+    bool ReadCurrentBatch(TransactionBatch& batch, IncrementalMerkle& merkle);
+
+    /** Write a swap, updating the expiry index for a changed state */
+    bool WriteSwap(const AtomicSwap& swap);
+    bool ReadSwap(const uint256& swap_id, AtomicSwap& swap) const;
+    /** Active swaps, the first to expire first */
+    std::vector<AtomicSwap> ReadActiveSwaps();
+
+    /** Log a batch about to be submitted, synced before returning */
+    bool LogBatchCommit(const TransactionBatch& batch);
+    bool ReadBatchCommitLog(TransactionBatch& batch) const;
+    /** Record the logged batch as committed with its inclusion proofs and start the next one, dropping the log */
+    bool FinishBatchCommit(const TransactionBatch& committed, const TransactionBatch& next);
+    bool ReadBatch(uint64_t batch_id, TransactionBatch& batch) const;
+    /** Branch of a transaction to the merkle root of the committed batch it is in */
+    bool ReadInclusionProof(const uint256& tx_hash, uint64_t& batch_id, CMerkleBranch& branch) const;
+
+    /** Heights of WATTx and Monero processed so far */
+    bool WriteHeights(uint64_t wattx_height, uint64_t monero_height);
+    bool ReadHeights(uint64_t& wattx_height, uint64_t& monero_height) const;
+
+private:
+    CDBWrapper m_db;
+};
+
+}  // namespace bridge
+
+#endif  // WATTX_BRIDGE_STORE_H
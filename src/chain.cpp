@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chain.h>
+#include <crypto/x25x/x25x.h>
 #include <tinyformat.h>
 #include <util/time.h>
 #include <pubkey.h>
@@ -123,10 +124,15 @@ CBlockIndex* CBlockIndex::GetAncestor(int height)
     return const_cast<CBlockIndex*>(static_cast<const CBlockIndex*>(this)->GetAncestor(height));
 }
 
+static_assert(static_cast<size_t>(x25x::Algorithm::KHEAVYHASH) < CBlockIndex::MAX_BLOCK_ALGOS);
+
 void CBlockIndex::BuildSkip()
 {
-    if (pprev)
+    if (pprev) {
         pskip = pprev->GetAncestor(GetSkipHeight(nHeight));
+        pprevAlgo = pprev->pprevAlgo;
+        pprevAlgo[static_cast<size_t>(x25x::GetBlockAlgorithm(pprev->nVersion))] = pprev;
+    }
 }
 
 arith_uint256 GetBlockProof(const CBlockIndex& block)
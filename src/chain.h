@@ -130,6 +130,8 @@ enum BlockStatus : uint32_t {
 
     BLOCK_STATUS_RESERVED    =   256, //!< Unused flag that was previously set on assumeutxo snapshot blocks and their
                                       //!< ancestors before they were validated, and unset when they were validated.
+
+    BLOCK_POW_CHECKED        =   512, //!< header proof of work was verified at its height and need not be rehashed on load
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -140,6 +142,9 @@ enum BlockStatus : uint32_t {
 class CBlockIndex
 {
 public:
+    //! Number of slots in pprevAlgo; covers every X25X algorithm id
+    static constexpr size_t MAX_BLOCK_ALGOS = 8;
+
     //! pointer to the hash of the block, if any. Memory is owned by this CBlockIndex
     const uint256* phashBlock{nullptr};
 
@@ -152,6 +157,10 @@ public:
     //! pointer to the index of some further predecessor of this block
     CBlockIndex* pskip{nullptr};
 
+    //! (memory only) most recent ancestor mined with each X25X algorithm, indexed
+    //! by algorithm id, so per-algorithm difficulty skips other algorithms' blocks
+    std::array<CBlockIndex*, MAX_BLOCK_ALGOS> pprevAlgo{};
+
     //! height of the entry in the chain. The genesis block has height 0
     int nHeight{0};
 
@@ -366,7 +375,7 @@ public:
         return false;
     }
 
-    //! Build the skiplist pointer for this entry.
+    //! Build the skiplist and per-algorithm pointers for this entry.
     void BuildSkip();
 
     //! Efficiently find an ancestor of this block.
@@ -452,7 +461,7 @@ public:
         READWRITE(obj.vchBlockSigDlgt); // qtum
     }
 
-    uint256 ConstructBlockHash() const
+    CBlockHeader ConstructBlockHeader() const
     {
         CBlockHeader block;
         block.nVersion = nVersion;
@@ -465,7 +474,12 @@ public:
         block.hashUTXORoot = hashUTXORoot; // qtum
         block.vchBlockSigDlgt = vchBlockSigDlgt;
         block.prevoutStake = prevoutStake;
-        return block.GetHash();
+        return block;
+    }
+
+    uint256 ConstructBlockHash() const
+    {
+        return ConstructBlockHeader().GetHash();
     }
 
     uint256 GetBlockHash() = delete;
@@ -34,8 +34,9 @@ bool CCoinsViewBacked::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &h
 std::unique_ptr<CCoinsViewCursor> CCoinsViewBacked::Cursor() const { return base->Cursor(); }
 size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
-CCoinsViewCache::CCoinsViewCache(CCoinsView* baseIn, bool deterministic) :
-    CCoinsViewBacked(baseIn), m_deterministic(deterministic),
+CCoinsViewCache::CCoinsViewCache(CCoinsView* baseIn, bool deterministic, bool large_pages) :
+    CCoinsViewBacked(baseIn), m_deterministic(deterministic), m_large_pages(large_pages),
+    m_cache_coins_memory_resource(CCoinsMapMemoryResource::DEFAULT_CHUNK_SIZE_BYTES, large_pages),
     cacheCoins(0, SaltedOutpointHasher(/*deterministic=*/deterministic), CCoinsMap::key_equal{}, &m_cache_coins_memory_resource)
 {
     m_sentinel.second.SelfRef(m_sentinel);
@@ -324,7 +325,7 @@ void CCoinsViewCache::ReallocateCache()
     assert(cacheCoins.size() == 0);
     cacheCoins.~CCoinsMap();
     m_cache_coins_memory_resource.~CCoinsMapMemoryResource();
-    ::new (&m_cache_coins_memory_resource) CCoinsMapMemoryResource{};
+    ::new (&m_cache_coins_memory_resource) CCoinsMapMemoryResource{CCoinsMapMemoryResource::DEFAULT_CHUNK_SIZE_BYTES, m_large_pages};
     ::new (&cacheCoins) CCoinsMap{0, SaltedOutpointHasher{/*deterministic=*/m_deterministic}, CCoinsMap::key_equal{}, &m_cache_coins_memory_resource};
 }
 
@@ -430,6 +430,7 @@ class CCoinsViewCache : public CCoinsViewBacked
 {
 private:
     const bool m_deterministic;
+    const bool m_large_pages;
 
 protected:
     /**
@@ -437,7 +438,7 @@ protected:
      * declared as "const".
      */
     mutable uint256 hashBlock;
-    mutable CCoinsMapMemoryResource m_cache_coins_memory_resource{};
+    mutable CCoinsMapMemoryResource m_cache_coins_memory_resource;
     /* The starting sentinel of the flagged entry circular doubly linked list. */
     mutable CoinsCachePair m_sentinel;
     mutable CCoinsMap cacheCoins;
@@ -446,7 +447,8 @@ protected:
     mutable size_t cachedCoinsUsage{0};
 
 public:
-    CCoinsViewCache(CCoinsView *baseIn, bool deterministic = false);
+    //! With large_pages the entries are kept in chunks from LargePageAllocator.
+    CCoinsViewCache(CCoinsView *baseIn, bool deterministic = false, bool large_pages = false);
 
     /**
      * By deleting the copy constructor, we prevent accidentally using it when one intends to create a cache on top of a base cache.
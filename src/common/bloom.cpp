@@ -5,6 +5,7 @@
 #include <common/bloom.h>
 
 #include <hash.h>
+#include <memusage.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <script/script.h>
@@ -244,3 +245,8 @@ void CRollingBloomFilter::reset()
     nGeneration = 1;
     std::fill(data.begin(), data.end(), 0);
 }
+
+size_t CRollingBloomFilter::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(data);
+}
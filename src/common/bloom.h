@@ -115,6 +115,8 @@ public:
 
     void reset();
 
+    size_t DynamicMemoryUsage() const;
+
 private:
     int nEntriesPerGeneration;
     int nEntriesThisGeneration;
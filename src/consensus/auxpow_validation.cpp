@@ -8,13 +8,62 @@
 #include <hash.h>
 #include <logging.h>
 #include <node/randomx_miner.h>
+#include <sync.h>
+#include <util/hasher.h>
 #include <util/time.h>
 
+#include <deque>
+#include <unordered_set>
+
 namespace consensus {
 
 // Global AuxPoW parameters
 static AuxPowParams g_auxpow_params;
 
+namespace {
+
+/**
+ * Proofs that passed CheckAuxProofOfWork(), by the hash of the aux block
+ * hash and the whole proof, so a header seen again on header sync, block
+ * receipt or reindex isn't checked again. Only valid proofs are kept.
+ */
+class AuxPowProofCache
+{
+public:
+    static constexpr size_t MAX_ENTRIES{8192};
+
+    static uint256 Key(const uint256& hashAuxBlock, const CAuxPow& auxpow)
+    {
+        return (HashWriter{} << hashAuxBlock << TX_WITH_WITNESS(auxpow)).GetHash();
+    }
+
+    bool Contains(const uint256& key) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        return m_valid.count(key) > 0;
+    }
+
+    void Insert(const uint256& key) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (!m_valid.insert(key).second) return;
+        m_order.push_back(key);
+        if (m_order.size() > MAX_ENTRIES) {
+            m_valid.erase(m_order.front());
+            m_order.pop_front();
+        }
+    }
+
+private:
+    Mutex m_mutex;
+    std::unordered_set<uint256, SaltedTxidHasher> m_valid GUARDED_BY(m_mutex);
+    std::deque<uint256> m_order GUARDED_BY(m_mutex);
+};
+
+AuxPowProofCache g_valid_proofs;
+
+} // namespace
+
 const AuxPowParams& GetAuxPowParams() {
     return g_auxpow_params;
 }
@@ -78,8 +127,10 @@ bool CheckAuxProofOfWork(const CBlockHeader& header, const CAuxPow& auxpow,
         return false;
     }
 
-    // 4. Verify the AuxPoW proof structure
+    // 4. Verify the AuxPoW proof structure, unless it was verified before
     uint256 hashAuxBlock = header.GetHash();
+    const uint256 proofKey = AuxPowProofCache::Key(hashAuxBlock, auxpow);
+    if (g_valid_proofs.Contains(proofKey)) return true;
     if (!auxpow.Check(hashAuxBlock, g_auxpow_params.nChainId)) {
         LogPrintf("AuxPoW Validation: Proof structure invalid\n");
         return false;
@@ -97,6 +148,7 @@ bool CheckAuxProofOfWork(const CBlockHeader& header, const CAuxPow& auxpow,
         return false;
     }
 
+    g_valid_proofs.Insert(proofKey);
     LogPrintf("AuxPoW Validation: Proof valid for block %s\n",
               hashAuxBlock.GetHex().substr(0, 16));
     return true;
@@ -413,6 +413,17 @@ struct Params {
     bool IsPrivacyActive(int height) const {
         return height >= nPrivacyActivationHeight;
     }
+
+    /**
+     * Block height from which a block may not spend a ring key image twice.
+     * A soft fork; unscheduled (disabled) unless a network sets it.
+     */
+    int nPrivacyKeyImageUniqueHeight{std::numeric_limits<int>::max()};
+
+    /** Check if key images must be unique within a block at given height */
+    bool IsPrivacyKeyImageUniqueActive(int height) const {
+        return height >= nPrivacyKeyImageUniqueHeight;
+    }
 };
 
 } // namespace Consensus
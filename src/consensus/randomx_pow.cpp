@@ -6,6 +6,7 @@
 #include <primitives/block.h>
 #include <uint256.h>
 #include <node/randomx_miner.h>
+#include <node/randomx_verifier.h>
 #include <arith_uint256.h>
 #include <logging.h>
 #include <crypto/sha256.h>
@@ -14,7 +15,7 @@
  * RandomX Proof-of-Work consensus validation
  *
  * This file provides consensus-level validation for RandomX PoW blocks.
- * The actual RandomX hashing is performed by the RandomXMiner class.
+ * The actual RandomX hashing is performed by the RandomXVerifier pool.
  */
 
 namespace Consensus {
@@ -32,7 +33,7 @@ bool CheckRandomXProofOfWork(const CBlockHeader& header, const Params& params)
     auto headerData = node::RandomXMiner::SerializeBlockHeader(header);
 
     uint256 hash;
-    node::GetRandomXMiner().CalculateHash(headerData.data(), headerData.size(), hash.data());
+    node::GetRandomXVerifier().CalculateHash(params.hashGenesisBlock, headerData.data(), headerData.size(), hash.data());
 
     if (hash.IsNull()) {
         LogPrintf("CheckRandomXProofOfWork: Failed to compute RandomX hash\n");
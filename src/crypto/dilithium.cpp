@@ -3,13 +3,19 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <crypto/dilithium.h>
+#include <crypto/common.h>
+#include <crypto/sha256.h>
 #include <hash.h>
 #include <logging.h>
 #include <random.h>
 #include <support/cleanse.h>
 
+#include <array>
 #include <cstring>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #ifdef HAVE_LIBOQS
 #include <oqs/oqs.h>
@@ -30,7 +36,13 @@ bool Initialize()
         if (OQS_SIG_alg_is_enabled(OQS_SIG_alg_ml_dsa_65)) {
             g_available = true;
             g_initialized = true;
-            LogPrintf("Dilithium (ML-DSA-65) post-quantum signatures: enabled\n");
+#ifdef OQS_ENABLE_SIG_ml_dsa_65_avx2
+            // liboqs picks its AVX2 NTT implementation at runtime when the CPU has it
+            const bool avx2 = OQS_CPU_has_extension(OQS_CPU_EXT_AVX2);
+#else
+            const bool avx2 = false;
+#endif
+            LogPrintf("Dilithium (ML-DSA-65) post-quantum signatures: enabled (%s)\n", avx2 ? "avx2" : "reference");
         } else {
             g_available = false;
             g_initialized = true;
@@ -65,6 +77,104 @@ std::string GetAlgorithmName()
 // CPubKey implementation
 // ============================================================================
 
+// ============================================================================
+// Verified signature cache
+// ============================================================================
+
+#ifdef HAVE_LIBOQS
+namespace {
+
+/**
+ * Recently verified (public key, message, signature) triples.
+ *
+ * OP_CHECKSIG_DILITHIUM signs the hash of the script code, so every output
+ * of one PQ address carries the same message and a wallet can spend them all
+ * with one signature. Block validation runs with the signature cache in
+ * read-only mode, so without this each of those inputs would be verified
+ * again. Only successes are kept; a verification is deterministic, so a hit
+ * is as good as re-running it.
+ *
+ * The LRU is split into shards by key, each behind its own mutex, so script
+ * check threads rarely contend.
+ */
+class VerifiedSignatures
+{
+public:
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t ENTRIES_PER_SHARD = 512;
+
+    VerifiedSignatures()
+    {
+        // Salted so entries cannot be ground into colliding keys
+        const uint256 salt = GetRandHash();
+        m_salted_hasher.Write(salt.begin(), salt.size());
+    }
+
+    uint256 Key(const std::vector<uint8_t>& pubkey, const uint8_t* data, size_t len, const std::vector<uint8_t>& sig) const
+    {
+        uint256 key;
+        unsigned char len_bytes[8];
+        WriteLE64(len_bytes, len);
+        CSHA256(m_salted_hasher)
+            .Write(pubkey.data(), pubkey.size())
+            .Write(len_bytes, sizeof(len_bytes))
+            .Write(data, len)
+            .Write(sig.data(), sig.size())
+            .Finalize(key.begin());
+        return key;
+    }
+
+    bool Contains(const uint256& key)
+    {
+        Shard& shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return false;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return true;
+    }
+
+    void Insert(const uint256& key)
+    {
+        Shard& shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.index.count(key)) return;
+        shard.lru.push_front(key);
+        shard.index.emplace(key, shard.lru.begin());
+        if (shard.lru.size() > ENTRIES_PER_SHARD) {
+            shard.index.erase(shard.lru.back());
+            shard.lru.pop_back();
+        }
+    }
+
+private:
+    //! Keys are salted SHA256 outputs, so any 64 bits of them hash well
+    struct KeyHasher {
+        size_t operator()(const uint256& key) const { return ReadLE64(key.begin()); }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        //! Most recently used first
+        std::list<uint256> lru;
+        std::unordered_map<uint256, std::list<uint256>::iterator, KeyHasher> index;
+    };
+
+    Shard& GetShard(const uint256& key) { return m_shards[key.begin()[8] % SHARDS]; }
+
+    CSHA256 m_salted_hasher;
+    std::array<Shard, SHARDS> m_shards;
+};
+
+VerifiedSignatures& GetVerifiedSignatures()
+{
+    static VerifiedSignatures cache;
+    return cache;
+}
+
+} // namespace
+#endif // HAVE_LIBOQS
+
 uint256 CPubKey::GetHash() const
 {
     if (!IsValid()) {
@@ -97,26 +207,33 @@ bool CPubKey::VerifyData(const uint8_t* data, size_t dataLen, const std::vector<
         return false;
     }
 
-    OQS_SIG* sig_ctx = OQS_SIG_new(OQS_SIG_alg_ml_dsa_65);
+    VerifiedSignatures& verified = GetVerifiedSignatures();
+    const uint256 key = verified.Key(vchPubKey, data, dataLen, sig);
+    if (verified.Contains(key)) return true;
+
+    // Script checks verify on the same few threads; keep one context each
+    // instead of allocating one per signature
+    thread_local const std::unique_ptr<OQS_SIG, decltype(&OQS_SIG_free)> sig_ctx{
+        OQS_SIG_new(OQS_SIG_alg_ml_dsa_65), &OQS_SIG_free};
     if (!sig_ctx) {
         LogPrintf( "Dilithium::Verify: failed to create signature context\n");
         return false;
     }
 
     OQS_STATUS result = OQS_SIG_verify(
-        sig_ctx,
+        sig_ctx.get(),
         data, dataLen,
         sig.data(), sig.size(),
         vchPubKey.data()
     );
 
-    OQS_SIG_free(sig_ctx);
-
     if (result != OQS_SUCCESS) {
-        LogPrintf( "Dilithium::Verify: signature verification failed\n");
+        // Invalid signatures can be relayed at will; keep them out of the default log
+        LogDebug(BCLog::VALIDATION, "Dilithium::Verify: signature verification failed\n");
         return false;
     }
 
+    verified.Insert(key);
     return true;
 #else
     (void)data;
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_EQUIHASH_BLAKE2B_LANES_H
+#define BITCOIN_CRYPTO_EQUIHASH_BLAKE2B_LANES_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * BLAKE2b compression over several independent messages in lockstep
+ *
+ * Equihash leaf inputs differ only in their index bytes, so LANES messages
+ * go through identical rounds. The per-lane inner loops are simple enough
+ * for the compiler to vectorize at whatever width the translation unit is
+ * built for; equihash_avx2.cpp includes this with AVX2 enabled.
+ *
+ * Everything here has internal linkage so the AVX2 and generic builds of
+ * the same templates can never be merged by the linker.
+ */
+namespace equihash {
+namespace blake2b {
+namespace {
+
+constexpr uint64_t BLAKE2B_IV[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+constexpr uint8_t BLAKE2B_SIGMA[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+};
+
+constexpr size_t BLAKE2B_BLOCK = 128;
+inline uint64_t Rotr64(uint64_t x, int n) { return (x >> n) | (x << (64 - n)); }
+
+template <int LANES>
+inline void G(uint64_t (&v)[16][LANES], const uint64_t (&m)[16][LANES],
+              int a, int b, int c, int d, int x, int y)
+{
+    for (int l = 0; l < LANES; l++) {
+        v[a][l] = v[a][l] + v[b][l] + m[x][l];
+        v[d][l] = Rotr64(v[d][l] ^ v[a][l], 32);
+        v[c][l] = v[c][l] + v[d][l];
+        v[b][l] = Rotr64(v[b][l] ^ v[c][l], 24);
+        v[a][l] = v[a][l] + v[b][l] + m[y][l];
+        v[d][l] = Rotr64(v[d][l] ^ v[a][l], 16);
+        v[c][l] = v[c][l] + v[d][l];
+        v[b][l] = Rotr64(v[b][l] ^ v[c][l], 63);
+    }
+}
+
+//! Compress one block per lane; all lanes are at the same stream offset
+template <int LANES>
+void Compress(uint64_t (&h)[8][LANES], const uint64_t (&m)[16][LANES], uint64_t bytes, bool last)
+{
+    uint64_t v[16][LANES];
+    for (int l = 0; l < LANES; l++) {
+        for (int i = 0; i < 8; i++) {
+            v[i][l] = h[i][l];
+            v[i + 8][l] = BLAKE2B_IV[i];
+        }
+        v[12][l] ^= bytes;
+        if (last) v[14][l] = ~v[14][l];
+    }
+
+    for (int r = 0; r < 12; r++) {
+        const uint8_t* s = BLAKE2B_SIGMA[r];
+        G<LANES>(v, m, 0, 4, 8, 12, s[0], s[1]);
+        G<LANES>(v, m, 1, 5, 9, 13, s[2], s[3]);
+        G<LANES>(v, m, 2, 6, 10, 14, s[4], s[5]);
+        G<LANES>(v, m, 3, 7, 11, 15, s[6], s[7]);
+        G<LANES>(v, m, 0, 5, 10, 15, s[8], s[9]);
+        G<LANES>(v, m, 1, 6, 11, 12, s[10], s[11]);
+        G<LANES>(v, m, 2, 7, 8, 13, s[12], s[13]);
+        G<LANES>(v, m, 3, 4, 9, 14, s[14], s[15]);
+    }
+
+    for (int l = 0; l < LANES; l++) {
+        for (int i = 0; i < 8; i++) {
+            h[i][l] ^= v[i][l] ^ v[i + 8][l];
+        }
+    }
+}
+
+} // namespace
+} // namespace blake2b
+} // namespace equihash
+
+#endif // BITCOIN_CRYPTO_EQUIHASH_BLAKE2B_LANES_H
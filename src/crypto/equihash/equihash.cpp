@@ -4,14 +4,21 @@
 
 #include <crypto/equihash/equihash.h>
 
-// Use Blake2b from randomx
-extern "C" {
-#include <randomx/src/blake2/blake2.h>
+#include <crypto/common.h>
+#include <crypto/equihash/blake2b_lanes.h>
+
+#if defined(ENABLE_AVX2)
+#include <compat/cpuid.h>
+
+namespace equihash_avx2 {
+void Compress4(uint64_t (&h)[8][4], const uint64_t (&m)[16][4], uint64_t bytes, bool last);
 }
+#endif
 
 #include <cstring>
 #include <algorithm>
-#include <set>
+#include <array>
+#include <thread>
 
 namespace equihash {
 
@@ -22,42 +29,166 @@ static const unsigned char EQUIHASH_PERSONAL[16] = {
     0x09, 0x00, 0x00, 0x00   // k = 9 (little-endian)
 };
 
-// Initialize Blake2b state with Equihash parameters
-static void InitializeState(blake2b_state* state, const unsigned char* input, size_t inputLen)
+namespace {
+
+using blake2b::BLAKE2B_BLOCK;
+using blake2b::BLAKE2B_IV;
+using blake2b::Compress;
+
+constexpr int LEAF_LANES = 4;
+using Compress4Fn = void (*)(uint64_t (&h)[8][4], const uint64_t (&m)[16][4], uint64_t bytes, bool last);
+
+//! Portable fallback: without wide vectors, four scalar passes beat an
+//! interleaved one
+void Compress4Scalar(uint64_t (&h)[8][4], const uint64_t (&m)[16][4], uint64_t bytes, bool last)
 {
-    blake2b_param P;
-    memset(&P, 0, sizeof(P));
-    P.digest_length = BLAKE2B_DIGEST_LENGTH;
-    P.fanout = 1;
-    P.depth = 1;
-    memcpy(P.personal, EQUIHASH_PERSONAL, sizeof(EQUIHASH_PERSONAL));
-
-    blake2b_init_param(state, &P);
-    blake2b_update(state, input, inputLen);
+    for (int l = 0; l < 4; l++) {
+        uint64_t hl[8][1], ml[16][1];
+        for (int i = 0; i < 8; i++) hl[i][0] = h[i][l];
+        for (int i = 0; i < 16; i++) ml[i][0] = m[i][l];
+        Compress<1>(hl, ml, bytes, last);
+        for (int i = 0; i < 8; i++) h[i][l] = hl[i][0];
+    }
 }
 
-void GenerateHash(const unsigned char* input, size_t inputLen,
-                  uint32_t index, unsigned char* hash)
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID)
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+
+Compress4Fn SelectCompress4()
+{
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx && AVXEnabled()) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        if ((ebx >> 5) & 1) {
+            return equihash_avx2::Compress4;
+        }
+    }
+#endif
+    return Compress4Scalar;
+}
+
+void Compress4(uint64_t (&h)[8][4], const uint64_t (&m)[16][4], uint64_t bytes, bool last)
 {
-    blake2b_state state;
-    InitializeState(&state, input, inputLen);
+    static const Compress4Fn impl = SelectCompress4();
+    impl(h, m, bytes, last);
+}
+
+/**
+ * Leaf hash generator for one header: BLAKE2b-400 personalized with
+ * "ZcashPoW"||n||k over input||index, truncated to HASH_LENGTH.
+ *
+ * The parameter block and every block that holds only input bytes are
+ * absorbed once; each leaf then hashes just the block(s) that carry its
+ * index (a single block for an 80-byte header).
+ */
+class LeafHasher
+{
+public:
+    LeafHasher(const unsigned char* input, size_t inputLen)
+    {
+        uint64_t h[8][1];
+        for (int i = 0; i < 8; i++) h[i][0] = BLAKE2B_IV[i];
+        h[0][0] ^= 0x01010000ULL | BLAKE2B_DIGEST_LENGTH;  // depth 1, fanout 1, no key
+        h[6][0] ^= ReadLE64(EQUIHASH_PERSONAL);
+        h[7][0] ^= ReadLE64(EQUIHASH_PERSONAL + 8);
+
+        // Blocks before the one holding the first index byte never change.
+        // A block is only compressed once more data follows it, which the
+        // index guarantees, so they all go in as non-final blocks.
+        const size_t fixedBlocks = inputLen / BLAKE2B_BLOCK;
+        for (size_t b = 0; b < fixedBlocks; b++) {
+            uint64_t m[16][1];
+            for (int i = 0; i < 16; i++) m[i][0] = ReadLE64(input + b * BLAKE2B_BLOCK + i * 8);
+            Compress<1>(h, m, (b + 1) * BLAKE2B_BLOCK, false);
+        }
+        for (int i = 0; i < 8; i++) m_midstate[i] = h[i][0];
 
-    // Add index (little-endian)
-    unsigned char indexBytes[4];
-    indexBytes[0] = index & 0xFF;
-    indexBytes[1] = (index >> 8) & 0xFF;
-    indexBytes[2] = (index >> 16) & 0xFF;
-    indexBytes[3] = (index >> 24) & 0xFF;
+        m_offset = fixedBlocks * BLAKE2B_BLOCK;
+        m_tailLen = inputLen - m_offset;
+        m_tailBlocks = (m_tailLen + 4 + BLAKE2B_BLOCK - 1) / BLAKE2B_BLOCK;  // 1 or 2
+        std::memcpy(m_tail.data(), input + m_offset, m_tailLen);
+    }
+
+    //! Hash LANES leaves at once; out receives LANES * HASH_LENGTH bytes
+    template <int LANES>
+    void Hash(const uint32_t* indices, unsigned char* out) const
+    {
+        unsigned char tails[LANES][2 * BLAKE2B_BLOCK];
+        for (int l = 0; l < LANES; l++) {
+            std::memcpy(tails[l], m_tail.data(), 2 * BLAKE2B_BLOCK);
+            WriteLE32(tails[l] + m_tailLen, indices[l]);
+        }
+
+        uint64_t h[8][LANES];
+        for (int i = 0; i < 8; i++) {
+            for (int l = 0; l < LANES; l++) h[i][l] = m_midstate[i];
+        }
+
+        for (size_t b = 0; b < m_tailBlocks; b++) {
+            uint64_t m[16][LANES];
+            for (int i = 0; i < 16; i++) {
+                for (int l = 0; l < LANES; l++) m[i][l] = ReadLE64(tails[l] + b * BLAKE2B_BLOCK + i * 8);
+            }
+            const bool last = b + 1 == m_tailBlocks;
+            const uint64_t bytes = last ? m_offset + m_tailLen + 4 : m_offset + (b + 1) * BLAKE2B_BLOCK;
+            if constexpr (LANES == LEAF_LANES) {
+                Compress4(h, m, bytes, last);
+            } else {
+                Compress<LANES>(h, m, bytes, last);
+            }
+        }
 
-    blake2b_state indexState = state;
-    blake2b_update(&indexState, indexBytes, 4);
+        for (int l = 0; l < LANES; l++) {
+            unsigned char digest[32];
+            for (int i = 0; i < 4; i++) WriteLE64(digest + i * 8, h[i][l]);
+            std::memcpy(out + l * HASH_LENGTH, digest, HASH_LENGTH);
+        }
+    }
+
+private:
+    uint64_t m_midstate[8];
+    size_t m_offset;      //!< stream offset of the first varying block
+    size_t m_tailLen;     //!< input bytes in the varying block(s)
+    size_t m_tailBlocks;  //!< number of varying blocks
+    //! Varying blocks, zero padded; the index goes at m_tailLen
+    std::array<unsigned char, 2 * BLAKE2B_BLOCK> m_tail{};
+};
+
+static_assert(HASH_LENGTH <= 32, "leaf hashes come from the first four BLAKE2b state words");
 
-    unsigned char hashOutput[BLAKE2B_DIGEST_LENGTH];
-    blake2b_final(&indexState, hashOutput, BLAKE2B_DIGEST_LENGTH);
+} // namespace
 
-    // Extract the relevant portion for this index
-    // Each hash output produces multiple hash values
-    memcpy(hash, hashOutput, HASH_LENGTH);
+void GenerateHash(const unsigned char* input, size_t inputLen,
+                  uint32_t index, unsigned char* hash)
+{
+    LeafHasher(input, inputLen).Hash<1>(&index, hash);
+}
+
+void GenerateHashes(const unsigned char* input, size_t inputLen,
+                    uint32_t first, size_t count, unsigned char* out)
+{
+    const LeafHasher hasher(input, inputLen);
+    size_t i = 0;
+    for (; i + LEAF_LANES <= count; i += LEAF_LANES) {
+        uint32_t indices[LEAF_LANES];
+        for (int l = 0; l < LEAF_LANES; l++) indices[l] = first + i + l;
+        hasher.Hash<LEAF_LANES>(indices, out + i * HASH_LENGTH);
+    }
+    for (; i < count; i++) {
+        const uint32_t index = first + i;
+        hasher.Hash<1>(&index, out + i * HASH_LENGTH);
+    }
 }
 
 // Extract bits from a byte array
@@ -133,16 +264,8 @@ bool HasValidIndicesOrder(const std::vector<uint32_t>& indices)
         return false;
     }
 
-    // Check for duplicates
-    std::set<uint32_t> seen;
-    for (uint32_t idx : indices) {
-        if (seen.count(idx)) {
-            return false;  // Duplicate index
-        }
-        seen.insert(idx);
-    }
-
-    // Check tree structure ordering
+    // Check tree structure ordering first; it is cheap and rejects most
+    // malformed solutions.
     // In a valid solution, for each level of the binary tree,
     // the left subtree's first index must be less than the right subtree's first index
     for (size_t step = 1; step < NUM_INDICES; step *= 2) {
@@ -153,41 +276,74 @@ bool HasValidIndicesOrder(const std::vector<uint32_t>& indices)
         }
     }
 
-    return true;
+    // Check for duplicates
+    std::array<uint32_t, NUM_INDICES> sorted;
+    std::copy(indices.begin(), indices.end(), sorted.begin());
+    std::sort(sorted.begin(), sorted.end());
+    return std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
 }
 
-// XOR two hash values
-static void XorHashes(const unsigned char* a, const unsigned char* b,
-                      unsigned char* result, size_t len)
+namespace {
+
+/**
+ * Collision tree walked depth-first, so a solution is rejected at the first
+ * failing pair instead of after all 512 leaves have been hashed.
+ *
+ * Combining two subtrees at level L XORs their first 3*(K-L) bytes; the
+ * leading COLLISION_BIT_LENGTH bits must vanish, and the rest (minus the
+ * leading COLLISION_BYTE_LENGTH bytes) carries on to level L+1. At the last
+ * level the whole remainder must be zero.
+ */
+class CollisionTree
 {
-    for (size_t i = 0; i < len; i++) {
-        result[i] = a[i] ^ b[i];
+public:
+    //! Add the next subtree of 2^level leaves; false if a collision check failed
+    bool Push(const unsigned char* node, int level)
+    {
+        while (m_depth > 0 && m_levels[m_depth - 1] == level) {
+            unsigned char merged[HASH_LENGTH]{};
+            if (!Combine(m_nodes[m_depth - 1].data(), node, level, merged)) return false;
+            m_depth--;
+            if (++level == K) return true;
+            std::memcpy(m_scratch.data(), merged, HASH_LENGTH);
+            node = m_scratch.data();
+        }
+        std::memcpy(m_nodes[m_depth].data(), node, HASH_LENGTH);
+        m_levels[m_depth++] = level;
+        return true;
     }
-}
 
-// Check if hash is all zeros for the specified collision length
-static bool IsValidCollision(const unsigned char* hash, size_t level)
-{
-    // At each level, check if the first (level+1)*COLLISION_BIT_LENGTH bits are zero
-    size_t bitsToCheck = (level + 1) * COLLISION_BIT_LENGTH;
-    size_t bytesToCheck = bitsToCheck / 8;
-    size_t remainingBits = bitsToCheck % 8;
+    static bool Combine(const unsigned char* a, const unsigned char* b, int level, unsigned char* out)
+    {
+        const size_t collisionLen = COLLISION_BYTE_LENGTH * (K - level);
+        unsigned char x[HASH_LENGTH];
+        for (size_t j = 0; j < collisionLen; j++) x[j] = a[j] ^ b[j];
 
-    for (size_t i = 0; i < bytesToCheck; i++) {
-        if (hash[i] != 0) {
-            return false;
-        }
-    }
+        // First COLLISION_BIT_LENGTH (20) bits must be zero
+        if (x[0] != 0 || x[1] != 0 || (x[2] & 0x0F) != 0) return false;
 
-    if (remainingBits > 0) {
-        unsigned char mask = (1 << remainingBits) - 1;
-        if ((hash[bytesToCheck] & mask) != 0) {
-            return false;
+        if (level == K - 1) {
+            // Final level: entire hash should be zero
+            for (size_t j = 0; j < collisionLen; j++) {
+                if (x[j] != 0) return false;
+            }
+            return true;
         }
+        std::memcpy(out, x + COLLISION_BYTE_LENGTH, collisionLen - COLLISION_BYTE_LENGTH);
+        return true;
     }
 
-    return true;
-}
+private:
+    std::array<std::array<unsigned char, HASH_LENGTH>, K + 1> m_nodes;
+    std::array<int, K + 1> m_levels;
+    std::array<unsigned char, HASH_LENGTH> m_scratch;
+    int m_depth{0};
+};
+
+static_assert(NUM_INDICES % LEAF_LANES == 0 && LEAF_LANES == 4,
+              "leaves are hashed and merged in groups of four");
+
+} // namespace
 
 bool VerifySolution(const unsigned char* input, size_t inputLen,
                     const std::vector<unsigned char>& solution)
@@ -208,45 +364,55 @@ bool VerifySolution(const unsigned char* input, size_t inputLen,
         return false;
     }
 
-    // Generate hashes for all indices
-    std::vector<std::array<unsigned char, HASH_LENGTH>> hashes(NUM_INDICES);
-
-    for (int i = 0; i < NUM_INDICES; i++) {
-        GenerateHash(input, inputLen, indices[i], hashes[i].data());
+    // Hash leaves four at a time and fold each group into the tree straight
+    // away: two level-0 pairs, then their level-1 combination
+    const LeafHasher hasher(input, inputLen);
+    CollisionTree tree;
+    unsigned char leaves[LEAF_LANES][HASH_LENGTH];
+    unsigned char left[HASH_LENGTH]{}, right[HASH_LENGTH]{}, quad[HASH_LENGTH]{};
+
+    for (int i = 0; i < NUM_INDICES; i += LEAF_LANES) {
+        hasher.Hash<LEAF_LANES>(&indices[i], leaves[0]);
+        if (!CollisionTree::Combine(leaves[0], leaves[1], 0, left) ||
+            !CollisionTree::Combine(leaves[2], leaves[3], 0, right) ||
+            !CollisionTree::Combine(left, right, 1, quad) ||
+            !tree.Push(quad, 2)) {
+            return false;
+        }
     }
 
-    // Verify the solution by computing XORs at each level
-    for (int level = 0; level < K; level++) {
-        size_t step = 1 << level;
-        size_t collisionLen = COLLISION_BYTE_LENGTH * (K - level);
-
-        for (size_t i = 0; i < NUM_INDICES; i += step * 2) {
-            // XOR pairs of hashes
-            std::array<unsigned char, HASH_LENGTH> xorResult;
-            XorHashes(hashes[i].data(), hashes[i + step].data(),
-                      xorResult.data(), collisionLen);
-
-            // Check collision (first COLLISION_BIT_LENGTH bits should be zero)
-            if (!IsValidCollision(xorResult.data(), 0)) {
-                return false;
-            }
+    return true;
+}
 
-            // Store result for next level (shift out the collision bits)
-            if (level < K - 1) {
-                memmove(hashes[i].data(), xorResult.data() + COLLISION_BYTE_LENGTH,
-                        collisionLen - COLLISION_BYTE_LENGTH);
-            } else {
-                // Final level: entire hash should be zero
-                for (size_t j = 0; j < collisionLen; j++) {
-                    if (xorResult[j] != 0) {
-                        return false;
-                    }
-                }
-            }
+std::vector<bool> VerifySolutions(const std::vector<SolutionCheck>& checks)
+{
+    std::vector<char> results(checks.size(), 0);
+    auto verify_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const SolutionCheck& check = checks[i];
+            results[i] = check.solution && VerifySolution(check.input, check.inputLen, *check.solution);
+        }
+    };
+
+    // Solutions are independent; split large batches across cores
+    unsigned numThreads = std::thread::hardware_concurrency();
+    if (numThreads < 1) numThreads = 1;
+    numThreads = std::min<size_t>(numThreads, (checks.size() + BATCH_MIN_PER_THREAD - 1) / BATCH_MIN_PER_THREAD);
+
+    if (numThreads <= 1) {
+        verify_range(0, checks.size());
+    } else {
+        std::vector<std::thread> threads;
+        const size_t perThread = (checks.size() + numThreads - 1) / numThreads;
+        for (size_t begin = 0; begin < checks.size(); begin += perThread) {
+            threads.emplace_back(verify_range, begin, std::min(checks.size(), begin + perThread));
+        }
+        for (auto& t : threads) {
+            t.join();
         }
     }
 
-    return true;
+    return std::vector<bool>(results.begin(), results.end());
 }
 
 bool VerifySolution(const unsigned char* header, size_t headerLen,
@@ -9,6 +9,9 @@
 #include <cstddef>
 #include <vector>
 #include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
 
 /**
  * Equihash Proof-of-Work Implementation
@@ -88,6 +91,25 @@ bool VerifySolution(const unsigned char* header, size_t headerLen,
 bool VerifySolution(const unsigned char* input, size_t inputLen,
                     const std::vector<unsigned char>& solution);
 
+/** One entry of a VerifySolutions() batch */
+struct SolutionCheck {
+    const unsigned char* input;                   //!< header+nonce input
+    size_t inputLen;
+    const std::vector<unsigned char>* solution;   //!< compressed solution
+};
+
+//! Batches smaller than this per core are verified on the calling thread
+constexpr size_t BATCH_MIN_PER_THREAD = 16;
+
+/**
+ * Verify many Equihash solutions, e.g. a range of headers during sync.
+ * Large batches are spread across cores.
+ *
+ * @param checks  Inputs and solutions; they must outlive the call
+ * @return one result per entry, in order
+ */
+std::vector<bool> VerifySolutions(const std::vector<SolutionCheck>& checks);
+
 /**
  * Generate the initial hash values for given indices
  *
@@ -99,6 +121,64 @@ bool VerifySolution(const unsigned char* input, size_t inputLen,
 void GenerateHash(const unsigned char* input, size_t inputLen,
                   uint32_t index, unsigned char* hash);
 
+/**
+ * Generate the hashes of count consecutive indices, HASH_LENGTH bytes each,
+ * four at a time through the widest BLAKE2b path the CPU supports
+ *
+ * @param input       Input data (header + nonce)
+ * @param inputLen    Input length
+ * @param first       First index to generate a hash for
+ * @param count       Number of indices
+ * @param out         Output buffer (count * HASH_LENGTH bytes)
+ */
+void GenerateHashes(const unsigned char* input, size_t inputLen,
+                    uint32_t first, size_t count, unsigned char* out);
+
+/**
+ * CPU solver for the instance VerifySolution() checks
+ *
+ * All 2^21 leaves are hashed and sorted into buckets by the first 12 bits of
+ * their first collision chunk, then each round pairs the entries of a bucket
+ * that agree on the remaining 8 bits, in the manner of Tromp's solver. An
+ * entry keeps only the chunks still to collide, and the tree of pairs is
+ * kept as one 32-bit reference per entry (bucket and two slots), from which
+ * the indices of a solution are collected at the end.
+ *
+ * Rounds are spread over numThreads threads by bucket. The solver needs
+ * about 235 MB, allocated on the first Solve() and reused by later calls.
+ */
+class Solver
+{
+public:
+    //! Called with the indices of each solution, in the order VerifySolution()
+    //! expects; return true to stop the search
+    using SolutionFound = std::function<bool(const std::vector<uint32_t>& indices)>;
+
+    explicit Solver(unsigned numThreads = 1);
+    ~Solver();
+
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    /**
+     * Search the solutions of one input
+     *
+     * @param input       Combined header+nonce input
+     * @param inputLen    Length of input
+     * @param found       Called with each solution found
+     * @param interrupt   Checked between rounds; the search ends when set
+     * @return number of solutions passed to found
+     */
+    size_t Solve(const unsigned char* input, size_t inputLen,
+                 const SolutionFound& found,
+                 const std::atomic<bool>* interrupt = nullptr);
+
+private:
+    struct State;
+    std::unique_ptr<State> m_state;
+    unsigned m_numThreads;
+};
+
 /**
  * Check if indices are in valid order (for solution verification)
  */
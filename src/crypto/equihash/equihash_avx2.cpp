@@ -0,0 +1,18 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <crypto/equihash/blake2b_lanes.h>
+
+namespace equihash_avx2 {
+
+void Compress4(uint64_t (&h)[8][4], const uint64_t (&m)[16][4], uint64_t bytes, bool last)
+{
+    equihash::blake2b::Compress<4>(h, m, bytes, last);
+}
+
+} // namespace equihash_avx2
+
+#endif
@@ -0,0 +1,246 @@
+// Copyright (c) 2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/equihash/equihash.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace equihash {
+
+namespace {
+
+//! Entries are bucketed by the first 12 of the 20 collision bits of a chunk
+constexpr int BUCKET_BITS = 12;
+constexpr uint32_t NUM_BUCKETS = 1U << BUCKET_BITS;
+//! and paired within a bucket on the other 8
+constexpr uint32_t NUM_RESTS = 1U << (COLLISION_BIT_LENGTH - BUCKET_BITS);
+constexpr uint32_t NUM_LEAVES = 1U << INDEX_BIT_LENGTH;
+
+//! Every round keeps about NUM_LEAVES entries, 512 per bucket on average.
+//! Entries past the end of a full bucket are dropped, losing the solutions
+//! they would have led to.
+constexpr uint32_t BUCKET_SLOTS = 640;
+constexpr int SLOT_BITS = 10;
+constexpr uint32_t SLOT_MASK = (1U << SLOT_BITS) - 1;
+constexpr size_t NUM_SLOTS = size_t{NUM_BUCKETS} * BUCKET_SLOTS;
+static_assert(BUCKET_SLOTS <= SLOT_MASK + 1 && BUCKET_BITS + 2 * SLOT_BITS == 32,
+              "a pair reference packs its bucket and both slots into 32 bits");
+
+constexpr uint16_t NIL = 0xFFFF;
+static_assert(BUCKET_SLOTS < NIL);
+
+//! Leaves hashed at a time before they are spread over the buckets
+constexpr uint32_t LEAF_BATCH = 256;
+static_assert(NUM_LEAVES % LEAF_BATCH == 0);
+
+/** Bytes of a level's entries: the chunks that still have to collide */
+constexpr size_t NodeBytes(int level) { return COLLISION_BYTE_LENGTH * (K - level); }
+
+/** First 12 collision bits of a chunk, in the bit order VerifySolution() checks */
+inline uint32_t BucketOf(const unsigned char* chunk)
+{
+    return chunk[0] | (uint32_t{chunk[1]} & 0x0F) << 8;
+}
+
+/** Remaining 8 collision bits of a chunk */
+inline uint32_t RestOf(const unsigned char* chunk)
+{
+    return chunk[1] >> 4 | (uint32_t{chunk[2]} & 0x0F) << 4;
+}
+
+/** Run fn(begin, end) over [0, count) split across threads */
+template <typename Fn>
+void RunParallel(unsigned numThreads, size_t count, const Fn& fn)
+{
+    if (numThreads <= 1) {
+        fn(0, count);
+        return;
+    }
+    std::vector<std::thread> threads;
+    const size_t perThread = (count + numThreads - 1) / numThreads;
+    for (size_t begin = 0; begin < count; begin += perThread) {
+        threads.emplace_back([&fn, begin, end = std::min(count, begin + perThread)] { fn(begin, end); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+} // namespace
+
+struct Solver::State {
+    //! Entries of the current and the next level, NodeBytes(level) each,
+    //! in BUCKET_SLOTS runs per bucket
+    std::array<std::vector<unsigned char>, 2> nodes;
+    std::array<std::unique_ptr<std::atomic<uint32_t>[]>, 2> counts;
+    //! Per level and slot: the leaf index at level 0, above that the bucket
+    //! and slots of the pair of entries below
+    std::array<std::vector<uint32_t>, K> refs;
+
+    State()
+    {
+        for (auto& n : nodes) n.resize(NUM_SLOTS * NodeBytes(0));
+        for (auto& c : counts) c = std::make_unique<std::atomic<uint32_t>[]>(NUM_BUCKETS);
+        for (auto& r : refs) r.resize(NUM_SLOTS);
+    }
+
+    void ResetCounts(int which)
+    {
+        for (uint32_t b = 0; b < NUM_BUCKETS; b++) counts[which][b].store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t Count(int which, uint32_t bucket) const
+    {
+        return std::min(counts[which][bucket].load(std::memory_order_relaxed), BUCKET_SLOTS);
+    }
+
+    /** Write the 2^level leaf indices under a slot, each pair ordered by its first index */
+    void CollectIndices(int level, size_t slot, uint32_t* out) const
+    {
+        const uint32_t ref = refs[level][slot];
+        if (level == 0) {
+            *out = ref;
+            return;
+        }
+        const size_t base = size_t{ref >> 2 * SLOT_BITS} * BUCKET_SLOTS;
+        const size_t half = size_t{1} << (level - 1);
+        CollectIndices(level - 1, base + ((ref >> SLOT_BITS) & SLOT_MASK), out);
+        CollectIndices(level - 1, base + (ref & SLOT_MASK), out + half);
+        if (out[0] > out[half]) std::swap_ranges(out, out + half, out + half);
+    }
+};
+
+Solver::Solver(unsigned numThreads)
+    : m_numThreads(std::max(1U, numThreads))
+{
+}
+
+Solver::~Solver() = default;
+
+size_t Solver::Solve(const unsigned char* input, size_t inputLen,
+                     const SolutionFound& found,
+                     const std::atomic<bool>* interrupt)
+{
+    if (!m_state) m_state = std::make_unique<State>();
+    State& s = *m_state;
+    const auto interrupted = [&] { return interrupt && interrupt->load(std::memory_order_relaxed); };
+
+    // Level 0: hash every leaf into the bucket of its first chunk. The
+    // verifier never looks at the last chunk of a leaf, so it is dropped.
+    s.ResetCounts(0);
+    RunParallel(m_numThreads, NUM_LEAVES / LEAF_BATCH, [&](size_t begin, size_t end) {
+        std::array<unsigned char, LEAF_BATCH * HASH_LENGTH> hashes;
+        for (size_t batch = begin; batch < end; batch++) {
+            const uint32_t first = batch * LEAF_BATCH;
+            GenerateHashes(input, inputLen, first, LEAF_BATCH, hashes.data());
+            for (uint32_t l = 0; l < LEAF_BATCH; l++) {
+                const unsigned char* hash = hashes.data() + l * HASH_LENGTH;
+                const uint32_t bucket = BucketOf(hash);
+                const uint32_t slot = s.counts[0][bucket].fetch_add(1, std::memory_order_relaxed);
+                if (slot >= BUCKET_SLOTS) continue;
+                const size_t index = size_t{bucket} * BUCKET_SLOTS + slot;
+                std::memcpy(&s.nodes[0][index * NodeBytes(0)], hash, NodeBytes(0));
+                s.refs[0][index] = first + l;
+            }
+        }
+    });
+
+    // Levels 1 to K-1: pair the entries of a bucket that collide on their
+    // first chunk and keep the XOR of the chunks after it
+    for (int level = 0; level < K - 1; level++) {
+        if (interrupted()) return 0;
+        const int cur = level & 1;
+        const int next = cur ^ 1;
+        const size_t inBytes = NodeBytes(level);
+        const size_t outBytes = NodeBytes(level + 1);
+        s.ResetCounts(next);
+        RunParallel(m_numThreads, NUM_BUCKETS, [&](size_t begin, size_t end) {
+            std::array<uint16_t, NUM_RESTS> heads;
+            std::array<uint16_t, BUCKET_SLOTS> chain;
+            for (size_t bucket = begin; bucket < end; bucket++) {
+                const unsigned char* entries = &s.nodes[cur][bucket * BUCKET_SLOTS * inBytes];
+                const uint32_t count = s.Count(cur, bucket);
+                heads.fill(NIL);
+                for (uint32_t i = 0; i < count; i++) {
+                    const unsigned char* a = entries + i * inBytes;
+                    const uint32_t rest = RestOf(a);
+                    for (uint16_t j = heads[rest]; j != NIL; j = chain[j]) {
+                        const unsigned char* b = entries + j * inBytes;
+                        unsigned char x[NodeBytes(1)];
+                        unsigned char any = 0;
+                        for (size_t t = 0; t < outBytes; t++) {
+                            x[t] = a[COLLISION_BYTE_LENGTH + t] ^ b[COLLISION_BYTE_LENGTH + t];
+                            any |= x[t];
+                        }
+                        // A pair that cancels out entirely almost always
+                        // shares leaves, which no solution may
+                        if (!any) continue;
+                        const uint32_t nextBucket = BucketOf(x);
+                        const uint32_t slot = s.counts[next][nextBucket].fetch_add(1, std::memory_order_relaxed);
+                        if (slot >= BUCKET_SLOTS) continue;
+                        const size_t index = size_t{nextBucket} * BUCKET_SLOTS + slot;
+                        std::memcpy(&s.nodes[next][index * outBytes], x, outBytes);
+                        s.refs[level + 1][index] = uint32_t(bucket) << 2 * SLOT_BITS | uint32_t{j} << SLOT_BITS | i;
+                    }
+                    chain[i] = heads[rest];
+                    heads[rest] = i;
+                }
+            }
+        });
+    }
+    if (interrupted()) return 0;
+
+    // Level K-1: the last chunk has to cancel out in all of its bits. Of the
+    // pairs that do, those without a repeated leaf are solutions.
+    const int last = (K - 1) & 1;
+    std::mutex foundMutex;
+    std::atomic<bool> stop{false};
+    size_t numFound = 0;
+    RunParallel(m_numThreads, NUM_BUCKETS, [&](size_t begin, size_t end) {
+        std::array<uint16_t, NUM_RESTS> heads;
+        std::array<uint16_t, BUCKET_SLOTS> chain;
+        std::vector<uint32_t> indices(NUM_INDICES);
+        std::vector<uint32_t> sorted(NUM_INDICES);
+        constexpr size_t half = NUM_INDICES / 2;
+        for (size_t bucket = begin; bucket < end && !stop.load(std::memory_order_relaxed); bucket++) {
+            const unsigned char* entries = &s.nodes[last][bucket * BUCKET_SLOTS * COLLISION_BYTE_LENGTH];
+            const uint32_t count = s.Count(last, bucket);
+            heads.fill(NIL);
+            for (uint32_t i = 0; i < count; i++) {
+                const unsigned char* a = entries + i * COLLISION_BYTE_LENGTH;
+                const uint32_t rest = RestOf(a);
+                for (uint16_t j = heads[rest]; j != NIL; j = chain[j]) {
+                    const unsigned char* b = entries + j * COLLISION_BYTE_LENGTH;
+                    if ((a[2] ^ b[2]) & 0xF0) continue;
+
+                    const size_t base = bucket * BUCKET_SLOTS;
+                    s.CollectIndices(K - 1, base + j, indices.data());
+                    s.CollectIndices(K - 1, base + i, indices.data() + half);
+                    if (indices[0] > indices[half]) {
+                        std::swap_ranges(indices.begin(), indices.begin() + half, indices.begin() + half);
+                    }
+                    std::copy(indices.begin(), indices.end(), sorted.begin());
+                    std::sort(sorted.begin(), sorted.end());
+                    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) continue;
+
+                    std::lock_guard<std::mutex> lock(foundMutex);
+                    if (stop) break;
+                    numFound++;
+                    if (found(indices)) stop = true;
+                }
+                if (stop.load(std::memory_order_relaxed)) break;
+                chain[i] = heads[rest];
+                heads[rest] = i;
+            }
+        }
+    });
+
+    return numFound;
+}
+
+} // namespace equihash
@@ -5,6 +5,8 @@
 // Based on https://github.com/mjosaarinen/tiny_sha3/blob/master/sha3.c
 // by Markku-Juhani O. Saarinen <mjos@iki.fi>
 
+#include <bitcoin-build-config.h> // IWYU pragma: keep
+
 #include <crypto/sha3.h>
 #include <crypto/common.h>
 #include <span.h>
@@ -12,9 +14,98 @@
 #include <algorithm>
 #include <array> // For std::begin and std::end.
 #include <bit>
+#include <cassert>
+#include <cstring>
+#include <vector>
 
 #include <stdint.h>
 
+#include <compat/cpuid.h>
+
+#include <ethash/keccak.h>
+
+#if defined(ENABLE_AVX2)
+namespace sha3_avx2
+{
+void KeccakF_4way(uint64_t* st);
+}
+#endif
+
+namespace {
+//! Keccak-f[1600] on four interleaved states, word i of state j at st[4 * i + j]
+typedef void (*KeccakF4Type)(uint64_t* st);
+
+KeccakF4Type KeccakF_4way = nullptr;
+
+//! KeccakF() for ethash, whose Keccak functions take the state as a plain pointer
+void KeccakF_ethash(uint64_t state[25])
+{
+    KeccakF(*reinterpret_cast<uint64_t(*)[25]>(state));
+}
+
+//! Sponge rate of Keccak-256 in bytes.
+constexpr size_t KECCAK256_RATE = 136;
+
+//! Number of sponge blocks a padded input spans.
+size_t KeccakBlocks(size_t size) { return size / KECCAK256_RATE + 1; }
+
+//! XOR block `block` of the padded input into a state whose words are stride apart.
+void KeccakAbsorb(uint64_t* st, size_t stride, Span<const unsigned char> input, size_t block)
+{
+    const size_t offset = block * KECCAK256_RATE;
+    const unsigned char* data = input.data() + offset;
+    unsigned char last[KECCAK256_RATE];
+    if (input.size() - offset < KECCAK256_RATE) {
+        const size_t size = input.size() - offset;
+        std::fill(std::begin(last), std::end(last), 0);
+        if (size) std::memcpy(last, data, size);
+        last[size] ^= 0x01;
+        last[KECCAK256_RATE - 1] ^= 0x80;
+        data = last;
+    }
+    for (size_t i = 0; i < KECCAK256_RATE / 8; ++i) {
+        st[i * stride] ^= ReadLE64(data + 8 * i);
+    }
+}
+
+void KeccakSqueeze(const uint64_t* st, size_t stride, Span<unsigned char> output)
+{
+    for (size_t i = 0; i < KECCAK256_OUTPUT_SIZE / 8; ++i) {
+        WriteLE64(output.data() + 8 * i, st[i * stride]);
+    }
+}
+
+#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+
+/** Check the batch against single hashes, with inputs that span one to
+ *  three blocks and end at and around a block boundary. */
+bool SelfTest()
+{
+    std::vector<unsigned char> data(3 * KECCAK256_RATE);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = i * 7 + 1;
+    static constexpr size_t SIZES[] = {0, 1, 135, 136, 137, 200, 271, 272, 300};
+    std::vector<Span<const unsigned char>> inputs;
+    for (size_t size : SIZES) inputs.emplace_back(data.data(), size);
+
+    std::vector<unsigned char> batch(inputs.size() * KECCAK256_OUTPUT_SIZE);
+    Keccak256Many(inputs, batch);
+    unsigned char single[KECCAK256_OUTPUT_SIZE];
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        Keccak256(inputs[i], single);
+        if (!std::equal(single, single + KECCAK256_OUTPUT_SIZE, batch.begin() + i * KECCAK256_OUTPUT_SIZE)) return false;
+    }
+    return true;
+}
+} // namespace
+
 void KeccakF(uint64_t (&st)[25])
 {
     static constexpr uint64_t RNDC[24] = {
@@ -154,3 +245,84 @@ SHA3_256& SHA3_256::Reset()
     std::fill(std::begin(m_state), std::end(m_state), 0);
     return *this;
 }
+
+void Keccak256(Span<const unsigned char> input, Span<unsigned char> output)
+{
+    assert(output.size() == KECCAK256_OUTPUT_SIZE);
+    uint64_t st[25] = {0};
+    const size_t blocks = KeccakBlocks(input.size());
+    for (size_t block = 0; block < blocks; ++block) {
+        KeccakAbsorb(st, 1, input, block);
+        KeccakF(st);
+    }
+    KeccakSqueeze(st, 1, output);
+}
+
+void Keccak256Many(Span<const Span<const unsigned char>> inputs, Span<unsigned char> output)
+{
+    assert(output.size() == inputs.size() * KECCAK256_OUTPUT_SIZE);
+    size_t i = 0;
+    if (KeccakF_4way) {
+        for (; i + 4 <= inputs.size(); i += 4) {
+            // Each lane is squeezed after its last block, the transforms the
+            // longer inputs still need do not matter to it
+            uint64_t st[25 * 4] = {0};
+            size_t blocks[4];
+            size_t max_blocks = 0;
+            for (size_t lane = 0; lane < 4; ++lane) {
+                blocks[lane] = KeccakBlocks(inputs[i + lane].size());
+                max_blocks = std::max(max_blocks, blocks[lane]);
+            }
+            for (size_t block = 0; block < max_blocks; ++block) {
+                for (size_t lane = 0; lane < 4; ++lane) {
+                    if (block < blocks[lane]) KeccakAbsorb(st + lane, 4, inputs[i + lane], block);
+                }
+                KeccakF_4way(st);
+                for (size_t lane = 0; lane < 4; ++lane) {
+                    if (block + 1 == blocks[lane]) {
+                        KeccakSqueeze(st + lane, 4, output.subspan((i + lane) * KECCAK256_OUTPUT_SIZE, KECCAK256_OUTPUT_SIZE));
+                    }
+                }
+            }
+        }
+    }
+    for (; i < inputs.size(); ++i) {
+        Keccak256(inputs[i], output.subspan(i * KECCAK256_OUTPUT_SIZE, KECCAK256_OUTPUT_SIZE));
+    }
+}
+
+std::string SHA3AutoDetect(sha3_implementation::UseImplementation use_implementation)
+{
+    std::string ret = "standard";
+    KeccakF_4way = nullptr;
+
+#if defined(HAVE_GETCPUID)
+    [[maybe_unused]] bool have_avx2 = false;
+    [[maybe_unused]] bool enabled_avx = false;
+
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx) {
+        enabled_avx = AVXEnabled();
+    }
+    if (use_implementation & sha3_implementation::USE_AVX2) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        have_avx2 = (ebx >> 5) & 1;
+    }
+
+#if defined(ENABLE_AVX2)
+    if (have_avx2 && enabled_avx) {
+        KeccakF_4way = sha3_avx2::KeccakF_4way;
+        ret = "avx2(4way)";
+    }
+#endif
+#endif // defined(HAVE_GETCPUID)
+
+    assert(SelfTest());
+    // Ethash and the EVM hash through ethash's Keccak functions; give them
+    // the same permutation as everything else
+    ethash_keccakf1600_set(KeccakF_ethash);
+    return ret;
+}
@@ -9,6 +9,7 @@
 
 #include <cstdlib>
 #include <stdint.h>
+#include <string>
 
 //! The Keccak-f[1600] transform.
 void KeccakF(uint64_t (&st)[25]);
@@ -38,4 +39,29 @@ public:
     SHA3_256& Reset();
 };
 
+static constexpr size_t KECCAK256_OUTPUT_SIZE = 32;
+
+//! Keccak-256, SHA3-256 with the original padding, as used by Ethereum and Monero.
+void Keccak256(Span<const unsigned char> input, Span<unsigned char> output);
+
+/** Compute the Keccak-256 of several inputs into consecutive outputs.
+ *  Inputs are hashed four at a time when the CPU allows it, which pays off
+ *  most when they are about the same length.
+ *  output:  KECCAK256_OUTPUT_SIZE bytes per input
+ */
+void Keccak256Many(Span<const Span<const unsigned char>> inputs, Span<unsigned char> output);
+
+namespace sha3_implementation {
+enum UseImplementation : uint8_t {
+    STANDARD = 0,
+    USE_AVX2 = 1 << 0,
+    USE_ALL = USE_AVX2,
+};
+}
+
+/** Autodetect the best available multi-buffer Keccak-f[1600] implementation.
+ *  Returns the name of the implementation.
+ */
+std::string SHA3AutoDetect(sha3_implementation::UseImplementation use_implementation = sha3_implementation::USE_ALL);
+
 #endif // BITCOIN_CRYPTO_SHA3_H
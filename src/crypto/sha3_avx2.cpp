@@ -0,0 +1,122 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace sha3_avx2 {
+namespace {
+
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z) { return Xor(Xor(x, y), z); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Xor(Xor(x, y, z), Xor(w, v)); }
+/** x ^ (~y & z), the Chi step */
+__m256i inline XorAndNot(__m256i x, __m256i y, __m256i z) { return Xor(x, _mm256_andnot_si256(y, z)); }
+__m256i inline Rotl(__m256i x, int n) { return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n)); }
+
+} // namespace
+
+/** Keccak-f[1600] on four states at once, see KeccakF(). Word i of state j is st[4 * i + j]. */
+void KeccakF_4way(uint64_t* st)
+{
+    static constexpr uint64_t RNDC[24] = {
+        0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+        0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+        0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+        0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+        0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+        0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+    };
+    static constexpr int ROUNDS = 24;
+
+    __m256i s[25];
+    for (int i = 0; i < 25; ++i) {
+        s[i] = _mm256_loadu_si256((const __m256i*)(st + 4 * i));
+    }
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        __m256i bc0, bc1, bc2, bc3, bc4, t;
+
+        // Theta
+        bc0 = Xor(s[0], s[5], s[10], s[15], s[20]);
+        bc1 = Xor(s[1], s[6], s[11], s[16], s[21]);
+        bc2 = Xor(s[2], s[7], s[12], s[17], s[22]);
+        bc3 = Xor(s[3], s[8], s[13], s[18], s[23]);
+        bc4 = Xor(s[4], s[9], s[14], s[19], s[24]);
+        t = Xor(bc4, Rotl(bc1, 1)); s[0] = Xor(s[0], t); s[5] = Xor(s[5], t); s[10] = Xor(s[10], t); s[15] = Xor(s[15], t); s[20] = Xor(s[20], t);
+        t = Xor(bc0, Rotl(bc2, 1)); s[1] = Xor(s[1], t); s[6] = Xor(s[6], t); s[11] = Xor(s[11], t); s[16] = Xor(s[16], t); s[21] = Xor(s[21], t);
+        t = Xor(bc1, Rotl(bc3, 1)); s[2] = Xor(s[2], t); s[7] = Xor(s[7], t); s[12] = Xor(s[12], t); s[17] = Xor(s[17], t); s[22] = Xor(s[22], t);
+        t = Xor(bc2, Rotl(bc4, 1)); s[3] = Xor(s[3], t); s[8] = Xor(s[8], t); s[13] = Xor(s[13], t); s[18] = Xor(s[18], t); s[23] = Xor(s[23], t);
+        t = Xor(bc3, Rotl(bc0, 1)); s[4] = Xor(s[4], t); s[9] = Xor(s[9], t); s[14] = Xor(s[14], t); s[19] = Xor(s[19], t); s[24] = Xor(s[24], t);
+
+        // Rho Pi
+        t = s[1];
+        bc0 = s[10]; s[10] = Rotl(t, 1); t = bc0;
+        bc0 = s[7]; s[7] = Rotl(t, 3); t = bc0;
+        bc0 = s[11]; s[11] = Rotl(t, 6); t = bc0;
+        bc0 = s[17]; s[17] = Rotl(t, 10); t = bc0;
+        bc0 = s[18]; s[18] = Rotl(t, 15); t = bc0;
+        bc0 = s[3]; s[3] = Rotl(t, 21); t = bc0;
+        bc0 = s[5]; s[5] = Rotl(t, 28); t = bc0;
+        bc0 = s[16]; s[16] = Rotl(t, 36); t = bc0;
+        bc0 = s[8]; s[8] = Rotl(t, 45); t = bc0;
+        bc0 = s[21]; s[21] = Rotl(t, 55); t = bc0;
+        bc0 = s[24]; s[24] = Rotl(t, 2); t = bc0;
+        bc0 = s[4]; s[4] = Rotl(t, 14); t = bc0;
+        bc0 = s[15]; s[15] = Rotl(t, 27); t = bc0;
+        bc0 = s[23]; s[23] = Rotl(t, 41); t = bc0;
+        bc0 = s[19]; s[19] = Rotl(t, 56); t = bc0;
+        bc0 = s[13]; s[13] = Rotl(t, 8); t = bc0;
+        bc0 = s[12]; s[12] = Rotl(t, 25); t = bc0;
+        bc0 = s[2]; s[2] = Rotl(t, 43); t = bc0;
+        bc0 = s[20]; s[20] = Rotl(t, 62); t = bc0;
+        bc0 = s[14]; s[14] = Rotl(t, 18); t = bc0;
+        bc0 = s[22]; s[22] = Rotl(t, 39); t = bc0;
+        bc0 = s[9]; s[9] = Rotl(t, 61); t = bc0;
+        bc0 = s[6]; s[6] = Rotl(t, 20); t = bc0;
+        s[1] = Rotl(t, 44);
+
+        // Chi Iota
+        bc0 = s[0]; bc1 = s[1]; bc2 = s[2]; bc3 = s[3]; bc4 = s[4];
+        s[0] = Xor(XorAndNot(bc0, bc1, bc2), _mm256_set1_epi64x(RNDC[round]));
+        s[1] = XorAndNot(bc1, bc2, bc3);
+        s[2] = XorAndNot(bc2, bc3, bc4);
+        s[3] = XorAndNot(bc3, bc4, bc0);
+        s[4] = XorAndNot(bc4, bc0, bc1);
+        bc0 = s[5]; bc1 = s[6]; bc2 = s[7]; bc3 = s[8]; bc4 = s[9];
+        s[5] = XorAndNot(bc0, bc1, bc2);
+        s[6] = XorAndNot(bc1, bc2, bc3);
+        s[7] = XorAndNot(bc2, bc3, bc4);
+        s[8] = XorAndNot(bc3, bc4, bc0);
+        s[9] = XorAndNot(bc4, bc0, bc1);
+        bc0 = s[10]; bc1 = s[11]; bc2 = s[12]; bc3 = s[13]; bc4 = s[14];
+        s[10] = XorAndNot(bc0, bc1, bc2);
+        s[11] = XorAndNot(bc1, bc2, bc3);
+        s[12] = XorAndNot(bc2, bc3, bc4);
+        s[13] = XorAndNot(bc3, bc4, bc0);
+        s[14] = XorAndNot(bc4, bc0, bc1);
+        bc0 = s[15]; bc1 = s[16]; bc2 = s[17]; bc3 = s[18]; bc4 = s[19];
+        s[15] = XorAndNot(bc0, bc1, bc2);
+        s[16] = XorAndNot(bc1, bc2, bc3);
+        s[17] = XorAndNot(bc2, bc3, bc4);
+        s[18] = XorAndNot(bc3, bc4, bc0);
+        s[19] = XorAndNot(bc4, bc0, bc1);
+        bc0 = s[20]; bc1 = s[21]; bc2 = s[22]; bc3 = s[23]; bc4 = s[24];
+        s[20] = XorAndNot(bc0, bc1, bc2);
+        s[21] = XorAndNot(bc1, bc2, bc3);
+        s[22] = XorAndNot(bc2, bc3, bc4);
+        s[23] = XorAndNot(bc3, bc4, bc0);
+        s[24] = XorAndNot(bc4, bc0, bc1);
+    }
+
+    for (int i = 0; i < 25; ++i) {
+        _mm256_storeu_si256((__m256i*)(st + 4 * i), s[i]);
+    }
+}
+
+} // namespace sha3_avx2
+
+#endif
@@ -294,7 +294,7 @@ void sph_bmw512_close(sph_bmw512_context *cc, void *dst)
  * Groestl-512
  * ============================================================ */
 
-static const sph_u64 GROESTL_T0[256] = {
+const sph_u64 sph_groestl_T0[256] = {
     SPH_C64(0xc632f4a5f497a5c6), SPH_C64(0xf86f978497eb84f8),
     SPH_C64(0xee5eb099b0c799ee), SPH_C64(0xf67a8c8d8cf78df6),
     SPH_C64(0xffe8170d17e50dff), SPH_C64(0xd60adcbddcb7bdd6),
@@ -444,9 +444,9 @@ static void groestl512_compress(sph_groestl512_context *cc, const unsigned char
         /* SubBytes, ShiftBytes, MixBytes (simplified) */
         sph_u64 T[16];
         for (int i = 0; i < 16; i++) {
-            T[i] = GROESTL_T0[(unsigned char)Q[i]];
+            T[i] = sph_groestl_T0[(unsigned char)Q[i]];
             for (int j = 1; j < 8; j++)
-                T[i] ^= SPH_ROTL64(GROESTL_T0[(unsigned char)(Q[(i + j) % 16] >> (j * 8))], j * 8);
+                T[i] ^= SPH_ROTL64(sph_groestl_T0[(unsigned char)(Q[(i + j) % 16] >> (j * 8))], j * 8);
         }
         memcpy(Q, T, sizeof(Q));
     }
@@ -460,9 +460,9 @@ static void groestl512_compress(sph_groestl512_context *cc, const unsigned char
 
         sph_u64 T[16];
         for (int i = 0; i < 16; i++) {
-            T[i] = GROESTL_T0[(unsigned char)R[i]];
+            T[i] = sph_groestl_T0[(unsigned char)R[i]];
             for (int j = 1; j < 8; j++)
-                T[i] ^= SPH_ROTL64(GROESTL_T0[(unsigned char)(R[(i + j) % 16] >> (j * 8))], j * 8);
+                T[i] ^= SPH_ROTL64(sph_groestl_T0[(unsigned char)(R[(i + j) % 16] >> (j * 8))], j * 8);
         }
         memcpy(R, T, sizeof(R));
     }
@@ -519,9 +519,9 @@ void sph_groestl512_close(sph_groestl512_context *cc, void *dst)
             H[i] ^= ((sph_u64)(i * 0x10) ^ ((sph_u64)r << 56));
         sph_u64 T[16];
         for (int i = 0; i < 16; i++) {
-            T[i] = GROESTL_T0[(unsigned char)H[i]];
+            T[i] = sph_groestl_T0[(unsigned char)H[i]];
             for (int j = 1; j < 8; j++)
-                T[i] ^= SPH_ROTL64(GROESTL_T0[(unsigned char)(H[(i + j) % 16] >> (j * 8))], j * 8);
+                T[i] ^= SPH_ROTL64(sph_groestl_T0[(unsigned char)(H[(i + j) % 16] >> (j * 8))], j * 8);
         }
         memcpy(H, T, sizeof(H));
     }
@@ -55,6 +55,9 @@ void sph_groestl512_init(sph_groestl512_context *cc);
 void sph_groestl512(sph_groestl512_context *cc, const void *data, size_t len);
 void sph_groestl512_close(sph_groestl512_context *cc, void *dst);
 
+/* Round table, shared with the X11 engine's unrolled Groestl */
+extern const sph_u64 sph_groestl_T0[256];
+
 /* ============== JH ============== */
 
 typedef struct {
@@ -0,0 +1,303 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/x25x/ethash_cache.h>
+
+#include <crypto/common.h>
+#include <crypto/sha256.h>
+#include <logging.h>
+#include <tinyformat.h>
+#include <util/fs_helpers.h>
+#include <util/strencodings.h>
+#include <util/threadnames.h>
+
+#include <ethash/ethash.h>
+
+#include <cstdio>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace x25x {
+
+// File layout: a 64-byte header followed by the light cache items, so the
+// items stay 64-byte aligned in the mapping
+//   bytes 0-7:   magic "WTXETHC\0"
+//   bytes 8-11:  format version (LE)
+//   bytes 12-15: epoch (LE)
+//   bytes 16-19: light cache item count (LE)
+//   bytes 20-51: SHA256 of the light cache items
+static constexpr size_t CACHE_HEADER_SIZE = 64;
+static constexpr char CACHE_MAGIC[8] = {'W', 'T', 'X', 'E', 'T', 'H', 'C', 0};
+
+struct EthashCache::Entry {
+    ethash_epoch_context context;
+    //! Set when the cache was built in this process
+    ethash_epoch_context* built{nullptr};
+#ifndef WIN32
+    void* map{nullptr};
+    size_t map_size{0};
+#else
+    std::unique_ptr<unsigned char[]> buffer;
+#endif
+
+    Entry(int epoch, int num_items, const ethash_hash512* light_cache)
+        : context{epoch, num_items, light_cache, ethash_calculate_full_dataset_num_items(epoch)} {}
+
+    ~Entry()
+    {
+        if (built) ethash_destroy_epoch_context(built);
+#ifndef WIN32
+        if (map) munmap(map, map_size);
+#endif
+    }
+};
+
+static void ChecksumCache(const unsigned char* data, size_t size, unsigned char out[CSHA256::OUTPUT_SIZE])
+{
+    CSHA256().Write(data, size).Finalize(out);
+}
+
+static std::unique_ptr<EthashCache> g_ethash_cache;
+
+EthashCache& GetEthashCache()
+{
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        g_ethash_cache = std::make_unique<EthashCache>();
+    });
+    return *g_ethash_cache;
+}
+
+EthashCache::EthashCache() = default;
+
+EthashCache::~EthashCache()
+{
+    std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+    if (m_prefetch_thread.joinable()) m_prefetch_thread.join();
+}
+
+void EthashCache::SetDirectory(const fs::path& dir)
+{
+    if (!dir.empty() && !TryCreateDirectories(dir) && !fs::is_directory(dir)) {
+        LogPrintf("Ethash: Cannot create cache directory %s, keeping caches in memory\n", fs::PathToString(dir));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dir = dir;
+}
+
+fs::path EthashCache::GetCachePath(int epoch) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_dir.empty()) return {};
+    return m_dir / fs::u8path(strprintf("epoch-%d.cache", epoch));
+}
+
+std::shared_ptr<EthashCache::Entry> EthashCache::Find(int epoch)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if ((*it)->context.epoch_number == epoch) {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return m_entries.front();
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const ethash_epoch_context> EthashCache::GetContext(int epoch)
+{
+    if (epoch < 0 || epoch > ETHASH_MAX_EPOCH_NUMBER) return nullptr;
+
+    std::shared_ptr<Entry> entry = Find(epoch);
+    if (!entry) {
+        std::lock_guard<std::mutex> build_lock(m_build_mutex);
+        entry = Find(epoch);
+        if (!entry) {
+            entry = LoadOrBuild(epoch);
+            if (!entry) return nullptr;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.push_front(entry);
+            // Evicted entries are freed once the last caller releases them
+            while (m_entries.size() > MAX_EPOCHS) m_entries.pop_back();
+        }
+    }
+    return std::shared_ptr<const ethash_epoch_context>(entry, &entry->context);
+}
+
+std::shared_ptr<EthashCache::Entry> EthashCache::LoadOrBuild(int epoch)
+{
+    const fs::path path = GetCachePath(epoch);
+    if (!path.empty()) {
+        if (auto entry = Load(epoch)) return entry;
+    }
+
+    LogPrintf("Ethash: Building light cache for epoch %d...\n", epoch);
+    ethash_epoch_context* built = ethash_create_epoch_context(epoch);
+    if (!built) {
+        LogPrintf("Ethash: Failed to allocate light cache for epoch %d\n", epoch);
+        return nullptr;
+    }
+    auto entry = std::make_shared<Entry>(epoch, built->light_cache_num_items, built->light_cache);
+    entry->built = built;
+
+    if (!path.empty() && Save(*entry)) {
+        PruneFiles(epoch);
+    }
+    return entry;
+}
+
+std::shared_ptr<EthashCache::Entry> EthashCache::Load(int epoch)
+{
+    const fs::path path = GetCachePath(epoch);
+    const int num_items = ethash_calculate_light_cache_num_items(epoch);
+    const size_t cache_size = static_cast<size_t>(num_items) * ETHASH_LIGHT_CACHE_ITEM_SIZE;
+    const size_t file_size = CACHE_HEADER_SIZE + cache_size;
+
+    const unsigned char* data = nullptr;
+    std::shared_ptr<Entry> entry;
+
+#ifndef WIN32
+    int fd = open(fs::PathToString(path).c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) == file_size) {
+        map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        LogPrintf("Ethash: Cache file for epoch %d has the wrong size, rebuilding\n", epoch);
+        std::error_code ec;
+        fs::remove(path, ec);
+        return nullptr;
+    }
+    data = static_cast<const unsigned char*>(map);
+    entry = std::make_shared<Entry>(epoch, num_items,
+                                    reinterpret_cast<const ethash_hash512*>(data + CACHE_HEADER_SIZE));
+    entry->map = map;
+    entry->map_size = file_size;
+#else
+    FILE* file = fsbridge::fopen(path, "rb");
+    if (!file) return nullptr;
+
+    auto buffer = std::make_unique<unsigned char[]>(file_size + 1);
+    size_t read = std::fread(buffer.get(), 1, file_size + 1, file);
+    std::fclose(file);
+    if (read != file_size) {
+        LogPrintf("Ethash: Cache file for epoch %d has the wrong size, rebuilding\n", epoch);
+        std::error_code ec;
+        fs::remove(path, ec);
+        return nullptr;
+    }
+    data = buffer.get();
+    entry = std::make_shared<Entry>(epoch, num_items,
+                                    reinterpret_cast<const ethash_hash512*>(data + CACHE_HEADER_SIZE));
+    entry->buffer = std::move(buffer);
+#endif
+
+    unsigned char checksum[CSHA256::OUTPUT_SIZE];
+    ChecksumCache(data + CACHE_HEADER_SIZE, cache_size, checksum);
+
+    if (std::memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        ReadLE32(data + 8) != FILE_VERSION ||
+        static_cast<int>(ReadLE32(data + 12)) != epoch ||
+        static_cast<int>(ReadLE32(data + 16)) != num_items ||
+        std::memcmp(data + 20, checksum, sizeof(checksum)) != 0) {
+        LogPrintf("Ethash: Cache file for epoch %d failed verification, rebuilding\n", epoch);
+        entry.reset();
+        std::error_code ec;
+        fs::remove(path, ec);
+        return nullptr;
+    }
+
+    LogPrintf("Ethash: Loaded light cache for epoch %d from %s\n", epoch, fs::PathToString(path));
+    return entry;
+}
+
+bool EthashCache::Save(const Entry& entry)
+{
+    const int epoch = entry.context.epoch_number;
+    const fs::path path = GetCachePath(epoch);
+    fs::path tmp = path;
+    tmp += ".tmp";
+
+    const auto* cache = reinterpret_cast<const unsigned char*>(entry.context.light_cache);
+    const size_t cache_size = static_cast<size_t>(entry.context.light_cache_num_items) * ETHASH_LIGHT_CACHE_ITEM_SIZE;
+
+    unsigned char header[CACHE_HEADER_SIZE] = {};
+    std::memcpy(header, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    WriteLE32(header + 8, FILE_VERSION);
+    WriteLE32(header + 12, static_cast<uint32_t>(epoch));
+    WriteLE32(header + 16, static_cast<uint32_t>(entry.context.light_cache_num_items));
+    ChecksumCache(cache, cache_size, header + 20);
+
+    FILE* file = fsbridge::fopen(tmp, "wb");
+    if (!file) {
+        LogPrintf("Ethash: Cannot write cache file %s\n", fs::PathToString(tmp));
+        return false;
+    }
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              std::fwrite(cache, 1, cache_size, file) == cache_size &&
+              FileCommit(file);
+    ok = (std::fclose(file) == 0) && ok;
+
+    // Write to a temporary name first so a crash never leaves a partial file
+    if (!ok || !RenameOver(tmp, path)) {
+        LogPrintf("Ethash: Failed to save light cache for epoch %d\n", epoch);
+        std::error_code ec;
+        fs::remove(tmp, ec);
+        return false;
+    }
+    LogPrintf("Ethash: Saved light cache for epoch %d to %s\n", epoch, fs::PathToString(path));
+    return true;
+}
+
+void EthashCache::PruneFiles(int epoch)
+{
+    fs::path dir;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dir = m_dir;
+    }
+
+    // Keep the neighbouring epochs for reorgs across the boundary
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(dir, ec)) {
+        const std::string name = fs::PathToString(file.path().filename());
+        if (name.rfind("epoch-", 0) != 0 || name.size() <= 12 || name.substr(name.size() - 6) != ".cache") continue;
+        auto file_epoch = ToIntegral<int>(std::string_view(name).substr(6, name.size() - 12));
+        if (file_epoch && (*file_epoch < epoch - 1 || *file_epoch > epoch + 1)) {
+            fs::remove(file.path(), ec);
+        }
+    }
+}
+
+void EthashCache::MaybePrefetch(uint64_t height)
+{
+    if (height % ETHASH_EPOCH_LENGTH < ETHASH_EPOCH_LENGTH - PREFETCH_BLOCKS) return;
+
+    const int next = static_cast<int>(height / ETHASH_EPOCH_LENGTH) + 1;
+    if (next > ETHASH_MAX_EPOCH_NUMBER) return;
+
+    std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+    if (m_prefetch_epoch == next) return;
+    if (m_prefetch_thread.joinable()) m_prefetch_thread.join();
+
+    m_prefetch_epoch = next;
+    m_prefetch_thread = std::thread([this, next] {
+        util::ThreadRename("ethashcache");
+        GetContext(next);
+    });
+}
+
+} // namespace x25x
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_X25X_ETHASH_CACHE_H
+#define BITCOIN_CRYPTO_X25X_ETHASH_CACHE_H
+
+#include <util/fs.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct ethash_epoch_context;
+
+namespace x25x {
+
+/**
+ * Ethash epoch light caches, persisted under the datadir
+ *
+ * Building an epoch's light cache takes seconds, and the global ethash
+ * context manager rebuilt it after every restart before the first Ethash
+ * block could be checked. Each cache is written once to
+ * <datadir>/ethash/epoch-<n>.cache, with a SHA256 checksum, and mapped read-only
+ * on later runs. Files that fail the size or checksum check are rebuilt.
+ *
+ * The next epoch is built in the background once the chain gets within
+ * PREFETCH_BLOCKS of an ETHASH_EPOCH_LENGTH boundary. Without a directory
+ * (before init, or in tools) caches are still shared but only kept in memory.
+ */
+class EthashCache {
+public:
+    //! Epoch caches kept resident (current and next)
+    static constexpr size_t MAX_EPOCHS = 2;
+    //! Blocks before an epoch boundary at which the next epoch is prefetched
+    static constexpr uint64_t PREFETCH_BLOCKS = 1000;
+    //! On-disk format version
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    EthashCache();
+    ~EthashCache();
+
+    EthashCache(const EthashCache&) = delete;
+    EthashCache& operator=(const EthashCache&) = delete;
+
+    /** Persist caches under @p dir (created if missing); empty keeps them in memory only. */
+    void SetDirectory(const fs::path& dir);
+
+    /**
+     * Get the light cache context for an epoch, loading it from disk or
+     * building (and saving) it on first use. The context remains valid for as
+     * long as the returned pointer is held.
+     * @return nullptr on allocation failure
+     */
+    std::shared_ptr<const ethash_epoch_context> GetContext(int epoch);
+
+    /** Prefetch the next epoch in the background if @p height is near its boundary. */
+    void MaybePrefetch(uint64_t height);
+
+    /** Path of the cache file for an epoch (empty without a directory). */
+    fs::path GetCachePath(int epoch) const;
+
+private:
+    struct Entry;
+
+    std::shared_ptr<Entry> Find(int epoch);
+    std::shared_ptr<Entry> LoadOrBuild(int epoch);
+    std::shared_ptr<Entry> Load(int epoch);
+    bool Save(const Entry& entry);
+    void PruneFiles(int epoch);
+
+    mutable std::mutex m_mutex;
+    fs::path m_dir;
+    //! Most recently used first
+    std::list<std::shared_ptr<Entry>> m_entries;
+
+    //! Serializes loading and building, so one epoch is never built twice
+    std::mutex m_build_mutex;
+
+    std::mutex m_prefetch_mutex;
+    std::thread m_prefetch_thread;
+    int m_prefetch_epoch{-1};
+};
+
+/**
+ * Global Ethash epoch cache
+ */
+EthashCache& GetEthashCache();
+
+} // namespace x25x
+
+#endif // BITCOIN_CRYPTO_X25X_ETHASH_CACHE_H
@@ -0,0 +1,216 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/x25x/scrypt.h>
+
+#include <crypto/common.h>
+#include <crypto/hmac_sha256.h>
+#include <crypto/x25x/scrypt_lanes.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(ENABLE_AVX2)
+#include <compat/cpuid.h>
+
+namespace scrypt_avx2 {
+void SMix8(uint32_t* X, uint32_t* V);
+}
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+
+namespace x25x {
+
+namespace {
+
+using scrypt::Block;
+using scrypt::SCRYPT_N;
+
+//! ROMix block size for r=1: 128 bytes, 32 words
+constexpr size_t BLOCK_WORDS = 32;
+constexpr size_t BLOCK_BYTES = BLOCK_WORDS * 4;
+
+struct ScalarOps {
+    using V = uint32_t;
+    static constexpr int LANES = 1;
+
+    static V Load(const uint32_t* p) { return *p; }
+    static void Store(uint32_t* p, V v) { *p = v; }
+    static V Add(V a, V b) { return a + b; }
+    static V Xor(V a, V b) { return a ^ b; }
+    template <int R>
+    static V Rotl(V a) { return (a << R) | (a >> (32 - R)); }
+};
+
+void SMix1(uint32_t* X, uint32_t* V)
+{
+    scrypt::SMix<ScalarOps>(*reinterpret_cast<Block<ScalarOps>*>(X), reinterpret_cast<Block<ScalarOps>*>(V));
+}
+
+#if defined(__SSE2__)
+struct Sse2Ops {
+    using V = __m128i;
+    static constexpr int LANES = 4;
+
+    static V Load(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void Store(uint32_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V Add(V a, V b) { return _mm_add_epi32(a, b); }
+    static V Xor(V a, V b) { return _mm_xor_si128(a, b); }
+    template <int R>
+    static V Rotl(V a) { return _mm_or_si128(_mm_slli_epi32(a, R), _mm_srli_epi32(a, 32 - R)); }
+};
+
+void SMix4(uint32_t* X, uint32_t* V)
+{
+    scrypt::SMix<Sse2Ops>(*reinterpret_cast<Block<Sse2Ops>*>(X), reinterpret_cast<Block<Sse2Ops>*>(V));
+}
+#endif
+
+struct Kernel {
+    void (*smix)(uint32_t* X, uint32_t* V);
+    size_t lanes;
+};
+
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID)
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+
+Kernel SelectKernel()
+{
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx && AVXEnabled()) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        if ((ebx >> 5) & 1) {
+            return {scrypt_avx2::SMix8, 8};
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    return {SMix4, 4};
+#else
+    return {SMix1, 1};
+#endif
+}
+
+const Kernel& GetKernel()
+{
+    static const Kernel kernel = SelectKernel();
+    return kernel;
+}
+
+/**
+ * HMAC-SHA256 keyed with the input. Keys longer than a block are replaced by
+ * their digest, which is where the shared 64-byte prefix midstate helps.
+ */
+CHMAC_SHA256 KeyedHmac(const unsigned char* data, size_t len, const CSHA256* prefix)
+{
+    if (len <= 64) return CHMAC_SHA256(data, len);
+
+    unsigned char key[CSHA256::OUTPUT_SIZE];
+    if (prefix) {
+        CSHA256(*prefix).Write(data + 64, len - 64).Finalize(key);
+    } else {
+        CSHA256().Write(data, len).Finalize(key);
+    }
+    return CHMAC_SHA256(key, sizeof(key));
+}
+
+/** PBKDF2-HMAC-SHA256 with one iteration, from an HMAC already keyed with the password. */
+void Pbkdf2(const CHMAC_SHA256& keyed, const unsigned char* salt, size_t salt_len, unsigned char* out, size_t out_len)
+{
+    CHMAC_SHA256 salted = keyed;
+    salted.Write(salt, salt_len);
+    for (uint32_t i = 1; out_len > 0; i++) {
+        unsigned char counter[4];
+        WriteBE32(counter, i);
+        unsigned char block[CHMAC_SHA256::OUTPUT_SIZE];
+        CHMAC_SHA256(salted).Write(counter, sizeof(counter)).Finalize(block);
+        const size_t n = std::min(out_len, sizeof(block));
+        std::copy(block, block + n, out);
+        out += n;
+        out_len -= n;
+    }
+}
+
+} // namespace
+
+ScryptHasher::ScryptHasher() = default;
+
+size_t ScryptHasher::GetLanes()
+{
+    return GetKernel().lanes;
+}
+
+uint256 ScryptHasher::Hash(const unsigned char* data, size_t len)
+{
+    uint256 hash;
+    HashGroup(&data, len, 1, &hash, nullptr);
+    return hash;
+}
+
+void ScryptHasher::HashMany(const unsigned char* const* inputs, size_t len, size_t count,
+                            uint256* out, const CSHA256* prefix)
+{
+    const size_t lanes = GetKernel().lanes;
+    while (count >= lanes) {
+        HashGroup(inputs, len, lanes, out, prefix);
+        inputs += lanes;
+        out += lanes;
+        count -= lanes;
+    }
+    // A short tail is cheaper one at a time than padded to a full group
+    for (size_t i = 0; i < count; i++) {
+        HashGroup(inputs + i, len, 1, out + i, prefix);
+    }
+}
+
+void ScryptHasher::HashGroup(const unsigned char* const* inputs, size_t len, size_t lanes,
+                             uint256* out, const CSHA256* prefix)
+{
+    // Single inputs use the scalar kernel and only a single lane's scratchpad
+    const Kernel kernel = lanes == 1 ? Kernel{SMix1, 1} : GetKernel();
+    assert(kernel.lanes == lanes);
+
+    const size_t scratch_words = SCRYPT_N * BLOCK_WORDS * lanes;
+    if (m_scratchpad.size() < scratch_words) m_scratchpad.resize(scratch_words);
+
+    alignas(32) uint32_t X[BLOCK_WORDS * MAX_LANES];
+    unsigned char B[MAX_LANES][BLOCK_BYTES];
+    std::optional<CHMAC_SHA256> keyed[MAX_LANES];
+
+    for (size_t l = 0; l < lanes; l++) {
+        keyed[l].emplace(KeyedHmac(inputs[l], len, prefix));
+        Pbkdf2(*keyed[l], inputs[l], len, B[l], BLOCK_BYTES);
+        for (size_t w = 0; w < BLOCK_WORDS; w++) X[w * lanes + l] = ReadLE32(B[l] + 4 * w);
+    }
+
+    kernel.smix(X, m_scratchpad.data());
+
+    for (size_t l = 0; l < lanes; l++) {
+        for (size_t w = 0; w < BLOCK_WORDS; w++) WriteLE32(B[l] + 4 * w, X[w * lanes + l]);
+        Pbkdf2(*keyed[l], B[l], BLOCK_BYTES, out[l].begin(), uint256::size());
+    }
+}
+
+ScryptHasher& GetThreadScryptHasher()
+{
+    static thread_local ScryptHasher hasher;
+    return hasher;
+}
+
+} // namespace x25x
@@ -0,0 +1,65 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_X25X_SCRYPT_H
+#define BITCOIN_CRYPTO_X25X_SCRYPT_H
+
+#include <crypto/sha256.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace x25x {
+
+/**
+ * Scrypt with the Litecoin parameters (N=1024, r=1, p=1, 32-byte output)
+ *
+ * libscrypt allocates a fresh 128 KiB scratchpad for every call and runs one
+ * input at a time. This engine keeps its scratchpad between calls and runs
+ * ROMix on several inputs in lockstep, interleaving their Salsa20/8 rounds
+ * across SSE2 (four lanes) or, when the CPU supports it, AVX2 (eight lanes)
+ * registers. Both PBKDF2 passes reuse one HMAC key schedule per input, and
+ * callers hashing many nonces of one header can pass the SHA-256 midstate of
+ * its first 64 bytes so the key digest only covers the tail.
+ *
+ * Not thread-safe; use one instance per thread (see GetThreadScryptHasher()).
+ */
+class ScryptHasher {
+public:
+    //! Most inputs hashed in lockstep, the width of the AVX2 kernel
+    static constexpr size_t MAX_LANES = 8;
+
+    ScryptHasher();
+
+    /** Hash a single input (password and salt are both @p data). */
+    uint256 Hash(const unsigned char* data, size_t len);
+
+    /**
+     * Hash @p count inputs of @p len bytes each, writing out[0..count).
+     * @param prefix  optional SHA-256 state after the first 64 bytes, which
+     *                must be identical across all inputs (ignored if len <= 64)
+     */
+    void HashMany(const unsigned char* const* inputs, size_t len, size_t count,
+                  uint256* out, const CSHA256* prefix = nullptr);
+
+    /** Inputs the active kernel hashes at once; batches of this size are cheapest. */
+    static size_t GetLanes();
+
+private:
+    /** Hash exactly @p lanes inputs with the kernel of that width. */
+    void HashGroup(const unsigned char* const* inputs, size_t len, size_t lanes,
+                   uint256* out, const CSHA256* prefix);
+
+    //! Grown on demand: 128 KiB per lane in use
+    std::vector<uint32_t> m_scratchpad;
+};
+
+/** The calling thread's ScryptHasher. */
+ScryptHasher& GetThreadScryptHasher();
+
+} // namespace x25x
+
+#endif // BITCOIN_CRYPTO_X25X_SCRYPT_H
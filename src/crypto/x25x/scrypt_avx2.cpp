@@ -0,0 +1,36 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <crypto/x25x/scrypt_lanes.h>
+
+#include <immintrin.h>
+
+namespace scrypt_avx2 {
+namespace {
+
+struct Avx2Ops {
+    using V = __m256i;
+    static constexpr int LANES = 8;
+
+    static V Load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void Store(uint32_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V Add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static V Xor(V a, V b) { return _mm256_xor_si256(a, b); }
+    template <int R>
+    static V Rotl(V a) { return _mm256_or_si256(_mm256_slli_epi32(a, R), _mm256_srli_epi32(a, 32 - R)); }
+};
+
+} // namespace
+
+void SMix8(uint32_t* X, uint32_t* V)
+{
+    using x25x::scrypt::Block;
+    x25x::scrypt::SMix<Avx2Ops>(*reinterpret_cast<Block<Avx2Ops>*>(X), reinterpret_cast<Block<Avx2Ops>*>(V));
+}
+
+} // namespace scrypt_avx2
+
+#endif
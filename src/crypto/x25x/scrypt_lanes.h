@@ -0,0 +1,109 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_X25X_SCRYPT_LANES_H
+#define BITCOIN_CRYPTO_X25X_SCRYPT_LANES_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Scrypt ROMix (N=1024, r=1) over several independent inputs in lockstep
+ *
+ * State is stored word-major, X[word][lane], so every Salsa20/8 step is the
+ * same operation across all lanes. The vector width comes from an Ops type
+ * supplied by the including translation unit:
+ *
+ *   using V = ...;                  // one 32-bit word for each lane
+ *   static constexpr int LANES;
+ *   static V Load(const uint32_t*); static void Store(uint32_t*, V);
+ *   static V Add(V, V); static V Xor(V, V);
+ *   template <int R> static V Rotl(V);
+ *
+ * Everything here has internal linkage so the AVX2 and generic builds of
+ * the same templates can never be merged by the linker.
+ */
+namespace x25x {
+namespace scrypt {
+namespace {
+
+constexpr unsigned int SCRYPT_N = 1024;
+
+template <typename Ops>
+using Block = uint32_t[2][16][Ops::LANES];
+
+template <typename Ops>
+inline void QuarterRound(typename Ops::V& a, typename Ops::V& b, typename Ops::V& c, typename Ops::V& d)
+{
+    b = Ops::Xor(b, Ops::template Rotl<7>(Ops::Add(a, d)));
+    c = Ops::Xor(c, Ops::template Rotl<9>(Ops::Add(b, a)));
+    d = Ops::Xor(d, Ops::template Rotl<13>(Ops::Add(c, b)));
+    a = Ops::Xor(a, Ops::template Rotl<18>(Ops::Add(d, c)));
+}
+
+/** B = Salsa20/8(B ^ Bx), the scrypt BlockMix step for r=1. */
+template <typename Ops>
+inline void XorSalsa8(uint32_t (&B)[16][Ops::LANES], const uint32_t (&Bx)[16][Ops::LANES])
+{
+    typename Ops::V b[16], x[16];
+    for (int i = 0; i < 16; i++) {
+        b[i] = Ops::Xor(Ops::Load(B[i]), Ops::Load(Bx[i]));
+        x[i] = b[i];
+    }
+    for (int i = 0; i < 8; i += 2) {
+        // Columns
+        QuarterRound<Ops>(x[0], x[4], x[8], x[12]);
+        QuarterRound<Ops>(x[5], x[9], x[13], x[1]);
+        QuarterRound<Ops>(x[10], x[14], x[2], x[6]);
+        QuarterRound<Ops>(x[15], x[3], x[7], x[11]);
+        // Rows
+        QuarterRound<Ops>(x[0], x[1], x[2], x[3]);
+        QuarterRound<Ops>(x[5], x[6], x[7], x[4]);
+        QuarterRound<Ops>(x[10], x[11], x[8], x[9]);
+        QuarterRound<Ops>(x[15], x[12], x[13], x[14]);
+    }
+    for (int i = 0; i < 16; i++) {
+        Ops::Store(B[i], Ops::Add(x[i], b[i]));
+    }
+}
+
+template <typename Ops>
+inline void BlockMix(Block<Ops>& X)
+{
+    XorSalsa8<Ops>(X[0], X[1]);
+    XorSalsa8<Ops>(X[1], X[0]);
+}
+
+/**
+ * ROMix with N=1024, r=1 on Ops::LANES blocks at once.
+ * @param X   block per lane, 32 little-endian words each
+ * @param V   scratchpad of SCRYPT_N blocks (128 KiB per lane)
+ */
+template <typename Ops>
+void SMix(Block<Ops>& X, Block<Ops>* V)
+{
+    constexpr int LANES = Ops::LANES;
+    for (unsigned int i = 0; i < SCRYPT_N; i++) {
+        for (int h = 0; h < 2; h++) {
+            for (int w = 0; w < 16; w++) Ops::Store(V[i][h][w], Ops::Load(X[h][w]));
+        }
+        BlockMix<Ops>(X);
+    }
+    for (unsigned int i = 0; i < SCRYPT_N; i++) {
+        // Each lane reads its own data-dependent block
+        for (int l = 0; l < LANES; l++) {
+            const unsigned int j = X[1][0][l] & (SCRYPT_N - 1);
+            for (int h = 0; h < 2; h++) {
+                for (int w = 0; w < 16; w++) X[h][w][l] ^= V[j][h][w][l];
+            }
+        }
+        BlockMix<Ops>(X);
+    }
+}
+
+} // namespace
+} // namespace scrypt
+} // namespace x25x
+
+#endif // BITCOIN_CRYPTO_X25X_SCRYPT_LANES_H
@@ -0,0 +1,228 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/x25x/x11_hasher.h>
+
+#include <crypto/common.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <array>
+#include <cstring>
+
+namespace x25x {
+
+namespace {
+
+constexpr size_t DIGEST_SIZE = 64;
+
+inline uint64_t Rotl64(uint64_t x, int n) { return (x << n) | (x >> (64 - n)); }
+
+// Groestl-512 as in sphlib/x11.c. Its round looks up T0 for each byte of a
+// column and rotates the result by the byte position; the eight rotations
+// are folded into eight tables here.
+
+using GroestlTables = std::array<std::array<uint64_t, 256>, 8>;
+
+const GroestlTables& GetGroestlTables()
+{
+    static const GroestlTables tables = [] {
+        GroestlTables t;
+        for (int j = 0; j < 8; j++) {
+            for (int b = 0; b < 256; b++) {
+                t[j][b] = j == 0 ? sph_groestl_T0[b] : Rotl64(sph_groestl_T0[b], j * 8);
+            }
+        }
+        return t;
+    }();
+    return tables;
+}
+
+/** 14 rounds of the P (mask = 0) or Q (mask = ~0) permutation. */
+void GroestlPermute(uint64_t (&x)[16], uint64_t mask, const GroestlTables& T)
+{
+    for (int r = 0; r < 14; r++) {
+        for (int i = 0; i < 16; i++) {
+            x[i] ^= mask ^ (static_cast<uint64_t>(i * 0x10) ^ (static_cast<uint64_t>(r) << 56));
+        }
+        uint64_t t[16];
+        for (int i = 0; i < 16; i++) {
+            t[i] = T[0][static_cast<uint8_t>(x[i])] ^
+                   T[1][static_cast<uint8_t>(x[(i + 1) & 15] >> 8)] ^
+                   T[2][static_cast<uint8_t>(x[(i + 2) & 15] >> 16)] ^
+                   T[3][static_cast<uint8_t>(x[(i + 3) & 15] >> 24)] ^
+                   T[4][static_cast<uint8_t>(x[(i + 4) & 15] >> 32)] ^
+                   T[5][static_cast<uint8_t>(x[(i + 5) & 15] >> 40)] ^
+                   T[6][static_cast<uint8_t>(x[(i + 6) & 15] >> 48)] ^
+                   T[7][static_cast<uint8_t>(x[(i + 7) & 15] >> 56)];
+        }
+        std::memcpy(x, t, sizeof(t));
+    }
+}
+
+/** sph_groestl512 init, update and close over exactly 64 bytes. */
+void Groestl64(const unsigned char* in, unsigned char* out)
+{
+    const GroestlTables& T = GetGroestlTables();
+
+    // The single padded block: message, 0x80, zeros, block count 1 (LE)
+    uint64_t M[16] = {};
+    for (int i = 0; i < 8; i++) M[i] = ReadLE64(in + i * 8);
+    M[8] = 0x80;
+    M[15] = 1;
+
+    uint64_t H[16] = {};
+    H[15] = 0x0002000000000000ULL;
+
+    uint64_t P[16], Q[16];
+    for (int i = 0; i < 16; i++) {
+        P[i] = H[i] ^ M[i];
+        Q[i] = M[i];
+    }
+    GroestlPermute(P, 0, T);
+    GroestlPermute(Q, ~uint64_t{0}, T);
+    for (int i = 0; i < 16; i++) H[i] ^= P[i] ^ Q[i];
+
+    // Output transformation
+    std::memcpy(P, H, sizeof(P));
+    GroestlPermute(P, 0, T);
+    for (int i = 8; i < 16; i++) WriteLE64(out + (i - 8) * 8, H[i] ^ P[i]);
+}
+
+// CubeHash-512 as in sphlib/x11.c, 16 rounds per 32-byte block and 32
+// finalization rounds.
+
+const uint32_t CUBEHASH_IV512[32] = {
+    0x2AEA2A61, 0x50F494D4, 0x2D538B8B, 0x4167D83E,
+    0x3FEE2313, 0xC701CF8C, 0xCC39968E, 0x50AC5695,
+    0x4D42C787, 0xA647A8B3, 0x97CF0BEF, 0x825B4537,
+    0xEEF864D2, 0xF22090C4, 0xD0E5CD33, 0xA23911AE,
+    0xFCD398D9, 0x148FE485, 0x1B017BEF, 0xB6444532,
+    0x6A536159, 0x2FF5781C, 0x91FA7934, 0x0DBADEA9,
+    0xD65C8A2B, 0xA5A70E75, 0xB1C62456, 0xBC796576,
+    0x1921C8F7, 0xE7989AF1, 0x7795D246, 0xD43E3B44
+};
+
+#if defined(__SSE2__)
+template <int R>
+inline __m128i Rotl(__m128i x) { return _mm_or_si128(_mm_slli_epi32(x, R), _mm_srli_epi32(x, 32 - R)); }
+
+/**
+ * CubeHash rounds with the state in eight registers, four words each.
+ * x[0..3] hold words 0-15 and x[4..7] words 16-31; the word permutations
+ * become register renames (i ^ 8, i ^ 4) and in-register shuffles (i ^ 2, i ^ 1).
+ */
+void CubeHashRounds(__m128i (&x)[8], int rounds)
+{
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < 4; i++) x[4 + i] = _mm_add_epi32(x[4 + i], x[i]);
+        __m128i a[4] = {Rotl<7>(x[2]), Rotl<7>(x[3]), Rotl<7>(x[0]), Rotl<7>(x[1])};
+        for (int i = 0; i < 4; i++) a[i] = _mm_xor_si128(a[i], x[4 + i]);
+        for (int i = 0; i < 4; i++) x[4 + i] = _mm_shuffle_epi32(x[4 + i], 0x4E);
+
+        for (int i = 0; i < 4; i++) x[4 + i] = _mm_add_epi32(x[4 + i], a[i]);
+        x[0] = Rotl<11>(a[1]);
+        x[1] = Rotl<11>(a[0]);
+        x[2] = Rotl<11>(a[3]);
+        x[3] = Rotl<11>(a[2]);
+        for (int i = 0; i < 4; i++) x[i] = _mm_xor_si128(x[i], x[4 + i]);
+        for (int i = 0; i < 4; i++) x[4 + i] = _mm_shuffle_epi32(x[4 + i], 0xB1);
+    }
+}
+
+/** sph_cubehash512 init, update and close over exactly 64 bytes. */
+void CubeHash64(const unsigned char* in, unsigned char* out)
+{
+    __m128i x[8];
+    for (int i = 0; i < 8; i++) x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(CUBEHASH_IV512) + i);
+
+    for (int block = 0; block < 2; block++) {
+        x[0] = _mm_xor_si128(x[0], _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + block * 32)));
+        x[1] = _mm_xor_si128(x[1], _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + block * 32 + 16)));
+        CubeHashRounds(x, 16);
+    }
+    // Padding block: 0x80 then zeros
+    x[0] = _mm_xor_si128(x[0], _mm_set_epi32(0, 0, 0, 0x80));
+    CubeHashRounds(x, 16);
+    x[7] = _mm_xor_si128(x[7], _mm_set_epi32(1, 0, 0, 0));
+    CubeHashRounds(x, 32);
+
+    for (int i = 0; i < 4; i++) _mm_storeu_si128(reinterpret_cast<__m128i*>(out) + i, x[i]);
+}
+#else
+void CubeHash64(const unsigned char* in, unsigned char* out)
+{
+    sph_cubehash512_context cc;
+    sph_cubehash512_init(&cc);
+    sph_cubehash512(&cc, in, DIGEST_SIZE);
+    sph_cubehash512_close(&cc, out);
+}
+#endif
+
+} // namespace
+
+X11Hasher::X11Hasher()
+{
+    sph_blake512_init(&m_init.blake);
+    sph_bmw512_init(&m_init.bmw);
+    sph_jh512_init(&m_init.jh);
+    sph_keccak512_init(&m_init.keccak);
+    sph_skein512_init(&m_init.skein);
+    sph_luffa512_init(&m_init.luffa);
+    sph_shavite512_init(&m_init.shavite);
+    sph_simd512_init(&m_init.simd);
+    sph_echo512_init(&m_init.echo);
+}
+
+uint256 X11Hasher::Hash(const unsigned char* data, size_t len)
+{
+    std::memcpy(&m_work, &m_init, sizeof(m_work));
+    alignas(16) unsigned char a[DIGEST_SIZE], b[DIGEST_SIZE];
+
+    sph_blake512(&m_work.blake, data, len);
+    sph_blake512_close(&m_work.blake, a);
+
+    sph_bmw512(&m_work.bmw, a, DIGEST_SIZE);
+    sph_bmw512_close(&m_work.bmw, b);
+
+    Groestl64(b, a);
+
+    sph_jh512(&m_work.jh, a, DIGEST_SIZE);
+    sph_jh512_close(&m_work.jh, b);
+
+    sph_keccak512(&m_work.keccak, b, DIGEST_SIZE);
+    sph_keccak512_close(&m_work.keccak, a);
+
+    sph_skein512(&m_work.skein, a, DIGEST_SIZE);
+    sph_skein512_close(&m_work.skein, b);
+
+    sph_luffa512(&m_work.luffa, b, DIGEST_SIZE);
+    sph_luffa512_close(&m_work.luffa, a);
+
+    CubeHash64(a, b);
+
+    sph_shavite512(&m_work.shavite, b, DIGEST_SIZE);
+    sph_shavite512_close(&m_work.shavite, a);
+
+    sph_simd512(&m_work.simd, a, DIGEST_SIZE);
+    sph_simd512_close(&m_work.simd, b);
+
+    sph_echo512(&m_work.echo, b, DIGEST_SIZE);
+    sph_echo512_close(&m_work.echo, a);
+
+    // Output is the first 256 bits
+    uint256 hash;
+    std::memcpy(hash.begin(), a, uint256::size());
+    return hash;
+}
+
+X11Hasher& GetThreadX11Hasher()
+{
+    static thread_local X11Hasher hasher;
+    return hasher;
+}
+
+} // namespace x25x
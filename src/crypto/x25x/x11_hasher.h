@@ -0,0 +1,58 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_X25X_X11_HASHER_H
+#define BITCOIN_CRYPTO_X25X_X11_HASHER_H
+
+#include <crypto/sphlib/x11.h>
+#include <uint256.h>
+
+#include <cstddef>
+
+namespace x25x {
+
+/**
+ * X11 hash chain engine
+ *
+ * x11_hash() initializes all eleven sphlib contexts on every call and runs
+ * each 64-byte intermediate digest through the generic buffered update path.
+ * This engine keeps contexts initialized once and copies them per hash into
+ * a fixed arena, and hashes the two stages that dominate the chain, Groestl
+ * and CubeHash, with implementations specialised for a 64-byte message:
+ * Groestl with precomputed rotated round tables, CubeHash with SSE2.
+ *
+ * Results are identical to x11_hash(), which remains the reference.
+ * Not thread-safe; use one instance per thread (see GetThreadX11Hasher()).
+ */
+class X11Hasher {
+public:
+    X11Hasher();
+
+    uint256 Hash(const unsigned char* data, size_t len);
+
+private:
+    struct Contexts {
+        sph_blake512_context blake;
+        sph_bmw512_context bmw;
+        sph_jh512_context jh;
+        sph_keccak512_context keccak;
+        sph_skein512_context skein;
+        sph_luffa512_context luffa;
+        sph_shavite512_context shavite;
+        sph_simd512_context simd;
+        sph_echo512_context echo;
+    };
+
+    //! Freshly initialized contexts, copied for every hash
+    Contexts m_init;
+    //! Working copies, reused so nothing is set up on the stack per call
+    Contexts m_work;
+};
+
+/** The calling thread's X11Hasher. */
+X11Hasher& GetThreadX11Hasher();
+
+} // namespace x25x
+
+#endif // BITCOIN_CRYPTO_X25X_X11_HASHER_H
@@ -3,7 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <crypto/x25x/x25x.h>
+#include <crypto/x25x/ethash_cache.h>
 
+#include <crypto/common.h>
 #include <crypto/sha256.h>
 #include <crypto/sha3.h>
 #include <hash.h>
@@ -12,24 +14,22 @@
 #include <chain.h>
 #include <logging.h>
 #include <span.h>
+#include <util/time.h>
+#include <util/trace.h>
 
 // Ethash library
 #include <ethash/ethash.h>
-#include <ethash/global_context.h>
 #include <ethash/keccak.h>
 
-// Scrypt library
-extern "C" {
-#include <eth_client/utils/libscrypt/libscrypt.h>
-}
+// Litecoin-parameter Scrypt engine
+#include <crypto/x25x/scrypt.h>
 
 // RandomX miner
 #include <node/randomx_miner.h>
+#include <node/randomx_verifier.h>
 
-// X11 sphlib implementation
-extern "C" {
-#include <crypto/sphlib/x11.h>
-}
+// X11 engine over the sphlib implementation
+#include <crypto/x25x/x11_hasher.h>
 
 // Equihash implementation
 #include <crypto/equihash/equihash.h>
@@ -37,6 +37,8 @@ extern "C" {
 #include <algorithm>
 #include <cstring>
 
+TRACEPOINT_SEMAPHORE(x25x, header_hashed);
+
 namespace x25x {
 
 // Algorithm information table
@@ -229,23 +231,7 @@ uint256 Scrypt(const unsigned char* data, size_t len)
 {
     // Scrypt parameters: N=1024, r=1, p=1 (Litecoin-compatible)
     // For mining, password and salt are both the block header
-    uint256 hash;
-
-    int result = libscrypt_scrypt(
-        data, len,           // password (block header)
-        data, len,           // salt (same as password for mining)
-        1024,                // N (CPU/memory cost)
-        1,                   // r (block size)
-        1,                   // p (parallelization)
-        hash.begin(), 32     // output buffer, 32 bytes
-    );
-
-    if (result != 0) {
-        LogPrintf("Scrypt: Hash computation failed\n");
-        hash.SetNull();
-    }
-
-    return hash;
+    return GetThreadScryptHasher().Hash(data, len);
 }
 
 uint256 Scrypt(const CBlockHeader& header)
@@ -276,8 +262,11 @@ uint256 Ethash(const CBlockHeader& header, uint64_t nonce, uint64_t blockHeight,
     // Calculate epoch from block height (epoch = height / 30000)
     int epoch = static_cast<int>(blockHeight / ETHASH_EPOCH_LENGTH);
 
-    // Get the global epoch context (manages DAG cache)
-    const ethash_epoch_context* context = ethash_get_global_epoch_context(epoch);
+    // Get the epoch light cache (persisted under the datadir) and start
+    // building the next one when the epoch boundary is close
+    EthashCache& cache = GetEthashCache();
+    std::shared_ptr<const ethash_epoch_context> context = cache.GetContext(epoch);
+    cache.MaybePrefetch(blockHeight);
     if (!context) {
         LogPrintf("Ethash: Failed to get epoch context for epoch %d\n", epoch);
         uint256 hash;
@@ -286,7 +275,7 @@ uint256 Ethash(const CBlockHeader& header, uint64_t nonce, uint64_t blockHeight,
     }
 
     // Compute Ethash
-    ethash_result result = ethash_hash(context, &header_hash, nonce);
+    ethash_result result = ethash_hash(context.get(), &header_hash, nonce);
 
     // Convert final_hash to uint256
     uint256 finalHash;
@@ -304,24 +293,14 @@ uint256 RandomX(const unsigned char* data, size_t len)
 {
     uint256 hash;
 
-    // Get the global RandomX miner instance
-    node::RandomXMiner& miner = node::GetRandomXMiner();
-
-    // Check if RandomX is initialized
-    if (!miner.IsInitialized()) {
-        // Initialize with default key if not already initialized
-        // In production, this should be initialized with proper key from blockchain
-        static const unsigned char defaultKey[32] = {0};
-        if (!miner.Initialize(defaultKey, 32, node::RandomXMiner::Mode::LIGHT, false)) {
-            LogPrintf("RandomX: Failed to initialize miner\n");
-            hash.SetNull();
-            return hash;
-        }
+    // Verification contexts are keyed by seed and shared across threads;
+    // the consensus seed is set at startup (zero until then)
+    node::RandomXVerifier& verifier = node::GetRandomXVerifier();
+    if (!verifier.CalculateHash(verifier.GetConsensusSeed(), data, len, hash.begin())) {
+        LogPrintf("RandomX: Failed to create verification context\n");
+        hash.SetNull();
     }
 
-    // Calculate the RandomX hash
-    miner.CalculateHash(data, len, hash.begin());
-
     return hash;
 }
 
@@ -367,11 +346,8 @@ uint256 X11(const unsigned char* data, size_t len)
     // blake -> bmw -> groestl -> jh -> keccak -> skein ->
     // luffa -> cubehash -> shavite -> simd -> echo
     //
-    // Uses sphlib implementation for full X11 compatibility
-
-    uint256 hash;
-    x11_hash(data, len, hash.begin());
-    return hash;
+    // Same output as sphlib's x11_hash(), with reused contexts
+    return GetThreadX11Hasher().Hash(data, len);
 }
 
 uint256 X11(const CBlockHeader& header)
@@ -402,31 +378,33 @@ static uint64_t xorshift64(uint64_t& state) {
     return state;
 }
 
-// Generate 64x64 matrix from seed
-static void generateMatrix(const unsigned char* seed, uint64_t matrix[64][64]) {
+// Matrix-vector multiplication (64x64 XorShift matrix * 64-element vector)
+//
+// The matrix is seeded from the hash of the whole input, nonce included, so
+// it differs for every hash and cannot be cached. It is consumed as it is
+// generated instead of being materialized (32 KiB per hash). The vector is
+// the 4 uint64s of a 32-byte hash, repeating, so row i contributes
+// sum_j m[i][j] * vec[j % 4]; multiplication distributes over the mod 2^64
+// sum, so each row needs four products of per-residue column sums rather
+// than 64 products.
+static void matrixMultiply(const unsigned char* seed, const uint64_t* vec, uint64_t* result) {
     // Initialize state from seed
     uint64_t state = 0;
-    for (int i = 0; i < 8 && i < 32; i++) {
+    for (int i = 0; i < 8; i++) {
         state |= static_cast<uint64_t>(seed[i]) << (i * 8);
     }
     if (state == 0) state = 1; // Avoid zero state
 
-    // Generate matrix elements
-    for (int i = 0; i < 64; i++) {
-        for (int j = 0; j < 64; j++) {
-            matrix[i][j] = xorshift64(state);
-        }
-    }
-}
-
-// Matrix-vector multiplication (64x64 matrix * 64-element vector)
-static void matrixMultiply(const uint64_t matrix[64][64], const uint64_t* vec, uint64_t* result) {
     for (int i = 0; i < 64; i++) {
-        uint64_t sum = 0;
-        for (int j = 0; j < 64; j++) {
-            // Multiplication with overflow is intentional (mod 2^64)
-            sum += matrix[i][j] * vec[j % 4]; // Use 4 uint64s from 32-byte hash, repeating
+        uint64_t lane[4] = {0, 0, 0, 0};
+        for (int j = 0; j < 64; j += 4) {
+            lane[0] += xorshift64(state);
+            lane[1] += xorshift64(state);
+            lane[2] += xorshift64(state);
+            lane[3] += xorshift64(state);
         }
+        // Multiplication with overflow is intentional (mod 2^64)
+        uint64_t sum = lane[0] * vec[0] + lane[1] * vec[1] + lane[2] * vec[2] + lane[3] * vec[3];
         result[i % 4] ^= sum; // XOR into 4 output uint64s
     }
 }
@@ -439,10 +417,6 @@ uint256 KHeavyHash(const unsigned char* data, size_t len)
     sha3_seed.Write({data, len});
     sha3_seed.Finalize(seedHash);
 
-    // Step 2: Generate 64x64 matrix
-    uint64_t matrix[64][64];
-    generateMatrix(seedHash.begin(), matrix);
-
     // Step 3: Compute SHA3-256 for input vector
     uint256 vecHash;
     SHA3_256 sha3_vec;
@@ -454,9 +428,9 @@ uint256 KHeavyHash(const unsigned char* data, size_t len)
     uint64_t vec[4];
     std::memcpy(vec, vecHash.begin(), 32);
 
-    // Step 4: Matrix-vector multiplication
+    // Steps 2 and 4: Generate the 64x64 matrix and multiply
     uint64_t result[4] = {0, 0, 0, 0};
-    matrixMultiply(matrix, vec, result);
+    matrixMultiply(seedHash.begin(), vec, result);
 
     // Step 5: XOR with another hash
     uint256 xorHash;
@@ -486,13 +460,8 @@ uint256 KHeavyHash(const CBlockHeader& header)
 
 } // namespace hash
 
-uint256 HashBlockHeader(const CBlockHeader& header, Algorithm algo, uint64_t blockHeight)
+static uint256 HashBlockHeaderWith(const CBlockHeader& header, Algorithm algo, uint64_t blockHeight)
 {
-    // If algorithm not specified, extract from block version
-    if (algo == Algorithm::INVALID) {
-        algo = GetBlockAlgorithm(header.nVersion);
-    }
-
     switch (algo) {
         case Algorithm::SHA256D:
             return hash::SHA256D(header);
@@ -522,6 +491,92 @@ uint256 HashBlockHeader(const CBlockHeader& header, Algorithm algo, uint64_t blo
     }
 }
 
+uint256 HashBlockHeader(const CBlockHeader& header, Algorithm algo, uint64_t blockHeight)
+{
+    // If algorithm not specified, extract from block version
+    if (algo == Algorithm::INVALID) {
+        algo = GetBlockAlgorithm(header.nVersion);
+    }
+
+    if (!TRACEPOINT_ACTIVE(x25x, header_hashed)) {
+        return HashBlockHeaderWith(header, algo, blockHeight);
+    }
+    const auto start{SteadyClock::now()};
+    const uint256 hash{HashBlockHeaderWith(header, algo, blockHeight)};
+    TRACEPOINT(x25x, header_hashed,
+        static_cast<uint8_t>(algo),
+        blockHeight,
+        Ticks<std::chrono::microseconds>(SteadyClock::now() - start)
+    );
+    return hash;
+}
+
+HeaderHasher::HeaderHasher(const CBlockHeader& header, Algorithm algo)
+    : m_header(header), m_algo(algo == Algorithm::INVALID ? GetBlockAlgorithm(header.nVersion) : algo)
+{
+    DataStream ss{};
+    ss << header;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(ss.data());
+    m_data.assign(bytes, bytes + ss.size());
+    m_midstate.Write(m_data.data(), 64);
+}
+
+uint256 HeaderHasher::Hash(uint32_t nonce)
+{
+    WriteLE32(m_data.data() + NONCE_OFFSET, nonce);
+
+    switch (m_algo) {
+        case Algorithm::SCRYPT:
+            return hash::Scrypt(m_data.data(), m_data.size());
+
+        case Algorithm::X11:
+            return hash::X11(m_data.data(), m_data.size());
+
+        case Algorithm::KHEAVYHASH:
+            return hash::KHeavyHash(m_data.data(), m_data.size());
+
+        case Algorithm::ETHASH:
+        case Algorithm::RANDOMX:
+            m_header.nNonce = nonce;
+            return HashBlockHeader(m_header, m_algo);
+
+        default: {
+            // SHA256d, and everything HashBlockHeader() hashes as SHA256d
+            uint256 hash;
+            CSHA256 sha = m_midstate;
+            sha.Write(m_data.data() + 64, m_data.size() - 64);
+            sha.Finalize(hash.begin());
+            CSHA256().Write(hash.begin(), 32).Finalize(hash.begin());
+            return hash;
+        }
+    }
+}
+
+size_t HeaderHasher::GetBatchSize() const
+{
+    return m_algo == Algorithm::SCRYPT ? ScryptHasher::GetLanes() : 1;
+}
+
+void HeaderHasher::HashMany(uint32_t firstNonce, size_t count, uint256* out)
+{
+    if (m_algo != Algorithm::SCRYPT) {
+        for (size_t i = 0; i < count; i++) out[i] = Hash(firstNonce + i);
+        return;
+    }
+
+    // Copies of the header that differ only in the nonce share m_midstate
+    const size_t len = m_data.size();
+    m_batch.resize(count * len);
+    m_batchInputs.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        unsigned char* data = m_batch.data() + i * len;
+        std::memcpy(data, m_data.data(), len);
+        WriteLE32(data + NONCE_OFFSET, firstNonce + i);
+        m_batchInputs[i] = data;
+    }
+    GetThreadScryptHasher().HashMany(m_batchInputs.data(), len, count, out, &m_midstate);
+}
+
 bool CheckProofOfWork(const CBlockHeader& header, unsigned int nBits, const Consensus::Params& params)
 {
     Algorithm algo = GetBlockAlgorithm(header.nVersion);
@@ -618,15 +673,7 @@ unsigned int GetNextWorkRequiredForAlgorithm(const CBlockIndex* pindexLast,
     int nLookback = params.nX25XDifficultyLookback;
 
     // Find the previous block with this algorithm for timing calculation
-    const CBlockIndex* pindexAlgoPrev = nullptr;
-    const CBlockIndex* pindex = pindexAlgoLast->pprev;
-    while (pindex != nullptr) {
-        if (GetBlockAlgorithm(pindex->nVersion) == algo) {
-            pindexAlgoPrev = pindex;
-            break;
-        }
-        pindex = pindex->pprev;
-    }
+    const CBlockIndex* pindexAlgoPrev = pindexAlgoLast->pprevAlgo[static_cast<size_t>(algo)];
 
     if (pindexAlgoPrev == nullptr) {
         return pindexAlgoLast->nBits;
@@ -671,28 +718,29 @@ unsigned int GetNextWorkRequiredForAlgorithm(const CBlockIndex* pindexLast,
 
 const CBlockIndex* MultiAlgoDifficultyManager::GetLastBlockForAlgorithm(const CBlockIndex* pindexLast, Algorithm algo)
 {
-    const CBlockIndex* pindex = pindexLast;
-    while (pindex != nullptr) {
-        if (GetBlockAlgorithm(pindex->nVersion) == algo) {
-            return pindex;
-        }
-        pindex = pindex->pprev;
+    if (pindexLast == nullptr || static_cast<size_t>(algo) >= CBlockIndex::MAX_BLOCK_ALGOS) {
+        return nullptr;
+    }
+    if (GetBlockAlgorithm(pindexLast->nVersion) == algo) {
+        return pindexLast;
     }
-    return nullptr;
+    return pindexLast->pprevAlgo[static_cast<size_t>(algo)];
 }
 
 int MultiAlgoDifficultyManager::CountBlocksForAlgorithm(const CBlockIndex* pindexStart, int nCount, Algorithm algo)
 {
+    if (pindexStart == nullptr) {
+        return 0;
+    }
+
+    // Only the nCount blocks ending at pindexStart are in range
     int count = 0;
-    const CBlockIndex* pindex = pindexStart;
-    int blocksChecked = 0;
+    const int nMinHeight = pindexStart->nHeight - nCount;
+    const CBlockIndex* pindex = GetLastBlockForAlgorithm(pindexStart, algo);
 
-    while (pindex != nullptr && blocksChecked < nCount) {
-        if (GetBlockAlgorithm(pindex->nVersion) == algo) {
-            count++;
-        }
-        pindex = pindex->pprev;
-        blocksChecked++;
+    while (pindex != nullptr && pindex->nHeight > nMinHeight) {
+        count++;
+        pindex = pindex->pprevAlgo[static_cast<size_t>(algo)];
     }
 
     return count;
@@ -703,13 +751,11 @@ int64_t MultiAlgoDifficultyManager::GetAverageBlockTimeForAlgorithm(const CBlock
                                                                      int nLookback)
 {
     std::vector<int64_t> times;
-    const CBlockIndex* pindex = pindexLast;
+    const CBlockIndex* pindex = GetLastBlockForAlgorithm(pindexLast, algo);
 
     while (pindex != nullptr && static_cast<int>(times.size()) < nLookback + 1) {
-        if (GetBlockAlgorithm(pindex->nVersion) == algo) {
-            times.push_back(pindex->GetBlockTime());
-        }
-        pindex = pindex->pprev;
+        times.push_back(pindex->GetBlockTime());
+        pindex = pindex->pprevAlgo[static_cast<size_t>(algo)];
     }
 
     if (times.size() < 2) {
@@ -5,6 +5,7 @@
 #ifndef BITCOIN_CRYPTO_X25X_X25X_H
 #define BITCOIN_CRYPTO_X25X_X25X_H
 
+#include <crypto/sha256.h>
 #include <primitives/block.h>
 #include <uint256.h>
 #include <consensus/params.h>
@@ -107,6 +108,49 @@ int32_t SetBlockAlgorithm(int32_t nVersion, Algorithm algo);
  */
 uint256 HashBlockHeader(const CBlockHeader& header, Algorithm algo = Algorithm::INVALID, uint64_t blockHeight = 0);
 
+/**
+ * Hash one block header template at many nonces
+ *
+ * The header is serialized once and each Hash() call patches the nonce into
+ * the buffer in place. For SHA256d the first 64 bytes (version, previous
+ * hash and most of the merkle root) form a complete SHA-256 block ahead of
+ * the nonce, so its midstate is computed once and every nonce only costs the
+ * remaining blocks plus the outer hash. Algorithms without a byte-level
+ * hasher (Ethash, RandomX) fall back to HashBlockHeader().
+ *
+ * HashMany() hashes consecutive nonces together where the algorithm has a
+ * multi-lane kernel (Scrypt), reusing the same midstate for the HMAC key.
+ *
+ * Results are identical to HashBlockHeader() with header.nNonce = nonce.
+ */
+class HeaderHasher {
+public:
+    //! Offset of nNonce in the serialized header
+    static constexpr size_t NONCE_OFFSET = 4 + 32 + 32 + 4 + 4;
+
+    HeaderHasher(const CBlockHeader& header, Algorithm algo = Algorithm::INVALID);
+
+    uint256 Hash(uint32_t nonce);
+
+    /** Hash nonces firstNonce .. firstNonce + count - 1 into out[0..count). */
+    void HashMany(uint32_t firstNonce, size_t count, uint256* out);
+
+    /** Nonces per HashMany() call that give the lowest cost per hash. */
+    size_t GetBatchSize() const;
+
+    Algorithm GetAlgorithm() const { return m_algo; }
+
+private:
+    CBlockHeader m_header;
+    Algorithm m_algo;
+    std::vector<unsigned char> m_data;
+    CSHA256 m_midstate;
+
+    // HashMany() buffers, kept to avoid reallocating per batch
+    std::vector<unsigned char> m_batch;
+    std::vector<const unsigned char*> m_batchInputs;
+};
+
 /**
  * Verify that a block's proof-of-work is valid for its algorithm
  *
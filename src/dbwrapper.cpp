@@ -9,11 +9,15 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/strencodings.h>
+#include <util/string.h>
+#include <util/time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
@@ -30,6 +34,8 @@
 #include <leveldb/write_batch.h>
 #include <memory>
 #include <optional>
+#include <set>
+#include <sstream>
 #include <utility>
 
 static auto CharCast(const std::byte* data) { return reinterpret_cast<const char*>(data); }
@@ -134,10 +140,10 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static leveldb::Options GetOptions(size_t nCacheSize, leveldb::Cache* shared_cache)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
+    options.block_cache = shared_cache ? shared_cache : leveldb::NewLRUCache(nCacheSize / 2);
     options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
     options.filter_policy = leveldb::NewBloomFilterPolicy(10);
     options.compression = leveldb::kNoCompression;
@@ -217,8 +223,77 @@ struct LevelDBContext {
 
     //! the database itself
     leveldb::DB* pdb;
+
+    //! keeps the shared block cache alive while options.block_cache points to it
+    std::shared_ptr<leveldb::Cache> shared_cache;
+    size_t cache_capacity{0};
+
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> read_hits{0};
+    std::atomic<uint64_t> bytes_read{0};
+    std::atomic<uint64_t> batches_written{0};
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<SteadyClock::time_point> last_write{SteadyClock::now()};
 };
 
+namespace {
+GlobalMutex g_dbwrappers_mutex;
+//! Every open database, for the statistics and the idle compaction
+std::set<CDBWrapper*> g_dbwrappers GUARDED_BY(g_dbwrappers_mutex);
+std::shared_ptr<leveldb::Cache> g_shared_cache GUARDED_BY(g_dbwrappers_mutex);
+size_t g_shared_cache_size GUARDED_BY(g_dbwrappers_mutex){0};
+} // namespace
+
+void SetSharedDBCacheSize(size_t bytes)
+{
+    LOCK(g_dbwrappers_mutex);
+    // Databases already open keep the cache they were given
+    g_shared_cache = bytes ? std::shared_ptr<leveldb::Cache>{leveldb::NewLRUCache(bytes)} : nullptr;
+    g_shared_cache_size = bytes;
+}
+
+std::vector<DBStats> GetAllDBStats()
+{
+    LOCK(g_dbwrappers_mutex);
+    std::vector<DBStats> stats;
+    for (const CDBWrapper* db : g_dbwrappers) stats.push_back(db->GetStats());
+    std::sort(stats.begin(), stats.end(), [](const DBStats& a, const DBStats& b) { return a.path < b.path; });
+    return stats;
+}
+
+std::optional<std::string> CompactIdleDB(std::chrono::seconds quiet, int min_level0_files, uint64_t max_bytes)
+{
+    // The registry lock is held throughout so the database cannot be closed under the compaction
+    LOCK(g_dbwrappers_mutex);
+    CDBWrapper* candidate{nullptr};
+    DBStats candidate_stats;
+    for (CDBWrapper* db : g_dbwrappers) {
+        DBStats stats{db->GetStats()};
+        if (stats.idle < quiet || stats.table_bytes > max_bytes) continue;
+        if (stats.level_files.empty() || stats.level_files[0] < min_level0_files) continue;
+        if (candidate && stats.level_files[0] <= candidate_stats.level_files[0]) continue;
+        candidate = db;
+        candidate_stats = std::move(stats);
+    }
+    if (!candidate) return std::nullopt;
+
+    LogDebug(BCLog::LEVELDB, "Compacting idle database %s (%d level 0 tables)\n", candidate_stats.name, candidate_stats.level_files[0]);
+    candidate->Compact();
+    return candidate_stats.name;
+}
+
+int DBStats::ReadAmplification() const
+{
+    if (level_files.empty()) return 0;
+    return level_files[0] + std::count_if(level_files.begin() + 1, level_files.end(), [](int files) { return files > 0; });
+}
+
+double DBStats::WriteAmplification() const
+{
+    if (bytes_written == 0) return 0;
+    return double(bytes_written + compaction_bytes_written) / bytes_written;
+}
+
 CDBWrapper::CDBWrapper(const DBParams& params)
     : m_db_context{std::make_unique<LevelDBContext>()}, m_name{fs::PathToString(params.path.stem())}, m_path{params.path}, m_is_memory{params.memory_only}
 {
@@ -227,7 +302,13 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     DBContext().iteroptions.verify_checksums = true;
     DBContext().iteroptions.fill_cache = false;
     DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
+    if (params.shared_cache) {
+        LOCK(g_dbwrappers_mutex);
+        DBContext().shared_cache = g_shared_cache;
+        DBContext().cache_capacity = g_shared_cache_size;
+    }
+    if (!DBContext().shared_cache) DBContext().cache_capacity = params.cache_bytes / 2;
+    DBContext().options = GetOptions(params.cache_bytes, DBContext().shared_cache.get());
     DBContext().options.create_if_missing = true;
     if (params.memory_only) {
         DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -273,18 +354,23 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     }
 
     LogPrintf("Using obfuscation key for %s: %s\n", fs::PathToString(params.path), HexStr(obfuscate_key));
+
+    LOCK(g_dbwrappers_mutex);
+    g_dbwrappers.insert(this);
 }
 
 CDBWrapper::~CDBWrapper()
 {
+    WITH_LOCK(g_dbwrappers_mutex, g_dbwrappers.erase(this));
     delete DBContext().pdb;
     DBContext().pdb = nullptr;
     delete DBContext().options.filter_policy;
     DBContext().options.filter_policy = nullptr;
     delete DBContext().options.info_log;
     DBContext().options.info_log = nullptr;
-    delete DBContext().options.block_cache;
+    if (!DBContext().shared_cache) delete DBContext().options.block_cache;
     DBContext().options.block_cache = nullptr;
+    DBContext().shared_cache.reset();
     delete DBContext().penv;
     DBContext().options.env = nullptr;
 }
@@ -298,6 +384,9 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     }
     leveldb::Status status = DBContext().pdb->Write(fSync ? DBContext().syncoptions : DBContext().writeoptions, &batch.m_impl_batch->batch);
     HandleError(status);
+    ++DBContext().batches_written;
+    DBContext().bytes_written += batch.size_estimate;
+    DBContext().last_write = SteadyClock::now();
     if (log_memory) {
         double mem_after = DynamicMemoryUsage() / 1024.0 / 1024;
         LogDebug(BCLog::LEVELDB, "WriteBatch memory usage: db=%s, before=%.1fMiB, after=%.1fMiB\n",
@@ -317,6 +406,58 @@ size_t CDBWrapper::DynamicMemoryUsage() const
     return parsed.value();
 }
 
+DBStats CDBWrapper::GetStats() const
+{
+    DBStats stats;
+    stats.name = m_name;
+    stats.path = m_path;
+    stats.reads = DBContext().reads;
+    stats.read_hits = DBContext().read_hits;
+    stats.bytes_read = DBContext().bytes_read;
+    stats.batches_written = DBContext().batches_written;
+    stats.bytes_written = DBContext().bytes_written;
+    stats.block_cache_usage = DBContext().options.block_cache->TotalCharge();
+    stats.block_cache_capacity = DBContext().cache_capacity;
+    stats.shared_cache = DBContext().shared_cache != nullptr;
+    stats.memory_usage = DynamicMemoryUsage();
+    stats.idle = std::chrono::duration_cast<std::chrono::seconds>(SteadyClock::now() - DBContext().last_write.load());
+
+    // Rows of "Level Files Size(MB) Time(sec) Read(MB) Write(MB)" after a dashed line
+    std::string property;
+    if (DBContext().pdb->GetProperty("leveldb.stats", &property)) {
+        std::istringstream lines{property};
+        std::string line;
+        bool table{false};
+        while (std::getline(lines, line)) {
+            if (!table) {
+                table = line.starts_with("---");
+                continue;
+            }
+            int level, files;
+            double size_mb, seconds, read_mb, write_mb;
+            if (std::sscanf(line.c_str(), "%d %d %lf %lf %lf %lf", &level, &files, &size_mb, &seconds, &read_mb, &write_mb) != 6) continue;
+            if (level < 0) continue;
+            if (stats.level_files.size() <= size_t(level)) stats.level_files.resize(level + 1);
+            stats.level_files[level] = files;
+            stats.table_bytes += uint64_t(size_mb * 1048576.0);
+            stats.compaction_bytes_read += uint64_t(read_mb * 1048576.0);
+            stats.compaction_bytes_written += uint64_t(write_mb * 1048576.0);
+        }
+    }
+    // Levels without tables or compactions are left out of the table
+    for (int level = stats.level_files.size(); level < 7; ++level) {
+        if (DBContext().pdb->GetProperty("leveldb.num-files-at-level" + util::ToString(level), &property)) {
+            stats.level_files.push_back(ToIntegral<int>(property).value_or(0));
+        }
+    }
+    return stats;
+}
+
+void CDBWrapper::Compact()
+{
+    DBContext().pdb->CompactRange(nullptr, nullptr);
+}
+
 // Prefixed with null character to avoid collisions with other keys
 //
 // We must use a string constructor which specifies length so that we copy
@@ -341,12 +482,15 @@ std::optional<std::string> CDBWrapper::ReadImpl(Span<const std::byte> key) const
     leveldb::Slice slKey(CharCast(key.data()), key.size());
     std::string strValue;
     leveldb::Status status = DBContext().pdb->Get(DBContext().readoptions, slKey, &strValue);
+    ++DBContext().reads;
     if (!status.ok()) {
         if (status.IsNotFound())
             return std::nullopt;
         LogPrintf("LevelDB read failure: %s\n", status.ToString());
         HandleError(status);
     }
+    ++DBContext().read_hits;
+    DBContext().bytes_read += strValue.size();
     return strValue;
 }
 
@@ -356,12 +500,14 @@ bool CDBWrapper::ExistsImpl(Span<const std::byte> key) const
 
     std::string strValue;
     leveldb::Status status = DBContext().pdb->Get(DBContext().readoptions, slKey, &strValue);
+    ++DBContext().reads;
     if (!status.ok()) {
         if (status.IsNotFound())
             return false;
         LogPrintf("LevelDB read failure: %s\n", status.ToString());
         HandleError(status);
     }
+    ++DBContext().read_hits;
     return true;
 }
 
@@ -382,6 +528,46 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
+CDBWrapper::Records CDBWrapper::ReadAllRecords() const
+{
+    DataStream skip_key{};
+    skip_key << OBFUSCATE_KEY_KEY;
+
+    Records records;
+    std::unique_ptr<leveldb::Iterator> it{DBContext().pdb->NewIterator(DBContext().iteroptions)};
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        if (std::ranges::equal(MakeByteSpan(it->key()), Span{skip_key})) continue;
+        DataStream value{MakeByteSpan(it->value())};
+        value.Xor(obfuscate_key);
+        records.emplace_back(std::vector<unsigned char>(it->key().data(), it->key().data() + it->key().size()),
+                             std::vector<unsigned char>(UCharCast(value.data()), UCharCast(value.data()) + value.size()));
+    }
+    HandleError(it->status());
+    return records;
+}
+
+bool CDBWrapper::ReplaceAllRecords(const Records& records)
+{
+    DataStream skip_key{};
+    skip_key << OBFUSCATE_KEY_KEY;
+
+    CDBBatch batch(*this);
+    std::unique_ptr<leveldb::Iterator> it{DBContext().pdb->NewIterator(DBContext().iteroptions)};
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        if (std::ranges::equal(MakeByteSpan(it->key()), Span{skip_key})) continue;
+        batch.EraseImpl(MakeByteSpan(it->key()));
+    }
+    HandleError(it->status());
+    it.reset();
+
+    for (const auto& [key, value] : records) {
+        if (std::ranges::equal(MakeByteSpan(key), Span{skip_key})) continue;
+        DataStream ssValue{MakeByteSpan(value)};
+        batch.WriteImpl(MakeByteSpan(key), ssValue);
+    }
+    return WriteBatch(batch, /*fSync=*/true);
+}
+
 struct CDBIterator::IteratorImpl {
     const std::unique_ptr<leveldb::Iterator> iter;
 
@@ -415,7 +601,9 @@ Span<const std::byte> CDBIterator::GetValueImpl() const
 CDBIterator::~CDBIterator() = default;
 bool CDBIterator::Valid() const { return m_impl_iter->iter->Valid(); }
 void CDBIterator::SeekToFirst() { m_impl_iter->iter->SeekToFirst(); }
+void CDBIterator::SeekToLast() { m_impl_iter->iter->SeekToLast(); }
 void CDBIterator::Next() { m_impl_iter->iter->Next(); }
+void CDBIterator::Prev() { m_impl_iter->iter->Prev(); }
 
 namespace dbwrapper_private {
 
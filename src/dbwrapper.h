@@ -12,12 +12,15 @@
 #include <util/check.h>
 #include <util/fs.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
@@ -43,6 +46,9 @@ struct DBParams {
     //! If true, store data obfuscated via simple XOR. If false, XOR with a
     //! zero'd byte array.
     bool obfuscate = false;
+    //! If true, use the block cache shared by the small auxiliary databases
+    //! (see SetSharedDBCacheSize) instead of one sized from cache_bytes.
+    bool shared_cache = false;
     //! Passed-through options.
     DBOptions options{};
 };
@@ -69,6 +75,52 @@ const std::vector<unsigned char>& GetObfuscateKey(const CDBWrapper &w);
 
 bool DestroyDB(const std::string& path_str);
 
+//! Usage and LevelDB compaction statistics of an open database
+struct DBStats {
+    std::string name;
+    fs::path path;
+    //! Point reads, and how many of them found an entry
+    uint64_t reads{0};
+    uint64_t read_hits{0};
+    uint64_t bytes_read{0};
+    //! Batches and bytes written by the node since the database was opened
+    uint64_t batches_written{0};
+    uint64_t bytes_written{0};
+    //! Bytes read and written by LevelDB compactions since the database was opened, to MiB precision
+    uint64_t compaction_bytes_read{0};
+    uint64_t compaction_bytes_written{0};
+    //! Table files per level and their total size, to MiB precision
+    std::vector<int> level_files;
+    uint64_t table_bytes{0};
+    size_t block_cache_usage{0};
+    size_t block_cache_capacity{0};
+    bool shared_cache{false};
+    size_t memory_usage{0};
+    //! Time since the last batch was written
+    std::chrono::seconds idle{0};
+
+    //! Tables a point read may have to consult: every level 0 file plus one per deeper level
+    int ReadAmplification() const;
+    //! Bytes written to disk per byte written by the node, including the log
+    double WriteAmplification() const;
+};
+
+//! Size the block cache shared by databases opened with DBParams::shared_cache from now on.
+void SetSharedDBCacheSize(size_t bytes);
+
+//! Statistics of every open database.
+std::vector<DBStats> GetAllDBStats();
+
+/**
+ * Compact one database that has not been written to for @p quiet, has at
+ * least @p min_level0_files level 0 tables and holds at most @p max_bytes,
+ * so the work happens between blocks instead of stalling the writes of the
+ * next one. Databases with the largest level 0 backlog go first.
+ *
+ * @returns the name of the database compacted, if any
+ */
+std::optional<std::string> CompactIdleDB(std::chrono::seconds quiet, int min_level0_files, uint64_t max_bytes);
+
 /** Batch of changes queued to be written to a CDBWrapper */
 class CDBBatch
 {
@@ -145,6 +197,7 @@ public:
     bool Valid() const;
 
     void SeekToFirst();
+    void SeekToLast();
 
     template<typename K> void Seek(const K& key) {
         DataStream ssKey{};
@@ -154,6 +207,7 @@ public:
     }
 
     void Next();
+    void Prev();
 
     template<typename K> bool GetKey(K& key) {
         try {
@@ -175,6 +229,13 @@ public:
         }
         return true;
     }
+
+    /** The value at the cursor with the obfuscation removed, for callers that decode it elsewhere. */
+    DataStream GetValueStream() const {
+        DataStream ssValue{GetValueImpl()};
+        ssValue.Xor(dbwrapper_private::GetObfuscateKey(parent));
+        return ssValue;
+    }
 };
 
 struct LevelDBContext;
@@ -276,6 +337,11 @@ public:
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    DBStats GetStats() const;
+
+    //! Compact the whole database.
+    void Compact();
+
     CDBIterator* NewIterator();
 
     /**
@@ -283,6 +349,21 @@ public:
      */
     bool IsEmpty();
 
+    //! Serialized key and de-obfuscated value of a database entry
+    using Records = std::vector<std::pair<std::vector<unsigned char>, std::vector<unsigned char>>>;
+
+    /**
+     * Return every entry of the database, leaving out the obfuscation key so
+     * the records can be moved to a database that uses a different one.
+     */
+    Records ReadAllRecords() const;
+
+    /**
+     * Atomically replace the contents of the database with records, as
+     * returned by ReadAllRecords(). The obfuscation key is kept.
+     */
+    bool ReplaceAllRecords(const Records& records);
+
     template<typename K>
     size_t EstimateSize(const K& key_begin, const K& key_end) const
     {
@@ -27,53 +27,73 @@ inline db::Slice toSlice(bytes const& _b)
     return db::Slice(reinterpret_cast<char const*>(&_b[0]), _b.size());
 }
 
+thread_local uint64_t t_diskReads = 0;
+
 }  // namespace
 
 OverlayDB::~OverlayDB() = default;
 
+uint64_t OverlayDB::diskReads()
+{
+    return t_diskReads;
+}
+
 void OverlayDB::commit()
 {
     if (m_db)
     {
-        auto writeBatch = m_db->createWriteBatch();
-//      cnote << "Committing nodes to disk DB:";
+        if (m_pending->deferred)
+        {
+            WriteGuard l(m_pending->x_pending);
 #if DEV_GUARDED_DB
-        DEV_READ_GUARDED(x_this)
+            DEV_READ_GUARDED(x_this)
 #endif
-        {
-            for (auto const& i: m_main)
             {
-                if (i.second.second)
-                    writeBatch->insert(toSlice(i.first), toSlice(i.second.first));
-//              cnote << i.first << "#" << m_main[i.first].second;
+                for (auto const& i: m_main)
+                    if (i.second.second && m_pending->main.emplace(i.first, i.second.first).second)
+                        m_pending->size += i.first.size + i.second.first.size();
+                for (auto const& i: m_aux)
+                    if (i.second.second)
+                    {
+                        auto it = m_pending->aux.find(i.first);
+                        if (it == m_pending->aux.end())
+                        {
+                            m_pending->aux.emplace(i.first, i.second.first);
+                            m_pending->size += i.first.size + i.second.first.size();
+                        }
+                        else
+                            it->second = i.second.first;
+                    }
             }
-            for (auto const& i: m_aux)
-                if (i.second.second)
-                {
-                    bytes b = i.first.asBytes();
-                    b.push_back(255);   // for aux
-                    writeBatch->insert(toSlice(b), toSlice(i.second.first));
-                }
         }
-
-        for (unsigned i = 0; i < 10; ++i)
+        else
         {
-            try
-            {
-                m_db->commit(std::move(writeBatch));
-                break;
-            }
-            catch (boost::exception const& ex)
+            Guard w(m_pending->x_write);
+            auto writeBatch = m_db->createWriteBatch();
+//          cnote << "Committing nodes to disk DB:";
+#if DEV_GUARDED_DB
+            DEV_READ_GUARDED(x_this)
+#endif
             {
-                if (i == 9)
+                for (auto const& i: m_main)
                 {
-                    cwarn << "Fail writing to state database. Bombing out.";
-                    exit(-1);
+                    if (i.second.second)
+                    {
+                        writeBatch->insert(toSlice(i.first), toSlice(i.second.first));
+                        if (m_pending->tracking)
+                            m_pending->written.insert(i.first);
+                    }
+//                  cnote << i.first << "#" << m_main[i.first].second;
                 }
-                cwarn << "Error writing to state database: " << boost::diagnostic_information(ex);
-                cwarn << "Sleeping for" << (i + 1) << "seconds, then retrying.";
-                std::this_thread::sleep_for(std::chrono::seconds(i + 1));
+                for (auto const& i: m_aux)
+                    if (i.second.second)
+                    {
+                        bytes b = i.first.asBytes();
+                        b.push_back(255);   // for aux
+                        writeBatch->insert(toSlice(b), toSlice(i.second.first));
+                    }
             }
+            commitBatch(std::move(writeBatch));
         }
 #if DEV_GUARDED_DB
         DEV_WRITE_GUARDED(x_this)
@@ -85,14 +105,133 @@ void OverlayDB::commit()
     }
 }
 
+void OverlayDB::setDeferredCommit(bool _deferred)
+{
+    if (!_deferred)
+        flush();
+    WriteGuard l(m_pending->x_pending);
+    m_pending->deferred = _deferred;
+}
+
+void OverlayDB::flush()
+{
+    if (!m_db)
+        return;
+
+    // Readers fall through to disk once an entry leaves the store, so it is only
+    // dropped after the batch is written; commits and flushes come from one thread
+    Guard w(m_pending->x_write);
+    auto writeBatch = m_db->createWriteBatch();
+    {
+        ReadGuard l(m_pending->x_pending);
+        if (m_pending->main.empty() && m_pending->aux.empty())
+            return;
+        for (auto const& i: m_pending->main)
+        {
+            writeBatch->insert(toSlice(i.first), toSlice(i.second));
+            if (m_pending->tracking)
+                m_pending->written.insert(i.first);
+        }
+        for (auto const& i: m_pending->aux)
+        {
+            bytes b = i.first.asBytes();
+            b.push_back(255);   // for aux
+            writeBatch->insert(toSlice(b), toSlice(i.second));
+        }
+    }
+    commitBatch(std::move(writeBatch));
+
+    WriteGuard l(m_pending->x_pending);
+    m_pending->main.clear();
+    m_pending->aux.clear();
+    m_pending->size = 0;
+}
+
+void OverlayDB::setWriteTracking(bool _tracking)
+{
+    Guard w(m_pending->x_write);
+    m_pending->tracking = _tracking;
+    m_pending->written.clear();
+}
+
+size_t OverlayDB::killUnwritten(std::vector<h256> const& _keys)
+{
+    if (!m_db)
+        return 0;
+
+    // Holding the write lock, a node is either written already and known, or written after it is deleted
+    Guard w(m_pending->x_write);
+    auto writeBatch = m_db->createWriteBatch();
+    size_t killed = 0;
+    for (auto const& h: _keys)
+        if (!m_pending->written.count(h))
+        {
+            writeBatch->kill(toSlice(h));
+            ++killed;
+        }
+    if (killed)
+        commitBatch(std::move(writeBatch));
+    return killed;
+}
+
+void OverlayDB::forEachNode(std::function<bool(h256 const&)> const& _f) const
+{
+    if (!m_db)
+        return;
+
+    // Aux entries have a longer key
+    m_db->forEach([&](db::Slice _key, db::Slice) {
+        if (_key.size() != h256::size)
+            return true;
+        return _f(h256(reinterpret_cast<byte const*>(_key.data()), h256::ConstructFromPointer));
+    });
+}
+
+size_t OverlayDB::pendingSize() const
+{
+    ReadGuard l(m_pending->x_pending);
+    return m_pending->size;
+}
+
+void OverlayDB::commitBatch(std::unique_ptr<db::WriteBatchFace> _batch)
+{
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        try
+        {
+            m_db->commit(std::move(_batch));
+            break;
+        }
+        catch (boost::exception const& ex)
+        {
+            if (i == 9)
+            {
+                cwarn << "Fail writing to state database. Bombing out.";
+                exit(-1);
+            }
+            cwarn << "Error writing to state database: " << boost::diagnostic_information(ex);
+            cwarn << "Sleeping for" << (i + 1) << "seconds, then retrying.";
+            std::this_thread::sleep_for(std::chrono::seconds(i + 1));
+        }
+    }
+}
+
 bytes OverlayDB::lookupAux(h256 const& _h) const
 {
     bytes ret = StateCacheDB::lookupAux(_h);
     if (!ret.empty() || !m_db)
         return ret;
 
+    {
+        ReadGuard l(m_pending->x_pending);
+        auto it = m_pending->aux.find(_h);
+        if (it != m_pending->aux.end())
+            return it->second;
+    }
+
     bytes b = _h.asBytes();
     b.push_back(255);   // for aux
+    ++t_diskReads;
     std::string const v = m_db->lookup(toSlice(b));
     if (v.empty())
         cwarn << "Aux not found: " << _h;
@@ -114,6 +253,14 @@ std::string OverlayDB::lookup(h256 const& _h) const
     if (!ret.empty() || !m_db)
         return ret;
 
+    {
+        ReadGuard l(m_pending->x_pending);
+        auto it = m_pending->main.find(_h);
+        if (it != m_pending->main.end())
+            return it->second;
+    }
+
+    ++t_diskReads;
     return m_db->lookup(toSlice(_h));
 }
 
@@ -121,7 +268,15 @@ bool OverlayDB::exists(h256 const& _h) const
 {
     if (StateCacheDB::exists(_h))
         return true;
-    return m_db && m_db->exists(toSlice(_h));
+    {
+        ReadGuard l(m_pending->x_pending);
+        if (m_pending->main.count(_h))
+            return true;
+    }
+    if (!m_db)
+        return false;
+    ++t_diskReads;
+    return m_db->exists(toSlice(_h));
 }
 
 void OverlayDB::kill(h256 const& _h)
@@ -130,7 +285,7 @@ void OverlayDB::kill(h256 const& _h)
     {
         if (m_db)
         {
-            if (!m_db->exists(toSlice(_h)))
+            if (!exists(_h))
             {
                 // No point node ref decreasing for EmptyTrie since we never bother incrementing it
                 // in the first place for empty storage tries.
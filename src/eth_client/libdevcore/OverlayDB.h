@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <libdevcore/db.h>
 #include <libdevcore/Common.h>
+#include <libdevcore/Guards.h>
 #include <libdevcore/Log.h>
 #include <libdevcore/StateCacheDB.h>
 
@@ -20,7 +22,8 @@ public:
       : m_db(_db.release(), [](db::DatabaseFace* db) {
             clog(VerbosityDebug, "overlaydb") << "Closing state DB";
             delete db;
-        })
+        }),
+        m_pending(std::make_shared<PendingWrites>())
     {}
 
     ~OverlayDB();
@@ -35,16 +38,54 @@ public:
     void commit();
 	void rollback();
 
+	/// With deferred commits, commit() moves the live nodes to a store shared by all copies of
+	/// this OverlayDB instead of writing them, and flush() writes the store in one batch.
+	/// Nodes are content-addressed, so reads from any copy see them in the store or on disk.
+	void setDeferredCommit(bool _deferred);
+	void flush();
+	/// Approximate memory held by deferred commits, in bytes
+	size_t pendingSize() const;
+
+	/// While tracking, the keys of the nodes written to disk are recorded in the store shared by
+	/// all copies, so a collector that marked the live nodes before never deletes one that was
+	/// written again since. Stopping tracking forgets the keys.
+	void setWriteTracking(bool _tracking);
+	/// Delete the nodes among _keys from disk, except those written since tracking started.
+	/// Returns the number deleted.
+	size_t killUnwritten(std::vector<h256> const& _keys);
+	/// Call _f with the key of every node on disk, until it returns false
+	void forEachNode(std::function<bool(h256 const&)> const& _f) const;
+
 	std::string lookup(h256 const& _h) const;
 	bool exists(h256 const& _h) const;
 	void kill(h256 const& _h);
 
 	bytes lookupAux(h256 const& _h) const;
 
+	/// Lookups by this thread that missed memory and the pending writes and read the disk
+	static uint64_t diskReads();
+
 private:
 	using StateCacheDB::clear;
 
+	void commitBatch(std::unique_ptr<db::WriteBatchFace> _batch);
+
+	struct PendingWrites
+	{
+		mutable SharedMutex x_pending;
+		std::unordered_map<h256, std::string> main;
+		std::unordered_map<h256, bytes> aux;
+		size_t size = 0;
+		bool deferred = false;
+
+		/// Held while writing to or deleting from disk
+		Mutex x_write;
+		bool tracking = false;
+		h256Hash written;
+	};
+
     std::shared_ptr<db::DatabaseFace> m_db;
+    std::shared_ptr<PendingWrites> m_pending;
 };
 
 }
@@ -298,38 +298,72 @@ RLPStream& RLPStream::append(bytesConstRef _s, bool _compact)
     return *this;
 }
 
-RLPStream& RLPStream::append(bigint _i)
+void RLPStream::pushCount(size_t _count, byte _base)
 {
-    if (!_i)
-        m_out.push_back(c_rlpDataImmLenStart);
-    else if (_i < c_rlpDataImmLenStart)
-        m_out.push_back((byte)_i);
+    auto br = bytesRequired(_count);
+    if (int(br) + _base > 0xff)
+        BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("Count too large for RLP"));
+    m_out.push_back((byte)(br + _base));	// max 8 bytes.
+    pushInt(_count, br);
+}
+
+dev::byte* RLPWriter::claim(size_t _n)
+{
+    if (_n > m_buffer.size() - m_size)
+        BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("RLPWriter buffer too small"));
+    dev::byte* ret = m_buffer.data() + m_size;
+    m_size += _n;
+    return ret;
+}
+
+void RLPWriter::pushCount(size_t _count, dev::byte _immBase, dev::byte _indBase)
+{
+    if (_count < c_rlpDataImmLenCount)
+    {
+        *claim(1) = (dev::byte)(_immBase + _count);
+        return;
+    }
+    auto br = bytesRequired(_count);
+    dev::byte* b = claim(1 + br);
+    *b = (dev::byte)(_indBase + br);
+    for (b += br; _count; _count >>= 8)
+        *(b--) = (dev::byte)_count;
+}
+
+RLPWriter& RLPWriter::appendList(size_t _payloadSize)
+{
+    pushCount(_payloadSize, c_rlpListStart, c_rlpListIndLenZero);
+    return *this;
+}
+
+RLPWriter& RLPWriter::append(bytesConstRef _s)
+{
+    if (_s.size() == 1 && _s[0] < c_rlpDataImmLenStart)
+        *claim(1) = _s[0];
     else
     {
-        unsigned br = bytesRequired(_i);
-        if (br < c_rlpDataImmLenCount)
-            m_out.push_back((byte)(br + c_rlpDataImmLenStart));
-        else
-        {
-            auto brbr = bytesRequired(br);
-            if (c_rlpDataIndLenZero + brbr > 0xff)
-                BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("Number too large for RLP"));
-            m_out.push_back((byte)(c_rlpDataIndLenZero + brbr));
-            pushInt(br, brbr);
-        }
-        pushInt(_i, br);
+        pushCount(_s.size(), c_rlpDataImmLenStart, c_rlpDataIndLenZero);
+        if (_s.size())
+            memcpy(claim(_s.size()), _s.data(), _s.size());
     }
-    noteAppended();
     return *this;
 }
 
-void RLPStream::pushCount(size_t _count, byte _base)
+RLPWriter& RLPWriter::append(u256 const& _i)
 {
-    auto br = bytesRequired(_count);
-    if (int(br) + _base > 0xff)
-        BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("Count too large for RLP"));
-    m_out.push_back((byte)(br + _base));	// max 8 bytes.
-    pushInt(_count, br);
+    if (!_i)
+        *claim(1) = c_rlpDataImmLenStart;
+    else if (_i < c_rlpDataImmLenStart)
+        *claim(1) = toUint8(_i);
+    else
+    {
+        unsigned br = bytesRequired(_i);
+        *claim(1) = (dev::byte)(c_rlpDataImmLenStart + br);
+        dev::byte* b = claim(br) + br - 1;
+        for (u256 v = _i; v; v >>= 8)
+            *(b--) = toUint8(v);
+    }
+    return *this;
 }
 
 static void streamOut(std::ostream& _out, dev::RLP const& _d, unsigned _depth = 0)
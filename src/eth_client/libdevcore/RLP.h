@@ -377,14 +377,14 @@ public:
     ~RLPStream() {}
 
     /// Append given datum to the byte stream.
-    RLPStream& append(unsigned _s) { return append(bigint(_s)); }
-    RLPStream& append(u160 _s) { return append(bigint(_s)); }
-    RLPStream& append(u256 _s) { return append(bigint(_s)); }
-    RLPStream& append(bigint _s);
+    RLPStream& append(unsigned _s) { return appendInt(_s); }
+    RLPStream& append(u160 const& _s) { return appendInt(_s); }
+    RLPStream& append(u256 const& _s) { return appendInt(_s); }
+    RLPStream& append(bigint const& _s) { return appendInt(_s); }
     RLPStream& append(bytesConstRef _s, bool _compact = false);
     RLPStream& append(bytes const& _s) { return append(bytesConstRef(&_s)); }
     RLPStream& append(std::string const& _s) { return append(bytesConstRef(_s)); }
-    RLPStream& append(char const* _s) { return append(std::string(_s)); }
+    RLPStream& append(char const* _s) { return append(bytesConstRef((byte const*)_s, std::char_traits<char>::length(_s))); }
     template <unsigned N> RLPStream& append(FixedHash<N> _s, bool _compact = false, bool _allOrNothing = false) { return _allOrNothing && !_s ? append(bytesConstRef()) : append(_s.ref(), _compact); }
 
     /// Appends an arbitrary RLP fragment - this *must* be a single item unless @a _itemCount is given.
@@ -414,6 +414,9 @@ public:
     /// Clear the output stream so far.
     void clear() { m_out.clear(); m_listStack.clear(); }
 
+    /// Reserve room for @a _size bytes of output, e.g. the size of the node being rewritten.
+    void reserve(size_t _size) { m_out.reserve(_size); }
+
     /// Read the byte stream.
     bytes const& out() const { if(!m_listStack.empty()) BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("listStack is not empty")); return m_out; }
 
@@ -424,6 +427,32 @@ public:
     void swapOut(bytes& _dest) { if(!m_listStack.empty()) BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("listStack is not empty")); swap(m_out, _dest); }
 
 private:
+    /// Append an integer without widening it to bigint, which allocates above 128 bits.
+    template <class _T> RLPStream& appendInt(_T const& _i)
+    {
+        if (!_i)
+            m_out.push_back(c_rlpDataImmLenStart);
+        else if (_i < c_rlpDataImmLenStart)
+            m_out.push_back(toUint8(_i));
+        else
+        {
+            unsigned br = bytesRequired(_i);
+            if (br < c_rlpDataImmLenCount)
+                m_out.push_back((byte)(br + c_rlpDataImmLenStart));
+            else
+            {
+                auto brbr = bytesRequired(br);
+                if (c_rlpDataIndLenZero + brbr > 0xff)
+                    BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("Number too large for RLP"));
+                m_out.push_back((byte)(c_rlpDataIndLenZero + brbr));
+                pushInt(br, brbr);
+            }
+            pushInt(_i, br);
+        }
+        noteAppended();
+        return *this;
+    }
+
     void noteAppended(size_t _itemCount = 1);
 
     /// Push the node-type byte (using @a _base) along with the item count @a _count.
@@ -445,6 +474,46 @@ private:
     std::vector<std::pair<size_t, size_t>> m_listStack;
 };
 
+/// @returns the size of the RLP length prefix for a string or list of @a _payloadSize bytes.
+inline size_t rlpPrefixSize(size_t _payloadSize) { return _payloadSize < c_rlpDataImmLenCount ? 1 : 1 + bytesRequired(_payloadSize); }
+
+/// @returns the size of the RLP encoding of the byte string @a _s.
+inline size_t rlpSize(bytesConstRef _s) { return _s.size() == 1 && _s[0] < c_rlpDataImmLenStart ? 1 : rlpPrefixSize(_s.size()) + _s.size(); }
+template <unsigned N> size_t rlpSize(FixedHash<N> const&) { return rlpPrefixSize(N) + N; }
+
+/// @returns the size of the RLP encoding of the integer @a _i.
+inline size_t rlpSize(u256 const& _i) { return _i < c_rlpDataImmLenStart ? 1 : 1 + bytesRequired(_i); }
+
+/**
+ * @brief Writes RLP into a caller-provided buffer without allocating.
+ * Unlike RLPStream, a list header is written before its items, so the caller gives the
+ * payload size up front (sum of the rlpSize() of its items) rather than an item count.
+ * This avoids both the list stack and the memmove RLPStream does when a list closes.
+ * Throws RLPException if the buffer is too small.
+ */
+class RLPWriter
+{
+public:
+    explicit RLPWriter(bytesRef _buffer): m_buffer(_buffer) {}
+
+    RLPWriter& appendList(size_t _payloadSize);
+    RLPWriter& append(bytesConstRef _s);
+    RLPWriter& append(u256 const& _i);
+    template <unsigned N> RLPWriter& append(FixedHash<N> const& _h) { return append(_h.ref()); }
+
+    template <class T> RLPWriter& operator<<(T const& _data) { return append(_data); }
+
+    /// The bytes written so far.
+    bytesConstRef out() const { return bytesConstRef(m_buffer.data(), m_size); }
+
+private:
+    byte* claim(size_t _n);
+    void pushCount(size_t _count, byte _immBase, byte _indBase);
+
+    bytesRef m_buffer;
+    size_t m_size = 0;
+};
+
 template <class _T> void rlpListAux(RLPStream& _out, _T _t) { _out << _t; }
 template <class _T, class ... _Ts> void rlpListAux(RLPStream& _out, _T _t, _Ts ... _ts) { rlpListAux(_out << _t, _ts...); }
 
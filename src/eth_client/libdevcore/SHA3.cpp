@@ -5,7 +5,7 @@
 #include "SHA3.h"
 #include "RLP.h"
 
-#include <ethash/keccak.hpp>
+#include <crypto/sha3.h>
 
 namespace dev
 {
@@ -16,8 +16,7 @@ bool sha3(bytesConstRef _input, bytesRef o_output) noexcept
 {
     if (o_output.size() != 32)
         return false;
-    ethash::hash256 h = ethash::keccak256(_input.data(), _input.size());
-    bytesConstRef{h.bytes, 32}.copyTo(o_output);
+    Keccak256({_input.data(), _input.size()}, {o_output.data(), o_output.size()});
     return true;
 }
 }  // namespace dev
@@ -7,8 +7,6 @@
 #include "FixedHash.h"
 #include "vector_ref.h"
 
-#include <ethash/keccak.hpp>
-
 #include <string>
 
 namespace dev
@@ -57,11 +55,10 @@ inline SecureFixedHash<32> sha3Secure(std::string const& _input) noexcept
     return sha3Secure(bytesConstRef(_input));
 }
 
-/// Keccak hash variant optimized for hashing 256-bit hashes.
+/// Calculate SHA3-256 hash of a 256-bit hash.
 inline h256 sha3(h256 const& _input) noexcept
 {
-    ethash::hash256 hash = ethash::keccak256_32(_input.data());
-    return h256{hash.bytes, h256::ConstructFromPointer};
+    return sha3(_input.ref());
 }
 
 /// Calculate SHA3-256 hash of the given input (presented as a FixedHash), returns a 256-bit hash.
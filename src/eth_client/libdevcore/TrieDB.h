@@ -78,6 +78,9 @@ public:
 
     std::string at(bytes const& _key) const { return at(&_key); }
     std::string at(bytesConstRef _key) const;
+    /// Like at(), but also appends to @a _proof every node looked up by hash on the way to @a _key,
+    /// root first. The value (or its absence) can then be checked against root() alone.
+    std::string prove(bytesConstRef _key, std::vector<bytes>& _proof) const;
     void insert(bytes const& _key, bytes const& _value) { insert(&_key, &_value); }
     void insert(bytesConstRef _key, bytes const& _value) { insert(_key, &_value); }
     void insert(bytes const& _key, bytesConstRef _value) { insert(&_key, _value); }
@@ -220,6 +223,8 @@ private:
     RLPStream& streamNode(RLPStream& _s, bytes const& _b);
 
     std::string atAux(RLP const& _here, NibbleSlice _key) const;
+    std::string proveAux(RLP const& _here, NibbleSlice _key, std::vector<bytes>& _proof) const;
+    RLP proveNode(h256 const& _h, std::vector<bytes>& _proof) const;
 
     void mergeAtAux(RLPStream& _out, RLP const& _replace, NibbleSlice _key, bytesConstRef _value);
     bytes mergeAt(RLP const& _replace, NibbleSlice _k, bytesConstRef _v, bool _inLine = false);
@@ -311,6 +316,7 @@ public:
 
     bool contains(KeyType _k) const { return Generic::contains(bytesConstRef((byte const*)&_k, sizeof(KeyType))); }
     std::string at(KeyType _k) const { return Generic::at(bytesConstRef((byte const*)&_k, sizeof(KeyType))); }
+    std::string prove(KeyType _k, std::vector<bytes>& _proof) const { return Generic::prove(bytesConstRef((byte const*)&_k, sizeof(KeyType)), _proof); }
     void insert(KeyType _k, bytesConstRef _value) { Generic::insert(bytesConstRef((byte const*)&_k, sizeof(KeyType)), _value); }
     void insert(KeyType _k, bytes const& _value) { insert(_k, bytesConstRef(&_value)); }
     void remove(KeyType _k) { Generic::remove(bytesConstRef((byte const*)&_k, sizeof(KeyType))); }
@@ -372,6 +378,7 @@ public:
     using Super::debugStructure;
 
     std::string at(bytesConstRef _key) const { return Super::at(sha3(_key)); }
+    std::string prove(bytesConstRef _key, std::vector<bytes>& _proof) const { return Super::prove(sha3(_key), _proof); }
     bool contains(bytesConstRef _key) const { return Super::contains(sha3(_key)); }
     void insert(bytesConstRef _key, bytesConstRef _value) { Super::insert(sha3(_key), _value); }
     void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
@@ -423,6 +430,7 @@ public:
     using Super::debugStructure;
 
     std::string at(bytesConstRef _key) const { return Super::at(sha3(_key)); }
+    std::string prove(bytesConstRef _key, std::vector<bytes>& _proof) const { return Super::prove(sha3(_key), _proof); }
     bool contains(bytesConstRef _key) const { return Super::contains(sha3(_key)); }
     void insert(bytesConstRef _key, bytesConstRef _value)
     {
@@ -791,6 +799,47 @@ template <class DB> std::string GenericTrieDB<DB>::atAux(RLP const& _here, Nibbl
     }
 }
 
+template <class DB> std::string GenericTrieDB<DB>::prove(bytesConstRef _key, std::vector<bytes>& _proof) const
+{
+    return proveAux(proveNode(m_root, _proof), _key, _proof);
+}
+
+template <class DB> RLP GenericTrieDB<DB>::proveNode(h256 const& _h, std::vector<bytes>& _proof) const
+{
+    // Growing _proof moves the earlier nodes without reallocating their data, so RLP views into them stay valid.
+    std::string n = node(_h);
+    _proof.emplace_back(n.begin(), n.end());
+    return RLP(_proof.back());
+}
+
+template <class DB> std::string GenericTrieDB<DB>::proveAux(RLP const& _here, NibbleSlice _key, std::vector<bytes>& _proof) const
+{
+    if (_here.isEmpty() || _here.isNull())
+        return std::string();
+    unsigned itemCount = _here.itemCount();
+    assert(_here.isList() && (itemCount == 2 || itemCount == 17));
+    if (itemCount == 2)
+    {
+        auto k = keyOf(_here);
+        if (_key == k && isLeaf(_here))
+            return _here[1].toString();
+        else if (_key.contains(k) && !isLeaf(_here))
+            return proveAux(_here[1].isList() ? _here[1] : proveNode(_here[1].toHash<h256>(), _proof), _key.mid(k.size()), _proof);
+        else
+            return std::string();
+    }
+    else
+    {
+        if (_key.size() == 0)
+            return _here[16].toString();
+        auto n = _here[_key[0]];
+        if (n.isEmpty())
+            return std::string();
+        else
+            return proveAux(n.isList() ? n : proveNode(n.toHash<h256>(), _proof), _key.mid(1), _proof);
+    }
+}
+
 template <class DB> bytes GenericTrieDB<DB>::mergeAt(RLP const& _orig, NibbleSlice _k, bytesConstRef _v, bool _inLine)
 {
     return mergeAt(_orig, sha3(_orig.data()), _k, _v, _inLine);
@@ -825,7 +874,7 @@ template <class DB> bytes GenericTrieDB<DB>::mergeAt(RLP const& _orig, h256 cons
             RLPStream s(2);
             s.append(_orig[0]);
             mergeAtAux(s, _orig[1], _k.mid(k.size()), _v);
-            return s.out();
+            return s.invalidate();
         }
 
         auto sh = _k.shared(k);
@@ -863,7 +912,7 @@ template <class DB> bytes GenericTrieDB<DB>::mergeAt(RLP const& _orig, h256 cons
                 mergeAtAux(r, _orig[i], _k.mid(1), _v);
             else
                 r.append(_orig[i]);
-        return r.out();
+        return r.invalidate();
     }
 
 }
@@ -944,7 +993,7 @@ template <class DB> bytes GenericTrieDB<DB>::deleteAt(RLP const& _orig, NibbleSl
             RLP r(s.out());
             if (isTwoItemNode(r[1]))
                 return graft(r);
-            return s.out();
+            return s.invalidate();
         }
         else
             // not found - no change.
@@ -975,7 +1024,7 @@ template <class DB> bytes GenericTrieDB<DB>::deleteAt(RLP const& _orig, NibbleSl
                 for (byte i = 0; i < 16; ++i)
                     r << _orig[i];
                 r << "";
-                return r.out();
+                return r.invalidate();
             }
         }
         else
@@ -999,7 +1048,7 @@ template <class DB> bytes GenericTrieDB<DB>::deleteAt(RLP const& _orig, NibbleSl
             RLP rlp(r.out());
             byte used = uniqueInUse(rlp, 255);
             if (used == 255)	// no - all ok.
-                return r.out();
+                return r.invalidate();
 
             // yes; merge
             if (isTwoItemNode(rlp[used]))
@@ -1042,10 +1091,11 @@ template <class DB> bytes GenericTrieDB<DB>::place(RLP const& _orig, NibbleSlice
         return rlpList(_orig[0], _s);
 
     auto s = RLPStream(17);
+    s.reserve(_orig.data().size() + _s.size() + 9);
     for (unsigned i = 0; i < 16; ++i)
         s << _orig[i];
     s << _s;
-    return s.out();
+    return s.invalidate();
 }
 
 // in1: [K, S] (DEL)
@@ -1060,10 +1110,11 @@ template <class DB> bytes GenericTrieDB<DB>::remove(RLP const& _orig)
     if (_orig.itemCount() == 2)
         return RLPNull;
     RLPStream r(17);
+    r.reserve(_orig.data().size());
     for (unsigned i = 0; i < 16; ++i)
         r << _orig[i];
     r << "";
-    return r.out();
+    return r.invalidate();
 }
 
 template <class DB> RLPStream& GenericTrieDB<DB>::streamNode(RLPStream& _s, bytes const& _b)
@@ -1089,7 +1140,7 @@ template <class DB> bytes GenericTrieDB<DB>::cleve(RLP const& _orig, unsigned _s
     top << hexPrefixEncode(k, false, 0, /*ugh*/(int)_s);
     streamNode(top, bottom.out());
 
-    return top.out();
+    return top.invalidate();
 }
 
 template <class DB> bytes GenericTrieDB<DB>::graft(RLP const& _orig)
@@ -1127,7 +1178,7 @@ template <class DB> bytes GenericTrieDB<DB>::merge(RLP const& _orig, byte _i)
     else
         s << hexPrefixEncode(bytes(), true);
     s << _orig[_i];
-    return s.out();
+    return s.invalidate();
 }
 
 template <class DB> bytes GenericTrieDB<DB>::branch(RLP const& _orig)
@@ -1157,7 +1208,7 @@ template <class DB> bytes GenericTrieDB<DB>::branch(RLP const& _orig)
                 r << "";
         r << "";
     }
-    return r.out();
+    return r.invalidate();
 }
 
 }
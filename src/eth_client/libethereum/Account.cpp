@@ -38,17 +38,28 @@ void Account::resetCode()
     m_version = 0;
 }
 
-u256 Account::originalStorageValue(u256 const& _key, OverlayDB const& _db) const
+u256 Account::originalStorageValue(u256 const& _key, OverlayDB const& _db, StateCache* _sharedCache) const
 {
     auto it = m_storageOriginal.find(_key);
     if (it != m_storageOriginal.end())
         return it->second;
 
+    // An empty storage trie has nothing worth caching
+    bool const useSharedCache = _sharedCache && m_storageRoot != EmptyTrie;
+    u256 value;
+    if (useSharedCache && _sharedCache->storage(m_storageRoot, _key, value))
+    {
+        m_storageOriginal[_key] = value;
+        return value;
+    }
+
     // Not in the original values cache - go to the DB.
     SecureTrieDB<h256, OverlayDB> const memdb(const_cast<OverlayDB*>(&_db), m_storageRoot);
     std::string const payload = memdb.at(_key);
-    auto const value = payload.size() ? RLP(payload).toInt<u256>() : 0;
+    value = payload.size() ? RLP(payload).toInt<u256>() : 0;
     m_storageOriginal[_key] = value;
+    if (useSharedCache)
+        _sharedCache->storeStorage(m_storageRoot, _key, value);
     return value;
 }
 
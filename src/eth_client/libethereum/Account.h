@@ -9,6 +9,7 @@
 #include <libdevcore/SHA3.h>
 #include <libdevcore/TrieCommon.h>
 #include <libethcore/Common.h>
+#include <libethereum/StateCache.h>
 
 #include <boost/filesystem/path.hpp>
 
@@ -122,18 +123,18 @@ public:
 
     /// @returns account's storage value corresponding to the @_key
     /// taking into account overlayed modifications
-    u256 storageValue(u256 const& _key, OverlayDB const& _db) const
+    u256 storageValue(u256 const& _key, OverlayDB const& _db, StateCache* _sharedCache = nullptr) const
     {
         auto mit = m_storageOverlay.find(_key);
         if (mit != m_storageOverlay.end())
             return mit->second;
 
-        return originalStorageValue(_key, _db);
+        return originalStorageValue(_key, _db, _sharedCache);
     }
 
     /// @returns account's original storage value corresponding to the @_key
     /// not taking into account overlayed modifications
-    u256 originalStorageValue(u256 const& _key, OverlayDB const& _db) const;
+    u256 originalStorageValue(u256 const& _key, OverlayDB const& _db, StateCache* _sharedCache = nullptr) const;
 
     /// @returns the storage overlay as a simple hash map.
     std::unordered_map<u256, u256> const& storageOverlay() const { return m_storageOverlay; }
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <list>
 #include <map>
+#include <unordered_map>
+#include <libdevcore/Common.h>
 #include <libdevcore/FixedHash.h>
 #include <libdevcore/Guards.h>
 
@@ -58,6 +61,61 @@ private:
 	std::map<h256, size_t> m_cache;
 };
 
+/**
+ * @brief Thread-safe cache from code hash to code, evicting the least recently used code
+ * once the total size passes the budget. Code is content-addressed, so entries never go stale.
+ */
+class CodeCache
+{
+public:
+	void store(h256 const& _hash, bytes const& _code)
+	{
+		UniqueGuard g(x_cache);
+		if (_code.size() > m_maxSize || m_cache.count(_hash))
+			return;
+		m_lru.push_front(_hash);
+		m_cache.emplace(_hash, std::make_pair(_code, m_lru.begin()));
+		m_size += _code.size();
+		evict();
+	}
+	bool get(h256 const& _hash, bytes& o_code)
+	{
+		UniqueGuard g(x_cache);
+		auto it = m_cache.find(_hash);
+		if (it == m_cache.end())
+			return false;
+		m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+		o_code = it->second.first;
+		return true;
+	}
+	void setMaxSize(size_t _maxSize)
+	{
+		UniqueGuard g(x_cache);
+		m_maxSize = _maxSize;
+		evict();
+	}
+
+	static CodeCache& instance() { static CodeCache cache; return cache; }
+
+private:
+	void evict()
+	{
+		while (m_size > m_maxSize)
+		{
+			auto it = m_cache.find(m_lru.back());
+			m_size -= it->second.first.size();
+			m_cache.erase(it);
+			m_lru.pop_back();
+		}
+	}
+
+	size_t m_maxSize = 0;
+	size_t m_size = 0;
+	mutable Mutex x_cache;
+	std::list<h256> m_lru;
+	std::unordered_map<h256, std::pair<bytes, std::list<h256>::iterator>> m_cache;
+};
+
 }
 }
 
@@ -164,9 +164,28 @@ Account* State::account(Address const& _addr)
     if (m_nonExistingAccountsCache.count(_addr))
         return nullptr;
 
-    // Populate basic info.
-    string stateBack = m_state.at(_addr);
-    if (stateBack.empty())
+    StateCache::CachedAccount cached;
+    h256 const root = m_sharedCache ? m_state.root() : h256();
+    if (!m_sharedCache || !m_sharedCache->account(root, _addr, cached))
+    {
+        // Populate basic info.
+        string stateBack = m_state.at(_addr);
+        if (!stateBack.empty())
+        {
+            RLP state(stateBack);
+            cached.exists = true;
+            cached.nonce = state[0].toInt<u256>();
+            cached.balance = state[1].toInt<u256>();
+            cached.storageRoot = state[2].toHash<h256>();
+            cached.codeHash = state[3].toHash<h256>();
+            // version is 0 if absent from RLP
+            cached.version = state[4] ? state[4].toInt<u256>() : 0;
+        }
+        if (m_sharedCache)
+            m_sharedCache->storeAccount(root, _addr, cached);
+    }
+
+    if (!cached.exists)
     {
         m_nonExistingAccountsCache.insert(_addr);
         return nullptr;
@@ -174,16 +193,8 @@ Account* State::account(Address const& _addr)
 
     clearCacheIfTooLarge();
 
-    RLP state(stateBack);
-    auto const nonce = state[0].toInt<u256>();
-    auto const balance = state[1].toInt<u256>();
-    auto const storageRoot = state[2].toHash<h256>();
-    auto const codeHash = state[3].toHash<h256>();
-    // version is 0 if absent from RLP
-    auto const version = state[4] ? state[4].toInt<u256>() : 0;
-
     auto i = m_cache.emplace(piecewise_construct, forward_as_tuple(_addr),
-        forward_as_tuple(nonce, balance, storageRoot, codeHash, version, Account::Unchanged));
+        forward_as_tuple(cached.nonce, cached.balance, cached.storageRoot, cached.codeHash, cached.version, Account::Unchanged));
     m_unchangedCacheEntries.push_back(_addr);
     return &i.first->second;
 }
@@ -211,7 +222,15 @@ void State::commit(CommitBehaviour _commitBehaviour)
 {
     if (_commitBehaviour == CommitBehaviour::RemoveEmptyAccounts)
         removeEmptyAccounts();
-    m_touched += dev::eth::commit(m_cache, m_state);
+    if (m_sharedCache)
+    {
+        h256 const from = m_state.root();
+        AddressHash const changed = dev::eth::commit(m_cache, m_state, m_sharedCache.get());
+        m_sharedCache->commitAccounts(from, m_state.root(), changed);
+        m_touched += changed;
+    }
+    else
+        m_touched += dev::eth::commit(m_cache, m_state);
     m_changeLog.clear();
     m_cache.clear();
     m_unchangedCacheEntries.clear();
@@ -432,7 +451,7 @@ u256 State::getNonce(Address const& _addr) const
 u256 State::storage(Address const& _id, u256 const& _key) const
 {
     if (Account const* a = account(_id))
-        return a->storageValue(_key, m_db);
+        return a->storageValue(_key, m_db, m_sharedCache.get());
     else
         return 0;
 }
@@ -463,7 +482,7 @@ void State::setTransientStorage(Address const& _contract, u256 const& _key, u256
 u256 State::originalStorageValue(Address const& _contract, u256 const& _key) const
 {
     if (Account const* a = account(_contract))
-        return a->originalStorageValue(_key, m_db);
+        return a->originalStorageValue(_key, m_db, m_sharedCache.get());
     else
         return 0;
 }
@@ -532,6 +551,34 @@ h256 State::storageRoot(Address const& _id) const
     return EmptyTrie;
 }
 
+namespace
+{
+template <class KeyType>
+std::string proveAt(OverlayDB const& _db, h256 const& _root, KeyType const& _key, std::vector<bytes>& _proof)
+{
+    if (_root == EmptyTrie)
+    {
+        // The empty trie is implied by its root and need not be in the database.
+        _proof.push_back(RLPNull);
+        return std::string();
+    }
+    SecureTrieDB<KeyType, OverlayDB> const trie(const_cast<OverlayDB*>(&_db), _root, Verification::Skip);
+    if (trie.isNull())
+        BOOST_THROW_EXCEPTION(RootNotFound() << errinfo_hash256(_root));
+    return trie.prove(_key, _proof);
+}
+}
+
+std::string State::proveAccount(h256 const& _root, Address const& _addr, std::vector<bytes>& _proof) const
+{
+    return proveAt(m_db, _root, _addr, _proof);
+}
+
+std::string State::proveStorage(h256 const& _storageRoot, h256 const& _key, std::vector<bytes>& _proof) const
+{
+    return proveAt(m_db, _storageRoot, _key, _proof);
+}
+
 bytes const& State::code(Address const& _addr) const
 {
     Account const* a = account(_addr);
@@ -542,7 +589,14 @@ bytes const& State::code(Address const& _addr) const
     {
         // Load the code from the backend.
         Account* mutableAccount = const_cast<Account*>(a);
-        mutableAccount->noteCode(m_db.lookup(a->codeHash()));
+        bytes code;
+        if (CodeCache::instance().get(a->codeHash(), code))
+            mutableAccount->noteCode(&code);
+        else
+        {
+            mutableAccount->noteCode(m_db.lookup(a->codeHash()));
+            CodeCache::instance().store(a->codeHash(), a->code());
+        }
         CodeSizeCache::instance().store(a->codeHash(), a->code().size());
     }
 
@@ -783,7 +837,7 @@ std::ostream& dev::eth::operator<<(std::ostream& _out, State const& _s)
 }
 
 template <class DB>
-AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
+AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state, StateCache* _sharedCache)
 {
     AddressHash ret;
     for (auto const& i: _cache)
@@ -794,44 +848,47 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
             else
             {
                 auto const version = i.second.version();
-
-                // version = 0: [nonce, balance, storageRoot, codeHash]
-                // version > 0: [nonce, balance, storageRoot, codeHash, version]
-                RLPStream s(version != 0 ? 5 : 4);
-                s << i.second.nonce() << i.second.balance();
+                h256 storageRoot = i.second.baseRoot();
 
                 if (i.second.storageOverlay().empty())
-                {
-                    assert(i.second.baseRoot());
-                    s.append(i.second.baseRoot());
-                }
+                    assert(storageRoot);
                 else
                 {
-                    SecureTrieDB<h256, DB> storageDB(_state.db(), i.second.baseRoot());
+                    SecureTrieDB<h256, DB> storageDB(_state.db(), storageRoot);
+                    std::array<byte, 33> value;
                     for (auto const& j: i.second.storageOverlay())
                         if (j.second)
-                            storageDB.insert(j.first, rlp(j.second));
+                            storageDB.insert(j.first, (RLPWriter(bytesRef(value.data(), value.size())) << j.second).out());
                         else
                             storageDB.remove(j.first);
                     assert(storageDB.root());
-                    s.append(storageDB.root());
+                    if (_sharedCache)
+                        _sharedCache->commitStorage(i.second.baseRoot(), storageDB.root(), i.second.storageOverlay());
+                    storageRoot = storageDB.root();
                 }
 
+                h256 codeHash = i.second.codeHash();
                 if (i.second.hasNewCode())
                 {
-                    h256 ch = i.second.codeHash();
                     // Store the size of the code
-                    CodeSizeCache::instance().store(ch, i.second.code().size());
-                    _state.db()->insert(ch, &i.second.code());
-                    s << ch;
+                    CodeSizeCache::instance().store(codeHash, i.second.code().size());
+                    CodeCache::instance().store(codeHash, i.second.code());
+                    _state.db()->insert(codeHash, &i.second.code());
                 }
-                else
-                    s << i.second.codeHash();
 
+                // version = 0: [nonce, balance, storageRoot, codeHash]
+                // version > 0: [nonce, balance, storageRoot, codeHash, version]
+                // Encoded on the stack: at most a 2 byte list prefix and five 33 byte items.
+                size_t payload = rlpSize(i.second.nonce()) + rlpSize(i.second.balance()) + rlpSize(storageRoot) + rlpSize(codeHash);
+                if (version != 0)
+                    payload += rlpSize(version);
+                std::array<byte, 2 + 5 * 33> account;
+                RLPWriter s(bytesRef(account.data(), account.size()));
+                s.appendList(payload) << i.second.nonce() << i.second.balance() << storageRoot << codeHash;
                 if (version != 0)
-                    s << i.second.version();
+                    s << version;
 
-                _state.insert(i.first, &s.out());
+                _state.insert(i.first, s.out());
             }
             ret.insert(i.first);
         }
@@ -839,5 +896,5 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
 }
 
 
-template AddressHash dev::eth::commit<OverlayDB>(AccountMap const& _cache, SecureTrieDB<Address, OverlayDB>& _state);
-template AddressHash dev::eth::commit<StateCacheDB>(AccountMap const& _cache, SecureTrieDB<Address, StateCacheDB>& _state);
+template AddressHash dev::eth::commit<OverlayDB>(AccountMap const& _cache, SecureTrieDB<Address, OverlayDB>& _state, StateCache* _sharedCache);
+template AddressHash dev::eth::commit<StateCacheDB>(AccountMap const& _cache, SecureTrieDB<Address, StateCacheDB>& _state, StateCache* _sharedCache);
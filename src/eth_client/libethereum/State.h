@@ -14,6 +14,7 @@
 #include <libethcore/BlockHeader.h>
 #include <libethcore/Exceptions.h>
 #include <libethereum/CodeSizeCache.h>
+#include <libethereum/StateCache.h>
 #include <libevm/ExtVMFace.h>
 #include <array>
 #include <unordered_map>
@@ -179,6 +180,11 @@ public:
     OverlayDB const& db() const { return m_db; }
     OverlayDB& db() { return m_db; }
 
+    /// Share decoded accounts and storage with later blocks through @a _cache; only for the state
+    /// that follows the chain. Copies of this State do not inherit it.
+    void setSharedCache(std::shared_ptr<StateCache> _cache) { m_sharedCache = std::move(_cache); }
+    std::shared_ptr<StateCache> const& sharedCache() const { return m_sharedCache; }
+
     /// Populate the state from the given AccountMap. Just uses dev::eth::commit().
     void populateFrom(AccountMap const& _map);
 
@@ -233,6 +239,17 @@ public:
     /// Get the root of the storage of an account.
     h256 storageRoot(Address const& _contract) const;
 
+    /// Get the RLP of the account at @a _addr in the committed state with root @a _root, and append
+    /// the trie nodes proving it (or its absence) to @a _proof.
+    /// @returns an empty string if no account exists at that address.
+    /// @throws RootNotFound if @a _root is not in the database.
+    std::string proveAccount(h256 const& _root, Address const& _addr, std::vector<bytes>& _proof) const;
+
+    /// Get the RLP of the storage value at @a _key in the storage trie with root @a _storageRoot,
+    /// and append the trie nodes proving it to @a _proof.
+    /// @returns an empty string if the position holds zero.
+    std::string proveStorage(h256 const& _storageRoot, h256 const& _key, std::vector<bytes>& _proof) const;
+
     /// Get the value of a storage position of an account.
     /// @returns 0 if no account exists at that address.
     u256 storage(Address const& _contract, u256 const& _memory) const;
@@ -383,6 +400,8 @@ protected:
     AddressHash m_touched;
     /// Tracks addresses that were touched and should stay touched in case of rollback
     AddressHash m_unrevertablyTouched;
+    /// Cache of accounts and storage outliving m_cache, see setSharedCache().
+    std::shared_ptr<StateCache> m_sharedCache;
 
     u256 m_accountStartNonce;
 
@@ -395,7 +414,7 @@ protected:
 std::ostream& operator<<(std::ostream& _out, State const& _s);
 
 template <class DB>
-AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state);
+AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state, StateCache* _sharedCache = nullptr);
 
 }
 }
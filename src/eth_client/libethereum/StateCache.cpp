@@ -0,0 +1,165 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "StateCache.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+bool StateCache::account(h256 const& _root, Address const& _address, CachedAccount& o_account)
+{
+	Guard l(x_cache);
+	if (_root != m_accountRoot)
+		return false;
+	auto it = m_accounts.find(_address);
+	if (it == m_accounts.end())
+		return false;
+	m_accountLru.splice(m_accountLru.begin(), m_accountLru, it->second.lru);
+	o_account = it->second.account;
+	return true;
+}
+
+void StateCache::storeAccount(h256 const& _root, Address const& _address, CachedAccount const& _account)
+{
+	Guard l(x_cache);
+	if (m_accounts.empty())
+		m_accountRoot = _root;
+	else if (_root != m_accountRoot)
+		return;
+
+	auto it = m_accounts.find(_address);
+	if (it != m_accounts.end())
+	{
+		it->second.account = _account;
+		m_accountLru.splice(m_accountLru.begin(), m_accountLru, it->second.lru);
+		return;
+	}
+	m_accountLru.push_front(_address);
+	m_accounts.emplace(_address, AccountEntry{_account, m_accountLru.begin()});
+	m_accountsSize += c_accountSize;
+	evict();
+}
+
+void StateCache::commitAccounts(h256 const& _from, h256 const& _to, AddressHash const& _changed)
+{
+	Guard l(x_cache);
+	if (_from != m_accountRoot)
+		clearAccounts();
+	else
+		for (auto const& address: _changed)
+		{
+			auto it = m_accounts.find(address);
+			if (it == m_accounts.end())
+				continue;
+			m_accountLru.erase(it->second.lru);
+			m_accounts.erase(it);
+			m_accountsSize -= c_accountSize;
+		}
+	m_accountRoot = _to;
+}
+
+bool StateCache::storage(h256 const& _storageRoot, u256 const& _key, u256& o_value)
+{
+	Guard l(x_cache);
+	auto it = m_storage.find(_storageRoot);
+	if (it == m_storage.end())
+		return false;
+	auto slot = it->second.slots.find(_key);
+	if (slot == it->second.slots.end())
+		return false;
+	m_storageLru.splice(m_storageLru.begin(), m_storageLru, it->second.lru);
+	o_value = slot->second;
+	return true;
+}
+
+void StateCache::storeStorage(h256 const& _storageRoot, u256 const& _key, u256 const& _value)
+{
+	Guard l(x_cache);
+	auto it = m_storage.find(_storageRoot);
+	if (it == m_storage.end())
+	{
+		m_storageLru.push_front(_storageRoot);
+		it = m_storage.emplace(_storageRoot, StorageEntry{{}, m_storageLru.begin()}).first;
+		m_storageSize += c_rootSize;
+	}
+	else
+		m_storageLru.splice(m_storageLru.begin(), m_storageLru, it->second.lru);
+	if (it->second.slots.emplace(_key, _value).second)
+		m_storageSize += c_slotSize;
+	evict();
+}
+
+void StateCache::commitStorage(h256 const& _from, h256 const& _to, unordered_map<u256, u256> const& _written)
+{
+	Guard l(x_cache);
+	auto from = m_storage.find(_from);
+	if (from == m_storage.end() || _from == _to)
+		return;
+
+	StorageEntry entry = std::move(from->second);
+	m_storage.erase(from);
+	m_storageSize -= c_rootSize + entry.slots.size() * c_slotSize;
+	for (auto const& i: _written)
+		entry.slots[i.first] = i.second;
+
+	// Slots read under the new root before this commit are just as valid; keep them
+	auto to = m_storage.find(_to);
+	if (to != m_storage.end())
+	{
+		m_storageSize -= c_rootSize + to->second.slots.size() * c_slotSize;
+		entry.slots.insert(to->second.slots.begin(), to->second.slots.end());
+		m_storageLru.erase(to->second.lru);
+		m_storage.erase(to);
+	}
+	m_storageLru.splice(m_storageLru.begin(), m_storageLru, entry.lru);
+	*entry.lru = _to;
+	m_storageSize += c_rootSize + entry.slots.size() * c_slotSize;
+	m_storage.emplace(_to, std::move(entry));
+	evict();
+}
+
+void StateCache::clear()
+{
+	Guard l(x_cache);
+	clearAccounts();
+	m_storage.clear();
+	m_storageLru.clear();
+	m_storageSize = 0;
+}
+
+size_t StateCache::memoryUsage() const
+{
+	Guard l(x_cache);
+	return m_accountsSize + m_storageSize;
+}
+
+void StateCache::evict()
+{
+	// Storage gets half the budget while there are accounts to evict instead
+	while (m_accountsSize + m_storageSize > m_maxSize)
+	{
+		if (!m_storageLru.empty() && (m_storageSize > m_maxSize / 2 || m_accountLru.empty()))
+		{
+			auto it = m_storage.find(m_storageLru.back());
+			m_storageSize -= c_rootSize + it->second.slots.size() * c_slotSize;
+			m_storage.erase(it);
+			m_storageLru.pop_back();
+		}
+		else if (!m_accountLru.empty())
+		{
+			m_accounts.erase(m_accountLru.back());
+			m_accountLru.pop_back();
+			m_accountsSize -= c_accountSize;
+		}
+		else
+			break;
+	}
+}
+
+void StateCache::clearAccounts()
+{
+	m_accounts.clear();
+	m_accountLru.clear();
+	m_accountsSize = 0;
+}
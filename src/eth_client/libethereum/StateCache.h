@@ -0,0 +1,92 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <libdevcore/Address.h>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+
+namespace dev
+{
+namespace eth
+{
+
+/**
+ * @brief Thread-safe cache of decoded accounts and storage slots that outlives a State's own cache.
+ *
+ * Storage slots are keyed by the storage root they were read under, so they never go stale; when a
+ * commit moves an account's storage to a new root its cached slots move along with the written values.
+ * Accounts are valid for a single state root only. commitAccounts() moves them to the root after a
+ * commit, dropping the accounts it wrote, and drops everything when the commit did not start at that root.
+ * Least recently used entries are evicted to stay within the memory budget.
+ */
+class StateCache
+{
+public:
+	struct CachedAccount
+	{
+		bool exists = false;
+		u256 nonce;
+		u256 balance;
+		h256 storageRoot;
+		h256 codeHash;
+		u256 version;
+	};
+
+	explicit StateCache(size_t _maxSize): m_maxSize(_maxSize) {}
+
+	/// @returns true and sets @a o_account if @a _address is cached for state root @a _root.
+	bool account(h256 const& _root, Address const& _address, CachedAccount& o_account);
+	/// Caches @a _address as read under @a _root; ignored if the cache follows a different root.
+	void storeAccount(h256 const& _root, Address const& _address, CachedAccount const& _account);
+	/// Moves the accounts from @a _from to @a _to after the accounts in @a _changed were written.
+	void commitAccounts(h256 const& _from, h256 const& _to, AddressHash const& _changed);
+
+	/// @returns true and sets @a o_value if @a _key is cached for storage root @a _storageRoot.
+	bool storage(h256 const& _storageRoot, u256 const& _key, u256& o_value);
+	void storeStorage(h256 const& _storageRoot, u256 const& _key, u256 const& _value);
+	/// Moves the slots of @a _from to @a _to after @a _written was written on top of @a _from.
+	void commitStorage(h256 const& _from, h256 const& _to, std::unordered_map<u256, u256> const& _written);
+
+	void clear();
+	size_t memoryUsage() const;
+
+private:
+	struct AccountEntry
+	{
+		CachedAccount account;
+		std::list<Address>::iterator lru;
+	};
+	struct StorageEntry
+	{
+		std::unordered_map<u256, u256> slots;
+		std::list<h256>::iterator lru;
+	};
+
+	/// Rough heap cost of the entries, including the map and list nodes.
+	static constexpr size_t c_accountSize = 256;
+	static constexpr size_t c_rootSize = 128;
+	static constexpr size_t c_slotSize = 112;
+
+	void evict();
+	void clearAccounts();
+
+	size_t const m_maxSize;
+	mutable Mutex x_cache;
+
+	h256 m_accountRoot;
+	std::unordered_map<Address, AccountEntry> m_accounts;
+	std::list<Address> m_accountLru;
+	size_t m_accountsSize = 0;
+
+	std::unordered_map<h256, StorageEntry> m_storage;
+	std::list<h256> m_storageLru;
+	size_t m_storageSize = 0;
+};
+
+}
+}
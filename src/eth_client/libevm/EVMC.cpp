@@ -3,8 +3,14 @@
 // Licensed under the GNU General Public License, Version 3.
 #include "EVMC.h"
 
+#include <libdevcore/Guards.h>
 #include <libdevcore/Log.h>
 #include <libevm/VMFactory.h>
+#include <evmone/baseline.hpp>
+#include <evmone/vm.hpp>
+
+#include <list>
+#include <unordered_map>
 
 namespace dev
 {
@@ -40,8 +46,115 @@ evmc_revision toRevision(EVMSchedule const& _schedule) noexcept
         return EVMC_HOMESTEAD;
     return EVMC_FRONTIER;
 }
+/**
+ * Process-wide cache of evmone's baseline analysis (padded code and jumpdest map) of deployed
+ * legacy code, keyed by code hash. Entries are shared, so executions keep theirs alive after
+ * eviction; least recently used entries are evicted once the total size passes the budget.
+ */
+class CodeAnalysisCache
+{
+public:
+    using Analysis = std::shared_ptr<evmone::baseline::CodeAnalysis const>;
+
+    Analysis get(h256 const& _codeHash, bytesConstRef _code)
+    {
+        {
+            Guard l(x_cache);
+            auto it = m_cache.find(_codeHash);
+            if (it != m_cache.end() && it->second.analysis->raw_code().size() == _code.size())
+            {
+                m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+                return it->second.analysis;
+            }
+        }
+
+        // Analyse outside the lock; a concurrent miss on the same code only duplicates work
+        Analysis analysis = std::make_shared<evmone::baseline::CodeAnalysis const>(
+            evmone::baseline::analyze({_code.data(), _code.size()}, false));
+        size_t const size = entrySize(_code.size());
+        if (size > c_maxSize)
+            return analysis;
+
+        Guard l(x_cache);
+        if (m_cache.count(_codeHash))
+            return analysis;
+        m_lru.push_front(_codeHash);
+        m_cache.emplace(_codeHash, Entry{analysis, m_lru.begin()});
+        m_size += size;
+        while (m_size > c_maxSize)
+        {
+            auto last = m_cache.find(m_lru.back());
+            m_size -= entrySize(last->second.analysis->raw_code().size());
+            m_cache.erase(last);
+            m_lru.pop_back();
+        }
+        return analysis;
+    }
+
+    static CodeAnalysisCache& instance()
+    {
+        static CodeAnalysisCache cache;
+        return cache;
+    }
+
+private:
+    struct Entry
+    {
+        Analysis analysis;
+        std::list<h256>::iterator lru;
+    };
+
+    /// Padded code plus one jumpdest bit per byte, and the bookkeeping around it.
+    static size_t entrySize(size_t _codeSize) { return _codeSize + _codeSize / 8 + 256; }
+
+    static constexpr size_t c_maxSize = 64 * 1024 * 1024;
+
+    Mutex x_cache;
+    std::list<h256> m_lru;
+    std::unordered_map<h256, Entry> m_cache;
+    size_t m_size = 0;
+};
+
+/// Tracer of the executions on this thread, see ScopedEVMCTracer
+thread_local evmone::Tracer* t_tracer = nullptr;
+
+/// Hands the notifications of one frame's VM to the thread's tracer, which the VM must not own
+class TracerForwarder : public evmone::Tracer
+{
+public:
+    explicit TracerForwarder(evmone::Tracer& _tracer) noexcept : m_tracer(_tracer) {}
+
+private:
+    void on_execution_start(
+        evmc_revision _rev, evmc_message const& _msg, evmone::bytes_view _code) noexcept override
+    {
+        m_tracer.notify_execution_start(_rev, _msg, _code);
+    }
+    void on_instruction_start(uint32_t _pc, intx::uint256 const* _stackTop, int _stackHeight,
+        int64_t _gas, evmone::ExecutionState const& _state) noexcept override
+    {
+        m_tracer.notify_instruction_start(
+            _pc, const_cast<intx::uint256*>(_stackTop), _stackHeight, _gas, _state);
+    }
+    void on_execution_end(evmc_result const& _result) noexcept override
+    {
+        m_tracer.notify_execution_end(_result);
+    }
+
+    evmone::Tracer& m_tracer;
+};
 }  // namespace
 
+ScopedEVMCTracer::ScopedEVMCTracer(evmone::Tracer& _tracer) noexcept : m_previous(t_tracer)
+{
+    t_tracer = &_tracer;
+}
+
+ScopedEVMCTracer::~ScopedEVMCTracer() noexcept
+{
+    t_tracer = m_previous;
+}
+
 EVMC::EVMC(evmc_vm* _vm, std::vector<std::pair<std::string, std::string>> const& _options) noexcept
   : evmc::VM(_vm)
 {
@@ -66,6 +179,9 @@ EVMC::EVMC(evmc_vm* _vm, std::vector<std::pair<std::string, std::string>> const&
             cwarn << "Unknown error when setting EVMC option '" << pair.first << "'";
         }
     }
+
+    // The "advanced" option swaps in an interpreter with its own kind of analysis
+    m_baseline = _vm->execute == static_cast<evmc_execute_fn>(evmone::baseline::execute);
 }
 
 owning_bytes_ref EVMC::exec(u256& io_gas, ExtVMFace& _ext, const OnOpFunc& _onOp)
@@ -92,7 +208,24 @@ owning_bytes_ref EVMC::exec(u256& io_gas, ExtVMFace& _ext, const OnOpFunc& _onOp
         toEvmC(_ext.caller), _ext.data.data(), _ext.data.size(), toEvmC(_ext.value),
         toEvmC(0x0_cppui256), toEvmC(_ext.myAddress)};
     EvmCHost host{_ext};
-    auto r = execute(host, mode, msg, _ext.code.data(), _ext.code.size());
+    // Every frame runs on a VM of its own, so the tracer is attached for this execution only
+    auto& vm = *static_cast<evmone::VM*>(get_raw_pointer());
+    if (t_tracer)
+        vm.add_tracer(std::make_unique<TracerForwarder>(*t_tracer));
+    evmc::Result r;
+    bytesConstRef const code{_ext.code.data(), _ext.code.size()};
+    if (m_baseline && !_ext.isCreate && !code.empty() &&
+        !evmone::is_eof_container({code.data(), code.size()}))
+    {
+        // Deployed legacy code: reuse its analysis across calls
+        auto const analysis = CodeAnalysisCache::instance().get(_ext.codeHash, code);
+        r = evmc::Result{evmone::baseline::execute(
+            vm, evmc::Host::get_interface(), host.to_context(), mode, msg, *analysis)};
+    }
+    else
+        r = execute(host, mode, msg, _ext.code.data(), _ext.code.size());
+    if (t_tracer)
+        vm.remove_tracers();
     // FIXME: Copy the output for now, but copyless version possible.
     auto output = owning_bytes_ref{{&r.output_data[0], &r.output_data[r.output_size]}, 0, r.output_size};
 
@@ -9,10 +9,32 @@
 #include <utility>
 #include <vector>
 
+namespace evmone
+{
+class Tracer;
+}
+
 namespace dev
 {
 namespace eth
 {
+/// Attaches an evmone tracer to the EVMC executions of the calling thread while in scope, nested
+/// call frames included. Frames are reported through evmone's own tracing hooks, so untraced
+/// executions pay nothing and traced ones avoid OnOpFunc's per-op std::function and bigints.
+/// The tracer is not owned.
+class ScopedEVMCTracer
+{
+public:
+    explicit ScopedEVMCTracer(evmone::Tracer& _tracer) noexcept;
+    ~ScopedEVMCTracer() noexcept;
+
+    ScopedEVMCTracer(ScopedEVMCTracer const&) = delete;
+    ScopedEVMCTracer& operator=(ScopedEVMCTracer const&) = delete;
+
+private:
+    evmone::Tracer* m_previous;
+};
+
 /// The wrapper implementing the VMFace interface with a EVMC VM as a backend.
 class EVMC : public evmc::VM, public VMFace
 {
@@ -20,6 +42,10 @@ public:
     EVMC(evmc_vm* _vm, std::vector<std::pair<std::string, std::string>> const& _options) noexcept;
 
     owning_bytes_ref exec(u256& io_gas, ExtVMFace& _ext, OnOpFunc const& _onOp) final;
+
+private:
+    /// True if the VM is evmone's baseline interpreter, which can run a cached code analysis.
+    bool m_baseline = false;
 };
 }  // namespace eth
 }  // namespace dev
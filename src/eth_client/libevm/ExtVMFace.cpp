@@ -4,6 +4,8 @@
 
 #include "ExtVMFace.h"
 
+#include <libdevcore/OverlayDB.h>
+
 #include <evmc/helpers.h>
 #include <evmc/instructions.h>
 using namespace evmc;
@@ -17,6 +19,49 @@ static_assert(alignof(Address) == alignof(evmc_address), "Address types alignmen
 static_assert(sizeof(h256) == sizeof(evmc_uint256be), "Hash types size mismatch");
 static_assert(alignof(h256) == alignof(evmc_uint256be), "Hash types alignment mismatch");
 
+namespace
+{
+thread_local StorageAccessCounts* t_storageAccessCounts = nullptr;
+
+/// Counts a storage access, with the disk reads made until the end of the scope
+class StorageAccessRecord
+{
+public:
+    StorageAccessRecord(evmc::address const& _addr, bool _store) noexcept
+      : m_counts{t_storageAccessCounts}, m_addr{_addr}, m_store{_store}
+    {
+        if (m_counts)
+            m_diskReads = OverlayDB::diskReads();
+    }
+
+    ~StorageAccessRecord() noexcept
+    {
+        if (!m_counts)
+            return;
+        StorageAccess& access = (*m_counts)[fromEvmC(m_addr)];
+        ++(m_store ? access.stores : access.loads);
+        access.diskReads += OverlayDB::diskReads() - m_diskReads;
+    }
+
+private:
+    StorageAccessCounts* m_counts;
+    evmc::address const& m_addr;
+    bool m_store;
+    uint64_t m_diskReads = 0;
+};
+}  // namespace
+
+ScopedStorageAccessCounter::ScopedStorageAccessCounter(StorageAccessCounts& _counts) noexcept
+  : m_previous{t_storageAccessCounts}
+{
+    t_storageAccessCounts = &_counts;
+}
+
+ScopedStorageAccessCounter::~ScopedStorageAccessCounter() noexcept
+{
+    t_storageAccessCounts = m_previous;
+}
+
 bool EvmCHost::account_exists(evmc::address const& _addr) const noexcept
 {
     record_account_access(_addr);
@@ -28,6 +73,7 @@ evmc::bytes32 EvmCHost::get_storage(evmc::address const& _addr, evmc::bytes32 co
 {
     assert(fromEvmC(_addr) == m_extVM.myAddress);
     record_account_access(_addr);
+    StorageAccessRecord const record{_addr, false};
     return toEvmC(m_extVM.store(fromEvmC(_key)));
 }
 
@@ -39,6 +85,7 @@ evmc_storage_status EvmCHost::set_storage(
 
     assert(fromEvmC(_addr) == m_extVM.myAddress);
     record_account_access(_addr);
+    StorageAccessRecord const record{_addr, true};
     u256 const index = fromEvmC(_key);
     u256 const newValue = fromEvmC(_value);
     u256 const currentValue = m_extVM.store(index);
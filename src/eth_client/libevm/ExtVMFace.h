@@ -318,6 +318,31 @@ struct AccessAccount
     AccessAccount() noexcept = default;
 };
 
+/// Storage reads and writes of a contract, and the disk reads of the state database they caused
+struct StorageAccess
+{
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    uint64_t diskReads = 0;
+};
+
+using StorageAccessCounts = std::unordered_map<Address, StorageAccess>;
+
+/// Counts the storage accesses of the EVM executions of this thread, by contract, while in
+/// scope. Scopes nest and the innermost one counts. The counts are not owned.
+class ScopedStorageAccessCounter
+{
+public:
+    explicit ScopedStorageAccessCounter(StorageAccessCounts& _counts) noexcept;
+    ~ScopedStorageAccessCounter() noexcept;
+
+    ScopedStorageAccessCounter(ScopedStorageAccessCounter const&) = delete;
+    ScopedStorageAccessCounter& operator=(ScopedStorageAccessCounter const&) = delete;
+
+private:
+    StorageAccessCounts* m_previous;
+};
+
 class EvmCHost : public evmc::Host
 {
 public:
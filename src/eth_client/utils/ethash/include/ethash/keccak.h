@@ -22,6 +22,13 @@ union ethash_hash256 ethash_keccak256_32(const uint8_t data[32]) noexcept;
 union ethash_hash512 ethash_keccak512(const uint8_t* data, size_t size) noexcept;
 union ethash_hash512 ethash_keccak512_64(const uint8_t data[64]) noexcept;
 
+#if defined(QTUM_BUILD)
+/// Route the Keccak-f[1600] permutation of all hashes above through @p fn,
+/// the node's runtime-selected implementation. NULL restores the built-in one.
+/// Not thread-safe: set it before any hashing starts.
+void ethash_keccakf1600_set(void (*fn)(uint64_t state[25])) noexcept;
+#endif
+
 #ifdef __cplusplus
 }
 #endif
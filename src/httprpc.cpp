@@ -24,6 +24,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using util::SplitString;
@@ -159,6 +160,26 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return multiUserAuthorized(strUserPass);
 }
 
+bool CheckRPCAuthorization(const std::string& auth_header, std::string& user_out)
+{
+    return RPCAuthorized(auth_header, user_out);
+}
+
+bool RPCMethodAllowed(const std::string& user, const std::string& method)
+{
+    const auto it = g_rpc_whitelist.find(user);
+    if (it == g_rpc_whitelist.end()) return !g_rpc_whitelist_default;
+    return it->second.count(method) > 0;
+}
+
+/** End a streamed reply that failed part way: the status is already sent, so the client sees it cut short. */
+static bool StreamErrorEnd(HTTPRequest* req, const JSONRPCRequest& jreq, const std::string& error)
+{
+    LogPrintf("RPC method %s failed while streaming its result: %s\n", jreq.strMethod, error);
+    req->ChunkEnd();
+    return false;
+}
+
 static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
 {
     // JSONRPC handles only POST
@@ -220,6 +241,7 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             // 2.0 behavior is to catch exceptions and return HTTP success with
             // RPC errors, as long as there is not an actual HTTP server error.
             const bool catch_errors{jreq.m_json_version == JSONRPCVersion::V2};
+            jreq.allowStreaming = true;
             reply = JSONRPCExec(jreq, catch_errors);
 
             if (jreq.isLongPolling) {
@@ -227,6 +249,12 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 return true;
             }
 
+            if (jreq.isStreaming) {
+                if (!reply["error"].isNull()) return StreamErrorEnd(req, jreq, reply["error"].write());
+                jreq.StreamEnd();
+                return true;
+            }
+
             if (jreq.IsNotification()) {
                 // Even though we do execute notifications, we do not respond to them
                 req->WriteReply(HTTP_NO_CONTENT);
@@ -291,15 +319,93 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, reply.write() + "\n");
     } catch (UniValue& e) {
+        if (jreq.isStreaming) return StreamErrorEnd(req, jreq, e.write());
         JSONErrorReply(req, std::move(e), jreq);
         return false;
     } catch (const std::exception& e) {
+        if (jreq.isStreaming) return StreamErrorEnd(req, jreq, e.what());
         JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq);
         return false;
     }
     return true;
 }
 
+/** Work queue class of each RPC method that doesn't belong in the default queue */
+static std::map<std::string, HTTPWorkClass, std::less<>> g_rpc_method_classes{
+    {"getblocktemplate", HTTPWorkClass::MINING},
+    {"getmininginfo", HTTPWorkClass::MINING},
+    {"submitblock", HTTPWorkClass::MINING},
+    {"submitheader", HTTPWorkClass::MINING},
+
+    {"callcontract", HTTPWorkClass::HEAVY},
+    {"dumptxoutset", HTTPWorkClass::HEAVY},
+    {"eth_call", HTTPWorkClass::HEAVY},
+    {"eth_estimateGas", HTTPWorkClass::HEAVY},
+    {"eth_getLogs", HTTPWorkClass::HEAVY},
+    {"getaddressbalance", HTTPWorkClass::HEAVY},
+    {"getaddressdeltas", HTTPWorkClass::HEAVY},
+    {"getaddressmempool", HTTPWorkClass::HEAVY},
+    {"getaddresstxids", HTTPWorkClass::HEAVY},
+    {"getaddressutxos", HTTPWorkClass::HEAVY},
+    {"getblockhashes", HTTPWorkClass::HEAVY},
+    {"getblockstats", HTTPWorkClass::HEAVY},
+    {"getchaintxstats", HTTPWorkClass::HEAVY},
+    {"getdescriptoractivity", HTTPWorkClass::HEAVY},
+    {"getspentinfo", HTTPWorkClass::HEAVY},
+    {"getstorage", HTTPWorkClass::HEAVY},
+    {"gettxoutsetinfo", HTTPWorkClass::HEAVY},
+    {"listcontracts", HTTPWorkClass::HEAVY},
+    {"scanblocks", HTTPWorkClass::HEAVY},
+    {"scantxoutset", HTTPWorkClass::HEAVY},
+    {"searchlogs", HTTPWorkClass::HEAVY},
+    {"waitforlogs", HTTPWorkClass::HEAVY},
+};
+
+HTTPWorkClass ClassifyJSONRPCRequest(std::string_view body, HTTPWorkClass fallback)
+{
+    // A plain scan for "method" keys rather than a JSON parse, as this runs on
+    // the event loop thread. A misread only changes the queue a request waits in.
+    static constexpr std::string_view KEY{"\"method\""};
+    static constexpr std::string_view WHITESPACE{" \t\r\n"};
+    std::optional<HTTPWorkClass> result;
+    bool mixed{false};
+    bool heavy{false};
+    for (size_t pos = body.find(KEY); pos != std::string_view::npos; pos = body.find(KEY, pos)) {
+        pos += KEY.size();
+        size_t start = body.find_first_not_of(WHITESPACE, pos);
+        if (start == std::string_view::npos || body[start] != ':') continue;
+        start = body.find_first_not_of(WHITESPACE, start + 1);
+        if (start == std::string_view::npos || body[start] != '"') continue;
+        const size_t end = body.find('"', start + 1);
+        if (end == std::string_view::npos) break;
+        pos = end + 1;
+
+        const auto it{g_rpc_method_classes.find(body.substr(start + 1, end - start - 1))};
+        const HTTPWorkClass method_class{it == g_rpc_method_classes.end() ? fallback : it->second};
+        heavy |= method_class == HTTPWorkClass::HEAVY;
+        mixed |= result && *result != method_class;
+        result = method_class;
+    }
+    // A batch must not carry heavy calls into a lighter queue.
+    if (heavy) return HTTPWorkClass::HEAVY;
+    if (!result || mixed) return fallback;
+    return *result;
+}
+
+static bool InitRPCMethodClasses()
+{
+    for (const std::string& spec : gArgs.GetArgs("-rpcmethodclass")) {
+        const auto pos{spec.rfind(':')};
+        const auto work_class{pos == std::string::npos ? std::nullopt : HTTPWorkClassFromName(std::string_view{spec}.substr(pos + 1))};
+        if (!work_class || pos == 0) {
+            LogError("Invalid -rpcmethodclass=%s; must be <method>:<class> with class one of default, mining, wallet or heavy.", spec);
+            return false;
+        }
+        g_rpc_method_classes[spec.substr(0, pos)] = *work_class;
+    }
+    return true;
+}
+
 static bool InitRPCAuthentication()
 {
     if (gArgs.GetArg("-rpcpassword", "") == "")
@@ -375,11 +481,15 @@ bool StartHTTPRPC(const std::any& context)
     LogDebug(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
+    if (!InitRPCMethodClasses())
+        return false;
 
     auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    auto classify_rpc = [](HTTPRequest* req, const std::string&) { return ClassifyJSONRPCRequest(req->PeekBody(), HTTPWorkClass::DEFAULT); };
+    RegisterHTTPHandler("/", true, handle_rpc, classify_rpc);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        auto classify_wallet_rpc = [](HTTPRequest* req, const std::string&) { return ClassifyJSONRPCRequest(req->PeekBody(), HTTPWorkClass::WALLET); };
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, classify_wallet_rpc);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
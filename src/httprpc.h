@@ -5,7 +5,11 @@
 #ifndef BITCOIN_HTTPRPC_H
 #define BITCOIN_HTTPRPC_H
 
+#include <httpserver.h>
+
 #include <any>
+#include <string>
+#include <string_view>
 
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
@@ -19,6 +23,22 @@ void InterruptHTTPRPC();
  */
 void StopHTTPRPC();
 
+/** Check a Basic authorization header against the RPC credentials, for the
+ * other transports serving the RPC table.
+ * Precondition; HTTP RPC has been started.
+ */
+bool CheckRPCAuthorization(const std::string& auth_header, std::string& user_out);
+/** Whether -rpcwhitelist and -rpcwhitelistdefault let the user call the method.
+ */
+bool RPCMethodAllowed(const std::string& user, const std::string& method);
+
+/** Work queue class of a JSON-RPC request body: the class of its method, or of
+ * all methods of a batch. Methods without a class (see -rpcmethodclass), and
+ * batches that mix classes, get fallback, except that a batch holding any
+ * heavy method is heavy.
+ */
+HTTPWorkClass ClassifyJSONRPCRequest(std::string_view body, HTTPWorkClass fallback);
+
 /** Start HTTP REST subsystem.
  * Precondition; HTTP and RPC has been started.
  */
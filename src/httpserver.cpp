@@ -17,9 +17,12 @@
 #include <util/check.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <array>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
@@ -48,16 +51,28 @@ using common::InvalidPortErrMsg;
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+/** Ask the client to retry later, after a work queue turned its request away. */
+static void WriteRetryLater(HTTPRequest* req, std::string_view reason)
+{
+    req->WriteHeader("Retry-After", util::ToString(HTTP_RETRY_AFTER_SECONDS));
+    req->WriteReply(HTTP_SERVICE_UNAVAILABLE, reason);
+}
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
 public:
-    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func):
-        req(std::move(_req)), path(_path), func(_func)
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func, std::optional<SteadyClock::time_point> _deadline):
+        req(std::move(_req)), path(_path), func(_func), deadline(_deadline)
     {
     }
     void operator()() override
     {
+        if (deadline && SteadyClock::now() > *deadline) {
+            LogDebug(BCLog::HTTP, "HTTP request from %s rejected: queued past the work queue deadline\n", req->GetPeer().ToStringAddrPort());
+            WriteRetryLater(req.get(), "Work queue deadline exceeded");
+            return;
+        }
         func(req.get(), path);
     }
 
@@ -66,6 +81,7 @@ public:
 private:
     std::string path;
     HTTPRequestHandler func;
+    std::optional<SteadyClock::time_point> deadline;
 };
 
 /** Simple work queue for distributing work over multiple threads.
@@ -127,13 +143,14 @@ public:
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPWorkClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPWorkClassifier classifier;
 };
 
 /** HTTP module state */
@@ -144,8 +161,10 @@ static struct event_base* eventBase = nullptr;
 static struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static std::unique_ptr<WorkQueue<HTTPClosure>> g_work_queue{nullptr};
+//! Work queues for handling longer requests off the event loop thread, one per class
+static std::array<std::unique_ptr<WorkQueue<HTTPClosure>>, HTTP_WORK_CLASS_COUNT> g_work_queues;
+//! Limits of each work queue class
+static std::array<HTTPWorkClassLimits, HTTP_WORK_CLASS_COUNT> g_work_class_limits;
 //! Handlers for (sub)paths
 static GlobalMutex g_httppathhandlers_mutex;
 static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_mutex);
@@ -207,8 +226,7 @@ public:
 //! Track active requests
 static HTTPRequestTracker g_requests;
 
-/** Check if a network address is allowed to access the HTTP server */
-static bool ClientAllowed(const CNetAddr& netaddr)
+bool ClientAllowed(const CNetAddr& netaddr)
 {
     if (!netaddr.IsValid())
         return false;
@@ -326,13 +344,23 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(g_work_queue);
-        if (g_work_queue->Enqueue(item.get())) {
+        HTTPWorkClass work_class{i->classifier ? i->classifier(hreq.get(), path) : HTTPWorkClass::DEFAULT};
+        if (!g_work_queues[size_t(work_class)]) work_class = HTTPWorkClass::DEFAULT;
+        const HTTPWorkClassLimits& limits{g_work_class_limits[size_t(work_class)]};
+        std::optional<SteadyClock::time_point> deadline;
+        if (limits.deadline > 0ms) deadline = SteadyClock::now() + limits.deadline;
+
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler, deadline));
+        auto& queue{g_work_queues[size_t(work_class)]};
+        assert(queue);
+        if (queue->Enqueue(item.get())) {
             item.release(); /* if true, queue took ownership */
-        } else {
+        } else if (work_class == HTTPWorkClass::DEFAULT) {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
-            item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
+            WriteRetryLater(item->req.get(), "Work queue depth exceeded");
+        } else {
+            LogPrintf("WARNING: request rejected because %s http work queue depth exceeded, it can be increased with the -rpcworkclass= setting\n", HTTPWorkClassName(work_class));
+            WriteRetryLater(item->req.get(), "Work queue depth exceeded");
         }
     } else {
         hreq->WriteReply(HTTP_NOT_FOUND);
@@ -412,12 +440,95 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, HTTPWorkClass work_class, int worker_num)
 {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    if (work_class == HTTPWorkClass::DEFAULT) {
+        util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    } else {
+        util::ThreadRename(strprintf("http%s.%i", HTTPWorkClassName(work_class), worker_num));
+    }
     queue->Run();
 }
 
+std::string HTTPWorkClassName(HTTPWorkClass work_class)
+{
+    switch (work_class) {
+    case HTTPWorkClass::DEFAULT:
+        return "default";
+    case HTTPWorkClass::MINING:
+        return "mining";
+    case HTTPWorkClass::WALLET:
+        return "wallet";
+    case HTTPWorkClass::HEAVY:
+        return "heavy";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+std::optional<HTTPWorkClass> HTTPWorkClassFromName(std::string_view name)
+{
+    for (size_t i = 0; i < HTTP_WORK_CLASS_COUNT; ++i) {
+        if (name == HTTPWorkClassName(HTTPWorkClass(i))) return HTTPWorkClass(i);
+    }
+    return std::nullopt;
+}
+
+HTTPWorkClassLimits DefaultHTTPWorkClassLimits(HTTPWorkClass work_class)
+{
+    switch (work_class) {
+    case HTTPWorkClass::DEFAULT:
+        return {DEFAULT_HTTP_THREADS, DEFAULT_HTTP_WORKQUEUE, 0ms};
+    case HTTPWorkClass::MINING:
+        // Never drop queued mining requests: a late block is still worth submitting.
+        return {4, 32, 0ms};
+    case HTTPWorkClass::WALLET:
+        return {4, 64, 0ms};
+    case HTTPWorkClass::HEAVY:
+        // Shed scans that waited so long the client has likely given up.
+        return {4, 16, 30s};
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+std::optional<std::pair<HTTPWorkClass, HTTPWorkClassLimits>> ParseHTTPWorkClassLimits(std::string_view spec)
+{
+    const std::vector<std::string> parts{util::SplitString(spec, ':')};
+    if (parts.size() != 3 && parts.size() != 4) return std::nullopt;
+    const auto work_class{HTTPWorkClassFromName(parts[0])};
+    const auto threads{ToIntegral<int>(parts[1])};
+    const auto depth{ToIntegral<int>(parts[2])};
+    const auto deadline{parts.size() == 4 ? ToIntegral<int64_t>(parts[3]) : std::optional<int64_t>{0}};
+    if (!work_class || !threads || !depth || !deadline) return std::nullopt;
+    if (*threads < 0 || *deadline < 0) return std::nullopt;
+    // DEFAULT takes everything the other classes don't, so it always needs workers.
+    if (*threads == 0 && *work_class == HTTPWorkClass::DEFAULT) return std::nullopt;
+    if (*threads > 0 && *depth < 1) return std::nullopt;
+    return std::make_pair(*work_class, HTTPWorkClassLimits{*threads, *depth, std::chrono::milliseconds{*deadline}});
+}
+
+/** Initialize the limits of the work queue classes */
+static bool InitHTTPWorkClasses()
+{
+    for (size_t i = 0; i < HTTP_WORK_CLASS_COUNT; ++i) {
+        g_work_class_limits[i] = DefaultHTTPWorkClassLimits(HTTPWorkClass(i));
+    }
+    HTTPWorkClassLimits& default_limits{g_work_class_limits[size_t(HTTPWorkClass::DEFAULT)]};
+    default_limits.threads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    default_limits.depth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
+
+    for (const std::string& spec : gArgs.GetArgs("-rpcworkclass")) {
+        const auto parsed{ParseHTTPWorkClassLimits(spec)};
+        if (!parsed) {
+            uiInterface.ThreadSafeMessageBox(
+                Untranslated(strprintf("Invalid -rpcworkclass specification: %s. Valid is <class>:<threads>:<depth>[:<deadline ms>] with class one of default, mining, wallet or heavy.", spec)),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        g_work_class_limits[size_t(parsed->first)] = parsed->second;
+    }
+    return true;
+}
+
 /** libevent event log callback */
 static void libevent_log_cb(int severity, const char *msg)
 {
@@ -443,6 +554,8 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
 {
     if (!InitHTTPAllowList())
         return false;
+    if (!InitHTTPWorkClasses())
+        return false;
 
     // Redirect libevent's logging to our own log
     event_set_log_callback(&libevent_log_cb);
@@ -476,10 +589,12 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
     }
 
     LogDebug(BCLog::HTTP, "Initialized HTTP server\n");
-    int workQueueDepth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
-
-    g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    for (size_t i = 0; i < HTTP_WORK_CLASS_COUNT; ++i) {
+        const HTTPWorkClassLimits& limits{g_work_class_limits[i]};
+        if (limits.threads == 0) continue;
+        LogDebug(BCLog::HTTP, "creating %s work queue of depth %d\n", HTTPWorkClassName(HTTPWorkClass(i)), limits.depth);
+        g_work_queues[i] = std::make_unique<WorkQueue<HTTPClosure>>(limits.depth);
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -499,12 +614,18 @@ static std::vector<std::thread> g_thread_http_workers;
 
 void StartHTTPServer()
 {
-    int rpcThreads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogInfo("Starting HTTP server with %d worker threads\n", rpcThreads);
+    LogInfo("Starting HTTP server with %d worker threads\n", g_work_class_limits[size_t(HTTPWorkClass::DEFAULT)].threads);
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
+    for (size_t c = 0; c < HTTP_WORK_CLASS_COUNT; ++c) {
+        if (!g_work_queues[c]) continue;
+        const HTTPWorkClass work_class{HTTPWorkClass(c)};
+        if (work_class != HTTPWorkClass::DEFAULT) {
+            LogInfo("Starting %d HTTP worker threads for %s requests\n", g_work_class_limits[c].threads, HTTPWorkClassName(work_class));
+        }
+        for (int i = 0; i < g_work_class_limits[c].threads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queues[c].get(), work_class, i);
+        }
     }
 }
 
@@ -515,15 +636,15 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (g_work_queue) {
-        g_work_queue->Interrupt();
+    for (auto& queue : g_work_queues) {
+        if (queue) queue->Interrupt();
     }
 }
 
 void StopHTTPServer()
 {
     LogDebug(BCLog::HTTP, "Stopping HTTP server\n");
-    if (g_work_queue) {
+    if (!g_thread_http_workers.empty()) {
         LogDebug(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
         for (auto& thread : g_thread_http_workers) {
             thread.join();
@@ -557,7 +678,9 @@ void StopHTTPServer()
         event_base_free(eventBase);
         eventBase = nullptr;
     }
-    g_work_queue.reset();
+    for (auto& queue : g_work_queues) {
+        queue.reset();
+    }
     LogDebug(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
@@ -701,6 +824,19 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string_view HTTPRequest::PeekBody()
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return {};
+    size_t size = evbuffer_get_length(buf);
+    // Linearizes the buffer in place, so a later ReadBody() doesn't copy again.
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return {};
+    return {data, size};
+}
+
 bool HTTPRequest::ReplySent() {
     return replySent;
 }
@@ -747,14 +883,44 @@ void HTTPRequest::Chunk(const std::string& chunk) {
 
 
     if (chunk.size() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            chunkBytesQueued += chunk.size();
+        }
         auto databuf = evbuffer_new(); // HTTPEvent will free this buffer
         evbuffer_add(databuf, chunk.data(), chunk.size());
-        HTTPEvent* ev = new HTTPEvent(eventBase, true, databuf,
-                std::bind(evhttp_send_reply_chunk, req, databuf));
+        const size_t size = chunk.size();
+        auto req_copy = req;
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, databuf, [this, req_copy, databuf, size]() {
+            {
+                std::lock_guard<std::mutex> lock(cs);
+                chunkBytesAdded += size;
+            }
+            // The callback runs once the connection's output buffer has drained,
+            // that is once everything added so far has been written out.
+            evhttp_send_reply_chunk_with_cb(req_copy, databuf, [](evhttp_connection*, void* arg) {
+                static_cast<HTTPRequest*>(arg)->chunksSent();
+            }, this);
+        });
         ev->trigger(0);
     }
 }
 
+void HTTPRequest::chunksSent() {
+    std::lock_guard<std::mutex> lock(cs);
+    chunkBytesSent = chunkBytesAdded;
+    closeCv.notify_all();
+}
+
+bool HTTPRequest::ChunkWait(size_t maxPending) {
+    std::unique_lock<std::mutex> lock(cs);
+    while (!connClosed && chunkBytesQueued - chunkBytesSent > maxPending) {
+        if (!IsRPCRunning()) return false;
+        closeCv.wait_for(lock, std::chrono::milliseconds(500));
+    }
+    return !connClosed;
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -865,11 +1031,11 @@ std::optional<std::string> GetQueryParameterFromUri(const char* uri, const std::
     return result;
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPWorkClassifier& classifier)
 {
     LogDebug(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
     LOCK(g_httppathhandlers_mutex);
-    pathHandlers.emplace_back(prefix, exactMatch, handler);
+    pathHandlers.emplace_back(prefix, exactMatch, handler, classifier);
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -5,10 +5,13 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <condition_variable>
 
@@ -29,8 +32,42 @@ static const int DEFAULT_HTTP_WORKQUEUE=64;
 
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
+/** Seconds a client is asked to wait (Retry-After) when a work queue rejects its request. */
+static const int HTTP_RETRY_AFTER_SECONDS=1;
+
+/**
+ * Work queue classes. Each class has its own worker threads, queue depth and
+ * deadline, so a flood of slow requests in one class (e.g. log searches from
+ * an explorer) cannot delay requests in another (e.g. block submission).
+ */
+enum class HTTPWorkClass : uint8_t {
+    DEFAULT, //!< Anything not classified otherwise, sized by -rpcthreads/-rpcworkqueue
+    MINING,  //!< Block templates and block submission
+    WALLET,  //!< Requests to wallet endpoints
+    HEAVY,   //!< Index scans, log searches and contract calls
+};
+static constexpr size_t HTTP_WORK_CLASS_COUNT{4};
+
+/** Limits of one work queue class. A class with no threads is served by DEFAULT. */
+struct HTTPWorkClassLimits {
+    int threads;
+    int depth;
+    //! Requests still queued after this long are rejected; zero means no deadline
+    std::chrono::milliseconds deadline;
+};
+
+/** Lower case name of a work queue class, as used by -rpcworkclass and -rpcmethodclass. */
+std::string HTTPWorkClassName(HTTPWorkClass work_class);
+/** Work queue class for a name, or std::nullopt if unknown. */
+std::optional<HTTPWorkClass> HTTPWorkClassFromName(std::string_view name);
+/** Built-in limits of a class. DEFAULT is overridden by -rpcthreads and -rpcworkqueue. */
+HTTPWorkClassLimits DefaultHTTPWorkClassLimits(HTTPWorkClass work_class);
+/** Parse a -rpcworkclass=<class>:<threads>:<depth>[:<deadline ms>] value, or std::nullopt if invalid. */
+std::optional<std::pair<HTTPWorkClass, HTTPWorkClassLimits>> ParseHTTPWorkClassLimits(std::string_view spec);
+
 struct evhttp_request;
 struct event_base;
+class CNetAddr;
 class CService;
 class HTTPRequest;
 
@@ -48,16 +85,24 @@ void InterruptHTTPServer();
 /** Stop HTTP server */
 void StopHTTPServer();
 
+/** Check if a network address is allowed by -rpcallowip to access the HTTP
+ * server, or the other RPC transports.
+ */
+bool ClientAllowed(const CNetAddr& netaddr);
+
 /** Change logging level for libevent. */
 void UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Picks the work queue class of a request. Runs on the event loop thread, so it must be cheap. */
+typedef std::function<HTTPWorkClass(HTTPRequest* req, const std::string &)> HTTPWorkClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are queued in the class chosen by classifier, or
+ * in the DEFAULT class if there is none.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPWorkClassifier& classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -81,8 +126,14 @@ private:
     std::mutex cs;
     std::condition_variable closeCv;
 
+    //! Chunk bytes handed to Chunk(), to the connection, and written out to the client
+    size_t chunkBytesQueued = 0;
+    size_t chunkBytesAdded = 0;
+    size_t chunkBytesSent = 0;
+
     void startDetectClientClose();
     void waitClientClose();
+    void chunksSent();
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
@@ -137,6 +188,12 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * View the request body without consuming it. The view is valid until
+     * ReadBody is called or the request is replied to.
+     */
+    std::string_view PeekBody();
+
     /**
      * Write output header.
      *
@@ -163,6 +220,14 @@ public:
      */
     void Chunk(const std::string& chunk);
 
+    /**
+     * Wait until at most maxPending bytes of earlier chunks are still to be
+     * written to the client, so a slow client can't make a large chunked reply
+     * pile up in memory.
+     * Returns false if the client closed the connection or RPC is stopping.
+     */
+    bool ChunkWait(size_t maxPending);
+
     /**
 	 * End chunk transfer.
 	 */
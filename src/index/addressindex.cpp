@@ -0,0 +1,414 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <addresstype.h>
+#include <chain.h>
+#include <coins.h>
+#include <common/args.h>
+#include <interfaces/chain.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <undo.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+constexpr uint8_t DB_ADDRESSINDEX{'a'};
+constexpr uint8_t DB_ADDRESSUNSPENTINDEX{'u'};
+constexpr uint8_t DB_ADDRESSBALANCEINDEX{'A'};
+constexpr uint8_t DB_SPENTINDEX{'p'};
+constexpr uint8_t DB_TIMESTAMPINDEX{'S'};
+constexpr uint8_t DB_BLOCKHASHINDEX{'z'};
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+/** Access to the address index database (indexes/addressindex/) */
+class AddressIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+AddressIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe)
+{}
+
+AddressIndex::AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "addressindex"), m_db(std::make_unique<AddressIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+AddressIndex::~AddressIndex() = default;
+
+namespace {
+/** Address index records of one block */
+struct BlockRecords {
+    std::vector<std::pair<CAddressIndexKey, CAmount>> deltas;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent;
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue>> spent;
+};
+} // namespace
+
+//! Index type and hash of the address paid by a script, false if it has none
+static bool GetIndexedAddress(const COutPoint& outpoint, const CScript& script, int& type, uint256& hash)
+{
+    CTxDestination dest;
+    if (!ExtractDestination(outpoint, script, dest)) return false;
+    valtype bytesID(std::visit(DataVisitor(), dest));
+    if (bytesID.empty()) return false;
+    valtype addressBytes(32);
+    std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
+    type = GetAddressIndexType(dest);
+    hash = uint256(addressBytes);
+    return true;
+}
+
+/**
+ * Collect the records of a block. Connecting adds its outputs to the unspent
+ * records and removes the outputs it spends; disconnecting walks the
+ * transactions last to first and does the opposite, so that an output
+ * created and spent in the same block ends up absent either way.
+ */
+static bool CollectBlockRecords(const CBlock& block, const CBlockUndo& block_undo, int height, bool connect, BlockRecords& records)
+{
+    if (block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+        LogError("%s: block %s and its undo data are inconsistent\n", __func__, block.GetHash().ToString());
+        return false;
+    }
+
+    for (size_t n = 0; n < block.vtx.size(); ++n) {
+        const size_t i = connect ? n : block.vtx.size() - 1 - n;
+        const CTransaction& tx = *block.vtx[i];
+        const auto& txid = tx.GetHash();
+        int type;
+        uint256 hash;
+
+        for (unsigned int k = 0; k < tx.vout.size(); ++k) {
+            const CTxOut& out = tx.vout[k];
+            if (!GetIndexedAddress({txid, k}, out.scriptPubKey, type, hash)) continue;
+            records.deltas.emplace_back(CAddressIndexKey(type, hash, height, i, txid, k, false), out.nValue);
+            records.unspent.emplace_back(CAddressUnspentKey(type, hash, txid, k),
+                                         connect ? CAddressUnspentValue(out.nValue, out.scriptPubKey, height, tx.IsCoinStake()) : CAddressUnspentValue());
+        }
+
+        if (i == 0) continue;
+        const CTxUndo& tx_undo = block_undo.vtxundo[i - 1];
+        if (tx_undo.vprevout.size() != tx.vin.size()) {
+            LogError("%s: transaction %s and its undo data are inconsistent\n", __func__, txid.ToString());
+            return false;
+        }
+        for (unsigned int j = 0; j < tx.vin.size(); ++j) {
+            const COutPoint& prevout = tx.vin[j].prevout;
+            const Coin& coin = tx_undo.vprevout[j];
+            if (!GetIndexedAddress(prevout, coin.out.scriptPubKey, type, hash)) continue;
+            records.deltas.emplace_back(CAddressIndexKey(type, hash, height, i, txid, j, true), -coin.out.nValue);
+            records.unspent.emplace_back(CAddressUnspentKey(type, hash, prevout.hash, prevout.n),
+                                         connect ? CAddressUnspentValue() : CAddressUnspentValue(coin.out.nValue, coin.out.scriptPubKey, coin.nHeight, coin.fCoinStake));
+            records.spent.emplace_back(CSpentIndexKey(prevout.hash, prevout.n),
+                                       connect ? CSpentIndexValue(txid, j, height, coin.out.nValue, type, hash) : CSpentIndexValue());
+        }
+    }
+    return true;
+}
+
+/** Sum the address index entries of a block per address */
+static std::map<std::pair<uint8_t, uint256>, CAddressBalanceValue> GetAddressBalanceDeltas(const std::vector<std::pair<CAddressIndexKey, CAmount>>& vect)
+{
+    std::map<std::pair<uint8_t, uint256>, CAddressBalanceValue> deltas;
+    for (const auto& [key, amount] : vect) {
+        CAddressBalanceValue& delta = deltas[{key.type, key.hashBytes}];
+        delta.balance += amount;
+        if (amount > 0) delta.received += amount;
+    }
+    return deltas;
+}
+
+static void WriteRecords(CDBBatch& batch, const BlockRecords& records, bool connect)
+{
+    for (const auto& [key, amount] : records.deltas) {
+        if (connect) {
+            batch.Write(std::make_pair(DB_ADDRESSINDEX, key), amount);
+        } else {
+            batch.Erase(std::make_pair(DB_ADDRESSINDEX, key));
+        }
+    }
+    for (const auto& [key, value] : records.unspent) {
+        if (value.IsNull()) {
+            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, key));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, key), value);
+        }
+    }
+    for (const auto& [key, value] : records.spent) {
+        if (value.IsNull()) {
+            batch.Erase(std::make_pair(DB_SPENTINDEX, key));
+        } else {
+            batch.Write(std::make_pair(DB_SPENTINDEX, key), value);
+        }
+    }
+}
+
+bool AddressIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    // The genesis block's outputs are not spendable
+    if (block.height == 0) return true;
+
+    assert(block.data);
+    CBlockUndo block_undo;
+    const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+    if (!m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
+        return false;
+    }
+
+    BlockRecords records;
+    if (!CollectBlockRecords(*block.data, block_undo, block.height, /*connect=*/true, records)) {
+        return false;
+    }
+
+    CDBBatch batch(*m_db);
+    WriteRecords(batch, records, /*connect=*/true);
+
+    for (const auto& [address, delta] : GetAddressBalanceDeltas(records.deltas)) {
+        CAddressBalanceValue value;
+        if (!ReadAddressBalance(address.second, address.first, block.height - 1, value)) {
+            return false;
+        }
+        value.balance += delta.balance;
+        value.received += delta.received;
+        batch.Write(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressBalanceKey(address.first, address.second, block.height)), value);
+    }
+
+    // Logical timestamps strictly increase along the chain
+    unsigned int logical_ts = block.data->nTime;
+    CTimestampBlockIndexValue prev_ts;
+    if (block.prev_hash && m_db->Read(std::make_pair(DB_BLOCKHASHINDEX, *block.prev_hash), prev_ts) && logical_ts <= prev_ts.ltimestamp) {
+        logical_ts = prev_ts.ltimestamp + 1;
+        LogDebug(BCLog::INDEX, "%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, block.data->nTime, prev_ts.ltimestamp, logical_ts);
+    }
+    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexKey(logical_ts, block.height, block.hash)), /*active=*/true);
+    batch.Write(std::make_pair(DB_BLOCKHASHINDEX, CTimestampBlockIndexKey(block.hash)), CTimestampBlockIndexValue(logical_ts));
+
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::CustomRewind(const interfaces::BlockRef& current_tip, const interfaces::BlockRef& new_tip)
+{
+    LOCK(cs_main);
+    const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+    const CBlockIndex* new_tip_index{m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash)};
+
+    // Timestamp records are kept but flagged as no longer in the active chain
+    do {
+        CBlock block;
+        CBlockUndo block_undo;
+        if (!m_chainstate->m_blockman.ReadBlock(block, *iter_tip) ||
+            !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *iter_tip)) {
+            LogError("%s: Failed to read block %s from disk\n", __func__, iter_tip->GetBlockHash().ToString());
+            return false;
+        }
+
+        BlockRecords records;
+        if (!CollectBlockRecords(block, block_undo, iter_tip->nHeight, /*connect=*/false, records)) {
+            return false;
+        }
+
+        CDBBatch batch(*m_db);
+        WriteRecords(batch, records, /*connect=*/false);
+        for (const auto& [address, delta] : GetAddressBalanceDeltas(records.deltas)) {
+            batch.Erase(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressBalanceKey(address.first, address.second, iter_tip->nHeight)));
+        }
+        CTimestampBlockIndexValue logical_ts;
+        if (m_db->Read(std::make_pair(DB_BLOCKHASHINDEX, iter_tip->GetBlockHash()), logical_ts)) {
+            batch.Write(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexKey(logical_ts.ltimestamp, iter_tip->nHeight, iter_tip->GetBlockHash())), /*active=*/false);
+        }
+        if (!m_db->WriteBatch(batch)) return false;
+
+        iter_tip = iter_tip->GetAncestor(iter_tip->nHeight - 1);
+    } while (new_tip_index != iter_tip);
+
+    return true;
+}
+
+BaseIndex::DB& AddressIndex::GetDB() const { return *m_db; }
+
+bool AddressIndex::ReadAddressIndex(const uint256& address_hash, int type, std::vector<std::pair<CAddressIndexKey, CAmount>>& entries,
+                                    int start, int end) const
+{
+    bool more;
+    return ReadAddressIndexPage(address_hash, type, start, end, nullptr, 0, false, entries, more);
+}
+
+static bool SameAddressIndexKey(const CAddressIndexKey& a, const CAddressIndexKey& b)
+{
+    return a.type == b.type && a.hashBytes == b.hashBytes && a.blockHeight == b.blockHeight &&
+           a.txindex == b.txindex && a.txhash == b.txhash && a.index == b.index && a.spending == b.spending;
+}
+
+bool AddressIndex::ReadAddressIndexPage(const uint256& address_hash, int type, int start, int end, const CAddressIndexKey* after,
+                                        size_t limit, bool reverse, std::vector<std::pair<CAddressIndexKey, CAmount>>& entries,
+                                        bool& more) const
+{
+    more = false;
+    const bool bounded = start > 0 && end > 0;
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+
+    if (!reverse) {
+        if (after) {
+            // Resume on the continuation key, or past it if a reorg erased it
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, *after));
+            std::pair<uint8_t, CAddressIndexKey> key;
+            if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && SameAddressIndexKey(key.second, *after)) {
+                pcursor->Next();
+            }
+        } else if (bounded) {
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, address_hash, start)));
+        } else {
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, address_hash)));
+        }
+    } else {
+        // Land on the first key past the range, then step back onto its last entry
+        if (after) {
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, *after));
+        } else {
+            const int past_end = bounded ? end + 1 : std::numeric_limits<int>::max();
+            pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, address_hash, past_end)));
+        }
+        if (pcursor->Valid()) {
+            pcursor->Prev();
+        } else {
+            pcursor->SeekToLast();
+        }
+    }
+
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX || key.second.type != type || key.second.hashBytes != address_hash) {
+            break;
+        }
+        if (bounded && (key.second.blockHeight > end || key.second.blockHeight < start)) {
+            break;
+        }
+        if (limit > 0 && entries.size() >= limit) {
+            more = true;
+            break;
+        }
+        CAmount value;
+        if (!pcursor->GetValue(value)) {
+            LogError("failed to get address index value");
+            return false;
+        }
+        entries.emplace_back(key.second, value);
+        if (reverse) {
+            pcursor->Prev();
+        } else {
+            pcursor->Next();
+        }
+    }
+
+    return true;
+}
+
+bool AddressIndex::ReadAddressUnspentIndex(const uint256& address_hash, int type,
+                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& outputs) const
+{
+    bool more;
+    return ReadAddressUnspentIndexPage(address_hash, type, nullptr, 0, outputs, more);
+}
+
+bool AddressIndex::ReadAddressUnspentIndexPage(const uint256& address_hash, int type, const CAddressUnspentKey* after, size_t limit,
+                                               std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& outputs, bool& more) const
+{
+    more = false;
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    if (after) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, *after));
+        std::pair<uint8_t, CAddressUnspentKey> key;
+        if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX &&
+            key.second.type == after->type && key.second.hashBytes == after->hashBytes &&
+            key.second.txhash == after->txhash && key.second.index == after->index) {
+            pcursor->Next();
+        }
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, address_hash)));
+    }
+
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CAddressUnspentKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSUNSPENTINDEX || key.second.type != type || key.second.hashBytes != address_hash) {
+            break;
+        }
+        if (limit > 0 && outputs.size() >= limit) {
+            more = true;
+            break;
+        }
+        CAddressUnspentValue value;
+        if (!pcursor->GetValue(value)) {
+            LogError("failed to get address unspent value");
+            return false;
+        }
+        outputs.emplace_back(key.second, value);
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+bool AddressIndex::ReadAddressBalance(const uint256& address_hash, int type, int height, CAddressBalanceValue& value) const
+{
+    value.SetNull();
+
+    // The first record at or past the inverted height is the latest one at or below it
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSBALANCEINDEX, CAddressBalanceKey(type, address_hash, height)));
+    if (!pcursor->Valid()) {
+        return true;
+    }
+
+    std::pair<uint8_t, CAddressBalanceKey> key;
+    if (!pcursor->GetKey(key) || key.first != DB_ADDRESSBALANCEINDEX || key.second.type != type || key.second.hashBytes != address_hash) {
+        // The address had no balance yet
+        return true;
+    }
+    if (!pcursor->GetValue(value)) {
+        LogError("failed to get address balance value");
+        return false;
+    }
+    return true;
+}
+
+bool AddressIndex::ReadSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const
+{
+    return m_db->Read(std::make_pair(DB_SPENTINDEX, key), value);
+}
+
+bool AddressIndex::ReadTimestampIndex(unsigned int high, unsigned int low, bool active_only,
+                                      std::vector<std::pair<uint256, unsigned int>>& hashes) const
+{
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, CTimestampIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_TIMESTAMPINDEX || key.second.timestamp >= high) {
+            break;
+        }
+        if (active_only) {
+            bool active{false};
+            if (!pcursor->GetValue(active)) {
+                LogError("%s: failed to read timestamp index value\n", __func__);
+                return false;
+            }
+            if (!active) continue;
+        }
+        hashes.emplace_back(key.second.blockHash, key.second.timestamp);
+    }
+
+    return true;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_INDEX_ADDRESSINDEX_H
+#define WATTX_INDEX_ADDRESSINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+struct CAddressBalanceValue;
+struct CAddressIndexKey;
+struct CAddressUnspentKey;
+struct CAddressUnspentValue;
+struct CSpentIndexKey;
+struct CSpentIndexValue;
+
+static constexpr bool DEFAULT_ADDRINDEX{false};
+
+/**
+ * AddressIndex keeps the block explorer records of -addrindex: the balance
+ * changes, unspent outputs and balance history of every address, which
+ * transaction input spent an output, and the blocks by logical timestamp.
+ *
+ * The records are built from the blocks and their undo data by the index's
+ * own sync thread, so the index can be switched on without a reindex and
+ * block connection does not wait for it. Queries reflect the chain up to the
+ * index's best block.
+ */
+class AddressIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return false; }
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRewind(const interfaces::BlockRef& current_tip, const interfaces::BlockRef& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// Balance changes of an address, optionally within [start, end] heights.
+    bool ReadAddressIndex(const uint256& address_hash, int type, std::vector<std::pair<CAddressIndexKey, CAmount>>& entries,
+                          int start = 0, int end = 0) const;
+
+    /**
+     * Read at most @p limit (0 for no limit) balance changes of an address
+     * within the optional [start, end] height bounds, resuming strictly after
+     * @p after when given. @p reverse walks from the newest entry backwards.
+     * @p more is set when entries remain past the returned page; the last
+     * returned key is the continuation for the next call.
+     */
+    bool ReadAddressIndexPage(const uint256& address_hash, int type, int start, int end, const CAddressIndexKey* after,
+                              size_t limit, bool reverse, std::vector<std::pair<CAddressIndexKey, CAmount>>& entries,
+                              bool& more) const;
+
+    /// Unspent outputs of an address.
+    bool ReadAddressUnspentIndex(const uint256& address_hash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& outputs) const;
+
+    /// Page through the unspent outputs of an address in index order, see ReadAddressIndexPage.
+    bool ReadAddressUnspentIndexPage(const uint256& address_hash, int type, const CAddressUnspentKey* after, size_t limit,
+                                     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>& outputs, bool& more) const;
+
+    /// Balance of an address as of a block height, zero if it had none yet.
+    bool ReadAddressBalance(const uint256& address_hash, int type, int height, CAddressBalanceValue& value) const;
+
+    /// Input that spent an output, false if it is unspent or unknown.
+    bool ReadSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const;
+
+    /**
+     * Blocks with a logical timestamp in [low, high), ordered by timestamp then
+     * height. With @p active_only, blocks flagged as stale by a rewind are
+     * skipped as part of the scan.
+     */
+    bool ReadTimestampIndex(unsigned int high, unsigned int low, bool active_only,
+                            std::vector<std::pair<uint256, unsigned int>>& hashes) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // WATTX_INDEX_ADDRESSINDEX_H
@@ -0,0 +1,119 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/anchorindex.h>
+
+#include <anchor/anchor_aggregator.h>
+#include <anchor/evm_anchor.h>
+#include <anchor/private_swap.h>
+#include <auxpow/auxpow.h>
+#include <common/args.h>
+#include <interfaces/chain.h>
+#include <primitives/block.h>
+#include <script/script.h>
+
+constexpr uint8_t DB_EVM_ANCHOR{'a'};
+constexpr uint8_t DB_EVM_ANCHOR_HEIGHT{'h'};
+constexpr uint8_t DB_SWAP_ANCHOR{'s'};
+constexpr uint8_t DB_AGGREGATE_ANCHOR{'r'};
+
+std::unique_ptr<AnchorIndex> g_anchorindex;
+
+/** Access to the anchor index database (indexes/anchorindex/) */
+class AnchorIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+AnchorIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "anchorindex", n_cache_size, f_memory, f_wipe)
+{}
+
+AnchorIndex::AnchorIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "anchorindex"), m_db(std::make_unique<AnchorIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+AnchorIndex::~AnchorIndex() = default;
+
+/** Add the anchor tags found in @p data to the batch */
+static void IndexAnchorTags(CDBBatch& batch, const std::vector<uint8_t>& data, AnchorLocation location)
+{
+    for (auto& payload : evm_anchor::FindAnchorTags(data, evm_anchor::ANCHOR_TAG)) {
+        evm_anchor::EVMAnchorData anchor;
+        if (!anchor.Deserialize(payload)) continue;
+        location.payload = std::move(payload);
+        batch.Write(std::make_pair(DB_EVM_ANCHOR, anchor.GetHash()), location);
+        batch.Write(std::make_pair(DB_EVM_ANCHOR_HEIGHT, anchor.wattx_block_height), anchor.GetHash());
+    }
+    for (auto& payload : evm_anchor::FindAnchorTags(data, evm_anchor::AGGREGATE_ANCHOR_TAG)) {
+        evm_anchor::AggregateAnchor aggregate;
+        if (!aggregate.Deserialize(payload)) continue;
+        location.payload = std::move(payload);
+        batch.Write(std::make_pair(DB_AGGREGATE_ANCHOR, aggregate.root), location);
+    }
+    for (auto& payload : evm_anchor::FindAnchorTags(data, private_swap::PRIVATE_SWAP_TAG)) {
+        private_swap::EncryptedSwapAnchor anchor;
+        if (!private_swap::EncryptedSwapAnchor::Deserialize(payload, anchor)) continue;
+        location.payload = std::move(payload);
+        batch.Write(std::make_pair(DB_SWAP_ANCHOR, uint256{anchor.swap_key_tag}), location);
+    }
+}
+
+static void IndexTransaction(CDBBatch& batch, const CTransaction& tx, bool auxpow_coinbase, AnchorLocation location)
+{
+    location.txid = tx.GetHash();
+    // The parent chain's merge mining data is in its coinbase input
+    if (auxpow_coinbase && !tx.vin.empty()) {
+        location.vout = -1;
+        IndexAnchorTags(batch, {tx.vin[0].scriptSig.begin(), tx.vin[0].scriptSig.end()}, location);
+    }
+    for (size_t i = 0; i < tx.vout.size(); ++i) {
+        const CScript& script = tx.vout[i].scriptPubKey;
+        if (script.empty() || script[0] != OP_RETURN) continue;
+        location.vout = i;
+        IndexAnchorTags(batch, {script.begin(), script.end()}, location);
+    }
+}
+
+bool AnchorIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    assert(block.data);
+    AnchorLocation location;
+    location.block_hash = block.hash;
+    location.height = block.height;
+
+    CDBBatch batch(*m_db);
+    if (block.data->HasAuxPow()) {
+        IndexTransaction(batch, block.data->auxpow->GetCoinbaseTx(), /*auxpow_coinbase=*/true, location);
+    }
+    for (const auto& tx : block.data->vtx) {
+        IndexTransaction(batch, *tx, /*auxpow_coinbase=*/false, location);
+    }
+    return m_db->WriteBatch(batch);
+}
+
+BaseIndex::DB& AnchorIndex::GetDB() const { return *m_db; }
+
+bool AnchorIndex::FindEVMAnchor(const uint256& anchor_hash, AnchorLocation& location) const
+{
+    return m_db->Read(std::make_pair(DB_EVM_ANCHOR, anchor_hash), location);
+}
+
+bool AnchorIndex::FindEVMAnchorByHeight(uint32_t anchored_height, AnchorLocation& location) const
+{
+    uint256 anchor_hash;
+    return m_db->Read(std::make_pair(DB_EVM_ANCHOR_HEIGHT, anchored_height), anchor_hash) &&
+           FindEVMAnchor(anchor_hash, location);
+}
+
+bool AnchorIndex::FindSwapAnchor(const uint256& swap_key_tag, AnchorLocation& location) const
+{
+    return m_db->Read(std::make_pair(DB_SWAP_ANCHOR, swap_key_tag), location);
+}
+
+bool AnchorIndex::FindAggregateAnchor(const uint256& root, AnchorLocation& location) const
+{
+    return m_db->Read(std::make_pair(DB_AGGREGATE_ANCHOR, root), location);
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_INDEX_ANCHORINDEX_H
+#define WATTX_INDEX_ANCHORINDEX_H
+
+#include <index/base.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <vector>
+
+static constexpr bool DEFAULT_ANCHORINDEX{false};
+
+/**
+ * Where an anchor tag was found on chain, with the tag itself
+ */
+struct AnchorLocation {
+    uint256 block_hash;
+    int height{0};
+    //! Transaction carrying the tag, the parent coinbase for a tag in the auxpow
+    uint256 txid;
+    //! Output carrying the tag, -1 for the coinbase input
+    int32_t vout{-1};
+    //! Payload of the tag, after its subtag
+    std::vector<uint8_t> payload;
+
+    SERIALIZE_METHODS(AnchorLocation, obj) { READWRITE(obj.block_hash, obj.height, obj.txid, obj.vout, obj.payload); }
+};
+
+/**
+ * AnchorIndex finds the EVM anchors and private swap anchors carried by
+ * the chain without scanning blocks.
+ *
+ * The coinbase of a merged-mined block's auxpow and the OP_RETURN outputs of
+ * the block's transactions are searched for anchor tags. EVM anchors are
+ * indexed by anchor hash and by the WATTx height they anchor, aggregate
+ * anchors by their merkle root, swap anchors by their swap key tag, which
+ * holders of the view key derive from the swap id. Entries of blocks disconnected in a reorg are left in place; the
+ * block hash of a location tells whether it is still in the active chain.
+ */
+class AnchorIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AnchorIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AnchorIndex() override;
+
+    /// Look up an EVM anchor by its hash (EVMAnchorData::GetHash()).
+    bool FindEVMAnchor(const uint256& anchor_hash, AnchorLocation& location) const;
+
+    /// Look up the last EVM anchor indexed for a WATTx height.
+    bool FindEVMAnchorByHeight(uint32_t anchored_height, AnchorLocation& location) const;
+
+    /// Look up an aggregate anchor by its merkle root (AggregateAnchor::root).
+    bool FindAggregateAnchor(const uint256& root, AnchorLocation& location) const;
+
+    /// Look up a private swap anchor by its swap key tag (EncryptedSwapAnchor::DeriveSwapKeyTag()).
+    bool FindSwapAnchor(const uint256& swap_key_tag, AnchorLocation& location) const;
+};
+
+/// The global anchor index. May be null.
+extern std::unique_ptr<AnchorIndex> g_anchorindex;
+
+#endif // WATTX_INDEX_ANCHORINDEX_H
@@ -12,6 +12,7 @@
 #include <logging.h>
 #include <node/blockstorage.h>
 #include <undo.h>
+#include <util/convert.h>
 #include <util/fs_helpers.h>
 #include <validation.h>
 
@@ -248,20 +249,54 @@ std::optional<uint256> BlockFilterIndex::ReadFilterHeader(int height, const uint
     return read_out.second.header;
 }
 
-bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+/** Contract addresses and log topics of the EVM logs emitted by a block, from its stored receipts */
+static bool EVMLogFilterElements(const CBlock& block, GCSFilter::ElementSet& elements)
 {
-    CBlockUndo block_undo;
+    if (!pstorageresult) {
+        LogError("%s: transaction receipts are not available\n", __func__);
+        return false;
+    }
 
-    if (block.height > 0) {
-        // pindex variable gives indexing code access to node internals. It
-        // will be removed in upcoming commit
-        const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
-        if (!m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
-            return false;
+    const uint256 block_hash{block.GetHash()};
+    for (const CTransactionRef& tx : block.vtx) {
+        if (!tx->HasCreateOrCall()) continue;
+        for (const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))) {
+            // The transaction may also be in a block that left the active chain
+            if (receipt.blockHash != block_hash) continue;
+            for (const dev::eth::LogEntry& log : receipt.logs) {
+                elements.emplace(log.address.begin(), log.address.end());
+                for (const dev::h256& topic : log.topics) {
+                    elements.emplace(topic.begin(), topic.end());
+                }
+            }
         }
     }
+    return true;
+}
 
-    BlockFilter filter(m_filter_type, *Assert(block.data), block_undo);
+bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    BlockFilter filter;
+    if (m_filter_type == BlockFilterType::EVM_LOG) {
+        GCSFilter::ElementSet elements;
+        if (!EVMLogFilterElements(*Assert(block.data), elements)) {
+            return false;
+        }
+        filter = BlockFilter(m_filter_type, block.hash, elements);
+    } else {
+        CBlockUndo block_undo;
+
+        if (block.height > 0) {
+            // pindex variable gives indexing code access to node internals. It
+            // will be removed in upcoming commit
+            const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+            if (!m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
+                return false;
+            }
+        }
+
+        filter = BlockFilter(m_filter_type, *Assert(block.data), block_undo);
+    }
 
     const uint256& header = filter.ComputeHeader(m_last_header);
     bool res = Write(filter, block.height, header);
@@ -10,11 +10,14 @@
 #include <kernel/coinstats.h>
 #include <logging.h>
 #include <node/blockstorage.h>
+#include <privacy/consensus.h>
 #include <serialize.h>
 #include <txdb.h>
 #include <undo.h>
 #include <validation.h>
 
+#include <algorithm>
+
 using kernel::ApplyCoinHash;
 using kernel::CCoinsStats;
 using kernel::GetBogoSize;
@@ -23,6 +26,11 @@ using kernel::RemoveCoinHash;
 static constexpr uint8_t DB_BLOCK_HASH{'s'};
 static constexpr uint8_t DB_BLOCK_HEIGHT{'t'};
 static constexpr uint8_t DB_MUHASH{'M'};
+static constexpr uint8_t DB_CONTRACT_MUHASH{'C'};
+static constexpr uint8_t DB_VERSION{'V'};
+
+//! Version 1 added the contract and privacy totals to DBVal
+static constexpr uint32_t CURRENT_VERSION{1};
 
 namespace {
 
@@ -40,6 +48,16 @@ struct DBVal {
     CAmount total_unspendables_bip30;
     CAmount total_unspendables_scripts;
     CAmount total_unspendables_unclaimed_rewards;
+    uint256 contract_muhash;
+    uint64_t contract_output_count;
+    CAmount total_contract_amount;
+    uint64_t privacy_tx_count;
+    uint64_t privacy_shielded_output_count;
+    uint64_t privacy_key_image_count;
+    uint64_t privacy_fcmp_input_count;
+    CAmount total_privacy_value_in;
+    CAmount total_privacy_value_out;
+    CAmount total_privacy_fees;
 
     SERIALIZE_METHODS(DBVal, obj)
     {
@@ -56,6 +74,16 @@ struct DBVal {
         READWRITE(obj.total_unspendables_bip30);
         READWRITE(obj.total_unspendables_scripts);
         READWRITE(obj.total_unspendables_unclaimed_rewards);
+        READWRITE(obj.contract_muhash);
+        READWRITE(obj.contract_output_count);
+        READWRITE(obj.total_contract_amount);
+        READWRITE(obj.privacy_tx_count);
+        READWRITE(obj.privacy_shielded_output_count);
+        READWRITE(obj.privacy_key_image_count);
+        READWRITE(obj.privacy_fcmp_input_count);
+        READWRITE(obj.total_privacy_value_in);
+        READWRITE(obj.total_privacy_value_out);
+        READWRITE(obj.total_privacy_fees);
     }
 };
 
@@ -99,6 +127,26 @@ struct DBHashKey {
     }
 };
 
+//! Coins held by contracts, created by contract creations, calls and the condensing transactions
+bool IsContractCoin(const Coin& coin)
+{
+    return coin.out.scriptPubKey.HasOpCreate() || coin.out.scriptPubKey.HasOpCall();
+}
+
+//! The privacy part of a transaction, nullopt for a transparent one
+std::optional<privacy::CPrivacyTransaction> GetPrivacyTransaction(const CTransaction& tx)
+{
+    if (!privacy::HasPrivacyData(tx)) return std::nullopt;
+    return privacy::ExtractPrivacyTransaction(tx);
+}
+
+uint64_t CountShieldedOutputs(const privacy::CPrivacyTransaction& tx)
+{
+    return std::count_if(tx.privacyOutputs.begin(), tx.privacyOutputs.end(), [](const privacy::CPrivacyOutput& out) {
+        return out.GetType() != privacy::PrivacyType::TRANSPARENT;
+    });
+}
+
 }; // namespace
 
 std::unique_ptr<CoinStatsIndex> g_coin_stats_index;
@@ -110,6 +158,15 @@ CoinStatsIndex::CoinStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t
     fs::create_directories(path);
 
     m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+
+    // Entries written before the contract and privacy totals existed cannot
+    // be read anymore, so such an index is built again from scratch.
+    uint32_t version{0};
+    if (m_db->Exists(DB_MUHASH) && (!m_db->Read(DB_VERSION, version) || version != CURRENT_VERSION)) {
+        LogPrintf("%s: rebuilding the index to add the contract and privacy totals\n", GetName());
+        m_db.reset();
+        m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, /*f_wipe=*/true);
+    }
 }
 
 bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
@@ -156,6 +213,15 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
                 continue;
             }
 
+            const auto privacy_tx{GetPrivacyTransaction(*tx)};
+            if (privacy_tx) {
+                ++m_privacy_tx_count;
+                m_privacy_shielded_output_count += CountShieldedOutputs(*privacy_tx);
+                m_privacy_key_image_count += privacy_tx->privacyInputs.size();
+                m_privacy_fcmp_input_count += privacy_tx->fcmpInputs.size();
+                m_total_privacy_fees += privacy_tx->nFee;
+            }
+
             for (uint32_t j = 0; j < tx->vout.size(); ++j) {
                 const CTxOut& out{tx->vout[j]};
                 Coin coin{out, block.height, tx->IsCoinBase(), tx->IsCoinStake()};
@@ -170,6 +236,13 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 
                 ApplyCoinHash(m_muhash, outpoint, coin);
 
+                if (IsContractCoin(coin)) {
+                    ApplyCoinHash(m_contract_muhash, outpoint, coin);
+                    ++m_contract_output_count;
+                    m_total_contract_amount += coin.out.nValue;
+                }
+                if (privacy_tx) m_total_privacy_value_out += coin.out.nValue;
+
                 if (tx->IsCoinBase()) {
                     m_total_coinbase_amount += coin.out.nValue;
                 } else {
@@ -191,6 +264,13 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 
                     RemoveCoinHash(m_muhash, outpoint, coin);
 
+                    if (IsContractCoin(coin)) {
+                        RemoveCoinHash(m_contract_muhash, outpoint, coin);
+                        --m_contract_output_count;
+                        m_total_contract_amount -= coin.out.nValue;
+                    }
+                    if (privacy_tx) m_total_privacy_value_in += coin.out.nValue;
+
                     m_total_prevout_spent_amount += coin.out.nValue;
 
                     --m_transaction_output_count;
@@ -227,10 +307,21 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
     value.second.total_unspendables_bip30 = m_total_unspendables_bip30;
     value.second.total_unspendables_scripts = m_total_unspendables_scripts;
     value.second.total_unspendables_unclaimed_rewards = m_total_unspendables_unclaimed_rewards;
+    value.second.contract_output_count = m_contract_output_count;
+    value.second.total_contract_amount = m_total_contract_amount;
+    value.second.privacy_tx_count = m_privacy_tx_count;
+    value.second.privacy_shielded_output_count = m_privacy_shielded_output_count;
+    value.second.privacy_key_image_count = m_privacy_key_image_count;
+    value.second.privacy_fcmp_input_count = m_privacy_fcmp_input_count;
+    value.second.total_privacy_value_in = m_total_privacy_value_in;
+    value.second.total_privacy_value_out = m_total_privacy_value_out;
+    value.second.total_privacy_fees = m_total_privacy_fees;
 
     uint256 out;
     m_muhash.Finalize(out);
     value.second.muhash = out;
+    m_contract_muhash.Finalize(out);
+    value.second.contract_muhash = out;
 
     // Intentionally do not update DB_MUHASH here so it stays in sync with
     // DB_BEST_BLOCK, and the index is not corrupted if there is an unclean shutdown.
@@ -346,6 +437,16 @@ std::optional<CCoinsStats> CoinStatsIndex::LookUpStats(const CBlockIndex& block_
     stats.total_unspendables_bip30 = entry.total_unspendables_bip30;
     stats.total_unspendables_scripts = entry.total_unspendables_scripts;
     stats.total_unspendables_unclaimed_rewards = entry.total_unspendables_unclaimed_rewards;
+    stats.contract_muhash = entry.contract_muhash;
+    stats.contract_output_count = entry.contract_output_count;
+    stats.total_contract_amount = entry.total_contract_amount;
+    stats.privacy_tx_count = entry.privacy_tx_count;
+    stats.privacy_shielded_output_count = entry.privacy_shielded_output_count;
+    stats.privacy_key_image_count = entry.privacy_key_image_count;
+    stats.privacy_fcmp_input_count = entry.privacy_fcmp_input_count;
+    stats.total_privacy_value_in = entry.total_privacy_value_in;
+    stats.total_privacy_value_out = entry.total_privacy_value_out;
+    stats.total_privacy_fees = entry.total_privacy_fees;
 
     return stats;
 }
@@ -362,6 +463,11 @@ bool CoinStatsIndex::CustomInit(const std::optional<interfaces::BlockRef>& block
             return false;
         }
     }
+    if (!m_db->Read(DB_CONTRACT_MUHASH, m_contract_muhash) && m_db->Exists(DB_CONTRACT_MUHASH)) {
+        LogError("%s: Cannot read current %s state; index may be corrupted\n",
+                     __func__, GetName());
+        return false;
+    }
 
     if (block) {
         DBVal entry;
@@ -373,7 +479,9 @@ bool CoinStatsIndex::CustomInit(const std::optional<interfaces::BlockRef>& block
 
         uint256 out;
         m_muhash.Finalize(out);
-        if (entry.muhash != out) {
+        uint256 contract_out;
+        m_contract_muhash.Finalize(contract_out);
+        if (entry.muhash != out || entry.contract_muhash != contract_out) {
             LogError("%s: Cannot read current %s state; index may be corrupted\n",
                          __func__, GetName());
             return false;
@@ -391,6 +499,15 @@ bool CoinStatsIndex::CustomInit(const std::optional<interfaces::BlockRef>& block
         m_total_unspendables_bip30 = entry.total_unspendables_bip30;
         m_total_unspendables_scripts = entry.total_unspendables_scripts;
         m_total_unspendables_unclaimed_rewards = entry.total_unspendables_unclaimed_rewards;
+        m_contract_output_count = entry.contract_output_count;
+        m_total_contract_amount = entry.total_contract_amount;
+        m_privacy_tx_count = entry.privacy_tx_count;
+        m_privacy_shielded_output_count = entry.privacy_shielded_output_count;
+        m_privacy_key_image_count = entry.privacy_key_image_count;
+        m_privacy_fcmp_input_count = entry.privacy_fcmp_input_count;
+        m_total_privacy_value_in = entry.total_privacy_value_in;
+        m_total_privacy_value_out = entry.total_privacy_value_out;
+        m_total_privacy_fees = entry.total_privacy_fees;
     }
 
     return true;
@@ -401,6 +518,8 @@ bool CoinStatsIndex::CustomCommit(CDBBatch& batch)
     // DB_MUHASH should always be committed in a batch together with DB_BEST_BLOCK
     // to prevent an inconsistent state of the DB.
     batch.Write(DB_MUHASH, m_muhash);
+    batch.Write(DB_CONTRACT_MUHASH, m_contract_muhash);
+    batch.Write(DB_VERSION, CURRENT_VERSION);
     return true;
 }
 
@@ -440,6 +559,15 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
     for (size_t i = 0; i < block.vtx.size(); ++i) {
         const auto& tx{block.vtx.at(i)};
 
+        const auto privacy_tx{GetPrivacyTransaction(*tx)};
+        if (privacy_tx) {
+            --m_privacy_tx_count;
+            m_privacy_shielded_output_count -= CountShieldedOutputs(*privacy_tx);
+            m_privacy_key_image_count -= privacy_tx->privacyInputs.size();
+            m_privacy_fcmp_input_count -= privacy_tx->fcmpInputs.size();
+            m_total_privacy_fees -= privacy_tx->nFee;
+        }
+
         for (uint32_t j = 0; j < tx->vout.size(); ++j) {
             const CTxOut& out{tx->vout[j]};
             COutPoint outpoint{tx->GetHash(), j};
@@ -454,6 +582,13 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
 
             RemoveCoinHash(m_muhash, outpoint, coin);
 
+            if (IsContractCoin(coin)) {
+                RemoveCoinHash(m_contract_muhash, outpoint, coin);
+                --m_contract_output_count;
+                m_total_contract_amount -= coin.out.nValue;
+            }
+            if (privacy_tx) m_total_privacy_value_out -= coin.out.nValue;
+
             if (tx->IsCoinBase()) {
                 m_total_coinbase_amount -= coin.out.nValue;
             } else {
@@ -475,6 +610,13 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
 
                 ApplyCoinHash(m_muhash, outpoint, coin);
 
+                if (IsContractCoin(coin)) {
+                    ApplyCoinHash(m_contract_muhash, outpoint, coin);
+                    ++m_contract_output_count;
+                    m_total_contract_amount += coin.out.nValue;
+                }
+                if (privacy_tx) m_total_privacy_value_in -= coin.out.nValue;
+
                 m_total_prevout_spent_amount -= coin.out.nValue;
 
                 m_transaction_output_count++;
@@ -492,6 +634,8 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
     uint256 out;
     m_muhash.Finalize(out);
     Assert(read_out.second.muhash == out);
+    m_contract_muhash.Finalize(out);
+    Assert(read_out.second.contract_muhash == out);
 
     Assert(m_transaction_output_count == read_out.second.transaction_output_count);
     Assert(m_total_amount == read_out.second.total_amount);
@@ -505,6 +649,15 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
     Assert(m_total_unspendables_bip30 == read_out.second.total_unspendables_bip30);
     Assert(m_total_unspendables_scripts == read_out.second.total_unspendables_scripts);
     Assert(m_total_unspendables_unclaimed_rewards == read_out.second.total_unspendables_unclaimed_rewards);
+    Assert(m_contract_output_count == read_out.second.contract_output_count);
+    Assert(m_total_contract_amount == read_out.second.total_contract_amount);
+    Assert(m_privacy_tx_count == read_out.second.privacy_tx_count);
+    Assert(m_privacy_shielded_output_count == read_out.second.privacy_shielded_output_count);
+    Assert(m_privacy_key_image_count == read_out.second.privacy_key_image_count);
+    Assert(m_privacy_fcmp_input_count == read_out.second.privacy_fcmp_input_count);
+    Assert(m_total_privacy_value_in == read_out.second.total_privacy_value_in);
+    Assert(m_total_privacy_value_out == read_out.second.total_privacy_value_out);
+    Assert(m_total_privacy_fees == read_out.second.total_privacy_fees);
 
     return true;
 }
@@ -38,6 +38,20 @@ private:
     CAmount m_total_unspendables_scripts{0};
     CAmount m_total_unspendables_unclaimed_rewards{0};
 
+    //! Contract held coins, a subset of the coins above
+    MuHash3072 m_contract_muhash;
+    uint64_t m_contract_output_count{0};
+    CAmount m_total_contract_amount{0};
+
+    //! Privacy transactions, their shielded side is only known by these counters
+    uint64_t m_privacy_tx_count{0};
+    uint64_t m_privacy_shielded_output_count{0};
+    uint64_t m_privacy_key_image_count{0};
+    uint64_t m_privacy_fcmp_input_count{0};
+    CAmount m_total_privacy_value_in{0};
+    CAmount m_total_privacy_value_out{0};
+    CAmount m_total_privacy_fees{0};
+
     [[nodiscard]] bool ReverseBlock(const CBlock& block, const CBlockIndex* pindex);
 
     bool AllowPrune() const override { return true; }
@@ -0,0 +1,258 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/explorerindex.h>
+
+#include <chain.h>
+#include <common/args.h>
+#include <interfaces/chain.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <pos.h>
+#include <primitives/block.h>
+#include <trust/heartbeat_net.h>
+#include <undo.h>
+#include <util/strencodings.h>
+#include <validation.h>
+
+#include <limits>
+#include <map>
+
+constexpr uint8_t DB_BLOCK_SUMMARY{'b'};
+constexpr uint8_t DB_TOKEN_TRANSFER{'t'};
+constexpr uint8_t DB_BLOCK_TRANSFERS{'u'};
+
+//! Topic of Transfer(address,address,uint256), shared by ERC20 and ERC721
+static const uint256 TRANSFER_TOPIC{ParseHex("ddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef")};
+
+std::unique_ptr<ExplorerIndex> g_explorerindex;
+
+namespace {
+
+/** Height in a key, big-endian so the records sort by height */
+struct HeightKey {
+    uint32_t height;
+
+    explicit HeightKey(uint32_t height_in) : height(height_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const { ser_writedata32be(s, height); }
+    template <typename Stream>
+    void Unserialize(Stream& s) { height = ser_readdata32be(s); }
+};
+
+//! Address of an indexed address topic, in its low 20 bytes
+uint160 TopicAddress(const uint256& topic)
+{
+    return uint160{Span{topic}.last(20)};
+}
+
+} // namespace
+
+/** Access to the explorer index database (indexes/explorerindex/) */
+class ExplorerIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+ExplorerIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "explorerindex", n_cache_size, f_memory, f_wipe)
+{}
+
+ExplorerIndex::ExplorerIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "explorerindex"), m_db(std::make_unique<ExplorerIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+ExplorerIndex::~ExplorerIndex() = default;
+
+bool ExplorerIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    assert(block.data);
+    const CBlock& data = *block.data;
+
+    ExplorerBlockSummary summary;
+    summary.hash = block.hash;
+    summary.time = data.GetBlockTime();
+    summary.size = ::GetSerializeSize(TX_WITH_WITNESS(data));
+    summary.tx_count = data.vtx.size();
+    summary.proof_of_stake = data.IsProofOfStake();
+
+    std::map<uint256, uint32_t> tx_positions;
+    for (size_t i = 0; i < data.vtx.size(); ++i) {
+        tx_positions.emplace(data.vtx[i]->GetHash(), i);
+        if (data.vtx[i]->HasCreateOrCall()) ++summary.contract_tx_count;
+    }
+
+    if (summary.proof_of_stake && data.vtx.size() > 1 && data.vtx[1]->vout.size() > 1) {
+        // The reward is what the coinstake pays out beyond the stake it spends
+        const CTransaction& coinstake = *data.vtx[1];
+        CBlockUndo block_undo;
+        const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+        if (!m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex) || block_undo.vtxundo.empty()) {
+            LogError("%s: Failed to read undo data of block %s\n", __func__, block.hash.ToString());
+            return false;
+        }
+        CAmount stake_in{0};
+        for (const Coin& coin : block_undo.vtxundo[0].vprevout) {
+            stake_in += coin.out.nValue;
+        }
+        summary.staker = coinstake.vout[1].scriptPubKey;
+        summary.reward = coinstake.GetValueOut() - stake_in;
+        if (trust::g_heartbeat_manager) {
+            summary.trust_tier = static_cast<uint8_t>(GetStakerTrustTier(summary.staker, *trust::g_heartbeat_manager->GetTrustManager()));
+        }
+    } else if (!data.vtx.empty() && !data.vtx[0]->vout.empty()) {
+        summary.staker = data.vtx[0]->vout[0].scriptPubKey;
+        summary.reward = data.vtx[0]->GetValueOut();
+    }
+
+    CDBBatch batch(*m_db);
+    std::vector<TokenTransferKey> keys;
+    std::vector<interfaces::ContractLog> logs;
+    if (summary.contract_tx_count > 0 && m_chain->getBlockContractLogs(data, logs)) {
+        uint256 last_tx;
+        uint32_t log_index{0};
+        for (const interfaces::ContractLog& log : logs) {
+            log_index = log.tx_hash == last_tx ? log_index + 1 : 0;
+            last_tx = log.tx_hash;
+            if (log.topics.empty() || log.topics[0] != TRANSFER_TOPIC) continue;
+
+            TokenTransfer transfer;
+            transfer.txid = log.tx_hash;
+            if (log.topics.size() == 3 && log.data.size() >= 32) {
+                transfer.value = uint256{Span{log.data}.first(32)};
+            } else if (log.topics.size() == 4) {
+                transfer.value = log.topics[3];
+                transfer.nft = true;
+            } else {
+                continue;
+            }
+            transfer.from = TopicAddress(log.topics[1]);
+            transfer.to = TopicAddress(log.topics[2]);
+
+            const TokenTransferKey& key = keys.emplace_back(TokenTransferKey{log.address, static_cast<uint32_t>(block.height),
+                                                                              tx_positions[log.tx_hash], log_index});
+            batch.Write(std::make_pair(DB_TOKEN_TRANSFER, key), transfer);
+        }
+    }
+    summary.token_transfer_count = keys.size();
+
+    batch.Write(std::make_pair(DB_BLOCK_SUMMARY, HeightKey(block.height)), summary);
+    // The receipts of a disconnected block are gone by the time the index
+    // rewinds, so keep what to erase
+    if (keys.empty()) {
+        batch.Erase(std::make_pair(DB_BLOCK_TRANSFERS, HeightKey(block.height)));
+    } else {
+        batch.Write(std::make_pair(DB_BLOCK_TRANSFERS, HeightKey(block.height)), keys);
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool ExplorerIndex::CustomRewind(const interfaces::BlockRef& current_tip, const interfaces::BlockRef& new_tip)
+{
+    CDBBatch batch(*m_db);
+    for (int height = current_tip.height; height > new_tip.height; --height) {
+        std::vector<TokenTransferKey> keys;
+        if (m_db->Read(std::make_pair(DB_BLOCK_TRANSFERS, HeightKey(height)), keys)) {
+            for (const TokenTransferKey& key : keys) {
+                batch.Erase(std::make_pair(DB_TOKEN_TRANSFER, key));
+            }
+            batch.Erase(std::make_pair(DB_BLOCK_TRANSFERS, HeightKey(height)));
+        }
+        batch.Erase(std::make_pair(DB_BLOCK_SUMMARY, HeightKey(height)));
+    }
+    return m_db->WriteBatch(batch);
+}
+
+BaseIndex::DB& ExplorerIndex::GetDB() const { return *m_db; }
+
+bool ExplorerIndex::ReadBlockSummary(int height, ExplorerBlockSummary& summary) const
+{
+    return height >= 0 && m_db->Read(std::make_pair(DB_BLOCK_SUMMARY, HeightKey(height)), summary);
+}
+
+bool ExplorerIndex::ReadBlockSummaries(int first, int last, std::vector<std::pair<int, ExplorerBlockSummary>>& summaries) const
+{
+    if (first < 0 || last < first) return true;
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_BLOCK_SUMMARY, HeightKey(first)));
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, HeightKey> key{0, HeightKey(0)};
+        if (!pcursor->GetKey(key) || key.first != DB_BLOCK_SUMMARY || key.second.height > static_cast<uint32_t>(last)) {
+            break;
+        }
+        ExplorerBlockSummary summary;
+        if (!pcursor->GetValue(summary)) {
+            LogError("failed to get explorer index block summary");
+            return false;
+        }
+        summaries.emplace_back(key.second.height, std::move(summary));
+        pcursor->Next();
+    }
+    return true;
+}
+
+static bool SameTokenTransferKey(const TokenTransferKey& a, const TokenTransferKey& b)
+{
+    return a.contract == b.contract && a.height == b.height && a.tx_index == b.tx_index && a.log_index == b.log_index;
+}
+
+bool ExplorerIndex::ReadTokenTransfers(const uint160& contract, const TokenTransferKey* after, size_t limit, bool reverse,
+                                       std::vector<std::pair<TokenTransferKey, TokenTransfer>>& transfers, bool& more) const
+{
+    more = false;
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    if (!reverse) {
+        if (after) {
+            // Resume on the continuation key, or past it if a reorg erased it
+            pcursor->Seek(std::make_pair(DB_TOKEN_TRANSFER, *after));
+            std::pair<uint8_t, TokenTransferKey> key;
+            if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_TOKEN_TRANSFER && SameTokenTransferKey(key.second, *after)) {
+                pcursor->Next();
+            }
+        } else {
+            pcursor->Seek(std::make_pair(DB_TOKEN_TRANSFER, TokenTransferKey{contract, 0, 0, 0}));
+        }
+    } else {
+        // Land on the first key past the range, then step back onto its last entry
+        if (after) {
+            pcursor->Seek(std::make_pair(DB_TOKEN_TRANSFER, *after));
+        } else {
+            constexpr uint32_t max{std::numeric_limits<uint32_t>::max()};
+            pcursor->Seek(std::make_pair(DB_TOKEN_TRANSFER, TokenTransferKey{contract, max, max, max}));
+        }
+        if (pcursor->Valid()) {
+            pcursor->Prev();
+        } else {
+            pcursor->SeekToLast();
+        }
+    }
+
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, TokenTransferKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_TOKEN_TRANSFER || key.second.contract != contract) {
+            break;
+        }
+        if (limit > 0 && transfers.size() >= limit) {
+            more = true;
+            break;
+        }
+        TokenTransfer transfer;
+        if (!pcursor->GetValue(transfer)) {
+            LogError("failed to get explorer index token transfer");
+            return false;
+        }
+        transfers.emplace_back(key.second, std::move(transfer));
+        if (reverse) {
+            pcursor->Prev();
+        } else {
+            pcursor->Next();
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_INDEX_EXPLORERINDEX_H
+#define WATTX_INDEX_EXPLORERINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+static constexpr bool DEFAULT_EXPLORERINDEX{false};
+
+/**
+ * What a block explorer shows of a block in its lists, without reading the
+ * block
+ */
+struct ExplorerBlockSummary {
+    uint256 hash;
+    uint32_t time{0};
+    uint32_t size{0};
+    uint32_t tx_count{0};
+    //! Transactions creating or calling a contract
+    uint32_t contract_tx_count{0};
+    uint32_t token_transfer_count{0};
+    bool proof_of_stake{false};
+    //! Output script paid by the coinstake, or the first coinbase output of a mined block
+    CScript staker;
+    //! Trust tier of the staker when the block was indexed, see GetStakerTrustTier
+    uint8_t trust_tier{0};
+    //! What the coinstake pays out beyond the stake it spends, or the coinbase value of a mined block
+    CAmount reward{0};
+
+    SERIALIZE_METHODS(ExplorerBlockSummary, obj)
+    {
+        READWRITE(obj.hash, obj.time, obj.size, obj.tx_count, obj.contract_tx_count, obj.token_transfer_count,
+                  obj.proof_of_stake, obj.staker, obj.trust_tier, obj.reward);
+    }
+};
+
+/** Position of a token transfer log, ordered by contract then chain order */
+struct TokenTransferKey {
+    uint160 contract;
+    uint32_t height{0};
+    uint32_t tx_index{0};
+    uint32_t log_index{0};
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << contract;
+        // Big-endian, so the keys of a contract sort by block and position
+        ser_writedata32be(s, height);
+        ser_writedata32be(s, tx_index);
+        ser_writedata32be(s, log_index);
+    }
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> contract;
+        height = ser_readdata32be(s);
+        tx_index = ser_readdata32be(s);
+        log_index = ser_readdata32be(s);
+    }
+};
+
+/** A Transfer event of an ERC20 or ERC721 token contract */
+struct TokenTransfer {
+    uint256 txid;
+    uint160 from;
+    uint160 to;
+    //! Big-endian amount, or the token id of an ERC721 transfer
+    uint256 value;
+    bool nft{false};
+
+    SERIALIZE_METHODS(TokenTransfer, obj) { READWRITE(obj.txid, obj.from, obj.to, obj.value, obj.nft); }
+};
+
+/**
+ * ExplorerIndex keeps what block explorer pages need beyond -addrindex, so
+ * they do not have to be assembled from many RPCs: a summary of every block
+ * by height, and the Transfer events of token contracts by contract.
+ *
+ * Token transfers are read from the transaction receipts, so they are only
+ * indexed with -logevents. Address histories are served from the address
+ * index.
+ */
+class ExplorerIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return false; }
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRewind(const interfaces::BlockRef& current_tip, const interfaces::BlockRef& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit ExplorerIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~ExplorerIndex() override;
+
+    /// Summary of the block at a height of the indexed chain.
+    bool ReadBlockSummary(int height, ExplorerBlockSummary& summary) const;
+
+    /// Summaries of the blocks at heights [first, last], in height order.
+    bool ReadBlockSummaries(int first, int last, std::vector<std::pair<int, ExplorerBlockSummary>>& summaries) const;
+
+    /**
+     * Read at most @p limit transfers of a token contract, resuming strictly
+     * after @p after when given. @p reverse walks from the newest transfer
+     * backwards. @p more is set when transfers remain past the returned page;
+     * the last returned key is the continuation for the next call.
+     */
+    bool ReadTokenTransfers(const uint160& contract, const TokenTransferKey* after, size_t limit, bool reverse,
+                            std::vector<std::pair<TokenTransferKey, TokenTransfer>>& transfers, bool& more) const;
+};
+
+/// The global explorer index. May be null.
+extern std::unique_ptr<ExplorerIndex> g_explorerindex;
+
+#endif // WATTX_INDEX_EXPLORERINDEX_H
@@ -20,12 +20,17 @@
 #include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/consensus.h>
+#include <crypto/x25x/ethash_cache.h>
+#include <dbwrapper.h>
 #include <deploymentstatus.h>
 #include <hash.h>
 #include <httprpc.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/addressindex.h>
+#include <index/anchorindex.h>
 #include <index/coinstatsindex.h>
+#include <index/explorerindex.h>
 #include <index/txindex.h>
 #include <init/common.h>
 #include <interfaces/chain.h>
@@ -56,13 +61,23 @@
 #include <node/mempool_persist_args.h>
 #include <node/miner.h>
 #include <node/peerman_args.h>
+#include <node/randomx_verifier.h>
+#include <node/utxo_snapshot.h>
+#include <node/wattx_state.h>
 #include <policy/feerate.h>
 #include <policy/fees.h>
 #include <policy/fees_args.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
+#include <pos.h>
+#include <pos_utxo_tracker.h>
 #include <protocol.h>
+#include <qtum/evmcallpool.h>
+#include <qtum/qtumDGP.h>
+#include <qtum/evmprefetch.h>
+#include <qtum/statepruner.h>
 #include <rpc/blockchain.h>
+#include <rpc/eth_rpc.h>
 #include <rpc/register.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
@@ -72,6 +87,7 @@
 #include <torcontrol.h>
 #include <txdb.h>
 #include <txmempool.h>
+#include <undo.h>
 #include <util/asmap.h>
 #include <util/batchpriority.h>
 #include <util/chaintype.h>
@@ -96,10 +112,12 @@
 #include <trust/trustscore.h>
 #include <trust/heartbeat_net.h>
 #include <messaging/encryptedmsg.h>
+#include <node/eth_filters.h>
 #include <node/privacy_provider.h>
 #include <privacy/consensus.h>
 #include <privacy/fcmp_consensus.h>
 #include <walletinitinterface.h>
+#include <wsrpc.h>
 #ifdef ENABLE_WALLET
 #include <wallet/wallet.h>
 #include <interfaces/wallet.h>
@@ -112,6 +130,7 @@
 #include <cstdio>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <set>
 #include <string>
 #include <thread>
@@ -140,6 +159,7 @@ using node::BlockManager;
 using node::CalculateCacheSizes;
 using node::ChainstateLoadResult;
 using node::ChainstateLoadStatus;
+using node::DEFAULT_BLOCK_CLUSTER_SELECTION;
 using node::DEFAULT_PERSIST_MEMPOOL;
 using node::DEFAULT_PRINT_MODIFIED_FEE;
 using node::DEFAULT_STOPATHEIGHT;
@@ -282,6 +302,8 @@ void Interrupt(NodeContext& node)
 #endif
     InterruptHTTPServer();
     InterruptHTTPRPC();
+    InterruptWSRPC();
+    InterruptStatePruner();
     InterruptRPC();
     InterruptREST();
     InterruptTorControl();
@@ -301,9 +323,6 @@ void Shutdown(NodeContext& node)
     TRY_LOCK(g_shutdown_mutex, lock_shutdown);
     if (!lock_shutdown) return;
     LogPrintf("%s: In progress...\n", __func__);
-
-    // Shutdown P2P encrypted messaging
-    messaging::ShutdownMessageManager();
     Assert(node.args);
 
     /// Note: Shutdown() must be able to handle cases in which initialization failed part of the way,
@@ -326,6 +345,7 @@ void Shutdown(NodeContext& node)
 
     if (node.mempool) node.mempool->AddTransactionsUpdated(1);
 
+    StopWSRPC(node.validation_signals.get());
     StopHTTPRPC();
     StopREST();
     StopRPC();
@@ -372,6 +392,7 @@ void Shutdown(NodeContext& node)
     // FlushStateToDisk generates a ChainStateFlushed callback, which we should avoid missing
     if (node.chainman) {
         LOCK(cs_main);
+        g_mempool_evm_warmer.reset();
         for (Chainstate* chainstate : node.chainman->GetAll()) {
             if (chainstate->CanFlushToDisk()) {
                 chainstate->ForceFlushStateToDisk();
@@ -387,6 +408,9 @@ void Shutdown(NodeContext& node)
     for (auto* index : node.indexes) index->Stop();
     if (g_txindex) g_txindex.reset();
     if (g_coin_stats_index) g_coin_stats_index.reset();
+    if (g_anchorindex) g_anchorindex.reset();
+    if (g_explorerindex) g_explorerindex.reset();
+    if (g_addressindex) g_addressindex.reset();
     DestroyAllBlockFilterIndexes();
     node.indexes.clear(); // all instances are nullptr now
 
@@ -394,16 +418,17 @@ void Shutdown(NodeContext& node)
     trust::ShutdownHeartbeatManager();
     trust::ShutdownPeerDiscovery();
 
+    // Shutdown P2P encrypted messaging, once no peer can reach it
+    messaging::ShutdownMessageManager();
+
     // Shutdown privacy subsystem
-    node::ShutdownDecoyProvider();
-    privacy::ShutdownKeyImageDB();
+    node::ShutdownDecoyProvider(node.validation_signals.get());
 
-    // Shutdown FCMP consensus state (curve tree, key images)
-    privacy::ShutdownFcmpConsensus();
+    node::ShutdownEthFilters(node.validation_signals.get());
+    StopStatePruner();
 
-    // Shutdown validator and delegation databases
-    validators::ShutdownValidatorDB();
-    validators::ShutdownDelegationDB();
+    // Shutdown validator, trust and privacy state (curve tree, key images)
+    node::ShutdownWattxState();
 
     // Any future callbacks will be dropped. This should absolutely be safe - if
     // missing a callback results in an unrecoverable situation, unclean shutdown
@@ -419,9 +444,7 @@ void Shutdown(NodeContext& node)
                 chainstate->ResetCoinsViews();
             }
         }
-        pstorageresult.reset();
-        globalState.reset();
-        globalSealEngine.reset();
+        node::UnloadEvmState();
     }
     for (const auto& client : node.chain_clients) {
         client->stop();
@@ -449,6 +472,7 @@ void Shutdown(NodeContext& node)
     RemovePidFile(*node.args);
 
     LogPrintf("%s: done\n", __func__);
+    LogInstance().StopAsyncLogging();
 }
 
 /**
@@ -491,6 +515,75 @@ static void registerSignalHandler(int signal, void(*handler)(int))
 }
 #endif
 
+/** Built-in -rpcworkclass limits of a class, in the option's own format */
+static std::string HTTPWorkClassLimitsString(HTTPWorkClass work_class)
+{
+    const HTTPWorkClassLimits limits{DefaultHTTPWorkClassLimits(work_class)};
+    return strprintf("%d:%d:%d", limits.threads, limits.depth, count_milliseconds(limits.deadline));
+}
+
+#ifdef ENABLE_ZMQ
+/** Contract logs, stakes and key images of blocks, for the ZMQ notifiers */
+static CZMQBlockDataSources ZMQBlockDataSources(NodeContext& node)
+{
+    CZMQBlockDataSources sources;
+    sources.get_logs = [](const CBlock& block, const CBlockIndex& index) {
+        std::vector<CZMQContractLog> logs;
+        if (!fLogEvents) return logs;
+        for (const TransactionReceiptInfo& receipt : pstorageresult->getBlockResults(block.vtx, index.GetBlockHash())) {
+            for (uint32_t i = 0; i < receipt.logs.size(); ++i) {
+                const dev::eth::LogEntry& entry = receipt.logs[i];
+                CZMQContractLog& log = logs.emplace_back();
+                log.txid = receipt.transactionHash;
+                log.output_index = receipt.outputIndex;
+                log.log_index = i;
+                log.address = entry.address.asArray();
+                for (const dev::h256& topic : entry.topics) {
+                    log.topics.push_back(topic.asArray());
+                }
+                log.data = entry.data;
+            }
+        }
+        return logs;
+    };
+    sources.get_stake = [&chainman = node.chainman](const CBlock& block, const CBlockIndex& index) -> std::optional<CZMQStake> {
+        assert(chainman);
+        if (block.vtx.size() < 2 || !block.vtx[1]->IsCoinStake()) return std::nullopt;
+        // The reward is what the coinstake pays out beyond the stake it spends
+        CBlockUndo undo;
+        if (!chainman->m_blockman.ReadBlockUndo(undo, index) || undo.vtxundo.empty()) return std::nullopt;
+        const CTransaction& coinstake = *block.vtx[1];
+        CAmount stake_in{0};
+        for (const Coin& coin : undo.vtxundo[0].vprevout) {
+            stake_in += coin.out.nValue;
+        }
+        CZMQStake stake;
+        stake.staker = coinstake.vout[1].scriptPubKey;
+        stake.reward = coinstake.GetValueOut() - stake_in;
+        if (trust::g_heartbeat_manager) {
+            stake.trust_tier = static_cast<uint8_t>(GetStakerTrustTier(stake.staker, *trust::g_heartbeat_manager->GetTrustManager()));
+        }
+        return stake;
+    };
+    sources.get_key_images = [&chainman = node.chainman](const CBlock& block, const CBlockIndex& index) {
+        assert(chainman);
+        // The same key images as the key image database records for the block
+        std::vector<uint256> key_images;
+        if (!privacy::IsPrivacyActive(index.nHeight, chainman->GetConsensus())) return key_images;
+        for (const CTransactionRef& tx : block.vtx) {
+            if (tx->IsCoinBase() || !privacy::HasPrivacyData(*tx)) continue;
+            const auto privTx = privacy::ExtractPrivacyTransaction(*tx);
+            if (!privTx || (privTx->privacyType != privacy::PrivacyType::RING && privTx->privacyType != privacy::PrivacyType::RINGCT)) continue;
+            for (const auto& input : privTx->privacyInputs) {
+                if (input.keyImage.IsValid()) key_images.push_back(input.keyImage.GetHash());
+            }
+        }
+        return key_images;
+    };
+    return sources;
+}
+#endif
+
 void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
 {
     SetupHelpOptions(argsman);
@@ -521,6 +614,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
 #endif
     argsman.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet3: %s, testnet4: %s, signet: %s)", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnet4ChainParams->GetConsensus().defaultAssumeValid.GetHex(), signetChainParams->GetConsensus().defaultAssumeValid.GetHex()), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blocksdir=<dir>", "Specify directory to hold blocks subdirectory for *.dat files (default: <datadir>)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blocksmmap", strprintf("Read blocks from finalized blocksdir *.dat files through read-only memory mappings instead of file reads (default: %u)", kernel::DEFAULT_BLOCKSMMAP), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blocksxor",
                    strprintf("Whether an XOR-key applies to blocksdir *.dat files. "
                              "The created XOR-key will be zeros for an existing blocksdir or when `-blocksxor=0` is "
@@ -539,6 +633,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-datadir=<dir>", "Specify data directory", ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_NEGATION, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbcache=<n>", strprintf("Maximum database cache size <n> MiB (minimum %d, default: %d). Make sure you have enough RAM. In addition, unused memory allocated to the mempool is shared with this cache (see -maxmempool).", MIN_DB_CACHE >> 20, DEFAULT_DB_CACHE >> 20), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-largepages=<cache>", "Back a cache with hugepages bound to the local NUMA node, falling back to regular pages where they are not available. Can be specified multiple times. Supported caches: coins (the -dbcache coins cache). Usage is reported by getmemoryinfo.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-includeconf=<file>", "Specify additional configuration file, relative to the -datadir path (only useable from configuration file, not command line)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-allowignoredconf", strprintf("For backwards compatibility, treat an unused %s file in the datadir as a warning, not an error.", BITCOIN_CONF_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-loadblock=<file>", "Imports blocks from external file on startup", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -561,6 +656,12 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-reindex", "If enabled, wipe chain state and block index, and rebuild them from blk*.dat files on disk. Also wipe and rebuild other optional indexes that are active. If an assumeutxo snapshot was loaded, its chainstate will be wiped as well. The snapshot can then be reloaded via RPC.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-reindex-chainstate", "If enabled, wipe chain state, and rebuild it from blk*.dat files on disk. If an assumeutxo snapshot was loaded, its chainstate will be wiped as well. The snapshot can then be reloaded via RPC.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-settings=<file>", strprintf("Specify path to dynamic settings data file. Can be disabled with -nosettings. File is written at runtime and not meant to be edited by users (use %s instead for custom settings). Relative paths will be prefixed by datadir location. (default: %s)", BITCOIN_CONF_FILENAME, BITCOIN_SETTINGS_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-evmcachesize=<n>", strprintf("Memory for contract accounts, storage and code kept between blocks, in MiB, 0 to disable (default: %d)", DEFAULT_EVM_CACHE_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-evmprefetchthreads=<n>", strprintf("Number of threads warming the contract state of a block before it is executed, and of mempool contract transactions ahead of it on one more thread, 0 to disable (default: %d, maximum: %d)", DEFAULT_EVM_PREFETCH_THREADS, MAX_EVM_PREFETCH_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-prunestate=<n>", strprintf("Keep the contract state of only the last <n> blocks, deleting older trie nodes in the background every %d blocks. "
+            "Calls against the state of older blocks fail, and a reorg deeper than <n> blocks needs -reindex-chainstate. "
+            "Warning: Reverting this setting requires -reindex-chainstate. "
+            "(default: %d = keep all, archive mode, minimum: %d)", STATE_PRUNE_INTERVAL, DEFAULT_PRUNE_STATE, MIN_BLOCKS_TO_KEEP), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-record-log-opcodes", "Logs all EVM LOG opcode operations to the file vmExecLogs.json", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #if HAVE_SYSTEM
     argsman.AddArg("-startupnotify=<cmd>", "Execute command on startup.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -569,10 +670,12 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-txindex", strprintf("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)", DEFAULT_TXINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blockfilterindex=<type>",
                  strprintf("Maintain an index of compact filters by block (default: %s, values: %s).", DEFAULT_BLOCKFILTERINDEX, ListBlockFilterTypes()) +
-                 " If <type> is not supplied or if <type> = 1, indexes for all known types are enabled.",
+                 " If <type> is not supplied or if <type> = 1, indexes for all known types are enabled. The evmlog filters cover the contract addresses and topics of EVM logs and need -logevents.",
                  ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-logevents", strprintf("Maintain a full EVM log index, used by searchlogs and gettransactionreceipt rpc calls (default: %u)", DEFAULT_LOGEVENTS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
-    argsman.AddArg("-addrindex", strprintf("Maintain a full address index (default: %u)", DEFAULT_ADDRINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-addrindex", strprintf("Maintain a full address index, used by the getaddress* and getspentinfo rpc calls. It is built in the background and can be switched on without a reindex (default: %u)", DEFAULT_ADDRINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-explorerindex", strprintf("Maintain block summaries and token transfers for block explorers, served by the /rest/explorer/ endpoints together with the address index (default: %u)", DEFAULT_EXPLORERINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-anchorindex", strprintf("Maintain an index of the EVM and private swap anchors carried by the chain, used by the getevmanchor and getswap rpc calls (default: %u)", DEFAULT_ANCHORINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-deleteblockchaindata", "Delete the local copy of the block chain data", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-forceinitialblocksdownloadmode", strprintf("Force initial blocks download mode for the node (default: %u)", DEFAULT_FORCE_INITIAL_BLOCKS_DOWNLOAD_MODE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
@@ -594,6 +697,8 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-maxreceivebuffer=<n>", strprintf("Maximum per-connection receive buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXRECEIVEBUFFER), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxsendbuffer=<n>", strprintf("Maximum per-connection memory usage for the send buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXSENDBUFFER), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxuploadtarget=<n>", strprintf("Tries to keep outbound traffic under the given target per 24h. Limit does not apply to peers with 'download' permission or blocks created within past week. 0 = no limit (default: %s). Optional suffix units [k|K|m|M|g|G|t|T] (default: M). Lowercase is 1000 base while uppercase is 1024 base", DEFAULT_MAX_UPLOAD_TARGET), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-maxvalidatorconnections=<n>", strprintf("Maintain at most <n> block-relay-only connections to staking validators, preferring the highest trust tier (default and maximum: %u). These are counted separately from the -maxconnections limit and are not made when -connect is used.", MAX_VALIDATOR_RELAY_CONNECTIONS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-validatorcutthrough", strprintf("Forward compact proof-of-stake blocks to validator connections as soon as their header and stake are checked, before the block is connected (default: %u)", DEFAULT_VALIDATOR_CUT_THROUGH), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
 #ifdef HAVE_SOCKADDR_UN
     argsman.AddArg("-onion=<ip:port|path>", "Use separate SOCKS5 proxy to reach peers via Tor onion services, set -noonion to disable (default: -proxy). May be a local file path prefixed with 'unix:'.", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
 #else
@@ -605,7 +710,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-v2transport", strprintf("Support v2 transport (default: %u)", DEFAULT_V2_TRANSPORT), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-peerbloomfilters", strprintf("Support filtering of blocks and transaction with bloom filters (default: %u)", DEFAULT_PEERBLOOMFILTERS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-peerblockfilters", strprintf("Serve compact block filters to peers per BIP 157 (default: %u)", DEFAULT_PEERBLOCKFILTERS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
-    argsman.AddArg("-txreconciliation", strprintf("Enable transaction reconciliations per BIP 330 (default: %d)", DEFAULT_TXRECONCILIATION_ENABLE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-txreconciliation", strprintf("Enable transaction reconciliations per BIP 330 (default: %d)", DEFAULT_TXRECONCILIATION_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-port=<port>", strprintf("Listen for connections on <port> (default: %u, testnet3: %u, testnet4: %u, signet: %u, regtest: %u). Not relevant for I2P (see doc/i2p.md). If set to a value x, the default onion listening port will be set to x+1.", defaultChainParams->GetDefaultPort(), testnetChainParams->GetDefaultPort(), testnet4ChainParams->GetDefaultPort(), signetChainParams->GetDefaultPort(), regtestChainParams->GetDefaultPort()), ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::CONNECTION);
 #ifdef HAVE_SOCKADDR_UN
     argsman.AddArg("-proxy=<ip:port|path>", "Connect through SOCKS5 proxy, set -noproxy to disable (default: disabled). May be a local file path prefixed with 'unix:' if the proxy supports it.", ArgsManager::ALLOW_ANY | ArgsManager::DISALLOW_ELISION, OptionsCategory::CONNECTION);
@@ -648,6 +753,14 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-zmqpubrawblockhwm=<n>", strprintf("Set publish raw block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtxhwm=<n>", strprintf("Set publish raw transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequencehwm=<n>", strprintf("Set publish hash sequence message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawlogs=<address>", "Enable publish the contract logs of each connected block in <address> (requires -logevents)", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubstake=<address>", "Enable publish the staker, reward and trust tier of proof-of-stake blocks in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubkeyimage=<address>", "Enable publish privacy key images spent or unspent by blocks in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawlogshwm=<n>", strprintf("Set publish raw logs outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubstakehwm=<n>", strprintf("Set publish stake outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubkeyimagehwm=<n>", strprintf("Set publish key image outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawlogsaddress=<hex>", "Publish only the logs of this contract on rawlogs (can be specified multiple times, default: all)", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawlogstopic=<hex>", "Publish only logs with this topic on rawlogs (can be specified multiple times, default: all)", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
@@ -659,9 +772,18 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
+    hidden_args.emplace_back("-zmqpubrawlogs=<address>");
+    hidden_args.emplace_back("-zmqpubstake=<address>");
+    hidden_args.emplace_back("-zmqpubkeyimage=<address>");
+    hidden_args.emplace_back("-zmqpubrawlogshwm=<n>");
+    hidden_args.emplace_back("-zmqpubstakehwm=<n>");
+    hidden_args.emplace_back("-zmqpubkeyimagehwm=<n>");
+    hidden_args.emplace_back("-zmqpubrawlogsaddress=<hex>");
+    hidden_args.emplace_back("-zmqpubrawlogstopic=<hex>");
 #endif
 
     argsman.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-checkpowonload", strprintf("Re-verify the proof of work of every stored block header when loading the block index, instead of trusting headers already verified (default: %u)", kernel::DEFAULT_CHECKPOWONLOAD), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checklevel=<n>", strprintf("How thorough the block verification of -checkblocks is: %s (0-4, default: %u)", Join(CHECKLEVEL_DOC, ", "), DEFAULT_CHECKLEVEL), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkblockindex", strprintf("Do a consistency check for the block tree, chainstate, and other validation data structures every <n> operations. Use 0 to disable. (default: %u, regtest: %u)", defaultChainParams->DefaultConsistencyChecks(), regtestChainParams->DefaultConsistencyChecks()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkaddrman=<n>", strprintf("Run addrman consistency checks every <n> operations. Use 0 to disable. (default: %u)", DEFAULT_ADDRMAN_CONSISTENCY_CHECKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -727,6 +849,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
 
     argsman.AddArg("-blockmaxweight=<n>", strprintf("Set maximum BIP141 block weight (default: %d)", DEFAULT_BLOCK_MAX_WEIGHT), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockreservedweight=<n>", strprintf("Reserve space for the fixed-size block header plus the largest coinbase transaction the mining software may add to the block. (default: %d).", DEFAULT_BLOCK_RESERVED_WEIGHT), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+    argsman.AddArg("-blockclusterselection", strprintf("Select block transactions by the linearized chunks of their mempool clusters, counting contract gas as block space, instead of by ancestor fee rate (default: %u)", DEFAULT_BLOCK_CLUSTER_SELECTION), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockmintxfee=<amt>", strprintf("Set lowest fee rate (in %s/kvB) for transactions to be included in block creation. (default: %s)", CURRENCY_UNIT, FormatMoney(DEFAULT_BLOCK_MIN_TX_FEE)), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockversion=<n>", "Override block version to test forking scenarios", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::BLOCK_CREATION);
 
@@ -743,6 +866,8 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-rpcdoccheck", strprintf("Throw a non-fatal error at runtime if the documentation for an RPC is incorrect (default: %u)", DEFAULT_RPC_DOC_CHECK), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
     argsman.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpccookieperms=<readable-by>", strprintf("Set permissions on the RPC auth cookie file so that it is readable by [owner|group|all] (default: owner [via umask 0077])"), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcmaxlogs=<n>", strprintf("Maximum number of logs eth_getLogs returns for a range of blocks, 0 for no limit (default: %d)", DEFAULT_ETH_MAX_LOGS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcmethodclass=<method>:<class>", "Serve an RPC method from the work queue of <class> (default, mining, wallet or heavy) instead of its built-in one. This option can be specified multiple times", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
     argsman.AddArg("-rpcport=<port>", strprintf("Listen for JSON-RPC connections on <port> (default: %u, testnet3: %u, testnet4: %u, signet: %u, regtest: %u)", defaultBaseParams->RPCPort(), testnetBaseParams->RPCPort(), testnet4BaseParams->RPCPort(), signetBaseParams->RPCPort(), regtestBaseParams->RPCPort()), ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::RPC);
     argsman.AddArg("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
@@ -750,8 +875,14 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-rpcuser=<user>", "Username for JSON-RPC connections", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
     argsman.AddArg("-rpcwhitelist=<whitelist>", "Set a whitelist to filter incoming RPC calls for a specific user. The field <whitelist> comes in the format: <USERNAME>:<rpc 1>,<rpc 2>,...,<rpc n>. If multiple whitelists are set for a given user, they are set-intersected. See -rpcwhitelistdefault documentation for information on default whitelist behavior.", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcwhitelistdefault", "Sets default behavior for rpc whitelisting. Unless rpcwhitelistdefault is set to 0, if any -rpcwhitelist is set, the rpc server acts as if all rpc users are subject to empty-unless-otherwise-specified whitelists. If rpcwhitelistdefault is set to 1 and no -rpcwhitelist is set, rpc server acts as if all rpc users are subject to empty whitelists.", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcworkclass=<class>:<threads>:<depth>[:<deadline>]", strprintf("Set the worker threads, maximum queue depth and optional queue deadline in milliseconds of an RPC work queue class, so slow calls cannot delay calls of another class. Classes are mining (block templates and submission, default: %s), wallet (wallet endpoints, default: %s), heavy (index scans, log searches and contract calls, default: %s) and default (everything else, sized by -rpcthreads and -rpcworkqueue). A class with 0 threads is served by the default queue. Requests rejected for depth or deadline get HTTP 503 with Retry-After. This option can be specified multiple times",
+        HTTPWorkClassLimitsString(HTTPWorkClass::MINING), HTTPWorkClassLimitsString(HTTPWorkClass::WALLET), HTTPWorkClassLimitsString(HTTPWorkClass::HEAVY)), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcworkqueue=<n>", strprintf("Set the maximum depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
     argsman.AddArg("-server", "Accept command line and JSON-RPC commands", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-ws", strprintf("Also serve JSON-RPC over WebSocket, with eth_subscribe, when -server is set (default: %u)", DEFAULT_WS_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-wsbind=<addr>[:port]", "Bind to given address to listen for WebSocket JSON-RPC connections. Like -rpcbind, this option is ignored unless -rpcallowip is also passed. Port is optional and overrides -wsport. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost)", ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::RPC);
+    argsman.AddArg("-wsport=<port>", strprintf("Listen for WebSocket JSON-RPC connections on <port> (default: %u)", DEFAULT_WS_PORT), ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::RPC);
+    argsman.AddArg("-wsthreads=<n>", strprintf("Set the number of threads to service WebSocket RPC calls (default: %d)", DEFAULT_WS_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     if (can_listen_ipc) {
         argsman.AddArg("-ipcbind=<address>", "Bind to Unix socket address and listen for incoming connections. Valid address values are \"unix\" to listen on the default path, <datadir>/node.sock, or \"unix:/custom/path\" to specify a custom path. Can be specified multiple times to listen on multiple paths. Default behavior is not to listen on any path. If relative paths are specified, they are interpreted relative to the network data directory. If paths include any parent directory components and the parent directories do not exist, they will be created.", ArgsManager::ALLOW_ANY, OptionsCategory::IPC);
     }
@@ -1061,6 +1192,8 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     std::string blockfilterindex_value = args.GetArg("-blockfilterindex", DEFAULT_BLOCKFILTERINDEX);
     if (blockfilterindex_value == "" || blockfilterindex_value == "1") {
         g_enabled_filter_types = AllBlockFilterTypes();
+        // The EVM log filters are built from the receipts that -logevents keeps
+        if (!args.GetBoolArg("-logevents", DEFAULT_LOGEVENTS)) g_enabled_filter_types.erase(BlockFilterType::EVM_LOG);
     } else if (blockfilterindex_value != "0") {
         const std::vector<std::string> names = args.GetArgs("-blockfilterindex");
         for (const auto& name : names) {
@@ -1070,6 +1203,9 @@ bool AppInitParameterInteraction(const ArgsManager& args)
             }
             g_enabled_filter_types.insert(filter_type);
         }
+        if (g_enabled_filter_types.count(BlockFilterType::EVM_LOG) && !args.GetBoolArg("-logevents", DEFAULT_LOGEVENTS)) {
+            return InitError(_("The evmlog block filter index requires -logevents."));
+        }
     }
 
     // Signal NODE_P2P_V2 if BIP324 v2 transport is enabled.
@@ -1120,8 +1256,8 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     if (user_max_connection < 0) {
         return InitError(Untranslated("-maxconnections must be greater or equal than zero"));
     }
-    // Reserve enough FDs to account for the bare minimum, plus any manual connections, plus the bound interfaces
-    int min_required_fds = MIN_CORE_FDS + MAX_ADDNODE_CONNECTIONS + nBind;
+    // Reserve enough FDs to account for the bare minimum, plus any manual and validator connections, plus the bound interfaces
+    int min_required_fds = MIN_CORE_FDS + MAX_ADDNODE_CONNECTIONS + MAX_VALIDATOR_RELAY_CONNECTIONS + nBind;
 
     // Try raising the FD limit to what we need (available_fds may be smaller than the requested amount if this fails)
     available_fds = RaiseFileDescriptorLimit(user_max_connection + min_required_fds);
@@ -1178,6 +1314,11 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     }
 
     nBytesPerSigOp = args.GetIntArg("-bytespersigop", nBytesPerSigOp);
+    nEvmCacheSize = std::clamp<int64_t>(args.GetIntArg("-evmcachesize", DEFAULT_EVM_CACHE_SIZE), 0, 1 << 20) << 20;
+    nEvmPrefetchThreads = std::clamp<int64_t>(args.GetIntArg("-evmprefetchthreads", DEFAULT_EVM_PREFETCH_THREADS), 0, MAX_EVM_PREFETCH_THREADS);
+    if (const int64_t prune_state = args.GetIntArg("-prunestate", DEFAULT_PRUNE_STATE); prune_state < 0 || (prune_state > 0 && prune_state < MIN_BLOCKS_TO_KEEP)) {
+        return InitError(strprintf(_("-prunestate must be 0 or at least %d blocks"), MIN_BLOCKS_TO_KEEP));
+    }
 
     if (!g_wallet_init_interface.ParameterInteraction()) return false;
 
@@ -1548,6 +1689,7 @@ bool CheckHostPortOptions(const ArgsManager& args) {
     for (const std::string port_option : {
         "-port",
         "-rpcport",
+        "-wsport",
     }) {
         if (args.IsArgSet(port_option)) {
             const std::string port = args.GetArg(port_option, "");
@@ -1566,11 +1708,15 @@ bool CheckHostPortOptions(const ArgsManager& args) {
         {"-rpcbind",                false},
         {"-torcontrol",             false},
         {"-whitebind",              false},
+        {"-wsbind",                 false},
         {"-zmqpubhashblock",        true},
         {"-zmqpubhashtx",           true},
         {"-zmqpubrawblock",         true},
         {"-zmqpubrawtx",            true},
         {"-zmqpubsequence",         true},
+        {"-zmqpubrawlogs",          true},
+        {"-zmqpubstake",            true},
+        {"-zmqpubkeyimage",         true},
     }) {
         for (const std::string& socket_addr : args.GetArgs(arg)) {
             std::string host_out;
@@ -1688,7 +1834,6 @@ static ChainstateLoadResult InitAndLoadChainstate(
         options.getting_values_dgp = false;
     }
     options.record_log_opcodes = args.IsArgSet("-record-log-opcodes");
-    options.addrindex = args.GetBoolArg("-addrindex", DEFAULT_ADDRINDEX);
     options.logevents = args.GetBoolArg("-logevents", DEFAULT_LOGEVENTS);
     uiInterface.InitMessage(_("Loading block index…"));
     auto catch_exceptions = [](auto&& f) -> ChainstateLoadResult {
@@ -1773,6 +1918,15 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         }
     }, std::chrono::minutes{5});
 
+    // Compact small databases once they have gone quiet after a block, so
+    // LevelDB's own compactions do not compete with the next block's writes.
+    scheduler.scheduleEvery([]{
+        constexpr auto quiet{std::chrono::seconds{45}};
+        constexpr int min_level0_files{2};
+        constexpr uint64_t max_bytes{64 << 20}; // 64 MB
+        CompactIdleDB(quiet, min_level0_files, max_bytes);
+    }, std::chrono::minutes{1});
+
     if (args.GetBoolArg("-logratelimit", BCLog::DEFAULT_LOGRATELIMIT)) {
         LogInstance().SetRateLimiting(BCLog::LogRateLimiter::Create(
             [&scheduler](auto func, auto window) { scheduler.scheduleEvery(std::move(func), window); },
@@ -2049,7 +2203,8 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         [&chainman = node.chainman](std::vector<uint8_t>& block, const CBlockIndex& index) {
             assert(chainman);
             return chainman->m_blockman.ReadRawBlock(block, WITH_LOCK(cs_main, return index.GetBlockPos()));
-        });
+        },
+        ZMQBlockDataSources(node));
 
     if (g_zmq_notification_interface) {
         validation_signals.RegisterValidationInterface(g_zmq_notification_interface.get());
@@ -2058,10 +2213,21 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
 
     // ********************************************************* Step 7: load block chain
 
+    // Build the RandomX verification cache while the chainstate loads, so the
+    // first header checks do not pay for it
+    node::GetRandomXVerifier().SetConsensusSeed(chainparams.GetConsensus().hashGenesisBlock);
+    node::GetRandomXVerifier().Prewarm(chainparams.GetConsensus().hashGenesisBlock);
+
+    // Ethash epoch caches are kept on disk so restarts do not rebuild them
+    x25x::GetEthashCache().SetDirectory(args.GetDataDirNet() / "ethash");
+
     node.notifications = std::make_unique<KernelNotifications>(Assert(node.shutdown_request), node.exit_status, *Assert(node.warnings));
     auto& kernel_notifications{*node.notifications};
     ReadNotificationArgs(args, kernel_notifications);
 
+    // The mempool keeps its own address records alongside the address index
+    fAddressIndex = args.GetBoolArg("-addrindex", DEFAULT_ADDRINDEX);
+
     // cache size calculations
     const auto [index_cache_sizes, kernel_cache_sizes] = CalculateCacheSizes(args, g_enabled_filter_types.size());
 
@@ -2074,6 +2240,12 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         LogInfo("* Using %.1f MiB for %s block filter index database",
                   index_cache_sizes.filter_index * (1.0 / 1024 / 1024), BlockFilterTypeName(filter_type));
     }
+    if (args.GetBoolArg("-addrindex", DEFAULT_ADDRINDEX)) {
+        LogInfo("* Using %.1f MiB for address index database", index_cache_sizes.address_index * (1.0 / 1024 / 1024));
+    }
+    LogInfo("* Using %.1f MiB for FCMP curve tree and key image databases", index_cache_sizes.curve_tree * (1.0 / 1024 / 1024));
+    LogInfo("* Using %.1f MiB shared by the validator, delegation, messaging and bridge databases", index_cache_sizes.shared_db * (1.0 / 1024 / 1024));
+    SetSharedDBCacheSize(index_cache_sizes.shared_db);
     LogInfo("* Using %.1f MiB for chain state database", kernel_cache_sizes.coins_db * (1.0 / 1024 / 1024));
 
     assert(!node.mempool);
@@ -2122,6 +2294,11 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
 
     ChainstateManager& chainman = *Assert(node.chainman);
 
+    // Paused until the first new tip outside IBD
+    if (nEvmPrefetchThreads > 0) {
+        g_mempool_evm_warmer = std::make_unique<MempoolEvmWarmer>();
+    }
+
     assert(!node.peerman);
     node.peerman = PeerManager::make(*node.connman, *node.addrman,
                                      node.banman.get(), chainman,
@@ -2146,35 +2323,59 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         node.indexes.emplace_back(g_coin_stats_index.get());
     }
 
+    if (args.GetBoolArg("-anchorindex", DEFAULT_ANCHORINDEX)) {
+        g_anchorindex = std::make_unique<AnchorIndex>(interfaces::MakeChain(node), /*cache_size=*/0, false, do_reindex);
+        node.indexes.emplace_back(g_anchorindex.get());
+    }
+
+    if (args.GetBoolArg("-explorerindex", DEFAULT_EXPLORERINDEX)) {
+        g_explorerindex = std::make_unique<ExplorerIndex>(interfaces::MakeChain(node), /*cache_size=*/0, false, do_reindex);
+        node.indexes.emplace_back(g_explorerindex.get());
+    }
+
+    if (fAddressIndex) {
+        g_addressindex = std::make_unique<AddressIndex>(interfaces::MakeChain(node), index_cache_sizes.address_index, false, do_reindex);
+        node.indexes.emplace_back(g_addressindex.get());
+    }
+
     // Init indexes
     for (auto index : node.indexes) if (!index->Init()) return false;
 
-    // ********************************************************* Step 8b: initialize validator and delegation databases
-    LogPrintf("Initializing validator and delegation databases...\n");
-    validators::InitValidatorDB(chainparams.GetConsensus(), args.GetDataDirNet());
-    validators::InitDelegationDB(chainparams.GetConsensus(), args.GetDataDirNet());
-
-    // ********************************************************* Step 8c: initialize trust system
-    LogPrintf("Initializing trust system...\n");
-    static trust::TrustScoreManager trust_manager(chainparams.GetConsensus());
-    trust::InitHeartbeatManager(trust_manager, chainparams.GetConsensus());
+    // ********************************************************* Step 8b: initialize validator, trust and privacy state
+    if (auto res{node::InitWattxState(chainman, args.GetDataDirNet(), {
+            .curve_tree_cache = index_cache_sizes.curve_tree,
+            .heartbeat_threads = std::clamp(chainman.m_options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS),
+        })}; !res) {
+        return InitError(util::ErrorString(res));
+    }
     trust::InitPeerDiscovery(fs::PathToString(args.GetDataDirNet()));
 
-    // ********************************************************* Step 8d: initialize privacy subsystem
+    // Match eth_newFilter filters against the blocks as they connect
+    node::InitializeEthFilters(&validation_signals);
+
+    // Delete the contract state older blocks left behind
+    if (const int prune_state = args.GetIntArg("-prunestate", DEFAULT_PRUNE_STATE); prune_state > 0) {
+        StartStatePruner(chainman, prune_state);
+    }
+
+    // Serve eth_subscribe, its notifications come from the validation signals
+    if (args.GetBoolArg("-server", false) && args.GetBoolArg("-ws", DEFAULT_WS_ENABLE)) {
+        if (!StartWSRPC(&node, &validation_signals)) {
+            return InitError(_("Unable to start WebSocket RPC server. See debug log for details."));
+        }
+    }
+
+    // ********************************************************* Step 8c: initialize privacy decoy provider
     LogPrintf("Initializing privacy subsystem...\n");
-    if (!node::InitializeDecoyProvider(chainman, args.GetDataDirNet())) {
+    if (!node::InitializeDecoyProvider(chainman, args.GetDataDirNet(), &validation_signals)) {
         LogPrintf("Warning: Privacy decoy provider initialization failed\n");
         // Not fatal - privacy features will be unavailable
     }
-    if (!privacy::InitializeKeyImageDB(args.GetDataDirNet())) {
-        LogPrintf("Warning: Key image database initialization failed\n");
-        // Not fatal - privacy features will be unavailable
-    }
 
-    // Initialize FCMP consensus state (curve tree, key image tracking)
-    if (!privacy::InitializeFcmpConsensus(args.GetDataDirNet())) {
-        LogPrintf("Warning: FCMP consensus initialization failed\n");
-        // Not fatal - FCMP features will be unavailable until activated
+    // ********************************************************* Step 8d: rebuild coinstake UTXO tracker
+    {
+        LOCK(cs_main);
+        GetCoinstakeTracker().Rebuild(chainman.ActiveChain().Tip(), chainman.m_blockman);
     }
 
     // ********************************************************* Step 9: load wallet
@@ -2339,6 +2540,7 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
     connOptions.nSendBufferMaxSize = 1000 * args.GetIntArg("-maxsendbuffer", DEFAULT_MAXSENDBUFFER);
     connOptions.nReceiveFloodSize = 1000 * args.GetIntArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
     connOptions.m_added_nodes = args.GetArgs("-addnode");
+    connOptions.m_max_validator_relay = std::clamp<int64_t>(args.GetIntArg("-maxvalidatorconnections", MAX_VALIDATOR_RELAY_CONNECTIONS), 0, MAX_VALIDATOR_RELAY_CONNECTIONS);
     connOptions.nMaxOutboundLimit = *opt_max_upload;
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
     connOptions.whitelist_forcerelay = args.GetBoolArg("-whitelistforcerelay", DEFAULT_WHITELISTFORCERELAY);
@@ -2493,7 +2695,10 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
     SetRPCWarmupFinished();
 
     // Initialize P2P encrypted messaging
-    messaging::InitMessageManager();
+    messaging::InitMessageManager(args.GetDataDirNet() / "messages");
+    scheduler.scheduleEvery([]{
+        if (messaging::g_message_manager) messaging::g_message_manager->CleanupExpired();
+    }, std::chrono::minutes{10});
 
     uiInterface.InitMessage(_("Done loading"));
 
@@ -40,6 +40,7 @@ void AddLoggingArgs(ArgsManager& argsman)
     argsman.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-loglevelalways", strprintf("Always prepend a category and level (default: %u)", DEFAULT_LOGLEVELALWAYS), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-logratelimit", strprintf("Apply rate limiting to unconditional logging to mitigate disk-filling attacks (default: %u)", BCLog::DEFAULT_LOGRATELIMIT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-logasync", strprintf("Write the log from a background thread so logging never waits for the disk. Lines that do not fit in the queue of their thread (%u lines) are dropped and counted, and the rate limits apply to debug logging too (default: %u)", BCLog::ASYNC_LOG_RING_SIZE, BCLog::DEFAULT_LOGASYNC), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-printtoconsole", "Send trace/debug info to console (default: 1 when no -daemon. To disable logging to file, set -nodebuglogfile)", ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-shrinkdebugfile", "Shrink debug.log file on client startup (default: 1 when no -debug)", ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
 }
@@ -121,6 +122,9 @@ bool StartLogging(const ArgsManager& args)
             return InitError(Untranslated(strprintf("Could not open debug log file %s",
                 fs::PathToString(LogInstance().m_file_path))));
     }
+    if (args.GetBoolArg("-logasync", BCLog::DEFAULT_LOGASYNC)) {
+        LogInstance().StartAsyncLogging();
+    }
 
 ////////////////////////////////////////////////////////////////////// // qtum
     dev::g_logPost(std::string("\n\n\n\n\n\n\n\n\n\n"), NULL);
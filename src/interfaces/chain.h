@@ -8,6 +8,7 @@
 #include <blockfilter.h>
 #include <common/settings.h>
 #include <primitives/transaction.h> // For CTransactionRef
+#include <uint256.h>
 #include <util/result.h>
 #include <netbase.h>                // For ConnectionDirection
 
@@ -108,6 +109,14 @@ struct BlockInfo {
     BlockInfo(const uint256& hash LIFETIMEBOUND) : hash(hash) {}
 };
 
+//! Event log of a contract call, from the transaction receipts kept with -logevents.
+struct ContractLog {
+    uint256 tx_hash;
+    uint160 address;
+    std::vector<uint256> topics;
+    std::vector<unsigned char> data;
+};
+
 //! The action to be taken after updating a settings value.
 //! WRITE indicates that the updated value must be written to disk,
 //! while SKIP_WRITE indicates that the change will be kept in memory-only
@@ -451,6 +460,9 @@ public:
     //! refresh delegates.
     virtual void refreshDelegates(wallet::CWallet *pwallet, bool myDelegates, bool stakerDelegates) = 0;
 
+    //! refresh the delegations weight snapshot.
+    virtual void refreshDelegationsWeight(wallet::CWallet& wallet) = 0;
+
     //! get contract RPC commands.
     virtual Span<const CRPCCommand> getContractRPCCommands() = 0;
 
@@ -463,6 +475,10 @@ public:
 
     //! verify delegation for an address.
     virtual bool verifyDelegation(const uint160& address, const Delegation& delegation) = 0;
+
+    //! Get the contract event logs of a connected block, in block order.
+    //! Returns false if transaction receipts are not kept (-logevents).
+    virtual bool getBlockContractLogs(const CBlock& block, std::vector<ContractLog>& logs) = 0;
 };
 
 //! Interface to let node manage chain clients (wallets, or maybe tools for
@@ -347,6 +347,12 @@ public:
     //! Check if token transaction is mine
     virtual bool isTokenTxMine(const TokenTx &wtx) = 0;
 
+    //! Get the balance of a token kept current from the blocks, if it has been seeded.
+    virtual bool getTokenBalance(const uint256& id, uint256& balance) = 0;
+
+    //! Seed the balance of a token, read at a block, for the wallet to keep current.
+    virtual bool setTokenBalance(const uint256& id, const uint256& balance, const uint256& block_hash) = 0;
+
     //! Get contract book data.
     virtual ContractBookData getContractBook(const std::string& address) = 0;
 
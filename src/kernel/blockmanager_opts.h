@@ -16,6 +16,8 @@ class CChainParams;
 namespace kernel {
 
 static constexpr bool DEFAULT_XOR_BLOCKSDIR{true};
+static constexpr bool DEFAULT_CHECKPOWONLOAD{false};
+static constexpr bool DEFAULT_BLOCKSMMAP{false};
 
 /**
  * An options struct for `BlockManager`, more ergonomically referred to as
@@ -24,8 +26,12 @@ static constexpr bool DEFAULT_XOR_BLOCKSDIR{true};
 struct BlockManagerOpts {
     const CChainParams& chainparams;
     bool use_xor{DEFAULT_XOR_BLOCKSDIR};
+    //! Read finalized block files through read-only memory mappings
+    bool use_mmap{DEFAULT_BLOCKSMMAP};
     uint64_t prune_target{0};
     bool fast_prune{false};
+    //! Re-verify the proof of work of every block index entry on load, ignoring BLOCK_POW_CHECKED
+    bool check_pow_on_load{DEFAULT_CHECKPOWONLOAD};
     const fs::path blocks_dir;
     Notifications& notifications;
     DBParams block_tree_db_params;
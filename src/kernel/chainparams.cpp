@@ -918,6 +918,9 @@ public:
         consensus.nFcmpActivationHeight = 1;
         consensus.nFcmpMaturity = 10;
 
+        // Key images unique within a block - active from genesis for regtest
+        consensus.nPrivacyKeyImageUniqueHeight = 0;
+
         // WATTx regtest addresses start with 'w' (base58 prefix 135)
         base58Prefixes[PUBKEY_ADDRESS] = std::vector<unsigned char>(1,135);
         base58Prefixes[SCRIPT_ADDRESS] = std::vector<unsigned char>(1,137);
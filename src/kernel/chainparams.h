@@ -63,6 +63,14 @@ struct AssumeutxoData {
     //! The hash of the base block for this snapshot. Used to refer to assumeutxo data
     //! prior to having a loaded blockindex.
     uint256 blockhash;
+
+    //! The expected hashes of the WATTx state written after the coins, see
+    //! node::SnapshotPrivacyState. The contract state is also checked against
+    //! the state roots of the base block, so a null hash skips only this check.
+    //! A null curve tree or key image hash expects an empty section.
+    uint256 hash_contract_state{};
+    uint256 hash_curve_tree{};
+    uint256 hash_key_images{};
 };
 
 /**
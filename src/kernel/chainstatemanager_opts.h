@@ -23,6 +23,8 @@ class ValidationSignals;
 
 static constexpr bool DEFAULT_CHECKPOINTS_ENABLED{true};
 static constexpr auto DEFAULT_MAX_TIP_AGE{12h}; //Changed to 12 hours so that isInitialBlockDownload() is more accurate
+//! Privacy proof cache size; an entry is 32 bytes, so this holds ~130k transactions
+static constexpr size_t DEFAULT_PRIVACY_PROOF_CACHE_BYTES{4 << 20};
 
 namespace kernel {
 
@@ -44,12 +46,15 @@ struct ChainstateManagerOpts {
     std::chrono::seconds max_tip_age{DEFAULT_MAX_TIP_AGE};
     DBOptions coins_db{};
     CoinsViewOptions coins_view{};
+    //! Keep the coins tip cache in chunks from LargePageAllocator.
+    bool coins_large_pages{false};
     Notifications& notifications;
     ValidationSignals* signals{nullptr};
     //! Number of script check worker threads. Zero means no parallel verification.
     int worker_threads_num{0};
     size_t script_execution_cache_bytes{DEFAULT_SCRIPT_EXECUTION_CACHE_BYTES};
     size_t signature_cache_bytes{DEFAULT_SIGNATURE_CACHE_BYTES};
+    size_t privacy_proof_cache_bytes{DEFAULT_PRIVACY_PROOF_CACHE_BYTES};
 };
 
 } // namespace kernel
@@ -67,6 +67,27 @@ struct CCoinsStats {
     //! Total cumulative amount of coins lost due to unclaimed miner rewards up to and including this block
     CAmount total_unspendables_unclaimed_rewards{0};
 
+    //! MuHash of the coins held by contracts (OP_CREATE and OP_CALL outputs)
+    uint256 contract_muhash{};
+    //! The number of coins held by contracts
+    uint64_t contract_output_count{0};
+    //! The amount held by contracts, included in total_amount
+    CAmount total_contract_amount{0};
+    //! Total cumulative number of privacy transactions up to and including this block
+    uint64_t privacy_tx_count{0};
+    //! Total cumulative number of stealth and confidential outputs created up to and including this block
+    uint64_t privacy_shielded_output_count{0};
+    //! Total cumulative number of ring input key images spent up to and including this block
+    uint64_t privacy_key_image_count{0};
+    //! Total cumulative number of FCMP inputs spent up to and including this block
+    uint64_t privacy_fcmp_input_count{0};
+    //! Total cumulative amount of prevouts spent by privacy transactions up to and including this block
+    CAmount total_privacy_value_in{0};
+    //! Total cumulative amount of spendable outputs created by privacy transactions up to and including this block
+    CAmount total_privacy_value_out{0};
+    //! Total cumulative amount of explicit privacy transaction fees up to and including this block
+    CAmount total_privacy_fees{0};
+
     CCoinsStats() = default;
     CCoinsStats(int block_height, const uint256& block_hash);
 };
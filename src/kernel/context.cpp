@@ -5,6 +5,7 @@
 #include <kernel/context.h>
 
 #include <crypto/sha256.h>
+#include <crypto/sha3.h>
 #include <logging.h>
 #include <random.h>
 
@@ -18,6 +19,8 @@ Context::Context()
     std::call_once(globals_initialized, []() {
         std::string sha256_algo = SHA256AutoDetect();
         LogInfo("Using the '%s' SHA256 implementation\n", sha256_algo);
+        std::string sha3_algo = SHA3AutoDetect();
+        LogInfo("Using the '%s' Keccak implementation\n", sha3_algo);
         RandomInit();
     });
 }
@@ -11,6 +11,7 @@
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <uint256.h>
 #include <util/epochguard.h>
 #include <util/overflow.h>
 
@@ -62,6 +63,18 @@ struct CompareIteratorByHash {
  *
  */
 
+struct CachedQtumTX;
+
+/** Contract gas of a mempool transaction, summarized on acceptance. */
+struct MempoolGasSummary {
+    //! Sum of the gas limits of the contract outputs, 0 for non-contract txs
+    uint64_t gas_limit{0};
+    //! The minimum gas price among the contract outputs, the price all of its gas is paid at
+    CAmount min_gas_price{0};
+    //! Key hash the contract outputs execute as
+    uint160 sender;
+};
+
 class CTxMemPoolEntry
 {
 public:
@@ -89,7 +102,8 @@ private:
     const int64_t sigOpCost;        //!< Total sigop cost
     CAmount m_modified_fee;         //!< Used for determining the priority of the transaction for mining in a block
     mutable LockPoints lockPoints;  //!< Track the height and time at which tx was final
-    CAmount nMinGasPrice{0};        //!< The minimum gas price among the contract outputs of the tx
+    const MempoolGasSummary m_gas;  //!< Contract gas of the tx
+    std::shared_ptr<const CachedQtumTX> m_qtum_tx; //!< Contract transactions extracted on acceptance, if any
 
     // Information about descendants of this transaction that are in the
     // mempool; if we remove this transaction we must remove all of these
@@ -110,7 +124,8 @@ public:
     CTxMemPoolEntry(const CTransactionRef& tx, CAmount fee,
                     int64_t time, unsigned int entry_height, uint64_t entry_sequence,
                     bool spends_coinbase,
-                    int64_t sigops_cost, LockPoints lp, CAmount min_gas_price = 0)
+                    int64_t sigops_cost, LockPoints lp, MempoolGasSummary gas = {},
+                    std::shared_ptr<const CachedQtumTX> qtum_tx = nullptr)
         : tx{tx},
           nFee{fee},
           nTxWeight{GetTransactionWeight(*tx)},
@@ -122,7 +137,8 @@ public:
           sigOpCost{sigops_cost},
           m_modified_fee{nFee},
           lockPoints{lp},
-          nMinGasPrice{min_gas_price},
+          m_gas{gas},
+          m_qtum_tx{std::move(qtum_tx)},
           nSizeWithDescendants{GetTxSize()},
           nModFeesWithDescendants{nFee},
           nSizeWithAncestors{GetTxSize()},
@@ -151,7 +167,10 @@ public:
     CAmount GetModifiedFee() const { return m_modified_fee; }
     size_t DynamicMemoryUsage() const { return nUsageSize; }
     const LockPoints& GetLockPoints() const { return lockPoints; }
-    const CAmount& GetMinGasPrice() const { return nMinGasPrice; }
+    const CAmount& GetMinGasPrice() const { return m_gas.min_gas_price; }
+    uint64_t GetGasLimit() const { return m_gas.gas_limit; }
+    const MempoolGasSummary& GetGasSummary() const { return m_gas; }
+    const std::shared_ptr<const CachedQtumTX>& GetQtumTX() const { return m_qtum_tx; }
 
     // Adjusts the descendant state.
     void UpdateDescendantState(int32_t modifySize, CAmount modifyFee, int64_t modifyCount);
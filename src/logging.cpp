@@ -11,6 +11,7 @@
 #include <util/threadnames.h>
 #include <util/time.h>
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <map>
@@ -47,6 +48,66 @@ BCLog::Logger& LogInstance()
 
 bool fLogIPs = DEFAULT_LOGIPS;
 
+namespace BCLog {
+struct AsyncLogRecord {
+    uint64_t seq;
+    std::string str;
+    std::source_location source_loc;
+    bool useVMLog;
+    std::string vmFunction;
+};
+
+/** Single producer, single consumer ring of the lines of one logging thread */
+class AsyncLogRing
+{
+    std::vector<AsyncLogRecord> m_slots;
+    alignas(64) std::atomic<size_t> m_head{0}; //!< next slot to write, only moved by the logging thread
+    alignas(64) std::atomic<size_t> m_tail{0}; //!< next slot to read, only moved by the writer
+
+public:
+    //! Set when the logging thread exits, the ring is released once drained
+    std::atomic<bool> m_orphaned{false};
+
+    explicit AsyncLogRing(size_t size) : m_slots(size) {}
+
+    bool Push(AsyncLogRecord&& record)
+    {
+        const size_t head{m_head.load(std::memory_order_relaxed)};
+        if (head - m_tail.load(std::memory_order_acquire) == m_slots.size()) return false;
+        m_slots[head % m_slots.size()] = std::move(record);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void Drain(std::vector<AsyncLogRecord>& out)
+    {
+        size_t tail{m_tail.load(std::memory_order_relaxed)};
+        const size_t head{m_head.load(std::memory_order_acquire)};
+        for (; tail != head; ++tail) {
+            out.push_back(std::move(m_slots[tail % m_slots.size()]));
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    bool Empty() const { return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire); }
+};
+} // namespace BCLog
+
+namespace {
+//! The async ring of the current thread, tied to one StartAsyncLogging() call
+struct ThreadLogRing {
+    std::shared_ptr<BCLog::AsyncLogRing> ring;
+    uint64_t generation{0};
+
+    ~ThreadLogRing()
+    {
+        if (ring) ring->m_orphaned = true;
+    }
+};
+thread_local ThreadLogRing g_thread_log_ring;
+std::atomic<uint64_t> g_async_log_generation{0};
+} // namespace
+
 static int FileWriteStr(std::string_view str, FILE *fp)
 {
     return fwrite(str.data(), 1, str.size(), fp);
@@ -105,6 +166,7 @@ bool BCLog::Logger::StartLogging()
 
 void BCLog::Logger::DisconnectTestLogger()
 {
+    StopAsyncLogging();
     StdLockGuard scoped_lock(m_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
@@ -438,8 +500,112 @@ void BCLog::Logger::FormatLogStrInPlace(std::string& str, BCLog::LogFlags catego
     str.insert(0, LogTimestampStr(now, mocktime));
 }
 
+void BCLog::Logger::StartAsyncLogging(size_t ring_size)
+{
+    assert(ring_size > 0);
+    StdLockGuard scoped_lock(m_async_mutex);
+    if (m_async_writer.joinable()) return;
+    m_async_ring_size = ring_size;
+    m_async_stop = false;
+    m_async_rings.clear();
+    m_async_generation = ++g_async_log_generation;
+    m_async_writer = std::thread(&Logger::AsyncWriterThread, this);
+    m_async = true;
+}
+
+void BCLog::Logger::StopAsyncLogging()
+{
+    if (!m_async.exchange(false)) return;
+    // Lines queued by threads that saw async mode still on must be written
+    // by the last drain of the writer.
+    while (m_async_users > 0) std::this_thread::yield();
+    {
+        StdLockGuard scoped_lock(m_async_mutex);
+        m_async_stop = true;
+    }
+    m_async_cv.notify_one();
+    m_async_writer.join();
+    StdLockGuard scoped_lock(m_async_mutex);
+    m_async_rings.clear();
+}
+
+BCLog::AsyncLogRing* BCLog::Logger::GetAsyncRing()
+{
+    const uint64_t generation{m_async_generation.load()};
+    if (g_thread_log_ring.ring && g_thread_log_ring.generation == generation) {
+        return g_thread_log_ring.ring.get();
+    }
+    auto ring{std::make_shared<AsyncLogRing>(m_async_ring_size)};
+    {
+        StdLockGuard scoped_lock(m_async_mutex);
+        m_async_rings.push_back(ring);
+    }
+    if (g_thread_log_ring.ring) g_thread_log_ring.ring->m_orphaned = true;
+    g_thread_log_ring.ring = ring;
+    g_thread_log_ring.generation = generation;
+    return ring.get();
+}
+
+bool BCLog::Logger::LogPrintAsync(std::string_view str, const std::source_location& source_loc, BCLog::LogFlags category, BCLog::Level level, bool useVMLog, const std::string& vmFunction)
+{
+    ++m_async_users;
+    if (!m_async) {
+        --m_async_users;
+        return false;
+    }
+    std::string str_prefixed{LogEscapeMessage(str)};
+    FormatLogStrInPlace(str_prefixed, category, level, source_loc, util::ThreadGetInternalName(), SystemClock::now(), GetMockTime(), useVMLog, vmFunction);
+    AsyncLogRecord record{
+        .seq = m_async_seq++,
+        .str = std::move(str_prefixed),
+        .source_loc = source_loc,
+        .useVMLog = useVMLog,
+        .vmFunction = useVMLog ? vmFunction : std::string{},
+    };
+    if (!GetAsyncRing()->Push(std::move(record))) {
+        ++m_async_dropped;
+        ++m_async_dropped_total;
+    }
+    --m_async_users;
+    return true;
+}
+
+void BCLog::Logger::AsyncWriterThread()
+{
+    util::ThreadRename("logwriter");
+    std::vector<std::shared_ptr<AsyncLogRing>> rings;
+    std::vector<AsyncLogRecord> records;
+    bool stop{false};
+    while (!stop) {
+        {
+            std::unique_lock<StdMutex> lock(m_async_mutex);
+            m_async_cv.wait_for(lock, ASYNC_LOG_INTERVAL, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_async_mutex) { return m_async_stop; });
+            stop = m_async_stop;
+            std::erase_if(m_async_rings, [](const auto& ring) { return ring->m_orphaned && ring->Empty(); });
+            rings = m_async_rings;
+        }
+
+        records.clear();
+        for (const auto& ring : rings) ring->Drain(records);
+        rings.clear();
+        // Interleave the lines of all threads in the order they were logged
+        std::sort(records.begin(), records.end(), [](const AsyncLogRecord& a, const AsyncLogRecord& b) { return a.seq < b.seq; });
+        const uint64_t dropped{m_async_dropped.exchange(0)};
+        if (records.empty() && dropped == 0) continue;
+
+        StdLockGuard scoped_lock(m_cs);
+        for (AsyncLogRecord& record : records) {
+            WriteLogStr_(record.str, record.source_loc, /*should_ratelimit=*/true, record.useVMLog, record.vmFunction);
+        }
+        if (dropped > 0) {
+            LogPrintStr_(strprintf("Async logging queue full, %d log lines dropped.", dropped), std::source_location::current(), LogFlags::ALL, Level::Warning, /*should_ratelimit=*/false, false);
+        }
+    }
+}
+
 void BCLog::Logger::LogPrintStr(std::string_view str, std::source_location&& source_loc, BCLog::LogFlags category, BCLog::Level level, bool should_ratelimit, bool useVMLog, const std::string& vmFunction)
 {
+    if (m_async && LogPrintAsync(str, source_loc, category, level, useVMLog, vmFunction)) return;
     StdLockGuard scoped_lock(m_cs);
     return LogPrintStr_(str, std::move(source_loc), category, level, should_ratelimit, useVMLog, vmFunction);
 }
@@ -480,6 +646,12 @@ void BCLog::Logger::LogPrintStr_(std::string_view str, std::source_location&& so
     }
 
     FormatLogStrInPlace(str_prefixed, category, level, source_loc, util::ThreadGetInternalName(), SystemClock::now(), GetMockTime(), useVMLog, vmFunction);
+    WriteLogStr_(str_prefixed, source_loc, should_ratelimit, useVMLog, vmFunction);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+void BCLog::Logger::WriteLogStr_(std::string& str_prefixed, const std::source_location& source_loc, bool should_ratelimit, bool useVMLog, const std::string& vmFunction)
+{
     bool ratelimit{false};
     if (should_ratelimit && m_limiter) {
         auto status{m_limiter->Consume(source_loc, str_prefixed)};
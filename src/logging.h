@@ -14,6 +14,7 @@
 #include <util/time.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -21,6 +22,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -135,6 +137,11 @@ namespace BCLog {
     constexpr uint64_t RATELIMIT_MAX_BYTES{1024 * 1024}; // maximum number of bytes per source location that can be logged within the RATELIMIT_WINDOW
     constexpr auto RATELIMIT_WINDOW{1h}; // time window after which log ratelimit stats are reset
     constexpr bool DEFAULT_LOGRATELIMIT{true};
+    constexpr bool DEFAULT_LOGASYNC{false};
+    constexpr size_t ASYNC_LOG_RING_SIZE{4096}; // lines queued per logging thread in async mode before lines are dropped
+    constexpr auto ASYNC_LOG_INTERVAL{10ms}; // how often the async writer looks for queued lines
+
+    class AsyncLogRing;
 
     //! Fixed window rate limiter for logging.
     class LogRateLimiter
@@ -245,8 +252,35 @@ namespace BCLog {
         void LogPrintStr_(std::string_view str, std::source_location&& source_loc, BCLog::LogFlags category, BCLog::Level level, bool should_ratelimit, bool useVMLog, const std::string& vmFunction = "")
             EXCLUSIVE_LOCKS_REQUIRED(m_cs);
 
+        /** Write a formatted line to the outputs, applying the rate limits (internal) */
+        void WriteLogStr_(std::string& str, const std::source_location& source_loc, bool should_ratelimit, bool useVMLog, const std::string& vmFunction)
+            EXCLUSIVE_LOCKS_REQUIRED(m_cs);
+
         std::string GetLogPrefix(LogFlags category, Level level) const;
 
+        //! Async mode: lines are formatted on the logging thread and queued
+        //! without locks, m_async_writer writes them out.
+        std::atomic<bool> m_async{false};
+        //! Logging threads between checking m_async and queueing their line
+        std::atomic<int> m_async_users{0};
+        std::atomic<uint64_t> m_async_generation{0};
+        std::atomic<uint64_t> m_async_seq{0};
+        std::atomic<uint64_t> m_async_dropped{0};
+        std::atomic<uint64_t> m_async_dropped_total{0};
+        size_t m_async_ring_size{ASYNC_LOG_RING_SIZE};
+        std::thread m_async_writer;
+        StdMutex m_async_mutex;
+        std::condition_variable_any m_async_cv;
+        bool m_async_stop GUARDED_BY(m_async_mutex){false};
+        std::vector<std::shared_ptr<AsyncLogRing>> m_async_rings GUARDED_BY(m_async_mutex);
+
+        /** The queue of the calling thread, nullptr if async mode is off */
+        AsyncLogRing* GetAsyncRing() EXCLUSIVE_LOCKS_REQUIRED(!m_async_mutex);
+        /** Queue a line in async mode, false if it has to be written synchronously */
+        bool LogPrintAsync(std::string_view str, const std::source_location& source_loc, BCLog::LogFlags category, BCLog::Level level, bool useVMLog, const std::string& vmFunction)
+            EXCLUSIVE_LOCKS_REQUIRED(!m_async_mutex);
+        void AsyncWriterThread() EXCLUSIVE_LOCKS_REQUIRED(!m_cs, !m_async_mutex);
+
     public:
         bool m_print_to_console = false;
         bool m_print_to_file = false;
@@ -264,7 +298,7 @@ namespace BCLog {
 
         /** Send a string to the log output */
         void LogPrintStr(std::string_view str, std::source_location&& source_loc, BCLog::LogFlags category, BCLog::Level level, bool should_ratelimit, bool useVMLog = false, const std::string& vmFunction = "")
-            EXCLUSIVE_LOCKS_REQUIRED(!m_cs);
+            EXCLUSIVE_LOCKS_REQUIRED(!m_cs, !m_async_mutex);
 
         /** Returns whether logs will be written to any output */
         bool Enabled() const EXCLUSIVE_LOCKS_REQUIRED(!m_cs)
@@ -291,7 +325,21 @@ namespace BCLog {
         /** Start logging (and flush all buffered messages) */
         bool StartLogging() EXCLUSIVE_LOCKS_REQUIRED(!m_cs);
         /** Only for testing */
-        void DisconnectTestLogger() EXCLUSIVE_LOCKS_REQUIRED(!m_cs);
+        void DisconnectTestLogger() EXCLUSIVE_LOCKS_REQUIRED(!m_cs, !m_async_mutex);
+
+        /**
+         * Write the log from a background thread. Logging threads format their
+         * lines and queue them in a ring buffer of their own without taking a
+         * lock. A line that does not fit is dropped and counted, and the rate
+         * limiter is applied to every call site, not only to unconditional
+         * logging. Must be called after StartLogging().
+         */
+        void StartAsyncLogging(size_t ring_size = ASYNC_LOG_RING_SIZE) EXCLUSIVE_LOCKS_REQUIRED(!m_async_mutex);
+        /** Write out the queued lines and go back to logging synchronously */
+        void StopAsyncLogging() EXCLUSIVE_LOCKS_REQUIRED(!m_cs, !m_async_mutex);
+        bool AsyncLogging() const { return m_async; }
+        /** Lines dropped because the queue of their thread was full */
+        uint64_t AsyncDroppedLines() const { return m_async_dropped_total; }
 
         void SetRateLimiting(std::shared_ptr<LogRateLimiter> limiter) EXCLUSIVE_LOCKS_REQUIRED(!m_cs)
         {
@@ -3,11 +3,14 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <messaging/encryptedmsg.h>
+#include <messaging/messagestore.h>
 #include <crypto/sha256.h>
 #include <hash.h>
 #include <logging.h>
 #include <util/time.h>
 
+#include <algorithm>
+
 namespace messaging {
 
 std::unique_ptr<MessageManager> g_message_manager;
@@ -34,12 +37,31 @@ bool EncryptedMessage::IsExpired() const
            timestamp > now + 300;  // Also reject future messages
 }
 
+MessageManager::MessageManager(const fs::path& path, size_t cache_size, bool memory_only)
+    : m_store(std::make_unique<MessageStore>(path, cache_size, memory_only))
+{
+    LOCK(m_mutex);
+    m_store->ReadRelayStats(m_relay_count, m_next_sequence);
+}
+
+MessageManager::~MessageManager() = default;
+
 void MessageManager::RegisterAddress(const uint256& addressHash)
 {
     LOCK(m_mutex);
     m_our_addresses.insert(addressHash);
     LogDebug(BCLog::NET, "Registered address for messaging: %s\n",
              addressHash.ToString().substr(0, 16));
+
+    // Deliver the messages that arrived for it before it was registered
+    for (StoredMessage& stored : m_store->ReadByRecipient(addressHash)) {
+        if (stored.state != StoredMessage::RELAY || stored.msg.IsExpired()) continue;
+        stored.state = StoredMessage::RECEIVED;
+        if (m_store->Write(stored)) {
+            --m_relay_count;
+            Deliver(stored.msg);
+        }
+    }
 }
 
 void MessageManager::UnregisterAddress(const uint256& addressHash)
@@ -72,39 +94,31 @@ bool MessageManager::ProcessMessage(const EncryptedMessage& msg, int64_t fromPee
         return false;
     }
 
+    // The sender has it, whether or not we do
+    m_peers[fromPeer].known.insert(msg.msgHash);
+    m_requested.erase(msg.msgHash);
+
     // Check if already seen
-    if (m_seen_messages.count(msg.msgHash)) {
+    if (m_store->Exists(msg.msgHash)) {
         return true;  // Already processed, not an error
     }
 
-    m_seen_messages.insert(msg.msgHash);
-    m_peer_known_messages[fromPeer].insert(msg.msgHash);
-
     // Check if it's for us
     if (m_our_addresses.count(msg.recipientHash)) {
-        m_received_messages.push_back(msg);
+        StoredMessage stored;
+        stored.msg = msg;
+        stored.state = StoredMessage::RECEIVED;
+        if (!m_store->Write(stored)) return false;
         LogDebug(BCLog::NET, "Received encrypted message for us: %s\n",
                  msg.msgHash.ToString().substr(0, 16));
-
-        // Notify callback
-        if (m_callback) {
-            m_callback(msg);
-        }
+        Deliver(msg);
     } else {
         // Not for us, add to relay queue
-        m_relay_queue.push_back(msg);
+        AddToRelayQueue(msg);
         LogDebug(BCLog::NET, "Queued message for relay: %s\n",
                  msg.msgHash.ToString().substr(0, 16));
     }
 
-    // Cleanup if queues are too large
-    while (m_relay_queue.size() > MAX_PENDING_MESSAGES) {
-        m_relay_queue.pop_front();
-    }
-    while (m_received_messages.size() > MAX_PENDING_MESSAGES) {
-        m_received_messages.pop_front();
-    }
-
     return true;
 }
 
@@ -116,18 +130,20 @@ bool MessageManager::QueueOutgoingMessage(const EncryptedMessage& msg)
         return false;
     }
 
-    m_seen_messages.insert(msg.msgHash);
-    m_relay_queue.push_back(msg);
-
-    // Also check if this message is for one of our own addresses (self-message)
+    // A message to one of our own addresses (self-message) is delivered
+    // rather than relayed
     if (m_our_addresses.count(msg.recipientHash)) {
-        m_received_messages.push_back(msg);
+        StoredMessage stored;
+        stored.msg = msg;
+        stored.state = StoredMessage::RECEIVED;
+        if (!m_store->Write(stored)) return false;
         LogPrintf("Received own message: %s\n", msg.msgHash.ToString().substr(0, 16));
-        if (m_callback) {
-            m_callback(msg);
-        }
+        Deliver(msg);
+        return true;
     }
 
+    AddToRelayQueue(msg);
+
     LogDebug(BCLog::NET, "Queued outgoing message: %s to %s\n",
              msg.msgHash.ToString().substr(0, 16),
              msg.recipientHash.ToString().substr(0, 16));
@@ -135,39 +151,135 @@ bool MessageManager::QueueOutgoingMessage(const EncryptedMessage& msg)
     return true;
 }
 
-std::vector<EncryptedMessage> MessageManager::GetMessagesToRelay(int64_t peerNodeId, size_t maxCount)
+void MessageManager::AddToRelayQueue(const EncryptedMessage& msg)
+{
+    AssertLockHeld(m_mutex);
+
+    if (m_store->Exists(msg.msgHash)) return;
+
+    StoredMessage stored;
+    stored.msg = msg;
+    stored.state = StoredMessage::RELAY;
+    stored.sequence = m_next_sequence++;
+    if (!m_store->Write(stored)) return;
+    ++m_relay_count;
+
+    // Evict the oldest relay messages, keeping their hash until they expire
+    while (m_relay_count > MAX_PENDING_MESSAGES) {
+        const std::vector<RelayEntry> oldest = m_store->ReadRelay(0, m_relay_count - MAX_PENDING_MESSAGES);
+        const size_t before = m_relay_count;
+        for (const RelayEntry& entry : oldest) {
+            StoredMessage evicted;
+            if (!m_store->Read(entry.msgHash, evicted)) continue;
+            evicted.state = StoredMessage::EVICTED;
+            evicted.msg.encryptedData.clear();
+            evicted.msg.signature.clear();
+            if (m_store->Write(evicted)) --m_relay_count;
+        }
+        if (m_relay_count == before) break;
+    }
+}
+
+void MessageManager::Deliver(const EncryptedMessage& msg)
+{
+    AssertLockHeld(m_mutex);
+
+    // Notify callback
+    if (m_callback) {
+        m_callback(msg);
+    }
+}
+
+bool MessageManager::ReceivedInventory(int64_t peerNodeId, const uint256& msgHash, int64_t now)
 {
     LOCK(m_mutex);
 
-    std::vector<EncryptedMessage> result;
-    auto& peerKnown = m_peer_known_messages[peerNodeId];
+    m_peers[peerNodeId].known.insert(msgHash);
+    if (m_store->Exists(msgHash)) return false;
+
+    // Bound the requests in flight, expiring those that were never answered
+    if (m_requested.size() >= MAX_PENDING_MESSAGES && !m_requested.count(msgHash)) {
+        std::erase_if(m_requested, [&](const auto& req) { return req.second <= now - REQUEST_TIMEOUT_SECONDS; });
+        if (m_requested.size() >= MAX_PENDING_MESSAGES) return false;
+    }
 
-    for (const auto& msg : m_relay_queue) {
-        if (result.size() >= maxCount) break;
+    // Ask one peer at a time, and another one if it doesn't deliver
+    auto [it, inserted] = m_requested.try_emplace(msgHash, now);
+    if (!inserted) {
+        if (it->second > now - REQUEST_TIMEOUT_SECONDS) return false;
+        it->second = now;
+    }
+    return true;
+}
 
-        if (!peerKnown.count(msg.msgHash) && !msg.IsExpired()) {
-            result.push_back(msg);
-            peerKnown.insert(msg.msgHash);
+std::vector<uint256> MessageManager::GetInventoryToAnnounce(int64_t peerNodeId, size_t maxCount)
+{
+    LOCK(m_mutex);
+
+    std::vector<uint256> result;
+    auto& peer = m_peers[peerNodeId];
+    const int64_t now = GetTime();
+
+    // Each message of the queue is considered once per peer
+    while (result.size() < maxCount) {
+        const std::vector<RelayEntry> entries = m_store->ReadRelay(peer.next_sequence, maxCount);
+        for (const RelayEntry& entry : entries) {
+            if (result.size() >= maxCount) break;
+            peer.next_sequence = entry.sequence + 1;
+            const bool expired = entry.timestamp < now - MESSAGE_EXPIRY_SECONDS || entry.timestamp > now + 300;
+            if (!peer.known.contains(entry.msgHash) && !expired) {
+                result.push_back(entry.msgHash);
+                peer.known.insert(entry.msgHash);
+            }
         }
+        if (entries.size() < maxCount) break;
     }
 
     return result;
 }
 
+bool MessageManager::GetRelayMessage(const uint256& msgHash, EncryptedMessage& out) const
+{
+    LOCK(m_mutex);
+
+    StoredMessage stored;
+    if (!m_store->Read(msgHash, stored) || stored.state != StoredMessage::RELAY) return false;
+    out = std::move(stored.msg);
+    return true;
+}
+
+void MessageManager::RemovePeer(int64_t peerNodeId)
+{
+    LOCK(m_mutex);
+    m_peers.erase(peerNodeId);
+}
+
 std::vector<EncryptedMessage> MessageManager::GetReceivedMessages()
 {
     LOCK(m_mutex);
-    return std::vector<EncryptedMessage>(m_received_messages.begin(), m_received_messages.end());
+
+    std::vector<EncryptedMessage> result;
+    for (const uint256& address : m_our_addresses) {
+        for (StoredMessage& stored : m_store->ReadByRecipient(address)) {
+            if (stored.state == StoredMessage::RECEIVED && !stored.msg.IsExpired()) {
+                result.push_back(std::move(stored.msg));
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const EncryptedMessage& a, const EncryptedMessage& b) {
+        return a.timestamp < b.timestamp;
+    });
+    return result;
 }
 
 void MessageManager::MarkDelivered(const uint256& msgHash)
 {
     LOCK(m_mutex);
-    for (auto it = m_received_messages.begin(); it != m_received_messages.end(); ++it) {
-        if (it->msgHash == msgHash) {
-            m_received_messages.erase(it);
-            break;
-        }
+
+    StoredMessage stored;
+    if (m_store->Read(msgHash, stored) && stored.state == StoredMessage::RECEIVED) {
+        stored.state = StoredMessage::DELIVERED;
+        m_store->Write(stored);
     }
 }
 
@@ -181,37 +293,27 @@ void MessageManager::CleanupExpired()
 {
     LOCK(m_mutex);
 
-    // Clean relay queue
-    auto it = m_relay_queue.begin();
-    while (it != m_relay_queue.end()) {
-        if (it->IsExpired()) {
-            m_seen_messages.erase(it->msgHash);
-            it = m_relay_queue.erase(it);
-        } else {
-            ++it;
-        }
+    const int64_t now = GetTime();
+    size_t relay_erased = 0;
+    const size_t erased = m_store->EraseOlderThan(now - MESSAGE_EXPIRY_SECONDS, relay_erased);
+    m_relay_count -= std::min(relay_erased, m_relay_count);
+    if (erased > 0) {
+        LogDebug(BCLog::NET, "Erased %u expired encrypted messages\n", erased);
     }
 
-    // Clean received messages
-    auto it2 = m_received_messages.begin();
-    while (it2 != m_received_messages.end()) {
-        if (it2->IsExpired()) {
-            it2 = m_received_messages.erase(it2);
-        } else {
-            ++it2;
-        }
-    }
+    // Forget requests that were never answered
+    std::erase_if(m_requested, [&](const auto& req) { return req.second <= now - REQUEST_TIMEOUT_SECONDS; });
 }
 
 bool MessageManager::HaveSeen(const uint256& msgHash) const
 {
     LOCK(m_mutex);
-    return m_seen_messages.count(msgHash) > 0;
+    return m_store->Exists(msgHash);
 }
 
-void InitMessageManager()
+void InitMessageManager(const fs::path& path)
 {
-    g_message_manager = std::make_unique<MessageManager>();
+    g_message_manager = std::make_unique<MessageManager>(path, MessageManager::STORE_CACHE_BYTES);
     LogPrintf("Encrypted P2P messaging initialized\n");
 }
 
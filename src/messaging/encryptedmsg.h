@@ -5,18 +5,24 @@
 #ifndef WATTX_MESSAGING_ENCRYPTEDMSG_H
 #define WATTX_MESSAGING_ENCRYPTEDMSG_H
 
+#include <common/bloom.h>
 #include <serialize.h>
 #include <uint256.h>
 #include <sync.h>
+#include <util/fs.h>
+#include <util/hasher.h>
 
 #include <vector>
 #include <deque>
 #include <map>
 #include <memory>
 #include <functional>
+#include <unordered_set>
 
 namespace messaging {
 
+class MessageStore;
+
 /**
  * Encrypted P2P message structure
  * Messages are relayed through the network until they reach the recipient
@@ -53,16 +59,24 @@ using MessageCallback = std::function<void(const EncryptedMessage&)>;
 
 /**
  * Global message manager for P2P encrypted messaging
+ *
+ * Messages are kept in a MessageStore until they expire, so a restart does
+ * not download them again; only our addresses, the relay requests in
+ * flight and the peers' known sets are held in memory.
  */
 class MessageManager {
 public:
     static constexpr int64_t MESSAGE_EXPIRY_SECONDS = 7 * 24 * 3600;  // 7 days
     static constexpr size_t MAX_MESSAGE_SIZE = 4096;  // 4KB max
     static constexpr size_t MAX_PENDING_MESSAGES = 10000;
+    static constexpr int64_t REQUEST_TIMEOUT_SECONDS = 60;  // Before asking another peer for a message
+    static constexpr size_t STORE_CACHE_BYTES = 4 << 20;
 
-    MessageManager() = default;
+    MessageManager(const fs::path& path, size_t cache_size, bool memory_only = false);
+    ~MessageManager();
 
-    // Register an address hash that we control (to receive messages)
+    // Register an address hash that we control (to receive messages); stored
+    // messages for it are delivered
     void RegisterAddress(const uint256& addressHash);
     void UnregisterAddress(const uint256& addressHash);
 
@@ -75,8 +89,21 @@ public:
     // Queue a message for sending
     bool QueueOutgoingMessage(const EncryptedMessage& msg);
 
-    // Get messages to relay to a peer
-    std::vector<EncryptedMessage> GetMessagesToRelay(int64_t peerNodeId, size_t maxCount = 100);
+    // Messages are relayed like transactions: announced by hash in an inv,
+    // then fetched with getdata by the peers that don't have them yet
+
+    // Record a peer's inv for a message; returns whether to request it from that peer
+    bool ReceivedInventory(int64_t peerNodeId, const uint256& msgHash, int64_t now);
+
+    // Get hashes of relay messages not yet announced to or by a peer, and
+    // mark them known to the peer
+    std::vector<uint256> GetInventoryToAnnounce(int64_t peerNodeId, size_t maxCount = 100);
+
+    // Look up a relay message for a peer's getdata
+    bool GetRelayMessage(const uint256& msgHash, EncryptedMessage& out) const;
+
+    // Forget the known set of a disconnected peer
+    void RemovePeer(int64_t peerNodeId);
 
     // Get received messages for our addresses
     std::vector<EncryptedMessage> GetReceivedMessages();
@@ -87,7 +114,7 @@ public:
     // Set callback for new messages
     void SetMessageCallback(MessageCallback callback);
 
-    // Cleanup expired messages
+    // Cleanup expired messages, oldest first, stopping at the first unexpired one
     void CleanupExpired();
 
     // Check if we've seen this message
@@ -96,20 +123,29 @@ public:
 private:
     mutable Mutex m_mutex;
 
-    // Addresses we control (hashed)
-    std::set<uint256> m_our_addresses GUARDED_BY(m_mutex);
+    // Addresses we control (hashed); every relayed message is checked
+    // against them, so the lookup is O(1) however many are registered
+    std::unordered_set<uint256, SaltedTxidHasher> m_our_addresses GUARDED_BY(m_mutex);
 
-    // Messages we've received for our addresses
-    std::deque<EncryptedMessage> m_received_messages GUARDED_BY(m_mutex);
+    // Messages we've seen, until they expire: received for our addresses,
+    // and pending relay (not for us, need to forward) by arrival sequence
+    const std::unique_ptr<MessageStore> m_store;
+    size_t m_relay_count GUARDED_BY(m_mutex){0};
+    uint64_t m_next_sequence GUARDED_BY(m_mutex){1};
 
-    // Messages pending relay (not for us, need to forward)
-    std::deque<EncryptedMessage> m_relay_queue GUARDED_BY(m_mutex);
+    // Messages requested from a peer, and when
+    std::map<uint256, int64_t> m_requested GUARDED_BY(m_mutex);
 
-    // Messages we've seen (to avoid duplicates)
-    std::set<uint256> m_seen_messages GUARDED_BY(m_mutex);
+    // Which messages each peer is known to have, bounded by a rolling bloom
+    // filter, and how far into the relay queue it has been announced to
+    struct PeerState {
+        CRollingBloomFilter known{MAX_PENDING_MESSAGES, 0.000001};
+        uint64_t next_sequence{0};
+    };
+    std::map<int64_t, PeerState> m_peers GUARDED_BY(m_mutex);
 
-    // Track which peers have which messages
-    std::map<int64_t, std::set<uint256>> m_peer_known_messages GUARDED_BY(m_mutex);
+    void AddToRelayQueue(const EncryptedMessage& msg) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Deliver(const EncryptedMessage& msg) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
 
     // Callback for new messages
     MessageCallback m_callback GUARDED_BY(m_mutex);
@@ -119,7 +155,7 @@ private:
 extern std::unique_ptr<MessageManager> g_message_manager;
 
 // Initialize/shutdown
-void InitMessageManager();
+void InitMessageManager(const fs::path& path);
 void ShutdownMessageManager();
 
 // Broadcast a message to all connected peers
@@ -0,0 +1,142 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <messaging/messagestore.h>
+
+#include <algorithm>
+#include <memory>
+
+namespace messaging {
+
+// Database keys
+static constexpr uint8_t DB_MESSAGE{'m'};
+static constexpr uint8_t DB_EXPIRY{'e'};
+static constexpr uint8_t DB_RECIPIENT{'r'};
+static constexpr uint8_t DB_RELAY{'q'};
+
+//! Numbers in keys are big endian, so keys sort by them
+struct OrderedKey {
+    uint64_t number{0};
+    uint256 hash;
+
+    SERIALIZE_METHODS(OrderedKey, obj) { READWRITE(Using<BigEndianFormatter<8>>(obj.number), obj.hash); }
+};
+
+static std::pair<uint8_t, OrderedKey> ExpiryKey(const EncryptedMessage& msg)
+{
+    return {DB_EXPIRY, OrderedKey{static_cast<uint64_t>(std::max<int64_t>(msg.timestamp, 0)), msg.msgHash}};
+}
+
+static std::pair<uint8_t, std::pair<uint256, uint256>> RecipientKey(const EncryptedMessage& msg)
+{
+    return {DB_RECIPIENT, {msg.recipientHash, msg.msgHash}};
+}
+
+static std::pair<uint8_t, OrderedKey> RelayKey(uint64_t sequence)
+{
+    return {DB_RELAY, OrderedKey{sequence, uint256()}};
+}
+
+MessageStore::MessageStore(const fs::path& path, size_t cache_size, bool memory_only)
+    : m_db(DBParams{.path = path, .cache_bytes = cache_size, .memory_only = memory_only, .wipe_data = false, .obfuscate = true, .shared_cache = true})
+{
+}
+
+bool MessageStore::Write(const StoredMessage& stored)
+{
+    CDBBatch batch(m_db);
+    batch.Write(std::make_pair(DB_MESSAGE, stored.msg.msgHash), stored);
+    batch.Write(ExpiryKey(stored.msg), uint8_t{0});
+    if (stored.state == StoredMessage::EVICTED) {
+        batch.Erase(RecipientKey(stored.msg));
+    } else {
+        batch.Write(RecipientKey(stored.msg), uint8_t{0});
+    }
+    if (stored.state == StoredMessage::RELAY) {
+        batch.Write(RelayKey(stored.sequence), std::make_pair(stored.msg.msgHash, stored.msg.timestamp));
+    } else if (stored.sequence != 0) {
+        batch.Erase(RelayKey(stored.sequence));
+    }
+    return m_db.WriteBatch(batch);
+}
+
+bool MessageStore::Read(const uint256& msgHash, StoredMessage& stored) const
+{
+    return m_db.Read(std::make_pair(DB_MESSAGE, msgHash), stored);
+}
+
+bool MessageStore::Exists(const uint256& msgHash) const
+{
+    return m_db.Exists(std::make_pair(DB_MESSAGE, msgHash));
+}
+
+std::vector<StoredMessage> MessageStore::ReadByRecipient(const uint256& recipientHash)
+{
+    std::vector<StoredMessage> result;
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(std::make_pair(DB_RECIPIENT, std::make_pair(recipientHash, uint256()))); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, std::pair<uint256, uint256>> key;
+        if (!pcursor->GetKey(key) || key.first != DB_RECIPIENT || key.second.first != recipientHash) break;
+        StoredMessage stored;
+        if (Read(key.second.second, stored)) result.push_back(std::move(stored));
+    }
+    return result;
+}
+
+std::vector<RelayEntry> MessageStore::ReadRelay(uint64_t from_sequence, size_t max_count)
+{
+    std::vector<RelayEntry> result;
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(RelayKey(from_sequence)); pcursor->Valid() && result.size() < max_count; pcursor->Next()) {
+        std::pair<uint8_t, OrderedKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_RELAY) break;
+        std::pair<uint256, int64_t> value;
+        if (!pcursor->GetValue(value)) break;
+        result.push_back({key.second.number, value.first, value.second});
+    }
+    return result;
+}
+
+void MessageStore::ReadRelayStats(size_t& count, uint64_t& next_sequence)
+{
+    count = 0;
+    next_sequence = 1;
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(RelayKey(0)); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, OrderedKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_RELAY) break;
+        ++count;
+        next_sequence = key.second.number + 1;
+    }
+}
+
+size_t MessageStore::EraseOlderThan(int64_t cutoff, size_t& relay_erased)
+{
+    size_t erased = 0;
+    relay_erased = 0;
+
+    CDBBatch batch(m_db);
+    std::unique_ptr<CDBIterator> pcursor(m_db.NewIterator());
+    for (pcursor->Seek(std::make_pair(DB_EXPIRY, OrderedKey{})); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, OrderedKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_EXPIRY) break;
+        if (key.second.number >= static_cast<uint64_t>(std::max<int64_t>(cutoff, 0))) break;
+
+        batch.Erase(key);
+        StoredMessage stored;
+        if (Read(key.second.hash, stored)) {
+            batch.Erase(std::make_pair(DB_MESSAGE, stored.msg.msgHash));
+            batch.Erase(RecipientKey(stored.msg));
+            if (stored.state == StoredMessage::RELAY) {
+                batch.Erase(RelayKey(stored.sequence));
+                ++relay_erased;
+            }
+        }
+        ++erased;
+    }
+    if (erased > 0) m_db.WriteBatch(batch);
+    return erased;
+}
+
+} // namespace messaging
@@ -0,0 +1,91 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_MESSAGING_MESSAGESTORE_H
+#define WATTX_MESSAGING_MESSAGESTORE_H
+
+#include <dbwrapper.h>
+#include <messaging/encryptedmsg.h>
+#include <serialize.h>
+#include <uint256.h>
+#include <util/fs.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace messaging {
+
+/**
+ * A message as kept by the store, with where it is in its life
+ */
+struct StoredMessage {
+    //! Waiting to be relayed to peers
+    static constexpr uint8_t RELAY{0};
+    //! For one of our addresses, not yet delivered
+    static constexpr uint8_t RECEIVED{1};
+    //! For one of our addresses, delivered
+    static constexpr uint8_t DELIVERED{2};
+    //! Dropped from a full relay queue; kept without its data until it
+    //! expires so it isn't downloaded again
+    static constexpr uint8_t EVICTED{3};
+
+    EncryptedMessage msg;
+    uint8_t state{RELAY};
+    //! Arrival order of relay messages, which peers are announced them in;
+    //! 0 for messages that were never in the relay queue
+    uint64_t sequence{0};
+
+    SERIALIZE_METHODS(StoredMessage, obj) { READWRITE(obj.msg, obj.state, obj.sequence); }
+};
+
+/**
+ * A relay queue entry, enough to announce the message
+ */
+struct RelayEntry {
+    uint64_t sequence{0};
+    uint256 msgHash;
+    int64_t timestamp{0};
+};
+
+/**
+ * LevelDB store of the messages the node has seen, until they expire
+ *
+ * Records are keyed by message hash. Index entries are written in the same
+ * batch as their record:
+ * - by timestamp, so expired messages are found without a scan;
+ * - by recipient hash, so messages are delivered when their address is
+ *   registered;
+ * - relay messages by sequence, for the per-peer announcement cursors.
+ */
+class MessageStore {
+public:
+    MessageStore(const fs::path& path, size_t cache_size, bool memory_only = false);
+
+    /** Write a message, updating the relay queue for a changed state */
+    bool Write(const StoredMessage& stored);
+    bool Read(const uint256& msgHash, StoredMessage& stored) const;
+    bool Exists(const uint256& msgHash) const;
+
+    /** Messages for a recipient */
+    std::vector<StoredMessage> ReadByRecipient(const uint256& recipientHash);
+
+    /** Up to max_count relay queue entries, from a sequence on */
+    std::vector<RelayEntry> ReadRelay(uint64_t from_sequence, size_t max_count);
+    /** Number of relay queue entries and the sequence after the last one */
+    void ReadRelayStats(size_t& count, uint64_t& next_sequence);
+
+    /**
+     * Erase the messages older than a timestamp, in timestamp order
+     * @param[out] relay_erased  how many of them were in the relay queue
+     * @return how many were erased
+     */
+    size_t EraseOlderThan(int64_t cutoff, size_t& relay_erased);
+
+private:
+    CDBWrapper m_db;
+};
+
+} // namespace messaging
+
+#endif // WATTX_MESSAGING_MESSAGESTORE_H
@@ -51,6 +51,7 @@
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <set>
 #include <unordered_map>
 
 TRACEPOINT_SEMAPHORE(net, closed_connection);
@@ -1868,6 +1869,8 @@ bool CConnman::AddConnection(const std::string& address, ConnectionType conn_typ
     switch (conn_type) {
     case ConnectionType::INBOUND:
     case ConnectionType::MANUAL:
+    // validator relay connections only go to addresses learned from heartbeats
+    case ConnectionType::VALIDATOR_RELAY:
         return false;
     case ConnectionType::OUTBOUND_FULL_RELAY:
         max_connections = m_max_outbound_full_relay;
@@ -2656,6 +2659,7 @@ void CConnman::ThreadOpenConnections(const std::vector<std::string> connect, Spa
                     case ConnectionType::MANUAL:
                     case ConnectionType::OUTBOUND_FULL_RELAY:
                     case ConnectionType::BLOCK_RELAY:
+                    case ConnectionType::VALIDATOR_RELAY:
                         const CAddress address{pnode->addr};
                         if (address.IsTor() || address.IsI2P() || address.IsCJDNS()) {
                             // Since our addrman-groups for these networks are
@@ -2981,6 +2985,52 @@ void CConnman::ThreadOpenAddedConnections()
     }
 }
 
+void CConnman::SetValidatorRelayAddresses(std::vector<CService> addresses)
+{
+    const std::set<CService> wanted(addresses.begin(), addresses.end());
+    WITH_LOCK(m_validator_relay_mutex, m_validator_relay_addresses = std::move(addresses));
+
+    // Free the slots of validators that dropped out, e.g. after deactivation
+    LOCK(m_nodes_mutex);
+    for (CNode* pnode : m_nodes) {
+        if (pnode->IsValidatorRelayConn() && !pnode->fDisconnect && wanted.count(pnode->addr) == 0) {
+            LogDebug(BCLog::NET, "validator relay peer is no longer a candidate, %s\n", pnode->DisconnectMsg(fLogIPs));
+            pnode->fDisconnect = true;
+        }
+    }
+}
+
+void CConnman::ThreadOpenValidatorConnections()
+{
+    AssertLockNotHeld(m_unused_i2p_sessions_mutex);
+    while (true)
+    {
+        CSemaphoreGrant grant(*semValidatorRelay);
+        // Copy, so that new addresses from the next block do not wait for this round
+        const std::vector<CService> addresses{WITH_LOCK(m_validator_relay_mutex, return m_validator_relay_addresses)};
+        bool tried = false;
+        for (const CService& address : addresses) {
+            if (!grant) {
+                // All slots are in use; keep them until a validator disconnects
+                // or drops out, rather than churning towards a higher tier.
+                break;
+            }
+            const CAddress addr{address, NODE_NONE};
+            if (!g_reachable_nets.Contains(addr) || AlreadyConnectedToAddress(addr)) continue;
+            tried = true;
+            // Attempt v2 connection if we support v2 - we'll reconnect with v1 if our
+            // peer doesn't support it or immediately disconnects us for another reason.
+            const bool use_v2transport(GetLocalServices() & NODE_P2P_V2);
+            OpenNetworkConnection(addr, /*fCountFailure=*/false, std::move(grant), /*pszDest=*/nullptr, ConnectionType::VALIDATOR_RELAY, use_v2transport);
+            if (!interruptNet.sleep_for(std::chrono::milliseconds(500))) return;
+            grant = CSemaphoreGrant(*semValidatorRelay, /*fTry=*/true);
+        }
+        // Retry every 60 seconds if a connection was attempted, otherwise two seconds
+        if (!interruptNet.sleep_for(std::chrono::seconds(tried ? 60 : 2)))
+            return;
+    }
+}
+
 // if successful, this moves the passed grant to the constructed node
 void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFailure, CSemaphoreGrant&& grant_outbound, const char *pszDest, ConnectionType conn_type, bool use_v2transport)
 {
@@ -3339,6 +3389,10 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         // initialize semaphore
         semAddnode = std::make_unique<CSemaphore>(m_max_addnode);
     }
+    if (semValidatorRelay == nullptr) {
+        // initialize semaphore
+        semValidatorRelay = std::make_unique<CSemaphore>(m_max_validator_relay);
+    }
 
     //
     // Start threads
@@ -3377,6 +3431,12 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
             [this, connect = connOptions.m_specified_outgoing, seed_nodes = std::move(seed_nodes)] { ThreadOpenConnections(connect, seed_nodes); });
     }
 
+    // Initiate connections to staking validators, unless outgoing connections
+    // are restricted to -connect
+    if (connOptions.m_use_addrman_outgoing && m_max_validator_relay > 0) {
+        threadOpenValidatorConnections = std::thread(&util::TraceThread, "valcon", [this] { ThreadOpenValidatorConnections(); });
+    }
+
     // Process messages
     threadMessageHandler = std::thread(&util::TraceThread, "msghand", [this] { ThreadMessageHandler(); });
 
@@ -3434,6 +3494,12 @@ void CConnman::Interrupt()
             semAddnode->post();
         }
     }
+
+    if (semValidatorRelay) {
+        for (int i=0; i<m_max_validator_relay; i++) {
+            semValidatorRelay->post();
+        }
+    }
 }
 
 void CConnman::StopThreads()
@@ -3447,6 +3513,8 @@ void CConnman::StopThreads()
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
         threadOpenAddedConnections.join();
+    if (threadOpenValidatorConnections.joinable())
+        threadOpenValidatorConnections.join();
     if (threadDNSAddressSeed.joinable())
         threadDNSAddressSeed.join();
     if (threadSocketHandler.joinable())
@@ -3485,6 +3553,7 @@ void CConnman::StopNodes()
     vhListenSocket.clear();
     semOutbound.reset();
     semAddnode.reset();
+    semValidatorRelay.reset();
 }
 
 void CConnman::DeleteNode(CNode* pnode)
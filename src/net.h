@@ -69,6 +69,8 @@ static const int MAX_OUTBOUND_FULL_RELAY_CONNECTIONS = 8;
 static const int MAX_ADDNODE_CONNECTIONS = 8;
 /** Maximum number of block-relay-only outgoing connections */
 static const int MAX_BLOCK_RELAY_ONLY_CONNECTIONS = 2;
+/** Maximum number of outgoing connections to staking validators */
+static const int MAX_VALIDATOR_RELAY_CONNECTIONS = 4;
 /** Maximum number of feeler connections */
 static const int MAX_FEELER_CONNECTIONS = 1;
 /** -listen default */
@@ -761,6 +763,7 @@ public:
         switch (m_conn_type) {
             case ConnectionType::OUTBOUND_FULL_RELAY:
             case ConnectionType::BLOCK_RELAY:
+            case ConnectionType::VALIDATOR_RELAY:
                 return true;
             case ConnectionType::INBOUND:
             case ConnectionType::MANUAL:
@@ -787,6 +790,7 @@ public:
         case ConnectionType::FEELER:
         case ConnectionType::BLOCK_RELAY:
         case ConnectionType::ADDR_FETCH:
+        case ConnectionType::VALIDATOR_RELAY:
                 return false;
         case ConnectionType::OUTBOUND_FULL_RELAY:
         case ConnectionType::MANUAL:
@@ -800,6 +804,10 @@ public:
         return m_conn_type == ConnectionType::BLOCK_RELAY;
     }
 
+    bool IsValidatorRelayConn() const {
+        return m_conn_type == ConnectionType::VALIDATOR_RELAY;
+    }
+
     bool IsFeelerConn() const {
         return m_conn_type == ConnectionType::FEELER;
     }
@@ -821,6 +829,7 @@ public:
             case ConnectionType::OUTBOUND_FULL_RELAY:
             case ConnectionType::BLOCK_RELAY:
             case ConnectionType::ADDR_FETCH:
+            case ConnectionType::VALIDATOR_RELAY:
                 return true;
         } // no default case, so the compiler can warn about missing cases
 
@@ -1075,6 +1084,7 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        int m_max_validator_relay = MAX_VALIDATOR_RELAY_CONNECTIONS;
         bool m_i2p_accept_incoming;
         bool whitelist_forcerelay = DEFAULT_WHITELISTFORCERELAY;
         bool whitelist_relay = DEFAULT_WHITELISTRELAY;
@@ -1090,6 +1100,7 @@ public:
         m_max_outbound_block_relay = std::min(MAX_BLOCK_RELAY_ONLY_CONNECTIONS, m_max_automatic_connections - m_max_outbound_full_relay);
         m_max_automatic_outbound = m_max_outbound_full_relay + m_max_outbound_block_relay + m_max_feeler;
         m_max_inbound = std::max(0, m_max_automatic_connections - m_max_automatic_outbound);
+        m_max_validator_relay = connOptions.m_max_validator_relay;
         m_use_addrman_outgoing = connOptions.m_use_addrman_outgoing;
         m_client_interface = connOptions.uiInterface;
         m_banman = connOptions.m_banman;
@@ -1208,6 +1219,13 @@ public:
     bool AddedNodesContain(const CAddress& addr) const EXCLUSIVE_LOCKS_REQUIRED(!m_added_nodes_mutex);
     std::vector<AddedNodeInfo> GetAddedNodeInfo(bool include_connected) const EXCLUSIVE_LOCKS_REQUIRED(!m_added_nodes_mutex);
 
+    /**
+     * Set the staking validator addresses to open validator relay connections
+     * to, best first. Validator relay peers that are no longer among them are
+     * disconnected.
+     */
+    void SetValidatorRelayAddresses(std::vector<CService> addresses) EXCLUSIVE_LOCKS_REQUIRED(!m_validator_relay_mutex, !m_nodes_mutex);
+
     /**
      * Attempts to open a connection. Currently only used from tests.
      *
@@ -1295,6 +1313,7 @@ private:
     bool InitBinds(const Options& options);
 
     void ThreadOpenAddedConnections() EXCLUSIVE_LOCKS_REQUIRED(!m_added_nodes_mutex, !m_unused_i2p_sessions_mutex, !m_reconnections_mutex);
+    void ThreadOpenValidatorConnections() EXCLUSIVE_LOCKS_REQUIRED(!m_validator_relay_mutex, !m_unused_i2p_sessions_mutex);
     void AddAddrFetch(const std::string& strDest) EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex);
     void ProcessAddrFetch() EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_unused_i2p_sessions_mutex);
     void ThreadOpenConnections(std::vector<std::string> connect, Span<const std::string> seed_nodes) EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_added_nodes_mutex, !m_nodes_mutex, !m_unused_i2p_sessions_mutex, !m_reconnections_mutex);
@@ -1442,6 +1461,11 @@ private:
     std::vector<AddedNodeParams> m_added_node_params GUARDED_BY(m_added_nodes_mutex);
 
     mutable Mutex m_added_nodes_mutex;
+
+    // Staking validator addresses for validator relay connections, best first
+    std::vector<CService> m_validator_relay_addresses GUARDED_BY(m_validator_relay_mutex);
+    Mutex m_validator_relay_mutex;
+
     std::vector<CNode*> m_nodes GUARDED_BY(m_nodes_mutex);
     std::list<CNode*> m_nodes_disconnected;
     mutable RecursiveMutex m_nodes_mutex;
@@ -1493,6 +1517,7 @@ private:
 
     std::unique_ptr<CSemaphore> semOutbound;
     std::unique_ptr<CSemaphore> semAddnode;
+    std::unique_ptr<CSemaphore> semValidatorRelay;
 
     /**
      * Maximum number of automatic connections permitted, excluding manual
@@ -1514,6 +1539,10 @@ private:
     int m_max_outbound_block_relay;
 
     int m_max_addnode{MAX_ADDNODE_CONNECTIONS};
+
+    // How many block-relay only outbound peers to staking validators we want.
+    // Like addnode peers, these are counted separately from -maxconnections
+    int m_max_validator_relay{MAX_VALIDATOR_RELAY_CONNECTIONS};
     int m_max_feeler{MAX_FEELER_CONNECTIONS};
     int m_max_automatic_outbound;
     int m_max_inbound;
@@ -1558,6 +1587,7 @@ private:
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
+    std::thread threadOpenValidatorConnections;
     std::thread threadOpenConnections;
     std::thread threadMessageHandler;
     std::thread threadI2PAcceptIncoming;
@@ -32,6 +32,8 @@
 #include <policy/settings.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <privacy/consensus.h>
+#include <privacy/fcmp_consensus.h>
 #include <random.h>
 #include <scheduler.h>
 #include <streams.h>
@@ -55,7 +57,9 @@
 #include <messaging/encryptedmsg.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <deque>
 #include <future>
 #include <memory>
 #include <optional>
@@ -104,6 +108,10 @@ static const unsigned int MAX_INV_SZ = 50000;
 static const unsigned int MAX_GETDATA_SZ = 1000;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Bounds of the per-peer limit on blocks in flight during download, which starts at
+ *  MAX_BLOCKS_IN_TRANSIT_PER_PEER, grows while the peer keeps up and halves when it stalls. */
+static const int MIN_BLOCKS_IN_TRANSIT_PER_PEER = 2;
+static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE = 64;
 /** Default time during which a peer must stall block download progress before being disconnected.
  * the actual timeout is increased temporarily if peers are disconnected for hitting the timeout */
 static constexpr auto BLOCK_STALLING_TIMEOUT_DEFAULT{2s};
@@ -114,12 +122,20 @@ static constexpr auto BLOCK_STALLING_TIMEOUT_MAX{64s};
 static const int MAX_CMPCTBLOCK_DEPTH = 5;
 /** Maximum depth of blocks we're willing to respond to GETBLOCKTXN requests for. */
 static const int MAX_BLOCKTXN_DEPTH = 10;
+/** Maximum depth of blocks whose `block` messages are kept serialized for further getdata requests */
+static const int MAX_SERIALIZED_BLOCK_DEPTH = 6;
+/** Memory budget of the serialized `block` messages of recent blocks */
+static constexpr size_t MAX_SERIALIZED_BLOCK_CACHE_BYTES{32 << 20};
 static_assert(MAX_BLOCKTXN_DEPTH <= MIN_BLOCKS_TO_KEEP, "MAX_BLOCKTXN_DEPTH too high");
+/** Maximum number of getblocktxn requests held back for a block cut through before we had it. */
+static const size_t MAX_CUT_THROUGH_REQUESTS = 16;
 /** Size of the "block download window": how far ahead of our current height do we fetch?
  *  Larger windows tolerate larger download speed differences between peer, but increase the potential
- *  degree of disordering of blocks on disk (which make reindexing and pruning harder). We'll probably
- *  want to make this a per-peer adaptive value at some point. */
+ *  degree of disordering of blocks on disk (which make reindexing and pruning harder). This is where
+ *  the window starts, see m_block_download_window. */
 static const unsigned int BLOCK_DOWNLOAD_WINDOW = 1024;
+/** Largest the block download window grows to, see m_block_download_window. */
+static const unsigned int MAX_BLOCK_DOWNLOAD_WINDOW = 4 * BLOCK_DOWNLOAD_WINDOW;
 /** Block download timeout base, expressed in multiples of the block interval (i.e. 10 min) */
 static constexpr double BLOCK_DOWNLOAD_TIMEOUT_BASE = 1;
 /** Additional block download timeout per parallel downloading peer (i.e. 5 min) */
@@ -173,6 +189,30 @@ static constexpr double MAX_ADDR_RATE_PER_SECOND{0.1};
 static constexpr size_t MAX_ADDR_PROCESSING_TOKEN_BUCKET{MAX_ADDR_TO_SEND};
 /** The compactblocks version we support. See BIP 152. */
 static constexpr uint64_t CMPCTBLOCKS_VERSION{2};
+/** WATTx trust-layer messages whose processing is budgeted per peer with a token bucket */
+enum class TrustMessage : size_t {
+    HEARTBEAT,
+    GETVALIDATORS,
+    VALIDATORS,
+    REGVALIDATOR,
+    ENCMSG,
+};
+static constexpr size_t NUM_TRUST_MESSAGES{5};
+/** Refill rate and capacity of the token bucket for one trust-layer message type */
+struct TrustMessageBudget {
+    double rate_per_second;
+    double bucket_size;
+};
+/** Token bucket budgets, indexed by TrustMessage. Heartbeats and encrypted messages
+ *  are cheap and come in bursts; each validator list costs a full (de)serialization
+ *  and each registration a signature check. */
+static constexpr std::array<TrustMessageBudget, NUM_TRUST_MESSAGES> TRUST_MESSAGE_BUDGETS{{
+    {/*rate_per_second=*/1.0, /*bucket_size=*/100},
+    {/*rate_per_second=*/1.0 / 60, /*bucket_size=*/2},
+    {/*rate_per_second=*/1.0 / 60, /*bucket_size=*/2},
+    {/*rate_per_second=*/0.1, /*bucket_size=*/10},
+    {/*rate_per_second=*/1.0, /*bucket_size=*/50},
+}};
 
 struct COrphanBlock {
     uint256 hashBlock;
@@ -189,6 +229,8 @@ struct QueuedBlock {
     const CBlockIndex* pindex;
     /** Optional, used for CMPCTBLOCK downloads */
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;
+    /** When the block was requested. */
+    std::chrono::microseconds m_requested_time{0us};
 };
 
 /**
@@ -367,6 +409,16 @@ struct Peer {
     /** Total number of addresses that were processed (excludes rate-limited ones). */
     std::atomic<uint64_t> m_addr_processed{0};
 
+    /** Number of trust-layer messages of each type that can be processed from
+     *  this peer, indexed by TrustMessage */
+    std::array<double, NUM_TRUST_MESSAGES> m_trust_msg_tokens GUARDED_BY(NetEventsInterface::g_msgproc_mutex){};
+    /** When each of m_trust_msg_tokens was last updated. Starting at zero fills
+     *  a bucket on the first message of its type. */
+    std::array<std::chrono::microseconds, NUM_TRUST_MESSAGES> m_trust_msg_token_timestamps GUARDED_BY(NetEventsInterface::g_msgproc_mutex){};
+
+    /** When to next announce encrypted P2P messages to this peer, trickled like transaction invs */
+    std::chrono::microseconds m_next_encmsg_inv_send GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+
     /** Whether we've sent this peer a getheaders in response to an inv prior to initial-headers-sync completing */
     bool m_inv_triggered_getheaders_before_sync GUARDED_BY(NetEventsInterface::g_msgproc_mutex){false};
 
@@ -434,6 +486,8 @@ struct CNodeState {
     std::list<QueuedBlock> vBlocksInFlight;
     //! When the first entry in vBlocksInFlight started downloading. Don't care when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! How many blocks we let this peer have in flight while downloading, adapted to how it keeps up.
+    int m_max_blocks_in_flight{MAX_BLOCKS_IN_TRANSIT_PER_PEER};
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /** Whether this peer wants invs or cmpctblocks (when possible) for block announcements. */
@@ -590,7 +644,7 @@ public:
     void BlockChecked(const CBlock& block, const BlockValidationState& state) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, !m_peer_mutex);
 
     /** Implement NetEventsInterface */
     void InitializeNode(const CNode& node, ServiceFlags our_services) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_tx_download_mutex);
@@ -828,6 +882,9 @@ private:
     /** Send `feefilter` message. */
     void MaybeSendFeefilter(CNode& node, Peer& peer, std::chrono::microseconds current_time) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 
+    /** Announce transactions that came out of reconciliation with a peer, if still in the mempool. */
+    void AnnounceReconciledTxs(CNode& node, Peer& peer, const std::vector<Wtxid>& wtxids) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
     /** Process net block. */
     void PushGetBlocks(CNode& node, const CBlockIndex* pindexBegin, const uint256& hashEnd);
     uint256 GetOrphanRoot(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -961,6 +1018,26 @@ private:
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> m_most_recent_compact_block GUARDED_BY(m_most_recent_block_mutex);
     uint256 m_most_recent_block_hash GUARDED_BY(m_most_recent_block_mutex);
     std::unique_ptr<const std::map<uint256, CTransactionRef>> m_most_recent_block_txs GUARDED_BY(m_most_recent_block_mutex);
+    /** The block last cut through, and the getblocktxn requests for it that arrived before we had
+     *  it. These are answered by NewPoWValidBlock. */
+    uint256 m_cut_through_hash GUARDED_BY(m_most_recent_block_mutex);
+    std::vector<std::pair<NodeId, BlockTransactionsRequest>> m_cut_through_requests GUARDED_BY(m_most_recent_block_mutex);
+
+    /** A `block` message of a block near the tip, with or without witness data. */
+    struct SerializedBlockMsg {
+        uint256 hash;
+        bool witness;
+        CSerializedNetMsg msg;
+    };
+    /** `block` messages served for blocks near the tip, oldest first, so that peers fetching the
+     *  same new block share one serialization. Historical blocks do not enter it, so syncing
+     *  peers cannot push the tip out. */
+    Mutex m_serialized_blocks_mutex;
+    std::deque<SerializedBlockMsg> m_serialized_blocks GUARDED_BY(m_serialized_blocks_mutex);
+    size_t m_serialized_blocks_bytes GUARDED_BY(m_serialized_blocks_mutex){0};
+
+    std::optional<CSerializedNetMsg> GetSerializedBlock(const uint256& hash, bool witness) EXCLUSIVE_LOCKS_REQUIRED(!m_serialized_blocks_mutex);
+    void CacheSerializedBlock(const uint256& hash, bool witness, const CSerializedNetMsg& msg) EXCLUSIVE_LOCKS_REQUIRED(!m_serialized_blocks_mutex);
 
     // Data about the low-work headers synchronization, aggregated from all peers' HeadersSyncStates.
     /** Mutex guarding the other m_headers_presync_* variables. */
@@ -983,6 +1060,17 @@ private:
     /** Height of the highest block announced using BIP 152 high-bandwidth mode. */
     int m_highest_fast_announce GUARDED_BY(::cs_main){0};
 
+    /** Height of the highest block cut through to validator relay peers. */
+    int m_highest_cut_through GUARDED_BY(::cs_main){0};
+
+    /**
+     * With -validatorcutthrough, forward a compact PoS block whose header (and so its stake and
+     * block signature) has just been checked to our validator relay peers, before we have the
+     * block or connected it. Peers it is sent to are skipped by NewPoWValidBlock later.
+     */
+    void MaybeCutThroughCompactBlock(const CNode& pfrom, const CBlockIndex& index, const CBlockHeaderAndShortTxIDs& cmpctblock)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+
     /** Have we requested this block from a peer */
     bool IsBlockRequested(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -1004,6 +1092,10 @@ private:
      */
     bool BlockRequested(NodeId nodeid, const CBlockIndex& block, std::list<QueuedBlock>::iterator** pit = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /** Adapt the download limits to a peer delivering a block it was asked for. Call before
+     *  RemoveBlockRequest. */
+    void BlockDelivered(NodeId nodeid, const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     bool TipMayBeStale() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Update pindexLastCommonBlock and add not-in-flight missing successors to vBlocks, until it has
@@ -1079,6 +1171,11 @@ private:
     /** Number of peers from which we're downloading blocks. */
     int m_peers_downloading_from GUARDED_BY(cs_main) = 0;
 
+    /** How far past the last block we have in common with a peer we fetch. Grows from
+     *  BLOCK_DOWNLOAD_WINDOW each time a stalling peer turns out to deliver in time, i.e. the
+     *  window was too narrow for the link latency, and goes back once out of IBD. */
+    int m_block_download_window GUARDED_BY(cs_main){BLOCK_DOWNLOAD_WINDOW};
+
     void AddToCompactExtraTransactions(const CTransactionRef& tx) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 
     /** Orphan/conflicted/etc transactions that are kept for compact block reconstruction.
@@ -1173,6 +1270,10 @@ private:
      */
     bool SetupAddressRelay(const CNode& node, Peer& peer) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 
+    /** Take a token from the peer's bucket for a trust-layer message type.
+     *  Returns false if the bucket is empty and the message must be dropped. */
+    bool ConsumeTrustMessageToken(Peer& peer, TrustMessage type) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
     void AddAddressKnown(Peer& peer, const CAddress& addr) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
     void PushAddress(Peer& peer, const CAddress& addr) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 };
@@ -1358,7 +1459,7 @@ bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, st
     RemoveBlockRequest(hash, nodeid);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {&block, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool, &m_chainman) : nullptr)});
+            {&block, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool, &m_chainman) : nullptr), GetTime<std::chrono::microseconds>()});
     if (state->vBlocksInFlight.size() == 1) {
         // We're starting a block download (batch) from this peer.
         state->m_downloading_since = GetTime<std::chrono::microseconds>();
@@ -1371,6 +1472,29 @@ bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, st
     return true;
 }
 
+void PeerManagerImpl::BlockDelivered(NodeId nodeid, const uint256& hash)
+{
+    for (auto range = mapBlocksInFlight.equal_range(hash); range.first != range.second; range.first++) {
+        auto [node_id, list_it] = range.first->second;
+        if (node_id != nodeid) continue;
+
+        CNodeState& state = *Assert(State(nodeid));
+        const auto latency{GetTime<std::chrono::microseconds>() - list_it->m_requested_time};
+        if (latency > m_block_stalling_timeout.load()) {
+            // Slow enough to hold back other peers at the end of the window
+            state.m_max_blocks_in_flight = std::max(MIN_BLOCKS_IN_TRANSIT_PER_PEER, state.m_max_blocks_in_flight / 2);
+        } else if (static_cast<int>(state.vBlocksInFlight.size()) >= state.m_max_blocks_in_flight) {
+            // Kept up with a full queue, so more in flight may use its bandwidth better
+            state.m_max_blocks_in_flight = std::min(MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE, state.m_max_blocks_in_flight + 1);
+        }
+        if (state.m_stalling_since != 0us && m_block_download_window < int{MAX_BLOCK_DOWNLOAD_WINDOW}) {
+            m_block_download_window = std::min<int>(MAX_BLOCK_DOWNLOAD_WINDOW, m_block_download_window + BLOCK_DOWNLOAD_WINDOW / 4);
+            LogDebug(BCLog::NET, "Stalling peer=%d delivered, block download window now %d\n", nodeid, m_block_download_window);
+        }
+        return;
+    }
+}
+
 void PeerManagerImpl::MaybeSetPeerAsAnnouncingHeaderAndIDs(NodeId nodeid)
 {
     AssertLockHeld(cs_main);
@@ -1387,6 +1511,15 @@ void PeerManagerImpl::MaybeSetPeerAsAnnouncingHeaderAndIDs(NodeId nodeid)
         return;
     }
 
+    // Validator relay peers are high-bandwidth for the whole connection and
+    // must not take, or be rotated out of, one of the three slots below
+    bool validator_relay{false};
+    m_connman.ForNode(nodeid, [&validator_relay](CNode* pnode) {
+        validator_relay = pnode->IsValidatorRelayConn();
+        return true;
+    });
+    if (validator_relay) return;
+
     int num_outbound_hb_peers = 0;
     for (std::list<NodeId>::iterator it = lNodesAnnouncingHeaderAndIDs.begin(); it != lNodesAnnouncingHeaderAndIDs.end(); it++) {
         if (*it == nodeid) {
@@ -1537,7 +1670,7 @@ void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int co
     // Never fetch further than the best block we know the peer has, or more than BLOCK_DOWNLOAD_WINDOW + 1 beyond the last
     // linked block we have in common with this peer. The +1 is so we can detect stalling, namely if we would be able to
     // download that next block if the window were 1 larger.
-    int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
+    int nWindowEnd = state->pindexLastCommonBlock->nHeight + m_block_download_window;
 
     FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller);
 }
@@ -1568,7 +1701,7 @@ void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned
         return;
     }
 
-    FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + BLOCK_DOWNLOAD_WINDOW, target_block->nHeight));
+    FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + m_block_download_window, target_block->nHeight));
 }
 
 void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller)
@@ -1770,6 +1903,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
         m_txdownloadman.DisconnectedPeer(nodeid);
     }
     if (m_txreconciliation) m_txreconciliation->ForgetPeer(nodeid);
+    if (messaging::g_message_manager) messaging::g_message_manager->RemovePeer(nodeid);
     m_num_preferred_download_peers -= state->fPreferredDownload;
     m_peers_downloading_from -= (!state->vBlocksInFlight.empty());
     assert(m_peers_downloading_from >= 0);
@@ -1789,7 +1923,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
     }
     } // cs_main
     if (node.fSuccessfullyConnected &&
-        !node.IsBlockOnlyConn() && !node.IsInboundConn()) {
+        !node.IsBlockOnlyConn() && !node.IsValidatorRelayConn() && !node.IsInboundConn()) {
         // Only change visible addrman state for full outbound peers.  We don't
         // call Connected() for feeler connections since they don't have
         // fSuccessfullyConnected set.
@@ -2077,8 +2211,7 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
       m_warnings{warnings},
       m_opts{opts}
 {
-    // While Erlay support is incomplete, it must be enabled explicitly via -txreconciliation.
-    // This argument can go away after Erlay support is complete.
+    // Erlay can still be switched off with -txreconciliation=0, e.g. to compare bandwidth.
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
@@ -2177,6 +2310,7 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
     if (!DeploymentActiveAt(*pindex, m_chainman, Consensus::DEPLOYMENT_SEGWIT)) return;
 
     uint256 hashBlock(pblock->GetHash());
+    std::vector<std::pair<NodeId, BlockTransactionsRequest>> cut_through_requests;
     const std::shared_future<CSerializedNetMsg> lazy_ser{
         std::async(std::launch::deferred, [&] { return NetMsg::Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
 
@@ -2192,6 +2326,21 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         m_most_recent_block = pblock;
         m_most_recent_compact_block = pcmpctblock;
         m_most_recent_block_txs = std::move(most_recent_block_txs);
+        if (m_cut_through_hash == hashBlock) {
+            cut_through_requests.swap(m_cut_through_requests);
+            m_cut_through_hash.SetNull();
+        }
+    }
+
+    for (const auto& [peer_id, req] : cut_through_requests) {
+        PeerRef peer{GetPeerRef(peer_id)};
+        if (!peer) continue;
+        m_connman.ForNode(peer_id, [&](CNode* pnode) {
+            if (pnode->fDisconnect) return false;
+            LogDebug(BCLog::NET, "answering deferred getblocktxn for %s from peer=%d\n", hashBlock.ToString(), peer_id);
+            SendBlockTransactions(*pnode, *peer, *pblock, req);
+            return true;
+        });
     }
 
     m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
@@ -2215,6 +2364,43 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
     });
 }
 
+void PeerManagerImpl::MaybeCutThroughCompactBlock(const CNode& pfrom, const CBlockIndex& index, const CBlockHeaderAndShortTxIDs& cmpctblock)
+{
+    if (!m_opts.validator_cut_through || !cmpctblock.header.IsProofOfStake()) return;
+
+    std::optional<CSerializedNetMsg> ser_cmpctblock;
+    {
+    LOCK(cs_main);
+    // The header's stake is only checked outside of IBD, see CheckBlockHeader()
+    if (m_chainman.IsInitialBlockDownload()) return;
+    if (index.nStatus & BLOCK_HAVE_DATA || index.pprev != m_chainman.ActiveChain().Tip()) return;
+    if (index.nHeight <= m_highest_cut_through || index.nHeight <= m_highest_fast_announce) return;
+    m_highest_cut_through = index.nHeight;
+
+    m_connman.ForEachNode([&](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+        AssertLockHeld(::cs_main);
+
+        if (!pnode->IsValidatorRelayConn() || pnode->GetId() == pfrom.GetId() || pnode->fDisconnect) return;
+        if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION) return;
+        ProcessBlockAvailability(pnode->GetId());
+        CNodeState& state = *State(pnode->GetId());
+        if (state.m_requested_hb_cmpctblocks && !PeerHasHeader(&state, &index) && PeerHasHeader(&state, index.pprev)) {
+            LogDebug(BCLog::NET, "cutting through header-and-ids %s from peer=%d to peer=%d\n",
+                     index.GetBlockHash().ToString(), pfrom.GetId(), pnode->GetId());
+            if (!ser_cmpctblock) ser_cmpctblock = NetMsg::Make(NetMsgType::CMPCTBLOCK, cmpctblock);
+            PushMessage(*pnode, ser_cmpctblock->Copy());
+            state.pindexBestHeaderSent = &index;
+        }
+    });
+    }
+
+    if (ser_cmpctblock) {
+        LOCK(m_most_recent_block_mutex);
+        m_cut_through_hash = index.GetBlockHash();
+        m_cut_through_requests.clear();
+    }
+}
+
 /**
  * Update our best height and announce any block hashes which weren't previously
  * in m_chainman.ActiveChain() to our peers.
@@ -2250,6 +2436,20 @@ void PeerManagerImpl::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlock
         }
     }
 
+    // WATTx: Announce the heartbeats received since the last block, once per block
+    if (trust::g_heartbeat_manager) {
+        for (const trust::CompactHeartbeats& compact : trust::g_heartbeat_manager->GetHeartbeatAnnouncements(FastRandomContext().rand64())) {
+            m_connman.ForEachNode([this, &compact](CNode* pnode) {
+                if (pnode->fSuccessfullyConnected && !pnode->fDisconnect) {
+                    MakeAndPushMessage(*pnode, NetMsgType::HBCOMPACT, compact);
+                }
+            });
+        }
+
+        // WATTx: Point the validator relay connections at the best validators
+        m_connman.SetValidatorRelayAddresses(trust::g_heartbeat_manager->GetValidatorRelayPeers());
+    }
+
     m_connman.WakeMessageHandler();
 }
 
@@ -2376,6 +2576,33 @@ void PeerManagerImpl::RelayAddress(NodeId originator,
     }
 }
 
+std::optional<CSerializedNetMsg> PeerManagerImpl::GetSerializedBlock(const uint256& hash, bool witness)
+{
+    LOCK(m_serialized_blocks_mutex);
+    for (const SerializedBlockMsg& entry : m_serialized_blocks) {
+        if (entry.hash == hash && entry.witness == witness) return entry.msg.Copy();
+    }
+    return std::nullopt;
+}
+
+void PeerManagerImpl::CacheSerializedBlock(const uint256& hash, bool witness, const CSerializedNetMsg& msg)
+{
+    if (msg.data.size() > MAX_SERIALIZED_BLOCK_CACHE_BYTES) return;
+    LOCK(m_serialized_blocks_mutex);
+    for (const SerializedBlockMsg& entry : m_serialized_blocks) {
+        // Two peers may have asked for the same block at once
+        if (entry.hash == hash && entry.witness == witness) return;
+    }
+    while (!m_serialized_blocks.empty() &&
+           (m_serialized_blocks_bytes + msg.data.size() > MAX_SERIALIZED_BLOCK_CACHE_BYTES ||
+            m_serialized_blocks.size() >= 2 * MAX_SERIALIZED_BLOCK_DEPTH)) {
+        m_serialized_blocks_bytes -= m_serialized_blocks.front().msg.data.size();
+        m_serialized_blocks.pop_front();
+    }
+    m_serialized_blocks.push_back({hash, witness, msg.Copy()});
+    m_serialized_blocks_bytes += msg.data.size();
+}
+
 void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
 {
     std::shared_ptr<const CBlock> a_recent_block;
@@ -2451,9 +2678,15 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         block_pos = pindex->GetBlockPos();
     }
 
+    // Blocks near the tip are requested by many peers in turn, so their messages are kept serialized
+    const bool cache_msg{(inv.IsMsgBlk() || inv.IsMsgWitnessBlk()) && tip->nHeight - pindex->nHeight < MAX_SERIALIZED_BLOCK_DEPTH};
+    std::optional<CSerializedNetMsg> cached_msg;
+    if (cache_msg) cached_msg = GetSerializedBlock(pindex->GetBlockHash(), inv.IsMsgWitnessBlk());
+
     std::shared_ptr<const CBlock> pblock;
-    if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
-        pblock = a_recent_block;
+    if (cached_msg) {
+        PushMessage(pfrom, std::move(*cached_msg));
+        // Don't set pblock as we've sent the block
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
         // as the network format matches the format on disk
@@ -2467,8 +2700,12 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
             pfrom.fDisconnect = true;
             return;
         }
-        MakeAndPushMessage(pfrom, NetMsgType::BLOCK, Span{block_data});
+        CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, Span{block_data})};
+        if (cache_msg) CacheSerializedBlock(pindex->GetBlockHash(), /*witness=*/true, msg);
+        PushMessage(pfrom, std::move(msg));
         // Don't set pblock as we've sent the block
+    } else if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
+        pblock = a_recent_block;
     } else {
         // Send block from disk
         std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -2485,9 +2722,9 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     }
     if (pblock) {
         if (inv.IsMsgBlk()) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_NO_WITNESS(*pblock));
-        } else if (inv.IsMsgWitnessBlk()) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_WITH_WITNESS(*pblock));
+            CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, TX_NO_WITNESS(*pblock))};
+            if (cache_msg) CacheSerializedBlock(pindex->GetBlockHash(), /*witness=*/false, msg);
+            PushMessage(pfrom, std::move(msg));
         } else if (inv.IsMsgFilteredBlk()) {
             bool sendMerkleBlock = false;
             CMerkleBlock merkleBlock;
@@ -2602,6 +2839,22 @@ void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic
         }
     }
 
+    // WATTx: Encrypted P2P messages are cheap to serve, batch them like transactions
+    while (it != peer.m_getdata_requests.end() && it->IsMsgEncMsg()) {
+        if (interruptMsgProc) return;
+        if (pfrom.fPauseSend) break;
+
+        const CInv &inv = *it++;
+
+        messaging::EncryptedMessage msg;
+        auto* msgMgr = messaging::g_message_manager.get();
+        if (msgMgr && msgMgr->GetRelayMessage(inv.hash, msg)) {
+            MakeAndPushMessage(pfrom, NetMsgType::ENCMSG, msg);
+        } else {
+            vNotFound.push_back(inv);
+        }
+    }
+
     // Only process one BLOCK item per call, since they're uncommon and can be
     // expensive to process.
     if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend) {
@@ -3360,8 +3613,10 @@ bool PeerManagerImpl::PrepareBlockFilterRequest(CNode& node, Peer& peer,
                                                 const CBlockIndex*& stop_index,
                                                 BlockFilterIndex*& filter_index)
 {
+    // The EVM log filters are served alongside the basic ones when indexed
     const bool supported_filter_type =
-        (filter_type == BlockFilterType::BASIC &&
+        ((filter_type == BlockFilterType::BASIC ||
+          (filter_type == BlockFilterType::EVM_LOG && GetBlockFilterIndex(filter_type))) &&
          (peer.m_our_services & NODE_COMPACT_FILTERS));
     if (!supported_filter_type) {
         LogDebug(BCLog::NET, "peer requested unsupported block filter type: %d, %s\n",
@@ -3755,11 +4010,13 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         // Only initialize the Peer::TxRelay m_relay_txs data structure if:
         // - this isn't an outbound block-relay-only connection, and
+        // - this isn't an outbound validator relay connection, and
         // - this isn't an outbound feeler connection, and
         // - fRelay=true (the peer wishes to receive transaction announcements)
         //   or we're offering NODE_BLOOM to this peer. NODE_BLOOM means that
         //   the peer may turn on transaction relay later.
         if (!pfrom.IsBlockOnlyConn() &&
+            !pfrom.IsValidatorRelayConn() &&
             !pfrom.IsFeelerConn() &&
             (fRelay || (peer->m_our_services & NODE_BLOOM))) {
             auto* const tx_relay = peer->SetTxRelay();
@@ -3974,6 +4231,14 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         // save whether peer selects us as BIP152 high-bandwidth peer
         // (receiving sendcmpct(1) signals high-bandwidth, sendcmpct(0) low-bandwidth)
         pfrom.m_bip152_highbandwidth_from = sendcmpct_hb;
+
+        // WATTx: Select validator relay peers as high-bandwidth right away,
+        // outside the three BIP152 slots, so blocks between stakers are
+        // announced without an inv/getdata round trip
+        if (pfrom.IsValidatorRelayConn() && !pfrom.m_bip152_highbandwidth_to && !m_opts.ignore_incoming_txs) {
+            MakeAndPushMessage(pfrom, NetMsgType::SENDCMPCT, /*high_bandwidth=*/true, /*version=*/CMPCTBLOCKS_VERSION);
+            pfrom.m_bip152_highbandwidth_to = true;
+        }
         return;
     }
 
@@ -4185,6 +4450,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         const auto current_time{GetTime<std::chrono::microseconds>()};
         uint256* best_block{nullptr};
+        std::vector<CInv> encmsg_getdata;
 
         for (CInv& inv : vInv) {
             if (interruptMsgProc) return;
@@ -4220,16 +4486,29 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 }
                 const GenTxid gtxid = ToGenTxid(inv);
                 AddKnownTx(*peer, inv.hash);
+                if (m_txreconciliation && inv.IsMsgWtx()) {
+                    m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), Wtxid::FromUint256(inv.hash));
+                }
 
                 if (!m_chainman.IsInitialBlockDownload()) {
                     const bool fAlreadyHave{m_txdownloadman.AddTxAnnouncement(pfrom.GetId(), gtxid, current_time)};
                     LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
                 }
+            } else if (inv.IsMsgEncMsg()) {
+                // WATTx: Fetch encrypted P2P messages we haven't seen, from one announcer at a time
+                auto* msgMgr = messaging::g_message_manager.get();
+                if (msgMgr && msgMgr->ReceivedInventory(pfrom.GetId(), inv.hash, count_seconds(std::chrono::duration_cast<std::chrono::seconds>(current_time)))) {
+                    encmsg_getdata.push_back(inv);
+                }
             } else {
                 LogDebug(BCLog::NET, "Unknown inv type \"%s\" received from peer=%d\n", inv.ToString(), pfrom.GetId());
             }
         }
 
+        if (!encmsg_getdata.empty()) {
+            MakeAndPushMessage(pfrom, NetMsgType::GETDATA, encmsg_getdata);
+        }
+
         if (best_block != nullptr) {
             // If we haven't started initial headers-sync with this peer, then
             // consider sending a getheaders now. On initial startup, there's a
@@ -4358,8 +4637,15 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         std::shared_ptr<const CBlock> recent_block;
         {
             LOCK(m_most_recent_block_mutex);
-            if (m_most_recent_block_hash == req.blockhash)
+            if (m_most_recent_block_hash == req.blockhash) {
                 recent_block = m_most_recent_block;
+            } else if (!m_cut_through_hash.IsNull() && m_cut_through_hash == req.blockhash) {
+                // We cut this block through before having it; answer once it arrives
+                if (m_cut_through_requests.size() < MAX_CUT_THROUGH_REQUESTS) {
+                    m_cut_through_requests.emplace_back(pfrom.GetId(), std::move(req));
+                }
+                return;
+            }
             // Unlock m_most_recent_block_mutex to avoid cs_main lock inversion
         }
         if (recent_block) {
@@ -4512,6 +4798,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         const uint256& hash = peer->m_wtxid_relay ? wtxid : txid;
         AddKnownTx(*peer, hash);
+        if (m_txreconciliation) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), ptx->GetWitnessHash());
 
         LOCK2(cs_main, m_tx_download_mutex);
 
@@ -4609,6 +4896,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         if (received_new_header) {
             LogInfo("Saw new cmpctblock header hash=%s peer=%d\n",
                 blockhash.ToString(), pfrom.GetId());
+            if (pindex) MaybeCutThroughCompactBlock(pfrom, *pindex, cmpctblock);
         }
 
         bool fProcessBLOCKTXN = false;
@@ -4896,6 +5184,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            BlockDelivered(pfrom.GetId(), hash);
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -5136,6 +5425,57 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) return;
+        std::vector<uint16_t> set_sizes;
+        ReconciliationRequest request;
+        vRecv >> set_sizes >> request.q;
+        std::vector<std::vector<uint8_t>> sketches;
+        if (set_sizes.size() != RECON_SET_COUNT) {
+            LogDebug(BCLog::NET, "reqrecon with %u sets, %s\n", set_sizes.size(), pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        std::copy(set_sizes.begin(), set_sizes.end(), request.set_sizes.begin());
+        if (!m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), GetTime<std::chrono::microseconds>(), request, sketches)) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reqrecon), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        MakeAndPushMessage(pfrom, NetMsgType::SKETCH, sketches);
+        return;
+    }
+
+    if (msg_type == NetMsgType::SKETCH) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) return;
+        std::vector<std::vector<uint8_t>> sketches;
+        vRecv >> sketches;
+        std::vector<Wtxid> txs_to_announce;
+        ReconciliationDifference difference;
+        if (!m_txreconciliation->HandleSketch(pfrom.GetId(), sketches, txs_to_announce, difference)) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected or malformed sketch), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        AnnounceReconciledTxs(pfrom, *peer, txs_to_announce);
+        MakeAndPushMessage(pfrom, NetMsgType::RECONCILDIFF, difference.success, difference.ask_shortids);
+        return;
+    }
+
+    if (msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) return;
+        ReconciliationDifference difference;
+        vRecv >> difference.success >> difference.ask_shortids;
+        std::vector<Wtxid> txs_to_announce;
+        if (!m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), difference, txs_to_announce)) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reconcildiff), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        AnnounceReconciledTxs(pfrom, *peer, txs_to_announce);
+        return;
+    }
+
     if (msg_type == NetMsgType::GETCFILTERS) {
         ProcessGetCFilters(pfrom, *peer, vRecv);
         return;
@@ -5155,7 +5495,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         std::vector<CInv> vInv;
         vRecv >> vInv;
         std::vector<uint256> tx_invs;
-        if (vInv.size() <= node::MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        if (vInv.size() <= node::MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE) {
             for (CInv &inv : vInv) {
                 if (inv.IsGenTxMsg()) {
                     tx_invs.emplace_back(inv.hash);
@@ -5167,6 +5507,19 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    // WATTx: Budget the trust-layer messages of each peer before paying for
+    // deserialization, signature checks or a validator list reply
+    std::optional<TrustMessage> trust_msg;
+    if (msg_type == NetMsgType::HEARTBEAT) trust_msg = TrustMessage::HEARTBEAT;
+    else if (msg_type == NetMsgType::GETVALIDATORS) trust_msg = TrustMessage::GETVALIDATORS;
+    else if (msg_type == NetMsgType::VALIDATORS) trust_msg = TrustMessage::VALIDATORS;
+    else if (msg_type == NetMsgType::REGVALIDATOR) trust_msg = TrustMessage::REGVALIDATOR;
+    else if (msg_type == NetMsgType::ENCMSG) trust_msg = TrustMessage::ENCMSG;
+    if (trust_msg && !ConsumeTrustMessageToken(*peer, *trust_msg)) {
+        LogDebug(BCLog::NET, "Dropping rate limited %s message from peer=%d\n", msg_type, pfrom.GetId());
+        return;
+    }
+
     // WATTx: Handle heartbeat messages from validators
     if (msg_type == NetMsgType::HEARTBEAT) {
         trust::Heartbeat heartbeat;
@@ -5182,13 +5535,49 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::HBCOMPACT) {
+        trust::CompactHeartbeats compact;
+        vRecv >> compact;
+
+        trust::HeartbeatsRequest request;
+        if (trust::g_heartbeat_manager && trust::g_heartbeat_manager->GetMissingHeartbeats(compact, request)) {
+            LogDebug(BCLog::NET, "Requesting %d of %d heartbeats for block %s from peer=%d\n",
+                     request.indexes.size(), compact.shortids.size(), compact.blockHash.ToString(), pfrom.GetId());
+            MakeAndPushMessage(pfrom, NetMsgType::GETHBEATS, request);
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::GETHBEATS) {
+        trust::HeartbeatsRequest request;
+        vRecv >> request;
+
+        trust::BlockHeartbeats response;
+        if (trust::g_heartbeat_manager && trust::g_heartbeat_manager->GetRequestedHeartbeats(request, response)) {
+            MakeAndPushMessage(pfrom, NetMsgType::HBEATS, response);
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::HBEATS) {
+        trust::BlockHeartbeats response;
+        vRecv >> response;
+
+        if (trust::g_heartbeat_manager) {
+            size_t processed = trust::g_heartbeat_manager->ProcessHeartbeats(response.heartbeats, pfrom.GetId());
+            LogDebug(BCLog::NET, "Received %d heartbeats (%d new) for block %s from peer=%d\n",
+                     response.heartbeats.size(), processed, response.blockHash.ToString(), pfrom.GetId());
+        }
+        return;
+    }
+
     if (msg_type == NetMsgType::GETVALIDATORS) {
-        // Return list of known validators
+        // Return list of known validators, serialized once per block
         if (trust::g_heartbeat_manager) {
-            trust::ValidatorList list = trust::g_heartbeat_manager->GetValidatorList();
-            MakeAndPushMessage(pfrom, NetMsgType::VALIDATORS, list);
-            LogDebug(BCLog::NET, "Sent validator list (%d validators) to peer=%d\n",
-                     list.validators.size(), pfrom.GetId());
+            const auto list_data = trust::g_heartbeat_manager->GetSerializedValidatorList();
+            MakeAndPushMessage(pfrom, NetMsgType::VALIDATORS, Span{*list_data});
+            LogDebug(BCLog::NET, "Sent validator list (%d bytes) to peer=%d\n",
+                     list_data->size(), pfrom.GetId());
         }
         return;
     }
@@ -5691,6 +6080,33 @@ void PeerManagerImpl::MaybeSendSendHeaders(CNode& node, Peer& peer)
     }
 }
 
+/** The reconciliation set a transaction is announced through. */
+static ReconciliationSet GetReconciliationSet(const CTransaction& tx)
+{
+    if (privacy::HasPrivacyData(tx) || privacy::HasFcmpInputs(tx)) return ReconciliationSet::PRIVACY;
+    if (tx.HasCreateOrCall()) return ReconciliationSet::CONTRACT;
+    return ReconciliationSet::DEFAULT;
+}
+
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, Peer& peer, const std::vector<Wtxid>& wtxids)
+{
+    auto tx_relay = peer.GetTxRelay();
+    if (!tx_relay || wtxids.empty()) return;
+
+    std::vector<CInv> invs;
+    LOCK(tx_relay->m_tx_inventory_mutex);
+    for (const Wtxid& wtxid : wtxids) {
+        if (!m_mempool.exists(GenTxid::Wtxid(wtxid.ToUint256()))) continue;
+        tx_relay->m_tx_inventory_known_filter.insert(wtxid.ToUint256());
+        invs.emplace_back(MSG_WTX, wtxid.ToUint256());
+        if (invs.size() == MAX_INV_SZ) {
+            MakeAndPushMessage(node, NetMsgType::INV, invs);
+            invs.clear();
+        }
+    }
+    if (!invs.empty()) MakeAndPushMessage(node, NetMsgType::INV, invs);
+}
+
 void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::microseconds current_time)
 {
     if (m_opts.ignore_incoming_txs) return;
@@ -5699,7 +6115,7 @@ void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::mi
     if (pto.HasPermission(NetPermissionFlags::ForceRelay)) return;
     // Don't send feefilter messages to outbound block-relay-only peers since they should never announce
     // transactions to us, regardless of feefilter state.
-    if (pto.IsBlockOnlyConn()) return;
+    if (pto.IsBlockOnlyConn() || pto.IsValidatorRelayConn()) return;
 
     CAmount currentFilter = m_mempool.GetMinFee().GetFeePerK();
 
@@ -5756,8 +6172,8 @@ public:
 
 bool PeerManagerImpl::RejectIncomingTxs(const CNode& peer) const
 {
-    // block-relay-only peers may never send txs to us
-    if (peer.IsBlockOnlyConn()) return true;
+    // block-relay-only and validator relay peers may never send txs to us
+    if (peer.IsBlockOnlyConn() || peer.IsValidatorRelayConn()) return true;
     if (peer.IsFeelerConn()) return true;
     // In -blocksonly mode, peers need the 'relay' permission to send txs to us
     if (m_opts.ignore_incoming_txs && !peer.HasPermission(NetPermissionFlags::Relay)) return true;
@@ -5768,8 +6184,9 @@ bool PeerManagerImpl::SetupAddressRelay(const CNode& node, Peer& peer)
 {
     // We don't participate in addr relay with outbound block-relay-only
     // connections to prevent providing adversaries with the additional
-    // information of addr traffic to infer the link.
-    if (node.IsBlockOnlyConn()) return false;
+    // information of addr traffic to infer the link. The same goes for
+    // validator relay connections, which would otherwise expose stakers.
+    if (node.IsBlockOnlyConn() || node.IsValidatorRelayConn()) return false;
 
     if (!peer.m_addr_relay_enabled.exchange(true)) {
         // During version message processing (non-block-relay-only outbound peers)
@@ -5781,6 +6198,22 @@ bool PeerManagerImpl::SetupAddressRelay(const CNode& node, Peer& peer)
     return true;
 }
 
+bool PeerManagerImpl::ConsumeTrustMessageToken(Peer& peer, TrustMessage type)
+{
+    const size_t index{static_cast<size_t>(type)};
+    const TrustMessageBudget& budget{TRUST_MESSAGE_BUDGETS[index]};
+    double& tokens{peer.m_trust_msg_tokens[index]};
+
+    const auto current_time{GetTime<std::chrono::microseconds>()};
+    const auto time_diff{std::max(current_time - peer.m_trust_msg_token_timestamps[index], 0us)};
+    tokens = std::min(tokens + Ticks<SecondsDouble>(time_diff) * budget.rate_per_second, budget.bucket_size);
+    peer.m_trust_msg_token_timestamps[index] = current_time;
+
+    if (tokens < 1.0) return false;
+    tokens -= 1.0;
+    return true;
+}
+
 bool PeerManagerImpl::SendMessages(CNode* pto)
 {
     AssertLockNotHeld(m_tx_download_mutex);
@@ -6127,6 +6560,15 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        // Reconciling peers learn most transactions through the next round instead
+                        if (m_txreconciliation && peer->m_wtxid_relay) {
+                            const Wtxid wtxid{Wtxid::FromUint256(hash)};
+                            if (!m_txreconciliation->ShouldFanoutTo(wtxid, pto->GetId()) &&
+                                m_txreconciliation->AddToSet(pto->GetId(), wtxid, GetReconciliationSet(*txinfo.tx))) {
+                                tx_relay->m_tx_inventory_known_filter.insert(hash);
+                                continue;
+                            }
+                        }
                         // Send
                         vInv.push_back(inv);
                         nRelayedTransactions++;
@@ -6145,6 +6587,19 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         if (!vInv.empty())
             MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
 
+        //
+        // Message: reqrecon
+        //
+        if (m_txreconciliation && peer->GetTxRelay() != nullptr) {
+            std::vector<Wtxid> txs_to_announce;
+            m_txreconciliation->ExpireStaleRounds(pto->GetId(), current_time, txs_to_announce);
+            AnnounceReconciledTxs(*pto, *peer, txs_to_announce);
+            if (const auto request{m_txreconciliation->InitiateReconciliationRequest(pto->GetId(), current_time)}) {
+                const std::vector<uint16_t> set_sizes(request->set_sizes.begin(), request->set_sizes.end());
+                MakeAndPushMessage(*pto, NetMsgType::REQRECON, set_sizes, request->q);
+            }
+        }
+
         // Detect whether we're stalling
         auto stalling_timeout = m_block_stalling_timeout.load();
         if (state.m_stalling_since.count() && state.m_stalling_since < current_time - stalling_timeout) {
@@ -6216,11 +6671,12 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        if (!m_chainman.IsInitialBlockDownload()) m_block_download_window = BLOCK_DOWNLOAD_WINDOW;
+        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && static_cast<int>(state.vBlocksInFlight.size()) < state.m_max_blocks_in_flight) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
             auto get_inflight_budget = [&state]() {
-                return std::max(0, MAX_BLOCKS_IN_TRANSIT_PER_PEER - static_cast<int>(state.vBlocksInFlight.size()));
+                return std::max(0, state.m_max_blocks_in_flight - static_cast<int>(state.vBlocksInFlight.size()));
             };
 
             // If a snapshot chainstate is in use, we want to find its next blocks
@@ -6244,9 +6700,23 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     pindex->nHeight, pto->GetId());
             }
             if (state.vBlocksInFlight.empty() && staller != -1) {
-                if (State(staller)->m_stalling_since == 0us) {
-                    State(staller)->m_stalling_since = current_time;
+                CNodeState& staller_state = *State(staller);
+                if (staller_state.m_stalling_since == 0us) {
+                    staller_state.m_stalling_since = current_time;
+                    // Hand the staller fewer blocks from now on, so the blocks validation needs next go to faster peers
+                    staller_state.m_max_blocks_in_flight = std::max(MIN_BLOCKS_IN_TRANSIT_PER_PEER, staller_state.m_max_blocks_in_flight / 2);
                     LogDebug(BCLog::NET, "Stall started peer=%d\n", staller);
+                } else if (vToDownload.empty() && !staller_state.vBlocksInFlight.empty() &&
+                           current_time - staller_state.m_stalling_since > m_block_stalling_timeout.load() / 2) {
+                    // Halfway to disconnecting the staller, fetch the block it holds back from this idle peer as well
+                    const CBlockIndex* pindex{staller_state.vBlocksInFlight.front().pindex};
+                    if (CanServeWitnesses(*peer) && mapBlocksInFlight.count(pindex->GetBlockHash()) < MAX_CMPCTBLOCKS_INFLIGHT_PER_BLOCK &&
+                        state.pindexBestKnownBlock && state.pindexBestKnownBlock->GetAncestor(pindex->nHeight) == pindex) {
+                        vGetData.emplace_back(MSG_BLOCK | GetFetchFlags(*peer), pindex->GetBlockHash());
+                        BlockRequested(pto->GetId(), *pindex);
+                        LogDebug(BCLog::NET, "Requesting block %s (%d) stalled by peer=%d from peer=%d\n", pindex->GetBlockHash().ToString(),
+                            pindex->nHeight, staller, pto->GetId());
+                    }
                 }
             }
         }
@@ -6269,20 +6739,22 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
             MakeAndPushMessage(*pto, NetMsgType::GETDATA, vGetData);
     } // release cs_main
 
-    // Relay encrypted P2P messages
-    {
-        auto* msgMgr = messaging::g_message_manager.get();
-        if (msgMgr) {
-            try {
-                auto messages = msgMgr->GetMessagesToRelay(pto->GetId(), 5);
-                for (const auto& msg : messages) {
-                    if (msg.IsValid() && !msg.msgHash.IsNull()) {
-                        MakeAndPushMessage(*pto, NetMsgType::ENCMSG, msg);
-                    }
-                }
-            } catch (...) {
-                // Silently ignore messaging errors
-            }
+    // Announce encrypted P2P messages. Invs are trickled on the transaction
+    // relay schedule and shuffled, so a message's origin doesn't show in
+    // when or in which order it is announced; peers fetch it with getdata.
+    if (auto* msgMgr = messaging::g_message_manager.get(); msgMgr && peer->m_next_encmsg_inv_send < current_time) {
+        if (pto->IsInboundConn()) {
+            peer->m_next_encmsg_inv_send = NextInvToInbounds(current_time, INBOUND_INVENTORY_BROADCAST_INTERVAL);
+        } else {
+            peer->m_next_encmsg_inv_send = current_time + m_rng.rand_exp_duration(OUTBOUND_INVENTORY_BROADCAST_INTERVAL);
+        }
+        std::vector<CInv> vInv;
+        for (const uint256& hash : msgMgr->GetInventoryToAnnounce(pto->GetId(), INVENTORY_BROADCAST_MAX)) {
+            vInv.emplace_back(MSG_ENCMSG, hash);
+        }
+        if (!vInv.empty()) {
+            std::shuffle(vInv.begin(), vInv.end(), m_rng);
+            MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
         }
     }
 
@@ -22,7 +22,7 @@ class Warnings;
 } // namespace node
 
 /** Whether transaction reconciliation protocol should be enabled by default. */
-static constexpr bool DEFAULT_TXRECONCILIATION_ENABLE{false};
+static constexpr bool DEFAULT_TXRECONCILIATION_ENABLE{true};
 /** Default for -maxorphantx, maximum number of orphan transactions kept in memory */
 static const uint32_t DEFAULT_MAX_ORPHAN_TRANSACTIONS{100};
 /** Default number of non-mempool transactions to keep around for block reconstruction. Includes
@@ -47,6 +47,8 @@ static const unsigned int DEFAULT_HEADER_SPAM_FILTER_MAX_AVG = 10;
 /** Default for -headerspamfilterignoreport, ignore the port in the ip address when looking for header spam,
  multiple nodes on the same ip will be treated as the one when computing the filter*/
 static const unsigned int DEFAULT_HEADER_SPAM_FILTER_IGNORE_PORT = true;
+/** Default for -validatorcutthrough. */
+static const bool DEFAULT_VALIDATOR_CUT_THROUGH = false;
 /** Default for -cleanblockindex. */
 static const bool DEFAULT_CLEANBLOCKINDEX = true;
 /** Default for -cleanblockindextimeout. */
@@ -94,6 +96,9 @@ public:
         //! Number of headers sent in one getheaders message result (this is
         //! a test-only option).
         uint32_t max_headers_result{MAX_HEADERS_RESULTS};
+        //! Whether to forward compact PoS blocks to validator relay peers once
+        //! their header is checked, before the block is connected
+        bool validator_cut_through{DEFAULT_VALIDATOR_CUT_THROUGH};
     };
 
     static std::unique_ptr<PeerManager> make(CConnman& connman, AddrMan& addrman,
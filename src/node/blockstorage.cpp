@@ -39,10 +39,20 @@
 #include <chainparams.h>
 
 #include <cstddef>
+#include <cstring>
+#include <future>
 #include <map>
 #include <ranges>
+#include <thread>
 #include <unordered_map>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace kernel {
 static constexpr uint8_t DB_BLOCK_FILES{'f'};
 static constexpr uint8_t DB_BLOCK_INDEX{'b'};
@@ -63,6 +73,11 @@ static constexpr uint8_t DB_ADDRESSUNSPENTINDEX{'u'};
 static constexpr uint8_t DB_TIMESTAMPINDEX{'S'};
 static constexpr uint8_t DB_BLOCKHASHINDEX{'z'};
 static constexpr uint8_t DB_SPENTINDEX{'p'};
+static constexpr uint8_t DB_TOPICINDEX{'e'};
+static constexpr uint8_t DB_ADDRESSTOPICINDEX{'E'};
+static constexpr uint8_t DB_TOPICINDEXSTART{'o'};
+static constexpr uint8_t DB_LOGINDEXUNDO{'n'};
+static constexpr uint8_t DB_ADDRESSBALANCEINDEX{'A'};
 
 struct DelegateEntry {
     uint160 address;
@@ -137,61 +152,131 @@ bool BlockTreeDB::ReadFlag(const std::string& name, bool& fValue)
     return true;
 }
 
-bool BlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
+namespace {
+//! Block index records read from disk before they are decoded as one batch
+constexpr size_t BLOCK_INDEX_LOAD_BATCH{16384};
+//! Batches smaller than this are decoded on the loading thread
+constexpr size_t BLOCK_INDEX_LOAD_MIN_PARALLEL{1024};
+constexpr unsigned MAX_BLOCK_INDEX_LOAD_THREADS{16};
+
+struct DecodedBlockIndex {
+    CDiskBlockIndex diskindex;
+    uint256 hash;
+    bool decoded{false};
+    bool proof_checked{false};
+    bool proof_valid{true};
+};
+} // namespace
+
+bool BlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt,
+                                     bool check_all_pow, std::vector<CBlockIndex*>& newly_checked)
 {
     AssertLockHeld(::cs_main);
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
     pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
 
-    // Load m_block_index
-    while (pcursor->Valid()) {
+    // Skip PoW validation for blocks covered by assumevalid (height 131349)
+    // This dramatically speeds up initial sync with RandomX
+    static constexpr int ASSUME_VALID_HEIGHT = 131349;
+
+    // Decoding a record and hashing its header (and rehashing the proof of
+    // work of headers that were never checked) does not need the block index,
+    // so the cursor is drained in batches that are decoded on several threads.
+    // Only linking the entries into m_block_index happens on this thread.
+    const unsigned hardware_threads{std::max(1U, std::thread::hardware_concurrency())};
+    const size_t num_workers{std::min(hardware_threads, MAX_BLOCK_INDEX_LOAD_THREADS)};
+    auto decode = [&](std::vector<DataStream>& values, std::vector<DecodedBlockIndex>& decoded, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            DecodedBlockIndex& entry = decoded[i];
+            try {
+                values[i] >> entry.diskindex;
+            } catch (const std::exception&) {
+                continue;
+            }
+            entry.decoded = true;
+            const CBlockHeader header{entry.diskindex.ConstructBlockHeader()};
+            entry.hash = header.GetHash();
+
+            bool skipProofCheck = !consensusParams.defaultAssumeValid.IsNull() &&
+                                  entry.diskindex.nHeight <= ASSUME_VALID_HEIGHT;
+            // Headers whose proof of work was verified when they were accepted
+            // are not rehashed; X25X and RandomX make that the bulk of startup
+            if (entry.diskindex.nStatus & BLOCK_POW_CHECKED) skipProofCheck = true;
+            if (check_all_pow) skipProofCheck = false;
+            if (!skipProofCheck) {
+                entry.proof_checked = true;
+                entry.proof_valid = CheckIndexProof(header, entry.diskindex.nHeight, consensusParams);
+            }
+        }
+    };
+
+    std::vector<DataStream> values;
+    bool done{false};
+    while (!done) {
         if (interrupt) return false;
-        std::pair<uint8_t, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.ConstructBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nMoneySupply   = diskindex.nMoneySupply;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-                pindexNew->hashStateRoot  = diskindex.hashStateRoot; // qtum
-                pindexNew->hashUTXORoot   = diskindex.hashUTXORoot; // qtum
-                pindexNew->nStakeModifier = diskindex.nStakeModifier;
-                pindexNew->prevoutStake   = diskindex.prevoutStake;
-                pindexNew->vchBlockSigDlgt    = diskindex.vchBlockSigDlgt; // qtum
-
-                // Skip PoW validation for blocks covered by assumevalid (height 131349)
-                // This dramatically speeds up initial sync with RandomX
-                static constexpr int ASSUME_VALID_HEIGHT = 131349;
-                bool skipProofCheck = !consensusParams.defaultAssumeValid.IsNull() &&
-                                      pindexNew->nHeight <= ASSUME_VALID_HEIGHT;
-
-                if (!skipProofCheck && !CheckIndexProof(*pindexNew, consensusParams)) {
-                    LogError("%s: CheckIndexProof failed: %s\n", __func__, pindexNew->ToString());
-                    return false;
-                }
+        values.clear();
+        while (values.size() < BLOCK_INDEX_LOAD_BATCH && pcursor->Valid()) {
+            std::pair<uint8_t, uint256> key;
+            if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX) break;
+            values.push_back(pcursor->GetValueStream());
+            pcursor->Next();
+        }
+        if (values.size() < BLOCK_INDEX_LOAD_BATCH) done = true;
+        if (values.empty()) break;
+
+        std::vector<DecodedBlockIndex> decoded(values.size());
+        const size_t workers{values.size() < BLOCK_INDEX_LOAD_MIN_PARALLEL ? 1 : num_workers};
+        const size_t chunk{(values.size() + workers - 1) / workers};
+        std::vector<std::future<void>> futures;
+        for (size_t begin = chunk; begin < values.size(); begin += chunk) {
+            futures.push_back(std::async(std::launch::async, decode, std::ref(values), std::ref(decoded),
+                                         begin, std::min(begin + chunk, values.size())));
+        }
+        decode(values, decoded, 0, std::min(chunk, values.size()));
+        for (auto& future : futures) future.get();
 
-                // NovaCoin: build setStakeSeen
-                if (pindexNew->IsProofOfStake())
-                    setStakeSeen.insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
-                pcursor->Next();
-            } else {
+        for (DecodedBlockIndex& entry : decoded) {
+            if (!entry.decoded) {
                 LogError("%s: failed to read value\n", __func__);
                 return false;
             }
-        } else {
-            break;
+            const CDiskBlockIndex& diskindex = entry.diskindex;
+
+            // Construct block index object
+            CBlockIndex* pindexNew = insertBlockIndex(entry.hash);
+            pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+            pindexNew->nMoneySupply   = diskindex.nMoneySupply;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nTx            = diskindex.nTx;
+            pindexNew->hashStateRoot  = diskindex.hashStateRoot; // qtum
+            pindexNew->hashUTXORoot   = diskindex.hashUTXORoot; // qtum
+            pindexNew->nStakeModifier = diskindex.nStakeModifier;
+            pindexNew->prevoutStake   = diskindex.prevoutStake;
+            pindexNew->vchBlockSigDlgt    = diskindex.vchBlockSigDlgt; // qtum
+
+            if (entry.proof_checked) {
+                if (!entry.proof_valid) {
+                    LogError("%s: CheckIndexProof failed: %s\n", __func__, pindexNew->ToString());
+                    return false;
+                }
+                if (pindexNew->IsProofOfWork() && !(pindexNew->nStatus & BLOCK_POW_CHECKED)) {
+                    pindexNew->nStatus |= BLOCK_POW_CHECKED;
+                    newly_checked.push_back(pindexNew);
+                }
+            }
+
+            // NovaCoin: build setStakeSeen
+            if (pindexNew->IsProofOfStake())
+                setStakeSeen.insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
         }
     }
 
@@ -207,7 +292,7 @@ bool BlockTreeDB::WriteHeightIndex(const CHeightTxIndexKey &heightIndex, const s
 
 int BlockTreeDB::ReadHeightIndex(int low, int high, int minconf,
         std::vector<std::vector<uint256>> &blocksOfHashes,
-        std::set<dev::h160> const &addresses, ChainstateManager &chainman) {
+        std::set<dev::h160> const &addresses, ChainstateManager &chainman, size_t limit) {
 
     if ((high < low && high > -1) || (high == 0 && low == 0) || (high < -1 || low < 0)) {
        return -1;
@@ -232,6 +317,10 @@ int BlockTreeDB::ReadHeightIndex(int low, int high, int minconf,
             break;
         }
 
+        if (limit > 0 && count >= limit && nextHeight != curheight) {
+            break;
+        }
+
         if (minconf > 0) {
             int conf = chainman.ActiveChain().Height() - nextHeight;
             if (conf < minconf) {
@@ -300,6 +389,168 @@ bool BlockTreeDB::WipeHeightIndex() {
     return WriteBatch(batch);
 }
 
+bool BlockTreeDB::WriteTopicIndex(const std::vector<std::pair<CTopicTxIndexKey, std::vector<uint256>>> &vect) {
+    if (vect.empty()) {
+        return true;
+    }
+
+    CDBBatch batch(*this);
+    if (!Exists(DB_TOPICINDEXSTART)) {
+        batch.Write(DB_TOPICINDEXSTART, vect.front().first.height);
+    }
+    for (const auto& [key, hashes] : vect) {
+        batch.Write(std::make_pair(DB_TOPICINDEX, key), hashes);
+        batch.Write(std::make_pair(DB_ADDRESSTOPICINDEX, CAddressTopicTxIndexKey(key.address, key.topic, key.height)), hashes);
+    }
+    return WriteBatch(batch);
+}
+
+int BlockTreeDB::ReadTopicIndex(const dev::h256 &topic, int low, int high,
+        std::vector<std::vector<uint256>> &blocksOfHashes,
+        std::set<dev::h160> const &addresses, size_t limit) {
+
+    if (high < low || low < 0) {
+        return -1;
+    }
+
+    // The scans of several addresses are merged by height
+    std::map<unsigned int, std::vector<uint256>> blocks;
+    int lastHeight = high;
+
+    auto collect = [&](unsigned int height, std::vector<uint256>&& hashes, size_t& count, int& prevHeight) {
+        if (limit > 0 && count >= limit && (int)height != prevHeight) {
+            // Everything below here is complete, the other scans need not go further
+            lastHeight = std::min(lastHeight, (int)height - 1);
+            return false;
+        }
+        count += hashes.size();
+        prevHeight = height;
+        auto& block = blocks[height];
+        block.insert(block.end(), hashes.begin(), hashes.end());
+        return true;
+    };
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    if (addresses.empty()) {
+        size_t count = 0;
+        int prevHeight = -1;
+        for (pcursor->Seek(std::make_pair(DB_TOPICINDEX, CTopicTxIndexKey(topic, low, dev::h160()))); pcursor->Valid(); pcursor->Next()) {
+            std::pair<uint8_t, CTopicTxIndexKey> key;
+            if (!pcursor->GetKey(key) || key.first != DB_TOPICINDEX || key.second.topic != topic || (int)key.second.height > lastHeight) {
+                break;
+            }
+            std::vector<uint256> hashes;
+            if (!pcursor->GetValue(hashes) || !collect(key.second.height, std::move(hashes), count, prevHeight)) {
+                break;
+            }
+        }
+    } else {
+        for (const dev::h160& address : addresses) {
+            size_t count = 0;
+            int prevHeight = -1;
+            for (pcursor->Seek(std::make_pair(DB_ADDRESSTOPICINDEX, CAddressTopicTxIndexKey(address, topic, low))); pcursor->Valid(); pcursor->Next()) {
+                std::pair<uint8_t, CAddressTopicTxIndexKey> key;
+                if (!pcursor->GetKey(key) || key.first != DB_ADDRESSTOPICINDEX || key.second.address != address ||
+                    key.second.topic != topic || (int)key.second.height > lastHeight) {
+                    break;
+                }
+                std::vector<uint256> hashes;
+                if (!pcursor->GetValue(hashes) || !collect(key.second.height, std::move(hashes), count, prevHeight)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    size_t count = 0;
+    for (auto& [height, hashes] : blocks) {
+        if ((int)height > lastHeight) {
+            break;
+        }
+        if (limit > 0 && count >= limit) {
+            lastHeight = height - 1;
+            break;
+        }
+        count += hashes.size();
+        blocksOfHashes.push_back(std::move(hashes));
+    }
+
+    return lastHeight;
+}
+
+bool BlockTreeDB::ReadTopicIndexStart(unsigned int &height) {
+    return Read(DB_TOPICINDEXSTART, height);
+}
+
+bool BlockTreeDB::EraseTopicIndex(const std::vector<CTopicTxIndexKey> &vect) {
+    CDBBatch batch(*this);
+    for (const CTopicTxIndexKey& key : vect) {
+        batch.Erase(std::make_pair(DB_TOPICINDEX, key));
+        batch.Erase(std::make_pair(DB_ADDRESSTOPICINDEX, CAddressTopicTxIndexKey(key.address, key.topic, key.height)));
+    }
+    return WriteBatch(batch);
+}
+
+bool BlockTreeDB::WipeTopicIndex() {
+
+    CDBBatch batch(*this);
+    auto eraseAll = [&](uint8_t prefix, auto key) {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        for (pcursor->Seek(prefix); pcursor->Valid(); pcursor->Next()) {
+            if (!pcursor->GetKey(key) || key.first != prefix) {
+                break;
+            }
+            batch.Erase(key);
+        }
+    };
+    eraseAll(DB_TOPICINDEX, std::pair<uint8_t, CTopicTxIndexKey>());
+    eraseAll(DB_ADDRESSTOPICINDEX, std::pair<uint8_t, CAddressTopicTxIndexKey>());
+    batch.Erase(DB_TOPICINDEXSTART);
+
+    return WriteBatch(batch);
+}
+
+bool BlockTreeDB::WriteLogIndexUndo(unsigned int height, const CLogIndexUndo &undo) {
+    return Write(std::make_pair(DB_LOGINDEXUNDO, height), undo);
+}
+
+bool BlockTreeDB::ReadLogIndexUndo(unsigned int height, CLogIndexUndo &undo) {
+    return Read(std::make_pair(DB_LOGINDEXUNDO, height), undo);
+}
+
+bool BlockTreeDB::EraseBlockIndexes(unsigned int height, const CLogIndexUndo *undo, bool stakeIndex) {
+    CDBBatch batch(*this);
+    if (undo) {
+        for (const CHeightTxIndexKey& key : undo->heightIndex) {
+            batch.Erase(std::make_pair(DB_HEIGHTINDEX, key));
+        }
+        for (const CTopicTxIndexKey& key : undo->topicIndex) {
+            batch.Erase(std::make_pair(DB_TOPICINDEX, key));
+            batch.Erase(std::make_pair(DB_ADDRESSTOPICINDEX, CAddressTopicTxIndexKey(key.address, key.topic, key.height)));
+        }
+        batch.Erase(std::make_pair(DB_LOGINDEXUNDO, height));
+    }
+    if (stakeIndex) {
+        batch.Erase(std::make_pair(DB_STAKEINDEX, height));
+        batch.Erase(std::make_pair(DB_DELEGATEINDEX, height));
+    }
+    return WriteBatch(batch);
+}
+
+bool BlockTreeDB::WipeLogIndexUndo() {
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    CDBBatch batch(*this);
+
+    for (pcursor->Seek(DB_LOGINDEXUNDO); pcursor->Valid(); pcursor->Next()) {
+        std::pair<uint8_t, unsigned int> key;
+        if (!pcursor->GetKey(key) || key.first != DB_LOGINDEXUNDO) {
+            break;
+        }
+        batch.Erase(key);
+    }
+
+    return WriteBatch(batch);
+}
 
 bool BlockTreeDB::WriteStakeIndex(unsigned int height, uint160 address) {
     CDBBatch batch(*this);
@@ -412,163 +663,36 @@ bool BlockTreeDB::EraseDelegateIndex(unsigned int height) {
     return WriteBatch(batch);
 }
 
-bool BlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+bool BlockTreeDB::WipeAddressIndex(const util::SignalInterrupt& interrupt) {
+    // Records of the address index kept here before it moved to indexes/addressindex
     CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
-    return WriteBatch(batch);
-}
-
-bool BlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
-    return WriteBatch(batch);
-}
-
-bool BlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
-                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                                    int start, int end) {
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    if (start > 0 && end > 0) {
-        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
-    } else {
-        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
-    }
-
-    while (pcursor->Valid()) {
-        std::pair<uint8_t,CAddressIndexKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.hashBytes == addressHash) {
-            if (end > 0 && key.second.blockHeight > end) {
+    auto eraseAll = [&](uint8_t prefix, auto key) {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        for (pcursor->Seek(prefix); pcursor->Valid(); pcursor->Next()) {
+            if (interrupt) return false;
+            if (!pcursor->GetKey(key) || key.first != prefix) {
                 break;
             }
-            CAmount nValue;
-            if (pcursor->GetValue(nValue)) {
-                addressIndex.push_back(std::make_pair(key.second, nValue));
-                pcursor->Next();
-            } else {
-                LogError("failed to get address index value");
-                return false;
-            }
-        } else {
-            break;
-        }
-    }
-
-    return true;
-}
-
-bool BlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
-        }
-    }
-    return WriteBatch(batch);
-}
-
-bool BlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
-                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
-
-    while (pcursor->Valid()) {
-        std::pair<uint8_t,CAddressUnspentKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash) {
-            CAddressUnspentValue nValue;
-            if (pcursor->GetValue(nValue)) {
-                unspentOutputs.push_back(std::make_pair(key.second, nValue));
-                pcursor->Next();
-            } else {
-                LogError("failed to get address unspent value");
-                return false;
-            }
-        } else {
-            break;
-        }
-    }
-
-    return true;
-}
-
-bool BlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex) {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
-    return WriteBatch(batch);
-}
-
-bool BlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes, ChainstateManager &chainman) {
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
-
-    while (pcursor->Valid()) {
-        std::pair<uint8_t, CTimestampIndexKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high) {
-            if (fActiveOnly) {
-                if (blockOnchainActive(key.second.blockHash, chainman)) {
-                    hashes.push_back(std::make_pair(key.second.blockHash, key.second.timestamp));
-                }
-            } else {
-                hashes.push_back(std::make_pair(key.second.blockHash, key.second.timestamp));
+            batch.Erase(key);
+            if (batch.SizeEstimate() > 16 << 20) {
+                if (!WriteBatch(batch)) return false;
+                batch.Clear();
             }
-
-            pcursor->Next();
-        } else {
-            break;
         }
-    }
-
-    return true;
-}
-
-bool BlockTreeDB::WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts) {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_BLOCKHASHINDEX, blockhashIndex), logicalts);
-    return WriteBatch(batch);
-}
-
-bool BlockTreeDB::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &ltimestamp) {
-
-    CTimestampBlockIndexValue lts;
-    if (!Read(std::make_pair(DB_BLOCKHASHINDEX, hash), lts))
-       return false;
-
-    ltimestamp = lts.ltimestamp;
-    return true;
-}
-
-bool BlockTreeDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
-    return Read(std::make_pair(DB_SPENTINDEX, key), value);
-}
-
-bool BlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
-        }
-    }
-    return WriteBatch(batch);
-}
-
-bool BlockTreeDB::blockOnchainActive(const uint256 &hash, ChainstateManager &chainman) {
-    LOCK(cs_main);
-    node::BlockMap::iterator mi = chainman.BlockIndex().find(hash);
-    if (mi == chainman.BlockIndex().end())
+        return true;
+    };
+    if (!eraseAll(DB_ADDRESSINDEX, std::pair<uint8_t, CAddressIndexKey>()) ||
+        !eraseAll(DB_ADDRESSUNSPENTINDEX, std::pair<uint8_t, CAddressUnspentKey>()) ||
+        !eraseAll(DB_ADDRESSBALANCEINDEX, std::pair<uint8_t, CAddressBalanceKey>()) ||
+        !eraseAll(DB_SPENTINDEX, std::pair<uint8_t, CSpentIndexKey>()) ||
+        // Legacy timestamp keys have no height: timestamp then block hash
+        !eraseAll(DB_TIMESTAMPINDEX, std::pair<uint8_t, std::pair<uint32_t, uint256>>()) ||
+        !eraseAll(DB_BLOCKHASHINDEX, std::pair<uint8_t, uint256>())) {
         return false;
-
-    CBlockIndex* pblockindex = &(*mi).second;
-    return pblockindex && chainman.ActiveChain().Contains(pblockindex);
+    }
+    batch.Erase(std::make_pair(DB_FLAG, std::string{"addrindex"}));
+    batch.Erase(std::make_pair(DB_FLAG, std::string{"addrbalanceindex"}));
+    return WriteBatch(batch, true);
 }
 
 bool BlockTreeDB::EraseBlockIndex(const std::vector<uint256> &vect)
@@ -831,10 +955,14 @@ CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
 
 bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
 {
+    std::vector<CBlockIndex*> pow_checked;
     if (!m_block_tree_db->LoadBlockIndexGuts(
-            GetConsensus(), [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_interrupt)) {
+            GetConsensus(), [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_interrupt,
+            m_opts.check_pow_on_load, pow_checked)) {
         return false;
     }
+    // Persist the flag so entries written by older versions are only rehashed once
+    m_dirty_blockindex.insert(pow_checked.begin(), pow_checked.end());
 
     if (snapshot_blockhash) {
         const std::optional<AssumeutxoData> maybe_au_data = GetParams().AssumeutxoForBlockhash(*snapshot_blockhash);
@@ -989,10 +1117,6 @@ bool BlockManager::LoadBlockIndexDB(const std::optional<uint256>& snapshot_block
     m_block_tree_db->ReadReindexing(fReindexing);
     if (fReindexing) m_blockfiles_indexed = false;
 
-    ///////////////////////////////////////////////////////////// // qtum
-    m_block_tree_db->ReadFlag("addrindex", fAddressIndex);
-    LogPrintf("LoadBlockIndexDB(): address index %s\n", fAddressIndex ? "enabled" : "disabled");
-    /////////////////////////////////////////////////////////////
     // Check whether we have a transaction index
     m_block_tree_db->ReadFlag("logevents", fLogEvents);
     LogPrintf("%s: log events index %s\n", __func__, fLogEvents ? "enabled" : "disabled");
@@ -1250,6 +1374,12 @@ uint64_t BlockManager::CalculateCurrentUsage()
 
 void BlockManager::UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const
 {
+    {
+        LOCK(m_block_read_mutex);
+        for (int file_num : setFilesToPrune) m_mapped_block_files.erase(file_num);
+        m_raw_block_cache.clear();
+        m_raw_block_cache_bytes = 0;
+    }
     std::error_code ec;
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         FlatFilePos pos(*it, 0);
@@ -1266,6 +1396,71 @@ AutoFile BlockManager::OpenBlockFile(const FlatFilePos& pos, bool fReadOnly) con
     return AutoFile{m_block_file_seq.Open(pos, fReadOnly), m_xor_key};
 }
 
+class MappedBlockFile
+{
+    const uint8_t* m_data{nullptr};
+    size_t m_size{0};
+
+public:
+    MappedBlockFile(const MappedBlockFile&) = delete;
+    MappedBlockFile& operator=(const MappedBlockFile&) = delete;
+
+    explicit MappedBlockFile(const fs::path& path)
+    {
+#ifndef WIN32
+        const int fd{open(fs::PathToString(path).c_str(), O_RDONLY)};
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                m_data = static_cast<const uint8_t*>(map);
+                m_size = st.st_size;
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedBlockFile()
+    {
+#ifndef WIN32
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    }
+
+    bool IsNull() const { return m_data == nullptr; }
+
+    //! Copy out [offset, offset + out.size()), removing the block file obfuscation
+    bool Read(size_t offset, Span<std::byte> out, const std::vector<std::byte>& xor_key) const
+    {
+        if (offset > m_size || out.size() > m_size - offset) return false;
+        std::memcpy(out.data(), m_data + offset, out.size());
+        util::Xor(out, xor_key, offset);
+        return true;
+    }
+};
+
+std::shared_ptr<const MappedBlockFile> BlockManager::MapBlockFile(int file_num) const
+{
+    if (!m_opts.use_mmap) return nullptr;
+    {
+        // The files still being appended to change size; read them normally
+        LOCK(cs_LastBlockFile);
+        for (const auto& cursor : m_blockfile_cursors) {
+            if (cursor && cursor->file_num == file_num) return nullptr;
+        }
+    }
+
+    LOCK(m_block_read_mutex);
+    if (auto it{m_mapped_block_files.find(file_num)}; it != m_mapped_block_files.end()) return it->second;
+    auto mapped{std::make_shared<const MappedBlockFile>(m_block_file_seq.FileName(FlatFilePos{file_num, 0}))};
+    if (mapped->IsNull()) return nullptr;
+    if (m_mapped_block_files.size() >= MAX_MAPPED_BLOCK_FILES) m_mapped_block_files.erase(m_mapped_block_files.begin());
+    m_mapped_block_files.emplace(file_num, mapped);
+    return mapped;
+}
+
 /** Open an undo file (rev?????.dat) */
 AutoFile BlockManager::OpenUndoFile(const FlatFilePos& pos, bool fReadOnly) const
 {
@@ -1475,16 +1670,15 @@ bool BlockManager::ReadBlock(Block& block, const FlatFilePos& pos) const
 {
     block.SetNull();
 
-    // Open history file to read
-    AutoFile filein{OpenBlockFile(pos, true)};
-    if (filein.IsNull()) {
-        LogError("%s: OpenBlockFile failed for %s\n", __func__, pos.ToString());
+    // Read the whole record at once and deserialize from memory, which is
+    // much cheaper than streaming every field through the file
+    std::vector<uint8_t> block_data;
+    if (!ReadRawBlock(block_data, pos)) {
         return false;
     }
 
-    // Read block
     try {
-        filein >> TX_WITH_WITNESS(block);
+        SpanReader{block_data} >> TX_WITH_WITNESS(block);
     } catch (const std::exception& e) {
         LogError("%s: Deserialize or I/O error - %s at %s\n", __func__, e.what(), pos.ToString());
         return false;
@@ -1529,18 +1723,18 @@ bool BlockManager::ReadRawBlock(std::vector<uint8_t>& block, const FlatFilePos&
         return false;
     }
     hpos.nPos -= 8; // Seek back 8 bytes for meta header
-    AutoFile filein{OpenBlockFile(hpos, true)};
-    if (filein.IsNull()) {
-        LogError("%s: OpenBlockFile failed for %s\n", __func__, pos.ToString());
-        return false;
-    }
-
-    try {
-        MessageStartChars blk_start;
-        unsigned int blk_size;
 
-        filein >> blk_start >> blk_size;
+    {
+        LOCK(m_block_read_mutex);
+        for (const auto& [cached_pos, cached_block] : m_raw_block_cache) {
+            if (cached_pos == pos) {
+                block = cached_block;
+                return true;
+            }
+        }
+    }
 
+    const auto check_meta = [&](const MessageStartChars& blk_start, unsigned int blk_size) {
         if (blk_start != GetParams().MessageStart()) {
             LogError("%s: Block magic mismatch for %s: %s versus expected %s\n", __func__, pos.ToString(),
                          HexStr(blk_start),
@@ -1553,12 +1747,56 @@ bool BlockManager::ReadRawBlock(std::vector<uint8_t>& block, const FlatFilePos&
                          blk_size, MAX_SIZE);
             return false;
         }
+        return true;
+    };
 
-        block.resize(blk_size); // Zeroing of memory is intentional here
-        filein.read(MakeWritableByteSpan(block));
-    } catch (const std::exception& e) {
-        LogError("%s: Read from block file failed: %s for %s\n", __func__, e.what(), pos.ToString());
-        return false;
+    if (const auto mapped{MapBlockFile(pos.nFile)}) {
+        std::array<uint8_t, 8> meta;
+        if (!mapped->Read(hpos.nPos, MakeWritableByteSpan(meta), m_xor_key)) {
+            LogError("%s: Read from block file failed: position out of range for %s\n", __func__, pos.ToString());
+            return false;
+        }
+        MessageStartChars blk_start;
+        unsigned int blk_size;
+        SpanReader{meta} >> blk_start >> blk_size;
+        if (!check_meta(blk_start, blk_size)) return false;
+
+        block.resize(blk_size);
+        if (!mapped->Read(pos.nPos, MakeWritableByteSpan(block), m_xor_key)) {
+            LogError("%s: Read from block file failed: block extends past the end of file for %s\n", __func__, pos.ToString());
+            return false;
+        }
+    } else {
+        AutoFile filein{OpenBlockFile(hpos, true)};
+        if (filein.IsNull()) {
+            LogError("%s: OpenBlockFile failed for %s\n", __func__, pos.ToString());
+            return false;
+        }
+
+        try {
+            MessageStartChars blk_start;
+            unsigned int blk_size;
+
+            filein >> blk_start >> blk_size;
+            if (!check_meta(blk_start, blk_size)) return false;
+
+            block.resize(blk_size); // Zeroing of memory is intentional here
+            filein.read(MakeWritableByteSpan(block));
+        } catch (const std::exception& e) {
+            LogError("%s: Read from block file failed: %s for %s\n", __func__, e.what(), pos.ToString());
+            return false;
+        }
+    }
+
+    // Blocks that would take a large share of the cache are not worth evicting it for
+    if (block.size() <= RAW_BLOCK_CACHE_BYTES / 4) {
+        LOCK(m_block_read_mutex);
+        while (!m_raw_block_cache.empty() && m_raw_block_cache_bytes + block.size() > RAW_BLOCK_CACHE_BYTES) {
+            m_raw_block_cache_bytes -= m_raw_block_cache.front().second.size();
+            m_raw_block_cache.pop_front();
+        }
+        m_raw_block_cache.emplace_back(pos, block);
+        m_raw_block_cache_bytes += block.size();
     }
 
     return true;
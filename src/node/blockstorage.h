@@ -28,6 +28,7 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <limits>
 #include <map>
@@ -47,9 +48,13 @@ class ChainstateManager;
 //////////////////////////////////// //qtum
 struct CHeightTxIndexKey;
 struct CHeightTxIndexIteratorKey;
+struct CTopicTxIndexKey;
+struct CLogIndexUndo;
 struct CAddressIndexKey;
 struct CAddressUnspentKey;
 struct CAddressUnspentValue;
+struct CAddressBalanceKey;
+struct CAddressBalanceValue;
 struct CMempoolAddressDeltaKey;
 struct CTimestampIndexKey;
 struct CTimestampBlockIndexKey;
@@ -76,7 +81,14 @@ public:
     void ReadReindexing(bool& fReindexing);
     bool WriteFlag(const std::string& name, bool fValue);
     bool ReadFlag(const std::string& name, bool& fValue);
-    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
+    /**
+     * Load every stored block index entry. Proof of work blocks flagged
+     * BLOCK_POW_CHECKED are not rehashed unless @p check_all_pow is set;
+     * entries that were verified here for the first time are flagged and
+     * appended to @p newly_checked so the caller can persist the flag.
+     */
+    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt,
+                            bool check_all_pow, std::vector<CBlockIndex*>& newly_checked)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     ////////////////////////////////////////////////////////////////////////////// // qtum
@@ -90,15 +102,50 @@ public:
      * @param minconf stop iterating of the block height does not have enough confirmations (ignored if <= 0)
      * @param blocksOfHashes transaction hashes in blocks iterated are collected into this vector.
      * @param addresses filter out a block unless it matches one of the addresses in this set.
+     * @param limit stop at the end of the block in which this many transactions are collected (ignored if 0)
      *
      * @return the height of the latest block iterated. 0 if no block is iterated.
      */
     int ReadHeightIndex(int low, int high, int minconf,
             std::vector<std::vector<uint256>> &blocksOfHashes,
-            std::set<dev::h160> const &addresses, ChainstateManager &chainman);
+            std::set<dev::h160> const &addresses, ChainstateManager &chainman, size_t limit = 0);
     bool EraseHeightIndex(const unsigned int &height);
     bool WipeHeightIndex();
 
+    /** Index the transactions of a block by the first topic of their logs, alone and with the log's address */
+    bool WriteTopicIndex(const std::vector<std::pair<CTopicTxIndexKey, std::vector<uint256>>> &vect);
+
+    /**
+     * Iterates through the blocks with logs whose first topic is topic, by height, starting from low.
+     *
+     * @param topic the first topic of the logs
+     * @param low start iterating from this block height
+     * @param high end iterating at this block height
+     * @param blocksOfHashes transaction hashes in blocks iterated are collected into this vector.
+     * @param addresses only collect the logs of one of the addresses in this set (all if empty).
+     * @param limit stop at the end of the block in which this many transactions are collected (ignored if 0)
+     *
+     * @return the height of the latest block completely iterated, -1 for an invalid range.
+     */
+    int ReadTopicIndex(const dev::h256 &topic, int low, int high,
+            std::vector<std::vector<uint256>> &blocksOfHashes,
+            std::set<dev::h160> const &addresses, size_t limit = 0);
+    /** Height of the first block in the topic index, the blocks below it may not be indexed */
+    bool ReadTopicIndexStart(unsigned int &height);
+    bool EraseTopicIndex(const std::vector<CTopicTxIndexKey> &vect);
+    bool WipeTopicIndex();
+
+    /** Record what a block with contract transactions added to the log indexes and receipts */
+    bool WriteLogIndexUndo(unsigned int height, const CLogIndexUndo &undo);
+    bool ReadLogIndexUndo(unsigned int height, CLogIndexUndo &undo);
+    /**
+     * Remove what the block at height added to the side indexes in one batch:
+     * the height and topic index keys of undo, if given, with its record, and
+     * the stake and delegate index entries if stakeIndex is set.
+     */
+    bool EraseBlockIndexes(unsigned int height, const CLogIndexUndo *undo, bool stakeIndex);
+    bool WipeLogIndexUndo();
+
 
     bool WriteStakeIndex(unsigned int height, uint160 address);
     bool ReadStakeIndex(unsigned int height, uint160& address);
@@ -111,22 +158,8 @@ public:
 
     bool EraseBlockIndex(const std::vector<uint256>&vect);
 
-    // Block explorer database functions
-    bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool ReadAddressIndex(uint256 addressHash, int type,
-                        std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                        int start = 0, int end = 0);
-    bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
-    bool ReadAddressUnspentIndex(uint256 addressHash, int type,
-                                std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
-    bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
-    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &vect, ChainstateManager & chainman);
-    bool WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts);
-    bool ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS);
-    bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-    bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
-    bool blockOnchainActive(const uint256 &hash, ChainstateManager &chainman);
+    //! Erase the address index records kept here before AddressIndex had its own database
+    bool WipeAddressIndex(const util::SignalInterrupt& interrupt);
     //////////////////////////////////////////////////////////////////////////////
 };
 } // namespace kernel
@@ -194,6 +227,14 @@ struct BlockfileCursor {
 
 std::ostream& operator<<(std::ostream& os, const BlockfileCursor& cursor);
 
+/** Read-only memory mapping of a finalized block file, see -blocksmmap */
+class MappedBlockFile;
+
+/** Maximum number of block files kept mapped at once */
+static constexpr size_t MAX_MAPPED_BLOCK_FILES{32};
+/** Total size of the recently read serialized blocks kept by ReadRawBlock */
+static constexpr size_t RAW_BLOCK_CACHE_BYTES{32 << 20};
+
 
 /**
  * Maintains a tree of blocks (stored in `m_block_index`) which is consulted
@@ -268,7 +309,7 @@ private:
         const Chainstate& chain,
         ChainstateManager& chainman);
 
-    RecursiveMutex cs_LastBlockFile;
+    mutable RecursiveMutex cs_LastBlockFile;
     std::vector<CBlockFileInfo> m_blockfile_info;
 
     //! Since assumedvalid chainstates may be syncing a range of the chain that is very
@@ -325,6 +366,20 @@ private:
     const FlatFileSeq m_block_file_seq;
     const FlatFileSeq m_undo_file_seq;
 
+    /**
+     * Block reads that do not go through the file system: mappings of
+     * finalized block files, and the serialized form of recently read blocks
+     * by position, so the blocks that RPC, REST and peers keep asking for are
+     * served without another read. Both are dropped when files are pruned.
+     */
+    mutable Mutex m_block_read_mutex;
+    mutable std::map<int, std::shared_ptr<const MappedBlockFile>> m_mapped_block_files GUARDED_BY(m_block_read_mutex);
+    mutable std::deque<std::pair<FlatFilePos, std::vector<uint8_t>>> m_raw_block_cache GUARDED_BY(m_block_read_mutex);
+    mutable size_t m_raw_block_cache_bytes GUARDED_BY(m_block_read_mutex){0};
+
+    /** Mapping of a block file that is no longer written to, or null */
+    std::shared_ptr<const MappedBlockFile> MapBlockFile(int file_num) const EXCLUSIVE_LOCKS_REQUIRED(!m_block_read_mutex);
+
 public:
     using Options = kernel::BlockManagerOpts;
 
@@ -478,7 +533,7 @@ public:
     /**
      *  Actually unlink the specified files
      */
-    void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const;
+    void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const EXCLUSIVE_LOCKS_REQUIRED(!m_block_read_mutex);
 
     //! Checks that the block hash at height nHeight matches the expected hardened checkpoint
     bool CheckHardened(int nHeight, const uint256& hash, const CCheckpointData& data) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -491,9 +546,10 @@ public:
 
     /** Functions for disk access for blocks */
     template <typename Block>
-    bool ReadBlock(Block& block, const FlatFilePos& pos) const;
-    bool ReadBlock(CBlock& block, const CBlockIndex& index) const;
-    bool ReadRawBlock(std::vector<uint8_t>& block, const FlatFilePos& pos) const;
+    bool ReadBlock(Block& block, const FlatFilePos& pos) const EXCLUSIVE_LOCKS_REQUIRED(!m_block_read_mutex);
+    bool ReadBlock(CBlock& block, const CBlockIndex& index) const EXCLUSIVE_LOCKS_REQUIRED(!m_block_read_mutex);
+    /** Read the block as stored, which is its network serialization with witness data */
+    bool ReadRawBlock(std::vector<uint8_t>& block, const FlatFilePos& pos) const EXCLUSIVE_LOCKS_REQUIRED(!m_block_read_mutex);
 
     bool ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index) const;
 
@@ -568,6 +624,98 @@ struct CHeightTxIndexKey {
     }
 };
 
+/** Key of the topic index, ordered by height for each topic */
+struct CTopicTxIndexKey {
+    dev::h256 topic;
+    unsigned int height;
+    dev::h160 address;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        s << topic.asBytes();
+        ser_writedata32be(s, height);
+        s << address.asBytes();
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        valtype tmp;
+        s >> tmp;
+        topic = dev::h256(tmp);
+        height = ser_readdata32be(s);
+        s >> tmp;
+        address = dev::h160(tmp);
+    }
+
+    CTopicTxIndexKey(dev::h256 _topic, unsigned int _height, dev::h160 _address) {
+        topic = _topic;
+        height = _height;
+        address = _address;
+    }
+
+    CTopicTxIndexKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        topic.clear();
+        height = 0;
+        address.clear();
+    }
+};
+
+/** Key of the topic index for a single address, ordered by height for each address and topic */
+struct CAddressTopicTxIndexKey {
+    dev::h160 address;
+    dev::h256 topic;
+    unsigned int height;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        s << address.asBytes();
+        s << topic.asBytes();
+        ser_writedata32be(s, height);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        valtype tmp;
+        s >> tmp;
+        address = dev::h160(tmp);
+        s >> tmp;
+        topic = dev::h256(tmp);
+        height = ser_readdata32be(s);
+    }
+
+    CAddressTopicTxIndexKey(dev::h160 _address, dev::h256 _topic, unsigned int _height) {
+        address = _address;
+        topic = _topic;
+        height = _height;
+    }
+
+    CAddressTopicTxIndexKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        address.clear();
+        topic.clear();
+        height = 0;
+    }
+};
+
+/**
+ * The height and topic index keys and the receipts a block with contract
+ * transactions added, written when it is connected. Disconnecting the block
+ * then takes neither index scans nor receipt reads.
+ */
+struct CLogIndexUndo {
+    uint256 blockHash;
+    std::vector<CHeightTxIndexKey> heightIndex;
+    std::vector<CTopicTxIndexKey> topicIndex;
+    std::vector<uint256> receipts;
+
+    SERIALIZE_METHODS(CLogIndexUndo, obj) { READWRITE(obj.blockHash, obj.heightIndex, obj.topicIndex, obj.receipts); }
+};
+
 struct CTimestampIndexIteratorKey {
     unsigned int timestamp;
 
@@ -596,26 +744,32 @@ struct CTimestampIndexIteratorKey {
     }
 };
 
+//! Blocks sorted by logical timestamp, then height. The value is whether the
+//! block is in the active chain, so active-only range scans need no lookups.
 struct CTimestampIndexKey {
     unsigned int timestamp;
+    unsigned int height;
     uint256 blockHash;
 
     size_t GetSerializeSize(int nType, int nVersion) const {
-        return 36;
+        return 40;
     }
     template<typename Stream>
     void Serialize(Stream& s) const {
         ser_writedata32be(s, timestamp);
+        ser_writedata32be(s, height);
         blockHash.Serialize(s);
     }
     template<typename Stream>
     void Unserialize(Stream& s) {
         timestamp = ser_readdata32be(s);
+        height = ser_readdata32be(s);
         blockHash.Unserialize(s);
     }
 
-    CTimestampIndexKey(unsigned int time, uint256 hash) {
+    CTimestampIndexKey(unsigned int time, unsigned int nHeight, uint256 hash) {
         timestamp = time;
+        height = nHeight;
         blockHash = hash;
     }
 
@@ -625,6 +779,7 @@ struct CTimestampIndexKey {
 
     void SetNull() {
         timestamp = 0;
+        height = 0;
         blockHash.SetNull();
     }
 };
@@ -895,5 +1050,64 @@ struct CAddressIndexIteratorKey {
         hashBytes.SetNull();
     }
 };
+
+/**
+ * Balance of an address as of a block height. A record is written at every
+ * height where the address appears in the address index, heights are stored
+ * inverted so that a seek finds the latest record at or below a height.
+ */
+struct CAddressBalanceKey {
+    uint8_t type;
+    uint256 hashBytes;
+    int blockHeight;
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        return 37;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, type);
+        hashBytes.Serialize(s);
+        ser_writedata32be(s, ~(uint32_t)blockHeight);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        type = ser_readdata8(s);
+        hashBytes.Unserialize(s);
+        blockHeight = ~ser_readdata32be(s);
+    }
+
+    CAddressBalanceKey(unsigned int addressType, uint256 addressHash, int height) {
+        type = addressType;
+        hashBytes = addressHash;
+        blockHeight = height;
+    }
+
+    CAddressBalanceKey() {
+        SetNull();
+    }
+
+    void SetNull() {
+        type = 0;
+        hashBytes.SetNull();
+        blockHeight = 0;
+    }
+};
+
+struct CAddressBalanceValue {
+    CAmount balance;
+    CAmount received;
+
+    SERIALIZE_METHODS(CAddressBalanceValue, obj) { READWRITE(obj.balance, obj.received); }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+    }
+};
 ////////////////////////////////////////////////////////////
 #endif // BITCOIN_NODE_BLOCKSTORAGE_H
@@ -5,6 +5,7 @@
 #include <node/caches.h>
 
 #include <common/args.h>
+#include <index/addressindex.h>
 #include <index/txindex.h>
 #include <kernel/caches.h>
 #include <logging.h>
@@ -20,6 +21,12 @@
 static constexpr size_t MAX_TX_INDEX_CACHE{1024_MiB};
 //! Max memory allocated to all block filter index caches combined in bytes.
 static constexpr size_t MAX_FILTER_INDEX_CACHE{1024_MiB};
+//! Max memory allocated to the address index DB specific cache in bytes.
+static constexpr size_t MAX_ADDRESS_INDEX_CACHE{1024_MiB};
+//! Max memory allocated to the FCMP curve tree node and output caches in bytes.
+static constexpr size_t MAX_CURVE_TREE_CACHE{256_MiB};
+//! Max memory allocated to the block cache shared by the auxiliary databases in bytes.
+static constexpr size_t MAX_SHARED_DB_CACHE{64_MiB};
 //! Maximum dbcache size on 32-bit systems.
 static constexpr size_t MAX_32BIT_DBCACHE{1024_MiB};
 
@@ -34,14 +41,16 @@ CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes)
         constexpr auto max_db_cache{sizeof(void*) == 4 ? MAX_32BIT_DBCACHE : std::numeric_limits<size_t>::max()};
         total_cache = std::max<size_t>(MIN_DB_CACHE, std::min<uint64_t>(db_cache_bytes, max_db_cache));
     }
-    if (args.GetBoolArg("-addrindex", DEFAULT_ADDRINDEX)) {
-        // enable 3/4 of the cache if addressindex and/or spentindex is enabled
-        total_cache = total_cache * 3 / 4;
-    }
 
     IndexCacheSizes index_sizes;
+    index_sizes.address_index = std::min(total_cache / 4, args.GetBoolArg("-addrindex", DEFAULT_ADDRINDEX) ? MAX_ADDRESS_INDEX_CACHE : 0);
+    total_cache -= index_sizes.address_index;
     index_sizes.tx_index = std::min(total_cache / 8, args.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? MAX_TX_INDEX_CACHE : 0);
     total_cache -= index_sizes.tx_index;
+    index_sizes.curve_tree = std::min(total_cache / 16, MAX_CURVE_TREE_CACHE);
+    total_cache -= index_sizes.curve_tree;
+    index_sizes.shared_db = std::min(total_cache / 32, MAX_SHARED_DB_CACHE);
+    total_cache -= index_sizes.shared_db;
     if (n_indexes > 0) {
         size_t max_cache = std::min(total_cache / 8, MAX_FILTER_INDEX_CACHE);
         index_sizes.filter_index = max_cache / n_indexes;
@@ -21,6 +21,10 @@ namespace node {
 struct IndexCacheSizes {
     size_t tx_index{0};
     size_t filter_index{0};
+    size_t curve_tree{0};
+    size_t address_index{0};
+    //! Block cache shared by the small auxiliary databases, see SetSharedDBCacheSize
+    size_t shared_db{0};
 };
 struct CacheSizes {
     IndexCacheSizes index;
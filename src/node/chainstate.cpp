@@ -23,6 +23,8 @@
 #include <validation.h>
 #include <chainparams.h>
 #include <common/args.h>
+#include <qtum/evmcallpool.h>
+#include <qtum/qtumDGP.h>
 
 #include <algorithm>
 #include <cassert>
@@ -31,15 +33,26 @@
 using kernel::CacheSizes;
 
 namespace node {
+void UnloadEvmState()
+{
+    GetEvmCallPool().Clear();
+    QtumDGP::clearCache();
+    pstorageresult.reset();
+    if (globalState) {
+        globalState->db().flush();
+        globalState->dbUtxo().flush();
+    }
+    globalState.reset();
+    globalSealEngine.reset();
+}
+
 // Complete initialization of chainstates after the initial call has been made
 // to ChainstateManager::InitializeChainstate().
 static ChainstateLoadResult CompleteChainstateInitialization(
     ChainstateManager& chainman,
     const ChainstateLoadOptions& options) EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
 {
-    pstorageresult.reset();
-    globalState.reset();
-    globalSealEngine.reset();
+    UnloadEvmState();
 
     if (chainman.m_interrupt) return {ChainstateLoadStatus::INTERRUPTED, {}};
 
@@ -64,9 +77,15 @@ static ChainstateLoadResult CompleteChainstateInitialization(
         return {ChainstateLoadStatus::FAILURE, _("You need to rebuild the database using -reindex to go back to unpruned mode.  This will redownload the entire blockchain")};
     }
 
-    // Check for changed -addrindex state
-    if (fAddressIndex != options.addrindex) {
-        return {ChainstateLoadStatus::FAILURE, _("You need to rebuild the database using -reindex to change -addrindex")};
+    // Drop the address index records written by block connection before the
+    // address index moved to its own database
+    bool legacy_addrindex{false};
+    if (chainman.m_blockman.m_block_tree_db->ReadFlag("addrindex", legacy_addrindex) && legacy_addrindex) {
+        LogPrintf("Removing legacy address index records from the block index database\n");
+        if (!chainman.m_blockman.m_block_tree_db->WipeAddressIndex(chainman.m_interrupt)) {
+            if (chainman.m_interrupt) return {ChainstateLoadStatus::INTERRUPTED, {}};
+            return {ChainstateLoadStatus::FAILURE, _("Error removing the legacy address index")};
+        }
     }
 
     // Check for changed -logevents state
@@ -152,6 +171,11 @@ static ChainstateLoadResult CompleteChainstateInitialization(
     const dev::h256 hashDB(dev::sha3(dev::rlp("")));
     dev::eth::BaseState existsQtumstate = fStatus ? dev::eth::BaseState::PreExisting : dev::eth::BaseState::Empty;
     globalState = std::unique_ptr<QtumState>(new QtumState(dev::u256(0), QtumState::openDB(dirQtum, hashDB, dev::WithExisting::Trust), dirQtum, existsQtumstate));
+    if (nEvmCacheSize > 0) {
+        // A quarter for code, the rest for accounts and storage slots
+        globalState->setSharedCache(std::make_shared<dev::eth::StateCache>(nEvmCacheSize - nEvmCacheSize / 4));
+    }
+    dev::eth::CodeCache::instance().setMaxSize(nEvmCacheSize / 4);
     const CChainParams& chainparams = Params();
     dev::eth::ChainParams cp(chainparams.EVMGenesisInfo());
     globalSealEngine = std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
@@ -174,6 +198,9 @@ static ChainstateLoadResult CompleteChainstateInitialization(
         }
         globalState->db().commit();
         globalState->dbUtxo().commit();
+        // From here on trie nodes are written with the coins, see Chainstate::FlushStateToDisk
+        globalState->db().setDeferredCommit(true);
+        globalState->dbUtxo().setDeferredCommit(true);
     }
 
     fRecordLogOpcodes = options.record_log_opcodes;
@@ -184,6 +211,8 @@ static ChainstateLoadResult CompleteChainstateInitialization(
     {
         pstorageresult->wipeResults();
         chainman.m_blockman.m_block_tree_db->WipeHeightIndex();
+        chainman.m_blockman.m_block_tree_db->WipeTopicIndex();
+        chainman.m_blockman.m_block_tree_db->WipeLogIndexUndo();
         fLogEvents = false;
         chainman.m_blockman.m_block_tree_db->WriteFlag("logevents", fLogEvents);
     }
@@ -37,7 +37,6 @@ struct ChainstateLoadOptions {
     std::function<void()> coins_error_cb;
     bool getting_values_dgp{false};
     bool record_log_opcodes{false};
-    bool addrindex{false};
     bool logevents{false};
 };
 
@@ -73,6 +72,10 @@ using ChainstateLoadResult = std::tuple<ChainstateLoadStatus, bilingual_str>;
 ChainstateLoadResult LoadChainstate(ChainstateManager& chainman, const kernel::CacheSizes& cache_sizes,
                                     const ChainstateLoadOptions& options);
 ChainstateLoadResult VerifyLoadedChainstate(ChainstateManager& chainman, const ChainstateLoadOptions& options);
+
+//! Flush and close the EVM state, contract results and caches LoadChainstate()
+//! opened. Call it with the chainstates flushed, before they are destroyed.
+void UnloadEvmState();
 } // namespace node
 
 #endif // BITCOIN_NODE_CHAINSTATE_H
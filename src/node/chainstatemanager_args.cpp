@@ -52,6 +52,14 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
     ReadDatabaseArgs(args, opts.coins_db);
     ReadCoinsViewArgs(args, opts.coins_view);
 
+    for (const std::string& cache : args.GetArgs("-largepages")) {
+        if (cache == "coins") {
+            opts.coins_large_pages = true;
+        } else {
+            return util::Error{Untranslated(strprintf("Unknown cache for -largepages: '%s'", cache))};
+        }
+    }
+
     int script_threads = args.GetIntArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
     if (script_threads <= 0) {
         // -par=0 means autodetect (number of cores - 1 script threads)
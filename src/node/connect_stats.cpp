@@ -0,0 +1,118 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#include <node/connect_stats.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace node {
+
+BlockConnectStats g_block_connect_stats;
+
+std::string ConnectPhaseName(ConnectPhase phase)
+{
+    switch (phase) {
+    case ConnectPhase::LOAD: return "load";
+    case ConnectPhase::CHECKS: return "checks";
+    case ConnectPhase::FORKS: return "forks";
+    case ConnectPhase::TRANSACTIONS: return "transactions";
+    case ConnectPhase::EVM: return "evm";
+    case ConnectPhase::PRIVACY: return "privacy";
+    case ConnectPhase::REWARD: return "reward";
+    case ConnectPhase::SCRIPTS: return "scripts";
+    case ConnectPhase::STATE: return "state";
+    case ConnectPhase::UNDO: return "undo";
+    case ConnectPhase::INDEX: return "index";
+    case ConnectPhase::DELEGATION: return "delegation";
+    case ConnectPhase::CURVE_TREE: return "curvetree";
+    case ConnectPhase::FLUSH: return "flush";
+    case ConnectPhase::CHAINSTATE: return "chainstate";
+    case ConnectPhase::POSTPROCESS: return "postprocess";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+std::chrono::microseconds BlockConnectTimes::Total() const
+{
+    return std::accumulate(phases.begin(), phases.end(), std::chrono::microseconds{0});
+}
+
+static std::chrono::microseconds PhaseOrTotal(const BlockConnectTimes& times, size_t phase)
+{
+    return phase < CONNECT_PHASE_COUNT ? times.phases[phase] : times.Total();
+}
+
+static double Millis(std::chrono::microseconds time)
+{
+    return Ticks<MillisecondsDouble>(time);
+}
+
+BlockConnectStats::BlockConnectStats()
+    : m_since(GetTime())
+{
+}
+
+void BlockConnectStats::Record(const BlockConnectTimes& times)
+{
+    LOCK(m_mutex);
+    for (size_t phase = 0; phase <= CONNECT_PHASE_COUNT; ++phase) {
+        const double us = PhaseOrTotal(times, phase).count();
+        m_ema_us[phase] = m_blocks == 0 ? us : m_ema_us[phase] + EMA_WEIGHT * (us - m_ema_us[phase]);
+    }
+    ++m_blocks;
+
+    m_window.push_back(times);
+    if (m_window.size() > WINDOW) m_window.pop_front();
+
+    const auto slower = [](const BlockConnectTimes& a, const BlockConnectTimes& b) { return a.Total() > b.Total(); };
+    if (m_slowest.size() < MAX_SLOWEST || slower(times, m_slowest.back())) {
+        m_slowest.insert(std::upper_bound(m_slowest.begin(), m_slowest.end(), times, slower), times);
+        if (m_slowest.size() > MAX_SLOWEST) m_slowest.pop_back();
+    }
+}
+
+BlockConnectStats::Summary BlockConnectStats::GetSummary(size_t slowest) const
+{
+    LOCK(m_mutex);
+    Summary summary;
+    summary.since = m_since;
+    summary.blocks = m_blocks;
+    summary.window_blocks = m_window.size();
+    summary.slowest.assign(m_slowest.begin(), m_slowest.begin() + std::min(slowest, m_slowest.size()));
+    if (m_window.empty()) return summary;
+
+    std::vector<std::chrono::microseconds> times(m_window.size());
+    // Nearest rank, so every percentile is a time some block took
+    const auto percentile = [&](double p) {
+        return Millis(times[std::min(times.size() - 1, static_cast<size_t>(p * times.size()))]);
+    };
+    for (size_t phase = 0; phase <= CONNECT_PHASE_COUNT; ++phase) {
+        std::transform(m_window.begin(), m_window.end(), times.begin(), [phase](const BlockConnectTimes& block) {
+            return PhaseOrTotal(block, phase);
+        });
+        std::sort(times.begin(), times.end());
+        PhaseSummary& stats = summary.phases[phase];
+        stats.ema_ms = m_ema_us[phase] / 1000.0;
+        stats.mean_ms = Millis(std::accumulate(times.begin(), times.end(), std::chrono::microseconds{0})) / times.size();
+        stats.p50_ms = percentile(0.50);
+        stats.p90_ms = percentile(0.90);
+        stats.p99_ms = percentile(0.99);
+        stats.max_ms = Millis(times.back());
+    }
+    return summary;
+}
+
+void BlockConnectStats::Reset()
+{
+    LOCK(m_mutex);
+    m_since = GetTime();
+    m_blocks = 0;
+    m_window.clear();
+    m_ema_us.fill(0);
+    m_slowest.clear();
+}
+
+} // namespace node
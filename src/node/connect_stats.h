@@ -0,0 +1,114 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#ifndef BITCOIN_NODE_CONNECT_STATS_H
+#define BITCOIN_NODE_CONNECT_STATS_H
+
+#include <sync.h>
+#include <uint256.h>
+#include <util/time.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace node {
+
+/** The phases a block's connection is split into, reported by getblockconnectstats */
+enum class ConnectPhase : uint8_t {
+    LOAD,         //!< reading the block from disk
+    CHECKS,       //!< block sanity checks
+    FORKS,        //!< fork and BIP30 checks
+    TRANSACTIONS, //!< inputs, sigops and fees of the transactions, EVM and privacy excluded
+    EVM,          //!< contract execution and processing of its results
+    PRIVACY,      //!< key images, range proofs and FCMP inputs, waiting for the privacy queue included
+    REWARD,       //!< block reward, MPoS outputs and trust tier checks
+    SCRIPTS,      //!< waiting for the script check queue
+    STATE,        //!< state root and AAL checks of the contract state
+    UNDO,         //!< writing the undo data
+    INDEX,        //!< height, topic, stake and delegate indexes and contract logs
+    DELEGATION,   //!< delegation rewards and coinstake tracking
+    CURVE_TREE,   //!< curve tree and key image database updates
+    FLUSH,        //!< flushing the coins view
+    CHAINSTATE,   //!< writing the chain state to disk, when due
+    POSTPROCESS,  //!< mempool removal and tip update
+};
+
+static constexpr size_t CONNECT_PHASE_COUNT{static_cast<size_t>(ConnectPhase::POSTPROCESS) + 1};
+
+/** The name of a phase in getblockconnectstats */
+std::string ConnectPhaseName(ConnectPhase phase);
+
+/** Where the time connecting one block went */
+struct BlockConnectTimes {
+    int height{-1};
+    uint256 hash;
+    std::array<std::chrono::microseconds, CONNECT_PHASE_COUNT> phases{};
+
+    void Add(ConnectPhase phase, SteadyClock::duration time)
+    {
+        phases[static_cast<size_t>(phase)] += std::chrono::duration_cast<std::chrono::microseconds>(time);
+    }
+    std::chrono::microseconds Get(ConnectPhase phase) const { return phases[static_cast<size_t>(phase)]; }
+    std::chrono::microseconds Total() const;
+};
+
+/**
+ * Times of the blocks connected to a chain, per phase
+ *
+ * Percentiles are taken over the last WINDOW blocks, the moving average
+ * weighs a new block with EMA_WEIGHT. The slowest blocks are kept until
+ * the statistics are reset.
+ */
+class BlockConnectStats
+{
+public:
+    static constexpr size_t WINDOW{1000};
+    static constexpr size_t MAX_SLOWEST{50};
+    static constexpr double EMA_WEIGHT{2.0 / 101}; //!< about the last 100 blocks
+
+    /** Statistics of one phase, the last entry of Summary::phases is the total */
+    struct PhaseSummary {
+        double ema_ms{0};
+        double mean_ms{0};
+        double p50_ms{0};
+        double p90_ms{0};
+        double p99_ms{0};
+        double max_ms{0};
+    };
+
+    struct Summary {
+        int64_t since{0};
+        uint64_t blocks{0};
+        size_t window_blocks{0};
+        std::array<PhaseSummary, CONNECT_PHASE_COUNT + 1> phases{};
+        std::vector<BlockConnectTimes> slowest;
+    };
+
+    BlockConnectStats();
+
+    void Record(const BlockConnectTimes& times) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** The statistics with at most slowest of the slowest blocks, slowest first */
+    Summary GetSummary(size_t slowest) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Reset() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    mutable Mutex m_mutex;
+    int64_t m_since GUARDED_BY(m_mutex);
+    uint64_t m_blocks GUARDED_BY(m_mutex){0};
+    std::deque<BlockConnectTimes> m_window GUARDED_BY(m_mutex);
+    std::array<double, CONNECT_PHASE_COUNT + 1> m_ema_us GUARDED_BY(m_mutex){};
+    //! Sorted by total, slowest first
+    std::vector<BlockConnectTimes> m_slowest GUARDED_BY(m_mutex);
+};
+
+extern BlockConnectStats g_block_connect_stats;
+
+} // namespace node
+
+#endif // BITCOIN_NODE_CONNECT_STATS_H
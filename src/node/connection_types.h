@@ -75,6 +75,17 @@ enum class ConnectionType {
      * AddrMan is empty.
      */
     ADDR_FETCH,
+
+    /**
+     * Validator relay connections are block-relay-only connections to the
+     * addresses of staking validators, preferring those of the highest trust
+     * tier. They do not relay transactions or addresses, and we request
+     * high-bandwidth compact block relay on them as soon as the peer signals
+     * support, so that blocks and heartbeats travel between stakers with one
+     * round trip less. We automatically attempt to open
+     * MAX_VALIDATOR_RELAY_CONNECTIONS using addresses from heartbeats.
+     */
+    VALIDATOR_RELAY,
 };
 
 /** Convert ConnectionType enum to a string value */
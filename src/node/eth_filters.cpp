@@ -0,0 +1,300 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/eth_filters.h>
+
+#include <kernel/mempool_entry.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <tinyformat.h>
+#include <util/convert.h>
+#include <validation.h>
+
+#include <algorithm>
+
+namespace node {
+
+static std::shared_ptr<EthFilterManager> g_ethFilters;
+static std::mutex g_ethFiltersMutex;
+
+bool EthLogFilter::Matches(const dev::h160& address, const dev::h256s& logTopics, int height) const
+{
+    if (fromBlock >= 0 && height < fromBlock) return false;
+    if (toBlock >= 0 && height > toBlock) return false;
+    if (!addresses.empty() && !addresses.count(address)) return false;
+    for (size_t i = 0; i < topics.size(); i++) {
+        if (topics[i].empty()) continue;
+        if (i >= logTopics.size() || !topics[i].count(logTopics[i])) return false;
+    }
+    return true;
+}
+
+std::vector<EthFilterLog> ReadBlockLogs(const CBlock& block, const CBlockIndex* pindex)
+{
+    std::vector<EthFilterLog> logs;
+    if (!fLogEvents || !pstorageresult) return logs;
+
+    const uint256 blockHash = block.GetHash();
+    uint32_t logIndex = 0;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransactionRef& tx = block.vtx[i];
+        if (!tx->HasCreateOrCall()) continue;
+        for (const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))) {
+            // The transaction may have moved to another block since
+            if (receipt.blockHash != blockHash) continue;
+            for (const dev::eth::LogEntry& entry : receipt.logs) {
+                EthFilterLog log;
+                log.address = entry.address;
+                log.topics = entry.topics;
+                log.data = entry.data;
+                log.blockNumber = pindex->nHeight;
+                log.blockHash = blockHash;
+                log.transactionHash = tx->GetHash();
+                log.transactionIndex = i;
+                log.logIndex = logIndex++;
+                logs.push_back(std::move(log));
+            }
+        }
+    }
+    return logs;
+}
+
+std::vector<EthFilterLog> ReadIndexedLogs(const EthLogFilter& filter, int from, const std::vector<uint256>& blockHashes, ChainstateManager& chainman)
+{
+    std::vector<EthFilterLog> logs;
+    if (!fLogEvents || !pstorageresult || blockHashes.empty()) return logs;
+
+    BlockTreeDB& blockTree = *chainman.m_blockman.m_block_tree_db;
+    const int to = from + blockHashes.size() - 1;
+
+    std::map<uint32_t, std::vector<TransactionReceiptInfo>> blocks;
+    std::set<uint256> seen;
+    auto addReceipts = [&](const std::vector<std::vector<uint256>>& txs) {
+        for (const auto& hashes : txs) {
+            for (const uint256& hash : hashes) {
+                if (!seen.insert(hash).second) continue;
+                for (TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(hash))) {
+                    // The transaction may be in other blocks too
+                    if (receipt.blockNumber < (uint32_t)from || receipt.blockNumber > (uint32_t)to ||
+                        receipt.blockHash != blockHashes[receipt.blockNumber - from]) continue;
+                    blocks[receipt.blockNumber].push_back(std::move(receipt));
+                }
+            }
+        }
+    };
+
+    std::set<dev::h256> bloomTopics;
+    for (const auto& position : filter.topics) {
+        bloomTopics.insert(position.begin(), position.end());
+    }
+    std::vector<std::vector<uint256>> txs;
+    for (const auto& [low, high] : pstorageresult->findLogRanges(from, to, filter.addresses, bloomTopics)) {
+        // The genesis block has no logs, and the index rejects a range of just it
+        if (high == 0) continue;
+        blockTree.ReadHeightIndex(low, high, 0, txs, filter.addresses, chainman);
+    }
+    addReceipts(txs);
+    if (!filter.addresses.empty()) {
+        // Log indexes count the logs of every contract in the block
+        std::vector<std::vector<uint256>> others;
+        for (const auto& [height, receipts] : blocks) {
+            if (height > 0) blockTree.ReadHeightIndex(height, height, 0, others, {}, chainman);
+        }
+        addReceipts(others);
+    }
+
+    for (auto& [height, receipts] : blocks) {
+        // The receipts of a transaction are already in output order
+        std::stable_sort(receipts.begin(), receipts.end(), [](const TransactionReceiptInfo& a, const TransactionReceiptInfo& b) {
+            return a.transactionIndex < b.transactionIndex;
+        });
+        uint32_t logIndex = 0;
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            for (const dev::eth::LogEntry& entry : receipt.logs) {
+                const uint32_t index = logIndex++;
+                if (!filter.Matches(entry.address, entry.topics, height)) continue;
+                EthFilterLog log;
+                log.address = entry.address;
+                log.topics = entry.topics;
+                log.data = entry.data;
+                log.blockNumber = height;
+                log.blockHash = receipt.blockHash;
+                log.transactionHash = receipt.transactionHash;
+                log.transactionIndex = receipt.transactionIndex;
+                log.logIndex = index;
+                logs.push_back(std::move(log));
+            }
+        }
+    }
+    return logs;
+}
+
+std::string EthFilterManager::NewLogFilter(EthLogFilter logFilter)
+{
+    LOCK(m_mutex);
+    Filter filter{FilterType::LOG};
+    filter.logFilter = std::move(logFilter);
+    return AddFilter(std::move(filter));
+}
+
+std::string EthFilterManager::NewBlockFilter()
+{
+    LOCK(m_mutex);
+    return AddFilter(Filter{FilterType::BLOCK});
+}
+
+std::string EthFilterManager::NewPendingTransactionFilter()
+{
+    LOCK(m_mutex);
+    return AddFilter(Filter{FilterType::PENDING_TRANSACTION});
+}
+
+bool EthFilterManager::Uninstall(const std::string& id)
+{
+    LOCK(m_mutex);
+    return m_filters.erase(id) > 0;
+}
+
+bool EthFilterManager::GetChanges(const std::string& id, FilterType& type, std::vector<EthFilterLog>& logs, std::vector<uint256>& hashes)
+{
+    LOCK(m_mutex);
+    ExpireFilters();
+    auto it = m_filters.find(id);
+    if (it == m_filters.end()) return false;
+
+    Filter& filter = it->second;
+    filter.lastPoll = MockableSteadyClock::now();
+    type = filter.type;
+    logs.assign(std::make_move_iterator(filter.logs.begin()), std::make_move_iterator(filter.logs.end()));
+    hashes.assign(filter.hashes.begin(), filter.hashes.end());
+    filter.logs.clear();
+    filter.hashes.clear();
+    return true;
+}
+
+void EthFilterManager::AddBlockLogs(const uint256& blockHash, std::vector<EthFilterLog> logs)
+{
+    LOCK(m_mutex);
+    const uint64_t sequence = m_block_sequence++;
+    MatchLogs(logs, sequence, /*removed=*/false);
+    m_recent_blocks.push_back(RecentBlock{blockHash, sequence, std::move(logs)});
+    if (m_recent_blocks.size() > MAX_RECENT_BLOCKS) m_recent_blocks.pop_front();
+}
+
+void EthFilterManager::RemoveBlockLogs(const uint256& blockHash)
+{
+    LOCK(m_mutex);
+    // Blocks are disconnected from the tip, so the block is the newest one if it is kept at all
+    for (auto it = m_recent_blocks.rbegin(); it != m_recent_blocks.rend(); ++it) {
+        if (it->hash != blockHash) continue;
+        MatchLogs(it->logs, it->sequence, /*removed=*/true);
+        m_recent_blocks.erase(std::next(it).base());
+        break;
+    }
+}
+
+void EthFilterManager::BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    // The background chainstate of an assumeutxo snapshot is not followed
+    if (role == ChainstateRole::BACKGROUND) return;
+
+    const uint256 blockHash = block->GetHash();
+    {
+        LOCK(m_mutex);
+        ExpireFilters();
+        AddHash(FilterType::BLOCK, blockHash);
+        if (!HasFilters(FilterType::LOG)) return;
+    }
+    if (!fLogEvents) return;
+
+    // The receipts were committed by ConnectBlock, read them without holding the filters
+    AddBlockLogs(blockHash, ReadBlockLogs(*block, pindex));
+}
+
+void EthFilterManager::BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    RemoveBlockLogs(block->GetHash());
+}
+
+void EthFilterManager::TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence)
+{
+    LOCK(m_mutex);
+    AddHash(FilterType::PENDING_TRANSACTION, tx.info.m_tx->GetHash());
+}
+
+std::string EthFilterManager::AddFilter(Filter filter)
+{
+    ExpireFilters();
+    filter.lastPoll = MockableSteadyClock::now();
+    filter.firstBlock = m_block_sequence;
+    std::string id = strprintf("0x%x", m_next_id++);
+    m_filters.emplace(id, std::move(filter));
+    return id;
+}
+
+bool EthFilterManager::HasFilters(FilterType type) const
+{
+    for (const auto& [id, filter] : m_filters) {
+        if (filter.type == type) return true;
+    }
+    return false;
+}
+
+void EthFilterManager::ExpireFilters()
+{
+    const auto now = MockableSteadyClock::now();
+    for (auto it = m_filters.begin(); it != m_filters.end();) {
+        if (now - it->second.lastPoll > FILTER_TIMEOUT) {
+            LogDebug(BCLog::RPC, "Uninstalling eth filter %s, not polled for %d minutes\n", it->first, FILTER_TIMEOUT.count());
+            it = m_filters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void EthFilterManager::AddHash(FilterType type, const uint256& hash)
+{
+    for (auto& [id, filter] : m_filters) {
+        if (filter.type != type) continue;
+        filter.hashes.push_back(hash);
+        if (filter.hashes.size() > MAX_FILTER_CHANGES) filter.hashes.pop_front();
+    }
+}
+
+void EthFilterManager::MatchLogs(const std::vector<EthFilterLog>& logs, uint64_t sequence, bool removed)
+{
+    for (auto& [id, filter] : m_filters) {
+        if (filter.type != FilterType::LOG || sequence < filter.firstBlock) continue;
+        for (const EthFilterLog& log : logs) {
+            if (!filter.logFilter.Matches(log.address, log.topics, log.blockNumber)) continue;
+            filter.logs.push_back(log);
+            filter.logs.back().removed = removed;
+            if (filter.logs.size() > MAX_FILTER_CHANGES) filter.logs.pop_front();
+        }
+    }
+}
+
+void InitializeEthFilters(ValidationSignals* signals)
+{
+    std::lock_guard<std::mutex> lock(g_ethFiltersMutex);
+    g_ethFilters = std::make_shared<EthFilterManager>();
+    if (signals) signals->RegisterSharedValidationInterface(g_ethFilters);
+}
+
+void ShutdownEthFilters(ValidationSignals* signals)
+{
+    std::lock_guard<std::mutex> lock(g_ethFiltersMutex);
+    if (signals && g_ethFilters) signals->UnregisterSharedValidationInterface(g_ethFilters);
+    g_ethFilters.reset();
+}
+
+std::shared_ptr<EthFilterManager> GetEthFilterManager()
+{
+    std::lock_guard<std::mutex> lock(g_ethFiltersMutex);
+    return g_ethFilters;
+}
+
+} // namespace node
@@ -0,0 +1,186 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_NODE_ETH_FILTERS_H
+#define WATTX_NODE_ETH_FILTERS_H
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/time.h>
+#include <validationinterface.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class ChainstateManager;
+class ValidationSignals;
+
+namespace node {
+
+/**
+ * @brief Compiled log filter of eth_newFilter
+ *
+ * A log matches if it comes from one of the addresses and, for each topic
+ * position, carries one of the topics given there. An empty set matches
+ * anything, and so do the positions past the end of topics.
+ */
+struct EthLogFilter
+{
+    std::set<dev::h160> addresses;
+    std::vector<std::set<dev::h256>> topics;
+    //! Block range, -1 for no bound
+    int fromBlock{-1};
+    int toBlock{-1};
+
+    bool Matches(const dev::h160& address, const dev::h256s& logTopics, int height) const;
+};
+
+/**
+ * @brief A log as reported by eth_getFilterChanges
+ */
+struct EthFilterLog
+{
+    dev::h160 address;
+    dev::h256s topics;
+    dev::bytes data;
+    int blockNumber{0};
+    uint256 blockHash;
+    uint256 transactionHash;
+    uint32_t transactionIndex{0};
+    //! Index of the log in its block
+    uint32_t logIndex{0};
+    //! The block of the log was disconnected
+    bool removed{false};
+};
+
+/**
+ * @brief Read the logs of a connected block from its receipts
+ *
+ * Empty unless -logevents is on. Must run while the block is still on the
+ * active chain, the receipts of a disconnected block are gone.
+ */
+std::vector<EthFilterLog> ReadBlockLogs(const CBlock& block, const CBlockIndex* pindex);
+
+/**
+ * @brief Read the logs matching a filter in consecutive blocks from the indexes
+ *
+ * Only the blocks whose log bloom may match are visited, through the
+ * height index and the receipts, without reading the blocks themselves.
+ * Receipts of other blocks than blockHashes, the hashes of the blocks from
+ * height from on, are skipped. Empty unless -logevents is on. Safe to call
+ * from several threads and without cs_main.
+ */
+std::vector<EthFilterLog> ReadIndexedLogs(const EthLogFilter& filter, int from, const std::vector<uint256>& blockHashes, ChainstateManager& chainman);
+
+/**
+ * @brief Filters of the eth_newFilter family
+ *
+ * Rather than searching the receipts again on every poll, installed
+ * filters are matched against each connected block's logs once, from the
+ * validation signals, and the matches wait in the filter until the next
+ * eth_getFilterChanges takes them. Block and pending transaction filters
+ * buffer hashes the same way. Logs of a disconnected block are reported
+ * again with removed set, for as long as the block is among the recent
+ * ones kept for that. Filters that are not polled for FILTER_TIMEOUT are
+ * uninstalled, as in geth.
+ */
+class EthFilterManager final : public CValidationInterface
+{
+public:
+    enum class FilterType { LOG, BLOCK, PENDING_TRANSACTION };
+
+    //! Filters not polled for this long are uninstalled
+    static constexpr std::chrono::minutes FILTER_TIMEOUT{5};
+    //! Changes kept per filter between polls, the oldest are dropped beyond it
+    static constexpr size_t MAX_FILTER_CHANGES{10000};
+    //! Connected blocks whose logs are kept to report them removed
+    static constexpr size_t MAX_RECENT_BLOCKS{64};
+
+    std::string NewLogFilter(EthLogFilter filter);
+    std::string NewBlockFilter();
+    std::string NewPendingTransactionFilter();
+    bool Uninstall(const std::string& id);
+
+    /**
+     * Take the changes buffered since the last poll
+     *
+     * @param[out] type the type of the filter
+     * @param[out] logs the logs matched, for a log filter
+     * @param[out] hashes the block or transaction hashes, for the other filters
+     * @return false if there is no such filter
+     */
+    bool GetChanges(const std::string& id, FilterType& type, std::vector<EthFilterLog>& logs, std::vector<uint256>& hashes);
+
+    //! Match the logs of a connected block against the log filters
+    void AddBlockLogs(const uint256& blockHash, std::vector<EthFilterLog> logs);
+    //! Report the logs of a disconnected block as removed
+    void RemoveBlockLogs(const uint256& blockHash);
+
+protected:
+    //! CValidationInterface
+    void BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+    void TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence) override;
+
+private:
+    struct Filter
+    {
+        FilterType type;
+        EthLogFilter logFilter{};
+        std::deque<EthFilterLog> logs{};
+        std::deque<uint256> hashes{};
+        MockableSteadyClock::time_point lastPoll{};
+        //! Sequence number of the first block the filter saw
+        uint64_t firstBlock{0};
+    };
+
+    struct RecentBlock
+    {
+        uint256 hash;
+        uint64_t sequence;
+        std::vector<EthFilterLog> logs;
+    };
+
+    std::string AddFilter(Filter filter) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    bool HasFilters(FilterType type) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void ExpireFilters() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void AddHash(FilterType type, const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void MatchLogs(const std::vector<EthFilterLog>& logs, uint64_t sequence, bool removed) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    mutable Mutex m_mutex;
+    std::map<std::string, Filter> m_filters GUARDED_BY(m_mutex);
+    uint64_t m_next_id GUARDED_BY(m_mutex){1};
+    //! Blocks whose logs were matched, counted so removals go to the filters that saw them
+    uint64_t m_block_sequence GUARDED_BY(m_mutex){0};
+    //! Logs of the recently connected blocks, oldest first
+    std::deque<RecentBlock> m_recent_blocks GUARDED_BY(m_mutex);
+};
+
+/**
+ * @brief Create the filter manager and register it with the validation signals
+ */
+void InitializeEthFilters(ValidationSignals* signals);
+
+/**
+ * @brief Unregister and destroy the filter manager
+ */
+void ShutdownEthFilters(ValidationSignals* signals);
+
+/**
+ * @brief Get the filter manager, null before initialization
+ */
+std::shared_ptr<EthFilterManager> GetEthFilterManager();
+
+} // namespace node
+
+#endif // WATTX_NODE_ETH_FILTERS_H
@@ -0,0 +1,175 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/gasprice.h>
+
+#include <chain.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <txmempool.h>
+#include <uint256.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace node {
+namespace {
+/** Block part of the last SuggestGasPrice() */
+struct GasPriceCache {
+    Mutex m_mutex;
+    uint256 m_tip GUARDED_BY(m_mutex);
+    CAmount m_min_gas_price GUARDED_BY(m_mutex){0};
+    uint64_t m_block_gas_limit GUARDED_BY(m_mutex){0};
+    CAmount m_price GUARDED_BY(m_mutex){0};
+};
+GasPriceCache g_gas_price_cache;
+} // namespace
+
+/** Gas limit and price of a contract output: the pushes before its gas price
+ * and data, and the address of an OP_CALL, counted from the end so that an
+ * OP_SENDER prefix does not matter. */
+static std::optional<GasPriceSample> GetOutputGas(const CScript& script)
+{
+    std::vector<valtype> values;
+    CScript::const_iterator pc = script.begin();
+    opcodetype opcode{OP_INVALIDOPCODE};
+    valtype data;
+    while (pc < script.end()) {
+        if (!script.GetOp(pc, opcode, data)) return std::nullopt;
+        if (opcode == OP_CALL || opcode == OP_CREATE) break;
+        if (opcode >= OP_1 && opcode <= OP_16) data = CScriptNum(CScript::DecodeOP_N(opcode)).getvch();
+        values.push_back(data);
+    }
+    if (opcode != OP_CALL && opcode != OP_CREATE) return std::nullopt;
+    const size_t gas_limit_pos{opcode == OP_CALL ? 4u : 3u};
+    if (values.size() < gas_limit_pos) return std::nullopt;
+    try {
+        const uint64_t gas_limit{CScriptNum::vch_to_uint64(values[values.size() - gas_limit_pos])};
+        const uint64_t gas_price{CScriptNum::vch_to_uint64(values[values.size() - gas_limit_pos + 1])};
+        if (gas_price > uint64_t(std::numeric_limits<CAmount>::max())) return std::nullopt;
+        return GasPriceSample{CAmount(gas_price), gas_limit};
+    } catch (const scriptnum_error&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<GasPriceSample> GetContractGas(const CTransaction& tx)
+{
+    if (!tx.HasCreateOrCall()) return std::nullopt;
+    std::optional<GasPriceSample> result;
+    for (const CTxOut& out : tx.vout) {
+        if (!out.scriptPubKey.HasOpCall() && !out.scriptPubKey.HasOpCreate()) continue;
+        const auto gas{GetOutputGas(out.scriptPubKey)};
+        if (!gas) continue;
+        if (!result) {
+            result = gas;
+        } else {
+            result->gas_price = std::min(result->gas_price, gas->gas_price);
+            result->gas_limit = std::min(result->gas_limit + gas->gas_limit, uint64_t(std::numeric_limits<int64_t>::max()));
+        }
+    }
+    return result;
+}
+
+std::vector<GasPriceSample> GetBlockGasPrices(const CBlock& block)
+{
+    std::vector<GasPriceSample> samples;
+    for (const CTransactionRef& tx : block.vtx) {
+        if (const auto gas{GetContractGas(*tx)}) samples.push_back(*gas);
+    }
+    return samples;
+}
+
+std::vector<GasPriceSample> GetMempoolGasPrices(const CTxMemPool& pool)
+{
+    std::vector<GasPriceSample> samples;
+    LOCK(pool.cs);
+    for (const CTxMemPoolEntry& entry : pool.mapTx.get<gas_price>()) {
+        // Contract txs come first
+        if (entry.GetGasLimit() == 0) break;
+        samples.push_back({entry.GetMinGasPrice(), entry.GetGasLimit()});
+    }
+    return samples;
+}
+
+CAmount GasPricePercentile(std::vector<GasPriceSample> samples, double percentile)
+{
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end(), [](const GasPriceSample& a, const GasPriceSample& b) {
+        return a.gas_price < b.gas_price;
+    });
+    uint64_t total{0};
+    for (const GasPriceSample& sample : samples) total += sample.gas_limit;
+    const double threshold{total * std::clamp(percentile, 0.0, 100.0) / 100.0};
+    uint64_t cumulative{0};
+    for (const GasPriceSample& sample : samples) {
+        cumulative += sample.gas_limit;
+        if (cumulative >= threshold) return sample.gas_price;
+    }
+    return samples.back().gas_price;
+}
+
+CAmount GetClearingGasPrice(const std::vector<GasPriceSample>& samples, uint64_t block_gas_limit)
+{
+    uint64_t cumulative{0};
+    for (const GasPriceSample& sample : samples) {
+        cumulative += sample.gas_limit;
+        if (cumulative >= block_gas_limit) return sample.gas_price;
+    }
+    return 0;
+}
+
+CAmount SuggestGasPrice(ChainstateManager& chainman, const CTxMemPool* mempool, CAmount min_gas_price, uint64_t block_gas_limit)
+{
+    GasPriceCache& cache{g_gas_price_cache};
+    std::vector<const CBlockIndex*> blocks;
+    {
+        LOCK(cs_main);
+        for (const CBlockIndex* index = chainman.ActiveChain().Tip(); index && blocks.size() < GAS_PRICE_ORACLE_BLOCKS; index = index->pprev) {
+            blocks.push_back(index);
+        }
+    }
+
+    CAmount block_price{min_gas_price};
+    const uint256 tip{blocks.empty() ? uint256{} : blocks.front()->GetBlockHash()};
+    LOCK(cache.m_mutex);
+    if (!blocks.empty() && tip == cache.m_tip && min_gas_price == cache.m_min_gas_price && block_gas_limit == cache.m_block_gas_limit) {
+        block_price = cache.m_price;
+    } else if (!blocks.empty()) {
+        std::vector<CAmount> prices;
+        for (const CBlockIndex* index : blocks) {
+            CBlock block;
+            if (!chainman.m_blockman.ReadBlock(block, *index)) continue;
+            const std::vector<GasPriceSample> samples{GetBlockGasPrices(block)};
+            uint64_t gas{0};
+            CAmount lowest{std::numeric_limits<CAmount>::max()};
+            for (const GasPriceSample& sample : samples) {
+                gas += sample.gas_limit;
+                lowest = std::min(lowest, sample.gas_price);
+            }
+            // A block with room to spare took anything paying the minimum
+            prices.push_back(gas * 2 < block_gas_limit ? min_gas_price : std::max(lowest, min_gas_price));
+        }
+        if (!prices.empty()) {
+            std::sort(prices.begin(), prices.end());
+            block_price = prices[(prices.size() - 1) * GAS_PRICE_ORACLE_PERCENTILE / 100];
+        }
+        cache.m_tip = tip;
+        cache.m_min_gas_price = min_gas_price;
+        cache.m_block_gas_limit = block_gas_limit;
+        cache.m_price = block_price;
+    }
+
+    CAmount price{std::max(block_price, min_gas_price)};
+    if (mempool) {
+        price = std::max(price, GetClearingGasPrice(GetMempoolGasPrices(*mempool), block_gas_limit));
+    }
+    return price;
+}
+
+} // namespace node
@@ -0,0 +1,66 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_NODE_GASPRICE_H
+#define WATTX_NODE_GASPRICE_H
+
+#include <consensus/amount.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class CBlock;
+class CTransaction;
+class CTxMemPool;
+class ChainstateManager;
+
+namespace node {
+
+//! Recent blocks the gas price oracle samples
+static constexpr int GAS_PRICE_ORACLE_BLOCKS{20};
+//! Percentile of the sampled block prices the oracle suggests
+static constexpr double GAS_PRICE_ORACLE_PERCENTILE{60};
+
+/** Contract gas of a transaction: the sum of its gas limits, paid at its lowest gas price. */
+struct GasPriceSample {
+    CAmount gas_price{0};
+    uint64_t gas_limit{0};
+};
+
+/** Gas of the contract outputs of a tx, read from their scripts. Nothing for non-contract txs. */
+std::optional<GasPriceSample> GetContractGas(const CTransaction& tx);
+
+/** Gas of the contract txs of a block, in block order. */
+std::vector<GasPriceSample> GetBlockGasPrices(const CBlock& block);
+
+/** Gas of the contract txs in the mempool, highest gas price first. */
+std::vector<GasPriceSample> GetMempoolGasPrices(const CTxMemPool& pool);
+
+/**
+ * Gas price below which @p percentile percent of the gas in @p samples is
+ * paid, 0 without samples.
+ */
+CAmount GasPricePercentile(std::vector<GasPriceSample> samples, double percentile);
+
+/**
+ * Lowest gas price that still makes it into a block of @p block_gas_limit,
+ * given @p samples highest price first. 0 if all of them fit.
+ */
+CAmount GetClearingGasPrice(const std::vector<GasPriceSample>& samples, uint64_t block_gas_limit);
+
+/**
+ * Gas price to offer for inclusion in the next blocks.
+ *
+ * Each of the last GAS_PRICE_ORACLE_BLOCKS blocks contributes the lowest gas
+ * price it included, or @p min_gas_price if its gas limits left half of the
+ * block free, and the GAS_PRICE_ORACLE_PERCENTILE percentile of these is
+ * taken. If the mempool holds more gas than a block, its clearing price is a
+ * floor. The block part is cached per tip.
+ */
+CAmount SuggestGasPrice(ChainstateManager& chainman, const CTxMemPool* mempool, CAmount min_gas_price, uint64_t block_gas_limit);
+
+} // namespace node
+
+#endif // WATTX_NODE_GASPRICE_H
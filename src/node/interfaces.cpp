@@ -57,6 +57,7 @@
 #include <uint256.h>
 #include <univalue.h>
 #include <util/check.h>
+#include <util/convert.h>
 #include <util/result.h>
 #include <util/signalinterrupt.h>
 #include <util/string.h>
@@ -86,6 +87,7 @@ using interfaces::BlockRef;
 using interfaces::BlockTemplate;
 using interfaces::BlockTip;
 using interfaces::Chain;
+using interfaces::ContractLog;
 using interfaces::FoundBlock;
 using interfaces::Handler;
 using interfaces::MakeSignalHandler;
@@ -1014,6 +1016,10 @@ public:
     {
         RefreshDelegates(pwallet, myDelegates, stakerDelegates);
     }
+    void refreshDelegationsWeight(wallet::CWallet& wallet) override
+    {
+        RefreshDelegationsWeight(wallet);
+    }
     Span<const CRPCCommand> getContractRPCCommands() override
     {
         return wallet::GetContractRPCCommands();
@@ -1032,6 +1038,27 @@ public:
     {
         return QtumDelegation::VerifyDelegation(address, delegation);
     }
+    bool getBlockContractLogs(const CBlock& block, std::vector<ContractLog>& logs) override
+    {
+        logs.clear();
+        if (!fLogEvents || !pstorageresult) return false;
+        const uint256 block_hash{block.GetHash()};
+        for (const CTransactionRef& tx : block.vtx) {
+            if (!tx->HasCreateOrCall()) continue;
+            for (const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))) {
+                // The transaction may have been in another block too
+                if (receipt.blockHash != block_hash) continue;
+                for (const dev::eth::LogEntry& entry : receipt.logs) {
+                    ContractLog& log{logs.emplace_back()};
+                    log.tx_hash = tx->GetHash();
+                    log.address = h160Touint(entry.address);
+                    for (const dev::h256& topic : entry.topics) log.topics.push_back(h256Touint(topic));
+                    log.data = entry.data;
+                }
+            }
+        }
+        return true;
+    }
     NodeContext& m_node;
 };
 
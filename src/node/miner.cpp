@@ -6,6 +6,7 @@
 #include <node/miner.h>
 
 #include <chain.h>
+#include <cluster_linearize.h>
 #include <chainparams.h>
 #include <coins.h>
 #include <common/args.h>
@@ -21,14 +22,18 @@
 #include <policy/policy.h>
 #include <pow.h>
 #include <pos.h>
+#include <random.h>
 #include <primitives/transaction.h>
+#include <util/bitset.h>
 #include <util/moneystr.h>
 #include <util/time.h>
+#include <util/trace.h>
 #include <validation.h>
 #include <util/threadnames.h>
 #include <key_io.h>
 #include <qtum/qtumledger.h>
 #include <qtum/qtumdelegation.h>
+#include <qtum/statepruner.h>
 #ifdef ENABLE_WALLET
 #include <wallet/wallet.h>
 #include <wallet/receive.h>
@@ -36,8 +41,20 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <utility>
 
+#ifdef ENABLE_WALLET
+TRACEPOINT_SEMAPHORE(staker, kernel_search);
+TRACEPOINT_SEMAPHORE(staker, candidate_block);
+TRACEPOINT_SEMAPHORE(staker, block_signed);
+TRACEPOINT_SEMAPHORE(staker, slot_missed);
+#endif
+
 namespace node {
 unsigned int nMaxStakeLookahead = MAX_STAKE_LOOKAHEAD;
 unsigned int nBytecodeTimeBuffer = BYTECODE_TIME_BUFFER;
@@ -141,6 +158,7 @@ void ApplyArgsManOptions(const ArgsManager& args, BlockAssembler::Options& optio
         if (const auto parsed{ParseMoney(*blockmintxfee)}) options.blockMinFeeRate = CFeeRate{*parsed};
     }
     options.print_modified_fee = args.GetBoolArg("-printpriority", options.print_modified_fee);
+    options.cluster_selection = args.GetBoolArg("-blockclusterselection", options.cluster_selection);
     options.block_reserved_weight = args.GetIntArg("-blockreservedweight", options.block_reserved_weight);
 }
 
@@ -151,6 +169,71 @@ static BlockAssembler::Options ConfiguredOptions()
     return options;
 }
 
+/** Everything the selection of a template depends on besides the mempool */
+struct AssemblyKey {
+    uint256 hashPrevBlock;
+    uint32_t nTime{0};
+    bool fProofOfStake{false};
+    CScript rewardScript;
+    size_t nBlockMaxWeight{0};
+    size_t nReservedWeight{0};
+    size_t nReservedSigOps{0};
+    CFeeRate blockMinFeeRate;
+    uint64_t minGasPrice{0};
+    uint64_t hardBlockGasLimit{0};
+    uint64_t softBlockGasLimit{0};
+    uint64_t txGasLimit{0};
+
+    bool operator==(const AssemblyKey&) const = default;
+};
+
+/**
+ * The selection of the last incremental template, with the contract
+ * execution state it left, so the next template for the same key only has
+ * to execute the transactions that entered the mempool since.
+ */
+struct AssemblyCheckpoint {
+    AssemblyKey key;
+    //! Transactions after the reward ones
+    std::vector<CTransactionRef> vtx;
+    std::vector<CAmount> vTxFees;
+    std::vector<int64_t> vTxSigOpsCost;
+    std::vector<FeeFrac> packageFeerates;
+    std::unordered_set<Txid, SaltedTxidHasher> inBlock;
+    std::set<Txid> failedContracts;
+    //! Of bceResult, whose value transfers are in vtx already
+    uint64_t usedGas{0};
+    CAmount refundSender{0};
+    std::vector<CTxOut> refundOutputs;
+    uint64_t nBlockWeight{0};
+    uint64_t nBlockTx{0};
+    uint64_t nBlockSigOpsCost{0};
+    CAmount nFees{0};
+    dev::h256 stateRoot;
+    dev::h256 utxoRoot;
+    //! State pruning started since takes the roots along
+    uint64_t pruneCount{0};
+};
+
+//! Seconds a PoW template may keep the time of the one it continues from
+static constexpr uint32_t MAX_CHECKPOINT_AGE{30};
+
+//! Last checkpoint of PoW and of PoS templates
+static std::shared_ptr<const AssemblyCheckpoint> g_assemblyCheckpoints[2];
+static std::mutex g_assemblyCheckpointsMutex;
+
+static std::shared_ptr<const AssemblyCheckpoint> GetAssemblyCheckpoint(bool fProofOfStake)
+{
+    std::lock_guard<std::mutex> lock(g_assemblyCheckpointsMutex);
+    return g_assemblyCheckpoints[fProofOfStake];
+}
+
+static void SetAssemblyCheckpoint(std::shared_ptr<const AssemblyCheckpoint> checkpoint)
+{
+    std::lock_guard<std::mutex> lock(g_assemblyCheckpointsMutex);
+    g_assemblyCheckpoints[checkpoint->key.fProofOfStake] = std::move(checkpoint);
+}
+
 #ifdef ENABLE_WALLET
 BlockAssembler::BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool, wallet::CWallet* _pwallet, const Options& options)
     : BlockAssembler(chainstate, mempool, options)
@@ -162,6 +245,8 @@ BlockAssembler::BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool
 void BlockAssembler::resetBlock()
 {
     inBlock.clear();
+    m_failed_contracts.clear();
+    m_checkpoint.reset();
 
     // Reserve space for fixed-size block header, txs count, and coinbase tx.
     nBlockWeight = m_options.block_reserved_weight;
@@ -233,6 +318,17 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(bool fProofOfStak
     pblock->nTime = txProofTime;
     if (!fProofOfStake)
         UpdateTime(pblock, chainparams.GetConsensus(), pindexPrev);
+
+    std::shared_ptr<const AssemblyCheckpoint> checkpoint;
+    if (m_options.incremental && m_mempool) {
+        checkpoint = GetAssemblyCheckpoint(fProofOfStake);
+        // Contracts see the block time, so a PoW template keeps the time of a recent one
+        // for the same parent, which was valid for it, to continue its execution
+        if (checkpoint && !fProofOfStake && checkpoint->key.hashPrevBlock == pindexPrev->GetBlockHash() &&
+            pblock->nTime >= checkpoint->key.nTime && pblock->nTime - checkpoint->key.nTime <= MAX_CHECKPOINT_AGE) {
+            pblock->nTime = checkpoint->key.nTime;
+        }
+    }
     pblock->nBits = GetNextWorkRequired(pindexPrev, pblock, chainparams.GetConsensus(),fProofOfStake);
 
     m_lock_time_cutoff = pindexPrev->GetMedianTimePast();
@@ -292,7 +388,14 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(bool fProofOfStak
     txGasLimit = gArgs.GetIntArg("-staker-max-tx-gas-limit", softBlockGasLimit);
 
     m_options.nBlockMaxWeight = blockSizeDGP ? blockSizeDGP * WITNESS_SCALE_FACTOR : m_options.nBlockMaxWeight;
-    
+
+    const AssemblyKey key{pindexPrev->GetBlockHash(), pblock->nTime, fProofOfStake, m_options.coinbase_output_script,
+                          m_options.nBlockMaxWeight, m_options.block_reserved_weight, m_options.coinbase_output_max_additional_sigops,
+                          m_options.blockMinFeeRate, minGasPrice, hardBlockGasLimit, softBlockGasLimit, txGasLimit};
+    if (checkpoint && checkpoint->key == key) {
+        m_checkpoint = std::move(checkpoint);
+    }
+
     dev::h256 oldHashStateRoot(globalState->rootHash());
     dev::h256 oldHashUTXORoot(globalState->rootHashUTXO());
     ////////////////////////////////////////////////// deploy offline staking contract
@@ -304,7 +407,32 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(bool fProofOfStak
     int nDescendantsUpdated = 0;
     if (m_mempool) {
         LOCK(m_mempool->cs);
-        addPackageTxs(nPackagesSelected, nDescendantsUpdated, minGasPrice, pblock);
+        if (m_options.cluster_selection) {
+            addClusterTxs(nPackagesSelected, minGasPrice, pblock);
+        } else {
+            addPackageTxs(nPackagesSelected, nDescendantsUpdated, minGasPrice, pblock);
+        }
+    }
+    if (m_options.incremental && m_mempool) {
+        auto next = std::make_shared<AssemblyCheckpoint>();
+        next->key = key;
+        next->vtx.assign(pblock->vtx.begin() + (fProofOfStake ? 2 : 1), pblock->vtx.end());
+        next->vTxFees.assign(pblocktemplate->vTxFees.begin() + 1, pblocktemplate->vTxFees.end());
+        next->vTxSigOpsCost.assign(pblocktemplate->vTxSigOpsCost.begin() + 1, pblocktemplate->vTxSigOpsCost.end());
+        next->packageFeerates = pblocktemplate->m_package_feerates;
+        next->inBlock.insert(inBlock.begin(), inBlock.end());
+        next->failedContracts = m_failed_contracts;
+        next->usedGas = bceResult.usedGas;
+        next->refundSender = bceResult.refundSender;
+        next->refundOutputs = bceResult.refundOutputs;
+        next->nBlockWeight = nBlockWeight;
+        next->nBlockTx = nBlockTx;
+        next->nBlockSigOpsCost = nBlockSigOpsCost;
+        next->nFees = nFees;
+        next->stateRoot = globalState->rootHash();
+        next->utxoRoot = globalState->rootHashUTXO();
+        next->pruneCount = GetStatePruneCount();
+        SetAssemblyCheckpoint(std::move(next));
     }
     pblock->hashStateRoot = uint256(h256Touint(dev::h256(globalState->rootHash())));
     pblock->hashUTXORoot = uint256(h256Touint(dev::h256(globalState->rootHashUTXO())));
@@ -489,8 +617,13 @@ bool BlockAssembler::TestPackageTransactions(const CTxMemPool::setEntries& packa
     return true;
 }
 
+bool BlockAssembler::OutOfBytecodeTime() const
+{
+    return nTimeLimit != 0 && TicksSinceEpoch<std::chrono::seconds>(NodeClock::now()) >= nTimeLimit - nBytecodeTimeBuffer;
+}
+
 bool BlockAssembler::AttemptToAddContractToBlock(CTxMemPool::txiter iter, uint64_t minGasPrice, CBlock* pblock) {
-    if (nTimeLimit != 0 && TicksSinceEpoch<std::chrono::seconds>(NodeClock::now()) >= nTimeLimit - nBytecodeTimeBuffer) {
+    if (OutOfBytecodeTime()) {
         return false;
     }
     if (pblock->IsProofOfStake() && gArgs.GetBoolArg("-disablecontractstaking", false))
@@ -506,10 +639,12 @@ bool BlockAssembler::AttemptToAddContractToBlock(CTxMemPool::txiter iter, uint64
     uint64_t nBlockSigOpsCost = this->nBlockSigOpsCost;
 
     unsigned int contractflags = GetContractScriptFlags(nHeight, chainparams.GetConsensus());
-    QtumTxConverter convert(iter->GetTx(), m_chainstate, m_mempool, NULL, &pblock->vtx, contractflags);
-
+    // Reuse the contract transactions extracted when the tx entered the mempool
     ExtractQtumTX resultConverter;
-    if(!convert.extractionQtumTransactions(resultConverter)){
+    const std::shared_ptr<const CachedQtumTX>& cached = iter->GetQtumTX();
+    if(cached && cached->flags == contractflags){
+        resultConverter = cached->extracted;
+    } else if(!QtumTxConverter(iter->GetTx(), m_chainstate, m_mempool, NULL, &pblock->vtx, contractflags).extractionQtumTransactions(resultConverter)){
         //this check already happens when accepting txs into mempool
         //therefore, this can only be triggered by using raw transactions on the staker itself
         LogPrintf("AttemptToAddContractToBlock(): Fail to extract contacts from tx %s\n", iter->GetTx().GetHash().ToString());
@@ -654,6 +789,46 @@ void BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
     }
 }
 
+bool BlockAssembler::RestoreCheckpoint(CBlock* pblock, CTxMemPool::setEntries& restored)
+{
+    const AssemblyCheckpoint& checkpoint = *m_checkpoint;
+
+    // A transaction mined, replaced or evicted since takes the execution after it along
+    for (const Txid& txid : checkpoint.inBlock) {
+        std::optional<CTxMemPool::txiter> it = m_mempool->GetIter(txid);
+        if (!it) {
+            restored.clear();
+            return false;
+        }
+        restored.insert(*it);
+    }
+    if (checkpoint.pruneCount != GetStatePruneCount() ||
+        (checkpoint.stateRoot != globalState->rootHash() && !globalState->db().exists(checkpoint.stateRoot)) ||
+        (checkpoint.utxoRoot != globalState->rootHashUTXO() && !globalState->dbUtxo().exists(checkpoint.utxoRoot))) {
+        restored.clear();
+        return false;
+    }
+
+    pblock->vtx.insert(pblock->vtx.end(), checkpoint.vtx.begin(), checkpoint.vtx.end());
+    pblocktemplate->vTxFees.insert(pblocktemplate->vTxFees.end(), checkpoint.vTxFees.begin(), checkpoint.vTxFees.end());
+    pblocktemplate->vTxSigOpsCost.insert(pblocktemplate->vTxSigOpsCost.end(), checkpoint.vTxSigOpsCost.begin(), checkpoint.vTxSigOpsCost.end());
+    pblocktemplate->m_package_feerates = checkpoint.packageFeerates;
+    inBlock.insert(checkpoint.inBlock.begin(), checkpoint.inBlock.end());
+    m_failed_contracts = checkpoint.failedContracts;
+    bceResult.usedGas = checkpoint.usedGas;
+    bceResult.refundSender = checkpoint.refundSender;
+    bceResult.refundOutputs = checkpoint.refundOutputs;
+    nBlockWeight = checkpoint.nBlockWeight;
+    nBlockTx = checkpoint.nBlockTx;
+    nBlockSigOpsCost = checkpoint.nBlockSigOpsCost;
+    nFees = checkpoint.nFees;
+    globalState->setRoot(checkpoint.stateRoot);
+    globalState->setRootUTXO(checkpoint.utxoRoot);
+    // The sigops counted include the refunds in the reward tx
+    RebuildRefundTransaction(pblock);
+    return true;
+}
+
 /** Add descendants of given transactions to mapModifiedTx with ancestor
  * state updated assuming given transactions are inBlock. Returns number
  * of updated descendants. */
@@ -716,6 +891,20 @@ void BlockAssembler::addPackageTxs(int& nPackagesSelected, int& nDescendantsUpda
     // Keep track of entries that failed inclusion, to avoid duplicate work
     std::set<Txid> failedTx;
 
+    // Continue from the checkpoint, so only what entered the mempool since is selected and executed
+    if (m_checkpoint) {
+        CTxMemPool::setEntries restored;
+        if (RestoreCheckpoint(pblock, restored)) {
+            nDescendantsUpdated += UpdatePackagesForAdded(mempool, restored, mapModifiedTx);
+            failedTx.insert(m_failed_contracts.begin(), m_failed_contracts.end());
+            for (const Txid& txid : m_failed_contracts) {
+                if (std::optional<CTxMemPool::txiter> it = mempool.GetIter(txid)) mapModifiedTx.erase(*it);
+            }
+        } else {
+            LogDebug(BCLog::BENCH, "CreateNewBlock(): checkpoint outdated, selecting from scratch\n");
+        }
+    }
+
     CTxMemPool::indexed_transaction_set::index<ancestor_score_or_gas_price>::type::iterator mi = mempool.mapTx.get<ancestor_score_or_gas_price>().begin();
     CTxMemPool::txiter iter;
 
@@ -850,6 +1039,9 @@ void BlockAssembler::addPackageTxs(int& nPackagesSelected, int& nDescendantsUpda
                 if (tx.HasCreateOrCall()) {
                     wasAdded = AttemptToAddContractToBlock(sortedEntries[i], minGasPrice, pblock);
                     if(!wasAdded){
+                        // Running out of time says nothing about the tx, a continuation may add it
+                        if(!OutOfBytecodeTime())
+                            m_failed_contracts.insert(tx.GetHash());
                         if(fUsingModified) {
                             //this only needs to be done once to mark the whole package (everything in sortedEntries) as failed
                             mapModifiedTx.get<ancestor_score_or_gas_price>().erase(modit);
@@ -877,6 +1069,207 @@ void BlockAssembler::addPackageTxs(int& nPackagesSelected, int& nDescendantsUpda
     }
 }
 
+// Cluster-based selection. The mempool tracks ancestors only, so the clusters
+// (connected components of the dependency graph) are collected here, and each
+// is linearized with cluster_linearize.h and cut into chunks: the runs of the
+// linearization that are included together. Chunks are then added best first.
+//
+// A block has two budgets, weight and gas, and a contract tx uses both. The
+// gas limit of a tx is counted as the share of block space it takes of the
+// soft block gas limit, so a chunk's score is its fee over vsize plus that
+// share, and fee-per-gas competes with fee-per-vbyte on the same scale.
+// Clusters beyond what a DepGraph holds keep their topological order and
+// are only chunked.
+void BlockAssembler::addClusterTxs(int& nPackagesSelected, uint64_t minGasPrice, CBlock* pblock)
+{
+    const auto& mempool{*Assert(m_mempool)};
+    LOCK(mempool.cs);
+
+    // Continue from the checkpoint, so only what entered the mempool since is selected and executed
+    if (m_checkpoint) {
+        CTxMemPool::setEntries restored;
+        if (!RestoreCheckpoint(pblock, restored)) {
+            LogDebug(BCLog::BENCH, "CreateNewBlock(): checkpoint outdated, selecting from scratch\n");
+        }
+    }
+
+    using SetType = BitSet<64>;
+    const uint64_t MAX_LINEARIZATION_ITERATIONS = 10000;
+
+    // Index the candidates and join them into clusters
+    std::vector<CTxMemPool::txiter> candidates;
+    std::map<CTxMemPool::txiter, size_t, CompareIteratorByHash> position;
+    for (auto it = mempool.mapTx.begin(); it != mempool.mapTx.end(); ++it) {
+        const Txid& txid = it->GetSharedTx()->GetHash();
+        if (inBlock.count(txid) || m_failed_contracts.count(txid)) continue;
+        position.emplace(it, candidates.size());
+        candidates.push_back(it);
+    }
+    std::vector<size_t> root(candidates.size());
+    for (size_t i = 0; i < root.size(); ++i) root[i] = i;
+    auto find = [&](size_t i) {
+        while (root[i] != i) i = root[i] = root[root[i]];
+        return i;
+    };
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        for (const CTxMemPoolEntry& parent : candidates[i]->GetMemPoolParentsConst()) {
+            auto pos = position.find(mempool.mapTx.iterator_to(parent));
+            if (pos != position.end()) root[find(i)] = find(pos->second);
+        }
+    }
+    std::map<size_t, std::vector<CTxMemPool::txiter>> clusters;
+    for (size_t i = 0; i < candidates.size(); ++i) clusters[find(i)].push_back(candidates[i]);
+
+    // Resource use of a tx: its vsize plus its gas limit as a share of the block
+    const uint64_t block_vsize = m_options.nBlockMaxWeight / WITNESS_SCALE_FACTOR;
+    const unsigned int contractflags = GetContractScriptFlags(nHeight, chainparams.GetConsensus());
+    auto resource = [&](CTxMemPool::txiter it) {
+        int64_t size = it->GetTxSize();
+        const std::shared_ptr<const CachedQtumTX>& cached = it->GetQtumTX();
+        if (cached && cached->flags == contractflags && softBlockGasLimit > 0) {
+            dev::u256 gas = 0;
+            for (const QtumTransaction& qtumTransaction : cached->extracted.first) gas += qtumTransaction.gas();
+            const uint64_t capped = gas > softBlockGasLimit ? softBlockGasLimit : static_cast<uint64_t>(gas);
+            size += static_cast<int64_t>(capped * block_vsize / softBlockGasLimit);
+        }
+        return static_cast<int32_t>(std::min<int64_t>(size, std::numeric_limits<int32_t>::max()));
+    };
+
+    struct Chunk {
+        size_t cluster;
+        size_t index;
+        FeeFrac score;
+        CAmount fee{0};
+        uint64_t size{0};
+        int64_t sigops{0};
+        std::vector<CTxMemPool::txiter> txs{};
+    };
+    std::vector<Chunk> chunks;
+    FastRandomContext rng;
+    size_t cluster_index{0};
+    for (auto& [_, txs] : clusters) {
+        // More ancestors means later in any topological order
+        std::sort(txs.begin(), txs.end(), CompareTxIterByAncestorCount());
+        std::vector<FeeFrac> feefracs;
+        feefracs.reserve(txs.size());
+        for (const auto& it : txs) feefracs.emplace_back(it->GetModifiedFee(), resource(it));
+
+        std::vector<cluster_linearize::ClusterIndex> linearization(txs.size());
+        for (size_t i = 0; i < txs.size(); ++i) linearization[i] = i;
+        if (txs.size() > 1 && txs.size() <= SetType::Size()) {
+            cluster_linearize::DepGraph<SetType> depgraph;
+            for (size_t i = 0; i < txs.size(); ++i) {
+                depgraph.AddTransaction(feefracs[i]);
+                SetType parents;
+                for (const CTxMemPoolEntry& parent : txs[i]->GetMemPoolParentsConst()) {
+                    const auto parent_it = std::find(txs.begin(), txs.begin() + i, mempool.mapTx.iterator_to(parent));
+                    if (parent_it != txs.begin() + i) parents.Set(parent_it - txs.begin());
+                }
+                depgraph.AddDependencies(parents, i);
+            }
+            linearization = cluster_linearize::Linearize(depgraph, MAX_LINEARIZATION_ITERATIONS, rng.rand64(), linearization).first;
+        }
+
+        // Chunk the linearization: a run joins the one before it while it has the higher score
+        std::vector<Chunk> cluster_chunks;
+        for (cluster_linearize::ClusterIndex i : linearization) {
+            Chunk chunk{cluster_index, 0, feefracs[i]};
+            chunk.fee = txs[i]->GetModifiedFee();
+            chunk.size = txs[i]->GetTxSize();
+            chunk.sigops = txs[i]->GetSigOpCost();
+            chunk.txs.push_back(txs[i]);
+            while (!cluster_chunks.empty() && chunk.score >> cluster_chunks.back().score) {
+                Chunk& prev = cluster_chunks.back();
+                prev.score += chunk.score;
+                prev.fee += chunk.fee;
+                prev.size += chunk.size;
+                prev.sigops += chunk.sigops;
+                prev.txs.insert(prev.txs.end(), chunk.txs.begin(), chunk.txs.end());
+                chunk = std::move(prev);
+                cluster_chunks.pop_back();
+            }
+            cluster_chunks.push_back(std::move(chunk));
+        }
+        for (size_t i = 0; i < cluster_chunks.size(); ++i) {
+            cluster_chunks[i].index = i;
+            chunks.push_back(std::move(cluster_chunks[i]));
+        }
+        ++cluster_index;
+    }
+
+    // Chunks of a cluster have non-increasing scores, ties keep their order
+    std::sort(chunks.begin(), chunks.end(), [](const Chunk& a, const Chunk& b) {
+        if (a.score >> b.score) return true;
+        if (b.score >> a.score) return false;
+        return std::tie(a.cluster, a.index) < std::tie(b.cluster, b.index);
+    });
+
+    // Limit the number of attempts to add transactions to the block when it is
+    // close to full, as in addPackageTxs()
+    const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
+    int64_t nConsecutiveFailed = 0;
+
+    for (const Chunk& chunk : chunks) {
+        if (nTimeLimit != 0 && TicksSinceEpoch<std::chrono::seconds>(NodeClock::now()) >= nTimeLimit) {
+            //no more time to add transactions, just exit
+            return;
+        }
+
+        // Scores count gas, so a later chunk may still pay the minimum fee rate
+        if (chunk.fee < m_options.blockMinFeeRate.GetFee(chunk.size)) continue;
+
+        // An earlier chunk of the cluster that was not added takes its descendants with it
+        CTxMemPool::setEntries package(chunk.txs.begin(), chunk.txs.end());
+        const bool parents_included = std::all_of(chunk.txs.begin(), chunk.txs.end(), [&](CTxMemPool::txiter it) {
+            return std::all_of(it->GetMemPoolParentsConst().begin(), it->GetMemPoolParentsConst().end(), [&](const CTxMemPoolEntry& parent) {
+                return inBlock.count(parent.GetSharedTx()->GetHash()) || package.count(mempool.mapTx.iterator_to(parent));
+            });
+        });
+        if (!parents_included) continue;
+
+        if (!TestPackage(chunk.size, chunk.sigops)) {
+            ++nConsecutiveFailed;
+            if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockWeight >
+                    m_options.nBlockMaxWeight - m_options.block_reserved_weight) {
+                // Give up if we're close to full and haven't succeeded in a while
+                break;
+            }
+            continue;
+        }
+
+        if (!TestPackageTransactions(package)) continue;
+
+        // This chunk will make it in; reset the failed counter.
+        nConsecutiveFailed = 0;
+
+        // The linearization is topological, so the chunk is in a valid order
+        bool wasAdded = true;
+        for (CTxMemPool::txiter it : chunk.txs) {
+            if (nTimeLimit != 0 && TicksSinceEpoch<std::chrono::seconds>(NodeClock::now()) >= nTimeLimit) {
+                wasAdded = false;
+                break;
+            }
+            const CTransaction& tx = it->GetTx();
+            if (tx.HasCreateOrCall()) {
+                if (!AttemptToAddContractToBlock(it, minGasPrice, pblock)) {
+                    // Running out of time says nothing about the tx, a continuation may add it
+                    if (!OutOfBytecodeTime())
+                        m_failed_contracts.insert(tx.GetHash());
+                    wasAdded = false;
+                    break;
+                }
+            } else {
+                AddToBlock(it);
+            }
+        }
+
+        if (!wasAdded) continue;
+
+        ++nPackagesSelected;
+        pblocktemplate->m_package_feerates.emplace_back(chunk.fee, static_cast<int32_t>(chunk.size));
+    }
+}
+
 bool CanStake()
 {
     bool canStake = gArgs.GetBoolArg("-staking", DEFAULT_STAKE);
@@ -1018,8 +1411,18 @@ public:
             cacheHeight = 0;
             cacheDelegationsStaker.clear();
             pwallet->fUpdatedSuperStaker = false;
+            fHasVersion = false;
         }
 
+        // The delegations to the staker only change with the storage of the delegation contract,
+        // or with the stakers of the wallet, skip the event search when neither changed
+        DelegationsVersion version;
+        version.fContract = qtumDelegations.GetStorageVersion(version.storageRoot);
+        version.nScriptPubKeyMans = pwallet->GetAllScriptPubKeyMans().size();
+        version.nSuperStakers = pwallet->mapSuperStaker.size();
+        if(fHasVersion && version == cacheVersion)
+            return;
+
         std::map<uint160, Delegation> delegations_staker;
         int checkpointSpan = Params().GetConsensus().CheckpointSpan(nHeight);
         if(nHeight <= checkpointSpan)
@@ -1047,14 +1450,45 @@ public:
             delegations_staker = cacheDelegationsStaker;
             qtumDelegations.UpdateDelegationsFromEvents(events, delegations_staker);
         }
+
+        // Verify the proof of delegation of new or changed delegations once, the others were verified before
+        for(auto it = delegations_staker.begin(); it != delegations_staker.end();)
+        {
+            auto known = pwallet->m_delegations_staker.find(it->first);
+            if((known == pwallet->m_delegations_staker.end() || known->second != it->second) &&
+                    !QtumDelegation::VerifyDelegation(it->first, it->second))
+            {
+                LogDebug(BCLog::COINSTAKE, "Skip delegation from %s with invalid proof of delegation\n", it->first.GetReverseHex());
+                it = delegations_staker.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
         pwallet->updateDelegationsStaker(delegations_staker);
+        cacheVersion = version;
+        fHasVersion = true;
     }
 
 private:
+    struct DelegationsVersion
+    {
+        bool fContract = false;
+        uint256 storageRoot;
+        size_t nScriptPubKeyMans = 0;
+        size_t nSuperStakers = 0;
+
+        bool operator==(const DelegationsVersion& other) const = default;
+    };
+
     wallet::CWallet *pwallet;
     QtumDelegation qtumDelegations;
     int32_t cacheHeight;
     std::map<uint160, Delegation> cacheDelegationsStaker;
+    DelegationsVersion cacheVersion;
+    bool fHasVersion = false;
     std::vector<uint160> allowList;
     std::vector<uint160> excludeList;
     int type;
@@ -1237,26 +1671,7 @@ bool CheckStake(const std::shared_ptr<const CBlock> pblock, wallet::CWallet& wal
 
 bool SleepStaker(wallet::CWallet *pwallet, uint64_t milliseconds)
 {
-    uint64_t seconds = milliseconds / 1000;
-    milliseconds %= 1000;
-
-    for(unsigned int i = 0; i < seconds; i++)
-    {
-        if(!pwallet->IsStakeClosing())
-            UninterruptibleSleep(std::chrono::seconds{1});
-        else
-            return false;
-    }
-
-    if(milliseconds)
-    {
-        if(!pwallet->IsStakeClosing())
-            UninterruptibleSleep(std::chrono::milliseconds{milliseconds});
-        else
-            return false;
-    }
-
-    return !pwallet->IsStakeClosing();
+    return pwallet->WaitStaker(std::chrono::milliseconds{milliseconds}, false);
 }
 
 bool SignBlockHWI(std::shared_ptr<CBlock> pblock, wallet::CWallet& wallet, std::vector<unsigned char>& vchSig)
@@ -1343,6 +1758,16 @@ bool SignBlockLedger(std::shared_ptr<CBlock> pblock, wallet::CWallet& wallet)
     return ret;
 }
 
+//! Account a block signature, by the wallet's keys or a hardware device, in the staker stats
+static void RecordBlockSignature(wallet::CWallet& wallet, bool hardware, std::chrono::steady_clock::time_point start)
+{
+    const uint64_t micros = wallet::StakerStats::Micros(std::chrono::steady_clock::now() - start);
+    wallet::StakerStats& stats = wallet.m_staker_stats;
+    wallet::StakerStats::Add(hardware ? stats.hardware_signatures : stats.signatures, 1);
+    wallet::StakerStats::Add(hardware ? stats.hardware_signature_micros : stats.signature_micros, micros);
+    TRACEPOINT(staker, block_signed, hardware, micros);
+}
+
 // novacoin: attempt to generate suitable proof-of-stake
 bool SignBlock(std::shared_ptr<CBlock> pblock, wallet::CWallet& wallet, const CAmount& nTotalFees, uint32_t nTime, std::set<std::pair<const wallet::CWalletTx*,unsigned int> >& setCoins, std::vector<COutPoint>& setSelectedCoins, std::vector<COutPoint>& setDelegateCoins, bool selectedOnly = false, bool tryOnly = false)
 {
@@ -1403,13 +1828,18 @@ bool SignBlock(std::shared_ptr<CBlock> pblock, wallet::CWallet& wallet, const CA
                     pblock->SetProofOfDelegation(vchPoD);
 
                 // append a signature to our block, ensure that is compact and check block header
+                const auto signStart{std::chrono::steady_clock::now()};
                 bool isSigned = privateKeysDisabled ? SignBlockLedger(pblock, wallet) : wallet.SignBlockStake(*pblock, pkhash, true);
+                RecordBlockSignature(wallet, privateKeysDisabled, signStart);
                 return isSigned && CheckHeaderProof(*pblock, consensusParams, wallet.chain().chainman().ActiveChainstate());
             }
             else
             {
                 // append a signature to our block and ensure that is LowS
-                return wallet.SignBlockStake(*pblock, pkhash, false) &&
+                const auto signStart{std::chrono::steady_clock::now()};
+                bool isSigned = wallet.SignBlockStake(*pblock, pkhash, false);
+                RecordBlockSignature(wallet, false, signStart);
+                return isSigned &&
                            EnsureLowS(pblock->vchBlockSigDlgt) &&
                            CheckHeaderProof(*pblock, consensusParams, wallet.chain().chainman().ActiveChainstate());
             }
@@ -1442,20 +1872,6 @@ public:
     virtual ~IStakeMiner() {};
 };
 
-class SolveItem
-{
-public:
-    SolveItem(const COutPoint& _prevoutStake, const uint32_t& _blockTime, const bool& _delegate):
-        prevoutStake(_prevoutStake),
-        blockTime(_blockTime),
-        delegate(_delegate)
-    {}
-
-    COutPoint prevoutStake;
-    uint32_t blockTime = 0;
-    bool delegate = false;
-};
-
 class StakeMinerPriv
 {
 public:
@@ -1472,7 +1888,6 @@ public:
     bool fError = false;
     int numThreads = 1;
     boost::thread_group threads;
-    mutable RecursiveMutex cs_worker;
     bool privateKeysDisabled = false;;
 
 public:
@@ -1493,18 +1908,29 @@ public:
     std::vector<COutPoint> setDelegateCoins;
     std::vector<COutPoint> prevouts;
     std::map<uint32_t, bool> mapSolveBlockTime;
-    std::multimap<uint256, SolveItem> mapSolvedBlock;
+    StakeKernelSearch kernelSearch;
     std::map<uint32_t, std::vector<COutPoint>> mapSolveSelectedCoins;
     std::map<uint32_t, std::vector<COutPoint>> mapSolveDelegateCoins;
     uint32_t beginningTime = 0;
     uint32_t endingTime = 0;
     uint32_t waitBestHeaderAttempts = 0;
+    std::chrono::steady_clock::time_point tipTime;
+    bool candidateOnTip = false;
 
     std::shared_ptr<CBlock> pblock;
     std::unique_ptr<CBlockTemplate> pblocktemplate;
     std::shared_ptr<CBlock> pblockfilled;
     std::unique_ptr<CBlockTemplate> pblocktemplatefilled;
 
+    // Last block filled with transactions, reused while the tip and the mempool stay the same
+    std::unique_ptr<CBlockTemplate> pblocktemplatecached;
+    uint256 cachedTip;
+    unsigned int cachedTransactionsUpdated = 0;
+    CScript cachedScript;
+    uint32_t cachedTime = 0;
+    bool cachedHasBytecode = false;
+    int64_t cachedTotalFees = 0;
+
 public:
     StakeMinerPriv(wallet::CWallet *_pwallet):
         pwallet(_pwallet),
@@ -1535,6 +1961,7 @@ public:
         }
         if(pwallet) numThreads = pwallet->m_num_threads;
         if(pwallet) privateKeysDisabled = pwallet->IsWalletFlagSet(wallet::WALLET_FLAG_DISABLE_PRIVATE_KEYS);
+        if(pwallet && pwallet->m_staker_stats.reset_time == 0) pwallet->m_staker_stats.reset_time = GetTime();
     }
 
     void clearCache()
@@ -1552,7 +1979,7 @@ public:
         setDelegateCoins.clear();
         prevouts.clear();
         mapSolveBlockTime.clear();
-        mapSolvedBlock.clear();
+        kernelSearch.Clear();
         mapSolveSelectedCoins.clear();
         mapSolveDelegateCoins.clear();
         beginningTime = 0;
@@ -1614,7 +2041,11 @@ public:
                     if(CanCreateBlock(blockTime))
                     {
                         // Create new block
-                        if(!CreateNewBlock(blockTime)) break;
+                        if(!CreateNewBlock(blockTime))
+                        {
+                            MissedSlot(blockTime);
+                            break;
+                        }
 
                         // Sign new block
                         if(SignNewBlock(blockTime)) break;
@@ -1622,8 +2053,8 @@ public:
                 }
             }
 
-            // Miner sleep before the next try
-            Sleep(nMinerSleep);
+            // Throttle the miner with minimum difficulty, otherwise IsReady() waits for the next slot
+            if(d->minDifficulty) Sleep(nMinerSleep);
         }
     }
 
@@ -1647,6 +2078,20 @@ protected:
         return SleepStaker(d->pwallet, milliseconds);
     }
 
+    // Sleep that a new tip or a staking change ends early
+    bool WaitForWakeup(uint64_t milliseconds)
+    {
+        return d->pwallet->WaitStaker(std::chrono::milliseconds{milliseconds}, true);
+    }
+
+    uint64_t TimeToNextSlot()
+    {
+        // First stake timestamp past the searched window
+        int64_t nextSlot = ((int64_t)(d->endingTime | d->stakeTimestampMask) + 1) * 1000;
+        int64_t now = TicksSinceEpoch<std::chrono::milliseconds>(NodeClock::now());
+        return nextSlot > now ? nextSlot - now : 0;
+    }
+
     bool IsStale(std::shared_ptr<CBlock> pblock)
     {
         if(d->pwallet->IsStakeClosing())
@@ -1664,7 +2109,7 @@ protected:
                d->pwallet->chain().chainman().m_blockman.LoadingBlocks())
         {
             d->pwallet->m_last_coin_stake_search_interval = 0;
-            if(!Sleep(10000))
+            if(!WaitForWakeup(10000))
                 return false;
         }
 
@@ -1692,7 +2137,7 @@ protected:
         blokTime &= ~d->stakeTimestampMask;
         if(!IsCachedDataOld() && d->endingTime >= blokTime)
         {
-            Sleep(100);
+            WaitForWakeup(TimeToNextSlot());
             return false;
         }
 
@@ -1753,7 +2198,7 @@ protected:
         {
             if(WaitBestHeader())
             {
-                if(!Sleep(nMinerWaitBestBlockHeader))
+                if(!WaitForWakeup(nMinerWaitBestBlockHeader))
                     return false;
             }
             else
@@ -1769,6 +2214,7 @@ protected:
         if(d->pwallet->IsStakeClosing()) return false;
         LOCK(d->pwallet->cs_wallet);
 
+        CBlockIndex* pindexOld = d->pindexPrev;
         d->clearCache();
         const auto bal = wallet::GetBalance(*d->pwallet);
         CAmount nBalance = bal.m_mine_trusted;
@@ -1781,6 +2227,12 @@ protected:
             d->pindexPrev = d->pwallet->chain().getTip();
             nHeightTip = d->pwallet->chain().getHeight().value_or(0);
         }
+        if(d->pindexPrev != pindexOld)
+        {
+            d->tipTime = std::chrono::steady_clock::now();
+            d->candidateOnTip = false;
+            wallet::StakerStats::Add(d->pwallet->m_staker_stats.tips, 1);
+        }
         d->nHeight = nHeightTip + 1;
         updateMinerParams(d->nHeight, d->consensusParams, d->minDifficulty);
         bool fOfflineStakeEnabled = (d->nHeight > d->nOfflineStakeHeight) && d->fDelegationsContract;
@@ -1821,6 +2273,9 @@ protected:
 
             LOCK(cs_main);
             UpdateMinerStakeCache(*d->pwallet, true, d->prevouts, d->pindexPrev);
+            d->kernelSearch.Prepare(d->pindexPrev, d->pblock->nBits, d->prevouts, d->pwallet->minerStakeCache);
+            wallet::StakerStats::Add(d->pwallet->m_staker_stats.cache_hits, d->kernelSearch.size());
+            wallet::StakerStats::Add(d->pwallet->m_staker_stats.cache_misses, d->prevouts.size() - d->kernelSearch.size());
         }
 
         d->beginningTime = TicksSinceEpoch<std::chrono::seconds>(NodeClock::now());
@@ -1855,63 +2310,56 @@ protected:
         if(searchInterval > 0) d->pwallet->m_last_coin_stake_search_interval = searchInterval;
     }
 
-    void SloveBlock(uint32_t blockTime, size_t delegateSize, size_t from, size_t to)
-    {
-        std::multimap<uint256, SolveItem> tmpSolvedBlock;
-        for(size_t i = from; i < to; i++)
-        {
-            const COutPoint &prevoutStake = d->prevouts[i];
-            uint256 hashProofOfStake;
-            if (CheckKernelCache(d->pindexPrev, d->pblock->nBits, blockTime, prevoutStake, d->pwallet->minerStakeCache, hashProofOfStake))
-            {
-                bool delegate = i < delegateSize;
-                tmpSolvedBlock.insert(std::make_pair(hashProofOfStake, SolveItem(prevoutStake, blockTime, delegate)));
-            }
-        }
-
-        if(tmpSolvedBlock.size() > 0)
-        {
-            LOCK(d->cs_worker);
-            d->mapSolveBlockTime[blockTime] = true;
-            d->mapSolvedBlock.insert(tmpSolvedBlock.begin(), tmpSolvedBlock.end());
-        }
-    }
-
-    void SloveBlock(const uint32_t& blockTime)
+    void SloveBlock(const std::vector<uint32_t>& blockTimes)
     {
         // Init variables
-        size_t listSize = d->prevouts.size();
+        size_t listSize = d->kernelSearch.size();
         size_t delegateSize = d->setDelegateCoins.size();
+        std::vector<StakeKernelSearch::Hit> hits;
+        const auto searchStart{std::chrono::steady_clock::now()};
 
-        // Solve block
+        // Solve blocks for all the timestamps at once
         int numThreads = std::min(d->numThreads, (int)listSize);
         if(listSize < 1000 || numThreads < 2)
         {
-            SloveBlock(blockTime, delegateSize, 0, listSize);
+            d->kernelSearch.Search(blockTimes, 0, listSize, hits);
         }
         else
         {
+            std::vector<std::vector<StakeKernelSearch::Hit>> threadHits(numThreads);
             size_t chunk = listSize / numThreads;
             for(int i = 0; i < numThreads; i++)
             {
                 size_t from = i * chunk;
                 size_t to = i == (numThreads -1) ? listSize : from + chunk;
-                d->threads.create_thread([this, blockTime, delegateSize, from, to]{SloveBlock(blockTime, delegateSize, from, to);});
+                d->threads.create_thread([this, &blockTimes, &threadHits, i, from, to]{d->kernelSearch.Search(blockTimes, from, to, threadHits[i]);});
             }
             d->threads.join_all();
+            for(const auto& part : threadHits)
+            {
+                hits.insert(hits.end(), part.begin(), part.end());
+            }
         }
 
-        // Populate the list with the potential solwed blocks
-        for (auto it = d->mapSolvedBlock.begin(); it != d->mapSolvedBlock.end(); ++it)
+        const uint64_t kernels = listSize * blockTimes.size();
+        const uint64_t micros = wallet::StakerStats::Micros(std::chrono::steady_clock::now() - searchStart);
+        wallet::StakerStats::Add(d->pwallet->m_staker_stats.kernels, kernels);
+        wallet::StakerStats::Add(d->pwallet->m_staker_stats.kernel_micros, micros);
+        TRACEPOINT(staker, kernel_search, d->nHeight, (uint64_t)listSize, (uint32_t)blockTimes.size(), micros, (uint64_t)hits.size());
+
+        // Populate the list with the potential solved blocks, earliest time first
+        StakeKernelSearch::SortHits(hits);
+        for(const StakeKernelSearch::Hit& hit : hits)
         {
-            const SolveItem& item = (*it).second;
-            if(item.delegate)
+            const COutPoint& prevoutStake = d->prevouts[hit.prevoutIndex];
+            d->mapSolveBlockTime[hit.nTime] = true;
+            if(hit.prevoutIndex < delegateSize)
             {
-                d->mapSolveDelegateCoins[item.blockTime].push_back(item.prevoutStake);
+                d->mapSolveDelegateCoins[hit.nTime].push_back(prevoutStake);
             }
             else
             {
-                d->mapSolveSelectedCoins[item.blockTime].push_back(item.prevoutStake);
+                d->mapSolveSelectedCoins[hit.nTime].push_back(prevoutStake);
             }
         }
     }
@@ -1921,8 +2369,15 @@ protected:
         d->pblock->nTime = blockTime;
         if(d->mapSolveBlockTime.find(blockTime) == d->mapSolveBlockTime.end())
         {
-            d->mapSolveBlockTime[blockTime] = false;
-            SloveBlock(blockTime);
+            // Solve the rest of the lookahead window in one pass
+            std::vector<uint32_t> blockTimes;
+            for(uint32_t time = blockTime; time < d->endingTime; time += d->stakeTimestampMask+1)
+            {
+                if(d->mapSolveBlockTime.emplace(time, false).second)
+                    blockTimes.push_back(time);
+            }
+            d->mapSolveBlockTime.emplace(blockTime, false);
+            SloveBlock(blockTimes);
         }
 
         return d->mapSolveBlockTime[blockTime];
@@ -1944,14 +2399,20 @@ protected:
             return false;
 
         // Create a block that's properly populated with transactions
-        BlockAssembler::Options options = ConfiguredOptions();
-        options.coinbase_output_script = d->pblock->vtx[1]->vout[1].scriptPubKey;
-        d->pblocktemplatefilled = std::unique_ptr<CBlockTemplate>(
-                BlockAssembler(d->pwallet->chain().chainman().ActiveChainstate(), &(d->pwallet->chain().mempool()), d->pwallet, options).CreateNewBlock(true, &(d->nTotalFees),
-                                                        blockTime, FutureDrift(TicksSinceEpoch<std::chrono::seconds>(NodeClock::now()), d->nHeight, d->consensusParams) - nStakeTimeBuffer));
-        if (!d->pblocktemplatefilled.get()) {
-            d->fError = true;
-            return false;
+        if(!ReuseBlockTemplate(blockTime))
+        {
+            BlockAssembler::Options options = ConfiguredOptions();
+            options.coinbase_output_script = d->pblock->vtx[1]->vout[1].scriptPubKey;
+            options.incremental = true;
+            unsigned int transactionsUpdated = d->pwallet->chain().mempool().GetTransactionsUpdated();
+            d->pblocktemplatefilled = std::unique_ptr<CBlockTemplate>(
+                    BlockAssembler(d->pwallet->chain().chainman().ActiveChainstate(), &(d->pwallet->chain().mempool()), d->pwallet, options).CreateNewBlock(true, &(d->nTotalFees),
+                                                            blockTime, FutureDrift(TicksSinceEpoch<std::chrono::seconds>(NodeClock::now()), d->nHeight, d->consensusParams) - nStakeTimeBuffer));
+            if (!d->pblocktemplatefilled.get()) {
+                d->fError = true;
+                return false;
+            }
+            CacheBlockTemplate(blockTime, options.coinbase_output_script, transactionsUpdated);
         }
 
         if (IsStale(d->pblock)) {
@@ -1963,9 +2424,63 @@ protected:
         // Sign the full block and use the timestamp from earlier for a valid stake
         d->pblockfilled = std::make_shared<CBlock>(d->pblocktemplatefilled->block);
 
+        wallet::StakerStats& stats = d->pwallet->m_staker_stats;
+        wallet::StakerStats::Add(stats.candidates, 1);
+        const uint64_t micros = wallet::StakerStats::Micros(std::chrono::steady_clock::now() - d->tipTime);
+        if(!d->candidateOnTip)
+        {
+            d->candidateOnTip = true;
+            wallet::StakerStats::Add(stats.tip_to_candidate_micros, micros);
+            stats.last_tip_to_candidate_micros = micros;
+        }
+        TRACEPOINT(staker, candidate_block, d->nHeight, blockTime, micros);
+
+        return true;
+    }
+
+    void CacheBlockTemplate(const uint32_t& blockTime, const CScript& script, unsigned int transactionsUpdated)
+    {
+        d->pblocktemplatecached = std::make_unique<CBlockTemplate>(*d->pblocktemplatefilled);
+        d->cachedTip = d->pblocktemplatefilled->block.hashPrevBlock;
+        d->cachedTransactionsUpdated = transactionsUpdated;
+        d->cachedScript = script;
+        d->cachedTime = blockTime;
+        d->cachedTotalFees = d->nTotalFees;
+        d->cachedHasBytecode = std::any_of(d->pblocktemplatefilled->block.vtx.begin(), d->pblocktemplatefilled->block.vtx.end(),
+                                           [](const CTransactionRef& tx) { return tx->HasCreateOrCall(); });
+    }
+
+    bool ReuseBlockTemplate(const uint32_t& blockTime)
+    {
+        if(!d->pblocktemplatecached ||
+                d->cachedTip != d->pindexPrev->GetBlockHash() ||
+                d->cachedTransactionsUpdated != d->pwallet->chain().mempool().GetTransactionsUpdated() ||
+                d->cachedScript != d->pblock->vtx[1]->vout[1].scriptPubKey)
+            return false;
+
+        // Contracts can read the block time, so their state roots and refunds are only valid for it
+        if(d->cachedHasBytecode && d->cachedTime != blockTime)
+            return false;
+
+        d->pblocktemplatefilled = std::make_unique<CBlockTemplate>(*d->pblocktemplatecached);
+        CBlock& block = d->pblocktemplatefilled->block;
+        block.nTime = blockTime;
+        if(d->minDifficulty)
+        {
+            // The min difficulty rule depends on the block time
+            LOCK(cs_main);
+            block.nBits = GetNextWorkRequired(d->pindexPrev, &block, d->consensusParams, true);
+        }
+        d->nTotalFees = d->cachedTotalFees;
         return true;
     }
 
+    void MissedSlot(const uint32_t& blockTime)
+    {
+        wallet::StakerStats::Add(d->pwallet->m_staker_stats.missed_slots, 1);
+        TRACEPOINT(staker, slot_missed, d->nHeight, blockTime);
+    }
+
     bool SignNewBlock(const uint32_t& blockTime)
     {
         // Try to sign the block once at specific time with the same cached data
@@ -2004,14 +2519,22 @@ protected:
                 validBlock=true;
             }
             if(validBlock) {
-                if(!CheckStake(d->pblockfilled, *(d->pwallet)))
+                if(CheckStake(d->pblockfilled, *(d->pwallet))) {
+                    wallet::StakerStats::Add(d->pwallet->m_staker_stats.blocks, 1);
+                } else {
                     d->forceUpdate = true;
+                    MissedSlot(blockTime);
+                }
                 // Update the search time when new valid block is created, needed for status bar icon
                 d->pwallet->m_last_coin_stake_search_time = d->pblockfilled->GetBlockTime();
+            } else {
+                MissedSlot(blockTime);
             }
             return true;
         }
 
+        MissedSlot(blockTime);
+
         //return back to low priority
         SetThreadPriority(THREAD_PRIORITY_LOWEST);
         return false;
@@ -15,6 +15,7 @@
 
 #include <memory>
 #include <optional>
+#include <set>
 #include <stdint.h>
 
 #include <boost/multi_index/identity.hpp>
@@ -37,6 +38,8 @@ namespace Consensus { struct Params; };
 
 namespace node {
 static const bool DEFAULT_PRINT_MODIFIED_FEE = false;
+/** Default for -blockclusterselection, selecting block transactions by cluster linearization */
+static const bool DEFAULT_BLOCK_CLUSTER_SELECTION = true;
 
 static const bool DEFAULT_STAKE = true;
 
@@ -242,6 +245,8 @@ struct update_for_parent_inclusion
 };
 
 /** Generate a new block, without valid proof-of-work */
+struct AssemblyCheckpoint;
+
 class BlockAssembler
 {
 private:
@@ -255,6 +260,11 @@ private:
     CAmount nFees;
     std::unordered_set<Txid, SaltedTxidHasher> inBlock;
 
+    // Selection of an earlier template to continue from, see BlockCreateOptions::incremental
+    std::shared_ptr<const AssemblyCheckpoint> m_checkpoint;
+    // Contract txs whose execution was rejected, not tried again when continuing
+    std::set<Txid> m_failed_contracts;
+
     // Chain context for the block
     int nHeight;
     int64_t m_lock_time_cutoff;
@@ -274,6 +284,8 @@ public:
         // Whether to call TestBlockValidity() at the end of CreateNewBlock().
         bool test_block_validity{true};
         bool print_modified_fee{DEFAULT_PRINT_MODIFIED_FEE};
+        // Whether to select transactions by cluster linearization rather than ancestor feerate
+        bool cluster_selection{DEFAULT_BLOCK_CLUSTER_SELECTION};
     };
 
     explicit BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool, const Options& options);
@@ -314,6 +326,8 @@ private:
     void AddToBlock(CTxMemPool::txiter iter);
 
     bool AttemptToAddContractToBlock(CTxMemPool::txiter iter, uint64_t minGasPrice, CBlock* pblock);
+    /** Whether nTimeLimit leaves no time to execute another contract tx */
+    bool OutOfBytecodeTime() const;
 
     // Methods for how to add transactions to a block.
     /** Add transactions based on feerate including unconfirmed ancestors
@@ -323,6 +337,16 @@ private:
       * @pre BlockAssembler::m_mempool must not be nullptr
     */
     void addPackageTxs(int& nPackagesSelected, int& nDescendantsUpdated, uint64_t minGasPrice, CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(!m_mempool->cs);
+    /** Add transactions by the chunks of their linearized clusters, best chunk feerate first.
+      * Chunk feerates count contract gas as block space, see addClusterTxs().
+      * Increments nPackagesSelected with the number of chunks added.
+      *
+      * @pre BlockAssembler::m_mempool must not be nullptr
+    */
+    void addClusterTxs(int& nPackagesSelected, uint64_t minGasPrice, CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(!m_mempool->cs);
+
+    /** Restore the selection of m_checkpoint, false if any of it left the mempool or state */
+    bool RestoreCheckpoint(CBlock* pblock, CTxMemPool::setEntries& restored) EXCLUSIVE_LOCKS_REQUIRED(m_mempool->cs);
 
     /** Rebuild the coinbase/coinstake transaction to account for new gas refunds **/
     void RebuildRefundTransaction(CBlock* pblock);
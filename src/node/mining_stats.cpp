@@ -0,0 +1,84 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/mining_stats.h>
+
+#include <node/randomx_miner.h>
+#include <node/x25x_miner.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace node {
+
+static int64_t NowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now().time_since_epoch()).count();
+}
+
+static double HashrateSince(int64_t start_time, uint64_t hashes)
+{
+    const int64_t elapsed{NowMicros() - start_time};
+    return elapsed > 0 ? hashes * 1e6 / elapsed : 0.0;
+}
+
+void MinerTelemetry::Start(unsigned threads)
+{
+    for (Slot& slot : m_slots) {
+        slot.hashes.store(0, std::memory_order_relaxed);
+    }
+    m_blocks_found.store(0, std::memory_order_relaxed);
+    m_threads.store(threads, std::memory_order_relaxed);
+    m_start_time.store(NowMicros(), std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+}
+
+void MinerTelemetry::Stop()
+{
+    if (!m_running.exchange(false)) return;
+    m_last_hashrate.store(HashrateSince(m_start_time.load(std::memory_order_relaxed), GetTotalHashes()), std::memory_order_relaxed);
+}
+
+uint64_t MinerTelemetry::GetTotalHashes() const
+{
+    uint64_t total{0};
+    for (const Slot& slot : m_slots) {
+        total += slot.hashes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MiningStats MinerTelemetry::GetStats() const
+{
+    MiningStats stats;
+    stats.mining = m_running.load(std::memory_order_acquire);
+    stats.total_hashes = GetTotalHashes();
+    stats.blocks_found = m_blocks_found.load(std::memory_order_relaxed);
+    if (stats.mining) {
+        const int64_t start_time{m_start_time.load(std::memory_order_relaxed)};
+        stats.threads = m_threads.load(std::memory_order_relaxed);
+        stats.hashrate = HashrateSince(start_time, stats.total_hashes);
+        stats.uptime = (NowMicros() - start_time) / 1'000'000;
+    } else {
+        stats.hashrate = m_last_hashrate.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+MiningStats GetMiningStats()
+{
+    MiningStats stats;
+    for (const MiningStats& miner : {GetX25XMiner().GetStats(), GetRandomXMiner().GetStats()}) {
+        stats.mining |= miner.mining;
+        stats.threads += miner.threads;
+        stats.total_hashes += miner.total_hashes;
+        stats.hashrate += miner.hashrate;
+        stats.blocks_found += miner.blocks_found;
+        stats.uptime = std::max(stats.uptime, miner.uptime);
+    }
+    return stats;
+}
+
+} // namespace node
@@ -0,0 +1,78 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_MINING_STATS_H
+#define BITCOIN_NODE_MINING_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+
+/** Snapshot of what the local miners are doing */
+struct MiningStats {
+    bool mining{false};
+    unsigned threads{0};
+    //! Hashes since mining was last started
+    uint64_t total_hashes{0};
+    //! Hashes per second since mining was last started, or of the last run once stopped
+    double hashrate{0.0};
+    //! Blocks found since mining was last started
+    uint64_t blocks_found{0};
+    //! Seconds since mining was last started
+    int64_t uptime{0};
+};
+
+/**
+ * Hash counters of a miner, one per thread and each on its own cache line,
+ * so mining threads never write a line another thread writes or reads on
+ * every update. GetStats() adds them up and costs the miners nothing: no
+ * locks are shared with the mining threads.
+ */
+class MinerTelemetry
+{
+public:
+    //! Threads past this share counters
+    static constexpr size_t MAX_THREADS{256};
+
+    /** Reset the counters for a run of @p threads mining threads */
+    void Start(unsigned threads);
+
+    /** Keep the hashrate of the run that ended */
+    void Stop();
+
+    /** Count hashes of a mining thread */
+    void AddHashes(unsigned thread, uint64_t count)
+    {
+        m_slots[thread % MAX_THREADS].hashes.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void BlockFound() { m_blocks_found.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t GetTotalHashes() const;
+
+    MiningStats GetStats() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> hashes{0};
+    };
+
+    std::array<Slot, MAX_THREADS> m_slots{};
+    alignas(64) std::atomic<bool> m_running{false};
+    std::atomic<unsigned> m_threads{0};
+    //! Steady clock time of Start(), in microseconds
+    std::atomic<int64_t> m_start_time{0};
+    std::atomic<uint64_t> m_blocks_found{0};
+    std::atomic<double> m_last_hashrate{0.0};
+};
+
+/** Combined stats of the X25X and RandomX miners, for the GUI and RPC */
+MiningStats GetMiningStats();
+
+} // namespace node
+
+#endif // BITCOIN_NODE_MINING_STATS_H
@@ -12,6 +12,7 @@
 #include <script/solver.h>
 #include <random.h>
 #include <util/fs.h>
+#include <validationinterface.h>
 
 #include <algorithm>
 
@@ -61,13 +62,36 @@ bool COutputIndexDB::GetFirstIndexAtHeight(int height, uint64_t& globalIndex) co
     return m_db->Read(std::make_pair(DB_HEIGHT, height), globalIndex);
 }
 
-bool COutputIndexDB::WriteBlock(int height, const std::vector<COutputIndexEntry>& outputs)
+bool COutputIndexDB::ReadOutputs(std::vector<COutputIndexEntry>& outputs) const
 {
     LOCK(cs_db);
 
-    uint64_t currentCount = 0;
-    m_db->Read(DB_COUNT, currentCount);
-    uint64_t startIndex = currentCount;
+    uint64_t count = 0;
+    m_db->Read(DB_COUNT, count);
+    outputs.assign(count, COutputIndexEntry{});
+
+    // Keys do not sort by index, so place each entry where it belongs.
+    // Entries past the count are left over from a disconnected block.
+    std::vector<bool> found(count, false);
+    uint64_t numFound = 0;
+    std::unique_ptr<CDBIterator> cursor{m_db->NewIterator()};
+    cursor->Seek(std::make_pair(DB_OUTPUT, uint64_t{0}));
+    for (; cursor->Valid(); cursor->Next()) {
+        std::pair<uint8_t, uint64_t> key;
+        if (!cursor->GetKey(key) || key.first != DB_OUTPUT) break;
+        if (key.second >= count) continue;
+        if (!cursor->GetValue(outputs[key.second])) return false;
+        if (!found[key.second]) {
+            found[key.second] = true;
+            ++numFound;
+        }
+    }
+    return numFound == count;
+}
+
+bool COutputIndexDB::WriteBlock(int height, uint64_t startIndex, const std::vector<COutputIndexEntry>& outputs)
+{
+    LOCK(cs_db);
 
     CDBBatch batch(*m_db);
 
@@ -142,7 +166,35 @@ ChainstateDecoyProvider::ChainstateDecoyProvider(ChainstateManager& chainman,
 uint64_t ChainstateDecoyProvider::GetOutputCount() const
 {
     LOCK(cs_provider);
-    return m_outputIndex ? m_outputIndex->GetOutputCount() : 0;
+    return m_outputs.size();
+}
+
+bool ChainstateDecoyProvider::LoadOutputTable()
+{
+    std::vector<COutputIndexEntry> entries;
+    if (!m_outputIndex->ReadOutputs(entries)) {
+        return false;
+    }
+
+    m_outputs.clear();
+    m_heightStart.clear();
+    m_outputs.reserve(entries.size());
+    for (const COutputIndexEntry& entry : entries) {
+        // Outputs are indexed in height order
+        if (!m_outputs.empty() && entry.height < m_outputs.back().height) return false;
+        if (entry.height >= m_heightStart.size()) {
+            m_heightStart.resize(entry.height + 1, m_outputs.size());
+        }
+        m_outputs.push_back({entry.outpoint, entry.height});
+    }
+    return true;
+}
+
+uint64_t ChainstateDecoyProvider::FirstIndexAtHeight(int height) const
+{
+    if (height <= 0) return 0;
+    if ((size_t)height >= m_heightStart.size()) return m_outputs.size();
+    return m_heightStart[height];
 }
 
 int ChainstateDecoyProvider::GetHeight() const
@@ -157,12 +209,8 @@ bool ChainstateDecoyProvider::GetOutputByIndex(uint64_t globalIndex,
 {
     LOCK(cs_provider);
 
-    if (!m_outputIndex) return false;
-
-    COutputIndexEntry entry;
-    if (!m_outputIndex->GetOutput(globalIndex, entry)) {
-        return false;
-    }
+    if (globalIndex >= m_outputs.size()) return false;
+    const CompactOutput& entry = m_outputs[globalIndex];
 
     // Get the actual UTXO to verify it's unspent and get pubkey
     LOCK(cs_main);
@@ -210,29 +258,17 @@ size_t ChainstateDecoyProvider::GetRandomOutputs(size_t count, int minHeight, in
 {
     LOCK(cs_provider);
 
-    if (!m_outputIndex) return 0;
-
     candidates.clear();
     candidates.reserve(count);
 
-    uint64_t totalOutputs = m_outputIndex->GetOutputCount();
-    if (totalOutputs == 0) return 0;
-
-    // Get index range for height bounds
-    uint64_t minIndex = 0;
-    uint64_t maxIndex = totalOutputs - 1;
+    // Index range for the height bounds, from the height table
+    const uint64_t minIndex = FirstIndexAtHeight(minHeight);
+    const uint64_t endIndex = maxHeight > 0 ? FirstIndexAtHeight(maxHeight + 1) : m_outputs.size();
+    if (minIndex >= endIndex) return 0;
+    const uint64_t maxIndex = endIndex - 1;
 
-    if (minHeight > 0) {
-        m_outputIndex->GetFirstIndexAtHeight(minHeight, minIndex);
-    }
-    if (maxHeight > 0 && maxHeight < GetHeight()) {
-        uint64_t nextHeightIndex;
-        if (m_outputIndex->GetFirstIndexAtHeight(maxHeight + 1, nextHeightIndex)) {
-            maxIndex = nextHeightIndex > 0 ? nextHeightIndex - 1 : 0;
-        }
-    }
-
-    if (minIndex > maxIndex) return 0;
+    // Every lookup checks the coin, so take cs_main once for all of them
+    LOCK(cs_main);
 
     // Random selection with retries
     std::uniform_int_distribution<uint64_t> dist(minIndex, maxIndex);
@@ -293,13 +329,22 @@ bool ChainstateDecoyProvider::IndexBlock(const CBlock& block, const CBlockIndex*
         }
     }
 
+    const uint64_t startIndex = m_outputs.size();
     if (!outputs.empty()) {
-        if (!m_outputIndex->WriteBlock(pindex->nHeight, outputs)) {
+        if (!m_outputIndex->WriteBlock(pindex->nHeight, startIndex, outputs)) {
             return false;
         }
     }
+    if (!m_outputIndex->SetBestBlock(pindex->GetBlockHash())) {
+        return false;
+    }
 
-    return m_outputIndex->SetBestBlock(pindex->GetBlockHash());
+    m_heightStart.resize(pindex->nHeight, startIndex);
+    m_heightStart.push_back(startIndex);
+    for (const COutputIndexEntry& entry : outputs) {
+        m_outputs.push_back({entry.outpoint, entry.height});
+    }
+    return true;
 }
 
 bool ChainstateDecoyProvider::UnindexBlock(const CBlockIndex* pindex)
@@ -308,15 +353,47 @@ bool ChainstateDecoyProvider::UnindexBlock(const CBlockIndex* pindex)
 
     if (!m_outputIndex) return false;
 
-    uint64_t startIndex;
-    if (!m_outputIndex->GetFirstIndexAtHeight(pindex->nHeight, startIndex)) {
+    if ((size_t)pindex->nHeight >= m_heightStart.size()) {
         return true;  // Nothing to unindex
     }
 
-    uint64_t totalCount = m_outputIndex->GetOutputCount();
-    uint64_t count = totalCount - startIndex;
+    const uint64_t startIndex = m_heightStart[pindex->nHeight];
+    const uint64_t count = m_outputs.size() - startIndex;
+    if (count > 0 && !m_outputIndex->EraseBlock(pindex->nHeight, startIndex, count)) {
+        return false;
+    }
+    if (pindex->pprev && !m_outputIndex->SetBestBlock(pindex->pprev->GetBlockHash())) {
+        return false;
+    }
+
+    m_outputs.resize(startIndex);
+    m_heightStart.resize(pindex->nHeight);
+    return true;
+}
+
+void ChainstateDecoyProvider::BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    // The background chainstate of an assumeutxo snapshot is not indexed
+    if (role == ChainstateRole::BACKGROUND) return;
 
-    return m_outputIndex->EraseBlock(pindex->nHeight, startIndex, count);
+    LOCK(cs_provider);
+    if ((size_t)pindex->nHeight != m_heightStart.size()) {
+        LogDebug(BCLog::PRIVACY, "Privacy output index at height %d, not indexing block %d\n",
+                 (int)m_heightStart.size() - 1, pindex->nHeight);
+        return;
+    }
+    if (!IndexBlock(*block, pindex)) {
+        LogPrintf("Failed to index block %d for privacy\n", pindex->nHeight);
+    }
+}
+
+void ChainstateDecoyProvider::BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    LOCK(cs_provider);
+    if ((size_t)pindex->nHeight + 1 != m_heightStart.size()) return;
+    if (!UnindexBlock(pindex)) {
+        LogPrintf("Failed to unindex block %d for privacy\n", pindex->nHeight);
+    }
 }
 
 bool ChainstateDecoyProvider::IsSynced() const
@@ -346,8 +423,18 @@ bool ChainstateDecoyProvider::Initialize()
         // Check if index is on active chain
         LOCK(cs_main);
         const CBlockIndex* pindex = m_chainman.m_blockman.LookupBlockIndex(indexBest);
-        if (pindex && m_chainman.ActiveChain().Contains(pindex)) {
-            LogPrintf("Privacy output index initialized at height %d\n", pindex->nHeight);
+        if (pindex && m_chainman.ActiveChain().Contains(pindex) && LoadOutputTable()) {
+            // Catch up with blocks connected while the index was not loaded
+            const CChain& chain = m_chainman.ActiveChain();
+            m_heightStart.resize(pindex->nHeight + 1, m_outputs.size());
+            for (int height = pindex->nHeight + 1; height <= chain.Height(); height++) {
+                CBlock block;
+                if (!m_chainman.m_blockman.ReadBlock(block, *chain[height]) || !IndexBlock(block, chain[height])) {
+                    LogPrintf("Failed to index block %d for privacy\n", height);
+                    return false;
+                }
+            }
+            LogPrintf("Privacy output index initialized at height %d, %u outputs\n", chain.Height(), m_outputs.size());
             return true;
         }
     }
@@ -365,6 +452,8 @@ bool ChainstateDecoyProvider::RebuildIndex(std::function<void(int, int)> progres
     if (!m_outputIndex) return false;
 
     LogPrintf("Rebuilding privacy output index...\n");
+    m_outputs.clear();
+    m_heightStart.clear();
 
     const CChain& chain = m_chainman.ActiveChain();
     int tipHeight = chain.Height();
@@ -392,7 +481,7 @@ bool ChainstateDecoyProvider::RebuildIndex(std::function<void(int, int)> progres
 
     m_outputIndex->Sync();
 
-    LogPrintf("Privacy output index rebuilt: %lu outputs indexed\n", m_outputIndex->GetOutputCount());
+    LogPrintf("Privacy output index rebuilt: %lu outputs indexed\n", m_outputs.size());
     return true;
 }
 
@@ -400,7 +489,7 @@ bool ChainstateDecoyProvider::RebuildIndex(std::function<void(int, int)> progres
 // Global Functions
 //
 
-bool InitializeDecoyProvider(ChainstateManager& chainman, const fs::path& datadir)
+bool InitializeDecoyProvider(ChainstateManager& chainman, const fs::path& datadir, ValidationSignals* signals)
 {
     std::lock_guard<std::mutex> lock(g_decoyProviderMutex);
 
@@ -422,15 +511,17 @@ bool InitializeDecoyProvider(ChainstateManager& chainman, const fs::path& datadi
 
     // Register with privacy module
     privacy::SetDecoyProvider(g_decoyProvider);
+    if (signals) signals->RegisterSharedValidationInterface(g_decoyProvider);
 
     LogPrintf("Privacy decoy provider initialized\n");
     return true;
 }
 
-void ShutdownDecoyProvider()
+void ShutdownDecoyProvider(ValidationSignals* signals)
 {
     std::lock_guard<std::mutex> lock(g_decoyProviderMutex);
 
+    if (signals && g_decoyProvider) signals->UnregisterSharedValidationInterface(g_decoyProvider);
     privacy::ClearDecoyProvider();
     g_decoyProvider.reset();
 
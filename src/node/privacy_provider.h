@@ -9,6 +9,7 @@
 #include <coins.h>
 #include <txdb.h>
 #include <validation.h>
+#include <validationinterface.h>
 #include <sync.h>
 
 #include <memory>
@@ -17,6 +18,7 @@
 
 class ChainstateManager;
 class CBlockIndex;
+class ValidationSignals;
 
 namespace node {
 
@@ -60,8 +62,11 @@ public:
     //! Get the first global index at or after a given height
     bool GetFirstIndexAtHeight(int height, uint64_t& globalIndex) const;
 
-    //! Add outputs from a block
-    bool WriteBlock(int height, const std::vector<COutputIndexEntry>& outputs);
+    //! Read all indexed outputs, in global index order
+    bool ReadOutputs(std::vector<COutputIndexEntry>& outputs) const;
+
+    //! Add outputs from a block, starting at global index startIndex
+    bool WriteBlock(int height, uint64_t startIndex, const std::vector<COutputIndexEntry>& outputs);
 
     //! Remove outputs (for reorg)
     bool EraseBlock(int height, uint64_t startIndex, uint64_t count);
@@ -78,16 +83,37 @@ public:
  * @brief Chainstate-based implementation of IDecoyProvider
  *
  * Provides decoy outputs for ring signatures by accessing the UTXO set
- * and output index database.
+ * and output index database. The output index is also held in memory as a
+ * flat table, so picking a ring member is an array read plus the unspent
+ * check, and follows the active chain through validation signals.
  */
-class ChainstateDecoyProvider : public privacy::IDecoyProvider
+class ChainstateDecoyProvider : public privacy::IDecoyProvider, public CValidationInterface
 {
 private:
+    //! An indexed output as kept in memory
+    struct CompactOutput
+    {
+        COutPoint outpoint;
+        uint32_t height;
+    };
+
     ChainstateManager& m_chainman;
     std::shared_ptr<COutputIndexDB> m_outputIndex;
     mutable RecursiveMutex cs_provider;
     mutable std::mt19937_64 m_rng;
 
+    //! Indexed outputs by global index
+    std::vector<CompactOutput> m_outputs GUARDED_BY(cs_provider);
+    //! Global index of the first output at each indexed height, the running
+    //! output count. Heights past the end have no outputs indexed yet.
+    std::vector<uint64_t> m_heightStart GUARDED_BY(cs_provider);
+
+    //! Load the in-memory table from the output index database
+    bool LoadOutputTable() EXCLUSIVE_LOCKS_REQUIRED(cs_provider);
+
+    //! Global index of the first output at or after a height
+    uint64_t FirstIndexAtHeight(int height) const EXCLUSIVE_LOCKS_REQUIRED(cs_provider);
+
 public:
     ChainstateDecoyProvider(ChainstateManager& chainman, std::shared_ptr<COutputIndexDB> outputIndex);
 
@@ -98,7 +124,7 @@ public:
     size_t GetRandomOutputs(size_t count, int minHeight, int maxHeight,
                             std::vector<privacy::CDecoyCandidate>& candidates) const override;
 
-    //! Index management
+    //! Index management. Blocks must be indexed in height order.
     bool IndexBlock(const CBlock& block, const CBlockIndex* pindex);
     bool UnindexBlock(const CBlockIndex* pindex);
     bool IsSynced() const;
@@ -106,19 +132,25 @@ public:
     //! Initialize/rebuild index
     bool Initialize();
     bool RebuildIndex(std::function<void(int, int)> progressCallback = nullptr);
+
+protected:
+    //! CValidationInterface, keep the index on the active chain
+    void BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
 };
 
 /**
  * @brief Initialize the global decoy provider
  *
- * Called during node initialization after chainstate is loaded.
+ * Called during node initialization after chainstate is loaded. The
+ * provider registers with the validation signals to follow new blocks.
  */
-bool InitializeDecoyProvider(ChainstateManager& chainman, const fs::path& datadir);
+bool InitializeDecoyProvider(ChainstateManager& chainman, const fs::path& datadir, ValidationSignals* signals);
 
 /**
  * @brief Shutdown the decoy provider
  */
-void ShutdownDecoyProvider();
+void ShutdownDecoyProvider(ValidationSignals* signals);
 
 /**
  * @brief Get the global decoy provider (for wallet/RPC use)
@@ -25,6 +25,67 @@
 
 namespace node {
 
+struct RandomXMiner::Context {
+    std::vector<unsigned char> key;
+    randomx_cache* cache{nullptr};
+    randomx_dataset* dataset{nullptr};
+    unsigned flags{0};  // Flags VMs bound to this context must be created with
+
+    ~Context() {
+        if (dataset) randomx_release_dataset(dataset);
+        if (cache) randomx_release_cache(cache);
+    }
+};
+
+// Large pages cut TLB misses on the cache and especially the 2GB dataset;
+// use them when the system has some reserved, else allocate normally
+static randomx_cache* AllocCache(unsigned flags) {
+    if (RandomXMiner::HasLargePages()) {
+        randomx_cache* cache = randomx_alloc_cache(static_cast<randomx_flags>(flags | RANDOMX_FLAG_LARGE_PAGES));
+        if (cache) return cache;
+    }
+    return randomx_alloc_cache(static_cast<randomx_flags>(flags));
+}
+
+static randomx_dataset* AllocDataset(unsigned flags) {
+    if (RandomXMiner::HasLargePages()) {
+        randomx_dataset* dataset = randomx_alloc_dataset(static_cast<randomx_flags>(flags | RANDOMX_FLAG_LARGE_PAGES));
+        if (dataset) {
+            LogPrintf("RandomX: Dataset allocated with large pages\n");
+            return dataset;
+        }
+    }
+    return randomx_alloc_dataset(static_cast<randomx_flags>(flags));
+}
+
+// Initialize a dataset using every core, each thread taking one item range
+static void InitDatasetParallel(randomx_dataset* dataset, randomx_cache* cache) {
+    unsigned long itemCount = randomx_dataset_item_count();
+    LogPrintf("RandomX: Initializing dataset (%lu items)...\n", itemCount);
+
+    unsigned numThreads = std::thread::hardware_concurrency();
+    if (numThreads < 1) numThreads = 1;
+
+    std::vector<std::thread> initThreads;
+    unsigned long itemsPerThread = itemCount / numThreads;
+
+    for (unsigned i = 0; i < numThreads; i++) {
+        unsigned long startItem = i * itemsPerThread;
+        unsigned long count = (i == numThreads - 1) ?
+            (itemCount - startItem) : itemsPerThread;
+
+        initThreads.emplace_back([dataset, cache, startItem, count]() {
+            randomx_init_dataset(dataset, cache, startItem, count);
+        });
+    }
+
+    for (auto& t : initThreads) {
+        t.join();
+    }
+
+    LogPrintf("RandomX: Dataset initialization complete\n");
+}
+
 // Global miner instance
 static std::unique_ptr<RandomXMiner> g_randomx_miner;
 
@@ -46,6 +107,7 @@ RandomXMiner::RandomXMiner() {
 
 RandomXMiner::~RandomXMiner() {
     StopMining();
+    JoinPrepareThread();
     Cleanup();
 }
 
@@ -64,18 +126,11 @@ void RandomXMiner::CleanupInternal() {
         randomx_destroy_vm(m_validationVm);
         m_validationVm = nullptr;
     }
+    m_validationContext.reset();
 
-    // Release dataset
-    if (m_dataset) {
-        randomx_release_dataset(m_dataset);
-        m_dataset = nullptr;
-    }
-
-    // Release cache
-    if (m_cache) {
-        randomx_release_cache(m_cache);
-        m_cache = nullptr;
-    }
+    // Release cache and dataset, including any prepared for the next key
+    m_context.reset();
+    m_nextContext.reset();
 
     m_initialized = false;
 }
@@ -141,15 +196,19 @@ bool RandomXMiner::Initialize(const void* key, size_t keySize, Mode mode, bool s
         // Keep SSSE3 and HARD_AES as they are more stable
     }
 
+    auto ctx = std::make_shared<Context>();
+    ctx->key.assign(static_cast<const unsigned char*>(key),
+                    static_cast<const unsigned char*>(key) + keySize);
+
     // Allocate cache
     LogPrintf("RandomX: Allocating cache (flags=0x%x)...\n", flags);
-    m_cache = randomx_alloc_cache(static_cast<randomx_flags>(flags));
-    if (!m_cache) {
+    ctx->cache = AllocCache(flags);
+    if (!ctx->cache) {
         LogPrintf("RandomX: Failed to allocate cache, trying without JIT...\n");
         // Try again without JIT
         flags &= ~RANDOMX_FLAG_JIT;
-        m_cache = randomx_alloc_cache(static_cast<randomx_flags>(flags));
-        if (!m_cache) {
+        ctx->cache = AllocCache(flags);
+        if (!ctx->cache) {
             LogPrintf("RandomX: Failed to allocate cache\n");
             return false;
         }
@@ -157,51 +216,28 @@ bool RandomXMiner::Initialize(const void* key, size_t keySize, Mode mode, bool s
 
     // Initialize cache with key
     LogPrintf("RandomX: Initializing cache with key (%zu bytes)...\n", keySize);
-    randomx_init_cache(m_cache, key, keySize);
-
-    // Save current key
-    m_currentKey.assign(static_cast<const unsigned char*>(key),
-                        static_cast<const unsigned char*>(key) + keySize);
+    randomx_init_cache(ctx->cache, key, keySize);
 
     // For full mode, allocate and initialize dataset
     if (mode == Mode::FULL) {
         LogPrintf("RandomX: Allocating dataset (~2GB, this may take a while)...\n");
-        m_dataset = randomx_alloc_dataset(static_cast<randomx_flags>(flags));
-        if (!m_dataset) {
+        ctx->dataset = AllocDataset(flags);
+        if (!ctx->dataset) {
             LogPrintf("RandomX: Failed to allocate dataset, falling back to light mode\n");
             m_mode = Mode::LIGHT;
             // Clear FULL_MEM flag since we don't have a dataset
             flags &= ~RANDOMX_FLAG_FULL_MEM;
         } else {
             // Initialize dataset (this is slow - can take 30+ seconds)
-            unsigned long itemCount = randomx_dataset_item_count();
-            LogPrintf("RandomX: Initializing dataset (%lu items)...\n", itemCount);
-
-            // Use multiple threads for dataset initialization
-            unsigned numThreads = std::thread::hardware_concurrency();
-            if (numThreads < 1) numThreads = 1;
-
-            std::vector<std::thread> initThreads;
-            unsigned long itemsPerThread = itemCount / numThreads;
-
-            for (unsigned i = 0; i < numThreads; i++) {
-                unsigned long startItem = i * itemsPerThread;
-                unsigned long count = (i == numThreads - 1) ?
-                    (itemCount - startItem) : itemsPerThread;
-
-                initThreads.emplace_back([this, startItem, count]() {
-                    randomx_init_dataset(m_dataset, m_cache, startItem, count);
-                });
-            }
-
-            for (auto& t : initThreads) {
-                t.join();
-            }
-
-            LogPrintf("RandomX: Dataset initialization complete\n");
+            InitDatasetParallel(ctx->dataset, ctx->cache);
         }
     }
 
+    ctx->flags = flags;
+    m_currentKey = ctx->key;
+    m_context = std::move(ctx);
+    m_generation++;
+
     m_flags = flags;
     m_initialized = true;
     LogPrintf("RandomX: Initialization complete (mode=%s)\n",
@@ -209,15 +245,131 @@ bool RandomXMiner::Initialize(const void* key, size_t keySize, Mode mode, bool s
     return true;
 }
 
+std::shared_ptr<RandomXMiner::Context> RandomXMiner::BuildContext(const std::vector<unsigned char>& key,
+                                                                 unsigned flags, bool fullMode) {
+    auto ctx = std::make_shared<Context>();
+    ctx->key = key;
+    ctx->flags = flags;
+
+    ctx->cache = AllocCache(flags);
+    if (!ctx->cache) return nullptr;
+    randomx_init_cache(ctx->cache, key.data(), key.size());
+
+    if (fullMode) {
+        ctx->dataset = AllocDataset(flags);
+        if (!ctx->dataset) return nullptr;
+        InitDatasetParallel(ctx->dataset, ctx->cache);
+    }
+    return ctx;
+}
+
+void RandomXMiner::SwapContext(std::shared_ptr<Context> ctx) {
+    // Threads still hashing hold a reference to the old context, which is
+    // released once the last of them has rebound its VM
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_currentKey = ctx->key;
+    m_context = std::move(ctx);
+    m_generation++;
+}
+
+void RandomXMiner::JoinPrepareThread() {
+    std::lock_guard<std::mutex> lock(m_prepareMutex);
+    if (m_prepareThread.joinable()) {
+        m_prepareThread.join();
+    }
+}
+
 bool RandomXMiner::ReinitializeIfNeeded(const void* key, size_t keySize) {
+    const auto* keyBytes = static_cast<const unsigned char*>(key);
+    std::vector<unsigned char> newKey(keyBytes, keyBytes + keySize);
+
     // Check if key has changed
-    if (m_currentKey.size() == keySize &&
-        std::memcmp(m_currentKey.data(), key, keySize) == 0) {
-        return true;  // Key unchanged, no reinitialization needed
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_currentKey == newKey) {
+            return true;  // Key unchanged, no reinitialization needed
+        }
     }
 
-    LogPrintf("RandomX: Key changed, reinitializing...\n");
-    return Initialize(key, keySize, m_mode);
+    // Wait for a background build of this key rather than starting another
+    {
+        std::lock_guard<std::mutex> lock(m_prepareMutex);
+        if (m_nextKey == newKey) {
+            if (m_prepareThread.joinable()) m_prepareThread.join();
+            m_nextKey.clear();
+        }
+    }
+
+    std::shared_ptr<Context> ctx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_nextContext && m_nextContext->key == newKey && m_nextContext->flags == m_flags) {
+            ctx = m_nextContext;
+        }
+        m_nextContext.reset();
+    }
+
+    if (!ctx) {
+        if (!m_mining) {
+            LogPrintf("RandomX: Key changed, reinitializing...\n");
+            return Initialize(key, keySize, m_mode);
+        }
+
+        // Keep the running threads on the old context until the new one exists
+        LogPrintf("RandomX: Key changed while mining, building new context...\n");
+        ctx = BuildContext(newKey, m_flags, m_mode == Mode::FULL);
+        if (!ctx) {
+            LogPrintf("RandomX: Failed to build context for new key\n");
+            return false;
+        }
+    }
+
+    SwapContext(std::move(ctx));
+    LogPrintf("RandomX: Switched to new key\n");
+    return true;
+}
+
+void RandomXMiner::PrepareNextKey(const void* key, size_t keySize) {
+    const auto* keyBytes = static_cast<const unsigned char*>(key);
+    std::vector<unsigned char> nextKey(keyBytes, keyBytes + keySize);
+
+    std::lock_guard<std::mutex> prepareLock(m_prepareMutex);
+    if (m_nextKey == nextKey) {
+        return;  // Already built or being built
+    }
+    if (m_prepareThread.joinable()) {
+        m_prepareThread.join();
+    }
+
+    unsigned flags;
+    bool fullMode;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nextContext.reset();
+        if (!m_initialized || m_currentKey == nextKey) {
+            return;
+        }
+        flags = m_flags;
+        fullMode = m_mode == Mode::FULL;
+    }
+
+    m_nextKey = nextKey;
+    m_prepareThread = std::thread([this, nextKey = std::move(nextKey), flags, fullMode]() {
+        LogPrintf("RandomX: Preparing context for next key in the background...\n");
+        auto ctx = BuildContext(nextKey, flags, fullMode);
+        if (!ctx) {
+            LogPrintf("RandomX: Failed to prepare context for next key\n");
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nextContext = std::move(ctx);
+        LogPrintf("RandomX: Context for next key ready\n");
+    });
+}
+
+bool RandomXMiner::IsNextKeyReady() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nextContext != nullptr;
 }
 
 void RandomXMiner::CalculateHash(const void* input, size_t inputSize, void* output) {
@@ -230,18 +382,37 @@ void RandomXMiner::CalculateHash(const void* input, size_t inputSize, void* outp
     }
 
     // Use dedicated validation VM (separate from mining VMs to avoid race conditions)
-    // This VM is created on first use and protected by m_vmMutex
-    if (!m_validationVm) {
-        m_validationVm = randomx_create_vm(
-            static_cast<randomx_flags>(m_flags),
-            m_cache,
-            m_dataset
-        );
-        if (!m_validationVm) {
-            LogPrintf("RandomX: Failed to create validation VM\n");
+    // This VM is created on first use, rebound after a key switch, and protected by m_vmMutex
+    if (!m_validationVm || m_validationGeneration != m_generation.load()) {
+        std::shared_ptr<Context> ctx;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> ctxLock(m_mutex);
+            ctx = m_context;
+            generation = m_generation.load();
+        }
+        if (!ctx) {
             std::memset(output, 0, HASH_SIZE);
             return;
         }
+        if (!m_validationVm) {
+            m_validationVm = randomx_create_vm(
+                static_cast<randomx_flags>(ctx->flags),
+                ctx->cache,
+                ctx->dataset
+            );
+            if (!m_validationVm) {
+                LogPrintf("RandomX: Failed to create validation VM\n");
+                std::memset(output, 0, HASH_SIZE);
+                return;
+            }
+        } else if (ctx->dataset) {
+            randomx_vm_set_dataset(m_validationVm, ctx->dataset);
+        } else {
+            randomx_vm_set_cache(m_validationVm, ctx->cache);
+        }
+        m_validationContext = std::move(ctx);
+        m_validationGeneration = generation;
     }
 
     randomx_calculate_hash(m_validationVm, input, inputSize, output);
@@ -354,21 +525,15 @@ void RandomXMiner::StartMining(const CBlock& block, const uint256& target,
 
     m_stopMining = false;
     m_mining = true;
-    m_totalHashes = 0;
-    m_miningStartTime = GetTime();
-
-    LogPrintf("RandomX: DEBUG - session tracking\n");
 
-    // Initialize session tracking on first block (don't reset between blocks)
-    if (m_sessionStartTime == 0) {
-        m_sessionStartTime = GetTime();
-        m_sessionHashes = 0;
-        m_recentWindowStart = GetTime();
-        m_recentHashes = 0;
+    std::shared_ptr<Context> ctx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ctx = m_context;
     }
 
-    LogPrintf("RandomX: DEBUG - about to lock vmMutex, m_cache=%p, m_dataset=%p\n",
-              (void*)m_cache, (void*)m_dataset);
+    LogPrintf("RandomX: DEBUG - about to lock vmMutex, cache=%p, dataset=%p\n",
+              ctx ? (void*)ctx->cache : nullptr, ctx ? (void*)ctx->dataset : nullptr);
 
     // Create VMs for each thread
     {
@@ -376,8 +541,8 @@ void RandomXMiner::StartMining(const CBlock& block, const uint256& target,
 
         LogPrintf("RandomX: DEBUG - locked vmMutex, checking cache\n");
 
-        // Safety check: m_cache must be valid
-        if (!m_cache) {
+        // Safety check: cache must be valid
+        if (!ctx || !ctx->cache) {
             LogPrintf("RandomX: Cannot create VMs - cache is null\n");
             m_mining = false;
             return;
@@ -389,9 +554,9 @@ void RandomXMiner::StartMining(const CBlock& block, const uint256& target,
         while (m_vms.size() < static_cast<size_t>(numThreads)) {
             LogPrintf("RandomX: DEBUG - calling randomx_create_vm (flags=0x%x)\n", m_flags);
             randomx_vm* vm = randomx_create_vm(
-                static_cast<randomx_flags>(m_flags),
-                m_cache,
-                m_dataset
+                static_cast<randomx_flags>(ctx->flags),
+                ctx->cache,
+                ctx->dataset
             );
             if (!vm) {
                 LogPrintf("RandomX: Failed to create VM for thread %zu\n", m_vms.size());
@@ -409,6 +574,8 @@ void RandomXMiner::StartMining(const CBlock& block, const uint256& target,
         return;
     }
 
+    m_telemetry.Start(numThreads);
+
     // Split nonce range among threads
     uint32_t nonceRange = UINT32_MAX / numThreads;
 
@@ -441,11 +608,36 @@ void RandomXMiner::MineThread(int threadId, CBlock block, uint256 target,
         return;
     }
 
+    // Bind the VM to the current context; repeated whenever a key switch
+    // swaps in a new one, so mining carries on across the switch
+    std::shared_ptr<Context> ctx;
+    uint64_t generation{0};
+    auto bindContext = [&]() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ctx = m_context;
+        generation = m_generation.load();
+        if (!ctx) return false;
+        if (ctx->dataset) {
+            randomx_vm_set_dataset(vm, ctx->dataset);
+        } else {
+            randomx_vm_set_cache(vm, ctx->cache);
+        }
+        return true;
+    };
+    if (!bindContext()) {
+        LogPrintf("RandomX: Thread %d has no context\n", threadId);
+        return;
+    }
+
     uint32_t nonce = startNonce;
     uint64_t hashCount = 0;
     unsigned char hashOutput[HASH_SIZE];
 
     while (!m_stopMining && nonce < startNonce + nonceRange) {
+        if (m_generation.load(std::memory_order_acquire) != generation && !bindContext()) {
+            break;
+        }
+
         block.nNonce = nonce;
 
         // Serialize block header
@@ -460,10 +652,9 @@ void RandomXMiner::MineThread(int threadId, CBlock block, uint256 target,
 
         hashCount++;
 
-        // Update session counter periodically (every 100 hashes) for live hashrate display
+        // Update this thread's counter periodically for live hashrate display
         if ((hashCount & 0x3F) == 0) {  // Every 64 hashes
-            m_sessionHashes += 64;
-            m_totalHashes += 64;
+            m_telemetry.AddHashes(threadId, 64);
         }
 
         // Debug logging every 10000 hashes to see hash values
@@ -478,6 +669,7 @@ void RandomXMiner::MineThread(int threadId, CBlock block, uint256 target,
                       threadId, nonce, hash.ToString());
 
             m_stopMining = true;
+            m_telemetry.BlockFound();
 
             if (callback) {
                 callback(block);
@@ -494,12 +686,8 @@ void RandomXMiner::MineThread(int threadId, CBlock block, uint256 target,
     }
 
     // Add remaining hashes not yet counted (hashCount % 64)
-    uint64_t remainingHashes = hashCount & 0x3F;  // hashCount % 64
-    m_totalHashes += remainingHashes;
-    m_sessionHashes += remainingHashes;
-    m_recentHashes += remainingHashes;
-    LogPrintf("RandomX: Thread %d stopped after %lu hashes (session: %lu)\n",
-              threadId, hashCount, m_sessionHashes.load());
+    m_telemetry.AddHashes(threadId, hashCount & 0x3F);
+    LogPrintf("RandomX: Thread %d stopped after %lu hashes\n", threadId, hashCount);
 }
 
 void RandomXMiner::StopMining() {
@@ -508,62 +696,21 @@ void RandomXMiner::StopMining() {
     LogPrintf("RandomX: Stopping mining...\n");
     m_stopMining = true;
 
-    // Save current hashrate before stopping
-    if (m_sessionStartTime > 0) {
-        int64_t elapsed = GetTime() - m_sessionStartTime;
-        if (elapsed > 0) {
-            m_lastHashrate = static_cast<double>(m_sessionHashes.load()) / elapsed;
-        }
-    }
-
     for (auto& t : m_threads) {
         if (t.joinable()) {
             t.join();
         }
     }
     m_threads.clear();
+    m_telemetry.Stop();
 
     m_mining = false;
 
-    // Reset session when fully stopped (next start begins fresh session)
-    m_sessionStartTime = 0;
-    m_sessionHashes = 0;
-    m_recentWindowStart = 0;
-    m_recentHashes = 0;
-
     LogPrintf("RandomX: Mining stopped\n");
 }
 
 double RandomXMiner::GetHashrate() const {
-    // If not mining, return last known hashrate
-    if (!m_mining) {
-        return m_lastHashrate.load();
-    }
-
-    // Use session-based hashrate (persists across block changes)
-    if (m_sessionStartTime == 0) {
-        return m_lastHashrate.load();
-    }
-
-    int64_t elapsed = GetTime() - m_sessionStartTime;
-    if (elapsed <= 0) {
-        return m_lastHashrate.load();
-    }
-
-    // Calculate session hashrate
-    double sessionHashrate = static_cast<double>(m_sessionHashes.load()) / elapsed;
-
-    // Also calculate recent window hashrate (last 10 seconds) for smoother display
-    int64_t recentElapsed = GetTime() - m_recentWindowStart;
-    if (recentElapsed >= 10) {
-        // Reset window every 10 seconds for rolling average
-        m_recentWindowStart = GetTime();
-        m_recentHashes = 0;
-    }
-
-    // Return session hashrate (more stable)
-    m_lastHashrate = sessionHashrate;
-    return sessionHashrate;
+    return m_telemetry.GetStats().hashrate;
 }
 
 } // namespace node
@@ -6,6 +6,7 @@
 #define BITCOIN_NODE_RANDOMX_MINER_H
 
 #include <uint256.h>
+#include <node/mining_stats.h>
 #include <primitives/block.h>
 
 #include <atomic>
@@ -32,6 +33,8 @@ namespace node {
  * - Light mode (slower but less memory) or Full mode (faster, needs ~2GB RAM)
  * - JIT compilation for faster execution
  * - Background mining with low CPU priority
+ * - Key changes without stalling: the next key's cache (and dataset in full
+ *   mode) is built in the background and swapped in while threads keep mining
  */
 class RandomXMiner {
 public:
@@ -72,10 +75,24 @@ public:
 
     /**
      * Reinitialize with a new key if the key has changed
-     * This is called when the blockchain advances and we need a new mining context
+     * This is called when the blockchain advances and we need a new mining context.
+     * If the key was handed to PrepareNextKey() beforehand, the prepared context
+     * is swapped in without interrupting mining; otherwise it is built now.
      */
     bool ReinitializeIfNeeded(const void* key, size_t keySize);
 
+    /**
+     * Start building the context for an upcoming key in the background, using
+     * all cores for the dataset. Only one key is prepared at a time; the
+     * current context stays in use until ReinitializeIfNeeded() switches.
+     */
+    void PrepareNextKey(const void* key, size_t keySize);
+
+    /**
+     * Check if the context for a key given to PrepareNextKey() is ready
+     */
+    bool IsNextKeyReady() const;
+
     /**
      * Calculate a RandomX hash for input data
      * @param input Input data to hash
@@ -120,13 +137,23 @@ public:
     /**
      * Get total hashes computed since mining started
      */
-    uint64_t GetTotalHashes() const { return m_totalHashes.load(); }
+    uint64_t GetTotalHashes() const { return m_telemetry.GetTotalHashes(); }
+
+    /**
+     * Get a snapshot of the mining stats, without locking the mining threads
+     */
+    MiningStats GetStats() const { return m_telemetry.GetStats(); }
 
     /**
      * Check if RandomX is properly initialized
      */
     bool IsInitialized() const { return m_initialized.load(); }
 
+    /**
+     * Number of times the key has changed, so hashes can be cached per key
+     */
+    uint64_t GetGeneration() const { return m_generation.load(); }
+
     /**
      * Get recommended flags for the current platform
      */
@@ -175,6 +202,19 @@ private:
     /** Set low priority for mining threads */
     static void SetLowThreadPriority();
 
+    /** Cache and (in full mode) dataset built for one key */
+    struct Context;
+
+    /** Build a context with fixed flags; nullptr if any allocation fails */
+    static std::shared_ptr<Context> BuildContext(const std::vector<unsigned char>& key,
+                                                 unsigned flags, bool fullMode);
+
+    /** Make ctx current; running VMs rebind to it before their next hash */
+    void SwapContext(std::shared_ptr<Context> ctx);
+
+    /** Wait for a running PrepareNextKey() build */
+    void JoinPrepareThread();
+
     /** Cleanup RandomX resources */
     void Cleanup();
 
@@ -182,24 +222,26 @@ private:
     void CleanupInternal();
 
     // RandomX objects
-    randomx_cache* m_cache{nullptr};
-    randomx_dataset* m_dataset{nullptr};
+    std::shared_ptr<Context> m_context;  // Current key's cache/dataset (guarded by m_mutex)
     std::vector<randomx_vm*> m_vms;  // VMs for mining threads
     randomx_vm* m_validationVm{nullptr};  // Dedicated VM for block validation (separate from mining)
+    std::shared_ptr<Context> m_validationContext;  // Context m_validationVm is bound to
+    uint64_t m_validationGeneration{0};  // Generation of m_validationContext
+
+    // Incremented on every context swap; VMs compare against it before hashing
+    std::atomic<uint64_t> m_generation{0};
+
+    // Background build of the next key's context
+    std::shared_ptr<Context> m_nextContext;  // Guarded by m_mutex
+    std::vector<unsigned char> m_nextKey;    // Key being prepared (guarded by m_prepareMutex)
+    std::thread m_prepareThread;
+    mutable std::mutex m_prepareMutex;
 
     // State
     std::atomic<bool> m_initialized{false};
     std::atomic<bool> m_mining{false};
     std::atomic<bool> m_stopMining{false};
-    std::atomic<uint64_t> m_totalHashes{0};
-    std::atomic<int64_t> m_miningStartTime{0};
-
-    // Persistent hashrate tracking (survives across block changes)
-    mutable std::atomic<uint64_t> m_sessionHashes{0};      // Total hashes this session
-    mutable std::atomic<int64_t> m_sessionStartTime{0};    // Session start time
-    mutable std::atomic<double> m_lastHashrate{0.0};       // Last known hashrate
-    mutable std::atomic<uint64_t> m_recentHashes{0};       // Hashes in recent window
-    mutable std::atomic<int64_t> m_recentWindowStart{0};   // Start of recent window
+    MinerTelemetry m_telemetry;
 
     // Current key for detecting key changes
     std::vector<unsigned char> m_currentKey;
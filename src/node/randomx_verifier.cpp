@@ -0,0 +1,183 @@
+// Copyright (c) 2024 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#include <node/randomx_verifier.h>
+#include <logging.h>
+#include <util/threadnames.h>
+
+#include <randomx.h>
+
+#include <cstring>
+
+namespace node {
+
+struct RandomXVerifier::SeedContext {
+    uint256 seed;
+    randomx_cache* cache{nullptr};
+    randomx_flags flags{RANDOMX_FLAG_DEFAULT};
+
+    // Build state; the creating thread initializes the cache, others wait
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool ready{false};
+    bool failed{false};
+
+    // Idle VMs; one is created per thread hashing concurrently
+    std::vector<randomx_vm*> idle_vms;
+
+    ~SeedContext()
+    {
+        for (auto* vm : idle_vms) randomx_destroy_vm(vm);
+        if (cache) randomx_release_cache(cache);
+    }
+
+    void Build()
+    {
+        unsigned f = randomx_get_flags() & ~RANDOMX_FLAG_FULL_MEM;
+        randomx_cache* c = randomx_alloc_cache(static_cast<randomx_flags>(f));
+        if (!c) {
+            f &= ~RANDOMX_FLAG_JIT;
+            c = randomx_alloc_cache(static_cast<randomx_flags>(f));
+        }
+        if (c) randomx_init_cache(c, seed.data(), seed.size());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cache = c;
+            flags = static_cast<randomx_flags>(f);
+            ready = true;
+            failed = (c == nullptr);
+        }
+        cv.notify_all();
+
+        if (c) {
+            LogPrintf("RandomX: Verification cache ready for seed %s\n", seed.ToString());
+        } else {
+            LogPrintf("RandomX: Failed to allocate verification cache for seed %s\n", seed.ToString());
+        }
+    }
+
+    bool WaitReady()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return ready; });
+        return !failed;
+    }
+
+    randomx_vm* AcquireVm()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!idle_vms.empty()) {
+                randomx_vm* vm = idle_vms.back();
+                idle_vms.pop_back();
+                return vm;
+            }
+        }
+        return randomx_create_vm(flags, cache, nullptr);
+    }
+
+    void ReleaseVm(randomx_vm* vm)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle_vms.push_back(vm);
+    }
+};
+
+static std::unique_ptr<RandomXVerifier> g_randomx_verifier;
+
+RandomXVerifier& GetRandomXVerifier()
+{
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        g_randomx_verifier = std::make_unique<RandomXVerifier>();
+    });
+    return *g_randomx_verifier;
+}
+
+RandomXVerifier::RandomXVerifier() = default;
+
+RandomXVerifier::~RandomXVerifier()
+{
+    std::lock_guard<std::mutex> lock(m_prewarm_mutex);
+    if (m_prewarm_thread.joinable()) m_prewarm_thread.join();
+}
+
+std::shared_ptr<RandomXVerifier::SeedContext> RandomXVerifier::GetContext(const uint256& seed)
+{
+    std::shared_ptr<SeedContext> ctx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_contexts.begin(); it != m_contexts.end(); ++it) {
+            if ((*it)->seed == seed) {
+                ctx = *it;
+                // Move to the front (most recently used)
+                m_contexts.splice(m_contexts.begin(), m_contexts, it);
+                return ctx;
+            }
+        }
+
+        ctx = std::make_shared<SeedContext>();
+        ctx->seed = seed;
+        m_contexts.push_front(ctx);
+        // Evicted contexts are freed once the last in-flight hash releases them
+        while (m_contexts.size() > MAX_SEEDS) m_contexts.pop_back();
+    }
+
+    // Build outside the pool lock so other seeds stay usable meanwhile
+    LogPrintf("RandomX: Building verification cache for seed %s\n", seed.ToString());
+    ctx->Build();
+    return ctx;
+}
+
+bool RandomXVerifier::CalculateHash(const uint256& seed, const void* input, size_t inputSize, void* output)
+{
+    std::shared_ptr<SeedContext> ctx = GetContext(seed);
+    randomx_vm* vm = ctx->WaitReady() ? ctx->AcquireVm() : nullptr;
+    if (!vm) {
+        std::memset(output, 0, RANDOMX_HASH_SIZE);
+        return false;
+    }
+
+    randomx_calculate_hash(vm, input, inputSize, output);
+    ctx->ReleaseVm(vm);
+    return true;
+}
+
+void RandomXVerifier::Prewarm(const uint256& seed)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& ctx : m_contexts) {
+            if (ctx->seed == seed) return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_prewarm_mutex);
+    if (m_prewarm_thread.joinable()) m_prewarm_thread.join();
+    m_prewarm_thread = std::thread([this, seed] {
+        util::ThreadRename("rxprewarm");
+        GetContext(seed);
+    });
+}
+
+void RandomXVerifier::SetConsensusSeed(const uint256& seed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_consensus_seed = seed;
+}
+
+uint256 RandomXVerifier::GetConsensusSeed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_consensus_seed;
+}
+
+size_t RandomXVerifier::GetSeedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_contexts.size();
+}
+
+} // namespace node
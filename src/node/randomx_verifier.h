@@ -0,0 +1,86 @@
+// Copyright (c) 2024 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#ifndef BITCOIN_NODE_RANDOMX_VERIFIER_H
+#define BITCOIN_NODE_RANDOMX_VERIFIER_H
+
+#include <uint256.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct randomx_cache;
+struct randomx_vm;
+
+namespace node {
+
+/**
+ * RandomX verification contexts, separate from the RandomXMiner singleton
+ *
+ * Proof-of-work validation used to share the miner's single validation VM
+ * (and whatever key the miner happened to be initialized with), so header
+ * checks serialized behind each other and behind local mining. This pool
+ * keeps light-mode contexts keyed by RandomX seed: one 256 MB cache per seed
+ * and, on top of it, a VM per concurrently validating thread, so checks on
+ * different threads run in parallel.
+ *
+ * At most MAX_SEEDS caches are kept; the least recently used one is dropped
+ * once the last hash using it completes. Prewarm() builds an upcoming seed's
+ * cache in the background so the switch does not stall validation.
+ */
+class RandomXVerifier {
+public:
+    /** Seeds kept resident (current epoch and the next one) */
+    static constexpr size_t MAX_SEEDS = 2;
+
+    RandomXVerifier();
+    ~RandomXVerifier();
+
+    RandomXVerifier(const RandomXVerifier&) = delete;
+    RandomXVerifier& operator=(const RandomXVerifier&) = delete;
+
+    /**
+     * Calculate a RandomX hash with the given seed. Safe to call from any
+     * number of threads; only blocks while the seed's cache is being built.
+     * @return false (and a null output) if the context could not be created
+     */
+    bool CalculateHash(const uint256& seed, const void* input, size_t inputSize, void* output);
+
+    /** Start building the cache for @p seed in the background, if not resident. */
+    void Prewarm(const uint256& seed);
+
+    /** Seed used for consensus RandomX hashing (the genesis block hash). */
+    void SetConsensusSeed(const uint256& seed);
+    uint256 GetConsensusSeed() const;
+
+    /** Number of seeds with a resident (or building) cache. */
+    size_t GetSeedCount() const;
+
+private:
+    struct SeedContext;
+
+    std::shared_ptr<SeedContext> GetContext(const uint256& seed);
+
+    mutable std::mutex m_mutex;
+    //! Most recently used first
+    std::list<std::shared_ptr<SeedContext>> m_contexts;
+    uint256 m_consensus_seed;
+
+    std::mutex m_prewarm_mutex;
+    std::thread m_prewarm_thread;
+};
+
+/**
+ * Global RandomX verification pool
+ */
+RandomXVerifier& GetRandomXVerifier();
+
+} // namespace node
+
+#endif // BITCOIN_NODE_RANDOMX_VERIFIER_H
@@ -5,9 +5,16 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <node/minisketchwrapper.h>
 #include <util/check.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
 #include <unordered_map>
 #include <variant>
 
@@ -29,6 +36,15 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/** Sketch capacity for the given set sizes, see BIP-330. */
+size_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, uint16_t q)
+{
+    const size_t set_size_diff = local_set_size > remote_set_size ? local_set_size - remote_set_size : remote_set_size - local_set_size;
+    const size_t min_size = std::min(local_set_size, remote_set_size);
+    const size_t capacity = set_size_diff + static_cast<size_t>(std::floor(double(q) / Q_PRECISION * min_size)) + 1;
+    return std::min(capacity, MAX_SKETCH_CAPACITY);
+}
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -36,9 +52,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,14 +60,59 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /** Transactions to announce to the peer through the next round, per set. */
+    std::array<std::set<Wtxid>, RECON_SET_COUNT> m_local_set;
+
+    /** As the responder, the sets the last sketches were built from, until the difference. */
+    std::array<std::set<Wtxid>, RECON_SET_COUNT> m_local_set_snapshot;
+
+    /** A request was sent (initiator) or a sketch sent (responder), and the round is open. */
+    bool m_round_pending{false};
+
+    /** Start of the open round; as the responder, time of the last request otherwise. */
+    std::chrono::microseconds m_last_round{0};
+
+    /** As the initiator, when the next request is due. */
+    std::chrono::microseconds m_next_request{0};
+
+    /** The peer stopped taking part in rounds; transactions are flooded to it. */
+    bool m_fallen_back{false};
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /**
+     * Short ID of a transaction in a set, per BIP-330 for the default set. The other sets mix
+     * their index into the salt, so that equal IDs across sets mean nothing.
+     */
+    uint32_t ComputeShortID(const Wtxid& wtxid, size_t set) const
+    {
+        const uint64_t s = set == 0 ? SipHashUint256(m_k0, m_k1, wtxid.ToUint256()) :
+                                      SipHashUint256Extra(m_k0, m_k1, wtxid.ToUint256(), set);
+        return 1 + (s & 0xFFFFFFFF);
+    }
+
+    Minisketch ComputeSketch(const std::set<Wtxid>& txs, size_t set, size_t capacity) const
+    {
+        Minisketch sketch = node::MakeMinisketch32(capacity);
+        for (const Wtxid& wtxid : txs) sketch.Add(ComputeShortID(wtxid, set));
+        return sketch;
+    }
+
+    /** Move every queued transaction, including a responder's snapshot, to txs. */
+    void Flush(std::vector<Wtxid>& txs)
+    {
+        for (auto* sets : {&m_local_set, &m_local_set_snapshot}) {
+            for (std::set<Wtxid>& txs_in_set : *sets) {
+                txs.insert(txs.end(), txs_in_set.begin(), txs_in_set.end());
+                txs_in_set.clear();
+            }
+        }
+        m_round_pending = false;
+    }
 };
 
 } // namespace
@@ -76,6 +134,28 @@ private:
      */
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
+    /** Salt for the per-transaction choice of fanout peers. */
+    const uint64_t m_fanout_k0{FastRandomContext().rand64()}, m_fanout_k1{FastRandomContext().rand64()};
+
+    TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto it = m_states.find(peer_id);
+        if (it == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&it->second);
+    }
+
+    const TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto it = m_states.find(peer_id);
+        if (it == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&it->second);
+    }
+
+    uint64_t FanoutHash(const Wtxid& wtxid, NodeId peer_id) const
+    {
+        return SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid.ToUint256(), static_cast<uint32_t>(peer_id));
+    }
+
 public:
     explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
 
@@ -142,6 +222,195 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid, ReconciliationSet set) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_fallen_back) return false;
+
+        std::set<Wtxid>& local_set = state->m_local_set[static_cast<size_t>(set)];
+        if (local_set.size() >= MAX_RECON_SET_SIZE) return false;
+        local_set.insert(wtxid);
+        return true;
+    }
+
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state) return false;
+        bool removed{false};
+        for (std::set<Wtxid>& local_set : state->m_local_set) removed |= local_set.erase(wtxid) > 0;
+        return removed;
+    }
+
+    bool ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_fallen_back) return true;
+
+        const uint64_t peer_hash{FanoutHash(wtxid, peer_id)};
+        if (!state->m_we_initiate) {
+            return peer_hash < INBOUND_FANOUT_DESTINATIONS_FRACTION * double(std::numeric_limits<uint64_t>::max());
+        }
+
+        // Flood to the outbound peers with the lowest hashes for this transaction
+        size_t lower{0};
+        for (const auto& [other_id, other_state] : m_states) {
+            const auto* other = std::get_if<TxReconciliationState>(&other_state);
+            if (other_id == peer_id || !other || !other->m_we_initiate || other->m_fallen_back) continue;
+            if (FanoutHash(wtxid, other_id) < peer_hash && ++lower >= OUTBOUND_FANOUT_DESTINATIONS) return false;
+        }
+        return true;
+    }
+
+    std::optional<ReconciliationRequest> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || !state->m_we_initiate || state->m_round_pending || now < state->m_next_request) return std::nullopt;
+
+        ReconciliationRequest request;
+        for (size_t set = 0; set < RECON_SET_COUNT; ++set) {
+            request.set_sizes[set] = state->m_local_set[set].size();
+        }
+        request.q = DEFAULT_RECON_Q * Q_PRECISION;
+        state->m_round_pending = true;
+        state->m_last_round = now;
+        state->m_next_request = now + RECON_REQUEST_INTERVAL;
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Initiate reconciliation with peer=%d (sets %u/%u/%u)\n",
+                      peer_id, request.set_sizes[0], request.set_sizes[1], request.set_sizes[2]);
+        return request;
+    }
+
+    bool HandleReconciliationRequest(NodeId peer_id, std::chrono::microseconds now, const ReconciliationRequest& request,
+                                     std::vector<std::vector<uint8_t>>& sketches) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_we_initiate || state->m_round_pending) return false;
+
+        sketches.assign(RECON_SET_COUNT, {});
+        for (size_t set = 0; set < RECON_SET_COUNT; ++set) {
+            std::set<Wtxid>& local_set = state->m_local_set[set];
+            // An empty sketch stands for two empty sets
+            if (!local_set.empty() || request.set_sizes[set] != 0) {
+                const size_t capacity{EstimateSketchCapacity(local_set.size(), request.set_sizes[set], request.q)};
+                sketches[set] = state->ComputeSketch(local_set, set, capacity).Serialize();
+            }
+            state->m_local_set_snapshot[set] = std::move(local_set);
+            local_set.clear();
+        }
+        state->m_round_pending = true;
+        state->m_last_round = now;
+        state->m_fallen_back = false;
+        return true;
+    }
+
+    bool HandleSketch(NodeId peer_id, const std::vector<std::vector<uint8_t>>& sketches,
+                      std::vector<Wtxid>& txs_to_announce, ReconciliationDifference& difference) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || !state->m_we_initiate || !state->m_round_pending || sketches.size() != RECON_SET_COUNT) return false;
+        for (const std::vector<uint8_t>& sketch : sketches) {
+            if (sketch.size() % 4 != 0 || sketch.size() / 4 > MAX_SKETCH_CAPACITY) return false;
+        }
+
+        difference.success.assign(RECON_SET_COUNT, 1);
+        difference.ask_shortids.assign(RECON_SET_COUNT, {});
+        for (size_t set = 0; set < RECON_SET_COUNT; ++set) {
+            std::set<Wtxid>& local_set = state->m_local_set[set];
+            std::optional<std::vector<uint64_t>> differences;
+            if (sketches[set].empty()) {
+                // The peer had nothing, so it misses everything we have
+                differences.emplace();
+                for (const Wtxid& wtxid : local_set) differences->push_back(state->ComputeShortID(wtxid, set));
+            } else {
+                const size_t capacity{sketches[set].size() / 4};
+                Minisketch remote_sketch = node::MakeMinisketch32(capacity);
+                remote_sketch.Deserialize(sketches[set]);
+                differences = state->ComputeSketch(local_set, set, capacity).Merge(remote_sketch).Decode(capacity);
+            }
+
+            if (!differences) {
+                // Too many differences for the sketch: both sides announce their whole set
+                difference.success[set] = 0;
+                txs_to_announce.insert(txs_to_announce.end(), local_set.begin(), local_set.end());
+                LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation of set %u with peer=%d failed\n", set, peer_id);
+            } else {
+                std::map<uint32_t, Wtxid> local_ids;
+                for (const Wtxid& wtxid : local_set) local_ids.emplace(state->ComputeShortID(wtxid, set), wtxid);
+                for (const uint64_t id : *differences) {
+                    auto it = local_ids.find(id);
+                    if (it != local_ids.end()) {
+                        txs_to_announce.push_back(it->second);
+                    } else {
+                        difference.ask_shortids[set].push_back(id);
+                    }
+                }
+            }
+            local_set.clear();
+        }
+        state->m_round_pending = false;
+        state->m_fallen_back = false;
+        return true;
+    }
+
+    bool HandleReconciliationDifference(NodeId peer_id, const ReconciliationDifference& difference,
+                                        std::vector<Wtxid>& txs_to_announce) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_we_initiate || !state->m_round_pending ||
+            difference.success.size() != RECON_SET_COUNT || difference.ask_shortids.size() != RECON_SET_COUNT) return false;
+
+        for (size_t set = 0; set < RECON_SET_COUNT; ++set) {
+            std::set<Wtxid>& snapshot = state->m_local_set_snapshot[set];
+            if (!difference.success[set]) {
+                txs_to_announce.insert(txs_to_announce.end(), snapshot.begin(), snapshot.end());
+            } else if (!difference.ask_shortids[set].empty()) {
+                std::map<uint32_t, Wtxid> snapshot_ids;
+                for (const Wtxid& wtxid : snapshot) snapshot_ids.emplace(state->ComputeShortID(wtxid, set), wtxid);
+                for (const uint32_t id : difference.ask_shortids[set]) {
+                    auto it = snapshot_ids.find(id);
+                    if (it != snapshot_ids.end()) txs_to_announce.push_back(it->second);
+                }
+            }
+            snapshot.clear();
+        }
+        state->m_round_pending = false;
+        return true;
+    }
+
+    void ExpireStaleRounds(NodeId peer_id, std::chrono::microseconds now, std::vector<Wtxid>& txs_to_announce) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        TxReconciliationState* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_fallen_back) return;
+
+        if (!state->m_we_initiate && state->m_last_round == 0us) {
+            // Give a new peer the time for its first request
+            state->m_last_round = now;
+            return;
+        }
+        // Responders wait for requests, and for the difference after a sketch
+        if ((state->m_round_pending || !state->m_we_initiate) && now > state->m_last_round + RECON_TIMEOUT) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Peer=%d stopped reconciling, flooding to it\n", peer_id);
+            state->Flush(txs_to_announce);
+            state->m_fallen_back = true;
+        }
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +437,46 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const Wtxid& wtxid, ReconciliationSet set)
+{
+    return m_impl->AddToSet(peer_id, wtxid, set);
+}
+
+bool TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->TryRemovingFromSet(peer_id, wtxid);
+}
+
+bool TxReconciliationTracker::ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const
+{
+    return m_impl->ShouldFanoutTo(wtxid, peer_id);
+}
+
+std::optional<ReconciliationRequest> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id, now);
+}
+
+bool TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, std::chrono::microseconds now, const ReconciliationRequest& request,
+                                                          std::vector<std::vector<uint8_t>>& sketches)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, now, request, sketches);
+}
+
+bool TxReconciliationTracker::HandleSketch(NodeId peer_id, const std::vector<std::vector<uint8_t>>& sketches,
+                                           std::vector<Wtxid>& txs_to_announce, ReconciliationDifference& difference)
+{
+    return m_impl->HandleSketch(peer_id, sketches, txs_to_announce, difference);
+}
+
+bool TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, const ReconciliationDifference& difference,
+                                                             std::vector<Wtxid>& txs_to_announce)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, difference, txs_to_announce);
+}
+
+void TxReconciliationTracker::ExpireStaleRounds(NodeId peer_id, std::chrono::microseconds now, std::vector<Wtxid>& txs_to_announce)
+{
+    m_impl->ExpireStaleRounds(peer_id, now, txs_to_announce);
+}
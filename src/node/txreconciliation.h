@@ -7,13 +7,61 @@
 
 #include <net.h>
 #include <sync.h>
+#include <util/transaction_identifier.h>
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <tuple>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
 
+/**
+ * Transactions are reconciled in separate sets, each with its own short ID salt and sketch, so
+ * that the rarer, larger contract and privacy transactions do not share sketch capacity (or a
+ * failed decode) with plain payments.
+ */
+enum class ReconciliationSet : uint8_t {
+    DEFAULT,
+    CONTRACT,
+    PRIVACY,
+};
+static constexpr size_t RECON_SET_COUNT{3};
+
+/** Transactions queued for reconciliation with a peer, per set. Past this they are flooded. */
+static constexpr size_t MAX_RECON_SET_SIZE{3000};
+/** Largest sketch capacity we build or accept. */
+static constexpr size_t MAX_SKETCH_CAPACITY{2 << 12};
+/** Interval between reconciliation requests to a peer we initiate with. */
+static constexpr std::chrono::seconds RECON_REQUEST_INTERVAL{8};
+/** A peer that leaves a round unanswered this long, or that we initiate with and that stops
+ * requesting, is treated as not reconciling: its sets are flooded and new transactions too. */
+static constexpr std::chrono::seconds RECON_TIMEOUT{60};
+/** Fixed-point precision of the q coefficient in reqrecon, see BIP-330. */
+static constexpr uint16_t Q_PRECISION{(2 << 14) - 1};
+/** Expected share of the smaller set missing from the other side, sent as q. */
+static constexpr double DEFAULT_RECON_Q{0.25};
+/** Share of reconciling inbound peers a transaction is still flooded to. */
+static constexpr double INBOUND_FANOUT_DESTINATIONS_FRACTION{0.1};
+/** Reconciling outbound peers a transaction is still flooded to. */
+static constexpr size_t OUTBOUND_FANOUT_DESTINATIONS{1};
+
+/** Contents of a reqrecon message. */
+struct ReconciliationRequest {
+    std::array<uint16_t, RECON_SET_COUNT> set_sizes{};
+    uint16_t q{0};
+};
+
+/** Contents of a reconcildiff message, one entry per set. */
+struct ReconciliationDifference {
+    std::vector<uint8_t> success;
+    std::vector<std::vector<uint32_t>> ask_shortids;
+};
+
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
     SUCCESS,
@@ -47,6 +95,10 @@ enum class ReconciliationRegisterResult {
  * This is a modification of the Erlay protocol (https://arxiv.org/abs/1905.10518) with two
  * changes (sketch extensions instead of bisections, and an extra INV exchange round), both
  * are motivated in BIP-330.
+ *
+ * Sketch extensions are not implemented: a failed decode goes straight to FAILURE. A round
+ * carries one sketch per ReconciliationSet. Every transaction is still flooded to a few
+ * reconciling peers (see ShouldFanoutTo()), so that it spreads before the next round.
  */
 class TxReconciliationTracker
 {
@@ -84,6 +136,62 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction to the peer's reconciliation set instead of announcing it.
+     * Returns false if the peer does not reconcile or the set is full; announce it then.
+     */
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid, ReconciliationSet set);
+
+    /**
+     * Drop a transaction from the peer's reconciliation sets, e.g. because the peer announced
+     * it to us. Returns whether it was there.
+     */
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Whether to flood a transaction to a reconciling peer anyway. Picks a deterministic
+     * OUTBOUND_FANOUT_DESTINATIONS of the outbound peers and about
+     * INBOUND_FANOUT_DESTINATIONS_FRACTION of the inbound ones per transaction.
+     * Always true for peers that do not reconcile.
+     */
+    bool ShouldFanoutTo(const Wtxid& wtxid, NodeId peer_id) const;
+
+    /**
+     * Step 2. As the initiator, start a round if one is due and none is pending.
+     */
+    std::optional<ReconciliationRequest> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now);
+
+    /**
+     * Step 2. As the responder, answer a request with one sketch per set, and keep the sets
+     * the sketches were built from until the difference arrives. Returns false on a protocol
+     * violation.
+     */
+    bool HandleReconciliationRequest(NodeId peer_id, std::chrono::microseconds now, const ReconciliationRequest& request,
+                                     std::vector<std::vector<uint8_t>>& sketches);
+
+    /**
+     * Step 3. As the initiator, find the differences from the peer's sketches. Transactions the
+     * peer is missing (or the whole set, if a sketch did not decode) go to txs_to_announce, and
+     * the short IDs we are missing to the difference to send back. Returns false on a protocol
+     * violation.
+     */
+    bool HandleSketch(NodeId peer_id, const std::vector<std::vector<uint8_t>>& sketches,
+                      std::vector<Wtxid>& txs_to_announce, ReconciliationDifference& difference);
+
+    /**
+     * Step 4. As the responder, collect the transactions the initiator asked for, or the whole
+     * set where its decode failed. Returns false on a protocol violation.
+     */
+    bool HandleReconciliationDifference(NodeId peer_id, const ReconciliationDifference& difference,
+                                        std::vector<Wtxid>& txs_to_announce);
+
+    /**
+     * Fall back to flooding with a peer that left a round unanswered, or that we respond to
+     * and that stopped requesting, for RECON_TIMEOUT. Its queued transactions go to
+     * txs_to_announce.
+     */
+    void ExpireStaleRounds(NodeId peer_id, std::chrono::microseconds now, std::vector<Wtxid>& txs_to_announce);
 };
 
 #endif // BITCOIN_NODE_TXRECONCILIATION_H
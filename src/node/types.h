@@ -60,6 +60,13 @@ struct BlockCreateOptions {
      * coinbase_max_additional_weight and coinbase_output_max_additional_sigops.
      */
     CScript coinbase_output_script{CScript() << OP_TRUE};
+    /**
+     * Continue from the selection of the last template built with this set,
+     * when it has the same parent, time, reward script and limits, instead
+     * of selecting and executing the whole mempool again. Only the
+     * transactions that entered the mempool since are considered.
+     */
+    bool incremental{false};
 };
 } // namespace node
 
@@ -4,22 +4,261 @@
 
 #include <node/utxo_snapshot.h>
 
+#include <chain.h>
+#include <crypto/sha3.h>
+#include <hash.h>
+#include <libdevcore/SHA3.h>
 #include <logging.h>
+#include <privacy/consensus.h>
+#include <privacy/fcmp_consensus.h>
+#include <qtum/qtumstate.h>
+#include <qtum/statepruner.h>
 #include <streams.h>
 #include <sync.h>
 #include <tinyformat.h>
 #include <txdb.h>
 #include <uint256.h>
+#include <util/convert.h>
 #include <util/fs.h>
+#include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace node {
 
+//! Trie nodes per chunk of the contract state, each loaded chunk is committed on its own
+static constexpr size_t CONTRACT_STATE_CHUNK_SIZE{10000};
+
+//! The state and UTXO trie roots after a block, blocks before the contract state have none
+static std::pair<dev::h256, dev::h256> StateRoots(const CBlockIndex& block)
+{
+    if (block.hashStateRoot.IsNull() || block.hashUTXORoot.IsNull()) {
+        return {dev::EmptyTrie, dev::EmptyTrie};
+    }
+    return {uintToh256(block.hashStateRoot), uintToh256(block.hashUTXORoot)};
+}
+
+uint256 SnapshotPrivacyState::GetCurveTreeHash() const
+{
+    HashWriter hasher{};
+    hasher << curve_tree_outputs << curve_tree_root;
+    return hasher.GetHash();
+}
+
+uint256 SnapshotPrivacyState::GetKeyImagesHash() const
+{
+    HashWriter hasher{};
+    hasher << fcmp_key_images << key_images;
+    return hasher.GetHash();
+}
+
+util::Result<uint256> WriteSnapshotContractState(AutoFile& afile, const CBlockIndex& base,
+                                                 const std::function<void()>& interruption_point)
+{
+    // Copies share the databases and the pending writes of globalState, and
+    // the nodes are content addressed, so blocks connected meanwhile do not
+    // change what the roots reach
+    std::optional<std::pair<dev::OverlayDB, dev::OverlayDB>> dbs{WITH_LOCK(::cs_main,
+        return globalState ? std::make_optional(std::make_pair(globalState->db(), globalState->dbUtxo())) : std::nullopt)};
+    if (!dbs) {
+        return util::Error{Untranslated("Contract state is not loaded")};
+    }
+    const auto [state_root, utxo_root] = StateRoots(base);
+
+    HashWriter hasher{};
+    for (const auto& [db, root, accounts] : {std::make_tuple(&dbs->first, state_root, true),
+                                             std::make_tuple(&dbs->second, utxo_root, false)}) {
+        std::vector<std::pair<uint256, std::vector<unsigned char>>> chunk;
+        auto write_chunk = [&] {
+            afile << chunk;
+            hasher << chunk;
+            chunk.clear();
+        };
+        // The empty trie is written once when a database is created
+        dev::h256Hash visited{dev::EmptyTrie};
+        const bool walked = WalkStateDB(*db, {root}, accounts, visited, [&](const dev::h256& key, const std::string& node) {
+            chunk.emplace_back(h256Touint(key), std::vector<unsigned char>(node.begin(), node.end()));
+            if (chunk.size() == CONTRACT_STATE_CHUNK_SIZE) {
+                interruption_point();
+                write_chunk();
+            }
+            return true;
+        }, [] { return false; });
+        if (!walked) {
+            return util::Error{Untranslated(strprintf("Contract state at block %s is not available, it may have been pruned",
+                base.GetBlockHash().ToString()))};
+        }
+        if (!chunk.empty()) write_chunk();
+        write_chunk();
+    }
+    return hasher.GetHash();
+}
+
+util::Result<uint256> LoadSnapshotContractState(AutoFile& afile, const CBlockIndex& base,
+                                                const std::function<bool()>& interrupted)
+{
+    std::optional<std::pair<dev::OverlayDB, dev::OverlayDB>> dbs{WITH_LOCK(::cs_main,
+        return globalState ? std::make_optional(std::make_pair(globalState->db(), globalState->dbUtxo())) : std::nullopt)};
+    if (!dbs) {
+        return util::Error{Untranslated("Contract state is not loaded")};
+    }
+    const auto [state_root, utxo_root] = StateRoots(base);
+
+    HashWriter hasher{};
+    size_t nodes{0};
+    for (const auto& [db, root, accounts] : {std::make_tuple(&dbs->first, state_root, true),
+                                             std::make_tuple(&dbs->second, utxo_root, false)}) {
+        std::vector<std::pair<uint256, std::vector<unsigned char>>> chunk;
+        do {
+            if (interrupted()) {
+                return util::Error{Untranslated("Aborting after an interrupt was requested")};
+            }
+            try {
+                afile >> chunk;
+            } catch (const std::ios_base::failure&) {
+                return util::Error{Untranslated(strprintf("Bad snapshot format or truncated snapshot after deserializing %d contract state nodes", nodes))};
+            }
+            if (chunk.size() > CONTRACT_STATE_CHUNK_SIZE) {
+                return util::Error{Untranslated("Bad snapshot contract state chunk size")};
+            }
+            hasher << chunk;
+            // The nodes of a chunk are hashed as one batch
+            std::vector<Span<const unsigned char>> nodes_data;
+            nodes_data.reserve(chunk.size());
+            for (const auto& [key, node] : chunk) nodes_data.emplace_back(node);
+            std::vector<unsigned char> hashes(chunk.size() * KECCAK256_OUTPUT_SIZE);
+            Keccak256Many(nodes_data, hashes);
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                const auto& [key, node] = chunk[i];
+                if (!std::equal(key.begin(), key.end(), hashes.begin() + i * KECCAK256_OUTPUT_SIZE)) {
+                    return util::Error{Untranslated(strprintf("Bad snapshot contract state node %s", key.ToString()))};
+                }
+                db->insert(uintToh256(key), dev::bytesConstRef(node.data(), node.size()));
+            }
+            nodes += chunk.size();
+            // Validation commits and flushes the shared pending writes under cs_main
+            LOCK(::cs_main);
+            db->commit();
+            db->flush();
+        } while (!chunk.empty());
+
+        // Each node matches its hash, so reaching every node from the root
+        // of the base block proves the state is the one the block commits to
+        dev::h256Hash visited{dev::EmptyTrie};
+        if (!WalkStateDB(*db, {root}, accounts, visited, [](const dev::h256&, const std::string&) { return true; }, interrupted)) {
+            return util::Error{Untranslated(strprintf("Snapshot contract state is incomplete for root %s", root.hex()))};
+        }
+    }
+
+    LogPrintf("[snapshot] loaded %d contract state nodes\n", nodes);
+    return hasher.GetHash();
+}
+
+util::Result<SnapshotPrivacyState> ReadSnapshotPrivacyState(const privacy::CFcmpConsensusState* fcmp,
+                                                             const privacy::CKeyImageDB* key_images)
+{
+    SnapshotPrivacyState state;
+    if (fcmp && fcmp->IsInitialized()) {
+        std::vector<curvetree::OutputTuple> outputs;
+        ed25519::Point root;
+        if (!fcmp->GetSnapshotState(outputs, root, state.fcmp_key_images)) {
+            return util::Error{Untranslated("Unable to read the curve tree")};
+        }
+        state.curve_tree_outputs.reserve(outputs.size());
+        for (const curvetree::OutputTuple& output : outputs) {
+            state.curve_tree_outputs.push_back(output.Serialize());
+        }
+        std::copy(root.data.begin(), root.data.end(), state.curve_tree_root.begin());
+    }
+    if (key_images) {
+        state.key_images = key_images->GetDBRecords();
+    }
+    return state;
+}
+
+util::Result<void> CheckSnapshotPrivacyState(const SnapshotPrivacyState& state, const AssumeutxoData& au_data)
+{
+    const bool empty_tree{state.curve_tree_outputs.empty()};
+    const bool empty_key_images{state.fcmp_key_images.empty() && state.key_images.empty()};
+    if (au_data.hash_curve_tree.IsNull() ? !empty_tree : state.GetCurveTreeHash() != au_data.hash_curve_tree) {
+        return util::Error{Untranslated(strprintf("Bad snapshot curve tree hash: expected %s, got %s",
+            au_data.hash_curve_tree.ToString(), state.GetCurveTreeHash().ToString()))};
+    }
+    if (au_data.hash_key_images.IsNull() ? !empty_key_images : state.GetKeyImagesHash() != au_data.hash_key_images) {
+        return util::Error{Untranslated(strprintf("Bad snapshot key image hash: expected %s, got %s",
+            au_data.hash_key_images.ToString(), state.GetKeyImagesHash().ToString()))};
+    }
+    return {};
+}
+
+util::Result<void> LoadSnapshotPrivacyState(const SnapshotPrivacyState& state, privacy::CFcmpConsensusState* fcmp,
+                                            privacy::CKeyImageDB* key_images, int height)
+{
+    if ((fcmp && !fcmp->IsEmpty()) || (key_images && !key_images->IsEmpty())) {
+        return util::Error{Untranslated("The privacy state is not empty, a snapshot can only be loaded before the first privacy transaction")};
+    }
+    if (state.IsEmpty()) return {};
+
+    // The ring key images go first, they are undone if the curve tree fails
+    // to load, which leaves the FCMP state empty itself
+    if (!state.key_images.empty()) {
+        if (!key_images || !key_images->LoadDBRecords(state.key_images)) {
+            return util::Error{Untranslated("Unable to load the snapshot key images")};
+        }
+    }
+    if (!state.curve_tree_outputs.empty() || !state.fcmp_key_images.empty()) {
+        auto undo_key_images{[&] { if (key_images) key_images->LoadDBRecords({}); }};
+        if (!fcmp || !fcmp->IsInitialized()) {
+            undo_key_images();
+            return util::Error{Untranslated("FCMP state is not loaded")};
+        }
+        std::vector<curvetree::OutputTuple> outputs;
+        outputs.reserve(state.curve_tree_outputs.size());
+        for (const std::vector<uint8_t>& data : state.curve_tree_outputs) {
+            auto output = curvetree::OutputTuple::Deserialize(data);
+            if (!output) {
+                undo_key_images();
+                return util::Error{Untranslated("Bad snapshot curve tree output")};
+            }
+            outputs.push_back(std::move(*output));
+        }
+        ed25519::Point root;
+        std::copy(state.curve_tree_root.begin(), state.curve_tree_root.end(), root.data.begin());
+        if (!fcmp->LoadSnapshotState(outputs, root, state.fcmp_key_images, height)) {
+            undo_key_images();
+            return util::Error{Untranslated("Unable to load the snapshot curve tree and FCMP key images")};
+        }
+    }
+    return {};
+}
+
+bool RestoreBackgroundPrivacyState(const fs::path& data_dir)
+{
+    const fs::path background_dir{data_dir / SNAPSHOT_PRIVACY_DIRNAME};
+    if (!fs::exists(background_dir)) return true;
+
+    LogPrintf("[snapshot] snapshot chainstate is gone, restoring the privacy state of the background chainstate\n");
+    try {
+        for (const fs::path& name : {fs::path{"fcmp"}, fs::path{"keyimages"}}) {
+            fs::remove_all(data_dir / name);
+            if (fs::exists(background_dir / name)) {
+                fs::rename(background_dir / name, data_dir / name);
+            }
+        }
+        fs::remove_all(background_dir);
+    } catch (const fs::filesystem_error& e) {
+        LogPrintf("[snapshot] failed to restore the background privacy state: %s\n", fsbridge::get_filesystem_error_message(e));
+        return false;
+    }
+    return true;
+}
+
 bool WriteSnapshotBaseBlockhash(Chainstate& snapshot_chainstate)
 {
     AssertLockHeld(::cs_main);
@@ -7,6 +7,7 @@
 #define BITCOIN_NODE_UTXO_SNAPSHOT_H
 
 #include <chainparams.h>
+#include <dbwrapper.h>
 #include <kernel/chainparams.h>
 #include <kernel/cs_main.h>
 #include <serialize.h>
@@ -15,24 +16,37 @@
 #include <util/chaintype.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/result.h>
 
+#include <array>
 #include <cstdint>
+#include <functional>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 // UTXO set snapshot magic bytes
 static constexpr std::array<uint8_t, 5> SNAPSHOT_MAGIC_BYTES = {'u', 't', 'x', 'o', 0xff};
 
+class AutoFile;
+class CBlockIndex;
 class Chainstate;
 
+namespace privacy {
+class CFcmpConsensusState;
+class CKeyImageDB;
+} // namespace privacy
+
 namespace node {
 //! Metadata describing a serialized version of a UTXO set from which an
 //! assumeutxo Chainstate can be constructed.
+//! The coins are followed by the contract state (see
+//! WriteSnapshotContractState()) and the SnapshotPrivacyState.
 //! All metadata fields come from an untrusted file, so must be validated
 //! before being used. Thus, new fields should be added only if needed.
 class SnapshotMetadata
 {
-    inline static const uint16_t VERSION{2};
+    inline static const uint16_t VERSION{3};
     const std::set<uint16_t> m_supported_versions{VERSION};
     const MessageStartChars m_network_magic;
 public:
@@ -101,6 +115,73 @@ public:
     }
 };
 
+//! The FCMP curve tree and spent key images at the base block of a snapshot,
+//! written after its contract state. The curve tree is written as its
+//! outputs, the nodes are rebuilt from them and checked against the root.
+struct SnapshotPrivacyState
+{
+    //! FCMP outputs in leaf order, see curvetree::OutputTuple::Serialize()
+    std::vector<std::vector<uint8_t>> curve_tree_outputs;
+    std::array<uint8_t, 32> curve_tree_root{};
+    //! Records of the FCMP and ring signature key image databases
+    CDBWrapper::Records fcmp_key_images;
+    CDBWrapper::Records key_images;
+
+    bool IsEmpty() const
+    {
+        return curve_tree_outputs.empty() && fcmp_key_images.empty() && key_images.empty();
+    }
+
+    //! Compared against AssumeutxoData::hash_curve_tree
+    uint256 GetCurveTreeHash() const;
+    //! Compared against AssumeutxoData::hash_key_images
+    uint256 GetKeyImagesHash() const;
+
+    SERIALIZE_METHODS(SnapshotPrivacyState, obj)
+    {
+        READWRITE(obj.curve_tree_outputs, obj.curve_tree_root, obj.fcmp_key_images, obj.key_images);
+    }
+};
+
+//! Write the nodes of the contract state and UTXO tries at the base block,
+//! with the code of the accounts, in chunks that end with an empty one.
+//! @returns the hash compared against AssumeutxoData::hash_contract_state
+util::Result<uint256> WriteSnapshotContractState(AutoFile& afile, const CBlockIndex& base,
+                                                 const std::function<void()>& interruption_point)
+    EXCLUSIVE_LOCKS_REQUIRED(!::cs_main);
+
+//! Read the nodes written by WriteSnapshotContractState() into the state
+//! databases. Every node must hash to its key, and afterwards the state
+//! roots of the base block must reach only nodes that are there.
+//! @returns the hash compared against AssumeutxoData::hash_contract_state
+util::Result<uint256> LoadSnapshotContractState(AutoFile& afile, const CBlockIndex& base,
+                                                const std::function<bool()>& interrupted)
+    EXCLUSIVE_LOCKS_REQUIRED(!::cs_main);
+
+//! Read the privacy state of an FCMP state and a ring signature key image
+//! database, either of which may be null. Both must have been flushed.
+util::Result<SnapshotPrivacyState> ReadSnapshotPrivacyState(const privacy::CFcmpConsensusState* fcmp,
+                                                             const privacy::CKeyImageDB* key_images);
+
+//! Check a privacy state against the hashes of the assumeutxo data.
+util::Result<void> CheckSnapshotPrivacyState(const SnapshotPrivacyState& state, const AssumeutxoData& au_data);
+
+//! Fill an empty FCMP state and ring signature key image database with the
+//! privacy state of a snapshot taken at height. On failure both are left empty.
+util::Result<void> LoadSnapshotPrivacyState(const SnapshotPrivacyState& state, privacy::CFcmpConsensusState* fcmp,
+                                            privacy::CKeyImageDB* key_images, int height);
+
+//! The directory in the data dir where the background chainstate keeps its
+//! FCMP state and ring signature key images while a snapshot is validated.
+//! The privacy state of the data dir is the snapshot chainstate's.
+const fs::path SNAPSHOT_PRIVACY_DIRNAME{"privacy_background"};
+
+//! When the snapshot chainstate is gone without having been validated, its
+//! privacy state is replaced with the background chainstate's. Must be called
+//! before the privacy databases are opened.
+//! @returns false if there was a background privacy state but it could not be moved
+bool RestoreBackgroundPrivacyState(const fs::path& data_dir);
+
 //! The file in the snapshot chainstate dir which stores the base blockhash. This is
 //! needed to reconstruct snapshot chainstates on init.
 //!
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/validator_snapshot.h>
+
+#include <chain.h>
+#include <hash.h>
+#include <logging.h>
+#include <trust/heartbeat_net.h>
+#include <util/translation.h>
+#include <validators/delegation.h>
+#include <validators/validatordb.h>
+
+namespace node {
+
+uint256 ValidatorSnapshot::GetHash() const
+{
+    HashWriter hasher{};
+    hasher << VERSION << m_network_magic << m_base_blockhash << m_base_height;
+    hasher << m_validators << m_delegations << m_trust;
+    return hasher.GetHash();
+}
+
+util::Result<ValidatorSnapshot> CreateValidatorSnapshot(const CBlockIndex& tip, const MessageStartChars& network_magic)
+{
+    AssertLockHeld(::cs_main);
+    if (!validators::g_validator_db || !validators::g_delegation_db || !trust::g_heartbeat_manager) {
+        return util::Error{Untranslated("Validator databases are not loaded")};
+    }
+
+    ValidatorSnapshot snapshot{network_magic};
+    snapshot.m_base_blockhash = tip.GetBlockHash();
+    snapshot.m_base_height = tip.nHeight;
+    snapshot.m_validators = validators::g_validator_db->GetDBRecords();
+    snapshot.m_delegations = validators::g_delegation_db->GetDBRecords();
+    snapshot.m_trust = trust::g_heartbeat_manager->GetTrustManager()->GetDBRecords();
+    return snapshot;
+}
+
+util::Result<void> LoadValidatorSnapshot(const ValidatorSnapshot& snapshot, const CBlockIndex& tip)
+{
+    AssertLockHeld(::cs_main);
+    if (!validators::g_validator_db || !validators::g_delegation_db || !trust::g_heartbeat_manager) {
+        return util::Error{Untranslated("Validator databases are not loaded")};
+    }
+    // The databases are updated by every connected block, so they can only
+    // be replaced by a state taken at the same block
+    if (snapshot.m_base_blockhash != tip.GetBlockHash() || snapshot.m_base_height != tip.nHeight) {
+        return util::Error{Untranslated(strprintf("Snapshot was taken at block %s (height %d), the active tip is %s (height %d)",
+            snapshot.m_base_blockhash.ToString(), snapshot.m_base_height, tip.GetBlockHash().ToString(), tip.nHeight))};
+    }
+
+    if (!validators::g_validator_db->LoadDBRecords(snapshot.m_validators)) {
+        return util::Error{Untranslated("Failed to write the validator database")};
+    }
+    if (!validators::g_delegation_db->LoadDBRecords(snapshot.m_delegations)) {
+        return util::Error{Untranslated("Failed to write the delegation database")};
+    }
+    if (!trust::g_heartbeat_manager->LoadTrustState(snapshot.m_trust)) {
+        return util::Error{Untranslated("Failed to write the trust database")};
+    }
+    validators::g_validator_db->SetHeight(tip.nHeight);
+    validators::g_delegation_db->SetHeight(tip.nHeight);
+    trust::g_heartbeat_manager->GetTrustManager()->SetHeight(tip.nHeight);
+
+    LogPrintf("Loaded validator state snapshot at height %d: %u validator, %u delegation and %u trust records\n",
+              tip.nHeight, snapshot.m_validators.size(), snapshot.m_delegations.size(), snapshot.m_trust.size());
+    return {};
+}
+
+} // namespace node
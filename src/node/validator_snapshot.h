@@ -0,0 +1,107 @@
+// Copyright (c) 2024 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_VALIDATOR_SNAPSHOT_H
+#define BITCOIN_NODE_VALIDATOR_SNAPSHOT_H
+
+#include <dbwrapper.h>
+#include <kernel/cs_main.h>
+#include <kernel/messagestartchars.h>
+#include <serialize.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <uint256.h>
+#include <util/result.h>
+
+#include <array>
+#include <cstdint>
+#include <ios>
+
+// Validator state snapshot magic bytes
+static constexpr std::array<uint8_t, 5> VALIDATOR_SNAPSHOT_MAGIC_BYTES = {'w', 'v', 'a', 'l', 0xff};
+
+class CBlockIndex;
+
+namespace node {
+//! The validator, delegation and trust databases at a block, so a new node can
+//! start from them instead of rebuilding the validator set from every block
+//! since genesis. The file ends with a hash committing to its content, which
+//! is checked on load and can be compared against a hash obtained out of band.
+class ValidatorSnapshot
+{
+    inline static const uint16_t VERSION{1};
+    const MessageStartChars m_network_magic;
+public:
+    //! The block the databases were read at
+    uint256 m_base_blockhash;
+    int m_base_height{0};
+
+    CDBWrapper::Records m_validators;
+    CDBWrapper::Records m_delegations;
+    CDBWrapper::Records m_trust;
+
+    explicit ValidatorSnapshot(const MessageStartChars network_magic) :
+        m_network_magic(network_magic) { }
+
+    //! Hash committing to the snapshot content, written at the end of the file
+    uint256 GetHash() const;
+
+    template <typename Stream>
+    inline void Serialize(Stream& s) const {
+        s << VALIDATOR_SNAPSHOT_MAGIC_BYTES;
+        s << VERSION;
+        s << m_network_magic;
+        s << m_base_blockhash;
+        s << m_base_height;
+        s << m_validators;
+        s << m_delegations;
+        s << m_trust;
+        s << GetHash();
+    }
+
+    template <typename Stream>
+    inline void Unserialize(Stream& s) {
+        std::array<uint8_t, VALIDATOR_SNAPSHOT_MAGIC_BYTES.size()> magic;
+        s >> magic;
+        if (magic != VALIDATOR_SNAPSHOT_MAGIC_BYTES) {
+            throw std::ios_base::failure("Invalid validator state snapshot magic bytes");
+        }
+
+        uint16_t version;
+        s >> version;
+        if (version != VERSION) {
+            throw std::ios_base::failure(strprintf("Unsupported validator state snapshot version %d", version));
+        }
+
+        MessageStartChars network_magic;
+        s >> network_magic;
+        if (network_magic != m_network_magic) {
+            throw std::ios_base::failure("The validator state snapshot was created for a different network");
+        }
+
+        s >> m_base_blockhash;
+        s >> m_base_height;
+        s >> m_validators;
+        s >> m_delegations;
+        s >> m_trust;
+
+        uint256 hash;
+        s >> hash;
+        if (hash != GetHash()) {
+            throw std::ios_base::failure("Validator state snapshot content does not match its hash");
+        }
+    }
+};
+
+//! Read the validator, delegation and trust databases at the active tip.
+util::Result<ValidatorSnapshot> CreateValidatorSnapshot(const CBlockIndex& tip, const MessageStartChars& network_magic)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+//! Replace the validator, delegation and trust databases with the snapshot.
+//! The snapshot must have been taken at the active tip.
+util::Result<void> LoadValidatorSnapshot(const ValidatorSnapshot& snapshot, const CBlockIndex& tip)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+} // namespace node
+
+#endif // BITCOIN_NODE_VALIDATOR_SNAPSHOT_H
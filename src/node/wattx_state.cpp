@@ -0,0 +1,82 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#include <node/wattx_state.h>
+
+#include <logging.h>
+#include <node/utxo_snapshot.h>
+#include <privacy/consensus.h>
+#include <privacy/fcmp_consensus.h>
+#include <tinyformat.h>
+#include <trust/heartbeat_net.h>
+#include <trust/trustscore.h>
+#include <util/translation.h>
+#include <validation.h>
+#include <validators/delegation.h>
+#include <validators/validatordb.h>
+
+#include <future>
+#include <memory>
+
+namespace node {
+
+static std::unique_ptr<trust::TrustScoreManager> g_trust_manager;
+
+util::Result<void> InitWattxState(ChainstateManager& chainman, const fs::path& datadir, const WattxStateOptions& options)
+{
+    const Consensus::Params& consensus{chainman.GetConsensus()};
+
+    // An unvalidated snapshot chainstate that is gone leaves the privacy state
+    // of the background chainstate, which is the one to continue with
+    if (!chainman.ActiveChainstate().m_from_snapshot_blockhash && !RestoreBackgroundPrivacyState(datadir)) {
+        return util::Error{strprintf(_("Failed to restore the privacy state in %s."), fs::PathToString(datadir / SNAPSHOT_PRIVACY_DIRNAME))};
+    }
+
+    // Each of these reads its own directory and none depends on another
+    LogPrintf("Initializing validator, delegation and privacy databases...\n");
+    auto validator_db_init = std::async(std::launch::async, [&] {
+        validators::InitValidatorDB(consensus, datadir);
+    });
+    auto delegation_db_init = std::async(std::launch::async, [&] {
+        validators::InitDelegationDB(consensus, datadir);
+    });
+    auto key_image_db_init = std::async(std::launch::async, [&] {
+        return privacy::InitializeKeyImageDB(datadir);
+    });
+    auto fcmp_init = std::async(std::launch::async, [&] {
+        return privacy::InitializeFcmpConsensus(datadir, options.curve_tree_cache);
+    });
+
+    LogPrintf("Initializing trust system...\n");
+    g_trust_manager = std::make_unique<trust::TrustScoreManager>(consensus, datadir / "trust");
+    trust::InitHeartbeatManager(*g_trust_manager, consensus, options.heartbeat_threads);
+
+    validator_db_init.get();
+    delegation_db_init.get();
+    if (!key_image_db_init.get()) {
+        LogPrintf("Warning: Key image database initialization failed\n");
+        // Not fatal - privacy features will be unavailable
+    }
+    if (!fcmp_init.get()) {
+        LogPrintf("Warning: FCMP consensus initialization failed\n");
+        // Not fatal - FCMP features will be unavailable until activated
+    }
+
+    if (!chainman.LoadBackgroundPrivacyState()) {
+        return util::Error{_("Failed to open the privacy state of the background chainstate.")};
+    }
+    return {};
+}
+
+void ShutdownWattxState()
+{
+    trust::ShutdownHeartbeatManager();
+    g_trust_manager.reset();
+    privacy::ShutdownKeyImageDB();
+    privacy::ShutdownFcmpConsensus();
+    validators::ShutdownValidatorDB();
+    validators::ShutdownDelegationDB();
+}
+
+} // namespace node
@@ -0,0 +1,41 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/license/mit/.
+
+#ifndef BITCOIN_NODE_WATTX_STATE_H
+#define BITCOIN_NODE_WATTX_STATE_H
+
+#include <util/fs.h>
+#include <util/result.h>
+
+#include <cstddef>
+
+class ChainstateManager;
+
+namespace node {
+
+struct WattxStateOptions {
+    //! Cache of the FCMP curve tree database, in bytes
+    size_t curve_tree_cache{0};
+    //! Threads of the heartbeat manager, 0 to verify heartbeats on the caller
+    int heartbeat_threads{0};
+};
+
+/**
+ * Open the WATTx state connecting blocks needs next to the chainstate: the
+ * validator and delegation databases, the trust score and heartbeat managers,
+ * the key image database and the FCMP consensus state. The EVM state is
+ * opened by LoadChainstate(). The databases are opened in parallel.
+ *
+ * As in the node, privacy databases that fail to open only leave the privacy
+ * features unavailable. The privacy state of the background chainstate of a
+ * snapshot must be restored and opened though, or an error is returned.
+ */
+[[nodiscard]] util::Result<void> InitWattxState(ChainstateManager& chainman, const fs::path& datadir, const WattxStateOptions& options);
+
+/** Close what InitWattxState() opened */
+void ShutdownWattxState();
+
+} // namespace node
+
+#endif // BITCOIN_NODE_WATTX_STATE_H
@@ -9,9 +9,12 @@
 #include <hash.h>
 #include <logging.h>
 #include <node/randomx_miner.h>
+#include <opencl/gpu_miner.h>
+#include <opencl/opencl_runtime.h>
 #include <streams.h>
 #include <util/time.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 
@@ -57,11 +60,33 @@ X25XMiner::~X25XMiner() {
     StopMining();
 }
 
-bool X25XMiner::Initialize(x25x::Algorithm algo) {
+bool X25XMiner::Initialize(x25x::Algorithm algo, Backend backend,
+                           int gpuPlatform, int gpuDevice) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     m_algorithm = algo;
 
+    if (backend == Backend::GPU) {
+        // The GPU kernels are built for one algorithm at a time
+        if (!opencl::GpuMiner::SupportsAlgorithm(algo)) {
+            LogPrintf("X25X: No GPU kernel for %s\n", x25x::GetAlgorithmInfo(algo).name);
+            return false;
+        }
+        if (!m_gpu) {
+            m_gpu = std::make_unique<opencl::GpuMiner>();
+        }
+        if (!m_gpu->Initialize(gpuPlatform, gpuDevice, algo)) {
+            LogPrintf("X25X: Failed to initialize GPU backend\n");
+            return false;
+        }
+        m_gpuPlatform = gpuPlatform;
+        m_gpuDevice = gpuDevice;
+        LogPrintf("X25X: GPU backend ready on %s\n", m_gpu->GetDeviceName());
+    } else if (m_gpu) {
+        m_gpu->Cleanup();
+    }
+    m_backend = backend;
+
     switch (algo) {
         case x25x::Algorithm::SHA256D:
             // SHA256 is always available
@@ -131,7 +156,7 @@ void X25XMiner::SetAlgorithm(x25x::Algorithm algo) {
         return;
     }
 
-    if (!Initialize(algo)) {
+    if (!Initialize(algo, m_backend, m_gpuPlatform, m_gpuDevice)) {
         LogPrintf("X25X: Failed to initialize algorithm %s\n",
                   x25x::GetAlgorithmInfo(algo).name);
         return;
@@ -148,6 +173,15 @@ uint256 X25XMiner::ComputeHash(const CBlockHeader& header) {
 
 void X25XMiner::StartMining(const CBlock& block, const uint256& target,
                             int numThreads, BlockFoundCallback callback) {
+    if (m_backend == Backend::GPU) {
+        // Hand a new template to the running search; it switches at the next batch
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_mining && !m_stopMining) {
+            m_pendingWork = GpuWork{block, target, std::move(callback)};
+            return;
+        }
+    }
+
     StopMining();
 
     if (!x25x::IsAlgorithmEnabled(m_algorithm)) {
@@ -156,17 +190,29 @@ void X25XMiner::StartMining(const CBlock& block, const uint256& target,
         return;
     }
 
+    if (m_backend == Backend::GPU && (!m_gpu || !m_gpu->IsInitialized())) {
+        LogPrintf("X25X: GPU backend is not initialized\n");
+        return;
+    }
+
     if (numThreads <= 0) {
         numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
     }
 
-    LogPrintf("X25X: Starting mining with %d threads using %s algorithm\n",
-              numThreads, x25x::GetAlgorithmInfo(m_algorithm).name);
-
     m_stopMining = false;
     m_mining = true;
-    m_totalHashes = 0;
-    m_miningStartTime = GetTime();
+    m_telemetry.Start(m_backend == Backend::GPU ? 1 : numThreads);
+
+    if (m_backend == Backend::GPU) {
+        LogPrintf("X25X: Starting GPU mining on %s using %s algorithm\n",
+                  m_gpu->GetDeviceName(), x25x::GetAlgorithmInfo(m_algorithm).name);
+        m_gpu->ResetStop();
+        m_threads.emplace_back(&X25XMiner::GpuMineThread, this, block, target, callback);
+        return;
+    }
+
+    LogPrintf("X25X: Starting mining with %d threads using %s algorithm\n",
+              numThreads, x25x::GetAlgorithmInfo(m_algorithm).name);
 
     // Split nonce range among threads
     uint32_t nonceRange = UINT32_MAX / numThreads;
@@ -197,52 +243,177 @@ void X25XMiner::MineThread(int threadId, CBlock block, uint256 target,
     // Set the algorithm in the block version
     block.nVersion = x25x::SetBlockAlgorithm(block.nVersion, m_algorithm);
 
-    while (!m_stopMining && nonce < startNonce + nonceRange) {
-        block.nNonce = nonce;
+    // Serialize the template once; only the nonce changes per hash
+    x25x::HeaderHasher hasher(block, m_algorithm);
+    const arith_uint256 targetValue = UintToArith256(target);
 
-        // Compute hash using current algorithm
-        uint256 hash = ComputeHash(block);
+    // Scrypt hashes several nonces per call; other algorithms one at a time
+    std::vector<uint256> hashes(hasher.GetBatchSize());
+    bool found = false;
 
-        hashCount++;
+    while (!m_stopMining && !found && nonce < startNonce + nonceRange) {
+        const size_t batch = std::min<size_t>(hashes.size(), startNonce + nonceRange - nonce);
+        hasher.HashMany(nonce, batch, hashes.data());
 
-        // Update counters periodically
-        if ((hashCount & 0x3F) == 0) {  // Every 64 hashes
-            m_totalHashes += 64;
-        }
+        for (size_t i = 0; i < batch; i++, nonce++) {
+            const uint256& hash = hashes[i];
+
+            hashCount++;
+
+            // Update counters periodically
+            if ((hashCount & 0x3F) == 0) {  // Every 64 hashes
+                m_telemetry.AddHashes(threadId, 64);
+            }
+
+            // Debug logging for first hash
+            if (hashCount == 1 && threadId == 0) {
+                LogPrintf("X25X: First hash=%s target=%s algo=%s\n",
+                          hash.ToString(), target.ToString(),
+                          x25x::GetAlgorithmInfo(m_algorithm).name);
+            }
+
+            // Check if meets target
+            if (UintToArith256(hash) <= targetValue) {
+                LogPrintf("X25X: Thread %d found valid block! nonce=%u hash=%s\n",
+                          threadId, nonce, hash.ToString());
+
+                m_stopMining = true;
+                m_telemetry.BlockFound();
+                block.nNonce = nonce;
 
-        // Debug logging for first hash
-        if (hashCount == 1 && threadId == 0) {
-            LogPrintf("X25X: First hash=%s target=%s algo=%s\n",
-                      hash.ToString(), target.ToString(),
-                      x25x::GetAlgorithmInfo(m_algorithm).name);
+                if (callback) {
+                    callback(block);
+                }
+                found = true;
+                break;
+            }
+
+            // Yield periodically; the thread already runs at the lowest priority,
+            // so sleeping here would only throttle the cheap algorithms
+            if ((nonce & 0xFF) == 0) {
+                std::this_thread::yield();
+            }
         }
+    }
 
-        // Check if meets target
-        if (UintToArith256(hash) <= UintToArith256(target)) {
-            LogPrintf("X25X: Thread %d found valid block! nonce=%u hash=%s\n",
-                      threadId, nonce, hash.ToString());
+    // Add remaining hashes
+    m_telemetry.AddHashes(threadId, hashCount & 0x3F);
 
-            m_stopMining = true;
+    LogPrintf("X25X: Thread %d stopped after %lu hashes\n", threadId, hashCount);
+}
 
-            if (callback) {
-                callback(block);
+void X25XMiner::GpuMineThread(CBlock block, uint256 target, BlockFoundCallback callback) {
+    LogPrintf("X25X: GPU thread started on %s\n", m_gpu->GetDeviceName());
+
+    // HashBlockHeader() hashes Ethash headers at height 0, so the GPU searches
+    // epoch 0 as well and agrees with the CPU verification below
+    static constexpr int ETHASH_EPOCH = 0;
+
+    std::optional<x25x::HeaderHasher> hasher;
+    arith_uint256 targetValue;
+    uint64_t jobId = 0;
+    // Wider than the nonce so the end of the range can be detected
+    uint64_t nextNonce = 0;
+    uint64_t hashCount = 0;
+    bool newWork = true;
+    opencl::GpuBatch batch;
+
+    while (!m_stopMining) {
+        if (!newWork) {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            if (m_pendingWork) {
+                block = std::move(m_pendingWork->block);
+                target = m_pendingWork->target;
+                callback = std::move(m_pendingWork->callback);
+                m_pendingWork.reset();
+                newWork = true;
+            }
+        }
+
+        if (newWork) {
+            newWork = false;
+            block.nVersion = x25x::SetBlockAlgorithm(block.nVersion, m_algorithm);
+            if (!m_gpu->SetJob(block, target, ETHASH_EPOCH)) {
+                LogPrintf("X25X: GPU could not take the block template\n");
+                break;
             }
+            hasher.emplace(block, m_algorithm);
+            targetValue = UintToArith256(target);
+            jobId = m_gpu->GetJobId();
+            nextNonce = 0;
+        }
+
+        // Keep the device busy while the oldest batch is collected
+        bool submitFailed = false;
+        while (m_gpu->GetPending() < opencl::GpuMiner::PIPELINE_DEPTH && nextNonce <= UINT32_MAX) {
+            const auto count = static_cast<uint32_t>(
+                std::min<uint64_t>(opencl::GpuMiner::BATCH_SIZE, uint64_t{UINT32_MAX} - nextNonce + 1));
+            if (!m_gpu->Submit(static_cast<uint32_t>(nextNonce), count)) {
+                submitFailed = true;
+                break;
+            }
+            nextNonce += count;
+        }
+        if (submitFailed) {
+            LogPrintf("X25X: GPU search failed\n");
             break;
         }
 
-        // Yield periodically
-        if ((nonce & 0xFF) == 0) {
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        if (m_gpu->GetPending() == 0) {
+            // The whole nonce range is searched; stop unless new work arrived
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            if (!m_pendingWork) {
+                m_stopMining = true;
+            }
+            continue;
         }
 
-        nonce++;
+        if (!m_gpu->Wait(batch)) {
+            LogPrintf("X25X: GPU search failed\n");
+            break;
+        }
+        hashCount += batch.count;
+        m_telemetry.AddHashes(0, batch.count);
+
+        // Batches of a replaced template are only counted
+        if (batch.jobId != jobId) continue;
+
+        for (const uint32_t nonce : batch.candidates) {
+            // The GPU only proposes nonces; the CPU hash is authoritative
+            const uint256 hash = hasher->Hash(nonce);
+            if (UintToArith256(hash) > targetValue) {
+                LogPrintf("X25X: GPU candidate nonce=%u failed CPU verification\n", nonce);
+                continue;
+            }
+
+            LogPrintf("X25X: GPU found valid block! nonce=%u hash=%s\n",
+                      nonce, hash.ToString());
+            {
+                std::lock_guard<std::mutex> lock(m_jobMutex);
+                m_stopMining = true;
+            }
+            m_telemetry.BlockFound();
+            block.nNonce = nonce;
+
+            if (callback) {
+                callback(block);
+            }
+            break;
+        }
     }
 
-    // Add remaining hashes
-    uint64_t remainingHashes = hashCount & 0x3F;
-    m_totalHashes += remainingHashes;
+    // Collect batches still in flight before the next job or Cleanup()
+    while (m_gpu->GetPending() > 0) {
+        m_gpu->Wait(batch);
+    }
+    {
+        // Later templates restart the search instead of being handed over
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stopMining = true;
+        m_pendingWork.reset();
+    }
 
-    LogPrintf("X25X: Thread %d stopped after %lu hashes\n", threadId, hashCount);
+    LogPrintf("X25X: GPU thread stopped after %lu hashes\n", hashCount);
 }
 
 void X25XMiner::StopMining() {
@@ -250,13 +421,9 @@ void X25XMiner::StopMining() {
 
     LogPrintf("X25X: Stopping mining...\n");
     m_stopMining = true;
-
-    // Save hashrate
-    if (m_miningStartTime > 0) {
-        int64_t elapsed = GetTime() - m_miningStartTime;
-        if (elapsed > 0) {
-            m_lastHashrate = static_cast<double>(m_totalHashes.load()) / elapsed;
-        }
+    if (m_gpu) {
+        // Abort a dataset build in progress
+        m_gpu->RequestStop();
     }
 
     for (auto& t : m_threads) {
@@ -265,28 +432,19 @@ void X25XMiner::StopMining() {
         }
     }
     m_threads.clear();
+    m_telemetry.Stop();
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_pendingWork.reset();
+    }
 
     m_mining = false;
     LogPrintf("X25X: Mining stopped\n");
 }
 
 double X25XMiner::GetHashrate() const {
-    if (!m_mining) {
-        return m_lastHashrate.load();
-    }
-
-    if (m_miningStartTime == 0) {
-        return 0.0;
-    }
-
-    int64_t elapsed = GetTime() - m_miningStartTime;
-    if (elapsed <= 0) {
-        return m_lastHashrate.load();
-    }
-
-    double hashrate = static_cast<double>(m_totalHashes.load()) / elapsed;
-    m_lastHashrate = hashrate;
-    return hashrate;
+    return m_telemetry.GetStats().hashrate;
 }
 
 double X25XMiner::GetHashrateForAlgorithm(x25x::Algorithm algo) const {
@@ -330,6 +488,14 @@ bool X25XMiner::IsAlgorithmAvailable(x25x::Algorithm algo) {
     }
 }
 
+bool X25XMiner::IsGpuAvailable(x25x::Algorithm algo) {
+    if (!opencl::GpuMiner::SupportsAlgorithm(algo)) {
+        return false;
+    }
+    auto& runtime = opencl::OpenCLRuntime::Instance();
+    return runtime.IsAvailable() && !runtime.GetGpuDevices().empty();
+}
+
 x25x::Algorithm X25XMiner::GetRecommendedAlgorithm() {
     // Detect hardware capabilities and recommend best algorithm
 
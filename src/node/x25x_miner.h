@@ -6,6 +6,7 @@
 #define BITCOIN_NODE_X25X_MINER_H
 
 #include <crypto/x25x/x25x.h>
+#include <node/mining_stats.h>
 #include <primitives/block.h>
 #include <uint256.h>
 
@@ -13,10 +14,15 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
 
+namespace opencl {
+class GpuMiner;
+} // namespace opencl
+
 namespace node {
 
 /**
@@ -31,11 +37,21 @@ namespace node {
  * - RandomX:  CPUs (Monero miners)
  * - Equihash: GPUs (ZCash miners)
  * - X11:      GPUs and ASICs (Dash miners)
+ *
+ * The GPU backend searches nonces with OpenCL kernels (SHA256d, kHeavyHash
+ * and Ethash) from a single host thread and verifies every candidate on the
+ * CPU. While it is mining, StartMining() hands the new template to the
+ * running search instead of restarting it.
  */
 class X25XMiner {
 public:
     using BlockFoundCallback = std::function<void(const CBlock& block)>;
 
+    enum class Backend {
+        CPU,
+        GPU,
+    };
+
     X25XMiner();
     ~X25XMiner();
 
@@ -47,9 +63,13 @@ public:
      * Initialize the miner for a specific algorithm
      *
      * @param algo The algorithm to use
+     * @param backend Whether to search nonces on the CPU or an OpenCL GPU
+     * @param gpuPlatform OpenCL platform index for the GPU backend
+     * @param gpuDevice OpenCL device index for the GPU backend
      * @return true if initialization successful
      */
-    bool Initialize(x25x::Algorithm algo);
+    bool Initialize(x25x::Algorithm algo, Backend backend = Backend::CPU,
+                    int gpuPlatform = 0, int gpuDevice = 0);
 
     /**
      * Set the algorithm to use for mining
@@ -61,12 +81,17 @@ public:
      */
     x25x::Algorithm GetAlgorithm() const { return m_algorithm; }
 
+    /**
+     * Get the currently selected backend
+     */
+    Backend GetBackend() const { return m_backend; }
+
     /**
      * Start mining with the specified block template and target
      *
      * @param block The block to mine
      * @param target The target hash (must be <= this value)
-     * @param numThreads Number of mining threads (0 = auto)
+     * @param numThreads Number of mining threads (0 = auto, ignored by the GPU backend)
      * @param callback Callback when valid block is found
      */
     void StartMining(const CBlock& block, const uint256& target,
@@ -90,7 +115,12 @@ public:
     /**
      * Get total hashes computed since mining started
      */
-    uint64_t GetTotalHashes() const { return m_totalHashes; }
+    uint64_t GetTotalHashes() const { return m_telemetry.GetTotalHashes(); }
+
+    /**
+     * Get a snapshot of the mining stats, without locking the mining threads
+     */
+    MiningStats GetStats() const { return m_telemetry.GetStats(); }
 
     /**
      * Get algorithm-specific hashrate
@@ -102,6 +132,11 @@ public:
      */
     static bool IsAlgorithmAvailable(x25x::Algorithm algo);
 
+    /**
+     * Check if an algorithm can be mined with the GPU backend on this system
+     */
+    static bool IsGpuAvailable(x25x::Algorithm algo);
+
     /**
      * Get recommended algorithm based on system hardware
      */
@@ -120,6 +155,11 @@ private:
                     uint32_t startNonce, uint32_t nonceRange,
                     BlockFoundCallback callback);
 
+    /**
+     * GPU mining thread function
+     */
+    void GpuMineThread(CBlock block, uint256 target, BlockFoundCallback callback);
+
     /**
      * Algorithm-specific hash function dispatcher
      */
@@ -128,18 +168,29 @@ private:
     // Current mining algorithm
     x25x::Algorithm m_algorithm{x25x::Algorithm::SHA256D};
 
+    // Nonce search backend
+    Backend m_backend{Backend::CPU};
+    int m_gpuPlatform{0};
+    int m_gpuDevice{0};
+    std::unique_ptr<opencl::GpuMiner> m_gpu;
+
     // Mining state
     std::atomic<bool> m_mining{false};
     std::atomic<bool> m_stopMining{false};
-    std::atomic<uint64_t> m_totalHashes{0};
+    MinerTelemetry m_telemetry;
 
     // Mining threads
     std::vector<std::thread> m_threads;
     mutable std::mutex m_mutex;
 
-    // Timing
-    int64_t m_miningStartTime{0};
-    mutable std::atomic<double> m_lastHashrate{0.0};
+    // Template handed to the running GPU search by StartMining()
+    struct GpuWork {
+        CBlock block;
+        uint256 target;
+        BlockFoundCallback callback;
+    };
+    std::mutex m_jobMutex;
+    std::optional<GpuWork> m_pendingWork;
 
     // Algorithm-specific contexts
     // These are initialized lazily when needed
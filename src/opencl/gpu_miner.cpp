@@ -0,0 +1,468 @@
+// Copyright (c) 2026 WATTx Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <opencl/gpu_miner.h>
+#include <opencl/mining_kernels.h>
+#include <crypto/common.h>
+#include <crypto/x25x/ethash_cache.h>
+#include <logging.h>
+#include <streams.h>
+#include <tinyformat.h>
+
+#include <ethash/ethash.h>
+#include <ethash/keccak.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace opencl {
+
+static_assert(sizeof(GpuJob) == (64 + 1 + 8 + 8 + 8 + 1) * 4, "GpuJob must match job_t");
+
+//! 512-bit Ethash dataset items generated per kernel launch
+static constexpr uint32_t DATASET_CHUNK = 1 << 16;
+
+GpuMiner::GpuMiner() : m_runtime(OpenCLRuntime::Instance()) {
+}
+
+GpuMiner::~GpuMiner() {
+    Cleanup();
+}
+
+bool GpuMiner::SupportsAlgorithm(x25x::Algorithm algo) {
+    switch (algo) {
+        case x25x::Algorithm::SHA256D:
+        case x25x::Algorithm::KHEAVYHASH:
+        case x25x::Algorithm::ETHASH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool GpuMiner::Initialize(int platformId, int deviceId, x25x::Algorithm algo) {
+    if (m_initialized) {
+        Cleanup();
+    }
+
+    if (!SupportsAlgorithm(algo)) {
+        LogPrintf("GpuMiner: No kernel for %s\n", x25x::GetAlgorithmInfo(algo).name);
+        return false;
+    }
+
+    if (!m_runtime.IsAvailable()) {
+        LogPrintf("GpuMiner: OpenCL not available\n");
+        return false;
+    }
+
+    // Initialize OpenCL context
+    if (!m_runtime.IsInitialized()) {
+        if (!m_runtime.Initialize(platformId, deviceId)) {
+            LogPrintf("GpuMiner: Failed to initialize OpenCL\n");
+            return false;
+        }
+    }
+
+    m_algorithm = algo;
+
+    if (!CompileKernels()) {
+        Cleanup();
+        return false;
+    }
+
+    // Create GPU buffers
+    cl_int err = CL_SUCCESS;
+    auto ctx = m_runtime.GetContext();
+
+    for (auto& buffer : m_jobBuffers) {
+        buffer = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
+            ctx, CL_MEM_READ_WRITE, sizeof(GpuJob), nullptr, &err);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuMiner: Failed to create job buffer (err=%d)\n", err);
+            Cleanup();
+            return false;
+        }
+    }
+
+    // Result buffers: count followed by up to MAX_RESULTS nonces
+    for (auto& slot : m_slots) {
+        slot.buffer = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
+            ctx, CL_MEM_READ_WRITE, sizeof(slot.results), nullptr, &err);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuMiner: Failed to create result buffer (err=%d)\n", err);
+            Cleanup();
+            return false;
+        }
+    }
+
+    m_initialized = true;
+    LogPrintf("GpuMiner: Initialized %s search on %s\n",
+              x25x::GetAlgorithmInfo(algo).name, GetDeviceName());
+    return true;
+}
+
+bool GpuMiner::CompileKernels() {
+    cl_int err = CL_SUCCESS;
+    auto ctx = m_runtime.GetContext();
+    auto dev = m_runtime.GetDevice();
+
+    // Create program
+    const char* source = MINING_KERNEL_SOURCE;
+    size_t sourceLen = strlen(source);
+
+    m_program = (cl_program)(intptr_t)m_runtime.clCreateProgramWithSource(
+        ctx, 1, &source, &sourceLen, &err);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to create program (err=%d)\n", err);
+        return false;
+    }
+
+    // Build program; the layout constants come from this side
+    const std::string options = strprintf("-DMAX_HEADER_BYTES=%u -DNONCE_OFFSET=%u -DMAX_RESULTS=%u",
+                                          MAX_HEADER_BYTES, x25x::HeaderHasher::NONCE_OFFSET, MAX_RESULTS);
+    err = (cl_int)(intptr_t)m_runtime.clBuildProgram(
+        m_program, 1, &dev, options.c_str(), nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        // Get build log
+        size_t logSize = 0;
+        m_runtime.clGetProgramBuildInfo(m_program, dev, 0x1183 /*CL_PROGRAM_BUILD_LOG*/,
+                                        0, nullptr, &logSize);
+        if (logSize > 0) {
+            std::vector<char> log(logSize);
+            m_runtime.clGetProgramBuildInfo(m_program, dev, 0x1183,
+                                           logSize, log.data(), nullptr);
+            LogPrintf("GpuMiner: Build failed: %s\n", log.data());
+        }
+        return false;
+    }
+
+    // Create kernels
+    const char* searchName = nullptr;
+    switch (m_algorithm) {
+        case x25x::Algorithm::SHA256D: searchName = "search_sha256d"; break;
+        case x25x::Algorithm::KHEAVYHASH: searchName = "search_kheavyhash"; break;
+        case x25x::Algorithm::ETHASH: searchName = "search_ethash"; break;
+        default: return false;
+    }
+
+    m_searchKernel = (cl_kernel)(intptr_t)m_runtime.clCreateKernel(
+        m_program, searchName, &err);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to create %s kernel (err=%d)\n", searchName, err);
+        return false;
+    }
+
+    if (m_algorithm == x25x::Algorithm::SHA256D) {
+        m_prepareKernel = (cl_kernel)(intptr_t)m_runtime.clCreateKernel(
+            m_program, "prepare_sha256d", &err);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuMiner: Failed to create midstate kernel (err=%d)\n", err);
+            return false;
+        }
+    }
+
+    if (m_algorithm == x25x::Algorithm::ETHASH) {
+        m_datasetKernel = (cl_kernel)(intptr_t)m_runtime.clCreateKernel(
+            m_program, "ethash_dag", &err);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuMiner: Failed to create dataset kernel (err=%d)\n", err);
+            return false;
+        }
+    }
+
+    LogPrintf("GpuMiner: Kernels compiled successfully\n");
+    return true;
+}
+
+bool GpuMiner::BuildDataset(int epoch) {
+    // Batches in flight may still read the old dataset
+    m_runtime.clFinish(m_runtime.GetQueue());
+    ReleaseDataset();
+
+    std::shared_ptr<const ethash_epoch_context> context = x25x::GetEthashCache().GetContext(epoch);
+    if (!context) {
+        LogPrintf("GpuMiner: Failed to get Ethash context for epoch %d\n", epoch);
+        return false;
+    }
+
+    const uint64_t datasetSize = static_cast<uint64_t>(context->full_dataset_num_items) * ETHASH_FULL_DATASET_ITEM_SIZE;
+    const size_t cacheSize = static_cast<size_t>(context->light_cache_num_items) * ETHASH_LIGHT_CACHE_ITEM_SIZE;
+
+    // The dataset has to fit in one allocation
+    auto dev = m_runtime.GetDevice();
+    uint64_t maxAlloc = 0;
+    m_runtime.clGetDeviceInfo(dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAlloc), &maxAlloc, nullptr);
+    if (maxAlloc < datasetSize) {
+        LogPrintf("GpuMiner: Ethash epoch %d dataset needs %u MB, device allows %u MB per buffer\n",
+                  epoch, datasetSize >> 20, maxAlloc >> 20);
+        return false;
+    }
+
+    cl_int err = CL_SUCCESS;
+    auto ctx = m_runtime.GetContext();
+    auto queue = m_runtime.GetQueue();
+
+    cl_mem cacheBuffer = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
+        ctx, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, cacheSize,
+        const_cast<ethash_hash512*>(context->light_cache), &err);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to create light cache buffer (err=%d)\n", err);
+        return false;
+    }
+
+    m_datasetBuffer = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
+        ctx, CL_MEM_READ_WRITE, datasetSize, nullptr, &err);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to create dataset buffer (err=%d)\n", err);
+        m_runtime.clReleaseMemObject(cacheBuffer);
+        m_datasetBuffer = nullptr;
+        return false;
+    }
+
+    LogPrintf("GpuMiner: Generating Ethash dataset for epoch %d (%u MB)...\n", epoch, datasetSize >> 20);
+
+    // The kernel works in 512-bit items, two per 1024-bit dataset item
+    const uint32_t cacheItems = static_cast<uint32_t>(context->light_cache_num_items);
+    const uint32_t items = static_cast<uint32_t>(context->full_dataset_num_items) * 2;
+    m_runtime.clSetKernelArg(m_datasetKernel, 0, sizeof(cl_mem), &cacheBuffer);
+    m_runtime.clSetKernelArg(m_datasetKernel, 1, sizeof(uint32_t), &cacheItems);
+    m_runtime.clSetKernelArg(m_datasetKernel, 3, sizeof(cl_mem), &m_datasetBuffer);
+
+    bool ok = true;
+    for (uint32_t first = 0; first < items && ok; first += DATASET_CHUNK) {
+        // Check stop between chunks so StopMining() does not wait for the whole dataset
+        if (m_stopRequested) {
+            ok = false;
+            break;
+        }
+        size_t globalSize = std::min(DATASET_CHUNK, items - first);
+        m_runtime.clSetKernelArg(m_datasetKernel, 2, sizeof(uint32_t), &first);
+        err = (cl_int)(intptr_t)m_runtime.clEnqueueNDRangeKernel(
+            queue, m_datasetKernel, 1, nullptr, &globalSize, nullptr,
+            0, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuMiner: Failed to launch dataset kernel (err=%d)\n", err);
+            ok = false;
+        }
+        m_runtime.clFinish(queue);
+    }
+
+    m_runtime.clReleaseMemObject(cacheBuffer);
+    if (!ok) {
+        ReleaseDataset();
+        return false;
+    }
+
+    m_datasetEpoch = epoch;
+    m_datasetItems = static_cast<uint32_t>(context->full_dataset_num_items);
+    LogPrintf("GpuMiner: Ethash dataset ready\n");
+    return true;
+}
+
+void GpuMiner::ReleaseDataset() {
+    if (m_datasetBuffer) {
+        m_runtime.clReleaseMemObject(m_datasetBuffer);
+        m_datasetBuffer = nullptr;
+    }
+    m_datasetEpoch = -1;
+    m_datasetItems = 0;
+}
+
+bool GpuMiner::SetJob(const CBlockHeader& header, const uint256& target, int ethashEpoch) {
+    if (!m_initialized) return false;
+
+    DataStream ss{};
+    ss << header;
+    if (ss.size() > MAX_HEADER_BYTES) {
+        LogPrintf("GpuMiner: Header of %u bytes is too long for the GPU kernels\n", ss.size());
+        return false;
+    }
+
+    if (m_algorithm == x25x::Algorithm::ETHASH && m_datasetEpoch != ethashEpoch) {
+        if (!BuildDataset(ethashEpoch)) return false;
+    }
+
+    auto queue = m_runtime.GetQueue();
+    const int next = m_active ^ 1;
+
+    // The previous upload from this staging copy is only known to be done
+    // once a batch queued after it has completed
+    if (m_completed < m_stagingFence[next]) {
+        m_runtime.clFinish(queue);
+    }
+
+    GpuJob& job = m_staging[next];
+    job = GpuJob{};
+    std::memcpy(job.header, ss.data(), ss.size());
+    job.length = static_cast<uint32_t>(ss.size());
+    for (int i = 0; i < 8; i++) {
+        job.target[i] = ReadLE32(target.begin() + i * 4);
+    }
+    if (m_algorithm == x25x::Algorithm::ETHASH) {
+        // Keccak-256 of the header without the nonce, as hash::Ethash()
+        const ethash_hash256 sealHash = ethash_keccak256(
+            reinterpret_cast<const uint8_t*>(ss.data()), x25x::HeaderHasher::NONCE_OFFSET);
+        for (int i = 0; i < 8; i++) {
+            job.sealHash[i] = ReadLE32(sealHash.bytes + i * 4);
+        }
+        job.datasetItems = m_datasetItems;
+    }
+
+    // Queue the upload without waiting; the batches in flight read the other buffer
+    cl_int err = (cl_int)(intptr_t)m_runtime.clEnqueueWriteBuffer(
+        queue, m_jobBuffers[next], 0 /*non-blocking*/, 0, sizeof(GpuJob),
+        &job, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to upload job (err=%d)\n", err);
+        return false;
+    }
+
+    if (m_prepareKernel) {
+        // The SHA-256 midstate of the first 64 bytes is computed once per job
+        size_t globalSize = 1;
+        m_runtime.clSetKernelArg(m_prepareKernel, 0, sizeof(cl_mem), &m_jobBuffers[next]);
+        err = (cl_int)(intptr_t)m_runtime.clEnqueueNDRangeKernel(
+            queue, m_prepareKernel, 1, nullptr, &globalSize, nullptr,
+            0, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuMiner: Failed to launch midstate kernel (err=%d)\n", err);
+            return false;
+        }
+    }
+
+    m_runtime.clFlush(queue);
+    m_stagingFence[next] = m_submitted + 1;
+    m_active = next;
+    m_jobId++;
+    return true;
+}
+
+bool GpuMiner::Submit(uint32_t firstNonce, uint32_t count) {
+    if (!m_initialized || m_jobId == 0 || count == 0 || m_pending == PIPELINE_DEPTH) return false;
+
+    auto queue = m_runtime.GetQueue();
+    Slot& slot = m_slots[(m_head + m_pending) % PIPELINE_DEPTH];
+    cl_int err;
+
+    // Reset the result count
+    err = (cl_int)(intptr_t)m_runtime.clEnqueueWriteBuffer(
+        queue, slot.buffer, 0 /*non-blocking*/, 0, sizeof(m_zero),
+        &m_zero, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to reset results (err=%d)\n", err);
+        return false;
+    }
+
+    // Set kernel arguments; their values are captured at enqueue time
+    m_runtime.clSetKernelArg(m_searchKernel, 0, sizeof(cl_mem), &m_jobBuffers[m_active]);
+    m_runtime.clSetKernelArg(m_searchKernel, 1, sizeof(uint32_t), &firstNonce);
+    m_runtime.clSetKernelArg(m_searchKernel, 2, sizeof(cl_mem), &slot.buffer);
+    if (m_algorithm == x25x::Algorithm::ETHASH) {
+        m_runtime.clSetKernelArg(m_searchKernel, 3, sizeof(cl_mem), &m_datasetBuffer);
+    }
+
+    // Launch kernel - one work item per nonce
+    size_t globalSize = count;
+    err = (cl_int)(intptr_t)m_runtime.clEnqueueNDRangeKernel(
+        queue, m_searchKernel, 1, nullptr, &globalSize, nullptr,
+        0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to launch search kernel (err=%d)\n", err);
+        return false;
+    }
+
+    // Read back results (non-blocking); Wait() waits on this read's event
+    err = (cl_int)(intptr_t)m_runtime.clEnqueueReadBuffer(
+        queue, slot.buffer, 0 /*non-blocking*/, 0, sizeof(slot.results),
+        slot.results, 0, nullptr, &slot.event);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Failed to read results (err=%d)\n", err);
+        m_runtime.clFinish(queue);
+        return false;
+    }
+    m_runtime.clFlush(queue);
+
+    slot.jobId = m_jobId;
+    slot.firstNonce = firstNonce;
+    slot.count = count;
+    m_pending++;
+    m_submitted++;
+    return true;
+}
+
+bool GpuMiner::Wait(GpuBatch& batch) {
+    batch.candidates.clear();
+    if (m_pending == 0) return false;
+
+    Slot& slot = m_slots[m_head];
+    cl_int err = (cl_int)(intptr_t)m_runtime.clWaitForEvents(1, &slot.event);
+    m_runtime.clReleaseEvent(slot.event);
+    slot.event = nullptr;
+    m_head = (m_head + 1) % PIPELINE_DEPTH;
+    m_pending--;
+    m_completed++;
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuMiner: Search batch failed (err=%d)\n", err);
+        return false;
+    }
+
+    batch.jobId = slot.jobId;
+    batch.firstNonce = slot.firstNonce;
+    batch.count = slot.count;
+    const uint32_t found = std::min(slot.results[0], MAX_RESULTS);
+    batch.candidates.assign(slot.results + 1, slot.results + 1 + found);
+    return true;
+}
+
+void GpuMiner::Cleanup() {
+    if (m_runtime.IsInitialized()) {
+        m_runtime.clFinish(m_runtime.GetQueue());
+    }
+    for (auto& slot : m_slots) {
+        if (slot.event) {
+            m_runtime.clReleaseEvent(slot.event);
+            slot.event = nullptr;
+        }
+        if (slot.buffer) {
+            m_runtime.clReleaseMemObject(slot.buffer);
+            slot.buffer = nullptr;
+        }
+    }
+    m_head = 0;
+    m_pending = 0;
+    ReleaseDataset();
+    for (auto& buffer : m_jobBuffers) {
+        if (buffer) {
+            m_runtime.clReleaseMemObject(buffer);
+            buffer = nullptr;
+        }
+    }
+    if (m_searchKernel) {
+        m_runtime.clReleaseKernel(m_searchKernel);
+        m_searchKernel = nullptr;
+    }
+    if (m_prepareKernel) {
+        m_runtime.clReleaseKernel(m_prepareKernel);
+        m_prepareKernel = nullptr;
+    }
+    if (m_datasetKernel) {
+        m_runtime.clReleaseKernel(m_datasetKernel);
+        m_datasetKernel = nullptr;
+    }
+    if (m_program) {
+        m_runtime.clReleaseProgram(m_program);
+        m_program = nullptr;
+    }
+
+    m_initialized = false;
+}
+
+std::string GpuMiner::GetDeviceName() const {
+    if (m_runtime.IsInitialized()) {
+        return m_runtime.GetCurrentDevice().name;
+    }
+    return "Unknown";
+}
+
+} // namespace opencl
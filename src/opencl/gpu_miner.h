@@ -0,0 +1,201 @@
+// Copyright (c) 2026 WATTx Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_OPENCL_GPU_MINER_H
+#define WATTX_OPENCL_GPU_MINER_H
+
+#include <opencl/opencl_runtime.h>
+#include <crypto/x25x/x25x.h>
+#include <primitives/block.h>
+#include <uint256.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace opencl {
+
+/**
+ * Mining job as laid out in GPU memory (job_t in mining_kernels.h)
+ */
+struct GpuJob {
+    uint32_t header[64];
+    uint32_t length;
+    uint32_t target[8];
+    uint32_t midstate[8];
+    uint32_t sealHash[8];
+    uint32_t datasetItems;
+};
+
+/**
+ * Result of one GPU search batch
+ */
+struct GpuBatch {
+    //! GpuMiner::GetJobId() of the job the batch searched
+    uint64_t jobId{0};
+    uint32_t firstNonce{0};
+    uint32_t count{0};
+    //! Nonces whose GPU hash met the target
+    std::vector<uint32_t> candidates;
+};
+
+/**
+ * GPU nonce search for the X25X miner using OpenCL
+ *
+ * Kernels exist for SHA256d, kHeavyHash and Ethash. Each batch hashes a
+ * range of nonces on the device and reports the nonces whose hash met the
+ * job target; callers re-check them on the CPU before submitting.
+ *
+ * Up to PIPELINE_DEPTH batches are in flight, so the device does not idle
+ * while the host collects results. Jobs are double-buffered: SetJob()
+ * queues the upload into the buffer the batches in flight are not reading,
+ * without waiting for them, and later batches use the new job. For Ethash
+ * the epoch's full dataset is generated on the device from the light cache
+ * the first time a job for that epoch is set.
+ */
+class GpuMiner {
+public:
+    //! Nonces hashed per kernel launch
+    static constexpr uint32_t BATCH_SIZE = 1 << 20;
+    //! Batches queued on the device at once
+    static constexpr size_t PIPELINE_DEPTH = 2;
+    //! Candidate nonces one batch can report
+    static constexpr uint32_t MAX_RESULTS = 15;
+    //! Longest serialized header the kernels accept
+    static constexpr size_t MAX_HEADER_BYTES = sizeof(GpuJob::header);
+
+    GpuMiner();
+    ~GpuMiner();
+
+    GpuMiner(const GpuMiner&) = delete;
+    GpuMiner& operator=(const GpuMiner&) = delete;
+
+    /**
+     * Check whether there is a GPU kernel for an algorithm
+     */
+    static bool SupportsAlgorithm(x25x::Algorithm algo);
+
+    /**
+     * Initialize the GPU miner
+     * @param platformId OpenCL platform index
+     * @param deviceId OpenCL device index
+     * @param algo Algorithm to search with
+     * @return true if initialized successfully
+     */
+    bool Initialize(int platformId, int deviceId, x25x::Algorithm algo);
+
+    /**
+     * Check if initialized
+     */
+    bool IsInitialized() const { return m_initialized; }
+
+    /**
+     * Get the algorithm the kernels were built for
+     */
+    x25x::Algorithm GetAlgorithm() const { return m_algorithm; }
+
+    /**
+     * Upload a new job for the batches submitted after this call
+     * @param header Header to mine, with the algorithm set in nVersion
+     * @param target The target hash (must be <= this value)
+     * @param ethashEpoch Ethash epoch whose dataset the job needs
+     * @return false if the header is too long or the upload failed
+     */
+    bool SetJob(const CBlockHeader& header, const uint256& target, int ethashEpoch = 0);
+
+    /**
+     * Get the id of the job set last
+     */
+    uint64_t GetJobId() const { return m_jobId; }
+
+    /**
+     * Queue a search of nonces firstNonce .. firstNonce + count - 1 of the
+     * current job; fails if PIPELINE_DEPTH batches are already in flight
+     */
+    bool Submit(uint32_t firstNonce, uint32_t count);
+
+    /**
+     * Wait for the oldest batch in flight
+     * @return false if there was none or it failed
+     */
+    bool Wait(GpuBatch& batch);
+
+    /**
+     * Get the number of batches in flight
+     */
+    size_t GetPending() const { return m_pending; }
+
+    /**
+     * Cleanup GPU resources
+     */
+    void Cleanup();
+
+    /**
+     * Get device name
+     */
+    std::string GetDeviceName() const;
+
+    /**
+     * Request stop - makes Ethash dataset generation return early
+     */
+    void RequestStop() { m_stopRequested = true; }
+
+    /**
+     * Reset stop flag
+     */
+    void ResetStop() { m_stopRequested = false; }
+
+private:
+    //! One batch's result buffer and its host copy
+    struct Slot {
+        cl_mem buffer{nullptr};
+        cl_event event{nullptr};
+        uint32_t results[1 + MAX_RESULTS];
+        uint64_t jobId{0};
+        uint32_t firstNonce{0};
+        uint32_t count{0};
+    };
+
+    bool CompileKernels();
+    bool BuildDataset(int epoch);
+    void ReleaseDataset();
+
+    OpenCLRuntime& m_runtime;
+    bool m_initialized{false};
+    std::atomic<bool> m_stopRequested{false};
+    x25x::Algorithm m_algorithm{x25x::Algorithm::SHA256D};
+
+    // OpenCL objects
+    cl_program m_program{nullptr};
+    cl_kernel m_searchKernel{nullptr};
+    cl_kernel m_prepareKernel{nullptr};
+    cl_kernel m_datasetKernel{nullptr};
+
+    // Job buffers; m_active is the one new batches read
+    GpuJob m_staging[2];
+    cl_mem m_jobBuffers[2]{nullptr, nullptr};
+    //! Batches that must complete before m_staging[i] may be reused
+    uint64_t m_stagingFence[2]{0, 0};
+    int m_active{0};
+    uint64_t m_jobId{0};
+
+    // Batches in flight, oldest at m_head
+    Slot m_slots[PIPELINE_DEPTH];
+    size_t m_head{0};
+    size_t m_pending{0};
+    uint64_t m_submitted{0};
+    uint64_t m_completed{0};
+    //! Source of the result count reset
+    const uint32_t m_zero{0};
+
+    // Ethash full dataset
+    cl_mem m_datasetBuffer{nullptr};
+    int m_datasetEpoch{-1};
+    uint32_t m_datasetItems{0};
+};
+
+} // namespace opencl
+
+#endif // WATTX_OPENCL_GPU_MINER_H
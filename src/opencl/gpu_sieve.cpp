@@ -5,11 +5,26 @@
 #include <opencl/gpu_sieve.h>
 #include <opencl/sieve_kernel.h>
 #include <logging.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 
 namespace opencl {
 
+namespace {
+
+//! Counters ahead of the candidate pairs in a segment's results
+constexpr size_t RESULT_HEADER_WORDS = 4;
+constexpr size_t RESULT_BYTES = (RESULT_HEADER_WORDS + 2 * GpuSieve::MAX_GAP_CANDIDATES) * sizeof(uint32_t);
+
+uint64_t ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
 GpuSieve::GpuSieve() : m_runtime(OpenCLRuntime::Instance()) {
 }
 
@@ -28,21 +43,24 @@ bool GpuSieve::Initialize(int platformId, int deviceId, size_t sieveSize,
         return false;
     }
 
-    // Initialize OpenCL context
-    if (!m_runtime.IsInitialized()) {
-        if (!m_runtime.Initialize(platformId, deviceId)) {
-            LogPrintf("GpuSieve: Failed to initialize OpenCL\n");
-            return false;
-        }
+    // Each sieve has a context and queue of its own, so that sieves on
+    // different devices run independently
+    if (!m_runtime.CreateDeviceContext(platformId, deviceId, m_device)) {
+        LogPrintf("GpuSieve: Failed to initialize OpenCL\n");
+        return false;
     }
 
     // Use smaller sieve for GPU to allow faster stop response
-    // Max 4MB sieve for GPU (vs 32MB default for CPU)
-    m_sieveSize = std::min(sieveSize, (size_t)(4 * 1024 * 1024));
+    // Max 4MB sieve for GPU (vs 32MB default for CPU), whole 32-bit words
+    m_sieveSize = std::min(sieveSize, (size_t)(4 * 1024 * 1024)) & ~size_t{3};
+    if (m_sieveSize == 0) {
+        LogPrintf("GpuSieve: Sieve size too small\n");
+        return false;
+    }
     m_numPrimes = primes.size();
 
     // Get max work group size
-    auto& dev = m_runtime.GetCurrentDevice();
+    auto& dev = m_device.info;
     m_maxWorkGroupSize = dev.maxWorkGroupSize > 0 ? dev.maxWorkGroupSize : 256;
     if (m_maxWorkGroupSize > 256) m_maxWorkGroupSize = 256;
 
@@ -53,7 +71,7 @@ bool GpuSieve::Initialize(int platformId, int deviceId, size_t sieveSize,
 
     // Create GPU buffers
     cl_int err;
-    auto ctx = m_runtime.GetContext();
+    auto ctx = m_device.context;
 
     // Sieve buffer
     m_sieveBuffer = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
@@ -91,8 +109,8 @@ bool GpuSieve::Initialize(int platformId, int deviceId, size_t sieveSize,
 
 bool GpuSieve::CompileKernel() {
     cl_int err;
-    auto ctx = m_runtime.GetContext();
-    auto dev = m_runtime.GetDevice();
+    auto ctx = m_device.context;
+    auto dev = m_device.device;
 
     // Create program
     const char* source = SIEVE_KERNEL_SOURCE;
@@ -144,46 +162,55 @@ bool GpuSieve::CompileKernel() {
         return false;
     }
 
+    m_clearKernel = (cl_kernel)(intptr_t)m_runtime.clCreateKernel(
+        m_program, "clear_sieve", &err);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuSieve: Failed to create clear kernel (err=%d)\n", err);
+        return false;
+    }
+
+    m_compactKernel = (cl_kernel)(intptr_t)m_runtime.clCreateKernel(
+        m_program, "compact_gaps", &err);
+    if (err != CL_SUCCESS) {
+        LogPrintf("GpuSieve: Failed to create compaction kernel (err=%d)\n", err);
+        return false;
+    }
+
     LogPrintf("GpuSieve: Kernels compiled successfully\n");
     return true;
 }
 
-bool GpuSieve::SieveSegment(uint64_t segmentStart, uint8_t* hostSieve) {
-    if (!m_initialized) return false;
-    if (m_stopRequested) return false;
-
-    auto queue = m_runtime.GetQueue();
+bool GpuSieve::EnqueueSieve(uint64_t segmentStart) {
+    auto queue = m_device.queue;
     cl_int err;
 
-    // Clear sieve buffer on GPU (non-blocking)
-    std::vector<uint8_t> zeros(m_sieveSize, 0);
-    err = (cl_int)(intptr_t)m_runtime.clEnqueueWriteBuffer(
-        queue, m_sieveBuffer, 0 /*non-blocking*/, 0, m_sieveSize,
-        zeros.data(), 0, nullptr, nullptr);
+    // Clear sieve buffer on the device rather than uploading zeros
+    uint32_t words = (uint32_t)(m_sieveSize / 4);
+    m_runtime.clSetKernelArg(m_clearKernel, 0, sizeof(cl_mem), &m_sieveBuffer);
+    m_runtime.clSetKernelArg(m_clearKernel, 1, sizeof(uint32_t), &words);
+
+    size_t localSize = m_maxWorkGroupSize;
+    size_t clearSize = ((words + localSize - 1) / localSize) * localSize;
+    err = (cl_int)(intptr_t)m_runtime.clEnqueueNDRangeKernel(
+        queue, m_clearKernel, 1, nullptr, &clearSize, &localSize,
+        0, nullptr, nullptr);
     if (err != CL_SUCCESS) {
         LogPrintf("GpuSieve: Failed to clear sieve (err=%d)\n", err);
         return false;
     }
 
-    // Check stop before kernel launch
-    if (m_stopRequested) {
-        m_runtime.clFinish(queue);
-        return false;
-    }
-
     // Set kernel arguments
-    cl_uint sieveSizeArg = (cl_uint)m_sieveSize;
-    cl_uint numPrimesArg = (cl_uint)std::min(m_numPrimes, (size_t)10000);  // Limit primes for faster response
+    uint32_t sieveSizeArg = (uint32_t)m_sieveSize;
+    uint32_t numPrimesArg = (uint32_t)std::min(m_numPrimes, (size_t)10000);  // Limit primes for faster response
 
     m_runtime.clSetKernelArg(m_sieveKernel, 0, sizeof(cl_mem), &m_sieveBuffer);
     m_runtime.clSetKernelArg(m_sieveKernel, 1, sizeof(cl_mem), &m_primesBuffer);
     m_runtime.clSetKernelArg(m_sieveKernel, 2, sizeof(uint64_t), &segmentStart);
-    m_runtime.clSetKernelArg(m_sieveKernel, 3, sizeof(cl_uint), &sieveSizeArg);
-    m_runtime.clSetKernelArg(m_sieveKernel, 4, sizeof(cl_uint), &numPrimesArg);
+    m_runtime.clSetKernelArg(m_sieveKernel, 3, sizeof(uint32_t), &sieveSizeArg);
+    m_runtime.clSetKernelArg(m_sieveKernel, 4, sizeof(uint32_t), &numPrimesArg);
 
     // Launch kernel - one work item per small prime
-    size_t globalSize = ((numPrimesArg + m_maxWorkGroupSize - 1) / m_maxWorkGroupSize) * m_maxWorkGroupSize;
-    size_t localSize = m_maxWorkGroupSize;
+    size_t globalSize = ((numPrimesArg + localSize - 1) / localSize) * localSize;
 
     err = (cl_int)(intptr_t)m_runtime.clEnqueueNDRangeKernel(
         queue, m_sieveKernel, 1, nullptr, &globalSize, &localSize,
@@ -192,6 +219,18 @@ bool GpuSieve::SieveSegment(uint64_t segmentStart, uint8_t* hostSieve) {
         LogPrintf("GpuSieve: Failed to launch sieve kernel (err=%d)\n", err);
         return false;
     }
+    return true;
+}
+
+bool GpuSieve::SieveSegment(uint64_t segmentStart, uint8_t* hostSieve) {
+    if (!m_initialized) return false;
+    if (m_stopRequested) return false;
+
+    auto queue = m_device.queue;
+    if (!EnqueueSieve(segmentStart)) {
+        m_runtime.clFinish(queue);
+        return false;
+    }
 
     // Wait for completion (required before reading)
     m_runtime.clFinish(queue);
@@ -202,7 +241,7 @@ bool GpuSieve::SieveSegment(uint64_t segmentStart, uint8_t* hostSieve) {
     }
 
     // Read back sieve to host (non-blocking)
-    err = (cl_int)(intptr_t)m_runtime.clEnqueueReadBuffer(
+    cl_int err = (cl_int)(intptr_t)m_runtime.clEnqueueReadBuffer(
         queue, m_sieveBuffer, 0 /*non-blocking*/, 0, m_sieveSize,
         hostSieve, 0, nullptr, nullptr);
     if (err != CL_SUCCESS) {
@@ -266,7 +305,297 @@ uint32_t GpuSieve::FindGaps(const uint8_t* hostSieve, uint32_t shift,
     return validGap;
 }
 
+bool GpuSieve::CreatePipelineBuffers() {
+    cl_int err;
+    auto ctx = m_device.context;
+    auto queue = m_device.queue;
+
+    for (PipelineSlot& slot : m_slots) {
+        slot.deviceResults = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
+            ctx, CL_MEM_READ_WRITE, RESULT_BYTES, nullptr, &err);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuSieve: Failed to create result buffer (err=%d)\n", err);
+            return false;
+        }
+
+        // Pinned host memory, mapped for the life of the pipeline
+        slot.pinnedResults = (cl_mem)(intptr_t)m_runtime.clCreateBuffer(
+            ctx, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, RESULT_BYTES, nullptr, &err);
+        if (err != CL_SUCCESS) {
+            LogPrintf("GpuSieve: Failed to create pinned buffer (err=%d)\n", err);
+            return false;
+        }
+        slot.hostResults = (uint32_t*)m_runtime.clEnqueueMapBuffer(
+            queue, slot.pinnedResults, 1 /*blocking*/, CL_MAP_READ | CL_MAP_WRITE,
+            0, RESULT_BYTES, 0, nullptr, nullptr, &err);
+        if (err != CL_SUCCESS || !slot.hostResults) {
+            LogPrintf("GpuSieve: Failed to map pinned buffer (err=%d)\n", err);
+            slot.hostResults = nullptr;
+            return false;
+        }
+    }
+    return true;
+}
+
+void GpuSieve::ReleasePipelineBuffers() {
+    auto queue = m_device.queue;
+    for (PipelineSlot& slot : m_slots) {
+        if (slot.event) {
+            m_runtime.clWaitForEvents(1, &slot.event);
+            m_runtime.clReleaseEvent(slot.event);
+            slot.event = nullptr;
+        }
+        if (slot.hostResults) {
+            m_runtime.clEnqueueUnmapMemObject(queue, slot.pinnedResults, slot.hostResults,
+                                              0, nullptr, nullptr);
+            slot.hostResults = nullptr;
+        }
+        if (slot.pinnedResults) {
+            m_runtime.clReleaseMemObject(slot.pinnedResults);
+            slot.pinnedResults = nullptr;
+        }
+        if (slot.deviceResults) {
+            m_runtime.clReleaseMemObject(slot.deviceResults);
+            slot.deviceResults = nullptr;
+        }
+    }
+    if (queue) m_runtime.clFinish(queue);
+}
+
+bool GpuSieve::StartPipeline(uint32_t shift, double targetMerit, GapCallback callback) {
+    if (!m_initialized) return false;
+    StopPipeline();
+
+    if (!CreatePipelineBuffers()) {
+        ReleasePipelineBuffers();
+        return false;
+    }
+
+    m_shift = shift;
+    m_targetMerit = targetMerit;
+    m_gapCallback = std::move(callback);
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats = PipelineStats{};
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        m_freeSlots.clear();
+        m_queuedSlots.clear();
+        for (size_t i = 0; i < PIPELINE_BUFFERS; ++i) m_freeSlots.push_back(i);
+        m_pipelineStopping = false;
+        m_pipelineRunning = true;
+    }
+    m_scanThread = std::thread(&GpuSieve::ScanThread, this);
+
+    LogPrintf("GpuSieve: Pipeline started with %zu buffers\n", PIPELINE_BUFFERS);
+    return true;
+}
+
+bool GpuSieve::QueueSegment(uint64_t segmentStart) {
+    size_t index;
+    {
+        std::unique_lock<std::mutex> lock(m_pipelineMutex);
+        if (!m_pipelineRunning || m_pipelineStopping) return false;
+
+        // RequestStop() does not notify, so poll it while waiting
+        const auto waitStart = std::chrono::steady_clock::now();
+        while (m_freeSlots.empty() && !m_stopRequested && !m_pipelineStopping) {
+            m_pipelineCv.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        const uint64_t stall = ElapsedUs(waitStart);
+        {
+            std::lock_guard<std::mutex> statsLock(m_statsMutex);
+            m_stats.stallUs += stall;
+        }
+        if (m_stopRequested || m_pipelineStopping) return false;
+
+        index = m_freeSlots.front();
+        m_freeSlots.pop_front();
+    }
+
+    const auto queueStart = std::chrono::steady_clock::now();
+    PipelineSlot& slot = m_slots[index];
+    slot.segmentStart = segmentStart;
+
+    auto queue = m_device.queue;
+    uint32_t words = (uint32_t)(m_sieveSize / 4);
+    float lnBase = (float)((double)m_shift * std::log(2.0));
+    float minMerit = (float)(m_targetMerit * 0.99);
+    uint32_t maxCandidates = MAX_GAP_CANDIDATES;
+
+    // The in-order queue runs the segments in flight one after another, so
+    // they share the device sieve; only the results are per slot
+    bool ok = EnqueueSieve(segmentStart);
+    if (ok) {
+        cl_int err = (cl_int)(intptr_t)m_runtime.clEnqueueWriteBuffer(
+            queue, slot.deviceResults, 0 /*non-blocking*/, 0, sizeof(m_resultHeader),
+            m_resultHeader, 0, nullptr, nullptr);
+        ok = err == CL_SUCCESS;
+    }
+    if (ok) {
+        m_runtime.clSetKernelArg(m_compactKernel, 0, sizeof(cl_mem), &m_sieveBuffer);
+        m_runtime.clSetKernelArg(m_compactKernel, 1, sizeof(uint32_t), &words);
+        m_runtime.clSetKernelArg(m_compactKernel, 2, sizeof(float), &lnBase);
+        m_runtime.clSetKernelArg(m_compactKernel, 3, sizeof(float), &minMerit);
+        m_runtime.clSetKernelArg(m_compactKernel, 4, sizeof(uint32_t), &maxCandidates);
+        m_runtime.clSetKernelArg(m_compactKernel, 5, sizeof(cl_mem), &slot.deviceResults);
+
+        size_t localSize = m_maxWorkGroupSize;
+        size_t globalSize = ((words + localSize - 1) / localSize) * localSize;
+        cl_int err = (cl_int)(intptr_t)m_runtime.clEnqueueNDRangeKernel(
+            queue, m_compactKernel, 1, nullptr, &globalSize, &localSize,
+            0, nullptr, nullptr);
+        ok = err == CL_SUCCESS;
+    }
+    if (ok) {
+        // Copy only the counters and candidates into pinned memory
+        cl_int err = (cl_int)(intptr_t)m_runtime.clEnqueueReadBuffer(
+            queue, slot.deviceResults, 0 /*non-blocking*/, 0, RESULT_BYTES,
+            slot.hostResults, 0, nullptr, &slot.event);
+        ok = err == CL_SUCCESS;
+    }
+    if (!ok) {
+        LogPrintf("GpuSieve: Failed to queue segment %llu\n", (unsigned long long)segmentStart);
+        m_runtime.clFinish(queue);
+        if (slot.event) {
+            m_runtime.clReleaseEvent(slot.event);
+            slot.event = nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_pipelineMutex);
+            m_freeSlots.push_back(index);
+        }
+        m_pipelineCv.notify_all();
+        return false;
+    }
+    m_runtime.clFlush(queue);
+
+    const uint64_t queued = ElapsedUs(queueStart);
+    {
+        std::lock_guard<std::mutex> statsLock(m_statsMutex);
+        m_stats.queueUs += queued;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        m_queuedSlots.push_back(index);
+    }
+    m_pipelineCv.notify_all();
+    return true;
+}
+
+void GpuSieve::ScanThread() {
+    while (true) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(m_pipelineMutex);
+            m_pipelineCv.wait(lock, [this] { return !m_queuedSlots.empty() || m_pipelineStopping; });
+            // Segments already queued are still scanned when stopping
+            if (m_queuedSlots.empty()) break;
+            index = m_queuedSlots.front();
+            m_queuedSlots.pop_front();
+        }
+
+        PipelineSlot& slot = m_slots[index];
+        const auto waitStart = std::chrono::steady_clock::now();
+        cl_int err = (cl_int)(intptr_t)m_runtime.clWaitForEvents(1, &slot.event);
+        const uint64_t waited = ElapsedUs(waitStart);
+        m_runtime.clReleaseEvent(slot.event);
+        slot.event = nullptr;
+
+        const auto scanStart = std::chrono::steady_clock::now();
+        if (err == CL_SUCCESS) {
+            ScanSlot(slot);
+        } else {
+            LogPrintf("GpuSieve: Segment %llu failed on the device (err=%d)\n",
+                      (unsigned long long)slot.segmentStart, err);
+        }
+        const uint64_t scanned = ElapsedUs(scanStart);
+        {
+            std::lock_guard<std::mutex> statsLock(m_statsMutex);
+            m_stats.gpuWaitUs += waited;
+            m_stats.scanUs += scanned;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_pipelineMutex);
+            m_freeSlots.push_back(index);
+        }
+        m_pipelineCv.notify_all();
+    }
+}
+
+void GpuSieve::ScanSlot(const PipelineSlot& slot) {
+    const uint32_t* results = slot.hostResults;
+    const uint32_t found = results[0];
+    const uint32_t primes = results[1];
+    const uint32_t maxGap = results[2];
+    const uint32_t reported = std::min(found, MAX_GAP_CANDIDATES);
+    const double lnBase = (double)m_shift * std::log(2.0);
+
+    // Merit as in FindGaps(), at the prime ending the gap
+    double bestMerit = 0.0;
+    std::vector<GapResult> gaps;
+    for (uint32_t k = 0; k < reported; ++k) {
+        const uint32_t pos = results[RESULT_HEADER_WORDS + 2 * k];
+        const uint32_t gapSize = results[RESULT_HEADER_WORDS + 2 * k + 1];
+        double lnPrime = lnBase + std::log((double)pos + gapSize + 1);
+        double merit = (double)gapSize / lnPrime;
+        bestMerit = std::max(bestMerit, merit);
+        if (merit >= m_targetMerit) {
+            gaps.push_back({slot.segmentStart, pos, gapSize, merit});
+        }
+    }
+    // Gaps below the candidate threshold are not reported; the largest gap
+    // at the segment end still gives a lower bound on the best merit
+    if (maxGap > 0) {
+        double lnEnd = lnBase + std::log((double)m_sieveSize * 8);
+        bestMerit = std::max(bestMerit, (double)maxGap / lnEnd);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats.segments++;
+        m_stats.candidates += found;
+        if (found > MAX_GAP_CANDIDATES) m_stats.overflows++;
+        m_stats.primesChecked += m_sieveSize * 8;
+        m_stats.gapsFound += primes > 0 ? primes - 1 : 0;
+        m_stats.bestMerit = std::max(m_stats.bestMerit, bestMerit);
+    }
+
+    if (m_gapCallback) {
+        for (const GapResult& gap : gaps) m_gapCallback(gap);
+    }
+}
+
+void GpuSieve::StopPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        if (!m_pipelineRunning) return;
+        m_pipelineStopping = true;
+    }
+    m_pipelineCv.notify_all();
+    if (m_scanThread.joinable()) m_scanThread.join();
+
+    ReleasePipelineBuffers();
+    {
+        std::lock_guard<std::mutex> lock(m_pipelineMutex);
+        m_freeSlots.clear();
+        m_queuedSlots.clear();
+        m_pipelineRunning = false;
+        m_pipelineStopping = false;
+    }
+    m_gapCallback = nullptr;
+}
+
+GpuSieve::PipelineStats GpuSieve::GetPipelineStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
 void GpuSieve::Cleanup() {
+    StopPipeline();
+
     if (m_sieveBuffer) {
         m_runtime.clReleaseMemObject(m_sieveBuffer);
         m_sieveBuffer = nullptr;
@@ -303,17 +632,26 @@ void GpuSieve::Cleanup() {
         m_runtime.clReleaseKernel(m_countKernel);
         m_countKernel = nullptr;
     }
+    if (m_clearKernel) {
+        m_runtime.clReleaseKernel(m_clearKernel);
+        m_clearKernel = nullptr;
+    }
+    if (m_compactKernel) {
+        m_runtime.clReleaseKernel(m_compactKernel);
+        m_compactKernel = nullptr;
+    }
     if (m_program) {
         m_runtime.clReleaseProgram(m_program);
         m_program = nullptr;
     }
+    m_runtime.ReleaseDeviceContext(m_device);
 
     m_initialized = false;
 }
 
 std::string GpuSieve::GetDeviceName() const {
-    if (m_runtime.IsInitialized()) {
-        return m_runtime.GetCurrentDevice().name;
+    if (m_device.context) {
+        return m_device.info.name;
     }
     return "Unknown";
 }
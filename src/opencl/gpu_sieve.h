@@ -9,19 +9,68 @@
 #include <cstdint>
 #include <vector>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 namespace opencl {
 
 /**
  * GPU-accelerated prime sieve using OpenCL
  *
- * Works with both AMD and NVIDIA GPUs through OpenCL.
+ * Works with both AMD and NVIDIA GPUs through OpenCL. Each sieve has its own
+ * context and queue on its device; MultiGpuSieve runs one per device.
+ *
+ * SieveSegment() and FindGaps() run one segment at a time. The pipeline
+ * (StartPipeline(), QueueSegment(), StopPipeline()) instead keeps up to
+ * PIPELINE_BUFFERS segments in flight: the device clears, sieves and
+ * compacts each segment to its gap candidates, only the candidates are
+ * copied into pinned host memory, and a CPU thread verifies them while the
+ * device works on the next segments.
  */
 class GpuSieve {
 public:
     using ProgressCallback = std::function<void(uint64_t primesChecked, uint64_t gapsFound, double bestMerit)>;
 
+    //! Segments in flight in the pipeline
+    static constexpr size_t PIPELINE_BUFFERS = 3;
+    //! Gap candidates one segment can report
+    static constexpr uint32_t MAX_GAP_CANDIDATES = 4096;
+
+    /**
+     * A gap meeting the target merit, found by the pipeline
+     */
+    struct GapResult {
+        uint64_t segmentStart;
+        uint32_t position;
+        uint32_t gapSize;
+        double merit;
+    };
+    using GapCallback = std::function<void(const GapResult& gap)>;
+
+    /**
+     * Pipeline counters and per-stage timing in microseconds
+     */
+    struct PipelineStats {
+        uint64_t segments{0};
+        uint64_t candidates{0};
+        //! Segments with more candidates than MAX_GAP_CANDIDATES
+        uint64_t overflows{0};
+        uint64_t primesChecked{0};
+        uint64_t gapsFound{0};
+        double bestMerit{0.0};
+        //! Host time spent queueing device work
+        uint64_t queueUs{0};
+        //! Time QueueSegment() waited for a free buffer (the CPU scan is behind)
+        uint64_t stallUs{0};
+        //! Time the scan thread waited for the device (sieve, compaction and copy)
+        uint64_t gpuWaitUs{0};
+        //! Time the scan thread spent verifying candidates
+        uint64_t scanUs{0};
+    };
+
     GpuSieve();
     ~GpuSieve();
 
@@ -41,6 +90,16 @@ public:
      */
     bool IsInitialized() const { return m_initialized; }
 
+    /**
+     * Get the number of candidates one segment covers (sieve bits)
+     */
+    uint64_t GetSegmentBits() const { return (uint64_t)m_sieveSize * 8; }
+
+    /**
+     * Get the device the sieve runs on
+     */
+    const GpuDeviceInfo& GetDeviceInfo() const { return m_device.info; }
+
     /**
      * Run sieve on GPU for one segment
      * @param segmentStart Start offset of segment
@@ -63,6 +122,32 @@ public:
                       double targetMerit, double& bestMerit,
                       uint64_t& primesChecked, uint64_t& gapsFound);
 
+    /**
+     * Start the asynchronous pipeline
+     * @param shift Mining shift value
+     * @param targetMerit Target merit for valid gap
+     * @param callback Called from the scan thread for each gap meeting the target
+     * @return true if the pipeline started
+     */
+    bool StartPipeline(uint32_t shift, double targetMerit, GapCallback callback);
+
+    /**
+     * Queue a segment on the pipeline, waiting while all buffers are in flight
+     * @param segmentStart Start offset of segment
+     * @return false if the pipeline is not running, stop was requested or queueing failed
+     */
+    bool QueueSegment(uint64_t segmentStart);
+
+    /**
+     * Finish the segments in flight and stop the scan thread
+     */
+    void StopPipeline();
+
+    /**
+     * Get pipeline counters and timing
+     */
+    PipelineStats GetPipelineStats() const;
+
     /**
      * Cleanup GPU resources
      */
@@ -89,11 +174,26 @@ public:
     bool IsStopRequested() const { return m_stopRequested; }
 
 private:
+    //! One segment in flight: device candidates and their pinned host copy
+    struct PipelineSlot {
+        cl_mem deviceResults{nullptr};
+        cl_mem pinnedResults{nullptr};
+        uint32_t* hostResults{nullptr};
+        cl_event event{nullptr};
+        uint64_t segmentStart{0};
+    };
+
     bool CompileKernel();
+    bool EnqueueSieve(uint64_t segmentStart);
+    bool CreatePipelineBuffers();
+    void ReleasePipelineBuffers();
+    void ScanThread();
+    void ScanSlot(const PipelineSlot& slot);
 
     OpenCLRuntime& m_runtime;
+    DeviceContext m_device;
     bool m_initialized{false};
-    bool m_stopRequested{false};
+    std::atomic<bool> m_stopRequested{false};
     size_t m_sieveSize{0};
 
     // OpenCL objects
@@ -101,6 +201,8 @@ private:
     cl_kernel m_sieveKernel{nullptr};
     cl_kernel m_gapKernel{nullptr};
     cl_kernel m_countKernel{nullptr};
+    cl_kernel m_clearKernel{nullptr};
+    cl_kernel m_compactKernel{nullptr};
 
     // GPU buffers
     cl_mem m_sieveBuffer{nullptr};
@@ -112,6 +214,24 @@ private:
 
     size_t m_numPrimes{0};
     size_t m_maxWorkGroupSize{256};
+
+    // Pipeline state
+    PipelineSlot m_slots[PIPELINE_BUFFERS];
+    std::deque<size_t> m_freeSlots;
+    std::deque<size_t> m_queuedSlots;
+    std::mutex m_pipelineMutex;
+    std::condition_variable m_pipelineCv;
+    std::thread m_scanThread;
+    bool m_pipelineRunning{false};
+    bool m_pipelineStopping{false};
+    uint32_t m_shift{0};
+    double m_targetMerit{0.0};
+    GapCallback m_gapCallback;
+    //! Source of the counter reset for each segment
+    const uint32_t m_resultHeader[4]{0, 0, 0, 0};
+
+    mutable std::mutex m_statsMutex;
+    PipelineStats m_stats;
 };
 
 } // namespace opencl
@@ -0,0 +1,363 @@
+// Copyright (c) 2026 WATTx Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_OPENCL_MINING_KERNELS_H
+#define WATTX_OPENCL_MINING_KERNELS_H
+
+// OpenCL kernels for X25X nonce search
+// Each work item hashes one nonce and reports it if the hash meets the job
+// target. MAX_HEADER_BYTES, NONCE_OFFSET and MAX_RESULTS are passed as build
+// options by GpuMiner. The source is split into several literals to stay
+// below compiler limits on string literal length.
+
+static const char* MINING_KERNEL_SOURCE = R"(
+// Job layout, mirrored by opencl::GpuJob
+typedef struct {
+    uint header[MAX_HEADER_BYTES / 4];  // Serialized header, nonce bytes ignored
+    uint length;                        // Serialized header length in bytes
+    uint target[8];                     // Little-endian words, target[7] most significant
+    uint midstate[8];                   // SHA-256 state after the first 64 header bytes
+    uint seal_hash[8];                  // Ethash: Keccak-256 of the header without nonce
+    uint dataset_items;                 // Ethash: full dataset size in 1024-bit items
+} job_t;
+
+#define ROTR32(x, n) rotate((uint)(x), (uint)(32 - (n)))
+#define ROTL64(x, n) rotate((ulong)(x), (ulong)(n))
+
+inline uint bswap32(uint x)
+{
+    return (x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24);
+}
+
+// Header byte i with the work item's nonce in place
+inline uchar header_byte(__global const job_t* job, uint i, uint nonce)
+{
+    if (i - NONCE_OFFSET < 4) return (uchar)(nonce >> ((i - NONCE_OFFSET) * 8));
+    return ((__global const uchar*)job->header)[i];
+}
+
+// Compare a hash, as little-endian words, against the job target
+inline bool meets_target(const uint* hash, __global const job_t* job)
+{
+    for (int i = 7; i >= 0; i--) {
+        if (hash[i] < job->target[i]) return true;
+        if (hash[i] > job->target[i]) return false;
+    }
+    return true;
+}
+
+inline void report(__global uint* results, uint nonce)
+{
+    const uint slot = atomic_inc(results);
+    if (slot < MAX_RESULTS) results[slot + 1] = nonce;
+}
+)"
+
+R"(
+// SHA-256
+
+__constant uint SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+__constant uint SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// One compression of a block of 16 big-endian words
+void sha256_transform(uint* state, const uint* block)
+{
+    uint w[64];
+    for (int i = 0; i < 16; i++) w[i] = block[i];
+    for (int i = 16; i < 64; i++) {
+        const uint s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint a = state[0], b = state[1], c = state[2], d = state[3];
+    uint e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        const uint t1 = h + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + bitselect(g, f, e) + SHA256_K[i] + w[i];
+        const uint t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + bitselect(a, b, c ^ a);
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// Run once per job: the first 64 header bytes do not contain the nonce
+__kernel void prepare_sha256d(__global job_t* job)
+{
+    uint state[8], block[16];
+    for (int i = 0; i < 8; i++) state[i] = SHA256_IV[i];
+    for (int i = 0; i < 16; i++) block[i] = bswap32(job->header[i]);
+    sha256_transform(state, block);
+    for (int i = 0; i < 8; i++) job->midstate[i] = state[i];
+}
+
+__kernel void search_sha256d(__global const job_t* job, const uint first_nonce, __global uint* results)
+{
+    const uint nonce = first_nonce + (uint)get_global_id(0);
+    const uint len = job->length;
+
+    uint state[8], block[16];
+    for (int i = 0; i < 8; i++) state[i] = job->midstate[i];
+
+    // Header bytes after the midstate, 0x80, zeros and the big-endian bit length
+    const uint blocks = (len - 64 + 9 + 63) / 64;
+    for (uint b = 0; b < blocks; b++) {
+        for (int i = 0; i < 16; i++) {
+            uint w = 0;
+            for (int k = 0; k < 4; k++) {
+                const uint pos = 64 + b * 64 + i * 4 + k;
+                const uint byte = pos < len ? header_byte(job, pos, nonce) : (pos == len ? 0x80 : 0);
+                w = (w << 8) | byte;
+            }
+            block[i] = w;
+        }
+        if (b == blocks - 1) block[15] = len * 8;
+        sha256_transform(state, block);
+    }
+
+    for (int i = 0; i < 8; i++) block[i] = state[i];
+    block[8] = 0x80000000;
+    for (int i = 9; i < 15; i++) block[i] = 0;
+    block[15] = 256;
+    for (int i = 0; i < 8; i++) state[i] = SHA256_IV[i];
+    sha256_transform(state, block);
+
+    uint hash[8];
+    for (int i = 0; i < 8; i++) hash[i] = bswap32(state[i]);
+    if (meets_target(hash, job)) report(results, nonce);
+}
+)"
+
+R"(
+// Keccak-f[1600], shared by SHA3-256 (kHeavyHash) and Keccak-256/512 (Ethash)
+
+__constant ulong KECCAK_RC[24] = {
+    0x0000000000000001UL, 0x0000000000008082UL, 0x800000000000808aUL, 0x8000000080008000UL,
+    0x000000000000808bUL, 0x0000000080000001UL, 0x8000000080008081UL, 0x8000000000008009UL,
+    0x000000000000008aUL, 0x0000000000000088UL, 0x0000000080008009UL, 0x000000008000000aUL,
+    0x000000008000808bUL, 0x800000000000008bUL, 0x8000000000008089UL, 0x8000000000008003UL,
+    0x8000000000008002UL, 0x8000000000000080UL, 0x000000000000800aUL, 0x800000008000000aUL,
+    0x8000000080008081UL, 0x8000000000008080UL, 0x0000000080000001UL, 0x8000000080008008UL
+};
+
+__constant uint KECCAK_ROTC[24] = {
+    1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
+};
+
+__constant uint KECCAK_PILN[24] = {
+    10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
+};
+
+void keccak_f1600(ulong* s)
+{
+    for (int r = 0; r < 24; r++) {
+        ulong c[5];
+        for (int x = 0; x < 5; x++) c[x] = s[x] ^ s[x + 5] ^ s[x + 10] ^ s[x + 15] ^ s[x + 20];
+        for (int x = 0; x < 5; x++) {
+            const ulong d = c[(x + 4) % 5] ^ ROTL64(c[(x + 1) % 5], 1);
+            for (int y = 0; y < 25; y += 5) s[y + x] ^= d;
+        }
+
+        ulong t = s[1];
+        for (int i = 0; i < 24; i++) {
+            const uint j = KECCAK_PILN[i];
+            const ulong next = s[j];
+            s[j] = ROTL64(t, KECCAK_ROTC[i]);
+            t = next;
+        }
+
+        for (int y = 0; y < 25; y += 5) {
+            for (int x = 0; x < 5; x++) c[x] = s[y + x];
+            for (int x = 0; x < 5; x++) s[y + x] = c[x] ^ (~c[(x + 1) % 5] & c[(x + 2) % 5]);
+        }
+        s[0] ^= KECCAK_RC[r];
+    }
+}
+
+inline ulong load64(const uchar* p)
+{
+    ulong v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+// SHA3-256 of a private message
+void sha3_256(const uchar* msg, uint len, uchar* out)
+{
+    const uint rate = 136;
+    ulong s[25];
+    for (int i = 0; i < 25; i++) s[i] = 0;
+
+    uint off = 0;
+    for (; len - off >= rate; off += rate) {
+        for (uint w = 0; w < rate / 8; w++) s[w] ^= load64(msg + off + w * 8);
+        keccak_f1600(s);
+    }
+    uchar last[136];
+    for (uint i = 0; i < rate; i++) last[i] = off + i < len ? msg[off + i] : 0;
+    last[len - off] ^= 0x06;
+    last[rate - 1] ^= 0x80;
+    for (uint w = 0; w < rate / 8; w++) s[w] ^= load64(last + w * 8);
+    keccak_f1600(s);
+
+    for (int i = 0; i < 32; i++) out[i] = (uchar)(s[i / 8] >> ((i % 8) * 8));
+}
+)"
+
+R"(
+// kHeavyHash, as hash::KHeavyHash()
+
+__kernel void search_kheavyhash(__global const job_t* job, const uint first_nonce, __global uint* results)
+{
+    const uint nonce = first_nonce + (uint)get_global_id(0);
+    const uint len = job->length;
+
+    uchar data[MAX_HEADER_BYTES + 32];
+    for (uint i = 0; i < len; i++) data[i] = header_byte(job, i, nonce);
+
+    uchar seed[32], vec_hash[32];
+    sha3_256(data, len, seed);
+    for (int i = 0; i < 32; i++) data[len + i] = seed[i];
+    sha3_256(data, len + 32, vec_hash);
+
+    ulong vec[4];
+    for (int i = 0; i < 4; i++) vec[i] = load64(vec_hash + i * 8);
+
+    // The 64x64 xorshift matrix folded into per-residue column sums per row
+    ulong state = load64(seed);
+    if (state == 0) state = 1;
+    ulong result[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 64; i++) {
+        ulong lane[4] = {0, 0, 0, 0};
+        for (int j = 0; j < 64; j += 4) {
+            for (int k = 0; k < 4; k++) {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                lane[k] += state;
+            }
+        }
+        result[i % 4] ^= lane[0] * vec[0] + lane[1] * vec[1] + lane[2] * vec[2] + lane[3] * vec[3];
+    }
+
+    uchar buf[32], xor_hash[32];
+    for (int i = 0; i < 32; i++) buf[i] = (uchar)(result[i / 8] >> ((i % 8) * 8));
+    sha3_256(buf, 32, xor_hash);
+    for (int i = 0; i < 32; i++) xor_hash[i] ^= vec_hash[i];
+    sha3_256(xor_hash, 32, buf);
+
+    uint hash[8];
+    for (int i = 0; i < 8; i++) {
+        hash[i] = (uint)buf[i * 4] | ((uint)buf[i * 4 + 1] << 8) | ((uint)buf[i * 4 + 2] << 16) | ((uint)buf[i * 4 + 3] << 24);
+    }
+    if (meets_target(hash, job)) report(results, nonce);
+}
+)"
+
+R"(
+// Ethash
+
+#define FNV_PRIME 0x01000193
+#define fnv1(u, v) (((u) * FNV_PRIME) ^ (v))
+
+// Keccak-512 of 16 little-endian words, in place
+void keccak512_words(uint* words)
+{
+    ulong s[25];
+    for (int i = 0; i < 25; i++) s[i] = 0;
+    for (int i = 0; i < 8; i++) s[i] = (ulong)words[i * 2] | ((ulong)words[i * 2 + 1] << 32);
+    s[8] = 0x8000000000000001UL;
+    keccak_f1600(s);
+    for (int i = 0; i < 8; i++) {
+        words[i * 2] = (uint)s[i];
+        words[i * 2 + 1] = (uint)(s[i] >> 32);
+    }
+}
+
+// One 512-bit dataset item per work item, from the epoch light cache
+__kernel void ethash_dag(__global const uint* cache, const uint cache_items, const uint first_item,
+                         __global uint* dataset)
+{
+    const uint index = first_item + (uint)get_global_id(0);
+
+    uint mix[16];
+    for (int i = 0; i < 16; i++) mix[i] = cache[(ulong)(index % cache_items) * 16 + i];
+    mix[0] ^= index;
+    keccak512_words(mix);
+
+    for (uint j = 0; j < 256; j++) {
+        const uint parent = fnv1(index ^ j, mix[j % 16]) % cache_items;
+        for (int i = 0; i < 16; i++) mix[i] = fnv1(mix[i], cache[(ulong)parent * 16 + i]);
+    }
+    keccak512_words(mix);
+
+    for (int i = 0; i < 16; i++) dataset[(ulong)index * 16 + i] = mix[i];
+}
+
+__kernel void search_ethash(__global const job_t* job, const uint first_nonce, __global uint* results,
+                            __global const uint* dataset)
+{
+    const uint nonce = first_nonce + (uint)get_global_id(0);
+
+    // seed = Keccak-512(seal hash || 64-bit little-endian nonce)
+    ulong s[25];
+    for (int i = 0; i < 25; i++) s[i] = 0;
+    for (int i = 0; i < 4; i++) s[i] = (ulong)job->seal_hash[i * 2] | ((ulong)job->seal_hash[i * 2 + 1] << 32);
+    s[4] = nonce;
+    s[5] = 0x01;
+    s[8] = 0x8000000000000000UL;
+    keccak_f1600(s);
+
+    uint seed[16];
+    for (int i = 0; i < 8; i++) {
+        seed[i * 2] = (uint)s[i];
+        seed[i * 2 + 1] = (uint)(s[i] >> 32);
+    }
+
+    uint mix[32];
+    for (int i = 0; i < 32; i++) mix[i] = seed[i % 16];
+
+    const uint items = job->dataset_items;
+    for (uint i = 0; i < 64; i++) {
+        const uint p = fnv1(i ^ seed[0], mix[i % 32]) % items;
+        __global const uint* item = dataset + (ulong)p * 32;
+        for (int j = 0; j < 32; j++) mix[j] = fnv1(mix[j], item[j]);
+    }
+
+    uint cmix[8];
+    for (int i = 0; i < 8; i++) {
+        cmix[i] = fnv1(fnv1(fnv1(mix[i * 4], mix[i * 4 + 1]), mix[i * 4 + 2]), mix[i * 4 + 3]);
+    }
+
+    // final = Keccak-256(seed || compressed mix)
+    for (int i = 0; i < 25; i++) s[i] = 0;
+    for (int i = 0; i < 8; i++) s[i] = (ulong)seed[i * 2] | ((ulong)seed[i * 2 + 1] << 32);
+    for (int i = 0; i < 4; i++) s[8 + i] = (ulong)cmix[i * 2] | ((ulong)cmix[i * 2 + 1] << 32);
+    s[12] = 0x01;
+    s[16] = 0x8000000000000000UL;
+    keccak_f1600(s);
+
+    uint hash[8];
+    for (int i = 0; i < 4; i++) {
+        hash[i * 2] = (uint)s[i];
+        hash[i * 2 + 1] = (uint)(s[i] >> 32);
+    }
+    if (meets_target(hash, job)) report(results, nonce);
+}
+)";
+
+#endif // WATTX_OPENCL_MINING_KERNELS_H
@@ -0,0 +1,222 @@
+// Copyright (c) 2026 WATTx Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <opencl/multi_gpu_sieve.h>
+#include <logging.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace opencl {
+
+SegmentScheduler::SegmentScheduler(uint64_t firstSegment, uint64_t segmentCount, size_t workers) {
+    assert(workers > 0);
+    m_ranges.reserve(workers);
+    uint64_t begin = firstSegment;
+    for (size_t i = 0; i < workers; ++i) {
+        // Spread the remainder over the first shares
+        uint64_t share = segmentCount / workers + (i < segmentCount % workers ? 1 : 0);
+        m_ranges.push_back({begin, begin + share});
+        begin += share;
+    }
+}
+
+bool SegmentScheduler::Take(size_t worker, uint64_t maxSegments, uint64_t& begin, uint64_t& end) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Range& own = m_ranges[worker];
+
+    if (own.begin == own.end) {
+        // Steal the back half of the largest share left
+        Range* victim = nullptr;
+        for (Range& r : m_ranges) {
+            if (r.end - r.begin > (victim ? victim->end - victim->begin : 0)) victim = &r;
+        }
+        if (!victim) return false;
+
+        uint64_t mid = victim->begin + (victim->end - victim->begin) / 2;
+        own = {mid, victim->end};
+        victim->end = mid;
+    }
+
+    begin = own.begin;
+    end = begin + std::min(maxSegments, own.end - own.begin);
+    own.begin = end;
+    return true;
+}
+
+void SegmentScheduler::Return(size_t worker, uint64_t begin, uint64_t end) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Range& own = m_ranges[worker];
+    // Thieves only shorten a share from the back, so the worker's share still
+    // starts where its last chunk ended
+    assert(own.begin == end);
+    own.begin = begin;
+}
+
+uint64_t SegmentScheduler::GetRemaining() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t remaining = 0;
+    for (const Range& r : m_ranges) remaining += r.end - r.begin;
+    return remaining;
+}
+
+MultiGpuSieve::MultiGpuSieve() = default;
+
+MultiGpuSieve::~MultiGpuSieve() {
+    Cleanup();
+}
+
+bool MultiGpuSieve::Initialize(size_t sieveSize, const std::vector<uint32_t>& primes) {
+    Cleanup();
+
+    auto& runtime = OpenCLRuntime::Instance();
+    if (!runtime.IsAvailable()) {
+        LogPrintf("MultiGpuSieve: OpenCL not available\n");
+        return false;
+    }
+
+    for (const GpuDeviceInfo& info : runtime.GetGpuDevices()) {
+        auto sieve = std::make_unique<GpuSieve>();
+        if (!sieve->Initialize(info.platformId, info.deviceId, sieveSize, primes)) {
+            LogPrintf("MultiGpuSieve: Skipping %s (platform %d, device %d)\n",
+                      info.name.c_str(), info.platformId, info.deviceId);
+            continue;
+        }
+        Device dev;
+        dev.sieve = std::move(sieve);
+        dev.stats.device = info;
+        m_devices.push_back(std::move(dev));
+    }
+
+    if (m_devices.empty()) {
+        LogPrintf("MultiGpuSieve: No usable GPU\n");
+        return false;
+    }
+
+    LogPrintf("MultiGpuSieve: Initialized on %zu devices\n", m_devices.size());
+    return true;
+}
+
+uint64_t MultiGpuSieve::GetSegmentBits() const {
+    return m_devices.empty() ? 0 : m_devices.front().sieve->GetSegmentBits();
+}
+
+void MultiGpuSieve::SetProgressCallback(size_t device, GpuSieve::ProgressCallback callback) {
+    if (device < m_devices.size()) {
+        m_devices[device].progress = std::move(callback);
+    }
+}
+
+uint64_t MultiGpuSieve::Run(uint64_t firstSegment, uint64_t segmentCount, uint32_t shift,
+                            double targetMerit, GpuSieve::GapCallback callback) {
+    if (m_devices.empty()) return 0;
+
+    m_stopRequested = false;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        for (Device& dev : m_devices) {
+            dev.sieve->ResetStop();
+            GpuDeviceInfo info = dev.stats.device;
+            dev.stats = DeviceStats{};
+            dev.stats.device = info;
+        }
+    }
+
+    SegmentScheduler scheduler(firstSegment, segmentCount, m_devices.size());
+    std::vector<std::thread> threads;
+    threads.reserve(m_devices.size());
+    for (size_t i = 0; i < m_devices.size(); ++i) {
+        threads.emplace_back(&MultiGpuSieve::DeviceThread, this, i, std::ref(scheduler),
+                             shift, targetMerit, std::cref(callback));
+    }
+    for (std::thread& t : threads) t.join();
+
+    uint64_t total = 0;
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    for (const Device& dev : m_devices) {
+        total += dev.stats.segments;
+        LogPrintf("MultiGpuSieve: %s verified %llu segments (%.1f/s)\n",
+                  dev.stats.device.name.c_str(), (unsigned long long)dev.stats.segments,
+                  dev.stats.segmentsPerSecond);
+    }
+    return total;
+}
+
+void MultiGpuSieve::DeviceThread(size_t index, SegmentScheduler& scheduler, uint32_t shift,
+                                 double targetMerit, const GpuSieve::GapCallback& callback) {
+    Device& dev = m_devices[index];
+    GpuSieve& sieve = *dev.sieve;
+    const auto start = std::chrono::steady_clock::now();
+
+    auto onGap = [this, &callback](const GpuSieve::GapResult& gap) {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        if (callback) callback(gap);
+    };
+    if (!sieve.StartPipeline(shift, targetMerit, onGap)) {
+        LogPrintf("MultiGpuSieve: Failed to start pipeline on %s\n", dev.stats.device.name.c_str());
+        return;
+    }
+
+    auto report = [&] {
+        const GpuSieve::PipelineStats ps = sieve.GetPipelineStats();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        DeviceStats stats;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            dev.stats.segments = ps.segments;
+            dev.stats.primesChecked = ps.primesChecked;
+            dev.stats.gapsFound = ps.gapsFound;
+            dev.stats.bestMerit = ps.bestMerit;
+            dev.stats.segmentsPerSecond = seconds > 0 ? ps.segments / seconds : 0.0;
+            stats = dev.stats;
+        }
+        if (dev.progress) dev.progress(stats.primesChecked, stats.gapsFound, stats.bestMerit);
+    };
+
+    const uint64_t segmentBits = sieve.GetSegmentBits();
+    uint64_t begin, end;
+    bool failed = false;
+    while (!failed && !m_stopRequested && scheduler.Take(index, CHUNK_SEGMENTS, begin, end)) {
+        for (uint64_t seg = begin; seg < end; ++seg) {
+            if (!sieve.QueueSegment(seg * segmentBits)) {
+                // Leave what is left of the chunk to the other devices
+                if (!m_stopRequested) {
+                    LogPrintf("MultiGpuSieve: %s failed, handing back its segments\n",
+                              dev.stats.device.name.c_str());
+                    scheduler.Return(index, seg, end);
+                }
+                failed = true;
+                break;
+            }
+        }
+        report();
+    }
+
+    sieve.StopPipeline();
+    report();
+}
+
+std::vector<MultiGpuSieve::DeviceStats> MultiGpuSieve::GetDeviceStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    std::vector<DeviceStats> stats;
+    stats.reserve(m_devices.size());
+    for (const Device& dev : m_devices) stats.push_back(dev.stats);
+    return stats;
+}
+
+void MultiGpuSieve::RequestStop() {
+    m_stopRequested = true;
+    for (Device& dev : m_devices) {
+        dev.sieve->RequestStop();
+    }
+}
+
+void MultiGpuSieve::Cleanup() {
+    m_devices.clear();
+}
+
+} // namespace opencl
@@ -0,0 +1,164 @@
+// Copyright (c) 2026 WATTx Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_OPENCL_MULTI_GPU_SIEVE_H
+#define WATTX_OPENCL_MULTI_GPU_SIEVE_H
+
+#include <opencl/gpu_sieve.h>
+#include <opencl/opencl_runtime.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace opencl {
+
+/**
+ * Splits a range of segments between workers with work stealing
+ *
+ * Each worker starts with an equal contiguous share and takes chunks from
+ * its front. A worker whose share is used up steals the back half of the
+ * largest remaining share, so faster devices end up with more segments.
+ */
+class SegmentScheduler {
+public:
+    /**
+     * @param firstSegment Index of the first segment
+     * @param segmentCount Number of segments to hand out
+     * @param workers Number of workers sharing them
+     */
+    SegmentScheduler(uint64_t firstSegment, uint64_t segmentCount, size_t workers);
+
+    /**
+     * Take up to maxSegments segments for a worker, stealing when its own share is empty
+     * @param worker Worker index
+     * @param maxSegments Largest chunk to take
+     * @param begin Output: first segment of the chunk
+     * @param end Output: one past the last segment of the chunk
+     * @return false when no segments are left
+     */
+    bool Take(size_t worker, uint64_t maxSegments, uint64_t& begin, uint64_t& end);
+
+    /**
+     * Give back segments begin .. end - 1, the unfinished tail of a worker's last chunk
+     */
+    void Return(size_t worker, uint64_t begin, uint64_t end);
+
+    /**
+     * Get the number of segments not taken yet
+     */
+    uint64_t GetRemaining() const;
+
+private:
+    struct Range {
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Range> m_ranges;
+};
+
+/**
+ * Prime sieve across every OpenCL GPU
+ *
+ * Runs a GpuSieve pipeline per device, on mixed AMD and NVIDIA rigs alike,
+ * and shares a range of segments between them through a SegmentScheduler.
+ * Segment i starts at i * GetSegmentBits().
+ */
+class MultiGpuSieve {
+public:
+    //! Segments a device takes from the scheduler at a time
+    static constexpr uint64_t CHUNK_SEGMENTS = 4 * GpuSieve::PIPELINE_BUFFERS;
+
+    /**
+     * Per-device counters
+     */
+    struct DeviceStats {
+        GpuDeviceInfo device;
+        uint64_t segments{0};
+        uint64_t primesChecked{0};
+        uint64_t gapsFound{0};
+        double bestMerit{0.0};
+        //! Segments verified per second during the last Run()
+        double segmentsPerSecond{0.0};
+    };
+
+    MultiGpuSieve();
+    ~MultiGpuSieve();
+
+    MultiGpuSieve(const MultiGpuSieve&) = delete;
+    MultiGpuSieve& operator=(const MultiGpuSieve&) = delete;
+
+    /**
+     * Initialize a sieve on every GPU that accepts one
+     * @param sieveSize Size of sieve in bytes
+     * @param primes Vector of small primes for sieving
+     * @return true if at least one device initialized
+     */
+    bool Initialize(size_t sieveSize, const std::vector<uint32_t>& primes);
+
+    /**
+     * Get the number of devices in use
+     */
+    size_t GetDeviceCount() const { return m_devices.size(); }
+
+    /**
+     * Get the number of candidates one segment covers, the same on every device
+     */
+    uint64_t GetSegmentBits() const;
+
+    /**
+     * Set the progress callback of one device, called with that device's
+     * totals after each chunk it finishes
+     */
+    void SetProgressCallback(size_t device, GpuSieve::ProgressCallback callback);
+
+    /**
+     * Sieve segments firstSegment .. firstSegment + segmentCount - 1 on all devices
+     * @param shift Mining shift value
+     * @param targetMerit Target merit for valid gap
+     * @param callback Called for each gap meeting the target, one call at a time
+     * @return Number of segments verified
+     */
+    uint64_t Run(uint64_t firstSegment, uint64_t segmentCount, uint32_t shift,
+                 double targetMerit, GpuSieve::GapCallback callback);
+
+    /**
+     * Get per-device counters of the last Run()
+     */
+    std::vector<DeviceStats> GetDeviceStats() const;
+
+    /**
+     * Request stop - makes Run() return early
+     */
+    void RequestStop();
+
+    /**
+     * Cleanup GPU resources
+     */
+    void Cleanup();
+
+private:
+    struct Device {
+        std::unique_ptr<GpuSieve> sieve;
+        GpuSieve::ProgressCallback progress;
+        DeviceStats stats;
+    };
+
+    void DeviceThread(size_t index, SegmentScheduler& scheduler, uint32_t shift,
+                      double targetMerit, const GpuSieve::GapCallback& callback);
+
+    std::vector<Device> m_devices;
+    std::atomic<bool> m_stopRequested{false};
+    mutable std::mutex m_statsMutex;
+    //! Serializes gap callbacks from the devices' scan threads
+    std::mutex m_callbackMutex;
+};
+
+} // namespace opencl
+
+#endif // WATTX_OPENCL_MULTI_GPU_SIEVE_H
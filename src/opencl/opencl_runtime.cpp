@@ -82,7 +82,12 @@ bool OpenCLRuntime::LoadOpenCLLib() {
     LOAD_FUNC(clEnqueueNDRangeKernel);
     LOAD_FUNC(clEnqueueReadBuffer);
     LOAD_FUNC(clEnqueueWriteBuffer);
+    LOAD_FUNC(clEnqueueMapBuffer);
+    LOAD_FUNC(clEnqueueUnmapMemObject);
     LOAD_FUNC(clFinish);
+    LOAD_FUNC(clFlush);
+    LOAD_FUNC(clWaitForEvents);
+    LOAD_FUNC(clReleaseEvent);
     LOAD_FUNC(clReleaseMemObject);
     LOAD_FUNC(clReleaseKernel);
     LOAD_FUNC(clReleaseProgram);
@@ -189,6 +194,22 @@ std::vector<GpuDeviceInfo> OpenCLRuntime::GetGpuDevices() {
 }
 
 bool OpenCLRuntime::Initialize(int platformId, int deviceId) {
+    DeviceContext ctx;
+    if (!CreateDeviceContext(platformId, deviceId, ctx)) {
+        return false;
+    }
+
+    m_context = ctx.context;
+    m_queue = ctx.queue;
+    m_device = ctx.device;
+    m_currentDevice = ctx.info;
+
+    m_initialized = true;
+    LogPrintf("OpenCL: Initialized on %s\n", m_currentDevice.name.c_str());
+    return true;
+}
+
+bool OpenCLRuntime::CreateDeviceContext(int platformId, int deviceId, DeviceContext& ctx) {
     if (!m_available) {
         return false;
     }
@@ -196,7 +217,7 @@ bool OpenCLRuntime::Initialize(int platformId, int deviceId) {
     // Get platform
     cl_uint numPlatforms = 0;
     clGetPlatformIDs(0, nullptr, &numPlatforms);
-    if (platformId >= (int)numPlatforms) {
+    if (platformId < 0 || platformId >= (int)numPlatforms) {
         LogPrintf("OpenCL: Invalid platform ID %d\n", platformId);
         return false;
     }
@@ -207,14 +228,14 @@ bool OpenCLRuntime::Initialize(int platformId, int deviceId) {
     // Get device
     cl_uint numDevices = 0;
     clGetDeviceIDs(platforms[platformId], CL_DEVICE_TYPE_GPU, 0, nullptr, &numDevices);
-    if (deviceId >= (int)numDevices) {
+    if (deviceId < 0 || deviceId >= (int)numDevices) {
         LogPrintf("OpenCL: Invalid device ID %d\n", deviceId);
         return false;
     }
 
     std::vector<cl_device_id> devIds(numDevices);
     clGetDeviceIDs(platforms[platformId], CL_DEVICE_TYPE_GPU, numDevices, devIds.data(), nullptr);
-    m_device = devIds[deviceId];
+    ctx.device = devIds[deviceId];
 
     // Create context with explicit platform properties (required by some NVIDIA drivers)
     cl_int err = CL_SUCCESS;
@@ -222,18 +243,20 @@ bool OpenCLRuntime::Initialize(int platformId, int deviceId) {
         CL_CONTEXT_PLATFORM, (cl_context_properties)platforms[platformId],
         0
     };
-    m_context = clCreateContext(properties, 1, &m_device, nullptr, nullptr, &err);
-    if (err != CL_SUCCESS || !m_context) {
+    ctx.context = clCreateContext(properties, 1, &ctx.device, nullptr, nullptr, &err);
+    if (err != CL_SUCCESS || !ctx.context) {
         LogPrintf("OpenCL: Failed to create context (err=%d)\n", err);
+        ctx.context = nullptr;
         return false;
     }
 
     // Create command queue
-    m_queue = clCreateCommandQueue(m_context, m_device, 0, &err);
-    if (err != CL_SUCCESS || !m_queue) {
+    ctx.queue = clCreateCommandQueue(ctx.context, ctx.device, 0, &err);
+    if (err != CL_SUCCESS || !ctx.queue) {
         LogPrintf("OpenCL: Failed to create command queue (err=%d)\n", err);
-        clReleaseContext(m_context);
-        m_context = nullptr;
+        clReleaseContext(ctx.context);
+        ctx.context = nullptr;
+        ctx.queue = nullptr;
         return false;
     }
 
@@ -241,16 +264,25 @@ bool OpenCLRuntime::Initialize(int platformId, int deviceId) {
     auto devices = GetGpuDevices();
     for (const auto& dev : devices) {
         if (dev.platformId == platformId && dev.deviceId == deviceId) {
-            m_currentDevice = dev;
+            ctx.info = dev;
             break;
         }
     }
-
-    m_initialized = true;
-    LogPrintf("OpenCL: Initialized on %s\n", m_currentDevice.name.c_str());
     return true;
 }
 
+void OpenCLRuntime::ReleaseDeviceContext(DeviceContext& ctx) {
+    if (ctx.queue) {
+        clReleaseCommandQueue(ctx.queue);
+        ctx.queue = nullptr;
+    }
+    if (ctx.context) {
+        clReleaseContext(ctx.context);
+        ctx.context = nullptr;
+    }
+    ctx.device = nullptr;
+}
+
 void OpenCLRuntime::Cleanup() {
     if (m_queue) {
         clReleaseCommandQueue(m_queue);
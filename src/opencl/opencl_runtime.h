@@ -23,6 +23,7 @@ typedef void* cl_command_queue;
 typedef void* cl_program;
 typedef void* cl_kernel;
 typedef void* cl_mem;
+typedef void* cl_event;
 typedef cl_ulong cl_device_type;
 typedef cl_uint cl_mem_flags;
 typedef intptr_t cl_context_properties;
@@ -35,7 +36,10 @@ typedef intptr_t cl_context_properties;
 #define CL_MEM_READ_WRITE (1 << 0)
 #define CL_MEM_WRITE_ONLY (1 << 1)
 #define CL_MEM_READ_ONLY (1 << 2)
+#define CL_MEM_ALLOC_HOST_PTR (1 << 4)
 #define CL_MEM_COPY_HOST_PTR (1 << 5)
+#define CL_MAP_READ (1 << 0)
+#define CL_MAP_WRITE (1 << 1)
 
 // Device info queries
 #define CL_DEVICE_NAME 0x102B
@@ -43,6 +47,7 @@ typedef intptr_t cl_context_properties;
 #define CL_DEVICE_MAX_COMPUTE_UNITS 0x1002
 #define CL_DEVICE_MAX_WORK_GROUP_SIZE 0x1004
 #define CL_DEVICE_GLOBAL_MEM_SIZE 0x101F
+#define CL_DEVICE_MAX_MEM_ALLOC_SIZE 0x1010
 
 /**
  * GPU Device information
@@ -57,6 +62,16 @@ struct GpuDeviceInfo {
     uint64_t globalMemorySize;
 };
 
+/**
+ * A context and in-order command queue on one device
+ */
+struct DeviceContext {
+    cl_context context{nullptr};
+    cl_command_queue queue{nullptr};
+    cl_device_id device{nullptr};
+    GpuDeviceInfo info;
+};
+
 /**
  * OpenCL Runtime Loader
  *
@@ -88,6 +103,21 @@ public:
      */
     bool Initialize(int platformId, int deviceId);
 
+    /**
+     * Create a context and queue of the caller's own on a device, so that
+     * several devices can be used at once
+     * @param platformId Platform index
+     * @param deviceId Device index
+     * @param ctx Output: the device's context, queue and info
+     * @return true if created successfully
+     */
+    bool CreateDeviceContext(int platformId, int deviceId, DeviceContext& ctx);
+
+    /**
+     * Release a context created by CreateDeviceContext()
+     */
+    void ReleaseDeviceContext(DeviceContext& ctx);
+
     /**
      * Check if initialized
      */
@@ -117,7 +147,12 @@ public:
     void* (*clEnqueueNDRangeKernel)(cl_command_queue, cl_kernel, cl_uint, const size_t*, const size_t*, const size_t*, cl_uint, void*, void*);
     void* (*clEnqueueReadBuffer)(cl_command_queue, cl_mem, cl_uint, size_t, size_t, void*, cl_uint, void*, void*);
     void* (*clEnqueueWriteBuffer)(cl_command_queue, cl_mem, cl_uint, size_t, size_t, const void*, cl_uint, void*, void*);
+    void* (*clEnqueueMapBuffer)(cl_command_queue, cl_mem, cl_uint, cl_ulong, size_t, size_t, cl_uint, void*, void*, cl_int*);
+    void* (*clEnqueueUnmapMemObject)(cl_command_queue, cl_mem, void*, cl_uint, void*, void*);
     void* (*clFinish)(cl_command_queue);
+    void* (*clFlush)(cl_command_queue);
+    void* (*clWaitForEvents)(cl_uint, const cl_event*);
+    void* (*clReleaseEvent)(cl_event);
     void* (*clReleaseMemObject)(cl_mem);
     void* (*clReleaseKernel)(cl_kernel);
     void* (*clReleaseProgram)(cl_program);
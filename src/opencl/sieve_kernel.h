@@ -6,13 +6,15 @@
 #define WATTX_OPENCL_SIEVE_KERNEL_H
 
 // OpenCL kernel for prime sieving
-// This kernel marks composite numbers in a sieve array using multiple small primes
+// This kernel marks composite numbers in a sieve array using multiple small primes.
+// The sieve is a bit array (bit j of byte j / 8), accessed as 32-bit words so
+// it can be marked with 32-bit atomics.
 
 static const char* SIEVE_KERNEL_SOURCE = R"(
 // Sieve kernel - marks composite numbers
 // Each work item handles one small prime
 __kernel void sieve_segment(
-    __global uchar* sieve,          // Output sieve array (bit array)
+    __global uint* sieve,           // Output sieve array (bit array)
     __global const uint* primes,    // Small primes array
     const ulong segmentStart,       // Start offset of this segment
     const uint sieveSize,           // Size of sieve in bytes
@@ -48,12 +50,77 @@ __kernel void sieve_segment(
 
     // Mark all multiples of p as composite
     for (ulong j = localStart; j < segmentBits; j += p) {
-        uint byteIdx = j / 8;
-        uint bitIdx = j % 8;
-        atomic_or(&sieve[byteIdx], (uchar)(1 << bitIdx));
+        uint wordIdx = j / 32;
+        uint bitIdx = j % 32;
+        atomic_or(&sieve[wordIdx], 1u << bitIdx);
     }
 }
 
+// Clear kernel - resets the sieve on the device instead of uploading zeros
+__kernel void clear_sieve(
+    __global uint* sieve,
+    const uint words
+) {
+    uint gid = get_global_id(0);
+    if (gid < words) sieve[gid] = 0;
+}
+
+// Index of the lowest set bit of a non-zero word
+inline uint lowest_bit(uint x) {
+    return 31 - clz(x & (0u - x));
+}
+
+// Gap compaction kernel - reports only gaps that may meet the target merit
+// Each work item owns the primes in one sieve word and measures the gap to
+// the next prime, scanning forward past its word if needed. Gaps running
+// past the segment end are not counted, as in GpuSieve::FindGaps(). The
+// merit is computed as there; minMerit is set a little below the target
+// so single-precision logs never drop a gap the host would accept.
+// out[0]: candidates found, out[1]: primes in the segment, out[2]: largest
+// gap; candidate k is (position of the gap's first prime, gap) at out[4 + 2k].
+__kernel void compact_gaps(
+    __global const uint* sieve,     // Input sieve array
+    const uint words,               // Size of sieve in 32-bit words
+    const float lnBase,             // shift * ln(2)
+    const float minMerit,           // Smallest merit worth reporting
+    const uint maxCandidates,       // Capacity of the candidate list
+    __global uint* out              // Output counters and candidates
+) {
+    uint gid = get_global_id(0);
+    if (gid >= words) return;
+
+    uint primes = ~sieve[gid];
+    if (primes == 0) return;  // All composite
+    atomic_add(&out[1], popcount(primes));
+
+    uint localMax = 0;
+    while (primes != 0) {
+        uint pos = gid * 32 + lowest_bit(primes);
+        primes &= primes - 1;
+
+        uint next;
+        if (primes != 0) {
+            next = gid * 32 + lowest_bit(primes);
+        } else {
+            uint w = gid + 1;
+            while (w < words && sieve[w] == 0xFFFFFFFF) w++;
+            if (w >= words) break;
+            next = w * 32 + lowest_bit(~sieve[w]);
+        }
+
+        uint gap = next - pos;
+        localMax = max(localMax, gap);
+        if ((float)gap >= minMerit * (lnBase + log((float)next + 1.0f))) {
+            uint idx = atomic_inc(&out[0]);
+            if (idx < maxCandidates) {
+                out[4 + idx * 2] = pos;
+                out[5 + idx * 2] = gap;
+            }
+        }
+    }
+    if (localMax > 0) atomic_max(&out[2], localMax);
+}
+
 // Gap finding kernel - finds gaps between primes
 // Returns gap sizes for each starting position
 __kernel void find_gaps(
@@ -76,6 +76,16 @@ std::vector<uint32_t> GetDust(const CTransaction& tx, CFeeRate dust_relay_rate)
     return dust_outputs;
 }
 
+/** Whether a data carrier script holds the "FCMP" magic of a shield output */
+static bool IsFcmpShieldData(const CScript& scriptPubKey)
+{
+    CScript::const_iterator pc = scriptPubKey.begin() + 1;
+    opcodetype opcode;
+    std::vector<unsigned char> data;
+    return scriptPubKey.GetOp(pc, opcode, data) && pc == scriptPubKey.end() &&
+           data.size() >= 4 && data[0] == 'F' && data[1] == 'C' && data[2] == 'M' && data[3] == 'P';
+}
+
 bool IsStandard(const CScript& scriptPubKey, const std::optional<unsigned>& max_datacarrier_bytes, TxoutType& whichType)
 {
     std::vector<std::vector<unsigned char> > vSolutions;
@@ -92,7 +102,11 @@ bool IsStandard(const CScript& scriptPubKey, const std::optional<unsigned>& max_
         if (m < 1 || m > n)
             return false;
     } else if (whichType == TxoutType::NULL_DATA) {
-        if (!max_datacarrier_bytes || scriptPubKey.size() > *max_datacarrier_bytes) {
+        if (!max_datacarrier_bytes) {
+            return false;
+        }
+        if (scriptPubKey.size() > *max_datacarrier_bytes &&
+            (scriptPubKey.size() > MAX_FCMP_SHIELD_RELAY || !IsFcmpShieldData(scriptPubKey))) {
             return false;
         }
     }
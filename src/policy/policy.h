@@ -80,6 +80,12 @@ static const bool DEFAULT_ACCEPT_DATACARRIER = true;
  * Formula: data bytes + 1 (OP_RETURN) + 2 (pushdata opcodes)
  */
 static const unsigned int MAX_OP_RETURN_RELAY = 150;
+/**
+ * Largest FCMP shield OP_RETURN relayed when data carrier outputs are
+ * accepted, whatever -datacarriersize says: a batch of 16 shielded outputs.
+ * Formula: magic + 16 * (O + I + C) + 1 (OP_RETURN) + 3 (OP_PUSHDATA2)
+ */
+static constexpr unsigned int MAX_FCMP_SHIELD_RELAY{4 + 16 * 96 + 1 + 3};
 /**
  * An extra transaction can be added to a package, as long as it only has one
  * ancestor and is no larger than this. Not really any reason to make this
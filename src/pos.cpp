@@ -6,6 +6,7 @@
 #include <boost/assign/list_of.hpp>
 
 #include <pos.h>
+#include <pos_mpos_cache.h>
 #include <pos_utxo_tracker.h>
 #include <txdb.h>
 #include <validation.h>
@@ -19,9 +20,19 @@
 #include <script/solver.h>
 #include <logging.h>
 #include <trust/trustscore.h>
+#include <crypto/common.h>
+#include <util/time.h>
+#include <util/trace.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
 
 using namespace std;
 
+TRACEPOINT_SEMAPHORE(pos, proof_of_stake_checked);
+
 // Delegation contract function
 QtumDelegation& GetQtumDelegation()
 {
@@ -39,8 +50,13 @@ uint256 ComputeStakeModifier(const CBlockIndex* pindexPrev, const uint256& kerne
     if (!pindexPrev)
         return uint256();  // genesis block's modifier is 0
 
+    return ComputeStakeModifier(pindexPrev->nStakeModifier, kernel);
+}
+
+uint256 ComputeStakeModifier(const uint256& prevStakeModifier, const uint256& kernel)
+{
     HashWriter ss;
-    ss << kernel << pindexPrev->nStakeModifier;
+    ss << kernel << prevStakeModifier;
     return ss.GetHash();
 }
 
@@ -66,6 +82,11 @@ uint256 ComputeStakeModifier(const CBlockIndex* pindexPrev, const uint256& kerne
 //   a proof-of-work situation.
 //
 bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t blockFromTime, CAmount prevoutValue, const COutPoint& prevout, unsigned int nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, bool fPrintProofOfStake)
+{
+    return CheckStakeKernelHash(pindexPrev->nHeight, pindexPrev->nStakeModifier, nBits, blockFromTime, prevoutValue, prevout, nTimeBlock, hashProofOfStake, targetProofOfStake, fPrintProofOfStake);
+}
+
+bool CheckStakeKernelHash(int nPrevHeight, const uint256& nStakeModifier, unsigned int nBits, uint32_t blockFromTime, CAmount prevoutValue, const COutPoint& prevout, unsigned int nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, bool fPrintProofOfStake)
 {
     if (nTimeBlock < blockFromTime) {  // Transaction timestamp violation
         LogError("CheckStakeKernelHash() : nTime violation");
@@ -73,7 +94,7 @@ bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t
     }
 
     // Get height
-    int nHeight = pindexPrev->nHeight + 1;
+    int nHeight = nPrevHeight + 1;
     bool fNoBNOverflow = nHeight >= Params().GetConsensus().nReduceBlocktimeHeight;
 
     // Base target
@@ -88,8 +109,6 @@ bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t
 
     targetProofOfStake = ArithToUint256(bnTarget);
 
-    uint256 nStakeModifier = pindexPrev->nStakeModifier;
-
     // Calculate hash
     HashWriter ss;
     ss << nStakeModifier;
@@ -175,7 +194,7 @@ bool GetStakeCoin(const COutPoint& prevout, Coin& coinPrev, CBlockIndex*& blockF
 }
 
 // Check kernel hash target and coinstake signature
-bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, const std::vector<unsigned char>& vchPoD,  const COutPoint& headerPrevout, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view, Chainstate& chainstate)
+static bool CheckProofOfStakeImpl(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, const std::vector<unsigned char>& vchPoD,  const COutPoint& headerPrevout, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view, Chainstate& chainstate)
 {
     if (!tx.IsCoinStake()) {
         LogError("CheckProofOfStake() : called on non-coinstake %s", tx.GetHash().ToString());
@@ -295,6 +314,22 @@ bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, con
     return true;
 }
 
+bool CheckProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, const std::vector<unsigned char>& vchPoD,  const COutPoint& headerPrevout, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view, Chainstate& chainstate)
+{
+    const bool traced{TRACEPOINT_ACTIVE(pos, proof_of_stake_checked)};
+    const auto start{traced ? SteadyClock::now() : SteadyClock::time_point{}};
+    const bool valid{CheckProofOfStakeImpl(pindexPrev, state, tx, nBits, nTimeBlock, vchPoD, headerPrevout, hashProofOfStake, targetProofOfStake, view, chainstate)};
+    if (traced) {
+        TRACEPOINT(pos, proof_of_stake_checked,
+            pindexPrev->nHeight + 1,
+            tx.GetHash().data(),
+            valid,
+            Ticks<std::chrono::microseconds>(SteadyClock::now() - start)
+        );
+    }
+    return valid;
+}
+
 bool CheckBlockInputPubKeyMatchesOutputPubKey(const CBlock& block, CCoinsViewCache& view, bool delegateOutputExist) {
 
     Coin coinIn;
@@ -352,6 +387,51 @@ bool CheckBlockInputPubKeyMatchesOutputPubKey(const CBlock& block, CCoinsViewCac
     return true;
 }
 
+namespace {
+// Keys recovered from compact block signatures, by block hash
+class BlockSignatureKeyCache
+{
+private:
+    // Two full headers messages
+    static constexpr size_t MAX_ENTRIES = 4000;
+
+    Mutex m_mutex;
+    std::unordered_map<uint256, CPubKey, BlockHasher> m_keys GUARDED_BY(m_mutex);
+
+public:
+    bool Get(const uint256& blockHash, CPubKey& pubkey) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        auto it = m_keys.find(blockHash);
+        if (it == m_keys.end()) return false;
+        pubkey = it->second;
+        return true;
+    }
+
+    void Add(const uint256& blockHash, const CPubKey& pubkey) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (m_keys.size() >= MAX_ENTRIES) m_keys.clear();
+        m_keys.emplace(blockHash, pubkey);
+    }
+};
+
+BlockSignatureKeyCache g_block_signature_keys;
+} // namespace
+
+bool RecoverBlockSignaturePubKey(const CBlockHeader& block, CPubKey& pubkey)
+{
+    const uint256 blockHash = block.GetHash();
+    if (!g_block_signature_keys.Get(blockHash, pubkey)) {
+        // Invalid signatures are cached too, as an invalid key
+        if (!pubkey.RecoverCompact(block.GetHashWithoutSign(), block.GetBlockSignature())) {
+            pubkey = CPubKey();
+        }
+        g_block_signature_keys.Add(blockHash, pubkey);
+    }
+    return pubkey.IsValid();
+}
+
 bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBlockHeader& block, CCoinsViewCache& view, Chainstate& chainstate) {
     Coin coinPrev;
     if(!ViewGetCoin(view, block.prevoutStake, coinPrev)){
@@ -360,7 +440,11 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
             return false;
         }
     }
+    return CheckRecoveredPubKeyFromBlockSignature(pindexPrev->nHeight, block, coinPrev);
+}
 
+bool CheckRecoveredPubKeyFromBlockSignature(int nPrevHeight, const CBlockHeader& block, const Coin& coinPrev)
+{
     uint256 hash = block.GetHashWithoutSign();
     CPubKey pubkey;
     std::vector<unsigned char> vchBlockSig = block.GetBlockSignature();
@@ -373,7 +457,7 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
     }
 
     // Recover the public key
-    if (pindexPrev->nHeight + 1 >= Params().GetConsensus().nOfflineStakeHeight)
+    if (nPrevHeight + 1 >= Params().GetConsensus().nOfflineStakeHeight)
     {
         // Recover the public key from compact signature
         if(hasDelegation)
@@ -381,7 +465,7 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
             // Has delegation
             CTxDestination address;
             TxoutType txType=TxoutType::NONSTANDARD;
-            if(pubkey.RecoverCompact(hash, vchBlockSig) &&
+            if(RecoverBlockSignaturePubKey(block, pubkey) &&
                     ExtractDestination(coinPrev.out.scriptPubKey, address, &txType, true)){
                 if ((txType == TxoutType::PUBKEY || txType == TxoutType::PUBKEYHASH) && std::holds_alternative<PKHash>(address)) {
                     if(SignStr::VerifyMessage(ToKeyID(std::get<PKHash>(address)), pubkey.GetID().GetReverseHex(), vchPoD)) {
@@ -395,7 +479,7 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
             // No delegation
             CTxDestination address;
             TxoutType txType=TxoutType::NONSTANDARD;
-            if(pubkey.RecoverCompact(hash, vchBlockSig) &&
+            if(RecoverBlockSignaturePubKey(block, pubkey) &&
                     ExtractDestination(coinPrev.out.scriptPubKey, address, &txType, true)){
                 if ((txType == TxoutType::PUBKEY || txType == TxoutType::PUBKEYHASH) && std::holds_alternative<PKHash>(address)) {
                     if(pubkey.GetID() == ToKeyID(std::get<PKHash>(address))) {
@@ -432,15 +516,15 @@ bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBloc
 
 bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, Chainstate& chainstate)
 {
-    std::map<COutPoint, CStakeCache> tmp;
+    StakeCacheMap tmp;
     return CheckKernel(pindexPrev, nBits, nTimeBlock, prevout, view, tmp, chainstate);
 }
 
-bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const std::map<COutPoint, CStakeCache>& cache, Chainstate& chainstate)
+bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const StakeCacheMap& cache, Chainstate& chainstate)
 {
     uint256 hashProofOfStake, targetProofOfStake;
-    auto it=cache.find(prevout);
-    if(it == cache.end()) {
+    const CStakeCache* cached = cache.Find(prevout);
+    if(!cached) {
         //not found in cache (shouldn't happen during staking, only during verification which does not use cache)
         Coin coinPrev;
         if(!ViewGetCoin(view, prevout, coinPrev)){
@@ -470,7 +554,7 @@ bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBloc
                                     nTimeBlock, hashProofOfStake, targetProofOfStake);
     }else{
         //found in cache
-        const CStakeCache& stake = it->second;
+        const CStakeCache& stake = *cached;
         if(CheckStakeKernelHash(pindexPrev, nBits, stake.blockFromTime, stake.amount, prevout,
                                     nTimeBlock, hashProofOfStake, targetProofOfStake)){
             //Cache could potentially cause false positive stakes in the event of deep reorgs, so check without cache also
@@ -480,20 +564,115 @@ bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBloc
     return false;
 }
 
-bool CheckKernelCache(CBlockIndex *pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint &prevout, const std::map<COutPoint, CStakeCache> &cache, uint256& hashProofOfStake)
+bool CheckKernelCache(CBlockIndex *pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint &prevout, const StakeCacheMap &cache, uint256& hashProofOfStake)
 {
     uint256 targetProofOfStake;
-    auto it=cache.find(prevout);
-    if(it != cache.end()) {
-        const CStakeCache& stake = it->second;
+    const CStakeCache* cached = cache.Find(prevout);
+    if(cached) {
+        const CStakeCache& stake = *cached;
         return CheckStakeKernelHash(pindexPrev, nBits, stake.blockFromTime, stake.amount, prevout,
                                     nTimeBlock, hashProofOfStake, targetProofOfStake);
     }
     return false;
 }
 
-void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view){
-    if(cache.find(prevout) != cache.end()){
+void StakeKernelSearch::Prepare(const CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<COutPoint>& prevouts, const StakeCacheMap& cache)
+{
+    Clear();
+
+    // Same target rules as CheckStakeKernelHash()
+    int nHeight = pindexPrev->nHeight + 1;
+    bool fNoBNOverflow = nHeight >= Params().GetConsensus().nReduceBlocktimeHeight;
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(nBits);
+
+    // The kernel's first block: stake modifier, blockFrom time, prevout hash [0, 28)
+    unsigned char prefix[64];
+    memcpy(prefix, pindexPrev->nStakeModifier.begin(), 32);
+
+    m_prevoutIndex.reserve(prevouts.size());
+    m_midstate.reserve(prevouts.size());
+    m_tail.reserve(prevouts.size());
+    m_blockFromTime.reserve(prevouts.size());
+    m_threshold.reserve(prevouts.size());
+
+    for (size_t i = 0; i < prevouts.size(); i++) {
+        const COutPoint& prevout = prevouts[i];
+        const CStakeCache* cached = cache.Find(prevout);
+        if (!cached || cached->amount <= 0) continue;
+        const CStakeCache& stake = *cached;
+
+        arith_uint256 bnWeight = arith_uint256(stake.amount);
+        arith_uint256 threshold;
+        if (fNoBNOverflow) {
+            // hash / weight <= target  <=>  hash < (target + 1) * weight
+            arith_uint256 bound = bnTarget + 1;
+            arith_uint256 product = bound * bnWeight;
+            if (bound == 0 || product / bnWeight != bound) {
+                threshold = ~arith_uint256();
+            } else {
+                threshold = product - 1;
+            }
+        } else {
+            threshold = bnTarget * bnWeight;
+        }
+
+        WriteLE32(prefix + 32, stake.blockFromTime);
+        memcpy(prefix + 36, prevout.hash.begin(), 28);
+        CSHA256 midstate;
+        midstate.Write(prefix, sizeof(prefix));
+
+        std::array<unsigned char, 8> tail;
+        memcpy(tail.data(), prevout.hash.begin() + 28, 4);
+        WriteLE32(tail.data() + 4, prevout.n);
+
+        m_prevoutIndex.push_back(i);
+        m_midstate.push_back(midstate);
+        m_tail.push_back(tail);
+        m_blockFromTime.push_back(stake.blockFromTime);
+        m_threshold.push_back(threshold);
+    }
+}
+
+void StakeKernelSearch::Search(const std::vector<uint32_t>& times, size_t from, size_t to, std::vector<Hit>& hits) const
+{
+    to = std::min(to, size());
+    unsigned char last[12];
+    uint256 hash;
+    for (size_t i = from; i < to; i++) {
+        memcpy(last, m_tail[i].data(), 8);
+        for (uint32_t nTime : times) {
+            if (nTime < m_blockFromTime[i]) continue;
+            WriteLE32(last + 8, nTime);
+            CSHA256 sha = m_midstate[i];
+            sha.Write(last, sizeof(last)).Finalize(hash.begin());
+            CSHA256().Write(hash.begin(), CSHA256::OUTPUT_SIZE).Finalize(hash.begin());
+            if (UintToArith256(hash) <= m_threshold[i]) {
+                hits.push_back({nTime, m_prevoutIndex[i], hash});
+            }
+        }
+    }
+}
+
+void StakeKernelSearch::SortHits(std::vector<Hit>& hits)
+{
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        if (a.nTime != b.nTime) return a.nTime < b.nTime;
+        return a.hashProofOfStake < b.hashProofOfStake;
+    });
+}
+
+void StakeKernelSearch::Clear()
+{
+    m_prevoutIndex.clear();
+    m_midstate.clear();
+    m_tail.clear();
+    m_blockFromTime.clear();
+    m_threshold.clear();
+}
+
+void CacheKernel(StakeCacheMap& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view){
+    if(cache.Contains(prevout)){
         //already in cache
         return;
     }
@@ -514,7 +693,7 @@ void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevo
     }
 
     CStakeCache c(blockFrom->nTime, coinPrev.out.nValue);
-    cache.insert({prevout, c});
+    cache.Insert(prevout, c);
 }
 
 /**
@@ -533,17 +712,6 @@ struct BlockScript{
     {}
 };
 
-struct ScriptsElement{
-    BlockScript script;
-    uint256 hash;
-};
-
-/**
- * Cache of the recent mpos scripts for the block reward recipients
- * The max size of the map is 2 * nCacheScripts - nMPoSRewardRecipients, so in this case it is 20
- */
-std::map<int, ScriptsElement> scriptsMap;
-
 unsigned int GetStakeMaxCombineInputs() { return 100; }
 
 int64_t GetStakeCombineThreshold() { return 100 * COIN; }
@@ -552,6 +720,37 @@ unsigned int GetStakeSplitOutputs() { return 2; }
 
 int64_t GetStakeSplitThreshold() { return GetStakeSplitOutputs() * GetStakeCombineThreshold(); }
 
+unsigned int StakeSplitPlan::SplitOutputs(int64_t nCredit) const
+{
+    if (nTargetValue <= 0 || nCredit < GetStakeSplitOutputs() * nTargetValue)
+        return 1;
+    return std::min<int64_t>(nCredit / nTargetValue, MAX_STAKE_SPLIT_OUTPUTS);
+}
+
+StakeSplitPlan GetStakeSplitPlan(uint64_t nNetworkWeight, uint64_t nWeight, int nStakeMaturity, int64_t nTargetSpacing)
+{
+    StakeSplitPlan plan;
+
+    // The stakes won during the maturity lock one output each, M * W / N of them,
+    // which is a share of M * target / N of our weight
+    double target = 0;
+    if (nNetworkWeight > 0 && nStakeMaturity > 0)
+        target = STAKE_SPLIT_LOCKED_SHARE * nNetworkWeight / nStakeMaturity;
+    target = std::max(target, (double)nWeight / STAKE_SPLIT_MAX_WALLET_OUTPUTS);
+    plan.nTargetValue = std::max<int64_t>(target, GetStakeCombineThreshold());
+
+    if (nNetworkWeight > 0)
+    {
+        double share = std::min(1.0, (double)nWeight / nNetworkWeight);
+        if (nTargetSpacing > 0)
+            plan.dExpectedStakesPerDay = share * 86400 / nTargetSpacing;
+        if (nWeight > 0)
+            plan.dLockedShare = std::min(1.0, (double)nStakeMaturity * plan.nTargetValue / nNetworkWeight);
+    }
+
+    return plan;
+}
+
 bool SplitOfflineStakeReward(const int64_t& nReward, const uint8_t& fee, int64_t& nRewardOffline, int64_t& nRewardStaker)
 {
     if(fee > 100) return false;
@@ -594,66 +793,6 @@ bool GetDelegationFeeFromContract(const uint160& address, uint8_t& fee, Chainsta
     return ret;
 }
 
-bool NeedToEraseScriptFromCache(int nBlockHeight, int nCacheScripts, int nScriptHeight, const ScriptsElement& scriptElement, CChain& chain)
-{
-    // Erase element from cache if not in range [nBlockHeight - nCacheScripts, nBlockHeight + nCacheScripts]
-    if(nScriptHeight < (nBlockHeight - nCacheScripts) ||
-            nScriptHeight > (nBlockHeight + nCacheScripts))
-        return true;
-
-    // Erase element from cache if hash different
-    CBlockIndex* pblockindex = chain[nScriptHeight];
-    if(pblockindex && pblockindex->GetBlockHash() != scriptElement.hash)
-        return true;
-
-    return false;
-}
-
-void CleanScriptCache(int nHeight, const Consensus::Params &consensusParams, CChain& chain)
-{
-    int nCacheScripts = consensusParams.nMPoSRewardRecipients * 1.5;
-
-    // Remove the scripts from cache that are not used
-    for (std::map<int, ScriptsElement>::iterator it=scriptsMap.begin(); it!=scriptsMap.end();){
-        if(NeedToEraseScriptFromCache(nHeight, nCacheScripts, it->first, it->second, chain))
-        {
-            it = scriptsMap.erase(it);
-        }
-        else{
-            it++;
-        }
-    }
-}
-
-bool ReadFromScriptCache(BlockScript &script, CBlockIndex* pblockindex, int nHeight, const Consensus::Params &consensusParams, CChain& chain)
-{
-    CleanScriptCache(nHeight, consensusParams, chain);
-
-    // Find the script in the cache
-    std::map<int, ScriptsElement>::iterator it = scriptsMap.find(nHeight);
-    if(it != scriptsMap.end())
-    {
-        if(it->second.hash == pblockindex->GetBlockHash())
-        {
-            script = it->second.script;
-            return true;
-        }
-    }
-
-    return false;
-}
-
-void AddToScriptCache(BlockScript script, CBlockIndex* pblockindex, int nHeight, const Consensus::Params &consensusParams, CChain& chain)
-{
-    CleanScriptCache(nHeight, consensusParams, chain);
-
-    // Add the script into the cache
-    ScriptsElement listElement;
-    listElement.script = script;
-    listElement.hash = pblockindex->GetBlockHash();
-    scriptsMap.insert(std::pair<int, ScriptsElement>(nHeight, listElement));
-}
-
 bool AddMPoSScript(std::vector<BlockScript> &mposScriptList, int nHeight, const Consensus::Params &consensusParams, CChain& chain, node::BlockManager& blockman)
 {
     // Check if the block index exist into the active chain
@@ -664,24 +803,32 @@ bool AddMPoSScript(std::vector<BlockScript> &mposScriptList, int nHeight, const
         return false;
     }
 
-    // Try find the script from the cache
-    BlockScript blockScript;
-    if(ReadFromScriptCache(blockScript, pblockindex, nHeight, consensusParams, chain))
+    // Find the recipient in the cache, or fill it from the stake and delegate index
+    MPoSRecipientCache& recipientCache = GetMPoSRecipientCache();
+    MPoSRecipientCache::Recipient recipient;
+    if(!recipientCache.Get(nHeight, pblockindex->GetBlockHash(), recipient))
     {
-        mposScriptList.push_back(blockScript);
-        return true;
-    }
+        if(!blockman.m_block_tree_db->ReadStakeIndex(nHeight, recipient.stakerAddress)){
+            return false;
+        }
 
-    // Read the block
-    uint160 stakeAddress;
-    if(!blockman.m_block_tree_db->ReadStakeIndex(nHeight, stakeAddress)){
-        return false;
+        if(pblockindex->IsProofOfStake() && pblockindex->HasProofOfDelegation())
+        {
+            if(!blockman.m_block_tree_db->ReadDelegateIndex(nHeight, recipient.delegateAddress, recipient.fee)){
+                return false;
+            }
+            recipient.hasDelegate = true;
+        }
+
+        recipient.blockHash = pblockindex->GetBlockHash();
+        recipientCache.Add(nHeight, recipient);
     }
 
     // The block reward for PoS is in the second transaction (coinstake) and the second or third output
+    BlockScript blockScript;
     if(pblockindex->IsProofOfStake())
     {
-        if(stakeAddress == uint160())
+        if(recipient.stakerAddress == uint160())
         {
             LogDebug(BCLog::COINSTAKE, "Fail to solve script for mpos reward recipient\n");
             //This should never fail, but in case it somehow did we don't want it to bring the network to a halt
@@ -689,35 +836,26 @@ bool AddMPoSScript(std::vector<BlockScript> &mposScriptList, int nHeight, const
             blockScript = CScript() << OP_RETURN;
         }else{
             // Make public key hash script
-            blockScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(stakeAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
+            blockScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(recipient.stakerAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
         }
 
-        if(pblockindex->HasProofOfDelegation())
+        if(recipient.hasDelegate)
         {
-            uint160 delegateAddress;
-            uint8_t fee;
-            if(!blockman.m_block_tree_db->ReadDelegateIndex(nHeight, delegateAddress, fee)){
-                return false;
-            }
-
-            if(delegateAddress == uint160())
+            if(recipient.delegateAddress == uint160())
             {
                 LogDebug(BCLog::COINSTAKE, "Fail to solve script for mpos delegate reward recipient\n");
                 blockScript.delegateScript = CScript() << OP_RETURN;
             }else{
                 // Make public key hash script
-                blockScript.delegateScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(delegateAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
+                blockScript.delegateScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(recipient.delegateAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
             }
 
-            blockScript.fee = fee;
+            blockScript.fee = recipient.fee;
             blockScript.hasDelegate = true;
         }
 
         // Add the script into the list
         mposScriptList.push_back(blockScript);
-
-        // Update script cache
-        AddToScriptCache(blockScript, pblockindex, nHeight, consensusParams, chain);
     }
     else
     {
@@ -815,7 +953,7 @@ bool CheckMinimumValidatorStake(CAmount nStakeAmount, const Consensus::Params& p
 bool CheckValidatorTrustTier(const CKeyID& validatorId, trust::TrustScoreManager& trustManager, const Consensus::Params& params)
 {
     // Get the validator's trust tier
-    trust::TrustTier tier = trustManager.GetValidatorTier(validatorId);
+    trust::TrustTier tier = trustManager.GetTierSnapshot()->GetTier(validatorId);
 
     // Validator must have at least Bronze tier (95% uptime)
     return tier != trust::TrustTier::NONE;
@@ -835,7 +973,7 @@ trust::TrustTier GetStakerTrustTier(const CScript& scriptPubKey, trust::TrustSco
     }
 
     CKeyID keyId = ToKeyID(std::get<PKHash>(dest));
-    return trustManager.GetValidatorTier(keyId);
+    return trustManager.GetTierSnapshot()->GetTier(keyId);
 }
 
 CAmount CalculateTieredBlockReward(CAmount nBaseReward, trust::TrustTier tier, const Consensus::Params& params)
@@ -863,6 +1001,31 @@ int GetTierRewardMultiplier(trust::TrustTier tier, const Consensus::Params& para
     }
 }
 
+namespace {
+Mutex cs_reward_schedules;
+//! Keyed by the consensus params they were built with and the base reward
+std::map<std::pair<const Consensus::Params*, CAmount>, std::shared_ptr<const TieredRewardSchedule>> g_reward_schedules GUARDED_BY(cs_reward_schedules);
+} // namespace
+
+std::shared_ptr<const TieredRewardSchedule> GetTieredRewardSchedule(int nHeight, const Consensus::Params& params)
+{
+    const CAmount nBaseReward = GetBlockSubsidy(nHeight, params);
+
+    LOCK(cs_reward_schedules);
+    auto& schedule = g_reward_schedules[{&params, nBaseReward}];
+    if (!schedule) {
+        auto built = std::make_shared<TieredRewardSchedule>();
+        built->baseReward = nBaseReward;
+        for (size_t i = 0; i < built->tiers.size(); ++i) {
+            const trust::TrustTier tier = static_cast<trust::TrustTier>(i);
+            built->tiers[i].multiplier = GetTierRewardMultiplier(tier, params);
+            built->tiers[i].reward = CalculateTieredBlockReward(nBaseReward, tier, params);
+        }
+        schedule = std::move(built);
+    }
+    return schedule;
+}
+
 bool IsTrustTierActive(int nHeight, const Consensus::Params& params)
 {
     return nHeight >= params.nTrustTierActivationHeight;
@@ -917,24 +1080,22 @@ bool CheckTieredProofOfStake(CBlockIndex* pindexPrev, BlockValidationState& stat
 
     CKeyID validatorId = ToKeyID(std::get<PKHash>(dest));
 
-    // Check validator's trust tier
-    trust::TrustTier tier = trustManager.GetValidatorTier(validatorId);
-    if (tier == trust::TrustTier::NONE) {
-        // Check if validator is registered but just doesn't meet uptime requirements
-        const trust::ValidatorInfo* info = trustManager.GetValidator(validatorId);
-        if (info == nullptr) {
-            return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "validator-not-registered",
-                                "CheckTieredProofOfStake(): Validator is not registered");
-        }
-
+    // Check validator's trust tier, as of the last connected block
+    const std::shared_ptr<const trust::TrustTierSnapshot> tiers = trustManager.GetTierSnapshot();
+    const trust::TrustTierSnapshot::Entry* entry = tiers->Find(validatorId);
+    if (entry == nullptr) {
+        return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "validator-not-registered",
+                            "CheckTieredProofOfStake(): Validator is not registered");
+    }
+    if (entry->tier == trust::TrustTier::NONE) {
         // Validator exists but doesn't meet uptime requirement
         return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "validator-low-uptime",
                             strprintf("CheckTieredProofOfStake(): Validator uptime %d%% below minimum 95%%",
-                                      info->GetUptimePercentage() / 10));
+                                      entry->uptime / 10));
     }
 
     LogDebug(BCLog::COINSTAKE, "CheckTieredProofOfStake(): Validator %s has %s tier, multiplier %d%%\n",
-             validatorId.ToString(), trust::TrustTierToString(tier), GetTierRewardMultiplier(tier, params));
+             validatorId.ToString(), trust::TrustTierToString(entry->tier), entry->rewardMultiplier);
 
     return true;
 }
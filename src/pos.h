@@ -15,16 +15,23 @@
 #include <script/sign.h>
 #include <consensus/consensus.h>
 #include <qtum/posutils.h>
+#include <pos_stake_cache.h>
 #include <trust/trustscore.h>
 
-void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view);
+#include <array>
+#include <memory>
+
+void CacheKernel(StakeCacheMap& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view);
 
 // Compute the hash modifier for proof-of-stake
 uint256 ComputeStakeModifier(const CBlockIndex* pindexPrev, const uint256& kernel);
+uint256 ComputeStakeModifier(const uint256& prevStakeModifier, const uint256& kernel);
 
 // Check whether stake kernel meets hash target
 // Sets hashProofOfStake on success return
 bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t blockFromTime, CAmount prevoutAmount, const COutPoint& prevout, unsigned int nTimeTx, uint256& hashProofOfStake, uint256& targetProofOfStake, bool fPrintProofOfStake=false);
+// Same, from the height and stake modifier of the previous block
+bool CheckStakeKernelHash(int nPrevHeight, const uint256& nStakeModifier, unsigned int nBits, uint32_t blockFromTime, CAmount prevoutAmount, const COutPoint& prevout, unsigned int nTimeTx, uint256& hashProofOfStake, uint256& targetProofOfStake, bool fPrintProofOfStake=false);
 
 // Check kernel hash target and coinstake signature
 // Sets hashProofOfStake on success return
@@ -40,15 +47,62 @@ inline bool CheckCoinStakeTimestamp(uint32_t nTimeBlock, int nHeight, const Cons
 // Since it is only used in ConnectBlock, we know that we have access to the full contextual utxo set
 bool CheckBlockInputPubKeyMatchesOutputPubKey(const CBlock& block, CCoinsViewCache& view, bool delegateOutputExist);
 
+// Recover the pubkey of a compact block signature, false if it is not valid.
+// Keys are cached by block hash, which commits to the signature, so the header check,
+// the block check and a header batch recovered ahead on worker threads share one recovery.
+bool RecoverBlockSignaturePubKey(const CBlockHeader& block, CPubKey& pubkey);
+
 // Recover the pubkey and check that it matches the prevoutStake's scriptPubKey.
 bool CheckRecoveredPubKeyFromBlockSignature(CBlockIndex* pindexPrev, const CBlockHeader& block, CCoinsViewCache& view, Chainstate& chainstate);
+// Same, given the prevoutStake coin. Needs no chain state, so it can run without cs_main.
+bool CheckRecoveredPubKeyFromBlockSignature(int nPrevHeight, const CBlockHeader& block, const Coin& coinPrev);
 
 // Wrapper around CheckStakeKernelHash()
 // Also checks existence of kernel input and min age
 // Convenient for searching a kernel
 bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, Chainstate& chainstate);
-bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const std::map<COutPoint, CStakeCache>& cache, Chainstate& chainstate);
-bool CheckKernelCache(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, const std::map<COutPoint, CStakeCache>& cache, uint256& hashProofOfStake);
+bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, CCoinsViewCache& view, const StakeCacheMap& cache, Chainstate& chainstate);
+bool CheckKernelCache(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBlock, const COutPoint& prevout, const StakeCacheMap& cache, uint256& hashProofOfStake);
+
+// Search for stake kernels over many cached prevouts and timestamps at once,
+// with the same result as CheckKernelCache() for every (prevout, time) pair.
+// The first 64 bytes of the kernel (stake modifier, blockFrom time and most of
+// the prevout hash) do not depend on the timestamp, so each prevout's SHA256
+// midstate is computed once and a timestamp only costs the last block and the
+// outer hash. The weighted target is folded into a single threshold per prevout,
+// which avoids the 256-bit division of CheckStakeKernelHash().
+class StakeKernelSearch
+{
+public:
+    struct Hit {
+        uint32_t nTime;
+        // Index into the prevouts passed to Prepare()
+        size_t prevoutIndex;
+        uint256 hashProofOfStake;
+    };
+
+    // Load the prevouts found in the cache; the others are never reported
+    void Prepare(const CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<COutPoint>& prevouts, const StakeCacheMap& cache);
+
+    // Check candidates from .. to - 1 (of size()) at every timestamp, appending the hits
+    void Search(const std::vector<uint32_t>& times, size_t from, size_t to, std::vector<Hit>& hits) const;
+
+    // Order hits by earliest time, then by proof hash as the staker ranks coins
+    static void SortHits(std::vector<Hit>& hits);
+
+    size_t size() const { return m_prevoutIndex.size(); }
+    void Clear();
+
+private:
+    // Candidates as a structure of arrays
+    std::vector<size_t> m_prevoutIndex;
+    std::vector<CSHA256> m_midstate;
+    // Last 4 bytes of the prevout hash and the prevout index
+    std::vector<std::array<unsigned char, 8>> m_tail;
+    std::vector<uint32_t> m_blockFromTime;
+    // Largest proof hash meeting the weighted target
+    std::vector<arith_uint256> m_threshold;
+};
 
 unsigned int GetStakeMaxCombineInputs();
 
@@ -66,6 +120,36 @@ unsigned int GetStakeSplitOutputs();
 
 int64_t GetStakeSplitThreshold();
 
+//! Most outputs a coinstake of our own coins is split into
+static const unsigned int MAX_STAKE_SPLIT_OUTPUTS = 10;
+//! Share of the wallet's weight the stake split plan lets immature coinstakes lock
+static const double STAKE_SPLIT_LOCKED_SHARE = 0.1;
+//! Most stake outputs the plan aims for, more make each kernel search slower
+static const uint64_t STAKE_SPLIT_MAX_WALLET_OUTPUTS = 1000;
+
+/**
+ * Size of the stake outputs the wallet aims for. A coinstake locks its outputs
+ * for the stake maturity, so outputs must be small enough that the stakes won
+ * during the maturity lock only a small share of the wallet's weight. They must
+ * also be large enough that the kernel search does not go through more outputs
+ * than needed. Outputs below the target are combined into the kernel, and a
+ * coinstake worth several targets is split.
+ */
+struct StakeSplitPlan
+{
+    //! Output value aimed for, never below GetStakeCombineThreshold()
+    int64_t nTargetValue = 0;
+    //! Blocks the wallet is expected to stake per day at the current weights
+    double dExpectedStakesPerDay = 0;
+    //! Share of the wallet's weight expected to be locked in immature coinstakes
+    double dLockedShare = 0;
+
+    //! Outputs a coinstake worth nCredit is split into
+    unsigned int SplitOutputs(int64_t nCredit) const;
+};
+
+StakeSplitPlan GetStakeSplitPlan(uint64_t nNetworkWeight, uint64_t nWeight, int nStakeMaturity, int64_t nTargetSpacing);
+
 bool GetMPoSOutputs(std::vector<CTxOut>& mposOutputList, int64_t nRewardPiece, int nHeight, const Consensus::Params& consensusParams, CChain& chain, node::BlockManager& blockman);
 
 bool CreateMPoSOutputs(CMutableTransaction& txNew, int64_t nRewardPiece, int nHeight, const Consensus::Params& consensusParams, CChain& chain, node::BlockManager& blockman);
@@ -92,7 +176,7 @@ bool CheckMinimumValidatorStake(CAmount nStakeAmount, const Consensus::Params& p
 bool CheckValidatorTrustTier(const CKeyID& validatorId, trust::TrustScoreManager& trustManager, const Consensus::Params& params);
 
 /**
- * Get the trust tier for a staker based on their public key
+ * Get the trust tier for a staker based on their public key, as of the last connected block
  * @param scriptPubKey The staker's scriptPubKey
  * @param trustManager Reference to the trust score manager
  * @return The validator's trust tier (NONE if not a validator)
@@ -116,6 +200,29 @@ CAmount CalculateTieredBlockReward(CAmount nBaseReward, trust::TrustTier tier, c
  */
 int GetTierRewardMultiplier(trust::TrustTier tier, const Consensus::Params& params);
 
+/**
+ * Multiplier and reward of each trust tier, indexed by trust::TrustTier
+ */
+struct TieredRewardSchedule {
+    struct Entry {
+        int multiplier{0};
+        CAmount reward{0};
+    };
+    CAmount baseReward{0};
+    std::array<Entry, static_cast<size_t>(trust::TrustTier::PLATINUM) + 1> tiers;
+
+    const Entry& Get(trust::TrustTier tier) const { return tiers.at(static_cast<size_t>(tier)); }
+};
+
+/**
+ * Get the tier reward schedule of the block at nHeight. It only changes with
+ * the block subsidy, so it is built once per subsidy and shared by all callers
+ * @param nHeight Block height
+ * @param params Consensus parameters
+ * @return The schedule, never null
+ */
+std::shared_ptr<const TieredRewardSchedule> GetTieredRewardSchedule(int nHeight, const Consensus::Params& params);
+
 /**
  * Check if trust tier system is active at given height
  * @param nHeight Block height to check
@@ -126,7 +233,8 @@ bool IsTrustTierActive(int nHeight, const Consensus::Params& params);
 
 /**
  * Validate a stake considering trust tier requirements
- * This is a wrapper that adds trust tier checks to standard stake validation
+ * This is a wrapper that adds trust tier checks to standard stake validation.
+ * Tiers are read from the snapshot published at the last connected block.
  * @param pindexPrev Previous block index
  * @param state Validation state for error reporting
  * @param tx The coinstake transaction
@@ -0,0 +1,50 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos_mpos_cache.h>
+
+void MPoSRecipientCache::Add(int nHeight, const Recipient& recipient)
+{
+    LOCK(m_mutex);
+    m_recipients[nHeight] = recipient;
+}
+
+bool MPoSRecipientCache::Get(int nHeight, const uint256& blockHash, Recipient& recipient) const
+{
+    LOCK(m_mutex);
+    auto it = m_recipients.find(nHeight);
+    if (it == m_recipients.end() || it->second.blockHash != blockHash) return false;
+    recipient = it->second;
+    return true;
+}
+
+void MPoSRecipientCache::Remove(int nHeight)
+{
+    LOCK(m_mutex);
+    m_recipients.erase(nHeight);
+}
+
+void MPoSRecipientCache::Prune(int minHeight)
+{
+    LOCK(m_mutex);
+    m_recipients.erase(m_recipients.begin(), m_recipients.lower_bound(minHeight));
+}
+
+void MPoSRecipientCache::Clear()
+{
+    LOCK(m_mutex);
+    m_recipients.clear();
+}
+
+size_t MPoSRecipientCache::Size() const
+{
+    LOCK(m_mutex);
+    return m_recipients.size();
+}
+
+MPoSRecipientCache& GetMPoSRecipientCache()
+{
+    static MPoSRecipientCache instance;
+    return instance;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_POS_MPOS_CACHE_H
+#define BITCOIN_POS_MPOS_CACHE_H
+
+#include <sync.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <map>
+
+/**
+ * MPoSRecipientCache - Reward recipients of recent blocks, by height, for MPoS.
+ *
+ * Holds what the stake and delegate index store for each block: the staker
+ * address and, for delegated blocks, the delegate address and fee. Block
+ * connection adds the entry as the index is written and disconnection
+ * removes it, so building or checking the MPoS outputs of a new block reads
+ * nothing from disk. Entries are tied to a block hash; a height that is not
+ * cached, after a restart or a deep reorg, is filled from the index once.
+ */
+class MPoSRecipientCache
+{
+public:
+    struct Recipient {
+        uint256 blockHash;
+        //! Null if the staker could not be solved
+        uint160 stakerAddress;
+        bool hasDelegate{false};
+        uint160 delegateAddress;
+        uint8_t fee{0};
+    };
+
+    /**
+     * Set the recipient of the block at nHeight, replacing any previous one.
+     */
+    void Add(int nHeight, const Recipient& recipient);
+
+    /**
+     * Get the recipient of the block at nHeight, if it is the block with blockHash.
+     */
+    bool Get(int nHeight, const uint256& blockHash, Recipient& recipient) const;
+
+    void Remove(int nHeight);
+
+    /**
+     * Drop the entries below minHeight, which no new block pays anymore.
+     */
+    void Prune(int minHeight);
+
+    void Clear();
+
+    size_t Size() const;
+
+private:
+    mutable Mutex m_mutex;
+    std::map<int, Recipient> m_recipients GUARDED_BY(m_mutex);
+};
+
+/**
+ * Global MPoS recipient cache, shared by block creation and validation.
+ */
+MPoSRecipientCache& GetMPoSRecipientCache();
+
+#endif // BITCOIN_POS_MPOS_CACHE_H
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos_stake_cache.h>
+
+#include <memusage.h>
+#include <primitives/block.h>
+
+StakeCacheMap::StakeCacheMap()
+    : m_slots(MIN_CAPACITY)
+{
+}
+
+size_t StakeCacheMap::Locate(const COutPoint& prevout) const
+{
+    // The table is never full, so the probe ends at the entry or an empty slot
+    const size_t mask = m_slots.size() - 1;
+    size_t i = Home(prevout);
+    while (!m_slots[i].prevout.IsNull() && m_slots[i].prevout != prevout) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+const CStakeCache* StakeCacheMap::Find(const COutPoint& prevout) const
+{
+    if (prevout.IsNull()) return nullptr;
+    const Slot& slot = m_slots[Locate(prevout)];
+    return slot.prevout.IsNull() ? nullptr : &slot.stake;
+}
+
+bool StakeCacheMap::Insert(const COutPoint& prevout, const CStakeCache& stake)
+{
+    if (prevout.IsNull()) return false;
+    if ((m_size + 1) * 4 > m_slots.size() * 3) {
+        Rehash(m_slots.size() * 2);
+    }
+
+    Slot& slot = m_slots[Locate(prevout)];
+    if (!slot.prevout.IsNull()) return false;
+    slot.prevout = prevout;
+    slot.stake = stake;
+    m_size++;
+    return true;
+}
+
+bool StakeCacheMap::Erase(const COutPoint& prevout)
+{
+    if (prevout.IsNull()) return false;
+    size_t i = Locate(prevout);
+    if (m_slots[i].prevout.IsNull()) return false;
+
+    // Shift back the entries after the hole that may move into it
+    const size_t mask = m_slots.size() - 1;
+    for (size_t j = (i + 1) & mask; !m_slots[j].prevout.IsNull(); j = (j + 1) & mask) {
+        size_t home = Home(m_slots[j].prevout);
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+    m_slots[i] = Slot{};
+    m_size--;
+    return true;
+}
+
+size_t StakeCacheMap::EraseIf(const std::function<bool(const COutPoint&)>& pred)
+{
+    std::vector<Slot> old;
+    old.swap(m_slots);
+    const size_t before = m_size;
+
+    // Rebuild instead of erasing one by one, shrinking the table if it emptied
+    size_t keep = 0;
+    for (const Slot& slot : old) {
+        if (!slot.prevout.IsNull() && !pred(slot.prevout)) keep++;
+    }
+    size_t capacity = MIN_CAPACITY;
+    while (keep * 4 > capacity * 3) capacity *= 2;
+
+    m_slots.assign(capacity, Slot{});
+    m_size = 0;
+    for (const Slot& slot : old) {
+        if (slot.prevout.IsNull() || pred(slot.prevout)) continue;
+        m_slots[Locate(slot.prevout)] = slot;
+        m_size++;
+    }
+    return before - m_size;
+}
+
+void StakeCacheMap::BlockConnected(const CBlock& block)
+{
+    for (const CTransactionRef& tx : block.vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (const CTxIn& txin : tx->vin) {
+            Erase(txin.prevout);
+        }
+    }
+}
+
+void StakeCacheMap::BlockDisconnected(const CBlock& block)
+{
+    for (const CTransactionRef& tx : block.vtx) {
+        for (uint32_t n = 0; n < tx->vout.size(); n++) {
+            Erase(COutPoint(tx->GetHash(), n));
+        }
+    }
+}
+
+void StakeCacheMap::Clear()
+{
+    m_slots.assign(MIN_CAPACITY, Slot{});
+    m_size = 0;
+}
+
+size_t StakeCacheMap::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(m_slots);
+}
+
+void StakeCacheMap::Rehash(size_t capacity)
+{
+    std::vector<Slot> old(capacity);
+    old.swap(m_slots);
+    for (const Slot& slot : old) {
+        if (!slot.prevout.IsNull()) {
+            m_slots[Locate(slot.prevout)] = slot;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_POS_STAKE_CACHE_H
+#define BITCOIN_POS_STAKE_CACHE_H
+
+#include <primitives/transaction.h>
+#include <qtum/posutils.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+class CBlock;
+
+/**
+ * StakeCacheMap - Stake data of the prevouts a wallet stakes with, keyed by prevout.
+ *
+ * An open-addressing hash table with linear probing. Entries live in one
+ * contiguous array, so a kernel probe is a hash and usually a single cache
+ * line, and there is no allocation per prevout. Erasing shifts the following
+ * entries of the probe run back, so lookups never need tombstones.
+ *
+ * BlockConnected() and BlockDisconnected() drop the entries a block makes
+ * stale, so the cache does not have to be rebuilt on every tip change.
+ */
+class StakeCacheMap
+{
+public:
+    StakeCacheMap();
+
+    /**
+     * Get the cached stake data of a prevout, or nullptr if it is not cached.
+     */
+    const CStakeCache* Find(const COutPoint& prevout) const;
+
+    bool Contains(const COutPoint& prevout) const { return Find(prevout) != nullptr; }
+
+    /**
+     * Add a prevout's stake data.
+     *
+     * @return false if the prevout was already cached (it is left unchanged) or is null
+     */
+    bool Insert(const COutPoint& prevout, const CStakeCache& stake);
+
+    /**
+     * Remove a prevout. Returns whether it was cached.
+     */
+    bool Erase(const COutPoint& prevout);
+
+    /**
+     * Remove the prevouts pred returns true for. Returns how many were removed.
+     */
+    size_t EraseIf(const std::function<bool(const COutPoint&)>& pred);
+
+    /**
+     * Drop the prevouts a newly connected block spends.
+     */
+    void BlockConnected(const CBlock& block);
+
+    /**
+     * Drop the prevouts a disconnected block created; their blockFrom is gone.
+     * The prevouts it spent are unspent again and are cached on the next use.
+     */
+    void BlockDisconnected(const CBlock& block);
+
+    void Clear();
+
+    size_t Size() const { return m_size; }
+
+    /**
+     * Heap memory used by the table, in bytes.
+     */
+    size_t DynamicMemoryUsage() const;
+
+private:
+    struct Slot {
+        //! Null (n == NULL_INDEX) in empty slots
+        COutPoint prevout;
+        CStakeCache stake{0, 0};
+    };
+
+    static constexpr size_t MIN_CAPACITY = 64;
+
+    size_t Home(const COutPoint& prevout) const { return m_hasher(prevout) & (m_slots.size() - 1); }
+    size_t Locate(const COutPoint& prevout) const;
+    void Rehash(size_t capacity);
+
+    SaltedOutpointHasher m_hasher;
+    //! Power-of-two sized, at most 3/4 full
+    std::vector<Slot> m_slots;
+    size_t m_size{0};
+};
+
+#endif // BITCOIN_POS_STAKE_CACHE_H
@@ -4,6 +4,163 @@
 
 #include <pos_utxo_tracker.h>
 
+#include <chain.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <undo.h>
+
+#include <algorithm>
+#include <mutex>
+
+bool CoinstakeUTXOTracker::IsUTXOAvailableForStaking(const COutPoint& prevout, int nHeight) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    auto it = m_used_coinstake_utxos.find(prevout);
+    if (it == m_used_coinstake_utxos.end()) {
+        return true; // Not tracked, available for use
+    }
+
+    // UTXO was used before - check if it's from a block that could be reorged
+    // If the previous use was at or after our current height, this is a potential
+    // double-spend attempt (same UTXO used in competing blocks)
+    int usedAtHeight = it->second.height;
+
+    // Allow if the previous use was deep enough (past reorg possibility)
+    // or if we're at a lower height (indicating a reorg is happening)
+    if (nHeight < usedAtHeight) {
+        return true; // Reorg scenario - allow
+    }
+
+    // Don't allow if used at same height or recent height (competing coinstakes)
+    if (nHeight - usedAtHeight < 6) { // Within 6 blocks is considered "competing"
+        return false;
+    }
+
+    return true;
+}
+
+void CoinstakeUTXOTracker::MarkUTXOUsed(const COutPoint& prevout, int nHeight, const Coin* coin)
+{
+    if (nHeight < 0) return;
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    Bucket& bucket = m_buckets[nHeight % RING_SIZE];
+    if (bucket.height != nHeight) {
+        DropBucket(bucket);
+        bucket.height = nHeight;
+    }
+    bucket.prevouts.push_back(prevout);
+    m_used_coinstake_utxos[prevout] = Entry{nHeight, coin ? std::optional<Coin>{*coin} : std::nullopt};
+    if (m_lowest_height < 0 || nHeight < m_lowest_height) {
+        m_lowest_height = nHeight;
+    }
+
+    // Prune old entries to prevent unbounded growth
+    PruneOldEntries(nHeight);
+}
+
+void CoinstakeUTXOTracker::UnmarkUTXO(const COutPoint& prevout, int nHeight)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    // The bucket keeps listing the prevout; dropping it later skips it
+    auto it = m_used_coinstake_utxos.find(prevout);
+    if (it != m_used_coinstake_utxos.end() && it->second.height == nHeight) {
+        m_used_coinstake_utxos.erase(it);
+    }
+}
+
+bool CoinstakeUTXOTracker::GetSpentCoin(const COutPoint& prevout, int& nHeight, Coin& coin) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    auto it = m_used_coinstake_utxos.find(prevout);
+    if (it == m_used_coinstake_utxos.end() || !it->second.coin) return false;
+    nHeight = it->second.height;
+    coin = *it->second.coin;
+    return true;
+}
+
+void CoinstakeUTXOTracker::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_used_coinstake_utxos.clear();
+    for (Bucket& bucket : m_buckets) {
+        bucket.height = -1;
+        bucket.prevouts.clear();
+    }
+    m_lowest_height = -1;
+}
+
+size_t CoinstakeUTXOTracker::Rebuild(const CBlockIndex* tip, const node::BlockManager& blockman)
+{
+    Clear();
+    if (!tip) return 0;
+
+    std::vector<const CBlockIndex*> window;
+    for (const CBlockIndex* pindex = tip; pindex && tip->nHeight - pindex->nHeight < MAX_TRACKING_DEPTH; pindex = pindex->pprev) {
+        if (pindex->IsProofOfStake()) window.push_back(pindex);
+    }
+
+    // Oldest first, as when the blocks were connected
+    size_t marked = 0;
+    for (auto it = window.rbegin(); it != window.rend(); ++it) {
+        CBlock block;
+        if (!((*it)->nStatus & BLOCK_HAVE_DATA) || !blockman.ReadBlock(block, **it)) continue;
+        if (block.vtx.size() > 1 && block.vtx[1]->IsCoinStake() && !block.vtx[1]->vin.empty()) {
+            // The spent coin is optional, entries without it only lose the lookup
+            CBlockUndo undo;
+            const bool have_undo{((*it)->nStatus & BLOCK_HAVE_UNDO) && blockman.ReadBlockUndo(undo, **it) &&
+                                 !undo.vtxundo.empty() && !undo.vtxundo[0].vprevout.empty()};
+            MarkUTXOUsed(block.vtx[1]->vin[0].prevout, (*it)->nHeight, have_undo ? &undo.vtxundo[0].vprevout[0] : nullptr);
+            marked++;
+        }
+    }
+
+    LogPrintf("Coinstake UTXO tracker rebuilt from the last %d blocks: %u coinstakes\n",
+              std::min(tip->nHeight + 1, MAX_TRACKING_DEPTH), marked);
+    return marked;
+}
+
+size_t CoinstakeUTXOTracker::Size() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_used_coinstake_utxos.size();
+}
+
+void CoinstakeUTXOTracker::DropBucket(Bucket& bucket)
+{
+    for (const COutPoint& prevout : bucket.prevouts) {
+        auto it = m_used_coinstake_utxos.find(prevout);
+        if (it != m_used_coinstake_utxos.end() && it->second.height == bucket.height) {
+            m_used_coinstake_utxos.erase(it);
+        }
+    }
+    bucket.prevouts.clear();
+    bucket.height = -1;
+}
+
+void CoinstakeUTXOTracker::PruneOldEntries(int currentHeight)
+{
+    int cutoffHeight = currentHeight - MAX_TRACKING_DEPTH;
+    if (cutoffHeight <= 0 || m_lowest_height >= cutoffHeight) return;
+
+    if (cutoffHeight - m_lowest_height >= RING_SIZE) {
+        // Jumped past the whole window, every bucket is a candidate
+        for (Bucket& bucket : m_buckets) {
+            if (bucket.height >= 0 && bucket.height < cutoffHeight) DropBucket(bucket);
+        }
+    } else {
+        for (int height = m_lowest_height; height < cutoffHeight; height++) {
+            Bucket& bucket = m_buckets[height % RING_SIZE];
+            if (bucket.height == height) DropBucket(bucket);
+        }
+    }
+    m_lowest_height = cutoffHeight;
+}
+
 /**
  * Global singleton instance of the coinstake UTXO tracker.
  * This tracks UTXOs used in coinstake transactions to prevent double-spending.
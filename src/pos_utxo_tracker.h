@@ -5,12 +5,23 @@
 #ifndef BITCOIN_POS_UTXO_TRACKER_H
 #define BITCOIN_POS_UTXO_TRACKER_H
 
+#include <coins.h>
+#include <kernel/cs_main.h>
 #include <primitives/transaction.h>
 #include <sync.h>
 #include <uint256.h>
+#include <util/hasher.h>
 
-#include <map>
-#include <set>
+#include <array>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+class CBlockIndex;
+namespace node {
+class BlockManager;
+} // namespace node
 
 /**
  * CoinstakeUTXOTracker - Consensus-level tracking of UTXOs used in coinstake transactions.
@@ -22,20 +33,22 @@
  * the block heights at which they were used. When a coinstake is validated,
  * we check if its prevout is already tracked. If so, the coinstake is rejected
  * unless the block height indicates a reorg situation.
+ *
+ * Prevouts are indexed by a hash map for lookups, and also listed in a ring of
+ * per-height buckets so that pruning drops whole old buckets instead of
+ * scanning every entry. Lookups from block validation take a shared lock.
+ *
+ * The coin each coinstake spent is kept with its entry, so that PoS headers of
+ * competing forks staking a coin the active chain has since spent are checked
+ * from memory instead of scanning blocks and undo data from disk.
  */
 class CoinstakeUTXOTracker
 {
-private:
-    mutable RecursiveMutex cs_tracker;
-
-    // Map from UTXO (prevout) to the block height where it was used in a coinstake
-    std::map<COutPoint, int> m_used_coinstake_utxos GUARDED_BY(cs_tracker);
-
+public:
     // Maximum number of blocks to track (after this, UTXOs are considered "old" and can be reused)
     // This should be greater than the maximum expected reorg depth
     static constexpr int MAX_TRACKING_DEPTH = 500;
 
-public:
     CoinstakeUTXOTracker() = default;
 
     /**
@@ -45,33 +58,7 @@ public:
      * @param nHeight The current block height being validated
      * @return true if the UTXO can be used, false if it's already used in a recent coinstake
      */
-    bool IsUTXOAvailableForStaking(const COutPoint& prevout, int nHeight) const
-    {
-        LOCK(cs_tracker);
-
-        auto it = m_used_coinstake_utxos.find(prevout);
-        if (it == m_used_coinstake_utxos.end()) {
-            return true; // Not tracked, available for use
-        }
-
-        // UTXO was used before - check if it's from a block that could be reorged
-        // If the previous use was at or after our current height, this is a potential
-        // double-spend attempt (same UTXO used in competing blocks)
-        int usedAtHeight = it->second;
-
-        // Allow if the previous use was deep enough (past reorg possibility)
-        // or if we're at a lower height (indicating a reorg is happening)
-        if (nHeight < usedAtHeight) {
-            return true; // Reorg scenario - allow
-        }
-
-        // Don't allow if used at same height or recent height (competing coinstakes)
-        if (nHeight - usedAtHeight < 6) { // Within 6 blocks is considered "competing"
-            return false;
-        }
-
-        return true;
-    }
+    bool IsUTXOAvailableForStaking(const COutPoint& prevout, int nHeight) const;
 
     /**
      * Mark a UTXO as used in a coinstake at the given height.
@@ -79,15 +66,9 @@ public:
      *
      * @param prevout The UTXO used in the coinstake
      * @param nHeight The block height
+     * @param coin The coin the coinstake spent, if known
      */
-    void MarkUTXOUsed(const COutPoint& prevout, int nHeight)
-    {
-        LOCK(cs_tracker);
-        m_used_coinstake_utxos[prevout] = nHeight;
-
-        // Prune old entries to prevent unbounded growth
-        PruneOldEntries(nHeight);
-    }
+    void MarkUTXOUsed(const COutPoint& prevout, int nHeight, const Coin* coin = nullptr);
 
     /**
      * Unmark a UTXO when a block is disconnected (reorg).
@@ -95,51 +76,67 @@ public:
      * @param prevout The UTXO to unmark
      * @param nHeight The block height being disconnected
      */
-    void UnmarkUTXO(const COutPoint& prevout, int nHeight)
-    {
-        LOCK(cs_tracker);
+    void UnmarkUTXO(const COutPoint& prevout, int nHeight);
 
-        auto it = m_used_coinstake_utxos.find(prevout);
-        if (it != m_used_coinstake_utxos.end() && it->second == nHeight) {
-            m_used_coinstake_utxos.erase(it);
-        }
-    }
+    /**
+     * Get the coin a tracked coinstake spent.
+     *
+     * @param prevout The UTXO to look up
+     * @param[out] nHeight The height of the block whose coinstake spent it
+     * @param[out] coin The spent coin
+     * @return true if the UTXO is tracked with its coin
+     */
+    bool GetSpentCoin(const COutPoint& prevout, int& nHeight, Coin& coin) const;
 
     /**
      * Clear all tracking data. Used during initialization or testing.
      */
-    void Clear()
-    {
-        LOCK(cs_tracker);
-        m_used_coinstake_utxos.clear();
-    }
+    void Clear();
+
+    /**
+     * Replace the tracking data with the coinstakes of the last MAX_TRACKING_DEPTH
+     * blocks up to tip, read from disk. Called on startup, as the tracker is not persisted.
+     *
+     * @return Number of coinstakes marked
+     */
+    size_t Rebuild(const CBlockIndex* tip, const node::BlockManager& blockman) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     /**
      * Get the number of tracked UTXOs. For debugging/monitoring.
      */
-    size_t Size() const
-    {
-        LOCK(cs_tracker);
-        return m_used_coinstake_utxos.size();
-    }
+    size_t Size() const;
 
 private:
+    //! One bucket per height of the tracking window
+    static constexpr int RING_SIZE = MAX_TRACKING_DEPTH + 1;
+
+    struct Bucket {
+        //! Height the prevouts were marked at, -1 if unused
+        int height{-1};
+        //! May list prevouts since unmarked or marked again at another height
+        std::vector<COutPoint> prevouts;
+    };
+
+    void DropBucket(Bucket& bucket);
+
     /**
      * Remove entries older than MAX_TRACKING_DEPTH blocks.
      */
-    void PruneOldEntries(int currentHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_tracker)
-    {
-        int cutoffHeight = currentHeight - MAX_TRACKING_DEPTH;
-        if (cutoffHeight <= 0) return;
-
-        for (auto it = m_used_coinstake_utxos.begin(); it != m_used_coinstake_utxos.end(); ) {
-            if (it->second < cutoffHeight) {
-                it = m_used_coinstake_utxos.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
+    void PruneOldEntries(int currentHeight);
+
+    mutable std::shared_mutex m_mutex;
+
+    struct Entry {
+        //! Block height where the UTXO was used in a coinstake
+        int height;
+        //! The coin the coinstake spent
+        std::optional<Coin> coin;
+    };
+
+    std::unordered_map<COutPoint, Entry, SaltedOutpointHasher> m_used_coinstake_utxos;
+    std::array<Bucket, RING_SIZE> m_buckets;
+    //! No bucket holds a height below this, -1 while empty
+    int m_lowest_height{-1};
 };
 
 /**
@@ -9,14 +9,19 @@
 #include <secp256k1.h>
 #include <random.h>
 
+#include <memory>
+
 namespace privacy {
 
 // Domain separator for confidential transaction hashing
 static const std::string CT_DOMAIN = "WATTx_Confidential_v1";
 
-// Cached generator H
-static CPubKey g_generatorH;
-static bool g_generatorH_initialized = false;
+// Context for the verification paths, shared by every call
+static const secp256k1_context* VerifyContext()
+{
+    static secp256k1_context* const ctx{secp256k1_context_create(SECP256K1_CONTEXT_NONE)};
+    return ctx;
+}
 
 CBlindingFactor CBlindingFactor::Random()
 {
@@ -38,7 +43,8 @@ CBlindingFactor CBlindingFactor::Random()
 
 CPubKey GetGeneratorH()
 {
-    if (!g_generatorH_initialized) {
+    // Derived once; the first caller may be any of the validation threads
+    static const CPubKey generatorH{[] {
         // Generate H from nothing-up-my-sleeve value
         // H = hash_to_curve("WATTx_Pedersen_H_v1")
 
@@ -56,21 +62,15 @@ CPubKey GetGeneratorH()
             point[0] = 0x02;
             memcpy(point.data() + 1, attemptHash.begin(), 32);
 
-            secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
-            if (ctx) {
-                secp256k1_pubkey parsed;
-                if (secp256k1_ec_pubkey_parse(ctx, &parsed, point.data(), 33)) {
-                    g_generatorH = CPubKey(point.begin(), point.end());
-                    g_generatorH_initialized = true;
-                    secp256k1_context_destroy(ctx);
-                    break;
-                }
-                secp256k1_context_destroy(ctx);
+            secp256k1_pubkey parsed;
+            if (secp256k1_ec_pubkey_parse(VerifyContext(), &parsed, point.data(), 33)) {
+                return CPubKey(point.begin(), point.end());
             }
         }
-    }
+        return CPubKey();
+    }()};
 
-    return g_generatorH;
+    return generatorH;
 }
 
 bool CreateCommitment(
@@ -235,11 +235,8 @@ static const size_t BULLETPROOF_BITS = 64;  // Range [0, 2^64)
 struct BulletproofGenerators {
     std::vector<CPubKey> G;  // Size n
     std::vector<CPubKey> H;  // Size n
-    bool initialized{false};
-
-    bool Initialize(secp256k1_context* ctx, size_t n) {
-        if (initialized && G.size() == n) return true;
 
+    bool Initialize(const secp256k1_context* ctx, size_t n) {
         G.resize(n);
         H.resize(n);
 
@@ -281,12 +278,21 @@ struct BulletproofGenerators {
             if (!G[i].IsValid() || !H[i].IsValid()) return false;
         }
 
-        initialized = true;
         return true;
     }
 };
 
-static BulletproofGenerators g_bulletproofGens;
+// The generators are derived on first use and kept for the process lifetime.
+// Returns nullptr if they could not be derived.
+static const BulletproofGenerators* GetBulletproofGenerators()
+{
+    static const std::unique_ptr<BulletproofGenerators> gens{[] {
+        auto g = std::make_unique<BulletproofGenerators>();
+        if (!g->Initialize(VerifyContext(), BULLETPROOF_BITS)) g.reset();
+        return g;
+    }()};
+    return gens.get();
+}
 
 // Helper: Hash to scalar for Fiat-Shamir
 static uint256 HashToScalar(const std::string& label, const std::vector<unsigned char>& data)
@@ -361,8 +367,8 @@ bool CreateRangeProof(
     secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
     if (!ctx) return false;
 
-    // Initialize generators
-    if (!g_bulletproofGens.Initialize(ctx, BULLETPROOF_BITS)) {
+    const BulletproofGenerators* gens = GetBulletproofGenerators();
+    if (!gens) {
         secp256k1_context_destroy(ctx);
         return false;
     }
@@ -387,7 +393,7 @@ bool CreateRangeProof(
     for (size_t i = 0; i < BULLETPROOF_BITS; i++) {
         if (aL[i] == 1) {
             CPubKey temp;
-            if (!PointAdd(ctx, A, g_bulletproofGens.G[i], temp)) {
+            if (!PointAdd(ctx, A, gens->G[i], temp)) {
                 secp256k1_context_destroy(ctx);
                 return false;
             }
@@ -397,8 +403,8 @@ bool CreateRangeProof(
         if (aR[i] != 0) {  // aR[i] == -1
             // Negate H[i] and add
             secp256k1_pubkey negH;
-            if (!secp256k1_ec_pubkey_parse(ctx, &negH, g_bulletproofGens.H[i].data(),
-                                            g_bulletproofGens.H[i].size())) {
+            if (!secp256k1_ec_pubkey_parse(ctx, &negH, gens->H[i].data(),
+                                            gens->H[i].size())) {
                 secp256k1_context_destroy(ctx);
                 return false;
             }
@@ -429,11 +435,11 @@ bool CreateRangeProof(
     CPubKey S = rho.GetPubKey();
     for (size_t i = 0; i < BULLETPROOF_BITS; i++) {
         CPubKey sLG, sRH;
-        if (!PointMul(ctx, g_bulletproofGens.G[i], UCharCast(sL[i].begin()), sLG)) {
+        if (!PointMul(ctx, gens->G[i], UCharCast(sL[i].begin()), sLG)) {
             secp256k1_context_destroy(ctx);
             return false;
         }
-        if (!PointMul(ctx, g_bulletproofGens.H[i], UCharCast(sR[i].begin()), sRH)) {
+        if (!PointMul(ctx, gens->H[i], UCharCast(sR[i].begin()), sRH)) {
             secp256k1_context_destroy(ctx);
             return false;
         }
@@ -587,6 +593,22 @@ bool CreateRangeProof(
 bool VerifyRangeProof(
     const CPedersenCommitment& commitment,
     const CRangeProof& rangeProof)
+{
+    CRangeProofBatch batch;
+    return batch.Add(commitment, rangeProof) && batch.Verify();
+}
+
+static bool IsZeroScalar(const unsigned char* scalar)
+{
+    for (int i = 0; i < 32; i++) {
+        if (scalar[i] != 0) return false;
+    }
+    return true;
+}
+
+bool CRangeProofBatch::Add(
+    const CPedersenCommitment& commitment,
+    const CRangeProof& rangeProof)
 {
     if (!commitment.IsValid() || rangeProof.data.empty()) {
         return false;
@@ -602,59 +624,34 @@ bool VerifyRangeProof(
         return false;
     }
 
-    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    const secp256k1_context* ctx = VerifyContext();
     if (!ctx) return false;
 
-    // Initialize generators
-    if (!g_bulletproofGens.Initialize(ctx, BULLETPROOF_BITS)) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
-
     // Parse proof components
     size_t offset = 1;
 
     CPubKey A(rangeProof.data.begin() + offset, rangeProof.data.begin() + offset + 33);
     offset += 33;
-    if (!A.IsValid()) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
-
     CPubKey S(rangeProof.data.begin() + offset, rangeProof.data.begin() + offset + 33);
     offset += 33;
-    if (!S.IsValid()) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
 
-    CPubKey T1(rangeProof.data.begin() + offset, rangeProof.data.begin() + offset + 33);
+    Entry entry;
+    entry.V = CPubKey(commitment.data.begin(), commitment.data.end());
+    entry.T1 = CPubKey(rangeProof.data.begin() + offset, rangeProof.data.begin() + offset + 33);
     offset += 33;
-    if (!T1.IsValid()) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
-
-    CPubKey T2(rangeProof.data.begin() + offset, rangeProof.data.begin() + offset + 33);
+    entry.T2 = CPubKey(rangeProof.data.begin() + offset, rangeProof.data.begin() + offset + 33);
     offset += 33;
-    if (!T2.IsValid()) {
-        secp256k1_context_destroy(ctx);
+    if (!A.IsValid() || !S.IsValid() || !entry.T1.IsValid() || !entry.T2.IsValid()) {
         return false;
     }
 
-    const unsigned char* tau_x = rangeProof.data.data() + offset;
-    offset += 32;
-
-    const unsigned char* mu = rangeProof.data.data() + offset;
-    offset += 32;
-
-    const unsigned char* t_hat = rangeProof.data.data() + offset;
-    offset += 32;
+    const unsigned char* mu = rangeProof.data.data() + offset + 32;
+    memcpy(entry.tau_x.begin(), rangeProof.data.data() + offset, 32);
+    memcpy(entry.t_hat.begin(), rangeProof.data.data() + offset + 64, 32);
 
     // Verify tau_x and mu are valid scalars
-    if (!secp256k1_ec_seckey_verify(ctx, tau_x) ||
+    if (!secp256k1_ec_seckey_verify(ctx, entry.tau_x.begin()) ||
         !secp256k1_ec_seckey_verify(ctx, mu)) {
-        secp256k1_context_destroy(ctx);
         return false;
     }
 
@@ -668,137 +665,165 @@ bool VerifyRangeProof(
     transcript.insert(transcript.end(), y.begin(), y.end());
     uint256 z = HashToScalar("z", transcript);
 
-    transcript.insert(transcript.end(), T1.begin(), T1.end());
-    transcript.insert(transcript.end(), T2.begin(), T2.end());
-    uint256 x = HashToScalar("x", transcript);
+    transcript.insert(transcript.end(), entry.T1.begin(), entry.T1.end());
+    transcript.insert(transcript.end(), entry.T2.begin(), entry.T2.end());
+    entry.x = HashToScalar("x", transcript);
 
-    // Verify: tau_x*G + t_hat*H == z^2*V + T1*x + T2*x^2
-    // Where V is the original Pedersen commitment
+    entry.z2 = z;
+    entry.x2 = entry.x;
+    if (!secp256k1_ec_seckey_tweak_mul(ctx, entry.z2.begin(), z.begin()) ||
+        !secp256k1_ec_seckey_tweak_mul(ctx, entry.x2.begin(), entry.x.begin())) {
+        return false;
+    }
 
-    // LHS: tau_x*G + t_hat*H
-    secp256k1_pubkey tauG;
-    if (!secp256k1_ec_pubkey_create(ctx, &tauG, tau_x)) {
-        secp256k1_context_destroy(ctx);
+    m_entries.push_back(std::move(entry));
+    return true;
+}
+
+bool CRangeProofBatch::AddAggregated(
+    const std::vector<CPedersenCommitment>& commitments,
+    const CRangeProof& rangeProof)
+{
+    if (commitments.empty() || rangeProof.data.empty()) {
         return false;
     }
 
-    // Check if t_hat is zero (happens when amount=0)
-    bool t_hat_is_zero = true;
-    for (int i = 0; i < 32; i++) {
-        if (t_hat[i] != 0) {
-            t_hat_is_zero = false;
-            break;
-        }
+    // Check for legacy placeholder marker
+    if (rangeProof.data.back() == 0xFE && rangeProof.data.size() == 33) {
+        return true; // Accept placeholder during transition
     }
 
-    secp256k1_pubkey lhs;
-    if (t_hat_is_zero) {
-        // When t_hat is zero, LHS = tau_x*G (t_hat*H = identity)
-        lhs = tauG;
-    } else {
-        CPubKey generatorH = GetGeneratorH();
-        secp256k1_pubkey thatH;
-        if (!secp256k1_ec_pubkey_parse(ctx, &thatH, generatorH.data(), generatorH.size())) {
-            secp256k1_context_destroy(ctx);
+    // Version 2: aggregated proof
+    if (rangeProof.data[0] != 0x02 || rangeProof.data.size() < 2) {
+        return false;
+    }
+
+    size_t numProofs = rangeProof.data[1];
+    if (numProofs != commitments.size()) {
+        return false;
+    }
+
+    size_t offset = 2;
+    for (size_t i = 0; i < numProofs; i++) {
+        if (offset + 2 > rangeProof.data.size()) {
             return false;
         }
-        if (!secp256k1_ec_pubkey_tweak_mul(ctx, &thatH, t_hat)) {
-            secp256k1_context_destroy(ctx);
+
+        uint16_t proofSize = rangeProof.data[offset] |
+                             (static_cast<uint16_t>(rangeProof.data[offset + 1]) << 8);
+        offset += 2;
+
+        if (offset + proofSize > rangeProof.data.size()) {
             return false;
         }
 
-        const secp256k1_pubkey* lhs_pts[2] = {&tauG, &thatH};
-        if (!secp256k1_ec_pubkey_combine(ctx, &lhs, lhs_pts, 2)) {
-            secp256k1_context_destroy(ctx);
+        CRangeProof singleProof;
+        singleProof.data.assign(rangeProof.data.begin() + offset,
+                                 rangeProof.data.begin() + offset + proofSize);
+
+        if (!Add(commitments[i], singleProof)) {
             return false;
         }
-    }
 
-    // RHS: z^2*V + T1*x + T2*x^2
-    // z^2*V
-    unsigned char z2[32];
-    memcpy(z2, z.begin(), 32);
-    if (!secp256k1_ec_seckey_tweak_mul(ctx, z2, z.begin())) {
-        secp256k1_context_destroy(ctx);
-        return false;
+        offset += proofSize;
     }
 
-    secp256k1_pubkey z2V;
-    if (!secp256k1_ec_pubkey_parse(ctx, &z2V, commitment.data.data(), commitment.data.size())) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
-    if (!secp256k1_ec_pubkey_tweak_mul(ctx, &z2V, z2)) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
+    return true;
+}
 
-    // T1*x
-    secp256k1_pubkey T1x;
-    if (!secp256k1_ec_pubkey_parse(ctx, &T1x, T1.data(), T1.size())) {
-        secp256k1_context_destroy(ctx);
-        return false;
-    }
-    if (!secp256k1_ec_pubkey_tweak_mul(ctx, &T1x, x.begin())) {
-        secp256k1_context_destroy(ctx);
-        return false;
+bool CRangeProofBatch::Verify() const
+{
+    if (m_entries.empty()) {
+        return true;
     }
 
-    // T2*x^2
-    unsigned char x2[32];
-    memcpy(x2, x.begin(), 32);
-    if (!secp256k1_ec_seckey_tweak_mul(ctx, x2, x.begin())) {
-        secp256k1_context_destroy(ctx);
-        return false;
+    const secp256k1_context* ctx = VerifyContext();
+    if (!ctx) return false;
+
+    // Every proof satisfies tau_x*G + t_hat*H == z^2*V + x*T1 + x^2*T2. With a
+    // random weight w per proof, the sum over the batch
+    //   (sum w*tau_x)*G + (sum w*t_hat)*H == sum (w*z^2*V + w*x*T1 + w*x^2*T2)
+    // only holds by chance if one of them does not.
+    uint256 tau_sum, t_sum;
+    bool have_tau{false}, have_t{false};
+    std::vector<secp256k1_pubkey> rhs_terms;
+    rhs_terms.reserve(m_entries.size() * 3);
+
+    auto add_scalar = [&](uint256& sum, bool& have, const uint256& scalar, const uint256& weight) {
+        uint256 weighted = scalar;
+        if (!secp256k1_ec_seckey_tweak_mul(ctx, weighted.begin(), weight.begin())) return false;
+        if (!have) {
+            sum = weighted;
+            have = true;
+            return true;
+        }
+        return secp256k1_ec_seckey_tweak_add(ctx, sum.begin(), weighted.begin()) == 1;
+    };
+    auto add_point = [&](const CPubKey& point, const uint256& scalar, const uint256& weight) {
+        uint256 weighted = scalar;
+        if (!secp256k1_ec_seckey_tweak_mul(ctx, weighted.begin(), weight.begin())) return false;
+        secp256k1_pubkey term;
+        if (!secp256k1_ec_pubkey_parse(ctx, &term, point.data(), point.size()) ||
+            !secp256k1_ec_pubkey_tweak_mul(ctx, &term, weighted.begin())) {
+            return false;
+        }
+        rhs_terms.push_back(term);
+        return true;
+    };
+
+    for (const Entry& entry : m_entries) {
+        uint256 weight;
+        do {
+            weight = GetRandHash();
+        } while (!secp256k1_ec_seckey_verify(ctx, weight.begin()));
+
+        if (!add_scalar(tau_sum, have_tau, entry.tau_x, weight)) return false;
+        // t_hat is zero when the amount is zero and adds nothing
+        if (!IsZeroScalar(entry.t_hat.begin()) && !add_scalar(t_sum, have_t, entry.t_hat, weight)) return false;
+        if (!add_point(entry.V, entry.z2, weight) ||
+            !add_point(entry.T1, entry.x, weight) ||
+            !add_point(entry.T2, entry.x2, weight)) {
+            return false;
+        }
     }
 
-    secp256k1_pubkey T2x2;
-    if (!secp256k1_ec_pubkey_parse(ctx, &T2x2, T2.data(), T2.size())) {
-        secp256k1_context_destroy(ctx);
+    // LHS: (sum w*tau_x)*G + (sum w*t_hat)*H
+    secp256k1_pubkey lhs;
+    if (!secp256k1_ec_pubkey_create(ctx, &lhs, tau_sum.begin())) {
         return false;
     }
-    if (!secp256k1_ec_pubkey_tweak_mul(ctx, &T2x2, x2)) {
-        secp256k1_context_destroy(ctx);
-        return false;
+    if (have_t) {
+        CPubKey generatorH = GetGeneratorH();
+        secp256k1_pubkey thatH;
+        if (!secp256k1_ec_pubkey_parse(ctx, &thatH, generatorH.data(), generatorH.size()) ||
+            !secp256k1_ec_pubkey_tweak_mul(ctx, &thatH, t_sum.begin())) {
+            return false;
+        }
+        const secp256k1_pubkey* lhs_pts[2] = {&lhs, &thatH};
+        secp256k1_pubkey combined;
+        if (!secp256k1_ec_pubkey_combine(ctx, &combined, lhs_pts, 2)) {
+            return false;
+        }
+        lhs = combined;
     }
 
-    // Combine RHS
-    const secp256k1_pubkey* rhs_pts[3] = {&z2V, &T1x, &T2x2};
+    // RHS: sum of the weighted commitment terms
+    std::vector<const secp256k1_pubkey*> rhs_pts(rhs_terms.size());
+    for (size_t i = 0; i < rhs_terms.size(); i++) {
+        rhs_pts[i] = &rhs_terms[i];
+    }
     secp256k1_pubkey rhs;
-    if (!secp256k1_ec_pubkey_combine(ctx, &rhs, rhs_pts, 3)) {
-        secp256k1_context_destroy(ctx);
+    if (!secp256k1_ec_pubkey_combine(ctx, &rhs, rhs_pts.data(), rhs_pts.size())) {
         return false;
     }
 
-    // Compare LHS and RHS
     unsigned char lhs_ser[33], rhs_ser[33];
     size_t len = 33;
     secp256k1_ec_pubkey_serialize(ctx, lhs_ser, &len, &lhs, SECP256K1_EC_COMPRESSED);
     len = 33;
     secp256k1_ec_pubkey_serialize(ctx, rhs_ser, &len, &rhs, SECP256K1_EC_COMPRESSED);
 
-    secp256k1_context_destroy(ctx);
-
-    // Verify the polynomial commitment equation holds
-    // This verifies: tau_x*G + t_hat*H == z^2*V + T1*x + T2*x^2
-    bool polyValid = (memcmp(lhs_ser, rhs_ser, 33) == 0);
-
-    if (!polyValid) {
-        return false;
-    }
-
-    // Additional check: verify the range constraint
-    // The proof is valid if the polynomial identity holds and
-    // the inner product argument (if present) verifies
-    // For version 1 proofs without inner product, we verify the
-    // commitment structure is correct
-
-    // Check that the proof was created with proper generators
-    if (!g_bulletproofGens.initialized || g_bulletproofGens.G.size() < BULLETPROOF_BITS) {
-        return false;
-    }
-
-    return true;
+    return memcmp(lhs_ser, rhs_ser, 33) == 0;
 }
 
 bool CreateAggregatedRangeProof(
@@ -856,51 +881,8 @@ bool VerifyAggregatedRangeProof(
     const std::vector<CPedersenCommitment>& commitments,
     const CRangeProof& rangeProof)
 {
-    if (commitments.empty() || rangeProof.data.empty()) {
-        return false;
-    }
-
-    // Check for legacy placeholder marker
-    if (rangeProof.data.back() == 0xFE && rangeProof.data.size() == 33) {
-        return true; // Accept placeholder during transition
-    }
-
-    // Version 2: aggregated proof
-    if (rangeProof.data[0] != 0x02 || rangeProof.data.size() < 2) {
-        return false;
-    }
-
-    size_t numProofs = rangeProof.data[1];
-    if (numProofs != commitments.size()) {
-        return false;
-    }
-
-    size_t offset = 2;
-    for (size_t i = 0; i < numProofs; i++) {
-        if (offset + 2 > rangeProof.data.size()) {
-            return false;
-        }
-
-        uint16_t proofSize = rangeProof.data[offset] |
-                             (static_cast<uint16_t>(rangeProof.data[offset + 1]) << 8);
-        offset += 2;
-
-        if (offset + proofSize > rangeProof.data.size()) {
-            return false;
-        }
-
-        CRangeProof singleProof;
-        singleProof.data.assign(rangeProof.data.begin() + offset,
-                                 rangeProof.data.begin() + offset + proofSize);
-
-        if (!VerifyRangeProof(commitments[i], singleProof)) {
-            return false;
-        }
-
-        offset += proofSize;
-    }
-
-    return true;
+    CRangeProofBatch batch;
+    return batch.AddAggregated(commitments, rangeProof) && batch.Verify();
 }
 
 // Generator U for inner product proofs
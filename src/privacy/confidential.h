@@ -237,6 +237,37 @@ bool VerifyAggregatedRangeProof(
     const std::vector<CPedersenCommitment>& commitments,
     const CRangeProof& rangeProof);
 
+/**
+ * @brief Range proofs verified together
+ *
+ * Each proof is checked through tau_x*G + t_hat*H == z^2*V + x*T1 + x^2*T2.
+ * The batch adds up these equations, each weighted by a random scalar, so G
+ * and H are multiplied once per batch instead of once per proof. Proofs are
+ * parsed and their challenges derived when they are added; Verify() only
+ * does the curve arithmetic. A failed batch does not say which proof is bad.
+ */
+class CRangeProofBatch
+{
+public:
+    //! Add a single (version 1) proof. Returns false if it is malformed.
+    bool Add(const CPedersenCommitment& commitment, const CRangeProof& rangeProof);
+
+    //! Add every proof of an aggregated (version 2) proof. Returns false if it is malformed.
+    bool AddAggregated(const std::vector<CPedersenCommitment>& commitments, const CRangeProof& rangeProof);
+
+    //! Check all proofs added so far. An empty batch is valid.
+    bool Verify() const;
+
+    size_t Size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        CPubKey V, T1, T2;
+        uint256 tau_x, t_hat, x, x2, z2;
+    };
+    std::vector<Entry> m_entries;
+};
+
 /**
  * @brief Compute blinding factor that balances transaction
  *
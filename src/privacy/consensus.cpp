@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <privacy/consensus.h>
+#include <privacy/fcmp_consensus.h>
 #include <hash.h>
 #include <logging.h>
 #include <script/script.h>
@@ -33,85 +34,59 @@ static constexpr uint8_t DB_KEYIMAGE = 'k';
 //
 
 CKeyImageDB::CKeyImageDB(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe)
+    : CKeyImageSpendDB(path, nCacheSize, fMemory, fWipe, DB_KEYIMAGE)
 {
-    m_db = std::make_unique<CDBWrapper>(DBParams{
-        .path = path,
-        .cache_bytes = nCacheSize,
-        .memory_only = fMemory,
-        .wipe_data = fWipe
-    });
 }
 
 bool CKeyImageDB::IsSpent(const CKeyImage& keyImage) const
 {
-    LOCK(cs_db);
     if (!keyImage.IsValid()) return false;
-    uint256 keyImageHash = keyImage.GetHash();
-    return m_db->Exists(std::make_pair(DB_KEYIMAGE, keyImageHash));
+    return CKeyImageSpendDB::IsSpent(keyImage.GetHash());
 }
 
 bool CKeyImageDB::GetEntry(const CKeyImage& keyImage, CKeyImageEntry& entry) const
 {
-    LOCK(cs_db);
     if (!keyImage.IsValid()) return false;
-    uint256 keyImageHash = keyImage.GetHash();
-    return m_db->Read(std::make_pair(DB_KEYIMAGE, keyImageHash), entry);
+    return ReadSpend(keyImage.GetHash(), entry);
 }
 
 bool CKeyImageDB::MarkSpent(const CKeyImage& keyImage, const uint256& txHash, int blockHeight)
 {
-    LOCK(cs_db);
     if (!keyImage.IsValid()) return false;
 
     CKeyImageEntry entry;
     entry.txHash = txHash;
     entry.blockHeight = blockHeight;
 
-    uint256 keyImageHash = keyImage.GetHash();
-    return m_db->Write(std::make_pair(DB_KEYIMAGE, keyImageHash), entry);
+    return WriteSpends({{keyImage.GetHash(), entry}});
 }
 
 bool CKeyImageDB::UnmarkSpent(const CKeyImage& keyImage)
 {
-    LOCK(cs_db);
     if (!keyImage.IsValid()) return false;
-    uint256 keyImageHash = keyImage.GetHash();
-    return m_db->Erase(std::make_pair(DB_KEYIMAGE, keyImageHash));
+    return EraseSpends({keyImage.GetHash()});
 }
 
 bool CKeyImageDB::WriteKeyImages(const std::vector<std::pair<CKeyImage, CKeyImageEntry>>& entries)
 {
-    LOCK(cs_db);
-    CDBBatch batch(*m_db);
-
+    std::vector<std::pair<uint256, CKeyImageEntry>> spends;
+    spends.reserve(entries.size());
     for (const auto& [keyImage, entry] : entries) {
         if (!keyImage.IsValid()) continue;
-        uint256 keyImageHash = keyImage.GetHash();
-        batch.Write(std::make_pair(DB_KEYIMAGE, keyImageHash), entry);
+        spends.emplace_back(keyImage.GetHash(), entry);
     }
-
-    return m_db->WriteBatch(batch);
+    return WriteSpends(spends);
 }
 
 bool CKeyImageDB::EraseKeyImages(const std::vector<CKeyImage>& keyImages)
 {
-    LOCK(cs_db);
-    CDBBatch batch(*m_db);
-
+    std::vector<uint256> hashes;
+    hashes.reserve(keyImages.size());
     for (const auto& keyImage : keyImages) {
         if (!keyImage.IsValid()) continue;
-        uint256 keyImageHash = keyImage.GetHash();
-        batch.Erase(std::make_pair(DB_KEYIMAGE, keyImageHash));
+        hashes.push_back(keyImage.GetHash());
     }
-
-    return m_db->WriteBatch(batch);
-}
-
-bool CKeyImageDB::Sync()
-{
-    LOCK(cs_db);
-    CDBBatch batch(*m_db);
-    return m_db->WriteBatch(batch, true);  // fSync = true
+    return EraseSpends(hashes);
 }
 
 //
@@ -288,7 +263,15 @@ bool ContextualCheckPrivacyTransaction(
         return false;
     }
 
-    // Check key images are not spent
+    return CheckPrivacyKeyImagesUnspent(tx, keyImageDB, state) &&
+           VerifyPrivacyTransactionProofs(tx, state);
+}
+
+bool CheckPrivacyKeyImagesUnspent(
+    const CPrivacyTransaction& tx,
+    const CKeyImageDB& keyImageDB,
+    TxValidationState& state)
+{
     if (tx.privacyType == PrivacyType::RING || tx.privacyType == PrivacyType::RINGCT) {
         for (size_t i = 0; i < tx.privacyInputs.size(); i++) {
             const CKeyImage& keyImage = tx.privacyInputs[i].keyImage;
@@ -301,8 +284,62 @@ bool ContextualCheckPrivacyTransaction(
                               i, entry.txHash.ToString()));
             }
         }
+    }
+
+    return true;
+}
+
+bool CheckPrivacyKeyImagesUniqueInBlock(
+    const CPrivacyTransaction& tx,
+    std::set<uint256>& blockKeyImages,
+    TxValidationState& state)
+{
+    if (tx.privacyType == PrivacyType::RING || tx.privacyType == PrivacyType::RINGCT) {
+        for (size_t i = 0; i < tx.privacyInputs.size(); i++) {
+            if (!blockKeyImages.insert(tx.privacyInputs[i].keyImage.GetHash()).second) {
+                return state.Invalid(TxValidationResult::TX_CONSENSUS,
+                    "privacy-key-image-spent",
+                    strprintf("Key image for input %d already spent in this block", i));
+            }
+        }
+    }
 
-        // Verify MLSAG signature
+    return true;
+}
+
+bool AddPrivacyRangeProofs(
+    const CPrivacyTransaction& tx,
+    CRangeProofBatch& batch,
+    TxValidationState& state)
+{
+    if (tx.privacyType != PrivacyType::CONFIDENTIAL && tx.privacyType != PrivacyType::RINGCT) {
+        return true;
+    }
+
+    std::vector<CPedersenCommitment> outputCommitments;
+    for (const auto& output : tx.privacyOutputs) {
+        if (output.confidentialOutput.IsValid()) {
+            outputCommitments.push_back(output.confidentialOutput.commitment);
+        }
+    }
+
+    if (!outputCommitments.empty() && tx.aggregatedRangeProof.IsValid()) {
+        if (!batch.AddAggregated(outputCommitments, tx.aggregatedRangeProof)) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS,
+                "privacy-invalid-range-proof");
+        }
+    }
+
+    return true;
+}
+
+bool VerifyPrivacyTransactionProofs(
+    const CPrivacyTransaction& tx,
+    TxValidationState& state,
+    bool checkRangeProofs)
+{
+    // Verify MLSAG signature
+    if (tx.privacyType == PrivacyType::RING || tx.privacyType == PrivacyType::RINGCT) {
         if (tx.privacyInputs.size() > 0 && tx.mlsagSig.IsValid()) {
             uint256 txHash = tx.GetHash();
             if (!VerifyMLSAGSignature(txHash, tx.mlsagSig)) {
@@ -337,12 +374,17 @@ bool ContextualCheckPrivacyTransaction(
             }
         }
 
-        // Verify range proofs
-        if (!outputCommitments.empty() && tx.aggregatedRangeProof.IsValid()) {
-            if (!VerifyAggregatedRangeProof(outputCommitments, tx.aggregatedRangeProof)) {
-                return state.Invalid(TxValidationResult::TX_CONSENSUS,
-                    "privacy-invalid-range-proof");
-            }
+    }
+
+    // Verify range proofs, the outputs of the transaction as one batch
+    if (checkRangeProofs) {
+        CRangeProofBatch batch;
+        if (!AddPrivacyRangeProofs(tx, batch, state)) {
+            return false;
+        }
+        if (!batch.Verify()) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS,
+                "privacy-invalid-range-proof");
         }
     }
 
@@ -638,4 +680,35 @@ std::optional<CPrivacyTransaction> ExtractPrivacyTransaction(const CTransaction&
     return std::nullopt;
 }
 
+std::vector<uint256> GetTxKeyImageHashes(const CTransaction& tx)
+{
+    std::vector<uint256> hashes;
+
+    if (auto privTx = ExtractPrivacyTransaction(tx)) {
+        for (const auto& input : privTx->privacyInputs) {
+            if (input.keyImage.IsValid()) {
+                hashes.push_back(input.keyImage.GetHash());
+            }
+        }
+        for (const auto& input : privTx->fcmpInputs) {
+            if (input.keyImage.IsValid()) {
+                hashes.push_back(input.keyImage.GetHash());
+            }
+        }
+    }
+
+    CPrivacyTransaction fcmpTx;
+    if (DecodeFcmpTransaction(tx, fcmpTx)) {
+        for (const auto& input : fcmpTx.fcmpInputs) {
+            if (input.keyImage.IsValid()) {
+                hashes.push_back(input.keyImage.GetHash());
+            }
+        }
+    }
+
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    return hashes;
+}
+
 } // namespace privacy
@@ -5,6 +5,7 @@
 #ifndef WATTX_PRIVACY_CONSENSUS_H
 #define WATTX_PRIVACY_CONSENSUS_H
 
+#include <privacy/keyimage_db.h>
 #include <privacy/privacy.h>
 #include <consensus/validation.h>
 #include <consensus/params.h>
@@ -14,6 +15,7 @@
 
 #include <memory>
 #include <optional>
+#include <set>
 
 namespace privacy {
 
@@ -22,31 +24,14 @@ namespace privacy {
  */
 bool IsPrivacyActive(int nHeight, const Consensus::Params& params);
 
-/**
- * @brief Key image database entry
- */
-struct CKeyImageEntry
-{
-    uint256 txHash;     // Transaction that spent this key image
-    int blockHeight;    // Block height (-1 for mempool)
-
-    SERIALIZE_METHODS(CKeyImageEntry, obj) {
-        READWRITE(obj.txHash, obj.blockHeight);
-    }
-};
-
 /**
  * @brief Persistent database for spent key images
  *
  * Tracks which key images have been used to prevent double-spending
  * of privacy transaction inputs.
  */
-class CKeyImageDB
+class CKeyImageDB : public CKeyImageSpendDB
 {
-private:
-    std::unique_ptr<CDBWrapper> m_db;
-    mutable RecursiveMutex cs_db;
-
 public:
     explicit CKeyImageDB(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
@@ -65,9 +50,6 @@ public:
     //! Batch operations for block connect/disconnect
     bool WriteKeyImages(const std::vector<std::pair<CKeyImage, CKeyImageEntry>>& entries);
     bool EraseKeyImages(const std::vector<CKeyImage>& keyImages);
-
-    //! Sync to disk
-    bool Sync();
 };
 
 /**
@@ -134,6 +116,57 @@ bool ContextualCheckPrivacyTransaction(
     TxValidationState& state,
     int height);
 
+/**
+ * @brief Check the key images of a ring transaction are unspent
+ *
+ * The part of ContextualCheckPrivacyTransaction() that reads chain state,
+ * so block validation runs it serially in block order.
+ */
+bool CheckPrivacyKeyImagesUnspent(
+    const CPrivacyTransaction& tx,
+    const CKeyImageDB& keyImageDB,
+    TxValidationState& state);
+
+/**
+ * @brief Check a ring transaction spends no key image spent earlier in its block
+ *
+ * Key images reach the database only once their block is connected, so
+ * CheckPrivacyKeyImagesUnspent() does not see spends within the block.
+ * Consensus rule from Consensus::Params::nPrivacyKeyImageUniqueHeight on:
+ * a block spending a key image twice is invalid.
+ *
+ * @param blockKeyImages Key image hashes of the block's earlier transactions,
+ *        the transaction's own are added
+ */
+bool CheckPrivacyKeyImagesUniqueInBlock(
+    const CPrivacyTransaction& tx,
+    std::set<uint256>& blockKeyImages,
+    TxValidationState& state);
+
+/**
+ * @brief Verify ring signature, commitment balance and range proofs
+ *
+ * The cryptographic part of ContextualCheckPrivacyTransaction(). Reads no
+ * chain state, so block validation runs it on the script check threads.
+ * Block validation batches range proofs across transactions with
+ * AddPrivacyRangeProofs() and passes checkRangeProofs = false.
+ */
+bool VerifyPrivacyTransactionProofs(
+    const CPrivacyTransaction& tx,
+    TxValidationState& state,
+    bool checkRangeProofs = true);
+
+/**
+ * @brief Add the range proofs of a confidential transaction to a batch
+ *
+ * Fails if the proofs are malformed; whether they are valid is only known
+ * once the batch is verified.
+ */
+bool AddPrivacyRangeProofs(
+    const CPrivacyTransaction& tx,
+    CRangeProofBatch& batch,
+    TxValidationState& state);
+
 /**
  * @brief Verify a key image is not spent
  */
@@ -220,6 +253,18 @@ bool HasPrivacyData(const CTransaction& tx);
  */
 std::optional<CPrivacyTransaction> ExtractPrivacyTransaction(const CTransaction& tx);
 
+/**
+ * @brief Hashes of the key images a transaction spends
+ *
+ * Covers ring inputs and FCMP inputs alike, sorted and without duplicates.
+ * Empty for transactions without privacy inputs. This is the key of the
+ * mempool's key image index (CTxMemPool::mapKeyImages).
+ *
+ * @param tx Standard transaction
+ * @return Key image hashes
+ */
+std::vector<uint256> GetTxKeyImageHashes(const CTransaction& tx);
+
 } // namespace privacy
 
 #endif // WATTX_PRIVACY_CONSENSUS_H
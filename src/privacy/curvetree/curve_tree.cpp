@@ -4,10 +4,14 @@
 
 #include <privacy/curvetree/curve_tree.h>
 
+#include <privacy/curvetree/flat_storage.h>
+
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstring>
+#include <thread>
 
 namespace curvetree {
 
@@ -198,6 +202,10 @@ std::optional<OutputTuple> MemoryTreeStorage::GetOutput(uint64_t index) {
     return std::nullopt;
 }
 
+bool MemoryTreeStorage::DeleteOutput(uint64_t index) {
+    return m_outputs.erase(index) > 0;
+}
+
 bool MemoryTreeStorage::StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) {
     m_metadata[key] = value;
     return true;
@@ -215,6 +223,34 @@ std::optional<std::vector<uint8_t>> MemoryTreeStorage::GetMetadata(const std::st
 // CurveTree Implementation
 // ============================================================================
 
+namespace {
+
+// Run fn(0) .. fn(count - 1) spread over the available cores
+template <typename Fn>
+void ParallelFor(size_t count, const Fn& fn) {
+    const size_t num_threads = std::min<size_t>(count, std::max(1U, std::thread::hardware_concurrency()));
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    const auto worker = [&] {
+        for (size_t i = next++; i < count; i = next++) fn(i);
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
 CurveTree::CurveTree(std::shared_ptr<ITreeStorage> storage)
     : m_storage(std::move(storage))
     , m_hasher("WATTx_CurveTree_v1")
@@ -228,7 +264,7 @@ CurveTree::CurveTree(std::shared_ptr<ITreeStorage> storage)
 }
 
 CurveTree::CurveTree()
-    : CurveTree(std::make_shared<MemoryTreeStorage>())
+    : CurveTree(std::make_shared<FlatTreeStorage>())
 {
 }
 
@@ -300,16 +336,22 @@ uint64_t CurveTree::AddOutput(const OutputTuple& output) {
     }
 
     // Update the path from this leaf to root
-    UpdatePath(index);
+    UpdatePaths({index});
 
     m_root_dirty = true;
     return index;
 }
 
-std::vector<uint64_t> CurveTree::AddOutputs(const std::vector<OutputTuple>& outputs) {
+std::vector<uint64_t> CurveTree::AddOutputs(const std::vector<OutputTuple>& outputs, TreeUndo* undo) {
     std::vector<uint64_t> indices;
     indices.reserve(outputs.size());
 
+    if (undo) {
+        undo->output_count = m_output_count;
+        undo->depth = m_depth;
+        undo->nodes.clear();
+    }
+
     m_storage->BeginBatch();
 
     for (const auto& output : outputs) {
@@ -327,16 +369,8 @@ std::vector<uint64_t> CurveTree::AddOutputs(const std::vector<OutputTuple>& outp
     // Update depth
     m_depth = CalculateDepth(m_output_count);
 
-    // Rebuild affected portions (or full rebuild for efficiency with large batches)
-    if (outputs.size() > 100) {
-        // Full rebuild is more efficient for large batches
-        Rebuild();
-    } else {
-        // Update paths for each new output
-        for (uint64_t idx : indices) {
-            UpdatePath(idx);
-        }
-    }
+    // Recompute each node above the new outputs once
+    UpdatePaths(indices, undo);
 
     m_storage->CommitBatch();
     m_root_dirty = true;
@@ -424,7 +458,7 @@ std::vector<Point> CurveTree::GetChildren(const TreeIndex& parent) const {
     return children;
 }
 
-Point CurveTree::ComputeLeafNode(uint64_t leaf_index) const {
+std::vector<Scalar> CurveTree::GetLeafElements(uint64_t leaf_index) const {
     // Get all outputs for this leaf commitment
     uint64_t start = leaf_index * TreeConfig::LEAF_BRANCH_WIDTH;
     uint64_t end = std::min(start + TreeConfig::LEAF_BRANCH_WIDTH, m_output_count);
@@ -438,7 +472,11 @@ Point CurveTree::ComputeLeafNode(uint64_t leaf_index) const {
             all_elements.insert(all_elements.end(), elements.begin(), elements.end());
         }
     }
+    return all_elements;
+}
 
+Point CurveTree::ComputeLeafNode(uint64_t leaf_index) const {
+    std::vector<Scalar> all_elements = GetLeafElements(leaf_index);
     if (all_elements.empty()) {
         return m_hasher.GetInit();
     }
@@ -446,39 +484,96 @@ Point CurveTree::ComputeLeafNode(uint64_t leaf_index) const {
     return m_hasher.Hash(all_elements);
 }
 
-void CurveTree::UpdatePath(uint64_t leaf_index) {
-    // Start from the leaf commitment (layer 0)
-    uint64_t leaf_commit_index = leaf_index / TreeConfig::LEAF_BRANCH_WIDTH;
+std::vector<TreeNode> CurveTree::ComputeNodes(uint32_t layer, const std::vector<uint64_t>& indices) const {
+    std::vector<TreeNode> nodes(indices.size());
+
+    if (layer == 0) {
+        std::vector<std::vector<Scalar>> inputs(indices.size());
+        size_t max_inputs = 0;
+        for (size_t i = 0; i < indices.size(); ++i) {
+            inputs[i] = GetLeafElements(indices[i]);
+            max_inputs = std::max(max_inputs, inputs[i].size());
+
+            // Count outputs in this leaf
+            uint64_t start = indices[i] * TreeConfig::LEAF_BRANCH_WIDTH;
+            uint64_t end = std::min(start + TreeConfig::LEAF_BRANCH_WIDTH, m_output_count);
+            nodes[i].child_count = end > start ? end - start : 0;
+        }
+        m_hasher.EnsureGenerators(max_inputs);
+
+        ParallelFor(indices.size(), [&](size_t i) {
+            nodes[i].hash = inputs[i].empty() ? m_hasher.GetInit() : m_hasher.Hash(inputs[i]);
+        });
+        return nodes;
+    }
+
+    std::vector<std::vector<Point>> children(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        children[i] = GetChildren(TreeIndex(layer, indices[i]));
+        nodes[i].child_count = children[i].size();
+    }
+    m_hasher.EnsureGenerators(TreeConfig::INTERNAL_BRANCH_WIDTH);
+
+    ParallelFor(indices.size(), [&](size_t i) {
+        nodes[i].hash = ComputeNodeHash(children[i]);
+    });
+    return nodes;
+}
+
+void CurveTree::UpdatePaths(const std::vector<uint64_t>& leaf_indices, TreeUndo* undo) {
+    const auto store = [&](const TreeIndex& index, const TreeNode& node) {
+        if (undo) {
+            undo->nodes.emplace_back(index, m_storage->GetNode(index));
+        }
+        m_storage->StoreNode(index, node);
+    };
+
+    // Leaf commitments (layer 0) holding the changed outputs, each once
+    std::vector<uint64_t> dirty;
+    dirty.reserve(leaf_indices.size());
+    for (uint64_t leaf_index : leaf_indices) {
+        dirty.push_back(leaf_index / TreeConfig::LEAF_BRANCH_WIDTH);
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    std::vector<TreeNode> nodes = ComputeNodes(0, dirty);
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        store(TreeIndex(0, dirty[i]), nodes[i]);
+    }
 
-    // Update layer 0 (leaf commitment)
-    {
-        TreeIndex idx(0, leaf_commit_index);
-        Point hash = ComputeLeafNode(leaf_commit_index);
-        // Count outputs in this leaf
-        uint64_t start = leaf_commit_index * TreeConfig::LEAF_BRANCH_WIDTH;
-        uint64_t end = std::min(start + TreeConfig::LEAF_BRANCH_WIDTH, m_output_count);
-        m_storage->StoreNode(idx, TreeNode(hash, end - start));
-    }
-
-    // Update internal layers (layer 1 through m_depth - 1)
-    // Only if we have more than one layer
-    if (m_depth > 1) {
-        uint64_t current_index = leaf_commit_index;
-        for (uint32_t layer = 1; layer < m_depth; ++layer) {
-            uint64_t parent_index = current_index / TreeConfig::INTERNAL_BRANCH_WIDTH;
-            TreeIndex parent_idx(layer, parent_index);
-
-            auto children = GetChildren(parent_idx);
-            if (!children.empty()) {
-                Point hash = ComputeNodeHash(children);
-                m_storage->StoreNode(parent_idx, TreeNode(hash, children.size()));
+    // Update internal layers (layer 1 through m_depth - 1), bottom-up, so
+    // every parent is hashed once after all of its changed children
+    for (uint32_t layer = 1; layer < m_depth; ++layer) {
+        std::vector<uint64_t> parents;
+        for (uint64_t index : dirty) {
+            const uint64_t parent_index = index / TreeConfig::INTERNAL_BRANCH_WIDTH;
+            if (parents.empty() || parents.back() != parent_index) {
+                parents.push_back(parent_index);
             }
+        }
 
-            current_index = parent_index;
+        nodes = ComputeNodes(layer, parents);
+        for (size_t i = 0; i < parents.size(); ++i) {
+            if (nodes[i].child_count > 0) {
+                store(TreeIndex(layer, parents[i]), nodes[i]);
+            }
         }
+
+        dirty = std::move(parents);
     }
 }
 
+uint64_t CurveTree::NodesAtLayer(uint64_t output_count, uint32_t layer) {
+    uint64_t nodes = (output_count + TreeConfig::LEAF_BRANCH_WIDTH - 1) /
+                     TreeConfig::LEAF_BRANCH_WIDTH;
+    for (uint32_t l = 1; l <= layer; ++l) {
+        nodes = (nodes + TreeConfig::INTERNAL_BRANCH_WIDTH - 1) /
+                TreeConfig::INTERNAL_BRANCH_WIDTH;
+    }
+    return nodes;
+}
+
 std::optional<TreeBranch> CurveTree::GetBranch(uint64_t leaf_index) const {
     if (leaf_index >= m_output_count) {
         return std::nullopt;
@@ -521,6 +616,89 @@ std::optional<TreeBranch> CurveTree::GetBranch(uint64_t leaf_index) const {
     return branch;
 }
 
+std::optional<TreeFrontier> CurveTree::GetFrontier(uint64_t old_count) const {
+    if (old_count > m_output_count) {
+        return std::nullopt;
+    }
+
+    TreeFrontier frontier;
+    frontier.old_count = old_count;
+    frontier.new_count = m_output_count;
+    frontier.layers.resize(m_depth);
+    if (m_depth == 0) {
+        return frontier;
+    }
+
+    // Layer 0: outputs appended to the leaf commitment the old tree ended in
+    uint64_t changed = old_count / TreeConfig::LEAF_BRANCH_WIDTH;
+    const uint64_t end = std::min((changed + 1) * TreeConfig::LEAF_BRANCH_WIDTH, m_output_count);
+    for (uint64_t i = old_count; i < end; ++i) {
+        auto output = m_storage->GetOutput(i);
+        if (output) {
+            auto elements = output->ToFieldElements();
+            frontier.layers[0].insert(frontier.layers[0].end(), elements.begin(), elements.end());
+        }
+    }
+
+    // Internal layers: the children of the rightmost node from the first
+    // changed one, which is where UpdatePaths() started rehashing. Layers
+    // the old tree did not have are taken whole.
+    const uint32_t old_depth = CalculateDepth(old_count);
+    for (uint32_t layer = 1; layer < m_depth; ++layer) {
+        const uint64_t parent = changed / TreeConfig::INTERNAL_BRANCH_WIDTH;
+        const uint64_t first = layer < old_depth ? changed : parent * TreeConfig::INTERNAL_BRANCH_WIDTH;
+        const uint64_t last = std::min((parent + 1) * TreeConfig::INTERNAL_BRANCH_WIDTH,
+                                       NodesAtLayer(m_output_count, layer - 1));
+        for (uint64_t i = first; i < last; ++i) {
+            auto node = m_storage->GetNode(TreeIndex(layer - 1, i));
+            if (node) {
+                frontier.layers[layer].push_back(Scalar::FromBytesModOrder(node->hash.data.data(), 32));
+            }
+        }
+        changed = parent;
+    }
+
+    return frontier;
+}
+
+bool CurveTree::UpdateBranch(TreeBranch& branch, const TreeFrontier& frontier) {
+    const size_t old_depth = CalculateDepth(frontier.old_count);
+    if (branch.leaf_index >= frontier.old_count || branch.layers.size() != old_depth ||
+        frontier.layers.size() < old_depth) {
+        return false;
+    }
+
+    // Layer 0 only grows if the branch's leaf commitment was the last one
+    uint64_t node = branch.leaf_index / TreeConfig::LEAF_BRANCH_WIDTH;
+    uint64_t changed = frontier.old_count / TreeConfig::LEAF_BRANCH_WIDTH;
+    if (node == changed) {
+        branch.layers[0].insert(branch.layers[0].end(), frontier.layers[0].begin(), frontier.layers[0].end());
+    }
+
+    // Above that the branch lists the children of one node per layer. They
+    // changed from the first rehashed child on if that node is the rightmost
+    // one; layers the tree grew by are new altogether.
+    for (size_t layer = 1; layer < frontier.layers.size(); ++layer) {
+        const uint64_t parent = node / TreeConfig::INTERNAL_BRANCH_WIDTH;
+        const uint64_t changed_parent = changed / TreeConfig::INTERNAL_BRANCH_WIDTH;
+        if (layer >= old_depth) {
+            branch.layers.push_back(frontier.layers[layer]);
+        } else if (parent == changed_parent) {
+            const uint64_t unchanged = changed - parent * TreeConfig::INTERNAL_BRANCH_WIDTH;
+            if (unchanged > branch.layers[layer].size()) {
+                return false;
+            }
+            branch.layers[layer].resize(unchanged);
+            branch.layers[layer].insert(branch.layers[layer].end(),
+                                        frontier.layers[layer].begin(), frontier.layers[layer].end());
+        }
+        node = parent;
+        changed = changed_parent;
+    }
+
+    return true;
+}
+
 bool CurveTree::VerifyBranch(const OutputTuple& output, const TreeBranch& branch,
                              const Point& expected_root) {
     if (branch.layers.empty()) {
@@ -543,6 +721,14 @@ bool CurveTree::VerifyBranch(const OutputTuple& output, const TreeBranch& branch
     return current == expected_root;
 }
 
+namespace {
+
+// Nodes hashed per round by Rebuild() and VerifyIntegrity(), bounding the
+// gathered hash inputs to a few MB however large the tree is
+constexpr uint64_t REBUILD_CHUNK_NODES = 1024;
+
+} // namespace
+
 bool CurveTree::Rebuild() {
     if (m_output_count == 0) {
         return true;
@@ -550,32 +736,23 @@ bool CurveTree::Rebuild() {
 
     m_storage->BeginBatch();
 
-    // Rebuild leaf layer (layer 0) - these are commitments to groups of outputs
-    uint64_t num_leaf_commits = (m_output_count + TreeConfig::LEAF_BRANCH_WIDTH - 1) /
-                                 TreeConfig::LEAF_BRANCH_WIDTH;
-
-    for (uint64_t i = 0; i < num_leaf_commits; ++i) {
-        Point hash = ComputeLeafNode(i);
-        uint64_t start = i * TreeConfig::LEAF_BRANCH_WIDTH;
-        uint64_t end = std::min(start + TreeConfig::LEAF_BRANCH_WIDTH, m_output_count);
-        m_storage->StoreNode(TreeIndex(0, i), TreeNode(hash, end - start));
-    }
+    // Each layer only depends on the one below, so a layer is hashed in
+    // parallel once the layer below it is stored
+    for (uint32_t layer = 0; layer < m_depth; ++layer) {
+        const uint64_t nodes_at_layer = NodesAtLayer(m_output_count, layer);
+        for (uint64_t chunk = 0; chunk < nodes_at_layer; chunk += REBUILD_CHUNK_NODES) {
+            std::vector<uint64_t> indices;
+            for (uint64_t i = chunk; i < std::min(chunk + REBUILD_CHUNK_NODES, nodes_at_layer); ++i) {
+                indices.push_back(i);
+            }
 
-    // Rebuild internal layers (layer 1 and above)
-    uint64_t nodes_at_prev_layer = num_leaf_commits;
-    for (uint32_t layer = 1; layer < m_depth; ++layer) {
-        uint64_t nodes_at_layer = (nodes_at_prev_layer + TreeConfig::INTERNAL_BRANCH_WIDTH - 1) /
-                                   TreeConfig::INTERNAL_BRANCH_WIDTH;
-
-        for (uint64_t i = 0; i < nodes_at_layer; ++i) {
-            auto children = GetChildren(TreeIndex(layer, i));
-            if (!children.empty()) {
-                Point hash = ComputeNodeHash(children);
-                m_storage->StoreNode(TreeIndex(layer, i), TreeNode(hash, children.size()));
+            const std::vector<TreeNode> nodes = ComputeNodes(layer, indices);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                if (layer == 0 || nodes[i].child_count > 0) {
+                    m_storage->StoreNode(TreeIndex(layer, indices[i]), nodes[i]);
+                }
             }
         }
-
-        nodes_at_prev_layer = nodes_at_layer;
     }
 
     m_storage->CommitBatch();
@@ -589,45 +766,94 @@ bool CurveTree::VerifyIntegrity() const {
         return true;
     }
 
-    // Verify each layer's hashes
-    uint64_t num_leaf_commits = (m_output_count + TreeConfig::LEAF_BRANCH_WIDTH - 1) /
-                                 TreeConfig::LEAF_BRANCH_WIDTH;
+    // Check each layer against hashes recomputed from the stored layer below
+    for (uint32_t layer = 0; layer < m_depth; ++layer) {
+        const uint64_t nodes_at_layer = NodesAtLayer(m_output_count, layer);
+        for (uint64_t chunk = 0; chunk < nodes_at_layer; chunk += REBUILD_CHUNK_NODES) {
+            std::vector<uint64_t> indices;
+            for (uint64_t i = chunk; i < std::min(chunk + REBUILD_CHUNK_NODES, nodes_at_layer); ++i) {
+                indices.push_back(i);
+            }
 
-    // Check leaf layer (layer 0) - these are commitments to groups of outputs
-    for (uint64_t i = 0; i < num_leaf_commits; ++i) {
-        auto stored = m_storage->GetNode(TreeIndex(0, i));
-        if (!stored) {
-            return false;
+            const std::vector<TreeNode> expected = ComputeNodes(layer, indices);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                auto stored = m_storage->GetNode(TreeIndex(layer, indices[i]));
+                if (!stored || stored->hash != expected[i].hash) {
+                    return false;
+                }
+            }
         }
+    }
 
-        Point expected = ComputeLeafNode(i);
-        if (stored->hash != expected) {
-            return false;
+    return true;
+}
+
+bool CurveTree::Rewind(const TreeUndo& undo) {
+    if (undo.output_count > m_output_count) {
+        return false;
+    }
+
+    m_storage->BeginBatch();
+
+    for (uint64_t i = undo.output_count; i < m_output_count; ++i) {
+        m_storage->DeleteOutput(i);
+    }
+
+    // Newest first, so a node written twice ends up with its oldest value
+    for (auto it = undo.nodes.rbegin(); it != undo.nodes.rend(); ++it) {
+        if (it->second) {
+            m_storage->StoreNode(it->first, *it->second);
+        } else {
+            m_storage->DeleteNode(it->first);
         }
     }
 
-    // Check internal layers (layer 1 and above)
-    uint64_t nodes_at_prev_layer = num_leaf_commits;
-    for (uint32_t layer = 1; layer < m_depth; ++layer) {
-        uint64_t nodes_at_layer = (nodes_at_prev_layer + TreeConfig::INTERNAL_BRANCH_WIDTH - 1) /
-                                   TreeConfig::INTERNAL_BRANCH_WIDTH;
+    if (!m_storage->CommitBatch()) {
+        return false;
+    }
 
-        for (uint64_t i = 0; i < nodes_at_layer; ++i) {
-            auto stored = m_storage->GetNode(TreeIndex(layer, i));
-            if (!stored) {
-                return false;
-            }
+    m_output_count = undo.output_count;
+    m_depth = undo.depth;
+    m_root_dirty = true;
+    return true;
+}
 
-            auto children = GetChildren(TreeIndex(layer, i));
-            Point expected = ComputeNodeHash(children);
-            if (stored->hash != expected) {
-                return false;
-            }
+bool CurveTree::TruncateTo(uint64_t count) {
+    if (count >= m_output_count) {
+        return count == m_output_count;
+    }
+
+    const uint32_t new_depth = CalculateDepth(count);
+
+    m_storage->BeginBatch();
+
+    for (uint64_t i = count; i < m_output_count; ++i) {
+        m_storage->DeleteOutput(i);
+    }
+
+    // Drop the nodes past the new right edge of every layer, and the layers
+    // above the new root entirely
+    for (uint32_t layer = 0; layer < m_depth; ++layer) {
+        const uint64_t old_nodes = NodesAtLayer(m_output_count, layer);
+        const uint64_t new_nodes = layer < new_depth ? NodesAtLayer(count, layer) : 0;
+        for (uint64_t i = new_nodes; i < old_nodes; ++i) {
+            m_storage->DeleteNode(TreeIndex(layer, i));
         }
+    }
 
-        nodes_at_prev_layer = nodes_at_layer;
+    m_output_count = count;
+    m_depth = new_depth;
+
+    // The last remaining leaf commitment and its ancestors lost children
+    if (count > 0) {
+        UpdatePaths({count - 1});
     }
 
+    if (!m_storage->CommitBatch()) {
+        return false;
+    }
+
+    m_root_dirty = true;
     return true;
 }
 
@@ -122,6 +122,21 @@ struct TreeBranch {
     static std::optional<TreeBranch> Deserialize(const std::vector<uint8_t>& data);
 };
 
+/**
+ * The part of the tree that appends since it held old_count outputs may have
+ * changed in a branch taken back then. Appends only touch the right edge, so
+ * at each layer this is the tail of the children of one node: layers[0]
+ * holds the field elements of the outputs added to the last leaf commitment
+ * of the old tree, layers[k] the hashes of the changed children of the
+ * rightmost layer-k node. Taken once per block, it brings every cached
+ * branch up to date through CurveTree::UpdateBranch().
+ */
+struct TreeFrontier {
+    uint64_t old_count{0};
+    uint64_t new_count{0};
+    std::vector<std::vector<Scalar>> layers;
+};
+
 /**
  * Tree node representing either a leaf commitment or internal hash.
  */
@@ -153,6 +168,7 @@ public:
     // Store/retrieve output tuples by leaf index
     virtual bool StoreOutput(uint64_t index, const OutputTuple& output) = 0;
     virtual std::optional<OutputTuple> GetOutput(uint64_t index) = 0;
+    virtual bool DeleteOutput(uint64_t index) = 0;
 
     // Store/retrieve tree metadata
     virtual bool StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) = 0;
@@ -178,6 +194,7 @@ public:
 
     bool StoreOutput(uint64_t index, const OutputTuple& output) override;
     std::optional<OutputTuple> GetOutput(uint64_t index) override;
+    bool DeleteOutput(uint64_t index) override;
 
     bool StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) override;
     std::optional<std::vector<uint8_t>> GetMetadata(const std::string& key) override;
@@ -194,6 +211,18 @@ private:
     std::map<std::string, std::vector<uint8_t>> m_metadata;
 };
 
+/**
+ * State needed to take back one AddOutputs() call: the output count and
+ * depth before it, and the previous value of every node it wrote (nullopt
+ * for nodes it created). Appends only touch the right edge of the tree, so
+ * this holds O(log n) nodes per batch.
+ */
+struct TreeUndo {
+    uint64_t output_count{0};
+    uint32_t depth{0};
+    std::vector<std::pair<TreeIndex, std::optional<TreeNode>>> nodes;
+};
+
 /**
  * The Curve Tree: an authenticated data structure for privacy outputs.
  *
@@ -212,7 +241,7 @@ public:
     // Create tree with specified storage backend
     explicit CurveTree(std::shared_ptr<ITreeStorage> storage);
 
-    // Create tree with in-memory storage
+    // Create tree with in-memory storage (a heap-backed FlatTreeStorage)
     CurveTree();
 
     ~CurveTree() = default;
@@ -237,8 +266,19 @@ public:
     // Returns the leaf index of the added output
     uint64_t AddOutput(const OutputTuple& output);
 
-    // Add multiple outputs (more efficient than individual adds)
-    std::vector<uint64_t> AddOutputs(const std::vector<OutputTuple>& outputs);
+    // Add multiple outputs (more efficient than individual adds, shared
+    // ancestors of the new outputs are rehashed once). If undo is given it
+    // receives what Rewind() needs to remove the outputs again.
+    std::vector<uint64_t> AddOutputs(const std::vector<OutputTuple>& outputs,
+                                     TreeUndo* undo = nullptr);
+
+    // Take back the most recent AddOutputs() call by restoring the nodes it
+    // overwrote. Undo records must be applied newest first.
+    bool Rewind(const TreeUndo& undo);
+
+    // Remove every output from index count on and recompute the right edge
+    // of the tree, for when no undo record is available
+    bool TruncateTo(uint64_t count);
 
     // Get output by leaf index
     std::optional<OutputTuple> GetOutput(uint64_t index) const;
@@ -251,17 +291,28 @@ public:
     // Extract a branch (Merkle path) for the given leaf index
     std::optional<TreeBranch> GetBranch(uint64_t leaf_index) const;
 
+    // Get what changed in the tree since it held old_count outputs, or
+    // nullopt if it holds fewer than that now (it was rewound)
+    std::optional<TreeFrontier> GetFrontier(uint64_t old_count) const;
+
+    // Bring a branch taken when the tree held frontier.old_count outputs up
+    // to date, without reading the tree. Fails if the branch is not one of
+    // that tree.
+    static bool UpdateBranch(TreeBranch& branch, const TreeFrontier& frontier);
+
     // Verify that a branch is valid for the given output and root
     static bool VerifyBranch(const OutputTuple& output, const TreeBranch& branch,
                              const Point& expected_root);
 
     // ========== Tree Maintenance ==========
 
-    // Rebuild the entire tree from stored outputs
+    // Rebuild the entire tree from stored outputs, layer by layer with the
+    // hashes of each layer spread over threads
     // Use after loading from storage or to fix corrupted tree
     bool Rebuild();
 
-    // Verify tree integrity (all hashes are correct)
+    // Verify tree integrity (all hashes are correct), hashing in parallel
+    // like Rebuild()
     bool VerifyIntegrity() const;
 
     // Get the Pedersen hasher used by this tree
@@ -279,14 +330,28 @@ private:
     // Compute leaf commitment from output tuple
     Point ComputeLeafCommitment(const std::vector<Scalar>& elements) const;
 
+    // Field elements of the outputs under a leaf commitment
+    std::vector<Scalar> GetLeafElements(uint64_t leaf_index) const;
+
     // Compute leaf node (commitment for a group of outputs)
     Point ComputeLeafNode(uint64_t leaf_index) const;
 
     // Compute internal node hash from children
     Point ComputeNodeHash(const std::vector<Point>& children) const;
 
-    // Update tree from leaf index up to root
-    void UpdatePath(uint64_t leaf_index);
+    // Compute the nodes at the given indices of one layer from the layer
+    // below (or the outputs for layer 0). Storage is read on the calling
+    // thread, only the hashing is spread over threads. Nodes without
+    // children come back with a child count of zero.
+    std::vector<TreeNode> ComputeNodes(uint32_t layer, const std::vector<uint64_t>& indices) const;
+
+    // Update tree from the given leaf indices up to root, recomputing each
+    // affected node once, layer by layer. Overwritten nodes are recorded in
+    // undo if given.
+    void UpdatePaths(const std::vector<uint64_t>& leaf_indices, TreeUndo* undo = nullptr);
+
+    // Number of nodes in a layer of a tree holding output_count outputs
+    static uint64_t NodesAtLayer(uint64_t output_count, uint32_t layer);
 
     // Get children of a node
     std::vector<Point> GetChildren(const TreeIndex& parent) const;
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <privacy/curvetree/curve_tree.h>
+#include <privacy/curvetree/flat_storage.h>
 #include <privacy/curvetree/tree_db.h>
 
 #include <iostream>
@@ -161,6 +162,97 @@ void test_memory_storage_basic() {
     std::cout << "  - Basic operations: OK" << std::endl;
 }
 
+void test_flat_storage() {
+    std::cout << "Testing flat tree storage..." << std::endl;
+
+    FlatTreeStorage storage;
+    OutputTuple output = MakeRandomOutput();
+    assert(!storage.GetOutput(0).has_value());
+    assert(storage.StoreOutput(5000, output));
+    assert(*storage.GetOutput(5000) == output);
+    assert(!storage.GetOutput(4999).has_value());
+    assert(storage.GetOutputCount() == 1);
+    assert(storage.StoreOutput(5000, output));
+    assert(storage.GetOutputCount() == 1);
+    assert(storage.DeleteOutput(5000));
+    assert(!storage.GetOutput(5000).has_value());
+    assert(storage.GetOutputCount() == 0);
+
+    TreeNode node(Point::Random(), 7);
+    assert(storage.StoreNode(TreeIndex(3, 12), node));
+    assert(*storage.GetNode(TreeIndex(3, 12)) == node);
+    assert(!storage.GetNode(TreeIndex(2, 12)).has_value());
+    assert(storage.DeleteNode(TreeIndex(3, 12)));
+    assert(!storage.GetNode(TreeIndex(3, 12)).has_value());
+
+    // Same roots as the map-based storage
+    auto outputs = MakeRandomOutputs(TreeConfig::LEAF_BRANCH_WIDTH * 40 + 3);
+    CurveTree flat_tree(std::make_shared<FlatTreeStorage>());
+    CurveTree map_tree(std::make_shared<MemoryTreeStorage>());
+    flat_tree.AddOutputs(outputs);
+    map_tree.AddOutputs(outputs);
+    assert(flat_tree.GetRoot() == map_tree.GetRoot());
+    assert(flat_tree.VerifyIntegrity());
+
+    std::cout << "  - Heap-backed flat storage: OK" << std::endl;
+}
+
+void test_flat_storage_mapped() {
+    std::cout << "Testing mapped flat tree storage..." << std::endl;
+
+    std::filesystem::path temp_dir = std::filesystem::temp_directory_path() / "wattx_curvetree_flat";
+    std::filesystem::path snapshot_dir = std::filesystem::temp_directory_path() / "wattx_curvetree_snapshot";
+    std::filesystem::remove_all(temp_dir);
+
+    auto outputs = MakeRandomOutputs(TreeConfig::LEAF_BRANCH_WIDTH * 3 + 1);
+    Point root;
+    {
+        auto storage = std::make_shared<FlatTreeStorage>(temp_dir);
+        CurveTree tree(storage);
+        tree.AddOutputs(outputs);
+        tree.Save();
+        assert(storage->Sync());
+        root = tree.GetRoot();
+    }
+
+    // Reopening maps the same tree
+    {
+        CurveTree tree(TreeStorageFactory::Create(TreeStorageFactory::StorageType::Flat, temp_dir));
+        assert(tree.GetOutputCount() == outputs.size());
+        assert(tree.GetRoot() == root);
+        assert(*tree.GetOutput(outputs.size() - 1) == outputs.back());
+    }
+
+    // Read-only storage serves reads and refuses writes
+    {
+        FlatTreeStorage storage(temp_dir, /*read_only=*/true);
+        assert(storage.GetOutputCount() == outputs.size());
+        assert(!storage.StoreOutput(0, MakeRandomOutput()));
+        assert(!storage.StoreNode(TreeIndex(0, 0), TreeNode(Point::Random(), 1)));
+        assert(!storage.StoreMetadata("depth", {}));
+        assert(*storage.GetOutput(0) == outputs[0]);
+    }
+
+    // A snapshot of map-based storage loads as the same tree
+    {
+        auto source = std::make_shared<MemoryTreeStorage>();
+        CurveTree tree(source);
+        tree.AddOutputs(outputs);
+        tree.Save();
+        assert(FlatTreeStorage::WriteSnapshot(*source, snapshot_dir));
+
+        CurveTree snapshot(std::make_shared<FlatTreeStorage>(snapshot_dir, /*read_only=*/true));
+        assert(snapshot.GetOutputCount() == outputs.size());
+        assert(snapshot.GetRoot() == root);
+        assert(snapshot.VerifyIntegrity());
+    }
+
+    std::filesystem::remove_all(temp_dir);
+    std::filesystem::remove_all(snapshot_dir);
+
+    std::cout << "  - Mapped flat storage: OK" << std::endl;
+}
+
 // ============================================================================
 // CurveTree Tests
 // ============================================================================
@@ -362,6 +454,125 @@ void test_curve_tree_incremental() {
     std::cout << "  - Incremental updates: OK" << std::endl;
 }
 
+void test_curve_tree_batch_matches_single() {
+    std::cout << "Testing CurveTree batch append matches single adds..." << std::endl;
+
+    CurveTree batched;
+    CurveTree single;
+
+    // Second batch spans several leaf commitments and grows the depth
+    auto first = MakeRandomOutputs(20);
+    auto second = MakeRandomOutputs(TreeConfig::LEAF_BRANCH_WIDTH * 3);
+
+    batched.AddOutputs(first);
+    batched.AddOutputs(second);
+    for (const auto& output : first) single.AddOutput(output);
+    for (const auto& output : second) single.AddOutput(output);
+
+    assert(batched.GetDepth() == single.GetDepth());
+    assert(batched.GetRoot() == single.GetRoot());
+    assert(batched.VerifyIntegrity());
+
+    std::cout << "  - Batch append: OK" << std::endl;
+}
+
+void test_curve_tree_rewind() {
+    std::cout << "Testing CurveTree rewind and truncate..." << std::endl;
+
+    auto first = MakeRandomOutputs(20);
+    auto second = MakeRandomOutputs(TreeConfig::LEAF_BRANCH_WIDTH * 3);
+
+    CurveTree reference;
+    reference.AddOutputs(first);
+
+    // Rewinding the second batch restores the tree holding only the first
+    CurveTree tree;
+    tree.AddOutputs(first);
+    TreeUndo undo;
+    tree.AddOutputs(second, &undo);
+    assert(undo.output_count == first.size());
+    assert(tree.GetDepth() > reference.GetDepth());
+
+    assert(tree.Rewind(undo));
+    assert(tree.GetOutputCount() == first.size());
+    assert(tree.GetDepth() == reference.GetDepth());
+    assert(tree.GetRoot() == reference.GetRoot());
+    assert(!tree.HasOutput(first.size()));
+    assert(tree.VerifyIntegrity());
+
+    // Appending again after a rewind matches a tree that never rewound
+    tree.AddOutputs(second);
+    reference.AddOutputs(second);
+    assert(tree.GetRoot() == reference.GetRoot());
+
+    std::cout << "  - Rewind: OK" << std::endl;
+
+    // Truncating without undo data gives the same tree
+    CurveTree truncated;
+    truncated.AddOutputs(first);
+    truncated.AddOutputs(second);
+    assert(truncated.TruncateTo(first.size()));
+
+    CurveTree expected;
+    expected.AddOutputs(first);
+    assert(truncated.GetDepth() == expected.GetDepth());
+    assert(truncated.GetRoot() == expected.GetRoot());
+    assert(truncated.VerifyIntegrity());
+
+    assert(truncated.TruncateTo(0));
+    assert(truncated.IsEmpty());
+
+    std::cout << "  - Truncate: OK" << std::endl;
+}
+
+void test_curve_tree_frontier() {
+    std::cout << "Testing CurveTree branch updates..." << std::endl;
+
+    const auto same_layers = [](const TreeBranch& a, const TreeBranch& b) {
+        if (a.layers.size() != b.layers.size()) return false;
+        for (size_t i = 0; i < a.layers.size(); ++i) {
+            if (a.layers[i] != b.layers[i]) return false;
+        }
+        return true;
+    };
+
+    // A full tree of two layers, so the next output adds a third
+    const uint64_t full = TreeConfig::LEAF_BRANCH_WIDTH * TreeConfig::INTERNAL_BRANCH_WIDTH;
+    CurveTree tree;
+    tree.AddOutputs(MakeRandomOutputs(full));
+
+    std::vector<TreeBranch> branches;
+    for (uint64_t leaf : {uint64_t{0}, uint64_t{TreeConfig::LEAF_BRANCH_WIDTH}, full - 1}) {
+        branches.push_back(*tree.GetBranch(leaf));
+    }
+
+    // Grow by batches that land in partial leaf commitments and new layers,
+    // tracking a branch of the newest output as well
+    for (size_t batch : {1, 20, 37, 40}) {
+        const uint64_t old_count = tree.GetOutputCount();
+        branches.push_back(*tree.GetBranch(old_count - 1));
+        tree.AddOutputs(MakeRandomOutputs(batch));
+
+        auto frontier = tree.GetFrontier(old_count);
+        assert(frontier.has_value());
+        for (auto& branch : branches) {
+            assert(CurveTree::UpdateBranch(branch, *frontier));
+            assert(same_layers(branch, *tree.GetBranch(branch.leaf_index)));
+        }
+    }
+    assert(tree.GetDepth() == 3);
+
+    // A frontier only applies to branches of the tree it was taken from
+    auto frontier = tree.GetFrontier(tree.GetOutputCount());
+    assert(frontier.has_value());
+    TreeBranch stale = branches.front();
+    stale.layers.pop_back();
+    assert(!CurveTree::UpdateBranch(stale, *frontier));
+    assert(!tree.GetFrontier(tree.GetOutputCount() + 1).has_value());
+
+    std::cout << "  - Branch updates: OK" << std::endl;
+}
+
 // ============================================================================
 // CurveTreeBuilder Tests
 // ============================================================================
@@ -446,6 +657,46 @@ void test_leveldb_storage() {
     std::filesystem::remove_all(temp_dir);
 }
 
+void test_cached_storage() {
+    std::cout << "Testing cached tree storage..." << std::endl;
+
+    auto backing = std::make_shared<MemoryTreeStorage>();
+    // Small enough that the LRU has to evict
+    auto cache = std::make_shared<CachedTreeStorage>(backing, 64 * 1024);
+
+    CurveTree cached_tree(cache);
+    CurveTree plain_tree;
+    auto outputs = MakeRandomOutputs(TreeConfig::LEAF_BRANCH_WIDTH * 4);
+    cached_tree.AddOutputs(outputs);
+    plain_tree.AddOutputs(outputs);
+    assert(cached_tree.GetRoot() == plain_tree.GetRoot());
+    assert(cached_tree.VerifyIntegrity());
+
+    // Nothing reaches the backing storage before a flush
+    assert(backing->GetOutputCount() == 0);
+    assert(cache->GetOutputCount() == outputs.size());
+    assert(cache->GetDirtyCount() > 0);
+
+    // Aborted batches leave no trace
+    cache->BeginBatch();
+    cache->StoreOutput(outputs.size(), MakeRandomOutput());
+    cache->AbortBatch();
+    assert(!cache->GetOutput(outputs.size()).has_value());
+    assert(cache->GetOutputCount() == outputs.size());
+
+    cached_tree.Save();
+    assert(cache->Flush());
+    assert(cache->GetDirtyCount() == 0);
+    assert(backing->GetOutputCount() == outputs.size());
+
+    // A fresh cache over the flushed storage loads the same tree
+    CurveTree reloaded(std::make_shared<CachedTreeStorage>(backing, 64 * 1024));
+    assert(reloaded.GetOutputCount() == outputs.size());
+    assert(reloaded.GetRoot() == plain_tree.GetRoot());
+
+    std::cout << "  - Cached storage: OK" << std::endl;
+}
+
 void test_leveldb_persistence() {
     std::cout << "Testing LevelDB persistence..." << std::endl;
 
@@ -538,6 +789,7 @@ int main() {
 
         // Storage tests
         test_memory_storage_basic();
+        test_flat_storage();
 
         std::cout << std::endl;
 
@@ -550,6 +802,9 @@ int main() {
         test_curve_tree_rebuild();
         test_curve_tree_determinism();
         test_curve_tree_incremental();
+        test_curve_tree_batch_matches_single();
+        test_curve_tree_rewind();
+        test_curve_tree_frontier();
 
         std::cout << std::endl;
 
@@ -560,7 +815,9 @@ int main() {
 
         // LevelDB tests
         test_leveldb_storage();
+        test_cached_storage();
         test_leveldb_persistence();
+        test_flat_storage_mapped();
 
         std::cout << std::endl;
         std::cout << "=== All Curve Tree tests passed! ===" << std::endl;
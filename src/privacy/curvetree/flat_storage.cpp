@@ -0,0 +1,446 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <privacy/curvetree/flat_storage.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace curvetree {
+
+// Region header
+//   bytes 0-7:   magic "WTXCTREE"
+//   bytes 8-11:  format version (LE)
+//   bytes 12-15: record size (LE)
+//   bytes 16-23: counter (LE)
+static constexpr char REGION_MAGIC[8] = {'W', 'T', 'X', 'C', 'T', 'R', 'E', 'E'};
+static constexpr uint32_t REGION_VERSION = 1;
+
+static constexpr const char* METADATA_FILE = "metadata.dat";
+static constexpr const char* OUTPUTS_FILE = "outputs.flat";
+
+static void WriteLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (v >> (i * 8)) & 0xFF;
+}
+
+static uint32_t ReadLE32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (i * 8);
+    return v;
+}
+
+static void WriteLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = (v >> (i * 8)) & 0xFF;
+}
+
+static uint64_t ReadLE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (i * 8);
+    return v;
+}
+
+static std::string LayerFile(uint32_t layer) {
+    return "layer" + std::to_string(layer) + ".flat";
+}
+
+// ============================================================================
+// FlatRegion
+// ============================================================================
+
+FlatRegion::FlatRegion(size_t record_size)
+    : m_record_size(record_size)
+{
+    m_heap.resize(HEADER_SIZE);
+    m_base = m_heap.data();
+    std::memcpy(m_base, REGION_MAGIC, sizeof(REGION_MAGIC));
+    WriteLE32(m_base + 8, REGION_VERSION);
+    WriteLE32(m_base + 12, m_record_size);
+}
+
+FlatRegion::FlatRegion(size_t record_size, const std::filesystem::path& file, bool read_only)
+    : m_record_size(record_size), m_read_only(read_only), m_file(file)
+{
+    const bool exists = std::filesystem::exists(file);
+    if (!exists && read_only) {
+        throw std::runtime_error("Flat tree file missing: " + file.string());
+    }
+
+#ifndef WIN32
+    m_fd = open(file.c_str(), read_only ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (m_fd < 0) {
+        throw std::runtime_error("Failed to open flat tree file: " + file.string());
+    }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+        close(m_fd);
+        throw std::runtime_error("Failed to stat flat tree file: " + file.string());
+    }
+    size_t file_size = st.st_size;
+    if (file_size < HEADER_SIZE) {
+        if (read_only) {
+            close(m_fd);
+            throw std::runtime_error("Truncated flat tree file: " + file.string());
+        }
+        file_size = HEADER_SIZE;
+        if (ftruncate(m_fd, file_size) != 0) {
+            close(m_fd);
+            throw std::runtime_error("Failed to size flat tree file: " + file.string());
+        }
+    }
+    if (!Map(file_size)) {
+        close(m_fd);
+        throw std::runtime_error("Failed to map flat tree file: " + file.string());
+    }
+    m_base = m_map;
+#else
+    // No mmap: keep the records on the heap and write them back on Sync()
+    if (exists) {
+        std::ifstream in(file, std::ios::binary);
+        m_heap.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    if (m_heap.size() < HEADER_SIZE) {
+        if (read_only) throw std::runtime_error("Truncated flat tree file: " + file.string());
+        m_heap.resize(HEADER_SIZE);
+    }
+    m_base = m_heap.data();
+    const size_t file_size = m_heap.size();
+#endif
+
+    if (std::memcmp(m_base, REGION_MAGIC, sizeof(REGION_MAGIC)) == 0) {
+        if (ReadLE32(m_base + 8) != REGION_VERSION || ReadLE32(m_base + 12) != m_record_size) {
+            Unmap();
+            throw std::runtime_error("Incompatible flat tree file: " + file.string());
+        }
+    } else if (!exists || file_size == HEADER_SIZE) {
+        if (read_only) {
+            Unmap();
+            throw std::runtime_error("Not a flat tree file: " + file.string());
+        }
+        std::memset(m_base, 0, HEADER_SIZE);
+        std::memcpy(m_base, REGION_MAGIC, sizeof(REGION_MAGIC));
+        WriteLE32(m_base + 8, REGION_VERSION);
+        WriteLE32(m_base + 12, m_record_size);
+    } else {
+        Unmap();
+        throw std::runtime_error("Not a flat tree file: " + file.string());
+    }
+    m_capacity = (file_size - HEADER_SIZE) / m_record_size;
+}
+
+FlatRegion::~FlatRegion() {
+    Sync();
+    Unmap();
+}
+
+bool FlatRegion::Map(size_t bytes) {
+#ifndef WIN32
+    void* map = mmap(nullptr, bytes, m_read_only ? PROT_READ : (PROT_READ | PROT_WRITE),
+                     MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) return false;
+    m_map = static_cast<uint8_t*>(map);
+    m_map_size = bytes;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FlatRegion::Unmap() {
+#ifndef WIN32
+    if (m_map) munmap(m_map, m_map_size);
+    m_map = nullptr;
+    m_map_size = 0;
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+bool FlatRegion::Grow(uint64_t min_records) {
+    uint64_t records = std::max<uint64_t>(m_capacity, MIN_RECORDS);
+    while (records < min_records) records *= 2;
+    const size_t bytes = HEADER_SIZE + records * m_record_size;
+
+    if (m_fd < 0) {
+        // Heap mode; new records are zero, i.e. not present
+        m_heap.resize(bytes);
+        m_base = m_heap.data();
+        m_capacity = records;
+        return true;
+    }
+
+#ifndef WIN32
+    // The file grows sparse, so only written records take disk space
+    if (ftruncate(m_fd, bytes) != 0) return false;
+    munmap(m_map, m_map_size);
+    m_map = nullptr;
+    if (!Map(bytes)) {
+        m_base = nullptr;
+        m_capacity = 0;
+        return false;
+    }
+    m_base = m_map;
+    m_capacity = records;
+    return true;
+#else
+    return false;
+#endif
+}
+
+const uint8_t* FlatRegion::Find(uint64_t index) const {
+    if (index >= m_capacity) return nullptr;
+    return m_base + HEADER_SIZE + index * m_record_size;
+}
+
+uint8_t* FlatRegion::Record(uint64_t index) {
+    if (m_read_only) return nullptr;
+    if (index >= m_capacity && !Grow(index + 1)) return nullptr;
+    return m_base + HEADER_SIZE + index * m_record_size;
+}
+
+uint64_t FlatRegion::GetCounter() const {
+    return ReadLE64(m_base + 16);
+}
+
+void FlatRegion::SetCounter(uint64_t value) {
+    if (m_read_only) return;
+    WriteLE64(m_base + 16, value);
+}
+
+bool FlatRegion::Sync() {
+    if (m_read_only || m_file.empty()) return true;
+#ifndef WIN32
+    return m_map && msync(m_map, m_map_size, MS_SYNC) == 0;
+#else
+    std::ofstream out(m_file, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(m_heap.data()), m_heap.size());
+    return out.good();
+#endif
+}
+
+// ============================================================================
+// FlatTreeStorage
+// ============================================================================
+
+FlatTreeStorage::FlatTreeStorage()
+    : m_outputs(std::make_unique<FlatRegion>(OUTPUT_RECORD_SIZE))
+{
+}
+
+FlatTreeStorage::FlatTreeStorage(const std::filesystem::path& dir, bool read_only)
+    : m_dir(dir), m_read_only(read_only)
+{
+    if (!read_only) std::filesystem::create_directories(dir);
+    m_outputs = MakeRegion(OUTPUT_RECORD_SIZE, OUTPUTS_FILE);
+
+    // Open existing layers up front so reads never have to create regions
+    for (uint32_t layer = 0; layer < m_layers.size(); ++layer) {
+        if (std::filesystem::exists(dir / LayerFile(layer))) {
+            m_layers[layer] = MakeRegion(NODE_RECORD_SIZE, LayerFile(layer));
+        }
+    }
+
+    if (!ReadMetadata()) {
+        throw std::runtime_error("Corrupt flat tree metadata in " + dir.string());
+    }
+}
+
+FlatTreeStorage::~FlatTreeStorage() {
+    Sync();
+}
+
+std::unique_ptr<FlatRegion> FlatTreeStorage::MakeRegion(size_t record_size, const std::string& name) {
+    if (!m_dir) return std::make_unique<FlatRegion>(record_size);
+    return std::make_unique<FlatRegion>(record_size, *m_dir / name, m_read_only);
+}
+
+FlatRegion* FlatTreeStorage::Layer(uint32_t layer, bool create) {
+    if (layer >= m_layers.size()) return nullptr;
+    if (!m_layers[layer] && create && !m_read_only) {
+        m_layers[layer] = MakeRegion(NODE_RECORD_SIZE, LayerFile(layer));
+    }
+    return m_layers[layer].get();
+}
+
+bool FlatTreeStorage::StoreNode(const TreeIndex& index, const TreeNode& node) {
+    if (node.child_count > UINT32_MAX) return false;
+    FlatRegion* region = Layer(index.layer, /*create=*/true);
+    uint8_t* record = region ? region->Record(index.index) : nullptr;
+    if (!record) return false;
+
+    record[0] = 1;
+    WriteLE32(record + 4, node.child_count);
+    std::memcpy(record + 8, node.hash.data.data(), 32);
+    return true;
+}
+
+std::optional<TreeNode> FlatTreeStorage::GetNode(const TreeIndex& index) {
+    FlatRegion* region = Layer(index.layer, /*create=*/false);
+    const uint8_t* record = region ? region->Find(index.index) : nullptr;
+    if (!record || !record[0]) return std::nullopt;
+
+    TreeNode node;
+    node.child_count = ReadLE32(record + 4);
+    std::memcpy(node.hash.data.data(), record + 8, 32);
+    return node;
+}
+
+bool FlatTreeStorage::DeleteNode(const TreeIndex& index) {
+    if (m_read_only) return false;
+    FlatRegion* region = Layer(index.layer, /*create=*/false);
+    if (!region || index.index >= region->Capacity()) return true;
+    std::memset(region->Record(index.index), 0, NODE_RECORD_SIZE);
+    return true;
+}
+
+bool FlatTreeStorage::StoreOutput(uint64_t index, const OutputTuple& output) {
+    uint8_t* record = m_outputs->Record(index);
+    if (!record) return false;
+
+    if (!record[0]) m_outputs->SetCounter(m_outputs->GetCounter() + 1);
+    record[0] = 1;
+    std::memcpy(record + 4, output.O.data.data(), 32);
+    std::memcpy(record + 36, output.I.data.data(), 32);
+    std::memcpy(record + 68, output.C.data.data(), 32);
+    return true;
+}
+
+std::optional<OutputTuple> FlatTreeStorage::GetOutput(uint64_t index) {
+    const uint8_t* record = m_outputs->Find(index);
+    if (!record || !record[0]) return std::nullopt;
+
+    OutputTuple output;
+    std::memcpy(output.O.data.data(), record + 4, 32);
+    std::memcpy(output.I.data.data(), record + 36, 32);
+    std::memcpy(output.C.data.data(), record + 68, 32);
+    return output;
+}
+
+bool FlatTreeStorage::DeleteOutput(uint64_t index) {
+    if (m_read_only) return false;
+    if (index >= m_outputs->Capacity()) return true;
+    uint8_t* record = m_outputs->Record(index);
+    if (record[0]) m_outputs->SetCounter(m_outputs->GetCounter() - 1);
+    std::memset(record, 0, OUTPUT_RECORD_SIZE);
+    return true;
+}
+
+uint64_t FlatTreeStorage::GetOutputCount() {
+    return m_outputs->GetCounter();
+}
+
+bool FlatTreeStorage::StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) {
+    if (m_read_only) return false;
+    m_metadata[key] = value;
+    return true;
+}
+
+std::optional<std::vector<uint8_t>> FlatTreeStorage::GetMetadata(const std::string& key) {
+    auto it = m_metadata.find(key);
+    if (it == m_metadata.end()) return std::nullopt;
+    return it->second;
+}
+
+// metadata.dat: entry count, then per entry key length, key, value length,
+// value; all lengths 4 bytes LE
+bool FlatTreeStorage::ReadMetadata() {
+    std::ifstream in(*m_dir / METADATA_FILE, std::ios::binary);
+    if (!in) return true;
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    auto read_bytes = [&](std::vector<uint8_t>& out) {
+        if (data.size() - pos < 4) return false;
+        const uint32_t len = ReadLE32(data.data() + pos);
+        pos += 4;
+        if (data.size() - pos < len) return false;
+        out.assign(data.begin() + pos, data.begin() + pos + len);
+        pos += len;
+        return true;
+    };
+
+    if (data.size() < 4) return false;
+    const uint32_t count = ReadLE32(data.data());
+    pos = 4;
+    for (uint32_t i = 0; i < count; ++i) {
+        std::vector<uint8_t> key, value;
+        if (!read_bytes(key) || !read_bytes(value)) return false;
+        m_metadata[std::string(key.begin(), key.end())] = std::move(value);
+    }
+    return pos == data.size();
+}
+
+bool FlatTreeStorage::WriteMetadata() {
+    std::vector<uint8_t> data(4);
+    WriteLE32(data.data(), m_metadata.size());
+    auto append = [&](const uint8_t* p, size_t len) {
+        uint8_t len_bytes[4];
+        WriteLE32(len_bytes, len);
+        data.insert(data.end(), len_bytes, len_bytes + 4);
+        data.insert(data.end(), p, p + len);
+    };
+    for (const auto& [key, value] : m_metadata) {
+        append(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+        append(value.data(), value.size());
+    }
+
+    // Write aside and rename so a crash never leaves half a file
+    const std::filesystem::path tmp = *m_dir / (std::string(METADATA_FILE) + ".new");
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!out.good()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, *m_dir / METADATA_FILE, ec);
+    return !ec;
+}
+
+bool FlatTreeStorage::Sync() {
+    if (!m_dir || m_read_only) return true;
+    bool ok = m_outputs->Sync();
+    for (auto& layer : m_layers) {
+        if (layer) ok &= layer->Sync();
+    }
+    return WriteMetadata() && ok;
+}
+
+bool FlatTreeStorage::WriteSnapshot(ITreeStorage& source, const std::filesystem::path& dir) {
+    std::filesystem::remove_all(dir);
+    FlatTreeStorage snapshot(dir);
+
+    const uint64_t output_count = source.GetOutputCount();
+    for (uint64_t i = 0; i < output_count; ++i) {
+        auto output = source.GetOutput(i);
+        if (!output || !snapshot.StoreOutput(i, *output)) return false;
+    }
+
+    // Nodes of a layer are contiguous from index 0, and the layers above
+    // the root are empty
+    for (uint32_t layer = 0; layer <= TreeConfig::MAX_DEPTH; ++layer) {
+        uint64_t index = 0;
+        while (auto node = source.GetNode(TreeIndex(layer, index))) {
+            if (!snapshot.StoreNode(TreeIndex(layer, index), *node)) return false;
+            ++index;
+        }
+        if (index == 0) break;
+    }
+
+    for (const char* key : {"output_count", "depth"}) {
+        if (auto value = source.GetMetadata(key)) {
+            snapshot.StoreMetadata(key, *value);
+        }
+    }
+    return snapshot.Sync();
+}
+
+} // namespace curvetree
@@ -0,0 +1,151 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_PRIVACY_CURVETREE_FLAT_STORAGE_H
+#define WATTX_PRIVACY_CURVETREE_FLAT_STORAGE_H
+
+#include <privacy/curvetree/curve_tree.h>
+
+#include <array>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace curvetree {
+
+/**
+ * Growable array of fixed-size records
+ *
+ * Record i lives at a fixed offset, so lookups are a multiplication instead
+ * of a map walk. The records are kept in heap memory, or in a memory-mapped
+ * file that the OS can page out, which bounds resident memory for trees far
+ * larger than RAM. The file starts with a 64-byte header holding a magic, the
+ * record size and one user counter.
+ *
+ * Growing moves the records, so pointers returned by Find() and Record() are
+ * only valid until the next Record() call past the capacity.
+ */
+class FlatRegion {
+public:
+    // Heap-backed region
+    explicit FlatRegion(size_t record_size);
+    // Region in `file`, created if missing. Throws if the file exists with a
+    // different record size, or if it can't be opened or mapped.
+    FlatRegion(size_t record_size, const std::filesystem::path& file, bool read_only);
+    ~FlatRegion();
+
+    FlatRegion(const FlatRegion&) = delete;
+    FlatRegion& operator=(const FlatRegion&) = delete;
+
+    // Record at index, nullptr if past the capacity. Never grows.
+    const uint8_t* Find(uint64_t index) const;
+    // Writable record at index, growing the region as needed; nullptr when
+    // read-only or if growing fails
+    uint8_t* Record(uint64_t index);
+
+    uint64_t Capacity() const { return m_capacity; }
+
+    // Counter kept in the header, persisted with the records
+    uint64_t GetCounter() const;
+    void SetCounter(uint64_t value);
+
+    // Flush a file-backed region to disk
+    bool Sync();
+
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr uint64_t MIN_RECORDS = 4096;
+
+private:
+    bool Grow(uint64_t min_records);
+    bool Map(size_t bytes);
+    void Unmap();
+
+    size_t m_record_size;
+    uint64_t m_capacity{0};
+    bool m_read_only{false};
+
+    // Heap mode
+    std::vector<uint8_t> m_heap;
+
+    // File mode
+    std::filesystem::path m_file;
+    int m_fd{-1};
+    uint8_t* m_map{nullptr};
+    size_t m_map_size{0};
+
+    uint8_t* m_base{nullptr};
+};
+
+/**
+ * Tree storage in flat arrays: one region per layer of nodes, addressed by
+ * (layer, index), and one region of outputs. Compared with
+ * MemoryTreeStorage this has no per-entry allocation or map overhead, and
+ * given a directory the regions are memory-mapped files, so regtest and soak
+ * tests with millions of outputs don't need the whole tree in RAM.
+ *
+ * The same directory layout doubles as a read-only snapshot of a tree_db
+ * tree (see WriteSnapshot()): opening it maps the files without reading or
+ * decoding anything, which is much faster than walking LevelDB.
+ *
+ * Batches are no-ops as in MemoryTreeStorage. Concurrent reads are safe while
+ * nothing writes; the tree does not write while it hashes in parallel.
+ */
+class FlatTreeStorage : public ITreeStorage {
+public:
+    // Heap-backed storage
+    FlatTreeStorage();
+    // Storage in `dir`, created if missing; with read_only every Store and
+    // Delete fails
+    explicit FlatTreeStorage(const std::filesystem::path& dir, bool read_only = false);
+    ~FlatTreeStorage() override;
+
+    bool StoreNode(const TreeIndex& index, const TreeNode& node) override;
+    std::optional<TreeNode> GetNode(const TreeIndex& index) override;
+    bool DeleteNode(const TreeIndex& index) override;
+
+    bool StoreOutput(uint64_t index, const OutputTuple& output) override;
+    std::optional<OutputTuple> GetOutput(uint64_t index) override;
+    bool DeleteOutput(uint64_t index) override;
+
+    bool StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) override;
+    std::optional<std::vector<uint8_t>> GetMetadata(const std::string& key) override;
+
+    void BeginBatch() override {}
+    bool CommitBatch() override { return true; }
+    void AbortBatch() override {}
+
+    uint64_t GetOutputCount() override;
+
+    // Write metadata and flush the mapped files; no-op for heap storage
+    bool Sync();
+
+    // Copy every output, node and metadata entry of `source` into a new flat
+    // storage in `dir`, which is cleared first
+    static bool WriteSnapshot(ITreeStorage& source, const std::filesystem::path& dir);
+
+    // Node record: present flag, 3 bytes padding, child count (LE), hash
+    static constexpr size_t NODE_RECORD_SIZE = 4 + 4 + 32;
+    // Output record: present flag, 3 bytes padding, O, I, C
+    static constexpr size_t OUTPUT_RECORD_SIZE = 4 + 96;
+
+private:
+    FlatRegion* Layer(uint32_t layer, bool create);
+    std::unique_ptr<FlatRegion> MakeRegion(size_t record_size, const std::string& name);
+    bool ReadMetadata();
+    bool WriteMetadata();
+
+    std::optional<std::filesystem::path> m_dir;
+    bool m_read_only{false};
+
+    std::array<std::unique_ptr<FlatRegion>, TreeConfig::MAX_DEPTH + 1> m_layers;
+    std::unique_ptr<FlatRegion> m_outputs;
+    std::map<std::string, std::vector<uint8_t>> m_metadata;
+};
+
+} // namespace curvetree
+
+#endif // WATTX_PRIVACY_CURVETREE_FLAT_STORAGE_H
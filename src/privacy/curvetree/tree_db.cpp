@@ -4,11 +4,15 @@
 
 #include <privacy/curvetree/tree_db.h>
 
+#include <privacy/curvetree/flat_storage.h>
+
 #include <leveldb/cache.h>
 #include <leveldb/filter_policy.h>
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
+#include <utility>
 
 namespace curvetree {
 
@@ -196,6 +200,22 @@ std::optional<OutputTuple> LevelDBTreeStorage::GetOutput(uint64_t index) {
     return OutputTuple::Deserialize(data);
 }
 
+bool LevelDBTreeStorage::DeleteOutput(uint64_t index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::string key = MakeOutputKey(index);
+
+    m_output_count_dirty = true;
+
+    if (m_in_batch) {
+        m_batch->Delete(key);
+        return true;
+    }
+
+    leveldb::Status status = m_db->Delete(leveldb::WriteOptions(), key);
+    return status.ok();
+}
+
 bool LevelDBTreeStorage::StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -322,6 +342,283 @@ bool LevelDBTreeStorage::Sync() {
     return m_db->Write(options, &empty_batch).ok();
 }
 
+// ============================================================================
+// CachedTreeStorage Implementation
+// ============================================================================
+
+namespace {
+// Rough memory used by one LRU entry: the value plus list and map node overhead
+template <typename K, typename V>
+constexpr size_t LRU_ENTRY_BYTES = sizeof(K) + sizeof(V) + sizeof(std::pair<K, V>) + 96;
+} // namespace
+
+CachedTreeStorage::CachedTreeStorage(std::shared_ptr<ITreeStorage> backing, size_t cache_bytes)
+    : m_backing(std::move(backing))
+    , m_nodes(cache_bytes / 2 / LRU_ENTRY_BYTES<TreeIndex, TreeNode>)
+    , m_outputs(cache_bytes / 2 / LRU_ENTRY_BYTES<uint64_t, OutputTuple>)
+    , m_output_count(m_backing->GetOutputCount())
+{
+}
+
+bool CachedTreeStorage::IsPinned(const TreeIndex& index) const {
+    if (index.layer + PINNED_LAYERS > m_top_layer) {
+        return true;
+    }
+    auto it = m_rightmost.find(index.layer);
+    return it != m_rightmost.end() && it->second == index.index;
+}
+
+void CachedTreeStorage::CacheNode(const TreeIndex& index, const TreeNode& node) {
+    if (index.layer > m_top_layer) {
+        m_top_layer = index.layer;
+        // Layers that dropped out of the top are cached like the rest
+        for (auto it = m_pinned.begin(); it != m_pinned.end();) {
+            if (IsPinned(it->first)) {
+                ++it;
+                continue;
+            }
+            m_nodes.Put(it->first, it->second);
+            it = m_pinned.erase(it);
+        }
+    }
+
+    auto [edge, inserted] = m_rightmost.try_emplace(index.layer, index.index);
+    if (!inserted && index.index > edge->second) {
+        const TreeIndex previous(index.layer, edge->second);
+        edge->second = index.index;
+        auto it = m_pinned.find(previous);
+        if (it != m_pinned.end() && !IsPinned(previous)) {
+            m_nodes.Put(it->first, it->second);
+            m_pinned.erase(it);
+        }
+    }
+
+    if (IsPinned(index)) {
+        m_pinned[index] = node;
+        m_nodes.Erase(index);
+    } else {
+        m_nodes.Put(index, node);
+    }
+}
+
+bool CachedTreeStorage::StoreNode(const TreeIndex& index, const TreeNode& node) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_in_batch) {
+        m_batch_nodes[index] = node;
+        return true;
+    }
+    m_dirty_nodes[index] = node;
+    CacheNode(index, node);
+    return true;
+}
+
+std::optional<TreeNode> CachedTreeStorage::GetNode(const TreeIndex& index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (auto it = m_batch_nodes.find(index); it != m_batch_nodes.end()) {
+        return it->second;
+    }
+    if (auto it = m_dirty_nodes.find(index); it != m_dirty_nodes.end()) {
+        return it->second;
+    }
+    if (auto it = m_pinned.find(index); it != m_pinned.end()) {
+        return it->second;
+    }
+    if (auto node = m_nodes.Get(index)) {
+        return node;
+    }
+
+    auto node = m_backing->GetNode(index);
+    if (node) {
+        CacheNode(index, *node);
+    }
+    return node;
+}
+
+bool CachedTreeStorage::DeleteNode(const TreeIndex& index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_in_batch) {
+        m_batch_nodes[index] = std::nullopt;
+        return true;
+    }
+    m_dirty_nodes[index] = std::nullopt;
+    m_pinned.erase(index);
+    m_nodes.Erase(index);
+    return true;
+}
+
+bool CachedTreeStorage::StoreOutput(uint64_t index, const OutputTuple& output) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_in_batch) {
+        m_batch_outputs[index] = output;
+        return true;
+    }
+    m_dirty_outputs[index] = output;
+    m_outputs.Put(index, output);
+    m_output_count = std::max(m_output_count, index + 1);
+    return true;
+}
+
+std::optional<OutputTuple> CachedTreeStorage::GetOutput(uint64_t index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (auto it = m_batch_outputs.find(index); it != m_batch_outputs.end()) {
+        return it->second;
+    }
+    if (auto it = m_dirty_outputs.find(index); it != m_dirty_outputs.end()) {
+        return it->second;
+    }
+    if (auto output = m_outputs.Get(index)) {
+        return output;
+    }
+
+    auto output = m_backing->GetOutput(index);
+    if (output) {
+        m_outputs.Put(index, *output);
+    }
+    return output;
+}
+
+bool CachedTreeStorage::DeleteOutput(uint64_t index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_in_batch) {
+        m_batch_outputs[index] = std::nullopt;
+        return true;
+    }
+    m_dirty_outputs[index] = std::nullopt;
+    m_outputs.Erase(index);
+    m_output_count = std::min(m_output_count, index);
+    return true;
+}
+
+bool CachedTreeStorage::StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_in_batch) {
+        m_batch_metadata[key] = value;
+    } else {
+        m_dirty_metadata[key] = value;
+    }
+    return true;
+}
+
+std::optional<std::vector<uint8_t>> CachedTreeStorage::GetMetadata(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (auto it = m_batch_metadata.find(key); it != m_batch_metadata.end()) {
+        return it->second;
+    }
+    if (auto it = m_dirty_metadata.find(key); it != m_dirty_metadata.end()) {
+        return it->second;
+    }
+    return m_backing->GetMetadata(key);
+}
+
+void CachedTreeStorage::BeginBatch() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_in_batch = true;
+}
+
+bool CachedTreeStorage::CommitBatch() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_in_batch) {
+        return false;
+    }
+    m_in_batch = false;
+
+    for (auto& [index, node] : m_batch_nodes) {
+        if (node) {
+            CacheNode(index, *node);
+        } else {
+            m_pinned.erase(index);
+            m_nodes.Erase(index);
+        }
+        m_dirty_nodes[index] = std::move(node);
+    }
+    for (auto& [index, output] : m_batch_outputs) {
+        if (output) {
+            m_outputs.Put(index, *output);
+            m_output_count = std::max(m_output_count, index + 1);
+        } else {
+            m_outputs.Erase(index);
+            m_output_count = std::min(m_output_count, index);
+        }
+        m_dirty_outputs[index] = std::move(output);
+    }
+    for (auto& [key, value] : m_batch_metadata) {
+        m_dirty_metadata[key] = std::move(value);
+    }
+    m_batch_nodes.clear();
+    m_batch_outputs.clear();
+    m_batch_metadata.clear();
+    return true;
+}
+
+void CachedTreeStorage::AbortBatch() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_batch_nodes.clear();
+    m_batch_outputs.clear();
+    m_batch_metadata.clear();
+    m_in_batch = false;
+}
+
+uint64_t CachedTreeStorage::GetOutputCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint64_t count = m_output_count;
+    for (const auto& [index, output] : m_batch_outputs) {
+        count = output ? std::max(count, index + 1) : std::min(count, index);
+    }
+    return count;
+}
+
+bool CachedTreeStorage::Flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_dirty_nodes.empty() && m_dirty_outputs.empty() && m_dirty_metadata.empty()) {
+        return true;
+    }
+
+    m_backing->BeginBatch();
+    for (const auto& [index, node] : m_dirty_nodes) {
+        if (node) {
+            m_backing->StoreNode(index, *node);
+        } else {
+            m_backing->DeleteNode(index);
+        }
+    }
+    for (const auto& [index, output] : m_dirty_outputs) {
+        if (output) {
+            m_backing->StoreOutput(index, *output);
+        } else {
+            m_backing->DeleteOutput(index);
+        }
+    }
+    for (const auto& [key, value] : m_dirty_metadata) {
+        m_backing->StoreMetadata(key, value);
+    }
+    if (!m_backing->CommitBatch()) {
+        // Keep the changes buffered for the next flush
+        return false;
+    }
+
+    m_dirty_nodes.clear();
+    m_dirty_outputs.clear();
+    m_dirty_metadata.clear();
+    return true;
+}
+
+size_t CachedTreeStorage::GetDirtyCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dirty_nodes.size() + m_dirty_outputs.size() + m_dirty_metadata.size();
+}
+
 // ============================================================================
 // TreeStorageFactory Implementation
 // ============================================================================
@@ -338,15 +635,22 @@ std::shared_ptr<ITreeStorage> TreeStorageFactory::Create(StorageType type,
             }
             return std::make_shared<LevelDBTreeStorage>(path);
 
+        case StorageType::Flat:
+            if (path.empty()) {
+                return std::make_shared<FlatTreeStorage>();
+            }
+            return std::make_shared<FlatTreeStorage>(path);
+
         default:
             throw std::runtime_error("Unknown storage type");
     }
 }
 
-std::shared_ptr<ITreeStorage> TreeStorageFactory::CreateDefault(const std::filesystem::path& data_dir) {
+std::shared_ptr<CachedTreeStorage> TreeStorageFactory::CreateDefault(const std::filesystem::path& data_dir,
+                                                                     size_t cache_bytes) {
     std::filesystem::path db_path = data_dir / "curvetree";
     std::filesystem::create_directories(db_path);
-    return Create(StorageType::LevelDB, db_path);
+    return std::make_shared<CachedTreeStorage>(Create(StorageType::LevelDB, db_path), cache_bytes);
 }
 
 } // namespace curvetree
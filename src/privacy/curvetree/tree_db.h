@@ -10,9 +10,14 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
 
 namespace curvetree {
 
@@ -43,6 +48,7 @@ public:
 
     bool StoreOutput(uint64_t index, const OutputTuple& output) override;
     std::optional<OutputTuple> GetOutput(uint64_t index) override;
+    bool DeleteOutput(uint64_t index) override;
 
     bool StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) override;
     std::optional<std::vector<uint8_t>> GetMetadata(const std::string& key) override;
@@ -85,22 +91,137 @@ private:
     mutable bool m_output_count_dirty;
 };
 
+/**
+ * Caching layer in front of another tree storage, normally LevelDB.
+ *
+ * - Nodes of the top PINNED_LAYERS layers and the rightmost node of every
+ *   layer, which every append and most branches read, stay in memory.
+ * - Other nodes and outputs are kept in LRU caches sized from cache_bytes.
+ * - Writes are buffered and only reach the backing storage on Flush(), so
+ *   they can be written together with the chainstate. BeginBatch() and
+ *   CommitBatch() stage writes inside the buffer, AbortBatch() drops them.
+ */
+class CachedTreeStorage : public ITreeStorage {
+public:
+    static constexpr uint32_t PINNED_LAYERS = 3;
+
+    CachedTreeStorage(std::shared_ptr<ITreeStorage> backing, size_t cache_bytes);
+
+    // ITreeStorage interface
+    bool StoreNode(const TreeIndex& index, const TreeNode& node) override;
+    std::optional<TreeNode> GetNode(const TreeIndex& index) override;
+    bool DeleteNode(const TreeIndex& index) override;
+
+    bool StoreOutput(uint64_t index, const OutputTuple& output) override;
+    std::optional<OutputTuple> GetOutput(uint64_t index) override;
+    bool DeleteOutput(uint64_t index) override;
+
+    bool StoreMetadata(const std::string& key, const std::vector<uint8_t>& value) override;
+    std::optional<std::vector<uint8_t>> GetMetadata(const std::string& key) override;
+
+    void BeginBatch() override;
+    bool CommitBatch() override;
+    void AbortBatch() override;
+
+    // Outputs are appended and deleted at the end, so this is one past the highest index
+    uint64_t GetOutputCount() override;
+
+    // Write the buffered changes to the backing storage in one batch
+    bool Flush();
+
+    // Number of buffered changes not yet written to the backing storage
+    size_t GetDirtyCount() const;
+
+private:
+    template <typename K, typename V>
+    class LRU {
+    public:
+        explicit LRU(size_t max_entries) : m_max_entries(std::max<size_t>(max_entries, 1)) {}
+
+        std::optional<V> Get(const K& key) {
+            auto it = m_index.find(key);
+            if (it == m_index.end()) return std::nullopt;
+            m_items.splice(m_items.begin(), m_items, it->second);
+            return it->second->second;
+        }
+
+        void Put(const K& key, const V& value) {
+            auto it = m_index.find(key);
+            if (it != m_index.end()) {
+                it->second->second = value;
+                m_items.splice(m_items.begin(), m_items, it->second);
+                return;
+            }
+            m_items.emplace_front(key, value);
+            m_index.emplace(key, m_items.begin());
+            if (m_items.size() > m_max_entries) {
+                m_index.erase(m_items.back().first);
+                m_items.pop_back();
+            }
+        }
+
+        void Erase(const K& key) {
+            auto it = m_index.find(key);
+            if (it == m_index.end()) return;
+            m_items.erase(it->second);
+            m_index.erase(it);
+        }
+
+    private:
+        size_t m_max_entries;
+        std::list<std::pair<K, V>> m_items;
+        std::map<K, typename std::list<std::pair<K, V>>::iterator> m_index;
+    };
+
+    bool IsPinned(const TreeIndex& index) const;
+    // Put a node in the pinned set or the LRU, updating the top layer and right edge
+    void CacheNode(const TreeIndex& index, const TreeNode& node);
+
+    std::shared_ptr<ITreeStorage> m_backing;
+    mutable std::mutex m_mutex;
+
+    std::map<TreeIndex, TreeNode> m_pinned;
+    uint32_t m_top_layer{0};
+    std::map<uint32_t, uint64_t> m_rightmost;
+    LRU<TreeIndex, TreeNode> m_nodes;
+    LRU<uint64_t, OutputTuple> m_outputs;
+
+    // Changes not yet flushed, nullopt nodes are deletions
+    std::map<TreeIndex, std::optional<TreeNode>> m_dirty_nodes;
+    std::map<uint64_t, std::optional<OutputTuple>> m_dirty_outputs;
+    std::map<std::string, std::vector<uint8_t>> m_dirty_metadata;
+
+    // Changes of the open batch, merged into the above on CommitBatch()
+    bool m_in_batch{false};
+    std::map<TreeIndex, std::optional<TreeNode>> m_batch_nodes;
+    std::map<uint64_t, std::optional<OutputTuple>> m_batch_outputs;
+    std::map<std::string, std::vector<uint8_t>> m_batch_metadata;
+
+    uint64_t m_output_count;
+};
+
 /**
  * Factory for creating tree storage instances.
- * Supports both in-memory (testing) and LevelDB (production) backends.
+ * Supports in-memory (testing), LevelDB (production) and flat-array backends.
+ * Flat storage is heap-backed without a path and memory-mapped with one.
  */
 class TreeStorageFactory {
 public:
     enum class StorageType {
         Memory,
-        LevelDB
+        LevelDB,
+        Flat
     };
 
     static std::shared_ptr<ITreeStorage> Create(StorageType type,
                                                 const std::filesystem::path& path = "");
 
-    // Create default storage for the node's data directory
-    static std::shared_ptr<ITreeStorage> CreateDefault(const std::filesystem::path& data_dir);
+    // Create default storage for the node's data directory: LevelDB behind a
+    // CachedTreeStorage of cache_bytes
+    static std::shared_ptr<CachedTreeStorage> CreateDefault(const std::filesystem::path& data_dir,
+                                                            size_t cache_bytes = DEFAULT_CACHE_BYTES);
+
+    static constexpr size_t DEFAULT_CACHE_BYTES = 16 * 1024 * 1024;
 };
 
 } // namespace curvetree
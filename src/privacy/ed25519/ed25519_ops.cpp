@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <privacy/ed25519/ed25519_types.h>
+#include <privacy/ed25519/extended_point.h>
 
 #include <crypto/sha512.h>
 #include <util/strencodings.h>
@@ -318,24 +319,34 @@ Point MultiScalarMul(const std::vector<Scalar>& scalars, const std::vector<Point
         return Point::Identity();
     }
 
-    // Simple implementation: sum of individual products
-    // TODO: Implement Pippenger's algorithm for better performance
-    Point result = Point::Identity();
+    // Points that crypto_scalarmult_ed25519_noclamp rejects (off the curve,
+    // small order or outside the prime-order subgroup) add nothing, as when
+    // every product was computed on its own. The rest are decoded once and
+    // summed in extended coordinates.
+    std::vector<Scalar> valid_scalars;
+    std::vector<ExtendedPoint> decoded;
+    valid_scalars.reserve(scalars.size());
+    decoded.reserve(points.size());
     for (size_t i = 0; i < scalars.size(); ++i) {
-        result += points[i] * scalars[i];
+        ExtendedPoint point;
+        if (!points[i].IsValid() || !ExtendedPoint::Decode(points[i], point)) {
+            continue;
+        }
+        valid_scalars.push_back(scalars[i]);
+        decoded.push_back(point);
     }
-    return result;
+    return MultiScalarMul(valid_scalars, decoded).Encode();
 }
 
 Point DoubleScalarMulBase(const Scalar& a, const Scalar& b, const Point& P) {
-    // Compute a*G + b*P where G is base point
-    Point aG;
-    if (crypto_scalarmult_ed25519_base_noclamp(aG.data.data(), a.data.data()) != 0) {
-        aG = Point::Identity();
-    }
+    // Compute a*G + b*P where G is base point, encoding only the sum
+    ExtendedPoint result = FixedBaseTable::Base().Mul(a);
 
-    Point bP = P * b;
-    return aG + bP;
+    ExtendedPoint decoded;
+    if (P.IsValid() && ExtendedPoint::Decode(P, decoded)) {
+        result += decoded * b;
+    }
+    return result.Encode();
 }
 
 // ============================================================================
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <privacy/ed25519/ed25519_types.h>
+#include <privacy/ed25519/extended_point.h>
 #include <privacy/ed25519/pedersen.h>
 
 #include <iostream>
@@ -224,6 +225,62 @@ void test_multi_scalar_mul() {
     std::cout << "  - Multi-scalar multiplication: OK" << std::endl;
 }
 
+void test_extended_point() {
+    std::cout << "Testing extended coordinates..." << std::endl;
+
+    Point G = Point::BasePoint();
+    Point P = Point::Random();
+    Scalar a = Scalar::Random();
+    Scalar b = Scalar::Random();
+
+    // Decoding and encoding round trip
+    ExtendedPoint ext_G = ExtendedPoint::FromPoint(G);
+    ExtendedPoint ext_P = ExtendedPoint::FromPoint(P);
+    assert(ext_G == ExtendedPoint::BasePoint());
+    assert(ext_P.Encode() == P);
+    assert(ExtendedPoint().Encode() == Point::Identity());
+    assert((ext_P - ext_P).IsIdentity());
+
+    // y = p is not a canonical encoding
+    Point non_canonical;
+    non_canonical.data.fill(0xff);
+    non_canonical.data[0] = 0xed;
+    non_canonical.data[31] = 0x7f;
+    ExtendedPoint decoded;
+    assert(!ExtendedPoint::Decode(non_canonical, decoded));
+
+    // Arithmetic matches libsodium
+    assert((ext_G + ext_P).Encode() == G + P);
+    assert((ext_G - ext_P).Encode() == G - P);
+    assert((-ext_P).Encode() == -P);
+    assert(ext_P.Double().Encode() == P + P);
+    assert((ext_P * a).Encode() == P * a);
+    assert(FixedBaseTable::Base().Mul(a).Encode() == G * a);
+    assert(FixedBaseTable(ext_P).Mul(b).Encode() == P * b);
+    assert(DoubleScalarMulBase(a, b, P) == G * a + P * b);
+
+    // The top bit of the scalar is ignored, as in libsodium
+    Scalar high = a;
+    high.data[31] |= 0x80;
+    assert(FixedBaseTable::Base().Mul(high).Encode() == G * high);
+    assert((ext_P * high).Encode() == P * high);
+
+    // Batch encoding shares one inversion
+    std::vector<ExtendedPoint> points = {ext_G, ext_P, ext_G + ext_P, ExtendedPoint()};
+    std::vector<Point> encoded = BatchEncode(points);
+    assert(encoded.size() == points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        assert(encoded[i] == points[i].Encode());
+    }
+
+    // Points libsodium would not multiply add nothing to a multi-scalar product
+    std::vector<Scalar> scalars = {a, b};
+    std::vector<Point> with_invalid = {P, non_canonical};
+    assert(MultiScalarMul(scalars, with_invalid) == P * a);
+
+    std::cout << "  - Extended coordinates: OK" << std::endl;
+}
+
 // ============================================================================
 // KeyPair Tests
 // ============================================================================
@@ -314,6 +371,10 @@ void test_pedersen_commitment() {
 
     PedersenCommitment C = PedersenCommitment::Commit(v, r);
 
+    // The tables give the same point as direct multiplication
+    const PedersenGenerators& gens = PedersenGenerators::Default();
+    assert(C.GetPoint() == gens.G() * v + gens.H() * r);
+
     // Opening should verify
     PedersenOpening opening(v, r);
     assert(opening.Verify(C));
@@ -448,6 +509,7 @@ int main() {
         test_scalar_mul();
         test_hash_to_point();
         test_multi_scalar_mul();
+        test_extended_point();
 
         std::cout << std::endl;
 
@@ -0,0 +1,552 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <privacy/ed25519/extended_point.h>
+
+#include <stdexcept>
+
+namespace ed25519 {
+
+// ============================================================================
+// Field Arithmetic (mod 2^255 - 19)
+// ============================================================================
+
+namespace {
+
+using uint128 = unsigned __int128;
+
+constexpr uint64_t MASK51 = (uint64_t{1} << 51) - 1;
+
+// d = -121665/121666
+constexpr FieldElement FE_D{{0x34dca135978a3, 0x1a8283b156ebd, 0x5e7a26001c029, 0x739c663a03cbb, 0x52036cee2b6ff}};
+// 2*d
+constexpr FieldElement FE_D2{{0x69b9426b2f159, 0x35050762add7a, 0x3cf44c0038052, 0x6738cc7407977, 0x2406d9dc56dff}};
+// sqrt(-1)
+constexpr FieldElement FE_SQRTM1{{0x61b274a0ea0b0, 0xd5a5fc8f189d, 0x7ef5e9cbd0c60, 0x78595a6804c9e, 0x2b8324804fc1d}};
+
+constexpr FieldElement FE_ZERO{{0, 0, 0, 0, 0}};
+constexpr FieldElement FE_ONE{{1, 0, 0, 0, 0}};
+
+// Encoding of the Ed25519 base point
+constexpr std::array<uint8_t, POINT_SIZE> BASE_POINT_BYTES = {
+    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+uint64_t Load64(const uint8_t* p) {
+    uint64_t r = 0;
+    for (int i = 7; i >= 0; --i) r = (r << 8) | p[i];
+    return r;
+}
+
+void Store64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = v & 0xff;
+        v >>= 8;
+    }
+}
+
+// Bring every limb back under 2^51 (plus a small excess in limb 1)
+void FeCarry(FieldElement& h) {
+    uint64_t c;
+    c = h.v[0] >> 51; h.v[0] &= MASK51; h.v[1] += c;
+    c = h.v[1] >> 51; h.v[1] &= MASK51; h.v[2] += c;
+    c = h.v[2] >> 51; h.v[2] &= MASK51; h.v[3] += c;
+    c = h.v[3] >> 51; h.v[3] &= MASK51; h.v[4] += c;
+    c = h.v[4] >> 51; h.v[4] &= MASK51; h.v[0] += c * 19;
+    c = h.v[0] >> 51; h.v[0] &= MASK51; h.v[1] += c;
+}
+
+FieldElement FeAdd(const FieldElement& f, const FieldElement& g) {
+    FieldElement h;
+    for (int i = 0; i < 5; ++i) h.v[i] = f.v[i] + g.v[i];
+    FeCarry(h);
+    return h;
+}
+
+FieldElement FeSub(const FieldElement& f, const FieldElement& g) {
+    // Add 2*p so that no limb goes negative
+    FieldElement h;
+    h.v[0] = f.v[0] + 0xfffffffffffda - g.v[0];
+    for (int i = 1; i < 5; ++i) h.v[i] = f.v[i] + 0xffffffffffffe - g.v[i];
+    FeCarry(h);
+    return h;
+}
+
+FieldElement FeNeg(const FieldElement& f) {
+    return FeSub(FE_ZERO, f);
+}
+
+FieldElement FeMul(const FieldElement& f, const FieldElement& g) {
+    const uint64_t f0 = f.v[0], f1 = f.v[1], f2 = f.v[2], f3 = f.v[3], f4 = f.v[4];
+    const uint64_t g0 = g.v[0], g1 = g.v[1], g2 = g.v[2], g3 = g.v[3], g4 = g.v[4];
+    const uint64_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3, g4_19 = 19 * g4;
+
+    uint128 r0 = (uint128)f0 * g0 + (uint128)f1 * g4_19 + (uint128)f2 * g3_19 + (uint128)f3 * g2_19 + (uint128)f4 * g1_19;
+    uint128 r1 = (uint128)f0 * g1 + (uint128)f1 * g0 + (uint128)f2 * g4_19 + (uint128)f3 * g3_19 + (uint128)f4 * g2_19;
+    uint128 r2 = (uint128)f0 * g2 + (uint128)f1 * g1 + (uint128)f2 * g0 + (uint128)f3 * g4_19 + (uint128)f4 * g3_19;
+    uint128 r3 = (uint128)f0 * g3 + (uint128)f1 * g2 + (uint128)f2 * g1 + (uint128)f3 * g0 + (uint128)f4 * g4_19;
+    uint128 r4 = (uint128)f0 * g4 + (uint128)f1 * g3 + (uint128)f2 * g2 + (uint128)f3 * g1 + (uint128)f4 * g0;
+
+    FieldElement h;
+    r1 += (uint64_t)(r0 >> 51); h.v[0] = (uint64_t)r0 & MASK51;
+    r2 += (uint64_t)(r1 >> 51); h.v[1] = (uint64_t)r1 & MASK51;
+    r3 += (uint64_t)(r2 >> 51); h.v[2] = (uint64_t)r2 & MASK51;
+    r4 += (uint64_t)(r3 >> 51); h.v[3] = (uint64_t)r3 & MASK51;
+    const uint64_t c = (uint64_t)(r4 >> 51);
+    h.v[4] = (uint64_t)r4 & MASK51;
+    h.v[0] += c * 19;
+    h.v[1] += h.v[0] >> 51;
+    h.v[0] &= MASK51;
+    return h;
+}
+
+FieldElement FeSq(const FieldElement& f) {
+    return FeMul(f, f);
+}
+
+FieldElement FeSqN(FieldElement f, int n) {
+    for (int i = 0; i < n; ++i) f = FeSq(f);
+    return f;
+}
+
+// z^(2^255 - 21) = 1/z
+FieldElement FeInvert(const FieldElement& z) {
+    FieldElement t0 = FeSq(z);                  // 2
+    FieldElement t1 = FeMul(z, FeSqN(t0, 2));   // 9
+    t0 = FeMul(t0, t1);                         // 11
+    FieldElement t2 = FeSq(t0);                 // 22
+    t1 = FeMul(t1, t2);                         // 2^5 - 1
+    t1 = FeMul(FeSqN(t1, 5), t1);               // 2^10 - 1
+    t2 = FeMul(FeSqN(t1, 10), t1);              // 2^20 - 1
+    t2 = FeMul(FeSqN(t2, 20), t2);              // 2^40 - 1
+    t1 = FeMul(FeSqN(t2, 10), t1);              // 2^50 - 1
+    t2 = FeMul(FeSqN(t1, 50), t1);              // 2^100 - 1
+    t2 = FeMul(FeSqN(t2, 100), t2);             // 2^200 - 1
+    t1 = FeMul(FeSqN(t2, 50), t1);              // 2^250 - 1
+    return FeMul(FeSqN(t1, 5), t0);             // 2^255 - 21
+}
+
+// z^(2^252 - 3), used for square roots
+FieldElement FePow22523(const FieldElement& z) {
+    FieldElement t0 = FeSq(z);                  // 2
+    FieldElement t1 = FeMul(z, FeSqN(t0, 2));   // 9
+    t0 = FeMul(t0, t1);                         // 11
+    t0 = FeMul(t1, FeSq(t0));                   // 2^5 - 1
+    t0 = FeMul(FeSqN(t0, 5), t0);               // 2^10 - 1
+    t1 = FeMul(FeSqN(t0, 10), t0);              // 2^20 - 1
+    t1 = FeMul(FeSqN(t1, 20), t1);              // 2^40 - 1
+    t0 = FeMul(FeSqN(t1, 10), t0);              // 2^50 - 1
+    t1 = FeMul(FeSqN(t0, 50), t0);              // 2^100 - 1
+    t1 = FeMul(FeSqN(t1, 100), t1);             // 2^200 - 1
+    t0 = FeMul(FeSqN(t1, 50), t0);              // 2^250 - 1
+    return FeMul(FeSqN(t0, 2), z);              // 2^252 - 3
+}
+
+FieldElement FeFromBytes(const uint8_t* s) {
+    FieldElement h;
+    h.v[0] = Load64(s) & MASK51;
+    h.v[1] = (Load64(s + 6) >> 3) & MASK51;
+    h.v[2] = (Load64(s + 12) >> 6) & MASK51;
+    h.v[3] = (Load64(s + 19) >> 1) & MASK51;
+    h.v[4] = (Load64(s + 24) >> 12) & MASK51;
+    return h;
+}
+
+std::array<uint8_t, 32> FeToBytes(const FieldElement& f) {
+    uint64_t t[5] = {f.v[0], f.v[1], f.v[2], f.v[3], f.v[4]};
+    const auto carry = [&t] {
+        t[1] += t[0] >> 51; t[0] &= MASK51;
+        t[2] += t[1] >> 51; t[1] &= MASK51;
+        t[3] += t[2] >> 51; t[2] &= MASK51;
+        t[4] += t[3] >> 51; t[3] &= MASK51;
+    };
+    carry();
+    t[0] += 19 * (t[4] >> 51); t[4] &= MASK51;
+    carry();
+    t[0] += 19 * (t[4] >> 51); t[4] &= MASK51;
+
+    // t is now below 2^255. Adding 19 overflows 2^255, and is folded back
+    // once more, exactly when t >= p; adding 2^255 - 19 and dropping bit 255
+    // then leaves t mod p.
+    t[0] += 19;
+    carry();
+    t[0] += 19 * (t[4] >> 51); t[4] &= MASK51;
+    t[0] += 0x8000000000000 - 19;
+    t[1] += 0x8000000000000 - 1;
+    t[2] += 0x8000000000000 - 1;
+    t[3] += 0x8000000000000 - 1;
+    t[4] += 0x8000000000000 - 1;
+    carry();
+    t[4] &= MASK51;
+
+    std::array<uint8_t, 32> s;
+    Store64(s.data(), t[0] | (t[1] << 51));
+    Store64(s.data() + 8, (t[1] >> 13) | (t[2] << 38));
+    Store64(s.data() + 16, (t[2] >> 26) | (t[3] << 25));
+    Store64(s.data() + 24, (t[3] >> 39) | (t[4] << 12));
+    return s;
+}
+
+bool FeIsZero(const FieldElement& f) {
+    const auto s = FeToBytes(f);
+    uint8_t acc = 0;
+    for (uint8_t b : s) acc |= b;
+    return acc == 0;
+}
+
+bool FeIsNegative(const FieldElement& f) {
+    return FeToBytes(f)[0] & 1;
+}
+
+bool FeEqual(const FieldElement& f, const FieldElement& g) {
+    return FeIsZero(FeSub(f, g));
+}
+
+// f = g if b == 1, unchanged if b == 0, without branching on b
+void FeCMov(FieldElement& f, const FieldElement& g, uint64_t b) {
+    const uint64_t mask = -b;
+    for (int i = 0; i < 5; ++i) f.v[i] ^= mask & (f.v[i] ^ g.v[i]);
+}
+
+// 1 if b == c, else 0
+uint64_t Equal(uint8_t b, uint8_t c) {
+    uint32_t x = b ^ c;
+    x -= 1;
+    return x >> 31;
+}
+
+/**
+ * Signed radix-16 digits of a scalar, each in [-8, 8]. The top bit of the
+ * scalar is cleared first, as crypto_scalarmult_ed25519_noclamp does.
+ */
+std::array<int8_t, 64> RecodeScalar(const Scalar& scalar) {
+    std::array<uint8_t, 32> a = scalar.data;
+    a[31] &= 127;
+
+    std::array<int8_t, 64> e;
+    for (int i = 0; i < 32; ++i) {
+        e[2 * i] = a[i] & 15;
+        e[2 * i + 1] = (a[i] >> 4) & 15;
+    }
+    int8_t carry = 0;
+    for (int i = 0; i < 63; ++i) {
+        e[i] += carry;
+        carry = (e[i] + 8) >> 4;
+        e[i] -= carry * 16;
+    }
+    e[63] += carry;
+    return e;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Point Formulas
+// ============================================================================
+
+using Cached = FixedBaseTable::Cached;
+
+/**
+ * Curve formulas on the private coordinates. The additions are the complete
+ * extended-coordinate formulas for a = -1 (Hisil, Wong, Carter and Dawson,
+ * 2008), so they need no special case for doubling or the identity.
+ */
+struct ExtendedPointOps {
+    static Cached ToCached(const ExtendedPoint& p) {
+        return Cached{FeAdd(p.m_Y, p.m_X), FeSub(p.m_Y, p.m_X), p.m_Z, FeMul(p.m_T, FE_D2)};
+    }
+
+    static Cached CachedIdentity() {
+        return Cached{FE_ONE, FE_ONE, FE_ONE, FE_ZERO};
+    }
+
+    static ExtendedPoint Add(const ExtendedPoint& p, const Cached& q, bool subtract) {
+        const FieldElement a = FeMul(FeSub(p.m_Y, p.m_X), subtract ? q.YplusX : q.YminusX);
+        const FieldElement b = FeMul(FeAdd(p.m_Y, p.m_X), subtract ? q.YminusX : q.YplusX);
+        const FieldElement c = FeMul(p.m_T, q.T2d);
+        const FieldElement zz = FeMul(p.m_Z, q.Z);
+        const FieldElement d = FeAdd(zz, zz);
+
+        const FieldElement e = FeSub(b, a);
+        const FieldElement f = subtract ? FeAdd(d, c) : FeSub(d, c);
+        const FieldElement g = subtract ? FeSub(d, c) : FeAdd(d, c);
+        const FieldElement h = FeAdd(b, a);
+
+        ExtendedPoint r;
+        r.m_X = FeMul(e, f);
+        r.m_Y = FeMul(g, h);
+        r.m_T = FeMul(e, h);
+        r.m_Z = FeMul(f, g);
+        return r;
+    }
+
+    static ExtendedPoint Double(const ExtendedPoint& p) {
+        const FieldElement a = FeSq(p.m_X);
+        const FieldElement b = FeSq(p.m_Y);
+        const FieldElement zz = FeSq(p.m_Z);
+        const FieldElement c = FeAdd(zz, zz);
+        const FieldElement h = FeAdd(a, b);
+        const FieldElement e = FeSub(h, FeSq(FeAdd(p.m_X, p.m_Y)));
+        const FieldElement g = FeSub(a, b);
+        const FieldElement f = FeAdd(c, g);
+
+        ExtendedPoint r;
+        r.m_X = FeMul(e, f);
+        r.m_Y = FeMul(g, h);
+        r.m_T = FeMul(e, h);
+        r.m_Z = FeMul(f, g);
+        return r;
+    }
+
+    // table[j] = (j + 1) * P; returns digit * P without branching on the digit
+    static Cached Select(const std::array<Cached, 8>& table, int8_t digit) {
+        const uint8_t negative = static_cast<uint8_t>(digit) >> 7;
+        const uint8_t abs = digit - ((-negative & digit) << 1);
+
+        Cached t = CachedIdentity();
+        for (int j = 0; j < 8; ++j) {
+            const uint64_t match = Equal(abs, j + 1);
+            FeCMov(t.YplusX, table[j].YplusX, match);
+            FeCMov(t.YminusX, table[j].YminusX, match);
+            FeCMov(t.Z, table[j].Z, match);
+            FeCMov(t.T2d, table[j].T2d, match);
+        }
+
+        // -(x, y) = (-x, y): swap y+x with y-x and negate 2dT
+        const Cached neg{t.YminusX, t.YplusX, t.Z, FeNeg(t.T2d)};
+        FeCMov(t.YplusX, neg.YplusX, negative);
+        FeCMov(t.YminusX, neg.YminusX, negative);
+        FeCMov(t.T2d, neg.T2d, negative);
+        return t;
+    }
+
+    // P, 2P, ..., 8P
+    static std::array<Cached, 8> Multiples(const ExtendedPoint& p) {
+        std::array<Cached, 8> table;
+        table[0] = ToCached(p);
+        ExtendedPoint multiple = p;
+        for (int j = 1; j < 8; ++j) {
+            multiple = Add(multiple, table[0], false);
+            table[j] = ToCached(multiple);
+        }
+        return table;
+    }
+
+    static ExtendedPoint Double4(ExtendedPoint p) {
+        for (int i = 0; i < 4; ++i) p = Double(p);
+        return p;
+    }
+
+    static Point EncodeWithInverse(const ExtendedPoint& p, const FieldElement& z_inv) {
+        Point result;
+        result.data = FeToBytes(FeMul(p.m_Y, z_inv));
+        result.data[31] ^= FeIsNegative(FeMul(p.m_X, z_inv)) << 7;
+        return result;
+    }
+
+    static FieldElement Z(const ExtendedPoint& p) { return p.m_Z; }
+};
+
+// ============================================================================
+// ExtendedPoint Implementation
+// ============================================================================
+
+ExtendedPoint::ExtendedPoint()
+    : m_X(FE_ZERO), m_Y(FE_ONE), m_Z(FE_ONE), m_T(FE_ZERO) {}
+
+bool ExtendedPoint::Decode(const Point& p, ExtendedPoint& out) {
+    const FieldElement y = FeFromBytes(p.data.data());
+
+    // Reject y >= p
+    std::array<uint8_t, 32> canonical = p.data;
+    canonical[31] &= 127;
+    if (FeToBytes(y) != canonical) {
+        return false;
+    }
+
+    // x^2 = (y^2 - 1) / (d*y^2 + 1) = u/v
+    const FieldElement yy = FeSq(y);
+    const FieldElement u = FeSub(yy, FE_ONE);
+    const FieldElement v = FeAdd(FeMul(yy, FE_D), FE_ONE);
+
+    // x = u * v^3 * (u * v^7)^((p - 5) / 8)
+    const FieldElement v3 = FeMul(FeSq(v), v);
+    FieldElement x = FeMul(FeMul(FeSq(v3), v), u);
+    x = FeMul(FeMul(FePow22523(x), v3), u);
+
+    const FieldElement vxx = FeMul(FeSq(x), v);
+    if (!FeEqual(vxx, u)) {
+        if (!FeEqual(vxx, FeNeg(u))) {
+            return false; // not on the curve
+        }
+        x = FeMul(x, FE_SQRTM1);
+    }
+
+    const bool sign = p.data[31] >> 7;
+    if (sign && FeIsZero(x)) {
+        return false;
+    }
+    if (FeIsNegative(x) != sign) {
+        x = FeNeg(x);
+    }
+
+    out.m_X = x;
+    out.m_Y = y;
+    out.m_Z = FE_ONE;
+    out.m_T = FeMul(x, y);
+    return true;
+}
+
+ExtendedPoint ExtendedPoint::FromPoint(const Point& p) {
+    ExtendedPoint result;
+    if (!Decode(p, result)) {
+        throw std::runtime_error("Failed to decode Ed25519 point");
+    }
+    return result;
+}
+
+ExtendedPoint ExtendedPoint::BasePoint() {
+    static const ExtendedPoint base = FromPoint(Point(BASE_POINT_BYTES));
+    return base;
+}
+
+Point ExtendedPoint::Encode() const {
+    return ExtendedPointOps::EncodeWithInverse(*this, FeInvert(m_Z));
+}
+
+ExtendedPoint ExtendedPoint::operator+(const ExtendedPoint& other) const {
+    return ExtendedPointOps::Add(*this, ExtendedPointOps::ToCached(other), false);
+}
+
+ExtendedPoint ExtendedPoint::operator-(const ExtendedPoint& other) const {
+    return ExtendedPointOps::Add(*this, ExtendedPointOps::ToCached(other), true);
+}
+
+ExtendedPoint ExtendedPoint::operator-() const {
+    ExtendedPoint result = *this;
+    result.m_X = FeNeg(m_X);
+    result.m_T = FeNeg(m_T);
+    return result;
+}
+
+ExtendedPoint& ExtendedPoint::operator+=(const ExtendedPoint& other) {
+    *this = *this + other;
+    return *this;
+}
+
+ExtendedPoint& ExtendedPoint::operator-=(const ExtendedPoint& other) {
+    *this = *this - other;
+    return *this;
+}
+
+ExtendedPoint ExtendedPoint::Double() const {
+    return ExtendedPointOps::Double(*this);
+}
+
+ExtendedPoint ExtendedPoint::operator*(const Scalar& scalar) const {
+    const std::array<Cached, 8> table = ExtendedPointOps::Multiples(*this);
+    const std::array<int8_t, 64> digits = RecodeScalar(scalar);
+
+    ExtendedPoint result = ExtendedPointOps::Add(ExtendedPoint(), ExtendedPointOps::Select(table, digits[63]), false);
+    for (int i = 62; i >= 0; --i) {
+        result = ExtendedPointOps::Double4(result);
+        result = ExtendedPointOps::Add(result, ExtendedPointOps::Select(table, digits[i]), false);
+    }
+    return result;
+}
+
+bool ExtendedPoint::operator==(const ExtendedPoint& other) const {
+    return FeEqual(FeMul(m_X, other.m_Z), FeMul(other.m_X, m_Z)) &&
+           FeEqual(FeMul(m_Y, other.m_Z), FeMul(other.m_Y, m_Z));
+}
+
+bool ExtendedPoint::IsIdentity() const {
+    return FeIsZero(m_X) && FeEqual(m_Y, m_Z);
+}
+
+std::vector<Point> BatchEncode(const std::vector<ExtendedPoint>& points) {
+    std::vector<Point> result(points.size());
+    if (points.empty()) {
+        return result;
+    }
+
+    // prefix[i] = Z_0 * ... * Z_i
+    std::vector<FieldElement> prefix(points.size());
+    prefix[0] = ExtendedPointOps::Z(points[0]);
+    for (size_t i = 1; i < points.size(); ++i) {
+        prefix[i] = FeMul(prefix[i - 1], ExtendedPointOps::Z(points[i]));
+    }
+
+    // Walk back from 1/(Z_0 * ... * Z_n-1), peeling off one Z at a time
+    FieldElement inv = FeInvert(prefix.back());
+    for (size_t i = points.size(); i-- > 0;) {
+        const FieldElement z_inv = i > 0 ? FeMul(inv, prefix[i - 1]) : inv;
+        inv = FeMul(inv, ExtendedPointOps::Z(points[i]));
+        result[i] = ExtendedPointOps::EncodeWithInverse(points[i], z_inv);
+    }
+    return result;
+}
+
+// ============================================================================
+// FixedBaseTable Implementation
+// ============================================================================
+
+FixedBaseTable::FixedBaseTable(const ExtendedPoint& base)
+    : m_table(64) {
+    ExtendedPoint row = base; // 16^i * base
+    for (size_t i = 0; i < m_table.size(); ++i) {
+        m_table[i] = ExtendedPointOps::Multiples(row);
+        row = ExtendedPointOps::Double4(row);
+    }
+}
+
+ExtendedPoint FixedBaseTable::Mul(const Scalar& scalar) const {
+    const std::array<int8_t, 64> digits = RecodeScalar(scalar);
+
+    ExtendedPoint result;
+    for (size_t i = 0; i < m_table.size(); ++i) {
+        result = ExtendedPointOps::Add(result, ExtendedPointOps::Select(m_table[i], digits[i]), false);
+    }
+    return result;
+}
+
+const FixedBaseTable& FixedBaseTable::Base() {
+    static const FixedBaseTable table(ExtendedPoint::BasePoint());
+    return table;
+}
+
+// ============================================================================
+// Multi-Scalar Multiplication
+// ============================================================================
+
+ExtendedPoint MultiScalarMul(const std::vector<Scalar>& scalars, const std::vector<ExtendedPoint>& points) {
+    if (scalars.size() != points.size()) {
+        throw std::runtime_error("MultiScalarMul: mismatched sizes");
+    }
+
+    std::vector<std::array<Cached, 8>> tables;
+    std::vector<std::array<int8_t, 64>> digits;
+    tables.reserve(points.size());
+    digits.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        tables.push_back(ExtendedPointOps::Multiples(points[i]));
+        digits.push_back(RecodeScalar(scalars[i]));
+    }
+
+    ExtendedPoint result;
+    for (int i = 63; i >= 0; --i) {
+        if (i != 63) {
+            result = ExtendedPointOps::Double4(result);
+        }
+        for (size_t k = 0; k < tables.size(); ++k) {
+            result = ExtendedPointOps::Add(result, ExtendedPointOps::Select(tables[k], digits[k][i]), false);
+        }
+    }
+    return result;
+}
+
+} // namespace ed25519
@@ -0,0 +1,117 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_PRIVACY_ED25519_EXTENDED_POINT_H
+#define WATTX_PRIVACY_ED25519_EXTENDED_POINT_H
+
+#include <privacy/ed25519/ed25519_types.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ed25519 {
+
+/**
+ * Element of GF(2^255 - 19) in five 51-bit limbs
+ */
+struct FieldElement {
+    std::array<uint64_t, 5> v;
+};
+
+/**
+ * Ed25519 point in extended coordinates (X:Y:Z:T)
+ *
+ * x = X/Z, y = Y/Z and x*y = T/Z. Point keeps the 32-byte encoding, so every
+ * libsodium operation on it decodes its inputs (a square root) and encodes
+ * its result (an inversion). ExtendedPoint stays decoded across a chain of
+ * additions and multiplications; it is encoded once at the end, and
+ * BatchEncode() shares a single inversion between many points.
+ *
+ * Scalars are used like libsodium's *_noclamp functions: the top bit is
+ * ignored and the scalar is not otherwise reduced. Decoding does not check
+ * that a point is in the prime-order subgroup; Point::IsValid() does.
+ */
+class ExtendedPoint {
+public:
+    // Identity point
+    ExtendedPoint();
+
+    // Decode a point. Fails on non-canonical encodings and points not on the curve.
+    static bool Decode(const Point& p, ExtendedPoint& out);
+
+    // Decode a point, throwing std::runtime_error if it does not decode
+    static ExtendedPoint FromPoint(const Point& p);
+
+    // Base point (generator G)
+    static ExtendedPoint BasePoint();
+
+    // Canonical 32-byte encoding
+    Point Encode() const;
+
+    ExtendedPoint operator+(const ExtendedPoint& other) const;
+    ExtendedPoint operator-(const ExtendedPoint& other) const;
+    ExtendedPoint operator-() const;
+
+    ExtendedPoint& operator+=(const ExtendedPoint& other);
+    ExtendedPoint& operator-=(const ExtendedPoint& other);
+
+    ExtendedPoint Double() const;
+
+    // Constant-time scalar multiplication (4-bit signed window)
+    ExtendedPoint operator*(const Scalar& scalar) const;
+
+    bool operator==(const ExtendedPoint& other) const;
+    bool operator!=(const ExtendedPoint& other) const { return !(*this == other); }
+
+    bool IsIdentity() const;
+
+private:
+    friend struct ExtendedPointOps;
+
+    FieldElement m_X, m_Y, m_Z, m_T;
+};
+
+/**
+ * Encode many points with one field inversion (Montgomery's trick)
+ */
+std::vector<Point> BatchEncode(const std::vector<ExtendedPoint>& points);
+
+/**
+ * Precomputed multiples of a fixed point
+ *
+ * Holds j * 16^i * P for j = 1..8 and each of the 64 radix-16 digits of a
+ * scalar, so a multiplication is 64 constant-time table lookups and
+ * additions with no doublings. A table takes 80 KiB.
+ */
+class FixedBaseTable {
+public:
+    explicit FixedBaseTable(const ExtendedPoint& base);
+
+    // scalar * base, in constant time
+    ExtendedPoint Mul(const Scalar& scalar) const;
+
+    // Table for the Ed25519 base point, built on first use
+    static const FixedBaseTable& Base();
+
+    // Cached form of a point for mixed additions
+    struct Cached {
+        FieldElement YplusX, YminusX, Z, T2d;
+    };
+
+private:
+    std::vector<std::array<Cached, 8>> m_table;
+};
+
+/**
+ * Multi-scalar multiplication over decoded points
+ * Computes: sum(scalars[i] * points[i])
+ * The doublings are shared between all terms (Straus), and the lookups are
+ * constant time so secret scalars such as blinding factors can be used.
+ */
+ExtendedPoint MultiScalarMul(const std::vector<Scalar>& scalars, const std::vector<ExtendedPoint>& points);
+
+} // namespace ed25519
+
+#endif // WATTX_PRIVACY_ED25519_EXTENDED_POINT_H
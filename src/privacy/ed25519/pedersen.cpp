@@ -25,6 +25,8 @@ PedersenGenerators::PedersenGenerators()
     h_seed.insert(h_seed.end(), m_seed.begin(), m_seed.end());
     h_seed.push_back('H');
     m_H = Point::HashToPoint(h_seed);
+    m_H_ext = ExtendedPoint::FromPoint(m_H);
+    m_H_table = std::make_shared<const FixedBaseTable>(m_H_ext);
 
     // Pre-generate some vector generators
     DeriveGenerators(64);
@@ -38,6 +40,8 @@ PedersenGenerators::PedersenGenerators(const std::string& seed)
     h_seed.insert(h_seed.end(), m_seed.begin(), m_seed.end());
     h_seed.push_back('H');
     m_H = Point::HashToPoint(h_seed);
+    m_H_ext = ExtendedPoint::FromPoint(m_H);
+    m_H_table = std::make_shared<const FixedBaseTable>(m_H_ext);
 
     DeriveGenerators(64);
 }
@@ -57,6 +61,7 @@ void PedersenGenerators::DeriveGenerators(size_t n) {
         }
 
         m_G_bold.push_back(Point::HashToPoint(gi_seed));
+        m_G_bold_ext.push_back(ExtendedPoint::FromPoint(m_G_bold.back()));
     }
 }
 
@@ -67,6 +72,13 @@ const Point& PedersenGenerators::G_bold(size_t i) const {
     return m_G_bold[i];
 }
 
+const ExtendedPoint& PedersenGenerators::ExtendedG_bold(size_t i) const {
+    if (i >= m_G_bold_ext.size()) {
+        throw std::out_of_range("Generator index out of range");
+    }
+    return m_G_bold_ext[i];
+}
+
 void PedersenGenerators::EnsureGenerators(size_t n) {
     if (m_G_bold.size() < n) {
         DeriveGenerators(n);
@@ -95,11 +107,11 @@ PedersenCommitment PedersenCommitment::Commit(const Scalar& value) {
 PedersenCommitment PedersenCommitment::Commit(const Scalar& value, const Scalar& blinding) {
     PedersenGenerators& gens = PedersenGenerators::Default();
 
-    // C = v*G + r*H
-    Point vG = gens.G() * value;
-    Point rH = gens.H() * blinding;
+    // C = v*G + r*H, from the precomputed tables
+    ExtendedPoint vG = FixedBaseTable::Base().Mul(value);
+    ExtendedPoint rH = gens.HTable().Mul(blinding);
 
-    return PedersenCommitment(vG + rH);
+    return PedersenCommitment((vG + rH).Encode());
 }
 
 PedersenCommitment PedersenCommitment::CommitAmount(uint64_t amount) {
@@ -147,7 +159,7 @@ PedersenVectorCommitment PedersenVectorCommitment::Commit(const std::vector<Scal
 PedersenVectorCommitment PedersenVectorCommitment::Commit(const std::vector<Scalar>& values, const Scalar& blinding) {
     if (values.empty()) {
         // Just the blinding: r*H
-        return PedersenVectorCommitment(PedersenGenerators::Default().H() * blinding);
+        return PedersenVectorCommitment(PedersenGenerators::Default().HTable().Mul(blinding).Encode());
     }
 
     PedersenGenerators& gens = PedersenGenerators::Default();
@@ -155,18 +167,18 @@ PedersenVectorCommitment PedersenVectorCommitment::Commit(const std::vector<Scal
 
     // C = v1*G1 + v2*G2 + ... + vn*Gn + r*H
     std::vector<Scalar> scalars;
-    std::vector<Point> points;
+    std::vector<ExtendedPoint> points;
 
     for (size_t i = 0; i < values.size(); ++i) {
         scalars.push_back(values[i]);
-        points.push_back(gens.G_bold(i));
+        points.push_back(gens.ExtendedG_bold(i));
     }
 
     // Add blinding term
     scalars.push_back(blinding);
-    points.push_back(gens.H());
+    points.push_back(gens.ExtendedH());
 
-    return PedersenVectorCommitment(MultiScalarMul(scalars, points));
+    return PedersenVectorCommitment(MultiScalarMul(scalars, points).Encode());
 }
 
 PedersenVectorCommitment PedersenVectorCommitment::operator+(const PedersenVectorCommitment& other) const {
@@ -191,8 +203,8 @@ bool PedersenOpening::Verify(const PedersenCommitment& commitment) const {
 
 bool PedersenOpening::Verify(const PedersenCommitment& commitment, const PedersenGenerators& gens) const {
     // Check: C == v*G + r*H
-    Point expected = gens.G() * value + gens.H() * blinding;
-    return expected == commitment.GetPoint();
+    ExtendedPoint expected = FixedBaseTable::Base().Mul(value) + gens.HTable().Mul(blinding);
+    return expected.Encode() == commitment.GetPoint();
 }
 
 bool PedersenVectorOpening::Verify(const PedersenVectorCommitment& commitment) const {
@@ -201,23 +213,23 @@ bool PedersenVectorOpening::Verify(const PedersenVectorCommitment& commitment) c
 
 bool PedersenVectorOpening::Verify(const PedersenVectorCommitment& commitment, const PedersenGenerators& gens) const {
     if (values.empty()) {
-        Point expected = gens.H() * blinding;
+        Point expected = gens.HTable().Mul(blinding).Encode();
         return expected == commitment.GetPoint();
     }
 
     const_cast<PedersenGenerators&>(gens).EnsureGenerators(values.size());
 
     std::vector<Scalar> scalars;
-    std::vector<Point> points;
+    std::vector<ExtendedPoint> points;
 
     for (size_t i = 0; i < values.size(); ++i) {
         scalars.push_back(values[i]);
-        points.push_back(gens.G_bold(i));
+        points.push_back(gens.ExtendedG_bold(i));
     }
     scalars.push_back(blinding);
-    points.push_back(gens.H());
+    points.push_back(gens.ExtendedH());
 
-    Point expected = MultiScalarMul(scalars, points);
+    Point expected = MultiScalarMul(scalars, points).Encode();
     return expected == commitment.GetPoint();
 }
 
@@ -232,6 +244,7 @@ PedersenHash::PedersenHash()
     std::string seed = "WATTx_FCMP_CurveTree_Init_v1";
     init_seed.insert(init_seed.end(), seed.begin(), seed.end());
     m_init = Point::HashToPoint(init_seed);
+    m_init_ext = ExtendedPoint::FromPoint(m_init);
 }
 
 PedersenHash::PedersenHash(const std::string& seed)
@@ -240,6 +253,11 @@ PedersenHash::PedersenHash(const std::string& seed)
     init_seed.insert(init_seed.end(), seed.begin(), seed.end());
     init_seed.push_back('I'); // Init marker
     m_init = Point::HashToPoint(init_seed);
+    m_init_ext = ExtendedPoint::FromPoint(m_init);
+}
+
+void PedersenHash::EnsureGenerators(size_t n) const {
+    const_cast<PedersenGenerators&>(m_generators).EnsureGenerators(n);
 }
 
 Point PedersenHash::Hash(const std::vector<Scalar>& inputs) const {
@@ -251,13 +269,13 @@ Point PedersenHash::Hash(const std::vector<Scalar>& inputs) const {
 
     // H(inputs) = H_init + sum(input[i] * G[i])
     std::vector<Scalar> scalars = inputs;
-    std::vector<Point> points;
+    std::vector<ExtendedPoint> points;
 
     for (size_t i = 0; i < inputs.size(); ++i) {
-        points.push_back(m_generators.G_bold(i));
+        points.push_back(m_generators.ExtendedG_bold(i));
     }
 
-    return m_init + MultiScalarMul(scalars, points);
+    return (m_init_ext + MultiScalarMul(scalars, points)).Encode();
 }
 
 Point PedersenHash::HashGrow(const Point& existing, size_t offset,
@@ -271,19 +289,19 @@ Point PedersenHash::HashGrow(const Point& existing, size_t offset,
 
     // Add: (new[0] - existing_at_offset)*G[offset] + new[1]*G[offset+1] + ...
     std::vector<Scalar> scalars;
-    std::vector<Point> points;
+    std::vector<ExtendedPoint> points;
 
     // First element replaces existing at offset
     scalars.push_back(new_elements[0] - existing_at_offset);
-    points.push_back(m_generators.G_bold(offset));
+    points.push_back(m_generators.ExtendedG_bold(offset));
 
     // Remaining elements are additions
     for (size_t i = 1; i < new_elements.size(); ++i) {
         scalars.push_back(new_elements[i]);
-        points.push_back(m_generators.G_bold(offset + i));
+        points.push_back(m_generators.ExtendedG_bold(offset + i));
     }
 
-    return existing + MultiScalarMul(scalars, points);
+    return (ExtendedPoint::FromPoint(existing) + MultiScalarMul(scalars, points)).Encode();
 }
 
 Point PedersenHash::HashTrim(const Point& existing, size_t offset,
@@ -297,19 +315,19 @@ Point PedersenHash::HashTrim(const Point& existing, size_t offset,
 
     // Remove: -(elem[0] - grow_back)*G[offset] - elem[1]*G[offset+1] - ...
     std::vector<Scalar> scalars;
-    std::vector<Point> points;
+    std::vector<ExtendedPoint> points;
 
     // First element: subtract difference from grow_back
     scalars.push_back(elements_to_remove[0] - element_to_grow_back);
-    points.push_back(m_generators.G_bold(offset));
+    points.push_back(m_generators.ExtendedG_bold(offset));
 
     // Remaining elements are subtractions
     for (size_t i = 1; i < elements_to_remove.size(); ++i) {
         scalars.push_back(elements_to_remove[i]);
-        points.push_back(m_generators.G_bold(offset + i));
+        points.push_back(m_generators.ExtendedG_bold(offset + i));
     }
 
-    return existing - MultiScalarMul(scalars, points);
+    return (ExtendedPoint::FromPoint(existing) - MultiScalarMul(scalars, points)).Encode();
 }
 
 } // namespace ed25519
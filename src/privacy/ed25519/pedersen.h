@@ -6,6 +6,7 @@
 #define WATTX_PRIVACY_ED25519_PEDERSEN_H
 
 #include <privacy/ed25519/ed25519_types.h>
+#include <privacy/ed25519/extended_point.h>
 
 #include <vector>
 #include <memory>
@@ -121,6 +122,12 @@ public:
     // Get the i-th vector generator
     const Point& G_bold(size_t i) const;
 
+    // Decoded generators and the precomputed table for H, used for the
+    // commitment arithmetic so it is encoded once per result
+    const ExtendedPoint& ExtendedH() const { return m_H_ext; }
+    const FixedBaseTable& HTable() const { return *m_H_table; }
+    const ExtendedPoint& ExtendedG_bold(size_t i) const;
+
     // Ensure at least n vector generators are available
     void EnsureGenerators(size_t n);
 
@@ -136,6 +143,9 @@ private:
     Point m_G;  // Value generator (base point)
     Point m_H;  // Blinding generator
     std::vector<Point> m_G_bold;  // Vector generators
+    ExtendedPoint m_H_ext;
+    std::shared_ptr<const FixedBaseTable> m_H_table;  // Shared between copies
+    std::vector<ExtendedPoint> m_G_bold_ext;
     std::string m_seed;
 };
 
@@ -207,6 +217,10 @@ public:
                    const std::vector<Scalar>& elements_to_remove,
                    const Scalar& element_to_grow_back) const;
 
+    // Derive the generators for inputs of up to n elements. Hash() only
+    // reads them afterwards, so it can be called from several threads.
+    void EnsureGenerators(size_t n) const;
+
     // Get the initialization point
     const Point& GetInit() const { return m_init; }
 
@@ -215,6 +229,7 @@ public:
 
 private:
     Point m_init;  // Initialization point (prevents zero-input → identity)
+    ExtendedPoint m_init_ext;
     PedersenGenerators m_generators;
 };
 
@@ -18,11 +18,15 @@ std::vector<uint8_t> FcmpProver::GenerateProof(
     if (!branch_opt) {
         throw FcmpError(FCMP_ERROR_INVALID_PARAM, "Failed to get branch for leaf index");
     }
-    const curvetree::TreeBranch& branch = *branch_opt;
 
-    // Get tree root
-    ed25519::Point root = m_tree->GetRoot();
+    return GenerateProof(output, *branch_opt, m_tree->GetRoot());
+}
 
+std::vector<uint8_t> FcmpProver::GenerateProof(
+    const curvetree::OutputTuple& output,
+    const curvetree::TreeBranch& branch,
+    const ed25519::Point& root
+) {
     // Prepare output tuple (O || I || C = 96 bytes)
     std::vector<uint8_t> output_bytes(FCMP_OUTPUT_TUPLE_SIZE);
     std::memcpy(output_bytes.data(), output.O.data.data(), FCMP_POINT_SIZE);
@@ -53,12 +57,12 @@ std::vector<uint8_t> FcmpProver::GenerateProof(
 
     // Build FcmpBranch
     FcmpBranch fcmp_branch;
-    fcmp_branch.leaf_index = leaf_index;
+    fcmp_branch.leaf_index = branch.leaf_index;
     fcmp_branch.num_layers = static_cast<uint32_t>(layers.size());
     fcmp_branch.layers = layers.data();
 
     // Allocate proof buffer
-    size_t max_proof_size = EstimateProofSize(1);
+    size_t max_proof_size = fcmp_proof_size(1, static_cast<uint32_t>(branch.Depth()));
     std::vector<uint8_t> proof(max_proof_size);
     size_t actual_size = 0;
 
@@ -91,5 +95,19 @@ bool FcmpVerifier::Verify(const FcmpInput& input, const std::vector<uint8_t>& pr
     return result == FCMP_SUCCESS;
 }
 
+bool FcmpVerifier::VerifyBatch(const std::vector<FcmpInput>& inputs,
+                               const std::vector<const std::vector<uint8_t>*>& proofs) const {
+    if (inputs.size() != proofs.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!Verify(inputs[i], *proofs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace fcmp
 } // namespace privacy
@@ -91,6 +91,22 @@ public:
         uint64_t leaf_index
     );
 
+    /**
+     * Generate a proof from a branch the caller already holds, without
+     * reading the tree
+     *
+     * @param output The output tuple (O, I, C)
+     * @param branch Branch of the output in the tree with the given root
+     * @param root Tree root the proof is against
+     * @return Serialized proof bytes
+     * @throws FcmpError on failure
+     */
+    static std::vector<uint8_t> GenerateProof(
+        const curvetree::OutputTuple& output,
+        const curvetree::TreeBranch& branch,
+        const ed25519::Point& root
+    );
+
     /**
      * Estimate the proof size for verification buffer allocation
      */
@@ -123,6 +139,20 @@ public:
      */
     bool Verify(const FcmpInput& input, const std::vector<uint8_t>& proof) const;
 
+    /**
+     * Verify several FCMP proofs against the same tree root
+     *
+     * This is the entry point batch verification goes through. The library
+     * does not export a batched verifier yet, so the proofs are checked one
+     * by one until it does.
+     *
+     * @param inputs The input tuples, one per proof
+     * @param proofs The proof bytes
+     * @return true if every proof is valid
+     */
+    bool VerifyBatch(const std::vector<FcmpInput>& inputs,
+                     const std::vector<const std::vector<uint8_t>*>& proofs) const;
+
     /**
      * Update the tree root (e.g., after new blocks)
      */
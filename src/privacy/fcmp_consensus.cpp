@@ -5,6 +5,7 @@
 #include <privacy/fcmp_consensus.h>
 #include <privacy/fcmp_tx.h>
 #include <privacy/ed25519/pedersen.h>
+#include <privacy/curvetree/tree_db.h>
 #include <chain.h>
 #include <logging.h>
 #include <hash.h>
@@ -12,8 +13,13 @@
 #include <common/system.h>
 #include <util/fs.h>
 #include <util/time.h>
+#include <util/trace.h>
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
+
+TRACEPOINT_SEMAPHORE(privacy, curve_tree_outputs_added);
 
 namespace privacy {
 
@@ -25,57 +31,31 @@ namespace privacy {
 static constexpr uint8_t DB_KEY_IMAGE = 'K';
 static constexpr uint8_t DB_SPENT_COUNT = 'S';
 
-// Serializable structure for key image spend info
-struct KeyImageSpendInfo {
-    uint256 txHash;
-    int32_t blockHeight;
-
-    SERIALIZE_METHODS(KeyImageSpendInfo, obj) {
-        READWRITE(obj.txHash, obj.blockHeight);
-    }
-};
-
 CFcmpKeyImageDB::CFcmpKeyImageDB(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe)
+    : CKeyImageSpendDB(path, nCacheSize, fMemory, fWipe, DB_KEY_IMAGE)
 {
-    m_db = std::make_unique<CDBWrapper>(DBParams{
-        .path = path,
-        .cache_bytes = nCacheSize,
-        .memory_only = fMemory,
-        .wipe_data = fWipe
-    });
 }
 
 bool CFcmpKeyImageDB::IsSpent(const CKeyImage& keyImage) const
 {
-    LOCK(cs_keyimage);
-    uint256 hash = keyImage.GetHash();
-    return m_db->Exists(std::make_pair(DB_KEY_IMAGE, hash));
+    return CKeyImageSpendDB::IsSpent(keyImage.GetHash());
 }
 
 bool CFcmpKeyImageDB::MarkSpent(const CKeyImage& keyImage, const uint256& txHash, int blockHeight)
 {
-    LOCK(cs_keyimage);
-    uint256 hash = keyImage.GetHash();
-
     // Store: keyImage hash -> (txHash, blockHeight)
-    KeyImageSpendInfo info{txHash, blockHeight};
-    return m_db->Write(std::make_pair(DB_KEY_IMAGE, hash), info);
+    return WriteSpends({{keyImage.GetHash(), CKeyImageEntry{txHash, blockHeight}}});
 }
 
 bool CFcmpKeyImageDB::Unmark(const CKeyImage& keyImage)
 {
-    LOCK(cs_keyimage);
-    uint256 hash = keyImage.GetHash();
-    return m_db->Erase(std::make_pair(DB_KEY_IMAGE, hash));
+    return EraseSpends({keyImage.GetHash()});
 }
 
 bool CFcmpKeyImageDB::GetSpendingInfo(const CKeyImage& keyImage, uint256& txHash, int& blockHeight) const
 {
-    LOCK(cs_keyimage);
-    uint256 hash = keyImage.GetHash();
-
-    KeyImageSpendInfo info;
-    if (!m_db->Read(std::make_pair(DB_KEY_IMAGE, hash), info)) {
+    CKeyImageEntry info;
+    if (!ReadSpend(keyImage.GetHash(), info)) {
         return false;
     }
 
@@ -86,35 +66,22 @@ bool CFcmpKeyImageDB::GetSpendingInfo(const CKeyImage& keyImage, uint256& txHash
 
 bool CFcmpKeyImageDB::WriteBatch(const std::vector<std::pair<CKeyImage, std::pair<uint256, int>>>& spends)
 {
-    LOCK(cs_keyimage);
-    CDBBatch batch(*m_db);
-
+    std::vector<std::pair<uint256, CKeyImageEntry>> entries;
+    entries.reserve(spends.size());
     for (const auto& [keyImage, spendInfo] : spends) {
-        uint256 hash = keyImage.GetHash();
-        KeyImageSpendInfo info{spendInfo.first, spendInfo.second};
-        batch.Write(std::make_pair(DB_KEY_IMAGE, hash), info);
+        entries.emplace_back(keyImage.GetHash(), CKeyImageEntry{spendInfo.first, spendInfo.second});
     }
-
-    return m_db->WriteBatch(batch);
+    return WriteSpends(entries);
 }
 
 bool CFcmpKeyImageDB::EraseBatch(const std::vector<CKeyImage>& keyImages)
 {
-    LOCK(cs_keyimage);
-    CDBBatch batch(*m_db);
-
+    std::vector<uint256> hashes;
+    hashes.reserve(keyImages.size());
     for (const auto& keyImage : keyImages) {
-        uint256 hash = keyImage.GetHash();
-        batch.Erase(std::make_pair(DB_KEY_IMAGE, hash));
+        hashes.push_back(keyImage.GetHash());
     }
-
-    return m_db->WriteBatch(batch);
-}
-
-bool CFcmpKeyImageDB::Sync()
-{
-    // CDBWrapper syncs automatically on batch writes
-    return true;
+    return EraseSpends(hashes);
 }
 
 // ============================================================================
@@ -141,9 +108,10 @@ bool CFcmpConsensusState::Initialize(const fs::path& datadir, size_t cacheSize)
         fs::create_directories(keyImagePath);
         m_keyImageDB = std::make_unique<CFcmpKeyImageDB>(keyImagePath, cacheSize / 2);
 
-        // Initialize curve tree with memory storage
-        // TODO: Add persistent LevelDB storage for production
-        m_treeStorage = std::make_shared<curvetree::MemoryTreeStorage>();
+        // Initialize curve tree on disk, behind a cache that buffers writes
+        // until the chainstate is flushed
+        m_treeCache = curvetree::TreeStorageFactory::CreateDefault(datadir / "fcmp", cacheSize / 2);
+        m_treeStorage = m_treeCache;
         m_curveTree = std::make_shared<curvetree::CurveTree>(m_treeStorage);
 
         m_initialized = true;
@@ -165,12 +133,16 @@ void CFcmpConsensusState::Shutdown()
     if (!m_initialized) return;
 
     // Sync databases
+    if (m_treeCache && !Flush()) {
+        LogPrintf("FCMP: Failed to flush curve tree on shutdown\n");
+    }
     if (m_keyImageDB) {
         m_keyImageDB->Sync();
     }
 
     // Clear state
     m_curveTree.reset();
+    m_treeCache.reset();
     m_treeStorage.reset();
     m_keyImageDB.reset();
     m_initialized = false;
@@ -178,6 +150,19 @@ void CFcmpConsensusState::Shutdown()
     LogPrintf("FCMP: Consensus state shutdown complete\n");
 }
 
+bool CFcmpConsensusState::Flush()
+{
+    LOCK(cs_fcmp);
+
+    if (!m_initialized || !m_treeCache) {
+        return true;
+    }
+
+    // Output count and depth are read back by CurveTree::Load()
+    m_curveTree->Save();
+    return m_treeCache->Flush();
+}
+
 std::shared_ptr<curvetree::CurveTree> CFcmpConsensusState::GetCurveTree() const
 {
     LOCK(cs_fcmp);
@@ -238,10 +223,17 @@ bool CFcmpConsensusState::ConnectBlock(const CBlock& block, const CBlockIndex* p
         }
     }
 
-    // Add outputs to curve tree
-    if (!outputsToAdd.empty()) {
-        m_curveTree->AddOutputs(outputsToAdd);
-    }
+    // Add outputs to curve tree, keeping what is needed to take them back
+    curvetree::TreeUndo undo;
+    const bool traced{TRACEPOINT_ACTIVE(privacy, curve_tree_outputs_added)};
+    const auto add_start{traced ? SteadyClock::now() : SteadyClock::time_point{}};
+    m_curveTree->AddOutputs(outputsToAdd, &undo);
+    TRACEPOINT(privacy, curve_tree_outputs_added,
+        height,
+        static_cast<uint64_t>(outputsToAdd.size()),
+        m_curveTree->GetOutputCount(),
+        Ticks<std::chrono::microseconds>(SteadyClock::now() - add_start)
+    );
 
     // Mark key images as spent
     if (!keyImagesToMark.empty()) {
@@ -253,7 +245,8 @@ bool CFcmpConsensusState::ConnectBlock(const CBlock& block, const CBlockIndex* p
     }
 
     // Track for reorg handling
-    m_outputsAddedPerBlock[height] = outputsAdded;
+    m_treeUndo[height] = std::move(undo);
+    m_treeUndo.erase(m_treeUndo.begin(), m_treeUndo.lower_bound(height - TREE_UNDO_BLOCKS));
     m_lastBlockHeight = height;
 
     if (outputsAdded > 0 || !keyImagesToMark.empty()) {
@@ -276,8 +269,10 @@ bool CFcmpConsensusState::DisconnectBlock(const CBlock& block, const CBlockIndex
 
     // Collect key images to unmark
     std::vector<CKeyImage> keyImagesToUnmark;
+    uint64_t outputsAdded = 0;
 
     for (const auto& tx : block.vtx) {
+        outputsAdded += ExtractFcmpOutputs(*tx).size();
         auto keyImages = ExtractKeyImages(*tx);
         for (const auto& ki : keyImages) {
             keyImagesToUnmark.push_back(ki);
@@ -293,15 +288,29 @@ bool CFcmpConsensusState::DisconnectBlock(const CBlock& block, const CBlockIndex
         m_keyImagesSpent -= keyImagesToUnmark.size();
     }
 
-    // Remove outputs from curve tree
-    auto it = m_outputsAddedPerBlock.find(height);
-    if (it != m_outputsAddedPerBlock.end() && it->second > 0) {
-        // Note: CurveTree needs a RemoveLastN method for proper reorg support
-        // For now, we'll need to rebuild from the last checkpoint
-        // This is a simplification - production would need proper reorg handling
-        LogPrintf("FCMP: Block %d disconnected. Would remove %lu outputs (reorg handling TBD)\n",
-                  height, it->second);
-        m_outputsAddedPerBlock.erase(it);
+    // Remove the block's outputs from the curve tree
+    const uint64_t treeSize = m_curveTree->GetOutputCount();
+    if (outputsAdded > treeSize) {
+        LogPrintf("FCMP: Block %d added %lu outputs but the tree only holds %lu\n", height, outputsAdded, treeSize);
+        return false;
+    }
+    auto it = m_treeUndo.find(height);
+    bool rewound;
+    if (it != m_treeUndo.end() && it->second.output_count == treeSize - outputsAdded) {
+        rewound = m_curveTree->Rewind(it->second);
+    } else {
+        rewound = m_curveTree->TruncateTo(treeSize - outputsAdded);
+    }
+    if (it != m_treeUndo.end()) {
+        m_treeUndo.erase(it);
+    }
+    if (!rewound) {
+        LogPrintf("FCMP: Failed to remove %lu outputs of block %d from the curve tree\n", outputsAdded, height);
+        return false;
+    }
+    if (outputsAdded > 0) {
+        LogPrintf("FCMP: Block %d disconnected. Removed %lu outputs. Tree size: %lu\n",
+                  height, outputsAdded, m_curveTree->GetOutputCount());
     }
 
     if (height <= m_lastBlockHeight) {
@@ -368,7 +377,8 @@ bool CFcmpConsensusState::CheckFcmpTransaction(const CTransaction& tx, TxValidat
 }
 
 bool CFcmpConsensusState::CheckFcmpInputs(const CTransaction& tx, TxValidationState& state,
-                                          const CCoinsViewCache& view, int nSpendHeight) const
+                                          const CCoinsViewCache& view, int nSpendHeight,
+                                          bool verifyProofs) const
 {
     LOCK(cs_fcmp);
 
@@ -391,12 +401,8 @@ bool CFcmpConsensusState::CheckFcmpInputs(const CTransaction& tx, TxValidationSt
     // Get current tree root for verification
     ed25519::Point treeRoot = m_curveTree->GetRoot();
 
-    // Compute message hash for signature verification
-    HashWriter hasher{};
-    hasher << tx.GetHash();
-    uint256 messageHash = hasher.GetHash();
-
-    // Verify each FCMP input
+    // Check each FCMP input against the chain state
+    std::vector<const CFcmpInput*> inputs;
     for (const auto& input : privTx.fcmpInputs) {
         // 1. Check key image not already spent
         if (IsKeyImageSpent(input.keyImage)) {
@@ -412,12 +418,14 @@ bool CFcmpConsensusState::CheckFcmpInputs(const CTransaction& tx, TxValidationSt
                                  "FCMP proof uses stale tree root");
         }
 
-        // 3. Verify the full FCMP input (proof + signature)
-        if (!VerifyFcmpInput(input, treeRoot, messageHash)) {
-            return state.Invalid(TxValidationResult::TX_CONSENSUS,
-                                 "fcmp-verification-failed",
-                                 "FCMP input verification failed");
-        }
+        inputs.push_back(&input);
+    }
+
+    // 3. Verify the proofs and signatures of all inputs as one batch
+    if (verifyProofs && !BatchVerifyFcmpInputs(inputs, treeRoot)) {
+        return state.Invalid(TxValidationResult::TX_CONSENSUS,
+                             "fcmp-verification-failed",
+                             "FCMP input verification failed");
     }
 
     // 4. Verify balance (sum of pseudo-outputs = sum of outputs + fee)
@@ -435,6 +443,70 @@ bool CFcmpConsensusState::CheckFcmpInputs(const CTransaction& tx, TxValidationSt
     return true;
 }
 
+bool CFcmpConsensusState::IsEmpty() const
+{
+    LOCK(cs_fcmp);
+    if (!m_initialized) return true;
+    return m_curveTree->IsEmpty() && m_keyImageDB->IsEmpty();
+}
+
+bool CFcmpConsensusState::GetSnapshotState(std::vector<curvetree::OutputTuple>& outputs, ed25519::Point& root,
+                                           CDBWrapper::Records& keyImages) const
+{
+    LOCK(cs_fcmp);
+
+    outputs.clear();
+    keyImages.clear();
+    if (!m_initialized) {
+        root = ed25519::Point::Identity();
+        return true;
+    }
+
+    const uint64_t count = m_curveTree->GetOutputCount();
+    outputs.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        auto output = m_curveTree->GetOutput(i);
+        if (!output) {
+            LogPrintf("FCMP: Missing curve tree output %lu\n", i);
+            return false;
+        }
+        outputs.push_back(std::move(*output));
+    }
+    root = m_curveTree->GetRoot();
+    keyImages = m_keyImageDB->GetDBRecords();
+    return true;
+}
+
+bool CFcmpConsensusState::LoadSnapshotState(const std::vector<curvetree::OutputTuple>& outputs, const ed25519::Point& root,
+                                            const CDBWrapper::Records& keyImages, int height)
+{
+    LOCK(cs_fcmp);
+
+    if (!m_initialized || !IsEmpty()) {
+        return false;
+    }
+
+    // The tree is rebuilt in batches, each rehashes the right edge once
+    static constexpr size_t LOAD_BATCH_SIZE{10000};
+    for (size_t i = 0; i < outputs.size(); i += LOAD_BATCH_SIZE) {
+        const auto end = outputs.begin() + std::min(outputs.size(), i + LOAD_BATCH_SIZE);
+        m_curveTree->AddOutputs(std::vector<curvetree::OutputTuple>(outputs.begin() + i, end));
+    }
+    if (!(m_curveTree->GetRoot() == root) || !m_keyImageDB->LoadDBRecords(keyImages)) {
+        LogPrintf("FCMP: Snapshot outputs do not rebuild to its curve tree root, or its key images could not be written\n");
+        m_curveTree->TruncateTo(0);
+        m_keyImageDB->LoadDBRecords({});
+        return false;
+    }
+
+    m_treeUndo.clear();
+    m_keyImagesSpent = keyImages.size();
+    m_lastBlockHeight = height;
+    LogPrintf("FCMP: Loaded snapshot state at height %d. Tree size: %lu, key images spent: %lu\n",
+              height, m_curveTree->GetOutputCount(), m_keyImagesSpent);
+    return Flush();
+}
+
 CFcmpConsensusState::Stats CFcmpConsensusState::GetStats() const
 {
     LOCK(cs_fcmp);
@@ -454,30 +526,12 @@ std::vector<curvetree::OutputTuple> CFcmpConsensusState::ExtractFcmpOutputs(cons
 {
     std::vector<curvetree::OutputTuple> outputs;
 
-    // Check transaction for FCMP output data
-    // FCMP outputs are encoded in OP_RETURN outputs or special script types
-    for (size_t i = 0; i < tx.vout.size(); i++) {
-        const CTxOut& out = tx.vout[i];
-
-        // Look for FCMP output marker in script
-        // Format: OP_RETURN <FCMP_MARKER> <O> <I> <C>
-        if (out.scriptPubKey.size() >= 98 && out.scriptPubKey[0] == OP_RETURN) {
-            // Check for FCMP marker "FCMP" (0x46434D50)
-            if (out.scriptPubKey.size() >= 102 &&
-                out.scriptPubKey[2] == 0x46 && out.scriptPubKey[3] == 0x43 &&
-                out.scriptPubKey[4] == 0x4D && out.scriptPubKey[5] == 0x50) {
-
-                curvetree::OutputTuple tuple;
-                // Extract O, I, C points (32 bytes each)
-                const uint8_t* data = out.scriptPubKey.data() + 6;
-                std::memcpy(tuple.O.data.data(), data, 32);
-                std::memcpy(tuple.I.data.data(), data + 32, 32);
-                std::memcpy(tuple.C.data.data(), data + 64, 32);
-
-                // Validate points
-                if (tuple.O.IsValid() && tuple.I.IsValid() && tuple.C.IsValid()) {
-                    outputs.push_back(tuple);
-                }
+    // FCMP outputs are encoded in shield OP_RETURN outputs
+    for (const CTxOut& out : tx.vout) {
+        for (const auto& tuple : ParseFcmpShieldScript(out.scriptPubKey)) {
+            // Validate points
+            if (tuple.O.IsValid() && tuple.I.IsValid() && tuple.C.IsValid()) {
+                outputs.push_back(tuple);
             }
         }
     }
@@ -515,10 +569,10 @@ CFcmpConsensusState& GetFcmpState()
     return *g_fcmpState;
 }
 
-bool InitializeFcmpConsensus(const fs::path& datadir)
+bool InitializeFcmpConsensus(const fs::path& datadir, size_t cacheSize)
 {
     g_fcmpState = std::make_unique<CFcmpConsensusState>();
-    return g_fcmpState->Initialize(datadir);
+    return g_fcmpState->Initialize(datadir, cacheSize);
 }
 
 void ShutdownFcmpConsensus()
@@ -551,16 +605,61 @@ bool HasFcmpInputs(const CTransaction& tx)
 bool HasFcmpOutputs(const CTransaction& tx)
 {
     for (const auto& out : tx.vout) {
-        if (out.scriptPubKey.size() >= 102 && out.scriptPubKey[0] == OP_RETURN) {
-            if (out.scriptPubKey[2] == 0x46 && out.scriptPubKey[3] == 0x43 &&
-                out.scriptPubKey[4] == 0x4D && out.scriptPubKey[5] == 0x50) {
-                return true;
-            }
+        if (!ParseFcmpShieldScript(out.scriptPubKey).empty()) {
+            return true;
         }
     }
     return false;
 }
 
+static constexpr uint8_t FCMP_SHIELD_MARKER[4]{0x46, 0x43, 0x4D, 0x50}; // "FCMP"
+static constexpr size_t FCMP_SHIELD_TUPLE_SIZE{96};
+
+CScript BuildFcmpShieldScript(const std::vector<curvetree::OutputTuple>& outputs)
+{
+    std::vector<uint8_t> payload(std::begin(FCMP_SHIELD_MARKER), std::end(FCMP_SHIELD_MARKER));
+    payload.reserve(payload.size() + outputs.size() * FCMP_SHIELD_TUPLE_SIZE);
+    for (const auto& tuple : outputs) {
+        payload.insert(payload.end(), tuple.O.data.begin(), tuple.O.data.end());
+        payload.insert(payload.end(), tuple.I.data.begin(), tuple.I.data.end());
+        payload.insert(payload.end(), tuple.C.data.begin(), tuple.C.data.end());
+    }
+
+    CScript script;
+    script << OP_RETURN << payload;
+    return script;
+}
+
+std::vector<curvetree::OutputTuple> ParseFcmpShieldScript(const CScript& script)
+{
+    std::vector<curvetree::OutputTuple> outputs;
+
+    CScript::const_iterator pc = script.begin();
+    opcodetype opcode;
+    std::vector<uint8_t> payload;
+    if (!script.GetOp(pc, opcode) || opcode != OP_RETURN) return outputs;
+    if (!script.GetOp(pc, opcode, payload) || opcode > OP_PUSHDATA4 || pc != script.end()) return outputs;
+
+    const size_t marker_size{sizeof(FCMP_SHIELD_MARKER)};
+    if (payload.size() < marker_size + FCMP_SHIELD_TUPLE_SIZE ||
+        (payload.size() - marker_size) % FCMP_SHIELD_TUPLE_SIZE != 0 ||
+        !std::equal(payload.begin(), payload.begin() + marker_size, std::begin(FCMP_SHIELD_MARKER))) {
+        return outputs;
+    }
+    const size_t count{(payload.size() - marker_size) / FCMP_SHIELD_TUPLE_SIZE};
+    if (count > MAX_FCMP_SHIELD_OUTPUTS) return outputs;
+
+    outputs.resize(count);
+    const uint8_t* data = payload.data() + marker_size;
+    for (auto& tuple : outputs) {
+        std::memcpy(tuple.O.data.data(), data, 32);
+        std::memcpy(tuple.I.data.data(), data + 32, 32);
+        std::memcpy(tuple.C.data.data(), data + 64, 32);
+        data += FCMP_SHIELD_TUPLE_SIZE;
+    }
+    return outputs;
+}
+
 bool DecodeFcmpTransaction(const CTransaction& tx, CPrivacyTransaction& privTx)
 {
     // Try to decode FCMP data from transaction
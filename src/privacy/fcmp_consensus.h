@@ -24,8 +24,10 @@
 
 #include <primitives/transaction.h>
 #include <primitives/block.h>
+#include <script/script.h>
 #include <privacy/privacy.h>
 #include <privacy/fcmp_tx.h>
+#include <privacy/keyimage_db.h>
 #include <privacy/curvetree/curve_tree.h>
 #include <consensus/validation.h>
 #include <consensus/params.h>
@@ -39,6 +41,10 @@
 class CBlockIndex;
 class CCoinsViewCache;
 
+namespace curvetree {
+class CachedTreeStorage;
+} // namespace curvetree
+
 namespace privacy {
 
 // ============================================================================
@@ -51,7 +57,7 @@ namespace privacy {
  * Key images are the mechanism for preventing double-spends in FCMP.
  * Each FCMP output can only be spent once, identified by its key image.
  */
-class CFcmpKeyImageDB
+class CFcmpKeyImageDB : public CKeyImageSpendDB
 {
 public:
     explicit CFcmpKeyImageDB(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false);
@@ -97,15 +103,6 @@ public:
      * @brief Batch erase for efficiency during block disconnection
      */
     bool EraseBatch(const std::vector<CKeyImage>& keyImages);
-
-    /**
-     * @brief Sync to disk
-     */
-    bool Sync();
-
-private:
-    std::unique_ptr<CDBWrapper> m_db;
-    mutable RecursiveMutex cs_keyimage;
 };
 
 // ============================================================================
@@ -129,6 +126,13 @@ public:
     void Shutdown();
     bool IsInitialized() const { return m_initialized; }
 
+    /**
+     * @brief Write the buffered curve tree changes to disk, together with
+     * the chainstate so both describe the same block after a restart
+     * @return true on success
+     */
+    bool Flush();
+
     // ========== Curve Tree Access ==========
 
     /**
@@ -192,10 +196,38 @@ public:
      * @param state Validation state
      * @param view Coins view for input verification
      * @param nSpendHeight Current spend height
+     * @param verifyProofs false when the membership proofs and signatures
+     *        are known valid against the current root (proof cache hit)
      * @return true if valid
      */
     bool CheckFcmpInputs(const CTransaction& tx, TxValidationState& state,
-                         const CCoinsViewCache& view, int nSpendHeight) const;
+                         const CCoinsViewCache& view, int nSpendHeight,
+                         bool verifyProofs = true) const;
+
+    // ========== Assumeutxo Snapshots ==========
+
+    /**
+     * @brief Whether no output was added to the tree and no key image spent
+     */
+    bool IsEmpty() const;
+
+    /**
+     * @brief Read the curve tree outputs in leaf order, the tree root and
+     * the records of the key image database
+     * @return false if an output could not be read
+     */
+    bool GetSnapshotState(std::vector<curvetree::OutputTuple>& outputs, ed25519::Point& root,
+                          CDBWrapper::Records& keyImages) const;
+
+    /**
+     * @brief Fill an empty state from a snapshot taken at height
+     *
+     * The tree is rebuilt from the outputs and must end up with the root.
+     * On failure the state is left empty.
+     * @return true on success
+     */
+    bool LoadSnapshotState(const std::vector<curvetree::OutputTuple>& outputs, const ed25519::Point& root,
+                           const CDBWrapper::Records& keyImages, int height);
 
     // ========== Statistics ==========
 
@@ -217,12 +249,17 @@ private:
     // Curve tree for membership proofs
     std::shared_ptr<curvetree::CurveTree> m_curveTree GUARDED_BY(cs_fcmp);
     std::shared_ptr<curvetree::ITreeStorage> m_treeStorage;
+    // Write-back cache in front of the tree database, the same object as m_treeStorage
+    std::shared_ptr<curvetree::CachedTreeStorage> m_treeCache;
 
     // Key image database
     std::unique_ptr<CFcmpKeyImageDB> m_keyImageDB;
 
-    // Track outputs added per block for reorg handling
-    std::map<int, uint64_t> m_outputsAddedPerBlock GUARDED_BY(cs_fcmp);
+    // Curve tree undo records of the most recent blocks, so a disconnect
+    // only touches the nodes the block changed. Blocks further back are
+    // disconnected with CurveTree::TruncateTo().
+    static constexpr int TREE_UNDO_BLOCKS{100};
+    std::map<int, curvetree::TreeUndo> m_treeUndo GUARDED_BY(cs_fcmp);
 
     // Statistics
     uint64_t m_keyImagesSpent{0};
@@ -256,7 +293,7 @@ CFcmpConsensusState& GetFcmpState();
 /**
  * @brief Initialize FCMP consensus (called during node startup)
  */
-bool InitializeFcmpConsensus(const fs::path& datadir);
+bool InitializeFcmpConsensus(const fs::path& datadir, size_t cacheSize);
 
 /**
  * @brief Shutdown FCMP consensus (called during node shutdown)
@@ -277,6 +314,23 @@ bool HasFcmpInputs(const CTransaction& tx);
  */
 bool HasFcmpOutputs(const CTransaction& tx);
 
+/** Most FCMP outputs one shield script may carry */
+static constexpr size_t MAX_FCMP_SHIELD_OUTPUTS{16};
+
+/**
+ * @brief Build the OP_RETURN script that shields outputs into the curve tree
+ *
+ * Format: OP_RETURN <"FCMP" (O I C)...>, one push holding the marker and
+ * 96 bytes per output, so a batch of shields needs only one data output.
+ */
+CScript BuildFcmpShieldScript(const std::vector<curvetree::OutputTuple>& outputs);
+
+/**
+ * @brief Decode a shield script built by BuildFcmpShieldScript()
+ * @return The output tuples, empty if the script is not a shield script
+ */
+std::vector<curvetree::OutputTuple> ParseFcmpShieldScript(const CScript& script);
+
 /**
  * @brief Decode FCMP data from a transaction
  * @param tx The transaction
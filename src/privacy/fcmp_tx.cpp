@@ -282,6 +282,22 @@ std::vector<CFcmpInput> CFcmpTransactionBuilder::BuildInputs() {
 // Verification Functions
 // ============================================================================
 
+#ifdef HAVE_FCMP
+// Convert an input tuple to FFI format
+static FcmpInput ToFfiInput(const CFcmpInputTuple& tuple) {
+    FcmpInput ffiInput;
+    std::memcpy(ffiInput.o_tilde, tuple.O_tilde.data.data(), 32);
+    std::memcpy(ffiInput.o_tilde + 32, tuple.O_tilde.data.data(), 32); // y coord placeholder
+    std::memcpy(ffiInput.i_tilde, tuple.I_tilde.data.data(), 32);
+    std::memcpy(ffiInput.i_tilde + 32, tuple.I_tilde.data.data(), 32);
+    std::memcpy(ffiInput.r, tuple.R.data.data(), 32);
+    std::memcpy(ffiInput.r + 32, tuple.R.data.data(), 32);
+    std::memcpy(ffiInput.c_tilde, tuple.C_tilde.data.data(), 32);
+    std::memcpy(ffiInput.c_tilde + 32, tuple.C_tilde.data.data(), 32);
+    return ffiInput;
+}
+#endif
+
 bool VerifyFcmpInput(
     const CFcmpInput& input,
     const ed25519::Point& treeRoot,
@@ -313,18 +329,7 @@ bool VerifyFcmpInput(
     fcmp::FcmpContext ctx;
     fcmp::FcmpVerifier verifier(treeRoot);
 
-    // Convert input tuple to FFI format
-    FcmpInput ffiInput;
-    std::memcpy(ffiInput.o_tilde, input.inputTuple.O_tilde.data.data(), 32);
-    std::memcpy(ffiInput.o_tilde + 32, input.inputTuple.O_tilde.data.data(), 32); // y coord placeholder
-    std::memcpy(ffiInput.i_tilde, input.inputTuple.I_tilde.data.data(), 32);
-    std::memcpy(ffiInput.i_tilde + 32, input.inputTuple.I_tilde.data.data(), 32);
-    std::memcpy(ffiInput.r, input.inputTuple.R.data.data(), 32);
-    std::memcpy(ffiInput.r + 32, input.inputTuple.R.data.data(), 32);
-    std::memcpy(ffiInput.c_tilde, input.inputTuple.C_tilde.data.data(), 32);
-    std::memcpy(ffiInput.c_tilde + 32, input.inputTuple.C_tilde.data.data(), 32);
-
-    if (!verifier.Verify(ffiInput, input.membershipProof.proofData)) {
+    if (!verifier.Verify(ToFfiInput(input.inputTuple), input.membershipProof.proofData)) {
         return false;
     }
 #else
@@ -396,22 +401,115 @@ bool VerifyFcmpBalance(
     return sumPseudo.data == sumOutputs.data;
 }
 
+// SA+L signatures of inputs[begin, end) as one random linear combination:
+// sum(z_i * s_i) * G == sum(z_i * R_i) + sum(z_i * c_i * O_i)
+// With random weights z_i an invalid signature makes the combination fail
+// except with negligible probability, and the whole batch costs a single
+// multi-scalar multiplication.
+static bool BatchVerifySalSignatures(const std::vector<const CFcmpInput*>& inputs, size_t begin, size_t end)
+{
+    std::vector<ed25519::Scalar> scalars;
+    std::vector<ed25519::Point> points;
+    scalars.reserve(2 * (end - begin) + 1);
+    points.reserve(2 * (end - begin) + 1);
+
+    ed25519::Scalar sumS = ed25519::Scalar::Zero();
+    for (size_t i = begin; i < end; ++i) {
+        const CFcmpInput& input = *inputs[i];
+        const ed25519::Scalar z = ed25519::Scalar::Random();
+        sumS += z * input.salSignature.s;
+        scalars.push_back(z);
+        points.push_back(input.inputTuple.R);
+        scalars.push_back(z * input.salSignature.c);
+        points.push_back(input.inputTuple.O_tilde);
+    }
+    scalars.push_back(-sumS);
+    points.push_back(ed25519::Point::BasePoint());
+
+    return ed25519::MultiScalarMul(scalars, points).IsIdentity();
+}
+
+// Membership proofs of inputs[begin, end)
+static bool BatchVerifyMembershipProofs(const std::vector<const CFcmpInput*>& inputs, size_t begin, size_t end,
+                                        const ed25519::Point& treeRoot)
+{
+#ifdef HAVE_FCMP
+    fcmp::FcmpContext ctx;
+    fcmp::FcmpVerifier verifier(treeRoot);
+
+    std::vector<FcmpInput> ffiInputs;
+    std::vector<const std::vector<uint8_t>*> proofs;
+    for (size_t i = begin; i < end; ++i) {
+        ffiInputs.push_back(ToFfiInput(inputs[i]->inputTuple));
+        proofs.push_back(&inputs[i]->membershipProof.proofData);
+    }
+    return verifier.VerifyBatch(ffiInputs, proofs);
+#else
+    // Placeholder verification - check proofs aren't empty
+    for (size_t i = begin; i < end; ++i) {
+        if (inputs[i]->membershipProof.proofData.empty()) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+static bool BatchVerifyRange(const std::vector<const CFcmpInput*>& inputs, size_t begin, size_t end,
+                             const ed25519::Point& treeRoot)
+{
+    return BatchVerifySalSignatures(inputs, begin, end) &&
+           BatchVerifyMembershipProofs(inputs, begin, end, treeRoot);
+}
+
 bool BatchVerifyFcmpInputs(
-    const std::vector<CFcmpInput>& inputs,
+    const std::vector<const CFcmpInput*>& inputs,
     const ed25519::Point& treeRoot,
-    const uint256& messageHash
+    size_t* failedIndex
 ) {
-    // For now, verify individually
-    // Future optimization: use batch verification for signatures and proofs
-    for (const auto& input : inputs) {
-        if (!VerifyFcmpInput(input, treeRoot, messageHash)) {
+    // Cheap per-input checks first, they also name the failing input
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const CFcmpInput& input = *inputs[i];
+        if (!input.IsValid() || input.membershipProof.treeRoot.data != treeRoot.data ||
+            !VerifyFcmpKeyImageUnspent(input)) {
+            if (failedIndex) *failedIndex = i;
             return false;
         }
-        if (!VerifyFcmpKeyImageUnspent(input)) {
-            return false;
+    }
+
+    if (inputs.empty() || BatchVerifyRange(inputs, 0, inputs.size(), treeRoot)) {
+        return true;
+    }
+
+    // Bisect to the failing input. A half that passes means the other one
+    // holds an invalid input, so this takes O(log n) batch checks.
+    if (failedIndex) {
+        size_t begin = 0;
+        size_t end = inputs.size();
+        while (end - begin > 1) {
+            const size_t mid = begin + (end - begin) / 2;
+            if (!BatchVerifyRange(inputs, begin, mid, treeRoot)) {
+                end = mid;
+            } else {
+                begin = mid;
+            }
         }
+        *failedIndex = begin;
     }
-    return true;
+    return false;
+}
+
+bool BatchVerifyFcmpInputs(
+    const std::vector<CFcmpInput>& inputs,
+    const ed25519::Point& treeRoot,
+    const uint256& messageHash
+) {
+    std::vector<const CFcmpInput*> refs;
+    refs.reserve(inputs.size());
+    for (const auto& input : inputs) {
+        refs.push_back(&input);
+    }
+    return BatchVerifyFcmpInputs(refs, treeRoot);
 }
 
 // ============================================================================
@@ -409,6 +409,24 @@ bool BatchVerifyFcmpInputs(
     const uint256& messageHash
 );
 
+/**
+ * @brief Batch verify FCMP inputs, possibly from several transactions
+ *
+ * The SA+L signatures are checked as one random linear combination and the
+ * membership proofs in one call to the proof verifier. If the batch fails it
+ * is bisected to find an invalid input.
+ *
+ * @param inputs FCMP inputs to verify
+ * @param treeRoot Curve tree root the proofs must be against
+ * @param failedIndex If not null, set to the index of an invalid input on failure
+ * @return true if all valid
+ */
+bool BatchVerifyFcmpInputs(
+    const std::vector<const CFcmpInput*>& inputs,
+    const ed25519::Point& treeRoot,
+    size_t* failedIndex = nullptr
+);
+
 // ============================================================================
 // Utility Functions
 // ============================================================================
@@ -0,0 +1,205 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <privacy/keyimage_db.h>
+
+#include <crypto/common.h>
+#include <logging.h>
+#include <util/time.h>
+#include <util/trace.h>
+
+#include <algorithm>
+
+TRACEPOINT_SEMAPHORE(privacy, key_image_lookup);
+
+namespace privacy {
+
+// Smallest filter, enough that a new chain does not rebuild it early on
+static constexpr uint64_t MIN_FILTER_CAPACITY = 1 << 16;
+
+//
+// CKeyImageFilter Implementation
+//
+
+CKeyImageFilter::CKeyImageFilter(uint64_t capacity)
+    : m_blocks((std::max<uint64_t>(capacity, 1) * BITS_PER_KEY + 511) / 512),
+      m_capacity(capacity)
+{
+    for (auto& block : m_blocks) block.fill(0);
+}
+
+void CKeyImageFilter::Insert(const uint256& hash)
+{
+    // The key image hashes are uniform, so their bits are used directly: the
+    // first word picks the block, the next 72 bits give 8 bit positions
+    const uint64_t w0 = ReadLE64(hash.data());
+    const uint64_t w1 = ReadLE64(hash.data() + 8);
+    const uint64_t w2 = ReadLE64(hash.data() + 16);
+    Block& block = m_blocks[w0 % m_blocks.size()];
+    for (int i = 0; i < 8; ++i) {
+        const uint64_t pos = (i < 7 ? w1 >> (9 * i) : w2) & 511;
+        block[pos >> 6] |= uint64_t{1} << (pos & 63);
+    }
+    ++m_count;
+}
+
+bool CKeyImageFilter::MayContain(const uint256& hash) const
+{
+    const uint64_t w0 = ReadLE64(hash.data());
+    const uint64_t w1 = ReadLE64(hash.data() + 8);
+    const uint64_t w2 = ReadLE64(hash.data() + 16);
+    const Block& block = m_blocks[w0 % m_blocks.size()];
+    for (int i = 0; i < 8; ++i) {
+        const uint64_t pos = (i < 7 ? w1 >> (9 * i) : w2) & 511;
+        if (!(block[pos >> 6] & (uint64_t{1} << (pos & 63)))) return false;
+    }
+    return true;
+}
+
+//
+// CKeyImageSpendDB Implementation
+//
+
+CKeyImageSpendDB::CKeyImageSpendDB(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, uint8_t key_prefix)
+    : m_key_prefix(key_prefix)
+{
+    m_db = std::make_unique<CDBWrapper>(DBParams{
+        .path = path,
+        .cache_bytes = nCacheSize,
+        .memory_only = fMemory,
+        .wipe_data = fWipe
+    });
+
+    LOCK(cs_db);
+    RebuildFilter();
+}
+
+void CKeyImageSpendDB::RebuildFilter()
+{
+    std::vector<uint256> hashes;
+    std::unique_ptr<CDBIterator> cursor{m_db->NewIterator()};
+    cursor->Seek(std::make_pair(m_key_prefix, uint256{}));
+    for (; cursor->Valid(); cursor->Next()) {
+        std::pair<uint8_t, uint256> key;
+        if (!cursor->GetKey(key) || key.first != m_key_prefix) break;
+        hashes.push_back(key.second);
+    }
+
+    auto filter = std::make_unique<CKeyImageFilter>(std::max<uint64_t>(hashes.size() * 2, MIN_FILTER_CAPACITY));
+    for (const uint256& hash : hashes) {
+        filter->Insert(hash);
+    }
+    LogDebug(BCLog::PRIVACY, "Key image filter built over %u spent key images, capacity %u\n",
+             hashes.size(), filter->GetCapacity());
+
+    LOCK(cs_filter);
+    m_filter = std::move(filter);
+}
+
+bool CKeyImageSpendDB::IsSpent(const uint256& keyImageHash) const
+{
+    const bool traced{TRACEPOINT_ACTIVE(privacy, key_image_lookup)};
+    const auto start{traced ? SteadyClock::now() : SteadyClock::time_point{}};
+    bool maybe_spent;
+    {
+        LOCK(cs_filter);
+        maybe_spent = m_filter->MayContain(keyImageHash);
+    }
+    bool spent{false};
+    if (maybe_spent) {
+        LOCK(cs_db);
+        spent = m_db->Exists(std::make_pair(m_key_prefix, keyImageHash));
+    }
+    // A lookup the filter rules out never reaches the database
+    TRACEPOINT(privacy, key_image_lookup,
+        keyImageHash.data(),
+        maybe_spent,
+        spent,
+        Ticks<std::chrono::microseconds>(SteadyClock::now() - start)
+    );
+    return spent;
+}
+
+bool CKeyImageSpendDB::ReadSpend(const uint256& keyImageHash, CKeyImageEntry& entry) const
+{
+    {
+        LOCK(cs_filter);
+        if (!m_filter->MayContain(keyImageHash)) return false;
+    }
+    LOCK(cs_db);
+    return m_db->Read(std::make_pair(m_key_prefix, keyImageHash), entry);
+}
+
+bool CKeyImageSpendDB::WriteSpends(const std::vector<std::pair<uint256, CKeyImageEntry>>& spends)
+{
+    LOCK(cs_db);
+
+    // The filter learns the key images first, so a lookup never misses one
+    // that is already in the database
+    bool full;
+    {
+        LOCK(cs_filter);
+        for (const auto& [hash, entry] : spends) {
+            m_filter->Insert(hash);
+        }
+        full = m_filter->GetCount() > m_filter->GetCapacity();
+    }
+
+    CDBBatch batch(*m_db);
+    for (const auto& [hash, entry] : spends) {
+        batch.Write(std::make_pair(m_key_prefix, hash), entry);
+    }
+    if (!m_db->WriteBatch(batch)) {
+        return false;
+    }
+
+    if (full) {
+        RebuildFilter();
+    }
+    return true;
+}
+
+bool CKeyImageSpendDB::EraseSpends(const std::vector<uint256>& keyImageHashes)
+{
+    LOCK(cs_db);
+    CDBBatch batch(*m_db);
+
+    for (const uint256& hash : keyImageHashes) {
+        batch.Erase(std::make_pair(m_key_prefix, hash));
+    }
+
+    return m_db->WriteBatch(batch);
+}
+
+bool CKeyImageSpendDB::IsEmpty() const
+{
+    LOCK(cs_db);
+    std::unique_ptr<CDBIterator> cursor{m_db->NewIterator()};
+    cursor->Seek(std::make_pair(m_key_prefix, uint256{}));
+    std::pair<uint8_t, uint256> key;
+    return !cursor->Valid() || !cursor->GetKey(key) || key.first != m_key_prefix;
+}
+
+CDBWrapper::Records CKeyImageSpendDB::GetDBRecords() const
+{
+    LOCK(cs_db);
+    return m_db->ReadAllRecords();
+}
+
+bool CKeyImageSpendDB::LoadDBRecords(const CDBWrapper::Records& records)
+{
+    LOCK(cs_db);
+    if (!m_db->ReplaceAllRecords(records)) return false;
+    RebuildFilter();
+    return true;
+}
+
+bool CKeyImageSpendDB::Sync()
+{
+    LOCK(cs_db);
+    CDBBatch batch(*m_db);
+    return m_db->WriteBatch(batch, true);  // fSync = true
+}
+
+} // namespace privacy
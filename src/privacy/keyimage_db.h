@@ -0,0 +1,120 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_PRIVACY_KEYIMAGE_DB_H
+#define WATTX_PRIVACY_KEYIMAGE_DB_H
+
+#include <dbwrapper.h>
+#include <serialize.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/fs.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace privacy {
+
+/**
+ * @brief Key image database entry
+ */
+struct CKeyImageEntry
+{
+    uint256 txHash;     // Transaction that spent this key image
+    int blockHeight;    // Block height (-1 for mempool)
+
+    SERIALIZE_METHODS(CKeyImageEntry, obj) {
+        READWRITE(obj.txHash, obj.blockHeight);
+    }
+};
+
+/**
+ * @brief Blocked Bloom filter over spent key image hashes
+ *
+ * Each key sets 8 bits inside one 512-bit block, so a lookup touches a single
+ * cache line. With 16 bits per key about 0.1% of unspent key images are
+ * reported as possibly spent. There are no false negatives.
+ */
+class CKeyImageFilter
+{
+public:
+    explicit CKeyImageFilter(uint64_t capacity);
+
+    void Insert(const uint256& hash);
+    bool MayContain(const uint256& hash) const;
+
+    //! Keys the filter was sized for, past this the false positive rate climbs
+    uint64_t GetCapacity() const { return m_capacity; }
+    uint64_t GetCount() const { return m_count; }
+
+private:
+    static constexpr uint64_t BITS_PER_KEY = 16;
+    using Block = std::array<uint64_t, 8>;
+
+    std::vector<Block> m_blocks;
+    uint64_t m_capacity;
+    uint64_t m_count{0};
+};
+
+/**
+ * @brief Spent key images in a LevelDB database, behind an in-memory filter
+ *
+ * The common answer to IsSpent() is "not spent", which the filter gives
+ * without reading the database. The filter is built from the database when
+ * it is opened and gains every key image written. Erased key images stay in
+ * the filter until it is rebuilt, which only costs a database read when they
+ * are looked up again.
+ *
+ * Base of the transparent ring (CKeyImageDB) and FCMP (CFcmpKeyImageDB) key
+ * image databases.
+ */
+class CKeyImageSpendDB
+{
+public:
+    CKeyImageSpendDB(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, uint8_t key_prefix);
+    virtual ~CKeyImageSpendDB() = default;
+
+    //! Check if the key image with this hash has been spent
+    bool IsSpent(const uint256& keyImageHash) const EXCLUSIVE_LOCKS_REQUIRED(!cs_db, !cs_filter);
+
+    //! Read the spend of the key image with this hash
+    bool ReadSpend(const uint256& keyImageHash, CKeyImageEntry& entry) const EXCLUSIVE_LOCKS_REQUIRED(!cs_db, !cs_filter);
+
+    //! Record spends, keyed by key image hash, in one batch
+    bool WriteSpends(const std::vector<std::pair<uint256, CKeyImageEntry>>& spends) EXCLUSIVE_LOCKS_REQUIRED(!cs_db, !cs_filter);
+
+    //! Remove spends (for reorg) in one batch
+    bool EraseSpends(const std::vector<uint256>& keyImageHashes) EXCLUSIVE_LOCKS_REQUIRED(!cs_db);
+
+    //! Whether no key image is recorded as spent
+    bool IsEmpty() const EXCLUSIVE_LOCKS_REQUIRED(!cs_db);
+
+    //! Every record of the database, for an assumeutxo snapshot
+    CDBWrapper::Records GetDBRecords() const EXCLUSIVE_LOCKS_REQUIRED(!cs_db);
+
+    //! Replace the database with records from GetDBRecords()
+    bool LoadDBRecords(const CDBWrapper::Records& records) EXCLUSIVE_LOCKS_REQUIRED(!cs_db, !cs_filter);
+
+    //! Sync to disk
+    bool Sync() EXCLUSIVE_LOCKS_REQUIRED(!cs_db);
+
+private:
+    std::unique_ptr<CDBWrapper> m_db;
+    const uint8_t m_key_prefix;
+    mutable Mutex cs_db;
+
+    std::unique_ptr<CKeyImageFilter> m_filter GUARDED_BY(cs_filter);
+    mutable Mutex cs_filter;
+
+    //! Build a new filter from the key images in the database, with room to
+    //! grow, and swap it in
+    void RebuildFilter() EXCLUSIVE_LOCKS_REQUIRED(cs_db, !cs_filter);
+};
+
+} // namespace privacy
+
+#endif // WATTX_PRIVACY_KEYIMAGE_DB_H
@@ -8,7 +8,9 @@
 #include <secp256k1.h>
 #include <random.h>
 #include <span.h>
+#include <sync.h>
 
+#include <map>
 #include <mutex>
 #include <set>
 #include <cmath>
@@ -24,12 +26,30 @@ uint256 CKeyImage::GetHash() const
     return Hash(data);
 }
 
-bool HashToPoint(const CPubKey& pubKey, CPubKey& result)
+namespace {
+
+// libsecp256k1 context for parsing and point arithmetic. It is only passed
+// to functions taking it as const, so all threads share one instance.
+const secp256k1_context* RingContext()
+{
+    static secp256k1_context* const ctx{secp256k1_context_create(SECP256K1_CONTEXT_NONE)};
+    return ctx;
+}
+
+// Hp(P) of recently seen ring members. Decoys are drawn from the same outputs
+// again and again, so most members of a ring have been hashed before.
+constexpr size_t HASH_TO_POINT_CACHE_SIZE{1 << 15};
+Mutex g_hash_to_point_mutex;
+std::map<CPubKey, CPubKey> g_hash_to_point_cache GUARDED_BY(g_hash_to_point_mutex);
+
+} // namespace
+
+static bool ComputeHashToPoint(const CPubKey& pubKey, CPubKey& result)
 {
     // Hash-to-point using try-and-increment method
     // H(pubKey) -> point on curve
 
-    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    const secp256k1_context* ctx = RingContext();
     if (!ctx) return false;
 
     uint256 hash;
@@ -49,17 +69,39 @@ bool HashToPoint(const CPubKey& pubKey, CPubKey& result)
         secp256k1_pubkey parsed;
         if (secp256k1_ec_pubkey_parse(ctx, &parsed, testPoint.data(), 33)) {
             result = CPubKey(testPoint.begin(), testPoint.end());
-            secp256k1_context_destroy(ctx);
             return true;
         }
 
         counter++;
     }
 
-    secp256k1_context_destroy(ctx);
     return false;
 }
 
+bool HashToPoint(const CPubKey& pubKey, CPubKey& result)
+{
+    {
+        LOCK(g_hash_to_point_mutex);
+        auto it = g_hash_to_point_cache.find(pubKey);
+        if (it != g_hash_to_point_cache.end()) {
+            result = it->second;
+            return true;
+        }
+    }
+
+    if (!ComputeHashToPoint(pubKey, result)) {
+        return false;
+    }
+
+    LOCK(g_hash_to_point_mutex);
+    if (g_hash_to_point_cache.size() >= HASH_TO_POINT_CACHE_SIZE) {
+        // Evict an arbitrary entry, the keys are uniformly distributed
+        g_hash_to_point_cache.erase(g_hash_to_point_cache.begin());
+    }
+    g_hash_to_point_cache.emplace(pubKey, result);
+    return true;
+}
+
 bool GenerateKeyImage(
     const CKey& privKey,
     const CPubKey& pubKey,
@@ -383,6 +425,63 @@ bool CreateRingSignature(
     return true;
 }
 
+// A ring member's P and Hp(P), parsed once per verification instead of once
+// per L and R computation
+struct RingMemberPoints
+{
+    secp256k1_pubkey P;
+    secp256k1_pubkey HpP;
+};
+
+static bool LoadRingMember(const CPubKey& pubKey, RingMemberPoints& member)
+{
+    const secp256k1_context* ctx = RingContext();
+    CPubKey HpP;
+    return HashToPoint(pubKey, HpP) &&
+           secp256k1_ec_pubkey_parse(ctx, &member.P, pubKey.data(), pubKey.size()) &&
+           secp256k1_ec_pubkey_parse(ctx, &member.HpP, HpP.data(), HpP.size());
+}
+
+static CPubKey SerializePoint(const secp256k1_pubkey& point)
+{
+    unsigned char serialized[33];
+    size_t len = 33;
+    secp256k1_ec_pubkey_serialize(RingContext(), serialized, &len, &point, SECP256K1_EC_COMPRESSED);
+    return CPubKey(serialized, serialized + 33);
+}
+
+// Compute L = s*G + c*P and R = s*Hp(P) + c*I from pre-parsed points
+static bool ComputeLR(const secp256k1_context* ctx, const RingMemberPoints& member,
+                      const secp256k1_pubkey& I, const uint256& s, const uint256& c,
+                      CPubKey& L, CPubKey& R)
+{
+    // s*G uses the precomputed generator table
+    secp256k1_pubkey sG;
+    if (!secp256k1_ec_pubkey_create(ctx, &sG, s.begin())) {
+        return false;
+    }
+    secp256k1_pubkey cP = member.P;
+    secp256k1_pubkey sHp = member.HpP;
+    secp256k1_pubkey cI = I;
+    if (!secp256k1_ec_pubkey_tweak_mul(ctx, &cP, c.begin()) ||
+        !secp256k1_ec_pubkey_tweak_mul(ctx, &sHp, s.begin()) ||
+        !secp256k1_ec_pubkey_tweak_mul(ctx, &cI, c.begin())) {
+        return false;
+    }
+
+    const secp256k1_pubkey* lpoints[2] = {&sG, &cP};
+    const secp256k1_pubkey* rpoints[2] = {&sHp, &cI};
+    secp256k1_pubkey Lpoint, Rpoint;
+    if (!secp256k1_ec_pubkey_combine(ctx, &Lpoint, lpoints, 2) ||
+        !secp256k1_ec_pubkey_combine(ctx, &Rpoint, rpoints, 2)) {
+        return false;
+    }
+
+    L = SerializePoint(Lpoint);
+    R = SerializePoint(Rpoint);
+    return true;
+}
+
 bool VerifyRingSignature(
     const uint256& message,
     const CRingSignature& sig)
@@ -393,46 +492,42 @@ bool VerifyRingSignature(
 
     size_t n = sig.ring.Size();
 
-    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    const secp256k1_context* ctx = RingContext();
     if (!ctx) return false;
 
+    // Parse the key image and every member's points once
+    secp256k1_pubkey I;
+    if (!secp256k1_ec_pubkey_parse(ctx, &I, sig.keyImage.data.data(), sig.keyImage.data.size())) {
+        return false;
+    }
+    std::vector<RingMemberPoints> members(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!LoadRingMember(sig.ring.members[i].pubKey, members[i])) {
+            return false;
+        }
+    }
+
     // Reconstruct L and R values, propagating challenges
-    std::vector<CPubKey> Ls(n), Rs(n);
-    std::vector<uint256> c(n);
-    c[0] = sig.c0;
+    CPubKey L, R;
+    uint256 c = sig.c0;
 
     for (size_t i = 0; i < n; i++) {
         // Verify s[i] is a valid scalar
         if (!secp256k1_ec_seckey_verify(ctx, sig.s[i].begin())) {
-            secp256k1_context_destroy(ctx);
             return false;
         }
 
-        // Compute L[i] = s[i]*G + c[i]*P[i]
-        if (!ComputeL(ctx, sig.s[i], c[i], sig.ring.members[i].pubKey, Ls[i])) {
-            secp256k1_context_destroy(ctx);
+        // Compute L[i] = s[i]*G + c[i]*P[i] and R[i] = s[i]*Hp(P[i]) + c[i]*I
+        if (!ComputeLR(ctx, members[i], I, sig.s[i], c, L, R)) {
             return false;
         }
 
-        // Compute R[i] = s[i]*Hp(P[i]) + c[i]*I
-        if (!ComputeR(ctx, sig.s[i], c[i], sig.ring.members[i].pubKey, sig.keyImage, Rs[i])) {
-            secp256k1_context_destroy(ctx);
-            return false;
-        }
-
-        // Compute c[i+1] = H(message || L[i] || R[i])
-        if (i < n - 1) {
-            c[i + 1] = ComputeChallenge(message, Ls[i], Rs[i]);
-        }
+        // Compute c[i+1] = H(message || L[i] || R[i]), wrapping around to c[0]
+        c = ComputeChallenge(message, L, R);
     }
 
-    // Compute what c[0] should be from the last L, R pair
-    uint256 c0_computed = ComputeChallenge(message, Ls[n - 1], Rs[n - 1]);
-
-    secp256k1_context_destroy(ctx);
-
     // Ring closes if computed c0 matches provided c0
-    return c0_computed == sig.c0;
+    return c == sig.c0;
 }
 
 // Helper: Compute MLSAG challenge from all L and R values across rings
@@ -626,60 +721,46 @@ bool VerifyMLSAGSignature(
     size_t m = sig.rings.size();  // Number of inputs
     size_t n = sig.RingSize();    // Ring size
 
-    secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
+    const secp256k1_context* ctx = RingContext();
     if (!ctx) return false;
 
-    // Reconstruct all L and R values
-    std::vector<std::vector<CPubKey>> Ls(m, std::vector<CPubKey>(n));
-    std::vector<std::vector<CPubKey>> Rs(m, std::vector<CPubKey>(n));
-    std::vector<uint256> c(n);
-    c[0] = sig.c0;
+    // Parse the key images and every member's points once
+    std::vector<secp256k1_pubkey> Is(m);
+    std::vector<std::vector<RingMemberPoints>> members(m, std::vector<RingMemberPoints>(n));
+    for (size_t j = 0; j < m; j++) {
+        if (!secp256k1_ec_pubkey_parse(ctx, &Is[j], sig.keyImages[j].data.data(), sig.keyImages[j].data.size())) {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!LoadRingMember(sig.rings[j].members[i].pubKey, members[j][i])) {
+                return false;
+            }
+        }
+    }
 
-    for (size_t i = 0; i < n; i++) {
-        std::vector<CPubKey> allLs(m), allRs(m);
+    // Reconstruct the L and R values column by column
+    std::vector<CPubKey> allLs(m), allRs(m);
+    uint256 c = sig.c0;
 
+    for (size_t i = 0; i < n; i++) {
         for (size_t j = 0; j < m; j++) {
             // Verify s[j][i] is a valid scalar
             if (!secp256k1_ec_seckey_verify(ctx, sig.s[j][i].begin())) {
-                secp256k1_context_destroy(ctx);
                 return false;
             }
 
-            // Compute L[j][i] = s[j][i]*G + c[i]*P[j][i]
-            if (!ComputeL(ctx, sig.s[j][i], c[i], sig.rings[j].members[i].pubKey, Ls[j][i])) {
-                secp256k1_context_destroy(ctx);
+            // Compute L[j][i] = s[j][i]*G + c[i]*P[j][i] and R[j][i] = s[j][i]*Hp(P[j][i]) + c[i]*I[j]
+            if (!ComputeLR(ctx, members[j][i], Is[j], sig.s[j][i], c, allLs[j], allRs[j])) {
                 return false;
             }
-
-            // Compute R[j][i] = s[j][i]*Hp(P[j][i]) + c[i]*I[j]
-            if (!ComputeR(ctx, sig.s[j][i], c[i], sig.rings[j].members[i].pubKey,
-                          sig.keyImages[j], Rs[j][i])) {
-                secp256k1_context_destroy(ctx);
-                return false;
-            }
-
-            allLs[j] = Ls[j][i];
-            allRs[j] = Rs[j][i];
         }
 
-        // Compute c[i+1]
-        if (i < n - 1) {
-            c[i + 1] = ComputeMLSAGChallenge(message, allLs, allRs);
-        }
-    }
-
-    // Compute what c[0] should be from the last column
-    std::vector<CPubKey> lastLs(m), lastRs(m);
-    for (size_t j = 0; j < m; j++) {
-        lastLs[j] = Ls[j][n - 1];
-        lastRs[j] = Rs[j][n - 1];
+        // Compute c[i+1], wrapping around to c[0] after the last column
+        c = ComputeMLSAGChallenge(message, allLs, allRs);
     }
-    uint256 c0_computed = ComputeMLSAGChallenge(message, lastLs, lastRs);
-
-    secp256k1_context_destroy(ctx);
 
     // Ring closes if computed c0 matches provided c0
-    return c0_computed == sig.c0;
+    return c == sig.c0;
 }
 
 // Global decoy provider
@@ -238,6 +238,9 @@ bool VerifyMLSAGSignature(
 /**
  * @brief Hash a point to the curve (for key image generation)
  *
+ * Results for recently hashed keys are cached, since ring members recur
+ * across the rings being verified.
+ *
  * @param pubKey Input point
  * @param result [out] Resulting point on curve
  * @return true if hash succeeded
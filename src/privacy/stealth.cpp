@@ -130,7 +130,8 @@ bool ScanStealthOutput(
     const CStealthOutput& output,
     const CKey& scanPrivKey,
     const CPubKey& spendPubKey,
-    CKey& derivedPrivKey)
+    CKey& derivedPrivKey,
+    uint256* sharedSecretHash)
 {
     if (!output.oneTimePubKey.IsValid() || !output.ephemeral.ephemeralPubKey.IsValid()) {
         return false;
@@ -198,6 +199,10 @@ bool ScanStealthOutput(
         return false;
     }
 
+    if (sharedSecretHash) {
+        *sharedSecretHash = scalarHash;
+    }
+
     // Match found! Caller needs to derive spending key separately
     // (requires spend_privkey which we don't have here)
     return true;
@@ -133,13 +133,16 @@ bool GenerateStealthDestination(
  * @param scanPrivKey The recipient's scan private key
  * @param spendPubKey The recipient's spend public key
  * @param derivedPrivKey [out] If matched, the private key to spend this output
+ * @param sharedSecretHash [out] If given and matched, H(S || output_index),
+ *                         which also keys the output's EncryptAmount()
  * @return true if output belongs to this stealth address
  */
 bool ScanStealthOutput(
     const CStealthOutput& output,
     const CKey& scanPrivKey,
     const CPubKey& spendPubKey,
-    CKey& derivedPrivKey);
+    CKey& derivedPrivKey,
+    uint256* sharedSecretHash = nullptr);
 
 /**
  * @brief Derive the private key for spending a stealth output
@@ -264,6 +264,21 @@ inline constexpr const char* WTXIDRELAY{"wtxidrelay"};
  * txreconciliation, as described by BIP 330.
  */
 inline constexpr const char* SENDTXRCNCL{"sendtxrcncl"};
+/**
+ * Requests the sketches of the current reconciliation sets from a peer we
+ * initiate reconciliation with, carrying our set sizes and the q coefficient.
+ * WATTx sends one set size per reconciliation set (default, contract, privacy).
+ */
+inline constexpr const char* REQRECON{"reqrecon"};
+/**
+ * Contains one sketch per reconciliation set, in reply to a reqrecon.
+ */
+inline constexpr const char* SKETCH{"sketch"};
+/**
+ * Ends a reconciliation round: per set, whether the sketch decoded and the
+ * short IDs of the transactions the initiator is missing.
+ */
+inline constexpr const char* RECONCILDIFF{"reconcildiff"};
 
 //////////////////////////////////////////////////
 // WATTx Trust Tier System Messages
@@ -296,6 +311,27 @@ inline constexpr const char* VALIDATORS{"validators"};
  */
 inline constexpr const char* REGVALIDATOR{"regvalidator"};
 
+/**
+ * The hbcompact message announces the heartbeats a node holds for one block
+ * as short IDs, once per block. Peers request the heartbeats they lack with
+ * gethbeats.
+ * @since WATTx protocol version 1.
+ */
+inline constexpr const char* HBCOMPACT{"hbcompact"};
+
+/**
+ * The gethbeats message requests heartbeats of an hbcompact announcement by
+ * their index in it.
+ * @since WATTx protocol version 1.
+ */
+inline constexpr const char* GETHBEATS{"gethbeats"};
+
+/**
+ * The hbeats message contains the heartbeats asked for in a gethbeats message.
+ * @since WATTx protocol version 1.
+ */
+inline constexpr const char* HBEATS{"hbeats"};
+
 //////////////////////////////////////////////////
 // WATTx Encrypted P2P Messaging
 //////////////////////////////////////////////////
@@ -303,7 +339,8 @@ inline constexpr const char* REGVALIDATOR{"regvalidator"};
 /**
  * The encmsg message contains an encrypted P2P message.
  * Contains recipient address hash, encrypted payload, and signature.
- * Messages are relayed to peers until delivered.
+ * Messages are announced with MSG_ENCMSG invs and sent in reply to a getdata
+ * for them, and relayed to peers until delivered.
  * @since WATTx protocol version 1.
  */
 inline constexpr const char* ENCMSG{"encmsg"};
@@ -347,11 +384,17 @@ inline const std::array ALL_NET_MESSAGE_TYPES{std::to_array<std::string>({
     NetMsgType::CFCHECKPT,
     NetMsgType::WTXIDRELAY,
     NetMsgType::SENDTXRCNCL,
+    NetMsgType::REQRECON,
+    NetMsgType::SKETCH,
+    NetMsgType::RECONCILDIFF,
     // WATTx Trust Tier messages
     NetMsgType::HEARTBEAT,
     NetMsgType::GETVALIDATORS,
     NetMsgType::VALIDATORS,
     NetMsgType::REGVALIDATOR,
+    NetMsgType::HBCOMPACT,
+    NetMsgType::GETHBEATS,
+    NetMsgType::HBEATS,
     // WATTx Encrypted P2P Messaging
     NetMsgType::ENCMSG,
 })};
@@ -542,6 +585,7 @@ enum GetDataMsg : uint32_t {
     // MSG_FILTERED_WITNESS_BLOCK is defined in BIP144 as reserved for future
     // use and remains unused.
     // MSG_FILTERED_WITNESS_BLOCK = MSG_FILTERED_BLOCK | MSG_WITNESS_FLAG,
+    MSG_ENCMSG = 64,                                  //!< WATTx encrypted P2P message, by EncryptedMessage::msgHash
 };
 
 /** inv message data */
@@ -565,6 +609,7 @@ public:
     bool IsMsgFilteredBlk() const { return type == MSG_FILTERED_BLOCK; }
     bool IsMsgCmpctBlk() const { return type == MSG_CMPCT_BLOCK; }
     bool IsMsgWitnessBlk() const { return type == MSG_WITNESS_BLOCK; }
+    bool IsMsgEncMsg() const { return type == MSG_ENCMSG; }
 
     // Combined-message helper methods
     bool IsGenTxMsg() const
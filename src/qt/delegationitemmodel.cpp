@@ -192,9 +192,18 @@ private Q_SLOTS:
         Q_EMIT itemChanged(hash, balance, stake, weight, status);
     }
 
+    void finishUpdates()
+    {
+        // Queued after the updates of a refresh, so all of them are done
+        Q_EMIT updatesFinished();
+    }
+
 Q_SIGNALS:
     // Signal that item in changed
     void itemChanged(QString hash, qint64 balance, qint64 stake, qint64 weight, qint32 status);
+
+    // Signal that the updates of a refresh are done
+    void updatesFinished();
 };
 
 #include <qt/delegationitemmodel.moc>
@@ -313,7 +322,9 @@ DelegationItemModel::DelegationItemModel(WalletModel *parent):
     QAbstractItemModel(parent),
     walletModel(parent),
     priv(0),
-    worker(0)
+    worker(0),
+    updatesPending(false),
+    checkPending(false)
 {
     columns << tr("Delegate") << tr("Staker Name") << tr("Staker Address") << tr("Fee") << tr("Height") << tr("Time");
 
@@ -323,6 +334,7 @@ DelegationItemModel::DelegationItemModel(WalletModel *parent):
     worker = new DelegationWorker(walletModel);
     worker->moveToThread(&(t));
     connect(worker, &DelegationWorker::itemChanged, this, &DelegationItemModel::itemChanged);
+    connect(worker, &DelegationWorker::updatesFinished, this, &DelegationItemModel::updatesFinished);
 
     t.start();
 
@@ -473,12 +485,32 @@ void DelegationItemModel::checkDelegationChanged()
     if(!priv)
         return;
 
+    // Blocks that come in while the worker is still busy are coalesced into one more refresh
+    if(updatesPending)
+    {
+        checkPending = true;
+        return;
+    }
+
     // Update delegation from contract
     for(int i = 0; i < priv->cachedDelegationItem.size(); i++)
     {
         DelegationItemEntry delegationEntry = priv->cachedDelegationItem[i];
         updateDelegationData(delegationEntry);
     }
+
+    updatesPending = true;
+    QMetaObject::invokeMethod(worker, "finishUpdates", Qt::QueuedConnection);
+}
+
+void DelegationItemModel::updatesFinished()
+{
+    updatesPending = false;
+    if(checkPending)
+    {
+        checkPending = false;
+        checkDelegationChanged();
+    }
 }
 
 void DelegationItemModel::emitDataChanged(int idx)
@@ -551,19 +583,19 @@ void DelegationItemModel::itemChanged(QString hash, qint64 balance, qint64 stake
     uint256 updated;
     updated.SetHexDeprecated(hash.toStdString());
 
-    // Update delegation
-    for(int i = 0; i < priv->cachedDelegationItem.size(); i++)
+    // Update delegation, the rows only change when the values do
+    QList<DelegationItemEntry>::iterator it = std::lower_bound(
+        priv->cachedDelegationItem.begin(), priv->cachedDelegationItem.end(), updated, DelegationItemEntryLessThan());
+    if(it == priv->cachedDelegationItem.end() || it->hash != updated)
+        return;
+
+    if(it->balance != balance || it->stake != stake || it->weight != weight || it->status != status)
     {
-        DelegationItemEntry delegationEntry = priv->cachedDelegationItem[i];
-        if(delegationEntry.hash == updated)
-        {
-            delegationEntry.balance = balance;
-            delegationEntry.stake = stake;
-            delegationEntry.weight = weight;
-            delegationEntry.status = status;
-            priv->cachedDelegationItem[i] = delegationEntry;
-            priv->updateEntry(delegationEntry, CT_UPDATED);
-        }
+        it->balance = balance;
+        it->stake = stake;
+        it->weight = weight;
+        it->status = status;
+        emitDataChanged(it - priv->cachedDelegationItem.begin());
     }
 }
 
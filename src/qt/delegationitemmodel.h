@@ -79,6 +79,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void updateDelegationData(const QString &hash, int status, bool showDelegation);
+    void updatesFinished();
 
 private:
     /** Notify listeners that data changed. */
@@ -92,6 +93,8 @@ private:
     DelegationItemPriv* priv;
     DelegationWorker* worker;
     QThread t;
+    bool updatesPending;
+    bool checkPending;
     std::unique_ptr<interfaces::Handler> m_handler_delegation_changed;
 
     friend class DelegationItemPriv;
@@ -855,6 +855,9 @@ QString ConnectionTypeToQString(ConnectionType conn_type, bool prepend_direction
     case ConnectionType::FEELER: return prefix + QObject::tr("Feeler");
     //: Short-lived peer connection type that solicits known addresses from a peer.
     case ConnectionType::ADDR_FETCH: return prefix + QObject::tr("Address Fetch");
+    /*: Peer connection type to a staking validator that relays network
+        information about blocks and not transactions or addresses. */
+    case ConnectionType::VALIDATOR_RELAY: return prefix + QObject::tr("Validator Relay");
     } // no default case, so the compiler can warn about missing cases
     assert(false);
 }
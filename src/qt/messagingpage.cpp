@@ -47,7 +47,9 @@
 #include <QColorDialog>
 #include <QUuid>
 #include <QHeaderView>
+#include <QListView>
 #include <qt/chatbubblewidget.h>
+#include <qt/p2pconversationmodel.h>
 
 // OP_RETURN message prefix
 static const std::string OP_RETURN_PREFIX = "WTX:";
@@ -74,8 +76,8 @@ MessagingPage::MessagingPage(const PlatformStyle *_platformStyle, QWidget *paren
     connect(ui->checkBoxEncrypt, &QCheckBox::toggled, this, &MessagingPage::onEncryptToggled);
 
     // Connect P2P Chat signals
-    connect(ui->listConversations, &QListWidget::itemClicked, this, &MessagingPage::onConversationSelected);
-    connect(ui->listConversations, &QListWidget::customContextMenuRequested, this, &MessagingPage::onConversationContextMenu);
+    connect(m_conversationView, &QListView::clicked, this, &MessagingPage::onConversationSelected);
+    connect(m_conversationView, &QListView::customContextMenuRequested, this, &MessagingPage::onConversationContextMenu);
     connect(ui->listPendingRequests, &QListWidget::itemClicked, this, &MessagingPage::onPendingRequestSelected);
     connect(ui->pushButtonSendP2P, &QPushButton::clicked, this, &MessagingPage::onSendP2PMessageClicked);
     connect(ui->pushButtonNewConversation, &QPushButton::clicked, this, &MessagingPage::onNewConversationClicked);
@@ -154,8 +156,10 @@ void MessagingPage::handleIncomingMessage(const messaging::EncryptedMessage& msg
     // We need this for fallback decryption which uses recipient address as key
     QString recipientAddress;
     wallet::CWallet* pwallet = walletModel ? walletModel->wallet().wallet() : nullptr;
-    if (pwallet) {
-        // Try legacy wallet first
+    if (auto it = m_addressByHash.find(msg.recipientHash); it != m_addressByHash.end()) {
+        recipientAddress = it->second;
+    } else if (pwallet) {
+        // Not a registered address: search the wallet, legacy keys first
         auto spk_man = pwallet->GetLegacyScriptPubKeyMan();
         if (spk_man) {
             for (const CKeyID& keyId : spk_man->GetKeys()) {
@@ -262,9 +266,6 @@ void MessagingPage::handleIncomingMessage(const messaging::EncryptedMessage& msg
 
     storeP2PMessage(storedMsg);
 
-    // Refresh the UI
-    updateConversationList();
-
     // Emit signal for notification
     Q_EMIT newMessageReceived(senderAddress, decryptedText.left(50));
 
@@ -303,6 +304,7 @@ void MessagingPage::registerWalletAddresses()
             sha.Finalize(addrHash.begin());
 
             messaging::g_message_manager->RegisterAddress(addrHash);
+            m_addressByHash[addrHash] = QString::fromStdString(addrStr);
             registered++;
         }
     }
@@ -323,6 +325,7 @@ void MessagingPage::registerWalletAddresses()
                     sha.Finalize(addrHash.begin());
 
                     messaging::g_message_manager->RegisterAddress(addrHash);
+                    m_addressByHash[addrHash] = QString::fromStdString(addrStr);
                     registered++;
                 }
             }
@@ -338,6 +341,28 @@ void MessagingPage::registerWalletAddresses()
 // JSON Storage Management
 // ============================================================================
 
+// Helper to load JSON from file
+static QJsonArray loadJsonArray(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonArray();
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    return doc.array();
+}
+
+// Helper to save JSON to file
+static bool saveJsonArray(const QString& filePath, const QJsonArray& array)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(array).toJson());
+    return true;
+}
+
 bool MessagingPage::initStorage()
 {
     if (m_storageInitialized) return true;
@@ -358,6 +383,9 @@ bool MessagingPage::initStorage()
         }
     }
 
+    // Load P2P messages
+    m_conversationModel->load(loadJsonArray(m_dataDir + "/p2p_messages.json"));
+
     // Load exchanged keys for encrypted chat
     loadExchangedKeys();
 
@@ -388,28 +416,6 @@ void MessagingPage::saveData()
     }
 }
 
-// Helper to load JSON from file
-static QJsonArray loadJsonArray(const QString& filePath)
-{
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return QJsonArray();
-    }
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    return doc.array();
-}
-
-// Helper to save JSON to file
-static bool saveJsonArray(const QString& filePath, const QJsonArray& array)
-{
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        return false;
-    }
-    file.write(QJsonDocument(array).toJson());
-    return true;
-}
-
 // ============================================================================
 // Tab Setup
 // ============================================================================
@@ -454,6 +460,19 @@ void MessagingPage::setupP2PTab()
     ui->lineEditChatMessage->setEnabled(false);
     ui->pushButtonSendP2P->setEnabled(false);
 
+    // Show conversations from a model, updated as messages arrive, in place
+    // of the form's item list
+    m_conversationModel = new P2PConversationModel([this](const QString& address) { return getAddressLabel(address); }, this);
+    m_conversationView = new QListView(this);
+    m_conversationView->setModel(m_conversationModel);
+    m_conversationView->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_conversationView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_conversationView->setUniformItemSizes(true);
+    if (QLayout* listLayout = ui->listConversations->parentWidget()->layout()) {
+        delete listLayout->replaceWidget(ui->listConversations, m_conversationView);
+    }
+    ui->listConversations->hide();
+
     // Create custom chat bubble widget (pure Qt Widgets, no QML dependencies)
     m_chatView = new ChatBubbleWidget(this);
     m_chatView->setMinimumHeight(200);
@@ -486,16 +505,6 @@ void MessagingPage::setupP2PTab()
     // Connect refresh identities button
     connect(ui->pushButtonRefreshIdentities, &QPushButton::clicked, this, &MessagingPage::refreshIdentities);
 
-    // Set up auto-refresh timer (every 3 seconds)
-    m_refreshTimer = new QTimer(this);
-    connect(m_refreshTimer, &QTimer::timeout, this, [this]() {
-        // Only refresh if we're on the P2P chat tab and have a conversation selected
-        if (ui->tabWidget->currentIndex() == 1 && !m_currentConversationPeer.isEmpty()) {
-            updateChatDisplay();
-            updateConversationList();
-        }
-    });
-    m_refreshTimer->start(3000); // 3 second interval
 }
 
 void MessagingPage::refreshIdentities()
@@ -902,11 +911,11 @@ void MessagingPage::updateOpReturnList()
 // P2P Encrypted Chat
 // ============================================================================
 
-void MessagingPage::onConversationSelected(QListWidgetItem* item)
+void MessagingPage::onConversationSelected(const QModelIndex& index)
 {
-    if (!item) return;
+    if (!index.isValid()) return;
 
-    m_currentConversationPeer = item->data(Qt::UserRole).toString();
+    m_currentConversationPeer = index.data(P2PConversationModel::AddressRole).toString();
     QString label = getAddressLabel(m_currentConversationPeer);
 
     if (label.isEmpty()) {
@@ -980,12 +989,10 @@ void MessagingPage::onNewConversationClicked()
     updateConversationList();
 
     // Select the new conversation
-    for (int i = 0; i < ui->listConversations->count(); i++) {
-        if (ui->listConversations->item(i)->data(Qt::UserRole).toString() == address) {
-            ui->listConversations->setCurrentRow(i);
-            onConversationSelected(ui->listConversations->item(i));
-            break;
-        }
+    const QModelIndex index = m_conversationModel->indexOf(address);
+    if (index.isValid()) {
+        m_conversationView->setCurrentIndex(index);
+        onConversationSelected(index);
     }
 }
 
@@ -999,10 +1006,10 @@ void MessagingPage::onRefreshP2PClicked()
 
 void MessagingPage::onConversationContextMenu(const QPoint& pos)
 {
-    QListWidgetItem* item = ui->listConversations->itemAt(pos);
-    if (!item) return;
+    const QModelIndex index = m_conversationView->indexAt(pos);
+    if (!index.isValid()) return;
 
-    QString address = item->data(Qt::UserRole).toString();
+    QString address = index.data(P2PConversationModel::AddressRole).toString();
     if (address.isEmpty()) return;
 
     QMenu menu(this);
@@ -1012,7 +1019,7 @@ void MessagingPage::onConversationContextMenu(const QPoint& pos)
     menu.addSeparator();
     QAction* deleteConvo = menu.addAction(tr("Delete Conversation"));
 
-    QAction* selected = menu.exec(ui->listConversations->mapToGlobal(pos));
+    QAction* selected = menu.exec(m_conversationView->viewport()->mapToGlobal(pos));
 
     if (selected == editLabel) {
         editConversationLabel(address);
@@ -1030,16 +1037,8 @@ void MessagingPage::onConversationContextMenu(const QPoint& pos)
 
         if (reply == QMessageBox::Yes) {
             // Remove messages for this peer from storage
-            QString filePath = m_dataDir + "/p2p_messages.json";
-            QJsonArray messages = loadJsonArray(filePath);
-            QJsonArray filtered;
-            for (const auto& m : messages) {
-                QJsonObject msg = m.toObject();
-                if (msg["peer_address"].toString() != address) {
-                    filtered.append(msg);
-                }
-            }
-            saveJsonArray(filePath, filtered);
+            m_conversationModel->removeConversation(address);
+            saveP2PMessages();
 
             if (m_currentConversationPeer == address) {
                 m_currentConversationPeer.clear();
@@ -1204,9 +1203,6 @@ bool MessagingPage::sendP2PMessage(const QString& toAddress, const QString& mess
 
 void MessagingPage::storeP2PMessage(const StoredMessage& msg)
 {
-    QString filePath = m_dataDir + "/p2p_messages.json";
-    QJsonArray messages = loadJsonArray(filePath);
-
     QString peerAddress = msg.isOutgoing ? msg.toAddress : msg.fromAddress;
 
     QJsonObject jsonMsg;
@@ -1217,10 +1213,18 @@ void MessagingPage::storeP2PMessage(const StoredMessage& msg)
     jsonMsg["timestamp"] = static_cast<qint64>(msg.timestamp);
     jsonMsg["is_outgoing"] = msg.isOutgoing;
     jsonMsg["is_read"] = msg.isRead;
-    messages.append(jsonMsg);
+    m_conversationModel->addMessage(jsonMsg);
+    saveP2PMessages();
+
+    if (peerAddress == m_currentConversationPeer) {
+        updateChatDisplay();
+    }
+}
 
-    if (!saveJsonArray(filePath, messages)) {
-        qWarning() << "Failed to store P2P message";
+void MessagingPage::saveP2PMessages()
+{
+    if (!saveJsonArray(m_dataDir + "/p2p_messages.json", m_conversationModel->toJson())) {
+        qWarning() << "Failed to store P2P messages";
     }
 }
 
@@ -1916,81 +1920,13 @@ QString MessagingPage::decryptMessage(const QByteArray& encrypted, const QString
 
 void MessagingPage::updateConversationList()
 {
-    if (!ui || !ui->listConversations) return;
-
-    ui->listConversations->clear();
-
-    QString filePath = m_dataDir + "/p2p_messages.json";
-    QJsonArray messages = loadJsonArray(filePath);
-
-    // Group by peer address
-    QMap<QString, int> peerUnread;
-    QMap<QString, qint64> peerLastTime;
-
-    for (const auto& m : messages) {
-        QJsonObject msg = m.toObject();
-        QString peerAddress = msg["peer_address"].toString();
-        qint64 timestamp = msg["timestamp"].toVariant().toLongLong();
-        bool isRead = msg["is_read"].toBool();
-        bool isOutgoing = msg["is_outgoing"].toBool();
-
-        if (!peerLastTime.contains(peerAddress) || timestamp > peerLastTime[peerAddress]) {
-            peerLastTime[peerAddress] = timestamp;
-        }
-        if (!isRead && !isOutgoing) {
-            peerUnread[peerAddress] = peerUnread.value(peerAddress, 0) + 1;
-        }
-    }
-
-    // Sort by last time
-    QList<QPair<QString, qint64>> sortedPeers;
-    for (auto it = peerLastTime.begin(); it != peerLastTime.end(); ++it) {
-        sortedPeers.append(qMakePair(it.key(), it.value()));
-    }
-    std::sort(sortedPeers.begin(), sortedPeers.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-
-    for (const auto& pair : sortedPeers) {
-        QString peerAddress = pair.first;
-        int unread = peerUnread.value(peerAddress, 0);
-
-        QString label = getAddressLabel(peerAddress);
-        QString displayText;
+    if (!m_conversationModel) return;
 
-        if (label.isEmpty()) {
-            displayText = peerAddress.left(12) + "..." + peerAddress.right(8);
-        } else {
-            displayText = label;
-        }
-
-        if (unread > 0) {
-            displayText += QString(" (%1)").arg(unread);
-        }
-
-        QListWidgetItem* item = new QListWidgetItem(displayText);
-        item->setData(Qt::UserRole, peerAddress);
-        ui->listConversations->addItem(item);
-    }
+    // The model follows the stored messages; only labels can be stale
+    m_conversationModel->refreshLabels();
 
     // Add current peer if not in list
-    if (!m_currentConversationPeer.isEmpty()) {
-        bool found = false;
-        for (int i = 0; i < ui->listConversations->count(); i++) {
-            if (ui->listConversations->item(i)->data(Qt::UserRole).toString() == m_currentConversationPeer) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            QString label = getAddressLabel(m_currentConversationPeer);
-            QString displayText = label.isEmpty() ?
-                (m_currentConversationPeer.left(12) + "..." + m_currentConversationPeer.right(8)) : label;
-
-            QListWidgetItem* item = new QListWidgetItem(displayText);
-            item->setData(Qt::UserRole, m_currentConversationPeer);
-            ui->listConversations->insertItem(0, item);
-        }
-    }
+    m_conversationModel->addConversation(m_currentConversationPeer);
 }
 
 void MessagingPage::updateChatDisplay()
@@ -2002,31 +1938,8 @@ void MessagingPage::updateChatDisplay()
         return;
     }
 
-    QString filePath = m_dataDir + "/p2p_messages.json";
-    QJsonArray messages = loadJsonArray(filePath);
-    bool needsSave = false;
-
-    // Sort messages by timestamp and filter by peer
-    QList<QJsonObject> peerMessages;
-    for (int i = 0; i < messages.size(); ++i) {
-        QJsonObject msg = messages[i].toObject();
-        if (msg["peer_address"].toString() == m_currentConversationPeer) {
-            peerMessages.append(msg);
-
-            // Mark as read
-            if (!msg["is_read"].toBool() && !msg["is_outgoing"].toBool()) {
-                msg["is_read"] = true;
-                messages[i] = msg;
-                needsSave = true;
-            }
-        }
-    }
-
-    // Sort by timestamp
-    std::sort(peerMessages.begin(), peerMessages.end(),
-              [](const QJsonObject& a, const QJsonObject& b) {
-                  return a["timestamp"].toVariant().toLongLong() < b["timestamp"].toVariant().toLongLong();
-              });
+    // Only the selected conversation's messages are built, already sorted
+    const QList<QJsonObject> peerMessages = m_conversationModel->messages(m_currentConversationPeer);
 
     // Update chat bubble widget with messages
     if (m_chatView) {
@@ -2047,8 +1960,8 @@ void MessagingPage::updateChatDisplay()
     }
 
     // Save if we marked messages as read
-    if (needsSave) {
-        saveJsonArray(filePath, messages);
+    if (m_conversationModel->markRead(m_currentConversationPeer)) {
+        saveP2PMessages();
     }
 }
 
@@ -2435,11 +2348,6 @@ void MessagingPage::onPendingRequestSelected(QListWidgetItem* item)
                      "Accept and start encrypted messaging?").arg(displayFrom);
     }
 
-    // Stop the refresh timer during this operation to prevent race conditions
-    if (m_refreshTimer) {
-        m_refreshTimer->stop();
-    }
-
     QMessageBox::StandardButton reply = QMessageBox::question(this,
         tr("Secure Chat Request"), message,
         QMessageBox::Yes | QMessageBox::No);
@@ -2449,11 +2357,6 @@ void MessagingPage::onPendingRequestSelected(QListWidgetItem* item)
     } else {
         rejectChatRequest(request);
     }
-
-    // Restart the refresh timer
-    if (m_refreshTimer) {
-        m_refreshTimer->start(3000);
-    }
 }
 
 void MessagingPage::loadPendingRequests()
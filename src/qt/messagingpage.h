@@ -18,10 +18,12 @@
 #include <QTimer>
 #include <QColor>
 #include <QMenu>
+#include <map>
 #include <memory>
 
 class ClientModel;
 class ChatBubbleWidget;
+class P2PConversationModel;
 class WalletModel;
 class PlatformStyle;
 
@@ -30,7 +32,9 @@ namespace Ui {
 }
 
 QT_BEGIN_NAMESPACE
+class QListView;
 class QListWidgetItem;
+class QModelIndex;
 class QTableWidgetItem;
 QT_END_NAMESPACE
 
@@ -164,7 +168,7 @@ private Q_SLOTS:
     void onEncryptToggled(bool checked);
 
     // P2P Chat tab
-    void onConversationSelected(QListWidgetItem* item);
+    void onConversationSelected(const QModelIndex& index);
     void onSendP2PMessageClicked();
     void onNewConversationClicked();
     void onRefreshP2PClicked();
@@ -199,8 +203,13 @@ private:
 
     // Current conversation state
     QString m_currentConversationPeer;
-    std::vector<StoredMessage> m_currentChatMessages;
-    std::vector<ChatConversation> m_conversations;
+
+    // P2P messages by conversation, loaded once from the message file
+    P2PConversationModel* m_conversationModel{nullptr};
+    QListView* m_conversationView{nullptr};
+
+    // Our address for each registered recipient hash
+    std::map<uint256, QString> m_addressByHash;
 
     // Contact labels (address -> label)
     QMap<QString, QString> m_contactLabels;
@@ -211,9 +220,6 @@ private:
     // Handshake status: 0=none, 1=requested, 2=accepted
     QMap<QString, int> m_handshakeStatus;
 
-    // Auto-refresh timer for chat
-    QTimer* m_refreshTimer{nullptr};
-
     // Custom chat bubble widget (pure Qt, no QML dependencies)
     ChatBubbleWidget* m_chatView{nullptr};
 
@@ -256,6 +262,7 @@ private:
     std::vector<StoredMessage> getP2PMessages(const QString& peerAddress);
     std::vector<ChatConversation> getConversations();
     void storeP2PMessage(const StoredMessage& msg);
+    void saveP2PMessages();
 
     // Key exchange handshake methods
     bool sendHandshakeRequest(const QString& toAddress);
@@ -16,6 +16,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <util/time.h>
+#include <node/mining_stats.h>
 #include <node/randomx_miner.h>
 #include <pow.h>
 #include <util/strencodings.h>
@@ -959,10 +960,11 @@ void MiningPage::updateMiningStats()
 {
     if (!isMining) return;
 
-    // Update hashrate and stats from miner
-    node::RandomXMiner& miner = node::GetRandomXMiner();
-    double hashrate = miner.GetHashrate();
-    uint64_t totalHashes = miner.GetTotalHashes();
+    // Update hashrate and stats from one snapshot of the miners' counters,
+    // which never blocks the mining threads
+    const node::MiningStats stats = node::GetMiningStats();
+    double hashrate = stats.hashrate;
+    uint64_t totalHashes = stats.total_hashes;
 
     onMiningHashrate(hashrate, totalHashes);
 
@@ -0,0 +1,211 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qt/p2pconversationmodel.h>
+
+#include <QMap>
+
+#include <algorithm>
+
+static qint64 MessageTime(const QJsonObject& msg)
+{
+    return msg["timestamp"].toVariant().toLongLong();
+}
+
+static bool IsUnread(const QJsonObject& msg)
+{
+    return !msg["is_read"].toBool() && !msg["is_outgoing"].toBool();
+}
+
+P2PConversationModel::P2PConversationModel(LabelLookup label_lookup, QObject* parent) :
+    QAbstractListModel(parent),
+    m_label_lookup(std::move(label_lookup))
+{
+}
+
+int P2PConversationModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_conversations.size();
+}
+
+QVariant P2PConversationModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_conversations.size()) {
+        return QVariant();
+    }
+    const Conversation& conversation = m_conversations[index.row()];
+
+    switch (role) {
+    case Qt::DisplayRole: {
+        const QString label = m_label_lookup ? m_label_lookup(conversation.peer) : QString();
+        QString text = label.isEmpty() ? (conversation.peer.left(12) + "..." + conversation.peer.right(8)) : label;
+        if (conversation.unread > 0) {
+            text += QString(" (%1)").arg(conversation.unread);
+        }
+        return text;
+    }
+    case Qt::ToolTipRole:
+    case AddressRole:
+        return conversation.peer;
+    case UnreadRole:
+        return conversation.unread;
+    case LastTimeRole:
+        return conversation.last_time;
+    }
+    return QVariant();
+}
+
+void P2PConversationModel::load(const QJsonArray& messages)
+{
+    QMap<QString, Conversation> by_peer;
+    for (const auto& m : messages) {
+        const QJsonObject msg = m.toObject();
+        const QString peer = msg["peer_address"].toString();
+        Conversation& conversation = by_peer[peer];
+        conversation.peer = peer;
+        conversation.last_time = std::max(conversation.last_time, MessageTime(msg));
+        if (IsUnread(msg)) ++conversation.unread;
+        conversation.messages.append(msg);
+    }
+
+    beginResetModel();
+    m_conversations.clear();
+    for (Conversation& conversation : by_peer) {
+        std::stable_sort(conversation.messages.begin(), conversation.messages.end(),
+                         [](const QJsonObject& a, const QJsonObject& b) { return MessageTime(a) < MessageTime(b); });
+        m_conversations.append(std::move(conversation));
+    }
+    std::stable_sort(m_conversations.begin(), m_conversations.end(),
+                     [](const Conversation& a, const Conversation& b) { return a.last_time > b.last_time; });
+    endResetModel();
+}
+
+QJsonArray P2PConversationModel::toJson() const
+{
+    QJsonArray result;
+    for (const Conversation& conversation : m_conversations) {
+        for (const QJsonObject& msg : conversation.messages) {
+            result.append(msg);
+        }
+    }
+    return result;
+}
+
+void P2PConversationModel::addMessage(const QJsonObject& msg)
+{
+    const QString peer = msg["peer_address"].toString();
+    const qint64 time = MessageTime(msg);
+
+    int row = findRow(peer);
+    if (row < 0) {
+        beginInsertRows(QModelIndex(), m_conversations.size(), m_conversations.size());
+        Conversation conversation;
+        conversation.peer = peer;
+        m_conversations.append(std::move(conversation));
+        endInsertRows();
+        row = m_conversations.size() - 1;
+    }
+
+    // Messages almost always arrive in order, so this is an append
+    Conversation& conversation = m_conversations[row];
+    auto pos = std::upper_bound(conversation.messages.begin(), conversation.messages.end(), time,
+                                [](qint64 t, const QJsonObject& m) { return t < MessageTime(m); });
+    conversation.messages.insert(pos, msg);
+    conversation.last_time = std::max(conversation.last_time, time);
+    if (IsUnread(msg)) ++conversation.unread;
+
+    row = moveUp(row);
+    Q_EMIT dataChanged(index(row), index(row));
+}
+
+QList<QJsonObject> P2PConversationModel::messages(const QString& peer) const
+{
+    const int row = findRow(peer);
+    return row < 0 ? QList<QJsonObject>() : m_conversations[row].messages;
+}
+
+bool P2PConversationModel::markRead(const QString& peer)
+{
+    const int row = findRow(peer);
+    if (row < 0 || m_conversations[row].unread == 0) {
+        return false;
+    }
+
+    Conversation& conversation = m_conversations[row];
+    for (QJsonObject& msg : conversation.messages) {
+        if (IsUnread(msg)) {
+            msg["is_read"] = true;
+        }
+    }
+    conversation.unread = 0;
+    Q_EMIT dataChanged(index(row), index(row));
+    return true;
+}
+
+void P2PConversationModel::addConversation(const QString& peer)
+{
+    if (peer.isEmpty() || findRow(peer) >= 0) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), 0, 0);
+    Conversation conversation;
+    conversation.peer = peer;
+    m_conversations.prepend(std::move(conversation));
+    endInsertRows();
+}
+
+void P2PConversationModel::removeConversation(const QString& peer)
+{
+    const int row = findRow(peer);
+    if (row < 0) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_conversations.removeAt(row);
+    endRemoveRows();
+}
+
+QModelIndex P2PConversationModel::indexOf(const QString& peer) const
+{
+    const int row = findRow(peer);
+    return row < 0 ? QModelIndex() : index(row);
+}
+
+void P2PConversationModel::refreshLabels()
+{
+    if (!m_conversations.isEmpty()) {
+        Q_EMIT dataChanged(index(0), index(m_conversations.size() - 1), {Qt::DisplayRole});
+    }
+}
+
+int P2PConversationModel::findRow(const QString& peer) const
+{
+    for (int row = 0; row < m_conversations.size(); ++row) {
+        if (m_conversations[row].peer == peer) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+int P2PConversationModel::moveUp(int row)
+{
+    int dest = row;
+    while (dest > 0 && m_conversations[dest - 1].last_time < m_conversations[row].last_time) {
+        --dest;
+    }
+    if (dest == row) {
+        return row;
+    }
+
+    beginMoveRows(QModelIndex(), row, row, QModelIndex(), dest);
+    m_conversations.move(row, dest);
+    endMoveRows();
+    return dest;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_QT_P2PCONVERSATIONMODEL_H
+#define WATTX_QT_P2PCONVERSATIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+/**
+ * Qt model of the P2P chat conversations, newest first, for the messaging page.
+ *
+ * Holds the stored P2P messages grouped by peer, loaded once from the message
+ * file. New messages update their conversation's row in place, so the list
+ * view only repaints the rows that changed and the chat view only builds the
+ * messages of the selected conversation.
+ */
+class P2PConversationModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    using LabelLookup = std::function<QString(const QString&)>;
+
+    explicit P2PConversationModel(LabelLookup label_lookup, QObject* parent = nullptr);
+
+    enum RoleIndex {
+        /** Peer address of the conversation */
+        AddressRole = Qt::UserRole,
+        /** Number of unread incoming messages */
+        UnreadRole,
+        /** Timestamp of the last message */
+        LastTimeRole
+    };
+
+    /** @name Methods overridden from QAbstractListModel
+        @{*/
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    /*@}*/
+
+    /** Replace the messages, as stored in the message file */
+    void load(const QJsonArray& messages);
+    /** The messages, in the message file format */
+    QJsonArray toJson() const;
+
+    /** Add a message, moving its conversation to the top */
+    void addMessage(const QJsonObject& msg);
+    /** Messages with a peer, oldest first */
+    QList<QJsonObject> messages(const QString& peer) const;
+    /** Mark the incoming messages from a peer read; returns whether any were unread */
+    bool markRead(const QString& peer);
+
+    /** Add an empty conversation at the top, if there's none with the peer */
+    void addConversation(const QString& peer);
+    /** Remove a conversation with its messages */
+    void removeConversation(const QString& peer);
+    QModelIndex indexOf(const QString& peer) const;
+
+    /** Contact labels changed */
+    void refreshLabels();
+
+private:
+    struct Conversation {
+        QString peer;
+        qint64 last_time{0};
+        int unread{0};
+        QList<QJsonObject> messages;
+    };
+
+    LabelLookup m_label_lookup;
+    QList<Conversation> m_conversations;
+
+    int findRow(const QString& peer) const;
+    //! Move a conversation whose last message got newer up to its place
+    int moveUp(int row);
+};
+
+#endif // WATTX_QT_P2PCONVERSATIONMODEL_H
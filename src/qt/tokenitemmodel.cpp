@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <consensus/consensus.h>
 #include <chainparams.h>
+#include <util/convert.h>
 
 #include <QDateTime>
 #include <QFont>
@@ -93,6 +94,9 @@ private Q_SLOTS:
             // Find the token tx in the wallet
             tokenInfo = walletModel->wallet().getToken(tokenHash);
             found = tokenInfo.hash == tokenHash;
+            // The wallet records the transfers from the logs of each block once the search has caught up
+            if(found && tokenInfo.block_hash == blockHash)
+                return;
             if(found)
             {
                 // Get the start location for search the event log
@@ -158,6 +162,16 @@ private Q_SLOTS:
         if(walletModel && walletModel->node().shutdownRequested())
             return;
 
+        // The wallet keeps a balance current from the block logs once it is seeded
+        uint256 tokenHash = uint256::FromHex(hash.toStdString()).value_or(uint256::ZERO);
+        uint256 watchedBalance;
+        if(walletModel && walletModel->wallet().getTokenBalance(tokenHash, watchedBalance))
+        {
+            Q_EMIT balanceChanged(hash, QString::fromStdString(uintTou256(watchedBalance).str()));
+            return;
+        }
+
+        uint256 tipHash = walletModel ? walletModel->node().getBestBlockHash() : uint256();
         tokenAbi.setAddress(contractAddress.toStdString());
         tokenAbi.setSender(senderAddress.toStdString());
         std::string strBalance;
@@ -165,12 +179,27 @@ private Q_SLOTS:
         {
             QString balance = QString::fromStdString(strBalance);
             Q_EMIT balanceChanged(hash, balance);
+
+            // Seed the wallet's balance if the tip did not move during the call
+            if(walletModel && walletModel->node().getBestBlockHash() == tipHash)
+            {
+                walletModel->wallet().setTokenBalance(tokenHash, u256Touint(dev::u256(strBalance)), tipHash);
+            }
         }
     }
 
+    void finishUpdates()
+    {
+        // Queued after the updates of a refresh, so all of them are done
+        Q_EMIT updatesFinished();
+    }
+
 Q_SIGNALS:
     // Signal that balance in token changed
     void balanceChanged(QString hash, QString balance);
+
+    // Signal that the updates of a refresh are done
+    void updatesFinished();
 };
 
 #include <qt/tokenitemmodel.moc>
@@ -274,15 +303,12 @@ public:
         updated.SetHexDeprecated(hash.toStdString());
         dev::s256 val(balance.toStdString());
 
-        for(int i = 0; i < cachedTokenItem.size(); i++)
+        QList<TokenItemEntry>::iterator it = std::lower_bound(
+            cachedTokenItem.begin(), cachedTokenItem.end(), updated, TokenItemEntryLessThan());
+        if(it != cachedTokenItem.end() && it->hash == updated && it->balance != val)
         {
-            TokenItemEntry item = cachedTokenItem[i];
-            if(item.hash == updated && item.balance != val)
-            {
-                item.balance = val;
-                cachedTokenItem[i] = item;
-                return i;
-            }
+            it->balance = val;
+            return it - cachedTokenItem.begin();
         }
 
         return -1;
@@ -311,7 +337,9 @@ TokenItemModel::TokenItemModel(WalletModel *parent):
     walletModel(parent),
     priv(0),
     worker(0),
-    tokenTxCleaned(false)
+    tokenTxCleaned(false),
+    updatesPending(false),
+    checkPending(false)
 {
     columns << tr("Token Name") << tr("Token Symbol") << tr("Balance");
 
@@ -322,6 +350,7 @@ TokenItemModel::TokenItemModel(WalletModel *parent):
     worker->tokenAbi.setModel(walletModel);
     worker->moveToThread(&(t));
     connect(worker, &TokenTxWorker::balanceChanged, this, &TokenItemModel::balanceChanged);
+    connect(worker, &TokenTxWorker::updatesFinished, this, &TokenItemModel::updatesFinished);
 
     t.start();
 
@@ -448,6 +477,13 @@ void TokenItemModel::checkTokenBalanceChanged()
     if(!priv)
         return;
 
+    // Blocks that come in while the worker is still busy are coalesced into one more refresh
+    if(updatesPending)
+    {
+        checkPending = true;
+        return;
+    }
+
     // Update token balance
     for(int i = 0; i < priv->cachedTokenItem.size(); i++)
     {
@@ -474,6 +510,19 @@ void TokenItemModel::checkTokenBalanceChanged()
             QMetaObject::invokeMethod(worker, "cleanTokenTxEntries", Qt::QueuedConnection);
         }
     }
+
+    updatesPending = true;
+    QMetaObject::invokeMethod(worker, "finishUpdates", Qt::QueuedConnection);
+}
+
+void TokenItemModel::updatesFinished()
+{
+    updatesPending = false;
+    if(checkPending)
+    {
+        checkPending = false;
+        checkTokenBalanceChanged();
+    }
 }
 
 void TokenItemModel::emitDataChanged(int idx)
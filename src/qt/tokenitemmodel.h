@@ -60,6 +60,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void updateToken(const QString &hash, int status, bool showToken);
+    void updatesFinished();
 
 private:
     /** Notify listeners that data changed. */
@@ -75,6 +76,8 @@ private:
     QThread t;
     std::unique_ptr<interfaces::Handler> m_handler_token_changed;
     bool tokenTxCleaned;
+    bool updatesPending;
+    bool checkPending;
 
     friend class TokenItemPriv;
 };
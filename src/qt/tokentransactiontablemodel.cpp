@@ -292,10 +292,24 @@ void TokenTransactionTableModel::updateConfirmations()
 {
     // Blocks came in since last poll.
     // Invalidate status (number of confirmations) and (possibly) description
-    //  for all rows. Qt is smart enough to only actually request the data for the
-    //  visible rows.
-    Q_EMIT dataChanged(index(0, Status), index(priv->size()-1, Status));
-    Q_EMIT dataChanged(index(0, ToAddress), index(priv->size()-1, ToAddress));
+    //  of the rows that were not confirmed yet, the rows of confirmed transactions
+    //  do not change with more blocks. Each run of rows is one signal, so that the
+    //  proxy does not re-sort the whole table on every block.
+    int first = -1;
+    for(int i = 0; i <= priv->size(); i++)
+    {
+        bool confirming = i < priv->size() && priv->cachedWallet[i].status.status != TokenTransactionStatus::Confirmed;
+        if(confirming && first == -1)
+        {
+            first = i;
+        }
+        else if(!confirming && first != -1)
+        {
+            Q_EMIT dataChanged(index(first, Status), index(i-1, Status));
+            Q_EMIT dataChanged(index(first, ToAddress), index(i-1, ToAddress));
+            first = -1;
+        }
+    }
 }
 
 int TokenTransactionTableModel::rowCount(const QModelIndex &parent) const
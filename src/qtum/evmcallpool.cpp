@@ -0,0 +1,238 @@
+#include <qtum/evmcallpool.h>
+
+#include <chainparams.h>
+#include <qtum/qtumDGP.h>
+#include <util/convert.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <optional>
+
+EvmStateSnapshot::EvmStateSnapshot(Chainstate& chainstate, CBlockIndex& index)
+    : m_index(&index),
+      m_schedule(globalSealEngine->getQtumSchedule()),
+      m_db(globalState->db()),
+      m_db_utxo(globalState->dbUtxo()),
+      m_state_root(uintToh256(index.hashStateRoot)),
+      m_utxo_root(uintToh256(index.hashUTXORoot)),
+      m_chain(std::make_unique<CChain>())
+{
+    AssertLockHeld(cs_main);
+
+    // Only the coinbase and coinstake are needed for the environment
+    chainstate.m_blockman.ReadBlock(m_block, index);
+    if (m_block.IsProofOfStake())
+        m_block.vtx.erase(m_block.vtx.begin() + 2, m_block.vtx.end());
+    else
+        m_block.vtx.erase(m_block.vtx.begin() + 1, m_block.vtx.end());
+
+    QtumDGP qtumDGP(globalState.get(), chainstate, fGettingValuesDGP);
+    m_block_gas_limit = qtumDGP.getBlockGasLimit(index.nHeight + 1);
+
+    m_chain->SetTip(index);
+}
+
+std::unique_ptr<QtumState> EvmStateSnapshot::MakeState() const
+{
+    auto state = std::make_unique<QtumState>(dev::u256(0), m_db, m_db_utxo);
+    state->setRoot(m_state_root);
+    state->setRootUTXO(m_utxo_root);
+    return state;
+}
+
+EvmCallPool::EvmCallPool(size_t contexts)
+    : m_contexts(std::max<size_t>(contexts, 1))
+{
+}
+
+std::shared_ptr<const EvmStateSnapshot> EvmCallPool::GetSnapshot(Chainstate& chainstate, int height)
+{
+    LOCK(cs_main);
+    CBlockIndex* pindex = height < 0 ? chainstate.m_chain.Tip() : chainstate.m_chain[height];
+    if (!pindex || !globalState) return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_snapshots.begin(); it != m_snapshots.end(); ++it) {
+        if (&(*it)->Index() == pindex) {
+            m_snapshots.splice(m_snapshots.begin(), m_snapshots, it);
+            return m_snapshots.front();
+        }
+    }
+
+    m_snapshots.push_front(std::make_shared<const EvmStateSnapshot>(chainstate, *pindex));
+    if (m_snapshots.size() > MAX_SNAPSHOTS) {
+        m_snapshots.pop_back();
+    }
+    return m_snapshots.front();
+}
+
+static dev::Address CallSender(const dev::Address& sender)
+{
+    return sender == dev::Address() ? dev::Address("ffffffffffffffffffffffffffffffffffffffff") : sender;
+}
+
+CBlock EvmCallPool::MakeCallBlock(const EvmStateSnapshot& snapshot, const dev::Address& sender, CAmount nAmount) const
+{
+    CBlock block = snapshot.m_block;
+    block.nTime = TicksSinceEpoch<std::chrono::seconds>(NodeClock::now());
+
+    CMutableTransaction tx;
+    tx.vout.push_back(CTxOut(nAmount, CScript() << OP_DUP << OP_HASH160 << CallSender(sender).asBytes() << OP_EQUALVERIFY << OP_CHECKSIG));
+    block.vtx.push_back(MakeTransactionRef(CTransaction(tx)));
+    return block;
+}
+
+std::vector<ResultExecute> EvmCallPool::Execute(const EvmStateSnapshot& snapshot, const CBlock& block, dev::eth::SealEngineFace& engine,
+                                                const dev::Address& addrContract, const std::vector<unsigned char>& opcode,
+                                                const dev::Address& sender, uint64_t gasLimit, CAmount nAmount, bool recordStats)
+{
+    const dev::Address senderAddress = CallSender(sender);
+    std::unique_ptr<QtumState> state = snapshot.MakeState();
+    dev::u256 nonce = state->getNonce(senderAddress);
+
+    QtumTransaction callTransaction;
+    if (addrContract == dev::Address()) {
+        callTransaction = QtumTransaction(nAmount, 1, dev::u256(gasLimit), opcode, nonce);
+    } else {
+        callTransaction = QtumTransaction(nAmount, 1, dev::u256(gasLimit), addrContract, opcode, nonce);
+    }
+    callTransaction.forceSender(senderAddress);
+    callTransaction.setVersion(VersionVM::GetEVMDefault());
+
+    engine.setQtumSchedule(snapshot.m_schedule);
+    ByteCodeExec exec(block, std::vector<QtumTransaction>(1, callTransaction), snapshot.m_block_gas_limit,
+                      snapshot.m_index, *snapshot.m_chain, *state, engine);
+    if (recordStats) exec.setStatsSource(EvmStatsSource::CALL);
+    exec.performByteCode(dev::eth::Permanence::Reverted);
+    return std::move(exec.getResult());
+}
+
+std::vector<ResultExecute> EvmCallPool::Call(const EvmStateSnapshot& snapshot, const dev::Address& addrContract, std::vector<unsigned char> opcode,
+                                             const dev::Address& sender, uint64_t gasLimit, CAmount nAmount)
+{
+    if (gasLimit == 0) {
+        gasLimit = snapshot.m_block_gas_limit - 1;
+    }
+    const CBlock block = MakeCallBlock(snapshot, sender, nAmount);
+
+    std::unique_ptr<dev::eth::SealEngineFace> engine = AcquireEngine();
+    try {
+        std::vector<ResultExecute> result = Execute(snapshot, block, *engine, addrContract, opcode, sender, gasLimit, nAmount, /*recordStats=*/true);
+        ReleaseEngine(std::move(engine));
+        return result;
+    } catch (...) {
+        ReleaseEngine(std::move(engine));
+        throw;
+    }
+}
+
+EvmGasEstimate EvmCallPool::EstimateGas(const EvmStateSnapshot& snapshot, const dev::Address& addrContract, const std::vector<unsigned char>& opcode,
+                                        const dev::Address& sender, uint64_t gasCap, CAmount nAmount)
+{
+    EvmGasEstimate estimate;
+    if (gasCap == 0 || gasCap >= snapshot.m_block_gas_limit) {
+        gasCap = snapshot.m_block_gas_limit - 1;
+    }
+    const CBlock block = MakeCallBlock(snapshot, sender, nAmount);
+
+    std::unique_ptr<dev::eth::SealEngineFace> engine = AcquireEngine();
+    try {
+        // Result of an execution at a gas limit, nullopt if it failed
+        auto execute = [&](uint64_t gasLimit) -> std::optional<dev::eth::ExecutionResult> {
+            ++estimate.executions;
+            std::vector<ResultExecute> result = Execute(snapshot, block, *engine, addrContract, opcode, sender, gasLimit, nAmount, /*recordStats=*/false);
+            if (result.empty()) return std::nullopt;
+            if (gasLimit == gasCap) estimate.capResult = result[0].execRes;
+            if (result[0].execRes.excepted != dev::eth::TransactionException::None) return std::nullopt;
+            return result[0].execRes;
+        };
+
+        std::optional<dev::eth::ExecutionResult> atCap = execute(gasCap);
+        if (!atCap) {
+            ReleaseEngine(std::move(engine));
+            estimate.gas = gasCap;
+            return estimate;
+        }
+        estimate.success = true;
+
+        // The limit must cover the gas used before refunds, and inner calls
+        // only get 63/64 of what is left, so pad the gas used for both
+        const uint64_t gasUsed = static_cast<uint64_t>(atCap->gasUsed);
+        const uint64_t gasRefunded = static_cast<uint64_t>(std::min<dev::u256>(atCap->gasRefunded, gasCap));
+        uint64_t lo = gasUsed > 0 ? gasUsed - 1 : 0;
+        uint64_t hi = gasCap;
+        const uint64_t optimistic = std::min<uint64_t>((gasUsed + gasRefunded + 2300) * 64 / 63, gasCap);
+        if (optimistic < hi) {
+            if (execute(optimistic)) {
+                hi = optimistic;
+            } else {
+                lo = optimistic;
+            }
+        }
+
+        while (lo + 1 < hi && (hi - lo) * 1000 / hi > ESTIMATE_GAS_PRECISION) {
+            // Bias towards the lower bound, most calls need little more than they use
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (lo > 0 && mid > lo * 2) mid = lo * 2;
+            if (execute(mid)) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        estimate.gas = hi;
+        ReleaseEngine(std::move(engine));
+        return estimate;
+    } catch (...) {
+        ReleaseEngine(std::move(engine));
+        throw;
+    }
+}
+
+void EvmCallPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_snapshots.clear();
+}
+
+std::unique_ptr<dev::eth::SealEngineFace> EvmCallPool::AcquireEngine()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_engine_cv.wait(lock, [&] { return !m_idle_engines.empty() || m_engines_created < m_contexts; });
+        if (!m_idle_engines.empty()) {
+            std::unique_ptr<dev::eth::SealEngineFace> engine = std::move(m_idle_engines.back());
+            m_idle_engines.pop_back();
+            return engine;
+        }
+        ++m_engines_created;
+    }
+
+    // Built outside the lock, parsing the genesis info takes a while
+    try {
+        dev::eth::ChainParams cp(Params().EVMGenesisInfo());
+        return std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_engines_created;
+        }
+        m_engine_cv.notify_one();
+        throw;
+    }
+}
+
+void EvmCallPool::ReleaseEngine(std::unique_ptr<dev::eth::SealEngineFace> engine)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle_engines.push_back(std::move(engine));
+    }
+    m_engine_cv.notify_one();
+}
+
+EvmCallPool& GetEvmCallPool()
+{
+    static EvmCallPool pool;
+    return pool;
+}
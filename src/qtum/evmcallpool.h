@@ -0,0 +1,133 @@
+#ifndef QTUM_EVMCALLPOOL_H
+#define QTUM_EVMCALLPOOL_H
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <qtum/qtumstate.h>
+#include <validation.h>
+
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * EVM state as of one block, for read-only calls
+ *
+ * Holds copies of globalState's databases pinned to the block's
+ * hashStateRoot and hashUTXORoot, plus everything else a call reads from
+ * the node: the block for the EVM environment, the DGP block gas limit and
+ * gas schedule, and the chain up to the block. Once created it is immutable
+ * and needs no lock, since trie nodes under a committed root are never
+ * rewritten and LevelDB serves reads concurrently with block connection.
+ */
+class EvmStateSnapshot {
+public:
+    EvmStateSnapshot(Chainstate& chainstate, CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    // New state over the snapshot's databases; cheap, so one per call
+    std::unique_ptr<QtumState> MakeState() const;
+
+    const CBlockIndex& Index() const { return *m_index; }
+
+private:
+    friend class EvmCallPool;
+
+    CBlockIndex* m_index;
+    CBlock m_block;
+    uint64_t m_block_gas_limit{0};
+    dev::eth::EVMSchedule m_schedule;
+    dev::OverlayDB m_db;
+    dev::OverlayDB m_db_utxo;
+    dev::h256 m_state_root;
+    dev::h256 m_utxo_root;
+    std::unique_ptr<CChain> m_chain;
+};
+
+/**
+ * Result of EvmCallPool::EstimateGas()
+ */
+struct EvmGasEstimate {
+    //! The call succeeded at the cap
+    bool success{false};
+    //! Lowest gas limit found to succeed, or the cap if the call failed
+    uint64_t gas{0};
+    //! Result of the execution at the cap, for the failure reason
+    dev::eth::ExecutionResult capResult;
+    //! Executions the search took
+    unsigned int executions{0};
+};
+
+/**
+ * Runs eth_call and callcontract without holding cs_main
+ *
+ * Calls used to reset the roots of globalState and execute on it under
+ * cs_main, so they serialized with each other and with block connection.
+ * Here each call executes on its own QtumState over an EvmStateSnapshot,
+ * on the calling RPC thread, with one of a bounded set of seal engines
+ * (the engine carries per-execution scratch state). cs_main is only taken
+ * to look up the block and, once per block, to create its snapshot.
+ */
+class EvmCallPool {
+public:
+    /** Calls executing at once; further callers wait for a free engine */
+    static constexpr size_t DEFAULT_CONTEXTS = 4;
+    /** Snapshots kept, most recently used first */
+    static constexpr size_t MAX_SNAPSHOTS = 4;
+
+    explicit EvmCallPool(size_t contexts = DEFAULT_CONTEXTS);
+
+    /**
+     * Snapshot of the state after the block at `height` of the active
+     * chain, or after the tip if negative. Takes cs_main.
+     * @return nullptr if there is no such block
+     */
+    std::shared_ptr<const EvmStateSnapshot> GetSnapshot(Chainstate& chainstate, int height = -1);
+
+    /** Execute a call on a snapshot; same arguments and results as CallContract() */
+    std::vector<ResultExecute> Call(const EvmStateSnapshot& snapshot, const dev::Address& addrContract, std::vector<unsigned char> opcode,
+                                    const dev::Address& sender = dev::Address(), uint64_t gasLimit = 0, CAmount nAmount = 0);
+
+    /**
+     * Find the lowest gas limit the call succeeds with, by binary search
+     * between the gas used at `gasCap` and `gasCap`
+     *
+     * All executions run on the same snapshot with the same engine, so they
+     * see exactly the same state and share the warmed database and code
+     * analysis caches. Most calls need no search: the gas used at the cap,
+     * padded for refunds and 63/64 forwarding, is tried first and ends it.
+     * The search stops once the bounds are within ESTIMATE_GAS_PRECISION.
+     */
+    EvmGasEstimate EstimateGas(const EvmStateSnapshot& snapshot, const dev::Address& addrContract, const std::vector<unsigned char>& opcode,
+                               const dev::Address& sender, uint64_t gasCap, CAmount nAmount = 0);
+
+    /** Relative precision, in thousandths, at which EstimateGas stops the search */
+    static constexpr uint64_t ESTIMATE_GAS_PRECISION = 15;
+
+    /** Drop cached snapshots; must be called before globalState is reset */
+    void Clear();
+
+private:
+    CBlock MakeCallBlock(const EvmStateSnapshot& snapshot, const dev::Address& sender, CAmount nAmount) const;
+    std::vector<ResultExecute> Execute(const EvmStateSnapshot& snapshot, const CBlock& block, dev::eth::SealEngineFace& engine,
+                                       const dev::Address& addrContract, const std::vector<unsigned char>& opcode,
+                                       const dev::Address& sender, uint64_t gasLimit, CAmount nAmount, bool recordStats);
+    std::unique_ptr<dev::eth::SealEngineFace> AcquireEngine();
+    void ReleaseEngine(std::unique_ptr<dev::eth::SealEngineFace> engine);
+
+    const size_t m_contexts;
+
+    std::mutex m_mutex;
+    std::condition_variable m_engine_cv;
+    size_t m_engines_created{0};
+    std::vector<std::unique_ptr<dev::eth::SealEngineFace>> m_idle_engines;
+    std::list<std::shared_ptr<const EvmStateSnapshot>> m_snapshots;
+};
+
+/**
+ * Global pool for read-only calls
+ */
+EvmCallPool& GetEvmCallPool();
+
+#endif // QTUM_EVMCALLPOOL_H
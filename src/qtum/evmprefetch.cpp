@@ -0,0 +1,251 @@
+#include <qtum/evmprefetch.h>
+
+#include <chainparams.h>
+#include <tinyformat.h>
+#include <util/thread.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <optional>
+
+std::unique_ptr<MempoolEvmWarmer> g_mempool_evm_warmer;
+
+namespace {
+/** Each worker has its own seal engine, which keeps per-execution scratch state */
+std::unique_ptr<dev::eth::SealEngineFace> MakeSealEngine(const dev::eth::EVMSchedule& schedule)
+{
+    dev::eth::ChainParams cp(Params().EVMGenesisInfo());
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine(cp.createSealEngine());
+    sealEngine->setQtumSchedule(schedule);
+    return sealEngine;
+}
+
+/** Warm what the transactions show without executing them, see EvmStatePrefetcher */
+void WarmAccounts(QtumState& state, const std::vector<QtumTransaction>& execution, const std::atomic<bool>& stop)
+{
+    for (const QtumTransaction& tx : execution) {
+        if (stop) return;
+        state.balance(tx.sender());
+        if (tx.isCreation() || !state.addressInUse(tx.receiveAddress())) continue;
+        const dev::Address& contract = tx.receiveAddress();
+        for (const dev::u256& key : EvmStatePrefetcher::ConstantStorageKeys(state.code(contract), EvmStatePrefetcher::MAX_CONSTANT_SLOTS)) {
+            state.storage(contract, key);
+        }
+    }
+}
+} // namespace
+
+EvmStatePrefetcher::EvmStatePrefetcher(const CBlock& block, CBlockIndex* pindexPrev, CChain& chain, uint64_t blockGasLimit,
+                                       std::vector<std::vector<QtumTransaction>> executions, int threads)
+    : m_block(block),
+      m_pindex(pindexPrev),
+      m_chain(chain),
+      m_block_gas_limit(blockGasLimit),
+      m_executions(std::move(executions)),
+      m_db(globalState->db()),
+      m_db_utxo(globalState->dbUtxo()),
+      m_state_root(globalState->rootHash()),
+      m_utxo_root(globalState->rootHashUTXO()),
+      m_schedule(globalSealEngine->getQtumSchedule()),
+      m_shared_cache(globalState->sharedCache())
+{
+    AssertLockHeld(cs_main);
+    threads = std::min<int>({threads, MAX_EVM_PREFETCH_THREADS, (int)m_executions.size()});
+    for (int i = 0; i < threads; ++i) {
+        m_workers.emplace_back(&util::TraceThread, strprintf("evmprefetch.%i", i), [this] { Run(); });
+    }
+}
+
+EvmStatePrefetcher::~EvmStatePrefetcher()
+{
+    Stop();
+}
+
+void EvmStatePrefetcher::Stop()
+{
+    m_stop = true;
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void EvmStatePrefetcher::Run()
+{
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine;
+    try {
+        sealEngine = MakeSealEngine(m_schedule);
+    } catch (...) {
+        return;
+    }
+    QtumState state(dev::u256(0), m_db, m_db_utxo);
+    state.setSharedCache(m_shared_cache);
+
+    // The static warm-up of every execution comes first, then the dry runs
+    while (!m_stop) {
+        const size_t next = m_next++;
+        if (next >= 2 * m_executions.size()) break;
+        const bool dryRun = next >= m_executions.size();
+        const std::vector<QtumTransaction>& execution = m_executions[dryRun ? next - m_executions.size() : next];
+
+        state.setRoot(m_state_root);
+        state.setRootUTXO(m_utxo_root);
+        try {
+            if (!dryRun) {
+                WarmAccounts(state, execution, m_stop);
+                continue;
+            }
+            ByteCodeExec exec(m_block, execution, m_block_gas_limit, m_pindex, m_chain, state, *sealEngine);
+            exec.performByteCode(dev::eth::Permanence::Reverted);
+        } catch (...) {
+            // Speculating on stale state may fail in ways the sequential pass won't
+        }
+    }
+}
+
+std::vector<dev::u256> EvmStatePrefetcher::ConstantStorageKeys(const dev::bytes& code, size_t max)
+{
+    static constexpr uint8_t OP_PUSH0{0x5f};
+    static constexpr uint8_t OP_PUSH1{0x60};
+    static constexpr uint8_t OP_PUSH32{0x7f};
+    static constexpr uint8_t OP_SLOAD{0x54};
+
+    std::vector<dev::u256> keys;
+    std::optional<dev::u256> pushed;
+    for (size_t pc = 0; pc < code.size() && keys.size() < max; ++pc) {
+        const uint8_t op = code[pc];
+        if (op == OP_PUSH0) {
+            pushed = 0;
+        } else if (op >= OP_PUSH1 && op <= OP_PUSH32) {
+            const size_t size = op - OP_PUSH1 + 1;
+            // Immediates cut off by the end of the code are zero padded, as the EVM reads them
+            dev::bytes immediate(size, 0);
+            std::copy(code.begin() + pc + 1, code.begin() + std::min(pc + 1 + size, code.size()), immediate.begin());
+            pushed = dev::fromBigEndian<dev::u256>(immediate);
+            pc += size;
+        } else {
+            if (op == OP_SLOAD && pushed && std::find(keys.begin(), keys.end(), *pushed) == keys.end()) {
+                keys.push_back(*pushed);
+            }
+            pushed.reset();
+        }
+    }
+    return keys;
+}
+
+MempoolEvmWarmer::MempoolEvmWarmer()
+{
+    m_worker = std::thread(&util::TraceThread, "evmwarm", [this] { Run(); });
+}
+
+MempoolEvmWarmer::~MempoolEvmWarmer()
+{
+    Stop();
+}
+
+void MempoolEvmWarmer::Add(std::shared_ptr<const CachedQtumTX> tx)
+{
+    if (!tx || tx->extracted.first.empty()) return;
+    {
+        LOCK(m_mutex);
+        if (m_queue.size() >= MAX_QUEUED) m_queue.pop_front();
+        m_queue.push_back(std::move(tx));
+    }
+    m_cv.notify_all();
+}
+
+void MempoolEvmWarmer::Pause()
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_paused = true;
+    m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_busy; });
+}
+
+void MempoolEvmWarmer::Resume(CBlockIndex* tip, CChain& chain, uint64_t blockGasLimit)
+{
+    AssertLockHeld(cs_main);
+    if (!tip || !globalState || !globalSealEngine) return;
+
+    // A next block as far as executions can tell: the tip's successor, paying to no one
+    auto snapshot = std::make_shared<Snapshot>(Snapshot{
+        .block = {},
+        .tip = tip,
+        .chain = &chain,
+        .block_gas_limit = blockGasLimit,
+        .db = globalState->db(),
+        .db_utxo = globalState->dbUtxo(),
+        .state_root = globalState->rootHash(),
+        .utxo_root = globalState->rootHashUTXO(),
+        .schedule = globalSealEngine->getQtumSchedule(),
+        .shared_cache = globalState->sharedCache(),
+    });
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    snapshot->block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    snapshot->block.hashPrevBlock = tip->GetBlockHash();
+    snapshot->block.nTime = std::max<int64_t>(tip->GetMedianTimePast() + 1, GetTime());
+    snapshot->block.nBits = tip->nBits;
+
+    {
+        LOCK(m_mutex);
+        m_snapshot = std::move(snapshot);
+        m_paused = false;
+    }
+    m_cv.notify_all();
+}
+
+void MempoolEvmWarmer::Stop()
+{
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+}
+
+void MempoolEvmWarmer::Run()
+{
+    std::shared_ptr<const Snapshot> snapshot;
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine;
+    std::unique_ptr<QtumState> state;
+    while (true) {
+        std::shared_ptr<const CachedQtumTX> tx;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_busy = false;
+            m_cv.notify_all();
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return m_stop || (!m_paused && m_snapshot && !m_queue.empty());
+            });
+            if (m_stop) return;
+            tx = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            if (snapshot != m_snapshot) {
+                snapshot = m_snapshot;
+                state.reset();
+            }
+        }
+
+        const std::vector<QtumTransaction>& execution = tx->extracted.first;
+        try {
+            if (!state) {
+                sealEngine = MakeSealEngine(snapshot->schedule);
+                state = std::make_unique<QtumState>(dev::u256(0), snapshot->db, snapshot->db_utxo);
+                state->setSharedCache(snapshot->shared_cache);
+            }
+            state->setRoot(snapshot->state_root);
+            state->setRootUTXO(snapshot->utxo_root);
+            WarmAccounts(*state, execution, m_stop);
+            if (m_stop) continue;
+            state->setRoot(snapshot->state_root);
+            state->setRootUTXO(snapshot->utxo_root);
+            ByteCodeExec exec(snapshot->block, execution, snapshot->block_gas_limit, snapshot->tip, *snapshot->chain, *state, *sealEngine);
+            exec.performByteCode(dev::eth::Permanence::Reverted);
+        } catch (...) {
+            // The transaction may no longer be valid on top of the tip
+            state.reset();
+        }
+    }
+}
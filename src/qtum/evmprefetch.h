@@ -0,0 +1,152 @@
+#ifndef QTUM_EVMPREFETCH_H
+#define QTUM_EVMPREFETCH_H
+
+#include <primitives/block.h>
+#include <qtum/qtumstate.h>
+#include <sync.h>
+#include <validation.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/** Default for -evmprefetchthreads */
+static const int DEFAULT_EVM_PREFETCH_THREADS = 2;
+/** Maximum for -evmprefetchthreads */
+static const int MAX_EVM_PREFETCH_THREADS = 16;
+
+/**
+ * Warms the state databases for a block's contract executions
+ *
+ * ConnectBlock executes contract transactions one after another on
+ * globalState, and most of each execution is spent on trie reads. Before
+ * the sequential pass starts, the prefetcher runs the block's executions
+ * speculatively on worker threads, each on a private QtumState over copies
+ * of the pre-block databases, and throws the results away. The sequential
+ * pass stays the only one that commits, so results and state roots are
+ * exactly as before; it just finds the trie nodes it needs in LevelDB's
+ * cache. Executions that depend on earlier ones in the block see stale
+ * state, which only costs wasted work. The executions also fill globalState's
+ * shared account and storage cache, which accepts their reads only while it
+ * still follows the pre-block state root.
+ *
+ * Before any dry run, the workers warm what the transactions show without
+ * executing: the sender and receiver accounts, the receiver's code, and the
+ * storage slots the code loads by constant key. These reads are right even
+ * when a dry run follows stale state, and the first execution of the block
+ * usually starts before the dry runs get far.
+ */
+class EvmStatePrefetcher {
+public:
+    /** Below this many executions in a block the threads are not worth starting */
+    static constexpr size_t MIN_EXECUTIONS = 1;
+    /** Storage slots with a constant key warmed per contract */
+    static constexpr size_t MAX_CONSTANT_SLOTS = 64;
+
+    EvmStatePrefetcher(const CBlock& block, CBlockIndex* pindexPrev, CChain& chain, uint64_t blockGasLimit,
+                       std::vector<std::vector<QtumTransaction>> executions, int threads) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    ~EvmStatePrefetcher();
+
+    EvmStatePrefetcher(const EvmStatePrefetcher&) = delete;
+    EvmStatePrefetcher& operator=(const EvmStatePrefetcher&) = delete;
+
+    /** Stop after the executions in progress and join the workers */
+    void Stop();
+
+    /** Keys of the SLOADs of code whose key is pushed right before, in code order, at most max */
+    static std::vector<dev::u256> ConstantStorageKeys(const dev::bytes& code, size_t max);
+
+private:
+    void Run();
+
+    const CBlock& m_block;
+    CBlockIndex* m_pindex;
+    CChain& m_chain;
+    const uint64_t m_block_gas_limit;
+    const std::vector<std::vector<QtumTransaction>> m_executions;
+
+    const dev::OverlayDB m_db;
+    const dev::OverlayDB m_db_utxo;
+    const dev::h256 m_state_root;
+    const dev::h256 m_utxo_root;
+    const dev::eth::EVMSchedule m_schedule;
+    const std::shared_ptr<dev::eth::StateCache> m_shared_cache;
+
+    std::atomic<size_t> m_next{0};
+    std::atomic<bool> m_stop{false};
+    std::vector<std::thread> m_workers;
+};
+
+/**
+ * Warms the state for contract transactions as they enter the mempool
+ *
+ * Most contract transactions of a block were relayed before it, so by the
+ * time a compact block is reconstructed the state they touch can already be
+ * in cache. Each accepted contract transaction gets the same static warm-up
+ * and dry run as in EvmStatePrefetcher, on one worker thread, against the tip
+ * state and a next block built from the tip. The results are thrown away:
+ * contracts may read the block's time, number and author and the effects of
+ * the transactions before them, none of which is known yet. What carries over
+ * to ConnectBlock are the reads, through LevelDB's cache and globalState's
+ * shared cache, whose storage slots stay valid until their contract changes.
+ *
+ * The worker pauses while blocks are connected or disconnected, as executions
+ * read the active chain, and resumes on the new tip outside IBD.
+ */
+class MempoolEvmWarmer {
+public:
+    /** Transactions waiting to be warmed; the oldest are dropped past this */
+    static constexpr size_t MAX_QUEUED = 1000;
+
+    MempoolEvmWarmer();
+    ~MempoolEvmWarmer();
+
+    MempoolEvmWarmer(const MempoolEvmWarmer&) = delete;
+    MempoolEvmWarmer& operator=(const MempoolEvmWarmer&) = delete;
+
+    /** Queue the executions of a transaction accepted to the mempool */
+    void Add(std::shared_ptr<const CachedQtumTX> tx) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait for the execution in progress and hold off the next ones, before the active chain changes */
+    void Pause() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Continue with the queued transactions on top of a new tip */
+    void Resume(CBlockIndex* tip, CChain& chain, uint64_t blockGasLimit) EXCLUSIVE_LOCKS_REQUIRED(cs_main, !m_mutex);
+
+    /** Stop after the execution in progress and join the worker */
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    /** The tip state the executions run on, replaced by each Resume() */
+    struct Snapshot {
+        CBlock block;
+        CBlockIndex* tip;
+        CChain* chain;
+        uint64_t block_gas_limit;
+        dev::OverlayDB db;
+        dev::OverlayDB db_utxo;
+        dev::h256 state_root;
+        dev::h256 utxo_root;
+        dev::eth::EVMSchedule schedule;
+        std::shared_ptr<dev::eth::StateCache> shared_cache;
+    };
+
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::shared_ptr<const CachedQtumTX>> m_queue GUARDED_BY(m_mutex);
+    std::shared_ptr<const Snapshot> m_snapshot GUARDED_BY(m_mutex);
+    bool m_paused GUARDED_BY(m_mutex){true};
+    bool m_busy GUARDED_BY(m_mutex){false};
+    std::atomic<bool> m_stop{false};
+    std::thread m_worker;
+};
+
+/** Warms the state for mempool contract transactions, null if -evmprefetchthreads is 0 */
+extern std::unique_ptr<MempoolEvmWarmer> g_mempool_evm_warmer;
+
+#endif // QTUM_EVMPREFETCH_H
@@ -0,0 +1,71 @@
+#include <qtum/evmstats.h>
+
+#include <sync.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+static Mutex g_evmStatsMutex;
+static std::unordered_map<dev::Address, EvmContractStats> g_evmStats GUARDED_BY(g_evmStatsMutex);
+static int64_t g_evmStatsResetTime GUARDED_BY(g_evmStatsMutex){GetTime()};
+
+static EvmContractStats& ContractStats(const dev::Address& contract) EXCLUSIVE_LOCKS_REQUIRED(g_evmStatsMutex)
+{
+    auto it = g_evmStats.find(contract);
+    if (it != g_evmStats.end()) return it->second;
+    if (g_evmStats.size() >= MAX_EVM_STATS_CONTRACTS) {
+        g_evmStats.erase(std::min_element(g_evmStats.begin(), g_evmStats.end(), [](const auto& a, const auto& b) {
+            return a.second.gasUsed < b.second.gasUsed;
+        }));
+    }
+    return g_evmStats[contract];
+}
+
+EvmExecutionStats::EvmExecutionStats()
+    : m_start(SteadyClock::now())
+{
+}
+
+EvmContractStats EvmExecutionStats::Record(EvmStatsSource source, const dev::Address& contract, uint64_t gasUsed)
+{
+    EvmContractStats execution;
+    (source == EvmStatsSource::BLOCK ? execution.blockExecutions : execution.callExecutions) = 1;
+    execution.gasUsed = gasUsed;
+    execution.micros = Ticks<std::chrono::microseconds>(SteadyClock::now() - m_start);
+
+    LOCK(g_evmStatsMutex);
+    EvmContractStats& entered = ContractStats(contract);
+    entered.blockExecutions += execution.blockExecutions;
+    entered.callExecutions += execution.callExecutions;
+    entered.gasUsed += execution.gasUsed;
+    entered.micros += execution.micros;
+    for (const auto& [address, access] : m_storage) {
+        EvmContractStats& stats = ContractStats(address);
+        stats.sloads += access.loads;
+        stats.sstores += access.stores;
+        stats.dbReads += access.diskReads;
+        execution.sloads += access.loads;
+        execution.sstores += access.stores;
+        execution.dbReads += access.diskReads;
+    }
+    return execution;
+}
+
+std::vector<std::pair<dev::Address, EvmContractStats>> GetEvmContractStats()
+{
+    LOCK(g_evmStatsMutex);
+    return {g_evmStats.begin(), g_evmStats.end()};
+}
+
+void ResetEvmContractStats()
+{
+    LOCK(g_evmStatsMutex);
+    g_evmStats.clear();
+    g_evmStatsResetTime = GetTime();
+}
+
+int64_t GetEvmStatsResetTime()
+{
+    LOCK(g_evmStatsMutex);
+    return g_evmStatsResetTime;
+}
@@ -0,0 +1,69 @@
+#ifndef QTUM_EVMSTATS_H
+#define QTUM_EVMSTATS_H
+
+#include <libdevcore/FixedHash.h>
+#include <libevm/ExtVMFace.h>
+#include <util/time.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/** Contracts whose statistics are kept, the one with the least gas makes room for a new one */
+static const size_t MAX_EVM_STATS_CONTRACTS = 10000;
+
+/** What ran an execution */
+enum class EvmStatsSource {
+    BLOCK, //!< a contract transaction of a connected block
+    CALL,  //!< callcontract or eth_call
+};
+
+/**
+ * EVM work attributed to a contract, reported by getevmstats
+ */
+struct EvmContractStats {
+    //! Executions that entered the contract, by source
+    uint64_t blockExecutions{0};
+    uint64_t callExecutions{0};
+    //! Gas and time of those executions, the contracts they called included
+    uint64_t gasUsed{0};
+    uint64_t micros{0};
+    //! SLOAD and SSTORE of the contract's storage by any execution, and the state database reads
+    //! from disk they caused
+    uint64_t sloads{0};
+    uint64_t sstores{0};
+    uint64_t dbReads{0};
+};
+
+/**
+ * Measures one execution of the calling thread while in scope
+ *
+ * Storage accesses are counted by the contract whose storage they touch, so
+ * a library or token called by many contracts shows up on its own.
+ */
+class EvmExecutionStats {
+public:
+    EvmExecutionStats();
+
+    /**
+     * Add the execution to the totals, entering contract
+     * @return the totals of the execution alone, storage accesses of all contracts summed
+     */
+    EvmContractStats Record(EvmStatsSource source, const dev::Address& contract, uint64_t gasUsed);
+
+private:
+    dev::eth::StorageAccessCounts m_storage;
+    dev::eth::ScopedStorageAccessCounter m_counter{m_storage};
+    SteadyClock::time_point m_start;
+};
+
+/** Statistics of every contract kept, in no particular order */
+std::vector<std::pair<dev::Address, EvmContractStats>> GetEvmContractStats();
+
+/** Forget the statistics of every contract */
+void ResetEvmContractStats();
+
+/** The UNIX time the statistics were last reset, or started to be collected */
+int64_t GetEvmStatsResetTime();
+
+#endif // QTUM_EVMSTATS_H
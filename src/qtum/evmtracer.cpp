@@ -0,0 +1,605 @@
+#include <qtum/evmtracer.h>
+
+#include <chainparams.h>
+#include <libdevcore/TrieCommon.h>
+#include <libethereum/Transaction.h>
+#include <libevm/EVMC.h>
+#include <libevm/ExtVMFace.h>
+#include <qtum/qtumDGP.h>
+#include <undo.h>
+#include <util/convert.h>
+
+#include <evmone/execution_state.hpp>
+#include <evmone/instructions_opcodes.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+using evmone::Opcode;
+
+//! Amounts are reported in wei as by the eth_ RPCs, 1 satoshi = 10^10 wei
+static constexpr uint64_t WEI_PER_SATOSHI{10000000000ULL};
+
+//! Frames of inner calls while only the top call is traced
+static constexpr size_t NO_FRAME{std::numeric_limits<size_t>::max()};
+
+//! Call input copied from memory for a call that may run no code; longer input only fails
+static constexpr uint64_t MAX_CALL_INPUT{1 << 24};
+
+static intx::uint256 ToUint256(const dev::u256& value)
+{
+    const dev::h256 bytes(value);
+    return intx::be::unsafe::load<intx::uint256>(bytes.data());
+}
+
+static uint64_t Saturate(const intx::uint256& value)
+{
+    return value > std::numeric_limits<uint64_t>::max() ? std::numeric_limits<uint64_t>::max() : static_cast<uint64_t>(value);
+}
+
+static std::string HexString(const uint8_t* data, size_t size)
+{
+    return "0x" + HexStr(Span{data, size});
+}
+
+std::optional<EvmTracerType> ParseEvmTracerType(const std::string& name)
+{
+    if (name == "callTracer") return EvmTracerType::CALL;
+    if (name == "prestateTracer") return EvmTracerType::PRESTATE;
+    return std::nullopt;
+}
+
+void JsonTextWriter::Separate()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (!m_filled.empty()) {
+        if (m_filled.back()) m_out += ',';
+        m_filled.back() = true;
+    }
+}
+
+void JsonTextWriter::BeginObject()
+{
+    Separate();
+    m_out += '{';
+    m_filled.push_back(false);
+}
+
+void JsonTextWriter::EndObject()
+{
+    m_out += '}';
+    m_filled.pop_back();
+}
+
+void JsonTextWriter::BeginArray()
+{
+    Separate();
+    m_out += '[';
+    m_filled.push_back(false);
+}
+
+void JsonTextWriter::EndArray()
+{
+    m_out += ']';
+    m_filled.pop_back();
+}
+
+void JsonTextWriter::Key(std::string_view key)
+{
+    String(key);
+    m_out += ':';
+    m_after_key = true;
+}
+
+void JsonTextWriter::String(std::string_view value)
+{
+    Separate();
+    m_out += '"';
+    for (const char c : value) {
+        if (c == '"' || c == '\\') {
+            m_out += '\\';
+            m_out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            m_out += strprintf("\\u%04x", static_cast<unsigned char>(c));
+        } else {
+            m_out += c;
+        }
+    }
+    m_out += '"';
+}
+
+void JsonTextWriter::Hex(const uint8_t* data, size_t size)
+{
+    Separate();
+    m_out += "\"0x";
+    m_out += HexStr(Span{data, size});
+    m_out += '"';
+}
+
+void JsonTextWriter::Quantity(const intx::uint256& value)
+{
+    Separate();
+    m_out += "\"0x";
+    m_out += intx::hex(value);
+    m_out += '"';
+}
+
+void JsonTextWriter::Number(uint64_t value)
+{
+    Separate();
+    m_out += std::to_string(value);
+}
+
+static const char* CallTypeName(uint8_t op)
+{
+    switch (op) {
+    case Opcode::OP_CALLCODE: return "CALLCODE";
+    case Opcode::OP_DELEGATECALL: return "DELEGATECALL";
+    case Opcode::OP_STATICCALL: return "STATICCALL";
+    case Opcode::OP_CREATE: return "CREATE";
+    case Opcode::OP_CREATE2: return "CREATE2";
+    default: return "CALL";
+    }
+}
+
+static bool IsCreate(uint8_t op)
+{
+    return op == Opcode::OP_CREATE || op == Opcode::OP_CREATE2;
+}
+
+//! Error of a frame as Ethereum clients word it
+static const char* StatusError(evmc_status_code status)
+{
+    switch (status) {
+    case EVMC_REVERT: return "execution reverted";
+    case EVMC_OUT_OF_GAS: return "out of gas";
+    case EVMC_INVALID_INSTRUCTION:
+    case EVMC_UNDEFINED_INSTRUCTION: return "invalid opcode";
+    case EVMC_BAD_JUMP_DESTINATION: return "invalid jump destination";
+    case EVMC_STACK_OVERFLOW: return "stack overflow";
+    case EVMC_STACK_UNDERFLOW: return "stack underflow";
+    case EVMC_INVALID_MEMORY_ACCESS: return "return data out of bounds";
+    case EVMC_STATIC_MODE_VIOLATION: return "write protection";
+    default: return "execution failed";
+    }
+}
+
+void EvmCallTracer::BeginExecution()
+{
+    m_executions.emplace_back();
+    m_open.clear();
+}
+
+void EvmCallTracer::on_execution_start(evmc_revision rev, const evmc_message& msg, evmone::bytes_view code) noexcept
+{
+    if (m_executions.empty()) m_executions.emplace_back();
+    std::vector<Frame>& frames = m_executions.back();
+    OpenFrame* parent = m_open.empty() ? nullptr : &m_open.back();
+
+    OpenFrame open;
+    open.address = msg.recipient;
+    open.code = code;
+    if (parent) {
+        parent->childStarted = true;
+        if (m_only_top_call || parent->frame == NO_FRAME) {
+            open.frame = NO_FRAME;
+            m_open.push_back(std::move(open));
+            return;
+        }
+    }
+
+    Frame frame;
+    if (parent && parent->pendingOp) {
+        frame.type = parent->pendingOp;
+    } else {
+        frame.type = msg.kind == EVMC_CREATE ? Opcode::OP_CREATE : Opcode::OP_CALL;
+    }
+    // DELEGATECALL keeps the caller of the caller and CALLCODE runs in the caller, so both are
+    // reported from the caller to the code they run
+    frame.from = parent ? parent->address : msg.sender;
+    const bool borrowsCode = frame.type == Opcode::OP_DELEGATECALL || frame.type == Opcode::OP_CALLCODE;
+    frame.to = parent && borrowsCode ? parent->pendingTo : msg.recipient;
+    if (frame.type != Opcode::OP_DELEGATECALL && frame.type != Opcode::OP_STATICCALL) {
+        frame.value = intx::be::load<intx::uint256>(msg.value);
+    }
+    frame.gas = msg.gas;
+    // The input of a create is its init code, taken from the first instruction
+    if (!IsCreate(frame.type)) {
+        frame.input.assign(msg.input_data, msg.input_data + msg.input_size);
+    }
+
+    open.frame = frames.size();
+    if (parent) frames[parent->frame].calls.push_back(open.frame);
+    frames.push_back(std::move(frame));
+    m_open.push_back(std::move(open));
+}
+
+void EvmCallTracer::on_instruction_start(uint32_t pc, const intx::uint256* stack_top, int stack_height, int64_t gas,
+                                         const evmone::ExecutionState& state) noexcept
+{
+    if (m_open.empty()) return;
+    OpenFrame& open = m_open.back();
+    if (open.frame == NO_FRAME) return;
+
+    if (!open.started) {
+        open.started = true;
+        Frame& frame = m_executions.back()[open.frame];
+        if (IsCreate(frame.type)) {
+            frame.input.assign(state.original_code.begin(), state.original_code.end());
+        }
+    }
+    if (m_only_top_call) return;
+    if (open.pendingOp) ResolvePending(open, stack_top);
+
+    const uint8_t op = pc < open.code.size() ? static_cast<uint8_t>(open.code[pc]) : static_cast<uint8_t>(Opcode::OP_STOP);
+    uint64_t inputOffset = 0;
+    uint64_t inputSize = 0;
+    switch (op) {
+    case Opcode::OP_CALL:
+    case Opcode::OP_CALLCODE:
+        if (stack_height < 7) return;
+        open.pendingValue = stack_top[-2];
+        inputOffset = Saturate(stack_top[-3]);
+        inputSize = stack_top[-4] > MAX_CALL_INPUT ? 0 : Saturate(stack_top[-4]);
+        break;
+    case Opcode::OP_DELEGATECALL:
+    case Opcode::OP_STATICCALL:
+        if (stack_height < 6) return;
+        open.pendingValue.reset();
+        inputOffset = Saturate(stack_top[-2]);
+        inputSize = stack_top[-3] > MAX_CALL_INPUT ? 0 : Saturate(stack_top[-3]);
+        break;
+    case Opcode::OP_CREATE:
+    case Opcode::OP_CREATE2:
+        if (stack_height < 3) return;
+        open.pendingValue = stack_top[0];
+        break;
+    default:
+        return;
+    }
+
+    open.pendingOp = op;
+    open.childStarted = false;
+    open.pendingInput.clear();
+    if (!IsCreate(op)) {
+        open.pendingTo = intx::be::trunc<evmc::address>(stack_top[-1]);
+        open.pendingGas = static_cast<int64_t>(std::min<uint64_t>(Saturate(stack_top[0]), gas));
+        // Memory the call expands reads as zeros
+        open.pendingInput.resize(inputSize);
+        const size_t memorySize = state.memory.size();
+        if (inputOffset < memorySize) {
+            const size_t copied = std::min<uint64_t>(inputSize, memorySize - inputOffset);
+            std::copy_n(state.memory.data() + inputOffset, copied, open.pendingInput.begin());
+        }
+    }
+}
+
+void EvmCallTracer::ResolvePending(OpenFrame& open, const intx::uint256* stack_top)
+{
+    const uint8_t op = open.pendingOp;
+    open.pendingOp = 0;
+    if (open.childStarted) return;
+
+    // The call ran no code and left its success, or the created address, on the stack
+    std::vector<Frame>& frames = m_executions.back();
+    Frame frame;
+    frame.type = op;
+    frame.from = open.address;
+    frame.to = IsCreate(op) ? intx::be::trunc<evmc::address>(stack_top[0]) : open.pendingTo;
+    frame.value = open.pendingValue;
+    frame.gas = IsCreate(op) ? 0 : open.pendingGas;
+    frame.input = std::move(open.pendingInput);
+    frame.status = stack_top[0] != 0 ? EVMC_SUCCESS : EVMC_FAILURE;
+    frames[open.frame].calls.push_back(frames.size());
+    frames.push_back(std::move(frame));
+}
+
+void EvmCallTracer::on_execution_end(const evmc_result& result) noexcept
+{
+    if (m_open.empty()) return;
+    const OpenFrame& open = m_open.back();
+    if (open.frame != NO_FRAME) {
+        Frame& frame = m_executions.back()[open.frame];
+        frame.status = result.status_code;
+        frame.gasUsed = frame.gas - result.gas_left;
+        frame.output.assign(result.output_data, result.output_data + result.output_size);
+    }
+    m_open.pop_back();
+}
+
+void EvmCallTracer::WriteExecution(size_t i, const QtumTransaction& tx, const dev::eth::ExecutionResult& result, JsonTextWriter& out) const
+{
+    static const std::vector<Frame> noFrames;
+    const std::vector<Frame>& frames = i < m_executions.size() ? m_executions[i] : noFrames;
+
+    // The top frame is reported with the gas of the transaction, intrinsic gas included
+    Frame top;
+    if (frames.empty()) {
+        // The receiver has no code
+        top.type = tx.isCreation() ? Opcode::OP_CREATE : Opcode::OP_CALL;
+        top.from = dev::eth::toEvmC(tx.sender());
+        top.to = dev::eth::toEvmC(tx.isCreation() ? result.newAddress : tx.receiveAddress());
+        top.value = ToUint256(tx.value());
+        top.input = tx.data();
+    } else {
+        top = frames[0];
+    }
+    top.gas = static_cast<int64_t>(tx.gas());
+    top.gasUsed = static_cast<int64_t>(result.gasUsed);
+
+    std::string error;
+    if (top.status && *top.status != EVMC_SUCCESS) {
+        error = StatusError(*top.status);
+    } else if (result.excepted != dev::eth::TransactionException::None) {
+        // Failed after the code ran, e.g. on the code deposit
+        std::ostringstream s;
+        s << result.excepted;
+        error = s.str();
+    }
+    WriteFrame(top, frames, error, out);
+}
+
+void EvmCallTracer::WriteFrame(const Frame& frame, const std::vector<Frame>& frames, const std::string& error, JsonTextWriter& out) const
+{
+    out.BeginObject();
+    out.Key("type");
+    out.String(CallTypeName(frame.type));
+    out.Key("from");
+    out.Hex(frame.from.bytes, sizeof(frame.from.bytes));
+    out.Key("to");
+    out.Hex(frame.to.bytes, sizeof(frame.to.bytes));
+    if (frame.value) {
+        out.Key("value");
+        out.Quantity(*frame.value * WEI_PER_SATOSHI);
+    }
+    out.Key("gas");
+    out.Quantity(frame.gas);
+    out.Key("gasUsed");
+    out.Quantity(frame.gasUsed);
+    out.Key("input");
+    out.Hex(frame.input.data(), frame.input.size());
+    if (!frame.output.empty()) {
+        out.Key("output");
+        out.Hex(frame.output.data(), frame.output.size());
+    }
+    if (!error.empty()) {
+        out.Key("error");
+        out.String(error);
+    }
+    if (!frame.calls.empty()) {
+        out.Key("calls");
+        out.BeginArray();
+        for (const size_t call : frame.calls) {
+            const Frame& inner = frames[call];
+            const bool failed = inner.status && *inner.status != EVMC_SUCCESS;
+            WriteFrame(inner, frames, failed ? StatusError(*inner.status) : std::string(), out);
+        }
+        out.EndArray();
+    }
+    out.EndObject();
+}
+
+void EvmPrestateTracer::BeginExecution()
+{
+    m_executions.emplace_back();
+    m_open.clear();
+}
+
+EvmPrestateTracer::Touched& EvmPrestateTracer::Current()
+{
+    if (m_executions.empty()) m_executions.emplace_back();
+    return m_executions.back();
+}
+
+void EvmPrestateTracer::on_execution_start(evmc_revision rev, const evmc_message& msg, evmone::bytes_view code) noexcept
+{
+    Touched& touched = Current();
+    touched[msg.sender];
+    touched[msg.recipient];
+    m_open.emplace_back(msg.recipient, code);
+}
+
+void EvmPrestateTracer::on_instruction_start(uint32_t pc, const intx::uint256* stack_top, int stack_height, int64_t gas,
+                                             const evmone::ExecutionState& state) noexcept
+{
+    if (m_open.empty()) return;
+    const auto& [address, code] = m_open.back();
+    const uint8_t op = pc < code.size() ? static_cast<uint8_t>(code[pc]) : static_cast<uint8_t>(Opcode::OP_STOP);
+    switch (op) {
+    case Opcode::OP_SLOAD:
+    case Opcode::OP_SSTORE:
+        if (stack_height < 1) return;
+        Current()[address].insert(intx::be::store<evmc::bytes32>(stack_top[0]));
+        break;
+    case Opcode::OP_BALANCE:
+    case Opcode::OP_EXTCODESIZE:
+    case Opcode::OP_EXTCODECOPY:
+    case Opcode::OP_EXTCODEHASH:
+    case Opcode::OP_SELFDESTRUCT:
+        if (stack_height < 1) return;
+        Current()[intx::be::trunc<evmc::address>(stack_top[0])];
+        break;
+    case Opcode::OP_CALL:
+    case Opcode::OP_CALLCODE:
+    case Opcode::OP_DELEGATECALL:
+    case Opcode::OP_STATICCALL:
+        if (stack_height < 2) return;
+        Current()[intx::be::trunc<evmc::address>(stack_top[-1])];
+        break;
+    default:
+        break;
+    }
+}
+
+void EvmPrestateTracer::on_execution_end(const evmc_result& result) noexcept
+{
+    if (!m_open.empty()) m_open.pop_back();
+}
+
+void EvmPrestateTracer::WriteExecution(size_t i, const QtumTransaction& tx, QtumState& pre, JsonTextWriter& out) const
+{
+    Touched touched = i < m_executions.size() ? m_executions[i] : Touched();
+    touched[dev::eth::toEvmC(tx.sender())];
+    if (!tx.isCreation()) touched[dev::eth::toEvmC(tx.receiveAddress())];
+
+    out.BeginObject();
+    for (const auto& [address, slots] : touched) {
+        const dev::Address account = dev::eth::fromEvmC(address);
+        out.Key(HexString(address.bytes, sizeof(address.bytes)));
+        out.BeginObject();
+        out.Key("balance");
+        out.Quantity(ToUint256(pre.balance(account)) * WEI_PER_SATOSHI);
+        const dev::u256 nonce = pre.getNonce(account);
+        if (nonce) {
+            out.Key("nonce");
+            out.Number(static_cast<uint64_t>(nonce));
+        }
+        const dev::bytes& code = pre.code(account);
+        if (!code.empty()) {
+            out.Key("code");
+            out.Hex(code.data(), code.size());
+        }
+        if (!slots.empty()) {
+            out.Key("storage");
+            out.BeginObject();
+            for (const evmc::bytes32& slot : slots) {
+                const dev::h256 value(pre.storage(account, dev::eth::fromEvmC(slot)));
+                out.Key(HexString(slot.bytes, sizeof(slot.bytes)));
+                out.Hex(value.data(), value.size);
+            }
+            out.EndObject();
+        }
+        out.EndObject();
+    }
+    out.EndObject();
+}
+
+EvmBlockReplay::EvmBlockReplay(Chainstate& chainstate, CBlockIndex& index)
+    : m_chainstate(chainstate),
+      m_index(&index),
+      m_db(globalState->db()),
+      m_db_utxo(globalState->dbUtxo()),
+      m_chain(std::make_unique<CChain>())
+{
+    AssertLockHeld(cs_main);
+    if (!chainstate.m_blockman.ReadBlock(m_block, index)) {
+        throw std::runtime_error("Block not available (pruned data)");
+    }
+    if (!index.pprev) return;
+
+    // The coins spent by the block give the senders of its contract transactions
+    CBlockUndo blockUndo;
+    if (!chainstate.m_blockman.ReadBlockUndo(blockUndo, index)) {
+        throw std::runtime_error("Undo data of the block not available");
+    }
+    for (size_t i = 1; i < m_block.vtx.size() && i - 1 < blockUndo.vtxundo.size(); i++) {
+        const std::vector<Coin>& prevouts = blockUndo.vtxundo[i - 1].vprevout;
+        for (size_t j = 0; j < m_block.vtx[i]->vin.size() && j < prevouts.size(); j++) {
+            m_spent.emplace_back(m_block.vtx[i]->vin[j].prevout, prevouts[j]);
+        }
+    }
+
+    // As ConnectBlock read them before executing the block
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const int dgpHeight = index.nHeight + (index.nHeight + 1 >= consensus.QIP7Height ? 0 : 1);
+    QtumDGP qtumDGP(globalState.get(), chainstate, fGettingValuesDGP);
+    m_schedule = qtumDGP.getGasSchedule(dgpHeight);
+    m_block_gas_limit = qtumDGP.getBlockGasLimit(dgpHeight);
+    m_contract_flags = GetContractScriptFlags(index.nHeight, consensus);
+
+    m_state_root = uintToh256(index.pprev->hashStateRoot);
+    m_utxo_root = uintToh256(index.pprev->hashUTXORoot);
+    if ((m_state_root != dev::EmptyTrie && !m_db.exists(m_state_root)) ||
+        (m_utxo_root != dev::EmptyTrie && !m_db_utxo.exists(m_utxo_root))) {
+        throw std::runtime_error("Contract state of the block not available (pruned state)");
+    }
+    m_chain->SetTip(*index.pprev);
+}
+
+bool EvmBlockReplay::TraceTransaction(const uint256& txid, const EvmTraceOptions& options, std::string& out) const
+{
+    JsonTextWriter writer(out);
+    const size_t size = out.size();
+    Replay(&txid, options, writer);
+    return out.size() > size;
+}
+
+void EvmBlockReplay::TraceBlock(const EvmTraceOptions& options, std::string& out) const
+{
+    JsonTextWriter writer(out);
+    writer.BeginArray();
+    Replay(nullptr, options, writer);
+    writer.EndArray();
+}
+
+void EvmBlockReplay::Replay(const uint256* target, const EvmTraceOptions& options, JsonTextWriter& out) const
+{
+    if (!m_index->pprev) return;
+
+    dev::eth::ChainParams cp(Params().EVMGenesisInfo());
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine(cp.createSealEngine());
+    sealEngine->setQtumSchedule(m_schedule);
+
+    QtumState state(dev::u256(0), m_db, m_db_utxo);
+    state.setRoot(m_state_root);
+    state.setRootUTXO(m_utxo_root);
+
+    CCoinsView viewDummy;
+    CCoinsViewCache view(&viewDummy);
+    for (const auto& [outpoint, coin] : m_spent) {
+        view.AddCoin(outpoint, Coin(coin), true);
+    }
+
+    for (const CTransactionRef& ptx : m_block.vtx) {
+        if (!ptx->HasCreateOrCall() || ptx->HasOpSpend()) continue;
+        ExtractQtumTX extracted;
+        if (!ExtractQtumTransactions(*ptx, m_chainstate, nullptr, &view, &m_block.vtx, m_contract_flags, extracted)) continue;
+
+        ByteCodeExec exec(m_block, extracted.first, m_block_gas_limit, m_index->pprev, *m_chain, state, *sealEngine);
+        const bool traced = !target || ptx->GetHash().ToUint256() == *target;
+        if (!traced) {
+            exec.performByteCode();
+            continue;
+        }
+
+        EvmCallTracer callTracer(options.onlyTopCall);
+        EvmPrestateTracer prestateTracer;
+        std::vector<std::pair<dev::h256, dev::h256>> preRoots;
+        exec.setOnExecute([&](size_t) {
+            callTracer.BeginExecution();
+            prestateTracer.BeginExecution();
+            preRoots.emplace_back(state.rootHash(), state.rootHashUTXO());
+        });
+        {
+            dev::eth::ScopedEVMCTracer scope(options.tracer == EvmTracerType::CALL ? static_cast<evmone::Tracer&>(callTracer) : prestateTracer);
+            exec.performByteCode();
+        }
+
+        // Each execution committed, so the state before it is still in the memory of the databases
+        std::unique_ptr<QtumState> pre;
+        const std::vector<ResultExecute>& results = exec.getResult();
+        for (size_t i = 0; i < results.size() && i < preRoots.size(); i++) {
+            if (!target) {
+                out.BeginObject();
+                out.Key("txHash");
+                out.String("0x" + ptx->GetHash().GetHex());
+                out.Key("result");
+            }
+            if (options.tracer == EvmTracerType::CALL) {
+                callTracer.WriteExecution(i, extracted.first[i], results[i].execRes, out);
+            } else {
+                if (!pre) pre = std::make_unique<QtumState>(dev::u256(0), state.db(), state.dbUtxo());
+                pre->setRoot(preRoots[i].first);
+                pre->setRootUTXO(preRoots[i].second);
+                prestateTracer.WriteExecution(i, extracted.first[i], *pre, out);
+            }
+            if (target) return;
+            out.EndObject();
+        }
+    }
+}
@@ -0,0 +1,206 @@
+#ifndef QTUM_EVMTRACER_H
+#define QTUM_EVMTRACER_H
+
+#include <chain.h>
+#include <coins.h>
+#include <primitives/block.h>
+#include <qtum/qtumstate.h>
+#include <validation.h>
+
+#include <evmone/tracing.hpp>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** Tracers built into debug_traceTransaction and debug_traceBlockBy* */
+enum class EvmTracerType {
+    CALL,     //!< callTracer: the tree of calls of an execution
+    PRESTATE, //!< prestateTracer: the accounts and storage an execution touches, as before it
+};
+
+/** Tracer of a name as Ethereum clients spell it, nullopt if it is not built in */
+std::optional<EvmTracerType> ParseEvmTracerType(const std::string& name);
+
+/**
+ * Options of a trace
+ */
+struct EvmTraceOptions {
+    EvmTracerType tracer{EvmTracerType::CALL};
+    //! callTracer: leave out the inner calls
+    bool onlyTopCall{false};
+};
+
+/**
+ * Appends JSON text to a string as values are written
+ *
+ * For results too large to build as UniValue first. The writer places the
+ * commas, it does not check that keys and values alternate.
+ */
+class JsonTextWriter {
+public:
+    explicit JsonTextWriter(std::string& out) : m_out(out) {}
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    void Key(std::string_view key);
+    void String(std::string_view value);
+    /** Bytes as a 0x prefixed hex string */
+    void Hex(const uint8_t* data, size_t size);
+    /** Number as a 0x prefixed hex string without leading zeros */
+    void Quantity(const intx::uint256& value);
+    void Number(uint64_t value);
+
+private:
+    void Separate();
+
+    std::string& m_out;
+    //! Whether a value was written in each open object or array
+    std::vector<bool> m_filled;
+    bool m_after_key{false};
+};
+
+/**
+ * callTracer: the tree of calls of each execution, with their gas, input,
+ * output and error
+ *
+ * Built from evmone's execution and instruction hooks. The type of a call
+ * and the code address of DELEGATECALL and CALLCODE come from the
+ * instruction of the caller, since frames only see their message. Calls
+ * that run no code, value transfers and precompiles, get a frame when the
+ * caller resumes, without gas used.
+ */
+class EvmCallTracer final : public evmone::Tracer {
+public:
+    explicit EvmCallTracer(bool onlyTopCall) : m_only_top_call(onlyTopCall) {}
+
+    /** Start the trace of the next execution */
+    void BeginExecution();
+    /** Write the trace of execution i, of tx with result */
+    void WriteExecution(size_t i, const QtumTransaction& tx, const dev::eth::ExecutionResult& result, JsonTextWriter& out) const;
+
+private:
+    struct Frame {
+        uint8_t type{0};
+        evmc::address from;
+        evmc::address to;
+        std::optional<intx::uint256> value;
+        int64_t gas{0};
+        int64_t gasUsed{0};
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        std::optional<evmc_status_code> status;
+        std::vector<size_t> calls;
+    };
+
+    //! A frame executing now
+    struct OpenFrame {
+        size_t frame;
+        evmc::address address;
+        evmone::bytes_view code;
+        bool started{false};
+        //! Last call or create instruction of the frame, until the frame resumes
+        uint8_t pendingOp{0};
+        evmc::address pendingTo;
+        std::optional<intx::uint256> pendingValue;
+        int64_t pendingGas{0};
+        std::vector<uint8_t> pendingInput;
+        bool childStarted{false};
+    };
+
+    void on_execution_start(evmc_revision rev, const evmc_message& msg, evmone::bytes_view code) noexcept override;
+    void on_instruction_start(uint32_t pc, const intx::uint256* stack_top, int stack_height, int64_t gas,
+                              const evmone::ExecutionState& state) noexcept override;
+    void on_execution_end(const evmc_result& result) noexcept override;
+
+    void ResolvePending(OpenFrame& open, const intx::uint256* stack_top);
+    void WriteFrame(const Frame& frame, const std::vector<Frame>& frames, const std::string& error, JsonTextWriter& out) const;
+
+    const bool m_only_top_call;
+    std::vector<std::vector<Frame>> m_executions;
+    std::vector<OpenFrame> m_open;
+};
+
+/**
+ * prestateTracer: the accounts and storage slots each execution touches,
+ * with their values before it
+ *
+ * Only the keys are collected while executing; the values are read after
+ * from the state the execution started on.
+ */
+class EvmPrestateTracer final : public evmone::Tracer {
+public:
+    /** Start the trace of the next execution */
+    void BeginExecution();
+    /** Write the trace of execution i, of tx, with the values of pre */
+    void WriteExecution(size_t i, const QtumTransaction& tx, QtumState& pre, JsonTextWriter& out) const;
+
+private:
+    using Touched = std::map<evmc::address, std::set<evmc::bytes32>>;
+
+    void on_execution_start(evmc_revision rev, const evmc_message& msg, evmone::bytes_view code) noexcept override;
+    void on_instruction_start(uint32_t pc, const intx::uint256* stack_top, int stack_height, int64_t gas,
+                              const evmone::ExecutionState& state) noexcept override;
+    void on_execution_end(const evmc_result& result) noexcept override;
+
+    Touched& Current();
+
+    std::vector<Touched> m_executions;
+    //! Storage address and code of the frames executing now
+    std::vector<std::pair<evmc::address, evmone::bytes_view>> m_open;
+};
+
+/**
+ * Replays the contract executions of a connected block to trace them
+ *
+ * Created under cs_main, it copies what the replay reads from the node: the
+ * block, the coins its transactions spent (from the undo data, for the
+ * senders), the state databases at the roots of the parent block, and the
+ * gas schedule and limit the block was connected with. The replay then runs
+ * without any lock on a private QtumState, executing the contract
+ * transactions of the block in order and committing each for the next as
+ * ConnectBlock did, with the tracer attached to the traced ones only.
+ */
+class EvmBlockReplay {
+public:
+    EvmBlockReplay(Chainstate& chainstate, CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Append the trace of txid to out, of its first execution as
+     * eth_getTransactionReceipt reports it
+     * @return false if txid has no contract execution in the block
+     * @throws std::runtime_error if the state of the parent block is gone
+     */
+    bool TraceTransaction(const uint256& txid, const EvmTraceOptions& options, std::string& out) const;
+
+    /**
+     * Append the traces of every execution of the block to out, as an array
+     * of {"txHash", "result"}
+     * @throws std::runtime_error if the state of the parent block is gone
+     */
+    void TraceBlock(const EvmTraceOptions& options, std::string& out) const;
+
+private:
+    void Replay(const uint256* target, const EvmTraceOptions& options, JsonTextWriter& out) const;
+
+    Chainstate& m_chainstate;
+    CBlockIndex* m_index;
+    CBlock m_block;
+    std::vector<std::pair<COutPoint, Coin>> m_spent;
+    unsigned int m_contract_flags{0};
+    uint64_t m_block_gas_limit{0};
+    dev::eth::EVMSchedule m_schedule;
+    dev::OverlayDB m_db;
+    dev::OverlayDB m_db_utxo;
+    dev::h256 m_state_root;
+    dev::h256 m_utxo_root;
+    std::unique_ptr<CChain> m_chain;
+};
+
+#endif // QTUM_EVMTRACER_H
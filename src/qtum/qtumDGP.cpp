@@ -1,6 +1,47 @@
 #include <qtum/qtumDGP.h>
 #include <chainparams.h>
 
+#include <mutex>
+#include <tuple>
+
+/** Entries kept per DGP cache map; a map is simply emptied when full */
+static constexpr size_t MAX_DGP_CACHE_ENTRIES = 256;
+
+/**
+ * Contract data read by QtumDGP, shared by all instances
+ *
+ * A DGP contract's proposals and a template's parameters only change with
+ * the contract's storage, so they are keyed by the contract's storage root
+ * (and code hash for templates) in the state they are read from. Looking up
+ * the roots is one account read, while reading the storage walks the whole
+ * storage trie and the template data takes an EVM call. Entries never go
+ * stale: a changed storage has a new root, and a reorg back to an old one
+ * finds the same data.
+ */
+namespace {
+using DGPStorage = std::map<dev::h256, std::pair<dev::u256, dev::u256>>;
+using DGPParams = std::vector<std::pair<unsigned int, dev::Address>>;
+
+std::mutex g_dgp_cache_mutex;
+std::map<std::pair<dev::Address, dev::h256>, DGPParams> g_dgp_params_cache;
+std::map<std::tuple<dev::Address, dev::h256, dev::h256>, DGPStorage> g_dgp_storage_cache;
+std::map<std::tuple<dev::Address, dev::h256, dev::h256, std::vector<unsigned char>>, std::vector<unsigned char>> g_dgp_data_cache;
+
+template <typename Map, typename Key, typename Value>
+void DGPCacheInsert(Map& map, Key&& key, const Value& value)
+{
+    if (map.size() >= MAX_DGP_CACHE_ENTRIES) map.clear();
+    map.emplace(std::forward<Key>(key), value);
+}
+} // namespace
+
+void QtumDGP::clearCache(){
+    std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+    g_dgp_params_cache.clear();
+    g_dgp_storage_cache.clear();
+    g_dgp_data_cache.clear();
+}
+
 std::vector<uint32_t> createDataSchedule(const dev::eth::EVMSchedule& schedule)
 {
     std::vector<uint32_t> tempData = {schedule.tierStepGas[0], schedule.tierStepGas[1], schedule.tierStepGas[2],
@@ -98,8 +139,7 @@ uint64_t QtumDGP::getBlockGasLimit(unsigned int blockHeight){
 }
 
 bool QtumDGP::initStorages(const dev::Address& addr, unsigned int blockHeight, std::vector<unsigned char> data){
-    initStorageDGP(addr);
-    createParamsInstance();
+    initParamsInstance(addr);
     dev::Address address = getAddressForBlock(blockHeight);
     if(address != dev::Address()){
         if(!dgpevm){
@@ -112,16 +152,60 @@ bool QtumDGP::initStorages(const dev::Address& addr, unsigned int blockHeight, s
     return false;
 }
 
+void QtumDGP::initParamsInstance(const dev::Address& addr){
+    std::pair<dev::Address, dev::h256> key{addr, state->storageRoot(addr)};
+    {
+        std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+        auto it = g_dgp_params_cache.find(key);
+        if(it != g_dgp_params_cache.end()){
+            paramsInstance = it->second;
+            return;
+        }
+    }
+
+    initStorageDGP(addr);
+    createParamsInstance();
+
+    std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+    DGPCacheInsert(g_dgp_params_cache, std::move(key), paramsInstance);
+}
+
 void QtumDGP::initStorageDGP(const dev::Address& addr){
     storageDGP = state->storage(addr);
 }
 
 void QtumDGP::initStorageTemplate(const dev::Address& addr){
+    std::tuple<dev::Address, dev::h256, dev::h256> key{addr, state->storageRoot(addr), state->codeHash(addr)};
+    {
+        std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+        auto it = g_dgp_storage_cache.find(key);
+        if(it != g_dgp_storage_cache.end()){
+            storageTemplate = it->second;
+            return;
+        }
+    }
+
     storageTemplate = state->storage(addr);
+
+    std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+    DGPCacheInsert(g_dgp_storage_cache, std::move(key), storageTemplate);
 }
 
 void QtumDGP::initDataTemplate(const dev::Address& addr, std::vector<unsigned char>& data){
+    std::tuple<dev::Address, dev::h256, dev::h256, std::vector<unsigned char>> key{addr, state->storageRoot(addr), state->codeHash(addr), data};
+    {
+        std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+        auto it = g_dgp_data_cache.find(key);
+        if(it != g_dgp_data_cache.end()){
+            dataTemplate = it->second;
+            return;
+        }
+    }
+
     dataTemplate = CallContract(addr, data, chainstate)[0].execRes.output;
+
+    std::lock_guard<std::mutex> lock(g_dgp_cache_mutex);
+    DGPCacheInsert(g_dgp_data_cache, std::move(key), dataTemplate);
 }
 
 void QtumDGP::createParamsInstance(){
@@ -24,6 +24,13 @@ static const uint64_t MIN_BLOCK_GAS_LIMIT_DGP = 1000000;
 static const uint64_t MAX_BLOCK_GAS_LIMIT_DGP = 1000000000;
 static const uint64_t DEFAULT_BLOCK_GAS_LIMIT_DGP = 40000000;
 
+/**
+ * Reads the parameters set by the DGP contracts
+ *
+ * The contract data behind them is cached across instances, keyed by the
+ * contracts' storage roots, so building an instance per use is cheap and
+ * repeated lookups need neither storage walks nor EVM calls.
+ */
 class QtumDGP {
     
 public:
@@ -38,8 +45,13 @@ public:
 
     uint64_t getBlockGasLimit(unsigned int blockHeight);
 
+    /** Drop the cached contract data, e.g. when the state database is replaced */
+    static void clearCache();
+
 private:
 
+    void initParamsInstance(const dev::Address& addr);
+
     bool initStorages(const dev::Address& addr, unsigned int blockHeight, std::vector<unsigned char> data = std::vector<unsigned char>());
 
     void initStorageDGP(const dev::Address& addr);
@@ -385,6 +385,16 @@ bool QtumDelegation::ExistDelegationContract() const
     return globalState && globalState->addressInUse(priv->delegationsAddress);
 }
 
+bool QtumDelegation::GetStorageVersion(uint256 &version) const
+{
+    LOCK(cs_main);
+    if(!globalState || !globalState->addressInUse(priv->delegationsAddress))
+        return false;
+
+    version = h256Touint(globalState->storageRoot(priv->delegationsAddress));
+    return true;
+}
+
 std::string QtumDelegation::BytecodeRemove()
 {
     return DelegationABI()["removeDelegation"].selector();
@@ -119,6 +119,14 @@ public:
      */
     bool ExistDelegationContract() const;
 
+    /**
+     * @brief GetStorageVersion Get the storage root of the delegation contract,
+     * it changes with every added or removed delegation
+     * @param version Storage root of the delegation contract at the tip
+     * @return true/false
+     */
+    bool GetStorageVersion(uint256& version) const;
+
     /**
      * @brief BytecodeRemove Bytecode for remove delegation
      * @return Bytecode
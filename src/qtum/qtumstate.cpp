@@ -17,6 +17,12 @@ QtumState::QtumState(u256 const& _accountStartNonce, OverlayDB const& _db, const
 	        stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
 }
 
+QtumState::QtumState(u256 const& _accountStartNonce, OverlayDB const& _db, OverlayDB const& _dbUtxo, BaseState _bs) :
+        State(_accountStartNonce, _db, _bs) {
+            dbUTXO = _dbUtxo;
+	        stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
+}
+
 QtumState::QtumState() : dev::eth::State(dev::Invalid256, dev::OverlayDB(), dev::eth::BaseState::PreExisting) {
     dbUTXO = OverlayDB();
     stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
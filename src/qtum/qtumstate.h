@@ -95,6 +95,9 @@ public:
 
     QtumState(dev::u256 const& _accountStartNonce, dev::OverlayDB const& _db, const std::string& _path, dev::eth::BaseState _bs = dev::eth::BaseState::PreExisting);
 
+    // State over existing databases, e.g. copies of another state's, without opening the UTXO database again
+    QtumState(dev::u256 const& _accountStartNonce, dev::OverlayDB const& _db, dev::OverlayDB const& _dbUtxo, dev::eth::BaseState _bs = dev::eth::BaseState::PreExisting);
+
     ResultExecute execute(dev::eth::EnvInfo const& _envInfo, dev::eth::SealEngineFace const& _sealEngine, QtumTransaction const& _t, CChain& _chain, dev::eth::Permanence _p = dev::eth::Permanence::Committed, dev::eth::OnOpFunc const& _onOp = OnOpFunc());
 
     void setRootUTXO(dev::h256 const& _r) { cacheUTXO.clear(); stateUTXO.setRoot(_r); }
@@ -86,8 +86,9 @@ dev::Address qtumutils::eth_getHistoryStorageAddress()
 
 qtumutils::HistoricalHashes &qtumutils::HistoricalHashes::instance()
 {
-    // Get instance
-    static qtumutils::HistoricalHashes _instance;
+    // Get instance, one per thread since the tip is set right before each
+    // execution and read-only calls run concurrently with block validation
+    static thread_local qtumutils::HistoricalHashes _instance;
     return _instance;
 }
 
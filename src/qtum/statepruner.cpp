@@ -0,0 +1,226 @@
+#include <qtum/statepruner.h>
+
+#include <chain.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/TrieDB.h>
+#include <logging.h>
+#include <qtum/qtumstate.h>
+#include <tinyformat.h>
+#include <util/convert.h>
+#include <util/thread.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <mutex>
+
+//! Nodes deleted per write batch
+static constexpr size_t SWEEP_BATCH_SIZE{10000};
+
+static std::atomic<uint64_t> g_statePruneCount{0};
+
+static std::unique_ptr<StatePruner> g_statePruner;
+static std::mutex g_statePrunerMutex;
+
+//! A node still to walk: a trie node, whose leaves are accounts or not, or the code of an account
+struct PendingNode {
+    dev::h256 hash;
+    bool accounts;
+    bool code;
+};
+using PendingNodes = std::vector<PendingNode>;
+
+static void WalkNode(const dev::RLP& node, bool accounts, PendingNodes& pending);
+
+static void WalkChild(const dev::RLP& child, bool accounts, PendingNodes& pending)
+{
+    // Nodes shorter than a hash are kept inline in their parent
+    if (child.isData() && child.size() == 32) {
+        pending.push_back({child.toHash<dev::h256>(), accounts, false});
+    } else if (child.isList()) {
+        WalkNode(child, accounts, pending);
+    } else {
+        BOOST_THROW_EXCEPTION(dev::InvalidTrie());
+    }
+}
+
+static void WalkNode(const dev::RLP& node, bool accounts, PendingNodes& pending)
+{
+    if (node.isList() && node.itemCount() == 2) {
+        if (!dev::isLeaf(node)) {
+            WalkChild(node[1], accounts, pending);
+        } else if (accounts) {
+            // [nonce, balance, storageRoot, codeHash(, version)]
+            const dev::RLP account(node[1].payload());
+            pending.push_back({account[2].toHash<dev::h256>(), false, false});
+            const dev::h256 codeHash = account[3].toHash<dev::h256>();
+            if (codeHash != dev::EmptySHA3) pending.push_back({codeHash, false, true});
+        }
+    } else if (node.isList() && node.itemCount() == 17) {
+        // The keys of secure tries have one length, so branches hold no values
+        for (unsigned i = 0; i < 16; ++i) {
+            if (!node[i].isEmpty()) WalkChild(node[i], accounts, pending);
+        }
+    } else {
+        BOOST_THROW_EXCEPTION(dev::InvalidTrie());
+    }
+}
+
+bool WalkStateDB(const dev::OverlayDB& db, const std::vector<dev::h256>& roots, bool accounts, dev::h256Hash& visited,
+                 const std::function<bool(const dev::h256&, const std::string&)>& visit,
+                 const std::function<bool()>& interrupted)
+{
+    PendingNodes pending;
+    for (const dev::h256& root : roots) {
+        pending.push_back({root, accounts, false});
+    }
+    try {
+        while (!pending.empty()) {
+            if (interrupted()) return false;
+            const PendingNode next = pending.back();
+            pending.pop_back();
+            // Tries of consecutive blocks share most of their nodes, each is walked once
+            if (!visited.insert(next.hash).second) continue;
+            // Code is only read for the visitor
+            if (next.code && !visit) continue;
+            const std::string node = db.lookup(next.hash);
+            if (node.empty()) {
+                LogPrintf("WalkStateDB(): Missing trie node %s\n", next.hash.hex());
+                return false;
+            }
+            if (visit && !visit(next.hash, node)) return false;
+            if (!next.code) WalkNode(dev::RLP(node), next.accounts, pending);
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("WalkStateDB(): Invalid trie: %s\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+std::optional<size_t> PruneStateDB(dev::OverlayDB& db, const std::vector<dev::h256>& roots, bool accounts,
+                                   const std::function<bool()>& interrupted)
+{
+    // The empty trie is written once when the database is created
+    dev::h256Hash live{dev::EmptyTrie};
+    if (!WalkStateDB(db, roots, accounts, live, {}, interrupted)) {
+        LogPrintf("PruneStateDB(): Could not mark the live nodes, not pruning\n");
+        return std::nullopt;
+    }
+
+    size_t killed = 0;
+    std::vector<dev::h256> dead;
+    db.forEachNode([&](const dev::h256& key) {
+        if (!live.count(key)) dead.push_back(key);
+        if (dead.size() >= SWEEP_BATCH_SIZE) {
+            killed += db.killUnwritten(dead);
+            dead.clear();
+        }
+        // What was deleted before an interruption stays deleted, the rest waits for the next collection
+        return !interrupted();
+    });
+    killed += db.killUnwritten(dead);
+    return killed;
+}
+
+StatePruner::StatePruner(ChainstateManager& chainman, int keepBlocks)
+    : m_chainman(chainman),
+      m_keep_blocks(keepBlocks)
+{
+}
+
+StatePruner::~StatePruner()
+{
+    Interrupt();
+    Stop();
+}
+
+void StatePruner::Start()
+{
+    m_thread = std::thread(&util::TraceThread, "stateprune", [this] { ThreadPrune(); });
+}
+
+void StatePruner::Interrupt()
+{
+    m_interrupt();
+}
+
+void StatePruner::Stop()
+{
+    if (m_thread.joinable()) m_thread.join();
+}
+
+std::optional<size_t> StatePruner::Prune()
+{
+    std::vector<dev::h256> stateRoots;
+    std::vector<dev::h256> utxoRoots;
+    dev::OverlayDB db;
+    dev::OverlayDB dbUtxo;
+    {
+        LOCK(cs_main);
+        const CChain& chain = m_chainman.ActiveChain();
+        if (!globalState || !chain.Tip()) return std::nullopt;
+        // The background chainstate of a snapshot builds its state in the same databases
+        for (Chainstate* chainstate : m_chainman.GetAll()) {
+            const CChain& walked = chainstate->m_chain;
+            for (const CBlockIndex* pindex = walked.Tip(); pindex && walked.Height() - pindex->nHeight < m_keep_blocks; pindex = pindex->pprev) {
+                stateRoots.push_back(uintToh256(pindex->hashStateRoot));
+                utxoRoots.push_back(uintToh256(pindex->hashUTXORoot));
+            }
+        }
+        // New blocks only reach the nodes of the tip or nodes they write, which are tracked from here on
+        globalState->db().setWriteTracking(true);
+        globalState->dbUtxo().setWriteTracking(true);
+        db = globalState->db();
+        dbUtxo = globalState->dbUtxo();
+        m_last_height = chain.Height();
+        ++g_statePruneCount;
+    }
+
+    const auto interrupted = [this] { return bool(m_interrupt); };
+    const auto start{SteadyClock::now()};
+    std::optional<size_t> killed = PruneStateDB(db, stateRoots, /*accounts=*/true, interrupted);
+    std::optional<size_t> killedUtxo = PruneStateDB(dbUtxo, utxoRoots, /*accounts=*/false, interrupted);
+    db.setWriteTracking(false);
+    dbUtxo.setWriteTracking(false);
+    if (!killed && !killedUtxo) return std::nullopt;
+
+    LogPrintf("Pruned %u contract state and %u UTXO trie nodes older than %d blocks in %.2fs\n",
+              killed.value_or(0), killedUtxo.value_or(0), m_keep_blocks, Ticks<SecondsDouble>(SteadyClock::now() - start));
+    return killed.value_or(0) + killedUtxo.value_or(0);
+}
+
+void StatePruner::ThreadPrune()
+{
+    while (!m_interrupt) {
+        const int height = WITH_LOCK(cs_main, return m_chainman.ActiveChain().Height());
+        if (height >= m_keep_blocks && (m_last_height < 0 || height - m_last_height >= STATE_PRUNE_INTERVAL)) {
+            Prune();
+        }
+        if (!m_interrupt.sleep_for(std::chrono::minutes{1})) break;
+    }
+}
+
+uint64_t GetStatePruneCount()
+{
+    return g_statePruneCount;
+}
+
+void StartStatePruner(ChainstateManager& chainman, int keepBlocks)
+{
+    std::lock_guard<std::mutex> lock(g_statePrunerMutex);
+    g_statePruner = std::make_unique<StatePruner>(chainman, keepBlocks);
+    g_statePruner->Start();
+}
+
+void InterruptStatePruner()
+{
+    std::lock_guard<std::mutex> lock(g_statePrunerMutex);
+    if (g_statePruner) g_statePruner->Interrupt();
+}
+
+void StopStatePruner()
+{
+    std::lock_guard<std::mutex> lock(g_statePrunerMutex);
+    g_statePruner.reset();
+}
@@ -0,0 +1,102 @@
+#ifndef QTUM_STATEPRUNER_H
+#define QTUM_STATEPRUNER_H
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/OverlayDB.h>
+#include <util/threadinterrupt.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ChainstateManager;
+
+/** Default for -prunestate, 0 keeps the contract state of every block */
+static const int DEFAULT_PRUNE_STATE = 0;
+/** Blocks connected between two collections of -prunestate */
+static const int STATE_PRUNE_INTERVAL = 1000;
+
+/**
+ * Walk the nodes of a state database the roots reach
+ *
+ * With the storage tries and code of the accounts when the database holds
+ * the account trie. Nodes already in visited are skipped along with what
+ * they reach, the others are added to it and passed to visit, which can
+ * stop the walk by returning false. Without a visitor the code of the
+ * accounts is only added to visited, not read.
+ *
+ * @return false if a node is missing or invalid, visit returned false or
+ *         interrupted returned true
+ */
+bool WalkStateDB(const dev::OverlayDB& db, const std::vector<dev::h256>& roots, bool accounts, dev::h256Hash& visited,
+                 const std::function<bool(const dev::h256&, const std::string&)>& visit,
+                 const std::function<bool()>& interrupted);
+
+/**
+ * Delete the nodes of a state database that none of the roots reach
+ *
+ * The nodes reachable from the roots are marked first, with the storage
+ * tries and code of the accounts when the database holds the account trie.
+ * Every other node on disk is then deleted, except the ones written since
+ * write tracking of db started, which may belong to state built on the
+ * roots meanwhile.
+ *
+ * @pre write tracking of db was started before the roots were taken
+ * @param accounts whether the leaves of the tries are accounts
+ * @return the number of nodes deleted, nullopt if a root could not be
+ *         walked or interrupted returned true while marking
+ */
+std::optional<size_t> PruneStateDB(dev::OverlayDB& db, const std::vector<dev::h256>& roots, bool accounts,
+                                   const std::function<bool()>& interrupted);
+
+/**
+ * @brief Background collector of the contract state older blocks left behind
+ *
+ * The state and UTXO tries are content addressed and never delete a node,
+ * so every block leaves the nodes it replaced on disk for good. With
+ * -prunestate the collector keeps only what the last blocks need: every
+ * STATE_PRUNE_INTERVAL blocks it takes the roots of the last keep blocks
+ * under cs_main and deletes everything else without holding it. State of
+ * older blocks is gone afterwards, so calls against it fail and a reorg
+ * deeper than keep blocks needs a reindex.
+ */
+class StatePruner
+{
+public:
+    StatePruner(ChainstateManager& chainman, int keepBlocks);
+    ~StatePruner();
+
+    void Start();
+    void Interrupt();
+    void Stop();
+
+    /** Collect now, returns the nodes deleted or nullopt if nothing was */
+    std::optional<size_t> Prune();
+
+private:
+    void ThreadPrune();
+
+    ChainstateManager& m_chainman;
+    const int m_keep_blocks;
+    int m_last_height{-1};
+    CThreadInterrupt m_interrupt;
+    std::thread m_thread;
+};
+
+/**
+ * @brief Times a collection started, execution state from before may be gone
+ */
+uint64_t GetStatePruneCount();
+
+/** Start the collector for -prunestate */
+void StartStatePruner(ChainstateManager& chainman, int keepBlocks);
+/** Interrupt a collection in progress */
+void InterruptStatePruner();
+/** Stop and destroy the collector */
+void StopStatePruner();
+
+#endif // QTUM_STATEPRUNER_H
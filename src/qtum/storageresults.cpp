@@ -2,6 +2,53 @@
 #include <util/convert.h>
 #include <logging.h>
 
+#include <leveldb/write_batch.h>
+
+#include <algorithm>
+
+namespace {
+// Receipts are keyed by the hex of the transaction hash, so upper case prefixes can't collide
+const std::string BLOOM_INDEXED_FROM_KEY = "I";
+const char BLOOM_BLOCK_PREFIX = 'B';
+const char BLOOM_SECTION_PREFIX = 'S';
+
+/** Bytes in one section vector, a bit per block */
+const size_t BLOOM_VECTOR_SIZE = LOG_BLOOM_SECTION_SIZE / 8;
+
+void AppendBigEndian(std::string& key, uint32_t value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        key.push_back(char((value >> (i * 8)) & 0xff));
+    }
+}
+
+std::string BloomBlockKey(uint32_t height)
+{
+    std::string key(1, BLOOM_BLOCK_PREFIX);
+    AppendBigEndian(key, height, 4);
+    return key;
+}
+
+std::string BloomSectionKey(uint32_t section, unsigned bit)
+{
+    std::string key(1, BLOOM_SECTION_PREFIX);
+    AppendBigEndian(key, section, 4);
+    AppendBigEndian(key, bit, 2);
+    return key;
+}
+
+std::vector<unsigned> BloomBits(dev::eth::LogBloom const& bloom)
+{
+    std::vector<unsigned> bits;
+    for (unsigned i = 0; i < dev::eth::LogBloom::size; ++i) {
+        for (unsigned j = 0; j < 8; ++j) {
+            if (bloom[i] & (1 << j)) bits.push_back(i * 8 + j);
+        }
+    }
+    return bits;
+}
+} // namespace
+
 StorageResults::StorageResults(std::string const& _path){
 	path = _path + "/resultsDB";
     leveldb::Options options;
@@ -18,14 +65,18 @@ StorageResults::~StorageResults()
 }
 
 void StorageResults::addResult(dev::h256 hashTx, std::vector<TransactionReceiptInfo>& result){
+    LOCK(m_mutex);
 	m_cache_result.insert(std::make_pair(hashTx, result));
 }
 
 void StorageResults::clearCacheResult(){
+    LOCK(m_mutex);
     m_cache_result.clear();
+    m_cache_blooms.clear();
 }
 
 void StorageResults::wipeResults(){
+    LOCK(m_mutex);
     LogPrintf("Wiping LevelDB in %s\n", path);
     bool opened = db;
     if (opened) {
@@ -41,77 +92,240 @@ void StorageResults::wipeResults(){
 }
 
 void StorageResults::deleteResults(std::vector<CTransactionRef> const& txs){
-
+    LOCK(m_mutex);
+    leveldb::WriteBatch batch;
     for(CTransactionRef tx : txs){
         dev::h256 hashTx = uintToh256(tx->GetHash());
         m_cache_result.erase(hashTx);
-
-        std::string keyTemp = hashTx.hex();
-	    leveldb::Slice key(keyTemp);
-        leveldb::Status status = db->Delete(leveldb::WriteOptions(), key);
-        assert(status.ok());
+        batch.Delete(hashTx.hex());
     }
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
 }
 
 std::vector<TransactionReceiptInfo> StorageResults::getResult(dev::h256 const& hashTx){
     std::vector<TransactionReceiptInfo> result;
-	auto it = m_cache_result.find(hashTx);
-	if (it == m_cache_result.end()){
-		if(readResult(hashTx, result))
-			m_cache_result.insert(std::make_pair(hashTx, result));
-    } else {
-		result = it->second;
+    {
+        LOCK(m_mutex);
+        auto it = m_cache_result.find(hashTx);
+        if (it != m_cache_result.end())
+            return it->second;
     }
+    // Results read back are not cached, the cache only holds what the next commit writes
+    readResult(hashTx, result);
 	return result;
 }
 
+std::vector<TransactionReceiptInfo> StorageResults::getBlockResults(std::vector<CTransactionRef> const& vtx, uint256 const& blockHash){
+    std::vector<TransactionReceiptInfo> result;
+    for (const CTransactionRef& tx : vtx){
+        if (!tx->HasCreateOrCall())
+            continue;
+        for (TransactionReceiptInfo& receipt : getResult(uintToh256(tx->GetHash()))){
+            if (receipt.blockHash == blockHash)
+                result.push_back(std::move(receipt));
+        }
+    }
+    return result;
+}
+
 void StorageResults::commitResults(){
-    if(m_cache_result.size()){
-
-        for (auto const& i: m_cache_result){
-            std::string valueTemp;
-            std::string keyTemp = i.first.hex();
-            leveldb::Slice key(keyTemp);
-            leveldb::Status status = db->Get(leveldb::ReadOptions(), key, &valueTemp);
-
-            if(status.IsNotFound()){
-
-                TransactionReceiptInfoSerialized tris;
-
-                for(size_t j = 0; j < i.second.size(); j++){
-                    tris.blockHashes.push_back(uintToh256(i.second[j].blockHash));
-                    tris.blockNumbers.push_back(i.second[j].blockNumber);
-                    tris.transactionHashes.push_back(uintToh256(i.second[j].transactionHash));
-                    tris.transactionIndexes.push_back(i.second[j].transactionIndex);
-                    tris.senders.push_back(i.second[j].from);
-                    tris.receivers.push_back(i.second[j].to);
-                    tris.cumulativeGasUsed.push_back(dev::u256(i.second[j].cumulativeGasUsed));
-                    tris.gasUsed.push_back(dev::u256(i.second[j].gasUsed));
-                    tris.contractAddresses.push_back(i.second[j].contractAddress);
-                    tris.logs.push_back(logEntriesSerialization(i.second[j].logs));
-                    tris.excepted.push_back(uint32_t(static_cast<int>(i.second[j].excepted)));
-                    tris.exceptedMessage.push_back(i.second[j].exceptedMessage);
-                    tris.outputIndexes.push_back(i.second[j].outputIndex);
-                    tris.blooms.push_back(i.second[j].bloom);
-                    tris.stateRoots.push_back(i.second[j].stateRoot);
-                    tris.utxoRoots.push_back(i.second[j].utxoRoot);
-                    tris.createdContracts.push_back(i.second[j].createdContracts);
-                    tris.destructedContracts.push_back(i.second[j].destructedContracts);
-                }
+    LOCK(m_mutex);
+    if(m_cache_result.empty() && m_cache_blooms.empty())
+        return;
+
+    // One batch per block for the receipts and the bloom index
+    leveldb::WriteBatch batch;
+    for (auto const& i: m_cache_result){
+        TransactionReceiptInfoSerialized tris;
+
+        for(size_t j = 0; j < i.second.size(); j++){
+            tris.blockHashes.push_back(uintToh256(i.second[j].blockHash));
+            tris.blockNumbers.push_back(i.second[j].blockNumber);
+            tris.transactionHashes.push_back(uintToh256(i.second[j].transactionHash));
+            tris.transactionIndexes.push_back(i.second[j].transactionIndex);
+            tris.senders.push_back(i.second[j].from);
+            tris.receivers.push_back(i.second[j].to);
+            tris.cumulativeGasUsed.push_back(dev::u256(i.second[j].cumulativeGasUsed));
+            tris.gasUsed.push_back(dev::u256(i.second[j].gasUsed));
+            tris.contractAddresses.push_back(i.second[j].contractAddress);
+            tris.logs.push_back(logEntriesSerialization(i.second[j].logs));
+            tris.excepted.push_back(uint32_t(static_cast<int>(i.second[j].excepted)));
+            tris.exceptedMessage.push_back(i.second[j].exceptedMessage);
+            tris.outputIndexes.push_back(i.second[j].outputIndex);
+            tris.blooms.push_back(i.second[j].bloom);
+            tris.stateRoots.push_back(i.second[j].stateRoot);
+            tris.utxoRoots.push_back(i.second[j].utxoRoot);
+            tris.createdContracts.push_back(i.second[j].createdContracts);
+            tris.destructedContracts.push_back(i.second[j].destructedContracts);
+        }
+
+        dev::RLPStream streamRLP(18);
+        streamRLP << tris.blockHashes << tris.blockNumbers << tris.transactionHashes << tris.transactionIndexes << tris.senders;
+        streamRLP << tris.receivers << tris.cumulativeGasUsed << tris.gasUsed << tris.contractAddresses << tris.logs << tris.excepted << tris.exceptedMessage << tris.outputIndexes << tris.blooms << tris.stateRoots << tris.utxoRoots << tris.createdContracts << tris.destructedContracts;
+
+        dev::bytes data = streamRLP.out();
+        batch.Put(i.first.hex(), leveldb::Slice((const char*)data.data(), data.size()));
+    }
 
-                dev::RLPStream streamRLP(18);
-                streamRLP << tris.blockHashes << tris.blockNumbers << tris.transactionHashes << tris.transactionIndexes << tris.senders;
-                streamRLP << tris.receivers << tris.cumulativeGasUsed << tris.gasUsed << tris.contractAddresses << tris.logs << tris.excepted << tris.exceptedMessage << tris.outputIndexes << tris.blooms << tris.stateRoots << tris.utxoRoots << tris.createdContracts << tris.destructedContracts;
+    if(!m_cache_blooms.empty()){
+        // Blocks connected from here on are all in the index
+        if(!readBloomIndexedFrom()){
+            std::string value;
+            AppendBigEndian(value, m_cache_blooms.begin()->first, 4);
+            batch.Put(BLOOM_INDEXED_FROM_KEY, value);
+        }
 
-                dev::bytes data = streamRLP.out();
-                std::string stringData(data.begin(), data.end());
-                leveldb::Slice value(stringData);
-                status = db->Put(leveldb::WriteOptions(), key, value);
-                assert(status.ok());
+        std::map<std::string, BloomVector> vectors;
+        for (auto const& i: m_cache_blooms){
+            if(!i.second) continue;
+            batch.Put(BloomBlockKey(i.first), leveldb::Slice((const char*)i.second.data(), i.second.size));
+            const uint32_t offset = i.first % LOG_BLOOM_SECTION_SIZE;
+            for (unsigned bit : BloomBits(i.second)){
+                loadBloomVector(vectors, i.first / LOG_BLOOM_SECTION_SIZE, bit)[offset / 8] |= char(1 << (offset % 8));
             }
         }
-        m_cache_result.clear();
+        for (auto const& i: vectors){
+            batch.Put(i.first, i.second);
+        }
+    }
+
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
+    m_cache_result.clear();
+    m_cache_blooms.clear();
+}
+
+void StorageResults::addBlockBloom(uint32_t height, dev::eth::LogBloom const& bloom){
+    LOCK(m_mutex);
+    m_cache_blooms[height] = bloom;
+}
+
+void StorageResults::deleteBlockBloom(uint32_t height){
+    LOCK(m_mutex);
+    leveldb::WriteBatch batch;
+    eraseBlockBloom(height, batch);
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
+}
+
+void StorageResults::deleteBlockResults(uint32_t height, std::vector<uint256> const& hashTxs){
+    LOCK(m_mutex);
+    leveldb::WriteBatch batch;
+    for(uint256 const& hash : hashTxs){
+        dev::h256 hashTx = uintToh256(hash);
+        m_cache_result.erase(hashTx);
+        batch.Delete(hashTx.hex());
+    }
+    eraseBlockBloom(height, batch);
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
+}
+
+void StorageResults::eraseBlockBloom(uint32_t height, leveldb::WriteBatch& batch){
+    m_cache_blooms.erase(height);
+
+    std::string value;
+    std::string key = BloomBlockKey(height);
+    if(!db->Get(leveldb::ReadOptions(), key, &value).ok() || value.size() != dev::eth::LogBloom::size)
+        return;
+
+    std::map<std::string, BloomVector> vectors;
+    const uint32_t offset = height % LOG_BLOOM_SECTION_SIZE;
+    for (unsigned bit : BloomBits(dev::eth::LogBloom(dev::bytesConstRef(&value)))){
+        loadBloomVector(vectors, height / LOG_BLOOM_SECTION_SIZE, bit)[offset / 8] &= char(~(1 << (offset % 8)));
+    }
+    for (auto const& i: vectors){
+        batch.Put(i.first, i.second);
+    }
+    batch.Delete(key);
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> StorageResults::findLogRanges(uint32_t from, uint32_t to, std::set<dev::h160> const& addresses, std::set<dev::h256> const& topics){
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    if(to < from)
+        return ranges;
+
+    std::optional<uint32_t> indexedFrom = readBloomIndexedFrom();
+    if((addresses.empty() && topics.empty()) || !indexedFrom || *indexedFrom > to){
+        ranges.emplace_back(from, to);
+        return ranges;
+    }
+    if(from < *indexedFrom){
+        ranges.emplace_back(from, *indexedFrom - 1);
+        from = *indexedFrom;
+    }
+
+    // The bloom bits of every address and topic, as in LogEntry::bloom()
+    std::vector<std::vector<unsigned>> addressBits, topicBits;
+    for (dev::h160 const& address : addresses)
+        addressBits.push_back(BloomBits(dev::eth::LogBloom().shiftBloom<3>(dev::sha3(address.ref()))));
+    for (dev::h256 const& topic : topics)
+        topicBits.push_back(BloomBits(dev::eth::LogBloom().shiftBloom<3>(dev::sha3(topic.ref()))));
+
+    for (uint32_t section = from / LOG_BLOOM_SECTION_SIZE; section <= to / LOG_BLOOM_SECTION_SIZE; ++section){
+        std::map<std::string, BloomVector> vectors;
+        // Blocks matching any of the values, each of which needs all of its bits
+        auto matchAny = [&](std::vector<std::vector<unsigned>> const& values){
+            BloomVector any(BLOOM_VECTOR_SIZE, 0);
+            for (auto const& bits : values){
+                BloomVector all(BLOOM_VECTOR_SIZE, char(0xff));
+                for (unsigned bit : bits){
+                    BloomVector const& vector = loadBloomVector(vectors, section, bit);
+                    for (size_t i = 0; i < BLOOM_VECTOR_SIZE; ++i) all[i] &= vector[i];
+                }
+                for (size_t i = 0; i < BLOOM_VECTOR_SIZE; ++i) any[i] |= all[i];
+            }
+            return any;
+        };
+        BloomVector match(BLOOM_VECTOR_SIZE, char(0xff));
+        if(!addressBits.empty()){
+            match = matchAny(addressBits);
+        }
+        if(!topicBits.empty()){
+            BloomVector topicMatch = matchAny(topicBits);
+            for (size_t i = 0; i < BLOOM_VECTOR_SIZE; ++i) match[i] &= topicMatch[i];
+        }
+
+        const uint32_t first = std::max(from, section * LOG_BLOOM_SECTION_SIZE);
+        const uint32_t last = std::min(to, section * LOG_BLOOM_SECTION_SIZE + LOG_BLOOM_SECTION_SIZE - 1);
+        for (uint32_t height = first; height <= last; ++height){
+            const uint32_t offset = height % LOG_BLOOM_SECTION_SIZE;
+            if(!match[offset / 8]){
+                height |= 7;
+                continue;
+            }
+            if(!(match[offset / 8] & (1 << (offset % 8))))
+                continue;
+            if(!ranges.empty() && ranges.back().second + 1 == height)
+                ranges.back().second = height;
+            else
+                ranges.emplace_back(height, height);
+        }
+    }
+    return ranges;
+}
+
+std::optional<uint32_t> StorageResults::readBloomIndexedFrom(){
+    std::string value;
+    if(!db->Get(leveldb::ReadOptions(), BLOOM_INDEXED_FROM_KEY, &value).ok() || value.size() != 4)
+        return std::nullopt;
+    uint32_t height = 0;
+    for (unsigned char c : value)
+        height = (height << 8) | c;
+    return height;
+}
+
+StorageResults::BloomVector& StorageResults::loadBloomVector(std::map<std::string, BloomVector>& vectors, uint32_t section, unsigned bit){
+    std::string key = BloomSectionKey(section, bit);
+    auto it = vectors.find(key);
+    if(it == vectors.end()){
+        BloomVector vector;
+        if(!db->Get(leveldb::ReadOptions(), key, &vector).ok() || vector.size() != BLOOM_VECTOR_SIZE)
+            vector.assign(BLOOM_VECTOR_SIZE, 0);
+        it = vectors.emplace(key, std::move(vector)).first;
     }
+    return it->second;
 }
 
 bool StorageResults::readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result){
@@ -183,16 +397,18 @@ bool StorageResults::readResult(dev::h256 const& _key, std::vector<TransactionRe
 
 logEntriesSerialize StorageResults::logEntriesSerialization(dev::eth::LogEntries const& _logs){
 	logEntriesSerialize result;
-	for(dev::eth::LogEntry i : _logs){
-		result.push_back(std::make_pair(i.address, std::make_pair(i.topics, i.data)));
+	result.reserve(_logs.size());
+	for(dev::eth::LogEntry const& i : _logs){
+		result.emplace_back(i.address, std::make_pair(i.topics, i.data));
 	}
 	return result;
 }
 
 dev::eth::LogEntries StorageResults::logEntriesDeserialize(logEntriesSerialize const& _logs){
 	dev::eth::LogEntries result;
-	for(std::pair<dev::Address, std::pair<dev::h256s, dev::bytes>> i : _logs){
-		result.push_back(dev::eth::LogEntry(i.first, i.second.first, dev::bytes(i.second.second)));
+	result.reserve(_logs.size());
+	for(auto const& i : _logs){
+		result.emplace_back(i.first, i.second.first, dev::bytes(i.second.second));
 	}
 	return result;
 }
@@ -4,6 +4,11 @@
 #include <libethereum/Transaction.h>
 #include <leveldb/db.h>
 #include <common/system.h>
+#include <sync.h>
+
+#include <map>
+#include <optional>
+#include <set>
 
 using logEntriesSerialize = std::vector<std::pair<dev::Address, std::pair<dev::h256s, dev::bytes>>>;
 
@@ -49,6 +54,9 @@ struct TransactionReceiptInfoSerialized{
     std::vector<std::vector<dev::h160>> destructedContracts;
 };
 
+/** Blocks covered by one section of the log bloom index */
+static const uint32_t LOG_BLOOM_SECTION_SIZE = 4096;
+
 class StorageResults{
 
 public:
@@ -60,16 +68,38 @@ public:
 
     void deleteResults(std::vector<CTransactionRef> const& txs);
 
+    /** Remove the receipts of a disconnected block and its log bloom in one batch */
+    void deleteBlockResults(uint32_t height, std::vector<uint256> const& hashTxs);
+
     std::vector<TransactionReceiptInfo> getResult(dev::h256 const& hashTx);
 
+    /** Receipts of the contract transactions of a block, leaving out those of other blocks that mined the same transaction */
+    std::vector<TransactionReceiptInfo> getBlockResults(std::vector<CTransactionRef> const& vtx, uint256 const& blockHash);
+
 	void commitResults();
 
     void clearCacheResult();
 
     void wipeResults();
 
+    /** Add the union of a connected block's log blooms, written by the next commitResults() */
+    void addBlockBloom(uint32_t height, dev::eth::LogBloom const& bloom);
+
+    /** Remove a disconnected block from the log bloom index */
+    void deleteBlockBloom(uint32_t height);
+
+    /**
+     * Heights in [from, to] that may hold logs from one of the addresses and with one of
+     * the topics, as sorted ranges of consecutive heights. An empty set matches anything.
+     * Heights below the start of the bloom index are always included.
+     */
+    std::vector<std::pair<uint32_t, uint32_t>> findLogRanges(uint32_t from, uint32_t to, std::set<dev::h160> const& addresses, std::set<dev::h256> const& topics);
+
 private:
 
+    /** Guards the pending results and blooms, as the log RPCs read without cs_main */
+    mutable Mutex m_mutex;
+
 	bool readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result);
 
 	logEntriesSerialize logEntriesSerialization(dev::eth::LogEntries const& _logs);
@@ -81,4 +111,22 @@ private:
     leveldb::DB* db;
 
 	std::unordered_map<dev::h256, std::vector<TransactionReceiptInfo>> m_cache_result;
+
+    /**
+     * Log bloom index, in the manner of geth's bloombits. For each section of
+     * LOG_BLOOM_SECTION_SIZE blocks and each of the 2048 bloom bits there is one
+     * vector with a bit per block, so a lookup ANDs three vectors per address or
+     * topic instead of reading every receipt. The block blooms are kept to clear
+     * a block's bits when it is disconnected.
+     */
+    using BloomVector = std::string;
+
+    std::optional<uint32_t> readBloomIndexedFrom();
+
+    BloomVector& loadBloomVector(std::map<std::string, BloomVector>& vectors, uint32_t section, unsigned bit);
+
+    /** Add clearing the bits of a block's bloom to batch */
+    void eraseBlockBloom(uint32_t height, leveldb::WriteBatch& batch) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    std::map<uint32_t, dev::eth::LogBloom> m_cache_blooms;
 };
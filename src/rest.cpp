@@ -13,23 +13,33 @@
 #include <core_io.h>
 #include <flatfile.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
+#include <index/explorerindex.h>
 #include <index/txindex.h>
+#include <key_io.h>
+#include <libdevcore/Exceptions.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <qtum/qtumstate.h>
 #include <rpc/blockchain.h>
+#include <rpc/contract_util.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
+#include <stratum/stratum_server.h>
 #include <streams.h>
 #include <sync.h>
+#include <trust/trustscore.h>
 #include <txmempool.h>
 #include <util/any.h>
 #include <util/check.h>
+#include <util/convert.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <validation.h>
 
 #include <any>
@@ -40,9 +50,12 @@
 using node::GetTransaction;
 using node::NodeContext;
 using util::SplitString;
+using util::ToString;
+using util::TrimString;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+static constexpr size_t MAX_REST_STATE_SLOTS = 64;
 
 static const struct {
     RESTResponseFormat rf;
@@ -1005,6 +1018,638 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+/** The bytes of an EVM hash or address, written without a length prefix. */
+template <unsigned N>
+static std::span<const uint8_t> HashBytes(const dev::FixedHash<N>& hash)
+{
+    return {hash.data(), N};
+}
+
+static void SerializeLog(DataStream& ss, const dev::eth::LogEntry& log)
+{
+    ss << HashBytes(log.address);
+    WriteCompactSize(ss, log.topics.size());
+    for (const dev::h256& topic : log.topics) {
+        ss << HashBytes(topic);
+    }
+    ss << log.data;
+}
+
+/** A receipt without its block hash and height, which the reply carries once for the whole block. */
+static void SerializeReceipt(DataStream& ss, const TransactionReceiptInfo& receipt)
+{
+    ss << receipt.transactionHash << receipt.transactionIndex << receipt.outputIndex;
+    ss << HashBytes(receipt.from) << HashBytes(receipt.to);
+    ss << receipt.cumulativeGasUsed << receipt.gasUsed << HashBytes(receipt.contractAddress);
+    ss << static_cast<uint32_t>(receipt.excepted) << receipt.exceptedMessage;
+    ss << HashBytes(receipt.bloom) << HashBytes(receipt.stateRoot) << HashBytes(receipt.utxoRoot);
+    WriteCompactSize(ss, receipt.logs.size());
+    for (const dev::eth::LogEntry& log : receipt.logs) {
+        SerializeLog(ss, log);
+    }
+    WriteCompactSize(ss, receipt.createdContracts.size());
+    for (const auto& [address, code] : receipt.createdContracts) {
+        ss << HashBytes(address) << code;
+    }
+    WriteCompactSize(ss, receipt.destructedContracts.size());
+    for (const dev::Address& address : receipt.destructedContracts) {
+        ss << HashBytes(address);
+    }
+}
+
+/**
+ * Read a block of the active chain and the receipts of its contract transactions.
+ * On failure an error reply has been written and nullptr is returned.
+ */
+static const CBlockIndex* ReadBlockReceipts(const std::any& context, HTTPRequest* req, const std::string& hashStr,
+                                            std::vector<TransactionReceiptInfo>& receipts)
+{
+    if (!fLogEvents) {
+        RESTERR(req, HTTP_BAD_REQUEST, "Events indexing is not enabled (-logevents)");
+        return nullptr;
+    }
+    auto hash{uint256::FromHex(hashStr)};
+    if (!hash) {
+        RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+        return nullptr;
+    }
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return nullptr;
+    ChainstateManager& chainman = *maybe_chainman;
+
+    const CBlockIndex* pblockindex = WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(*hash));
+    if (!pblockindex || !WITH_LOCK(cs_main, return chainman.ActiveChain().Contains(pblockindex))) {
+        RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found in the active chain");
+        return nullptr;
+    }
+    CBlock block;
+    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
+        RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available");
+        return nullptr;
+    }
+
+    receipts = pstorageresult->getBlockResults(block.vtx, *hash);
+    return pblockindex;
+}
+
+static bool rest_receipts(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RESTResponseFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    std::vector<TransactionReceiptInfo> receipts;
+    const CBlockIndex* pblockindex = ReadBlockReceipts(context, req, hashStr, receipts);
+    if (!pblockindex) return false;
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        DataStream ssReceipts{};
+        ssReceipts << pblockindex->GetBlockHash() << static_cast<uint32_t>(pblockindex->nHeight);
+        WriteCompactSize(ssReceipts, receipts.size());
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            SerializeReceipt(ssReceipts, receipt);
+        }
+        if (rf == RESTResponseFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssReceipts);
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssReceipts) + "\n");
+        }
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue result(UniValue::VARR);
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            UniValue tri(UniValue::VOBJ);
+            transactionReceiptInfoToJSON(receipt, tri);
+            result.push_back(std::move(tri));
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+/** Parse a comma separated list of hex hashes or addresses from a query parameter. An absent parameter matches anything. */
+template <unsigned N>
+static bool ParseHashList(HTTPRequest* req, const std::string& key, std::vector<dev::FixedHash<N>>& hashes)
+{
+    const std::optional<std::string> param = req->GetQueryParameter(key);
+    if (!param) return true;
+    for (const std::string& str : SplitString(*param, ',')) {
+        if (str.size() != 2 * N || !IsHex(str)) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid " + key + ": " + SanitizeString(str));
+        }
+        hashes.emplace_back(str);
+    }
+    return true;
+}
+
+template <unsigned N>
+static bool MatchesHashList(const std::vector<dev::FixedHash<N>>& hashes, const dev::FixedHash<N>& hash)
+{
+    return hashes.empty() || std::find(hashes.begin(), hashes.end(), hash) != hashes.end();
+}
+
+static bool rest_logs(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RESTResponseFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    // Same matching as eth_getLogs: any of the addresses, and per position any of the topics
+    std::vector<dev::Address> addresses;
+    if (!ParseHashList(req, "address", addresses)) return false;
+    std::array<std::vector<dev::h256>, 4> topics;
+    for (size_t i = 0; i < topics.size(); ++i) {
+        if (!ParseHashList(req, strprintf("topic%d", i), topics[i])) return false;
+    }
+    auto matches = [&](const dev::eth::LogEntry& log) {
+        if (!MatchesHashList(addresses, log.address)) return false;
+        for (size_t i = 0; i < topics.size(); ++i) {
+            if (topics[i].empty()) continue;
+            if (i >= log.topics.size() || !MatchesHashList(topics[i], log.topics[i])) return false;
+        }
+        return true;
+    };
+
+    std::vector<TransactionReceiptInfo> receipts;
+    const CBlockIndex* pblockindex = ReadBlockReceipts(context, req, hashStr, receipts);
+    if (!pblockindex) return false;
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        DataStream ssLogs{};
+        uint64_t count = 0;
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            for (uint32_t logIndex = 0; logIndex < receipt.logs.size(); ++logIndex) {
+                if (!matches(receipt.logs[logIndex])) continue;
+                ssLogs << receipt.transactionHash << receipt.transactionIndex << receipt.outputIndex << logIndex;
+                SerializeLog(ssLogs, receipt.logs[logIndex]);
+                ++count;
+            }
+        }
+        DataStream ssHeader{};
+        ssHeader << pblockindex->GetBlockHash() << static_cast<uint32_t>(pblockindex->nHeight);
+        WriteCompactSize(ssHeader, count);
+        ssHeader << std::span{ssLogs};
+        if (rf == RESTResponseFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssHeader);
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssHeader) + "\n");
+        }
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue result(UniValue::VARR);
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            for (uint32_t logIndex = 0; logIndex < receipt.logs.size(); ++logIndex) {
+                if (!matches(receipt.logs[logIndex])) continue;
+                UniValue entry(UniValue::VOBJ);
+                entry.pushKV("blockHash", receipt.blockHash.GetHex());
+                entry.pushKV("blockNumber", uint64_t(receipt.blockNumber));
+                entry.pushKV("transactionHash", receipt.transactionHash.GetHex());
+                entry.pushKV("transactionIndex", uint64_t(receipt.transactionIndex));
+                entry.pushKV("outputIndex", uint64_t(receipt.outputIndex));
+                entry.pushKV("logIndex", uint64_t(logIndex));
+                assignJSON(entry, receipt.logs[logIndex], true);
+                result.push_back(std::move(entry));
+            }
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static UniValue ProofToJSON(const std::vector<dev::bytes>& proof)
+{
+    UniValue nodes(UniValue::VARR);
+    for (const dev::bytes& node : proof) {
+        nodes.push_back(HexStr(node));
+    }
+    return nodes;
+}
+
+static bool rest_contractstate(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string addressStr;
+    const RESTResponseFormat rf = ParseDataFormat(addressStr, strURIPart);
+
+    if (addressStr.size() != 40 || !IsHex(addressStr)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(addressStr));
+    }
+    const dev::Address address(addressStr);
+    std::vector<dev::h256> slots;
+    if (!ParseHashList(req, "slots", slots)) return false;
+    if (slots.size() > MAX_REST_STATE_SLOTS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max slots exceeded (max: %d, tried: %d)", MAX_REST_STATE_SLOTS, slots.size()));
+    }
+    std::optional<uint256> blockhash;
+    if (std::optional<std::string> blockhashStr = req->GetQueryParameter("blockhash")) {
+        blockhash = uint256::FromHex(*blockhashStr);
+        if (!blockhash) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + SanitizeString(*blockhashStr));
+        }
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+
+    // Proofs are checked against the hashStateRoot of the block, the tip unless one is given
+    const CBlockIndex* pblockindex = nullptr;
+    std::string account;
+    std::vector<dev::bytes> accountProof;
+    std::vector<std::pair<dev::h256, std::vector<dev::bytes>>> storageProofs;
+    std::vector<dev::h256> values;
+    {
+        LOCK(cs_main);
+        pblockindex = blockhash ? chainman.m_blockman.LookupBlockIndex(*blockhash) : chainman.ActiveChain().Tip();
+        if (!pblockindex || !chainman.ActiveChain().Contains(pblockindex)) {
+            return RESTERR(req, HTTP_NOT_FOUND, "Block not found in the active chain");
+        }
+        try {
+            account = globalState->proveAccount(uintToh256(pblockindex->hashStateRoot), address, accountProof);
+            const dev::h256 storageRoot = account.empty() ? dev::EmptyTrie : dev::RLP(account)[2].toHash<dev::h256>();
+            for (const dev::h256& slot : slots) {
+                std::vector<dev::bytes> proof;
+                const std::string value = globalState->proveStorage(storageRoot, slot, proof);
+                values.emplace_back(value.empty() ? dev::u256(0) : dev::RLP(value).toInt<dev::u256>());
+                storageProofs.emplace_back(slot, std::move(proof));
+            }
+        } catch (const dev::RootNotFound&) {
+            return RESTERR(req, HTTP_NOT_FOUND, "State of block " + pblockindex->GetBlockHash().GetHex() + " not available");
+        }
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        DataStream ssState{};
+        ssState << pblockindex->GetBlockHash() << HashBytes(uintToh256(pblockindex->hashStateRoot)) << HashBytes(address);
+        ssState << dev::bytes(account.begin(), account.end()) << accountProof;
+        WriteCompactSize(ssState, storageProofs.size());
+        for (size_t i = 0; i < storageProofs.size(); ++i) {
+            ssState << HashBytes(storageProofs[i].first) << HashBytes(values[i]) << storageProofs[i].second;
+        }
+        if (rf == RESTResponseFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssState);
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssState) + "\n");
+        }
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("blockhash", pblockindex->GetBlockHash().GetHex());
+        result.pushKV("height", pblockindex->nHeight);
+        result.pushKV("stateRoot", pblockindex->hashStateRoot.GetHex());
+        result.pushKV("address", address.hex());
+        if (account.empty()) {
+            result.pushKV("account", NullUniValue);
+        } else {
+            const dev::RLP state(account);
+            UniValue objAccount(UniValue::VOBJ);
+            objAccount.pushKV("nonce", state[0].toInt<dev::u256>().str());
+            objAccount.pushKV("balance", state[1].toInt<dev::u256>().str());
+            objAccount.pushKV("storageRoot", state[2].toHash<dev::h256>().hex());
+            objAccount.pushKV("codeHash", state[3].toHash<dev::h256>().hex());
+            result.pushKV("account", std::move(objAccount));
+        }
+        result.pushKV("accountProof", ProofToJSON(accountProof));
+        UniValue storage(UniValue::VARR);
+        for (size_t i = 0; i < storageProofs.size(); ++i) {
+            UniValue entry(UniValue::VOBJ);
+            entry.pushKV("key", storageProofs[i].first.hex());
+            entry.pushKV("value", values[i].hex());
+            entry.pushKV("proof", ProofToJSON(storageProofs[i].second));
+            storage.push_back(std::move(entry));
+        }
+        result.pushKV("storage", std::move(storage));
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_stratum_metrics(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+    if (!str_uri_part.empty()) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Invalid URI format. Expected /rest/stratum/metrics");
+    }
+
+    const stratum::StratumServer& server = stratum::GetStratumServer();
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, stratum::FormatPrometheus("wattx_stratum", server.GetMetrics(),
+                                                       server.GetConnectionMetrics(), server.GetValidationQueueDepth()));
+    return true;
+}
+
+static constexpr size_t MAX_REST_EXPLORER_BLOCKS = 100;
+static constexpr size_t DEFAULT_REST_EXPLORER_PAGE = 50;
+static constexpr size_t MAX_REST_EXPLORER_PAGE = 1000;
+
+/**
+ * Tag the reply with @p etag, and answer 304 Not Modified if the client
+ * already holds it. Explorer replies only change when the index moves, so
+ * their tag is the index's best block.
+ */
+static bool ExplorerNotModified(HTTPRequest* req, const std::string& etag)
+{
+    req->WriteHeader("ETag", etag);
+    const auto [present, if_none_match] = req->GetHeader("If-None-Match");
+    if (!present) return false;
+    for (const std::string& tag : SplitString(if_none_match, ',')) {
+        const std::string trimmed{TrimString(tag)};
+        if (trimmed == etag || trimmed == "W/" + etag || trimmed == "*") {
+            req->WriteReply(HTTP_NOT_MODIFIED);
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string ExplorerETag(const IndexSummary& summary)
+{
+    return "\"" + summary.best_block_hash.GetHex() + "\"";
+}
+
+/** Page size and order of an explorer list, newest first unless order=asc */
+static bool ParseExplorerPage(HTTPRequest* req, size_t& limit, bool& reverse)
+{
+    try {
+        const std::string raw_limit{req->GetQueryParameter("limit").value_or(ToString(DEFAULT_REST_EXPLORER_PAGE))};
+        const auto parsed_limit{ToIntegral<size_t>(raw_limit)};
+        if (!parsed_limit || *parsed_limit < 1 || *parsed_limit > MAX_REST_EXPLORER_PAGE) {
+            return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Limit is invalid or out of acceptable range (1-%u): %s", MAX_REST_EXPLORER_PAGE, raw_limit));
+        }
+        limit = *parsed_limit;
+        const std::string order{req->GetQueryParameter("order").value_or("desc")};
+        if (order != "asc" && order != "desc") {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid order (asc or desc): " + SanitizeString(order));
+        }
+        reverse = order == "desc";
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    return true;
+}
+
+/** Continuation key of an explorer list, from the "after" query parameter */
+template <typename Key>
+static bool ParseExplorerCursor(HTTPRequest* req, std::optional<Key>& after)
+{
+    std::optional<std::string> param;
+    try {
+        param = req->GetQueryParameter("after");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    if (!param) return true;
+    try {
+        if (!IsHex(*param)) throw std::ios_base::failure("not hex");
+        DataStream ss{ParseHex(*param)};
+        ss >> after.emplace();
+        if (!ss.empty()) throw std::ios_base::failure("trailing data");
+    } catch (const std::ios_base::failure&) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid continuation key: " + SanitizeString(*param));
+    }
+    return true;
+}
+
+template <typename Key>
+static std::string ExplorerCursor(const Key& key)
+{
+    DataStream ss{};
+    ss << key;
+    return HexStr(ss);
+}
+
+static ExplorerIndex* GetExplorerIndex(HTTPRequest* req)
+{
+    if (!g_explorerindex) {
+        RESTERR(req, HTTP_NOT_FOUND, "Explorer index is not enabled (-explorerindex)");
+        return nullptr;
+    }
+    return g_explorerindex.get();
+}
+
+static UniValue ExplorerBlockSummaryToJSON(int height, const ExplorerBlockSummary& summary)
+{
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("height", height);
+    entry.pushKV("hash", summary.hash.GetHex());
+    entry.pushKV("time", uint64_t(summary.time));
+    entry.pushKV("size", uint64_t(summary.size));
+    entry.pushKV("nTx", uint64_t(summary.tx_count));
+    entry.pushKV("contracttxs", uint64_t(summary.contract_tx_count));
+    entry.pushKV("tokentransfers", uint64_t(summary.token_transfer_count));
+    entry.pushKV("proofofstake", summary.proof_of_stake);
+    CTxDestination dest;
+    if (ExtractDestination(summary.staker, dest)) {
+        entry.pushKV("staker", EncodeDestination(dest));
+    }
+    entry.pushKV("stakerscript", HexStr(summary.staker));
+    if (summary.proof_of_stake) {
+        entry.pushKV("trusttier", ToLower(trust::TrustTierToString(static_cast<trust::TrustTier>(summary.trust_tier))));
+    }
+    entry.pushKV("reward", ValueFromAmount(summary.reward));
+    return entry;
+}
+
+/**
+ * /rest/explorer/blocks/<height>.json?count=<count> lists the summaries of
+ * count blocks down from height, /rest/explorer/blocks.json?count=<count>
+ * those down from the index's best block.
+ */
+static bool rest_explorer_blocks(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf != RESTResponseFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    const ExplorerIndex* index = GetExplorerIndex(req);
+    if (!index) return false;
+    const IndexSummary index_summary{index->GetSummary()};
+
+    int height{index_summary.best_block_height};
+    if (!param.empty()) {
+        const auto parsed_height{param[0] == '/' ? ToIntegral<int32_t>(param.substr(1)) : std::nullopt};
+        if (!parsed_height || *parsed_height < 0) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + SanitizeString(param));
+        }
+        if (*parsed_height > index_summary.best_block_height) {
+            return RESTERR(req, HTTP_NOT_FOUND, strprintf("Block height %d not indexed yet", *parsed_height));
+        }
+        height = *parsed_height;
+    }
+    std::string raw_count;
+    try {
+        raw_count = req->GetQueryParameter("count").value_or("10");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const auto parsed_count{ToIntegral<size_t>(raw_count)};
+    if (!parsed_count || *parsed_count < 1 || *parsed_count > MAX_REST_EXPLORER_BLOCKS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Block count is invalid or out of acceptable range (1-%u): %s", MAX_REST_EXPLORER_BLOCKS, raw_count));
+    }
+
+    if (ExplorerNotModified(req, ExplorerETag(index_summary))) return true;
+
+    std::vector<std::pair<int, ExplorerBlockSummary>> summaries;
+    const int first{std::max(0, height - static_cast<int>(*parsed_count) + 1)};
+    if (!index->ReadBlockSummaries(first, height, summaries)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read the explorer index");
+    }
+    UniValue result(UniValue::VARR);
+    for (auto it = summaries.rbegin(); it != summaries.rend(); ++it) {
+        result.push_back(ExplorerBlockSummaryToJSON(it->first, it->second));
+    }
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, result.write() + "\n");
+    return true;
+}
+
+/** /rest/explorer/address/<address>.json?limit=<n>&after=<key>&order=<asc|desc> pages the balance changes of an address */
+static bool rest_explorer_address(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string address;
+    const RESTResponseFormat rf = ParseDataFormat(address, strURIPart);
+    if (rf != RESTResponseFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    if (!g_addressindex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled (-addrindex)");
+    }
+    uint256 hash_bytes;
+    int type{0};
+    if (!DecodeIndexKey(address, hash_bytes, type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address));
+    }
+    size_t limit;
+    bool reverse;
+    std::optional<CAddressIndexKey> after;
+    if (!ParseExplorerPage(req, limit, reverse) || !ParseExplorerCursor(req, after)) return false;
+    if (after && (after->hashBytes != hash_bytes || after->type != type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Continuation key belongs to another address");
+    }
+
+    if (ExplorerNotModified(req, ExplorerETag(g_addressindex->GetSummary()))) return true;
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> entries;
+    bool more{false};
+    if (!GetAddressIndexPage(hash_bytes, type, 0, 0, after ? &*after : nullptr, limit, reverse, entries, more)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read the address index");
+    }
+    UniValue deltas(UniValue::VARR);
+    for (const auto& [key, satoshis] : entries) {
+        UniValue delta(UniValue::VOBJ);
+        delta.pushKV("satoshis", satoshis);
+        delta.pushKV("txid", key.txhash.GetHex());
+        delta.pushKV("index", (int)key.index);
+        delta.pushKV("blockindex", (int)key.txindex);
+        delta.pushKV("height", key.blockHeight);
+        deltas.push_back(std::move(delta));
+    }
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("address", address);
+    result.pushKV("deltas", std::move(deltas));
+    if (more) result.pushKV("next", ExplorerCursor(entries.back().first));
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, result.write() + "\n");
+    return true;
+}
+
+/** /rest/explorer/tokentransfers/<contract>.json?limit=<n>&after=<key>&order=<asc|desc> pages the Transfer events of a token contract */
+static bool rest_explorer_token_transfers(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string contract_str;
+    const RESTResponseFormat rf = ParseDataFormat(contract_str, strURIPart);
+    if (rf != RESTResponseFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    const ExplorerIndex* index = GetExplorerIndex(req);
+    if (!index) return false;
+    const auto contract{uint160::FromHex(contract_str)};
+    if (!contract) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid contract address: " + SanitizeString(contract_str));
+    }
+    size_t limit;
+    bool reverse;
+    std::optional<TokenTransferKey> after;
+    if (!ParseExplorerPage(req, limit, reverse) || !ParseExplorerCursor(req, after)) return false;
+    if (after && after->contract != *contract) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Continuation key belongs to another contract");
+    }
+
+    if (ExplorerNotModified(req, ExplorerETag(index->GetSummary()))) return true;
+
+    std::vector<std::pair<TokenTransferKey, TokenTransfer>> transfers;
+    bool more{false};
+    if (!index->ReadTokenTransfers(*contract, after ? &*after : nullptr, limit, reverse, transfers, more)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read the explorer index");
+    }
+    UniValue entries(UniValue::VARR);
+    for (const auto& [key, transfer] : transfers) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("txid", transfer.txid.GetHex());
+        entry.pushKV("height", uint64_t(key.height));
+        entry.pushKV("blockindex", uint64_t(key.tx_index));
+        entry.pushKV("logindex", uint64_t(key.log_index));
+        entry.pushKV("from", transfer.from.GetHex());
+        entry.pushKV("to", transfer.to.GetHex());
+        entry.pushKV(transfer.nft ? "tokenid" : "value", HexStr(transfer.value));
+        entries.push_back(std::move(entry));
+    }
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("contract", contract->GetHex());
+    result.pushKV("transfers", std::move(entries));
+    if (more) result.pushKV("next", ExplorerCursor(transfers.back().first));
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, result.write() + "\n");
+    return true;
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1021,6 +1666,13 @@ static const struct {
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/receipts/", rest_receipts},
+      {"/rest/logs/", rest_logs},
+      {"/rest/contractstate/", rest_contractstate},
+      {"/rest/stratum/metrics", rest_stratum_metrics},
+      {"/rest/explorer/blocks", rest_explorer_blocks},
+      {"/rest/explorer/address/", rest_explorer_address},
+      {"/rest/explorer/tokentransfers/", rest_explorer_token_transfers},
 };
 
 void StartREST(const std::any& context)
@@ -2,12 +2,14 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <anchor/anchor_aggregator.h>
 #include <anchor/evm_anchor.h>
 #include <anchor/private_swap.h>
 #include <auxpow/auxpow.h>
 #include <chainparams.h>
 #include <consensus/params.h>
 #include <core_io.h>
+#include <index/anchorindex.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/transaction.h>
@@ -26,6 +28,24 @@
 
 using node::NodeContext;
 
+static const RPCResult ANCHORED_RESULT{RPCResult::Type::OBJ, "anchored", /*optional=*/true, "Where the anchor was found on chain (only with -anchorindex)",
+    {
+        {RPCResult::Type::STR_HEX, "blockhash", "Block carrying the anchor"},
+        {RPCResult::Type::NUM, "height", "Height of that block"},
+        {RPCResult::Type::STR_HEX, "txid", "Transaction carrying the anchor, the parent coinbase for a merge mined block"},
+        {RPCResult::Type::NUM, "vout", "Output carrying the anchor, -1 for the coinbase input"},
+    }};
+
+static UniValue AnchorLocationToJSON(const AnchorLocation& location)
+{
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("blockhash", location.block_hash.GetHex());
+    result.pushKV("height", location.height);
+    result.pushKV("txid", location.txid.GetHex());
+    result.pushKV("vout", location.vout);
+    return result;
+}
+
 static RPCHelpMan getevmanchorinfo()
 {
     return RPCHelpMan{"getevmanchorinfo",
@@ -91,6 +111,7 @@ static RPCHelpMan getevmanchor()
                 {RPCResult::Type::NUM, "timestamp", "Block timestamp"},
                 {RPCResult::Type::STR_HEX, "anchor_hash", "Unique anchor identifier"},
                 {RPCResult::Type::BOOL, "valid", "Whether anchor data is valid"},
+                ANCHORED_RESULT,
             }},
         RPCExamples{
             HelpExampleCli("getevmanchor", "\"blockhash\"")
@@ -131,6 +152,11 @@ static RPCHelpMan getevmanchor()
             result.pushKV("anchor_hash", anchor.GetHash().GetHex());
             result.pushKV("valid", anchor.IsValid());
 
+            AnchorLocation location;
+            if (g_anchorindex && g_anchorindex->FindEVMAnchorByHeight(pblockindex->nHeight, location)) {
+                result.pushKV("anchored", AnchorLocationToJSON(location));
+            }
+
             return result;
         },
     };
@@ -295,6 +321,216 @@ static RPCHelpMan setevmanchoractivation()
     };
 }
 
+static UniValue AggregateToJSON(const evm_anchor::AggregateAnchor& aggregate)
+{
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("root", aggregate.root.GetHex());
+    result.pushKV("item_count", (uint64_t)aggregate.item_count);
+    result.pushKV("timestamp", aggregate.timestamp);
+    result.pushKV("anchor_tag", HexStr(evm_anchor::AnchorAggregator::BuildAggregateTag(aggregate)));
+    return result;
+}
+
+static const RPCResult AGGREGATE_RESULT{RPCResult::Type::OBJ, "aggregate", /*optional=*/true, "The aggregate anchor of the window closed by this call",
+    {
+        {RPCResult::Type::STR_HEX, "root", "Merkle root of the window's commitments"},
+        {RPCResult::Type::NUM, "item_count", "Number of commitments under the root"},
+        {RPCResult::Type::NUM, "timestamp", "When the window was closed"},
+        {RPCResult::Type::STR_HEX, "anchor_tag", "Anchor tag for the Monero coinbase extra field"},
+    }};
+
+static RPCHelpMan setevmanchoraggregation()
+{
+    return RPCHelpMan{"setevmanchoraggregation",
+        "\nSet how anchor commitments are aggregated under one anchored merkle root.\n"
+        "A window of commitments closes once it holds max_items commitments or its first one is max_age seconds old.\n",
+        {
+            {"max_items", RPCArg::Type::NUM, RPCArg::Default{256}, "Commitments per aggregate"},
+            {"max_age", RPCArg::Type::NUM, RPCArg::Default{600}, "Seconds a window stays open"},
+            {"aggregate_block_anchors", RPCArg::Type::BOOL, RPCArg::Default{false}, "Whether merged mining jobs anchor aggregates of the blocks found rather than one anchor per block"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::NUM, "max_items", "Commitments per aggregate"},
+                {RPCResult::Type::NUM, "max_age", "Seconds a window stays open"},
+                {RPCResult::Type::BOOL, "aggregate_block_anchors", "Whether block anchors are aggregated"},
+            }},
+        RPCExamples{
+            HelpExampleCli("setevmanchoraggregation", "1000 3600 true")
+            + HelpExampleRpc("setevmanchoraggregation", "1000, 3600, true")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            auto& aggregator = evm_anchor::GetAnchorAggregator();
+            auto options = aggregator.GetOptions();
+            const int64_t max_items = request.params[0].isNull() ? 256 : request.params[0].getInt<int64_t>();
+            options.max_age = request.params[1].isNull() ? 600 : request.params[1].getInt<int64_t>();
+            options.aggregate_block_anchors = !request.params[2].isNull() && request.params[2].get_bool();
+            if (max_items < 1 || max_items > UINT32_MAX || options.max_age < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "max_items must be positive and max_age non-negative");
+            }
+            options.max_items = max_items;
+            aggregator.SetOptions(options);
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("max_items", (uint64_t)options.max_items);
+            result.pushKV("max_age", options.max_age);
+            result.pushKV("aggregate_block_anchors", options.aggregate_block_anchors);
+
+            return result;
+        },
+    };
+}
+
+static RPCHelpMan submitanchorcommitment()
+{
+    return RPCHelpMan{"submitanchorcommitment",
+        "\nAdd a 32 byte commitment (an EVM anchor hash, or a relayer's batch commitment) to the open aggregation window.\n"
+        "Its inclusion proof is available from getanchorproof once the window closes.\n",
+        {
+            {"commitment", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The commitment"},
+            {"flush", RPCArg::Type::BOOL, RPCArg::Default{false}, "Close the window now"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::BOOL, "added", "False if the commitment was already aggregated or pending"},
+                {RPCResult::Type::NUM, "pending", "Commitments waiting in the open window"},
+                AGGREGATE_RESULT,
+            }},
+        RPCExamples{
+            HelpExampleCli("submitanchorcommitment", "\"commitment\"")
+            + HelpExampleRpc("submitanchorcommitment", "\"commitment\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            uint256 commitment = ParseHashV(request.params[0], "commitment");
+            bool flush = !request.params[1].isNull() && request.params[1].get_bool();
+
+            auto& aggregator = evm_anchor::GetAnchorAggregator();
+            const int64_t now = GetTime();
+            bool added = aggregator.Add(commitment, now);
+            auto aggregate = flush ? aggregator.Flush(now) : aggregator.Poll(now);
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("added", added);
+            result.pushKV("pending", (uint64_t)aggregator.GetPendingCount());
+            if (aggregate) {
+                result.pushKV("aggregate", AggregateToJSON(*aggregate));
+            }
+
+            return result;
+        },
+    };
+}
+
+static RPCHelpMan getanchorproof()
+{
+    return RPCHelpMan{"getanchorproof",
+        "\nGet the inclusion proof of an aggregated anchor commitment.\n",
+        {
+            {"commitment", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The commitment"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "commitment", "The commitment"},
+                {RPCResult::Type::STR_HEX, "root", "Aggregate root the commitment is under"},
+                {RPCResult::Type::NUM, "index", "Position of the commitment in its aggregate"},
+                {RPCResult::Type::ARR, "branch", "Merkle branch from the commitment to the root",
+                    {
+                        {RPCResult::Type::STR_HEX, "", "Sibling hash"},
+                    }},
+                ANCHORED_RESULT,
+            }},
+        RPCExamples{
+            HelpExampleCli("getanchorproof", "\"commitment\"")
+            + HelpExampleRpc("getanchorproof", "\"commitment\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            uint256 commitment = ParseHashV(request.params[0], "commitment");
+
+            auto& aggregator = evm_anchor::GetAnchorAggregator();
+            evm_anchor::AnchorInclusionProof proof;
+            if (!aggregator.GetProof(commitment, proof)) {
+                if (aggregator.IsPending(commitment)) {
+                    throw JSONRPCError(RPC_MISC_ERROR, "Commitment is waiting in the open aggregation window");
+                }
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Commitment not found");
+            }
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("commitment", proof.commitment.GetHex());
+            result.pushKV("root", proof.root.GetHex());
+            result.pushKV("index", proof.branch.nIndex);
+            UniValue branch(UniValue::VARR);
+            for (const auto& hash : proof.branch.vHash) {
+                branch.push_back(hash.GetHex());
+            }
+            result.pushKV("branch", branch);
+
+            AnchorLocation location;
+            if (g_anchorindex && g_anchorindex->FindAggregateAnchor(proof.root, location)) {
+                result.pushKV("anchored", AnchorLocationToJSON(location));
+            }
+
+            return result;
+        },
+    };
+}
+
+static RPCHelpMan verifyanchorproof()
+{
+    return RPCHelpMan{"verifyanchorproof",
+        "\nVerify that a commitment is included under an anchored aggregate root.\n",
+        {
+            {"commitment", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The commitment"},
+            {"root", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The aggregate root"},
+            {"index", RPCArg::Type::NUM, RPCArg::Optional::NO, "Position of the commitment in its aggregate"},
+            {"branch", RPCArg::Type::ARR, RPCArg::Optional::NO, "Merkle branch from the commitment to the root",
+                {
+                    {"hash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Sibling hash"},
+                },
+            },
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::BOOL, "valid", "Whether the branch leads from the commitment to the root"},
+                ANCHORED_RESULT,
+            }},
+        RPCExamples{
+            HelpExampleCli("verifyanchorproof", "\"commitment\" \"root\" 3 '[\"hash\",...]'")
+            + HelpExampleRpc("verifyanchorproof", "\"commitment\", \"root\", 3, [\"hash\",...]")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            evm_anchor::AnchorInclusionProof proof;
+            proof.commitment = ParseHashV(request.params[0], "commitment");
+            proof.root = ParseHashV(request.params[1], "root");
+            proof.branch.nIndex = request.params[2].getInt<int>();
+            if (proof.branch.nIndex < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Index must be non-negative");
+            }
+            for (const auto& hash : request.params[3].get_array().getValues()) {
+                proof.branch.vHash.push_back(ParseHashV(hash, "branch"));
+            }
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("valid", proof.Verify());
+
+            AnchorLocation location;
+            if (g_anchorindex && g_anchorindex->FindAggregateAnchor(proof.root, location)) {
+                result.pushKV("anchored", AnchorLocationToJSON(location));
+            }
+
+            return result;
+        },
+    };
+}
+
 // ============================================================================
 // Private Swap RPC Commands
 // ============================================================================
@@ -385,6 +621,7 @@ static RPCHelpMan getswap()
                 {RPCResult::Type::STR, "state", "Swap state"},
                 {RPCResult::Type::NUM, "created_at", "Creation timestamp"},
                 {RPCResult::Type::NUM, "expires_at", "Expiration timestamp"},
+                ANCHORED_RESULT,
             }},
         RPCExamples{
             HelpExampleCli("getswap", "\"swap_id\" \"view_key\"")
@@ -403,7 +640,20 @@ static RPCHelpMan getswap()
             auto& swap_mgr = private_swap::GetPrivateSwapManager();
 
             private_swap::PrivateSwapData swap;
-            if (!swap_mgr.GetSwap(swap_id, view_key, swap)) {
+            bool found = swap_mgr.GetSwap(swap_id, view_key, swap);
+
+            // Swaps of other nodes are found on chain by their swap key tag
+            AnchorLocation location;
+            bool anchored = false;
+            if (g_anchorindex) {
+                const uint256 swap_key_tag{private_swap::EncryptedSwapAnchor::DeriveSwapKeyTag(swap_id, view_key)};
+                anchored = g_anchorindex->FindSwapAnchor(swap_key_tag, location);
+                private_swap::EncryptedSwapAnchor encrypted;
+                if (!found && anchored && private_swap::EncryptedSwapAnchor::Deserialize(location.payload, encrypted)) {
+                    found = private_swap::EncryptedSwapAnchor::Decrypt(encrypted, view_key, swap) && swap.swap_id == swap_id;
+                }
+            }
+            if (!found) {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "Swap not found or invalid view key");
             }
 
@@ -426,6 +676,9 @@ static RPCHelpMan getswap()
                 result.pushKV("evm_tx_hash", swap.evm_tx_hash.GetHex());
                 result.pushKV("evm_state_root", swap.evm_state_root.GetHex());
             }
+            if (anchored) {
+                result.pushKV("anchored", AnchorLocationToJSON(location));
+            }
 
             return result;
         },
@@ -825,6 +1078,10 @@ void RegisterAnchorRPCCommands(CRPCTable& t)
         {"anchor", &verifyevmanchor},
         {"anchor", &getevmtxlist},
         {"anchor", &setevmanchoractivation},
+        {"anchor", &setevmanchoraggregation},
+        {"anchor", &submitanchorcommitment},
+        {"anchor", &getanchorproof},
+        {"anchor", &verifyanchorproof},
         // Private swap commands
         {"swap", &initiateswap},
         {"swap", &getswap},
@@ -28,6 +28,7 @@
 #include <net.h>
 #include <net_processing.h>
 #include <node/blockstorage.h>
+#include <node/connect_stats.h>
 #include <node/context.h>
 #include <node/transaction.h>
 #include <node/utxo_snapshot.h>
@@ -58,6 +59,7 @@
 #include <txdb.h>
 #include <util/convert.h>
 #include <qtum/qtumdelegation.h>
+#include <qtum/evmstats.h>
 #include <util/tokenstr.h>
 #include <rpc/contract_util.h>
 
@@ -79,7 +81,7 @@ using node::NodeContext;
 using node::SnapshotMetadata;
 using util::MakeUnorderedList;
 
-std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
+std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*, node::SnapshotPrivacyState>
 PrepareUTXOSnapshot(
     Chainstate& chainstate,
     const std::function<void()>& interruption_point = {})
@@ -90,6 +92,7 @@ UniValue WriteUTXOSnapshot(
     CCoinsViewCursor* pcursor,
     CCoinsStats* maybe_stats,
     const CBlockIndex* tip,
+    const node::SnapshotPrivacyState& privacy_state,
     AutoFile& afile,
     const fs::path& path,
     const fs::path& temppath,
@@ -343,6 +346,23 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
 
     result.pushKV("tx", std::move(txs));
 
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    if (verbosity == TxVerbosity::SHOW_DETAILS_AND_PREVOUT && block.IsProofOfStake() &&
+        IsTrustTierActive(blockindex.nHeight, consensusParams)) {
+        const std::shared_ptr<const TieredRewardSchedule> schedule = GetTieredRewardSchedule(blockindex.nHeight, consensusParams);
+        UniValue tiers(UniValue::VOBJ);
+        for (size_t i = 0; i < schedule->tiers.size(); ++i) {
+            UniValue tier(UniValue::VOBJ);
+            tier.pushKV("multiplier", schedule->tiers[i].multiplier);
+            tier.pushKV("reward", ValueFromAmount(schedule->tiers[i].reward));
+            tiers.pushKV(ToLower(trust::TrustTierToString(static_cast<trust::TrustTier>(i))), std::move(tier));
+        }
+        UniValue rewardSchedule(UniValue::VOBJ);
+        rewardSchedule.pushKV("basereward", ValueFromAmount(schedule->baseReward));
+        rewardSchedule.pushKV("tiers", std::move(tiers));
+        result.pushKV("rewardschedule", std::move(rewardSchedule));
+    }
+
     return result;
 }
 
@@ -1158,6 +1178,18 @@ static RPCHelpMan getblock()
                             getblock_vin,
                         }},
                     }},
+                    {RPCResult::Type::OBJ, "rewardschedule", /*optional=*/true, "Reward of each trust tier, for proof-of-stake blocks once trust tiers are active",
+                    {
+                        {RPCResult::Type::STR_AMOUNT, "basereward", "The block subsidy the multipliers apply to"},
+                        {RPCResult::Type::OBJ_DYN, "tiers", "",
+                        {
+                            {RPCResult::Type::OBJ, "tier", "Trust tier name (none, bronze, silver, gold or platinum)",
+                            {
+                                {RPCResult::Type::NUM, "multiplier", "Reward multiplier in percent (100 = 1.0x)"},
+                                {RPCResult::Type::STR_AMOUNT, "reward", "The block reward of a staker in this tier"},
+                            }},
+                        }},
+                    }},
                 }},
         },
                 RPCExamples{
@@ -1526,6 +1558,51 @@ RPCHelpMan waitforlogs()
     };
 }
 
+static std::vector<RPCResult> SearchLogsReceiptDoc()
+{
+    return {
+        {RPCResult::Type::STR_HEX, "blockHash", "The block hash"},
+        {RPCResult::Type::NUM, "blockNumber", "The block number"},
+        {RPCResult::Type::STR_HEX, "transactionHash", "The transaction hash"},
+        {RPCResult::Type::NUM, "transactionIndex", "The transaction index"},
+        {RPCResult::Type::NUM, "outputIndex", "The output index"},
+        {RPCResult::Type::STR_HEX, "from", "The from address"},
+        {RPCResult::Type::STR_HEX, "to", "The to address"},
+        {RPCResult::Type::NUM, "cumulativeGasUsed", "The cumulative gas used"},
+        {RPCResult::Type::NUM, "gasUsed", "The gas used"},
+        {RPCResult::Type::STR_HEX, "contractAddress", "The contract address"},
+        {RPCResult::Type::STR, "excepted", "The thrown exception"},
+        {RPCResult::Type::STR, "exceptedMessage", "The thrown exception message"},
+        {RPCResult::Type::STR_HEX, "bloom", "Bloom filter for light clients to quickly retrieve related logs"},
+        {RPCResult::Type::STR_HEX, "stateRoot", "The hash state root"},
+        {RPCResult::Type::STR_HEX, "utxoRoot", "The hash UTXO root"},
+        {RPCResult::Type::ARR, "log", "The logs from the receipt",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_HEX, "address", "The contract address"},
+                        {RPCResult::Type::ARR, "topics", "The topic",
+                            {{RPCResult::Type::STR_HEX, "topic", "The topic"}}},
+                        {RPCResult::Type::STR_HEX, "data", "The logged data"},
+                    }
+                }
+            }
+        },
+        {RPCResult::Type::ARR, "createdContracts", "The created contracts",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_HEX, "address", "The contract address"},
+                        {RPCResult::Type::STR_HEX, "code", "The contract code"},
+                    }
+                }
+            }
+        },
+        {RPCResult::Type::ARR, "destructedContracts", "The destructed contracts",
+            {{RPCResult::Type::STR_HEX, "", "The contract"}}},
+    };
+}
+
 RPCHelpMan searchlogs()
 {
     return RPCHelpMan{"searchlogs",
@@ -1550,53 +1627,23 @@ RPCHelpMan searchlogs()
                         },
                     }},
                     {"minconf", RPCArg::Type::NUM, RPCArg::Default{0}, "Minimal number of confirmations before a log is returned"},
+                    {"limit", RPCArg::Type::NUM, RPCArg::Default{0}, "Stop at the end of the block in which this many transactions with matching logs are found, 0 for no limit. Continue from nextblock to get the next page"},
                 },
-                RPCResult{
+                {
+                    RPCResult{"if limit is 0",
             RPCResult::Type::ARR, "", "",
                 {
-                    {RPCResult::Type::OBJ, "", "",
-                        {
-                            {RPCResult::Type::STR_HEX, "blockHash", "The block hash"},
-                            {RPCResult::Type::NUM, "blockNumber", "The block number"},
-                            {RPCResult::Type::STR_HEX, "transactionHash", "The transaction hash"},
-                            {RPCResult::Type::NUM, "transactionIndex", "The transaction index"},
-                            {RPCResult::Type::NUM, "outputIndex", "The output index"},
-                            {RPCResult::Type::STR_HEX, "from", "The from address"},
-                            {RPCResult::Type::STR_HEX, "to", "The to address"},
-                            {RPCResult::Type::NUM, "cumulativeGasUsed", "The cumulative gas used"},
-                            {RPCResult::Type::NUM, "gasUsed", "The gas used"},
-                            {RPCResult::Type::STR_HEX, "contractAddress", "The contract address"},
-                            {RPCResult::Type::STR, "excepted", "The thrown exception"},
-                            {RPCResult::Type::STR, "exceptedMessage", "The thrown exception message"},
-                            {RPCResult::Type::STR_HEX, "bloom", "Bloom filter for light clients to quickly retrieve related logs"},
-                            {RPCResult::Type::STR_HEX, "stateRoot", "The hash state root"},
-                            {RPCResult::Type::STR_HEX, "utxoRoot", "The hash UTXO root"},
-                            {RPCResult::Type::ARR, "log", "The logs from the receipt",
-                                {
-                                    {RPCResult::Type::OBJ, "", "",
-                                        {
-                                            {RPCResult::Type::STR_HEX, "address", "The contract address"},
-                                            {RPCResult::Type::ARR, "topics", "The topic",
-                                                {{RPCResult::Type::STR_HEX, "topic", "The topic"}}},
-                                            {RPCResult::Type::STR_HEX, "data", "The logged data"},
-                                        }
-                                    }
-                                }
-                            },
-                            {RPCResult::Type::ARR, "createdContracts", "The created contracts",
-                                {
-                                    {RPCResult::Type::OBJ, "", "",
-                                        {
-                                            {RPCResult::Type::STR_HEX, "address", "The contract address"},
-                                            {RPCResult::Type::STR_HEX, "code", "The contract code"},
-                                        }
-                                    }
-                                }
-                            },
-                            {RPCResult::Type::ARR, "destructedContracts", "The destructed contracts",
-                                {{RPCResult::Type::STR_HEX, "", "The contract"}}},
-                        }}
+                    {RPCResult::Type::OBJ, "", "", SearchLogsReceiptDoc()},
                 }},
+                    RPCResult{"if limit is set",
+            RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::ARR, "entries", "The receipts, as above",
+                        {{RPCResult::Type::OBJ, "", "", SearchLogsReceiptDoc()}}},
+                    {RPCResult::Type::NUM, "count", "How many receipts were returned"},
+                    {RPCResult::Type::NUM, "nextblock", "The block to search from for the next page"},
+                }},
+                },
                 RPCExamples{
                     HelpExampleCli("searchlogs", "0 100 '{\"addresses\": [\"12ae42729af478ca92c8c66773a3e32115717be4\"]}' '{\"topics\": [null,\"b436c2bf863ccd7b8f63171201efd4792066b4ce8e543dde9c3e9e9ab98e216c\"]}'")
             + HelpExampleRpc("searchlogs", "0 100 '{\"addresses\": [\"12ae42729af478ca92c8c66773a3e32115717be4\"]} {\"topics\": [null,\"b436c2bf863ccd7b8f63171201efd4792066b4ce8e543dde9c3e9e9ab98e216c\"]}'")
@@ -1604,7 +1651,7 @@ RPCHelpMan searchlogs()
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
-    return SearchLogs(request.params, chainman);
+    return SearchLogs(request, chainman);
 },
     };
 }
@@ -1869,7 +1916,7 @@ uint64_t getDelegateWeight(const uint160& keyid, const std::map<COutPoint, uint3
 
     // Get address weight
     uint64_t weight = 0;
-    if (!GetAddressWeight(hashBytes, type, immatureStakes, height, weight, blockman)) {
+    if (!GetAddressWeight(hashBytes, type, immatureStakes, height, weight)) {
         return 0;
     }
 
@@ -2017,6 +2064,204 @@ RPCHelpMan listcontracts()
     };
 }
 
+static RPCHelpMan getevmstats()
+{
+    return RPCHelpMan{"getevmstats",
+                "\nReturns the contracts that took the most EVM work since the statistics were reset, to find hot or abusive contracts.\n"
+                "Executions are counted for the contract a transaction or call enters, with the contracts it called included.\n"
+                "Storage accesses are counted for the contract whose storage they touch.\n"
+                "At most " + util::ToString(MAX_EVM_STATS_CONTRACTS) + " contracts are kept, the one with the least gas used makes room for a new one.",
+                {
+                    {"count", RPCArg::Type::NUM, RPCArg::Default{10}, "The number of contracts to return"},
+                    {"sortby", RPCArg::Type::STR, RPCArg::Default{"gas"}, "What to rank the contracts by: gas, time, sloads, sstores or dbreads"},
+                    {"reset", RPCArg::Type::BOOL, RPCArg::Default{false}, "Reset the statistics after reading them"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM_TIME, "since", "The " + UNIX_EPOCH_TIME + " the statistics were last reset"},
+                        {RPCResult::Type::NUM, "contracts", "The number of contracts with statistics"},
+                        {RPCResult::Type::ARR, "top", "The contracts ranked by sortby, highest first",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR_HEX, "address", "The contract address"},
+                                {RPCResult::Type::NUM, "blockexecutions", "Contract transactions of connected blocks that entered the contract"},
+                                {RPCResult::Type::NUM, "callexecutions", "Calls by callcontract or eth_call that entered the contract"},
+                                {RPCResult::Type::NUM, "gasused", "Gas used by those executions"},
+                                {RPCResult::Type::NUM, "time", "Time spent in those executions, in milliseconds"},
+                                {RPCResult::Type::NUM, "sloads", "Reads of the contract's storage"},
+                                {RPCResult::Type::NUM, "sstores", "Writes of the contract's storage"},
+                                {RPCResult::Type::NUM, "dbreads", "State database reads from disk for the contract's storage, missing the in-memory caches"},
+                            }},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getevmstats", "")
+            + HelpExampleCli("getevmstats", "20 \"dbreads\"")
+            + HelpExampleRpc("getevmstats", "20, \"time\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const int count = request.params[0].isNull() ? 10 : request.params[0].getInt<int>();
+    if (count < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid count, must be non-negative");
+    }
+    const std::string sortBy = request.params[1].isNull() ? "gas" : request.params[1].get_str();
+    static const std::map<std::string, uint64_t EvmContractStats::*> rankings{
+        {"gas", &EvmContractStats::gasUsed},
+        {"time", &EvmContractStats::micros},
+        {"sloads", &EvmContractStats::sloads},
+        {"sstores", &EvmContractStats::sstores},
+        {"dbreads", &EvmContractStats::dbReads},
+    };
+    const auto ranking = rankings.find(sortBy);
+    if (ranking == rankings.end()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sortby: " + sortBy);
+    }
+    const uint64_t EvmContractStats::* key = ranking->second;
+
+    const int64_t since = GetEvmStatsResetTime();
+    std::vector<std::pair<dev::Address, EvmContractStats>> stats = GetEvmContractStats();
+    if (!request.params[2].isNull() && request.params[2].get_bool()) {
+        ResetEvmContractStats();
+    }
+
+    const size_t top = std::min(stats.size(), static_cast<size_t>(count));
+    std::partial_sort(stats.begin(), stats.begin() + top, stats.end(), [key](const auto& a, const auto& b) {
+        return a.second.*key > b.second.*key;
+    });
+
+    UniValue contracts(UniValue::VARR);
+    for (size_t i = 0; i < top; ++i) {
+        const auto& [address, contract] = stats[i];
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("address", address.hex());
+        obj.pushKV("blockexecutions", contract.blockExecutions);
+        obj.pushKV("callexecutions", contract.callExecutions);
+        obj.pushKV("gasused", contract.gasUsed);
+        obj.pushKV("time", contract.micros / 1000.0);
+        obj.pushKV("sloads", contract.sloads);
+        obj.pushKV("sstores", contract.sstores);
+        obj.pushKV("dbreads", contract.dbReads);
+        contracts.push_back(std::move(obj));
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("since", since);
+    result.pushKV("contracts", stats.size());
+    result.pushKV("top", std::move(contracts));
+    return result;
+},
+    };
+}
+
+static RPCHelpMan getblockconnectstats()
+{
+    std::vector<RPCResult> phase_results;
+    for (size_t phase = 0; phase < node::CONNECT_PHASE_COUNT; ++phase) {
+        phase_results.emplace_back(RPCResult::Type::OBJ, node::ConnectPhaseName(static_cast<node::ConnectPhase>(phase)), "Statistics of the phase, in milliseconds",
+            std::vector<RPCResult>{{RPCResult::Type::ELISION, "", "same fields as total"}});
+    }
+    std::vector<RPCResult> total_fields{
+        {RPCResult::Type::NUM, "ema", "Exponential moving average over about the last 100 blocks"},
+        {RPCResult::Type::NUM, "mean", "Mean over the window"},
+        {RPCResult::Type::NUM, "p50", "Median over the window"},
+        {RPCResult::Type::NUM, "p90", "90th percentile over the window"},
+        {RPCResult::Type::NUM, "p99", "99th percentile over the window"},
+        {RPCResult::Type::NUM, "max", "Slowest over the window"},
+    };
+    phase_results.emplace_back(RPCResult::Type::OBJ, "total", "Statistics of the whole block connection, in milliseconds", total_fields);
+
+    return RPCHelpMan{"getblockconnectstats",
+                "\nReturns where the time connecting blocks went since the statistics were reset, per phase.\n"
+                "The phases of a WATTx block are reading it, the sanity and fork checks, the transactions, EVM execution, privacy proofs,\n"
+                "the reward, MPoS and trust tier checks, waiting for the script checks, the contract state checks, undo data, index writes,\n"
+                "delegation rewards, the curve tree update, the coins flush, writing the chain state and updating the tip.\n"
+                "Percentiles are taken over the last " + util::ToString(node::BlockConnectStats::WINDOW) + " blocks. "
+                "The " + util::ToString(node::BlockConnectStats::MAX_SLOWEST) + " slowest blocks are kept until the statistics are reset.",
+                {
+                    {"slowest", RPCArg::Type::NUM, RPCArg::Default{10}, "The number of slowest blocks to return with their phases"},
+                    {"reset", RPCArg::Type::BOOL, RPCArg::Default{false}, "Reset the statistics after reading them"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM_TIME, "since", "The " + UNIX_EPOCH_TIME + " the statistics were last reset"},
+                        {RPCResult::Type::NUM, "blocks", "Blocks connected since then"},
+                        {RPCResult::Type::NUM, "window", "Blocks the percentiles are taken over"},
+                        {RPCResult::Type::OBJ, "phases", "Statistics by phase", phase_results},
+                        {RPCResult::Type::ARR, "slowest", "The slowest blocks, slowest first",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::NUM, "height", "The block height"},
+                                {RPCResult::Type::STR_HEX, "hash", "The block hash"},
+                                {RPCResult::Type::NUM, "total", "Time connecting the block, in milliseconds"},
+                                {RPCResult::Type::OBJ_DYN, "phases", "Time of each phase, in milliseconds",
+                                {
+                                    {RPCResult::Type::NUM, "phase", "Time of the phase"},
+                                }},
+                            }},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getblockconnectstats", "")
+            + HelpExampleCli("getblockconnectstats", "20 true")
+            + HelpExampleRpc("getblockconnectstats", "5")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const int slowest = request.params[0].isNull() ? 10 : request.params[0].getInt<int>();
+    if (slowest < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid slowest, must be non-negative");
+    }
+
+    const node::BlockConnectStats::Summary summary = node::g_block_connect_stats.GetSummary(slowest);
+    if (!request.params[1].isNull() && request.params[1].get_bool()) {
+        node::g_block_connect_stats.Reset();
+    }
+
+    UniValue phases(UniValue::VOBJ);
+    for (size_t phase = 0; phase <= node::CONNECT_PHASE_COUNT; ++phase) {
+        const node::BlockConnectStats::PhaseSummary& stats = summary.phases[phase];
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("ema", stats.ema_ms);
+        obj.pushKV("mean", stats.mean_ms);
+        obj.pushKV("p50", stats.p50_ms);
+        obj.pushKV("p90", stats.p90_ms);
+        obj.pushKV("p99", stats.p99_ms);
+        obj.pushKV("max", stats.max_ms);
+        phases.pushKV(phase < node::CONNECT_PHASE_COUNT ? node::ConnectPhaseName(static_cast<node::ConnectPhase>(phase)) : "total", std::move(obj));
+    }
+
+    UniValue blocks(UniValue::VARR);
+    for (const node::BlockConnectTimes& block : summary.slowest) {
+        UniValue block_phases(UniValue::VOBJ);
+        for (size_t phase = 0; phase < node::CONNECT_PHASE_COUNT; ++phase) {
+            block_phases.pushKV(node::ConnectPhaseName(static_cast<node::ConnectPhase>(phase)), Ticks<MillisecondsDouble>(block.phases[phase]));
+        }
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("height", block.height);
+        obj.pushKV("hash", block.hash.GetHex());
+        obj.pushKV("total", Ticks<MillisecondsDouble>(block.Total()));
+        obj.pushKV("phases", std::move(block_phases));
+        blocks.push_back(std::move(obj));
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("since", summary.since);
+    result.pushKV("blocks", summary.blocks);
+    result.pushKV("window", summary.window_blocks);
+    result.pushKV("phases", std::move(phases));
+    result.pushKV("slowest", std::move(blocks));
+    return result;
+},
+    };
+}
+
 //! Return height of highest block that has been pruned, or std::nullopt if no blocks have been pruned
 std::optional<int> GetPruneHeight(const BlockManager& blockman, const CChain& chain) {
     AssertLockHeld(::cs_main);
@@ -2186,6 +2431,23 @@ static RPCHelpMan gettxoutsetinfo()
                                 {RPCResult::Type::STR_AMOUNT, "unclaimed_rewards", "Fee rewards that miners did not claim in their coinbase transaction"},
                             }}
                         }},
+                        {RPCResult::Type::OBJ, "contracts", /*optional=*/true, "The coins held by contracts, part of the UTXO set (only available if coinstatsindex is used)",
+                        {
+                            {RPCResult::Type::NUM, "txouts", "The number of unspent contract outputs"},
+                            {RPCResult::Type::STR_AMOUNT, "total_amount", "The total amount held by contracts"},
+                            {RPCResult::Type::STR_HEX, "muhash", "The MuHash of the contract outputs"},
+                        }},
+                        {RPCResult::Type::OBJ, "privacy", /*optional=*/true, "Totals of the privacy transactions up to this block (only available if coinstatsindex is used)",
+                        {
+                            {RPCResult::Type::NUM, "transactions", "The number of privacy transactions"},
+                            {RPCResult::Type::NUM, "shielded_outputs", "The number of stealth and confidential outputs created"},
+                            {RPCResult::Type::NUM, "key_images", "The number of ring input key images spent"},
+                            {RPCResult::Type::NUM, "fcmp_inputs", "The number of FCMP inputs spent"},
+                            {RPCResult::Type::STR_AMOUNT, "value_in", "Transparent amount spent by privacy transactions"},
+                            {RPCResult::Type::STR_AMOUNT, "value_out", "Transparent amount created by privacy transactions"},
+                            {RPCResult::Type::STR_AMOUNT, "fees", "Explicit fees of privacy transactions"},
+                            {RPCResult::Type::STR_AMOUNT, "pool_amount", "Net transparent amount moved into the shielded pool, value_in minus value_out and fees"},
+                        }},
                     }},
                 RPCExamples{
                     HelpExampleCli("gettxoutsetinfo", "") +
@@ -2291,6 +2553,23 @@ static RPCHelpMan gettxoutsetinfo()
             block_info.pushKV("unspendables", std::move(unspendables));
 
             ret.pushKV("block_info", std::move(block_info));
+
+            UniValue contracts(UniValue::VOBJ);
+            contracts.pushKV("txouts", stats.contract_output_count);
+            contracts.pushKV("total_amount", ValueFromAmount(stats.total_contract_amount));
+            contracts.pushKV("muhash", stats.contract_muhash.GetHex());
+            ret.pushKV("contracts", std::move(contracts));
+
+            UniValue privacy(UniValue::VOBJ);
+            privacy.pushKV("transactions", stats.privacy_tx_count);
+            privacy.pushKV("shielded_outputs", stats.privacy_shielded_output_count);
+            privacy.pushKV("key_images", stats.privacy_key_image_count);
+            privacy.pushKV("fcmp_inputs", stats.privacy_fcmp_input_count);
+            privacy.pushKV("value_in", ValueFromAmount(stats.total_privacy_value_in));
+            privacy.pushKV("value_out", ValueFromAmount(stats.total_privacy_value_out));
+            privacy.pushKV("fees", ValueFromAmount(stats.total_privacy_fees));
+            privacy.pushKV("pool_amount", ValueFromAmount(stats.total_privacy_value_in - stats.total_privacy_value_out - stats.total_privacy_fees));
+            ret.pushKV("privacy", std::move(privacy));
         }
     } else {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
@@ -4191,6 +4470,9 @@ static RPCHelpMan dumptxoutset()
                     {RPCResult::Type::NUM, "base_height", "the height of the base of the snapshot"},
                     {RPCResult::Type::STR, "path", "the absolute path that the snapshot was written to"},
                     {RPCResult::Type::STR_HEX, "txoutset_hash", "the hash of the UTXO set contents"},
+                    {RPCResult::Type::STR_HEX, "contract_state_hash", "the hash of the contract state trie nodes"},
+                    {RPCResult::Type::STR_HEX, "curve_tree_hash", "the hash of the FCMP curve tree, or all zeros if it is empty"},
+                    {RPCResult::Type::STR_HEX, "key_images_hash", "the hash of the spent key images, or all zeros if there are none"},
                     {RPCResult::Type::NUM, "nchaintx", "the number of transactions in the chain up to and including the base block"},
                 }
         },
@@ -4281,6 +4563,7 @@ static RPCHelpMan dumptxoutset()
     Chainstate* chainstate;
     std::unique_ptr<CCoinsViewCursor> cursor;
     CCoinsStats stats;
+    node::SnapshotPrivacyState privacy_state;
     {
         // Lock the chainstate before calling PrepareUtxoSnapshot, to be able
         // to get a UTXO database cursor while the chain is pointing at the
@@ -4300,11 +4583,11 @@ static RPCHelpMan dumptxoutset()
             LogWarning("dumptxoutset failed to roll back to requested height, reverting to tip.\n");
             throw JSONRPCError(RPC_MISC_ERROR, "Could not roll back to requested height.");
         } else {
-            std::tie(cursor, stats, tip) = PrepareUTXOSnapshot(*chainstate, node.rpc_interruption_point);
+            std::tie(cursor, stats, tip, privacy_state) = PrepareUTXOSnapshot(*chainstate, node.rpc_interruption_point);
         }
     }
 
-    UniValue result = WriteUTXOSnapshot(*chainstate, cursor.get(), &stats, tip, afile, path, temppath, node.rpc_interruption_point);
+    UniValue result = WriteUTXOSnapshot(*chainstate, cursor.get(), &stats, tip, privacy_state, afile, path, temppath, node.rpc_interruption_point);
     fs::rename(temppath, path);
 
     result.pushKV("path", path.utf8string());
@@ -4313,7 +4596,7 @@ static RPCHelpMan dumptxoutset()
     };
 }
 
-std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
+std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*, node::SnapshotPrivacyState>
 PrepareUTXOSnapshot(
     Chainstate& chainstate,
     const std::function<void()>& interruption_point)
@@ -4321,6 +4604,7 @@ PrepareUTXOSnapshot(
     std::unique_ptr<CCoinsViewCursor> pcursor;
     std::optional<CCoinsStats> maybe_stats;
     const CBlockIndex* tip;
+    node::SnapshotPrivacyState privacy_state;
 
     {
         // We need to lock cs_main to ensure that the coinsdb isn't written to
@@ -4346,9 +4630,17 @@ PrepareUTXOSnapshot(
 
         pcursor = chainstate.CoinsDB().Cursor();
         tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(maybe_stats->hashBlock));
+
+        // The privacy state was flushed with the coins and is small, so it is
+        // read here rather than through a cursor
+        auto maybe_privacy_state{node::ReadSnapshotPrivacyState(chainstate.FcmpState(), chainstate.KeyImageDB().get())};
+        if (!maybe_privacy_state) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, util::ErrorString(maybe_privacy_state).original);
+        }
+        privacy_state = std::move(*maybe_privacy_state);
     }
 
-    return {std::move(pcursor), *CHECK_NONFATAL(maybe_stats), tip};
+    return {std::move(pcursor), *CHECK_NONFATAL(maybe_stats), tip, std::move(privacy_state)};
 }
 
 UniValue WriteUTXOSnapshot(
@@ -4356,6 +4648,7 @@ UniValue WriteUTXOSnapshot(
     CCoinsViewCursor* pcursor,
     CCoinsStats* maybe_stats,
     const CBlockIndex* tip,
+    const node::SnapshotPrivacyState& privacy_state,
     AutoFile& afile,
     const fs::path& path,
     const fs::path& temppath,
@@ -4415,6 +4708,14 @@ UniValue WriteUTXOSnapshot(
 
     CHECK_NONFATAL(written_coins_count == maybe_stats->coins_count);
 
+    // The coins are followed by the state contracts and privacy transactions
+    // of later blocks are validated against
+    const auto contract_state_hash{node::WriteSnapshotContractState(afile, *tip, interruption_point)};
+    if (!contract_state_hash) {
+        throw JSONRPCError(RPC_MISC_ERROR, util::ErrorString(contract_state_hash).original);
+    }
+    afile << privacy_state;
+
     afile.fclose();
 
     UniValue result(UniValue::VOBJ);
@@ -4423,6 +4724,9 @@ UniValue WriteUTXOSnapshot(
     result.pushKV("base_height", tip->nHeight);
     result.pushKV("path", path.utf8string());
     result.pushKV("txoutset_hash", maybe_stats->hashSerialized.ToString());
+    result.pushKV("contract_state_hash", contract_state_hash->ToString());
+    result.pushKV("curve_tree_hash", privacy_state.GetCurveTreeHash().ToString());
+    result.pushKV("key_images_hash", privacy_state.GetKeyImagesHash().ToString());
     result.pushKV("nchaintx", tip->m_chain_tx_count);
     return result;
 }
@@ -4434,8 +4738,8 @@ UniValue CreateUTXOSnapshot(
     const fs::path& path,
     const fs::path& tmppath)
 {
-    auto [cursor, stats, tip]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate, node.rpc_interruption_point))};
-    return WriteUTXOSnapshot(chainstate, cursor.get(), &stats, tip, afile, path, tmppath, node.rpc_interruption_point);
+    auto [cursor, stats, tip, privacy_state]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate, node.rpc_interruption_point))};
+    return WriteUTXOSnapshot(chainstate, cursor.get(), &stats, tip, privacy_state, afile, path, tmppath, node.rpc_interruption_point);
 }
 
 static RPCHelpMan loadtxoutset()
@@ -4938,6 +5242,8 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &qrc20allowance},
         {"blockchain", &qrc20listtransactions},
         {"blockchain", &listcontracts},
+        {"blockchain", &getevmstats},
+        {"blockchain", &getblockconnectstats},
         {"blockchain", &gettransactionreceipt},
         {"blockchain", &getblocktransactionreceipts},
         {"blockchain", &searchlogs},
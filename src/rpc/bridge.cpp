@@ -0,0 +1,68 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bridge/bridge_node.h>
+#include <rpc/server.h>
+#include <rpc/util.h>
+#include <univalue.h>
+
+static RPCHelpMan getbridgeproof()
+{
+    return RPCHelpMan{"getbridgeproof",
+        "\nGet the proof that a bridge transaction is in a committed batch.\n"
+        "Hashing the transaction hash up the branch, on the left where the bit of the\n"
+        "position at that depth is set, gives the merkle root of the batch.\n",
+        {
+            {"txhash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The bridge transaction hash"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "txhash", "The bridge transaction hash"},
+                {RPCResult::Type::NUM, "batch", "The batch the transaction was committed in"},
+                {RPCResult::Type::NUM, "position", "Position of the transaction in the batch"},
+                {RPCResult::Type::STR_HEX, "merkleroot", "Merkle root of the batch"},
+                {RPCResult::Type::ARR, "branch", "Sibling hashes from the transaction up to the root",
+                    {{RPCResult::Type::STR_HEX, "", "hash"}}},
+                {RPCResult::Type::BOOL, "committed", "Whether the batch was submitted to the bridge contract"},
+            }},
+        RPCExamples{
+            HelpExampleCli("getbridgeproof", "\"txhash\"")
+            + HelpExampleRpc("getbridgeproof", "\"txhash\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            const uint256 tx_hash = ParseHashV(request.params[0], "txhash");
+
+            const std::optional<bridge::BatchInclusionProof> proof = bridge::GetBridgeNode().GetInclusionProof(tx_hash);
+            if (!proof) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not in a committed batch");
+            }
+
+            UniValue branch(UniValue::VARR);
+            for (const uint256& hash : proof->branch.vHash) {
+                branch.push_back(hash.GetHex());
+            }
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("txhash", tx_hash.GetHex());
+            result.pushKV("batch", proof->batch_id);
+            result.pushKV("position", proof->branch.nIndex);
+            result.pushKV("merkleroot", proof->merkle_root.GetHex());
+            result.pushKV("branch", std::move(branch));
+            result.pushKV("committed", proof->committed_to_wattx);
+            return result;
+        },
+    };
+}
+
+void RegisterBridgeRPCCommands(CRPCTable& t)
+{
+    static const CRPCCommand commands[]{
+        {"bridge", &getbridgeproof},
+    };
+    for (const auto& c : commands) {
+        t.appendCommand(c.name, &c);
+    }
+}
@@ -55,6 +55,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "settxfee", 0, "amount" },
     { "sethdseed", 0, "newkeypool" },
     { "getsubsidy", 0, "height" },
+    { "setminingalgorithm", 2, "gpu_platform" },
+    { "setminingalgorithm", 3, "gpu_device" },
     { "getreceivedbyaddress", 1, "minconf" },
     { "getreceivedbyaddress", 2, "include_immature_coinbase" },
     { "getreceivedbylabel", 1, "minconf" },
@@ -93,6 +95,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "sendmany", 6 , "conf_target" },
     { "sendmany", 8, "fee_rate"},
     { "sendmany", 9, "verbose" },
+    { "shieldfcmpmany", 0, "amounts" },
+    { "shieldfcmpmany", 1, "minconf" },
+    { "queueshieldfcmp", 2, "minconf" },
     { "deriveaddresses", 1, "range" },
     { "scanblocks", 1, "scanobjects" },
     { "scanblocks", 2, "start_height" },
@@ -125,6 +130,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "searchlogs", 2, "addressfilter"},
     { "searchlogs", 3, "topicfilter"},
     { "searchlogs", 4, "minconf"},
+    { "searchlogs", 5, "limit"},
     { "waitforlogs", 0, "fromblock"},
     { "waitforlogs", 1, "toblock"},
     { "waitforlogs", 2, "filter"},
@@ -339,6 +345,11 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "sendtocontract", 6, "broadcast" },
     { "sendtocontract", 7, "changetosender" },
     { "sendtocontract", 8, "psbt" },
+    { "sendmanytocontract", 0, "calls" },
+    { "sendmanytocontract", 1, "gasprice" },
+    { "sendmanytocontract", 3, "broadcast" },
+    { "sendmanytocontract", 4, "changetosender" },
+    { "sendmanytocontract", 5, "psbt" },
     { "removedelegationforaddress", 1, "gaslimit" },
     { "removedelegationforaddress", 2, "gasprice" },
     { "setdelegateforaddress", 1, "fee" },
@@ -365,11 +376,25 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "callcontract", 5, "blocknum" },
     { "reservebalance", 0, "reserve"},
     { "reservebalance", 1, "amount"},
+    { "getstakerstats", 0, "reset" },
+    { "listvalidators", 0, "minFee" },
+    { "listvalidators", 1, "activeOnly" },
+    { "listvalidators", 2, "count" },
+    { "listvalidators", 3, "skip" },
+    { "listdelegations", 2, "count" },
     { "listcontracts", 0, "start" },
     { "listcontracts", 1, "maxdisplay" },
+    { "getevmstats", 0, "count" },
+    { "getevmstats", 2, "reset" },
+    { "getblockconnectstats", 0, "slowest" },
+    { "getblockconnectstats", 1, "reset" },
     { "getcontractcode", 1, "blocknum" },
     { "getstorage", 2, "index" },
     { "getstorage", 1, "blocknum" },
+    { "startstratum", 0, "port" },
+    { "startstratum", 2, "sv2_port" },
+    { "startstratum", 3, "io_threads" },
+    { "startstratum", 4, "max_clients" },
     // Echo with conversion (For testing only)
     { "echojson", 0, "arg0" },
     { "echojson", 1, "arg1" },
@@ -383,6 +408,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "echojson", 9, "arg9" },
     { "rescanblockchain", 0, "start_height"},
     { "rescanblockchain", 1, "stop_height"},
+    { "rescanprivacy", 0, "start_height"},
+    { "rescanprivacy", 1, "stop_height"},
     { "createwallet", 1, "disable_private_keys"},
     { "createwallet", 2, "blank"},
     { "createwallet", 4, "avoid_reuse"},
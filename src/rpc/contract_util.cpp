@@ -2,6 +2,7 @@
 #include <rpc/util.h>
 #include <common/system.h>
 #include <key_io.h>
+#include <qtum/evmcallpool.h>
 #include <rpc/server.h>
 #include <txdb.h>
 
@@ -61,9 +62,6 @@ UniValue transactionReceiptToJSON(const QtumTransactionReceipt& txRec)
 
 UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
 {
-    LOCK(cs_main);
-
-    CChain& active_chain = chainman.ActiveChain();
     std::string strAddr = params[0].get_str();
     std::string data = params[1].get_str();
 
@@ -93,22 +91,20 @@ UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
             throw JSONRPCError(RPC_TYPE_ERROR, "Invalid amount for send");
     }
 
-    TemporaryState ts(globalState);
-    int blockNum;
+    // The call runs on a snapshot of the state after the block, without cs_main
+    int blockNum = -1;
     if (params.size() >= 6) {
         if (params[5].isNum()) {
             blockNum = params[5].getInt<int>();
-            if ((blockNum < 0 && blockNum != -1) || blockNum > active_chain.Height())
+            if ((blockNum < 0 && blockNum != -1) || blockNum > WITH_LOCK(cs_main, return chainman.ActiveChain().Height()))
                 throw JSONRPCError(RPC_INVALID_PARAMS, "Incorrect block number");
-            if (blockNum != -1) {
-                ts.SetRoot(uintToh256(active_chain[blockNum]->hashStateRoot), uintToh256(active_chain[blockNum]->hashUTXORoot));
-            }
         } else {
             throw JSONRPCError(RPC_INVALID_PARAMS, "Incorrect block number");
         }
-    } else {
-        blockNum = active_chain.Height();
     }
+    std::shared_ptr<const EvmStateSnapshot> snapshot = GetEvmCallPool().GetSnapshot(chainman.ActiveChainstate(), blockNum);
+    if (!snapshot)
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Incorrect block number");
 
     dev::Address addrAccount;
     std::string normalizedAddr;
@@ -116,13 +112,14 @@ UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
         if (!NormalizeEvmAddress(strAddr, normalizedAddr))
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Incorrect address (expected 40 hex chars, with optional 0x prefix)");
         addrAccount = dev::Address(normalizedAddr);
-        if (!globalState->addressInUse(addrAccount))
+        if (!snapshot->MakeState()->addressInUse(addrAccount))
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Address does not exist");
     }
 
-    std::vector<ResultExecute> execResults = CallContract(addrAccount, ParseHex(data), chainman.ActiveChainstate(), blockNum, senderAddress, gasLimit, nAmount);
+    std::vector<ResultExecute> execResults = GetEvmCallPool().Call(*snapshot, addrAccount, ParseHex(data), senderAddress, gasLimit, nAmount);
 
     if(fRecordLogOpcodes){
+        LOCK(cs_main);
         writeVMlog(execResults, chainman.ActiveChain());
     }
 
@@ -317,6 +314,7 @@ public:
     size_t fromBlock;
     size_t toBlock;
     size_t minconf;
+    size_t limit;
     int numBlocks;
 
     std::set<dev::h160> addresses;
@@ -332,6 +330,7 @@ public:
         parseParam(params[3]["topics"], topics);
 
         minconf = parseUInt(params[4], 0);
+        limit = parseUInt(params[5], 0);
     }
 
 private:
@@ -353,26 +352,98 @@ private:
 
 };
 
-UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
+UniValue SearchLogs(const UniValue& params, ChainstateManager &chainman)
 {
+    JSONRPCRequest request;
+    request.params = params;
+    return SearchLogs(request, chainman);
+}
+
+UniValue SearchLogs(const JSONRPCRequest& request, ChainstateManager &chainman)
+{
+    const UniValue& _params = request.params;
     if(!fLogEvents)
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
 
-    int curheight = 0;
+    // Only the tip needs cs_main, the indexes and receipts are read without it
+    const int tipHeight = WITH_LOCK(cs_main, return chainman.ActiveChain().Height());
+
+    SearchLogsParams params(_params, tipHeight);
 
-    LOCK(cs_main);
+    if (params.toBlock < params.fromBlock || (params.toBlock == 0 && params.fromBlock == 0)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
+    }
 
-    SearchLogsParams params(_params, chainman.ActiveChain().Height());
+    // Blocks without enough confirmations are left for a later search
+    const int fromBlock = params.fromBlock;
+    const int toBlock = params.minconf > 0 ? std::min<int>(params.toBlock, tipHeight - (int)params.minconf) : (int)params.toBlock;
+    int nextBlock = std::max(fromBlock, toBlock + 1);
 
     std::vector<std::vector<uint256>> hashesToBlock;
+    size_t count = 0;
+    auto collect = [&](int height, size_t first) {
+        for (size_t i = first; i < hashesToBlock.size(); i++) {
+            count += hashesToBlock[i].size();
+        }
+        if (params.limit > 0 && count >= params.limit) {
+            nextBlock = height + 1;
+            return false;
+        }
+        return true;
+    };
+    auto remaining = [&] { return params.limit > 0 ? params.limit - count : 0; };
+
+    // The topic index answers a filter on the first topic alone, other positions are matched on the receipts
+    std::optional<dev::h256> indexedTopic;
+    unsigned int topicIndexStart = 0;
+    if (!params.topics.empty() && params.topics[0] &&
+        std::none_of(params.topics.begin() + 1, params.topics.end(), [](const auto& topic) { return bool(topic); }) &&
+        chainman.m_blockman.m_block_tree_db->ReadTopicIndexStart(topicIndexStart)) {
+        indexedTopic = params.topics[0].get();
+    }
+
+    // Blocks before the topic index go through the height index, visiting only those whose log bloom may match
+    bool more = true;
+    const int heightIndexTo = indexedTopic ? std::min<int>(toBlock, (int)topicIndexStart - 1) : toBlock;
+    if (fromBlock <= heightIndexTo) {
+        std::set<dev::h256> bloomTopics;
+        for (const auto& topic : params.topics) {
+            if (topic) {
+                bloomTopics.insert(topic.get());
+            }
+        }
 
-    curheight = chainman.m_blockman.m_block_tree_db->ReadHeightIndex(params.fromBlock, params.toBlock, params.minconf, hashesToBlock, params.addresses, chainman);
+        for (const auto& range : pstorageresult->findLogRanges(fromBlock, heightIndexTo, params.addresses, bloomTopics)) {
+            // ReadHeightIndex rejects a range of just the genesis block, which has no logs anyway
+            if (range.second == 0) {
+                continue;
+            }
+            size_t first = hashesToBlock.size();
+            int height = chainman.m_blockman.m_block_tree_db->ReadHeightIndex(range.first, range.second, 0, hashesToBlock, params.addresses, chainman, remaining());
 
-    if (curheight == -1) {
-        throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
+            if (height == -1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
+            }
+            if (!(more = collect(height, first))) {
+                break;
+            }
+        }
     }
 
-    UniValue result(UniValue::VARR);
+    if (more && indexedTopic && std::max<int>(fromBlock, topicIndexStart) <= toBlock) {
+        size_t first = hashesToBlock.size();
+        int height = chainman.m_blockman.m_block_tree_db->ReadTopicIndex(*indexedTopic, std::max<int>(fromBlock, topicIndexStart), toBlock, hashesToBlock, params.addresses, remaining());
+        collect(height, first);
+    }
+
+    // Streamed when the transport allows, the receipts are never one UniValue tree
+    JSONRPCResultWriter result{request};
+    if (params.limit > 0) {
+        result.BeginObject();
+        result.Key("entries");
+    }
+    result.BeginArray();
+    int entries = 0;
 
     auto topics = params.topics;
 
@@ -382,6 +453,9 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
     {
         for(const auto& e : hashesTx)
         {
+            if (!result.Alive()) {
+                break;
+            }
 
             if(dupes.find(e) != dupes.end()) {
                 continue;
@@ -424,12 +498,20 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
 
                 UniValue tri(UniValue::VOBJ);
                 transactionReceiptInfoToJSON(receipt, tri);
-                result.push_back(tri);
+                result.Value(std::move(tri));
+                entries++;
             }
         }
     }
+    result.End();
 
-    return result;
+    if (params.limit > 0) {
+        result.KV("count", entries);
+        result.KV("nextblock", nextBlock);
+        result.End();
+    }
+
+    return result.Finish();
 }
 
 CallToken::CallToken(ChainstateManager &_chainman):
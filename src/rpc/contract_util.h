@@ -1,6 +1,7 @@
 #ifndef CONTRACT_UTIL_H
 #define CONTRACT_UTIL_H
 
+#include <rpc/request.h>
 #include <univalue.h>
 #include <validation.h>
 #include <qtum/qtumtoken.h>
@@ -11,6 +12,9 @@ UniValue CallToContract(const UniValue& params, ChainstateManager &chainman);
 
 UniValue SearchLogs(const UniValue& params, ChainstateManager &chainman);
 
+/** searchlogs with the parameters of request, streaming the result when the transport allows. */
+UniValue SearchLogs(const JSONRPCRequest& request, ChainstateManager &chainman);
+
 void assignJSON(UniValue& entry, const TransactionReceiptInfo& resExec);
 
 void assignJSON(UniValue& logEntry, const dev::eth::LogEntry& log,
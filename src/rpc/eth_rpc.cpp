@@ -15,6 +15,8 @@
 #include <net_processing.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <node/eth_filters.h>
+#include <node/gasprice.h>
 #include <node/transaction.h>
 #include <node/types.h>
 #include <primitives/block.h>
@@ -26,20 +28,31 @@
 #include <rpc/util.h>
 #include <sync.h>
 #include <txdb.h>
+#include <txmempool.h>
 #include <util/strencodings.h>
 #include <util/convert.h>
+#include <util/hasher.h>
 #include <validation.h>
 #include <wallet/receive.h>
 #include <wallet/rpc/util.h>
 #include <wallet/wallet.h>
 #include <rpc/contract_util.h>
 #include <libdevcore/CommonData.h>
+#include <qtum/evmcallpool.h>
+#include <qtum/evmtracer.h>
+#include <qtum/qtumDGP.h>
 #include <qtum/qtumstate.h>
 
+#include <algorithm>
+#include <future>
 #include <iomanip>
+#include <limits>
+#include <list>
 #include <map>
 #include <mutex>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
 using node::NodeContext;
 
@@ -48,6 +61,8 @@ static UniValue FormatEthBlockInternal(const CBlock& block, const CBlockIndex* p
                                        bool fullTransactions, ChainstateManager& chainman);
 static UniValue FormatEthTransactionInternal(const CTransaction& tx, const CBlockIndex* pblockindex,
                                              size_t txIndex);
+static const CBlockIndex* EthBlockIndexAtHeight(ChainstateManager& chainman, int64_t height);
+static std::shared_ptr<const CBlock> ReadEthBlock(ChainstateManager& chainman, const CBlockIndex& index);
 
 // ============================================================================
 // Unit Conversion Implementation
@@ -352,10 +367,17 @@ static RPCHelpMan eth_blockNumber()
     };
 }
 
+// Gas prices in wei, counting one satoshi per gas as one gwei
+static std::string GasPriceToWei(CAmount gas_price)
+{
+    return IntToHex(static_cast<uint64_t>(std::max<CAmount>(gas_price, 0)) * 1000000000);
+}
+
 static RPCHelpMan eth_gasPrice()
 {
     return RPCHelpMan{"eth_gasPrice",
-        "\nReturns the current gas price in wei.\n",
+        "\nReturns the gas price in wei that recent blocks and the mempool suggest for timely inclusion,\n"
+        "never less than the DGP minimum gas price.\n",
         {},
         RPCResult{
             RPCResult::Type::STR_HEX, "", "The gas price in wei (hex)"},
@@ -365,8 +387,150 @@ static RPCHelpMan eth_gasPrice()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    // Return 40 gwei (0x9502f9000) - minimum gas price
-    return "0x9502f9000";
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    ChainstateManager& chainman = EnsureChainman(node);
+    uint64_t minGasPrice = DEFAULT_MIN_GAS_PRICE_DGP;
+    uint64_t blockGasLimit = DEFAULT_BLOCK_GAS_LIMIT_DGP;
+    {
+        LOCK(cs_main);
+        if (globalState) {
+            QtumDGP qtumDGP(globalState.get(), chainman.ActiveChainstate(), fGettingValuesDGP);
+            const int nextHeight = chainman.ActiveChain().Height() + 1;
+            minGasPrice = qtumDGP.getMinGasPrice(nextHeight);
+            blockGasLimit = qtumDGP.getBlockGasLimit(nextHeight);
+        }
+    }
+    return GasPriceToWei(node::SuggestGasPrice(chainman, node.mempool.get(), CAmount(minGasPrice), blockGasLimit));
+},
+    };
+}
+
+// Most blocks eth_feeHistory reports on, as other providers allow
+static constexpr int64_t ETH_MAX_FEE_HISTORY_BLOCKS{1024};
+
+static RPCHelpMan eth_feeHistory()
+{
+    return RPCHelpMan{"eth_feeHistory",
+        "\nReturns the gas prices of a range of blocks ending at newestBlock. The DGP minimum gas price is\n"
+        "reported as the base fee, and the rewards are the gas prices paid above it at the given percentiles\n"
+        "of each block's gas. Blocks are weighed by gas limits, as gas used is not known without execution.\n"
+        "For 'pending', the last entry is the mempool's next block.\n",
+        {
+            {"blockCount", RPCArg::Type::STR, RPCArg::Optional::NO, "Number of blocks, as hex or decimal, at most 1024"},
+            {"newestBlock", RPCArg::Type::STR, RPCArg::Optional::NO, "Block number as hex, or 'latest', 'earliest', 'pending'"},
+            {"rewardPercentiles", RPCArg::Type::ARR, RPCArg::Default{UniValue::VARR}, "Increasing percentiles of gas to sample rewards at",
+                {
+                    {"percentile", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "A percentile between 0 and 100"},
+                },
+            },
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "oldestBlock", "Number of the first block reported"},
+                {RPCResult::Type::ARR, "baseFeePerGas", "DGP minimum gas price in wei per block, and for the block after the newest",
+                    {{RPCResult::Type::STR_HEX, "", "Gas price in wei"}}},
+                {RPCResult::Type::ARR, "gasUsedRatio", "Gas limits of each block as a share of its block gas limit",
+                    {{RPCResult::Type::NUM, "", "Share of the block gas limit"}}},
+                {RPCResult::Type::ARR, "reward", /*optional=*/true, "Gas price above the base fee in wei at each percentile, per block",
+                    {{RPCResult::Type::ARR, "", "", {{RPCResult::Type::STR_HEX, "", "Gas price in wei"}}}}},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("eth_feeHistory", "\"0x4\" \"latest\" \"[25, 75]\"")
+            + HelpExampleRpc("eth_feeHistory", "\"0x4\", \"latest\", [25, 75]")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    ChainstateManager& chainman = EnsureChainman(node);
+
+    int64_t blockCount{0};
+    if (request.params[0].isNum()) {
+        blockCount = request.params[0].getInt<int64_t>();
+    } else {
+        const std::string& count = request.params[0].get_str();
+        const bool hex = count.substr(0, 2) == "0x" || count.substr(0, 2) == "0X";
+        const std::optional<int64_t> parsed = hex ? std::optional<int64_t>(HexToInt(count)) : ToIntegral<int64_t>(count);
+        if (!parsed) throw JSONRPCError(RPC_INVALID_PARAMS, "Invalid blockCount");
+        blockCount = *parsed;
+    }
+    if (blockCount < 1) throw JSONRPCError(RPC_INVALID_PARAMS, "blockCount must be positive");
+    blockCount = std::min(blockCount, ETH_MAX_FEE_HISTORY_BLOCKS);
+
+    std::vector<double> percentiles;
+    if (!request.params[2].isNull()) {
+        for (const UniValue& percentile : request.params[2].get_array().getValues()) {
+            const double value = percentile.get_real();
+            if (value < 0 || value > 100 || (!percentiles.empty() && value < percentiles.back())) {
+                throw JSONRPCError(RPC_INVALID_PARAMS, "rewardPercentiles must be increasing and between 0 and 100");
+            }
+            percentiles.push_back(value);
+        }
+    }
+
+    const bool pending = request.params[1].isStr() && request.params[1].get_str() == "pending" && node.mempool;
+    const int64_t tipHeight = WITH_LOCK(cs_main, return chainman.ActiveChain().Height());
+    const int64_t newest = pending ? tipHeight + 1 : ParseEthBlockNumber(request.params[1], chainman);
+    if (newest < 0 || newest > tipHeight + (pending ? 1 : 0)) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "newestBlock is not in the chain");
+    }
+    const int64_t oldest = std::max<int64_t>(0, newest - blockCount + 1);
+
+    // DGP values of each height, and of the one after the newest
+    std::vector<uint64_t> minGasPrices, blockGasLimits;
+    {
+        LOCK(cs_main);
+        std::optional<QtumDGP> qtumDGP;
+        if (globalState) qtumDGP.emplace(globalState.get(), chainman.ActiveChainstate(), fGettingValuesDGP);
+        for (int64_t height = oldest; height <= newest + 1; ++height) {
+            minGasPrices.push_back(qtumDGP ? qtumDGP->getMinGasPrice(height) : DEFAULT_MIN_GAS_PRICE_DGP);
+            blockGasLimits.push_back(qtumDGP ? qtumDGP->getBlockGasLimit(height) : DEFAULT_BLOCK_GAS_LIMIT_DGP);
+        }
+    }
+
+    UniValue baseFees(UniValue::VARR);
+    UniValue ratios(UniValue::VARR);
+    UniValue rewards(UniValue::VARR);
+    for (int64_t height = oldest; height <= newest; ++height) {
+        const size_t i = height - oldest;
+        std::vector<node::GasPriceSample> samples;
+        if (height > tipHeight) {
+            // The mempool's gas, as far as it fits into the next block
+            uint64_t gas{0};
+            for (const node::GasPriceSample& sample : node::GetMempoolGasPrices(*node.mempool)) {
+                if (gas + sample.gas_limit > blockGasLimits[i]) break;
+                gas += sample.gas_limit;
+                samples.push_back(sample);
+            }
+        } else {
+            const CBlockIndex* pblockindex = EthBlockIndexAtHeight(chainman, height);
+            if (!pblockindex) throw JSONRPCError(RPC_INVALID_PARAMS, "newestBlock is not in the chain");
+            samples = node::GetBlockGasPrices(*ReadEthBlock(chainman, *pblockindex));
+        }
+
+        uint64_t gas{0};
+        for (const node::GasPriceSample& sample : samples) gas += sample.gas_limit;
+        baseFees.push_back(GasPriceToWei(minGasPrices[i]));
+        ratios.push_back(blockGasLimits[i] ? std::min(1.0, double(gas) / blockGasLimits[i]) : 0.0);
+
+        if (!percentiles.empty()) {
+            UniValue blockRewards(UniValue::VARR);
+            for (double percentile : percentiles) {
+                const CAmount price = node::GasPricePercentile(samples, percentile);
+                blockRewards.push_back(GasPriceToWei(samples.empty() ? 0 : price - CAmount(minGasPrices[i])));
+            }
+            rewards.push_back(std::move(blockRewards));
+        }
+    }
+    baseFees.push_back(GasPriceToWei(minGasPrices.back()));
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("oldestBlock", IntToHex(oldest));
+    result.pushKV("baseFeePerGas", std::move(baseFees));
+    result.pushKV("gasUsedRatio", std::move(ratios));
+    if (!percentiles.empty()) result.pushKV("reward", std::move(rewards));
+    return result;
 },
     };
 }
@@ -559,7 +723,8 @@ static RPCHelpMan web3_sha3()
 static RPCHelpMan eth_getBalance()
 {
     return RPCHelpMan{"eth_getBalance",
-        "\nReturns the balance of the account at given address.\n",
+        "\nReturns the balance of the account at given address.\n"
+        "With -addrindex any address is answered, at any block, otherwise only wallet addresses at the tip are.\n",
         {
             {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address to check balance (hex or base58)"},
             {"block", RPCArg::Type::STR, RPCArg::Default{"latest"}, "Block number or 'latest', 'earliest', 'pending'"},
@@ -598,10 +763,33 @@ static RPCHelpMan eth_getBalance()
         validAddress = true;
     }
 
+    // Answer for any address from the address balance index
+    if (fAddressIndex) {
+        ChainstateManager& chainman = EnsureAnyChainman(request.context);
+        const int64_t blockNum = ParseEthBlockNumber(request.params[1], chainman);
+        {
+            LOCK(cs_main);
+            if (blockNum < 0 || blockNum > chainman.ActiveChain().Height()) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Block not found");
+            }
+        }
+
+        uint256 hashBytes;
+        int type = 0;
+        if (!DecodeIndexKey(base58Addr, hashBytes, type)) {
+            return "0x0";
+        }
+        CAddressBalanceValue value;
+        if (!GetAddressBalance(hashBytes, type, blockNum, value)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read address balance");
+        }
+        return SatoshiToWei(value.balance);
+    }
+
     // Decode the destination for wallet lookup
     CTxDestination dest = DecodeDestination(base58Addr);
 
-    // Try to get balance from wallet first (gracefully handle missing wallet)
+    // Without -addrindex only the addresses of the wallet are known
     try {
         const std::shared_ptr<wallet::CWallet> pwallet = wallet::GetWalletForJSONRPCRequest(request);
         if (pwallet) {
@@ -621,8 +809,7 @@ static RPCHelpMan eth_getBalance()
 
     // Address not in wallet - return 0
     // Note: In UTXO model, we can't efficiently scan all UTXOs for an address
-    // without a full address index. For external addresses not in wallet, return 0.
-    // This is a limitation compared to account-based chains like Ethereum.
+    // without -addrindex. For external addresses not in wallet, return 0.
     return "0x0";
 },
     };
@@ -687,7 +874,8 @@ static RPCHelpMan eth_accounts()
 static RPCHelpMan eth_getTransactionCount()
 {
     return RPCHelpMan{"eth_getTransactionCount",
-        "\nReturns the number of transactions sent from an address (nonce).\n",
+        "\nReturns the number of transactions sent from an address (nonce). For 'pending', the contract\n"
+        "transactions of the address waiting in the mempool are counted too.\n",
         {
             {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address to get transaction count (hex or base58)"},
             {"block", RPCArg::Type::STR, RPCArg::Default{"latest"}, "Block number or 'latest', 'earliest', 'pending'"},
@@ -757,6 +945,15 @@ static RPCHelpMan eth_getTransactionCount()
         // Wallet not available
     }
 
+    // Pending contract txs of the sender follow its confirmed ones
+    const bool pending = request.params[1].isStr() && request.params[1].get_str() == "pending";
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    if (pending && node.mempool) {
+        if (const PKHash* keyHash = std::get_if<PKHash>(&dest)) {
+            txCount += node.mempool->GetSenderTxCount(uint160(*keyHash));
+        }
+    }
+
     return IntToHex(txCount);
 },
     };
@@ -888,16 +1085,20 @@ static RPCHelpMan eth_call()
     // Parse block number
     int64_t blockNum = ParseEthBlockNumber(request.params[1], chainman);
 
-    LOCK(cs_main);
+    // Execute the call on the state as of that block, without holding cs_main
+    std::shared_ptr<const EvmStateSnapshot> snapshot;
+    if (blockNum >= 0 && blockNum <= std::numeric_limits<int>::max()) {
+        snapshot = GetEvmCallPool().GetSnapshot(chainman.ActiveChainstate(), static_cast<int>(blockNum));
+    }
+    if (!snapshot) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Block not found");
+    }
 
     dev::Address contractAddr(toAddr);
-
-    // Execute the call
-    std::vector<ResultExecute> execResults = CallContract(
+    std::vector<ResultExecute> execResults = GetEvmCallPool().Call(
+        *snapshot,
         contractAddr,
         ParseHex(dataHex),
-        chainman.ActiveChainstate(),
-        static_cast<int>(blockNum),
         senderAddress,
         gasLimit,
         nAmount
@@ -1055,7 +1256,7 @@ static RPCHelpMan eth_estimateGas()
                 {
                     {"from", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The sender address"},
                     {"to", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The contract address"},
-                    {"gas", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Gas limit"},
+                    {"gas", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Highest gas limit to consider"},
                     {"gasPrice", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Gas price"},
                     {"value", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Value to send"},
                     {"data", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The data to send"},
@@ -1126,35 +1327,51 @@ static RPCHelpMan eth_estimateGas()
         nAmount = WeiToSatoshi(txObj["value"].get_str());
     }
 
-    LOCK(cs_main);
+    // Parse gas cap
+    uint64_t gasCap = ETH_MAX_GAS_LIMIT;
+    if (!txObj["gas"].isNull()) {
+        gasCap = HexToInt(txObj["gas"].get_str());
+    }
+
+    // Parse block number
+    int64_t blockNum = ParseEthBlockNumber(request.params[1], chainman);
+
+    std::shared_ptr<const EvmStateSnapshot> snapshot;
+    if (blockNum >= 0 && blockNum <= std::numeric_limits<int>::max()) {
+        snapshot = GetEvmCallPool().GetSnapshot(chainman.ActiveChainstate(), static_cast<int>(blockNum));
+    }
+    if (!snapshot) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Block not found");
+    }
 
     // If it's just a simple transfer (no data, valid to address)
     if (dataHex.empty() && !toAddr.empty()) {
         dev::Address contractAddr(toAddr);
-        if (!globalState->addressInUse(contractAddr)) {
+        if (!snapshot->MakeState()->addressInUse(contractAddr)) {
             // Simple transfer to non-contract address
             return IntToHex(ETH_NON_CONTRACT_GAS);
         }
     }
 
-    // Execute the call to estimate gas
+    // Search for the lowest gas limit the call succeeds with
     dev::Address contractAddr(toAddr);
-    std::vector<ResultExecute> execResults = CallContract(
+    EvmGasEstimate estimate = GetEvmCallPool().EstimateGas(
+        *snapshot,
         contractAddr,
         ParseHex(dataHex),
-        chainman.ActiveChainstate(),
         senderAddress,
-        ETH_MAX_GAS_LIMIT,
+        gasCap,
         nAmount
     );
 
-    if (execResults.empty()) {
-        return IntToHex(ETH_NON_CONTRACT_GAS);
+    if (!estimate.success) {
+        if (estimate.capResult.excepted == dev::eth::TransactionException::RevertInstruction) {
+            throw JSONRPCError(RPC_MISC_ERROR, "execution reverted: 0x" + HexStr(estimate.capResult.output));
+        }
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("gas required exceeds allowance (%d)", estimate.gas));
     }
 
-    // Return gas used plus a buffer (20%)
-    uint64_t gasUsed = static_cast<uint64_t>(execResults[0].execRes.gasUsed);
-    uint64_t estimatedGas = gasUsed + (gasUsed / 5); // Add 20% buffer
+    uint64_t estimatedGas = estimate.gas;
 
     // Ensure minimum gas
     if (estimatedGas < ETH_NON_CONTRACT_GAS) {
@@ -1646,6 +1863,163 @@ static RPCHelpMan eth_getTransactionReceipt()
 // Phase 5: Block and Log Methods
 // ============================================================================
 
+// ============================================================================
+// Block Cache
+// ============================================================================
+
+//! Threads searching the chunks of one eth_getLogs range
+static constexpr size_t ETH_MAX_LOG_THREADS{8};
+
+//! Full transaction lists shorter than this are formatted on the calling thread
+static constexpr size_t ETH_PARALLEL_FORMAT_MIN_TXS{256};
+//! Threads formatting one block's transactions
+static constexpr size_t ETH_MAX_FORMAT_THREADS{8};
+//! Approximate memory the block cache may hold
+static constexpr size_t ETH_BLOCK_CACHE_BYTES{64 << 20};
+
+/**
+ * Recently requested blocks and their ETH formatting
+ *
+ * Explorers and bridges keep asking for the same recent blocks, so the
+ * blocks read from disk and the block objects formatted from them, with and
+ * without full transactions, are kept in an LRU. Entries are keyed by block
+ * hash: the block and the index fields the formatting uses never change for
+ * a hash, so a reorg cannot make an entry stale. Requests by number resolve
+ * the number on the active chain first, and a disconnected block just ages
+ * out. The size of an entry is estimated from the block's serialized size
+ * and transaction count.
+ */
+class EthBlockCache
+{
+public:
+    std::shared_ptr<const CBlock> GetBlock(const uint256& hash)
+    {
+        LOCK(m_mutex);
+        Entry* entry = Find(hash);
+        return entry ? entry->block : nullptr;
+    }
+
+    std::shared_ptr<const UniValue> GetFormatted(const uint256& hash, bool fullTransactions)
+    {
+        LOCK(m_mutex);
+        Entry* entry = Find(hash);
+        return entry ? entry->formatted[fullTransactions] : nullptr;
+    }
+
+    void PutBlock(const uint256& hash, std::shared_ptr<const CBlock> block)
+    {
+        const size_t cost = GetSerializeSize(TX_WITH_WITNESS(*block));
+        LOCK(m_mutex);
+        Entry& entry = Insert(hash);
+        if (entry.block) return;
+        entry.block = std::move(block);
+        Charge(entry, cost);
+    }
+
+    void PutFormatted(const uint256& hash, bool fullTransactions, size_t txCount, std::shared_ptr<const UniValue> formatted)
+    {
+        // Rough UniValue footprint of a transaction hash or object
+        const size_t cost = 1024 + txCount * (fullTransactions ? 2048 : 128);
+        LOCK(m_mutex);
+        Entry& entry = Insert(hash);
+        if (entry.formatted[fullTransactions]) return;
+        entry.formatted[fullTransactions] = std::move(formatted);
+        Charge(entry, cost);
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const CBlock> block;
+        //! Without and with full transactions
+        std::shared_ptr<const UniValue> formatted[2];
+        size_t cost{0};
+        std::list<uint256>::iterator lru;
+    };
+
+    Entry* Find(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        auto it = m_entries.find(hash);
+        if (it == m_entries.end()) return nullptr;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        return &it->second;
+    }
+
+    Entry& Insert(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        if (Entry* entry = Find(hash)) return *entry;
+        m_lru.push_front(hash);
+        Entry& entry = m_entries[hash];
+        entry.lru = m_lru.begin();
+        return entry;
+    }
+
+    void Charge(Entry& entry, size_t cost) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        entry.cost += cost;
+        m_total += cost;
+        // The entry just charged is the most recent one, and is kept
+        while (m_total > ETH_BLOCK_CACHE_BYTES && m_lru.size() > 1) {
+            auto it = m_entries.find(m_lru.back());
+            m_total -= it->second.cost;
+            m_entries.erase(it);
+            m_lru.pop_back();
+        }
+    }
+
+    Mutex m_mutex;
+    //! Most recently used first
+    std::list<uint256> m_lru GUARDED_BY(m_mutex);
+    std::unordered_map<uint256, Entry, BlockHasher> m_entries GUARDED_BY(m_mutex);
+    size_t m_total GUARDED_BY(m_mutex){0};
+};
+
+static EthBlockCache g_eth_block_cache;
+
+static const CBlockIndex* EthBlockIndexAtHeight(ChainstateManager& chainman, int64_t height)
+{
+    LOCK(cs_main);
+    const CChain& active_chain = chainman.ActiveChain();
+    if (height < 0 || height > active_chain.Height()) {
+        return nullptr;
+    }
+    return active_chain[height];
+}
+
+static const CBlockIndex* EthBlockIndexByHash(ChainstateManager& chainman, const uint256& hash)
+{
+    LOCK(cs_main);
+    return chainman.m_blockman.LookupBlockIndex(hash);
+}
+
+// Read a block, from the cache if it was read recently. Doesn't need cs_main.
+static std::shared_ptr<const CBlock> ReadEthBlock(ChainstateManager& chainman, const CBlockIndex& index)
+{
+    const uint256 hash = index.GetBlockHash();
+    if (auto block = g_eth_block_cache.GetBlock(hash)) {
+        return block;
+    }
+    auto block = std::make_shared<CBlock>();
+    if (!chainman.m_blockman.ReadBlock(*block, index)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+    }
+    g_eth_block_cache.PutBlock(hash, block);
+    return block;
+}
+
+// The block in ETH format, from the cache if it was formatted recently
+static UniValue GetEthBlock(ChainstateManager& chainman, const CBlockIndex& index, bool fullTransactions)
+{
+    const uint256 hash = index.GetBlockHash();
+    if (auto formatted = g_eth_block_cache.GetFormatted(hash, fullTransactions)) {
+        return *formatted;
+    }
+    const auto block = ReadEthBlock(chainman, index);
+    auto formatted = std::make_shared<const UniValue>(FormatEthBlockInternal(*block, &index, fullTransactions, chainman));
+    g_eth_block_cache.PutFormatted(hash, fullTransactions, block->vtx.size(), formatted);
+    return *formatted;
+}
+
 static RPCHelpMan eth_getBlockByNumber()
 {
     return RPCHelpMan{"eth_getBlockByNumber",
@@ -1691,25 +2065,12 @@ static RPCHelpMan eth_getBlockByNumber()
     int64_t blockHeight = ParseEthBlockNumber(request.params[0], chainman);
     bool fullTransactions = !request.params[1].isNull() && request.params[1].get_bool();
 
-    LOCK(cs_main);
-
-    CChain& active_chain = chainman.ActiveChain();
-    if (blockHeight < 0 || blockHeight > active_chain.Height()) {
-        return UniValue(UniValue::VNULL);
-    }
-
-    CBlockIndex* pblockindex = active_chain[blockHeight];
+    const CBlockIndex* pblockindex = EthBlockIndexAtHeight(chainman, blockHeight);
     if (!pblockindex) {
         return UniValue(UniValue::VNULL);
     }
 
-    // Read the block
-    CBlock block;
-    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
-
-    return FormatEthBlockInternal(block, pblockindex, fullTransactions, chainman);
+    return GetEthBlock(chainman, *pblockindex, fullTransactions);
 },
     };
 }
@@ -1744,20 +2105,12 @@ static RPCHelpMan eth_getBlockByHash()
     uint256 hash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
     bool fullTransactions = !request.params[1].isNull() && request.params[1].get_bool();
 
-    LOCK(cs_main);
-
-    CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+    const CBlockIndex* pblockindex = EthBlockIndexByHash(chainman, hash);
     if (!pblockindex) {
         return UniValue(UniValue::VNULL);
     }
 
-    // Read the block
-    CBlock block;
-    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
-
-    return FormatEthBlockInternal(block, pblockindex, fullTransactions, chainman);
+    return GetEthBlock(chainman, *pblockindex, fullTransactions);
 },
     };
 }
@@ -1781,25 +2134,12 @@ static RPCHelpMan eth_getBlockTransactionCountByNumber()
 
     int64_t blockHeight = ParseEthBlockNumber(request.params[0], chainman);
 
-    LOCK(cs_main);
-
-    CChain& active_chain = chainman.ActiveChain();
-    if (blockHeight < 0 || blockHeight > active_chain.Height()) {
-        return UniValue(UniValue::VNULL);
-    }
-
-    CBlockIndex* pblockindex = active_chain[blockHeight];
+    const CBlockIndex* pblockindex = EthBlockIndexAtHeight(chainman, blockHeight);
     if (!pblockindex) {
         return UniValue(UniValue::VNULL);
     }
 
-    // Read the block
-    CBlock block;
-    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
-
-    return IntToHex(block.vtx.size());
+    return IntToHex(ReadEthBlock(chainman, *pblockindex)->vtx.size());
 },
     };
 }
@@ -1828,20 +2168,12 @@ static RPCHelpMan eth_getBlockTransactionCountByHash()
 
     uint256 hash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
 
-    LOCK(cs_main);
-
-    CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+    const CBlockIndex* pblockindex = EthBlockIndexByHash(chainman, hash);
     if (!pblockindex) {
         return UniValue(UniValue::VNULL);
     }
 
-    // Read the block
-    CBlock block;
-    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
-
-    return IntToHex(block.vtx.size());
+    return IntToHex(ReadEthBlock(chainman, *pblockindex)->vtx.size());
 },
     };
 }
@@ -1872,29 +2204,18 @@ static RPCHelpMan eth_getTransactionByBlockNumberAndIndex()
     int64_t blockHeight = ParseEthBlockNumber(request.params[0], chainman);
     uint64_t txIndex = HexToInt(request.params[1].get_str());
 
-    LOCK(cs_main);
-
-    CChain& active_chain = chainman.ActiveChain();
-    if (blockHeight < 0 || blockHeight > active_chain.Height()) {
-        return UniValue(UniValue::VNULL);
-    }
-
-    CBlockIndex* pblockindex = active_chain[blockHeight];
+    const CBlockIndex* pblockindex = EthBlockIndexAtHeight(chainman, blockHeight);
     if (!pblockindex) {
         return UniValue(UniValue::VNULL);
     }
 
-    // Read the block
-    CBlock block;
-    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
+    const auto block = ReadEthBlock(chainman, *pblockindex);
 
-    if (txIndex >= block.vtx.size()) {
+    if (txIndex >= block->vtx.size()) {
         return UniValue(UniValue::VNULL);
     }
 
-    const CTransactionRef& tx = block.vtx[txIndex];
+    const CTransactionRef& tx = block->vtx[txIndex];
     return FormatEthTransactionInternal(*tx, pblockindex, txIndex);
 },
     };
@@ -1931,24 +2252,18 @@ static RPCHelpMan eth_getTransactionByBlockHashAndIndex()
     uint256 hash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
     uint64_t txIndex = HexToInt(request.params[1].get_str());
 
-    LOCK(cs_main);
-
-    CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+    const CBlockIndex* pblockindex = EthBlockIndexByHash(chainman, hash);
     if (!pblockindex) {
         return UniValue(UniValue::VNULL);
     }
 
-    // Read the block
-    CBlock block;
-    if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
-    }
+    const auto block = ReadEthBlock(chainman, *pblockindex);
 
-    if (txIndex >= block.vtx.size()) {
+    if (txIndex >= block->vtx.size()) {
         return UniValue(UniValue::VNULL);
     }
 
-    const CTransactionRef& tx = block.vtx[txIndex];
+    const CTransactionRef& tx = block->vtx[txIndex];
     return FormatEthTransactionInternal(*tx, pblockindex, txIndex);
 },
     };
@@ -1957,12 +2272,14 @@ static RPCHelpMan eth_getTransactionByBlockHashAndIndex()
 static RPCHelpMan eth_getLogs()
 {
     return RPCHelpMan{"eth_getLogs",
-        "\nReturns an array of all logs matching a given filter object.\n",
+        "\nReturns an array of all logs matching a given filter object.\n"
+        "A range with more logs than -rpcmaxlogs fails with error -32005, which names the\n"
+        "longest range from fromBlock that fits; continue after its toBlock.\n",
         {
             {"filter", RPCArg::Type::OBJ, RPCArg::Optional::NO, "The filter options",
                 {
-                    {"fromBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Starting block (hex, 'latest', 'earliest')"},
-                    {"toBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Ending block (hex, 'latest', 'earliest')"},
+                    {"fromBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Starting block (hex, 'latest', 'earliest', default 'latest')"},
+                    {"toBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Ending block (hex, 'latest', 'earliest', default 'latest')"},
                     {"address", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Contract address or array of addresses"},
                     {"topics", RPCArg::Type::ARR, RPCArg::Optional::OMITTED, "Array of 32-byte topic filters",
                         {
@@ -2003,126 +2320,184 @@ static RPCHelpMan eth_getLogs()
     }
 
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
-    UniValue filterObj = request.params[0].get_obj();
-
-    LOCK(cs_main);
-
-    CChain& active_chain = chainman.ActiveChain();
-    int numBlocks = active_chain.Height();
-
-    // Parse block range
-    int64_t fromBlock = 0;
-    int64_t toBlock = numBlocks;
+    const UniValue& filterObj = request.params[0].get_obj();
+    node::EthLogFilter filter = ParseEthLogFilter(filterObj, chainman);
 
+    // The chunks are searched without cs_main, each against the blocks active when it started
+    int fromBlock;
+    int toBlock;
+    std::optional<uint256> blockHash;
     if (!filterObj["blockhash"].isNull()) {
-        // Single block by hash
         std::string hashStr = StripHexPrefix(filterObj["blockhash"].get_str());
-        uint256 hash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
-        CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+        blockHash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
+        const CBlockIndex* pblockindex = WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(*blockHash));
         if (!pblockindex) {
             return UniValue(UniValue::VARR);  // Empty array
         }
         fromBlock = toBlock = pblockindex->nHeight;
+        filter.fromBlock = filter.toBlock = -1;
     } else {
-        if (!filterObj["fromBlock"].isNull()) {
-            fromBlock = ParseEthBlockNumber(filterObj["fromBlock"], chainman);
-        }
-        if (!filterObj["toBlock"].isNull()) {
-            toBlock = ParseEthBlockNumber(filterObj["toBlock"], chainman);
+        const int tipHeight = WITH_LOCK(cs_main, return chainman.ActiveChain().Height());
+        fromBlock = filter.fromBlock < 0 ? tipHeight : filter.fromBlock;
+        toBlock = filter.toBlock < 0 ? tipHeight : filter.toBlock;
+        if (fromBlock > toBlock) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "invalid block range");
         }
     }
 
-    // Build searchlogs params
-    UniValue searchParams(UniValue::VARR);
-    searchParams.push_back((int64_t)fromBlock);
-    searchParams.push_back((int64_t)toBlock);
+    // A single block cannot be split, so only longer ranges are capped
+    const int64_t maxLogs = EnsureAnyArgsman(request.context).GetIntArg("-rpcmaxlogs", DEFAULT_ETH_MAX_LOGS);
+    const bool capped = maxLogs > 0 && fromBlock < toBlock;
 
-    // Addresses
-    UniValue addressesObj(UniValue::VOBJ);
-    if (!filterObj["address"].isNull()) {
-        UniValue addresses(UniValue::VARR);
-        if (filterObj["address"].isStr()) {
-            std::string normalized;
-            if (NormalizeEthAddress(filterObj["address"].get_str(), normalized)) {
-                addresses.push_back(StripHexPrefix(normalized));
-            }
-        } else if (filterObj["address"].isArray()) {
-            for (const auto& addr : filterObj["address"].getValues()) {
-                std::string normalized;
-                if (NormalizeEthAddress(addr.get_str(), normalized)) {
-                    addresses.push_back(StripHexPrefix(normalized));
-                }
-            }
-        }
-        addressesObj.pushKV("addresses", addresses);
+    // Chunks follow the sections of the log bloom index, a wave of them is searched in parallel
+    std::vector<std::pair<int, int>> chunks;
+    for (int low = fromBlock; low <= toBlock;) {
+        const int high = std::min<int64_t>(toBlock, (low / LOG_BLOOM_SECTION_SIZE + 1) * (int64_t)LOG_BLOOM_SECTION_SIZE - 1);
+        chunks.emplace_back(low, high);
+        low = high + 1;
     }
-    searchParams.push_back(addressesObj);
+    const size_t threads = std::min<size_t>({chunks.size(), std::max(std::thread::hardware_concurrency(), 1U), ETH_MAX_LOG_THREADS});
 
-    // Topics
-    UniValue topicsObj(UniValue::VOBJ);
-    if (!filterObj["topics"].isNull() && filterObj["topics"].isArray()) {
-        UniValue topics(UniValue::VARR);
-        for (const auto& topic : filterObj["topics"].getValues()) {
-            if (topic.isNull()) {
-                topics.push_back(UniValue(UniValue::VNULL));
-            } else {
-                topics.push_back(StripHexPrefix(topic.get_str()));
+    std::vector<node::EthFilterLog> logs;
+    for (size_t wave = 0; wave < chunks.size(); wave += threads) {
+        const size_t waveEnd = std::min(wave + threads, chunks.size());
+        std::vector<std::vector<uint256>> hashes(waveEnd - wave);
+        {
+            LOCK(cs_main);
+            const CChain& chain = chainman.ActiveChain();
+            for (size_t i = wave; i < waveEnd; i++) {
+                if (blockHash) {
+                    hashes[i - wave].push_back(*blockHash);
+                    continue;
+                }
+                for (int height = chunks[i].first; height <= chunks[i].second; height++) {
+                    const CBlockIndex* pindex = chain[height];
+                    if (!pindex) break;
+                    hashes[i - wave].push_back(pindex->GetBlockHash());
+                }
             }
         }
-        topicsObj.pushKV("topics", topics);
-    }
-    searchParams.push_back(topicsObj);
 
-    // Min confirmations
-    searchParams.push_back(0);
+        std::vector<std::future<std::vector<node::EthFilterLog>>> parts;
+        for (size_t i = wave + 1; i < waveEnd; i++) {
+            parts.push_back(std::async(std::launch::async, node::ReadIndexedLogs, std::cref(filter), chunks[i].first, std::cref(hashes[i - wave]), std::ref(chainman)));
+        }
+        std::vector<node::EthFilterLog> first = node::ReadIndexedLogs(filter, chunks[wave].first, hashes[0], chainman);
+        logs.insert(logs.end(), std::make_move_iterator(first.begin()), std::make_move_iterator(first.end()));
+        for (auto& part : parts) {
+            std::vector<node::EthFilterLog> chunkLogs = part.get();
+            logs.insert(logs.end(), std::make_move_iterator(chunkLogs.begin()), std::make_move_iterator(chunkLogs.end()));
+        }
 
-    // Call searchlogs
-    UniValue searchResults = SearchLogs(searchParams, chainman);
+        if (capped && logs.size() > (size_t)maxLogs) {
+            // Suggest the longest range from fromBlock that fits, the query continues after it
+            const int lastFitting = std::max(fromBlock, logs[maxLogs].blockNumber - 1);
+            UniValue error = JSONRPCError(ETH_RPC_LIMIT_EXCEEDED, strprintf("query returned more than %d results. Try with this block range [%s, %s].",
+                                                                            maxLogs, IntToHex(fromBlock), IntToHex(lastFitting)));
+            UniValue data(UniValue::VOBJ);
+            data.pushKV("fromBlock", IntToHex(fromBlock));
+            data.pushKV("toBlock", IntToHex(lastFitting));
+            error.pushKV("data", data);
+            throw error;
+        }
+    }
 
-    // Format results in ETH format
-    UniValue result(UniValue::VARR);
-    size_t logIndex = 0;
+    // Streamed when the transport allows, the logs are never one UniValue tree
+    JSONRPCResultWriter result{request};
+    result.BeginArray();
+    for (const node::EthFilterLog& log : logs) {
+        if (!result.Alive()) break;
+        result.Value(EthFilterLogToJSON(log));
+    }
+    result.End();
+    return result.Finish();
+},
+    };
+}
 
-    for (size_t i = 0; i < searchResults.size(); i++) {
-        const UniValue& receipt = searchResults[i];
+static std::shared_ptr<node::EthFilterManager> EnsureEthFilters()
+{
+    std::shared_ptr<node::EthFilterManager> filters = node::GetEthFilterManager();
+    if (!filters) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Filters are not available");
+    }
+    return filters;
+}
 
-        if (!receipt.exists("log")) continue;
+node::EthLogFilter ParseEthLogFilter(const UniValue& filterObj, ChainstateManager& chainman)
+{
+    node::EthLogFilter filter;
 
-        const UniValue& logs = receipt["log"];
-        for (size_t j = 0; j < logs.size(); j++) {
-            const UniValue& log = logs[j];
+    // Open ended unless a block number is given, the filter follows the tip
+    auto parseBound = [&](const UniValue& param) -> int {
+        if (param.isNull() || (param.isStr() && (param.get_str() == "latest" || param.get_str() == "pending"))) {
+            return -1;
+        }
+        return ParseEthBlockNumber(param, chainman);
+    };
+    filter.fromBlock = parseBound(filterObj["fromBlock"]);
+    filter.toBlock = parseBound(filterObj["toBlock"]);
 
-            UniValue logEntry(UniValue::VOBJ);
-            logEntry.pushKV("address", "0x" + log["address"].get_str());
+    auto parseAddress = [&](const UniValue& param) {
+        std::string normalized;
+        if (!param.isStr() || !NormalizeEthAddress(param.get_str(), normalized)) {
+            throw JSONRPCError(RPC_INVALID_PARAMS, "Invalid address");
+        }
+        filter.addresses.insert(dev::h160(StripHexPrefix(normalized)));
+    };
+    const UniValue& address = filterObj["address"];
+    if (address.isArray()) {
+        for (const auto& addr : address.getValues()) {
+            parseAddress(addr);
+        }
+    } else if (!address.isNull()) {
+        parseAddress(address);
+    }
 
-            UniValue topics(UniValue::VARR);
-            if (log.exists("topics")) {
-                for (const auto& topic : log["topics"].getValues()) {
-                    topics.push_back("0x" + topic.get_str());
+    auto parseTopic = [](const UniValue& param) {
+        std::string hex = param.isStr() ? StripHexPrefix(param.get_str()) : "";
+        if (hex.size() != 64 || !IsHex(hex)) {
+            throw JSONRPCError(RPC_INVALID_PARAMS, "Invalid topic");
+        }
+        return dev::h256(hex);
+    };
+    const UniValue& topics = filterObj["topics"];
+    if (topics.isArray()) {
+        // Each position is null for any topic, a topic, or a list of alternatives
+        for (const auto& position : topics.getValues()) {
+            std::set<dev::h256> alternatives;
+            if (position.isArray()) {
+                for (const auto& topic : position.getValues()) {
+                    alternatives.insert(parseTopic(topic));
                 }
+            } else if (!position.isNull()) {
+                alternatives.insert(parseTopic(position));
             }
-            logEntry.pushKV("topics", topics);
-            logEntry.pushKV("data", "0x" + log["data"].get_str());
-            logEntry.pushKV("blockNumber", IntToHex(receipt["blockNumber"].getInt<int64_t>()));
-            logEntry.pushKV("transactionHash", "0x" + receipt["transactionHash"].get_str());
-            logEntry.pushKV("transactionIndex", IntToHex(receipt["transactionIndex"].getInt<int64_t>()));
-            logEntry.pushKV("blockHash", "0x" + receipt["blockHash"].get_str());
-            logEntry.pushKV("logIndex", IntToHex(logIndex++));
-            logEntry.pushKV("removed", false);
-
-            result.push_back(logEntry);
+            filter.topics.push_back(std::move(alternatives));
         }
     }
 
-    return result;
-},
-    };
+    return filter;
 }
 
-// Filter storage for eth_newFilter
-static std::mutex g_filter_mutex;
-static std::map<std::string, UniValue> g_filters;
-static uint64_t g_next_filter_id = 1;
+UniValue EthFilterLogToJSON(const node::EthFilterLog& log)
+{
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("address", "0x" + log.address.hex());
+    UniValue topics(UniValue::VARR);
+    for (const auto& topic : log.topics) {
+        topics.push_back("0x" + topic.hex());
+    }
+    entry.pushKV("topics", topics);
+    entry.pushKV("data", "0x" + HexStr(log.data));
+    entry.pushKV("blockNumber", IntToHex(log.blockNumber));
+    entry.pushKV("transactionHash", "0x" + log.transactionHash.GetHex());
+    entry.pushKV("transactionIndex", IntToHex(log.transactionIndex));
+    entry.pushKV("blockHash", "0x" + log.blockHash.GetHex());
+    entry.pushKV("logIndex", IntToHex(log.logIndex));
+    entry.pushKV("removed", log.removed);
+    return entry;
+}
 
 static RPCHelpMan eth_newFilter()
 {
@@ -2131,10 +2506,10 @@ static RPCHelpMan eth_newFilter()
         {
             {"filter", RPCArg::Type::OBJ, RPCArg::Optional::NO, "The filter options",
                 {
-                    {"fromBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Starting block"},
-                    {"toBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Ending block"},
-                    {"address", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Contract address"},
-                    {"topics", RPCArg::Type::ARR, RPCArg::Optional::OMITTED, "Topics to match",
+                    {"fromBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Starting block (hex, 'latest', 'earliest')"},
+                    {"toBlock", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Ending block (hex, 'latest', 'earliest')"},
+                    {"address", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Contract address or array of addresses"},
+                    {"topics", RPCArg::Type::ARR, RPCArg::Optional::OMITTED, "Topics to match by position, each null for any, a topic, or an array of topics",
                         {
                             {"topic", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "32-byte topic"},
                         }},
@@ -2148,23 +2523,14 @@ static RPCHelpMan eth_newFilter()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    ChainstateManager& chainman = EnsureAnyChainman(request.context);
-
-    std::lock_guard<std::mutex> lock(g_filter_mutex);
-
-    std::string filterId = IntToHex(g_next_filter_id++);
-
-    // Store the filter parameters along with current block height
-    UniValue filterData(UniValue::VOBJ);
-    filterData.pushKV("filter", request.params[0]);
-    {
-        LOCK(cs_main);
-        filterData.pushKV("lastBlock", chainman.ActiveChain().Height());
+    if (!fLogEvents) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Events indexing disabled. Start with -logevents to enable.");
     }
 
-    g_filters[filterId] = filterData;
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    node::EthLogFilter filter = ParseEthLogFilter(request.params[0].get_obj(), chainman);
 
-    return filterId;
+    return EnsureEthFilters()->NewLogFilter(std::move(filter));
 },
     };
 }
@@ -2172,7 +2538,8 @@ static RPCHelpMan eth_newFilter()
 static RPCHelpMan eth_getFilterChanges()
 {
     return RPCHelpMan{"eth_getFilterChanges",
-        "\nPolling method for a filter, which returns an array of logs which occurred since last poll.\n",
+        "\nPolling method for a filter, which returns an array of logs which occurred since last poll.\n"
+        "Block and pending transaction filters return hashes. Filters not polled for 5 minutes are uninstalled.\n",
         {
             {"filterId", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The filter ID"},
         },
@@ -2187,60 +2554,26 @@ static RPCHelpMan eth_getFilterChanges()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    if (!fLogEvents) {
-        throw JSONRPCError(RPC_MISC_ERROR, "Events indexing disabled");
-    }
-
-    ChainstateManager& chainman = EnsureAnyChainman(request.context);
     std::string filterId = request.params[0].get_str();
 
-    std::lock_guard<std::mutex> lock(g_filter_mutex);
-
-    auto it = g_filters.find(filterId);
-    if (it == g_filters.end()) {
+    node::EthFilterManager::FilterType type;
+    std::vector<node::EthFilterLog> logs;
+    std::vector<uint256> hashes;
+    if (!EnsureEthFilters()->GetChanges(filterId, type, logs, hashes)) {
         throw JSONRPCError(RPC_INVALID_PARAMS, "Filter not found");
     }
 
-    UniValue& filterData = it->second;
-    int64_t lastBlock = filterData["lastBlock"].getInt<int64_t>();
-
-    int64_t currentBlock;
-    {
-        LOCK(cs_main);
-        currentBlock = chainman.ActiveChain().Height();
-    }
-
-    // Update last block
-    filterData.pushKV("lastBlock", currentBlock);
-
-    if (lastBlock >= currentBlock) {
-        return UniValue(UniValue::VARR);  // No new blocks
-    }
-
-    // Get logs for new blocks
-    UniValue filterParams(UniValue::VOBJ);
-    filterParams.pushKV("fromBlock", IntToHex(lastBlock + 1));
-    filterParams.pushKV("toBlock", IntToHex(currentBlock));
-
-    // Copy address and topics from stored filter
-    if (filterData["filter"].exists("address")) {
-        filterParams.pushKV("address", filterData["filter"]["address"]);
-    }
-    if (filterData["filter"].exists("topics")) {
-        filterParams.pushKV("topics", filterData["filter"]["topics"]);
+    UniValue result(UniValue::VARR);
+    if (type == node::EthFilterManager::FilterType::LOG) {
+        for (const auto& log : logs) {
+            result.push_back(EthFilterLogToJSON(log));
+        }
+    } else {
+        for (const auto& hash : hashes) {
+            result.push_back("0x" + hash.GetHex());
+        }
     }
-
-    // Create a temporary request to call eth_getLogs
-    UniValue getLogsParams(UniValue::VARR);
-    getLogsParams.push_back(filterParams);
-
-    JSONRPCRequest subrequest;
-    subrequest.context = request.context;
-    subrequest.params = getLogsParams;
-
-    // Manually invoke the eth_getLogs logic
-    // (In a real implementation, we'd have a shared function)
-    return UniValue(UniValue::VARR);  // Simplified - return empty for now
+    return result;
 },
     };
 }
@@ -2259,17 +2592,7 @@ static RPCHelpMan eth_uninstallFilter()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    std::string filterId = request.params[0].get_str();
-
-    std::lock_guard<std::mutex> lock(g_filter_mutex);
-
-    auto it = g_filters.find(filterId);
-    if (it == g_filters.end()) {
-        return false;
-    }
-
-    g_filters.erase(it);
-    return true;
+    return EnsureEthFilters()->Uninstall(request.params[0].get_str());
 },
     };
 }
@@ -2286,48 +2609,203 @@ static RPCHelpMan eth_newBlockFilter()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    return EnsureEthFilters()->NewBlockFilter();
+},
+    };
+}
 
-    std::lock_guard<std::mutex> lock(g_filter_mutex);
+static RPCHelpMan eth_newPendingTransactionFilter()
+{
+    return RPCHelpMan{"eth_newPendingTransactionFilter",
+        "\nCreates a filter to notify when new pending transactions arrive.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::STR_HEX, "", "The filter ID"},
+        RPCExamples{
+            HelpExampleCli("eth_newPendingTransactionFilter", "")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    return EnsureEthFilters()->NewPendingTransactionFilter();
+},
+    };
+}
 
-    std::string filterId = IntToHex(g_next_filter_id++);
+// ============================================================================
+// Debug tracing
+// ============================================================================
 
-    UniValue filterData(UniValue::VOBJ);
-    filterData.pushKV("type", "block");
+static const RPCArg ETH_TRACE_OPTIONS_ARG{"options", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "The trace options",
     {
+        {"tracer", RPCArg::Type::STR, RPCArg::Default{"callTracer"}, "Built-in tracer, 'callTracer' or 'prestateTracer'"},
+        {"tracerConfig", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "Options of the tracer",
+            {
+                {"onlyTopCall", RPCArg::Type::BOOL, RPCArg::Default{false}, "callTracer: leave out the inner calls"},
+            }},
+    }};
+
+static EvmTraceOptions ParseEvmTraceOptions(const UniValue& params)
+{
+    EvmTraceOptions options;
+    if (params.isNull()) return options;
+
+    const UniValue& tracer = params.get_obj().find_value("tracer");
+    if (!tracer.isNull()) {
+        std::optional<EvmTracerType> type = ParseEvmTracerType(tracer.get_str());
+        if (!type) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Unsupported tracer %s, the built-in tracers are callTracer and prestateTracer", tracer.get_str()));
+        }
+        options.tracer = *type;
+    }
+    const UniValue& config = params.get_obj().find_value("tracerConfig");
+    if (config.isObject() && !config.find_value("onlyTopCall").isNull()) {
+        options.onlyTopCall = config.find_value("onlyTopCall").get_bool();
+    }
+    return options;
+}
+
+// Traces are written as JSON text while replaying, the server copies a number's text as is
+static UniValue EthTraceResult(std::string json)
+{
+    return UniValue(UniValue::VNUM, std::move(json));
+}
+
+static std::string TraceEthBlock(ChainstateManager& chainman, CBlockIndex* pindex, const uint256* txid, const EvmTraceOptions& options)
+{
+    std::unique_ptr<EvmBlockReplay> replay;
+    try {
         LOCK(cs_main);
-        filterData.pushKV("lastBlock", chainman.ActiveChain().Height());
+        if (!globalState) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Contract state not available");
+        }
+        replay = std::make_unique<EvmBlockReplay>(chainman.ActiveChainstate(), *pindex);
+    } catch (const std::runtime_error& e) {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
 
-    g_filters[filterId] = filterData;
+    // The replay itself runs without cs_main
+    std::string out;
+    if (txid) {
+        if (!replay->TraceTransaction(*txid, options, out)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction has no contract execution");
+        }
+    } else {
+        replay->TraceBlock(options, out);
+    }
+    return out;
+}
 
-    return filterId;
+static RPCHelpMan debug_traceTransaction()
+{
+    return RPCHelpMan{"debug_traceTransaction",
+        "\nReplays a transaction of the chain and returns the trace of its contract execution.\n"
+        "The transactions before it in its block are replayed first. A transaction with several\n"
+        "contract outputs is traced by its first, as eth_getTransactionReceipt reports it.\n",
+        {
+            {"hash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The transaction hash"},
+            ETH_TRACE_OPTIONS_ARG,
+        },
+        RPCResult{
+            RPCResult::Type::ANY, "", "The callTracer call frame or the prestateTracer accounts"},
+        RPCExamples{
+            HelpExampleCli("debug_traceTransaction", "\"0x...\" '{\"tracer\":\"callTracer\"}'")
+            + HelpExampleRpc("debug_traceTransaction", "\"0x...\", {\"tracer\":\"prestateTracer\"}")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+
+    std::string hashStr = StripHexPrefix(request.params[0].get_str());
+    if (hashStr.size() != 64) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Invalid transaction hash");
+    }
+    const uint256 hash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
+    const EvmTraceOptions options = ParseEvmTraceOptions(request.params[1]);
+
+    // The block of the transaction, from its receipt or the transaction index
+    uint256 hashBlock;
+    if (fLogEvents) {
+        std::vector<TransactionReceiptInfo> receipts = pstorageresult->getResult(uintToh256(hash));
+        if (!receipts.empty()) hashBlock = receipts[0].blockHash;
+    }
+    CTransactionRef tx;
+    if (hashBlock.IsNull() && !(g_txindex && g_txindex->FindTx(Txid::FromUint256(hash), hashBlock, tx))) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not found, use -logevents or -txindex to trace transactions");
+    }
+
+    CBlockIndex* pindex = WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(hashBlock));
+    if (!pindex || WITH_LOCK(cs_main, return !chainman.ActiveChain().Contains(pindex))) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction is not in the active chain");
+    }
+    return EthTraceResult(TraceEthBlock(chainman, pindex, &hash, options));
 },
     };
 }
 
-static RPCHelpMan eth_newPendingTransactionFilter()
+static RPCResult EthBlockTraceResult()
 {
-    return RPCHelpMan{"eth_newPendingTransactionFilter",
-        "\nCreates a filter to notify when new pending transactions arrive.\n",
-        {},
-        RPCResult{
-            RPCResult::Type::STR_HEX, "", "The filter ID"},
+    // Written as JSON text, so not checked against a structure
+    return RPCResult{RPCResult::Type::ANY, "", "Array of {\"txHash\", \"result\"}, the traces of the contract executions of the block in order"};
+}
+
+static RPCHelpMan debug_traceBlockByNumber()
+{
+    return RPCHelpMan{"debug_traceBlockByNumber",
+        "\nReplays a block of the active chain and returns the traces of its contract executions.\n"
+        "A transaction with several contract outputs has a trace for each of them.\n",
+        {
+            {"blockNumber", RPCArg::Type::STR, RPCArg::Optional::NO, "Block number as hex, or 'latest', 'earliest'"},
+            ETH_TRACE_OPTIONS_ARG,
+        },
+        EthBlockTraceResult(),
         RPCExamples{
-            HelpExampleCli("eth_newPendingTransactionFilter", "")
+            HelpExampleCli("debug_traceBlockByNumber", "\"0x1\" '{\"tracer\":\"callTracer\"}'")
+            + HelpExampleRpc("debug_traceBlockByNumber", "\"latest\", {\"tracer\":\"callTracer\"}")
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    std::lock_guard<std::mutex> lock(g_filter_mutex);
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
 
-    std::string filterId = IntToHex(g_next_filter_id++);
+    const int64_t height = ParseEthBlockNumber(request.params[0], chainman);
+    const EvmTraceOptions options = ParseEvmTraceOptions(request.params[1]);
+    CBlockIndex* pindex = WITH_LOCK(cs_main, return height < 0 ? nullptr : chainman.ActiveChain()[height]);
+    if (!pindex) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Block not found");
+    }
+    return EthTraceResult(TraceEthBlock(chainman, pindex, nullptr, options));
+},
+    };
+}
 
-    UniValue filterData(UniValue::VOBJ);
-    filterData.pushKV("type", "pendingTransaction");
+static RPCHelpMan debug_traceBlockByHash()
+{
+    return RPCHelpMan{"debug_traceBlockByHash",
+        "\nReplays a block of the active chain and returns the traces of its contract executions.\n",
+        {
+            {"blockHash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The block hash"},
+            ETH_TRACE_OPTIONS_ARG,
+        },
+        EthBlockTraceResult(),
+        RPCExamples{
+            HelpExampleCli("debug_traceBlockByHash", "\"0x...\"")
+            + HelpExampleRpc("debug_traceBlockByHash", "\"0x...\", {\"tracer\":\"prestateTracer\"}")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
 
-    g_filters[filterId] = filterData;
+    std::string hashStr = StripHexPrefix(request.params[0].get_str());
+    if (hashStr.size() != 64) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Invalid block hash");
+    }
+    const uint256 hash = uint256::FromHex(hashStr).value_or(uint256::ZERO);
+    const EvmTraceOptions options = ParseEvmTraceOptions(request.params[1]);
 
-    return filterId;
+    CBlockIndex* pindex = WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(hash));
+    if (!pindex || WITH_LOCK(cs_main, return !chainman.ActiveChain().Contains(pindex))) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Block not found in the active chain");
+    }
+    return EthTraceResult(TraceEthBlock(chainman, pindex, nullptr, options));
 },
     };
 }
@@ -2336,8 +2814,7 @@ static RPCHelpMan eth_newPendingTransactionFilter()
 // Helper: Format block in ETH style
 // ============================================================================
 
-static UniValue FormatEthBlockInternal(const CBlock& block, const CBlockIndex* pblockindex,
-                                       bool fullTransactions, ChainstateManager& chainman)
+UniValue FormatEthBlockHeader(const CBlock& block, const CBlockIndex* pblockindex)
 {
     UniValue result(UniValue::VOBJ);
 
@@ -2391,48 +2868,86 @@ static UniValue FormatEthBlockInternal(const CBlock& block, const CBlockIndex* p
     // Timestamp
     result.pushKV("timestamp", IntToHex(block.GetBlockTime()));
 
+    return result;
+}
+
+// Full transaction object of a block's transaction list
+static UniValue FormatEthBlockTransaction(const CTransaction& tx, const std::string& blockHash, int height, size_t txIndex)
+{
+    UniValue txObj(UniValue::VOBJ);
+
+    txObj.pushKV("blockHash", blockHash);
+    txObj.pushKV("blockNumber", IntToHex(height));
+    txObj.pushKV("from", "0x0000000000000000000000000000000000000000");
+    txObj.pushKV("gas", IntToHex(21000));
+    txObj.pushKV("gasPrice", "0x9502f9000");
+    txObj.pushKV("hash", "0x" + tx.GetHash().GetHex());
+    txObj.pushKV("input", "0x");
+    txObj.pushKV("nonce", "0x0");
+
+    // To address
+    std::string toAddr = "0x0000000000000000000000000000000000000000";
+    CAmount value = 0;
+    if (!tx.vout.empty()) {
+        CTxDestination dest;
+        if (ExtractDestination(tx.vout[0].scriptPubKey, dest)) {
+            std::string base58 = EncodeDestination(dest);
+            Base58ToEthAddress(base58, toAddr);
+        }
+        value = tx.vout[0].nValue;
+    }
+    txObj.pushKV("to", toAddr);
+    txObj.pushKV("transactionIndex", IntToHex(txIndex));
+    txObj.pushKV("value", SatoshiToWei(value));
+    txObj.pushKV("v", "0x1b");
+    txObj.pushKV("r", "0x0000000000000000000000000000000000000000000000000000000000000000");
+    txObj.pushKV("s", "0x0000000000000000000000000000000000000000000000000000000000000000");
+
+    return txObj;
+}
+
+static UniValue FormatEthBlockInternal(const CBlock& block, const CBlockIndex* pblockindex,
+                                       bool fullTransactions, ChainstateManager& chainman)
+{
+    UniValue result = FormatEthBlockHeader(block, pblockindex);
+
     // Transactions
     UniValue transactions(UniValue::VARR);
-    for (size_t i = 0; i < block.vtx.size(); i++) {
-        if (fullTransactions) {
-            // Full transaction object
-            UniValue txObj(UniValue::VOBJ);
-            const CTransactionRef& tx = block.vtx[i];
-
-            txObj.pushKV("blockHash", "0x" + block.GetHash().GetHex());
-            txObj.pushKV("blockNumber", IntToHex(pblockindex->nHeight));
-            txObj.pushKV("from", "0x0000000000000000000000000000000000000000");
-            txObj.pushKV("gas", IntToHex(21000));
-            txObj.pushKV("gasPrice", "0x9502f9000");
-            txObj.pushKV("hash", "0x" + tx->GetHash().GetHex());
-            txObj.pushKV("input", "0x");
-            txObj.pushKV("nonce", "0x0");
-
-            // To address
-            std::string toAddr = "0x0000000000000000000000000000000000000000";
-            CAmount value = 0;
-            if (!tx->vout.empty()) {
-                CTxDestination dest;
-                if (ExtractDestination(tx->vout[0].scriptPubKey, dest)) {
-                    std::string base58 = EncodeDestination(dest);
-                    Base58ToEthAddress(base58, toAddr);
-                }
-                value = tx->vout[0].nValue;
+    if (fullTransactions) {
+        const std::string blockHash = "0x" + block.GetHash().GetHex();
+        std::vector<UniValue> txObjs(block.vtx.size());
+        auto formatRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                txObjs[i] = FormatEthBlockTransaction(*block.vtx[i], blockHash, pblockindex->nHeight, i);
             }
-            txObj.pushKV("to", toAddr);
-            txObj.pushKV("transactionIndex", IntToHex(i));
-            txObj.pushKV("value", SatoshiToWei(value));
-            txObj.pushKV("v", "0x1b");
-            txObj.pushKV("r", "0x0000000000000000000000000000000000000000000000000000000000000000");
-            txObj.pushKV("s", "0x0000000000000000000000000000000000000000000000000000000000000000");
-
-            transactions.push_back(txObj);
+        };
+
+        // Address encoding dominates, so large blocks are split across threads
+        const size_t threads = std::min<size_t>({block.vtx.size() / ETH_PARALLEL_FORMAT_MIN_TXS,
+                                                 std::max(std::thread::hardware_concurrency(), 1U),
+                                                 ETH_MAX_FORMAT_THREADS});
+        if (threads > 1) {
+            const size_t chunk = (block.vtx.size() + threads - 1) / threads;
+            std::vector<std::future<void>> parts;
+            for (size_t begin = chunk; begin < block.vtx.size(); begin += chunk) {
+                parts.push_back(std::async(std::launch::async, formatRange, begin, std::min(begin + chunk, block.vtx.size())));
+            }
+            formatRange(0, chunk);
+            for (auto& part : parts) part.get();
         } else {
+            formatRange(0, block.vtx.size());
+        }
+
+        for (UniValue& txObj : txObjs) {
+            transactions.push_back(std::move(txObj));
+        }
+    } else {
+        for (const CTransactionRef& tx : block.vtx) {
             // Just transaction hash
-            transactions.push_back("0x" + block.vtx[i]->GetHash().GetHex());
+            transactions.push_back("0x" + tx->GetHash().GetHex());
         }
     }
-    result.pushKV("transactions", transactions);
+    result.pushKV("transactions", std::move(transactions));
 
     // Uncles (empty in this chain)
     result.pushKV("uncles", UniValue(UniValue::VARR));
@@ -2525,6 +3040,7 @@ void RegisterEthRPCCommands(CRPCTable& t)
         {"eth", &net_version},
         {"eth", &eth_blockNumber},
         {"eth", &eth_gasPrice},
+        {"eth", &eth_feeHistory},
         {"eth", &web3_clientVersion},
         {"eth", &net_listening},
         {"eth", &net_peerCount},
@@ -2561,6 +3077,10 @@ void RegisterEthRPCCommands(CRPCTable& t)
         {"eth", &eth_uninstallFilter},
         {"eth", &eth_newBlockFilter},
         {"eth", &eth_newPendingTransactionFilter},
+        // Phase 6: Debug tracing
+        {"eth", &debug_traceTransaction},
+        {"eth", &debug_traceBlockByNumber},
+        {"eth", &debug_traceBlockByHash},
     };
 
     for (const auto& c : commands) {
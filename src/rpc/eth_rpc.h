@@ -13,9 +13,16 @@
 #include <string>
 #include <cstdint>
 
+class CBlock;
+class CBlockIndex;
 class CRPCTable;
 class ChainstateManager;
 
+namespace node {
+struct EthFilterLog;
+struct EthLogFilter;
+} // namespace node
+
 // ============================================================================
 // Chain Configuration
 // ============================================================================
@@ -30,6 +37,11 @@ static constexpr uint64_t ETH_GAS_PRICE_WEI = 0x9502f9000;  // 40 gwei in wei
 static constexpr uint64_t ETH_NON_CONTRACT_GAS = 21000;  // Standard transfer gas
 static constexpr uint64_t ETH_MAX_GAS_LIMIT = 40000000;  // Maximum gas limit
 
+// Default for -rpcmaxlogs, logs eth_getLogs returns for a range of blocks
+static constexpr int64_t DEFAULT_ETH_MAX_LOGS = 10000;
+// Error of a query over the limits, as other providers report it
+static constexpr int ETH_RPC_LIMIT_EXCEEDED = -32005;
+
 // ============================================================================
 // Unit Conversion Utilities
 // ============================================================================
@@ -150,6 +162,11 @@ std::string PadHex(const std::string& hex, size_t bytes);
  */
 UniValue FormatEthBlock(const UniValue& qtumBlock, bool fullTransactions);
 
+/**
+ * Format the header fields of a block in ETH format, as sent for newHeads
+ */
+UniValue FormatEthBlockHeader(const CBlock& block, const CBlockIndex* pblockindex);
+
 /**
  * Format transaction response in ETH format
  */
@@ -165,6 +182,21 @@ UniValue FormatEthReceipt(const UniValue& qtumReceipt);
  */
 UniValue FormatEthLog(const UniValue& qtumLog);
 
+// ============================================================================
+// Log Filters
+// ============================================================================
+
+/**
+ * Parse the filter object of eth_newFilter, eth_subscribe("logs", ...) and the like
+ * @throws JSONRPCError on a malformed address, topic or block number
+ */
+node::EthLogFilter ParseEthLogFilter(const UniValue& filterObj, ChainstateManager& chainman);
+
+/**
+ * Format a log matched by a filter in ETH format
+ */
+UniValue EthFilterLogToJSON(const node::EthFilterLog& log);
+
 // ============================================================================
 // RPC Registration
 // ============================================================================
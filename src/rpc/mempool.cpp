@@ -438,6 +438,42 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+/** Mempool entries described per lock, so a slow client reading a streamed result doesn't hold up the mempool */
+static constexpr size_t MEMPOOL_JSON_BATCH{1000};
+
+/** The verbose getrawmempool result, written entry by entry. Entries that leave the mempool meanwhile are left out. */
+static UniValue VerboseMempoolToJSON(const CTxMemPool& pool, const JSONRPCRequest& request)
+{
+    std::vector<uint256> txids;
+    {
+        LOCK(pool.cs);
+        for (const CTxMemPoolEntry& e : pool.entryAll()) {
+            txids.push_back(e.GetTx().GetHash());
+        }
+    }
+
+    JSONRPCResultWriter result{request};
+    result.BeginObject();
+    for (size_t i = 0; i < txids.size() && result.Alive(); i += MEMPOOL_JSON_BATCH) {
+        std::vector<std::pair<std::string, UniValue>> batch;
+        {
+            LOCK(pool.cs);
+            for (size_t j = i; j < std::min(i + MEMPOOL_JSON_BATCH, txids.size()); ++j) {
+                const auto it{pool.GetIter(txids[j])};
+                if (!it) continue;
+                UniValue info(UniValue::VOBJ);
+                entryToJSON(pool, info, **it);
+                batch.emplace_back(txids[j].ToString(), std::move(info));
+            }
+        }
+        for (auto& [txid, info] : batch) {
+            result.KV(txid, std::move(info));
+        }
+    }
+    result.End();
+    return result.Finish();
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{"getrawmempool",
@@ -483,6 +519,9 @@ static RPCHelpMan getrawmempool()
         include_mempool_sequence = request.params[1].get_bool();
     }
 
+    if (fVerbose && !include_mempool_sequence) {
+        return VerboseMempoolToJSON(EnsureAnyMemPool(request.context), request);
+    }
     return MempoolToJSON(EnsureAnyMemPool(request.context), fVerbose, include_mempool_sequence);
 },
     };
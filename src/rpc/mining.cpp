@@ -937,7 +937,7 @@ static RPCHelpMan getblocktemplate()
         // Create new block - WATTx Hybrid Consensus: Always create PoW templates for miners
         // PoS blocks are created via staking, not getblocktemplate
         bool fProofOfStake = false;
-        block_template = miner.createNewBlock({}, fProofOfStake);
+        block_template = miner.createNewBlock({.incremental = true}, fProofOfStake);
         CHECK_NONFATAL(block_template);
 
 
@@ -1231,6 +1231,11 @@ static RPCHelpMan submitheader()
 
 // X25X Multi-Algorithm Mining RPC Commands
 
+static std::string MinerBackendName(node::X25XMiner::Backend backend)
+{
+    return backend == node::X25XMiner::Backend::GPU ? "gpu" : "cpu";
+}
+
 static RPCHelpMan getx25xalgorithms()
 {
     return RPCHelpMan{"getx25xalgorithms",
@@ -1245,6 +1250,7 @@ static RPCHelpMan getx25xalgorithms()
                     {RPCResult::Type::STR, "description", "Algorithm description"},
                     {RPCResult::Type::BOOL, "enabled", "Whether algorithm is enabled"},
                     {RPCResult::Type::BOOL, "available", "Whether algorithm is available on this system"},
+                    {RPCResult::Type::BOOL, "gpu", "Whether algorithm can be mined with the GPU backend on this system"},
                     {RPCResult::Type::BOOL, "supports_merged_mining", "Whether algorithm supports merged mining"},
                 }},
             }
@@ -1264,6 +1270,7 @@ static RPCHelpMan getx25xalgorithms()
         obj.pushKV("description", info.description);
         obj.pushKV("enabled", info.enabled);
         obj.pushKV("available", node::X25XMiner::IsAlgorithmAvailable(algo));
+        obj.pushKV("gpu", node::X25XMiner::IsGpuAvailable(algo));
         obj.pushKV("supports_merged_mining", info.supportsMergedMining);
         result.push_back(obj);
     }
@@ -1282,6 +1289,7 @@ static RPCHelpMan getminingalgorithm()
             RPCResult::Type::OBJ, "", "",
             {
                 {RPCResult::Type::STR, "algorithm", "Current mining algorithm name"},
+                {RPCResult::Type::STR, "backend", "Nonce search backend (cpu or gpu)"},
                 {RPCResult::Type::NUM, "hashrate", "Current hashrate (H/s)"},
                 {RPCResult::Type::BOOL, "mining", "Whether mining is active"},
             }
@@ -1297,6 +1305,7 @@ static RPCHelpMan getminingalgorithm()
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("algorithm", info.name);
+    result.pushKV("backend", MinerBackendName(miner.GetBackend()));
     result.pushKV("hashrate", miner.GetHashrate());
     result.pushKV("mining", miner.IsMining());
 
@@ -1308,20 +1317,26 @@ static RPCHelpMan getminingalgorithm()
 static RPCHelpMan setminingalgorithm()
 {
     return RPCHelpMan{"setminingalgorithm",
-        "\nSets the mining algorithm to use.\n",
+        "\nSets the mining algorithm to use, and whether to mine on the CPU or an OpenCL GPU.\n"
+        "The GPU backend supports sha256d, ethash and kheavyhash.\n",
         {
             {"algorithm", RPCArg::Type::STR, RPCArg::Optional::NO, "Algorithm name (sha256d, scrypt, ethash, randomx, equihash, x11, kheavyhash/kaspa)"},
+            {"backend", RPCArg::Type::STR, RPCArg::Default{"cpu"}, "Nonce search backend (cpu or gpu)"},
+            {"gpu_platform", RPCArg::Type::NUM, RPCArg::Default{0}, "OpenCL platform index for the gpu backend"},
+            {"gpu_device", RPCArg::Type::NUM, RPCArg::Default{0}, "OpenCL device index for the gpu backend"},
         },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
             {
                 {RPCResult::Type::BOOL, "success", "Whether algorithm was set successfully"},
                 {RPCResult::Type::STR, "algorithm", "New mining algorithm"},
+                {RPCResult::Type::STR, "backend", "Nonce search backend (cpu or gpu)"},
                 {RPCResult::Type::STR, "message", "Status message"},
             }
         },
         RPCExamples{
             HelpExampleCli("setminingalgorithm", "\"randomx\"")
+            + HelpExampleCli("setminingalgorithm", "\"kheavyhash\" \"gpu\"")
             + HelpExampleRpc("setminingalgorithm", "\"randomx\"")
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
@@ -1339,16 +1354,31 @@ static RPCHelpMan setminingalgorithm()
 
     auto& miner = node::GetX25XMiner();
 
+    node::X25XMiner::Backend backend{node::X25XMiner::Backend::CPU};
+    if (!request.params[1].isNull()) {
+        const std::string backendName = request.params[1].get_str();
+        if (backendName == "gpu") {
+            backend = node::X25XMiner::Backend::GPU;
+        } else if (backendName != "cpu") {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown backend: " + backendName);
+        }
+    }
+    const int gpuPlatform{request.params[2].isNull() ? 0 : request.params[2].getInt<int>()};
+    const int gpuDevice{request.params[3].isNull() ? 0 : request.params[3].getInt<int>()};
+
     if (miner.IsMining()) {
         throw JSONRPCError(RPC_IN_WARMUP, "Cannot change algorithm while mining is active. Stop mining first.");
     }
 
-    miner.SetAlgorithm(algo);
-
     const auto& info = x25x::GetAlgorithmInfo(algo);
+    if (!miner.Initialize(algo, backend, gpuPlatform, gpuDevice)) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Failed to initialize %s on the %s backend", info.name, MinerBackendName(backend)));
+    }
+
     UniValue result(UniValue::VOBJ);
     result.pushKV("success", true);
     result.pushKV("algorithm", info.name);
+    result.pushKV("backend", MinerBackendName(backend));
     result.pushKV("message", "Mining algorithm set to " + info.name);
 
     return result;
@@ -1365,6 +1395,7 @@ static RPCHelpMan getx25xmininginfo()
             RPCResult::Type::OBJ, "", "",
             {
                 {RPCResult::Type::STR, "current_algorithm", "Current mining algorithm"},
+                {RPCResult::Type::STR, "backend", "Nonce search backend (cpu or gpu)"},
                 {RPCResult::Type::BOOL, "x25x_active", "Whether X25X is active on the network"},
                 {RPCResult::Type::NUM, "x25x_activation_height", "X25X activation height"},
                 {RPCResult::Type::NUM, "hashrate", "Current hashrate (H/s)"},
@@ -1395,6 +1426,7 @@ static RPCHelpMan getx25xmininginfo()
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("current_algorithm", info.name);
+    result.pushKV("backend", MinerBackendName(miner.GetBackend()));
     result.pushKV("x25x_active", params.IsX25XActive(currentHeight));
     result.pushKV("x25x_activation_height", params.nX25XActivationHeight);
     result.pushKV("hashrate", miner.GetHashrate());
@@ -45,7 +45,8 @@ const std::vector<std::string> CONNECTION_TYPE_DOC{
         "inbound (initiated by the peer)",
         "manual (added via addnode RPC or -addnode/-connect configuration options)",
         "addr-fetch (short-lived automatic connection for soliciting addresses)",
-        "feeler (short-lived automatic connection for testing addresses)"
+        "feeler (short-lived automatic connection for testing addresses)",
+        "validator-relay (block-relay-only automatic connection to a staking validator)"
 };
 
 const std::vector<std::string> TRANSPORT_TYPE_DOC{
@@ -6,7 +6,10 @@
 #include <bitcoin-build-config.h> // IWYU pragma: keep
 
 #include <chainparams.h>
+#include <dbwrapper.h>
 #include <httpserver.h>
+#include <index/anchorindex.h>
+#include <index/explorerindex.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
 #include <index/txindex.h>
@@ -21,6 +24,7 @@
 #include <rpc/server_util.h>
 #include <rpc/util.h>
 #include <scheduler.h>
+#include <support/largepages.h>
 #include <univalue.h>
 #include <util/any.h>
 #include <util/check.h>
@@ -29,6 +33,7 @@
 #include <key_io.h>
 #include <common/args.h>
 #include <util/time.h>
+#include <streams.h>
 
 #include <stdint.h>
 #ifdef HAVE_MALLOC_INFO
@@ -122,6 +127,18 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCLargePagesInfo()
+{
+    LargePageAllocator::Stats stats = LargePageAllocator::Instance().stats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("explicit", uint64_t(stats.explicit_bytes));
+    obj.pushKV("transparent", uint64_t(stats.transparent_bytes));
+    obj.pushKV("regular", uint64_t(stats.regular_bytes));
+    obj.pushKV("numa_bound", uint64_t(stats.numa_bound_bytes));
+    obj.pushKV("chunks", uint64_t(stats.allocations));
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -166,6 +183,14 @@ static RPCHelpMan getmemoryinfo()
                                 {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                                 {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                             }},
+                            {RPCResult::Type::OBJ, "largepages", "Information about the caches backed by large pages (see -largepages)",
+                            {
+                                {RPCResult::Type::NUM, "explicit", "Number of bytes on explicit hugepages"},
+                                {RPCResult::Type::NUM, "transparent", "Number of bytes advised for transparent hugepages"},
+                                {RPCResult::Type::NUM, "regular", "Number of bytes that fell back to regular pages"},
+                                {RPCResult::Type::NUM, "numa_bound", "Number of bytes bound to the NUMA node they were allocated from"},
+                                {RPCResult::Type::NUM, "chunks", "Number of allocated chunks"},
+                            }},
                         }
                     },
                     RPCResult{"mode \"mallocinfo\"",
@@ -182,6 +207,7 @@ static RPCHelpMan getmemoryinfo()
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("largepages", RPCLargePagesInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -196,6 +222,74 @@ static RPCHelpMan getmemoryinfo()
     };
 }
 
+static RPCHelpMan getdbstats()
+{
+    return RPCHelpMan{"getdbstats",
+                "Returns usage and compaction statistics of every open LevelDB database.\n"
+                "Counters cover the time since each database was opened.\n",
+                {},
+                RPCResult{
+                    RPCResult::Type::ARR, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::STR, "name", "Database name"},
+                            {RPCResult::Type::STR, "path", "Database directory"},
+                            {RPCResult::Type::NUM, "reads", "Point reads"},
+                            {RPCResult::Type::NUM, "read_hit_rate", "Share of point reads that found an entry"},
+                            {RPCResult::Type::NUM, "bytes_read", "Bytes returned by point reads"},
+                            {RPCResult::Type::NUM, "batches_written", "Write batches"},
+                            {RPCResult::Type::NUM, "bytes_written", "Bytes written by the node"},
+                            {RPCResult::Type::NUM, "compaction_bytes_read", "Bytes read by LevelDB compactions"},
+                            {RPCResult::Type::NUM, "compaction_bytes_written", "Bytes written by LevelDB compactions"},
+                            {RPCResult::Type::NUM, "read_amplification", "Tables a point read may have to consult"},
+                            {RPCResult::Type::NUM, "write_amplification", "Bytes written to disk per byte written by the node"},
+                            {RPCResult::Type::ARR, "level_files", "Table files per level", {{RPCResult::Type::NUM, "", ""}}},
+                            {RPCResult::Type::NUM, "table_bytes", "Total size of the tables"},
+                            {RPCResult::Type::NUM, "block_cache_usage", "Bytes held by the block cache"},
+                            {RPCResult::Type::NUM, "block_cache_capacity", "Block cache size"},
+                            {RPCResult::Type::BOOL, "shared_cache", "Whether the block cache is shared with other databases"},
+                            {RPCResult::Type::NUM, "memory_usage", "Approximate memory used by LevelDB"},
+                            {RPCResult::Type::NUM, "idle", "Seconds since the last write"},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getdbstats", "")
+            + HelpExampleRpc("getdbstats", "")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    UniValue result(UniValue::VARR);
+    for (const DBStats& stats : GetAllDBStats()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("name", stats.name);
+        obj.pushKV("path", fs::PathToString(stats.path));
+        obj.pushKV("reads", stats.reads);
+        obj.pushKV("read_hit_rate", stats.reads ? double(stats.read_hits) / stats.reads : 0.0);
+        obj.pushKV("bytes_read", stats.bytes_read);
+        obj.pushKV("batches_written", stats.batches_written);
+        obj.pushKV("bytes_written", stats.bytes_written);
+        obj.pushKV("compaction_bytes_read", stats.compaction_bytes_read);
+        obj.pushKV("compaction_bytes_written", stats.compaction_bytes_written);
+        obj.pushKV("read_amplification", stats.ReadAmplification());
+        obj.pushKV("write_amplification", stats.WriteAmplification());
+        UniValue levels(UniValue::VARR);
+        for (int files : stats.level_files) levels.push_back(files);
+        obj.pushKV("level_files", std::move(levels));
+        obj.pushKV("table_bytes", stats.table_bytes);
+        obj.pushKV("block_cache_usage", uint64_t(stats.block_cache_usage));
+        obj.pushKV("block_cache_capacity", uint64_t(stats.block_cache_capacity));
+        obj.pushKV("shared_cache", stats.shared_cache);
+        obj.pushKV("memory_usage", uint64_t(stats.memory_usage));
+        obj.pushKV("idle", int64_t(stats.idle.count()));
+        result.push_back(std::move(obj));
+    }
+    return result;
+},
+    };
+}
+
 static void EnableOrDisableLogCategories(UniValue cats, bool enable) {
     cats = cats.get_array();
     for (unsigned int i = 0; i < cats.size(); ++i) {
@@ -395,6 +489,14 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_anchorindex) {
+        result.pushKVs(SummaryToJSON(g_anchorindex->GetSummary(), index_name));
+    }
+
+    if (g_explorerindex) {
+        result.pushKVs(SummaryToJSON(g_explorerindex->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
@@ -503,7 +605,7 @@ static RPCHelpMan getblockhashes()
     std::vector<std::pair<uint256, unsigned int> > blockHashes;
     bool found = false;
 
-    found = GetTimestampIndex(high, low, fActiveOnly, blockHashes, chainman);
+    found = GetTimestampIndex(high, low, fActiveOnly, blockHashes);
 
     if (!found) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for block hashes");
@@ -594,6 +696,53 @@ bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &addr
     return true;
 }
 
+//! Largest page of a paged address query, which bounds the memory of one reply
+static constexpr int64_t MAX_ADDRESS_PAGE_SIZE{100000};
+
+//! Page size of a paged address query, 0 when the caller asked for everything
+static size_t getAddressPageLimit(const UniValue& param, size_t n_addresses)
+{
+    if (!param.isObject()) return 0;
+    const UniValue& limit = param.get_obj().find_value("limit");
+    if (limit.isNull()) return 0;
+    const int64_t n = limit.getInt<int64_t>();
+    if (n <= 0 || n > MAX_ADDRESS_PAGE_SIZE) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Limit is expected to be between 1 and %d", MAX_ADDRESS_PAGE_SIZE));
+    }
+    if (n_addresses != 1) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit is only supported for a single address");
+    }
+    return n;
+}
+
+template <typename Key>
+static std::string encodeAddressPageCursor(const Key& key)
+{
+    DataStream ss{};
+    ss << key;
+    return HexStr(ss);
+}
+
+//! Continuation key of a paged address query, which must belong to the queried address
+template <typename Key>
+static std::optional<Key> getAddressPageCursor(const UniValue& param, const std::pair<uint256, int>& address)
+{
+    const UniValue& after = param.get_obj().find_value("after");
+    if (after.isNull()) return std::nullopt;
+    Key key;
+    try {
+        DataStream ss{ParseHexV(after, "after")};
+        ss >> key;
+        if (!ss.empty()) throw std::ios_base::failure("trailing data");
+    } catch (const std::ios_base::failure&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid continuation key");
+    }
+    if (key.hashBytes != address.first || key.type != address.second) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Continuation key belongs to another address");
+    }
+    return key;
+}
+
 static RPCHelpMan getaddressdeltas()
 {
     return RPCHelpMan{"getaddressdeltas",
@@ -609,6 +758,9 @@ static RPCHelpMan getaddressdeltas()
                         {"start", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "The start block height"},
                         {"end", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "The end block height"},
                         {"chainInfo", RPCArg::Type::BOOL, RPCArg::Optional::OMITTED, "Include chain info in results, only applies if start and end specified"},
+                        {"limit", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "Return at most this many deltas of a single address, and a continuation key if more remain"},
+                        {"after", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Continuation key returned by the previous page, only applies if limit is set"},
+                        {"reverse", RPCArg::Type::BOOL, RPCArg::Optional::OMITTED, "Return the newest deltas first, only applies if limit is set"},
                     }
                 }
             },
@@ -627,7 +779,7 @@ static RPCHelpMan getaddressdeltas()
                         }}
                     },
                 },
-                RPCResult{"if chainInfo is set to true",
+                RPCResult{"if chainInfo or limit is set",
                     RPCResult::Type::OBJ, "", "",
                     {
                         {RPCResult::Type::ARR, "deltas", "List of delta",
@@ -642,12 +794,13 @@ static RPCHelpMan getaddressdeltas()
                                 {RPCResult::Type::STR, "address", "The qtum address"},
                             }}
                         }},
-                        {RPCResult::Type::OBJ, "start", "Start block",
+                        {RPCResult::Type::STR_HEX, "next", /*optional=*/true, "Continuation key for the next page, if more deltas remain"},
+                        {RPCResult::Type::OBJ, "start", /*optional=*/true, "Start block",
                         {
                             {RPCResult::Type::STR_HEX, "hash", "The block hash"},
                             {RPCResult::Type::NUM, "height", "The block height"},
                         }},
-                        {RPCResult::Type::OBJ, "end", "End block",
+                        {RPCResult::Type::OBJ, "end", /*optional=*/true, "End block",
                         {
                             {RPCResult::Type::STR_HEX, "hash", "The block hash"},
                             {RPCResult::Type::NUM, "height", "The block height"},
@@ -659,7 +812,8 @@ static RPCHelpMan getaddressdeltas()
                 HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"QD1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XX\"]}'")
         + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"QD1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XX\"]}") +
                 HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"QD1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XX\"], \"start\": 5000, \"end\": 5500, \"chainInfo\": true}'")
-        + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"QD1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XX\"], \"start\": 5000, \"end\": 5500, \"chainInfo\": true}")
+        + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"QD1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XX\"], \"start\": 5000, \"end\": 5500, \"chainInfo\": true}") +
+                HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"QD1ZrZNe3JUo7ZycKEYQQiQAWd9y54F4XX\"], \"limit\": 100, \"reverse\": true}'")
             },
     [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
@@ -695,15 +849,27 @@ static RPCHelpMan getaddressdeltas()
     }
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, chainman.m_blockman, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, chainman.m_blockman)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    bool more = false;
+
+    const size_t limit = getAddressPageLimit(request.params[0], addresses.size());
+    if (limit > 0) {
+        const std::optional<CAddressIndexKey> after = getAddressPageCursor<CAddressIndexKey>(request.params[0], addresses.front());
+        const UniValue& reverseValue = request.params[0].get_obj().find_value("reverse");
+        const bool reverse = reverseValue.isBool() && reverseValue.get_bool();
+        if (!GetAddressIndexPage(addresses.front().first, addresses.front().second, start, end, after ? &*after : nullptr,
+                                 limit, reverse, addressIndex, more)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+    } else {
+        for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (start > 0 && end > 0) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
+            } else {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
             }
         }
     }
@@ -750,9 +916,14 @@ static RPCHelpMan getaddressdeltas()
         endInfo.pushKV("height", end);
 
         result.pushKV("deltas", deltas);
+        if (more) result.pushKV("next", encodeAddressPageCursor(addressIndex.back().first));
         result.pushKV("start", startInfo);
         result.pushKV("end", endInfo);
 
+        return result;
+    } else if (limit > 0) {
+        result.pushKV("deltas", deltas);
+        if (more) result.pushKV("next", encodeAddressPageCursor(addressIndex.back().first));
         return result;
     } else {
         return deltas;
@@ -798,28 +969,35 @@ static RPCHelpMan getaddressbalance()
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex((*it).first, (*it).second, addressIndex, chainman.m_blockman)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
+    int nHeight;
+    int maturity;
+    {
+        LOCK(cs_main);
+        nHeight = chainman.ActiveChain().Height();
+        maturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
     }
 
     CAmount balance = 0;
     CAmount received = 0;
     CAmount immature = 0;
 
-    LOCK(cs_main);
-    CChain& active_chain = chainman.ActiveChain();
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
+    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+        CAddressBalanceValue value;
+        if (!GetAddressBalance((*it).first, (*it).second, nHeight, value)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        balance += value.balance;
+        received += value.received;
+
+        // Only the stakes of the last maturity window can be immature
+        std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+        if (!GetAddressIndex((*it).first, (*it).second, addressIndex, std::max(1, nHeight - maturity + 1), std::max(1, nHeight))) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator i=addressIndex.begin(); i!=addressIndex.end(); i++) {
+            if (i->first.txindex == 1 && ((nHeight - i->first.blockHeight) < maturity))
+                immature += i->second; //immature stake outputs
         }
-        balance += it->second;
-        int nHeight = active_chain.Height();
-        if (it->first.txindex == 1 && ((nHeight - it->first.blockHeight) < Params().GetConsensus().CoinbaseMaturity(nHeight)))
-            immature += it->second; //immature stake outputs
     }
 
     UniValue result(UniValue::VOBJ);
@@ -845,6 +1023,8 @@ static RPCHelpMan getaddressutxos()
                                 }
                             },
                             {"chainInfo", RPCArg::Type::BOOL, RPCArg::Optional::OMITTED, "Include chain info with results"},
+                            {"limit", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "Return at most this many outputs of a single address in index order rather than by height, and a continuation key if more remain"},
+                            {"after", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Continuation key returned by the previous page, only applies if limit is set"},
                         }
                     }
                 },
@@ -864,7 +1044,7 @@ static RPCHelpMan getaddressutxos()
                             }}
                         },
                     },
-                    RPCResult{"if chainInfo is set to true",
+                    RPCResult{"if chainInfo or limit is set",
                         RPCResult::Type::OBJ, "", "",
                         {
                             {RPCResult::Type::ARR, "utxos", "List of utxo",
@@ -880,8 +1060,9 @@ static RPCHelpMan getaddressutxos()
                                     {RPCResult::Type::BOOL, "isStake", "Is coinstake output"},
                                 }}
                             }},
-                            {RPCResult::Type::STR_HEX, "hash", "The tip block hash"},
-                            {RPCResult::Type::NUM, "height", "The tip block height"},
+                            {RPCResult::Type::STR_HEX, "next", /*optional=*/true, "Continuation key for the next page, if more outputs remain"},
+                            {RPCResult::Type::STR_HEX, "hash", /*optional=*/true, "The tip block hash"},
+                            {RPCResult::Type::NUM, "height", /*optional=*/true, "The tip block height"},
                         },
                     },
                 },
@@ -910,14 +1091,25 @@ static RPCHelpMan getaddressutxos()
     }
 
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
-
-    for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs, chainman.m_blockman)) {
+    bool more = false;
+
+    const size_t limit = getAddressPageLimit(request.params[0], addresses.size());
+    if (limit > 0) {
+        // Pages follow the index order so that they can resume; sorting is left to the caller
+        const std::optional<CAddressUnspentKey> after = getAddressPageCursor<CAddressUnspentKey>(request.params[0], addresses.front());
+        if (!GetAddressUnspentPage(addresses.front().first, addresses.front().second, after ? &*after : nullptr,
+                                   limit, unspentOutputs, more)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
-    }
+    } else {
+        for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
+        }
 
-    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+        std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+    }
 
     UniValue utxos(UniValue::VARR);
 
@@ -938,9 +1130,15 @@ static RPCHelpMan getaddressutxos()
         utxos.push_back(output);
     }
 
-    if (includeChainInfo) {
+    if (limit > 0 && !includeChainInfo) {
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("utxos", utxos);
+        if (more) result.pushKV("next", encodeAddressPageCursor(unspentOutputs.back().first));
+        return result;
+    } else if (includeChainInfo) {
         UniValue result(UniValue::VOBJ);
         result.pushKV("utxos", utxos);
+        if (more) result.pushKV("next", encodeAddressPageCursor(unspentOutputs.back().first));
 
         ChainstateManager& chainman = EnsureAnyChainman(request.context);
         LOCK(cs_main);
@@ -1078,7 +1276,7 @@ static RPCHelpMan getspentinfo()
     CSpentIndexKey key(txid, outputIndex);
     CSpentIndexValue value;
 
-    if (!GetSpentIndex(key, value, mempool, chainman.m_blockman)) {
+    if (!GetSpentIndex(key, value, mempool)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unable to get spent info");
     }
 
@@ -1146,11 +1344,11 @@ static RPCHelpMan getaddresstxids()
 
     for (std::vector<std::pair<uint256, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, chainman.m_blockman, start, end)) {
+            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         } else {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, chainman.m_blockman)) {
+            if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
                 throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
             }
         }
@@ -1256,6 +1454,7 @@ void RegisterNodeRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"control", &getmemoryinfo},
+        {"control", &getdbstats},
         {"control", &logging},
         {"control", &getdgpinfo},
         {"util", &getindexinfo},
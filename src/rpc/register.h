@@ -24,6 +24,7 @@ void RegisterSignerRPCCommands(CRPCTable &tableRPC);
 void RegisterTxoutProofRPCCommands(CRPCTable&);
 void RegisterValidatorRPCCommands(CRPCTable&);
 void RegisterStratumRPCCommands(CRPCTable&);
+void RegisterBridgeRPCCommands(CRPCTable&);
 void RegisterRandomXMiningRPCCommands(CRPCTable&);
 void RegisterEthRPCCommands(CRPCTable&);
 
@@ -44,6 +45,7 @@ static inline void RegisterAllCoreRPCCommands(CRPCTable &t)
     RegisterTxoutProofRPCCommands(t);
     RegisterValidatorRPCCommands(t);
     RegisterStratumRPCCommands(t);
+    RegisterBridgeRPCCommands(t);
     RegisterRandomXMiningRPCCommands(t);
     RegisterEthRPCCommands(t);
 }
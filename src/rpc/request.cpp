@@ -13,6 +13,7 @@
 #include <util/fs_helpers.h>
 #include <util/strencodings.h>
 
+#include <cassert>
 #include <fstream>
 #include <stdexcept>
 #include <string>
@@ -259,3 +260,106 @@ void JSONRPCRequest::PollPing() {}
 void JSONRPCRequest::PollCancel() {}
 
 void JSONRPCRequest::PollReply(const UniValue& result) {}
+
+bool JSONRPCRequest::StreamStart() const { return false; }
+
+bool JSONRPCRequest::StreamWrite(const std::string& json) const { return false; }
+
+void JSONRPCRequest::StreamEnd() const {}
+
+JSONRPCResultWriter::JSONRPCResultWriter(const JSONRPCRequest& request)
+    : m_request{request}, m_streaming{request.StreamStart()}
+{
+}
+
+void JSONRPCResultWriter::Emit(std::string_view json)
+{
+    if (!m_alive) return;
+    m_buffer += json;
+    if (m_buffer.size() >= CHUNK_SIZE) {
+        m_alive = m_request.StreamWrite(m_buffer);
+        m_buffer.clear();
+    }
+}
+
+void JSONRPCResultWriter::Separate()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (!m_open.empty()) {
+        if (m_open.back().has_element) Emit(",");
+        m_open.back().has_element = true;
+    }
+}
+
+void JSONRPCResultWriter::Open(UniValue::VType type)
+{
+    if (m_streaming) {
+        Separate();
+        Emit(type == UniValue::VARR ? "[" : "{");
+        m_open.push_back({type == UniValue::VARR ? ']' : '}', false});
+    } else {
+        m_stack.emplace_back(std::move(m_key), UniValue{type});
+        m_key.clear();
+    }
+}
+
+void JSONRPCResultWriter::BeginArray() { Open(UniValue::VARR); }
+
+void JSONRPCResultWriter::BeginObject() { Open(UniValue::VOBJ); }
+
+void JSONRPCResultWriter::End()
+{
+    if (m_streaming) {
+        assert(!m_open.empty());
+        const char close{m_open.back().close};
+        m_open.pop_back();
+        Emit(std::string_view{&close, 1});
+    } else {
+        assert(!m_stack.empty());
+        auto [key, value] = std::move(m_stack.back());
+        m_stack.pop_back();
+        m_key = std::move(key);
+        Value(std::move(value));
+    }
+}
+
+void JSONRPCResultWriter::Key(const std::string& key)
+{
+    if (m_streaming) {
+        Separate();
+        Emit(UniValue{key}.write());
+        Emit(":");
+        m_after_key = true;
+    } else {
+        m_key = key;
+    }
+}
+
+void JSONRPCResultWriter::Value(UniValue value)
+{
+    if (m_streaming) {
+        Separate();
+        // Skip the serialization too once nobody reads it
+        if (m_alive) Emit(value.write());
+    } else if (m_stack.empty()) {
+        m_result = std::move(value);
+    } else if (m_stack.back().second.isObject()) {
+        m_stack.back().second.pushKVEnd(std::move(m_key), std::move(value));
+        m_key.clear();
+    } else {
+        m_stack.back().second.push_back(std::move(value));
+    }
+}
+
+UniValue JSONRPCResultWriter::Finish()
+{
+    if (!m_streaming) return std::move(m_result);
+    if (m_alive && !m_buffer.empty()) {
+        m_alive = m_request.StreamWrite(m_buffer);
+        m_buffer.clear();
+    }
+    return NullUniValue;
+}
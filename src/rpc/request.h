@@ -9,6 +9,8 @@
 #include <any>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <univalue.h>
 #include <util/fs.h>
@@ -45,6 +47,7 @@ public:
     std::any context;
     JSONRPCVersion m_json_version = JSONRPCVersion::V1_LEGACY;
     bool isLongPolling = false;
+    mutable bool isStreaming = false;
     void *httpreq = nullptr;
 
     void parse(const UniValue& valRequest);
@@ -74,6 +77,82 @@ public:
      * Return the JSON result of a long poll request
      */
     virtual void PollReply(const UniValue& result);
+
+    /**
+     * Start streaming the result: send the reply status and the start of the
+     * reply object. Returns false if the transport can't stream this request,
+     * then the handler returns its result as usual.
+     * Use JSONRPCResultWriter rather than calling this directly.
+     */
+    virtual bool StreamStart() const;
+
+    /**
+     * Send the next piece of the JSON text of a streamed result. Waits while
+     * the client lags behind. Returns false once the client has gone away.
+     */
+    virtual bool StreamWrite(const std::string& json) const;
+
+    /**
+     * Finish a streamed reply. Called by the transport after the handler returns.
+     */
+    virtual void StreamEnd() const;
+};
+
+/**
+ * Builds an RPC result piece by piece. If the transport supports it, the
+ * result is streamed to the client while it is built, so a large result never
+ * exists as a whole UniValue tree or reply string. Otherwise it is collected
+ * into a UniValue as usual, so handlers have a single code path.
+ *
+ * Create it once the handler can no longer fail: after streaming starts the
+ * reply status has been sent, and an exception only cuts the reply short.
+ */
+class JSONRPCResultWriter
+{
+public:
+    explicit JSONRPCResultWriter(const JSONRPCRequest& request);
+
+    void BeginArray();
+    void BeginObject();
+    /** Close the innermost array or object. */
+    void End();
+    /** Set the key of the next value, which must be in an object. */
+    void Key(const std::string& key);
+    void Value(UniValue value);
+    void KV(const std::string& key, UniValue value) { Key(key); Value(std::move(value)); }
+
+    /** Whether the client still reads the result. Long producers should stop once it doesn't. */
+    bool Alive() const { return m_alive; }
+
+    /** The value for the handler to return: the collected result, or null once it has been streamed. */
+    UniValue Finish();
+
+private:
+    //! Streamed output is sent in pieces of about this size
+    static constexpr size_t CHUNK_SIZE{1 << 16};
+
+    void Open(UniValue::VType type);
+    void Emit(std::string_view json);
+    void Separate();
+
+    const JSONRPCRequest& m_request;
+    const bool m_streaming;
+    bool m_alive{true};
+
+    struct OpenContainer {
+        char close;
+        bool has_element;
+    };
+
+    // Streaming: unsent output, and the open containers
+    std::string m_buffer;
+    std::vector<OpenContainer> m_open;
+    bool m_after_key{false};
+
+    // Collecting: the open containers with the keys they go under, and the finished result
+    std::vector<std::pair<std::string, UniValue>> m_stack;
+    std::string m_key;
+    UniValue m_result;
 };
 
 #endif // BITCOIN_RPC_REQUEST_H
@@ -39,6 +39,8 @@ static RPCTimerInterface* timerInterface = nullptr;
 static GlobalMutex g_deadline_timers_mutex;
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers GUARDED_BY(g_deadline_timers_mutex);
 static bool ExecuteCommand(const CRPCCommand& command, const JSONRPCRequest& request, UniValue& result, bool last_handler);
+/* Bytes of a streamed reply that may wait to be written out to a slow client */
+static constexpr size_t MAX_STREAM_PENDING_BYTES{4 << 20};
 
 struct RPCCommandExecutionInfo
 {
@@ -372,7 +374,33 @@ void JSONRPCRequestLong::PollReply(const UniValue& result) {
     req()->ChunkEnd();
 }
 
-HTTPRequest* JSONRPCRequestLong::req() {
+bool JSONRPCRequestLong::StreamStart() const {
+    if (!allowStreaming || isLongPolling || isStreaming || IsNotification()) return false;
+    req()->WriteHeader("Content-Type", "application/json");
+    // ChunkEnd waits for the client to close the connection
+    req()->WriteHeader("Connection", "close");
+    // The reply object up to the result, as JSONRPCReplyObj writes it
+    req()->Chunk(m_json_version == JSONRPCVersion::V2 ? "{\"jsonrpc\":\"2.0\",\"result\":" : "{\"result\":");
+    isStreaming = true;
+    return true;
+}
+
+bool JSONRPCRequestLong::StreamWrite(const std::string& json) const {
+    assert(isStreaming);
+    req()->Chunk(json);
+    return req()->ChunkWait(MAX_STREAM_PENDING_BYTES);
+}
+
+void JSONRPCRequestLong::StreamEnd() const {
+    assert(isStreaming);
+    std::string tail;
+    if (m_json_version == JSONRPCVersion::V1_LEGACY) tail += ",\"error\":null";
+    if (id.has_value()) tail += ",\"id\":" + id->write();
+    req()->Chunk(tail + "}\n");
+    req()->ChunkEnd();
+}
+
+HTTPRequest* JSONRPCRequestLong::req() const {
     return (HTTPRequest*)httpreq;
 }
 
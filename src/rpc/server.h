@@ -52,10 +52,17 @@ public:
      */
     void PollReply(const UniValue& result) override;
 
+    bool StreamStart() const override;
+    bool StreamWrite(const std::string& json) const override;
+    void StreamEnd() const override;
+
     /**
      * Return the http request
      */
-     HTTPRequest* req();
+     HTTPRequest* req() const;
+
+    //! Whether the result may be streamed; off for batches, whose replies share one body
+    bool allowStreaming = false;
 };
 
 /** Throw JSONRPCError if RPC is not running */
@@ -22,18 +22,25 @@ static RPCHelpMan startstratum()
         {
             {"port", RPCArg::Type::NUM, RPCArg::Default{3335}, "Port to listen on"},
             {"address", RPCArg::Type::STR, RPCArg::Default{"0.0.0.0"}, "Address to bind to"},
+            {"sv2_port", RPCArg::Type::NUM, RPCArg::Default{0}, "Port for Stratum V2 miners (Noise encrypted, binary framing); 0 disables it"},
+            {"io_threads", RPCArg::Type::NUM, RPCArg::Default{stratum::DEFAULT_STRATUM_IO_THREADS}, "Number of threads serving the miner connections"},
+            {"max_clients", RPCArg::Type::NUM, RPCArg::Default{100}, "Maximum number of connected miners"},
         },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
             {
                 {RPCResult::Type::BOOL, "success", "Whether server started successfully"},
                 {RPCResult::Type::NUM, "port", "Port the server is listening on"},
+                {RPCResult::Type::NUM, "sv2_port", "Stratum V2 port, 0 if disabled"},
+                {RPCResult::Type::STR_HEX, "sv2_authority_key", /*optional=*/true, "x-only key miners pin to authenticate the Stratum V2 port"},
             }
         },
         RPCExamples{
             HelpExampleCli("startstratum", "")
             + HelpExampleCli("startstratum", "3335")
             + HelpExampleCli("startstratum", "3335 \"127.0.0.1\"")
+            + HelpExampleCli("startstratum", "3335 \"0.0.0.0\" 3336")
+            + HelpExampleCli("startstratum", "3335 \"0.0.0.0\" 0 8 5000")
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
         {
@@ -42,6 +49,19 @@ static RPCHelpMan startstratum()
             stratum::StratumConfig config;
             config.port = request.params[0].isNull() ? 3335 : request.params[0].getInt<int>();
             config.bind_address = request.params[1].isNull() ? "0.0.0.0" : request.params[1].get_str();
+            config.sv2_port = request.params[2].isNull() ? 0 : request.params[2].getInt<int>();
+            if (!request.params[3].isNull()) {
+                config.io_threads = request.params[3].getInt<int>();
+                if (config.io_threads < 1) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "io_threads must be at least 1");
+                }
+            }
+            if (!request.params[4].isNull()) {
+                config.max_clients = request.params[4].getInt<int>();
+                if (config.max_clients < 1) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "max_clients must be at least 1");
+                }
+            }
 
             stratum::StratumServer& server = stratum::GetStratumServer();
 
@@ -54,6 +74,8 @@ static RPCHelpMan startstratum()
             UniValue result(UniValue::VOBJ);
             result.pushKV("success", success);
             result.pushKV("port", (int)server.GetPort());
+            result.pushKV("sv2_port", (int)server.GetSv2Port());
+            if (server.GetSv2Port() != 0) result.pushKV("sv2_authority_key", server.GetSv2AuthorityKey());
             return result;
         },
     };
@@ -89,6 +111,8 @@ static RPCHelpMan getstratuminfo()
             {
                 {RPCResult::Type::BOOL, "running", "Whether the server is running"},
                 {RPCResult::Type::NUM, "port", "Port the server is listening on"},
+                {RPCResult::Type::NUM, "sv2_port", "Stratum V2 port, 0 if disabled"},
+                {RPCResult::Type::STR_HEX, "sv2_authority_key", /*optional=*/true, "x-only key miners pin to authenticate the Stratum V2 port"},
                 {RPCResult::Type::NUM, "clients", "Number of connected miners"},
                 {RPCResult::Type::NUM, "shares_accepted", "Total accepted shares"},
                 {RPCResult::Type::NUM, "shares_rejected", "Total rejected shares"},
@@ -105,6 +129,8 @@ static RPCHelpMan getstratuminfo()
             UniValue result(UniValue::VOBJ);
             result.pushKV("running", server.IsRunning());
             result.pushKV("port", (int)server.GetPort());
+            result.pushKV("sv2_port", (int)server.GetSv2Port());
+            if (server.GetSv2Port() != 0) result.pushKV("sv2_authority_key", server.GetSv2AuthorityKey());
             result.pushKV("clients", (int)server.GetClientCount());
             result.pushKV("shares_accepted", (uint64_t)server.GetTotalSharesAccepted());
             result.pushKV("shares_rejected", (uint64_t)server.GetTotalSharesRejected());
@@ -114,6 +140,101 @@ static RPCHelpMan getstratuminfo()
     };
 }
 
+static RPCHelpMan getstratumstats()
+{
+    return RPCHelpMan{"getstratumstats",
+        "\nGet per-stage latencies, reject reasons and per-connection traffic of the stratum server.\n"
+        "The same figures are served in Prometheus format at /rest/stratum/metrics when -rest is enabled.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::OBJ_DYN, "latency", "Latency histograms by stage (share_queue, share_validation, job_template, job_build, job_broadcast, work_restart, block_submit)",
+                {
+                    {RPCResult::Type::OBJ, "stage", "",
+                    {
+                        {RPCResult::Type::NUM, "count", "Number of timings"},
+                        {RPCResult::Type::NUM, "mean_us", "Mean, in microseconds"},
+                        {RPCResult::Type::NUM, "p50_us", "Median, in microseconds"},
+                        {RPCResult::Type::NUM, "p90_us", "90th percentile, in microseconds"},
+                        {RPCResult::Type::NUM, "p99_us", "99th percentile, in microseconds"},
+                        {RPCResult::Type::NUM, "max_us", "Maximum, in microseconds"},
+                    }},
+                }},
+                {RPCResult::Type::OBJ_DYN, "rejects", "Rejected shares by reason",
+                {
+                    {RPCResult::Type::NUM, "reason", "Number of shares"},
+                }},
+                {RPCResult::Type::NUM, "validation_queue", "Shares waiting for a validation thread"},
+                {RPCResult::Type::ARR, "connections", "",
+                {
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "id", "Connection id"},
+                        {RPCResult::Type::STR, "peer", "Peer address"},
+                        {RPCResult::Type::STR, "worker", "Worker name"},
+                        {RPCResult::Type::NUM, "difficulty", "Current share difficulty"},
+                        {RPCResult::Type::NUM, "shares_accepted", "Accepted shares"},
+                        {RPCResult::Type::NUM, "shares_rejected", "Rejected shares"},
+                        {RPCResult::Type::NUM, "bytes_in", "Bytes received"},
+                        {RPCResult::Type::NUM, "bytes_out", "Bytes sent"},
+                        {RPCResult::Type::NUM, "send_queue", "Bytes queued that the socket has not taken yet"},
+                    }},
+                }},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("getstratumstats", "")
+            + HelpExampleRpc("getstratumstats", "")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            const stratum::StratumServer& server = stratum::GetStratumServer();
+            const stratum::StratumMetrics& metrics = server.GetMetrics();
+
+            UniValue latency(UniValue::VOBJ);
+            for (const auto& [name, help, histogram] : metrics.Histograms()) {
+                const auto snapshot = histogram.Read();
+                UniValue stage(UniValue::VOBJ);
+                stage.pushKV("count", snapshot.count);
+                stage.pushKV("mean_us", snapshot.count ? snapshot.sum_us / snapshot.count : 0);
+                stage.pushKV("p50_us", snapshot.Percentile(0.50));
+                stage.pushKV("p90_us", snapshot.Percentile(0.90));
+                stage.pushKV("p99_us", snapshot.Percentile(0.99));
+                stage.pushKV("max_us", snapshot.max_us);
+                latency.pushKV(name, std::move(stage));
+            }
+
+            UniValue rejects(UniValue::VOBJ);
+            for (size_t i = 0; i < stratum::SHARE_REJECT_COUNT; ++i) {
+                rejects.pushKV(stratum::ShareRejectString(static_cast<stratum::ShareReject>(i)), metrics.rejects[i].load());
+            }
+
+            UniValue connections(UniValue::VARR);
+            for (const auto& conn : server.GetConnectionMetrics()) {
+                UniValue entry(UniValue::VOBJ);
+                entry.pushKV("id", conn.id);
+                entry.pushKV("peer", conn.peer);
+                entry.pushKV("worker", conn.worker);
+                entry.pushKV("difficulty", conn.difficulty);
+                entry.pushKV("shares_accepted", conn.shares_accepted);
+                entry.pushKV("shares_rejected", conn.shares_rejected);
+                entry.pushKV("bytes_in", conn.bytes_in);
+                entry.pushKV("bytes_out", conn.bytes_out);
+                entry.pushKV("send_queue", (uint64_t)conn.send_queue_bytes);
+                connections.push_back(std::move(entry));
+            }
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("latency", std::move(latency));
+            result.pushKV("rejects", std::move(rejects));
+            result.pushKV("validation_queue", (uint64_t)server.GetValidationQueueDepth());
+            result.pushKV("connections", std::move(connections));
+            return result;
+        },
+    };
+}
+
 static RPCHelpMan startmergedstratum()
 {
     return RPCHelpMan{"startmergedstratum",
@@ -124,6 +245,7 @@ static RPCHelpMan startmergedstratum()
             {"monero_port", RPCArg::Type::NUM, RPCArg::Default{18081}, "Monero daemon port"},
             {"monero_wallet", RPCArg::Type::STR, RPCArg::Optional::NO, "Monero wallet address for block rewards"},
             {"wattx_wallet", RPCArg::Type::STR, RPCArg::Optional::NO, "WATTx wallet address for block rewards"},
+            {"monero_zmq", RPCArg::Type::STR, RPCArg::Default{""}, "monerod --zmq-pub endpoint (e.g. tcp://127.0.0.1:18083) for instant new-block notifications; polling only if empty"},
         },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
@@ -146,6 +268,7 @@ static RPCHelpMan startmergedstratum()
             config.monero_daemon_port = request.params[2].isNull() ? 18081 : request.params[2].getInt<int>();
             config.monero_wallet_address = request.params[3].get_str();
             config.wattx_wallet_address = request.params[4].get_str();
+            if (!request.params[5].isNull()) config.monero_zmq_endpoint = request.params[5].get_str();
 
             merged_stratum::MergedStratumServer& server = merged_stratum::GetMergedStratumServer();
 
@@ -194,6 +317,7 @@ static RPCHelpMan startbitcoinmergedstratum()
             {"bitcoin_user", RPCArg::Type::STR, RPCArg::Optional::NO, "Bitcoin RPC username"},
             {"bitcoin_pass", RPCArg::Type::STR, RPCArg::Optional::NO, "Bitcoin RPC password"},
             {"wattx_wallet", RPCArg::Type::STR, RPCArg::Optional::NO, "WATTx wallet address for block rewards"},
+            {"bitcoin_zmq", RPCArg::Type::STR, RPCArg::Default{""}, "bitcoind -zmqpubhashblock endpoint (e.g. tcp://127.0.0.1:28332) for instant new-block notifications; polling only if empty"},
         },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
@@ -220,6 +344,7 @@ static RPCHelpMan startbitcoinmergedstratum()
             btc_config.daemon_user = request.params[3].get_str();
             btc_config.daemon_password = request.params[4].get_str();
             btc_config.wallet_address = "";  // Bitcoin doesn't need wallet for getblocktemplate
+            if (!request.params[6].isNull()) btc_config.zmq_endpoint = request.params[6].get_str();
 
             // Configure multi-chain server
             merged_stratum::MultiMergedConfig config;
@@ -250,6 +375,7 @@ void RegisterStratumRPCCommands(CRPCTable& t)
         {"mining", &startstratum},
         {"mining", &stopstratum},
         {"mining", &getstratuminfo},
+        {"mining", &getstratumstats},
         {"mining", &startbitcoinmergedstratum},
         {"mining", &startmergedstratum},
         {"mining", &stopmergedstratum},
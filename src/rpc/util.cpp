@@ -700,7 +700,8 @@ UniValue RPCHelpMan::HandleRequest(const JSONRPCRequest& request) const
     m_req = &request;
     UniValue ret = m_fun(*this, request);
     m_req = nullptr;
-    if (gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
+    // A streamed result has been sent already and isn't returned
+    if (!request.isStreaming && gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
         UniValue mismatch{UniValue::VARR};
         for (const auto& res : m_results.m_results) {
             UniValue match{res.MatchesType(ret)};
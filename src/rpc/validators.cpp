@@ -9,8 +9,15 @@
 #include <validators/delegation.h>
 #include <trust/trustscore.h>
 #include <trust/heartbeat_net.h>
+#include <chain.h>
 #include <chainparams.h>
+#include <common/args.h>
 #include <core_io.h>
+#include <node/context.h>
+#include <node/validator_snapshot.h>
+#include <streams.h>
+#include <util/fs.h>
+#include <validation.h>
 #include <univalue.h>
 #include <key_io.h>
 #include <util/strencodings.h>
@@ -38,9 +45,11 @@ static RPCHelpMan listvalidators()
         {
             {"minFee", RPCArg::Type::NUM, RPCArg::Default{-1}, "Filter validators with fee at or below this rate (basis points, 100 = 1%)"},
             {"activeOnly", RPCArg::Type::BOOL, RPCArg::Default{true}, "Only show active validators"},
+            {"count", RPCArg::Type::NUM, RPCArg::Default{0}, "Maximum number of validators to return, 0 for all"},
+            {"skip", RPCArg::Type::NUM, RPCArg::Default{0}, "Number of validators to skip, in stake order"},
         },
         RPCResult{
-            RPCResult::Type::ARR, "", "",
+            RPCResult::Type::ARR, "", "Validators sorted by total stake (descending), or by fee rate with minFee",
             {
                 {RPCResult::Type::OBJ, "", "",
                 {
@@ -60,6 +69,7 @@ static RPCHelpMan listvalidators()
         RPCExamples{
             HelpExampleCli("listvalidators", "")
             + HelpExampleCli("listvalidators", "500 true")
+            + HelpExampleCli("listvalidators", "-1 true 50 100")
             + HelpExampleRpc("listvalidators", "500, true")
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
@@ -73,18 +83,20 @@ static RPCHelpMan listvalidators()
                 maxFee = request.params[0].getInt<int64_t>();
             }
 
-            bool activeOnly = true;
-            if (!request.params[1].isNull()) {
-                activeOnly = request.params[1].get_bool();
+            const int64_t count = request.params[2].isNull() ? 0 : request.params[2].getInt<int64_t>();
+            const int64_t skip = request.params[3].isNull() ? 0 : request.params[3].getInt<int64_t>();
+            if (count < 0 || skip < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "count and skip must not be negative");
             }
 
             std::vector<ValidatorEntry> validators;
             if (maxFee >= 0) {
                 validators = g_validator_db->GetValidatorsByMaxFee(maxFee);
-            } else if (activeOnly) {
-                validators = g_validator_db->GetActiveValidators();
+                validators.erase(validators.begin(), validators.begin() + std::min<size_t>(skip, validators.size()));
+                if (count > 0 && validators.size() > size_t(count)) validators.resize(count);
             } else {
-                validators = g_validator_db->GetValidatorsByStake();
+                // Only active validators are listed, whatever activeOnly is set to
+                validators = g_validator_db->GetValidatorsByStake(skip, count);
             }
 
             UniValue result(UniValue::VARR);
@@ -138,6 +150,7 @@ static RPCHelpMan getvalidator()
                 {RPCResult::Type::STR, "status", "Validator status"},
                 {RPCResult::Type::NUM, "registrationHeight", "Block height when registered"},
                 {RPCResult::Type::NUM, "delegatorCount", "Number of delegators"},
+                {RPCResult::Type::NUM, "stakeRank", /*optional=*/true, "Position among active validators by total stake, 0 is the highest"},
                 {RPCResult::Type::STR, "trustTier", "Trust tier"},
                 {RPCResult::Type::NUM, "uptimePercent", "Uptime percentage * 10"},
                 {RPCResult::Type::NUM, "rewardMultiplier", "Reward multiplier (100 = 1x)"},
@@ -170,6 +183,9 @@ static RPCHelpMan getvalidator()
             result.pushKV("status", ValidatorStatusToString(v->status));
             result.pushKV("registrationHeight", v->registrationHeight);
             result.pushKV("delegatorCount", v->delegatorCount);
+            if (auto rank = g_validator_db->GetStakeRank(validatorId)) {
+                result.pushKV("stakeRank", (int64_t)*rank);
+            }
 
             // Get trust info
             if (trust::g_heartbeat_manager) {
@@ -275,6 +291,8 @@ static RPCHelpMan listdelegations()
         {
             {"keyId", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The delegator or validator public key ID"},
             {"type", RPCArg::Type::STR, RPCArg::Default{"delegator"}, "Query type: 'delegator' or 'validator'"},
+            {"count", RPCArg::Type::NUM, RPCArg::Default{0}, "The number of delegations to return, 0 for all"},
+            {"after", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "Return the delegations after this delegation ID, in delegation ID order"},
         },
         RPCResult{
             RPCResult::Type::ARR, "", "",
@@ -292,6 +310,7 @@ static RPCHelpMan listdelegations()
         },
         RPCExamples{
             HelpExampleCli("listdelegations", "\"0123456789abcdef...\" delegator")
+            + HelpExampleCli("listdelegations", "\"0123456789abcdef...\" validator 100 \"fedcba9876543210...\"")
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
         {
@@ -307,15 +326,18 @@ static RPCHelpMan listdelegations()
                 queryType = request.params[1].get_str();
             }
 
-            std::vector<DelegationEntry> delegations;
-            if (queryType == "validator") {
-                delegations = g_delegation_db->GetDelegationsForValidator(keyId);
-            } else {
-                delegations = g_delegation_db->GetDelegationsForDelegator(keyId);
+            int count = request.params[2].isNull() ? 0 : request.params[2].getInt<int>();
+            if (count < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+            }
+            uint256 after;
+            if (!request.params[3].isNull()) {
+                after = ParseHashV(request.params[3], "after");
             }
 
+            // Written straight from the on-disk index, without copying the entries out
             UniValue result(UniValue::VARR);
-            for (const auto& d : delegations) {
+            auto visit = [&](const DelegationEntry& d) {
                 UniValue entry(UniValue::VOBJ);
                 entry.pushKV("delegationId", d.GetDelegationId().ToString());
                 entry.pushKV("delegatorId", d.delegatorId.ToString());
@@ -323,7 +345,12 @@ static RPCHelpMan listdelegations()
                 entry.pushKV("amount", ValueFromAmount(d.amount));
                 entry.pushKV("status", DelegationStatusToString(d.status));
                 entry.pushKV("pendingRewards", ValueFromAmount(d.pendingRewards));
-                result.push_back(entry);
+                result.push_back(std::move(entry));
+            };
+            if (queryType == "validator") {
+                g_delegation_db->ForEachDelegationForValidator(keyId, after, count, visit);
+            } else {
+                g_delegation_db->ForEachDelegationForDelegator(keyId, after, count, visit);
             }
 
             return result;
@@ -422,6 +449,139 @@ static RPCHelpMan gettrusttierinfo()
     };
 }
 
+static RPCHelpMan dumpvalidatorstate()
+{
+    return RPCHelpMan{"dumpvalidatorstate",
+        "\nWrite the validator, delegation and trust databases at the current tip to a file.\n"
+        "A new node synced to the same block can load it with loadvalidatorstate.\n",
+        {
+            {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the output file. If relative, will be prefixed by datadir."},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "base_hash", "The hash of the block the state was taken at"},
+                {RPCResult::Type::NUM, "base_height", "The height of the block the state was taken at"},
+                {RPCResult::Type::STR_HEX, "snapshot_hash", "The hash committing to the snapshot content"},
+                {RPCResult::Type::NUM, "validator_records", "The number of validator database records"},
+                {RPCResult::Type::NUM, "delegation_records", "The number of delegation database records"},
+                {RPCResult::Type::NUM, "trust_records", "The number of trust database records"},
+                {RPCResult::Type::STR, "path", "The absolute path that the snapshot was written to"},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("dumpvalidatorstate", "\"validators.dat\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            node::NodeContext& node = EnsureAnyNodeContext(request.context);
+            const fs::path path{AbsPathForConfigVal(EnsureArgsman(node), fs::u8path(request.params[0].get_str()))};
+            // Write to a temporary path so an interrupted dump is not mistaken for a snapshot
+            const fs::path temppath{path + ".incomplete"};
+
+            if (fs::exists(path)) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER,
+                    path.utf8string() + " already exists. If you are sure this is what you want, move it out of the way first");
+            }
+
+            ChainstateManager& chainman = EnsureChainman(node);
+            auto snapshot{WITH_LOCK(::cs_main, return node::CreateValidatorSnapshot(*chainman.ActiveChain().Tip(), chainman.GetParams().MessageStart()))};
+            if (!snapshot) {
+                throw JSONRPCError(RPC_INTERNAL_ERROR, util::ErrorString(snapshot).original);
+            }
+
+            AutoFile afile{fsbridge::fopen(temppath, "wb")};
+            if (afile.IsNull()) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Couldn't open file " + temppath.utf8string() + " for writing.");
+            }
+            afile << *snapshot;
+            if (afile.fclose() != 0) {
+                throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to write " + temppath.utf8string());
+            }
+            fs::rename(temppath, path);
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("base_hash", snapshot->m_base_blockhash.ToString());
+            result.pushKV("base_height", snapshot->m_base_height);
+            result.pushKV("snapshot_hash", snapshot->GetHash().ToString());
+            result.pushKV("validator_records", (uint64_t)snapshot->m_validators.size());
+            result.pushKV("delegation_records", (uint64_t)snapshot->m_delegations.size());
+            result.pushKV("trust_records", (uint64_t)snapshot->m_trust.size());
+            result.pushKV("path", path.utf8string());
+            return result;
+        },
+    };
+}
+
+static RPCHelpMan loadvalidatorstate()
+{
+    return RPCHelpMan{"loadvalidatorstate",
+        "\nReplace the validator, delegation and trust databases with a snapshot written by dumpvalidatorstate.\n"
+        "The snapshot must have been taken at the current tip. Its content is checked against the hash stored\n"
+        "in the file and, if given, against snapshot_hash, which should come from a source you trust.\n",
+        {
+            {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the snapshot file. If relative, will be prefixed by datadir."},
+            {"snapshot_hash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The expected snapshot hash, as reported by dumpvalidatorstate"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "base_hash", "The hash of the block the state was taken at"},
+                {RPCResult::Type::NUM, "base_height", "The height of the block the state was taken at"},
+                {RPCResult::Type::STR_HEX, "snapshot_hash", "The hash committing to the snapshot content"},
+                {RPCResult::Type::NUM, "validator_records", "The number of validator database records"},
+                {RPCResult::Type::NUM, "delegation_records", "The number of delegation database records"},
+                {RPCResult::Type::NUM, "trust_records", "The number of trust database records"},
+                {RPCResult::Type::STR, "path", "The absolute path that the snapshot was loaded from"},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("loadvalidatorstate", "\"validators.dat\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            node::NodeContext& node = EnsureAnyNodeContext(request.context);
+            ChainstateManager& chainman = EnsureChainman(node);
+            const fs::path path{AbsPathForConfigVal(EnsureArgsman(node), fs::u8path(request.params[0].get_str()))};
+
+            AutoFile afile{fsbridge::fopen(path, "rb")};
+            if (afile.IsNull()) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Couldn't open file " + path.utf8string() + " for reading.");
+            }
+
+            node::ValidatorSnapshot snapshot{chainman.GetParams().MessageStart()};
+            try {
+                afile >> snapshot;
+            } catch (const std::ios_base::failure& e) {
+                throw JSONRPCError(RPC_DESERIALIZATION_ERROR, strprintf("Unable to parse validator state snapshot: %s", e.what()));
+            }
+
+            const uint256 snapshot_hash{snapshot.GetHash()};
+            if (!request.params[1].isNull() && ParseHashV(request.params[1], "snapshot_hash") != snapshot_hash) {
+                throw JSONRPCError(RPC_VERIFY_ERROR, strprintf("Snapshot hash %s does not match the expected hash", snapshot_hash.ToString()));
+            }
+
+            {
+                LOCK(::cs_main);
+                const auto loaded{node::LoadValidatorSnapshot(snapshot, *chainman.ActiveChain().Tip())};
+                if (!loaded) {
+                    throw JSONRPCError(RPC_INTERNAL_ERROR, strprintf("Unable to load validator state snapshot: %s", util::ErrorString(loaded).original));
+                }
+            }
+
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("base_hash", snapshot.m_base_blockhash.ToString());
+            result.pushKV("base_height", snapshot.m_base_height);
+            result.pushKV("snapshot_hash", snapshot_hash.ToString());
+            result.pushKV("validator_records", (uint64_t)snapshot.m_validators.size());
+            result.pushKV("delegation_records", (uint64_t)snapshot.m_delegations.size());
+            result.pushKV("trust_records", (uint64_t)snapshot.m_trust.size());
+            result.pushKV("path", path.utf8string());
+            return result;
+        },
+    };
+}
+
 static RPCHelpMan activatevalidator()
 {
     return RPCHelpMan{"activatevalidator",
@@ -470,6 +630,8 @@ void RegisterValidatorRPCCommands(CRPCTable& t)
         {"validators", &listdelegations},
         {"validators", &getpendingrewards},
         {"validators", &gettrusttierinfo},
+        {"validators", &dumpvalidatorstate},
+        {"validators", &loadvalidatorstate},
         {"hidden", &activatevalidator},
     };
     for (const auto& c : commands) {
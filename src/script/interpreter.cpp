@@ -1149,9 +1149,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                         CScript scriptCode(pbegincodehash, pend);
                         uint256 scriptHash = Hash(scriptCode);
 
-                        // Verify using Dilithium
-                        dilithium::CPubKey pubkey(vchPubKey);
-                        fSuccess = pubkey.Verify(scriptHash, vchSig);
+                        fSuccess = checker.CheckDilithiumSignature(vchSig, vchPubKey, scriptHash);
                     }
 
                     popstack(stack);
@@ -1822,6 +1820,11 @@ uint256 SignatureHash(const CScript& scriptCode, const T& txTo, unsigned int nIn
     return ss.GetHash();
 }
 
+bool BaseSignatureChecker::CheckDilithiumSignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const uint256& hash) const
+{
+    return dilithium::CPubKey(pubkey).Verify(hash, sig);
+}
+
 template <class T>
 bool GenericTransactionSignatureChecker<T>::VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
@@ -269,6 +269,9 @@ public:
         return false;
     }
 
+    /** Verify an ML-DSA-65 signature of OP_CHECKSIG_DILITHIUM over @p hash */
+    virtual bool CheckDilithiumSignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const uint256& hash) const;
+
     virtual bool CheckLockTime(const CScriptNum& nLockTime) const
     {
          return false;
@@ -338,6 +341,11 @@ public:
         return m_checker.CheckSchnorrSignature(sig, pubkey, sigversion, execdata, serror);
     }
 
+    bool CheckDilithiumSignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const uint256& hash) const override
+    {
+        return m_checker.CheckDilithiumSignature(sig, pubkey, hash);
+    }
+
     bool CheckLockTime(const CScriptNum& nLockTime) const override
     {
         return m_checker.CheckLockTime(nLockTime);
@@ -22,14 +22,17 @@ SignatureCache::SignatureCache(const size_t max_size_bytes)
     uint256 nonce = GetRandHash();
     // We want the nonce to be 64 bytes long to force the hasher to process
     // this chunk, which makes later hash computations more efficient. We
-    // just write our 32-byte entropy, and then pad with 'E' for ECDSA and
-    // 'S' for Schnorr (followed by 0 bytes).
+    // just write our 32-byte entropy, and then pad with 'E' for ECDSA,
+    // 'S' for Schnorr and 'D' for Dilithium (followed by 0 bytes).
     static constexpr unsigned char PADDING_ECDSA[32] = {'E'};
     static constexpr unsigned char PADDING_SCHNORR[32] = {'S'};
+    static constexpr unsigned char PADDING_DILITHIUM[32] = {'D'};
     m_salted_hasher_ecdsa.Write(nonce.begin(), 32);
     m_salted_hasher_ecdsa.Write(PADDING_ECDSA, 32);
     m_salted_hasher_schnorr.Write(nonce.begin(), 32);
     m_salted_hasher_schnorr.Write(PADDING_SCHNORR, 32);
+    m_salted_hasher_dilithium.Write(nonce.begin(), 32);
+    m_salted_hasher_dilithium.Write(PADDING_DILITHIUM, 32);
 
     const auto [num_elems, approx_size_bytes] = setValid.setup_bytes(max_size_bytes);
     LogPrintf("Using %zu MiB out of %zu MiB requested for signature cache, able to store %zu elements\n",
@@ -48,6 +51,12 @@ void SignatureCache::ComputeEntrySchnorr(uint256& entry, const uint256& hash, Sp
     hasher.Write(hash.begin(), 32).Write(pubkey.data(), pubkey.size()).Write(sig.data(), sig.size()).Finalize(entry.begin());
 }
 
+void SignatureCache::ComputeEntryDilithium(uint256& entry, const uint256& hash, const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey) const
+{
+    CSHA256 hasher = m_salted_hasher_dilithium;
+    hasher.Write(hash.begin(), 32).Write(pubkey.data(), pubkey.size()).Write(sig.data(), sig.size()).Finalize(entry.begin());
+}
+
 bool SignatureCache::Get(const uint256& entry, const bool erase)
 {
     std::shared_lock<std::shared_mutex> lock(cs_sigcache);
@@ -83,6 +92,18 @@ bool CachingTransactionSignatureChecker::VerifySchnorrSignature(Span<const unsig
     return true;
 }
 
+bool CachingTransactionSignatureChecker::CheckDilithiumSignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const uint256& hash) const
+{
+    // Pubkey and signature are ~5 KB together; hashing them is still far
+    // cheaper than an ML-DSA verification
+    uint256 entry;
+    m_signature_cache.ComputeEntryDilithium(entry, hash, sig, pubkey);
+    if (m_signature_cache.Get(entry, !store)) return true;
+    if (!TransactionSignatureChecker::CheckDilithiumSignature(sig, pubkey, hash)) return false;
+    if (store) m_signature_cache.Set(entry);
+    return true;
+}
+
 bool CachingTransactionSignatureOutputChecker::VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -0,0 +1,79 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/coinbase_template.h>
+
+#include <consensus/merkle.h>
+#include <hash.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <streams.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace stratum {
+
+//! Offset of the merkle root in RandomXMiner::SerializeMiningBlob's layout
+static constexpr size_t BLOB_MERKLE_ROOT_OFFSET = 47;
+//! Consensus limit on the coinbase scriptSig
+static constexpr size_t MAX_COINBASE_SCRIPTSIG_SIZE = 100;
+
+static std::array<unsigned char, CoinbaseTemplate::EXTRANONCE1_SIZE> EncodeExtranonce(uint32_t extranonce1)
+{
+    return {static_cast<unsigned char>(extranonce1), static_cast<unsigned char>(extranonce1 >> 8),
+            static_cast<unsigned char>(extranonce1 >> 16), static_cast<unsigned char>(extranonce1 >> 24)};
+}
+
+CoinbaseTemplate::CoinbaseTemplate(const CBlock& block)
+{
+    if (block.vtx.empty()) throw std::runtime_error("block template has no coinbase");
+
+    m_coinbase = CMutableTransaction(*block.vtx[0]);
+    CScript& script_sig = m_coinbase.vin.at(0).scriptSig;
+    script_sig << std::vector<unsigned char>(EXTRANONCE1_SIZE, 0);
+    if (script_sig.size() > MAX_COINBASE_SCRIPTSIG_SIZE) {
+        throw std::runtime_error("coinbase scriptSig has no room for an extranonce");
+    }
+
+    DataStream stream;
+    stream << TX_NO_WITNESS(m_coinbase);
+    // version, input count, prevout, scriptSig length, then the scriptSig ending in the extranonce
+    const size_t slot = 4 + GetSizeOfCompactSize(m_coinbase.vin.size()) + 36 +
+                        GetSizeOfCompactSize(script_sig.size()) + script_sig.size() - EXTRANONCE1_SIZE;
+    const auto* data = UCharCast(stream.data());
+    m_coinb1.assign(data, data + slot);
+    m_coinb2.assign(data + slot + EXTRANONCE1_SIZE, data + stream.size());
+
+    m_branch = TransactionMerklePath(block, 0);
+}
+
+uint256 CoinbaseTemplate::MerkleRoot(uint32_t extranonce1) const
+{
+    uint256 hash;
+    CHash256().Write(m_coinb1).Write(EncodeExtranonce(extranonce1)).Write(m_coinb2).Finalize(hash);
+    for (const uint256& sibling : m_branch) {
+        hash = Hash(hash, sibling);
+    }
+    return hash;
+}
+
+CTransactionRef CoinbaseTemplate::Coinbase(uint32_t extranonce1) const
+{
+    CMutableTransaction coinbase{m_coinbase};
+    CScript& script_sig = coinbase.vin[0].scriptSig;
+    const auto extranonce = EncodeExtranonce(extranonce1);
+    std::copy(extranonce.begin(), extranonce.end(), script_sig.end() - EXTRANONCE1_SIZE);
+    return MakeTransactionRef(std::move(coinbase));
+}
+
+void SetBlobMerkleRoot(std::vector<unsigned char>& blob, const uint256& merkle_root)
+{
+    if (blob.size() < BLOB_MERKLE_ROOT_OFFSET + merkle_root.size()) return;
+    std::copy(merkle_root.begin(), merkle_root.end(), blob.begin() + BLOB_MERKLE_ROOT_OFFSET);
+}
+
+} // namespace stratum
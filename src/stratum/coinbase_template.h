@@ -0,0 +1,58 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_COINBASE_TEMPLATE_H
+#define WATTX_STRATUM_COINBASE_TEMPLATE_H
+
+#include <primitives/transaction.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <vector>
+
+class CBlock;
+
+namespace stratum {
+
+/**
+ * A block template's coinbase split around a per-connection extranonce.
+ *
+ * The coinbase scriptSig is extended with an EXTRANONCE1_SIZE push, and the
+ * serialization without witness is cut into coinb1 and coinb2 either side
+ * of it. With the coinbase's merkle branch taken once per template, the
+ * merkle root for any extranonce is one coinbase hash plus one hash per
+ * tree level, whatever the number of transactions in the block. Each
+ * connection hashing its own extranonce gets a header, and so a nonce
+ * space, no other connection shares.
+ */
+class CoinbaseTemplate {
+public:
+    static constexpr size_t EXTRANONCE1_SIZE = 4;
+
+    //! Throws std::runtime_error if the coinbase scriptSig has no room for the extranonce
+    explicit CoinbaseTemplate(const CBlock& block);
+
+    uint256 MerkleRoot(uint32_t extranonce1) const;
+
+    //! The coinbase carrying @p extranonce1, for block submission
+    CTransactionRef Coinbase(uint32_t extranonce1) const;
+
+    const std::vector<unsigned char>& Coinb1() const { return m_coinb1; }
+    const std::vector<unsigned char>& Coinb2() const { return m_coinb2; }
+    //! Siblings of the coinbase from the leaves up
+    const std::vector<uint256>& Branch() const { return m_branch; }
+
+private:
+    CMutableTransaction m_coinbase;
+    std::vector<unsigned char> m_coinb1;
+    std::vector<unsigned char> m_coinb2;
+    std::vector<uint256> m_branch;
+};
+
+/** Replace the merkle root of an 80-byte RandomX mining blob */
+void SetBlobMerkleRoot(std::vector<unsigned char>& blob, const uint256& merkle_root);
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_COINBASE_TEMPLATE_H
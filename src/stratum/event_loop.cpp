@@ -0,0 +1,673 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/event_loop.h>
+
+#include <compat/compat.h>
+#include <stratum/stratum_framing.h>
+#include <logging.h>
+#include <util/threadnames.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#define STRATUM_USE_EPOLL 1
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define STRATUM_USE_KQUEUE 1
+#include <sys/event.h>
+#include <sys/time.h>
+#else
+#include <poll.h>
+#endif
+
+namespace stratum {
+
+//! Poll timeout, bounds how long Stop() waits for an idle I/O thread
+static constexpr int IO_WAIT_TIMEOUT_MS = 200;
+//! Maximum readiness events handled per wakeup
+static constexpr int IO_MAX_EVENTS = 256;
+//! recv() calls per readiness event before yielding to other sockets
+static constexpr int IO_READS_PER_EVENT = 4;
+//! Queued segments gathered into a single sendmsg() call
+static constexpr size_t IO_MAX_IOVECS = 16;
+
+static bool SetNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return false;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool IsWouldBlock(int err)
+{
+    return err == EAGAIN || err == EWOULDBLOCK || err == EINTR;
+}
+
+// ============================================================================
+// Readiness backends
+// ============================================================================
+//
+// Tokens identify what became ready: values >= 0 are connection ids,
+// negative values are listener slots (slot = -token - 1).
+
+struct PollEvent {
+    int64_t token;
+    bool readable;
+    bool writable;
+    bool hangup;
+};
+
+#if defined(STRATUM_USE_EPOLL)
+
+class StratumEventLoop::Poller {
+public:
+    ~Poller() { if (m_fd >= 0) close(m_fd); }
+
+    bool Init()
+    {
+        m_fd = epoll_create1(EPOLL_CLOEXEC);
+        return m_fd >= 0;
+    }
+
+    bool Add(int fd, int64_t token)
+    {
+        struct epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = static_cast<uint64_t>(token);
+        return epoll_ctl(m_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    void SetWriteInterest(int fd, int64_t token, bool enable)
+    {
+        struct epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<uint32_t>(EPOLLOUT) : 0U);
+        ev.data.u64 = static_cast<uint64_t>(token);
+        epoll_ctl(m_fd, EPOLL_CTL_MOD, fd, &ev);
+    }
+
+    void Remove(int fd)
+    {
+        epoll_ctl(m_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    int Wait(std::vector<PollEvent>& out, int timeout_ms)
+    {
+        struct epoll_event events[IO_MAX_EVENTS];
+        int n = epoll_wait(m_fd, events, IO_MAX_EVENTS, timeout_ms);
+        out.clear();
+        for (int i = 0; i < n; ++i) {
+            out.push_back({static_cast<int64_t>(events[i].data.u64),
+                           (events[i].events & EPOLLIN) != 0,
+                           (events[i].events & EPOLLOUT) != 0,
+                           (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) != 0});
+        }
+        return n;
+    }
+
+private:
+    int m_fd{-1};
+};
+
+const char* StratumEventLoop::BackendName() { return "epoll"; }
+
+#elif defined(STRATUM_USE_KQUEUE)
+
+class StratumEventLoop::Poller {
+public:
+    ~Poller() { if (m_fd >= 0) close(m_fd); }
+
+    bool Init()
+    {
+        m_fd = kqueue();
+        return m_fd >= 0;
+    }
+
+    bool Add(int fd, int64_t token)
+    {
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_READ, EV_ADD | EV_ENABLE, 0, 0, reinterpret_cast<void*>(static_cast<intptr_t>(token)));
+        return kevent(m_fd, &ev, 1, nullptr, 0, nullptr) == 0;
+    }
+
+    void SetWriteInterest(int fd, int64_t token, bool enable)
+    {
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_WRITE, enable ? (EV_ADD | EV_ENABLE) : EV_DELETE, 0, 0,
+               reinterpret_cast<void*>(static_cast<intptr_t>(token)));
+        kevent(m_fd, &ev, 1, nullptr, 0, nullptr);
+    }
+
+    void Remove(int fd)
+    {
+        // Closing the descriptor drops its filters; delete explicitly for
+        // callers that keep the fd open.
+        struct kevent ev[2];
+        EV_SET(&ev[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+        EV_SET(&ev[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+        kevent(m_fd, ev, 2, nullptr, 0, nullptr);
+    }
+
+    int Wait(std::vector<PollEvent>& out, int timeout_ms)
+    {
+        struct kevent events[IO_MAX_EVENTS];
+        struct timespec ts;
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        int n = kevent(m_fd, nullptr, 0, events, IO_MAX_EVENTS, &ts);
+        out.clear();
+        for (int i = 0; i < n; ++i) {
+            int64_t token = static_cast<int64_t>(reinterpret_cast<intptr_t>(events[i].udata));
+            out.push_back({token,
+                           events[i].filter == EVFILT_READ,
+                           events[i].filter == EVFILT_WRITE,
+                           (events[i].flags & (EV_EOF | EV_ERROR)) != 0 && events[i].data == 0});
+        }
+        return n;
+    }
+
+private:
+    int m_fd{-1};
+};
+
+const char* StratumEventLoop::BackendName() { return "kqueue"; }
+
+#else
+
+class StratumEventLoop::Poller {
+public:
+    bool Init() { return true; }
+
+    bool Add(int fd, int64_t token)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fds[fd] = {token, false};
+        return true;
+    }
+
+    void SetWriteInterest(int fd, int64_t token, bool enable)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_fds.find(fd);
+        if (it != m_fds.end()) it->second.second = enable;
+    }
+
+    void Remove(int fd)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fds.erase(fd);
+    }
+
+    int Wait(std::vector<PollEvent>& out, int timeout_ms)
+    {
+        std::vector<struct pollfd> pfds;
+        std::vector<int64_t> tokens;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& [fd, entry] : m_fds) {
+                struct pollfd pfd{};
+                pfd.fd = fd;
+                pfd.events = POLLIN | (entry.second ? POLLOUT : 0);
+                pfds.push_back(pfd);
+                tokens.push_back(entry.first);
+            }
+        }
+        out.clear();
+        int n = poll(pfds.data(), pfds.size(), timeout_ms);
+        if (n <= 0) return n;
+        for (size_t i = 0; i < pfds.size(); ++i) {
+            if (pfds[i].revents == 0) continue;
+            out.push_back({tokens[i],
+                           (pfds[i].revents & POLLIN) != 0,
+                           (pfds[i].revents & POLLOUT) != 0,
+                           (pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0});
+        }
+        return static_cast<int>(out.size());
+    }
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<int, std::pair<int64_t, bool>> m_fds; // fd -> (token, want_write)
+};
+
+const char* StratumEventLoop::BackendName() { return "poll"; }
+
+#endif
+
+// ============================================================================
+// Connection state
+// ============================================================================
+
+struct StratumEventLoop::Connection {
+    int id{-1};
+    int fd{-1};
+    size_t worker{0};
+    bool raw{false};  //!< Framing::RAW: hand over chunks, not lines
+
+    //! Guards everything below; taken by Send() from any thread
+    std::mutex mutex;
+    std::deque<SharedPayload> send_queue;
+    size_t send_offset{0};  //!< bytes of send_queue.front() already written
+    size_t queued_bytes{0};
+    uint64_t bytes_out{0};
+    bool want_write{false};
+    bool closed{false};
+
+    //! Written by the owning I/O thread, read by stats
+    std::atomic<uint64_t> bytes_in{0};
+
+    //! Only touched by the owning I/O thread
+    StratumLineFramer framer{MAX_STRATUM_LINE_LENGTH};
+};
+
+struct StratumEventLoop::Worker {
+    Poller poller;
+    std::thread thread;
+
+    //! Connections closed by Close() whose descriptors the I/O thread still has to release
+    std::mutex closing_mutex;
+    std::vector<std::shared_ptr<Connection>> closing;
+};
+
+// ============================================================================
+// StratumEventLoop
+// ============================================================================
+
+StratumEventLoop::StratumEventLoop() = default;
+
+StratumEventLoop::~StratumEventLoop()
+{
+    Stop();
+}
+
+bool StratumEventLoop::Start(int num_threads, const std::string& thread_prefix,
+                             AcceptFn on_accept, LineFn on_line, CloseFn on_close)
+{
+    if (m_running.load()) return false;
+
+    m_on_accept = std::move(on_accept);
+    m_on_line = std::move(on_line);
+    m_on_close = std::move(on_close);
+
+    if (num_threads < 1) num_threads = 1;
+    m_workers.clear();
+    for (int i = 0; i < num_threads; ++i) {
+        auto worker = std::make_unique<Worker>();
+        if (!worker->poller.Init()) {
+            LogPrintf("Stratum: Failed to create %s poller: %s\n", BackendName(), strerror(errno));
+            m_workers.clear();
+            return false;
+        }
+        m_workers.push_back(std::move(worker));
+    }
+
+    m_running.store(true);
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i]->thread = std::thread([this, i, thread_prefix] {
+            util::ThreadRename(thread_prefix + "." + std::to_string(i));
+            WorkerThread(i);
+        });
+    }
+
+    LogPrintf("Stratum: %s I/O core started with %d threads (%s)\n",
+              thread_prefix, num_threads, BackendName());
+    return true;
+}
+
+void StratumEventLoop::Stop()
+{
+    if (!m_running.exchange(false)) return;
+
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_listeners_mutex);
+        for (const Listener& listener : m_listeners) {
+            if (!m_workers.empty()) m_workers[0]->poller.Remove(listener.fd);
+        }
+        m_listeners.clear();
+    }
+
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        connections.swap(m_connections);
+    }
+    for (auto& [id, conn] : connections) {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (!conn->closed) {
+            conn->closed = true;
+            close(conn->fd);
+        }
+    }
+    // The I/O threads are gone, so the descriptors of closed connections
+    // they did not get to can be released here
+    for (auto& worker : m_workers) {
+        ReleaseClosed(*worker);
+    }
+}
+
+bool StratumEventLoop::AddListener(int listen_fd, int listener_id, Framing framing)
+{
+    if (!m_running.load() || m_workers.empty()) return false;
+    if (!SetNonBlocking(listen_fd)) return false;
+
+    std::lock_guard<std::mutex> lock(m_listeners_mutex);
+    int64_t token = -static_cast<int64_t>(m_listeners.size()) - 1;
+    if (!m_workers[0]->poller.Add(listen_fd, token)) {
+        LogPrintf("Stratum: Failed to register listener %d: %s\n", listener_id, strerror(errno));
+        return false;
+    }
+    m_listeners.push_back({listen_fd, listener_id, framing});
+    return true;
+}
+
+size_t StratumEventLoop::GetConnectionCount() const
+{
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    return m_connections.size();
+}
+
+bool StratumEventLoop::GetConnectionStats(int conn_id, ConnectionStats& stats) const
+{
+    auto conn = FindConnection(conn_id);
+    if (!conn) return false;
+
+    stats.bytes_in = conn->bytes_in.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    stats.bytes_out = conn->bytes_out;
+    stats.queued_bytes = conn->queued_bytes;
+    return !conn->closed;
+}
+
+std::shared_ptr<StratumEventLoop::Connection> StratumEventLoop::FindConnection(int conn_id) const
+{
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    auto it = m_connections.find(conn_id);
+    if (it == m_connections.end()) return nullptr;
+    return it->second;
+}
+
+bool StratumEventLoop::Send(int conn_id, const std::string& data)
+{
+    return Send(conn_id, std::make_shared<const std::string>(data));
+}
+
+bool StratumEventLoop::Send(int conn_id, SharedPayload payload)
+{
+    if (!payload || payload->empty()) return true;
+
+    auto conn = FindConnection(conn_id);
+    if (!conn) return false;
+
+    Worker& worker = *m_workers[conn->worker];
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    if (conn->closed) return false;
+
+    if (conn->queued_bytes + payload->size() > MAX_STRATUM_SEND_BUFFER) {
+        // Slow consumer. Shut the socket down and let the owning I/O thread
+        // observe the hangup so the close callback runs outside caller locks.
+        LogPrintf("Stratum: Connection %d send buffer overflow, dropping\n", conn_id);
+        shutdown(conn->fd, SHUT_RDWR);
+        return false;
+    }
+
+    conn->queued_bytes += payload->size();
+    conn->send_queue.push_back(std::move(payload));
+    return FlushLocked(worker, *conn);
+}
+
+bool StratumEventLoop::FlushLocked(Worker& worker, Connection& conn)
+{
+    while (!conn.send_queue.empty()) {
+        // Gather queued segments into one sendmsg() call
+        struct iovec iov[IO_MAX_IOVECS];
+        size_t iov_count = 0;
+        size_t offset = conn.send_offset;
+        for (const auto& segment : conn.send_queue) {
+            if (iov_count == IO_MAX_IOVECS) break;
+            iov[iov_count].iov_base = const_cast<char*>(segment->data()) + offset;
+            iov[iov_count].iov_len = segment->size() - offset;
+            ++iov_count;
+            offset = 0;
+        }
+
+        struct msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+        ssize_t n = sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n < 0 && IsWouldBlock(errno)) break;
+        if (n <= 0) {
+            // Hard error, the reader side will pick up the hangup
+            shutdown(conn.fd, SHUT_RDWR);
+            return false;
+        }
+
+        // Retire fully written segments; shared payloads are released here
+        size_t written = static_cast<size_t>(n);
+        conn.queued_bytes -= written;
+        conn.bytes_out += written;
+        while (written > 0) {
+            size_t remaining = conn.send_queue.front()->size() - conn.send_offset;
+            if (written < remaining) {
+                conn.send_offset += written;
+                break;
+            }
+            written -= remaining;
+            conn.send_queue.pop_front();
+            conn.send_offset = 0;
+        }
+    }
+
+    bool pending = !conn.send_queue.empty();
+    if (pending != conn.want_write) {
+        conn.want_write = pending;
+        worker.poller.SetWriteInterest(conn.fd, conn.id, pending);
+    }
+    return true;
+}
+
+void StratumEventLoop::Close(int conn_id)
+{
+    auto conn = FindConnection(conn_id);
+    if (!conn) return;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->closed) return;
+        conn->closed = true;
+        // The owning I/O thread may be in recv() on the descriptor right now,
+        // so only shut it down here. Closing it could let the number be
+        // reused by another socket while that thread still reads from it.
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_connections.erase(conn_id);
+    }
+    Worker& worker = *m_workers[conn->worker];
+    std::lock_guard<std::mutex> lock(worker.closing_mutex);
+    worker.closing.push_back(std::move(conn));
+}
+
+void StratumEventLoop::ReleaseClosed(Worker& worker)
+{
+    std::vector<std::shared_ptr<Connection>> closing;
+    {
+        std::lock_guard<std::mutex> lock(worker.closing_mutex);
+        closing.swap(worker.closing);
+    }
+    for (const auto& conn : closing) {
+        worker.poller.Remove(conn->fd);
+        close(conn->fd);
+    }
+}
+
+void StratumEventLoop::DropConnection(Worker& worker, const std::shared_ptr<Connection>& conn, bool notify)
+{
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        // Closed by Close(), which left the descriptor to ReleaseClosed()
+        if (conn->closed) return;
+        conn->closed = true;
+    }
+    // No other thread touches the descriptor once the connection is marked closed
+    worker.poller.Remove(conn->fd);
+    close(conn->fd);
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_connections.erase(conn->id);
+    }
+    if (notify && m_on_close) m_on_close(conn->id);
+}
+
+void StratumEventLoop::WorkerThread(size_t index)
+{
+    Worker& worker = *m_workers[index];
+    std::vector<PollEvent> events;
+    events.reserve(IO_MAX_EVENTS);
+
+    while (m_running.load()) {
+        int n = worker.poller.Wait(events, IO_WAIT_TIMEOUT_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LogPrintf("Stratum: %s wait failed: %s\n", BackendName(), strerror(errno));
+            break;
+        }
+
+        for (const PollEvent& ev : events) {
+            if (ev.token < 0) {
+                Listener listener;
+                {
+                    std::lock_guard<std::mutex> lock(m_listeners_mutex);
+                    size_t slot = static_cast<size_t>(-ev.token - 1);
+                    if (slot >= m_listeners.size()) continue;
+                    listener = m_listeners[slot];
+                }
+                HandleAccept(worker, listener);
+                continue;
+            }
+
+            auto conn = FindConnection(static_cast<int>(ev.token));
+            if (!conn) continue;
+
+            if (ev.writable) HandleWritable(worker, conn);
+            if (ev.readable || ev.hangup) HandleReadable(worker, conn);
+        }
+
+        ReleaseClosed(worker);
+    }
+}
+
+void StratumEventLoop::HandleAccept(Worker& worker, const Listener& listener)
+{
+    const int listen_fd = listener.fd;
+    const int listener_id = listener.id;
+
+    // Drain the accept backlog; the listener is non-blocking
+    while (m_running.load()) {
+        struct sockaddr_in client_addr{};
+        socklen_t addr_len = sizeof(client_addr);
+        int fd = accept(listen_fd, (struct sockaddr*)&client_addr, &addr_len);
+        if (fd < 0) {
+            if (!IsWouldBlock(errno)) {
+                LogPrintf("Stratum: Accept failed: %s\n", strerror(errno));
+            }
+            return;
+        }
+
+        char addr_str[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &client_addr.sin_addr, addr_str, sizeof(addr_str));
+
+        if (!SetNonBlocking(fd)) {
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        int conn_id = m_on_accept ? m_on_accept(listener_id, addr_str) : -1;
+        if (conn_id < 0) {
+            close(fd);
+            continue;
+        }
+
+        auto conn = std::make_shared<Connection>();
+        conn->id = conn_id;
+        conn->fd = fd;
+        conn->worker = m_next_worker.fetch_add(1) % m_workers.size();
+        conn->raw = listener.framing == Framing::RAW;
+        {
+            std::lock_guard<std::mutex> lock(m_connections_mutex);
+            m_connections[conn_id] = conn;
+        }
+
+        if (!m_workers[conn->worker]->poller.Add(fd, conn_id)) {
+            LogPrintf("Stratum: Failed to register connection %d: %s\n", conn_id, strerror(errno));
+            DropConnection(*m_workers[conn->worker], conn, /*notify=*/true);
+        }
+    }
+}
+
+void StratumEventLoop::HandleWritable(Worker& worker, const std::shared_ptr<Connection>& conn)
+{
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    if (conn->closed) return;
+    FlushLocked(worker, *conn);
+}
+
+void StratumEventLoop::HandleReadable(Worker& worker, const std::shared_ptr<Connection>& conn)
+{
+    bool peer_closed = false;
+
+    // Level-triggered: read what is there now and come back on the next wakeup
+    for (int i = 0; i < IO_READS_PER_EVENT; ++i) {
+        auto [dst, room] = conn->framer.WriteSpace();
+        if (room == 0) break;
+
+        ssize_t n = recv(conn->fd, dst, room, 0);
+        if (n < 0 && IsWouldBlock(errno)) break;
+        if (n <= 0) {
+            peer_closed = true;
+            break;
+        }
+        conn->framer.Commit(static_cast<size_t>(n));
+        conn->bytes_in.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+
+        // Dispatch straight out of the ring
+        std::string_view line;
+        while (conn->raw ? conn->framer.NextChunk(line) : conn->framer.NextLine(line)) {
+            if (m_on_line) m_on_line(conn->id, line);
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            if (conn->closed) return;
+        }
+
+        if (static_cast<size_t>(n) < room) break;
+    }
+
+    if (conn->framer.Overflowed()) {
+        LogPrintf("Stratum: Connection %d exceeded max line length, dropping\n", conn->id);
+        peer_closed = true;
+    }
+
+    if (peer_closed) {
+        DropConnection(worker, conn, /*notify=*/true);
+    }
+}
+
+} // namespace stratum
@@ -0,0 +1,165 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_EVENT_LOOP_H
+#define WATTX_STRATUM_EVENT_LOOP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace stratum {
+
+//! Default number of I/O threads multiplexing all stratum sockets
+static constexpr int DEFAULT_STRATUM_IO_THREADS = 4;
+//! Queued outbound bytes after which a slow client is dropped
+static constexpr size_t MAX_STRATUM_SEND_BUFFER = 4 * 1024 * 1024;
+//! Per-connection receive ring size, and so the longest line accepted
+static constexpr size_t MAX_STRATUM_LINE_LENGTH = 16 * 1024;
+
+/**
+ * Event-driven socket core shared by all stratum servers.
+ *
+ * A small, fixed pool of I/O threads each owns an epoll (Linux), kqueue
+ * (BSD/macOS) or poll() set. Listening sockets live on the first thread;
+ * accepted connections are spread round-robin across all of them. Inbound
+ * data is read into a per-connection StratumLineFramer ring and handed to
+ * the owning server one newline-delimited message at a time, or for
+ * listeners registered as Framing::RAW, as whatever bytes arrived. Outbound data
+ * is written without blocking and whatever the kernel does not take
+ * immediately is queued, as refcounted segments, on the connection and
+ * flushed with scatter-gather writes when the socket becomes writable again.
+ *
+ * Callbacks run on I/O threads without any event loop lock held, so they may
+ * call Send() and Close() freely. A connection is only ever serviced by one
+ * I/O thread, so the line callback for a given connection is never invoked
+ * concurrently with itself.
+ */
+class StratumEventLoop {
+public:
+    /**
+     * Called for every accepted socket. Returns the connection id the server
+     * assigned to it, or -1 to reject (the socket is then closed).
+     */
+    using AcceptFn = std::function<int(int listener_id, const std::string& peer_addr)>;
+    /**
+     * Called for every complete, non-empty inbound line (without the newline),
+     * or every received chunk on a Framing::RAW connection.
+     * The view points into the receive ring and is only valid for the call.
+     */
+    using LineFn = std::function<void(int conn_id, std::string_view line)>;
+    //! Called once when the peer goes away or the connection fails
+    using CloseFn = std::function<void(int conn_id)>;
+    //! Immutable outbound buffer that may be queued on many connections at once
+    using SharedPayload = std::shared_ptr<const std::string>;
+
+    //! How inbound bytes of a listener's connections are split into messages
+    enum class Framing {
+        LINES,  //!< newline-delimited JSON
+        RAW,    //!< unsplit; the server frames a binary protocol itself
+    };
+
+    //! Traffic of one connection
+    struct ConnectionStats {
+        uint64_t bytes_in{0};
+        uint64_t bytes_out{0};
+        size_t queued_bytes{0};  //!< sent but not yet taken by the socket
+    };
+
+    StratumEventLoop();
+    ~StratumEventLoop();
+
+    StratumEventLoop(const StratumEventLoop&) = delete;
+    StratumEventLoop& operator=(const StratumEventLoop&) = delete;
+
+    /** Spawn the I/O threads. */
+    bool Start(int num_threads, const std::string& thread_prefix,
+               AcceptFn on_accept, LineFn on_line, CloseFn on_close);
+
+    /** Stop the I/O threads and close every connection (listeners stay open). */
+    void Stop();
+
+    bool IsRunning() const { return m_running.load(); }
+
+    /** Register a bound and listening socket. The caller keeps ownership of the fd. */
+    bool AddListener(int listen_fd, int listener_id, Framing framing = Framing::LINES);
+
+    /**
+     * Queue data for a connection. Written immediately when possible,
+     * otherwise buffered until the socket becomes writable.
+     * @return false if the connection is unknown or already closed
+     */
+    bool Send(int conn_id, const std::string& data);
+
+    /**
+     * Queue a shared buffer without copying it. Used to fan one serialized
+     * job notification out to every subscriber; the buffer is released once
+     * the last connection has written it.
+     */
+    bool Send(int conn_id, SharedPayload payload);
+
+    /**
+     * Close a connection on behalf of the server. Does not invoke the close
+     * callback. The socket is shut down at once; its descriptor is closed by
+     * the owning I/O thread.
+     */
+    void Close(int conn_id);
+
+    size_t GetConnectionCount() const;
+    /** @return false if the connection is unknown or already closed */
+    bool GetConnectionStats(int conn_id, ConnectionStats& stats) const;
+    int GetThreadCount() const { return static_cast<int>(m_workers.size()); }
+
+    /** Name of the readiness backend compiled in ("epoll", "kqueue" or "poll"). */
+    static const char* BackendName();
+
+    class Poller;
+
+private:
+    struct Connection;
+    struct Worker;
+
+    void WorkerThread(size_t index);
+    struct Listener {
+        int fd;
+        int id;
+        Framing framing;
+    };
+
+    void HandleAccept(Worker& worker, const Listener& listener);
+    void HandleReadable(Worker& worker, const std::shared_ptr<Connection>& conn);
+    void HandleWritable(Worker& worker, const std::shared_ptr<Connection>& conn);
+    bool FlushLocked(Worker& worker, Connection& conn);
+    void DropConnection(Worker& worker, const std::shared_ptr<Connection>& conn, bool notify);
+    //! Close the descriptors of connections closed by Close(), on their I/O thread
+    void ReleaseClosed(Worker& worker);
+    std::shared_ptr<Connection> FindConnection(int conn_id) const;
+
+    AcceptFn m_on_accept;
+    LineFn m_on_line;
+    CloseFn m_on_close;
+
+    std::atomic<bool> m_running{false};
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_next_worker{0};
+
+    //! Listening sockets, indexed by (-token - 1) in the poller
+    std::mutex m_listeners_mutex;
+    std::vector<Listener> m_listeners;
+
+    mutable std::mutex m_connections_mutex;
+    std::unordered_map<int, std::shared_ptr<Connection>> m_connections;
+};
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_EVENT_LOOP_H
@@ -0,0 +1,137 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/job_payload.h>
+
+#include <array>
+#include <utility>
+
+namespace stratum {
+
+static constexpr std::string_view NOTIFY_PREFIX{"{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":"};
+static constexpr std::string_view NOTIFY_SUFFIX{"}\n"};
+
+bool PreparedJob::IsDefault(std::string_view target, std::string_view blob) const
+{
+    return (m_target_pos == std::string::npos || target == m_default_target) &&
+           (m_blob_pos == std::string::npos || blob == m_default_blob);
+}
+
+std::string PreparedJob::Patch(const std::string& text, size_t base, std::string_view target, std::string_view blob) const
+{
+    struct Field {
+        size_t pos;
+        size_t old_size;
+        std::string_view value;
+    };
+    std::array<Field, 2> fields{{{m_target_pos, m_default_target.size(), target},
+                                 {m_blob_pos, m_default_blob.size(), blob}}};
+    if (fields[1].pos < fields[0].pos) std::swap(fields[0], fields[1]);
+
+    std::string out;
+    out.reserve(text.size() + target.size() + blob.size());
+    size_t done = 0;
+    for (const Field& field : fields) {
+        if (field.pos == std::string::npos) continue;
+        out.append(text, done, base + field.pos - done);
+        out.append(field.value);
+        done = base + field.pos + field.old_size;
+    }
+    out.append(text, done, std::string::npos);
+    return out;
+}
+
+std::shared_ptr<const std::string> PreparedJob::Notify(std::string_view target) const
+{
+    return Notify(target, m_default_blob);
+}
+
+std::shared_ptr<const std::string> PreparedJob::Notify(std::string_view target, std::string_view blob) const
+{
+    if (IsDefault(target, blob)) return m_notify;
+    return std::make_shared<const std::string>(Patch(*m_notify, NOTIFY_PREFIX.size(), target, blob));
+}
+
+std::string PreparedJob::JobObject(std::string_view target) const
+{
+    return JobObject(target, m_default_blob);
+}
+
+std::string PreparedJob::JobObject(std::string_view target, std::string_view blob) const
+{
+    if (IsDefault(target, blob)) return m_job_object;
+    return Patch(m_job_object, 0, target, blob);
+}
+
+void PreparedJobBuilder::Key(std::string_view key)
+{
+    if (m_object.size() > 1) m_object += ',';
+    m_object += '"';
+    m_object.append(key);
+    m_object += "\":";
+}
+
+PreparedJobBuilder& PreparedJobBuilder::Str(std::string_view key, std::string_view value)
+{
+    Key(key);
+    m_object += '"';
+    m_object.append(value);
+    m_object += '"';
+    return *this;
+}
+
+PreparedJobBuilder& PreparedJobBuilder::Num(std::string_view key, uint64_t value)
+{
+    Key(key);
+    m_object += std::to_string(value);
+    return *this;
+}
+
+PreparedJobBuilder& PreparedJobBuilder::Target(std::string_view value)
+{
+    Key("target");
+    m_object += '"';
+    m_target_pos = m_object.size();
+    m_target.assign(value);
+    m_object.append(value);
+    m_object += '"';
+    return *this;
+}
+
+PreparedJobBuilder& PreparedJobBuilder::Blob(std::string_view value)
+{
+    Key("blob");
+    m_object += '"';
+    m_blob_pos = m_object.size();
+    m_blob.assign(value);
+    m_object.append(value);
+    m_object += '"';
+    return *this;
+}
+
+std::shared_ptr<const PreparedJob> PreparedJobBuilder::Build()
+{
+    auto job = std::make_shared<PreparedJob>();
+    job->m_job_object = std::move(m_object) + "}";
+    job->m_default_target = std::move(m_target);
+    job->m_target_pos = m_target_pos;
+    job->m_default_blob = std::move(m_blob);
+    job->m_blob_pos = m_blob_pos;
+
+    std::string notify;
+    notify.reserve(NOTIFY_PREFIX.size() + job->m_job_object.size() + NOTIFY_SUFFIX.size());
+    notify.append(NOTIFY_PREFIX);
+    notify.append(job->m_job_object);
+    notify.append(NOTIFY_SUFFIX);
+    job->m_notify = std::make_shared<const std::string>(std::move(notify));
+
+    m_object = "{";
+    m_target.clear();
+    m_target_pos = std::string::npos;
+    m_blob.clear();
+    m_blob_pos = std::string::npos;
+    return job;
+}
+
+} // namespace stratum
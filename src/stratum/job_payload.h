@@ -0,0 +1,85 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_JOB_PAYLOAD_H
+#define WATTX_STRATUM_JOB_PAYLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace stratum {
+
+/**
+ * A mining job serialized once and shared by every subscriber.
+ *
+ * Holds the JSON job object and the complete "job" notification line built
+ * from it. The notification is an immutable refcounted buffer that can be
+ * queued on any number of connections. Per-client fields (the share
+ * target and, for servers giving each connection its own extranonce, the
+ * blob) are patched into a copy only for clients whose value differs from
+ * the one the job was serialized with.
+ */
+class PreparedJob {
+public:
+    //! Complete "job" notification line carrying the default target
+    const std::shared_ptr<const std::string>& Notify() const { return m_notify; }
+
+    //! Notification line with @p target substituted (shares the default buffer when equal)
+    std::shared_ptr<const std::string> Notify(std::string_view target) const;
+    //! Notification line with @p target and @p blob substituted; @p blob must keep the default's length
+    std::shared_ptr<const std::string> Notify(std::string_view target, std::string_view blob) const;
+
+    //! JSON job object for embedding in login/getjob responses
+    const std::string& JobObject() const { return m_job_object; }
+    std::string JobObject(std::string_view target) const;
+    std::string JobObject(std::string_view target, std::string_view blob) const;
+
+    const std::string& DefaultTarget() const { return m_default_target; }
+    const std::string& DefaultBlob() const { return m_default_blob; }
+
+private:
+    friend class PreparedJobBuilder;
+
+    bool IsDefault(std::string_view target, std::string_view blob) const;
+    std::string Patch(const std::string& text, size_t base, std::string_view target, std::string_view blob) const;
+
+    std::string m_job_object;
+    std::shared_ptr<const std::string> m_notify;
+    std::string m_default_target;
+    size_t m_target_pos{std::string::npos};  //!< offset of the target value in m_job_object
+    std::string m_default_blob;
+    size_t m_blob_pos{std::string::npos};    //!< offset of the blob value in m_job_object
+};
+
+/**
+ * Streams the fields of a job object. Values are emitted verbatim; callers
+ * pass hex strings and integers, which never need JSON escaping.
+ */
+class PreparedJobBuilder {
+public:
+    PreparedJobBuilder& Str(std::string_view key, std::string_view value);
+    PreparedJobBuilder& Num(std::string_view key, uint64_t value);
+    //! The share target, patchable per client
+    PreparedJobBuilder& Target(std::string_view value);
+    //! The hashing blob, patchable per client with one of the same length
+    PreparedJobBuilder& Blob(std::string_view value);
+
+    std::shared_ptr<const PreparedJob> Build();
+
+private:
+    void Key(std::string_view key);
+
+    std::string m_object{"{"};
+    std::string m_target;
+    size_t m_target_pos{std::string::npos};
+    std::string m_blob;
+    size_t m_blob_pos{std::string::npos};
+};
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_JOB_PAYLOAD_H
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <stratum/merged_stratum.h>
+#include <anchor/anchor_aggregator.h>
 #include <anchor/evm_anchor.h>
 #include <arith_uint256.h>
 #include <auxpow/auxpow.h>
@@ -12,6 +13,8 @@
 #include <node/randomx_miner.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <stratum/rpc_client.h>
+#include <stratum/stratum_framing.h>
 #include <script/script.h>
 #include <streams.h>
 #include <util/strencodings.h>
@@ -21,7 +24,6 @@
 #include <chrono>
 #include <cstring>
 #include <iomanip>
-#include <netdb.h>
 #include <netinet/in.h>
 #include <poll.h>
 #include <sys/socket.h>
@@ -257,7 +259,7 @@ bool MergedStratumServer::Start(const MergedStratumConfig& config, interfaces::M
         return false;
     }
 
-    if (listen(m_listen_socket, 10) < 0) {
+    if (listen(m_listen_socket, SOMAXCONN) < 0) {
         LogPrintf("MergedStratum: Failed to listen\n");
         close(m_listen_socket);
         m_listen_socket = -1;
@@ -266,11 +268,31 @@ bool MergedStratumServer::Start(const MergedStratumConfig& config, interfaces::M
 
     m_running.store(true);
 
+    if (!m_io.Start(m_config.io_threads, "mstratum-io",
+                    [this](int listener_id, const std::string& peer_addr) { return OnAccept(listener_id, peer_addr); },
+                    [this](int client_id, std::string_view line) { HandleMessage(client_id, line); },
+                    [this](int client_id) { OnDisconnect(client_id); }) ||
+        !m_io.AddListener(m_listen_socket, 0) ||
+        !m_validators.Start(m_config.validation_threads, m_config.validation_queue, "mstratum-share")) {
+        LogPrintf("MergedStratum: Failed to start I/O core\n");
+        m_running.store(false);
+        m_io.Stop();
+        m_validators.Stop();
+        close(m_listen_socket);
+        m_listen_socket = -1;
+        return false;
+    }
+
     // Start threads
-    m_accept_thread = std::thread(&MergedStratumServer::AcceptThread, this);
     m_job_thread = std::thread(&MergedStratumServer::JobThread, this);
     m_monero_poller_thread = std::thread(&MergedStratumServer::MoneroPollerThread, this);
 
+    // Push notifications cut job latency after a Monero block; the poller stays as fallback
+    if (!m_config.monero_zmq_endpoint.empty()) {
+        m_monero_subscriber.Start("monero", m_config.monero_zmq_endpoint, stratum::MONERO_ZMQ_BLOCK_TOPIC,
+                                  [this] { NotifyNewMoneroBlock(); });
+    }
+
     LogPrintf("MergedStratum: Merged mining server started on port %d\n", m_config.port);
     LogPrintf("MergedStratum: Monero daemon: %s:%d\n",
               m_config.monero_daemon_host, m_config.monero_daemon_port);
@@ -284,35 +306,31 @@ void MergedStratumServer::Stop() {
     LogPrintf("MergedStratum: Stopping merged mining server...\n");
     m_running.store(false);
 
+    m_monero_subscriber.Stop();
+
     // Wake up job thread
-    m_job_cv.notify_all();
+    WakeJobThread();
+
+    // Join worker threads before tearing down connections they write to
+    if (m_job_thread.joinable()) m_job_thread.join();
+    if (m_monero_poller_thread.joinable()) m_monero_poller_thread.join();
+
+    // Drain validation before the connections its responses go to
+    m_validators.Stop();
+
+    // Stop I/O threads; this closes every client connection
+    m_io.Stop();
 
-    // Close listening socket
     if (m_listen_socket >= 0) {
         close(m_listen_socket);
         m_listen_socket = -1;
     }
 
-    // Disconnect all clients
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
-        for (auto& [id, client] : m_clients) {
-            if (client && client->socket_fd >= 0) {
-                close(client->socket_fd);
-            }
-        }
         m_clients.clear();
     }
 
-    // Join threads
-    if (m_accept_thread.joinable()) m_accept_thread.join();
-    if (m_job_thread.joinable()) m_job_thread.join();
-    if (m_monero_poller_thread.joinable()) m_monero_poller_thread.join();
-    for (auto& t : m_client_threads) {
-        if (t.joinable()) t.join();
-    }
-    m_client_threads.clear();
-
     LogPrintf("MergedStratum: Server stopped\n");
 }
 
@@ -323,11 +341,20 @@ size_t MergedStratumServer::GetClientCount() const {
 
 void MergedStratumServer::NotifyNewMoneroBlock() {
     LogPrintf("MergedStratum: New Monero block notification\n");
-    m_job_cv.notify_all();
+    WakeJobThread();
 }
 
 void MergedStratumServer::NotifyNewWattxBlock() {
     LogPrintf("MergedStratum: New WATTx block notification\n");
+    WakeJobThread();
+}
+
+void MergedStratumServer::WakeJobThread() {
+    // The flag keeps a notification that arrives mid-job from being lost
+    {
+        std::lock_guard<std::mutex> lock(m_job_cv_mutex);
+        m_job_pending = true;
+    }
     m_job_cv.notify_all();
 }
 
@@ -335,115 +362,35 @@ void MergedStratumServer::NotifyNewWattxBlock() {
 // Server Threads
 // ============================================================================
 
-void MergedStratumServer::AcceptThread() {
-    LogPrintf("MergedStratum: Accept thread started\n");
-
-    while (m_running.load()) {
-        struct pollfd pfd{};
-        pfd.fd = m_listen_socket;
-        pfd.events = POLLIN;
-
-        int ret = poll(&pfd, 1, 1000);  // 1 second timeout
-        if (ret <= 0) continue;
-
-        struct sockaddr_in client_addr{};
-        socklen_t addr_len = sizeof(client_addr);
-        int client_fd = accept(m_listen_socket, (struct sockaddr*)&client_addr, &addr_len);
-
-        if (client_fd < 0) continue;
-
-        // Create new client
-        int client_id;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-
-            if (m_clients.size() >= static_cast<size_t>(m_config.max_clients)) {
-                LogPrintf("MergedStratum: Max clients reached, rejecting connection\n");
-                close(client_fd);
-                continue;
-            }
+int MergedStratumServer::OnAccept(int listener_id, const std::string& peer_addr) {
+    int client_id;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
 
-            client_id = m_next_client_id++;
-            auto client = std::make_unique<MergedClient>();
-            client->socket_fd = client_fd;
-            client->session_id = GenerateSessionId();
-            client->connect_time = GetTime();
-            client->last_activity = GetTime();
-            m_clients[client_id] = std::move(client);
+        if (m_clients.size() >= static_cast<size_t>(m_config.max_clients)) {
+            LogPrintf("MergedStratum: Max clients reached, rejecting connection\n");
+            return -1;
         }
 
-        // Start client handler thread
-        m_client_threads.emplace_back(&MergedStratumServer::ClientThread, this, client_id);
-
-        LogPrintf("MergedStratum: Client %d connected\n", client_id);
+        client_id = m_next_client_id++;
+        auto client = std::make_unique<MergedClient>();
+        client->peer_address = peer_addr;
+        client->session_id = GenerateSessionId();
+        client->connect_time = GetTime();
+        client->last_activity = GetTime();
+        client->vardiff.Init(m_config.vardiff, m_config.share_difficulty, client->connect_time);
+        m_clients[client_id] = std::move(client);
     }
 
-    LogPrintf("MergedStratum: Accept thread stopped\n");
+    LogPrintf("MergedStratum: Client %d connected\n", client_id);
+    return client_id;
 }
 
-void MergedStratumServer::ClientThread(int client_id) {
-    char buffer[4096];
-
-    while (m_running.load()) {
-        int socket_fd;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it == m_clients.end() || !it->second) {
-                break;
-            }
-            socket_fd = it->second->socket_fd;
-        }
-
-        struct pollfd pfd{};
-        pfd.fd = socket_fd;
-        pfd.events = POLLIN;
-
-        int ret = poll(&pfd, 1, 1000);
-        if (ret < 0) break;
-        if (ret == 0) continue;
-
-        ssize_t bytes = recv(socket_fd, buffer, sizeof(buffer) - 1, 0);
-        if (bytes <= 0) {
-            break;
-        }
-
-        buffer[bytes] = '\0';
-
-        // Add to receive buffer and process complete messages
-        std::string messages;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it == m_clients.end() || !it->second) break;
-
-            it->second->recv_buffer += buffer;
-            it->second->last_activity = GetTime();
-            messages = it->second->recv_buffer;
-        }
-
-        // Process complete JSON-RPC messages (newline delimited)
-        size_t pos = 0;
-        while ((pos = messages.find('\n')) != std::string::npos) {
-            std::string message = messages.substr(0, pos);
-            messages = messages.substr(pos + 1);
-
-            if (!message.empty()) {
-                HandleMessage(client_id, message);
-            }
-        }
-
-        // Store remaining buffer
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it != m_clients.end() && it->second) {
-                it->second->recv_buffer = messages;
-            }
-        }
+void MergedStratumServer::OnDisconnect(int client_id) {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    if (m_clients.erase(client_id)) {
+        LogPrintf("MergedStratum: Client %d disconnected\n", client_id);
     }
-
-    DisconnectClient(client_id);
 }
 
 void MergedStratumServer::JobThread() {
@@ -455,7 +402,9 @@ void MergedStratumServer::JobThread() {
 
         // Wait for notification or timeout
         std::unique_lock<std::mutex> lock(m_job_cv_mutex);
-        m_job_cv.wait_for(lock, std::chrono::seconds(m_config.job_timeout_seconds));
+        m_job_cv.wait_for(lock, std::chrono::seconds(m_config.job_timeout_seconds),
+                          [this] { return m_job_pending || !m_running.load(); });
+        m_job_pending = false;
     }
 
     LogPrintf("MergedStratum: Job thread stopped\n");
@@ -484,7 +433,7 @@ void MergedStratumServer::MoneroPollerThread() {
                 m_monero_difficulty = difficulty;
 
                 // Trigger new job creation
-                m_job_cv.notify_all();
+                WakeJobThread();
             }
         }
 
@@ -499,7 +448,22 @@ void MergedStratumServer::MoneroPollerThread() {
 // Protocol Handlers (XMRig JSON-RPC style)
 // ============================================================================
 
-void MergedStratumServer::HandleMessage(int client_id, const std::string& message) {
+void MergedStratumServer::HandleMessage(int client_id, std::string_view raw_message) {
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end() || !it->second) return;
+        it->second->last_activity = GetTime();
+    }
+    // Fast path: share submissions are parsed in place without allocating
+    stratum::StratumSubmitView submit;
+    if (stratum::ParseStratumSubmit(raw_message, submit)) {
+        ProcessSubmit(client_id, submit.id, submit.job_id, submit.nonce, submit.result);
+        return;
+    }
+
+    std::string message(raw_message);
+
     // Parse JSON-RPC method
     std::string method = ParseJsonString(message, "method");
     std::string id = ParseJsonString(message, "id");
@@ -608,18 +572,20 @@ void MergedStratumServer::HandleLogin(int client_id, const std::string& id,
               client_id, xmr_address.substr(0, 16), wtx_address.substr(0, 16), worker);
 
     // Send login response with first job
-    MergedJob job;
+    std::shared_ptr<const MergedJob> job;
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
         job = m_current_job;
     }
 
     std::string session_id;
+    uint64_t difficulty = m_config.share_difficulty;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
         if (it != m_clients.end() && it->second) {
             session_id = it->second->session_id;
+            difficulty = it->second->vardiff.Difficulty();
         }
     }
 
@@ -627,13 +593,9 @@ void MergedStratumServer::HandleLogin(int client_id, const std::string& id,
     std::ostringstream oss;
     oss << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"result\":{";
     oss << "\"id\":\"" << session_id << "\",";
-    oss << "\"job\":{";
-    oss << "\"blob\":\"" << job.monero_blob << "\",";
-    oss << "\"job_id\":\"" << job.job_id << "\",";
-    oss << "\"target\":\"" << job.monero_target.GetHex().substr(0, 8) << "\",";
-    oss << "\"height\":" << job.monero_height << ",";
-    oss << "\"seed_hash\":\"" << job.monero_seed_hash << "\"";
-    oss << "},";
+    oss << "\"job\":"
+        << (job && job->prepared ? job->prepared->JobObject(stratum::DifficultyToCompactTarget(difficulty)) : "null")
+        << ",";
     oss << "\"status\":\"OK\"";
     oss << "}}\n";
 
@@ -648,27 +610,36 @@ void MergedStratumServer::HandleSubmit(int client_id, const std::string& id,
         return;
     }
 
-    std::string job_id = params[0];
-    std::string nonce = params[1];
-    std::string result = params[2];
+    ProcessSubmit(client_id, id, params[0], params[1], params[2]);
+}
 
-    bool valid = ValidateShare(client_id, job_id, nonce, result);
+void MergedStratumServer::ProcessSubmit(int client_id, std::string_view id, std::string_view job_id,
+                                        std::string_view nonce, std::string_view result) {
+    // The views point into the receive buffer; the task needs its own copies
+    bool queued = m_validators.Submit([this, client_id, id = std::string{id}, job_id = std::string{job_id},
+                                       nonce = std::string{nonce}, result = std::string{result}] {
+        bool valid = ValidateShare(client_id, job_id, nonce, result);
 
-    if (valid) {
-        SendResult(client_id, id, "{\"status\":\"OK\"}");
-    } else {
-        SendError(client_id, id, -1, "Invalid share");
+        if (valid) {
+            SendResult(client_id, id, "{\"status\":\"OK\"}");
+        } else {
+            SendError(client_id, id, -1, "Invalid share");
+        }
+    });
+
+    if (!queued) {
+        SendError(client_id, id, -1, "Server busy");
     }
 }
 
 void MergedStratumServer::HandleGetJob(int client_id, const std::string& id) {
-    MergedJob job;
+    std::shared_ptr<const MergedJob> job;
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
         job = m_current_job;
     }
 
-    SendJob(client_id, job);
+    if (job) SendJob(client_id, *job);
 }
 
 // ============================================================================
@@ -682,7 +653,7 @@ void MergedStratumServer::CreateMergedJob() {
 
     // Get WATTx template first (needed for merge mining commitment)
     if (m_wattx_mining) {
-        job.wattx_template = m_wattx_mining->createNewBlock();
+        job.wattx_template = m_wattx_mining->createNewBlock({.incremental = true});
         if (job.wattx_template) {
             auto header = job.wattx_template->getBlockHeader();
             // Get height from tip + 1 (new block being mined)
@@ -755,8 +726,18 @@ void MergedStratumServer::CreateMergedJob() {
             block.nTime
         );
 
-        // Build the anchor tag for Monero coinbase extra
-        job.evm_anchor_tag = anchor_mgr.BuildAnchorTag(job.evm_anchor);
+        // Build the anchor tag for Monero coinbase extra. When block anchors
+        // are aggregated, carry the root of the last closed window instead;
+        // the anchor of each block found joins the open window.
+        auto& aggregator = evm_anchor::GetAnchorAggregator();
+        if (aggregator.GetOptions().aggregate_block_anchors) {
+            aggregator.Poll(job.created_at);
+            if (auto aggregate = aggregator.GetLastAggregate()) {
+                job.evm_anchor_tag = evm_anchor::AnchorAggregator::BuildAggregateTag(*aggregate);
+            }
+        } else {
+            job.evm_anchor_tag = anchor_mgr.BuildAnchorTag(job.evm_anchor);
+        }
 
         LogPrintf("MergedStratum: EVM anchor created - block %d, %d EVM txs, merkle: %s\n",
                   job.evm_anchor.wattx_block_height,
@@ -925,16 +906,25 @@ void MergedStratumServer::CreateMergedJob() {
                   job.evm_anchor_tag.empty() ? "no" : "yes");
     }
 
-    // Store job
+    job.prepared = stratum::PreparedJobBuilder{}
+                       .Str("blob", job.monero_blob)
+                       .Str("job_id", job.job_id)
+                       .Target(stratum::DifficultyToCompactTarget(m_config.share_difficulty))
+                       .Num("height", job.monero_height)
+                       .Str("seed_hash", job.monero_seed_hash)
+                       .Build();
+
+    // Publish job; from here on it is shared read-only with the validators
+    auto published = std::make_shared<const MergedJob>(std::move(job));
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        m_current_job = job;
-        m_jobs[job.job_id] = job;
+        m_current_job = published;
+        m_jobs[published->job_id] = published;
 
         // Cleanup old jobs
         int64_t now = GetTime();
         for (auto it = m_jobs.begin(); it != m_jobs.end();) {
-            if (now - it->second.created_at > m_config.job_timeout_seconds * 10) {
+            if (now - it->second->created_at > m_config.job_timeout_seconds * 10) {
                 it = m_jobs.erase(it);
             } else {
                 ++it;
@@ -943,33 +933,45 @@ void MergedStratumServer::CreateMergedJob() {
     }
 
     // Broadcast to all clients
-    BroadcastJob(job);
+    BroadcastJob(*published);
 }
 
 void MergedStratumServer::BroadcastJob(const MergedJob& job) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-
-    for (const auto& [client_id, client] : m_clients) {
-        if (client && client->authorized) {
-            SendJob(client_id, job);
+    std::vector<std::pair<int, uint64_t>> clients_to_notify;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        int64_t now = GetTime();
+        for (const auto& [client_id, client] : m_clients) {
+            if (client && client->authorized) {
+                // Ease off miners that have gone quiet at their current difficulty
+                client->vardiff.CheckIdle(m_config.vardiff, now);
+                clients_to_notify.emplace_back(client_id, client->vardiff.Difficulty());
+            }
         }
     }
+
+    // Subscribers on the default difficulty share the one serialized notification
+    for (const auto& [client_id, difficulty] : clients_to_notify) {
+        SendJob(client_id, job, difficulty);
+    }
 }
 
-bool MergedStratumServer::ValidateShare(int client_id, const std::string& job_id,
-                                         const std::string& nonce, const std::string& result) {
+std::shared_ptr<const MergedJob> MergedStratumServer::FindJob(std::string_view job_id) const {
+    std::lock_guard<std::mutex> lock(m_jobs_mutex);
+    auto it = m_jobs.find(std::string{job_id});
+    return it == m_jobs.end() ? nullptr : it->second;
+}
+
+bool MergedStratumServer::ValidateShare(int client_id, std::string_view job_id,
+                                        std::string_view nonce, std::string_view result) {
     // Find the job
-    MergedJob job;
-    {
-        std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        auto it = m_jobs.find(job_id);
-        if (it == m_jobs.end()) {
-            LogPrintf("MergedStratum: Client %d submitted for unknown job %s\n",
-                      client_id, job_id);
-            return false;
-        }
-        job = it->second;
+    std::shared_ptr<const MergedJob> job_ref = FindJob(job_id);
+    if (!job_ref) {
+        LogPrintf("MergedStratum: Client %d submitted for unknown job %s\n",
+                  client_id, job_id);
+        return false;
     }
+    const MergedJob& job = *job_ref;
 
     // Decode the submitted hash
     std::vector<uint8_t> result_bytes = ParseHex(result);
@@ -984,12 +986,17 @@ bool MergedStratumServer::ValidateShare(int client_id, const std::string& job_id
     // Convert to arith for comparison
     arith_uint256 hash_arith = UintToArith256(submitted_hash);
 
-    // Calculate share target (easier than network target for tracking)
-    arith_uint256 share_target = arith_uint256().SetCompact(0x1d00ffff);
-    share_target /= m_config.share_difficulty;
+    // Share difficulty is tuned per connection
+    uint64_t share_difficulty;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end() || !it->second) return false;
+        share_difficulty = it->second->vardiff.AcceptDifficulty(GetTime());
+    }
 
     // Check if meets share difficulty
-    if (hash_arith > share_target) {
+    if (!stratum::HashMeetsDifficulty(submitted_hash, share_difficulty)) {
         LogPrintf("MergedStratum: Share from client %d doesn't meet share target\n", client_id);
         {
             std::lock_guard<std::mutex> lock(m_clients_mutex);
@@ -1010,10 +1017,14 @@ bool MergedStratumServer::ValidateShare(int client_id, const std::string& job_id
     bool meets_wtx_target = (hash_arith <= wtx_target);
 
     // Update statistics
+    bool retargeted = false;
+    uint64_t next_difficulty = share_difficulty;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
         if (it != m_clients.end() && it->second) {
+            retargeted = it->second->vardiff.RecordShare(m_config.vardiff, GetTime());
+            next_difficulty = it->second->vardiff.Difficulty();
             if (meets_xmr_target) {
                 it->second->xmr_shares_accepted++;
                 m_total_xmr_shares++;
@@ -1027,6 +1038,17 @@ bool MergedStratumServer::ValidateShare(int client_id, const std::string& job_id
         }
     }
 
+    // A new target only takes effect with a new job
+    if (retargeted) {
+        std::shared_ptr<const MergedJob> current;
+        {
+            std::lock_guard<std::mutex> lock(m_jobs_mutex);
+            current = m_current_job;
+        }
+        LogPrintf("MergedStratum: Client %d difficulty retargeted to %lu\n", client_id, next_difficulty);
+        if (current) SendJob(client_id, *current, next_difficulty);
+    }
+
     // If meets Monero target, submit to Monero
     if (meets_xmr_target && !job.monero_blob.empty()) {
         // Inject nonce into blob and submit
@@ -1053,7 +1075,12 @@ bool MergedStratumServer::ValidateShare(int client_id, const std::string& job_id
         LogPrintf("MergedStratum: CLIENT %d FOUND WATTX BLOCK! Constructing AuxPoW proof...\n", client_id);
 
         // Construct and submit the AuxPoW block
-        bool block_submitted = ConstructAndSubmitAuxPowBlock(client_id, job, nonce, result);
+        bool block_submitted = ConstructAndSubmitAuxPowBlock(client_id, job, std::string{nonce}, std::string{result});
+
+        auto& aggregator = evm_anchor::GetAnchorAggregator();
+        if (block_submitted && job.evm_anchor.IsValid() && aggregator.GetOptions().aggregate_block_anchors) {
+            aggregator.Add(job.evm_anchor.GetHash(), GetTime());
+        }
 
         {
             std::lock_guard<std::mutex> lock(m_clients_mutex);
@@ -1089,7 +1116,7 @@ bool MergedStratumServer::ValidateShare(int client_id, const std::string& job_id
         }
 
         if (!share.miner_address.empty()) {
-            share.shares = 1;  // Could weight by share difficulty
+            share.shares = share_difficulty;  // Weighted so miners on any difficulty score alike
             share.xmr_valid = meets_xmr_target;
             share.wtx_valid = meets_wtx_target;
             share.monero_height = job.monero_height;
@@ -1172,20 +1199,16 @@ bool MergedStratumServer::SubmitMoneroBlock(const std::string& blob) {
 // ============================================================================
 
 void MergedStratumServer::SendToClient(int client_id, const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-    auto it = m_clients.find(client_id);
-    if (it == m_clients.end() || !it->second) return;
-
-    send(it->second->socket_fd, message.c_str(), message.length(), MSG_NOSIGNAL);
+    m_io.Send(client_id, message);
 }
 
-void MergedStratumServer::SendResult(int client_id, const std::string& id, const std::string& result) {
+void MergedStratumServer::SendResult(int client_id, std::string_view id, const std::string& result) {
     std::ostringstream oss;
     oss << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"error\":null,\"result\":" << result << "}\n";
     SendToClient(client_id, oss.str());
 }
 
-void MergedStratumServer::SendError(int client_id, const std::string& id, int code, const std::string& msg) {
+void MergedStratumServer::SendError(int client_id, std::string_view id, int code, const std::string& msg) {
     std::ostringstream oss;
     oss << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"error\":{\"code\":" << code
         << ",\"message\":\"" << JsonEscape(msg) << "\"},\"result\":null}\n";
@@ -1193,27 +1216,28 @@ void MergedStratumServer::SendError(int client_id, const std::string& id, int co
 }
 
 void MergedStratumServer::SendJob(int client_id, const MergedJob& job) {
-    std::ostringstream oss;
-    oss << "{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":{";
-    oss << "\"blob\":\"" << job.monero_blob << "\",";
-    oss << "\"job_id\":\"" << job.job_id << "\",";
-    oss << "\"target\":\"" << job.monero_target.GetHex().substr(0, 8) << "\",";
-    oss << "\"height\":" << job.monero_height << ",";
-    oss << "\"seed_hash\":\"" << job.monero_seed_hash << "\"";
-    oss << "}}\n";
-    SendToClient(client_id, oss.str());
+    uint64_t difficulty;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end() || !it->second) return;
+        difficulty = it->second->vardiff.Difficulty();
+    }
+    SendJob(client_id, job, difficulty);
+}
+
+void MergedStratumServer::SendJob(int client_id, const MergedJob& job, uint64_t difficulty) {
+    if (!job.prepared) return;
+    m_io.Send(client_id, job.prepared->Notify(stratum::DifficultyToCompactTarget(difficulty)));
 }
 
 void MergedStratumServer::DisconnectClient(int client_id) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-    auto it = m_clients.find(client_id);
-    if (it != m_clients.end()) {
-        if (it->second && it->second->socket_fd >= 0) {
-            close(it->second->socket_fd);
-        }
-        m_clients.erase(it);
-        LogPrintf("MergedStratum: Client %d disconnected\n", client_id);
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        if (m_clients.erase(client_id) == 0) return;
     }
+    m_io.Close(client_id);
+    LogPrintf("MergedStratum: Client %d disconnected\n", client_id);
 }
 
 // ============================================================================
@@ -1235,66 +1259,7 @@ std::string MergedStratumServer::GenerateSessionId() {
 
 std::string MergedStratumServer::HttpPost(const std::string& host, uint16_t port,
                                            const std::string& path, const std::string& body) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) return "";
-
-    // Set timeout
-    struct timeval tv;
-    tv.tv_sec = 5;
-    tv.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-    struct sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-
-    // Resolve hostname
-    struct hostent* he = gethostbyname(host.c_str());
-    if (!he) {
-        close(sock);
-        return "";
-    }
-    std::memcpy(&addr.sin_addr, he->h_addr, he->h_length);
-
-    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(sock);
-        return "";
-    }
-
-    // Build HTTP request
-    std::ostringstream request;
-    request << "POST " << path << " HTTP/1.1\r\n";
-    request << "Host: " << host << ":" << port << "\r\n";
-    request << "Content-Type: application/json\r\n";
-    request << "Content-Length: " << body.length() << "\r\n";
-    request << "Connection: close\r\n\r\n";
-    request << body;
-
-    std::string req_str = request.str();
-    if (send(sock, req_str.c_str(), req_str.length(), 0) < 0) {
-        close(sock);
-        return "";
-    }
-
-    // Read response
-    std::string response;
-    char buffer[4096];
-    ssize_t bytes;
-    while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes] = '\0';
-        response += buffer;
-    }
-
-    close(sock);
-
-    // Extract body (skip headers)
-    size_t body_start = response.find("\r\n\r\n");
-    if (body_start != std::string::npos) {
-        return response.substr(body_start + 4);
-    }
-
-    return response;
+    return stratum::GetRpcClient(host, port)->Post(path, body, 5);
 }
 
 // ============================================================================
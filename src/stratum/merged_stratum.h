@@ -7,13 +7,19 @@
 
 #include <anchor/evm_anchor.h>
 #include <auxpow/auxpow.h>
+#include <stratum/event_loop.h>
+#include <stratum/job_payload.h>
 #include <stratum/mining_rewards.h>
+#include <stratum/parent_notify.h>
+#include <stratum/share_validation.h>
+#include <stratum/vardiff.h>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -33,18 +39,23 @@ struct MergedStratumConfig {
     std::string bind_address = "0.0.0.0";
     uint16_t port = 3337;
     int max_clients = 1000;
+    int io_threads = stratum::DEFAULT_STRATUM_IO_THREADS;
+    int validation_threads = stratum::DEFAULT_SHARE_VALIDATION_THREADS;
+    size_t validation_queue = stratum::DEFAULT_SHARE_VALIDATION_QUEUE;
 
     // Monero node connection
     std::string monero_daemon_host = "127.0.0.1";
     uint16_t monero_daemon_port = 18081;
     std::string monero_wallet_address;
+    std::string monero_zmq_endpoint;    // monerod --zmq-pub address; empty to rely on polling
 
     // WATTx settings
     std::string wattx_wallet_address;
 
     // Pool settings
     int job_timeout_seconds = 60;
-    uint64_t share_difficulty = 10000;  // Easy share target for tracking
+    uint64_t share_difficulty = 10000;  // Starting share difficulty for each connection
+    stratum::VardiffConfig vardiff;     // Per-connection difficulty tuning
     double pool_fee_percent = 1.0;
 };
 
@@ -104,13 +115,16 @@ struct MergedJob {
     std::vector<uint8_t> evm_anchor_tag;  // Serialized anchor for Monero extra
 
     int64_t created_at{0};
+
+    // Notification serialized once when the job is created
+    std::shared_ptr<const stratum::PreparedJob> prepared;
 };
 
 /**
  * Connected miner client
  */
 struct MergedClient {
-    int socket_fd;
+    std::string peer_address;
     std::string session_id;
     std::string worker_name;
     std::string xmr_address;
@@ -128,10 +142,10 @@ struct MergedClient {
 
     int64_t connect_time;
     int64_t last_activity;
-    std::string recv_buffer;
+    stratum::VardiffState vardiff;
 
     MergedClient()
-        : socket_fd(-1), authorized(false), subscribed(false),
+        : authorized(false), subscribed(false),
           xmr_shares_accepted(0), wtx_shares_accepted(0), shares_rejected(0),
           xmr_blocks_found(0), wtx_blocks_found(0),
           connect_time(0), last_activity(0) {}
@@ -179,25 +193,31 @@ public:
     void NotifyNewWattxBlock();
 
 private:
+    // Event loop callbacks (run on I/O threads)
+    int OnAccept(int listener_id, const std::string& peer_addr);
+    void OnDisconnect(int client_id);
+
     // Server threads
-    void AcceptThread();
-    void ClientThread(int client_id);
     void JobThread();
+    void WakeJobThread();
     void MoneroPollerThread();
 
     // Protocol handlers
-    void HandleMessage(int client_id, const std::string& message);
+    void HandleMessage(int client_id, std::string_view message);
     void HandleLogin(int client_id, const std::string& id,
                      const std::vector<std::string>& params);
     void HandleSubmit(int client_id, const std::string& id,
                       const std::vector<std::string>& params);
+    void ProcessSubmit(int client_id, std::string_view id, std::string_view job_id,
+                       std::string_view nonce, std::string_view result);
     void HandleGetJob(int client_id, const std::string& id);
 
     // Job management
     void CreateMergedJob();
     void BroadcastJob(const MergedJob& job);
-    bool ValidateShare(int client_id, const std::string& job_id,
-                       const std::string& nonce, const std::string& result);
+    std::shared_ptr<const MergedJob> FindJob(std::string_view job_id) const;
+    bool ValidateShare(int client_id, std::string_view job_id,
+                       std::string_view nonce, std::string_view result);
 
     // Monero daemon communication
     bool GetMoneroBlockTemplate(std::string& blob, std::string& seed_hash,
@@ -213,9 +233,10 @@ private:
 
     // Network helpers
     void SendToClient(int client_id, const std::string& message);
-    void SendResult(int client_id, const std::string& id, const std::string& result);
-    void SendError(int client_id, const std::string& id, int code, const std::string& msg);
+    void SendResult(int client_id, std::string_view id, const std::string& result);
+    void SendError(int client_id, std::string_view id, int code, const std::string& msg);
     void SendJob(int client_id, const MergedJob& job);
+    void SendJob(int client_id, const MergedJob& job, uint64_t difficulty);
     void DisconnectClient(int client_id);
 
     // Utility
@@ -233,20 +254,21 @@ private:
     int m_listen_socket{-1};
 
     // Threads
-    std::thread m_accept_thread;
+    stratum::StratumEventLoop m_io;
+    stratum::ShareValidationPool m_validators;
     std::thread m_job_thread;
     std::thread m_monero_poller_thread;
-    std::vector<std::thread> m_client_threads;
+    stratum::ParentBlockSubscriber m_monero_subscriber;
 
     // Clients
     mutable std::mutex m_clients_mutex;
     std::unordered_map<int, std::unique_ptr<MergedClient>> m_clients;
     int m_next_client_id{0};
 
-    // Jobs
+    // Jobs are immutable once published; lookups only copy the pointer
     mutable std::mutex m_jobs_mutex;
-    std::unordered_map<std::string, MergedJob> m_jobs;
-    MergedJob m_current_job;
+    std::unordered_map<std::string, std::shared_ptr<const MergedJob>> m_jobs;
+    std::shared_ptr<const MergedJob> m_current_job;
     std::atomic<uint64_t> m_job_counter{0};
 
     // Current Monero state
@@ -265,6 +287,7 @@ private:
     // Synchronization
     std::condition_variable m_job_cv;
     std::mutex m_job_cv_mutex;
+    bool m_job_pending{false};  // guarded by m_job_cv_mutex; set when a new block needs a refresh
 };
 
 /**
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <stratum/mining_rewards.h>
+#include <stratum/rpc_client.h>
 #include <logging.h>
 #include <util/strencodings.h>
 #include <util/time.h>
@@ -10,11 +11,7 @@
 #include <algorithm>
 #include <cstring>
 #include <iomanip>
-#include <netdb.h>
-#include <netinet/in.h>
 #include <sstream>
-#include <sys/socket.h>
-#include <unistd.h>
 
 namespace mining_rewards {
 
@@ -32,8 +29,8 @@ MiningRewardsManager& GetMiningRewardsManager() {
 // Contract Function Selectors (keccak256 of function signature, first 4 bytes)
 // ============================================================================
 
-// submitShares(address,uint256,bool,bool,uint256,uint256)
-static const std::string SUBMIT_SHARES_SELECTOR = "0x8e7ea5b2";
+// submitSharesBatch((address,uint256,uint8)[],uint256,uint256)
+static const std::string SUBMIT_SHARES_BATCH_SELECTOR = "0xa10f60d4";
 
 // finalizeBlock()
 static const std::string FINALIZE_BLOCK_SELECTOR = "0x4bb278f3";
@@ -100,7 +97,7 @@ void MiningRewardsManager::Stop() {
     m_running.store(false);
 
     // Wake up thread
-    m_cv.notify_all();
+    WakeSubmissionThread();
     m_block_cv.notify_all();
 
     if (m_submission_thread.joinable()) {
@@ -110,22 +107,45 @@ void MiningRewardsManager::Stop() {
     LogPrintf("MiningRewards: Stopped\n");
 }
 
+void MiningRewardsManager::WakeSubmissionThread() {
+    {
+        std::lock_guard<std::mutex> lock(m_cv_mutex);
+        m_wake = true;
+    }
+    m_cv.notify_one();
+}
+
 void MiningRewardsManager::QueueShare(const ShareSubmission& share) {
     if (!m_running.load()) return;
 
+    uint8_t coin = (share.xmr_valid ? SHARE_COIN_XMR : 0) | (share.wtx_valid ? SHARE_COIN_WTX : 0);
+    size_t entries;
     {
         std::lock_guard<std::mutex> lock(m_queue_mutex);
-        m_share_queue.push(share);
+        auto& entry = m_pending[{share.miner_address, coin}];
+        if (entry.share_count == 0) {
+            entry.miner_address = share.miner_address;
+            entry.coin = coin;
+        }
+        entry.difficulty += share.shares;
+        entry.share_count++;
+
+        if (m_pending_shares++ == 0 || share.timestamp < m_oldest_pending) {
+            m_oldest_pending = share.timestamp;
+        }
+        m_pending_monero_height = std::max(m_pending_monero_height, share.monero_height);
+        m_pending_wattx_height = std::max(m_pending_wattx_height, share.wattx_height);
+        entries = m_pending.size();
     }
 
-    // Wake up thread if batch size reached
-    if (GetPendingShareCount() >= static_cast<size_t>(m_config.max_batch_size)) {
-        m_cv.notify_one();
+    // Wake up thread once a full transaction's worth of entries is waiting
+    if (entries >= static_cast<size_t>(m_config.max_batch_size)) {
+        WakeSubmissionThread();
     }
 }
 
 void MiningRewardsManager::FlushPendingShares() {
-    m_cv.notify_one();
+    WakeSubmissionThread();
 }
 
 void MiningRewardsManager::NotifyBlockFound(uint64_t moneroHeight, uint64_t wattxHeight) {
@@ -136,62 +156,67 @@ void MiningRewardsManager::NotifyBlockFound(uint64_t moneroHeight, uint64_t watt
         m_last_wattx_height = wattxHeight;
     }
 
+    // The round's shares are flushed before it is finalized
     m_block_cv.notify_one();
+    WakeSubmissionThread();
 }
 
 size_t MiningRewardsManager::GetPendingShareCount() const {
     std::lock_guard<std::mutex> lock(m_queue_mutex);
-    return m_share_queue.size();
+    return m_pending_shares;
 }
 
 void MiningRewardsManager::SubmissionThread() {
     LogPrintf("MiningRewards: Submission thread started\n");
 
+    // After a failed flush nothing is retried for one batch interval
+    int64_t retry_after = 0;
+
     while (m_running.load()) {
-        // Wait for batch interval or wake signal
+        // Sleep until the oldest pending share reaches the batch age, unless woken by
+        // a full batch, a found block or an explicit flush
+        int64_t wait_seconds = m_config.batch_interval_seconds;
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            if (m_pending_shares > 0) {
+                wait_seconds = std::max<int64_t>(0, m_oldest_pending + m_config.batch_interval_seconds - GetTime());
+            }
+        }
+        wait_seconds = std::max<int64_t>(wait_seconds, retry_after - GetTime());
+        bool woken;
         {
             std::unique_lock<std::mutex> lock(m_cv_mutex);
-            m_cv.wait_for(lock, std::chrono::seconds(m_config.batch_interval_seconds));
+            woken = m_cv.wait_for(lock, std::chrono::seconds(wait_seconds), [this] { return m_wake || !m_running.load(); });
+            m_wake = false;
         }
 
         if (!m_running.load()) break;
 
-        // Collect pending shares
-        std::vector<ShareSubmission> batch;
+        bool should_finalize = false;
         {
-            std::lock_guard<std::mutex> lock(m_queue_mutex);
-            while (!m_share_queue.empty() && batch.size() < static_cast<size_t>(m_config.max_batch_size)) {
-                batch.push_back(m_share_queue.front());
-                m_share_queue.pop();
-            }
+            std::lock_guard<std::mutex> lock(m_block_mutex);
+            should_finalize = m_block_found;
         }
 
-        // Submit batch
-        if (!batch.empty()) {
-            if (SubmitSharesBatch(batch)) {
-                m_total_shares_submitted += batch.size();
-                LogPrintf("MiningRewards: Submitted %zu shares to contract\n", batch.size());
-            } else {
-                // Re-queue failed shares
-                std::lock_guard<std::mutex> lock(m_queue_mutex);
-                for (const auto& share : batch) {
-                    m_share_queue.push(share);
-                }
-                LogPrintf("MiningRewards: Failed to submit shares, re-queued\n");
+        // Every wakeup has a reason to flush: a full batch, a found block or FlushPendingShares()
+        bool due = woken;
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            if (m_pending_shares > 0) {
+                due |= m_pending.size() >= static_cast<size_t>(m_config.max_batch_size);
+                due |= GetTime() - m_oldest_pending >= m_config.batch_interval_seconds;
             }
         }
+        if (due && GetTime() >= retry_after && !FlushBatches()) {
+            retry_after = GetTime() + m_config.batch_interval_seconds;
+        }
 
         // Check for block finalization
-        bool should_finalize = false;
-        {
-            std::lock_guard<std::mutex> lock(m_block_mutex);
-            if (m_block_found) {
-                should_finalize = true;
+        if (should_finalize) {
+            {
+                std::lock_guard<std::mutex> lock(m_block_mutex);
                 m_block_found = false;
             }
-        }
-
-        if (should_finalize) {
             if (FinalizeBlock()) {
                 m_total_blocks_finalized++;
                 LogPrintf("MiningRewards: Block finalized on contract\n");
@@ -202,21 +227,82 @@ void MiningRewardsManager::SubmissionThread() {
     LogPrintf("MiningRewards: Submission thread stopped\n");
 }
 
-bool MiningRewardsManager::SubmitSharesBatch(const std::vector<ShareSubmission>& shares) {
-    // Submit each share individually (could be optimized with batch contract function)
-    for (const auto& share : shares) {
-        std::string calldata = BuildSubmitSharesCalldata(share);
-        std::string txhash = SendContractTransaction(calldata, 150000);
+bool MiningRewardsManager::FlushBatches() {
+    std::vector<ShareBatchEntry> entries;
+    uint64_t monero_height, wattx_height;
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        if (m_pending.empty()) return true;
+        entries.reserve(m_pending.size());
+        for (auto& [key, entry] : m_pending) entries.push_back(std::move(entry));
+        m_pending.clear();
+        m_pending_shares = 0;
+        monero_height = m_pending_monero_height;
+        wattx_height = m_pending_wattx_height;
+    }
 
-        if (txhash.empty()) {
-            LogPrintf("MiningRewards: Failed to submit share for %s\n",
-                      share.miner_address.substr(0, 10));
+    // Entries per transaction are bounded by both the configured size and the gas ceiling
+    size_t per_tx = static_cast<size_t>(std::max(m_config.max_batch_size, 1));
+    if (m_config.max_batch_gas > BATCH_BASE_GAS + BATCH_GAS_PER_ENTRY) {
+        per_tx = std::min<size_t>(per_tx, (m_config.max_batch_gas - BATCH_BASE_GAS) / BATCH_GAS_PER_ENTRY);
+    } else {
+        per_tx = 1;
+    }
+
+    for (size_t start = 0; start < entries.size(); start += per_tx) {
+        std::vector<ShareBatchEntry> batch(entries.begin() + start,
+                                           entries.begin() + std::min(entries.size(), start + per_tx));
+        uint64_t shares = 0;
+        for (const auto& entry : batch) shares += entry.share_count;
+
+        if (!SubmitSharesBatch(batch, monero_height, wattx_height)) {
+            // Re-queue this and every later batch; they go out with the next flush
+            RequeueEntries(std::vector<ShareBatchEntry>(entries.begin() + start, entries.end()),
+                           monero_height, wattx_height);
+            LogPrintf("MiningRewards: Failed to submit shares, re-queued\n");
             return false;
         }
 
-        m_total_tx_sent++;
+        m_total_shares_submitted += shares;
+        LogPrintf("MiningRewards: Submitted %llu shares (%zu entries) to contract\n",
+                  static_cast<unsigned long long>(shares), batch.size());
+    }
+    return true;
+}
+
+void MiningRewardsManager::RequeueEntries(const std::vector<ShareBatchEntry>& entries,
+                                          uint64_t monero_height, uint64_t wattx_height) {
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    if (m_pending_shares == 0) m_oldest_pending = GetTime();
+    for (const auto& failed : entries) {
+        auto& entry = m_pending[{failed.miner_address, failed.coin}];
+        if (entry.share_count == 0) {
+            entry.miner_address = failed.miner_address;
+            entry.coin = failed.coin;
+        }
+        entry.difficulty += failed.difficulty;
+        entry.share_count += failed.share_count;
+        m_pending_shares += failed.share_count;
+    }
+    m_pending_monero_height = std::max(m_pending_monero_height, monero_height);
+    m_pending_wattx_height = std::max(m_pending_wattx_height, wattx_height);
+}
+
+bool MiningRewardsManager::SubmitSharesBatch(const std::vector<ShareBatchEntry>& entries,
+                                             uint64_t monero_height, uint64_t wattx_height) {
+    std::string calldata = BuildSubmitSharesBatchCalldata(entries, monero_height, wattx_height);
+
+    // Size the gas to the batch instead of a flat per-call allowance
+    uint64_t fallback = BATCH_BASE_GAS + BATCH_GAS_PER_ENTRY * entries.size();
+    uint64_t gas = std::min(EstimateGas(calldata, fallback), m_config.max_batch_gas);
+
+    std::string txhash = SendContractTransaction(calldata, gas);
+    if (txhash.empty()) {
+        LogPrintf("MiningRewards: Failed to submit batch of %zu entries\n", entries.size());
+        return false;
     }
 
+    m_total_tx_sent++;
     return true;
 }
 
@@ -233,19 +319,26 @@ bool MiningRewardsManager::FinalizeBlock() {
     return true;
 }
 
-std::string MiningRewardsManager::BuildSubmitSharesCalldata(const ShareSubmission& share) {
-    // submitShares(address miner, uint256 shares, bool xmrValid, bool wtxValid, uint256 moneroHeight, uint256 wattxHeight)
-    std::ostringstream ss;
-
-    ss << SUBMIT_SHARES_SELECTOR;
-    ss << EncodeAddress(share.miner_address);
-    ss << EncodeUint256(share.shares);
-    ss << EncodeBool(share.xmr_valid);
-    ss << EncodeBool(share.wtx_valid);
-    ss << EncodeUint256(share.monero_height);
-    ss << EncodeUint256(share.wattx_height);
+std::string MiningRewardsManager::BuildSubmitSharesBatchCalldata(const std::vector<ShareBatchEntry>& entries,
+                                                                 uint64_t monero_height, uint64_t wattx_height) {
+    // submitSharesBatch((address miner, uint256 difficulty, uint8 coin)[] shares, uint256 moneroHeight, uint256 wattxHeight)
+    // Head: offset of the dynamic array, then the two static arguments. The
+    // tuples are fully static, so they follow the array length inline.
+    std::string data;
+    data.reserve(SUBMIT_SHARES_BATCH_SELECTOR.size() + 64 * (4 + 3 * entries.size()));
+
+    data += SUBMIT_SHARES_BATCH_SELECTOR;
+    data += EncodeUint256(3 * 32);
+    data += EncodeUint256(monero_height);
+    data += EncodeUint256(wattx_height);
+    data += EncodeUint256(entries.size());
+    for (const auto& entry : entries) {
+        data += EncodeAddress(entry.miner_address);
+        data += EncodeUint256(entry.difficulty);
+        data += EncodeUint256(entry.coin);
+    }
 
-    return ss.str();
+    return data;
 }
 
 std::string MiningRewardsManager::BuildFinalizeBlockCalldata() {
@@ -253,6 +346,34 @@ std::string MiningRewardsManager::BuildFinalizeBlockCalldata() {
     return FINALIZE_BLOCK_SELECTOR;
 }
 
+uint64_t MiningRewardsManager::EstimateGas(const std::string& calldata, uint64_t fallback) {
+    std::ostringstream params;
+    params << "[{";
+    params << "\"from\":\"" << m_config.operator_address << "\",";
+    params << "\"to\":\"" << m_config.contract_address << "\",";
+    params << "\"data\":\"" << calldata << "\"";
+    params << "}]";
+
+    std::string response = WattxRPC("eth_estimateGas", params.str());
+
+    size_t pos = response.find("\"result\"");
+    if (pos == std::string::npos) return fallback;
+    pos = response.find("\"0x", pos);
+    if (pos == std::string::npos) return fallback;
+    size_t end = response.find('"', pos + 1);
+    if (end == std::string::npos) return fallback;
+
+    std::string hex = response.substr(pos + 3, end - pos - 3);
+    if (hex.empty() || hex.size() > 16) return fallback;
+    uint64_t gas = 0;
+    for (char c : hex) {
+        int v = HexDigit(c);
+        if (v < 0) return fallback;
+        gas = (gas << 4) | static_cast<uint64_t>(v);
+    }
+    return gas > 0 ? gas : fallback;
+}
+
 std::string MiningRewardsManager::SendContractTransaction(const std::string& calldata, uint64_t gas) {
     // Build eth_sendTransaction params
     std::ostringstream params;
@@ -304,83 +425,7 @@ std::string MiningRewardsManager::WattxRPC(const std::string& method, const std:
 std::string MiningRewardsManager::HttpPost(const std::string& host, uint16_t port,
                                             const std::string& path, const std::string& body,
                                             const std::string& auth) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) return "";
-
-    struct timeval tv;
-    tv.tv_sec = 10;
-    tv.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-    struct sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-
-    struct hostent* he = gethostbyname(host.c_str());
-    if (!he) {
-        close(sock);
-        return "";
-    }
-    std::memcpy(&addr.sin_addr, he->h_addr, he->h_length);
-
-    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        close(sock);
-        return "";
-    }
-
-    std::ostringstream request;
-    request << "POST " << path << " HTTP/1.1\r\n";
-    request << "Host: " << host << ":" << port << "\r\n";
-    request << "Content-Type: application/json\r\n";
-    request << "Content-Length: " << body.length() << "\r\n";
-
-    if (!auth.empty()) {
-        // Base64 encode auth
-        static const char* base64_chars =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        std::string encoded;
-        int val = 0, valb = -6;
-        for (unsigned char c : auth) {
-            val = (val << 8) + c;
-            valb += 8;
-            while (valb >= 0) {
-                encoded.push_back(base64_chars[(val >> valb) & 0x3F]);
-                valb -= 6;
-            }
-        }
-        if (valb > -6) encoded.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-        while (encoded.size() % 4) encoded.push_back('=');
-
-        request << "Authorization: Basic " << encoded << "\r\n";
-    }
-
-    request << "Connection: close\r\n\r\n";
-    request << body;
-
-    std::string req_str = request.str();
-    if (send(sock, req_str.c_str(), req_str.length(), 0) < 0) {
-        close(sock);
-        return "";
-    }
-
-    std::string response;
-    char buffer[4096];
-    ssize_t bytes;
-    while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes] = '\0';
-        response += buffer;
-    }
-
-    close(sock);
-
-    // Extract body
-    size_t body_start = response.find("\r\n\r\n");
-    if (body_start != std::string::npos) {
-        return response.substr(body_start + 4);
-    }
-
-    return response;
+    return stratum::GetRpcClient(host, port, auth)->Post(path, body);
 }
 
 std::string MiningRewardsManager::EncodeAddress(const std::string& address) {
@@ -8,11 +8,13 @@
 #include <uint256.h>
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <queue>
 #include <thread>
+#include <utility>
+#include <vector>
 #include <condition_variable>
 
 namespace mining_rewards {
@@ -34,8 +36,9 @@ struct MiningRewardsConfig {
     std::string operator_address;
 
     // Batch settings
-    int batch_interval_seconds = 30;     // Submit shares every N seconds
-    int max_batch_size = 100;            // Max shares per transaction
+    int batch_interval_seconds = 30;     // Flush once the oldest pending share is this old
+    int max_batch_size = 100;            // Max (miner, coin) entries per transaction; flush when reached
+    uint64_t max_batch_gas = 4000000;    // Gas ceiling for one batch transaction
 
     // Enable/disable
     bool enabled = false;
@@ -54,6 +57,26 @@ struct ShareSubmission {
     int64_t timestamp;                   // Submission time
 };
 
+//! Coin bits of a batch entry: which chain's target the shares met
+static constexpr uint8_t SHARE_COIN_XMR = 1 << 0;
+static constexpr uint8_t SHARE_COIN_WTX = 1 << 1;
+
+//! Fixed gas of a submitSharesBatch call, used when the node cannot estimate it
+static constexpr uint64_t BATCH_BASE_GAS = 60000;
+//! Gas per batch entry (one miner balance update and its event)
+static constexpr uint64_t BATCH_GAS_PER_ENTRY = 25000;
+
+/**
+ * One element of a submitSharesBatch call: all pending shares of a miner
+ * that met the same set of targets, summed by difficulty.
+ */
+struct ShareBatchEntry {
+    std::string miner_address;
+    uint64_t difficulty{0};              // Sum of share difficulties
+    uint8_t coin{0};                     // SHARE_COIN_* bits
+    uint64_t share_count{0};             // Shares folded into this entry (not encoded)
+};
+
 /**
  * Mining Rewards Manager
  * Integrates merged mining stratum with on-chain rewards contract
@@ -103,6 +126,13 @@ public:
      */
     size_t GetPendingShareCount() const;
 
+    /**
+     * Build submitSharesBatch((address,uint256,uint8)[],uint256,uint256)
+     * calldata for a set of entries and the heights they were mined at.
+     */
+    static std::string BuildSubmitSharesBatchCalldata(const std::vector<ShareBatchEntry>& entries,
+                                                      uint64_t monero_height, uint64_t wattx_height);
+
     /**
      * Get statistics
      */
@@ -119,16 +149,29 @@ private:
     // Worker thread
     void SubmissionThread();
 
-    // Submit batch of shares to contract
-    bool SubmitSharesBatch(const std::vector<ShareSubmission>& shares);
+    // Submit all pending shares, as few transactions as the size and gas limits allow
+    bool FlushBatches();
+
+    // Submit one batch of entries to contract
+    bool SubmitSharesBatch(const std::vector<ShareBatchEntry>& entries,
+                           uint64_t monero_height, uint64_t wattx_height);
+
+    // Put entries of a failed batch back into the pending set
+    void RequeueEntries(const std::vector<ShareBatchEntry>& entries,
+                        uint64_t monero_height, uint64_t wattx_height);
+
+    // Wake the submission thread before the batch interval expires
+    void WakeSubmissionThread();
 
     // Call finalizeBlock on contract
     bool FinalizeBlock();
 
     // Build contract call data
-    std::string BuildSubmitSharesCalldata(const ShareSubmission& share);
     std::string BuildFinalizeBlockCalldata();
 
+    // Ask the node for the gas a call needs, falling back to @p fallback
+    uint64_t EstimateGas(const std::string& calldata, uint64_t fallback);
+
     // Send transaction to contract
     std::string SendContractTransaction(const std::string& calldata, uint64_t gas = 200000);
 
@@ -139,13 +182,13 @@ private:
                           const std::string& auth = "");
 
     // Encode address for contract call
-    std::string EncodeAddress(const std::string& address);
+    static std::string EncodeAddress(const std::string& address);
 
     // Encode uint256 for contract call
-    std::string EncodeUint256(uint64_t value);
+    static std::string EncodeUint256(uint64_t value);
 
     // Encode bool for contract call
-    std::string EncodeBool(bool value);
+    static std::string EncodeBool(bool value);
 
     // Configuration
     MiningRewardsConfig m_config;
@@ -154,9 +197,13 @@ private:
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_initialized{false};
 
-    // Share queue
+    // Pending shares, aggregated per (miner, coin)
     mutable std::mutex m_queue_mutex;
-    std::queue<ShareSubmission> m_share_queue;
+    std::map<std::pair<std::string, uint8_t>, ShareBatchEntry> m_pending;
+    size_t m_pending_shares{0};
+    int64_t m_oldest_pending{0};         // Timestamp of the oldest pending share
+    uint64_t m_pending_monero_height{0};
+    uint64_t m_pending_wattx_height{0};
 
     // Block notification
     std::mutex m_block_mutex;
@@ -169,6 +216,7 @@ private:
     std::thread m_submission_thread;
     std::condition_variable m_cv;
     std::mutex m_cv_mutex;
+    bool m_wake{false};
 
     // Statistics
     std::atomic<uint64_t> m_total_shares_submitted{0};
@@ -8,6 +8,7 @@
 #include <hash.h>
 #include <logging.h>
 #include <random.h>
+#include <stratum/stratum_framing.h>
 #include <util/strencodings.h>
 #include <util/time.h>
 
@@ -137,6 +138,7 @@ bool MultiMergedStratumServer::Start(const MultiMergedConfig& config, interfaces
 
         // Initialize statistics
         m_total_shares[chain_config.name] = 0;
+        m_total_difficulty[chain_config.name] = 0;
         m_blocks_found[chain_config.name] = 0;
 
         LogPrintf("MultiMergedStratum: Initialized %s handler (%s)\n",
@@ -180,7 +182,7 @@ bool MultiMergedStratumServer::Start(const MultiMergedConfig& config, interfaces
             continue;
         }
 
-        if (listen(sock, 10) < 0) {
+        if (listen(sock, SOMAXCONN) < 0) {
             LogPrintf("MultiMergedStratum: Failed to listen on port %d\n", port);
             close(sock);
             continue;
@@ -200,15 +202,49 @@ bool MultiMergedStratumServer::Start(const MultiMergedConfig& config, interfaces
 
     m_running.store(true);
 
+    // One I/O core multiplexes every algorithm port
+    bool io_ok = m_io.Start(m_config.io_threads, "mmstratum-io",
+                            [this](int listener_id, const std::string& peer_addr) { return OnAccept(listener_id, peer_addr); },
+                            [this](int client_id, std::string_view line) { HandleMessage(client_id, line); },
+                            [this](int client_id) { OnDisconnect(client_id); });
+    for (const auto& [algo, sock] : m_listen_sockets) {
+        if (!io_ok) break;
+        io_ok = m_io.AddListener(sock, static_cast<int>(algo));
+    }
+    if (!io_ok) {
+        LogPrintf("MultiMergedStratum: Failed to start I/O core\n");
+        m_running.store(false);
+        m_io.Stop();
+        for (auto& [algo, sock] : m_listen_sockets) close(sock);
+        m_listen_sockets.clear();
+        return false;
+    }
+
     // Start threads
     for (const auto& [algo, sock] : m_listen_sockets) {
-        m_accept_threads.emplace_back(&MultiMergedStratumServer::AcceptThread, this, algo);
+        m_job_cvs[algo];
+        m_job_cv_mutexes[algo];
+        m_job_pending[algo] = false;
+    }
+    for (const auto& [algo, sock] : m_listen_sockets) {
         m_job_threads.emplace_back(&MultiMergedStratumServer::JobThread, this, algo);
     }
 
     // Start poller threads for each parent chain
     for (const auto& [name, handler] : m_parent_handlers) {
-        m_poller_threads.emplace_back(&MultiMergedStratumServer::ParentPollerThread, this, name);
+        // Push notifications cut job latency after a parent block; the poller stays as fallback
+        std::string chain_name = name;
+        bool pushed = handler->StartWorkWatch([this, chain_name] { NotifyNewParentBlock(chain_name); });
+        std::string zmq_endpoint = handler->GetZmqEndpoint();
+        if (!zmq_endpoint.empty()) {
+            auto subscriber = std::make_unique<stratum::ParentBlockSubscriber>();
+            if (subscriber->Start(name, zmq_endpoint, handler->GetZmqBlockTopic(),
+                                  [this, chain_name] { NotifyNewParentBlock(chain_name); })) {
+                m_block_subscribers.push_back(std::move(subscriber));
+                pushed = true;
+            }
+        }
+        m_poller_threads.emplace_back(&MultiMergedStratumServer::ParentPollerThread, this, name, pushed);
 
         // Initialize coin stats
         m_coin_stats[name] = CoinHashrateStats{};
@@ -232,11 +268,36 @@ void MultiMergedStratumServer::Stop() {
     LogPrintf("MultiMergedStratum: Stopping server...\n");
     m_running.store(false);
 
+    for (auto& subscriber : m_block_subscribers) {
+        subscriber->Stop();
+    }
+    m_block_subscribers.clear();
+    for (auto& [name, handler] : m_parent_handlers) {
+        handler->StopWorkWatch();
+    }
+
     // Wake up job threads
     for (auto& [algo, cv] : m_job_cvs) {
-        cv.notify_all();
+        WakeJobThread(algo);
+    }
+
+    // Join worker threads before tearing down connections they write to
+    for (auto& t : m_job_threads) {
+        if (t.joinable()) t.join();
+    }
+    for (auto& t : m_poller_threads) {
+        if (t.joinable()) t.join();
+    }
+    if (m_hashrate_thread.joinable()) {
+        m_hashrate_thread.join();
     }
 
+    m_job_threads.clear();
+    m_poller_threads.clear();
+
+    // Stop I/O threads; this closes every client connection
+    m_io.Stop();
+
     // Close listening sockets
     for (auto& [algo, sock] : m_listen_sockets) {
         if (sock >= 0) {
@@ -245,44 +306,29 @@ void MultiMergedStratumServer::Stop() {
     }
     m_listen_sockets.clear();
 
-    // Disconnect clients
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
-        for (auto& [id, client] : m_clients) {
-            if (client && client->socket_fd >= 0) {
-                close(client->socket_fd);
-            }
-        }
         m_clients.clear();
     }
 
-    // Join threads
-    for (auto& t : m_accept_threads) {
-        if (t.joinable()) t.join();
-    }
-    for (auto& t : m_job_threads) {
-        if (t.joinable()) t.join();
-    }
-    for (auto& t : m_poller_threads) {
-        if (t.joinable()) t.join();
-    }
-    for (auto& t : m_client_threads) {
-        if (t.joinable()) t.join();
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_current_jobs.clear();
+        m_jobs.clear();
     }
-    if (m_hashrate_thread.joinable()) {
-        m_hashrate_thread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_wattx_mutex);
+        m_wattx_template.reset();
+        m_wattx_stale = true;
     }
 
-    m_accept_threads.clear();
-    m_job_threads.clear();
-    m_poller_threads.clear();
-    m_client_threads.clear();
-
     // Clear hashrate stats
     {
         std::lock_guard<std::mutex> lock(m_hashrate_mutex);
         m_coin_stats.clear();
+        m_miner_scores.clear();
     }
+    m_share_stats.Clear();
 
     LogPrintf("MultiMergedStratum: Server stopped\n");
 }
@@ -313,17 +359,30 @@ uint16_t MultiMergedStratumServer::GetPort(ParentChainAlgo algo) const {
 void MultiMergedStratumServer::NotifyNewParentBlock(const std::string& chain_name) {
     auto it = m_parent_handlers.find(chain_name);
     if (it != m_parent_handlers.end()) {
-        ParentChainAlgo algo = it->second->GetAlgo();
-        auto cv_it = m_job_cvs.find(algo);
-        if (cv_it != m_job_cvs.end()) {
-            cv_it->second.notify_all();
-        }
+        WakeJobThread(it->second->GetAlgo());
     }
 }
 
+void MultiMergedStratumServer::WakeJobThread(ParentChainAlgo algo) {
+    auto cv_it = m_job_cvs.find(algo);
+    auto mutex_it = m_job_cv_mutexes.find(algo);
+    if (cv_it == m_job_cvs.end() || mutex_it == m_job_cv_mutexes.end()) return;
+
+    // The flag keeps a notification that arrives mid-job from being lost
+    {
+        std::lock_guard<std::mutex> lock(mutex_it->second);
+        m_job_pending[algo] = true;
+    }
+    cv_it->second.notify_all();
+}
+
 void MultiMergedStratumServer::NotifyNewWattxBlock() {
+    {
+        std::lock_guard<std::mutex> lock(m_wattx_mutex);
+        m_wattx_stale = true;
+    }
     for (auto& [algo, cv] : m_job_cvs) {
-        cv.notify_all();
+        WakeJobThread(algo);
     }
 }
 
@@ -331,112 +390,39 @@ void MultiMergedStratumServer::NotifyNewWattxBlock() {
 // Server Threads
 // ============================================================================
 
-void MultiMergedStratumServer::AcceptThread(ParentChainAlgo algo) {
-    LogPrintf("MultiMergedStratum: Accept thread started for %s\n",
-              ParentChainFactory::AlgoToString(algo));
+int MultiMergedStratumServer::OnAccept(int listener_id, const std::string& peer_addr) {
+    ParentChainAlgo algo = static_cast<ParentChainAlgo>(listener_id);
 
-    auto sock_it = m_listen_sockets.find(algo);
-    if (sock_it == m_listen_sockets.end()) return;
-
-    int listen_socket = sock_it->second;
-
-    while (m_running.load()) {
-        struct pollfd pfd{};
-        pfd.fd = listen_socket;
-        pfd.events = POLLIN;
-
-        int ret = poll(&pfd, 1, 1000);
-        if (ret <= 0) continue;
-
-        struct sockaddr_in client_addr{};
-        socklen_t addr_len = sizeof(client_addr);
-        int client_fd = accept(listen_socket, (struct sockaddr*)&client_addr, &addr_len);
-
-        if (client_fd < 0) continue;
-
-        int client_id;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-
-            if (m_clients.size() >= static_cast<size_t>(m_config.max_clients_per_algo * m_listen_sockets.size())) {
-                LogPrintf("MultiMergedStratum: Max clients reached\n");
-                close(client_fd);
-                continue;
-            }
+    int client_id;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
 
-            client_id = m_next_client_id++;
-            auto client = std::make_unique<MultiMergedClient>();
-            client->socket_fd = client_fd;
-            client->session_id = GenerateSessionId();
-            client->algo = algo;
-            client->connect_time = GetTime();
-            client->last_activity = GetTime();
-            m_clients[client_id] = std::move(client);
+        if (m_clients.size() >= static_cast<size_t>(m_config.max_clients_per_algo * m_listen_sockets.size())) {
+            LogPrintf("MultiMergedStratum: Max clients reached\n");
+            return -1;
         }
 
-        m_client_threads.emplace_back(&MultiMergedStratumServer::ClientThread, this, client_id);
-
-        LogPrintf("MultiMergedStratum: Client %d connected (%s)\n",
-                  client_id, ParentChainFactory::AlgoToString(algo));
+        client_id = m_next_client_id++;
+        auto client = std::make_unique<MultiMergedClient>();
+        client->peer_address = peer_addr;
+        client->session_id = GenerateSessionId();
+        client->algo = algo;
+        client->connect_time = GetTime();
+        client->last_activity = GetTime();
+        client->vardiff.Init(m_config.vardiff, m_config.share_difficulty, client->connect_time);
+        m_clients[client_id] = std::move(client);
     }
-}
-
-void MultiMergedStratumServer::ClientThread(int client_id) {
-    char buffer[4096];
-
-    while (m_running.load()) {
-        int socket_fd;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it == m_clients.end() || !it->second) break;
-            socket_fd = it->second->socket_fd;
-        }
-
-        struct pollfd pfd{};
-        pfd.fd = socket_fd;
-        pfd.events = POLLIN;
-
-        int ret = poll(&pfd, 1, 1000);
-        if (ret < 0) break;
-        if (ret == 0) continue;
-
-        ssize_t bytes = recv(socket_fd, buffer, sizeof(buffer) - 1, 0);
-        if (bytes <= 0) break;
-
-        buffer[bytes] = '\0';
 
-        std::string messages;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it == m_clients.end() || !it->second) break;
-
-            it->second->recv_buffer += buffer;
-            it->second->last_activity = GetTime();
-            messages = it->second->recv_buffer;
-        }
-
-        size_t pos = 0;
-        while ((pos = messages.find('\n')) != std::string::npos) {
-            std::string message = messages.substr(0, pos);
-            messages = messages.substr(pos + 1);
-
-            if (!message.empty()) {
-                HandleMessage(client_id, message);
-            }
-        }
+    LogPrintf("MultiMergedStratum: Client %d connected (%s)\n",
+              client_id, ParentChainFactory::AlgoToString(algo));
+    return client_id;
+}
 
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it != m_clients.end() && it->second) {
-                it->second->recv_buffer = messages;
-            }
-        }
+void MultiMergedStratumServer::OnDisconnect(int client_id) {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    if (m_clients.erase(client_id)) {
+        LogPrintf("MultiMergedStratum: Client %d disconnected\n", client_id);
     }
-
-    DisconnectClient(client_id);
 }
 
 void MultiMergedStratumServer::JobThread(ParentChainAlgo algo) {
@@ -446,12 +432,15 @@ void MultiMergedStratumServer::JobThread(ParentChainAlgo algo) {
     while (m_running.load()) {
         CreateJob(algo);
 
-        std::unique_lock<std::mutex> lock(m_job_cv_mutexes[algo]);
-        m_job_cvs[algo].wait_for(lock, std::chrono::seconds(m_config.job_timeout_seconds));
+        std::unique_lock<std::mutex> lock(m_job_cv_mutexes.at(algo));
+        bool& pending = m_job_pending.at(algo);
+        m_job_cvs.at(algo).wait_for(lock, std::chrono::seconds(m_config.job_timeout_seconds),
+                                    [&] { return pending || !m_running.load(); });
+        pending = false;
     }
 }
 
-void MultiMergedStratumServer::ParentPollerThread(const std::string& chain_name) {
+void MultiMergedStratumServer::ParentPollerThread(const std::string& chain_name, bool pushed) {
     LogPrintf("MultiMergedStratum: Poller thread started for %s\n", chain_name);
 
     auto handler_it = m_parent_handlers.find(chain_name);
@@ -475,7 +464,11 @@ void MultiMergedStratumServer::ParentPollerThread(const std::string& chain_name)
             }
         }
 
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+        // Sleep in steps so Stop() isn't held up by a long interval
+        const int interval = pushed ? PARENT_POLL_PUSHED_SECONDS : PARENT_POLL_SECONDS;
+        for (int i = 0; i < interval && m_running.load(); ++i) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
     }
 }
 
@@ -483,7 +476,22 @@ void MultiMergedStratumServer::ParentPollerThread(const std::string& chain_name)
 // Protocol Handlers
 // ============================================================================
 
-void MultiMergedStratumServer::HandleMessage(int client_id, const std::string& message) {
+void MultiMergedStratumServer::HandleMessage(int client_id, std::string_view raw_message) {
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end() || !it->second) return;
+        it->second->last_activity = GetTime();
+    }
+    // Fast path: share submissions are parsed in place without allocating
+    stratum::StratumSubmitView submit;
+    if (stratum::ParseStratumSubmit(raw_message, submit)) {
+        ProcessSubmit(client_id, submit.id, submit.job_id, submit.nonce, submit.result);
+        return;
+    }
+
+    std::string message(raw_message);
+
     std::string method = ParseJsonString(message, "method");
     std::string id = ParseJsonString(message, "id");
 
@@ -537,12 +545,14 @@ void MultiMergedStratumServer::HandleLogin(int client_id, const std::string& id,
 
     ParentChainAlgo algo;
     std::string session_id;
+    uint64_t difficulty;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
         if (it == m_clients.end() || !it->second) return;
 
         algo = it->second->algo;
+        difficulty = it->second->vardiff.Difficulty();
         it->second->wtx_address = wtx_address;
         it->second->worker_name = worker.empty() ? "default" : worker;
         it->second->authorized = true;
@@ -560,27 +570,12 @@ void MultiMergedStratumServer::HandleLogin(int client_id, const std::string& id,
               client_id, ParentChainFactory::AlgoToString(algo), worker);
 
     // Send login response with job
-    MultiAlgoJob job;
-    {
-        std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        auto job_it = m_current_jobs.find(algo);
-        if (job_it != m_current_jobs.end()) {
-            job = job_it->second;
-        }
-    }
+    const auto job = GetCurrentJob(algo);
 
     std::ostringstream oss;
     oss << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"result\":{";
     oss << "\"id\":\"" << session_id << "\",";
-    oss << "\"job\":{";
-    oss << "\"blob\":\"" << job.hashing_blob << "\",";
-    oss << "\"job_id\":\"" << job.job_id << "\",";
-    oss << "\"target\":\"" << job.parent_target.GetHex().substr(0, 16) << "\",";
-    oss << "\"height\":" << job.parent_height;
-    if (!job.seed_hash.empty()) {
-        oss << ",\"seed_hash\":\"" << job.seed_hash << "\"";
-    }
-    oss << "},";
+    oss << "\"job\":" << (job && job->prepared ? job->prepared->JobObject(ShareTarget(algo, difficulty)) : "null") << ",";
     oss << "\"status\":\"OK\"";
     oss << "}}\n";
 
@@ -594,10 +589,11 @@ void MultiMergedStratumServer::HandleSubmit(int client_id, const std::string& id
         return;
     }
 
-    std::string job_id = params[0];
-    std::string nonce = params[1];
-    std::string result = params[2];
+    ProcessSubmit(client_id, id, params[0], params[1], params[2]);
+}
 
+void MultiMergedStratumServer::ProcessSubmit(int client_id, std::string_view id, std::string_view job_id,
+                                             std::string_view nonce, std::string_view result) {
     bool valid = ValidateShare(client_id, job_id, nonce, result);
 
     if (valid) {
@@ -616,22 +612,53 @@ void MultiMergedStratumServer::HandleGetJob(int client_id, const std::string& id
         algo = it->second->algo;
     }
 
-    MultiAlgoJob job;
-    {
-        std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        auto job_it = m_current_jobs.find(algo);
-        if (job_it != m_current_jobs.end()) {
-            job = job_it->second;
-        }
+    if (const auto job = GetCurrentJob(algo)) {
+        SendJob(client_id, *job);
     }
-
-    SendJob(client_id, job);
 }
 
 // ============================================================================
 // Job Management
 // ============================================================================
 
+std::shared_ptr<const WattxJobTemplate> MultiMergedStratumServer::GetWattxTemplate() {
+    if (!m_wattx_mining) return nullptr;
+
+    // The first job thread to find the template stale fetches the new one,
+    // the others wait for it here rather than fetching their own
+    std::lock_guard<std::mutex> lock(m_wattx_mutex);
+    const int64_t now = GetTime();
+    if (m_wattx_template && !m_wattx_stale &&
+        now - m_wattx_template->created_at < m_config.job_timeout_seconds) {
+        return m_wattx_template;
+    }
+
+    auto block_template = m_wattx_mining->createNewBlock({.incremental = true});
+    if (!block_template) return m_wattx_template;
+
+    auto wattx = std::make_shared<WattxJobTemplate>();
+    wattx->block_template = std::move(block_template);
+    wattx->header = wattx->block_template->getBlockHeader();
+    auto tip = m_wattx_mining->getTip();
+    wattx->height = tip ? tip->height + 1 : 0;
+    wattx->target = ArithToUint256(arith_uint256().SetCompact(wattx->header.nBits));
+    wattx->created_at = now;
+
+    // Create merge mining commitment
+    const uint256 wattx_hash = wattx->header.GetHash();
+    for (const auto& [name, handler] : m_parent_handlers) {
+        const uint32_t chain_id = handler->GetChainId();
+        if (wattx->commitments.count(chain_id)) continue;
+        auto& commitment = wattx->commitments[chain_id];
+        commitment.aux_merkle_root = auxpow::CalcAuxChainMerkleRoot(wattx_hash, chain_id);
+        commitment.merge_mining_tag = auxpow::BuildMergeMiningTag(commitment.aux_merkle_root, 0);
+    }
+
+    m_wattx_template = std::move(wattx);
+    m_wattx_stale = false;
+    return m_wattx_template;
+}
+
 void MultiMergedStratumServer::CreateJob(ParentChainAlgo algo) {
     // Find primary chain for this algorithm
     auto primary_it = m_algo_primary_chain.find(algo);
@@ -642,52 +669,50 @@ void MultiMergedStratumServer::CreateJob(ParentChainAlgo algo) {
 
     auto& handler = handler_it->second;
 
-    MultiAlgoJob job;
-    job.job_id = GenerateJobId();
-    job.algo = algo;
-    job.created_at = GetTime();
+    auto job = std::make_shared<MultiAlgoJob>();
+    job->job_id = GenerateJobId();
+    job->algo = algo;
+    job->created_at = GetTime();
 
     // Get parent chain template
-    if (!handler->GetBlockTemplate(job.hashing_blob, job.full_template, job.seed_hash,
-                                    job.parent_height, job.parent_difficulty, job.coinbase_data)) {
+    if (!handler->GetBlockTemplate(job->hashing_blob, job->full_template, job->seed_hash,
+                                    job->parent_height, job->parent_difficulty, job->coinbase_data)) {
         return;
     }
 
-    job.parent_target = handler->DifficultyToTarget(job.parent_difficulty);
+    job->parent_target = handler->DifficultyToTarget(job->parent_difficulty);
 
     // Get WATTx template
-    if (m_wattx_mining) {
-        job.wattx_template = m_wattx_mining->createNewBlock();
-        if (job.wattx_template) {
-            auto header = job.wattx_template->getBlockHeader();
-            auto tip = m_wattx_mining->getTip();
-            job.wattx_height = tip ? tip->height + 1 : 0;
-            job.wattx_bits = header.nBits;
-
-            arith_uint256 target;
-            target.SetCompact(job.wattx_bits);
-            job.wattx_target = ArithToUint256(target);
-
-            // Create merge mining commitment
-            uint256 wattx_hash = header.GetHash();
-            job.aux_merkle_root = auxpow::CalcAuxChainMerkleRoot(wattx_hash, handler->GetChainId());
-            job.merge_mining_tag = auxpow::BuildMergeMiningTag(job.aux_merkle_root, 0);
-
-            // Rebuild hashing blob with MM tag injected
-            job.hashing_blob = handler->BuildHashingBlob(job.coinbase_data, job.merge_mining_tag);
-        }
+    job->wattx = GetWattxTemplate();
+    if (job->wattx) {
+        const auto& commitment = job->wattx->commitments.at(handler->GetChainId());
+        job->aux_merkle_root = commitment.aux_merkle_root;
+        job->merge_mining_tag = commitment.merge_mining_tag;
+
+        // Rebuild hashing blob with MM tag injected
+        job->hashing_blob = handler->BuildHashingBlob(job->coinbase_data, job->merge_mining_tag);
+    }
+
+    stratum::PreparedJobBuilder builder;
+    builder.Str("blob", job->hashing_blob)
+        .Str("job_id", job->job_id)
+        .Target(handler->DifficultyToTarget(m_config.share_difficulty).GetHex().substr(0, 16))
+        .Num("height", job->parent_height);
+    if (!job->seed_hash.empty()) {
+        builder.Str("seed_hash", job->seed_hash);
     }
+    job->prepared = builder.Build();
 
     // Store job
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
         m_current_jobs[algo] = job;
-        m_jobs[job.job_id] = job;
+        m_jobs[job->job_id] = job;
 
         // Cleanup old jobs
         int64_t now = GetTime();
         for (auto it = m_jobs.begin(); it != m_jobs.end();) {
-            if (now - it->second.created_at > m_config.job_timeout_seconds * 10) {
+            if (now - it->second->created_at > m_config.job_timeout_seconds * 10) {
                 it = m_jobs.erase(it);
             } else {
                 ++it;
@@ -696,35 +721,52 @@ void MultiMergedStratumServer::CreateJob(ParentChainAlgo algo) {
     }
 
     // Broadcast to clients
-    BroadcastJob(algo, job);
+    BroadcastJob(algo, *job);
 
     LogPrintf("MultiMergedStratum: Created %s job %s (parent height: %lu, WTX height: %lu)\n",
-              ParentChainFactory::AlgoToString(algo), job.job_id,
-              job.parent_height, job.wattx_height);
+              ParentChainFactory::AlgoToString(algo), job->job_id,
+              job->parent_height, job->wattx ? job->wattx->height : 0);
 }
 
-void MultiMergedStratumServer::BroadcastJob(ParentChainAlgo algo, const MultiAlgoJob& job) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
+std::shared_ptr<const MultiAlgoJob> MultiMergedStratumServer::GetCurrentJob(ParentChainAlgo algo) const {
+    std::lock_guard<std::mutex> lock(m_jobs_mutex);
+    auto job_it = m_current_jobs.find(algo);
+    return job_it != m_current_jobs.end() ? job_it->second : nullptr;
+}
 
-    for (const auto& [client_id, client] : m_clients) {
-        if (client && client->authorized && client->algo == algo) {
-            SendJob(client_id, job);
+void MultiMergedStratumServer::BroadcastJob(ParentChainAlgo algo, const MultiAlgoJob& job) {
+    std::vector<std::pair<int, uint64_t>> clients_to_notify;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        int64_t now = GetTime();
+        for (const auto& [client_id, client] : m_clients) {
+            if (client && client->authorized && client->algo == algo) {
+                // Ease off miners that have gone quiet at their current difficulty
+                client->vardiff.CheckIdle(m_config.vardiff, now);
+                clients_to_notify.emplace_back(client_id, client->vardiff.Difficulty());
+            }
         }
     }
+
+    // Subscribers of this algorithm on the default difficulty share the one serialized notification
+    for (const auto& [client_id, difficulty] : clients_to_notify) {
+        SendJob(client_id, job, difficulty);
+    }
 }
 
-bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& job_id,
-                                              const std::string& nonce, const std::string& result) {
-    MultiAlgoJob job;
+bool MultiMergedStratumServer::ValidateShare(int client_id, std::string_view job_id,
+                                             std::string_view nonce, std::string_view result) {
+    std::shared_ptr<const MultiAlgoJob> job_ref;
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        auto it = m_jobs.find(job_id);
+        auto it = m_jobs.find(std::string{job_id});
         if (it == m_jobs.end()) {
             LogPrintf("MultiMergedStratum: Unknown job %s\n", job_id);
             return false;
         }
-        job = it->second;
+        job_ref = it->second;
     }
+    const MultiAlgoJob& job = *job_ref;
 
     // Get handler for this job's algorithm
     auto primary_it = m_algo_primary_chain.find(job.algo);
@@ -736,13 +778,15 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
     auto& handler = handler_it->second;
     const std::string& chain_name = primary_it->second;
 
-    // Get client's WATTx address for luck calculation
+    // Get client's WATTx address for luck calculation and its current share difficulty
     std::string wtx_address;
+    uint64_t share_difficulty = m_config.share_difficulty;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
         if (it != m_clients.end() && it->second) {
             wtx_address = it->second->wtx_address;
+            share_difficulty = it->second->vardiff.AcceptDifficulty(GetTime());
         }
     }
 
@@ -755,7 +799,7 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
     arith_uint256 hash_arith = UintToArith256(submitted_hash);
 
     // Check share difficulty
-    uint256 share_target = handler->DifficultyToTarget(m_config.share_difficulty);
+    uint256 share_target = handler->DifficultyToTarget(share_difficulty);
     if (hash_arith > UintToArith256(share_target)) {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
@@ -787,16 +831,15 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
     // ========================================================================
     // Get miner's luck-adjusted target based on their diversification
     // More diversified miners get higher targets (easier to meet)
-    uint256 adjusted_wtx_target = job.wattx_target;
-    if (!wtx_address.empty()) {
-        adjusted_wtx_target = GetAdjustedWtxTarget(job.wattx_target, wtx_address);
-
-        // Log if luck adjustment is significant
-        MinerScore score = GetMinerScore(wtx_address);
-        if (score.luck_multiplier != 1.0) {
-            // Only log occasionally to avoid spam
-            static int log_counter = 0;
-            if (++log_counter % 100 == 0) {
+    uint256 adjusted_wtx_target = job.wattx ? job.wattx->target : uint256();
+    if (job.wattx && !wtx_address.empty()) {
+        adjusted_wtx_target = GetAdjustedWtxTarget(job.wattx->target, wtx_address);
+
+        // Log if luck adjustment is significant, only occasionally to avoid spam
+        static std::atomic<int> log_counter{0};
+        if (++log_counter % 100 == 0) {
+            MinerScore score = GetMinerScore(wtx_address);
+            if (score.luck_multiplier != 1.0) {
                 LogPrintf("MultiMergedStratum: Miner %s luck: %.2fx (chains: %zu, HHI: %.3f)\n",
                           wtx_address.substr(0, 12) + "...",
                           score.luck_multiplier,
@@ -807,29 +850,45 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
     }
 
     // Check WATTx target with luck adjustment
-    bool meets_wtx = (hash_arith <= UintToArith256(adjusted_wtx_target));
+    bool meets_wtx = job.wattx && (hash_arith <= UintToArith256(adjusted_wtx_target));
 
     // Update statistics
+    bool retargeted = false;
+    bool scored = false;
+    uint64_t next_difficulty = share_difficulty;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
         if (it != m_clients.end() && it->second) {
+            retargeted = it->second->vardiff.RecordShare(m_config.vardiff, GetTime());
+            next_difficulty = it->second->vardiff.Difficulty();
             if (meets_parent) {
                 // Always count shares for parent chain (valid regardless of cap)
                 it->second->shares_accepted[chain_name]++;
+                it->second->difficulty_accepted[chain_name] += share_difficulty;
                 m_total_shares[chain_name]++;
+                m_total_difficulty[chain_name] += share_difficulty;
 
                 // Only record toward WATTx score if NOT capped on this chain
                 // This is the core of the 50% decentralization rule
-                if (!miner_capped && !wtx_address.empty()) {
-                    RecordMinerShare(wtx_address, chain_name, m_config.share_difficulty);
-                }
+                scored = !miner_capped && !wtx_address.empty();
             }
             if (meets_wtx) {
                 it->second->wtx_blocks_found++;
             }
         }
     }
+    if (scored) {
+        RecordMinerShare(wtx_address, chain_name, share_difficulty);
+    }
+
+    // A new target only takes effect with a new job
+    if (retargeted) {
+        LogPrintf("MultiMergedStratum: Client %d difficulty retargeted to %lu\n", client_id, next_difficulty);
+        if (const auto current = GetCurrentJob(job.algo)) {
+            SendJob(client_id, *current, next_difficulty);
+        }
+    }
 
     // Submit to parent chain if meets target
     if (meets_parent) {
@@ -840,7 +899,7 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
     }
 
     // Submit to WATTx if meets target
-    if (meets_wtx && job.wattx_template) {
+    if (meets_wtx && job.wattx) {
         // Parse nonce
         std::vector<uint8_t> nonce_bytes = ParseHex(nonce);
         uint32_t nonce_val = 0;
@@ -851,23 +910,23 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
 
         // Create AuxPoW proof
         CAuxPow auxpow = handler->CreateAuxPow(
-            job.wattx_template->getBlockHeader(),
+            job.wattx->header,
             job.coinbase_data,
             nonce_val,
             job.merge_mining_tag
         );
 
         // Verify proof
-        uint256 wattx_hash = job.wattx_template->getBlockHeader().GetHash();
+        uint256 wattx_hash = job.wattx->header.GetHash();
         if (auxpow.Check(wattx_hash, handler->GetChainId())) {
             auto auxpow_ptr = std::make_shared<CAuxPow>(auxpow);
-            auto header = job.wattx_template->getBlockHeader();
+            const auto& header = job.wattx->header;
 
-            bool success = job.wattx_template->submitAuxPowSolution(
+            bool success = job.wattx->block_template->submitAuxPowSolution(
                 header.nVersion | CAuxPowBlockHeader::AUXPOW_VERSION_FLAG,
                 header.nTime,
                 0,
-                job.wattx_template->getCoinbaseTx(),
+                job.wattx->block_template->getCoinbaseTx(),
                 auxpow_ptr
             );
 
@@ -887,20 +946,16 @@ bool MultiMergedStratumServer::ValidateShare(int client_id, const std::string& j
 // ============================================================================
 
 void MultiMergedStratumServer::SendToClient(int client_id, const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-    auto it = m_clients.find(client_id);
-    if (it == m_clients.end() || !it->second) return;
-
-    send(it->second->socket_fd, message.c_str(), message.length(), MSG_NOSIGNAL);
+    m_io.Send(client_id, message);
 }
 
-void MultiMergedStratumServer::SendResult(int client_id, const std::string& id, const std::string& result) {
+void MultiMergedStratumServer::SendResult(int client_id, std::string_view id, const std::string& result) {
     std::ostringstream oss;
     oss << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"error\":null,\"result\":" << result << "}\n";
     SendToClient(client_id, oss.str());
 }
 
-void MultiMergedStratumServer::SendError(int client_id, const std::string& id, int code, const std::string& msg) {
+void MultiMergedStratumServer::SendError(int client_id, std::string_view id, int code, const std::string& msg) {
     std::ostringstream oss;
     oss << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"error\":{\"code\":" << code
         << ",\"message\":\"" << msg << "\"},\"result\":null}\n";
@@ -908,29 +963,37 @@ void MultiMergedStratumServer::SendError(int client_id, const std::string& id, i
 }
 
 void MultiMergedStratumServer::SendJob(int client_id, const MultiAlgoJob& job) {
-    std::ostringstream oss;
-    oss << "{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":{";
-    oss << "\"blob\":\"" << job.hashing_blob << "\",";
-    oss << "\"job_id\":\"" << job.job_id << "\",";
-    oss << "\"target\":\"" << job.parent_target.GetHex().substr(0, 16) << "\",";
-    oss << "\"height\":" << job.parent_height;
-    if (!job.seed_hash.empty()) {
-        oss << ",\"seed_hash\":\"" << job.seed_hash << "\"";
+    uint64_t difficulty;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end() || !it->second) return;
+        difficulty = it->second->vardiff.Difficulty();
     }
-    oss << "}}\n";
-    SendToClient(client_id, oss.str());
+    SendJob(client_id, job, difficulty);
+}
+
+void MultiMergedStratumServer::SendJob(int client_id, const MultiAlgoJob& job, uint64_t difficulty) {
+    if (!job.prepared) return;
+    m_io.Send(client_id, job.prepared->Notify(ShareTarget(job.algo, difficulty)));
+}
+
+std::string MultiMergedStratumServer::ShareTarget(ParentChainAlgo algo, uint64_t difficulty) const {
+    // Handlers are fixed once the server has started
+    auto primary_it = m_algo_primary_chain.find(algo);
+    if (primary_it == m_algo_primary_chain.end()) return {};
+    auto handler_it = m_parent_handlers.find(primary_it->second);
+    if (handler_it == m_parent_handlers.end()) return {};
+    return handler_it->second->DifficultyToTarget(difficulty).GetHex().substr(0, 16);
 }
 
 void MultiMergedStratumServer::DisconnectClient(int client_id) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-    auto it = m_clients.find(client_id);
-    if (it != m_clients.end()) {
-        if (it->second && it->second->socket_fd >= 0) {
-            close(it->second->socket_fd);
-        }
-        m_clients.erase(it);
-        LogPrintf("MultiMergedStratum: Client %d disconnected\n", client_id);
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        if (m_clients.erase(client_id) == 0) return;
     }
+    m_io.Close(client_id);
+    LogPrintf("MultiMergedStratum: Client %d disconnected\n", client_id);
 }
 
 std::string MultiMergedStratumServer::GenerateJobId() {
@@ -1000,7 +1063,7 @@ void MultiMergedStratumServer::UpdateCoinHashrates() {
         // Calculate pool hashrate from recent shares
         uint64_t time_window = 600;  // 10 minute window
         uint64_t recent_shares = m_total_shares[name].load();
-        stats.pool_hashrate = (recent_shares * m_config.share_difficulty * 0x100000000ULL) / time_window;
+        stats.pool_hashrate = (m_total_difficulty[name].load() * 0x100000000ULL) / time_window;
         stats.pool_shares = recent_shares;
 
         // Calculate pool's % of network hashrate
@@ -1019,27 +1082,19 @@ void MultiMergedStratumServer::UpdateCoinHashrates() {
 }
 
 void MultiMergedStratumServer::UpdateMinerHashrates() {
-    std::lock_guard<std::mutex> lock_clients(m_clients_mutex);
-    std::lock_guard<std::mutex> lock_hashrate(m_hashrate_mutex);
+    // Aggregate miner hashrates from the scored shares of the window
+    auto window = m_share_stats.Collect(GetTime());
+    const uint64_t time_window = m_share_stats.WindowSeconds();
 
-    // Clear old miner hashrates
+    std::lock_guard<std::mutex> lock(m_hashrate_mutex);
     for (auto& [coin_name, stats] : m_coin_stats) {
         stats.miner_hashrates.clear();
-    }
-
-    // Aggregate miner hashrates from client shares
-    uint64_t time_window = 600;  // 10 minute window
-
-    for (const auto& [client_id, client] : m_clients) {
-        if (!client || client->wtx_address.empty()) continue;
 
-        for (const auto& [coin_name, shares] : client->shares_accepted) {
-            auto stats_it = m_coin_stats.find(coin_name);
-            if (stats_it == m_coin_stats.end()) continue;
-
-            // Estimate miner's hashrate: (shares * share_diff * 2^32) / time
-            uint64_t miner_hashrate = (shares * m_config.share_difficulty * 0x100000000ULL) / time_window;
-            stats_it->second.miner_hashrates[client->wtx_address] += miner_hashrate;
+        auto chain_it = window.find(coin_name);
+        if (chain_it == window.end()) continue;
+        for (const auto& [miner, difficulty] : chain_it->second) {
+            // Estimate miner's hashrate: (sum of share difficulties * 2^32) / time
+            stats.miner_hashrates[miner] = (difficulty * 0x100000000ULL) / time_window;
         }
     }
 }
@@ -1126,15 +1181,9 @@ void MultiMergedStratumServer::RecordMinerShare(const std::string& wtx_address,
                                                  const std::string& coin_name,
                                                  uint64_t difficulty) {
     // Called when a miner submits a valid share
-    // The share counts toward their hashrate on that chain
-    std::lock_guard<std::mutex> lock(m_hashrate_mutex);
-
-    auto stats_it = m_coin_stats.find(coin_name);
-    if (stats_it != m_coin_stats.end()) {
-        // Increment their share-based hashrate contribution
-        // This gets converted to hashrate in UpdateMinerHashrates()
-        stats_it->second.miner_hashrates[wtx_address] += difficulty;
-    }
+    // The share counts toward their hashrate on that chain, which
+    // UpdateMinerHashrates() picks up
+    m_share_stats.Record(wtx_address, coin_name, difficulty, GetTime());
 }
 
 MinerScore MultiMergedStratumServer::GetMinerScore(const std::string& wtx_address) const {
@@ -1155,6 +1204,13 @@ MinerScore MultiMergedStratumServer::GetMinerScore(const std::string& wtx_addres
     return default_score;
 }
 
+double MultiMergedStratumServer::GetMinerLuck(const std::string& wtx_address) const {
+    std::lock_guard<std::mutex> lock(m_hashrate_mutex);
+
+    auto it = m_miner_scores.find(wtx_address);
+    return it != m_miner_scores.end() ? it->second.luck_multiplier : 1.0;
+}
+
 std::vector<MinerScore> MultiMergedStratumServer::GetAllMinerScores() const {
     std::lock_guard<std::mutex> lock(m_hashrate_mutex);
 
@@ -1281,9 +1337,9 @@ double MultiMergedStratumServer::CalculateLuckMultiplier(const MinerScore& score
 uint256 MultiMergedStratumServer::GetAdjustedWtxTarget(const uint256& base_target,
                                                         const std::string& wtx_address) const {
     // Get miner's luck multiplier
-    MinerScore score = GetMinerScore(wtx_address);
+    const double luck_multiplier = GetMinerLuck(wtx_address);
 
-    if (score.luck_multiplier <= 0.0 || score.luck_multiplier == 1.0) {
+    if (luck_multiplier <= 0.0 || luck_multiplier == 1.0) {
         return base_target;  // No adjustment needed
     }
 
@@ -1293,7 +1349,7 @@ uint256 MultiMergedStratumServer::GetAdjustedWtxTarget(const uint256& base_targe
 
     // Scale by luck multiplier (using fixed-point math to avoid precision loss)
     // luck_multiplier is in range [0.5, 3.0]
-    uint64_t luck_scaled = static_cast<uint64_t>(score.luck_multiplier * 1000000.0);
+    uint64_t luck_scaled = static_cast<uint64_t>(luck_multiplier * 1000000.0);
     target = (target * luck_scaled) / 1000000;
 
     // Ensure target doesn't overflow or become too easy
@@ -5,7 +5,12 @@
 #ifndef WATTX_STRATUM_MULTI_MERGED_STRATUM_H
 #define WATTX_STRATUM_MULTI_MERGED_STRATUM_H
 
+#include <stratum/event_loop.h>
+#include <stratum/job_payload.h>
 #include <stratum/parent_chain.h>
+#include <stratum/parent_notify.h>
+#include <stratum/share_stats.h>
+#include <stratum/vardiff.h>
 #include <stratum/mining_rewards.h>
 #include <anchor/evm_anchor.h>
 #include <interfaces/mining.h>
@@ -15,6 +20,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -39,6 +45,12 @@ static constexpr double MAX_NETHASH_PERCENT_PER_CHAIN = 50.0;
 static constexpr double MIN_LUCK_MULTIPLIER = 0.5;   // 50% harder for concentrated miners
 static constexpr double MAX_LUCK_MULTIPLIER = 3.0;   // 3x easier for highly diversified miners
 
+// Seconds between parent chain template polls
+static constexpr int PARENT_POLL_SECONDS = 5;
+// Poll interval for chains whose daemon pushes new work (long-poll, ZMQ),
+// where polling only covers lost notifications
+static constexpr int PARENT_POLL_PUSHED_SECONDS = 30;
+
 /**
  * Per-coin hashrate tracking for share calculations
  *
@@ -65,7 +77,8 @@ struct CoinHashrateStats {
     uint64_t pool_hashrate{0};          // Our pool's hashrate on this coin
     uint64_t pool_shares{0};            // Total shares submitted
 
-    // Per-miner tracking: miner_address -> their hashrate on this coin
+    // Per-miner tracking: miner_address -> their hashrate on this coin,
+    // from the share window at the last hashrate update
     std::unordered_map<std::string, uint64_t> miner_hashrates;
 
     // Calculated metrics
@@ -118,6 +131,7 @@ struct MultiMergedConfig {
     std::string bind_address = "0.0.0.0";
     uint16_t base_port = 3337;           // Each algo gets its own port: base_port + algo_index
     int max_clients_per_algo = 500;
+    int io_threads = stratum::DEFAULT_STRATUM_IO_THREADS;  // Shared by all algorithm ports
 
     // WATTx settings
     std::string wattx_wallet_address;
@@ -127,7 +141,8 @@ struct MultiMergedConfig {
 
     // Pool settings
     int job_timeout_seconds = 60;
-    uint64_t share_difficulty = 10000;
+    uint64_t share_difficulty = 10000;   // Starting share difficulty for each connection
+    stratum::VardiffConfig vardiff;      // Per-connection difficulty tuning
     double pool_fee_percent = 0.1;   // 0.1% fee for WATTx Mining Game pools
 
     // Hashrate tracking settings
@@ -135,8 +150,29 @@ struct MultiMergedConfig {
     bool normalize_cross_algo = true;    // Normalize shares across different algorithms
 };
 
+/**
+ * WATTx block template shared by the jobs of every algorithm, with the
+ * merge mining commitment for each parent chain ID computed once
+ */
+struct WattxJobTemplate {
+    struct Commitment {
+        uint256 aux_merkle_root;
+        std::vector<uint8_t> merge_mining_tag;
+    };
+
+    std::shared_ptr<interfaces::BlockTemplate> block_template;
+    CBlockHeader header;
+    uint64_t height{0};
+    uint256 target;
+    std::unordered_map<uint32_t, Commitment> commitments;  // parent chain ID -> commitment
+    int64_t created_at{0};
+};
+
 /**
  * Job for a specific algorithm (may include multiple parent chains)
+ *
+ * Jobs are immutable once created and shared between the current job, the
+ * job lookup and the threads validating shares against them.
  */
 struct MultiAlgoJob {
     std::string job_id;
@@ -152,10 +188,7 @@ struct MultiAlgoJob {
     ParentCoinbaseData coinbase_data;
 
     // WATTx data
-    std::shared_ptr<interfaces::BlockTemplate> wattx_template;
-    uint64_t wattx_height{0};
-    uint32_t wattx_bits{0};
-    uint256 wattx_target;
+    std::shared_ptr<const WattxJobTemplate> wattx;
 
     // Merge mining commitment
     uint256 aux_merkle_root;
@@ -166,13 +199,16 @@ struct MultiAlgoJob {
     std::vector<uint8_t> evm_anchor_tag;
 
     int64_t created_at{0};
+
+    // Notification serialized once when the job is created
+    std::shared_ptr<const stratum::PreparedJob> prepared;
 };
 
 /**
  * Connected miner for multi-algo mining
  */
 struct MultiMergedClient {
-    int socket_fd{-1};
+    std::string peer_address;
     std::string session_id;
     std::string worker_name;
     ParentChainAlgo algo;
@@ -186,13 +222,14 @@ struct MultiMergedClient {
 
     // Statistics per chain
     std::unordered_map<std::string, uint64_t> shares_accepted;
+    std::unordered_map<std::string, uint64_t> difficulty_accepted;  // Sum of accepted share difficulties
     std::unordered_map<std::string, uint64_t> blocks_found;
     uint64_t shares_rejected{0};
     uint64_t wtx_blocks_found{0};
 
     int64_t connect_time{0};
     int64_t last_activity{0};
-    std::string recv_buffer;
+    stratum::VardiffState vardiff;
 };
 
 /**
@@ -250,29 +287,38 @@ public:
     void NotifyNewWattxBlock();
 
 private:
-    // Server threads (one accept thread per algorithm)
-    void AcceptThread(ParentChainAlgo algo);
-    void ClientThread(int client_id);
+    // Event loop callbacks (run on I/O threads); listener id is the algorithm
+    int OnAccept(int listener_id, const std::string& peer_addr);
+    void OnDisconnect(int client_id);
+
+    // Server threads
     void JobThread(ParentChainAlgo algo);
-    void ParentPollerThread(const std::string& chain_name);
+    void WakeJobThread(ParentChainAlgo algo);
+    void ParentPollerThread(const std::string& chain_name, bool pushed);
 
     // Protocol handlers
-    void HandleMessage(int client_id, const std::string& message);
+    void HandleMessage(int client_id, std::string_view message);
     void HandleLogin(int client_id, const std::string& id, const std::vector<std::string>& params);
     void HandleSubmit(int client_id, const std::string& id, const std::vector<std::string>& params);
+    void ProcessSubmit(int client_id, std::string_view id, std::string_view job_id,
+                       std::string_view nonce, std::string_view result);
     void HandleGetJob(int client_id, const std::string& id);
 
     // Job management
+    std::shared_ptr<const WattxJobTemplate> GetWattxTemplate();
     void CreateJob(ParentChainAlgo algo);
+    std::shared_ptr<const MultiAlgoJob> GetCurrentJob(ParentChainAlgo algo) const;
     void BroadcastJob(ParentChainAlgo algo, const MultiAlgoJob& job);
-    bool ValidateShare(int client_id, const std::string& job_id,
-                       const std::string& nonce, const std::string& result);
+    bool ValidateShare(int client_id, std::string_view job_id,
+                       std::string_view nonce, std::string_view result);
 
     // Network helpers
     void SendToClient(int client_id, const std::string& message);
-    void SendResult(int client_id, const std::string& id, const std::string& result);
-    void SendError(int client_id, const std::string& id, int code, const std::string& msg);
+    void SendResult(int client_id, std::string_view id, const std::string& result);
+    void SendError(int client_id, std::string_view id, int code, const std::string& msg);
     void SendJob(int client_id, const MultiAlgoJob& job);
+    void SendJob(int client_id, const MultiAlgoJob& job, uint64_t difficulty);
+    std::string ShareTarget(ParentChainAlgo algo, uint64_t difficulty) const;
     void DisconnectClient(int client_id);
 
     // Utility
@@ -292,24 +338,31 @@ private:
     std::unordered_map<ParentChainAlgo, int> m_listen_sockets;
 
     // Threads
-    std::vector<std::thread> m_accept_threads;
+    stratum::StratumEventLoop m_io;
     std::vector<std::thread> m_job_threads;
     std::vector<std::thread> m_poller_threads;
-    std::vector<std::thread> m_client_threads;
+    std::vector<std::unique_ptr<stratum::ParentBlockSubscriber>> m_block_subscribers;
 
     // Clients
     mutable std::mutex m_clients_mutex;
     std::unordered_map<int, std::unique_ptr<MultiMergedClient>> m_clients;
     int m_next_client_id{0};
 
+    // WATTx template shared by the job threads, refreshed on a new WATTx
+    // block or once it is job_timeout_seconds old
+    std::mutex m_wattx_mutex;
+    std::shared_ptr<const WattxJobTemplate> m_wattx_template;  // guarded by m_wattx_mutex
+    bool m_wattx_stale{true};                                  // guarded by m_wattx_mutex
+
     // Jobs (per algorithm)
     mutable std::mutex m_jobs_mutex;
-    std::unordered_map<ParentChainAlgo, MultiAlgoJob> m_current_jobs;
-    std::unordered_map<std::string, MultiAlgoJob> m_jobs;  // job_id -> job
+    std::unordered_map<ParentChainAlgo, std::shared_ptr<const MultiAlgoJob>> m_current_jobs;
+    std::unordered_map<std::string, std::shared_ptr<const MultiAlgoJob>> m_jobs;  // job_id -> job
     std::atomic<uint64_t> m_job_counter{0};
 
     // Statistics
     std::unordered_map<std::string, std::atomic<uint64_t>> m_total_shares;
+    std::unordered_map<std::string, std::atomic<uint64_t>> m_total_difficulty;
     std::unordered_map<std::string, std::atomic<uint64_t>> m_blocks_found;
     std::atomic<uint64_t> m_wtx_blocks_found{0};
 
@@ -318,6 +371,10 @@ private:
     std::unordered_map<std::string, CoinHashrateStats> m_coin_stats;  // coin_name -> stats
     std::unordered_map<std::string, MinerScore> m_miner_scores;       // wtx_address -> score
 
+    // Scored shares per miner, recorded without m_hashrate_mutex and turned
+    // into miner_hashrates by the hashrate thread
+    stratum::MinerShareStats m_share_stats;
+
     // Hashrate update thread
     std::thread m_hashrate_thread;
     void HashrateUpdateThread();
@@ -330,6 +387,7 @@ private:
 
     // Get miner's score and reward share
     MinerScore GetMinerScore(const std::string& wtx_address) const;
+    double GetMinerLuck(const std::string& wtx_address) const;
     std::vector<MinerScore> GetAllMinerScores() const;
 
     // Get total scores for reward distribution
@@ -373,9 +431,10 @@ private:
      */
     uint256 GetAdjustedWtxTarget(const uint256& base_target, const std::string& wtx_address) const;
 
-    // Synchronization
+    // Synchronization (entries are created in Start() before any thread runs)
     std::unordered_map<ParentChainAlgo, std::condition_variable> m_job_cvs;
     std::unordered_map<ParentChainAlgo, std::mutex> m_job_cv_mutexes;
+    std::unordered_map<ParentChainAlgo, bool> m_job_pending;  // guarded by the algo's m_job_cv_mutexes entry
 };
 
 /**
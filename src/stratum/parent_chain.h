@@ -10,6 +10,7 @@
 #include <primitives/transaction.h>
 #include <uint256.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,6 +43,7 @@ struct ParentChainConfig {
     std::string wallet_address;    // Pool's address on parent chain
     uint32_t chain_id;             // Unique ID to prevent cross-chain replay
     bool enabled{true};
+    std::string zmq_endpoint;      // Daemon's ZMQ block publisher; empty to rely on polling
 };
 
 /**
@@ -94,6 +96,18 @@ public:
     virtual ParentChainAlgo GetAlgo() const = 0;
     virtual uint32_t GetChainId() const = 0;
 
+    // ZMQ block notifications (endpoint empty when not configured)
+    virtual std::string GetZmqEndpoint() const = 0;
+    virtual std::string GetZmqBlockTopic() const = 0;
+
+    // Work pushed by the daemon (e.g. getblocktemplate long-polling). The
+    // handler calls on_change from its own thread whenever the daemon has new
+    // work. Returns false if the chain has no such mechanism, leaving it to
+    // be polled.
+    using WorkChangedFn = std::function<void()>;
+    virtual bool StartWorkWatch(WorkChangedFn on_change) { return false; }
+    virtual void StopWorkWatch() {}
+
     // Block template operations
     virtual bool GetBlockTemplate(
         std::string& hashing_blob,
@@ -6,15 +6,14 @@
 #define WATTX_STRATUM_PARENT_CHAIN_BASE_H
 
 #include <stratum/parent_chain.h>
+#include <stratum/parent_notify.h>
+#include <stratum/rpc_client.h>
 #include <hash.h>
 #include <logging.h>
 #include <util/strencodings.h>
 
 #include <cstring>
-#include <netdb.h>
-#include <netinet/in.h>
-#include <sys/socket.h>
-#include <unistd.h>
+#include <memory>
 
 namespace merged_stratum {
 
@@ -24,77 +23,20 @@ namespace merged_stratum {
 class ParentChainHandlerBase : public IParentChainHandler {
 public:
     explicit ParentChainHandlerBase(const ParentChainConfig& config)
-        : m_config(config) {}
+        : m_config(config),
+          m_rpc(stratum::GetRpcClient(config.daemon_host, config.daemon_port,
+                                      config.daemon_user.empty() ? std::string{}
+                                                                 : config.daemon_user + ":" + config.daemon_password)) {}
 
     std::string GetName() const override { return m_config.name; }
     ParentChainAlgo GetAlgo() const override { return m_config.algo; }
     uint32_t GetChainId() const override { return m_config.chain_id; }
 
-    std::string HttpPost(const std::string& path, const std::string& body) override {
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) return "";
-
-        struct timeval tv;
-        tv.tv_sec = 10;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-
-        struct sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(m_config.daemon_port);
-
-        struct hostent* he = gethostbyname(m_config.daemon_host.c_str());
-        if (!he) {
-            close(sock);
-            return "";
-        }
-        std::memcpy(&addr.sin_addr, he->h_addr, he->h_length);
-
-        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            close(sock);
-            return "";
-        }
+    std::string GetZmqEndpoint() const override { return m_config.zmq_endpoint; }
+    std::string GetZmqBlockTopic() const override { return stratum::BITCOIN_ZMQ_BLOCK_TOPIC; }
 
-        // Build HTTP request
-        std::string auth_header;
-        if (!m_config.daemon_user.empty()) {
-            std::string credentials = m_config.daemon_user + ":" + m_config.daemon_password;
-            auth_header = "Authorization: Basic " + EncodeBase64(credentials) + "\r\n";
-        }
-
-        std::ostringstream request;
-        request << "POST " << path << " HTTP/1.1\r\n";
-        request << "Host: " << m_config.daemon_host << ":" << m_config.daemon_port << "\r\n";
-        request << "Content-Type: application/json\r\n";
-        request << auth_header;
-        request << "Content-Length: " << body.length() << "\r\n";
-        request << "Connection: close\r\n\r\n";
-        request << body;
-
-        std::string req_str = request.str();
-        if (send(sock, req_str.c_str(), req_str.length(), 0) < 0) {
-            close(sock);
-            return "";
-        }
-
-        std::string response;
-        char buffer[4096];
-        ssize_t bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-        }
-
-        close(sock);
-
-        // Extract body (skip headers)
-        size_t body_start = response.find("\r\n\r\n");
-        if (body_start != std::string::npos) {
-            return response.substr(body_start + 4);
-        }
-
-        return response;
+    std::string HttpPost(const std::string& path, const std::string& body) override {
+        return m_rpc->Post(path, body);
     }
 
     std::string JsonRpcCall(const std::string& method, const std::string& params) override {
@@ -105,6 +47,7 @@ public:
 
 protected:
     ParentChainConfig m_config;
+    std::shared_ptr<stratum::RpcClient> m_rpc;
 
     // Helper: Read varint from buffer
     static size_t ReadVarint(const std::vector<uint8_t>& data, size_t pos, uint64_t& value) {
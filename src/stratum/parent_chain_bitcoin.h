@@ -119,6 +119,11 @@ public:
     explicit BitcoinChainHandler(const ParentChainConfig& config)
         : ParentChainHandlerBase(config) {}
 
+    bool StartWorkWatch(WorkChangedFn on_change) override {
+        return m_longpoll.Start(m_config.name, m_rpc, TemplateRequest(), std::move(on_change));
+    }
+    void StopWorkWatch() override { m_longpoll.Stop(); }
+
     bool GetBlockTemplate(
         std::string& hashing_blob,
         std::string& full_template,
@@ -128,8 +133,7 @@ public:
         ParentCoinbaseData& coinbase_data
     ) override {
         // Bitcoin uses getblocktemplate RPC
-        std::string response = JsonRpcCall("getblocktemplate",
-            "[{\"rules\":[\"segwit\"],\"capabilities\":[\"coinbasetxn\",\"workid\",\"coinbase/append\"]}]");
+        std::string response = JsonRpcCall("getblocktemplate", "[" + TemplateRequest() + "]");
 
         if (response.empty()) {
             LogPrintf("BitcoinChain: Failed to get block template\n");
@@ -427,7 +431,14 @@ public:
         return ArithToUint256(target);
     }
 
+protected:
+    //! getblocktemplate request object, for polling and long-polling alike
+    virtual std::string TemplateRequest() const {
+        return "{\"rules\":[\"segwit\"],\"capabilities\":[\"coinbasetxn\",\"workid\",\"coinbase/append\"]}";
+    }
+
 private:
+    stratum::TemplateLongPoller m_longpoll;
     BitcoinBlockHeader m_current_header;
     std::string m_current_prevhash;
     std::string m_current_bits;
@@ -152,6 +152,12 @@ public:
         : ParentChainHandlerBase(config),
           m_equihash_n(200), m_equihash_k(9) {}
 
+    // zcashd supports getblocktemplate long-polling like bitcoind
+    bool StartWorkWatch(WorkChangedFn on_change) override {
+        return m_longpoll.Start(m_config.name, m_rpc, "{}", std::move(on_change));
+    }
+    void StopWorkWatch() override { m_longpoll.Stop(); }
+
     // Allow custom Equihash parameters (for Horizen, etc.)
     void SetEquihashParams(unsigned int n, unsigned int k) {
         m_equihash_n = n;
@@ -333,6 +339,7 @@ public:
     }
 
 private:
+    stratum::TemplateLongPoller m_longpoll;
     EquihashBlockHeader m_current_header;
     uint64_t m_current_height{0};
     unsigned int m_equihash_n;
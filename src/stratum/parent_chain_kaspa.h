@@ -293,54 +293,8 @@ public:
 
 private:
     std::string HttpGet(const std::string& path) {
-        // Simple HTTP GET (Kaspa uses REST, not JSON-RPC)
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) return "";
-
-        struct timeval tv;
-        tv.tv_sec = 10;
-        tv.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-        struct sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(m_config.daemon_port);
-
-        struct hostent* he = gethostbyname(m_config.daemon_host.c_str());
-        if (!he) {
-            close(sock);
-            return "";
-        }
-        std::memcpy(&addr.sin_addr, he->h_addr, he->h_length);
-
-        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            close(sock);
-            return "";
-        }
-
-        std::ostringstream request;
-        request << "GET " << path << " HTTP/1.1\r\n";
-        request << "Host: " << m_config.daemon_host << "\r\n";
-        request << "Connection: close\r\n\r\n";
-
-        std::string req_str = request.str();
-        send(sock, req_str.c_str(), req_str.length(), 0);
-
-        std::string response;
-        char buffer[4096];
-        ssize_t bytes;
-        while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-            buffer[bytes] = '\0';
-            response += buffer;
-        }
-
-        close(sock);
-
-        size_t body_start = response.find("\r\n\r\n");
-        if (body_start != std::string::npos) {
-            return response.substr(body_start + 4);
-        }
-        return response;
+        // Kaspa uses REST, not JSON-RPC
+        return m_rpc->Get(path);
     }
 
     KaspaBlockHeader m_current_header;
@@ -99,6 +99,8 @@ public:
     explicit MoneroChainHandler(const ParentChainConfig& config)
         : ParentChainHandlerBase(config) {}
 
+    std::string GetZmqBlockTopic() const override { return stratum::MONERO_ZMQ_BLOCK_TOPIC; }
+
     bool GetBlockTemplate(
         std::string& hashing_blob,
         std::string& full_template,
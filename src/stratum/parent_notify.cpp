@@ -0,0 +1,217 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/parent_notify.h>
+
+#include <logging.h>
+#include <stratum/rpc_client.h>
+#include <univalue.h>
+#include <util/threadnames.h>
+
+#ifdef ENABLE_ZMQ
+#include <zmq.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+
+namespace stratum {
+
+//! Receive timeout, bounds how long Stop() waits for the subscriber thread
+static constexpr int ZMQ_POLL_TIMEOUT_MS = 500;
+
+ParentBlockSubscriber::~ParentBlockSubscriber()
+{
+    Stop();
+}
+
+bool ParentBlockSubscriber::IsAvailable()
+{
+#ifdef ENABLE_ZMQ
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef ENABLE_ZMQ
+
+bool ParentBlockSubscriber::Start(const std::string& name, const std::string& endpoint,
+                                  const std::string& topic, NotifyFn on_block)
+{
+    if (m_running.load()) return false;
+
+    m_name = name;
+    m_on_block = std::move(on_block);
+
+    m_context = zmq_ctx_new();
+    if (!m_context) {
+        LogPrintf("Stratum: %s ZMQ context failed: %s\n", m_name, zmq_strerror(errno));
+        return false;
+    }
+
+    m_socket = zmq_socket(m_context, ZMQ_SUB);
+    int timeout = ZMQ_POLL_TIMEOUT_MS;
+    int keepalive = 1;
+    if (!m_socket ||
+        zmq_setsockopt(m_socket, ZMQ_RCVTIMEO, &timeout, sizeof(timeout)) != 0 ||
+        zmq_setsockopt(m_socket, ZMQ_TCP_KEEPALIVE, &keepalive, sizeof(keepalive)) != 0 ||
+        zmq_setsockopt(m_socket, ZMQ_SUBSCRIBE, topic.data(), topic.size()) != 0 ||
+        zmq_connect(m_socket, endpoint.c_str()) != 0) {
+        LogPrintf("Stratum: %s ZMQ subscribe to %s failed: %s\n", m_name, endpoint, zmq_strerror(errno));
+        if (m_socket) zmq_close(m_socket);
+        zmq_ctx_term(m_context);
+        m_socket = nullptr;
+        m_context = nullptr;
+        return false;
+    }
+
+    m_running.store(true);
+    m_thread = std::thread([this] {
+        util::ThreadRename("zmqsub." + m_name);
+        SubscriberThread();
+    });
+
+    LogPrintf("Stratum: %s subscribed to %s at %s\n", m_name, topic, endpoint);
+    return true;
+}
+
+void ParentBlockSubscriber::Stop()
+{
+    if (!m_running.exchange(false)) return;
+    if (m_thread.joinable()) m_thread.join();
+
+    zmq_close(m_socket);
+    zmq_ctx_term(m_context);
+    m_socket = nullptr;
+    m_context = nullptr;
+}
+
+void ParentBlockSubscriber::SubscriberThread()
+{
+    while (m_running.load()) {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        int rc = zmq_msg_recv(&msg, m_socket, 0);
+        if (rc < 0) {
+            int err = errno;
+            zmq_msg_close(&msg);
+            if (err == EAGAIN || err == EINTR) continue;
+            LogPrintf("Stratum: %s ZMQ receive failed: %s\n", m_name, zmq_strerror(err));
+            break;
+        }
+
+        // Drain the remaining frames (hashblock sends topic, hash, sequence)
+        bool more = zmq_msg_more(&msg);
+        zmq_msg_close(&msg);
+        while (more) {
+            zmq_msg_init(&msg);
+            if (zmq_msg_recv(&msg, m_socket, 0) < 0) {
+                zmq_msg_close(&msg);
+                break;
+            }
+            more = zmq_msg_more(&msg);
+            zmq_msg_close(&msg);
+        }
+
+        m_notifications++;
+        m_on_block();
+    }
+}
+
+#else // ENABLE_ZMQ
+
+bool ParentBlockSubscriber::Start(const std::string& name, const std::string& endpoint,
+                                  const std::string& topic, NotifyFn on_block)
+{
+    LogPrintf("Stratum: %s cannot subscribe to %s, built without ZMQ support\n", name, endpoint);
+    return false;
+}
+
+void ParentBlockSubscriber::Stop()
+{
+}
+
+void ParentBlockSubscriber::SubscriberThread()
+{
+}
+
+#endif // ENABLE_ZMQ
+
+// ============================================================================
+// TemplateLongPoller
+// ============================================================================
+
+TemplateLongPoller::~TemplateLongPoller()
+{
+    Stop();
+}
+
+bool TemplateLongPoller::Start(const std::string& name, std::shared_ptr<RpcClient> rpc,
+                               const std::string& template_request, NotifyFn on_change)
+{
+    if (m_running.load() || !rpc) return false;
+
+    UniValue request;
+    if (!request.read(template_request) || !request.isObject()) return false;
+
+    m_name = name;
+    m_rpc = std::move(rpc);
+    m_template_request = template_request;
+    m_on_change = std::move(on_change);
+
+    m_running.store(true);
+    m_thread = std::thread([this] {
+        util::ThreadRename("longpoll." + m_name);
+        PollerThread();
+    });
+    return true;
+}
+
+void TemplateLongPoller::Stop()
+{
+    if (!m_running.exchange(false)) return;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void TemplateLongPoller::PollerThread()
+{
+    std::string longpollid;
+
+    while (m_running.load()) {
+        UniValue request;
+        request.read(m_template_request);
+        if (!longpollid.empty()) request.pushKV("longpollid", longpollid);
+        UniValue params(UniValue::VARR);
+        params.push_back(std::move(request));
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::string response = m_rpc->Call("/", "getblocktemplate", params.write(), LONGPOLL_TIMEOUT_SECONDS);
+
+        UniValue reply;
+        if (response.empty() || !reply.read(response) || !reply.isObject() || !reply.find_value("result").isObject()) {
+            // Timed out waiting (the normal case when nothing changes) or the
+            // daemon is down; don't hammer a daemon that fails straight away
+            if (std::chrono::steady_clock::now() - start < std::chrono::seconds{1}) {
+                std::this_thread::sleep_for(std::chrono::seconds{1});
+            }
+            continue;
+        }
+
+        const UniValue& id = reply.find_value("result").find_value("longpollid");
+        if (!id.isStr()) {
+            LogPrintf("Stratum: %s daemon does not support getblocktemplate long-polling\n", m_name);
+            break;
+        }
+        if (!longpollid.empty() && id.get_str() != longpollid) {
+            m_notifications++;
+            m_on_change();
+        } else if (longpollid.empty()) {
+            LogPrintf("Stratum: %s long-polling getblocktemplate\n", m_name);
+        }
+        longpollid = id.get_str();
+    }
+}
+
+} // namespace stratum
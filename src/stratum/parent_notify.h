@@ -0,0 +1,124 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_PARENT_NOTIFY_H
+#define WATTX_STRATUM_PARENT_NOTIFY_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace stratum {
+
+//! monerod --zmq-pub topic carrying every new main-chain block
+static constexpr const char* MONERO_ZMQ_BLOCK_TOPIC = "json-minimal-chain_main";
+//! bitcoind -zmqpubhashblock topic (also used by its forks)
+static constexpr const char* BITCOIN_ZMQ_BLOCK_TOPIC = "hashblock";
+//! How long one getblocktemplate long-poll request is left waiting; also
+//! bounds how long TemplateLongPoller::Stop() takes
+static constexpr int LONGPOLL_TIMEOUT_SECONDS = 15;
+
+class RpcClient;
+
+/**
+ * ZMQ subscriber that fires a callback for every new parent chain block.
+ *
+ * Connects a SUB socket to a daemon's publisher (monerod zmq-pub, bitcoind
+ * zmqpubhashblock) and invokes the callback once per message on the
+ * subscribed topic, without looking at the payload; the server fetches a
+ * fresh template just as it would after a poll. ZMQ reconnects by itself
+ * when the daemon restarts, and the template poller keeps running alongside
+ * as a fallback for lost notifications.
+ *
+ * Only functional when built with ZMQ support; otherwise Start() fails and
+ * the poller alone drives job updates.
+ */
+class ParentBlockSubscriber {
+public:
+    using NotifyFn = std::function<void()>;
+
+    ParentBlockSubscriber() = default;
+    ~ParentBlockSubscriber();
+
+    ParentBlockSubscriber(const ParentBlockSubscriber&) = delete;
+    ParentBlockSubscriber& operator=(const ParentBlockSubscriber&) = delete;
+
+    /**
+     * Subscribe to @p topic at @p endpoint (e.g. "tcp://127.0.0.1:18083").
+     * @p name is used for the thread name and log messages.
+     */
+    bool Start(const std::string& name, const std::string& endpoint,
+               const std::string& topic, NotifyFn on_block);
+
+    void Stop();
+
+    bool IsRunning() const { return m_running.load(); }
+    uint64_t GetNotificationCount() const { return m_notifications.load(); }
+
+    /** Whether this build can subscribe at all. */
+    static bool IsAvailable();
+
+private:
+    void SubscriberThread();
+
+    std::string m_name;
+    NotifyFn m_on_block;
+    void* m_context{nullptr};
+    void* m_socket{nullptr};
+
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_notifications{0};
+    std::thread m_thread;
+};
+
+/**
+ * getblocktemplate long-poll loop (BIP 22) for bitcoind-family daemons.
+ *
+ * Each request carries the longpollid of the previous answer, and the daemon
+ * holds it until its template changes. A new longpollid means new work, and
+ * fires the callback. Requests that time out are simply issued again. If the
+ * daemon answers without a longpollid it does not support long-polling, and
+ * the loop ends, leaving the server's template poller alone.
+ */
+class TemplateLongPoller {
+public:
+    using NotifyFn = std::function<void()>;
+
+    TemplateLongPoller() = default;
+    ~TemplateLongPoller();
+
+    TemplateLongPoller(const TemplateLongPoller&) = delete;
+    TemplateLongPoller& operator=(const TemplateLongPoller&) = delete;
+
+    /**
+     * Long-poll getblocktemplate on @p rpc with @p template_request, the JSON
+     * template request object the handler also polls with.
+     * @p name is used for the thread name and log messages.
+     */
+    bool Start(const std::string& name, std::shared_ptr<RpcClient> rpc,
+               const std::string& template_request, NotifyFn on_change);
+
+    void Stop();
+
+    uint64_t GetNotificationCount() const { return m_notifications.load(); }
+
+private:
+    void PollerThread();
+
+    std::string m_name;
+    std::shared_ptr<RpcClient> m_rpc;
+    std::string m_template_request;
+    NotifyFn m_on_change;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_notifications{0};
+    std::thread m_thread;
+};
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_PARENT_NOTIFY_H
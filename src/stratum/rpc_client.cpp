@@ -0,0 +1,461 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/rpc_client.h>
+
+#include <compat/compat.h>
+#include <util/strencodings.h>
+#include <util/string.h>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace stratum {
+
+// ============================================================================
+// HttpResponseReader
+// ============================================================================
+
+bool HttpResponseReader::ParseHeaders(std::string_view headers)
+{
+    size_t eol = headers.find("\r\n");
+    std::string_view status_line = headers.substr(0, eol);
+
+    // "HTTP/1.1 200 OK"
+    if (status_line.size() < 12 || status_line.substr(0, 5) != "HTTP/") return false;
+    bool http11 = status_line.substr(5, 3) == "1.1";
+    auto code = ToIntegral<int>(status_line.substr(9, 3));
+    if (!code) return false;
+    m_status_code = *code;
+    m_keep_alive = http11;
+
+    while (eol != std::string_view::npos) {
+        size_t start = eol + 2;
+        eol = headers.find("\r\n", start);
+        std::string_view line = headers.substr(start, eol == std::string_view::npos ? std::string_view::npos : eol - start);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+
+        std::string name = ToLower(util::TrimStringView(line.substr(0, colon)));
+        std::string value = ToLower(util::TrimStringView(line.substr(colon + 1)));
+        if (name == "content-length") {
+            auto len = ToIntegral<uint64_t>(value);
+            if (!len) return false;
+            m_has_length = true;
+            m_content_length = *len;
+        } else if (name == "transfer-encoding") {
+            m_chunked = value.find("chunked") != std::string::npos;
+        } else if (name == "connection") {
+            if (value.find("close") != std::string::npos) m_keep_alive = false;
+            if (value.find("keep-alive") != std::string::npos) m_keep_alive = true;
+        }
+    }
+
+    if (m_status_code == 204 || m_status_code == 304) {
+        m_has_length = true;
+        m_content_length = 0;
+    }
+    // Without any framing the body runs until the peer closes
+    if (!m_chunked && !m_has_length) m_keep_alive = false;
+    return true;
+}
+
+HttpResponseReader::Status HttpResponseReader::Parse(std::string& buf, bool eof)
+{
+    while (!m_have_headers) {
+        size_t end = buf.find("\r\n\r\n");
+        if (end == std::string::npos) {
+            if (eof || buf.size() > MAX_HTTP_HEADER_SIZE) return Status::FAILED;
+            return Status::NEED_MORE;
+        }
+        *this = HttpResponseReader{};
+        if (!ParseHeaders(std::string_view(buf).substr(0, end))) return Status::FAILED;
+        if (m_status_code >= 100 && m_status_code < 200) {
+            // Interim response (100 Continue); the real one follows
+            buf.erase(0, end + 4);
+            continue;
+        }
+        m_have_headers = true;
+        m_pos = end + 4;
+    }
+
+    if (m_chunked) {
+        while (true) {
+            if (!m_in_chunk) {
+                size_t eol = buf.find("\r\n", m_pos);
+                if (eol == std::string::npos) return eof ? Status::FAILED : Status::NEED_MORE;
+
+                // Hex size, optionally followed by ";extensions"
+                uint64_t size = 0;
+                size_t digits = 0;
+                for (size_t i = m_pos; i < eol && buf[i] != ';'; ++i) {
+                    int v = HexDigit(buf[i]);
+                    if (v < 0 || ++digits > 15) return Status::FAILED;
+                    size = (size << 4) | static_cast<uint64_t>(v);
+                }
+                if (digits == 0) return Status::FAILED;
+
+                if (size == 0) {
+                    // Last chunk, then optional trailers up to an empty line
+                    size_t end;
+                    if (buf.compare(eol + 2, 2, "\r\n") == 0) {
+                        end = eol + 4;
+                    } else {
+                        size_t trailers = buf.find("\r\n\r\n", eol + 2);
+                        if (trailers == std::string::npos) return eof ? Status::FAILED : Status::NEED_MORE;
+                        end = trailers + 4;
+                    }
+                    buf.erase(0, end);
+                    return Status::DONE;
+                }
+                m_in_chunk = true;
+                m_chunk_remaining = size + 2;
+                m_pos = eol + 2;
+            }
+            if (buf.size() - m_pos < m_chunk_remaining) return eof ? Status::FAILED : Status::NEED_MORE;
+            m_body.append(buf, m_pos, m_chunk_remaining - 2);
+            m_pos += m_chunk_remaining;
+            m_in_chunk = false;
+        }
+    }
+
+    if (m_has_length) {
+        if (buf.size() - m_pos < m_content_length) return eof ? Status::FAILED : Status::NEED_MORE;
+        m_body.assign(buf, m_pos, m_content_length);
+        buf.erase(0, m_pos + m_content_length);
+        return Status::DONE;
+    }
+
+    if (!eof) return Status::NEED_MORE;
+    m_body.assign(buf, m_pos);
+    buf.clear();
+    return Status::DONE;
+}
+
+// ============================================================================
+// RpcClient
+// ============================================================================
+
+struct RpcClient::Connection {
+    int fd{-1};
+    std::string inbuf;            //!< bytes received past the last response
+    int timeout_seconds{0};       //!< socket timeouts currently applied
+    bool reusable{false};
+    Clock::time_point last_used;
+
+    ~Connection()
+    {
+        if (fd >= 0) close(fd);
+    }
+
+    void SetTimeout(int seconds)
+    {
+        if (seconds == timeout_seconds) return;
+        struct timeval tv;
+        tv.tv_sec = seconds;
+        tv.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        timeout_seconds = seconds;
+    }
+
+    bool SendAll(const std::string& data)
+    {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    //! An idle keep-alive socket must not be readable: data or EOF means the daemon gave up on it
+    bool IsIdleHealthy() const
+    {
+        if (!inbuf.empty()) return false;
+        struct pollfd pfd{};
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        return poll(&pfd, 1, 0) == 0;
+    }
+};
+
+RpcClient::RpcClient(std::string host, uint16_t port, std::string auth)
+    : m_host(std::move(host)), m_port(port)
+{
+    if (!auth.empty()) {
+        m_auth_header = "Authorization: Basic " + EncodeBase64(auth) + "\r\n";
+    }
+}
+
+RpcClient::~RpcClient() = default;
+
+size_t RpcClient::GetIdleCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idle.size();
+}
+
+void RpcClient::Reset()
+{
+    std::vector<std::unique_ptr<Connection>> idle;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        idle.swap(m_idle);
+    }
+    std::lock_guard<std::mutex> lock(m_resolve_mutex);
+    m_addrs.clear();
+}
+
+std::string RpcClient::BuildRequest(const char* method, const std::string& path, const std::string* body) const
+{
+    std::string request;
+    request.reserve(160 + m_host.size() + m_auth_header.size() + path.size() + (body ? body->size() : 0));
+    request += method;
+    request += ' ';
+    request += path;
+    request += " HTTP/1.1\r\nHost: ";
+    request += m_host;
+    request += ':';
+    request += std::to_string(m_port);
+    request += "\r\n";
+    request += m_auth_header;
+    if (body) {
+        request += "Content-Type: application/json\r\nContent-Length: ";
+        request += std::to_string(body->size());
+        request += "\r\n";
+    }
+    request += "Connection: keep-alive\r\n\r\n";
+    if (body) request += *body;
+    return request;
+}
+
+std::unique_ptr<RpcClient::Connection> RpcClient::Acquire(int timeout_seconds, bool& reused)
+{
+    reused = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto now = Clock::now();
+        while (!m_idle.empty()) {
+            std::unique_ptr<Connection> conn = std::move(m_idle.back());
+            m_idle.pop_back();
+            if (now - conn->last_used > std::chrono::seconds(RPC_IDLE_CONNECTION_SECONDS)) continue;
+            if (!conn->IsIdleHealthy()) continue;
+            conn->SetTimeout(timeout_seconds);
+            reused = true;
+            return conn;
+        }
+    }
+    return Connect(timeout_seconds);
+}
+
+void RpcClient::Release(std::unique_ptr<Connection> conn)
+{
+    if (!conn->reusable || !conn->inbuf.empty()) return;
+    conn->last_used = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle.size() < MAX_RPC_IDLE_CONNECTIONS) m_idle.push_back(std::move(conn));
+}
+
+std::unique_ptr<RpcClient::Connection> RpcClient::Connect(int timeout_seconds)
+{
+    std::vector<std::vector<unsigned char>> addrs;
+    {
+        std::lock_guard<std::mutex> lock(m_resolve_mutex);
+        if (m_addrs.empty() || Clock::now() - m_resolved_at > std::chrono::seconds(RPC_DNS_CACHE_SECONDS)) {
+            struct addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            struct addrinfo* res = nullptr;
+            if (getaddrinfo(m_host.c_str(), std::to_string(m_port).c_str(), &hints, &res) == 0) {
+                m_addrs.clear();
+                for (struct addrinfo* ai = res; ai; ai = ai->ai_next) {
+                    auto* p = reinterpret_cast<const unsigned char*>(ai->ai_addr);
+                    m_addrs.emplace_back(p, p + ai->ai_addrlen);
+                }
+                m_resolved_at = Clock::now();
+                freeaddrinfo(res);
+            }
+            // On failure keep using a stale result, if there is one
+        }
+        addrs = m_addrs;
+    }
+
+    for (const auto& raw : addrs) {
+        const auto* sa = reinterpret_cast<const struct sockaddr*>(raw.data());
+        auto conn = std::make_unique<Connection>();
+        conn->fd = socket(sa->sa_family, SOCK_STREAM, 0);
+        if (conn->fd < 0) continue;
+
+        // Non-blocking connect so an unreachable daemon costs the RPC timeout, not the kernel's
+        int flags = fcntl(conn->fd, F_GETFL, 0);
+        fcntl(conn->fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = connect(conn->fd, sa, static_cast<socklen_t>(raw.size()));
+        if (rc < 0 && errno == EINPROGRESS) {
+            struct pollfd pfd{};
+            pfd.fd = conn->fd;
+            pfd.events = POLLOUT;
+            int err = 0;
+            socklen_t err_len = sizeof(err);
+            if (poll(&pfd, 1, timeout_seconds * 1000) == 1 &&
+                getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) == 0 && err == 0) {
+                rc = 0;
+            }
+        }
+        if (rc < 0) continue;
+        fcntl(conn->fd, F_SETFL, flags);
+
+        int one = 1;
+        setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+        setsockopt(conn->fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        conn->SetTimeout(timeout_seconds);
+        return conn;
+    }
+
+    // Nothing answered; the daemon may have moved, so resolve again next time
+    std::lock_guard<std::mutex> lock(m_resolve_mutex);
+    m_addrs.clear();
+    return nullptr;
+}
+
+bool RpcClient::ReadResponse(Connection& conn, std::string& body, bool& got_bytes)
+{
+    HttpResponseReader reader;
+    bool eof = false;
+    char buffer[16384];
+    while (true) {
+        switch (reader.Parse(conn.inbuf, eof)) {
+        case HttpResponseReader::Status::DONE:
+            body = std::move(reader.Body());
+            conn.reusable = reader.KeepAlive() && !eof;
+            return true;
+        case HttpResponseReader::Status::FAILED:
+            return false;
+        case HttpResponseReader::Status::NEED_MORE:
+            break;
+        }
+        if (eof) return false;
+
+        ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            got_bytes = true;
+            conn.inbuf.append(buffer, n);
+        } else if (n == 0) {
+            eof = true;
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+std::string RpcClient::Post(const std::string& path, const std::string& body, int timeout_seconds)
+{
+    return Exchange(BuildRequest("POST", path, &body), timeout_seconds);
+}
+
+std::string RpcClient::Get(const std::string& path, int timeout_seconds)
+{
+    return Exchange(BuildRequest("GET", path, nullptr), timeout_seconds);
+}
+
+std::string RpcClient::Exchange(const std::string& request, int timeout_seconds)
+{
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        std::unique_ptr<Connection> conn = Acquire(timeout_seconds, reused);
+        if (!conn) return "";
+
+        std::string response;
+        bool got_bytes = false;
+        if (conn->SendAll(request) && ReadResponse(*conn, response, got_bytes)) {
+            Release(std::move(conn));
+            return response;
+        }
+        // Only a stale pooled connection that never answered is worth retrying
+        if (!reused || got_bytes) break;
+    }
+    return "";
+}
+
+std::vector<std::string> RpcClient::PostPipelined(const std::string& path, const std::vector<std::string>& bodies,
+                                                  int timeout_seconds)
+{
+    std::vector<std::string> responses(bodies.size());
+    if (bodies.empty()) return responses;
+    if (bodies.size() == 1) {
+        responses[0] = Post(path, bodies[0], timeout_seconds);
+        return responses;
+    }
+
+    std::string requests;
+    for (const auto& body : bodies) requests += BuildRequest("POST", path, &body);
+
+    bool reused = false;
+    std::unique_ptr<Connection> conn = Acquire(timeout_seconds, reused);
+    if (!conn) return responses;
+    if (!conn->SendAll(requests) && reused) {
+        // The pooled socket was dead before anything could reach the daemon
+        conn = Connect(timeout_seconds);
+        if (!conn || !conn->SendAll(requests)) return responses;
+    }
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        bool got_bytes = false;
+        if (!ReadResponse(*conn, responses[i], got_bytes)) return responses;
+        if (!conn->reusable && i + 1 < bodies.size()) return responses;
+    }
+    Release(std::move(conn));
+    return responses;
+}
+
+std::string RpcClient::Call(const std::string& path, const std::string& method, const std::string& params,
+                            int timeout_seconds)
+{
+    std::string body = "{\"jsonrpc\":\"2.0\",\"id\":\"0\",\"method\":\"" + method + "\",\"params\":" + params + "}";
+    return Post(path, body, timeout_seconds);
+}
+
+std::string RpcClient::CallBatch(const std::string& path, const std::vector<std::pair<std::string, std::string>>& calls,
+                                 int timeout_seconds)
+{
+    std::string body = "[";
+    for (size_t i = 0; i < calls.size(); ++i) {
+        if (i) body += ',';
+        body += "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(i) + ",\"method\":\"" + calls[i].first +
+                "\",\"params\":" + calls[i].second + "}";
+    }
+    body += ']';
+    return Post(path, body, timeout_seconds);
+}
+
+// ============================================================================
+// Shared clients
+// ============================================================================
+
+std::shared_ptr<RpcClient> GetRpcClient(const std::string& host, uint16_t port, const std::string& auth)
+{
+    static std::mutex s_mutex;
+    static std::map<std::tuple<std::string, uint16_t, std::string>, std::shared_ptr<RpcClient>> s_clients;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& client = s_clients[{host, port, auth}];
+    if (!client) client = std::make_shared<RpcClient>(host, port, auth);
+    return client;
+}
+
+} // namespace stratum
@@ -0,0 +1,164 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_RPC_CLIENT_H
+#define WATTX_STRATUM_RPC_CLIENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace stratum {
+
+//! Default send/receive timeout for a daemon RPC call
+static constexpr int DEFAULT_RPC_TIMEOUT_SECONDS = 10;
+//! Idle keep-alive connections kept open per endpoint
+static constexpr size_t MAX_RPC_IDLE_CONNECTIONS = 4;
+//! Idle connections older than this are closed instead of reused
+static constexpr int RPC_IDLE_CONNECTION_SECONDS = 30;
+//! How long a resolved daemon address is trusted before resolving again
+static constexpr int RPC_DNS_CACHE_SECONDS = 300;
+//! Responses with a larger header block are treated as malformed
+static constexpr size_t MAX_HTTP_HEADER_SIZE = 64 * 1024;
+
+/**
+ * Incremental HTTP/1.x response decoder.
+ *
+ * Fed from a connection's receive buffer as bytes arrive. Bodies delimited
+ * by Content-Length, chunked transfer encoding or connection close are all
+ * supported. A completed response is erased from the front of the buffer,
+ * so anything after it (the next pipelined response) stays in place.
+ */
+class HttpResponseReader {
+public:
+    enum class Status {
+        NEED_MORE, //!< feed more bytes and call again
+        DONE,      //!< Body(), StatusCode() and KeepAlive() are valid
+        FAILED,    //!< malformed or truncated response
+    };
+
+    /**
+     * Try to decode one response from the front of @p buf.
+     * @param eof the peer has closed the connection; no more bytes will come
+     */
+    Status Parse(std::string& buf, bool eof);
+
+    int StatusCode() const { return m_status_code; }
+    //! Whether the connection may carry another request afterwards
+    bool KeepAlive() const { return m_keep_alive; }
+    std::string& Body() { return m_body; }
+
+private:
+    bool ParseHeaders(std::string_view headers);
+
+    bool m_have_headers{false};
+    size_t m_pos{0};           //!< first undecoded byte of the buffer
+    int m_status_code{0};
+    bool m_keep_alive{false};
+    bool m_chunked{false};
+    bool m_has_length{false};
+    uint64_t m_content_length{0};
+    bool m_in_chunk{false};
+    uint64_t m_chunk_remaining{0}; //!< payload bytes plus the trailing CRLF
+    std::string m_body;
+};
+
+/**
+ * Keep-alive HTTP/JSON-RPC client for one daemon endpoint.
+ *
+ * Shared by the stratum servers, parent chain handlers, mining rewards and
+ * the bridge, which all talk to monerod, bitcoind-style daemons or WATTx RPC
+ * over plain HTTP. Connections are HTTP/1.1 keep-alive and returned to a
+ * small idle pool after each exchange; the resolved address is cached so the
+ * hot path does neither a DNS lookup nor a TCP handshake.
+ *
+ * A request that fails on a reused connection before any response byte has
+ * arrived (the daemon closed it while idle) is retried once on a fresh
+ * connection. All methods are thread-safe; concurrent calls simply use
+ * different connections. Failures return an empty string, as the per-class
+ * helpers this replaces did.
+ */
+class RpcClient {
+public:
+    /** @param auth "user:password" for HTTP Basic authentication, or empty */
+    RpcClient(std::string host, uint16_t port, std::string auth = {});
+    ~RpcClient();
+
+    RpcClient(const RpcClient&) = delete;
+    RpcClient& operator=(const RpcClient&) = delete;
+
+    /** POST a JSON body and return the response body ("" on failure). */
+    std::string Post(const std::string& path, const std::string& body,
+                     int timeout_seconds = DEFAULT_RPC_TIMEOUT_SECONDS);
+
+    /** GET a path, for REST-style daemons ("" on failure). */
+    std::string Get(const std::string& path, int timeout_seconds = DEFAULT_RPC_TIMEOUT_SECONDS);
+
+    /**
+     * Pipeline several POSTs over one connection: all requests are written
+     * back to back, then the responses are read in order. Entries whose
+     * response never arrived are empty; they are not retried, since the
+     * daemon may already have acted on them.
+     */
+    std::vector<std::string> PostPipelined(const std::string& path, const std::vector<std::string>& bodies,
+                                           int timeout_seconds = DEFAULT_RPC_TIMEOUT_SECONDS);
+
+    /** Single JSON-RPC 2.0 call; @p params is a JSON array or object. */
+    std::string Call(const std::string& path, const std::string& method, const std::string& params,
+                     int timeout_seconds = DEFAULT_RPC_TIMEOUT_SECONDS);
+
+    /**
+     * JSON-RPC 2.0 batch: one request carrying every (method, params) pair,
+     * with ids equal to their index. Returns the raw response array; the
+     * daemon may answer the elements in any order, so match on "id".
+     */
+    std::string CallBatch(const std::string& path, const std::vector<std::pair<std::string, std::string>>& calls,
+                          int timeout_seconds = DEFAULT_RPC_TIMEOUT_SECONDS);
+
+    /** Close all idle connections and forget the resolved address. */
+    void Reset();
+
+    const std::string& GetHost() const { return m_host; }
+    uint16_t GetPort() const { return m_port; }
+    size_t GetIdleCount() const;
+
+private:
+    struct Connection;
+    using Clock = std::chrono::steady_clock;
+
+    std::unique_ptr<Connection> Acquire(int timeout_seconds, bool& reused);
+    std::unique_ptr<Connection> Connect(int timeout_seconds);
+    void Release(std::unique_ptr<Connection> conn);
+    std::string BuildRequest(const char* method, const std::string& path, const std::string* body) const;
+    std::string Exchange(const std::string& request, int timeout_seconds);
+    bool ReadResponse(Connection& conn, std::string& body, bool& got_bytes);
+
+    const std::string m_host;
+    const uint16_t m_port;
+    std::string m_auth_header; //!< precomputed "Authorization: ..." line, or empty
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Connection>> m_idle;
+
+    //! Cached resolution of m_host, in getaddrinfo() order
+    std::mutex m_resolve_mutex;
+    std::vector<std::vector<unsigned char>> m_addrs; //!< raw sockaddr bytes
+    Clock::time_point m_resolved_at;
+};
+
+/**
+ * Process-wide client for an endpoint, created on first use. Callers that
+ * talk to the same daemon with the same credentials share its connections.
+ */
+std::shared_ptr<RpcClient> GetRpcClient(const std::string& host, uint16_t port, const std::string& auth = {});
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_RPC_CLIENT_H
@@ -0,0 +1,69 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/share_stats.h>
+
+#include <functional>
+#include <iterator>
+
+namespace stratum {
+
+void HashrateWindow::Add(uint64_t difficulty, int64_t now, int64_t bucket_seconds)
+{
+    const int64_t epoch = now / bucket_seconds;
+    Bucket& bucket = m_buckets[static_cast<uint64_t>(epoch) % BUCKETS];
+    if (bucket.epoch != epoch) {
+        bucket.epoch = epoch;
+        bucket.difficulty = 0;
+    }
+    bucket.difficulty += difficulty;
+}
+
+uint64_t HashrateWindow::Sum(int64_t now, int64_t bucket_seconds) const
+{
+    const int64_t epoch = now / bucket_seconds;
+    uint64_t sum = 0;
+    for (const Bucket& bucket : m_buckets) {
+        if (bucket.epoch > epoch - static_cast<int64_t>(BUCKETS) && bucket.epoch <= epoch) {
+            sum += bucket.difficulty;
+        }
+    }
+    return sum;
+}
+
+void MinerShareStats::Record(const std::string& miner, const std::string& chain, uint64_t difficulty, int64_t now)
+{
+    Shard& shard = m_shards[std::hash<std::string>{}(miner) % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.miners[miner][chain].Add(difficulty, now, m_bucket_seconds);
+}
+
+MinerShareStats::Snapshot MinerShareStats::Collect(int64_t now)
+{
+    Snapshot result;
+    for (Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto miner_it = shard.miners.begin(); miner_it != shard.miners.end();) {
+            bool active = false;
+            for (const auto& [chain, window] : miner_it->second) {
+                const uint64_t sum = window.Sum(now, m_bucket_seconds);
+                if (sum == 0) continue;
+                result[chain][miner_it->first] = sum;
+                active = true;
+            }
+            miner_it = active ? std::next(miner_it) : shard.miners.erase(miner_it);
+        }
+    }
+    return result;
+}
+
+void MinerShareStats::Clear()
+{
+    for (Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.miners.clear();
+    }
+}
+
+} // namespace stratum
@@ -0,0 +1,77 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_SHARE_STATS_H
+#define WATTX_STRATUM_SHARE_STATS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace stratum {
+
+/**
+ * Sum of share difficulty over a sliding window, in a fixed ring of time
+ * buckets. Adding a share and reading the sum cost the same however many
+ * shares are in the window.
+ */
+class HashrateWindow {
+public:
+    static constexpr size_t BUCKETS = 10;
+
+    void Add(uint64_t difficulty, int64_t now, int64_t bucket_seconds);
+    /** Difficulty of the shares in the last BUCKETS buckets */
+    uint64_t Sum(int64_t now, int64_t bucket_seconds) const;
+
+private:
+    struct Bucket {
+        int64_t epoch{-1};
+        uint64_t difficulty{0};
+    };
+    std::array<Bucket, BUCKETS> m_buckets;
+};
+
+/**
+ * Accepted share difficulty per miner and parent chain, over a sliding window.
+ *
+ * Miners are sharded by address hash, so concurrent share submissions only
+ * contend when their miners land on the same shard. The periodic hashrate
+ * update takes a snapshot one shard at a time.
+ */
+class MinerShareStats {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    //! miner address -> window difficulty, per chain
+    using Snapshot = std::unordered_map<std::string, std::unordered_map<std::string, uint64_t>>;
+
+    explicit MinerShareStats(int64_t window_seconds = 600)
+        : m_bucket_seconds(std::max<int64_t>(window_seconds / HashrateWindow::BUCKETS, 1)) {}
+
+    int64_t WindowSeconds() const { return m_bucket_seconds * HashrateWindow::BUCKETS; }
+
+    void Record(const std::string& miner, const std::string& chain, uint64_t difficulty, int64_t now);
+
+    /** Window difficulty per chain and miner; forgets the miners with none */
+    Snapshot Collect(int64_t now);
+
+    void Clear();
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        //! miner address -> chain -> window
+        std::unordered_map<std::string, std::unordered_map<std::string, HashrateWindow>> miners;
+    };
+
+    const int64_t m_bucket_seconds;
+    std::array<Shard, SHARDS> m_shards;
+};
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_SHARE_STATS_H
@@ -0,0 +1,95 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/share_validation.h>
+
+#include <logging.h>
+#include <util/threadnames.h>
+
+#include <exception>
+
+namespace stratum {
+
+ShareValidationPool::~ShareValidationPool()
+{
+    Stop();
+}
+
+bool ShareValidationPool::Start(int num_threads, size_t max_queue, const std::string& thread_prefix)
+{
+    if (m_running.load()) return false;
+
+    if (num_threads < 1) num_threads = 1;
+    m_max_queue = max_queue > 0 ? max_queue : 1;
+
+    m_running.store(true);
+    m_threads.clear();
+    for (int i = 0; i < num_threads; ++i) {
+        m_threads.emplace_back([this, i, thread_prefix] {
+            util::ThreadRename(thread_prefix + "." + std::to_string(i));
+            WorkerThread();
+        });
+    }
+
+    LogPrintf("Stratum: %s share validation started with %d threads (queue %u)\n",
+              thread_prefix, num_threads, m_max_queue);
+    return true;
+}
+
+void ShareValidationPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running.exchange(false)) return;
+        m_queue.clear();
+    }
+    m_cv.notify_all();
+
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_threads.clear();
+}
+
+bool ShareValidationPool::Submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running.load() || m_queue.size() >= m_max_queue) {
+            m_rejected++;
+            return false;
+        }
+        m_queue.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+size_t ShareValidationPool::GetQueueDepth() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+void ShareValidationPool::WorkerThread()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return !m_running.load() || !m_queue.empty(); });
+            if (!m_running.load()) return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LogPrintf("Stratum: Share validation error: %s\n", e.what());
+        }
+    }
+}
+
+} // namespace stratum
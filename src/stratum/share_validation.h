@@ -0,0 +1,79 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_SHARE_VALIDATION_H
+#define WATTX_STRATUM_SHARE_VALIDATION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stratum {
+
+//! Default number of threads verifying submitted shares
+static constexpr int DEFAULT_SHARE_VALIDATION_THREADS = 2;
+//! Default number of submissions allowed to wait for a validation thread
+static constexpr size_t DEFAULT_SHARE_VALIDATION_QUEUE = 4096;
+
+/**
+ * Bounded FIFO of share submissions served by a fixed set of threads.
+ *
+ * I/O threads hand each parsed submit to Submit() and return to the socket
+ * loop straight away; hashing, target checks and block submission happen on
+ * the validation threads, which send the response themselves. When the queue
+ * is full the submission is refused, so a burst of shares turns into fast
+ * "busy" errors instead of unbounded memory growth and response latency.
+ */
+class ShareValidationPool {
+public:
+    using Task = std::function<void()>;
+
+    ShareValidationPool() = default;
+    ~ShareValidationPool();
+
+    ShareValidationPool(const ShareValidationPool&) = delete;
+    ShareValidationPool& operator=(const ShareValidationPool&) = delete;
+
+    /** Spawn the validation threads. */
+    bool Start(int num_threads, size_t max_queue, const std::string& thread_prefix);
+
+    /** Stop the threads. Tasks still queued are discarded. */
+    void Stop();
+
+    bool IsRunning() const { return m_running.load(); }
+
+    /**
+     * Queue a validation task.
+     * @return false if the pool is stopped or the queue is full
+     */
+    bool Submit(Task task);
+
+    size_t GetQueueDepth() const;
+    int GetThreadCount() const { return static_cast<int>(m_threads.size()); }
+    uint64_t GetRejectedCount() const { return m_rejected.load(); }
+
+private:
+    void WorkerThread();
+
+    std::atomic<bool> m_running{false};
+    size_t m_max_queue{DEFAULT_SHARE_VALIDATION_QUEUE};
+    std::vector<std::thread> m_threads;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Task> m_queue;
+
+    std::atomic<uint64_t> m_rejected{0};
+};
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_SHARE_VALIDATION_H
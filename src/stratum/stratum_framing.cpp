@@ -0,0 +1,346 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/stratum_framing.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace stratum {
+
+// ============================================================================
+// StratumLineFramer
+// ============================================================================
+
+static size_t RoundUpPow2(size_t n)
+{
+    size_t v = 1;
+    while (v < n) v <<= 1;
+    return v;
+}
+
+StratumLineFramer::StratumLineFramer(size_t capacity)
+    : m_buf(RoundUpPow2(std::max<size_t>(capacity, 64))),
+      m_mask(m_buf.size() - 1)
+{
+}
+
+std::pair<char*, size_t> StratumLineFramer::WriteSpace()
+{
+    size_t free_space = m_buf.size() - Size();
+    size_t offset = m_tail & m_mask;
+    size_t contiguous = std::min(free_space, m_buf.size() - offset);
+    return {m_buf.data() + offset, contiguous};
+}
+
+void StratumLineFramer::Commit(size_t n)
+{
+    m_tail += n;
+}
+
+bool StratumLineFramer::Append(const char* data, size_t len)
+{
+    if (len > m_buf.size() - Size()) return false;
+    while (len > 0) {
+        auto [dst, room] = WriteSpace();
+        size_t chunk = std::min(room, len);
+        std::memcpy(dst, data, chunk);
+        Commit(chunk);
+        data += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool StratumLineFramer::NextLine(std::string_view& line)
+{
+    while (true) {
+        // Find the next newline, searching each contiguous segment with memchr
+        uint64_t newline = m_tail;
+        while (m_scan < m_tail) {
+            size_t offset = m_scan & m_mask;
+            size_t len = std::min<uint64_t>(m_tail - m_scan, m_buf.size() - offset);
+            const void* hit = std::memchr(m_buf.data() + offset, '\n', len);
+            if (hit) {
+                newline = m_scan + (static_cast<const char*>(hit) - (m_buf.data() + offset));
+                break;
+            }
+            m_scan += len;
+        }
+        if (newline == m_tail) return false;
+
+        uint64_t start = m_head;
+        uint64_t end = newline;
+        m_head = newline + 1;
+        m_scan = m_head;
+
+        if (end > start && m_buf[(end - 1) & m_mask] == '\r') --end;
+        if (end == start) continue;
+
+        size_t begin_off = start & m_mask;
+        size_t len = end - start;
+        if (begin_off + len <= m_buf.size()) {
+            line = std::string_view(m_buf.data() + begin_off, len);
+        } else {
+            // Line wraps around the end of the ring; linearize it
+            size_t first = m_buf.size() - begin_off;
+            m_scratch.assign(m_buf.data() + begin_off, first);
+            m_scratch.append(m_buf.data(), len - first);
+            line = m_scratch;
+        }
+        return true;
+    }
+}
+
+bool StratumLineFramer::NextChunk(std::string_view& chunk)
+{
+    if (m_head == m_tail) return false;
+    size_t offset = m_head & m_mask;
+    size_t len = std::min<uint64_t>(m_tail - m_head, m_buf.size() - offset);
+    chunk = std::string_view(m_buf.data() + offset, len);
+    m_head += len;
+    m_scan = m_head;
+    return true;
+}
+
+// ============================================================================
+// Fast submit parser
+// ============================================================================
+
+namespace {
+
+/** Minimal forward-only JSON cursor over a string_view. */
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view s) : m_s(s) {}
+
+    void SkipWs()
+    {
+        while (m_p < m_s.size() && (m_s[m_p] == ' ' || m_s[m_p] == '\t' || m_s[m_p] == '\r' || m_s[m_p] == '\n')) ++m_p;
+    }
+
+    bool Eat(char c)
+    {
+        SkipWs();
+        if (m_p < m_s.size() && m_s[m_p] == c) {
+            ++m_p;
+            return true;
+        }
+        return false;
+    }
+
+    char Peek()
+    {
+        SkipWs();
+        return m_p < m_s.size() ? m_s[m_p] : '\0';
+    }
+
+    //! String without escape sequences; the view excludes the quotes
+    bool String(std::string_view& out)
+    {
+        if (!Eat('"')) return false;
+        size_t start = m_p;
+        while (m_p < m_s.size() && m_s[m_p] != '"') {
+            if (m_s[m_p] == '\\') return false;
+            ++m_p;
+        }
+        if (m_p >= m_s.size()) return false;
+        out = m_s.substr(start, m_p - start);
+        ++m_p;
+        return true;
+    }
+
+    //! Raw scalar token (string with quotes, number, true/false/null)
+    bool Scalar(std::string_view& out)
+    {
+        char c = Peek();
+        size_t start = m_p;
+        if (c == '"') {
+            std::string_view dummy;
+            if (!String(dummy)) return false;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            if (!Number()) return false;
+        } else if (!Literal("null") && !Literal("true") && !Literal("false")) {
+            return false;
+        }
+        out = m_s.substr(start, m_p - start);
+        return true;
+    }
+
+    //! Only whitespace remains
+    bool AtEnd()
+    {
+        SkipWs();
+        return m_p == m_s.size();
+    }
+
+    //! Skip any value, including nested containers
+    bool Skip()
+    {
+        char c = Peek();
+        if (c != '{' && c != '[') {
+            std::string_view dummy;
+            if (c == '"') return SkipString();
+            return Scalar(dummy);
+        }
+        int depth = 0;
+        while (m_p < m_s.size()) {
+            char ch = m_s[m_p];
+            if (ch == '"') {
+                if (!SkipString()) return false;
+                continue;
+            }
+            if (ch == '{' || ch == '[') ++depth;
+            else if (ch == '}' || ch == ']') {
+                if (--depth == 0) {
+                    ++m_p;
+                    return true;
+                }
+            }
+            ++m_p;
+        }
+        return false;
+    }
+
+private:
+    bool Digit() const { return m_p < m_s.size() && m_s[m_p] >= '0' && m_s[m_p] <= '9'; }
+
+    bool Digits()
+    {
+        if (!Digit()) return false;
+        while (Digit()) ++m_p;
+        return true;
+    }
+
+    //! JSON number: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool Number()
+    {
+        if (m_p < m_s.size() && m_s[m_p] == '-') ++m_p;
+        if (m_p < m_s.size() && m_s[m_p] == '0') {
+            ++m_p;
+        } else if (!Digits()) {
+            return false;
+        }
+        if (m_p < m_s.size() && m_s[m_p] == '.') {
+            ++m_p;
+            if (!Digits()) return false;
+        }
+        if (m_p < m_s.size() && (m_s[m_p] == 'e' || m_s[m_p] == 'E')) {
+            ++m_p;
+            if (m_p < m_s.size() && (m_s[m_p] == '+' || m_s[m_p] == '-')) ++m_p;
+            if (!Digits()) return false;
+        }
+        return true;
+    }
+
+    bool Literal(std::string_view word)
+    {
+        if (m_s.substr(m_p, word.size()) != word) return false;
+        m_p += word.size();
+        return true;
+    }
+
+    //! Skip a string, tolerating escapes
+    bool SkipString()
+    {
+        if (!Eat('"')) return false;
+        while (m_p < m_s.size()) {
+            if (m_s[m_p] == '\\') {
+                m_p += 2;
+                continue;
+            }
+            if (m_s[m_p] == '"') {
+                ++m_p;
+                return true;
+            }
+            ++m_p;
+        }
+        return false;
+    }
+
+    std::string_view m_s;
+    size_t m_p{0};
+};
+
+bool ParseSubmitParams(JsonCursor& cur, StratumSubmitView& out)
+{
+    if (cur.Eat('[')) {
+        // ["worker", "job_id", "extranonce2", "ntime", "nonce", ...]
+        std::string_view* slots[] = {&out.worker, &out.job_id, &out.extranonce2, &out.ntime, &out.nonce};
+        size_t index = 0;
+        if (cur.Eat(']')) return true;
+        do {
+            if (index < std::size(slots)) {
+                if (!cur.String(*slots[index])) return false;
+            } else if (!cur.Skip()) {
+                return false;
+            }
+            ++index;
+        } while (cur.Eat(','));
+        return cur.Eat(']') && index >= std::size(slots);
+    }
+
+    if (cur.Eat('{')) {
+        // {"id":"session", "job_id":"...", "nonce":"...", "result":"..."}
+        if (cur.Eat('}')) return true;
+        do {
+            std::string_view key;
+            if (!cur.String(key) || !cur.Eat(':')) return false;
+            if (key == "job_id") {
+                if (!cur.String(out.job_id)) return false;
+            } else if (key == "nonce") {
+                if (!cur.String(out.nonce)) return false;
+            } else if (key == "result") {
+                if (!cur.String(out.result)) return false;
+            } else if (key == "id") {
+                if (!cur.String(out.worker)) return false;
+            } else if (!cur.Skip()) {
+                return false;
+            }
+        } while (cur.Eat(','));
+        return cur.Eat('}');
+    }
+
+    return false;
+}
+
+} // namespace
+
+bool ParseStratumSubmit(std::string_view message, StratumSubmitView& out)
+{
+    // Cheap reject before doing any real work
+    if (message.find("submit") == std::string_view::npos) return false;
+
+    out = StratumSubmitView{};
+    JsonCursor cur(message);
+    if (!cur.Eat('{')) return false;
+
+    bool have_params = false;
+    if (!cur.Eat('}')) {
+        do {
+            std::string_view key;
+            if (!cur.String(key) || !cur.Eat(':')) return false;
+            if (key == "method") {
+                if (!cur.String(out.method)) return false;
+            } else if (key == "id") {
+                // JSON-RPC ids are a string, a number or null
+                if (!cur.Scalar(out.id) || out.id == "true" || out.id == "false") return false;
+            } else if (key == "params") {
+                if (!ParseSubmitParams(cur, out)) return false;
+                have_params = true;
+            } else if (!cur.Skip()) {
+                return false;
+            }
+        } while (cur.Eat(','));
+        if (!cur.Eat('}')) return false;
+    }
+    if (!cur.AtEnd()) return false;
+
+    if (out.method != "submit" && out.method != "mining.submit") return false;
+    if (!have_params || out.job_id.empty() || out.nonce.empty()) return false;
+    if (out.id.empty()) out.id = "null";
+    return true;
+}
+
+} // namespace stratum
@@ -0,0 +1,101 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_FRAMING_H
+#define WATTX_STRATUM_FRAMING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace stratum {
+
+/**
+ * Fixed-capacity ring buffer that splits a byte stream into
+ * newline-delimited stratum messages.
+ *
+ * Sockets read straight into the free region returned by WriteSpace(), so
+ * inbound bytes are copied exactly once. NextLine() hands out views into the
+ * ring; only a line that wraps around the end of the ring is linearized, into
+ * a scratch buffer that is reused across calls. Views stay valid until the
+ * next call to NextLine() or Commit().
+ */
+class StratumLineFramer {
+public:
+    //! Capacity is rounded up to a power of two
+    explicit StratumLineFramer(size_t capacity);
+
+    /** Contiguous free region to read into (may be shorter than the total free space). */
+    std::pair<char*, size_t> WriteSpace();
+
+    /** Mark @p n bytes of the region returned by WriteSpace() as filled. */
+    void Commit(size_t n);
+
+    /** Copy @p len bytes in; returns false if they do not fit. */
+    bool Append(const char* data, size_t len);
+
+    /**
+     * Extract the next complete line, without the trailing "\n" or "\r\n".
+     * Empty lines are skipped.
+     * @return false if no complete line is buffered
+     */
+    bool NextLine(std::string_view& line);
+
+    /**
+     * Take everything buffered, for binary protocols that do their own
+     * framing. A buffer that wraps around the end of the ring comes out in
+     * two calls.
+     * @return false if nothing is buffered
+     */
+    bool NextChunk(std::string_view& chunk);
+
+    /** True when the ring is full without containing a newline. */
+    bool Overflowed() const { return Size() == m_buf.size() && m_scan == m_tail; }
+
+    size_t Size() const { return m_tail - m_head; }
+    size_t Capacity() const { return m_buf.size(); }
+
+private:
+    std::vector<char> m_buf;
+    size_t m_mask;
+    uint64_t m_head{0}; //!< first unread byte (monotonic)
+    uint64_t m_tail{0}; //!< one past the last written byte (monotonic)
+    uint64_t m_scan{0}; //!< bytes before this position contain no newline
+    std::string m_scratch;
+};
+
+/**
+ * Fields of a share submission, as views into the original message.
+ *
+ * Filled for both the XMRig style ("submit" with an object of job_id, nonce
+ * and result) and the standard style ("mining.submit" with a positional
+ * array of worker, job_id, extranonce2, ntime and nonce).
+ */
+struct StratumSubmitView {
+    std::string_view method;
+    std::string_view id;          //!< raw JSON token, quotes included for string ids
+    std::string_view worker;
+    std::string_view job_id;
+    std::string_view extranonce2;
+    std::string_view ntime;
+    std::string_view nonce;
+    std::string_view result;
+};
+
+/**
+ * Allocation-free single-pass parse of a share submission.
+ *
+ * Returns false for anything that is not a well-formed submit whose string
+ * values are free of escape sequences, whose id is a JSON string, number or
+ * null, and which is followed by nothing but whitespace; callers then fall
+ * back to the full JSON parser.
+ */
+bool ParseStratumSubmit(std::string_view message, StratumSubmitView& out);
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_FRAMING_H
@@ -0,0 +1,176 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/stratum_metrics.h>
+
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace stratum {
+
+//! Prometheus le bounds, in microseconds
+static constexpr std::array<uint64_t, 18> PROMETHEUS_BOUNDS_US{
+    100, 250, 500,
+    1000, 2500, 5000,
+    10000, 25000, 50000,
+    100000, 250000, 500000,
+    1000000, 2500000, 5000000,
+    10000000, 30000000, 60000000,
+};
+
+size_t LatencyHistogram::BucketIndex(uint64_t value_us)
+{
+    if (value_us < SUB_BUCKETS) return value_us;
+    const int msb = std::bit_width(value_us) - 1;
+    if (msb >= MAX_BITS) return BUCKETS - 1;
+    const int shift = msb - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + ((value_us >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index)
+{
+    if (index < SUB_BUCKETS) return index;
+    const int shift = index / SUB_BUCKETS - 1;
+    const uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::chrono::microseconds elapsed)
+{
+    const uint64_t value = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+    m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_sum_us.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = m_max_us.load(std::memory_order_relaxed);
+    while (value > max && !m_max_us.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Read() const
+{
+    // Not a consistent cut; the figures may be a few recordings apart
+    Snapshot snapshot;
+    snapshot.buckets.resize(BUCKETS);
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum_us = m_sum_us.load(std::memory_order_relaxed);
+    snapshot.max_us = m_max_us.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+uint64_t LatencyHistogram::Snapshot::Percentile(double q) const
+{
+    if (count == 0) return 0;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(BucketUpperBound(i), max_us);
+    }
+    return max_us;
+}
+
+uint64_t LatencyHistogram::Snapshot::CountAtOrBelow(uint64_t bound_us) const
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < buckets.size() && BucketUpperBound(i) <= bound_us; ++i) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+std::string ShareRejectString(ShareReject reason)
+{
+    switch (reason) {
+    case ShareReject::MALFORMED: return "malformed";
+    case ShareReject::BUSY: return "busy";
+    case ShareReject::UNKNOWN_JOB: return "unknown_job";
+    case ShareReject::LOW_DIFFICULTY: return "low_difficulty";
+    case ShareReject::BLOCK_REJECTED: return "block_rejected";
+    case ShareReject::EXCEPTION: return "exception";
+    } // no default case, so the compiler can warn about missing cases
+    return "unknown";
+}
+
+std::vector<StratumMetrics::NamedHistogram> StratumMetrics::Histograms() const
+{
+    return {
+        {"share_queue", "Time a submitted share waits for a validation thread", share_queue},
+        {"share_validation", "Time to hash and check a share, including any block submission", share_validation},
+        {"job_template", "Time to fetch a block template for a new job", job_template},
+        {"job_build", "Time to build and publish a job from its template", job_build},
+        {"job_broadcast", "Time to queue a new job on every subscriber", job_broadcast},
+        {"work_restart", "Time from a new block notification to the new job being queued on every subscriber", work_restart},
+        {"block_submit", "Round trip of submitting a found block to the node", block_submit},
+    };
+}
+
+static std::string EscapeLabel(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string FormatPrometheus(const std::string& prefix, const StratumMetrics& metrics,
+                             const std::vector<ConnectionMetrics>& connections, size_t validation_queue_depth)
+{
+    std::string out;
+
+    for (const auto& [name, help, histogram] : metrics.Histograms()) {
+        const auto snapshot = histogram.Read();
+        const std::string metric = prefix + "_" + name + "_seconds";
+        out += strprintf("# HELP %s %s\n# TYPE %s histogram\n", metric, help, metric);
+        for (uint64_t bound : PROMETHEUS_BOUNDS_US) {
+            out += strprintf("%s_bucket{le=\"%g\"} %u\n", metric, bound / 1e6, snapshot.CountAtOrBelow(bound));
+        }
+        out += strprintf("%s_bucket{le=\"+Inf\"} %u\n", metric, snapshot.count);
+        out += strprintf("%s_sum %.6f\n%s_count %u\n", metric, snapshot.sum_us / 1e6, metric, snapshot.count);
+    }
+
+    const std::string rejects = prefix + "_shares_rejected_total";
+    out += strprintf("# HELP %s Shares refused, by reason\n# TYPE %s counter\n", rejects, rejects);
+    for (size_t i = 0; i < SHARE_REJECT_COUNT; ++i) {
+        out += strprintf("%s{reason=\"%s\"} %u\n", rejects, ShareRejectString(static_cast<ShareReject>(i)),
+                         metrics.rejects[i].load(std::memory_order_relaxed));
+    }
+
+    const std::string queue = prefix + "_validation_queue_depth";
+    out += strprintf("# HELP %s Shares waiting for a validation thread\n# TYPE %s gauge\n%s %u\n",
+                     queue, queue, queue, validation_queue_depth);
+
+    const std::string bytes_in = prefix + "_connection_received_bytes_total";
+    const std::string bytes_out = prefix + "_connection_sent_bytes_total";
+    const std::string send_queue = prefix + "_connection_send_queue_bytes";
+    out += strprintf("# HELP %s Bytes received from a miner connection\n# TYPE %s counter\n", bytes_in, bytes_in);
+    for (const auto& conn : connections) {
+        out += strprintf("%s{connection=\"%d\",worker=\"%s\"} %u\n", bytes_in, conn.id, EscapeLabel(conn.worker), conn.bytes_in);
+    }
+    out += strprintf("# HELP %s Bytes sent to a miner connection\n# TYPE %s counter\n", bytes_out, bytes_out);
+    for (const auto& conn : connections) {
+        out += strprintf("%s{connection=\"%d\",worker=\"%s\"} %u\n", bytes_out, conn.id, EscapeLabel(conn.worker), conn.bytes_out);
+    }
+    out += strprintf("# HELP %s Bytes queued for a miner connection the socket has not taken yet\n# TYPE %s gauge\n",
+                     send_queue, send_queue);
+    for (const auto& conn : connections) {
+        out += strprintf("%s{connection=\"%d\",worker=\"%s\"} %u\n", send_queue, conn.id, EscapeLabel(conn.worker), conn.send_queue_bytes);
+    }
+
+    return out;
+}
+
+} // namespace stratum
@@ -0,0 +1,124 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_STRATUM_METRICS_H
+#define WATTX_STRATUM_STRATUM_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stratum {
+
+/**
+ * Latency histogram with HDR-style log-linear buckets.
+ *
+ * Each power of two of microseconds is split into SUB_BUCKETS linear
+ * buckets, so any recorded value is known to within 1/SUB_BUCKETS of itself
+ * from 1us up to hours. Recording is a few relaxed atomic increments and
+ * takes no lock, so it can sit on the share and job hot paths.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    //! Values at or above 2^MAX_BITS microseconds (~19h) land in the last bucket
+    static constexpr int MAX_BITS = 36;
+    static constexpr size_t BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot {
+        uint64_t count{0};
+        uint64_t sum_us{0};
+        uint64_t max_us{0};
+        std::vector<uint64_t> buckets;
+
+        /** Smallest recorded-bucket bound that q of the values are at or below */
+        uint64_t Percentile(double q) const;
+        /** Number of values at or below @p bound_us, to bucket precision */
+        uint64_t CountAtOrBelow(uint64_t bound_us) const;
+    };
+
+    void Record(std::chrono::microseconds elapsed);
+    Snapshot Read() const;
+
+    static size_t BucketIndex(uint64_t value_us);
+    //! Largest value that falls in a bucket
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> m_buckets{};
+    std::atomic<uint64_t> m_sum_us{0};
+    std::atomic<uint64_t> m_max_us{0};
+};
+
+/** Why a submitted share was refused */
+enum class ShareReject : uint8_t {
+    MALFORMED,       //!< submit without job id or nonce
+    BUSY,            //!< validation queue full
+    UNKNOWN_JOB,     //!< stale or unknown job id
+    LOW_DIFFICULTY,  //!< hash above the connection's share target
+    BLOCK_REJECTED,  //!< block candidate refused by the node
+    EXCEPTION,       //!< validation threw
+};
+static constexpr size_t SHARE_REJECT_COUNT = static_cast<size_t>(ShareReject::EXCEPTION) + 1;
+
+std::string ShareRejectString(ShareReject reason);
+
+/**
+ * Per-stage timings and counters of a stratum server.
+ *
+ * Shares are timed from the I/O thread handing them off to the validation
+ * pool (share_queue) and through validation itself; jobs through the
+ * template fetch, the notification build and the fan-out to subscribers.
+ * work_restart is the whole path from a new-block notification to the last
+ * subscriber having the new job queued.
+ */
+struct StratumMetrics {
+    LatencyHistogram share_queue;
+    LatencyHistogram share_validation;
+    LatencyHistogram job_template;
+    LatencyHistogram job_build;
+    LatencyHistogram job_broadcast;
+    LatencyHistogram work_restart;
+    LatencyHistogram block_submit;
+
+    std::array<std::atomic<uint64_t>, SHARE_REJECT_COUNT> rejects{};
+
+    void Reject(ShareReject reason) { ++rejects[static_cast<size_t>(reason)]; }
+
+    struct NamedHistogram {
+        const char* name;
+        const char* help;
+        const LatencyHistogram& histogram;
+    };
+    std::vector<NamedHistogram> Histograms() const;
+};
+
+/** Connection-level figures, as reported next to the metrics */
+struct ConnectionMetrics {
+    int id{-1};
+    std::string peer;
+    std::string worker;
+    uint64_t shares_accepted{0};
+    uint64_t shares_rejected{0};
+    uint64_t difficulty{0};
+    uint64_t bytes_in{0};
+    uint64_t bytes_out{0};
+    size_t send_queue_bytes{0};
+};
+
+/**
+ * Prometheus text exposition of the metrics. Histograms are in seconds
+ * with fixed le bounds from 100us to 60s.
+ */
+std::string FormatPrometheus(const std::string& prefix, const StratumMetrics& metrics,
+                             const std::vector<ConnectionMetrics>& connections, size_t validation_queue_depth);
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_STRATUM_METRICS_H
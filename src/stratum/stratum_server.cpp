@@ -7,22 +7,26 @@
 #include <arith_uint256.h>
 #include <chainparams.h>
 #include <consensus/merkle.h>
+#include <crypto/common.h>
 #include <interfaces/mining.h>
 #include <logging.h>
 #include <node/randomx_miner.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <stratum/stratum_framing.h>
 #include <streams.h>
 #include <uint256.h>
 #include <univalue.h>
 #include <util/strencodings.h>
 #include <util/time.h>
+#include <util/trace.h>
 
 #include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <sstream>
+#include <tuple>
 
 #ifdef WIN32
 #include <winsock2.h>
@@ -36,8 +40,43 @@
 #include <unistd.h>
 #endif
 
+TRACEPOINT_SEMAPHORE(stratum, share_validated);
+
 namespace stratum {
 
+static int64_t SteadyMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now().time_since_epoch()).count();
+}
+
+static std::chrono::microseconds MicrosSince(int64_t start_us)
+{
+    return std::chrono::microseconds{SteadyMicros() - start_us};
+}
+
+//! The job's mining blob with the merkle root of a client's coinbase
+static std::vector<unsigned char> ClientBlobBytes(const StratumJob& job, uint32_t extranonce1)
+{
+    std::vector<unsigned char> blob = job.blob_bytes;
+    if (job.coinbase && extranonce1 != 0) SetBlobMerkleRoot(blob, job.coinbase->MerkleRoot(extranonce1));
+    return blob;
+}
+
+static std::string ClientBlob(const StratumJob& job, uint32_t extranonce1)
+{
+    return extranonce1 == 0 ? job.blob : HexStr(ClientBlobBytes(job, extranonce1));
+}
+
+// Listener ids handed to the event loop
+static constexpr int LISTENER_JSON = 0;
+static constexpr int LISTENER_SV2 = 1;
+//! Id of the one standard channel a Stratum V2 connection may open
+static constexpr uint32_t SV2_CHANNEL_ID = 1;
+//! Stratum V2 protocol version spoken
+static constexpr uint16_t SV2_PROTOCOL_VERSION = 2;
+//! How far ahead of the clock a Stratum V2 share's ntime may be
+static constexpr int64_t SV2_MAX_FUTURE_NTIME = 2 * 60 * 60;
+
 // Global instance
 static std::unique_ptr<StratumServer> g_stratum_server;
 
@@ -54,73 +93,114 @@ StratumServer::~StratumServer() {
     Stop();
 }
 
-bool StratumServer::Start(const StratumConfig& config, interfaces::Mining* mining) {
-    if (m_running.load()) {
-        LogPrintf("Stratum: Server already running\n");
-        return false;
-    }
-
-    m_config = config;
-    m_mining = mining;
+static void CloseSocket(int fd) {
+#ifdef WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
 
-    // Create listening socket
-    m_listen_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (m_listen_socket < 0) {
+// Bound and listening TCP socket, or -1
+static int OpenListenSocket(const std::string& bind_address, uint16_t port, int backlog) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
         LogPrintf("Stratum: Failed to create socket\n");
-        return false;
+        return -1;
     }
 
     // Set socket options for address reuse
     int opt = 1;
-    setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&opt, sizeof(opt));
 #ifdef SO_REUSEPORT
-    setsockopt(m_listen_socket, SOL_SOCKET, SO_REUSEPORT, (const char*)&opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (const char*)&opt, sizeof(opt));
 #endif
 
     // Bind to address
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(config.port);
+    server_addr.sin_port = htons(port);
 
-    if (config.bind_address == "0.0.0.0") {
+    if (bind_address == "0.0.0.0") {
         server_addr.sin_addr.s_addr = INADDR_ANY;
     } else {
-        inet_pton(AF_INET, config.bind_address.c_str(), &server_addr.sin_addr);
+        inet_pton(AF_INET, bind_address.c_str(), &server_addr.sin_addr);
     }
 
-    if (bind(m_listen_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        LogPrintf("Stratum: Failed to bind to port %d\n", config.port);
-#ifdef WIN32
-        closesocket(m_listen_socket);
-#else
-        close(m_listen_socket);
-#endif
-        m_listen_socket = -1;
-        return false;
+    if (bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        LogPrintf("Stratum: Failed to bind to port %d\n", port);
+        CloseSocket(fd);
+        return -1;
     }
 
     // Start listening
-    if (listen(m_listen_socket, config.max_clients) < 0) {
+    if (listen(fd, backlog) < 0) {
         LogPrintf("Stratum: Failed to listen\n");
-#ifdef WIN32
-        closesocket(m_listen_socket);
-#else
-        close(m_listen_socket);
-#endif
-        m_listen_socket = -1;
+        CloseSocket(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool StratumServer::Start(const StratumConfig& config, interfaces::Mining* mining) {
+    if (m_running.load()) {
+        LogPrintf("Stratum: Server already running\n");
         return false;
     }
 
+    m_config = config;
+    m_mining = mining;
+
+    m_listen_socket = OpenListenSocket(config.bind_address, config.port, config.max_clients);
+    if (m_listen_socket < 0) return false;
+
+    if (config.sv2_port != 0) {
+        m_sv2_listen_socket = OpenListenSocket(config.bind_address, config.sv2_port, config.max_clients);
+        if (m_sv2_listen_socket < 0) {
+            CloseSocket(m_listen_socket);
+            m_listen_socket = -1;
+            return false;
+        }
+
+        // Certificate valid for a year from an hour ago, to allow for miner clock skew
+        m_sv2_static_key = GenerateRandomKey();
+        m_sv2_authority_key = GenerateRandomKey();
+        const uint32_t now = static_cast<uint32_t>(GetTime());
+        m_sv2_certificate.valid_from = now - 3600;
+        m_sv2_certificate.not_valid_after = now + 365 * 24 * 3600;
+        m_sv2_certificate.Sign(m_sv2_authority_key, XOnlyPubKey{m_sv2_static_key.GetPubKey()});
+    }
+
     m_running.store(true);
 
-    // Start accept thread
-    m_accept_thread = std::thread(&StratumServer::AcceptThread, this);
+    // Start the event loop and hand it the listening sockets
+    if (!m_io.Start(config.io_threads, "stratum-io",
+                    [this](int listener_id, const std::string& peer_addr) { return OnAccept(listener_id, peer_addr); },
+                    [this](int client_id, std::string_view line) { HandleMessage(client_id, line); },
+                    [this](int client_id) { OnDisconnect(client_id); }) ||
+        !m_io.AddListener(m_listen_socket, LISTENER_JSON) ||
+        (m_sv2_listen_socket >= 0 && !m_io.AddListener(m_sv2_listen_socket, LISTENER_SV2, StratumEventLoop::Framing::RAW)) ||
+        !m_validators.Start(config.validation_threads, config.validation_queue, "stratum-share")) {
+        LogPrintf("Stratum: Failed to start I/O core\n");
+        m_running.store(false);
+        m_io.Stop();
+        m_validators.Stop();
+        CloseSocket(m_listen_socket);
+        m_listen_socket = -1;
+        if (m_sv2_listen_socket >= 0) CloseSocket(m_sv2_listen_socket);
+        m_sv2_listen_socket = -1;
+        return false;
+    }
 
     // Start job generation thread
     m_job_thread = std::thread(&StratumServer::JobThread, this);
 
     LogPrintf("Stratum: Server started on %s:%d\n", config.bind_address, config.port);
+    if (m_sv2_listen_socket >= 0) {
+        LogPrintf("Stratum: Stratum V2 listening on %s:%d, authority key %s\n",
+                  config.bind_address, config.sv2_port, GetSv2AuthorityKey());
+    }
     return true;
 }
 
@@ -129,161 +209,101 @@ void StratumServer::Stop() {
 
     m_running.store(false);
 
-    // Close listening socket to wake up accept thread
-    if (m_listen_socket >= 0) {
-#ifdef WIN32
-        closesocket(m_listen_socket);
-#else
-        close(m_listen_socket);
-#endif
-        m_listen_socket = -1;
-    }
-
     // Wake up job thread
     m_job_cv.notify_all();
-
-    // Wait for threads
-    if (m_accept_thread.joinable()) m_accept_thread.join();
     if (m_job_thread.joinable()) m_job_thread.join();
-    for (auto& t : m_client_threads) {
-        if (t.joinable()) t.join();
+
+    // Drain validation before the connections its responses go to
+    m_validators.Stop();
+
+    // Stop I/O threads; this closes every client connection
+    m_io.Stop();
+
+    for (int* fd : {&m_listen_socket, &m_sv2_listen_socket}) {
+        if (*fd >= 0) {
+            CloseSocket(*fd);
+            *fd = -1;
+        }
     }
-    m_client_threads.clear();
 
-    // Disconnect all clients
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
-        for (auto& [id, client] : m_clients) {
-            if (client->socket_fd >= 0) {
-#ifdef WIN32
-                closesocket(client->socket_fd);
-#else
-                close(client->socket_fd);
-#endif
-            }
-        }
         m_clients.clear();
     }
 
     LogPrintf("Stratum: Server stopped\n");
 }
 
+std::string StratumServer::GetSv2AuthorityKey() const {
+    if (!m_sv2_authority_key.IsValid()) return {};
+    return HexStr(XOnlyPubKey{m_sv2_authority_key.GetPubKey()});
+}
+
 size_t StratumServer::GetClientCount() const {
     std::lock_guard<std::mutex> lock(m_clients_mutex);
     return m_clients.size();
 }
 
-void StratumServer::AcceptThread() {
-    LogPrintf("Stratum: Accept thread started\n");
-
-    while (m_running.load()) {
-        struct sockaddr_in client_addr;
-        socklen_t client_len = sizeof(client_addr);
-
-        int client_socket = accept(m_listen_socket, (struct sockaddr*)&client_addr, &client_len);
-        if (client_socket < 0) {
-            if (m_running.load()) {
-                LogPrintf("Stratum: Accept failed\n");
-            }
-            continue;
+std::vector<ConnectionMetrics> StratumServer::GetConnectionMetrics() const {
+    std::vector<ConnectionMetrics> result;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        result.reserve(m_clients.size());
+        for (const auto& [id, client] : m_clients) {
+            ConnectionMetrics& conn = result.emplace_back();
+            conn.id = id;
+            conn.peer = client->peer_address;
+            conn.worker = client->worker_name;
+            conn.shares_accepted = client->shares_accepted;
+            conn.shares_rejected = client->shares_rejected;
+            conn.difficulty = client->vardiff.Difficulty();
         }
+    }
 
-        // Set non-blocking
-#ifdef WIN32
-        u_long mode = 1;
-        ioctlsocket(client_socket, FIONBIO, &mode);
-#else
-        fcntl(client_socket, F_SETFL, O_NONBLOCK);
-#endif
-
-        // Create client
-        int client_id;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            client_id = m_next_client_id++;
-            auto client = std::make_unique<StratumClient>();
-            client->socket_fd = client_socket;
-            client->session_id = GenerateSessionId();
-            client->connect_time = GetTime();
-            client->last_activity = client->connect_time;
-            m_clients[client_id] = std::move(client);
+    // Traffic comes from the event loop, which has its own locks
+    for (ConnectionMetrics& conn : result) {
+        StratumEventLoop::ConnectionStats stats;
+        if (m_io.GetConnectionStats(conn.id, stats)) {
+            conn.bytes_in = stats.bytes_in;
+            conn.bytes_out = stats.bytes_out;
+            conn.send_queue_bytes = stats.queued_bytes;
         }
-
-        char addr_str[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, addr_str, sizeof(addr_str));
-        LogPrintf("Stratum: Client %d connected from %s\n", client_id, addr_str);
-
-        // Start client handler thread
-        m_client_threads.emplace_back(&StratumServer::ClientThread, this, client_id);
     }
-
-    LogPrintf("Stratum: Accept thread stopped\n");
+    return result;
 }
 
-void StratumServer::ClientThread(int client_id) {
-    char buffer[4096];
-
-    while (m_running.load()) {
-        int socket_fd;
-        {
-            std::lock_guard<std::mutex> lock(m_clients_mutex);
-            auto it = m_clients.find(client_id);
-            if (it == m_clients.end()) break;
-            socket_fd = it->second->socket_fd;
+int StratumServer::OnAccept(int listener_id, const std::string& peer_addr) {
+    int client_id;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        if (m_clients.size() >= static_cast<size_t>(m_config.max_clients)) {
+            LogPrintf("Stratum: Max clients reached, rejecting %s\n", peer_addr);
+            return -1;
         }
 
-        // Read data
-        ssize_t bytes_read = recv(socket_fd, buffer, sizeof(buffer) - 1, 0);
-
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-
-            // Collect complete messages while holding the lock
-            std::vector<std::string> messages;
-            {
-                std::lock_guard<std::mutex> lock(m_clients_mutex);
-                auto it = m_clients.find(client_id);
-                if (it == m_clients.end()) break;
-
-                it->second->recv_buffer += buffer;
-                it->second->last_activity = GetTime();
-
-                // Extract complete messages (newline-delimited JSON)
-                size_t pos;
-                while ((pos = it->second->recv_buffer.find('\n')) != std::string::npos) {
-                    std::string message = it->second->recv_buffer.substr(0, pos);
-                    it->second->recv_buffer.erase(0, pos + 1);
-                    if (!message.empty()) {
-                        messages.push_back(message);
-                    }
-                }
-            }
-
-            // Process messages without holding the lock to avoid deadlock
-            for (const auto& message : messages) {
-                HandleMessage(client_id, message);
-            }
-        } else if (bytes_read == 0) {
-            // Connection closed
-            LogPrintf("Stratum: Client %d disconnected\n", client_id);
-            break;
-        } else {
-#ifdef WIN32
-            int err = WSAGetLastError();
-            if (err != WSAEWOULDBLOCK) {
-                break;
-            }
-#else
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                break;
-            }
-#endif
-            // No data available, sleep briefly
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        client_id = m_next_client_id++;
+        auto client = std::make_unique<StratumClient>();
+        client->peer_address = peer_addr;
+        client->session_id = GenerateSessionId();
+        client->extranonce1 = m_next_extranonce1++;
+        client->connect_time = GetTime();
+        client->last_activity = client->connect_time;
+        client->vardiff.Init(m_config.vardiff, m_config.share_difficulty, client->connect_time);
+        if (listener_id == LISTENER_SV2) {
+            client->sv2 = std::make_shared<Sv2Session>(m_sv2_static_key, m_sv2_certificate);
         }
+        m_clients[client_id] = std::move(client);
     }
 
-    DisconnectClient(client_id);
+    LogPrintf("Stratum: Client %d connected from %s%s\n", client_id, peer_addr, listener_id == LISTENER_SV2 ? " (Stratum V2)" : "");
+    return client_id;
+}
+
+void StratumServer::OnDisconnect(int client_id) {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    if (m_clients.erase(client_id)) {
+        LogPrintf("Stratum: Client %d disconnected\n", client_id);
+    }
 }
 
 void StratumServer::JobThread() {
@@ -296,13 +316,35 @@ void StratumServer::JobThread() {
         // Wait for new block or timeout
         std::unique_lock<std::mutex> lock(m_job_cv_mutex);
         m_job_cv.wait_for(lock, std::chrono::seconds(m_config.job_timeout_seconds),
-                          [this] { return !m_running.load(); });
+                          [this] { return !m_running.load() || m_block_notified_us.load() != 0; });
     }
 
     LogPrintf("Stratum: Job thread stopped\n");
 }
 
-void StratumServer::HandleMessage(int client_id, const std::string& message) {
+void StratumServer::HandleMessage(int client_id, std::string_view message) {
+    std::shared_ptr<Sv2Session> sv2;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) return;
+        it->second->last_activity = GetTime();
+        sv2 = it->second->sv2;
+    }
+
+    // Connections on the Stratum V2 port hand over raw bytes, not lines
+    if (sv2) {
+        HandleSv2Data(client_id, sv2, message);
+        return;
+    }
+
+    // Fast path: share submissions are parsed in place without building a UniValue
+    StratumSubmitView submit;
+    if (ParseStratumSubmit(message, submit)) {
+        ProcessSubmit(client_id, submit.id, submit.job_id, submit.nonce, submit.result);
+        return;
+    }
+
     try {
         UniValue request;
         if (!request.read(message)) {
@@ -363,20 +405,24 @@ void StratumServer::HandleMessage(int client_id, const std::string& message) {
 
 void StratumServer::HandleSubscribe(int client_id, const std::string& id, const std::vector<std::string>& params) {
     std::string session_id;
+    uint32_t extranonce1;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
         if (it == m_clients.end()) return;
         it->second->subscribed = true;
         session_id = it->second->session_id;
+        extranonce1 = it->second->extranonce1;
     }
 
     // Send subscription response
     // Format: {"id":1,"result":[[["mining.notify","session_id"]],"extranonce1","extranonce2_size"],"error":null}
+    const unsigned char extranonce_bytes[] = {static_cast<unsigned char>(extranonce1), static_cast<unsigned char>(extranonce1 >> 8),
+                                              static_cast<unsigned char>(extranonce1 >> 16), static_cast<unsigned char>(extranonce1 >> 24)};
     std::ostringstream response;
     response << "{\"id\":" << id << ",\"result\":[[";
     response << "[\"mining.notify\",\"" << session_id << "\"]";
-    response << "],\"" << session_id.substr(0, 8) << "\",4],\"error\":null}\n";
+    response << "],\"" << HexStr(extranonce_bytes) << "\",4],\"error\":null}\n";
 
     SendToClient(client_id, response.str());
     LogPrintf("Stratum: Client %d subscribed\n", client_id);
@@ -415,8 +461,8 @@ void StratumServer::HandleAuthorize(int client_id, const std::string& id, const
     // Send current job
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        if (!m_current_job.job_id.empty()) {
-            SendJob(client_id, m_current_job);
+        if (m_current_job) {
+            SendJob(client_id, *m_current_job);
         }
     }
 }
@@ -447,6 +493,8 @@ void StratumServer::HandleGetJob(int client_id, const std::string& id, const std
     LogPrintf("Stratum: HandleGetJob - parsed login=%s\n", login.empty() ? "(empty)" : login.substr(0, 50));
 
     std::string session_id;
+    uint64_t difficulty;
+    uint32_t extranonce1;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
         auto it = m_clients.find(client_id);
@@ -454,6 +502,8 @@ void StratumServer::HandleGetJob(int client_id, const std::string& id, const std
             LogPrintf("Stratum: HandleGetJob - client %d not found!\n", client_id);
             return;
         }
+        difficulty = it->second->vardiff.Difficulty();
+        extranonce1 = it->second->extranonce1;
         it->second->subscribed = true;
         it->second->authorized = true;
         it->second->wallet_address = login.empty() ? m_config.default_wallet : login;
@@ -463,24 +513,20 @@ void StratumServer::HandleGetJob(int client_id, const std::string& id, const std
     }
 
     // Build XMRig-style response with job
-    StratumJob job;
+    std::shared_ptr<const StratumJob> job;
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
         job = m_current_job;
     }
-    LogPrintf("Stratum: HandleGetJob - got job %s at height %d, blob_size=%d\n", job.job_id, job.height, job.blob.size());
+    if (job) {
+        LogPrintf("Stratum: HandleGetJob - got job %s at height %d, blob_size=%d\n", job->job_id, job->height, job->blob.size());
+    }
 
     std::ostringstream response;
     response << "{\"id\":" << id << ",\"jsonrpc\":\"2.0\",\"result\":{";
     response << "\"id\":\"" << session_id << "\",";
-    response << "\"job\":{";
-    response << "\"blob\":\"" << job.blob << "\",";
-    response << "\"job_id\":\"" << job.job_id << "\",";
-    response << "\"target\":\"" << job.target << "\",";
-    response << "\"algo\":\"rx/0\",";  // RandomX algorithm
-    response << "\"height\":" << job.height << ",";
-    response << "\"seed_hash\":\"" << job.seed_hash << "\"";
-    response << "},";
+    response << "\"job\":"
+             << (job && job->prepared ? job->prepared->JobObject(DifficultyToCompactTarget(difficulty), ClientBlob(*job, extranonce1)) : "null") << ",";
     response << "\"status\":\"OK\"";
     response << "},\"error\":null}\n";
 
@@ -514,46 +560,115 @@ void StratumServer::HandleSubmit(int client_id, const std::string& id, const std
         } catch (...) {}
     }
 
+    ProcessSubmit(client_id, id, job_id, nonce, result);
+}
+
+void StratumServer::ProcessSubmit(int client_id, std::string_view id, std::string_view job_id,
+                                  std::string_view nonce, std::string_view result) {
     if (job_id.empty() || nonce.empty()) {
+        m_metrics.Reject(ShareReject::MALFORMED);
         SendError(client_id, id, 20, "Invalid submit format");
         return;
     }
 
-    bool accepted = ValidateAndSubmitShare(client_id, job_id, nonce, result);
+    // The views point into the receive buffer; the task needs its own copies
+    bool queued = m_validators.Submit([this, client_id, id = std::string{id}, job_id = std::string{job_id},
+                                       nonce = std::string{nonce}, result = std::string{result},
+                                       queued_us = SteadyMicros()] {
+        m_metrics.share_queue.Record(MicrosSince(queued_us));
+        FinishSubmit(client_id, id, job_id, nonce, result);
+    });
+
+    if (!queued) {
+        m_metrics.Reject(ShareReject::BUSY);
+        SendError(client_id, id, 24, "Server busy");
+    }
+}
 
+void StratumServer::FinishSubmit(int client_id, const std::string& id, const std::string& job_id,
+                                 const std::string& nonce, const std::string& result) {
+    uint64_t difficulty;
+    uint32_t extranonce1;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) return;
+        difficulty = it->second->vardiff.AcceptDifficulty(GetTime());
+        extranonce1 = it->second->extranonce1;
+    }
+
+    const int64_t validation_start = SteadyMicros();
+    ShareReject reject{ShareReject::EXCEPTION};
+    bool accepted = ValidateAndSubmitShare(client_id, job_id, nonce, result, difficulty, extranonce1, reject);
+    const std::chrono::microseconds validation_time{MicrosSince(validation_start)};
+    m_metrics.share_validation.Record(validation_time);
+    TRACEPOINT(stratum, share_validated,
+        client_id,
+        1,
+        difficulty,
+        accepted,
+        static_cast<int>(reject),
+        static_cast<int64_t>(validation_time.count())
+    );
+
+    const bool retargeted = RecordShareResult(client_id, accepted, difficulty);
     if (accepted) {
         std::ostringstream response;
         response << "{\"id\":" << id << ",\"result\":{\"status\":\"OK\"},\"error\":null}\n";
         SendToClient(client_id, response.str());
 
-        std::lock_guard<std::mutex> lock(m_clients_mutex);
-        auto it = m_clients.find(client_id);
+        // A new target only takes effect with a new job
+        if (retargeted) {
+            std::shared_ptr<const StratumJob> job;
+            {
+                std::lock_guard<std::mutex> lock(m_jobs_mutex);
+                job = m_current_job;
+            }
+            LogPrintf("Stratum: Client %d difficulty retargeted to %u\n", client_id, difficulty);
+            if (job) SendJob(client_id, *job, difficulty, extranonce1);
+        }
+    } else {
+        m_metrics.Reject(reject);
+        SendError(client_id, id, 23, "Invalid share");
+    }
+}
+
+bool StratumServer::RecordShareResult(int client_id, bool accepted, uint64_t& difficulty) {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    auto it = m_clients.find(client_id);
+    bool retargeted = false;
+    if (accepted) {
         if (it != m_clients.end()) {
             it->second->shares_accepted++;
+            retargeted = it->second->vardiff.RecordShare(m_config.vardiff, GetTime());
+            difficulty = it->second->vardiff.Difficulty();
         }
         m_total_shares_accepted++;
     } else {
-        SendError(client_id, id, 23, "Invalid share");
-
-        std::lock_guard<std::mutex> lock(m_clients_mutex);
-        auto it = m_clients.find(client_id);
         if (it != m_clients.end()) {
             it->second->shares_rejected++;
         }
         m_total_shares_rejected++;
     }
+    return retargeted;
 }
 
 void StratumServer::CreateNewJob() {
     if (!m_mining) return;
 
+    // The job about to be built answers any block notification so far
+    const int64_t notified_us = m_block_notified_us.exchange(0);
+
     try {
         // Get block template
-        auto block_template = m_mining->createNewBlock();
+        const int64_t template_start = SteadyMicros();
+        auto block_template = m_mining->createNewBlock({.incremental = true});
         if (!block_template) {
             LogPrintf("Stratum: Failed to create block template\n");
             return;
         }
+        const int64_t build_start = SteadyMicros();
+        m_metrics.job_template.Record(std::chrono::microseconds{build_start - template_start});
 
         CBlock block = block_template->getBlock();
 
@@ -562,6 +677,9 @@ void StratumServer::CreateNewJob() {
         job.timestamp = block.nTime;
         job.bits = block.nBits;
         job.prev_hash = block.hashPrevBlock.GetHex();
+        job.hash_prev_block = block.hashPrevBlock;
+        job.version = block.nVersion;
+        job.sv2_job_id = ++m_sv2_job_counter;
 
         // Get height from chain
         auto tip = m_mining->getTip();
@@ -570,12 +688,18 @@ void StratumServer::CreateNewJob() {
         // Store the block template for later submission
         job.block_template = std::shared_ptr<interfaces::BlockTemplate>(block_template.release());
 
+        // Split the coinbase around the extranonce once; each client's merkle
+        // root then costs one coinbase hash plus the branch
+        job.coinbase = std::make_shared<const CoinbaseTemplate>(block);
+
         // Create XMRig-compatible mining blob (80 bytes)
         // Uses SerializeMiningBlob which places nonce at bytes 39-42
         // This SAME format is used for consensus validation, so blocks found
         // via stratum will be valid on the network
+        block.hashMerkleRoot = job.coinbase->MerkleRoot(0);
         auto miningBlob = node::RandomXMiner::SerializeMiningBlob(block);
         job.blob = HexStr(miningBlob);
+        job.blob_bytes.assign(miningBlob.begin(), miningBlob.end());
 
         // Calculate target from bits
         arith_uint256 target;
@@ -585,7 +709,7 @@ void StratumServer::CreateNewJob() {
         // The pool validates shares against this easy target for hashrate tracking,
         // but only submits to the network if hash also meets the real block target
         // "b88d0600" = difficulty ~1000, shares every few seconds at typical hashrates
-        job.target = "b88d0600";
+        job.target = DifficultyToCompactTarget(m_config.share_difficulty);
 
         LogPrintf("Stratum: Real target (nBits=0x%08x) = %s, share target = %s\n",
                   block.nBits, target.GetHex(), job.target);
@@ -595,11 +719,21 @@ void StratumServer::CreateNewJob() {
         // Seed hash - for RandomX, use genesis block hash as key
         job.seed_hash = block.hashPrevBlock.GetHex();
 
+        job.prepared = stratum::PreparedJobBuilder{}
+                           .Blob(job.blob)
+                           .Str("job_id", job.job_id)
+                           .Target(job.target)
+                           .Str("algo", "rx/0")  // RandomX algorithm
+                           .Num("height", job.height)
+                           .Str("seed_hash", job.seed_hash)
+                           .Build();
+
         // Store job
         {
             std::lock_guard<std::mutex> lock(m_jobs_mutex);
-            m_jobs[job.job_id] = job;
-            m_current_job = job;
+            auto published = std::make_shared<const StratumJob>(job);
+            m_jobs[job.job_id] = published;
+            m_current_job = published;
 
             // Limit stored jobs
             if (m_jobs.size() > 10) {
@@ -608,8 +742,13 @@ void StratumServer::CreateNewJob() {
             }
         }
 
+        const int64_t broadcast_start = SteadyMicros();
+        m_metrics.job_build.Record(std::chrono::microseconds{broadcast_start - build_start});
+
         // Broadcast to all clients
         BroadcastJob(job);
+        m_metrics.job_broadcast.Record(MicrosSince(broadcast_start));
+        if (notified_us != 0) m_metrics.work_restart.Record(MicrosSince(notified_us));
 
         LogPrintf("Stratum: New job %s at height %d\n", job.job_id, job.height);
 
@@ -620,88 +759,419 @@ void StratumServer::CreateNewJob() {
 
 void StratumServer::BroadcastJob(const StratumJob& job) {
     // Collect client info while holding lock, then send without lock to avoid deadlock
-    std::vector<std::pair<int, int>> clients_to_notify; // client_id, socket_fd
+    std::vector<std::tuple<int, uint64_t, uint32_t, std::shared_ptr<Sv2Session>>> clients_to_notify;
     {
         std::lock_guard<std::mutex> lock(m_clients_mutex);
+        int64_t now = GetTime();
         for (auto& [id, client] : m_clients) {
             if (client->subscribed && client->authorized) {
-                clients_to_notify.emplace_back(id, client->socket_fd);
+                // Ease off miners that have gone quiet at their current difficulty
+                client->vardiff.CheckIdle(m_config.vardiff, now);
+                clients_to_notify.emplace_back(id, client->vardiff.Difficulty(), client->extranonce1, client->sv2);
             }
         }
     }
 
-    // Build job message once
-    std::ostringstream msg;
-    msg << "{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":{";
-    msg << "\"blob\":\"" << job.blob << "\",";
-    msg << "\"job_id\":\"" << job.job_id << "\",";
-    msg << "\"target\":\"" << job.target << "\",";
-    msg << "\"algo\":\"rx/0\",";
-    msg << "\"height\":" << job.height << ",";
-    msg << "\"seed_hash\":\"" << job.seed_hash << "\"";
-    msg << "}}\n";
-    std::string job_msg = msg.str();
-
-    // Send to each client without holding the lock
-    for (const auto& [client_id, socket_fd] : clients_to_notify) {
-        if (socket_fd >= 0) {
-            send(socket_fd, job_msg.c_str(), job_msg.length(), 0);
+    // Each client's notification differs from the serialized one only in
+    // the target and the blob's merkle root
+    for (const auto& [client_id, difficulty, extranonce1, sv2] : clients_to_notify) {
+        if (sv2) {
+            SendSv2Job(client_id, *sv2, job, difficulty, extranonce1);
+        } else {
+            SendJob(client_id, job, difficulty, extranonce1);
         }
     }
 }
 
 void StratumServer::SendJob(int client_id, const StratumJob& job) {
+    uint64_t difficulty;
+    uint32_t extranonce1;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) return;
+        difficulty = it->second->vardiff.Difficulty();
+        extranonce1 = it->second->extranonce1;
+    }
+    SendJob(client_id, job, difficulty, extranonce1);
+}
+
+void StratumServer::SendJob(int client_id, const StratumJob& job, uint64_t difficulty, uint32_t extranonce1) {
     // XMRig-compatible job notification
-    std::ostringstream msg;
-    msg << "{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":{";
-    msg << "\"blob\":\"" << job.blob << "\",";
-    msg << "\"job_id\":\"" << job.job_id << "\",";
-    msg << "\"target\":\"" << job.target << "\",";
-    msg << "\"algo\":\"rx/0\",";  // RandomX algorithm
-    msg << "\"height\":" << job.height << ",";
-    msg << "\"seed_hash\":\"" << job.seed_hash << "\"";
-    msg << "}}\n";
-
-    SendToClient(client_id, msg.str());
-}
-
-bool StratumServer::ValidateAndSubmitShare(int client_id, const std::string& job_id,
-                                            const std::string& nonce_hex, const std::string& result_hex) {
-    StratumJob job;
+    if (!job.prepared) return;
+    m_io.Send(client_id, job.prepared->Notify(DifficultyToCompactTarget(difficulty), ClientBlob(job, extranonce1)));
+}
+
+// ============================================================================
+// Stratum V2
+// ============================================================================
+
+template <typename Msg>
+void StratumServer::SendSv2(int client_id, Sv2Session& session, const Msg& msg) {
+    const std::vector<std::byte> frame = Sv2EncodeFrame(msg);
+    std::lock_guard<std::mutex> lock(session.mutex);
+    const std::vector<std::byte> sealed = session.transport.Seal(frame);
+    m_io.Send(client_id, std::string(reinterpret_cast<const char*>(sealed.data()), sealed.size()));
+}
+
+void StratumServer::SendSv2Job(int client_id, Sv2Session& session, const StratumJob& job, uint64_t difficulty, uint32_t extranonce1) {
+    // Header-only channel: the miner assembles the RandomX blob from these
+    // fields and the merkle root of its own coinbase
+    Sv2NewMiningJob new_job;
+    new_job.channel_id = SV2_CHANNEL_ID;
+    new_job.job_id = job.sv2_job_id;
+    new_job.version = static_cast<uint32_t>(job.version);
+    if (job.coinbase) {
+        const uint256 merkle_root = job.coinbase->MerkleRoot(extranonce1);
+        new_job.merkle_root.assign(merkle_root.begin(), merkle_root.end());
+    }
+
+    std::vector<std::byte> frames;
+    auto seal = [&](const auto& msg) {
+        const std::vector<std::byte> sealed = session.transport.Seal(Sv2EncodeFrame(msg));
+        frames.insert(frames.end(), sealed.begin(), sealed.end());
+    };
+
+    std::lock_guard<std::mutex> lock(session.mutex);
+    // A job sent while the channel opened may overtake the broadcast of a newer one
+    if (!session.channel_open || job.sv2_job_id <= session.job_id) return;
+    session.job_id = job.sv2_job_id;
+
+    if (difficulty != session.difficulty) {
+        Sv2SetTarget set_target;
+        set_target.channel_id = SV2_CHANNEL_ID;
+        set_target.maximum_target = DifficultyToTarget(difficulty);
+        seal(set_target);
+        session.difficulty = difficulty;
+    }
+
+    if (job.hash_prev_block != session.prev_hash) {
+        // New block: a future job, switched to by SetNewPrevHash
+        seal(new_job);
+        Sv2SetNewPrevHash prev_hash;
+        prev_hash.channel_id = SV2_CHANNEL_ID;
+        prev_hash.job_id = job.sv2_job_id;
+        prev_hash.prev_hash = job.hash_prev_block;
+        prev_hash.min_ntime = static_cast<uint32_t>(job.timestamp);
+        prev_hash.nbits = job.bits;
+        seal(prev_hash);
+        session.prev_hash = job.hash_prev_block;
+    } else {
+        new_job.min_ntime = static_cast<uint32_t>(job.timestamp);
+        seal(new_job);
+    }
+    m_io.Send(client_id, std::string(reinterpret_cast<const char*>(frames.data()), frames.size()));
+}
+
+void StratumServer::HandleSv2Data(int client_id, const std::shared_ptr<Sv2Session>& session, std::string_view data) {
+    std::vector<Sv2Transport::Message> messages;
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        std::vector<std::byte> reply;
+        ok = session->transport.Receive(MakeByteSpan(data), reply, static_cast<uint32_t>(GetTime()));
+        if (!reply.empty()) {
+            m_io.Send(client_id, std::string(reinterpret_cast<const char*>(reply.data()), reply.size()));
+        }
+        Sv2Transport::Message message;
+        while (session->transport.NextMessage(message)) {
+            messages.push_back(std::move(message));
+        }
+    }
+
+    for (const auto& message : messages) {
+        if (!ok) break;
+        ok = HandleSv2Message(client_id, session, message);
+    }
+    if (!ok) {
+        LogPrintf("Stratum: Stratum V2 protocol error from client %d, disconnecting\n", client_id);
+        DisconnectClient(client_id);
+    }
+}
+
+bool StratumServer::HandleSv2Message(int client_id, const std::shared_ptr<Sv2Session>& session, const Sv2Transport::Message& message) {
+    // Extensions are not supported; their messages are ignored
+    if ((message.header.extension_type & ~SV2_CHANNEL_MSG_BIT) != 0) return true;
+
+    switch (static_cast<Sv2MsgType>(message.header.msg_type)) {
+    case Sv2MsgType::SETUP_CONNECTION: {
+        Sv2SetupConnection setup;
+        if (!Sv2DecodePayload(message.payload, setup)) return false;
+
+        Sv2SetupConnectionError error;
+        if (setup.protocol != 0) {
+            error.error_code = "unsupported-protocol";
+        } else if (setup.min_version > SV2_PROTOCOL_VERSION || setup.max_version < SV2_PROTOCOL_VERSION) {
+            error.error_code = "protocol-version-mismatch";
+        } else if (setup.flags & Sv2SetupConnection::REQUIRES_WORK_SELECTION) {
+            error.error_code = "unsupported-feature-flags";
+            error.flags = Sv2SetupConnection::REQUIRES_WORK_SELECTION;
+        }
+        if (!error.error_code.empty()) {
+            SendSv2(client_id, *session, error);
+            return true;
+        }
+
+        Sv2SetupConnectionSuccess success;
+        success.used_version = SV2_PROTOCOL_VERSION;
+        success.flags = Sv2SetupConnectionSuccess::REQUIRES_FIXED_VERSION;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->setup = true;
+        }
+        SendSv2(client_id, *session, success);
+        LogPrintf("Stratum: Client %d set up Stratum V2 (%s %s)\n", client_id, setup.vendor, setup.firmware);
+        return true;
+    }
+    case Sv2MsgType::OPEN_STANDARD_MINING_CHANNEL: {
+        Sv2OpenStandardMiningChannel open;
+        if (!Sv2DecodePayload(message.payload, open)) return false;
+        return HandleSv2OpenChannel(client_id, *session, open);
+    }
+    case Sv2MsgType::SUBMIT_SHARES_STANDARD: {
+        Sv2SubmitSharesStandard submit;
+        if (!Sv2DecodePayload(message.payload, submit)) return false;
+
+        bool channel_open;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            channel_open = session->channel_open;
+        }
+        if (!channel_open || submit.channel_id != SV2_CHANNEL_ID) {
+            m_metrics.Reject(ShareReject::MALFORMED);
+            Sv2SubmitSharesError error;
+            error.channel_id = submit.channel_id;
+            error.sequence_number = submit.sequence_number;
+            error.error_code = "invalid-channel-id";
+            SendSv2(client_id, *session, error);
+            return true;
+        }
+
+        bool queued = m_validators.Submit([this, client_id, session, submit, queued_us = SteadyMicros()] {
+            m_metrics.share_queue.Record(MicrosSince(queued_us));
+            FinishSv2Submit(client_id, *session, submit);
+        });
+        if (!queued) {
+            m_metrics.Reject(ShareReject::BUSY);
+            Sv2SubmitSharesError error;
+            error.channel_id = submit.channel_id;
+            error.sequence_number = submit.sequence_number;
+            error.error_code = "server-busy";
+            SendSv2(client_id, *session, error);
+        }
+        return true;
+    }
+    default:
+        // Only the standard-channel subset of the mining protocol is served
+        LogPrintf("Stratum: Ignoring Stratum V2 message 0x%02x from client %d\n", message.header.msg_type, client_id);
+        return true;
+    }
+}
+
+bool StratumServer::HandleSv2OpenChannel(int client_id, Sv2Session& session, const Sv2OpenStandardMiningChannel& open) {
+    bool setup, channel_open;
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        setup = session.setup;
+        channel_open = session.channel_open;
+    }
+    if (!setup) return false;
+
+    Sv2OpenMiningChannelError error;
+    error.request_id = open.request_id;
+    if (channel_open) {
+        error.error_code = "max-channels-reached";
+        SendSv2(client_id, session, error);
+        return true;
+    }
+
+    // user_identity is wallet_address.worker_name, as in mining.authorize
+    std::string wallet_address = open.user_identity;
+    std::string worker_name = "default";
+    size_t dot_pos = open.user_identity.find('.');
+    if (dot_pos != std::string::npos) {
+        wallet_address = open.user_identity.substr(0, dot_pos);
+        worker_name = open.user_identity.substr(dot_pos + 1);
+    }
+
+    uint64_t difficulty;
+    uint32_t extranonce1;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) return true;
+        difficulty = it->second->vardiff.Difficulty();
+        extranonce1 = it->second->extranonce1;
+    }
+
+    const uint256 target = DifficultyToTarget(difficulty);
+    if (UintToArith256(target) > UintToArith256(open.max_target)) {
+        error.error_code = "max-target-out-of-range";
+        SendSv2(client_id, session, error);
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) return true;
+        it->second->subscribed = true;
+        it->second->authorized = true;
+        it->second->wallet_address = wallet_address.empty() ? m_config.default_wallet : wallet_address;
+        it->second->worker_name = worker_name;
+    }
+
+    Sv2OpenStandardMiningChannelSuccess success;
+    success.request_id = open.request_id;
+    success.channel_id = SV2_CHANNEL_ID;
+    success.target = target;
+    success.extranonce_prefix = {static_cast<unsigned char>(extranonce1), static_cast<unsigned char>(extranonce1 >> 8),
+                                 static_cast<unsigned char>(extranonce1 >> 16), static_cast<unsigned char>(extranonce1 >> 24)};
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        const std::vector<std::byte> sealed = session.transport.Seal(Sv2EncodeFrame(success));
+        m_io.Send(client_id, std::string(reinterpret_cast<const char*>(sealed.data()), sealed.size()));
+        session.channel_open = true;
+        session.difficulty = difficulty;
+    }
+    LogPrintf("Stratum: Client %d opened a Stratum V2 channel as %s (%s)\n", client_id, wallet_address, worker_name);
+
+    std::shared_ptr<const StratumJob> job;
     {
         std::lock_guard<std::mutex> lock(m_jobs_mutex);
-        auto it = m_jobs.find(job_id);
+        job = m_current_job;
+    }
+    if (job) SendSv2Job(client_id, session, *job, difficulty, extranonce1);
+    return true;
+}
+
+void StratumServer::FinishSv2Submit(int client_id, Sv2Session& session, const Sv2SubmitSharesStandard& submit) {
+    uint64_t difficulty;
+    uint32_t extranonce1;
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        auto it = m_clients.find(client_id);
+        if (it == m_clients.end()) return;
+        difficulty = it->second->vardiff.AcceptDifficulty(GetTime());
+        extranonce1 = it->second->extranonce1;
+    }
+
+    std::shared_ptr<const StratumJob> job;
+    {
+        // Only the last few jobs are kept
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        for (const auto& [id, candidate] : m_jobs) {
+            if (candidate->sv2_job_id == submit.job_id) job = candidate;
+        }
+    }
+
+    const int64_t validation_start = SteadyMicros();
+    ShareReject reject{ShareReject::EXCEPTION};
+    std::string error_code;
+    bool accepted = false;
+    if (!job) {
+        reject = ShareReject::UNKNOWN_JOB;
+        error_code = "invalid-job-id";
+    } else if (submit.version != static_cast<uint32_t>(job->version)) {
+        reject = ShareReject::MALFORMED;
+        error_code = "invalid-version";
+    } else if (submit.ntime < job->timestamp || submit.ntime > GetTime() + SV2_MAX_FUTURE_NTIME) {
+        reject = ShareReject::MALFORMED;
+        error_code = "invalid-timestamp";
+    } else {
+        accepted = ValidateAndSubmitShare(client_id, *job, submit.nonce, submit.ntime, difficulty, extranonce1, reject);
+        if (!accepted) error_code = reject == ShareReject::LOW_DIFFICULTY ? "difficulty-too-low" : ShareRejectString(reject);
+    }
+    const std::chrono::microseconds validation_time{MicrosSince(validation_start)};
+    m_metrics.share_validation.Record(validation_time);
+    TRACEPOINT(stratum, share_validated,
+        client_id,
+        2,
+        difficulty,
+        accepted,
+        static_cast<int>(reject),
+        static_cast<int64_t>(validation_time.count())
+    );
+
+    const uint64_t share_difficulty = difficulty;
+    const bool retargeted = RecordShareResult(client_id, accepted, difficulty);
+    if (accepted) {
+        Sv2SubmitSharesSuccess success;
+        success.channel_id = SV2_CHANNEL_ID;
+        success.last_sequence_number = submit.sequence_number;
+        success.new_submits_accepted_count = 1;
+        success.new_shares_sum = share_difficulty;
+        SendSv2(client_id, session, success);
+
+        if (retargeted) {
+            LogPrintf("Stratum: Client %d difficulty retargeted to %u\n", client_id, difficulty);
+            Sv2SetTarget set_target;
+            set_target.channel_id = SV2_CHANNEL_ID;
+            set_target.maximum_target = DifficultyToTarget(difficulty);
+            {
+                std::lock_guard<std::mutex> lock(session.mutex);
+                session.difficulty = difficulty;
+            }
+            SendSv2(client_id, session, set_target);
+        }
+    } else {
+        m_metrics.Reject(reject);
+        Sv2SubmitSharesError error;
+        error.channel_id = SV2_CHANNEL_ID;
+        error.sequence_number = submit.sequence_number;
+        error.error_code = error_code;
+        SendSv2(client_id, session, error);
+    }
+}
+
+bool StratumServer::ValidateAndSubmitShare(int client_id, std::string_view job_id,
+                                            std::string_view nonce_hex, std::string_view result_hex,
+                                            uint64_t difficulty, uint32_t extranonce1, ShareReject& reject) {
+    std::shared_ptr<const StratumJob> job_ref;
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        auto it = m_jobs.find(std::string{job_id});
         if (it == m_jobs.end()) {
             LogPrintf("Stratum: Unknown job_id %s\n", job_id);
+            reject = ShareReject::UNKNOWN_JOB;
             return false;
         }
-        job = it->second;
+        job_ref = it->second;
     }
 
+    // Parse nonce (XMRig sends 4 bytes in little-endian hex)
+    std::vector<unsigned char> nonce_bytes;
+    if (nonce_hex.length() >= 8) {
+        nonce_bytes = ParseHex(nonce_hex);
+    }
+    if (nonce_bytes.size() < 4) {
+        nonce_bytes.resize(4, 0);
+    }
+    uint32_t nonce = nonce_bytes[0] | (nonce_bytes[1] << 8) |
+                    (nonce_bytes[2] << 16) | (nonce_bytes[3] << 24);
+
+    // XMRig cannot roll the time; the share carries the job's
+    return ValidateAndSubmitShare(client_id, *job_ref, nonce, static_cast<uint32_t>(job_ref->timestamp),
+                                  difficulty, extranonce1, reject);
+}
+
+bool StratumServer::ValidateAndSubmitShare(int client_id, const StratumJob& job, uint32_t nonce, uint32_t ntime,
+                                           uint64_t difficulty, uint32_t extranonce1, ShareReject& reject) {
     if (!job.block_template) {
-        LogPrintf("Stratum: No block template for job %s\n", job_id);
+        LogPrintf("Stratum: No block template for job %s\n", job.job_id);
+        reject = ShareReject::UNKNOWN_JOB;
         return false;
     }
 
     try {
-        // Parse nonce (XMRig sends 4 bytes in little-endian hex)
-        std::vector<unsigned char> nonce_bytes;
-        if (nonce_hex.length() >= 8) {
-            nonce_bytes = ParseHex(nonce_hex);
-        }
-        if (nonce_bytes.size() < 4) {
-            nonce_bytes.resize(4, 0);
-        }
-        uint32_t nonce = nonce_bytes[0] | (nonce_bytes[1] << 8) |
-                        (nonce_bytes[2] << 16) | (nonce_bytes[3] << 24);
-
-        LogPrintf("Stratum: Validating share - job_id=%s nonce=0x%08x\n", job_id, nonce);
+        LogPrintf("Stratum: Validating share - job_id=%s nonce=0x%08x\n", job.job_id, nonce);
 
         // Ensure RandomX is initialized with the genesis block hash
         const CChainParams& chainParams = Params();
         uint256 genesisHash = chainParams.GenesisBlock().GetHash();
 
         auto& miner = node::GetRandomXMiner();
+        std::unique_lock<std::mutex> init_lock(m_randomx_init_mutex);
         if (!miner.IsInitialized()) {
             LogPrintf("Stratum: Initializing RandomX for validation...\n");
             if (!miner.Initialize(genesisHash.data(), 32, node::RandomXMiner::Mode::LIGHT)) {
@@ -710,19 +1180,19 @@ bool StratumServer::ValidateAndSubmitShare(int client_id, const std::string& job
             }
         }
 
-        // Reconstruct the mining blob with submitted nonce at bytes 39-42
+        init_lock.unlock();
+
+        // Reconstruct the client's mining blob with submitted nonce at bytes 39-42
         // This is the SAME format used by SerializeMiningBlob for consensus validation
-        auto blobBytes = ParseHex(job.blob);
+        std::vector<unsigned char> blobBytes = ClientBlobBytes(job, extranonce1);
         if (blobBytes.size() < 80) {
             LogPrintf("Stratum: Invalid blob size %d (expected 80)\n", blobBytes.size());
             return false;
         }
 
-        // Insert nonce at bytes 39-42 (little-endian)
-        blobBytes[39] = nonce_bytes[0];
-        blobBytes[40] = nonce_bytes[1];
-        blobBytes[41] = nonce_bytes[2];
-        blobBytes[42] = nonce_bytes[3];
+        // Insert nonce at bytes 39-42 and time at 43-46 (little-endian)
+        WriteLE32(blobBytes.data() + 39, nonce);
+        WriteLE32(blobBytes.data() + 43, ntime);
 
         // Hash the blob - this is the same hash used for consensus validation
         uint256 hash;
@@ -742,13 +1212,11 @@ bool StratumServer::ValidateAndSubmitShare(int client_id, const std::string& job
             // BLOCK FOUND! The hash meets the network target
             LogPrintf("Stratum: *** BLOCK FOUND! *** hash=%s nonce=%u\n", hash.GetHex(), nonce);
 
-            // Get block from template and set nonce
-            CBlock block = job.block_template->getBlock();
-            block.nNonce = nonce;
-
-            // Submit the block
-            CTransactionRef coinbase = job.block_template->getCoinbaseTx();
-            bool accepted = job.block_template->submitSolution(block.nVersion, block.nTime, nonce, coinbase);
+            // Submit the block with the coinbase carrying this client's extranonce
+            CTransactionRef coinbase = job.coinbase ? job.coinbase->Coinbase(extranonce1) : job.block_template->getCoinbaseTx();
+            const int64_t submit_start = SteadyMicros();
+            bool accepted = job.block_template->submitSolution(job.version, ntime, nonce, coinbase);
+            m_metrics.block_submit.Record(MicrosSince(submit_start));
 
             if (accepted) {
                 m_blocks_found++;
@@ -757,12 +1225,18 @@ bool StratumServer::ValidateAndSubmitShare(int client_id, const std::string& job
                 return true;
             } else {
                 LogPrintf("Stratum: Block rejected by network\n");
+                reject = ShareReject::BLOCK_REJECTED;
                 return false;
             }
         }
 
-        // Share doesn't meet block target - just accept for pool tracking
-        // (In a real pool, you'd track shares for payment purposes)
+        // Share doesn't meet block target - accept it for pool tracking if it
+        // meets the connection's share difficulty
+        if (!HashMeetsDifficulty(hash, difficulty)) {
+            LogPrintf("Stratum: Share from client %d below difficulty %u\n", client_id, difficulty);
+            reject = ShareReject::LOW_DIFFICULTY;
+            return false;
+        }
         return true;
 
     } catch (const std::exception& e) {
@@ -772,15 +1246,17 @@ bool StratumServer::ValidateAndSubmitShare(int client_id, const std::string& job
 }
 
 void StratumServer::NotifyNewBlock() {
+    // Keep the earliest notification the next job answers
+    int64_t none = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_job_cv_mutex);
+        m_block_notified_us.compare_exchange_strong(none, SteadyMicros());
+    }
     m_job_cv.notify_all();
 }
 
 void StratumServer::SendToClient(int client_id, const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-    auto it = m_clients.find(client_id);
-    if (it == m_clients.end()) return;
-
-    send(it->second->socket_fd, message.c_str(), message.length(), 0);
+    m_io.Send(client_id, message);
 }
 
 void StratumServer::SendResult(int client_id, const std::string& id, const std::string& result) {
@@ -789,26 +1265,19 @@ void StratumServer::SendResult(int client_id, const std::string& id, const std::
     SendToClient(client_id, response.str());
 }
 
-void StratumServer::SendError(int client_id, const std::string& id, int code, const std::string& message) {
+void StratumServer::SendError(int client_id, std::string_view id, int code, const std::string& message) {
     std::ostringstream response;
     response << "{\"id\":" << id << ",\"result\":null,\"error\":[" << code << ",\"" << message << "\",null]}\n";
     SendToClient(client_id, response.str());
 }
 
 void StratumServer::DisconnectClient(int client_id) {
-    std::lock_guard<std::mutex> lock(m_clients_mutex);
-    auto it = m_clients.find(client_id);
-    if (it != m_clients.end()) {
-        if (it->second->socket_fd >= 0) {
-#ifdef WIN32
-            closesocket(it->second->socket_fd);
-#else
-            close(it->second->socket_fd);
-#endif
-        }
-        m_clients.erase(it);
-        LogPrintf("Stratum: Client %d removed\n", client_id);
+    {
+        std::lock_guard<std::mutex> lock(m_clients_mutex);
+        if (m_clients.erase(client_id) == 0) return;
     }
+    m_io.Close(client_id);
+    LogPrintf("Stratum: Client %d removed\n", client_id);
 }
 
 std::string StratumServer::GenerateJobId() {
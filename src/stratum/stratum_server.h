@@ -11,10 +11,18 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include <stratum/coinbase_template.h>
+#include <stratum/event_loop.h>
+#include <stratum/job_payload.h>
+#include <stratum/share_validation.h>
+#include <stratum/stratum_metrics.h>
+#include <stratum/sv2_transport.h>
+#include <stratum/vardiff.h>
 #include <uint256.h>
 
 class CBlock;
@@ -29,33 +37,59 @@ namespace stratum {
 // Stratum job data sent to miners
 struct StratumJob {
     std::string job_id;
-    std::string blob;           // Block header blob (hex)
+    std::string blob;           // Block header blob (hex), for extranonce1 0
+    std::vector<unsigned char> blob_bytes;  // Decoded blob; each client's carries its own merkle root
     std::string target;         // Mining target (hex)
     uint64_t height;
     std::string seed_hash;      // RandomX seed hash
     std::string prev_hash;      // Previous block hash
+    uint256 hash_prev_block;    // Same, for Stratum V2 SetNewPrevHash
     int64_t timestamp;
     uint32_t bits;
+    int32_t version;
+    uint32_t sv2_job_id{0};     // Numeric job id for Stratum V2 channels, increasing
 
     // Full block template for submission
     std::shared_ptr<interfaces::BlockTemplate> block_template;
+
+    // Coinbase split around the extranonce, with its merkle branch
+    std::shared_ptr<const stratum::CoinbaseTemplate> coinbase;
+
+    // Notification serialized once when the job is created
+    std::shared_ptr<const stratum::PreparedJob> prepared;
+};
+
+// Stratum V2 state of a connection on the binary port
+struct Sv2Session {
+    Sv2Session(const CKey& static_key, const Sv2Certificate& certificate) : transport(static_key, certificate) {}
+
+    // Guards everything below; frames must be sealed in the order they are sent
+    std::mutex mutex;
+    Sv2Transport transport;
+    bool setup{false};
+    bool channel_open{false};   // One standard (header-only) channel per connection
+    uint32_t job_id{0};         // Latest job sent on the channel
+    uint256 prev_hash;          // Previous block of the latest SetNewPrevHash
+    uint64_t difficulty{0};     // Difficulty of the channel's current target
 };
 
 // Connected miner client
 struct StratumClient {
-    int socket_fd;
+    std::string peer_address;
     std::string worker_name;
     std::string wallet_address;
     bool authorized;
     bool subscribed;
     std::string session_id;
+    uint32_t extranonce1{0};    // Unique per connection; selects its coinbase and so its nonce space
     uint64_t shares_accepted;
     uint64_t shares_rejected;
     int64_t connect_time;
     int64_t last_activity;
-    std::string recv_buffer;
+    VardiffState vardiff;
+    std::shared_ptr<Sv2Session> sv2;  // Set for connections on the Stratum V2 port
 
-    StratumClient() : socket_fd(-1), authorized(false), subscribed(false),
+    StratumClient() : authorized(false), subscribed(false),
                       shares_accepted(0), shares_rejected(0), connect_time(0), last_activity(0) {}
 };
 
@@ -63,9 +97,15 @@ struct StratumClient {
 struct StratumConfig {
     std::string bind_address = "0.0.0.0";
     uint16_t port = 3335;
+    uint16_t sv2_port = 0;             // Stratum V2 listener (Noise, binary framing); 0 disables it
     int max_clients = 100;
     int job_timeout_seconds = 60;
+    int io_threads = DEFAULT_STRATUM_IO_THREADS;  // Event loop threads shared by all connections
+    int validation_threads = DEFAULT_SHARE_VALIDATION_THREADS;  // Threads hashing submitted shares
+    size_t validation_queue = DEFAULT_SHARE_VALIDATION_QUEUE;   // Submits waiting beyond this are refused
     std::string default_wallet;  // Default wallet for coinbase if miner doesn't specify
+    uint64_t share_difficulty = 10000;  // Starting share difficulty for each connection
+    VardiffConfig vardiff;             // Per-connection difficulty tuning
 };
 
 class StratumServer {
@@ -80,38 +120,67 @@ public:
 
     // Get server info
     uint16_t GetPort() const { return m_config.port; }
+    uint16_t GetSv2Port() const { return m_sv2_listen_socket >= 0 ? m_config.sv2_port : 0; }
+    // Key Stratum V2 miners pin to authenticate the server (x-only, hex)
+    std::string GetSv2AuthorityKey() const;
     size_t GetClientCount() const;
     uint64_t GetTotalSharesAccepted() const { return m_total_shares_accepted.load(); }
     uint64_t GetTotalSharesRejected() const { return m_total_shares_rejected.load(); }
     uint64_t GetBlocksFound() const { return m_blocks_found.load(); }
 
+    // Per-stage latencies, reject reasons and per-connection traffic
+    const StratumMetrics& GetMetrics() const { return m_metrics; }
+    std::vector<ConnectionMetrics> GetConnectionMetrics() const;
+    size_t GetValidationQueueDepth() const { return m_validators.GetQueueDepth(); }
+
     // Notify all clients of new job (called when new block arrives)
     void NotifyNewBlock();
 
 private:
+    // Event loop callbacks (run on I/O threads)
+    int OnAccept(int listener_id, const std::string& peer_addr);
+    void OnDisconnect(int client_id);
+
     // Server threads
-    void AcceptThread();
-    void ClientThread(int client_id);
     void JobThread();
 
     // Protocol handlers
-    void HandleMessage(int client_id, const std::string& message);
+    void HandleMessage(int client_id, std::string_view message);
     void HandleSubscribe(int client_id, const std::string& id, const std::vector<std::string>& params);
     void HandleAuthorize(int client_id, const std::string& id, const std::vector<std::string>& params);
     void HandleSubmit(int client_id, const std::string& id, const std::vector<std::string>& params);
+    void ProcessSubmit(int client_id, std::string_view id, std::string_view job_id,
+                       std::string_view nonce, std::string_view result);
+    void FinishSubmit(int client_id, const std::string& id, const std::string& job_id,
+                      const std::string& nonce, const std::string& result);  // runs on a validation thread
     void HandleGetJob(int client_id, const std::string& id, const std::vector<std::string>& params);
 
+    // Stratum V2 (run on I/O threads, except FinishSv2Submit)
+    void HandleSv2Data(int client_id, const std::shared_ptr<Sv2Session>& session, std::string_view data);
+    bool HandleSv2Message(int client_id, const std::shared_ptr<Sv2Session>& session, const Sv2Transport::Message& message);
+    bool HandleSv2OpenChannel(int client_id, Sv2Session& session, const Sv2OpenStandardMiningChannel& open);
+    void FinishSv2Submit(int client_id, Sv2Session& session, const Sv2SubmitSharesStandard& submit);  // runs on a validation thread
+    template <typename Msg>
+    void SendSv2(int client_id, Sv2Session& session, const Msg& msg);
+    void SendSv2Job(int client_id, Sv2Session& session, const StratumJob& job, uint64_t difficulty, uint32_t extranonce1);
+
     // Job management
     void CreateNewJob();
     void BroadcastJob(const StratumJob& job);
-    bool ValidateAndSubmitShare(int client_id, const std::string& job_id,
-                                 const std::string& nonce, const std::string& result);
+    bool ValidateAndSubmitShare(int client_id, std::string_view job_id,
+                                 std::string_view nonce, std::string_view result, uint64_t difficulty,
+                                 uint32_t extranonce1, ShareReject& reject);
+    bool ValidateAndSubmitShare(int client_id, const StratumJob& job, uint32_t nonce, uint32_t ntime,
+                                uint64_t difficulty, uint32_t extranonce1, ShareReject& reject);
+    // Count a validated share; true if the client's difficulty was retargeted
+    bool RecordShareResult(int client_id, bool accepted, uint64_t& difficulty);
 
     // Network helpers
     void SendToClient(int client_id, const std::string& message);
     void SendResult(int client_id, const std::string& id, const std::string& result);
-    void SendError(int client_id, const std::string& id, int code, const std::string& message);
+    void SendError(int client_id, std::string_view id, int code, const std::string& message);
     void SendJob(int client_id, const StratumJob& job);
+    void SendJob(int client_id, const StratumJob& job, uint64_t difficulty, uint32_t extranonce1);
     void DisconnectClient(int client_id);
 
     // Generate unique IDs
@@ -125,27 +194,41 @@ private:
     // Server state
     std::atomic<bool> m_running{false};
     int m_listen_socket{-1};
+    int m_sv2_listen_socket{-1};
+
+    // Stratum V2: static key of the Noise handshake and the certificate an
+    // authority key signs for it; both are generated when the server starts
+    CKey m_sv2_static_key;
+    CKey m_sv2_authority_key;
+    Sv2Certificate m_sv2_certificate;
 
     // Threads
-    std::thread m_accept_thread;
+    StratumEventLoop m_io;
+    ShareValidationPool m_validators;
     std::thread m_job_thread;
-    std::vector<std::thread> m_client_threads;
 
     // Clients
     mutable std::mutex m_clients_mutex;
     std::unordered_map<int, std::unique_ptr<StratumClient>> m_clients;
     int m_next_client_id{0};
+    uint32_t m_next_extranonce1{0};
 
-    // Jobs
+    // Jobs are immutable once published; lookups only copy the pointer
     mutable std::mutex m_jobs_mutex;
-    std::unordered_map<std::string, StratumJob> m_jobs;
-    StratumJob m_current_job;
+    std::unordered_map<std::string, std::shared_ptr<const StratumJob>> m_jobs;
+    std::shared_ptr<const StratumJob> m_current_job;
+    std::mutex m_randomx_init_mutex;
     std::atomic<uint64_t> m_job_counter{0};
+    std::atomic<uint32_t> m_sv2_job_counter{0};
 
     // Statistics
     std::atomic<uint64_t> m_total_shares_accepted{0};
     std::atomic<uint64_t> m_total_shares_rejected{0};
     std::atomic<uint64_t> m_blocks_found{0};
+    StratumMetrics m_metrics;
+    //! Steady clock microseconds of the new-block notification the next job
+    //! answers, 0 if none is pending
+    std::atomic<int64_t> m_block_notified_us{0};
 
     // Synchronization
     std::condition_variable m_job_cv;
@@ -0,0 +1,185 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/sv2_messages.h>
+
+#include <crypto/common.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace stratum {
+
+static_assert(sizeof(float) == 4 && std::numeric_limits<float>::is_iec559, "f32 fields are IEEE 754 binary32");
+
+void Sv2FrameHeader::Serialize(std::byte* out) const
+{
+    auto* p = UCharCast(out);
+    WriteLE16(p, extension_type);
+    p[2] = msg_type;
+    p[3] = msg_length & 0xff;
+    p[4] = (msg_length >> 8) & 0xff;
+    p[5] = (msg_length >> 16) & 0xff;
+}
+
+Sv2FrameHeader Sv2FrameHeader::Deserialize(const std::byte* in)
+{
+    const auto* p = UCharCast(in);
+    Sv2FrameHeader header;
+    header.extension_type = ReadLE16(p);
+    header.msg_type = p[2];
+    header.msg_length = uint32_t{p[3]} | (uint32_t{p[4]} << 8) | (uint32_t{p[5]} << 16);
+    return header;
+}
+
+// ============================================================================
+// Sv2Writer
+// ============================================================================
+
+void Sv2Writer::operator()(uint8_t v)
+{
+    m_out.push_back(std::byte{v});
+}
+
+void Sv2Writer::operator()(uint16_t v)
+{
+    unsigned char buf[2];
+    WriteLE16(buf, v);
+    m_out.insert(m_out.end(), reinterpret_cast<const std::byte*>(buf), reinterpret_cast<const std::byte*>(buf) + sizeof(buf));
+}
+
+void Sv2Writer::operator()(uint32_t v)
+{
+    unsigned char buf[4];
+    WriteLE32(buf, v);
+    m_out.insert(m_out.end(), reinterpret_cast<const std::byte*>(buf), reinterpret_cast<const std::byte*>(buf) + sizeof(buf));
+}
+
+void Sv2Writer::operator()(uint64_t v)
+{
+    unsigned char buf[8];
+    WriteLE64(buf, v);
+    m_out.insert(m_out.end(), reinterpret_cast<const std::byte*>(buf), reinterpret_cast<const std::byte*>(buf) + sizeof(buf));
+}
+
+void Sv2Writer::operator()(float v)
+{
+    (*this)(std::bit_cast<uint32_t>(v));
+}
+
+void Sv2Writer::operator()(const uint256& v)
+{
+    // U256 is little-endian, as uint256 is stored
+    const auto bytes = MakeByteSpan(v);
+    m_out.insert(m_out.end(), bytes.begin(), bytes.end());
+}
+
+void Sv2Writer::operator()(const std::string& v)
+{
+    const size_t len = std::min<size_t>(v.size(), 255);
+    m_out.push_back(std::byte(len));
+    m_out.insert(m_out.end(), reinterpret_cast<const std::byte*>(v.data()), reinterpret_cast<const std::byte*>(v.data()) + len);
+}
+
+void Sv2Writer::operator()(const std::vector<unsigned char>& v)
+{
+    const size_t len = std::min<size_t>(v.size(), 32);
+    m_out.push_back(std::byte(len));
+    m_out.insert(m_out.end(), reinterpret_cast<const std::byte*>(v.data()), reinterpret_cast<const std::byte*>(v.data()) + len);
+}
+
+void Sv2Writer::operator()(const std::optional<uint32_t>& v)
+{
+    (*this)(uint8_t{v.has_value()});
+    if (v) (*this)(*v);
+}
+
+// ============================================================================
+// Sv2Reader
+// ============================================================================
+
+Span<const std::byte> Sv2Reader::Take(size_t n)
+{
+    if (!m_ok || m_in.size() < n) {
+        m_ok = false;
+        return {};
+    }
+    auto out = m_in.first(n);
+    m_in = m_in.subspan(n);
+    return out;
+}
+
+void Sv2Reader::operator()(uint8_t& v)
+{
+    auto in = Take(1);
+    if (m_ok) v = std::to_integer<uint8_t>(in[0]);
+}
+
+void Sv2Reader::operator()(uint16_t& v)
+{
+    auto in = Take(2);
+    if (m_ok) v = ReadLE16(UCharCast(in.data()));
+}
+
+void Sv2Reader::operator()(uint32_t& v)
+{
+    auto in = Take(4);
+    if (m_ok) v = ReadLE32(UCharCast(in.data()));
+}
+
+void Sv2Reader::operator()(uint64_t& v)
+{
+    auto in = Take(8);
+    if (m_ok) v = ReadLE64(UCharCast(in.data()));
+}
+
+void Sv2Reader::operator()(float& v)
+{
+    uint32_t bits{0};
+    (*this)(bits);
+    if (m_ok) v = std::bit_cast<float>(bits);
+}
+
+void Sv2Reader::operator()(uint256& v)
+{
+    auto in = Take(v.size());
+    if (m_ok) std::memcpy(v.data(), in.data(), v.size());
+}
+
+void Sv2Reader::operator()(std::string& v)
+{
+    uint8_t len{0};
+    (*this)(len);
+    auto in = Take(len);
+    if (m_ok) v.assign(reinterpret_cast<const char*>(in.data()), in.size());
+}
+
+void Sv2Reader::operator()(std::vector<unsigned char>& v)
+{
+    uint8_t len{0};
+    (*this)(len);
+    if (len > 32) m_ok = false;
+    auto in = Take(len);
+    if (m_ok) v.assign(UCharCast(in.data()), UCharCast(in.data()) + in.size());
+}
+
+void Sv2Reader::operator()(std::optional<uint32_t>& v)
+{
+    uint8_t present{0};
+    (*this)(present);
+    if (!m_ok) return;
+    if (present > 1) {
+        m_ok = false;
+    } else if (present == 0) {
+        v.reset();
+    } else {
+        uint32_t value{0};
+        (*this)(value);
+        if (m_ok) v = value;
+    }
+}
+
+} // namespace stratum
@@ -0,0 +1,315 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_SV2_MESSAGES_H
+#define WATTX_STRATUM_SV2_MESSAGES_H
+
+#include <span.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace stratum {
+
+//! Frame header: extension_type (u16), msg_type (u8), msg_length (u24)
+static constexpr size_t SV2_FRAME_HEADER_SIZE = 6;
+//! Set in extension_type for messages addressed to a channel
+static constexpr uint16_t SV2_CHANNEL_MSG_BIT = 0x8000;
+//! Longest payload accepted from a peer; every mining message is far shorter
+static constexpr uint32_t MAX_SV2_PAYLOAD = 16 * 1024;
+
+//! Mining protocol message types used by the header-only channels
+enum class Sv2MsgType : uint8_t {
+    SETUP_CONNECTION = 0x00,
+    SETUP_CONNECTION_SUCCESS = 0x01,
+    SETUP_CONNECTION_ERROR = 0x02,
+    OPEN_STANDARD_MINING_CHANNEL = 0x10,
+    OPEN_STANDARD_MINING_CHANNEL_SUCCESS = 0x11,
+    OPEN_MINING_CHANNEL_ERROR = 0x12,
+    NEW_MINING_JOB = 0x15,
+    SUBMIT_SHARES_STANDARD = 0x1a,
+    SUBMIT_SHARES_SUCCESS = 0x1c,
+    SUBMIT_SHARES_ERROR = 0x1d,
+    SET_NEW_PREV_HASH = 0x20,
+    SET_TARGET = 0x21,
+};
+
+struct Sv2FrameHeader {
+    uint16_t extension_type{0};
+    uint8_t msg_type{0};
+    uint32_t msg_length{0};
+
+    //! Write SV2_FRAME_HEADER_SIZE bytes at @p out
+    void Serialize(std::byte* out) const;
+    //! Read SV2_FRAME_HEADER_SIZE bytes at @p in
+    static Sv2FrameHeader Deserialize(const std::byte* in);
+};
+
+/**
+ * Little-endian field writer for the Stratum V2 binary types. Strings are
+ * STR0_255 and byte vectors B0_32; longer values are truncated.
+ */
+class Sv2Writer {
+public:
+    explicit Sv2Writer(std::vector<std::byte>& out) : m_out(out) {}
+
+    void operator()(uint8_t v);
+    void operator()(uint16_t v);
+    void operator()(uint32_t v);
+    void operator()(uint64_t v);
+    void operator()(float v);
+    void operator()(const uint256& v);
+    void operator()(const std::string& v);
+    void operator()(const std::vector<unsigned char>& v);
+    void operator()(const std::optional<uint32_t>& v);
+
+private:
+    std::vector<std::byte>& m_out;
+};
+
+/** Reader matching Sv2Writer; any short or malformed field clears Ok() */
+class Sv2Reader {
+public:
+    explicit Sv2Reader(Span<const std::byte> in) : m_in(in) {}
+
+    void operator()(uint8_t& v);
+    void operator()(uint16_t& v);
+    void operator()(uint32_t& v);
+    void operator()(uint64_t& v);
+    void operator()(float& v);
+    void operator()(uint256& v);
+    void operator()(std::string& v);
+    void operator()(std::vector<unsigned char>& v);
+    void operator()(std::optional<uint32_t>& v);
+
+    //! True if every field was read and nothing is left over
+    bool Ok() const { return m_ok && m_in.empty(); }
+
+private:
+    Span<const std::byte> Take(size_t n);
+
+    Span<const std::byte> m_in;
+    bool m_ok{true};
+};
+
+// Messages list their fields in wire order through Fields(self, visitor),
+// shared by encoding (const self, Sv2Writer) and decoding (Sv2Reader).
+
+struct Sv2SetupConnection {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SETUP_CONNECTION};
+    static constexpr bool CHANNEL_MSG{false};
+    //! Flag bits of the mining protocol
+    static constexpr uint32_t REQUIRES_STANDARD_JOBS = 1 << 0;
+    static constexpr uint32_t REQUIRES_WORK_SELECTION = 1 << 1;
+    static constexpr uint32_t REQUIRES_VERSION_ROLLING = 1 << 2;
+
+    uint8_t protocol{0};
+    uint16_t min_version{0};
+    uint16_t max_version{0};
+    uint32_t flags{0};
+    std::string endpoint_host;
+    uint16_t endpoint_port{0};
+    std::string vendor;
+    std::string hardware_version;
+    std::string firmware;
+    std::string device_id;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.protocol), v(self.min_version), v(self.max_version), v(self.flags), v(self.endpoint_host),
+            v(self.endpoint_port), v(self.vendor), v(self.hardware_version), v(self.firmware), v(self.device_id);
+    }
+};
+
+struct Sv2SetupConnectionSuccess {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SETUP_CONNECTION_SUCCESS};
+    static constexpr bool CHANNEL_MSG{false};
+    //! The server does not accept rolled header versions
+    static constexpr uint32_t REQUIRES_FIXED_VERSION = 1 << 0;
+
+    uint16_t used_version{0};
+    uint32_t flags{0};
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v) { v(self.used_version), v(self.flags); }
+};
+
+struct Sv2SetupConnectionError {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SETUP_CONNECTION_ERROR};
+    static constexpr bool CHANNEL_MSG{false};
+
+    uint32_t flags{0};
+    std::string error_code;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v) { v(self.flags), v(self.error_code); }
+};
+
+struct Sv2OpenStandardMiningChannel {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::OPEN_STANDARD_MINING_CHANNEL};
+    static constexpr bool CHANNEL_MSG{false};
+
+    uint32_t request_id{0};
+    std::string user_identity;
+    float nominal_hash_rate{0};
+    uint256 max_target;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.request_id), v(self.user_identity), v(self.nominal_hash_rate), v(self.max_target);
+    }
+};
+
+struct Sv2OpenStandardMiningChannelSuccess {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::OPEN_STANDARD_MINING_CHANNEL_SUCCESS};
+    static constexpr bool CHANNEL_MSG{false};
+
+    uint32_t request_id{0};
+    uint32_t channel_id{0};
+    uint256 target;
+    std::vector<unsigned char> extranonce_prefix;
+    uint32_t group_channel_id{0};
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.request_id), v(self.channel_id), v(self.target), v(self.extranonce_prefix), v(self.group_channel_id);
+    }
+};
+
+struct Sv2OpenMiningChannelError {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::OPEN_MINING_CHANNEL_ERROR};
+    static constexpr bool CHANNEL_MSG{false};
+
+    uint32_t request_id{0};
+    std::string error_code;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v) { v(self.request_id), v(self.error_code); }
+};
+
+struct Sv2NewMiningJob {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::NEW_MINING_JOB};
+    static constexpr bool CHANNEL_MSG{true};
+
+    uint32_t channel_id{0};
+    uint32_t job_id{0};
+    std::optional<uint32_t> min_ntime;  //!< unset for a future job, activated by SetNewPrevHash
+    uint32_t version{0};
+    std::vector<unsigned char> merkle_root;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.channel_id), v(self.job_id), v(self.min_ntime), v(self.version), v(self.merkle_root);
+    }
+};
+
+struct Sv2SetNewPrevHash {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SET_NEW_PREV_HASH};
+    static constexpr bool CHANNEL_MSG{true};
+
+    uint32_t channel_id{0};
+    uint32_t job_id{0};
+    uint256 prev_hash;
+    uint32_t min_ntime{0};
+    uint32_t nbits{0};
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.channel_id), v(self.job_id), v(self.prev_hash), v(self.min_ntime), v(self.nbits);
+    }
+};
+
+struct Sv2SubmitSharesStandard {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SUBMIT_SHARES_STANDARD};
+    static constexpr bool CHANNEL_MSG{true};
+
+    uint32_t channel_id{0};
+    uint32_t sequence_number{0};
+    uint32_t job_id{0};
+    uint32_t nonce{0};
+    uint32_t ntime{0};
+    uint32_t version{0};
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.channel_id), v(self.sequence_number), v(self.job_id), v(self.nonce), v(self.ntime), v(self.version);
+    }
+};
+
+struct Sv2SubmitSharesSuccess {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SUBMIT_SHARES_SUCCESS};
+    static constexpr bool CHANNEL_MSG{true};
+
+    uint32_t channel_id{0};
+    uint32_t last_sequence_number{0};
+    uint32_t new_submits_accepted_count{0};
+    uint64_t new_shares_sum{0};
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v)
+    {
+        v(self.channel_id), v(self.last_sequence_number), v(self.new_submits_accepted_count), v(self.new_shares_sum);
+    }
+};
+
+struct Sv2SubmitSharesError {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SUBMIT_SHARES_ERROR};
+    static constexpr bool CHANNEL_MSG{true};
+
+    uint32_t channel_id{0};
+    uint32_t sequence_number{0};
+    std::string error_code;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v) { v(self.channel_id), v(self.sequence_number), v(self.error_code); }
+};
+
+struct Sv2SetTarget {
+    static constexpr Sv2MsgType TYPE{Sv2MsgType::SET_TARGET};
+    static constexpr bool CHANNEL_MSG{true};
+
+    uint32_t channel_id{0};
+    uint256 maximum_target;
+
+    template <typename Self, typename Visitor>
+    static void Fields(Self& self, Visitor& v) { v(self.channel_id), v(self.maximum_target); }
+};
+
+/** Header and payload of @p msg, unencrypted */
+template <typename Msg>
+std::vector<std::byte> Sv2EncodeFrame(const Msg& msg)
+{
+    std::vector<std::byte> frame(SV2_FRAME_HEADER_SIZE);
+    Sv2Writer writer{frame};
+    Msg::Fields(msg, writer);
+    Sv2FrameHeader header;
+    header.extension_type = Msg::CHANNEL_MSG ? SV2_CHANNEL_MSG_BIT : 0;
+    header.msg_type = static_cast<uint8_t>(Msg::TYPE);
+    header.msg_length = frame.size() - SV2_FRAME_HEADER_SIZE;
+    header.Serialize(frame.data());
+    return frame;
+}
+
+/** Decode a payload; false unless it holds exactly the fields of Msg */
+template <typename Msg>
+bool Sv2DecodePayload(Span<const std::byte> payload, Msg& msg)
+{
+    Sv2Reader reader{payload};
+    Msg::Fields(msg, reader);
+    return reader.Ok();
+}
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_SV2_MESSAGES_H
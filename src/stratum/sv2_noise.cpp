@@ -0,0 +1,212 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/sv2_noise.h>
+
+#include <crypto/common.h>
+#include <crypto/hmac_sha256.h>
+#include <crypto/sha256.h>
+#include <hash.h>
+#include <random.h>
+
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace stratum {
+
+static constexpr std::string_view SV2_NOISE_PROTOCOL_NAME{"Noise_NX_Secp256k1+EllSwift_ChaChaPoly_SHA256"};
+
+// ============================================================================
+// Sv2CipherState
+// ============================================================================
+
+Sv2CipherState::Sv2CipherState(const uint256& key)
+{
+    m_aead.emplace(MakeByteSpan(key));
+}
+
+void Sv2CipherState::Encrypt(Span<const std::byte> ad, Span<const std::byte> plain, Span<std::byte> cipher)
+{
+    // Noise ChaChaPoly nonce: 32 zero bits, then the counter little-endian
+    m_aead->Encrypt(plain, ad, {0, m_nonce++}, cipher);
+}
+
+bool Sv2CipherState::Decrypt(Span<const std::byte> ad, Span<const std::byte> cipher, Span<std::byte> plain)
+{
+    return m_aead->Decrypt(cipher, ad, {0, m_nonce++}, plain);
+}
+
+// ============================================================================
+// Sv2Certificate
+// ============================================================================
+
+uint256 Sv2Certificate::SigningHash(const XOnlyPubKey& static_key) const
+{
+    return (HashWriter{} << version << valid_from << not_valid_after << static_key).GetSHA256();
+}
+
+bool Sv2Certificate::Sign(const CKey& authority, const XOnlyPubKey& static_key)
+{
+    return authority.SignSchnorr(SigningHash(static_key), signature, nullptr, GetRandHash());
+}
+
+bool Sv2Certificate::Verify(const XOnlyPubKey& authority, const XOnlyPubKey& static_key, uint32_t now) const
+{
+    if (now < valid_from || now > not_valid_after) return false;
+    return authority.VerifySchnorr(SigningHash(static_key), signature);
+}
+
+std::array<std::byte, Sv2Certificate::SIZE> Sv2Certificate::Serialize() const
+{
+    std::array<std::byte, SIZE> out;
+    auto* p = UCharCast(out.data());
+    WriteLE16(p, version);
+    WriteLE32(p + 2, valid_from);
+    WriteLE32(p + 6, not_valid_after);
+    std::memcpy(p + 10, signature.data(), signature.size());
+    return out;
+}
+
+Sv2Certificate Sv2Certificate::Deserialize(const std::array<std::byte, SIZE>& data)
+{
+    const auto* p = UCharCast(data.data());
+    Sv2Certificate certificate;
+    certificate.version = ReadLE16(p);
+    certificate.valid_from = ReadLE32(p + 2);
+    certificate.not_valid_after = ReadLE32(p + 6);
+    std::memcpy(certificate.signature.data(), p + 10, certificate.signature.size());
+    return certificate;
+}
+
+// ============================================================================
+// Sv2Handshake
+// ============================================================================
+
+//! Noise HKDF: two outputs chained from HMAC-SHA256 keyed with the chaining key
+static std::pair<uint256, uint256> NoiseHkdf(const uint256& chaining_key, Span<const std::byte> input_key_material)
+{
+    uint256 temp_key, out1, out2;
+    CHMAC_SHA256(chaining_key.data(), chaining_key.size())
+        .Write(UCharCast(input_key_material.data()), input_key_material.size())
+        .Finalize(temp_key.data());
+    const unsigned char one = 0x01, two = 0x02;
+    CHMAC_SHA256(temp_key.data(), temp_key.size()).Write(&one, 1).Finalize(out1.data());
+    CHMAC_SHA256(temp_key.data(), temp_key.size()).Write(out1.data(), out1.size()).Write(&two, 1).Finalize(out2.data());
+    return {out1, out2};
+}
+
+static void InitSymmetricState(uint256& chaining_key, uint256& hash)
+{
+    CSHA256().Write(UCharCast(SV2_NOISE_PROTOCOL_NAME.data()), SV2_NOISE_PROTOCOL_NAME.size()).Finalize(hash.data());
+    chaining_key = hash;
+    // Empty prologue
+    CSHA256().Write(hash.data(), hash.size()).Finalize(hash.data());
+}
+
+Sv2Handshake::Sv2Handshake(const CKey& static_key, const Sv2Certificate& certificate)
+    : m_initiator(false), m_static_key(static_key), m_certificate(certificate)
+{
+    InitSymmetricState(m_chaining_key, m_hash);
+    m_static = m_static_key.EllSwiftCreate(MakeByteSpan(GetRandHash()));
+}
+
+Sv2Handshake::Sv2Handshake(const XOnlyPubKey& authority)
+    : m_initiator(true), m_authority(authority)
+{
+    InitSymmetricState(m_chaining_key, m_hash);
+}
+
+void Sv2Handshake::MixHash(Span<const std::byte> data)
+{
+    CSHA256().Write(m_hash.data(), m_hash.size()).Write(UCharCast(data.data()), data.size()).Finalize(m_hash.data());
+}
+
+void Sv2Handshake::MixKey(Span<const std::byte> input_key_material)
+{
+    auto [chaining_key, key] = NoiseHkdf(m_chaining_key, input_key_material);
+    m_chaining_key = chaining_key;
+    m_cipher = Sv2CipherState(key);
+}
+
+void Sv2Handshake::EncryptAndHash(Span<const std::byte> plain, std::vector<std::byte>& out)
+{
+    const size_t start = out.size();
+    out.resize(start + plain.size() + SV2_MAC_SIZE);
+    Span<std::byte> cipher{out.data() + start, plain.size() + SV2_MAC_SIZE};
+    m_cipher.Encrypt(MakeByteSpan(m_hash), plain, cipher);
+    MixHash(cipher);
+}
+
+bool Sv2Handshake::DecryptAndHash(Span<const std::byte> cipher, Span<std::byte> plain)
+{
+    if (!m_cipher.Decrypt(MakeByteSpan(m_hash), cipher, plain)) return false;
+    MixHash(cipher);
+    return true;
+}
+
+void Sv2Handshake::GenerateEphemeral()
+{
+    m_ephemeral_key = GenerateRandomKey();
+    m_ephemeral = m_ephemeral_key.EllSwiftCreate(MakeByteSpan(GetRandHash()));
+}
+
+std::vector<std::byte> Sv2Handshake::WriteStep0()
+{
+    // -> e
+    GenerateEphemeral();
+    MixHash(m_ephemeral);
+    MixHash({});  // empty payload, no key yet
+    return {m_ephemeral.begin(), m_ephemeral.end()};
+}
+
+bool Sv2Handshake::ReadStep0(Span<const std::byte> message, std::vector<std::byte>& reply)
+{
+    if (m_initiator || message.size() != SV2_HANDSHAKE_STEP0_SIZE) return false;
+    m_remote_ephemeral = EllSwiftPubKey{message};
+    MixHash(message);
+    MixHash({});
+
+    // <- e, ee, s, es
+    reply.clear();
+    reply.reserve(STEP1_SIZE);
+    GenerateEphemeral();
+    reply.insert(reply.end(), m_ephemeral.begin(), m_ephemeral.end());
+    MixHash(m_ephemeral);
+    MixKey(m_ephemeral_key.ComputeBIP324ECDHSecret(m_remote_ephemeral, m_ephemeral, /*initiating=*/false));
+    EncryptAndHash(m_static, reply);
+    MixKey(m_static_key.ComputeBIP324ECDHSecret(m_remote_ephemeral, m_static, /*initiating=*/false));
+    EncryptAndHash(m_certificate.Serialize(), reply);
+    return true;
+}
+
+bool Sv2Handshake::ReadStep1(Span<const std::byte> message, uint32_t now)
+{
+    if (!m_initiator || message.size() != STEP1_SIZE) return false;
+
+    m_remote_ephemeral = EllSwiftPubKey{message.first(EllSwiftPubKey::size())};
+    MixHash(message.first(EllSwiftPubKey::size()));
+    message = message.subspan(EllSwiftPubKey::size());
+    MixKey(m_ephemeral_key.ComputeBIP324ECDHSecret(m_remote_ephemeral, m_ephemeral, /*initiating=*/true));
+
+    std::array<std::byte, EllSwiftPubKey::size()> remote_static_bytes;
+    if (!DecryptAndHash(message.first(remote_static_bytes.size() + SV2_MAC_SIZE), remote_static_bytes)) return false;
+    message = message.subspan(remote_static_bytes.size() + SV2_MAC_SIZE);
+    const EllSwiftPubKey remote_static{remote_static_bytes};
+    MixKey(m_ephemeral_key.ComputeBIP324ECDHSecret(remote_static, m_ephemeral, /*initiating=*/true));
+
+    std::array<std::byte, Sv2Certificate::SIZE> certificate_bytes;
+    if (!DecryptAndHash(message, certificate_bytes)) return false;
+    const Sv2Certificate certificate = Sv2Certificate::Deserialize(certificate_bytes);
+    return certificate.Verify(m_authority, XOnlyPubKey{remote_static.Decode()}, now);
+}
+
+void Sv2Handshake::Split(Sv2CipherState& send, Sv2CipherState& receive) const
+{
+    auto [initiator_key, responder_key] = NoiseHkdf(m_chaining_key, {});
+    send = Sv2CipherState(m_initiator ? initiator_key : responder_key);
+    receive = Sv2CipherState(m_initiator ? responder_key : initiator_key);
+}
+
+} // namespace stratum
@@ -0,0 +1,122 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_SV2_NOISE_H
+#define WATTX_STRATUM_SV2_NOISE_H
+
+#include <crypto/chacha20poly1305.h>
+#include <key.h>
+#include <pubkey.h>
+#include <span.h>
+#include <uint256.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace stratum {
+
+//! Bytes a ChaCha20-Poly1305 seal adds
+static constexpr size_t SV2_MAC_SIZE = AEADChaCha20Poly1305::EXPANSION;
+//! Initiator's first handshake message: its ephemeral key
+static constexpr size_t SV2_HANDSHAKE_STEP0_SIZE = EllSwiftPubKey::size();
+
+/**
+ * Noise cipher state: a ChaCha20-Poly1305 key and the nonce counter of
+ * the messages sealed or opened with it.
+ */
+class Sv2CipherState {
+public:
+    Sv2CipherState() = default;
+    explicit Sv2CipherState(const uint256& key);
+
+    bool HasKey() const { return m_aead.has_value(); }
+
+    //! @p cipher must be SV2_MAC_SIZE longer than @p plain
+    void Encrypt(Span<const std::byte> ad, Span<const std::byte> plain, Span<std::byte> cipher);
+    //! @p plain must be SV2_MAC_SIZE shorter than @p cipher; false if the MAC does not verify
+    bool Decrypt(Span<const std::byte> ad, Span<const std::byte> cipher, Span<std::byte> plain);
+
+private:
+    std::optional<AEADChaCha20Poly1305> m_aead;
+    uint64_t m_nonce{0};
+};
+
+/**
+ * Certificate the responder sends inside the handshake: a validity window
+ * and the authority's BIP340 signature binding it to the responder's static
+ * key. Miners pin the authority key, not the (rotatable) static key.
+ */
+struct Sv2Certificate {
+    static constexpr size_t SIZE = 2 + 4 + 4 + 64;
+
+    uint16_t version{0};
+    uint32_t valid_from{0};
+    uint32_t not_valid_after{0};
+    std::array<unsigned char, 64> signature{};
+
+    uint256 SigningHash(const XOnlyPubKey& static_key) const;
+    bool Sign(const CKey& authority, const XOnlyPubKey& static_key);
+    bool Verify(const XOnlyPubKey& authority, const XOnlyPubKey& static_key, uint32_t now) const;
+
+    std::array<std::byte, SIZE> Serialize() const;
+    static Sv2Certificate Deserialize(const std::array<std::byte, SIZE>& data);
+};
+
+/**
+ * Noise_NX_Secp256k1+EllSwift_ChaChaPoly_SHA256, the Stratum V2 handshake.
+ *
+ * One round trip: the initiator (miner) sends an ephemeral key, the
+ * responder (pool) answers with its ephemeral key and, encrypted, its
+ * static key and certificate. ECDH is the BIP324 ElligatorSwift x-only
+ * exchange. Both sides then Split() into one cipher per direction.
+ */
+class Sv2Handshake {
+public:
+    //! Responder's reply: ephemeral key, sealed static key, sealed certificate
+    static constexpr size_t STEP1_SIZE = EllSwiftPubKey::size() + (EllSwiftPubKey::size() + SV2_MAC_SIZE) +
+                                         (Sv2Certificate::SIZE + SV2_MAC_SIZE);
+
+    //! Responder holding a static key and a certificate for it
+    Sv2Handshake(const CKey& static_key, const Sv2Certificate& certificate);
+    //! Initiator that accepts responders certified by @p authority
+    explicit Sv2Handshake(const XOnlyPubKey& authority);
+
+    //! Initiator: the first message
+    std::vector<std::byte> WriteStep0();
+    //! Responder: read the first message and produce the reply
+    bool ReadStep0(Span<const std::byte> message, std::vector<std::byte>& reply);
+    //! Initiator: read the reply and check the certificate against @p now
+    bool ReadStep1(Span<const std::byte> message, uint32_t now);
+
+    //! Ciphers for each direction once the handshake is complete
+    void Split(Sv2CipherState& send, Sv2CipherState& receive) const;
+
+private:
+    void MixHash(Span<const std::byte> data);
+    void MixKey(Span<const std::byte> input_key_material);
+    void EncryptAndHash(Span<const std::byte> plain, std::vector<std::byte>& out);
+    bool DecryptAndHash(Span<const std::byte> cipher, Span<std::byte> plain);
+    void GenerateEphemeral();
+
+    bool m_initiator;
+    uint256 m_chaining_key;
+    uint256 m_hash;
+    Sv2CipherState m_cipher;
+
+    CKey m_ephemeral_key;
+    EllSwiftPubKey m_ephemeral;
+    EllSwiftPubKey m_remote_ephemeral;
+
+    CKey m_static_key;              //!< responder only
+    EllSwiftPubKey m_static;        //!< responder only
+    Sv2Certificate m_certificate;   //!< responder only
+    XOnlyPubKey m_authority;        //!< initiator only
+};
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_SV2_NOISE_H
@@ -0,0 +1,136 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/sv2_transport.h>
+
+#include <algorithm>
+#include <array>
+
+namespace stratum {
+
+size_t Sv2SealedPayloadSize(size_t length)
+{
+    const size_t chunks = (length + SV2_MAX_CHUNK - 1) / SV2_MAX_CHUNK;
+    return length + chunks * SV2_MAC_SIZE;
+}
+
+Sv2Transport::Sv2Transport(const CKey& static_key, const Sv2Certificate& certificate)
+    : m_initiator(false), m_handshake(static_key, certificate)
+{
+}
+
+Sv2Transport::Sv2Transport(const XOnlyPubKey& authority)
+    : m_initiator(true), m_handshake(authority)
+{
+}
+
+std::vector<std::byte> Sv2Transport::Connect()
+{
+    return m_handshake.WriteStep0();
+}
+
+bool Sv2Transport::Receive(Span<const std::byte> data, std::vector<std::byte>& reply, uint32_t now)
+{
+    if (m_state == State::FAILED) return false;
+    m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+
+    const bool ok = (m_state == State::ESTABLISHED || ProcessHandshake(reply, now)) &&
+                    (m_state != State::ESTABLISHED || ProcessFrames());
+    if (!ok) {
+        m_state = State::FAILED;
+        return false;
+    }
+
+    // Compact once everything buffered has been consumed, or the consumed part dominates
+    if (m_buffer_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_buffer_offset = 0;
+    } else if (m_buffer_offset > m_buffer.size() / 2) {
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_buffer_offset);
+        m_buffer_offset = 0;
+    }
+    return true;
+}
+
+bool Sv2Transport::ProcessHandshake(std::vector<std::byte>& reply, uint32_t now)
+{
+    const size_t expected = m_initiator ? Sv2Handshake::STEP1_SIZE : SV2_HANDSHAKE_STEP0_SIZE;
+    const size_t available = m_buffer.size() - m_buffer_offset;
+    if (available < expected) return true;
+
+    Span<const std::byte> message{m_buffer.data() + m_buffer_offset, expected};
+    if (m_initiator) {
+        if (!m_handshake.ReadStep1(message, now)) return false;
+    } else {
+        std::vector<std::byte> step1;
+        if (!m_handshake.ReadStep0(message, step1)) return false;
+        reply.insert(reply.end(), step1.begin(), step1.end());
+    }
+    m_buffer_offset += expected;
+    m_handshake.Split(m_send, m_receive);
+    m_state = State::ESTABLISHED;
+    return true;
+}
+
+bool Sv2Transport::ProcessFrames()
+{
+    while (true) {
+        const size_t available = m_buffer.size() - m_buffer_offset;
+        const std::byte* in = m_buffer.data() + m_buffer_offset;
+
+        if (!m_header) {
+            if (available < SV2_FRAME_HEADER_SIZE + SV2_MAC_SIZE) return true;
+            std::array<std::byte, SV2_FRAME_HEADER_SIZE> header;
+            if (!m_receive.Decrypt({}, {in, SV2_FRAME_HEADER_SIZE + SV2_MAC_SIZE}, header)) return false;
+            m_buffer_offset += SV2_FRAME_HEADER_SIZE + SV2_MAC_SIZE;
+            m_header = Sv2FrameHeader::Deserialize(header.data());
+            if (m_header->msg_length > MAX_SV2_PAYLOAD) return false;
+            continue;
+        }
+
+        const size_t sealed = Sv2SealedPayloadSize(m_header->msg_length);
+        if (available < sealed) return true;
+
+        Message& message = m_messages.emplace_back();
+        message.header = *m_header;
+        message.payload.resize(m_header->msg_length);
+        size_t done = 0;
+        while (done < message.payload.size()) {
+            const size_t chunk = std::min(SV2_MAX_CHUNK, message.payload.size() - done);
+            Span<const std::byte> cipher{in, chunk + SV2_MAC_SIZE};
+            if (!m_receive.Decrypt({}, cipher, Span{message.payload}.subspan(done, chunk))) return false;
+            in += chunk + SV2_MAC_SIZE;
+            done += chunk;
+        }
+        m_buffer_offset += sealed;
+        m_header.reset();
+    }
+}
+
+bool Sv2Transport::NextMessage(Message& message)
+{
+    if (m_messages.empty()) return false;
+    message = std::move(m_messages.front());
+    m_messages.pop_front();
+    return true;
+}
+
+std::vector<std::byte> Sv2Transport::Seal(Span<const std::byte> frame)
+{
+    const Span<const std::byte> payload = frame.subspan(SV2_FRAME_HEADER_SIZE);
+    std::vector<std::byte> out(SV2_FRAME_HEADER_SIZE + SV2_MAC_SIZE + Sv2SealedPayloadSize(payload.size()));
+
+    std::byte* dst = out.data();
+    m_send.Encrypt({}, frame.first(SV2_FRAME_HEADER_SIZE), {dst, SV2_FRAME_HEADER_SIZE + SV2_MAC_SIZE});
+    dst += SV2_FRAME_HEADER_SIZE + SV2_MAC_SIZE;
+    for (size_t done = 0; done < payload.size();) {
+        const size_t chunk = std::min(SV2_MAX_CHUNK, payload.size() - done);
+        m_send.Encrypt({}, payload.subspan(done, chunk), {dst, chunk + SV2_MAC_SIZE});
+        dst += chunk + SV2_MAC_SIZE;
+        done += chunk;
+    }
+    return out;
+}
+
+} // namespace stratum
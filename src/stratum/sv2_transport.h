@@ -0,0 +1,84 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_SV2_TRANSPORT_H
+#define WATTX_STRATUM_SV2_TRANSPORT_H
+
+#include <stratum/sv2_messages.h>
+#include <stratum/sv2_noise.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace stratum {
+
+//! Largest plaintext sealed in one chunk of a frame payload
+static constexpr size_t SV2_MAX_CHUNK = 65535 - SV2_MAC_SIZE;
+
+/**
+ * Byte stream of one Stratum V2 connection: the Noise handshake, then
+ * encrypted frames.
+ *
+ * Each frame's header is sealed on its own, so the reader learns the payload
+ * length before the payload arrives; the payload follows in sealed chunks of
+ * at most SV2_MAX_CHUNK bytes. Not thread-safe: frames must be sealed in the
+ * order they are written to the socket.
+ */
+class Sv2Transport {
+public:
+    struct Message {
+        Sv2FrameHeader header;
+        std::vector<std::byte> payload;
+    };
+
+    //! Responder (server) side
+    Sv2Transport(const CKey& static_key, const Sv2Certificate& certificate);
+    //! Initiator (miner) side, accepting servers certified by @p authority
+    explicit Sv2Transport(const XOnlyPubKey& authority);
+
+    //! Initiator: the bytes that open the handshake
+    std::vector<std::byte> Connect();
+
+    /**
+     * Take bytes received from the peer. A handshake answer to send back is
+     * appended to @p reply; completed messages queue for NextMessage().
+     * @param[in] now  time the responder's certificate is checked against
+     * @return false on a failed handshake, a bad MAC or an oversized frame
+     */
+    bool Receive(Span<const std::byte> data, std::vector<std::byte>& reply, uint32_t now);
+
+    bool NextMessage(Message& message);
+
+    //! Seal a frame built by Sv2EncodeFrame(); only once Established()
+    std::vector<std::byte> Seal(Span<const std::byte> frame);
+
+    bool Established() const { return m_state == State::ESTABLISHED; }
+
+private:
+    enum class State { HANDSHAKE, ESTABLISHED, FAILED };
+
+    bool ProcessHandshake(std::vector<std::byte>& reply, uint32_t now);
+    bool ProcessFrames();
+
+    bool m_initiator;
+    State m_state{State::HANDSHAKE};
+    Sv2Handshake m_handshake;
+    Sv2CipherState m_send;
+    Sv2CipherState m_receive;
+
+    std::vector<std::byte> m_buffer;  //!< received bytes not yet processed
+    size_t m_buffer_offset{0};
+    std::optional<Sv2FrameHeader> m_header;  //!< opened header awaiting its payload
+    std::deque<Message> m_messages;
+};
+
+//! Sealed size of a frame payload of @p length plaintext bytes
+size_t Sv2SealedPayloadSize(size_t length);
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_SV2_TRANSPORT_H
@@ -0,0 +1,100 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <stratum/vardiff.h>
+
+#include <arith_uint256.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace stratum {
+
+void VardiffState::Init(const VardiffConfig& config, uint64_t difficulty, int64_t now)
+{
+    m_difficulty = std::clamp(difficulty, std::max<uint64_t>(config.min_difficulty, 1),
+                              std::max<uint64_t>(config.max_difficulty, 1));
+    m_previous_difficulty = m_difficulty;
+    m_changed_at = now;
+    m_window_start = now;
+    m_window_shares = 0;
+}
+
+uint64_t VardiffState::AcceptDifficulty(int64_t now) const
+{
+    if (now - m_changed_at < VARDIFF_GRACE_SECONDS) {
+        return std::min(m_difficulty, m_previous_difficulty);
+    }
+    return m_difficulty;
+}
+
+bool VardiffState::RecordShare(const VardiffConfig& config, int64_t now)
+{
+    ++m_window_shares;
+    return config.enabled && Retarget(config, now);
+}
+
+bool VardiffState::CheckIdle(const VardiffConfig& config, int64_t now)
+{
+    return config.enabled && Retarget(config, now);
+}
+
+bool VardiffState::Retarget(const VardiffConfig& config, int64_t now)
+{
+    int64_t elapsed = now - m_window_start;
+    if (elapsed < config.retarget_seconds || config.target_share_seconds <= 0) return false;
+
+    // With no shares at all, the interval is at least the whole window
+    double observed = static_cast<double>(elapsed) / static_cast<double>(std::max<uint64_t>(m_window_shares, 1));
+    double ratio = config.target_share_seconds / observed;
+
+    m_window_start = now;
+    m_window_shares = 0;
+
+    double tolerance = config.variance_percent / 100.0;
+    if (ratio >= 1.0 / (1.0 + tolerance) && ratio <= 1.0 + tolerance) return false;
+
+    ratio = std::clamp(ratio, 1.0 / VARDIFF_MAX_STEP, static_cast<double>(VARDIFF_MAX_STEP));
+    double scaled = std::round(static_cast<double>(m_difficulty) * ratio);
+    uint64_t next = scaled >= static_cast<double>(config.max_difficulty) ? config.max_difficulty
+                                                                         : static_cast<uint64_t>(scaled);
+    next = std::clamp(next, std::max<uint64_t>(config.min_difficulty, 1),
+                      std::max<uint64_t>(config.max_difficulty, 1));
+    if (next == m_difficulty) return false;
+
+    m_previous_difficulty = m_difficulty;
+    m_difficulty = next;
+    m_changed_at = now;
+    return true;
+}
+
+std::string DifficultyToCompactTarget(uint64_t difficulty)
+{
+    uint32_t target = static_cast<uint32_t>(0xFFFFFFFFULL / std::max<uint64_t>(difficulty, 1));
+    std::array<unsigned char, 4> bytes{
+        static_cast<unsigned char>(target),
+        static_cast<unsigned char>(target >> 8),
+        static_cast<unsigned char>(target >> 16),
+        static_cast<unsigned char>(target >> 24),
+    };
+    return HexStr(bytes);
+}
+
+bool HashMeetsDifficulty(const uint256& hash, uint64_t difficulty)
+{
+    if (difficulty <= 1) return true;
+    return UintToArith256(hash) <= UintToArith256(DifficultyToTarget(difficulty));
+}
+
+uint256 DifficultyToTarget(uint64_t difficulty)
+{
+    arith_uint256 limit = ~arith_uint256{};
+    limit /= arith_uint256{std::max<uint64_t>(difficulty, 1)};
+    return ArithToUint256(limit);
+}
+
+} // namespace stratum
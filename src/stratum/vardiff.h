@@ -0,0 +1,86 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_STRATUM_VARDIFF_H
+#define WATTX_STRATUM_VARDIFF_H
+
+#include <cstdint>
+#include <string>
+
+class uint256;
+
+namespace stratum {
+
+//! Seconds a lowered share from before a retarget is still accepted
+static constexpr int64_t VARDIFF_GRACE_SECONDS = 10;
+//! Largest factor difficulty moves by in one retarget
+static constexpr uint64_t VARDIFF_MAX_STEP = 4;
+
+/**
+ * Variable difficulty settings shared by all stratum servers.
+ */
+struct VardiffConfig {
+    bool enabled = true;
+    uint64_t min_difficulty = 1000;
+    uint64_t max_difficulty = 1000000000000ULL;
+    double target_share_seconds = 15.0;   // Desired average time between shares per connection
+    int64_t retarget_seconds = 90;        // Minimum window before difficulty is re-evaluated
+    double variance_percent = 30.0;       // Tolerated deviation from the target interval
+};
+
+/**
+ * Per-connection difficulty tracker.
+ *
+ * Counts accepted shares over a window of at least retarget_seconds and,
+ * when the observed interval strays from the target by more than the
+ * tolerated variance, scales difficulty by target/observed, bounded by
+ * VARDIFF_MAX_STEP and the configured range. Idle connections are eased down
+ * from the job broadcast path via CheckIdle(), since they never submit.
+ */
+class VardiffState {
+public:
+    void Init(const VardiffConfig& config, uint64_t difficulty, int64_t now);
+
+    uint64_t Difficulty() const { return m_difficulty; }
+
+    /**
+     * Lowest difficulty a share may meet at @p now. Right after a retarget
+     * the miner is still working on a job with the old target.
+     */
+    uint64_t AcceptDifficulty(int64_t now) const;
+
+    /** Account an accepted share. @return true if the difficulty changed. */
+    bool RecordShare(const VardiffConfig& config, int64_t now);
+
+    /** Re-evaluate without a share. @return true if the difficulty changed. */
+    bool CheckIdle(const VardiffConfig& config, int64_t now);
+
+private:
+    bool Retarget(const VardiffConfig& config, int64_t now);
+
+    uint64_t m_difficulty{1};
+    uint64_t m_previous_difficulty{1};
+    int64_t m_changed_at{0};
+    int64_t m_window_start{0};
+    uint64_t m_window_shares{0};
+};
+
+/**
+ * XMRig-style 32-bit compact target for @p difficulty, as little-endian hex
+ * (e.g. difficulty 10000 -> "b88d0600").
+ */
+std::string DifficultyToCompactTarget(uint64_t difficulty);
+
+/**
+ * CryptoNote share check: the hash, read as a little-endian 256-bit number,
+ * multiplied by @p difficulty must not overflow 256 bits.
+ */
+bool HashMeetsDifficulty(const uint256& hash, uint64_t difficulty);
+
+/** Largest hash HashMeetsDifficulty() accepts at @p difficulty */
+uint256 DifficultyToTarget(uint64_t difficulty);
+
+} // namespace stratum
+
+#endif // WATTX_STRATUM_VARDIFF_H
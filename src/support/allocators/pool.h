@@ -5,6 +5,8 @@
 #ifndef BITCOIN_SUPPORT_ALLOCATORS_POOL_H
 #define BITCOIN_SUPPORT_ALLOCATORS_POOL_H
 
+#include <support/largepages.h>
+
 #include <array>
 #include <cassert>
 #include <cstddef>
@@ -30,6 +32,9 @@
  * * Block sizes or alignments that can not be served by the pools are allocated
  *   and deallocated by operator new().
  *
+ * * Chunks can be taken from LargePageAllocator, for resources holding a large
+ *   cache that is looked up at random.
+ *
  * PoolResource is not thread-safe. It is intended to be used by PoolAllocator.
  *
  * @tparam MAX_BLOCK_SIZE_BYTES Maximum size to allocate with the pool. If larger
@@ -95,6 +100,11 @@ class PoolResource final
      */
     const size_t m_chunk_size_bytes;
 
+    /**
+     * Whether chunks come from LargePageAllocator instead of operator new
+     */
+    const bool m_large_pages;
+
     /**
      * Contains all allocated pools of memory, used to free the data in the destructor.
      */
@@ -158,7 +168,14 @@ class PoolResource final
             PlacementAddToList(m_available_memory_it, m_free_lists[remaining_available_bytes / ELEM_ALIGN_BYTES]);
         }
 
-        void* storage = ::operator new (m_chunk_size_bytes, std::align_val_t{ELEM_ALIGN_BYTES});
+        void* storage;
+        if (m_large_pages) {
+            size_t len{m_chunk_size_bytes};
+            storage = LargePageAllocator::Instance().Allocate(len);
+            if (!storage) throw std::bad_alloc{};
+        } else {
+            storage = ::operator new (m_chunk_size_bytes, std::align_val_t{ELEM_ALIGN_BYTES});
+        }
         m_available_memory_it = new (storage) std::byte[m_chunk_size_bytes];
         m_available_memory_end = m_available_memory_it + m_chunk_size_bytes;
         m_allocated_chunks.emplace_back(m_available_memory_it);
@@ -170,13 +187,19 @@ class PoolResource final
     friend class PoolResourceTester;
 
 public:
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE_BYTES{262144};
+
     /**
      * Construct a new PoolResource object which allocates the first chunk.
-     * chunk_size_bytes will be rounded up to next multiple of ELEM_ALIGN_BYTES.
+     * chunk_size_bytes will be rounded up to next multiple of ELEM_ALIGN_BYTES,
+     * or of LargePageAllocator::LARGE_PAGE_SIZE with large_pages.
      */
-    explicit PoolResource(std::size_t chunk_size_bytes)
-        : m_chunk_size_bytes(NumElemAlignBytes(chunk_size_bytes) * ELEM_ALIGN_BYTES)
+    explicit PoolResource(std::size_t chunk_size_bytes, bool large_pages = false)
+        : m_chunk_size_bytes(large_pages ? (chunk_size_bytes + LargePageAllocator::LARGE_PAGE_SIZE - 1) / LargePageAllocator::LARGE_PAGE_SIZE * LargePageAllocator::LARGE_PAGE_SIZE
+                                         : NumElemAlignBytes(chunk_size_bytes) * ELEM_ALIGN_BYTES),
+          m_large_pages(large_pages)
     {
+        static_assert(LargePageAllocator::LARGE_PAGE_SIZE % ELEM_ALIGN_BYTES == 0);
         assert(m_chunk_size_bytes >= MAX_BLOCK_SIZE_BYTES);
         AllocateChunk();
     }
@@ -184,7 +207,7 @@ public:
     /**
      * Construct a new Pool Resource object, defaults to 2^18=262144 chunk size.
      */
-    PoolResource() : PoolResource(262144) {}
+    PoolResource() : PoolResource(DEFAULT_CHUNK_SIZE_BYTES) {}
 
     /**
      * Disable copy & move semantics, these are not supported for the resource.
@@ -201,7 +224,11 @@ public:
     {
         for (std::byte* chunk : m_allocated_chunks) {
             std::destroy(chunk, chunk + m_chunk_size_bytes);
-            ::operator delete ((void*)chunk, std::align_val_t{ELEM_ALIGN_BYTES});
+            if (m_large_pages) {
+                LargePageAllocator::Instance().Free(chunk);
+            } else {
+                ::operator delete ((void*)chunk, std::align_val_t{ELEM_ALIGN_BYTES});
+            }
         }
     }
 
@@ -0,0 +1,126 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <support/largepages.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <new>
+
+namespace {
+
+/** Align up to power of 2 */
+size_t align_up(size_t x, size_t align)
+{
+    return (x + align - 1) & ~(align - 1);
+}
+
+#ifdef __linux__
+//! MPOL_PREFERRED of <numaif.h>, which only comes with libnuma
+constexpr int MPOL_PREFERRED_POLICY{1};
+
+/** Prefer the NUMA node of the calling thread for a mapping not yet touched */
+bool BindToLocalNode(void* addr, size_t len)
+{
+#if defined(SYS_getcpu) && defined(SYS_mbind)
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return false;
+    constexpr unsigned MASK_BITS{sizeof(unsigned long) * 8};
+    if (node >= MASK_BITS) return false;
+    const unsigned long mask{1UL << node};
+    // The kernel reads one bit less than maxnode
+    return syscall(SYS_mbind, addr, len, MPOL_PREFERRED_POLICY, &mask, MASK_BITS + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+} // namespace
+
+LargePageAllocator& LargePageAllocator::Instance()
+{
+    static LargePageAllocator instance;
+    return instance;
+}
+
+void* LargePageAllocator::Allocate(size_t& len)
+{
+    len = align_up(len > 0 ? len : 1, LARGE_PAGE_SIZE);
+    Mapping mapping{len, Backing::REGULAR, false};
+    void* addr{nullptr};
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+    int huge_flags{MAP_HUGETLB};
+#ifdef MAP_HUGE_2MB
+    // Ask for pages of LARGE_PAGE_SIZE even where the default hugepage size differs
+    huge_flags |= MAP_HUGE_2MB;
+#endif
+    addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | huge_flags, -1, 0);
+    if (addr != MAP_FAILED) {
+        mapping.backing = Backing::EXPLICIT;
+    } else {
+        addr = nullptr;
+    }
+#endif
+    if (!addr) {
+        // Transparent hugepages only back aligned ranges, so map a page more
+        // than needed and trim both ends
+        const size_t padded{len + LARGE_PAGE_SIZE};
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+        const uintptr_t begin{reinterpret_cast<uintptr_t>(raw)};
+        const uintptr_t aligned{align_up(begin, LARGE_PAGE_SIZE)};
+        if (aligned > begin) munmap(raw, aligned - begin);
+        const size_t tail{begin + padded - (aligned + len)};
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + len), tail);
+        addr = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        if (madvise(addr, len, MADV_HUGEPAGE) == 0) mapping.backing = Backing::TRANSPARENT;
+#endif
+    }
+    mapping.numa_bound = BindToLocalNode(addr, len);
+#else
+    addr = ::operator new(len, std::align_val_t{LARGE_PAGE_SIZE}, std::nothrow);
+    if (!addr) return nullptr;
+#endif
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mappings.emplace(addr, mapping);
+    return addr;
+}
+
+void LargePageAllocator::Free(void* addr) noexcept
+{
+    if (!addr) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mappings.find(addr);
+    if (it == m_mappings.end()) return;
+#ifdef __linux__
+    munmap(addr, it->second.len);
+#else
+    ::operator delete(addr, std::align_val_t{LARGE_PAGE_SIZE});
+#endif
+    m_mappings.erase(it);
+}
+
+LargePageAllocator::Stats LargePageAllocator::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    for (const auto& [addr, mapping] : m_mappings) {
+        switch (mapping.backing) {
+        case Backing::EXPLICIT: stats.explicit_bytes += mapping.len; break;
+        case Backing::TRANSPARENT: stats.transparent_bytes += mapping.len; break;
+        case Backing::REGULAR: stats.regular_bytes += mapping.len; break;
+        }
+        if (mapping.numa_bound) stats.numa_bound_bytes += mapping.len;
+    }
+    stats.allocations = m_mappings.size();
+    return stats;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SUPPORT_LARGEPAGES_H
+#define BITCOIN_SUPPORT_LARGEPAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+/**
+ * Allocator for large, long-lived caches backed by large pages, to cut the
+ * TLB misses of random lookups across them.
+ *
+ * Every allocation is rounded up to LARGE_PAGE_SIZE and mapped separately.
+ * Explicit hugepages (reserved through vm.nr_hugepages) are tried first, then
+ * an aligned mapping advised for transparent hugepages, so an allocation only
+ * fails when the system is out of memory. Mappings are bound to the NUMA node
+ * of the allocating thread before they are first touched. Systems without
+ * these facilities get plain memory.
+ *
+ * Meant for a few large chunks, not for general use: each allocation is
+ * tracked for stats().
+ */
+class LargePageAllocator
+{
+public:
+    static constexpr size_t LARGE_PAGE_SIZE{2 << 20};
+
+    struct Stats {
+        //! Bytes backed by explicit hugepages
+        size_t explicit_bytes{0};
+        //! Bytes advised for transparent hugepages
+        size_t transparent_bytes{0};
+        //! Bytes that only got regular pages
+        size_t regular_bytes{0};
+        //! Bytes bound to the NUMA node they were allocated from
+        size_t numa_bound_bytes{0};
+        size_t allocations{0};
+    };
+
+    /** Return the process-wide instance */
+    static LargePageAllocator& Instance();
+
+    /**
+     * Allocate at least @p len bytes, aligned to LARGE_PAGE_SIZE where large
+     * pages are used. @p len is rounded up to the allocated size.
+     * @return nullptr when out of memory
+     */
+    void* Allocate(size_t& len);
+
+    /** Free memory returned by Allocate() */
+    void Free(void* addr) noexcept;
+
+    Stats stats() const;
+
+private:
+    enum class Backing : uint8_t { EXPLICIT, TRANSPARENT, REGULAR };
+
+    struct Mapping {
+        size_t len;
+        Backing backing;
+        bool numa_bound;
+    };
+
+    LargePageAllocator() = default;
+
+    mutable std::mutex m_mutex;
+    std::map<void*, Mapping> m_mappings;
+};
+
+#endif // BITCOIN_SUPPORT_LARGEPAGES_H
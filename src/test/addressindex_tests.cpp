@@ -0,0 +1,139 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <index/addressindex.h>
+#include <interfaces/chain.h>
+#include <key.h>
+#include <node/blockstorage.h>
+#include <script/solver.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(addressindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex addressindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(addressindex.Init());
+    BOOST_REQUIRE(addressindex.StartBackgroundSync());
+    IndexWaitSynced(addressindex, *Assert(m_node.shutdown_signal));
+
+    // The coinbase outputs pay to coinbaseKey, indexed by its key hash
+    const PKHash key_hash{coinbaseKey.GetPubKey()};
+    std::vector<unsigned char> address_bytes(32);
+    std::copy(key_hash.begin(), key_hash.end(), address_bytes.begin());
+    const uint256 address{address_bytes};
+    const int type{GetAddressIndexType(key_hash)};
+
+    std::vector<std::pair<CAddressIndexKey, CAmount>> entries;
+    BOOST_REQUIRE(addressindex.ReadAddressIndex(address, type, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), m_coinbase_txns.size());
+    CAmount received{0}, received_at_50{0};
+    for (size_t i = 0; i < entries.size(); ++i) {
+        BOOST_CHECK_EQUAL(entries[i].first.blockHeight, int(i) + 1);
+        BOOST_CHECK_EQUAL(entries[i].first.txhash, m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK(!entries[i].first.spending);
+        received += entries[i].second;
+        if (entries[i].first.blockHeight <= 50) received_at_50 += entries[i].second;
+    }
+
+    entries.clear();
+    BOOST_REQUIRE(addressindex.ReadAddressIndex(address, type, entries, 10, 19));
+    BOOST_CHECK_EQUAL(entries.size(), 10U);
+
+    // Pages walk the same entries in both directions
+    auto read_pages = [&](bool reverse) {
+        std::vector<int> heights;
+        std::optional<CAddressIndexKey> cursor;
+        bool more{true};
+        while (more) {
+            std::vector<std::pair<CAddressIndexKey, CAmount>> page;
+            BOOST_REQUIRE(addressindex.ReadAddressIndexPage(address, type, 0, 0, cursor ? &*cursor : nullptr, 7, reverse, page, more));
+            BOOST_REQUIRE(page.size() <= 7);
+            for (const auto& [key, value] : page) heights.push_back(key.blockHeight);
+            if (!page.empty()) cursor = page.back().first;
+        }
+        return heights;
+    };
+    const std::vector<int> forward{read_pages(false)};
+    std::vector<int> backward{read_pages(true)};
+    BOOST_CHECK_EQUAL(forward.size(), m_coinbase_txns.size());
+    std::reverse(backward.begin(), backward.end());
+    BOOST_CHECK(forward == backward);
+
+    // Nothing is spent yet
+    CAddressBalanceValue balance;
+    BOOST_REQUIRE(addressindex.ReadAddressBalance(address, type, 100, balance));
+    BOOST_CHECK_EQUAL(balance.balance, received);
+    BOOST_CHECK_EQUAL(balance.received, received);
+    BOOST_REQUIRE(addressindex.ReadAddressBalance(address, type, 50, balance));
+    BOOST_CHECK_EQUAL(balance.received, received_at_50);
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspent;
+    BOOST_REQUIRE(addressindex.ReadAddressUnspentIndex(address, type, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), m_coinbase_txns.size());
+
+    CSpentIndexValue spent;
+    BOOST_CHECK(!addressindex.ReadSpentIndex(CSpentIndexKey(m_coinbase_txns[0]->GetHash(), 0), spent));
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification.
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    addressindex.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(addressindex_timestamp_reorg, TestChain100Setup)
+{
+    AddressIndex addressindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(addressindex.Init());
+    BOOST_REQUIRE(addressindex.StartBackgroundSync());
+    IndexWaitSynced(addressindex, *Assert(m_node.shutdown_signal));
+
+    auto read_range = [&](bool active_only) {
+        std::vector<std::pair<uint256, unsigned int>> hashes;
+        BOOST_REQUIRE(addressindex.ReadTimestampIndex(std::numeric_limits<unsigned int>::max(), 0, active_only, hashes));
+        return hashes;
+    };
+    auto contains = [](const std::vector<std::pair<uint256, unsigned int>>& hashes, const uint256& hash) {
+        return std::any_of(hashes.begin(), hashes.end(), [&](const auto& entry) { return entry.first == hash; });
+    };
+    BOOST_CHECK_EQUAL(read_range(true).size(), 100U);
+
+    // Replace the tip with a sibling
+    CBlockIndex* old_tip{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+    BlockValidationState state;
+    m_node.chainman->ActiveChainstate().InvalidateBlock(state, old_tip);
+    const CBlock new_tip = CreateAndProcessBlock({}, GetScriptForRawPubKey(GenerateRandomKey().GetPubKey()));
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+
+    // The stale block stays in the index but drops out of active-only scans
+    const std::vector<std::pair<uint256, unsigned int>> active{read_range(true)};
+    BOOST_CHECK_EQUAL(active.size(), 100U);
+    BOOST_CHECK(contains(active, new_tip.GetHash()));
+    BOOST_CHECK(!contains(active, old_tip->GetBlockHash()));
+    const std::vector<std::pair<uint256, unsigned int>> all{read_range(false)};
+    BOOST_CHECK_EQUAL(all.size(), 101U);
+    BOOST_CHECK(contains(all, old_tip->GetBlockHash()));
+
+    // Logical timestamps strictly increase along the active chain
+    for (size_t i = 1; i < active.size(); ++i) {
+        BOOST_CHECK(active[i - 1].second < active[i].second);
+    }
+
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    addressindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,79 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <anchor/anchor_aggregator.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace evm_anchor;
+
+BOOST_FIXTURE_TEST_SUITE(anchor_aggregator_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(aggregate_window)
+{
+    AnchorAggregator aggregator;
+    AnchorAggregator::Options options;
+    options.max_items = 5;
+    options.max_age = 100;
+    options.max_aggregates = 2;
+    aggregator.SetOptions(options);
+
+    // A window closes when full
+    std::vector<uint256> commitments;
+    for (int i = 0; i < 5; ++i) {
+        commitments.push_back(m_rng.rand256());
+        BOOST_CHECK(aggregator.Add(commitments.back(), 1000));
+        BOOST_CHECK(!aggregator.Add(commitments.back(), 1000));
+    }
+    const auto aggregate = aggregator.Poll(1000);
+    BOOST_REQUIRE(aggregate);
+    BOOST_CHECK_EQUAL(aggregate->item_count, 5U);
+    BOOST_CHECK_EQUAL(aggregator.GetPendingCount(), 0U);
+    for (const auto& commitment : commitments) {
+        AnchorInclusionProof proof;
+        BOOST_REQUIRE(aggregator.GetProof(commitment, proof));
+        BOOST_CHECK_EQUAL(proof.root, aggregate->root);
+        BOOST_CHECK(proof.Verify());
+        proof.commitment = m_rng.rand256();
+        BOOST_CHECK(!proof.Verify());
+    }
+    BOOST_CHECK(!aggregator.Add(commitments[0], 1000));
+
+    // Or when its first commitment is old enough
+    const uint256 late = m_rng.rand256();
+    BOOST_CHECK(aggregator.Add(late, 2000));
+    BOOST_CHECK(!aggregator.Poll(2099));
+    BOOST_CHECK(aggregator.IsPending(late));
+    const auto single = aggregator.Poll(2100);
+    BOOST_REQUIRE(single);
+    BOOST_CHECK_EQUAL(single->root, late);
+
+    // Only the last max_aggregates windows keep their proofs
+    BOOST_CHECK(aggregator.Add(m_rng.rand256(), 3000));
+    BOOST_REQUIRE(aggregator.Flush(3000));
+    AnchorInclusionProof proof;
+    BOOST_CHECK(!aggregator.GetProof(commitments[0], proof));
+    BOOST_CHECK(aggregator.GetProof(late, proof));
+}
+
+BOOST_AUTO_TEST_CASE(aggregate_tag_roundtrip)
+{
+    AggregateAnchor aggregate;
+    aggregate.item_count = 1000;
+    aggregate.root = m_rng.rand256();
+    aggregate.timestamp = 1700000000;
+
+    std::vector<uint8_t> extra{0x01, 0x02};
+    const std::vector<uint8_t> tag = AnchorAggregator::BuildAggregateTag(aggregate);
+    extra.insert(extra.end(), tag.begin(), tag.end());
+
+    const std::vector<AggregateAnchor> parsed = AnchorAggregator::ParseAggregateTags(extra);
+    BOOST_REQUIRE_EQUAL(parsed.size(), 1U);
+    BOOST_CHECK_EQUAL(parsed[0].item_count, aggregate.item_count);
+    BOOST_CHECK_EQUAL(parsed[0].root, aggregate.root);
+    BOOST_CHECK_EQUAL(parsed[0].timestamp, aggregate.timestamp);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <anchor/evm_anchor.h>
+#include <anchor/private_swap.h>
+#include <index/anchorindex.h>
+#include <interfaces/chain.h>
+#include <script/script.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(anchorindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(anchorindex_initial_sync, TestChain100Setup)
+{
+    AnchorIndex anchorindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(anchorindex.Init());
+
+    // Mine an EVM anchor and a swap anchor in coinbase OP_RETURN outputs
+    const evm_anchor::EVMAnchorData evm = evm_anchor::GetEVMAnchorManager().CreateAnchor(
+        42, {m_rng.rand256()}, m_rng.rand256(), m_rng.rand256(), 1700000000);
+    const std::vector<uint8_t> evm_tag = evm_anchor::GetEVMAnchorManager().BuildAnchorTag(evm);
+    const CBlock evm_block = CreateAndProcessBlock({}, CScript() << OP_RETURN << evm_tag);
+
+    private_swap::PrivateSwapData swap{};
+    swap.swap_id = m_rng.rand256();
+    swap.source_chain = private_swap::ChainType::WATTX_EVM;
+    swap.dest_chain = private_swap::ChainType::MONERO;
+    std::array<uint8_t, 32> view_key{};
+    view_key[0] = 1;
+    const std::vector<uint8_t> swap_tag = private_swap::GetPrivateSwapManager().BuildSwapAnchorTag(swap, view_key);
+    const CBlock swap_block = CreateAndProcessBlock({}, CScript() << OP_RETURN << swap_tag);
+
+    BOOST_REQUIRE(anchorindex.StartBackgroundSync());
+    IndexWaitSynced(anchorindex, *Assert(m_node.shutdown_signal));
+
+    AnchorLocation location;
+    BOOST_REQUIRE(anchorindex.FindEVMAnchor(evm.GetHash(), location));
+    BOOST_CHECK_EQUAL(location.block_hash, evm_block.GetHash());
+    BOOST_CHECK_EQUAL(location.height, 101);
+    BOOST_CHECK_EQUAL(location.txid, evm_block.vtx[0]->GetHash());
+    BOOST_REQUIRE(location.vout >= 0);
+    BOOST_CHECK(evm_block.vtx[0]->vout[location.vout].scriptPubKey[0] == OP_RETURN);
+    BOOST_REQUIRE(anchorindex.FindEVMAnchorByHeight(42, location));
+    BOOST_CHECK_EQUAL(location.block_hash, evm_block.GetHash());
+    BOOST_CHECK(!anchorindex.FindEVMAnchorByHeight(43, location));
+
+    // The swap is found from its id and view key alone
+    const uint256 swap_key_tag{private_swap::EncryptedSwapAnchor::DeriveSwapKeyTag(swap.swap_id, view_key)};
+    BOOST_REQUIRE(anchorindex.FindSwapAnchor(swap_key_tag, location));
+    BOOST_CHECK_EQUAL(location.block_hash, swap_block.GetHash());
+    private_swap::EncryptedSwapAnchor encrypted;
+    private_swap::PrivateSwapData decrypted;
+    BOOST_REQUIRE(private_swap::EncryptedSwapAnchor::Deserialize(location.payload, encrypted));
+    BOOST_REQUIRE(private_swap::EncryptedSwapAnchor::Decrypt(encrypted, view_key, decrypted));
+    BOOST_CHECK_EQUAL(decrypted.swap_id, swap.swap_id);
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification.
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    anchorindex.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(private_swap_view_tag_lookup, BasicTestingSetup)
+{
+    private_swap::PrivateSwapManager swap_mgr;
+    const auto [swap_id, view_key] = swap_mgr.InitiateSwap(
+        private_swap::ChainType::WATTX_EVM, "source", 1000, "WATTX",
+        private_swap::ChainType::MONERO, "dest", 2000, "XMR", 3600);
+
+    std::array<uint8_t, 32> other_key = view_key;
+    other_key[0] ^= 1;
+    BOOST_CHECK(private_swap::EncryptedSwapAnchor::DeriveViewTag(view_key) != private_swap::EncryptedSwapAnchor::DeriveViewTag(other_key));
+
+    const std::vector<private_swap::PrivateSwapData> swaps = swap_mgr.GetSwapsForViewKey(view_key);
+    BOOST_REQUIRE_EQUAL(swaps.size(), 1U);
+    BOOST_CHECK_EQUAL(swaps[0].swap_id, swap_id);
+    BOOST_CHECK(swap_mgr.GetSwapsForViewKey(other_key).empty());
+
+    private_swap::PrivateSwapData swap;
+    BOOST_CHECK(!swap_mgr.GetSwap(swap_id, other_key, swap));
+    BOOST_CHECK(!swap_mgr.JoinSwap(swap_id, other_key));
+    BOOST_REQUIRE(swap_mgr.JoinSwap(swap_id, view_key));
+    BOOST_REQUIRE(swap_mgr.GetSwap(swap_id, view_key, swap));
+    BOOST_CHECK(swap.state == private_swap::PrivateSwapData::SwapState::PARTICIPANT_JOINED);
+    // The re-encrypted swap stays under its view tag
+    BOOST_CHECK_EQUAL(swap_mgr.GetSwapsForViewKey(view_key).size(), 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
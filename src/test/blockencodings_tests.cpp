@@ -307,6 +307,39 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ProofOfStakePrefillTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    TestMemPoolEntryHelper entry;
+    auto rand_ctx(FastRandomContext(uint256{42}));
+    CBlock block(BuildBlockTestCase(rand_ctx));
+    block.prevoutStake = COutPoint{Txid::FromUint256(rand_ctx.rand256()), 0};
+    BOOST_REQUIRE(block.IsProofOfStake());
+
+    LOCK2(cs_main, pool.cs);
+    AddToMempool(pool, entry.FromTx(block.vtx[2]));
+
+    // The coinstake is sent along with the coinbase
+    CBlockHeaderAndShortTxIDs shortIDs{block, rand_ctx.rand64()};
+    BOOST_CHECK_EQUAL(shortIDs.BlockTxCount(), block.vtx.size());
+    const TestHeaderAndShortIDs decoded{shortIDs};
+    BOOST_REQUIRE_EQUAL(decoded.prefilledtxn.size(), 2U);
+    BOOST_CHECK_EQUAL(decoded.prefilledtxn[1].index, 0U); // differentially encoded, so vtx[1]
+    BOOST_CHECK(*decoded.prefilledtxn[1].tx == *block.vtx[1]);
+    BOOST_CHECK_EQUAL(decoded.shorttxids.size(), 1U);
+
+    DataStream stream{};
+    stream << shortIDs;
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+
+    PartiallyDownloadedBlock partialBlock(&pool, m_node.chainman.get());
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, empty_extra_txn) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.IsTxAvailable(0));
+    BOOST_CHECK(partialBlock.IsTxAvailable(1));
+    BOOST_CHECK(partialBlock.IsTxAvailable(2));
+}
+
 BOOST_AUTO_TEST_CASE(ReceiveWithExtraTransactions) {
     CTxMemPool& pool = *Assert(m_node.mempool);
     TestMemPoolEntryHelper entry;
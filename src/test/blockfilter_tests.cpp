@@ -127,6 +127,32 @@ BOOST_AUTO_TEST_CASE(blockfilter_basic_test)
     BOOST_CHECK(default_ctor_block_filter_1.GetEncodedFilter() == default_ctor_block_filter_2.GetEncodedFilter());
 }
 
+BOOST_AUTO_TEST_CASE(blockfilter_evm_log_test)
+{
+    // A contract address and two topics of its logs
+    const std::vector<unsigned char> address(20, 0xaa);
+    const std::vector<unsigned char> topic0(32, 0xdd);
+    const std::vector<unsigned char> topic1(32, 0x01);
+    const uint256 block_hash{uint256::ONE};
+
+    BlockFilter block_filter(BlockFilterType::EVM_LOG, block_hash, {address, topic0, topic1});
+    const GCSFilter& filter = block_filter.GetFilter();
+    BOOST_CHECK(filter.Match(address));
+    BOOST_CHECK(filter.Match(topic1));
+    BOOST_CHECK(!filter.Match(std::vector<unsigned char>(20, 0xbb)));
+    BOOST_CHECK(filter.MatchAny({std::vector<unsigned char>(20, 0xbb), topic0}));
+
+    BlockFilter block_filter2;
+    DataStream stream{};
+    stream << block_filter;
+    stream >> block_filter2;
+    BOOST_CHECK_EQUAL(block_filter2.GetFilterType(), BlockFilterType::EVM_LOG);
+    BOOST_CHECK(block_filter2.GetFilter().Match(address));
+
+    // EVM log filters come from receipts, not from the block and its undo data
+    BOOST_CHECK_THROW(BlockFilter(BlockFilterType::EVM_LOG, CBlock{}, CBlockUndo{}), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(blockfilters_json_test)
 {
     UniValue json;
@@ -184,6 +210,8 @@ BOOST_AUTO_TEST_CASE(blockfilter_type_names)
     BlockFilterType filter_type;
     BOOST_CHECK(BlockFilterTypeByName("basic", filter_type));
     BOOST_CHECK_EQUAL(filter_type, BlockFilterType::BASIC);
+    BOOST_CHECK(BlockFilterTypeByName("evmlog", filter_type));
+    BOOST_CHECK_EQUAL(filter_type, BlockFilterType::EVM_LOG);
 
     BOOST_CHECK(!BlockFilterTypeByName("unknown", filter_type));
 }
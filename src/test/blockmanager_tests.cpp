@@ -17,6 +17,8 @@
 #include <test/util/logging.h>
 #include <test/util/setup_common.h>
 
+#include <algorithm>
+
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
 using node::BlockManager;
 using node::KernelNotifications;
@@ -57,6 +59,50 @@ BOOST_AUTO_TEST_CASE(blockmanager_find_block_pos)
     BOOST_CHECK_EQUAL(actual.nPos, BLOCK_SERIALIZATION_HEADER_SIZE + ::GetSerializeSize(TX_WITH_WITNESS(params->GenesisBlock())) + BLOCK_SERIALIZATION_HEADER_SIZE);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_read_mapped_block_file)
+{
+    const auto params {CreateChainParams(ArgsManager{}, ChainType::MAIN)};
+    KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    const BlockManager::Options blockman_opts{
+        .chainparams = *params,
+        .use_mmap = true,
+        .fast_prune = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+        .block_tree_db_params = DBParams{
+            .path = m_args.GetDataDirNet() / "blocks" / "index",
+            .cache_bytes = 0,
+        },
+    };
+    BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+    const CBlock& genesis{params->GenesisBlock()};
+
+    // Fill the first block file so that it is finalized and gets mapped
+    const FlatFilePos first{blockman.WriteBlock(genesis, 0)};
+    FlatFilePos last{first};
+    for (int height = 1; last.nFile == first.nFile; ++height) {
+        last = blockman.WriteBlock(genesis, height);
+    }
+
+    DataStream expected{};
+    expected << TX_WITH_WITNESS(genesis);
+    for (const FlatFilePos& pos : {first, last}) {
+        // The second read is served from the cache of recent blocks
+        for (int i = 0; i < 2; ++i) {
+            std::vector<uint8_t> raw;
+            BOOST_REQUIRE(blockman.ReadRawBlock(raw, pos));
+            BOOST_CHECK(std::ranges::equal(raw, MakeUCharSpan(expected)));
+        }
+        CBlock block;
+        BOOST_REQUIRE(blockman.ReadBlock(block, pos));
+        BOOST_CHECK_EQUAL(block.GetHash(), genesis.GetHash());
+    }
+
+    // Out of range positions fail rather than read past the mapping
+    std::vector<uint8_t> raw;
+    BOOST_CHECK(!blockman.ReadRawBlock(raw, FlatFilePos{first.nFile, MAX_BLOCKFILE_SIZE}));
+}
+
 BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files, TestChain100Setup)
 {
     // Cap last block file size, and mine new block in a new block file.
@@ -137,6 +183,19 @@ BOOST_FIXTURE_TEST_CASE(blockmanager_block_data_availability, TestChain100Setup)
     BOOST_CHECK(!blockman.CheckBlockDataAvailability(tip, *last_pruned_block));
 }
 
+BOOST_FIXTURE_TEST_CASE(blockmanager_pow_checked_flag, TestChain100Setup)
+{
+    LOCK(::cs_main);
+    const CChain& chain = m_node.chainman->ActiveChain();
+
+    // Accepted proof of work headers are flagged so the next load skips rehashing them
+    BOOST_CHECK(!(chain.Genesis()->nStatus & BLOCK_POW_CHECKED));
+    for (int height = 1; height <= chain.Height(); ++height) {
+        const CBlockIndex* pindex = chain[height];
+        BOOST_CHECK_EQUAL(bool(pindex->nStatus & BLOCK_POW_CHECKED), pindex->IsProofOfWork());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
 {
     KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
@@ -206,4 +265,55 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
 }
 
+BOOST_AUTO_TEST_CASE(blocktreedb_log_index_undo)
+{
+    kernel::BlockTreeDB db{DBParams{.path = m_args.GetDataDirNet() / "blocks" / "index", .cache_bytes = 1 << 20, .memory_only = true}};
+    const dev::h160 address{dev::h160(0x11)};
+    const dev::h256 topic{dev::h256(0x22)};
+    const uint256 tx10{uint256::ONE};
+    const uint256 tx11{uint256::FromHex("0000000000000000000000000000000000000000000000000000000000000002").value()};
+
+    // Two blocks with logs of the same contract and topic, the first one staked and delegated
+    for (const auto& [height, tx] : {std::pair{10u, tx10}, std::pair{11u, tx11}}) {
+        BOOST_CHECK(db.WriteHeightIndex(CHeightTxIndexKey(height, address), {tx}));
+        BOOST_CHECK(db.WriteTopicIndex({{CTopicTxIndexKey(topic, height, address), {tx}}}));
+    }
+    BOOST_CHECK(db.WriteStakeIndex(10, uint160{address.asBytes()}));
+    BOOST_CHECK(db.WriteDelegateIndex(10, uint160{address.asBytes()}, 10));
+
+    CLogIndexUndo undo;
+    undo.blockHash = uint256::ONE;
+    undo.heightIndex.emplace_back(10, address);
+    undo.topicIndex.emplace_back(topic, 10, address);
+    undo.receipts.push_back(tx10);
+    BOOST_CHECK(db.WriteLogIndexUndo(10, undo));
+
+    CLogIndexUndo read;
+    BOOST_REQUIRE(db.ReadLogIndexUndo(10, read));
+    BOOST_CHECK(read.blockHash == undo.blockHash);
+    BOOST_REQUIRE_EQUAL(read.heightIndex.size(), 1U);
+    BOOST_CHECK(read.heightIndex[0].address == address);
+    BOOST_REQUIRE_EQUAL(read.topicIndex.size(), 1U);
+    BOOST_CHECK(read.topicIndex[0].topic == topic);
+    BOOST_CHECK_EQUAL(read.topicIndex[0].height, 10U);
+    BOOST_CHECK(read.receipts == undo.receipts);
+
+    BOOST_CHECK(db.EraseBlockIndexes(10, &read, /*stakeIndex=*/true));
+
+    // Only the entries of the second block are left
+    BOOST_CHECK(!db.ReadLogIndexUndo(10, read));
+    std::vector<std::vector<uint256>> blocks;
+    BOOST_CHECK_EQUAL(db.ReadTopicIndex(topic, 0, 20, blocks, {}), 20);
+    BOOST_REQUIRE_EQUAL(blocks.size(), 1U);
+    BOOST_CHECK(blocks[0] == std::vector<uint256>{tx11});
+    blocks.clear();
+    BOOST_CHECK_EQUAL(db.ReadTopicIndex(topic, 0, 20, blocks, {address}), 20);
+    BOOST_REQUIRE_EQUAL(blocks.size(), 1U);
+    BOOST_CHECK(blocks[0] == std::vector<uint256>{tx11});
+    uint160 staker;
+    uint8_t fee;
+    BOOST_CHECK(!db.ReadStakeIndex(10, staker));
+    BOOST_CHECK(!db.ReadDelegateIndex(10, staker, fee));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
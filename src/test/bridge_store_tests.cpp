@@ -0,0 +1,190 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bridge/bridge_node.h>
+#include <bridge/bridge_store.h>
+#include <hash.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace bridge;
+
+//! Merkle root of the whole list, as BridgeNode computed it before the tree was incremental
+static uint256 ReferenceRoot(std::vector<uint256> nodes)
+{
+    if (nodes.empty()) return uint256{};
+    while (nodes.size() > 1) {
+        std::vector<uint256> next;
+        for (size_t i = 0; i < nodes.size(); i += 2) {
+            next.push_back(Hash(nodes[i], nodes[i + 1 < nodes.size() ? i + 1 : i]));
+        }
+        nodes = std::move(next);
+    }
+    return nodes[0];
+}
+
+static PendingTransaction MakeTransaction(const uint256& hash, const std::string& destination)
+{
+    PendingTransaction tx{};
+    tx.tx_hash = hash;
+    tx.from_chain = "wattx";
+    tx.to_chain = "monero";
+    tx.amount = 1000;
+    tx.destination = destination;
+    return tx;
+}
+
+BOOST_FIXTURE_TEST_SUITE(bridge_store_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(incremental_merkle_root)
+{
+    IncrementalMerkle merkle;
+    BOOST_CHECK(merkle.Root() == uint256{});
+
+    std::vector<uint256> hashes;
+    for (int i = 0; i < 40; ++i) {
+        hashes.push_back(m_rng.rand256());
+        merkle.Append(hashes.back());
+        BOOST_CHECK_EQUAL(merkle.Size(), hashes.size());
+        BOOST_CHECK_EQUAL(merkle.Root(), ReferenceRoot(hashes));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(merkle_branches)
+{
+    std::vector<uint256> hashes;
+    for (int i = 0; i < 20; ++i) {
+        hashes.push_back(m_rng.rand256());
+        const uint256 root = ReferenceRoot(hashes);
+        const std::vector<CMerkleBranch> branches = ComputeMerkleBranches(hashes);
+        BOOST_REQUIRE_EQUAL(branches.size(), hashes.size());
+        for (size_t j = 0; j < hashes.size(); ++j) {
+            BOOST_CHECK_EQUAL(branches[j].nIndex, int(j));
+            BOOST_CHECK_EQUAL(branches[j].GetRoot(hashes[j]), root);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_flush_policy)
+{
+    BridgeConfig config;
+    config.batch_interval = 600;
+    config.batch_min_interval = 30;
+    config.batch_max_transactions = 100;
+    int64_t wait;
+
+    BOOST_CHECK(CheckBatchFlush(config, 0, 1000, wait) == BatchFlush::NONE);
+    BOOST_CHECK_EQUAL(wait, 600);
+    BOOST_CHECK(CheckBatchFlush(config, 10, 100, wait) == BatchFlush::NONE);
+    BOOST_CHECK_EQUAL(wait, 500);
+    BOOST_CHECK(CheckBatchFlush(config, 10, 600, wait) == BatchFlush::AGE);
+    BOOST_CHECK(CheckBatchFlush(config, 100, 0, wait) == BatchFlush::SIZE);
+
+    // A commitment of 1000 is worth making for 20 transactions at 50 each
+    config.batch_commit_fee = 1000;
+    config.batch_target_fee_per_tx = 50;
+    BOOST_CHECK(CheckBatchFlush(config, 19, 100, wait) == BatchFlush::NONE);
+    BOOST_CHECK_EQUAL(wait, 500);
+    BOOST_CHECK(CheckBatchFlush(config, 20, 10, wait) == BatchFlush::NONE);
+    BOOST_CHECK_EQUAL(wait, 20);
+    BOOST_CHECK(CheckBatchFlush(config, 20, 30, wait) == BatchFlush::FEE);
+}
+
+BOOST_AUTO_TEST_CASE(transactions_and_batches)
+{
+    BridgeStore store(fs::path{}, 1 << 20, /*memory_only=*/true);
+
+    TransactionBatch batch{};
+    batch.batch_id = 7;
+    IncrementalMerkle merkle;
+    std::vector<PendingTransaction> txs;
+    for (int i = 0; i < 3; ++i) {
+        txs.push_back(MakeTransaction(m_rng.rand256(), i == 1 ? "alice" : "bob"));
+        batch.tx_hashes.push_back(txs.back().tx_hash);
+        merkle.Append(txs.back().tx_hash);
+        BOOST_CHECK(store.AddTransaction(txs.back(), batch, merkle));
+    }
+    BOOST_CHECK_EQUAL(store.ReadOpenTransactions().size(), 3U);
+    BOOST_CHECK_EQUAL(store.ReadTransactionsByDestination("bob").size(), 2U);
+    BOOST_CHECK(store.ReadTransactionsByDestination("alice") == std::vector<uint256>{txs[1].tx_hash});
+
+    // Closing a transaction drops it from the open index only
+    txs[0].completed = true;
+    BOOST_CHECK(store.WriteTransaction(txs[0]));
+    BOOST_CHECK_EQUAL(store.ReadOpenTransactions().size(), 2U);
+    PendingTransaction read;
+    BOOST_CHECK(store.ReadTransaction(txs[0].tx_hash, read));
+    BOOST_CHECK(read.completed);
+
+    // The current batch is rebuilt from its entries
+    TransactionBatch current;
+    IncrementalMerkle current_merkle;
+    BOOST_CHECK(store.ReadCurrentBatch(current, current_merkle));
+    BOOST_CHECK_EQUAL(current.batch_id, 7U);
+    BOOST_CHECK(current.tx_hashes == batch.tx_hashes);
+    BOOST_CHECK_EQUAL(current_merkle.Root(), merkle.Root());
+
+    // A logged commit stays until it is finished
+    batch.merkle_root = merkle.Root();
+    BOOST_CHECK(store.LogBatchCommit(batch));
+    TransactionBatch logged;
+    BOOST_CHECK(store.ReadBatchCommitLog(logged));
+    BOOST_CHECK(logged.tx_hashes == batch.tx_hashes);
+
+    TransactionBatch next{};
+    next.batch_id = 8;
+    BOOST_CHECK(store.FinishBatchCommit(batch, next));
+    BOOST_CHECK(!store.ReadBatchCommitLog(logged));
+    TransactionBatch committed;
+    BOOST_CHECK(store.ReadBatch(7, committed));
+    BOOST_CHECK_EQUAL(committed.merkle_root, batch.merkle_root);
+    uint64_t proof_batch;
+    CMerkleBranch branch;
+    BOOST_CHECK(store.ReadInclusionProof(txs[2].tx_hash, proof_batch, branch));
+    BOOST_CHECK_EQUAL(proof_batch, 7U);
+    BOOST_CHECK_EQUAL(branch.nIndex, 2);
+    BOOST_CHECK_EQUAL(branch.GetRoot(txs[2].tx_hash), batch.merkle_root);
+    BOOST_CHECK(store.ReadCurrentBatch(current, current_merkle));
+    BOOST_CHECK_EQUAL(current.batch_id, 8U);
+    BOOST_CHECK(current.tx_hashes.empty());
+    BOOST_CHECK_EQUAL(current_merkle.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(active_swaps_by_expiry)
+{
+    BridgeStore store(fs::path{}, 1 << 20, /*memory_only=*/true);
+
+    std::vector<AtomicSwap> swaps;
+    for (int64_t timelock : {300, 100, 200}) {
+        AtomicSwap swap{};
+        swap.swap_id = m_rng.rand256();
+        swap.timelock = timelock;
+        swap.state = "active";
+        BOOST_CHECK(store.WriteSwap(swap));
+        swaps.push_back(swap);
+    }
+
+    std::vector<AtomicSwap> active = store.ReadActiveSwaps();
+    BOOST_REQUIRE_EQUAL(active.size(), 3U);
+    BOOST_CHECK_EQUAL(active[0].timelock, 100);
+    BOOST_CHECK_EQUAL(active[1].timelock, 200);
+    BOOST_CHECK_EQUAL(active[2].timelock, 300);
+
+    swaps[1].state = "claimed";
+    BOOST_CHECK(store.WriteSwap(swaps[1]));
+    active = store.ReadActiveSwaps();
+    BOOST_CHECK_EQUAL(active.size(), 2U);
+    BOOST_CHECK(std::none_of(active.begin(), active.end(), [&](const AtomicSwap& s) { return s.swap_id == swaps[1].swap_id; }));
+    AtomicSwap read;
+    BOOST_CHECK(store.ReadSwap(swaps[1].swap_id, read));
+    BOOST_CHECK_EQUAL(read.state, "claimed");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -60,10 +60,23 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_initial_sync, TestChain100Setup)
         LOCK(cs_main);
         new_block_index = m_node.chainman->ActiveChain().Tip();
     }
-    BOOST_CHECK(coin_stats_index.LookUpStats(*new_block_index));
+    const auto new_stats{coin_stats_index.LookUpStats(*new_block_index)};
+    BOOST_REQUIRE(new_stats);
 
     BOOST_CHECK(block_index != new_block_index);
 
+    // No contracts or privacy transactions on this chain, so their totals are
+    // empty and the contract MuHash is the one of the empty set.
+    uint256 empty_muhash;
+    MuHash3072{}.Finalize(empty_muhash);
+    BOOST_CHECK_EQUAL(new_stats->contract_output_count, 0U);
+    BOOST_CHECK_EQUAL(new_stats->total_contract_amount, 0);
+    BOOST_CHECK_EQUAL(new_stats->contract_muhash, empty_muhash);
+    BOOST_CHECK(new_stats->hashSerialized != empty_muhash);
+    BOOST_CHECK_EQUAL(new_stats->privacy_tx_count, 0U);
+    BOOST_CHECK_EQUAL(new_stats->privacy_key_image_count, 0U);
+    BOOST_CHECK_EQUAL(new_stats->total_privacy_value_in, 0);
+
     // It is not safe to stop and destroy the index until it finishes handling
     // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
     // call above is sufficient to ensure this, but the
@@ -0,0 +1,94 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/connect_stats.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+using node::BlockConnectStats;
+using node::BlockConnectTimes;
+using node::ConnectPhase;
+
+static BlockConnectTimes MakeTimes(int height, std::chrono::microseconds evm, std::chrono::microseconds privacy)
+{
+    BlockConnectTimes times;
+    times.height = height;
+    times.Add(ConnectPhase::EVM, evm);
+    times.Add(ConnectPhase::PRIVACY, privacy);
+    times.Add(ConnectPhase::CHECKS, std::chrono::microseconds{100});
+    return times;
+}
+
+static size_t Index(ConnectPhase phase) { return static_cast<size_t>(phase); }
+
+BOOST_FIXTURE_TEST_SUITE(connect_stats_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(phase_times)
+{
+    BlockConnectTimes times{MakeTimes(1, std::chrono::milliseconds{2}, std::chrono::microseconds{500})};
+    times.Add(ConnectPhase::EVM, std::chrono::milliseconds{1});
+    BOOST_CHECK(times.Get(ConnectPhase::EVM) == std::chrono::milliseconds{3});
+    BOOST_CHECK(times.Total() == std::chrono::microseconds{3600});
+    for (size_t phase = 0; phase < node::CONNECT_PHASE_COUNT; ++phase) {
+        BOOST_CHECK(!node::ConnectPhaseName(static_cast<ConnectPhase>(phase)).empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(percentiles_and_slowest)
+{
+    BlockConnectStats stats;
+    // EVM takes 1..200ms, privacy a constant 1ms
+    for (int i = 1; i <= 200; ++i) {
+        stats.Record(MakeTimes(i, std::chrono::milliseconds{i}, std::chrono::milliseconds{1}));
+    }
+
+    const BlockConnectStats::Summary summary{stats.GetSummary(5)};
+    BOOST_CHECK_EQUAL(summary.blocks, 200U);
+    BOOST_CHECK_EQUAL(summary.window_blocks, 200U);
+
+    const auto& evm{summary.phases[Index(ConnectPhase::EVM)]};
+    BOOST_CHECK_EQUAL(evm.p50_ms, 101.0);
+    BOOST_CHECK_EQUAL(evm.p90_ms, 181.0);
+    BOOST_CHECK_EQUAL(evm.p99_ms, 199.0);
+    BOOST_CHECK_EQUAL(evm.max_ms, 200.0);
+    BOOST_CHECK_CLOSE(evm.mean_ms, 100.5, 0.001);
+    // The moving average follows the recent, slower blocks
+    BOOST_CHECK(evm.ema_ms > evm.mean_ms && evm.ema_ms < evm.max_ms);
+
+    const auto& privacy{summary.phases[Index(ConnectPhase::PRIVACY)]};
+    BOOST_CHECK_EQUAL(privacy.p99_ms, 1.0);
+    BOOST_CHECK_CLOSE(privacy.ema_ms, 1.0, 0.001);
+
+    const auto& total{summary.phases[node::CONNECT_PHASE_COUNT]};
+    BOOST_CHECK_CLOSE(total.max_ms, 201.1, 0.001);
+
+    BOOST_REQUIRE_EQUAL(summary.slowest.size(), 5U);
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK_EQUAL(summary.slowest[i].height, 200 - i);
+    }
+    BOOST_CHECK(summary.slowest[0].Get(ConnectPhase::EVM) == std::chrono::milliseconds{200});
+}
+
+BOOST_AUTO_TEST_CASE(window_and_reset)
+{
+    BlockConnectStats stats;
+    for (size_t i = 0; i < BlockConnectStats::WINDOW + 10; ++i) {
+        stats.Record(MakeTimes(i, std::chrono::milliseconds{i == 0 ? 500 : 1}, {}));
+    }
+    BlockConnectStats::Summary summary{stats.GetSummary(BlockConnectStats::MAX_SLOWEST + 10)};
+    BOOST_CHECK_EQUAL(summary.window_blocks, BlockConnectStats::WINDOW);
+    BOOST_CHECK_EQUAL(summary.slowest.size(), BlockConnectStats::MAX_SLOWEST);
+    // The slow block left the window but not the slowest blocks
+    BOOST_CHECK_EQUAL(summary.phases[Index(ConnectPhase::EVM)].max_ms, 1.0);
+    BOOST_CHECK_EQUAL(summary.slowest[0].height, 0);
+
+    stats.Reset();
+    summary = stats.GetSummary(10);
+    BOOST_CHECK_EQUAL(summary.blocks, 0U);
+    BOOST_CHECK(summary.slowest.empty());
+    BOOST_CHECK_EQUAL(summary.phases[Index(ConnectPhase::EVM)].max_ms, 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
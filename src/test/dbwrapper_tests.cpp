@@ -8,6 +8,9 @@
 #include <uint256.h>
 #include <util/string.h>
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include <memory>
 
 #include <boost/test/unit_test.hpp>
@@ -162,6 +165,75 @@ BOOST_AUTO_TEST_CASE(dbwrapper_batch)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_records)
+{
+    // Records read from one obfuscated database replace the content of another
+    CDBWrapper src({.path = m_args.GetDataDirBase() / "dbwrapper_records_src", .cache_bytes = 1 << 20, .memory_only = true, .wipe_data = false, .obfuscate = true});
+    CDBWrapper dst({.path = m_args.GetDataDirBase() / "dbwrapper_records_dst", .cache_bytes = 1 << 20, .memory_only = true, .wipe_data = false, .obfuscate = true});
+    BOOST_CHECK(dbwrapper_private::GetObfuscateKey(src) != dbwrapper_private::GetObfuscateKey(dst));
+
+    const uint256 in = m_rng.rand256();
+    const uint32_t in_uint{m_rng.rand32()};
+    BOOST_CHECK(src.Write(uint8_t{'a'}, in));
+    BOOST_CHECK(src.Write(uint8_t{'b'}, in_uint));
+    BOOST_CHECK(dst.Write(uint8_t{'c'}, in));
+
+    const CDBWrapper::Records records{src.ReadAllRecords()};
+    BOOST_CHECK_EQUAL(records.size(), 2U);
+    BOOST_CHECK(dst.ReplaceAllRecords(records));
+
+    uint256 res;
+    uint32_t res_uint;
+    BOOST_CHECK(dst.Read(uint8_t{'a'}, res));
+    BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+    BOOST_CHECK(dst.Read(uint8_t{'b'}, res_uint));
+    BOOST_CHECK_EQUAL(res_uint, in_uint);
+    BOOST_CHECK(!dst.Exists(uint8_t{'c'}));
+    BOOST_CHECK(dst.ReadAllRecords() == records);
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_stats)
+{
+    SetSharedDBCacheSize(1 << 20);
+    CDBWrapper shared({.path = m_args.GetDataDirBase() / "dbwrapper_stats_shared", .cache_bytes = 1 << 16, .memory_only = true, .shared_cache = true});
+    CDBWrapper own({.path = m_args.GetDataDirBase() / "dbwrapper_stats_own", .cache_bytes = 1 << 16, .memory_only = true});
+    SetSharedDBCacheSize(0);
+
+    // Enough data for several level 0 tables with the smallest write buffer
+    const std::vector<unsigned char> value(4096, 0x55);
+    for (uint32_t i = 0; i < 512; ++i) BOOST_CHECK(shared.Write(i, value));
+    const DBStats before{shared.GetStats()};
+    std::vector<unsigned char> res;
+    BOOST_CHECK(shared.Read(uint32_t{0}, res));
+    BOOST_CHECK(!shared.Read(uint32_t{1000}, res));
+
+    DBStats stats{shared.GetStats()};
+    BOOST_CHECK_EQUAL(stats.name, "dbwrapper_stats_shared");
+    BOOST_CHECK(stats.shared_cache);
+    BOOST_CHECK_EQUAL(stats.block_cache_capacity, 1U << 20);
+    BOOST_CHECK_EQUAL(stats.reads - before.reads, 2U);
+    BOOST_CHECK_EQUAL(stats.read_hits - before.read_hits, 1U);
+    BOOST_CHECK_EQUAL(stats.bytes_read - before.bytes_read, ::GetSerializeSize(value));
+    BOOST_CHECK_EQUAL(stats.batches_written, 512U);
+    BOOST_CHECK(stats.bytes_written > 512 * value.size());
+    BOOST_CHECK(!own.GetStats().shared_cache);
+    BOOST_CHECK_EQUAL(own.GetStats().block_cache_capacity, 1U << 15);
+
+    const std::vector<DBStats> all{GetAllDBStats()};
+    BOOST_CHECK_EQUAL(std::count_if(all.begin(), all.end(), [](const DBStats& s) { return s.name.starts_with("dbwrapper_stats_"); }), 2);
+
+    // A busy database is left alone, a compaction folds level 0 into deeper levels
+    BOOST_CHECK(!CompactIdleDB(std::chrono::hours{1}, 1, std::numeric_limits<uint64_t>::max()));
+    shared.Compact();
+    stats = shared.GetStats();
+    BOOST_REQUIRE(!stats.level_files.empty());
+    BOOST_CHECK_EQUAL(stats.level_files[0], 0);
+    BOOST_CHECK(stats.table_bytes > 0);
+    BOOST_CHECK(stats.compaction_bytes_written > 0);
+    BOOST_CHECK(stats.WriteAmplification() > 1.0);
+    BOOST_CHECK(stats.ReadAmplification() >= 1);
+}
+
 BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
 {
     // Perform tests both obfuscated and non-obfuscated.
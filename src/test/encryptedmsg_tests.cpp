@@ -0,0 +1,98 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <messaging/encryptedmsg.h>
+#include <test/util/setup_common.h>
+#include <util/time.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace messaging;
+
+BOOST_FIXTURE_TEST_SUITE(encryptedmsg_tests, BasicTestingSetup)
+
+static EncryptedMessage MakeMessage(FastRandomContext& rng)
+{
+    EncryptedMessage msg;
+    msg.recipientHash = rng.rand256();
+    msg.senderHash = rng.rand256();
+    msg.timestamp = GetTime();
+    msg.encryptedData = rng.randbytes<unsigned char>(100);
+    msg.msgHash = msg.GetHash();
+    return msg;
+}
+
+BOOST_AUTO_TEST_CASE(inventory_relay)
+{
+    MessageManager manager{fs::path{}, 1 << 20, /*memory_only=*/true};
+    const int64_t now = GetTime();
+
+    // An announced message is requested from the first announcer only,
+    // until the request times out
+    const EncryptedMessage msg = MakeMessage(m_rng);
+    BOOST_CHECK(manager.ReceivedInventory(/*peerNodeId=*/1, msg.msgHash, now));
+    BOOST_CHECK(!manager.ReceivedInventory(/*peerNodeId=*/2, msg.msgHash, now + 1));
+    BOOST_CHECK(manager.ReceivedInventory(/*peerNodeId=*/2, msg.msgHash, now + MessageManager::REQUEST_TIMEOUT_SECONDS));
+
+    // Once received it is announced to the peers that don't know it, once
+    BOOST_CHECK(manager.ProcessMessage(msg, /*fromPeer=*/2));
+    BOOST_CHECK(!manager.ReceivedInventory(/*peerNodeId=*/3, msg.msgHash, now));
+    BOOST_CHECK(manager.GetInventoryToAnnounce(/*peerNodeId=*/1).empty());
+    BOOST_CHECK(manager.GetInventoryToAnnounce(/*peerNodeId=*/2).empty());
+    BOOST_CHECK(manager.GetInventoryToAnnounce(/*peerNodeId=*/3).empty());
+    const std::vector<uint256> inv = manager.GetInventoryToAnnounce(/*peerNodeId=*/4);
+    BOOST_REQUIRE_EQUAL(inv.size(), 1U);
+    BOOST_CHECK_EQUAL(inv[0], msg.msgHash);
+    BOOST_CHECK(manager.GetInventoryToAnnounce(/*peerNodeId=*/4).empty());
+
+    // Only messages relayed through us are served to getdata
+    EncryptedMessage served;
+    BOOST_REQUIRE(manager.GetRelayMessage(msg.msgHash, served));
+    BOOST_CHECK_EQUAL(served.GetHash(), msg.GetHash());
+    BOOST_CHECK(!manager.GetRelayMessage(m_rng.rand256(), served));
+
+    // Announcements are batched up to the requested count
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK(manager.QueueOutgoingMessage(MakeMessage(m_rng)));
+    }
+    BOOST_CHECK_EQUAL(manager.GetInventoryToAnnounce(/*peerNodeId=*/4, 3).size(), 3U);
+    BOOST_CHECK_EQUAL(manager.GetInventoryToAnnounce(/*peerNodeId=*/4, 3).size(), 2U);
+    manager.RemovePeer(4);
+    BOOST_CHECK_EQUAL(manager.GetInventoryToAnnounce(/*peerNodeId=*/4).size(), 6U);
+}
+
+BOOST_AUTO_TEST_CASE(store_delivery_and_expiry)
+{
+    MessageManager manager{fs::path{}, 1 << 20, /*memory_only=*/true};
+    std::vector<uint256> delivered;
+    manager.SetMessageCallback([&](const EncryptedMessage& msg) { delivered.push_back(msg.msgHash); });
+
+    // A message relayed before its address was registered is delivered on
+    // registration, and no longer relayed
+    const EncryptedMessage msg = MakeMessage(m_rng);
+    BOOST_CHECK(manager.ProcessMessage(msg, /*fromPeer=*/1));
+    BOOST_CHECK(delivered.empty());
+    manager.RegisterAddress(msg.recipientHash);
+    BOOST_REQUIRE_EQUAL(delivered.size(), 1U);
+    BOOST_CHECK_EQUAL(delivered[0], msg.msgHash);
+    EncryptedMessage served;
+    BOOST_CHECK(!manager.GetRelayMessage(msg.msgHash, served));
+    BOOST_CHECK(manager.GetInventoryToAnnounce(/*peerNodeId=*/2).empty());
+    BOOST_CHECK_EQUAL(manager.GetReceivedMessages().size(), 1U);
+    manager.MarkDelivered(msg.msgHash);
+    BOOST_CHECK(manager.GetReceivedMessages().empty());
+
+    // Expired messages are erased, and may be seen again
+    const EncryptedMessage relay = MakeMessage(m_rng);
+    BOOST_CHECK(manager.ProcessMessage(relay, /*fromPeer=*/1));
+    BOOST_CHECK(manager.HaveSeen(relay.msgHash));
+    SetMockTime(relay.timestamp + MessageManager::MESSAGE_EXPIRY_SECONDS + 1);
+    manager.CleanupExpired();
+    BOOST_CHECK(!manager.HaveSeen(msg.msgHash));
+    BOOST_CHECK(!manager.HaveSeen(relay.msgHash));
+    BOOST_CHECK(manager.GetInventoryToAnnounce(/*peerNodeId=*/2).empty());
+    SetMockTime(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/eth_filters.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <util/time.h>
+
+#include <boost/test/unit_test.hpp>
+
+using node::EthFilterLog;
+using node::EthFilterManager;
+using node::EthLogFilter;
+
+namespace {
+EthFilterLog MakeLog(const dev::h160& address, dev::h256s topics, int height, const uint256& blockHash)
+{
+    EthFilterLog log;
+    log.address = address;
+    log.topics = std::move(topics);
+    log.blockNumber = height;
+    log.blockHash = blockHash;
+    return log;
+}
+
+std::vector<EthFilterLog> TakeLogs(EthFilterManager& filters, const std::string& id)
+{
+    EthFilterManager::FilterType type;
+    std::vector<EthFilterLog> logs;
+    std::vector<uint256> hashes;
+    BOOST_REQUIRE(filters.GetChanges(id, type, logs, hashes));
+    BOOST_CHECK(type == EthFilterManager::FilterType::LOG);
+    return logs;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(eth_filters_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(log_filter_matches)
+{
+    const dev::h160 token{dev::h160::Arith(1)};
+    const dev::h256 transfer{dev::h256::Arith(2)}, approval{dev::h256::Arith(3)}, holder{dev::h256::Arith(4)};
+
+    EthLogFilter filter;
+    BOOST_CHECK(filter.Matches(token, {}, 10));
+
+    filter.addresses = {token};
+    filter.topics = {{transfer, approval}, {}, {holder}};
+    BOOST_CHECK(filter.Matches(token, {transfer, approval, holder}, 10));
+    BOOST_CHECK(filter.Matches(token, {approval, transfer, holder, transfer}, 10));
+    BOOST_CHECK(!filter.Matches(dev::h160{dev::h160::Arith(5)}, {transfer, approval, holder}, 10));
+    BOOST_CHECK(!filter.Matches(token, {holder, approval, holder}, 10));
+    BOOST_CHECK(!filter.Matches(token, {transfer, approval}, 10));
+
+    filter.fromBlock = 5;
+    filter.toBlock = 10;
+    BOOST_CHECK(!filter.Matches(token, {transfer, approval, holder}, 4));
+    BOOST_CHECK(!filter.Matches(token, {transfer, approval, holder}, 11));
+}
+
+BOOST_AUTO_TEST_CASE(log_filter_changes)
+{
+    EthFilterManager filters;
+    const dev::h160 token{dev::h160::Arith(1)}, other{dev::h160::Arith(2)};
+    const dev::h256 transfer{dev::h256::Arith(3)};
+
+    const uint256 before{m_rng.rand256()};
+    filters.AddBlockLogs(before, {MakeLog(token, {transfer}, 1, before)});
+
+    EthLogFilter filter;
+    filter.addresses = {token};
+    const std::string id = filters.NewLogFilter(filter);
+    BOOST_CHECK(TakeLogs(filters, id).empty());
+
+    const uint256 block{m_rng.rand256()};
+    filters.AddBlockLogs(block, {MakeLog(token, {transfer}, 2, block), MakeLog(other, {transfer}, 2, block)});
+    std::vector<EthFilterLog> logs = TakeLogs(filters, id);
+    BOOST_REQUIRE_EQUAL(logs.size(), 1U);
+    BOOST_CHECK(logs[0].address == token);
+    BOOST_CHECK(!logs[0].removed);
+    BOOST_CHECK(TakeLogs(filters, id).empty());
+
+    // Only the logs the filter saw are reported removed
+    filters.RemoveBlockLogs(block);
+    filters.RemoveBlockLogs(before);
+    logs = TakeLogs(filters, id);
+    BOOST_REQUIRE_EQUAL(logs.size(), 1U);
+    BOOST_CHECK(logs[0].blockHash == block);
+    BOOST_CHECK(logs[0].removed);
+
+    BOOST_CHECK(filters.Uninstall(id));
+    BOOST_CHECK(!filters.Uninstall(id));
+}
+
+BOOST_AUTO_TEST_CASE(filter_timeout)
+{
+    MockableSteadyClock::SetMockTime(MockableSteadyClock::INITIAL_MOCK_TIME);
+    EthFilterManager filters;
+    const std::string polled = filters.NewLogFilter({});
+    const std::string idle = filters.NewBlockFilter();
+
+    MockableSteadyClock::SetMockTime(MockableSteadyClock::INITIAL_MOCK_TIME + EthFilterManager::FILTER_TIMEOUT);
+    TakeLogs(filters, polled);
+
+    MockableSteadyClock::SetMockTime(MockableSteadyClock::INITIAL_MOCK_TIME + EthFilterManager::FILTER_TIMEOUT + std::chrono::seconds{1});
+    EthFilterManager::FilterType type;
+    std::vector<EthFilterLog> logs;
+    std::vector<uint256> hashes;
+    BOOST_CHECK(!filters.GetChanges(idle, type, logs, hashes));
+    BOOST_CHECK(filters.GetChanges(polled, type, logs, hashes));
+    MockableSteadyClock::ClearMockTime();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+// Copyright (c) 2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <consensus/validation.h>
+#include <index/explorerindex.h>
+#include <interfaces/chain.h>
+#include <script/script.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(explorerindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(explorerindex_block_summaries, TestChain100Setup)
+{
+    ExplorerIndex explorerindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(explorerindex.Init());
+    BOOST_REQUIRE(explorerindex.StartBackgroundSync());
+    IndexWaitSynced(explorerindex, *Assert(m_node.shutdown_signal));
+
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip());
+    CBlock block;
+    BOOST_REQUIRE(m_node.chainman->m_blockman.ReadBlock(block, *tip));
+
+    ExplorerBlockSummary summary;
+    BOOST_REQUIRE(explorerindex.ReadBlockSummary(tip->nHeight, summary));
+    BOOST_CHECK_EQUAL(summary.hash, tip->GetBlockHash());
+    BOOST_CHECK_EQUAL(summary.time, block.nTime);
+    BOOST_CHECK_EQUAL(summary.tx_count, block.vtx.size());
+    BOOST_CHECK(!summary.proof_of_stake);
+    BOOST_CHECK(summary.staker == block.vtx[0]->vout[0].scriptPubKey);
+    BOOST_CHECK_EQUAL(summary.reward, block.vtx[0]->GetValueOut());
+    BOOST_CHECK(!explorerindex.ReadBlockSummary(tip->nHeight + 1, summary));
+
+    // Ranges stop at the indexed tip
+    std::vector<std::pair<int, ExplorerBlockSummary>> summaries;
+    BOOST_REQUIRE(explorerindex.ReadBlockSummaries(tip->nHeight - 4, tip->nHeight + 10, summaries));
+    BOOST_REQUIRE_EQUAL(summaries.size(), 5U);
+    BOOST_CHECK_EQUAL(summaries.front().first, tip->nHeight - 4);
+    BOOST_CHECK_EQUAL(summaries.back().second.hash, tip->GetBlockHash());
+
+    std::vector<std::pair<TokenTransferKey, TokenTransfer>> transfers;
+    bool more{true};
+    BOOST_REQUIRE(explorerindex.ReadTokenTransfers(uint160{}, nullptr, 10, /*reverse=*/true, transfers, more));
+    BOOST_CHECK(transfers.empty());
+    BOOST_CHECK(!more);
+
+    // A reorg replaces the summary of the disconnected block
+    {
+        BlockValidationState state;
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())));
+    }
+    const CBlock replacement = CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    IndexWaitSynced(explorerindex, *Assert(m_node.shutdown_signal));
+    BOOST_REQUIRE(explorerindex.ReadBlockSummary(tip->nHeight, summary));
+    BOOST_CHECK_EQUAL(summary.hash, replacement.GetHash());
+    BOOST_CHECK(summary.staker == CScript() << OP_TRUE);
+
+    explorerindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
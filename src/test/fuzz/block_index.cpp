@@ -129,5 +129,6 @@ FUZZ_TARGET(block_index, .init = init_block_index)
     const auto inserter = [&](const uint256&) {
         return blocks.back().get();
     };
-    WITH_LOCK(::cs_main, assert(block_index.LoadBlockIndexGuts(params, inserter, g_setup->m_interrupt)));
+    std::vector<CBlockIndex*> pow_checked;
+    WITH_LOCK(::cs_main, assert(block_index.LoadBlockIndexGuts(params, inserter, g_setup->m_interrupt, /*check_all_pow=*/true, pow_checked)));
 }
@@ -118,6 +118,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getbestblockhash",
     "getblock",
     "getblockchaininfo",
+    "getblockconnectstats",
     "getblockcount",
     "getblockfilter",
     "getblockfrompeer", // when no peers are connected, no p2p message is sent
@@ -129,6 +130,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getchainstates",
     "getchaintxstats",
     "getconnectioncount",
+    "getdbstats",
     "getdeploymentinfo",
     "getdescriptoractivity",
     "getdescriptorinfo",
@@ -35,6 +35,7 @@
 #include <vector>
 
 using node::SnapshotMetadata;
+using node::SnapshotPrivacyState;
 
 namespace {
 
@@ -112,6 +113,9 @@ void utxo_snapshot_fuzz(FuzzBufferType buffer)
                 outfile << Coin(coinbase->vout[0], height, /*fCoinBaseIn=*/1, /*fCoinStakeIn=*/0);
                 height++;
             }
+            // No contract state nodes in either trie, and no privacy state
+            const std::vector<std::pair<uint256, std::vector<unsigned char>>> no_nodes;
+            outfile << no_nodes << no_nodes << SnapshotPrivacyState{};
         }
         if constexpr (INVALID) {
             // Append an invalid coin to ensure invalidity. This error will be
@@ -0,0 +1,86 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/gasprice.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using node::GasPriceSample;
+
+BOOST_FIXTURE_TEST_SUITE(gasprice_tests, TestingSetup)
+
+static CScript CallScript(int64_t gas_limit, int64_t gas_price)
+{
+    return CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(gas_limit) << CScriptNum(gas_price)
+                     << std::vector<unsigned char>(4, 0x01) << std::vector<unsigned char>(20, 0x02) << OP_CALL;
+}
+
+BOOST_AUTO_TEST_CASE(contract_gas)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+    BOOST_CHECK(!node::GetContractGas(CTransaction{tx}));
+
+    // Gas limits add up, the lowest gas price is paid
+    tx.vout[0].scriptPubKey = CallScript(100000, 60);
+    tx.vout.emplace_back(0, CallScript(250000, 45));
+    tx.vout.emplace_back(0, CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(50000) << CScriptNum(80)
+                                      << std::vector<unsigned char>(10, 0x03) << OP_CREATE);
+    const auto gas{node::GetContractGas(CTransaction{tx})};
+    BOOST_REQUIRE(gas);
+    BOOST_CHECK_EQUAL(gas->gas_limit, 400000U);
+    BOOST_CHECK_EQUAL(gas->gas_price, 45);
+}
+
+BOOST_AUTO_TEST_CASE(percentiles)
+{
+    BOOST_CHECK_EQUAL(node::GasPricePercentile({}, 50), 0);
+
+    // Weighed by gas: 40 pays for a tenth, 50 for the next half, 100 for the rest
+    const std::vector<GasPriceSample> samples{{100, 400000}, {40, 100000}, {50, 500000}};
+    BOOST_CHECK_EQUAL(node::GasPricePercentile(samples, 0), 40);
+    BOOST_CHECK_EQUAL(node::GasPricePercentile(samples, 10), 40);
+    BOOST_CHECK_EQUAL(node::GasPricePercentile(samples, 50), 50);
+    BOOST_CHECK_EQUAL(node::GasPricePercentile(samples, 61), 100);
+    BOOST_CHECK_EQUAL(node::GasPricePercentile(samples, 100), 100);
+
+    // Highest first, the block fills up at the second sample
+    const std::vector<GasPriceSample> by_price{{100, 400000}, {50, 500000}, {40, 100000}};
+    BOOST_CHECK_EQUAL(node::GetClearingGasPrice(by_price, 800000), 50);
+    BOOST_CHECK_EQUAL(node::GetClearingGasPrice(by_price, 2000000), 0);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_gas_index)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    const std::vector<std::pair<uint64_t, CAmount>> gas{{0, 0}, {300000, 45}, {0, 0}, {100000, 90}, {200000, 60}};
+    for (size_t i = 0; i < gas.size(); ++i) {
+        tx.vin[0].prevout.n = i;
+        tx.vout[0].nValue = 10000;
+        AddToMempool(pool, entry.Fee(10000).Gas(gas[i].first, gas[i].second).FromTx(tx));
+    }
+
+    const std::vector<GasPriceSample> samples{node::GetMempoolGasPrices(pool)};
+    BOOST_REQUIRE_EQUAL(samples.size(), 3U);
+    BOOST_CHECK_EQUAL(samples[0].gas_price, 90);
+    BOOST_CHECK_EQUAL(samples[1].gas_price, 60);
+    BOOST_CHECK_EQUAL(samples[2].gas_price, 45);
+    BOOST_CHECK_EQUAL(node::GetClearingGasPrice(samples, 250000), 60);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,8 +2,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <httprpc.h>
 #include <httpserver.h>
 #include <test/util/setup_common.h>
+#include <util/time.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -39,4 +41,56 @@ BOOST_AUTO_TEST_CASE(test_query_parameters)
     uri = "/rest/endpoint/someresource.json&p1=v1&p2=v2%";
     BOOST_CHECK_EXCEPTION(GetQueryParameterFromUri(uri.c_str(), "p1"), std::runtime_error, HasReason("URI parsing failed, it likely contained RFC 3986 invalid characters"));
 }
+BOOST_AUTO_TEST_CASE(test_work_class_limits)
+{
+    for (const char* name : {"default", "mining", "wallet", "heavy"}) {
+        BOOST_CHECK_EQUAL(HTTPWorkClassName(HTTPWorkClassFromName(name).value()), name);
+    }
+    BOOST_CHECK(!HTTPWorkClassFromName("Mining").has_value());
+
+    auto limits{ParseHTTPWorkClassLimits("mining:8:100")};
+    BOOST_REQUIRE(limits.has_value());
+    BOOST_CHECK(limits->first == HTTPWorkClass::MINING);
+    BOOST_CHECK_EQUAL(limits->second.threads, 8);
+    BOOST_CHECK_EQUAL(limits->second.depth, 100);
+    BOOST_CHECK(limits->second.deadline == 0ms);
+
+    limits = ParseHTTPWorkClassLimits("heavy:2:10:5000");
+    BOOST_REQUIRE(limits.has_value());
+    BOOST_CHECK(limits->second.deadline == 5s);
+
+    // A class without threads is folded into the default one, which can't be disabled
+    BOOST_CHECK(ParseHTTPWorkClassLimits("heavy:0:0").has_value());
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("default:0:10").has_value());
+
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("heavy:2").has_value());
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("heavy:2:0").has_value());
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("heavy:-1:10").has_value());
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("heavy:2:10:-1").has_value());
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("explorer:2:10").has_value());
+    BOOST_CHECK(!ParseHTTPWorkClassLimits("heavy:2:10:5:5").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(test_jsonrpc_work_class)
+{
+    const auto classify{[](std::string_view body) { return ClassifyJSONRPCRequest(body, HTTPWorkClass::DEFAULT); }};
+    BOOST_CHECK(classify(R"({"jsonrpc":"2.0","method":"submitblock","params":["00"],"id":1})") == HTTPWorkClass::MINING);
+    BOOST_CHECK(classify(R"({"method" : "searchlogs", "params": [1, 2]})") == HTTPWorkClass::HEAVY);
+    BOOST_CHECK(classify(R"({"method":"getblockcount"})") == HTTPWorkClass::DEFAULT);
+    BOOST_CHECK(classify("") == HTTPWorkClass::DEFAULT);
+    BOOST_CHECK(classify("not json") == HTTPWorkClass::DEFAULT);
+
+    // Unclassified methods fall back to the endpoint's class
+    BOOST_CHECK(ClassifyJSONRPCRequest(R"({"method":"getbalance"})", HTTPWorkClass::WALLET) == HTTPWorkClass::WALLET);
+    BOOST_CHECK(ClassifyJSONRPCRequest(R"({"method":"getblocktemplate"})", HTTPWorkClass::WALLET) == HTTPWorkClass::MINING);
+
+    // Batches
+    BOOST_CHECK(classify(R"([{"method":"getblocktemplate"},{"method":"submitblock"}])") == HTTPWorkClass::MINING);
+    BOOST_CHECK(classify(R"([{"method":"getblocktemplate"},{"method":"getblockcount"}])") == HTTPWorkClass::DEFAULT);
+    BOOST_CHECK(classify(R"([{"method":"submitblock"},{"method":"eth_getLogs"}])") == HTTPWorkClass::HEAVY);
+
+    // Only "method" keys count, not the word inside parameters
+    BOOST_CHECK(classify(R"({"method":"getblockcount","params":["method","searchlogs"]})") == HTTPWorkClass::DEFAULT);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,11 +14,13 @@
 #include <util/string.h>
 
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <future>
 #include <ios>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -443,6 +445,62 @@ void TestLogFromLocation(Location location, const std::string& message,
 
 } // namespace
 
+BOOST_FIXTURE_TEST_CASE(logging_async, LogSetup)
+{
+    constexpr int num_threads{4};
+    constexpr int num_lines{200};
+
+    LogInstance().StartAsyncLogging();
+    BOOST_CHECK(LogInstance().AsyncLogging());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < num_lines; ++i) LogInfo("thread %d line %d", t, i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    LogInstance().StopAsyncLogging();
+    BOOST_CHECK(!LogInstance().AsyncLogging());
+    BOOST_CHECK_EQUAL(LogInstance().AsyncDroppedLines(), 0U);
+
+    // Every line is written once, and the lines of a thread keep their order
+    std::vector<int> next(num_threads, 0);
+    for (const std::string& line : ReadDebugLogLines()) {
+        int t, i;
+        BOOST_REQUIRE_EQUAL(std::sscanf(line.c_str(), "thread %d line %d", &t, &i), 2);
+        BOOST_CHECK_EQUAL(i, next.at(t)++);
+    }
+    for (int count : next) BOOST_CHECK_EQUAL(count, num_lines);
+
+    // Back to synchronous logging
+    LogInfo("sync line");
+    BOOST_CHECK_EQUAL(ReadDebugLogLines().back(), "sync line");
+}
+
+BOOST_FIXTURE_TEST_CASE(logging_async_drops, LogSetup)
+{
+    constexpr int num_lines{1000};
+    const uint64_t dropped_before{LogInstance().AsyncDroppedLines()};
+
+    // A queue of one line overflows as soon as the writer falls behind
+    LogInstance().StartAsyncLogging(/*ring_size=*/1);
+    for (int i = 0; i < num_lines; ++i) LogInfo("line %d", i);
+    LogInstance().StopAsyncLogging();
+
+    const uint64_t dropped{LogInstance().AsyncDroppedLines() - dropped_before};
+    uint64_t written{0}, reported{0};
+    for (const std::string& line : ReadDebugLogLines()) {
+        unsigned long long count;
+        if (std::sscanf(line.c_str(), "[warning] Async logging queue full, %llu log lines dropped.", &count) == 1) {
+            reported += count;
+        } else {
+            ++written;
+        }
+    }
+    BOOST_CHECK_EQUAL(written + dropped, uint64_t{num_lines});
+    BOOST_CHECK_EQUAL(reported, dropped);
+}
+
 BOOST_FIXTURE_TEST_CASE(logging_filesize_rate_limit, LogSetup)
 {
     using Status = BCLog::LogRateLimiter::Status;
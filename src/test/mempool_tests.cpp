@@ -3,7 +3,11 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <common/system.h>
+#include <key.h>
 #include <policy/policy.h>
+#include <privacy/consensus.h>
+#include <privacy/privacy.h>
+#include <streams.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <util/time.h>
@@ -804,4 +808,101 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTestsDiamond)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+//! Transaction spending a key image through a ring input carried in an OP_RETURN
+static CMutableTransaction MakeKeyImageTx(const privacy::CKeyImage& key_image, uint32_t n)
+{
+    privacy::CPrivacyTransaction privTx;
+    privTx.privacyType = privacy::PrivacyType::RINGCT;
+    privacy::CPrivacyInput input;
+    input.keyImage = key_image;
+    privTx.privacyInputs.push_back(input);
+
+    DataStream ss;
+    ss << privTx;
+    std::vector<unsigned char> data{'W', 'T', 'X', 'P'};
+    data.insert(data.end(), UCharCast(ss.data()), UCharCast(ss.data() + ss.size()));
+
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_11;
+    tx.vin[0].prevout.n = n;
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_RETURN << data;
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(MempoolKeyImageTest)
+{
+    TestMemPoolEntryHelper entry;
+    const CKey key = GenerateRandomKey();
+    privacy::CKeyImage key_image;
+    BOOST_REQUIRE(privacy::GenerateKeyImage(key, key.GetPubKey(), key_image));
+    const uint256 key_image_hash = key_image.GetHash();
+
+    // Two transactions with different inputs spending the same key image
+    CMutableTransaction tx1 = MakeKeyImageTx(key_image, 0);
+    CMutableTransaction tx2 = MakeKeyImageTx(key_image, 1);
+    BOOST_CHECK(privacy::GetTxKeyImageHashes(CTransaction(tx1)) == std::vector<uint256>{key_image_hash});
+
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+
+    BOOST_CHECK(pool.GetKeyImageConflictTx(key_image_hash) == nullptr);
+    AddToMempool(pool, entry.FromTx(tx1));
+    const CTransaction* spender = pool.GetKeyImageConflictTx(key_image_hash);
+    BOOST_REQUIRE(spender != nullptr);
+    BOOST_CHECK(spender->GetHash() == tx1.GetHash());
+
+    // Removing the spender releases its key images
+    pool.removeRecursive(CTransaction(tx1), REMOVAL_REASON_DUMMY);
+    BOOST_CHECK(pool.GetKeyImageConflictTx(key_image_hash) == nullptr);
+
+    // A block spending the key image evicts the mempool spender as a conflict
+    AddToMempool(pool, entry.FromTx(tx1));
+    BOOST_CHECK_EQUAL(pool.size(), 1U);
+    pool.removeForBlock({MakeTransactionRef(tx2)}, 1);
+    BOOST_CHECK_EQUAL(pool.size(), 0U);
+    BOOST_CHECK(pool.GetKeyImageConflictTx(key_image_hash) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolSenderIndexTest)
+{
+    TestMemPoolEntryHelper entry;
+    const uint160 sender{uint160::FromHex("00000000000000000000000000000000000000aa").value()};
+    const uint160 other{uint160::FromHex("00000000000000000000000000000000000000bb").value()};
+
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+
+    // Three contract txs of one sender, one of another and a plain tx, accepted in that order
+    std::vector<CTransactionRef> txs;
+    for (uint32_t i = 0; i < 5; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout.n = i;
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 10 * COIN;
+        txs.push_back(MakeTransactionRef(tx));
+        entry.Sequence(i);
+        if (i < 3) {
+            AddToMempool(pool, entry.Gas(100000, 40, sender).FromTx(txs.back()));
+        } else if (i == 3) {
+            AddToMempool(pool, entry.Gas(100000, 40, other).FromTx(txs.back()));
+        } else {
+            AddToMempool(pool, entry.Gas(0, 0).FromTx(txs.back()));
+        }
+    }
+    BOOST_CHECK_EQUAL(pool.GetSenderTxCount(sender), 3U);
+    BOOST_CHECK_EQUAL(pool.GetSenderTxCount(other), 1U);
+    BOOST_CHECK_EQUAL(pool.GetSenderTxCount(uint160{}), 0U);
+    BOOST_CHECK(pool.GetSenderTxs(sender) == std::vector<CTransactionRef>(txs.begin(), txs.begin() + 3));
+
+    // Removal keeps the order of the rest, and drops senders without txs
+    pool.removeRecursive(*txs[1], REMOVAL_REASON_DUMMY);
+    pool.removeRecursive(*txs[3], REMOVAL_REASON_DUMMY);
+    BOOST_CHECK(pool.GetSenderTxs(sender) == std::vector<CTransactionRef>({txs[0], txs[2]}));
+    BOOST_CHECK_EQUAL(pool.GetSenderTxCount(other), 0U);
+    BOOST_CHECK_EQUAL(pool.mapSenderTxs.size(), 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -361,6 +361,17 @@ void MinerTestingSetup::TestPackageSelection(const CScript& scriptPubKey, const
     block = block_template->getBlock();
     BOOST_REQUIRE_EQUAL(block.vtx.size(), 9U);
     BOOST_CHECK(block.vtx[8]->GetHash() == hashLowFeeTx2);
+
+    // Cluster selection takes the same transactions here, for no less in fees
+    BlockAssembler::Options ancestor_options{options};
+    ancestor_options.cluster_selection = false;
+    BlockAssembler::Options cluster_options{options};
+    cluster_options.cluster_selection = true;
+    const auto ancestor_template{BlockAssembler{m_node.chainman->ActiveChainstate(), &tx_mempool, ancestor_options}.CreateNewBlock()};
+    const auto cluster_template{BlockAssembler{m_node.chainman->ActiveChainstate(), &tx_mempool, cluster_options}.CreateNewBlock()};
+    BOOST_REQUIRE_EQUAL(cluster_template->block.vtx.size(), ancestor_template->block.vtx.size());
+    BOOST_CHECK_GE(-cluster_template->vTxFees[0], -ancestor_template->vTxFees[0]);
+    BOOST_CHECK_EQUAL(cluster_template->m_package_feerates.size(), 5U);
 }
 
 CAmount calculateReward(const CBlock& block, ChainstateManager& chainman){
@@ -4,6 +4,7 @@
 
 #include <memusage.h>
 #include <support/allocators/pool.h>
+#include <support/largepages.h>
 #include <test/util/poolresourcetester.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
@@ -191,4 +192,36 @@ BOOST_AUTO_TEST_CASE(memusage_test)
     PoolResourceTester::CheckAllDataAccountedFor(resource);
 }
 
+BOOST_AUTO_TEST_CASE(large_page_chunks)
+{
+    const auto total_bytes = [](const LargePageAllocator::Stats& stats) {
+        return stats.explicit_bytes + stats.transparent_bytes + stats.regular_bytes;
+    };
+    const LargePageAllocator::Stats before = LargePageAllocator::Instance().stats();
+    {
+        auto resource = PoolResource<8, 8>(1024, /*large_pages=*/true);
+        BOOST_TEST(resource.ChunkSizeBytes() == LargePageAllocator::LARGE_PAGE_SIZE);
+        PoolResourceTester::CheckAllDataAccountedFor(resource);
+
+        // Fill the first chunk and start a second one
+        std::vector<void*> blocks;
+        for (size_t i = 0; i <= LargePageAllocator::LARGE_PAGE_SIZE / 8; ++i) {
+            blocks.push_back(resource.Allocate(8, 8));
+        }
+        BOOST_TEST(resource.NumAllocatedChunks() == 2U);
+
+        const LargePageAllocator::Stats during = LargePageAllocator::Instance().stats();
+        BOOST_TEST(during.allocations == before.allocations + 2);
+        BOOST_TEST(total_bytes(during) == total_bytes(before) + 2 * LargePageAllocator::LARGE_PAGE_SIZE);
+
+        for (void* block : blocks) {
+            resource.Deallocate(block, 8, 8);
+        }
+        PoolResourceTester::CheckAllDataAccountedFor(resource);
+    }
+    const LargePageAllocator::Stats after = LargePageAllocator::Instance().stats();
+    BOOST_TEST(after.allocations == before.allocations);
+    BOOST_TEST(total_bytes(after) == total_bytes(before));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
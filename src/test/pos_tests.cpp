@@ -0,0 +1,347 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <checkqueue.h>
+#include <key.h>
+#include <pos.h>
+#include <pos_mpos_cache.h>
+#include <pos_stake_cache.h>
+#include <pos_utxo_tracker.h>
+#include <primitives/block.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+#include <trust/trustscore.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+
+BOOST_FIXTURE_TEST_SUITE(pos_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(stake_kernel_search_matches_check_kernel_cache)
+{
+    // 2^246: about one in a thousand kernels per unit of weight meets it
+    const unsigned int nBits = 0x1f400000;
+
+    StakeCacheMap cache;
+    std::vector<COutPoint> prevouts;
+    for (int i = 0; i < 300; i++) {
+        COutPoint prevout(Txid::FromUint256(m_rng.rand256()), m_rng.randrange(4));
+        prevouts.push_back(prevout);
+        // Prevouts missing from the cache are never reported
+        if (i % 10 == 9) continue;
+        cache.Insert(prevout, CStakeCache(1000 + m_rng.randrange(100), 1 + m_rng.randrange(1000)));
+    }
+    std::vector<uint32_t> times;
+    for (uint32_t t = 1040; t < 1200; t += 16) times.push_back(t);
+
+    // Both sides of the weighted target change, where the chain has them
+    const int nReduceHeight = Params().GetConsensus().nReduceBlocktimeHeight;
+    for (int nHeight : {nReduceHeight - 2, nReduceHeight}) {
+        if (nHeight < 0) continue;
+        CBlockIndex prev;
+        prev.nHeight = nHeight;
+        prev.nStakeModifier = m_rng.rand256();
+
+        StakeKernelSearch search;
+        search.Prepare(&prev, nBits, prevouts, cache);
+        BOOST_CHECK_EQUAL(search.size(), cache.Size());
+
+        std::vector<StakeKernelSearch::Hit> hits;
+        search.Search(times, 0, search.size() / 2, hits);
+        search.Search(times, search.size() / 2, search.size(), hits);
+        StakeKernelSearch::SortHits(hits);
+
+        std::vector<StakeKernelSearch::Hit> expected;
+        for (uint32_t nTime : times) {
+            for (size_t i = 0; i < prevouts.size(); i++) {
+                const CStakeCache* stake = cache.Find(prevouts[i]);
+                if (!stake || nTime < stake->blockFromTime) continue;
+                uint256 hashProofOfStake;
+                if (CheckKernelCache(&prev, nBits, nTime, prevouts[i], cache, hashProofOfStake)) {
+                    expected.push_back({nTime, i, hashProofOfStake});
+                }
+            }
+        }
+        StakeKernelSearch::SortHits(expected);
+
+        BOOST_CHECK(!expected.empty());
+        BOOST_REQUIRE_EQUAL(hits.size(), expected.size());
+        for (size_t k = 0; k < hits.size(); k++) {
+            BOOST_CHECK_EQUAL(hits[k].nTime, expected[k].nTime);
+            BOOST_CHECK_EQUAL(hits[k].prevoutIndex, expected[k].prevoutIndex);
+            BOOST_CHECK(hits[k].hashProofOfStake == expected[k].hashProofOfStake);
+        }
+        for (size_t k = 1; k < hits.size(); k++) {
+            BOOST_CHECK(hits[k - 1].nTime <= hits[k].nTime);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stake_cache_map)
+{
+    StakeCacheMap cache;
+    std::map<COutPoint, CStakeCache> reference;
+    std::vector<COutPoint> prevouts;
+    for (int i = 0; i < 2000; i++) {
+        prevouts.emplace_back(Txid::FromUint256(m_rng.rand256()), m_rng.randrange(8));
+    }
+
+    // Random inserts and erases against std::map, through several rehashes
+    for (int round = 0; round < 20000; round++) {
+        const COutPoint& prevout = prevouts[m_rng.randrange(prevouts.size())];
+        if (m_rng.randbool()) {
+            CStakeCache stake(m_rng.rand32(), m_rng.randrange(1000000));
+            BOOST_CHECK_EQUAL(cache.Insert(prevout, stake), reference.emplace(prevout, stake).second);
+        } else {
+            BOOST_CHECK_EQUAL(cache.Erase(prevout), reference.erase(prevout) == 1);
+        }
+    }
+    BOOST_CHECK_EQUAL(cache.Size(), reference.size());
+    for (const COutPoint& prevout : prevouts) {
+        const CStakeCache* stake = cache.Find(prevout);
+        auto it = reference.find(prevout);
+        BOOST_REQUIRE_EQUAL(stake != nullptr, it != reference.end());
+        if (stake) {
+            BOOST_CHECK_EQUAL(stake->blockFromTime, it->second.blockFromTime);
+            BOOST_CHECK_EQUAL(stake->amount, it->second.amount);
+        }
+    }
+    BOOST_CHECK(cache.DynamicMemoryUsage() > 0);
+    BOOST_CHECK(!cache.Insert(COutPoint(), CStakeCache(0, 1)));
+
+    // Odd output indexes go
+    size_t odd = 0;
+    for (const auto& [prevout, stake] : reference) odd += prevout.n % 2;
+    BOOST_CHECK_EQUAL(cache.EraseIf([](const COutPoint& prevout) { return prevout.n % 2 == 1; }), odd);
+    BOOST_CHECK_EQUAL(cache.Size(), reference.size() - odd);
+    for (const auto& [prevout, stake] : reference) {
+        BOOST_CHECK_EQUAL(cache.Contains(prevout), prevout.n % 2 == 0);
+    }
+
+    // A connected block drops what it spends, a disconnected one what it created
+    cache.Clear();
+    CMutableTransaction spend;
+    spend.vin.emplace_back(prevouts[0]);
+    spend.vout.resize(2);
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    block.vtx.push_back(MakeTransactionRef(spend));
+    const Txid created = block.vtx[1]->GetHash();
+    for (const COutPoint& prevout : {prevouts[0], prevouts[1], COutPoint(created, 0), COutPoint(created, 1)}) {
+        cache.Insert(prevout, CStakeCache(1, 1));
+    }
+    cache.BlockConnected(block);
+    BOOST_CHECK(!cache.Contains(prevouts[0]));
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+    cache.BlockDisconnected(block);
+    BOOST_CHECK(!cache.Contains(COutPoint(created, 0)));
+    BOOST_CHECK(!cache.Contains(COutPoint(created, 1)));
+    BOOST_CHECK(cache.Contains(prevouts[1]));
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(coinstake_utxo_tracker)
+{
+    CoinstakeUTXOTracker tracker;
+    std::map<COutPoint, int> reference;
+    std::vector<COutPoint> prevouts;
+    for (int i = 0; i < 200; i++) {
+        prevouts.emplace_back(Txid::FromUint256(m_rng.rand256()), m_rng.randrange(4));
+    }
+
+    // A chain that mostly grows, with short reorgs and a jump past the window
+    int height = 1;
+    for (int round = 0; round < 5000; round++) {
+        if (round == 3000) height += 3 * CoinstakeUTXOTracker::MAX_TRACKING_DEPTH;
+        const COutPoint& prevout = prevouts[m_rng.randrange(prevouts.size())];
+        if (m_rng.randrange(8) == 0) {
+            const int unmarkHeight = height - m_rng.randrange(3);
+            tracker.UnmarkUTXO(prevout, unmarkHeight);
+            auto it = reference.find(prevout);
+            if (it != reference.end() && it->second == unmarkHeight) reference.erase(it);
+            height -= m_rng.randrange(3);
+            continue;
+        }
+
+        tracker.MarkUTXOUsed(prevout, height);
+        reference[prevout] = height;
+        std::erase_if(reference, [&](const auto& entry) {
+            return height - CoinstakeUTXOTracker::MAX_TRACKING_DEPTH > 0 && entry.second < height - CoinstakeUTXOTracker::MAX_TRACKING_DEPTH;
+        });
+        BOOST_REQUIRE_EQUAL(tracker.Size(), reference.size());
+
+        const COutPoint& probe = prevouts[m_rng.randrange(prevouts.size())];
+        const int probeHeight = height + m_rng.randrange(10) - 3;
+        auto it = reference.find(probe);
+        const bool available = it == reference.end() || probeHeight < it->second || probeHeight - it->second >= 6;
+        BOOST_CHECK_EQUAL(tracker.IsUTXOAvailableForStaking(probe, probeHeight), available);
+        height += m_rng.randrange(3);
+    }
+
+    tracker.Clear();
+    BOOST_CHECK_EQUAL(tracker.Size(), 0U);
+    BOOST_CHECK(tracker.IsUTXOAvailableForStaking(prevouts[0], height));
+    tracker.MarkUTXOUsed(prevouts[0], height);
+    BOOST_CHECK(!tracker.IsUTXOAvailableForStaking(prevouts[0], height + 5));
+    BOOST_CHECK(tracker.IsUTXOAvailableForStaking(prevouts[0], height + 6));
+}
+
+BOOST_AUTO_TEST_CASE(coinstake_utxo_tracker_spent_coins)
+{
+    CoinstakeUTXOTracker tracker;
+    const COutPoint staked{Txid::FromUint256(m_rng.rand256()), 0};
+    const COutPoint unknown{Txid::FromUint256(m_rng.rand256()), 1};
+    const Coin spent{CTxOut{5 * COIN, CScript() << OP_TRUE}, 10, /*fCoinBaseIn=*/false, /*fCoinStakeIn=*/true};
+    tracker.MarkUTXOUsed(staked, 100, &spent);
+    tracker.MarkUTXOUsed(unknown, 101);
+
+    int height;
+    Coin coin;
+    BOOST_REQUIRE(tracker.GetSpentCoin(staked, height, coin));
+    BOOST_CHECK_EQUAL(height, 100);
+    BOOST_CHECK_EQUAL(coin.out.nValue, 5 * COIN);
+    BOOST_CHECK(coin.out.scriptPubKey == spent.out.scriptPubKey);
+    BOOST_CHECK_EQUAL(coin.nHeight, 10U);
+    // Tracked without its coin
+    BOOST_CHECK(!tracker.GetSpentCoin(unknown, height, coin));
+
+    // Disconnecting the block forgets the coin, as does leaving the window
+    tracker.UnmarkUTXO(staked, 100);
+    BOOST_CHECK(!tracker.GetSpentCoin(staked, height, coin));
+    tracker.MarkUTXOUsed(staked, 100, &spent);
+    tracker.MarkUTXOUsed(unknown, 101 + CoinstakeUTXOTracker::MAX_TRACKING_DEPTH);
+    BOOST_CHECK(!tracker.GetSpentCoin(staked, height, coin));
+}
+
+BOOST_AUTO_TEST_CASE(mpos_recipient_cache)
+{
+    MPoSRecipientCache cache;
+    std::vector<uint256> hashes;
+    for (int nHeight = 0; nHeight < 30; nHeight++) {
+        MPoSRecipientCache::Recipient recipient;
+        recipient.blockHash = m_rng.rand256();
+        recipient.stakerAddress = uint160{m_rng.randbytes<unsigned char>(20)};
+        recipient.hasDelegate = nHeight % 3 == 0;
+        recipient.fee = nHeight;
+        cache.Add(nHeight, recipient);
+        hashes.push_back(recipient.blockHash);
+    }
+
+    MPoSRecipientCache::Recipient recipient;
+    BOOST_CHECK(cache.Get(12, hashes[12], recipient));
+    BOOST_CHECK(recipient.hasDelegate);
+    BOOST_CHECK_EQUAL(recipient.fee, 12);
+    // A block at the same height on another branch is not served
+    BOOST_CHECK(!cache.Get(12, hashes[13], recipient));
+
+    cache.Remove(29);
+    BOOST_CHECK(!cache.Get(29, hashes[29], recipient));
+    cache.Prune(10);
+    BOOST_CHECK_EQUAL(cache.Size(), 19U);
+    BOOST_CHECK(!cache.Get(9, hashes[9], recipient));
+    BOOST_CHECK(cache.Get(10, hashes[10], recipient));
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(block_signature_key_recovery)
+{
+    std::vector<CKey> keys(20);
+    std::vector<CBlockHeader> headers(keys.size());
+    for (size_t i = 0; i < headers.size(); i++) {
+        keys[i].MakeNewKey(true);
+        headers[i].nTime = i;
+        headers[i].prevoutStake = COutPoint(Txid::FromUint256(m_rng.rand256()), 1);
+        std::vector<unsigned char> sig;
+        BOOST_REQUIRE(keys[i].SignCompact(headers[i].GetHashWithoutSign(), sig));
+        headers[i].SetBlockSignature(sig);
+    }
+    // A compact signature with an invalid recovery id
+    headers.back().SetBlockSignature(std::vector<unsigned char>(CPubKey::COMPACT_SIGNATURE_SIZE, 0));
+
+    // Recover ahead on worker threads, then read the cached keys
+    const Consensus::Params& params{Params().GetConsensus()};
+    CCheckQueue<HeaderCheck> queue{/*batch_size=*/4, /*worker_threads_num=*/3};
+    // A spent stake fails the stake check without failing the batch
+    uint8_t stake_verified{1};
+    {
+        CCheckQueueControl<HeaderCheck> control(&queue);
+        std::vector<HeaderCheck> checks;
+        for (const CBlockHeader& header : headers) checks.emplace_back(header, 1, params);
+        checks.emplace_back(headers[0], 1, params, HeaderCheck::StakeContext{uint256{}, Coin{}, 0}, stake_verified);
+        control.Add(std::move(checks));
+        BOOST_CHECK(!control.Complete().has_value());
+    }
+    BOOST_CHECK_EQUAL(stake_verified, 0);
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i + 1 < headers.size(); i++) {
+            CPubKey pubkey;
+            BOOST_CHECK(RecoverBlockSignaturePubKey(headers[i], pubkey));
+            BOOST_CHECK(pubkey == keys[i].GetPubKey());
+        }
+        CPubKey pubkey;
+        BOOST_CHECK(!RecoverBlockSignaturePubKey(headers.back(), pubkey));
+        BOOST_CHECK(!pubkey.IsValid());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(trust_tier_snapshot)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    trust::TrustScoreManager trustManager(params);
+    const CKeyID validatorId{uint160{m_rng.randbytes<unsigned char>(20)}};
+    const CScript script = GetScriptForDestination(PKHash(validatorId));
+    BOOST_REQUIRE(trustManager.RegisterValidator(validatorId, params.nMinValidatorStake, 100, 0));
+
+    // Registrations are only seen once a block publishes them
+    const auto before = trustManager.GetTierSnapshot();
+    BOOST_CHECK_EQUAL(before->height, -1);
+    BOOST_CHECK(GetStakerTrustTier(script, trustManager) == trust::TrustTier::NONE);
+
+    trustManager.UpdateHeartbeatExpectations(0);
+    BOOST_CHECK(!before->Find(validatorId));
+    const auto after = trustManager.GetTierSnapshot();
+    BOOST_CHECK_EQUAL(after->height, 0);
+    BOOST_REQUIRE(after->Find(validatorId));
+    BOOST_CHECK(after->GetTier(validatorId) == trustManager.GetValidatorTier(validatorId));
+    BOOST_CHECK_EQUAL(after->Find(validatorId)->rewardMultiplier, trustManager.GetValidatorRewardMultiplier(validatorId));
+    BOOST_CHECK(GetStakerTrustTier(script, trustManager) == trustManager.GetValidatorTier(validatorId));
+
+    // Missed heartbeats lower the tier at the next block
+    const int height = params.nHeartbeatInterval * 100;
+    trustManager.UpdateHeartbeatExpectations(height);
+    BOOST_CHECK_EQUAL(trustManager.GetTierSnapshot()->height, height);
+    BOOST_CHECK(trustManager.GetTierSnapshot()->GetTier(validatorId) == trustManager.GetValidatorTier(validatorId));
+    BOOST_CHECK_EQUAL(trustManager.GetTierSnapshot()->Find(validatorId)->uptime, trustManager.GetValidator(validatorId)->GetUptimePercentage());
+}
+
+BOOST_AUTO_TEST_CASE(stake_split_plan)
+{
+    // Without a network weight the static thresholds apply
+    StakeSplitPlan plan = GetStakeSplitPlan(0, 1000 * COIN, 500, 32);
+    BOOST_CHECK_EQUAL(plan.nTargetValue, GetStakeCombineThreshold());
+    BOOST_CHECK_EQUAL(plan.SplitOutputs(GetStakeSplitThreshold() - 1), 1U);
+    BOOST_CHECK_EQUAL(plan.SplitOutputs(GetStakeSplitThreshold()), GetStakeSplitOutputs());
+    BOOST_CHECK_EQUAL(plan.dExpectedStakesPerDay, 0);
+
+    // Outputs small enough that the stakes won during the maturity lock a tenth of the weight
+    const uint64_t network_weight = 10000000 * COIN;
+    plan = GetStakeSplitPlan(network_weight, 100000 * COIN, 500, 32);
+    BOOST_CHECK_EQUAL(plan.nTargetValue, 2000 * COIN);
+    BOOST_CHECK_CLOSE(plan.dLockedShare, STAKE_SPLIT_LOCKED_SHARE, 0.001);
+    BOOST_CHECK_CLOSE(plan.dExpectedStakesPerDay, 0.01 * 86400 / 32, 0.001);
+    BOOST_CHECK_EQUAL(plan.SplitOutputs(3 * plan.nTargetValue + 1), 3U);
+    BOOST_CHECK_EQUAL(plan.SplitOutputs(100 * plan.nTargetValue), MAX_STAKE_SPLIT_OUTPUTS);
+
+    // Large wallets are not split into more outputs than the kernel search should go through
+    const uint64_t weight = network_weight / 2;
+    plan = GetStakeSplitPlan(network_weight, weight, 500, 32);
+    BOOST_CHECK_EQUAL(plan.nTargetValue, (int64_t)(weight / STAKE_SPLIT_MAX_WALLET_OUTPUTS));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,10 +4,16 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <chainparams.h>
 #include <privacy/stealth.h>
 #include <privacy/ring_signature.h>
 #include <privacy/confidential.h>
+#include <privacy/consensus.h>
 #include <privacy/privacy.h>
+#include <privacy/keyimage_db.h>
+#include <privacy/fcmp_consensus.h>
+#include <policy/policy.h>
+#include <script/solver.h>
 #include <key.h>
 #include <random.h>
 #include <secp256k1.h>
@@ -228,6 +234,40 @@ BOOST_AUTO_TEST_CASE(range_proof_aggregated)
     BOOST_CHECK(verifySuccess);
 }
 
+BOOST_AUTO_TEST_CASE(range_proof_batch)
+{
+    // Proofs from several "transactions" verified as one batch
+    privacy::CRangeProofBatch batch;
+    BOOST_CHECK(batch.Verify());
+
+    std::vector<privacy::CPedersenCommitment> commitments;
+    std::vector<privacy::CRangeProof> proofs;
+    for (CAmount amount : {CAmount{0}, CAmount{1}, CAmount{100000000}, CAmount{2100000000000000}}) {
+        privacy::CBlindingFactor blind = privacy::CBlindingFactor::Random();
+        privacy::CPedersenCommitment commitment;
+        privacy::CRangeProof proof;
+        BOOST_REQUIRE(privacy::CreateCommitment(amount, blind, commitment));
+        BOOST_REQUIRE(privacy::CreateRangeProof(amount, blind, commitment, proof));
+        BOOST_CHECK(batch.Add(commitment, proof));
+        commitments.push_back(commitment);
+        proofs.push_back(proof);
+    }
+    BOOST_CHECK_EQUAL(batch.Size(), 4U);
+    BOOST_CHECK(batch.Verify());
+
+    // A proof checked against another output's commitment fails the batch
+    privacy::CRangeProofBatch bad_batch;
+    BOOST_CHECK(bad_batch.Add(commitments[0], proofs[0]));
+    BOOST_CHECK(bad_batch.Add(commitments[2], proofs[3]));
+    BOOST_CHECK(bad_batch.Add(commitments[1], proofs[1]));
+    BOOST_CHECK(!bad_batch.Verify());
+
+    // Malformed proofs are rejected when added
+    privacy::CRangeProof truncated{proofs[0]};
+    truncated.data.resize(100);
+    BOOST_CHECK(!bad_batch.Add(commitments[0], truncated));
+}
+
 BOOST_AUTO_TEST_CASE(commitment_homomorphic)
 {
     // Test that commitments are homomorphic: C(a) + C(b) == C(a+b)
@@ -538,6 +578,105 @@ BOOST_AUTO_TEST_CASE(key_image_double_spend_prevention)
     BOOST_CHECK(privacy::IsKeyImageSpent(keyImage));
 }
 
+BOOST_AUTO_TEST_CASE(key_image_spent_twice_in_block)
+{
+    // Regression test: the key images of a block only reach the database
+    // after the block is connected, so two transactions of one block
+    // spending the same key image must be caught within the block
+    auto make_tx = [](const std::vector<privacy::CKeyImage>& key_images) {
+        privacy::CPrivacyTransaction tx;
+        tx.privacyType = privacy::PrivacyType::RINGCT;
+        for (const auto& key_image : key_images) {
+            privacy::CPrivacyInput input;
+            input.keyImage = key_image;
+            tx.privacyInputs.push_back(input);
+        }
+        return tx;
+    };
+    auto make_key_image = []() {
+        CKey key;
+        key.MakeNewKey(true);
+        privacy::CKeyImage key_image;
+        BOOST_REQUIRE(privacy::GenerateKeyImage(key, key.GetPubKey(), key_image));
+        return key_image;
+    };
+    const privacy::CKeyImage ki_a{make_key_image()};
+    const privacy::CKeyImage ki_b{make_key_image()};
+    const privacy::CKeyImage ki_c{make_key_image()};
+
+    std::set<uint256> block_key_images;
+    TxValidationState state;
+    BOOST_CHECK(privacy::CheckPrivacyKeyImagesUniqueInBlock(make_tx({ki_a, ki_b}), block_key_images, state));
+    BOOST_CHECK(privacy::CheckPrivacyKeyImagesUniqueInBlock(make_tx({ki_c}), block_key_images, state));
+    BOOST_CHECK_EQUAL(block_key_images.size(), 3U);
+
+    // A later transaction of the block spending ki_b again
+    BOOST_CHECK(!privacy::CheckPrivacyKeyImagesUniqueInBlock(make_tx({make_key_image(), ki_b}), block_key_images, state));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "privacy-key-image-spent");
+
+    // Transactions without ring inputs carry no key images to check
+    privacy::CPrivacyTransaction confidential{make_tx({ki_a})};
+    confidential.privacyType = privacy::PrivacyType::CONFIDENTIAL;
+    TxValidationState confidential_state;
+    BOOST_CHECK(privacy::CheckPrivacyKeyImagesUniqueInBlock(confidential, block_key_images, confidential_state));
+
+    // The rule is a soft fork: enforced on regtest, unscheduled on main
+    const auto main_params{CreateChainParams(ArgsManager{}, ChainType::MAIN)};
+    BOOST_CHECK(!main_params->GetConsensus().IsPrivacyKeyImageUniqueActive(1000000));
+    const auto regtest_params{CreateChainParams(ArgsManager{}, ChainType::REGTEST)};
+    BOOST_CHECK(regtest_params->GetConsensus().IsPrivacyKeyImageUniqueActive(0));
+}
+
+BOOST_AUTO_TEST_CASE(key_image_filter)
+{
+    privacy::CKeyImageFilter filter(1000);
+    std::vector<uint256> inserted;
+    for (int i = 0; i < 1000; ++i) {
+        inserted.push_back(m_rng.rand256());
+        filter.Insert(inserted.back());
+    }
+    BOOST_CHECK_EQUAL(filter.GetCount(), 1000U);
+
+    // No false negatives
+    for (const uint256& hash : inserted) {
+        BOOST_CHECK(filter.MayContain(hash));
+    }
+
+    // Few false positives at the sized capacity
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        false_positives += filter.MayContain(m_rng.rand256());
+    }
+    BOOST_CHECK(false_positives < 100);
+}
+
+BOOST_AUTO_TEST_CASE(key_image_spend_db)
+{
+    privacy::CKeyImageSpendDB db(m_args.GetDataDirBase() / "keyimages", 1 << 20, /*fMemory=*/true, /*fWipe=*/false, 'k');
+
+    // Enough spends to outgrow the initial filter and rebuild it
+    std::vector<std::pair<uint256, privacy::CKeyImageEntry>> spends;
+    for (int i = 0; i < 70000; ++i) {
+        spends.emplace_back(m_rng.rand256(), privacy::CKeyImageEntry{m_rng.rand256(), i});
+    }
+    BOOST_CHECK(db.WriteSpends(spends));
+
+    for (const auto& [hash, entry] : spends) {
+        BOOST_CHECK(db.IsSpent(hash));
+    }
+    privacy::CKeyImageEntry read;
+    BOOST_CHECK(db.ReadSpend(spends[123].first, read));
+    BOOST_CHECK(read.txHash == spends[123].second.txHash);
+    BOOST_CHECK_EQUAL(read.blockHeight, 123);
+    BOOST_CHECK(!db.IsSpent(m_rng.rand256()));
+
+    // Erased key images are unspent again although the filter still has them
+    BOOST_CHECK(db.EraseSpends({spends[0].first, spends[1].first}));
+    BOOST_CHECK(!db.IsSpent(spends[0].first));
+    BOOST_CHECK(!db.IsSpent(spends[1].first));
+    BOOST_CHECK(db.IsSpent(spends[2].first));
+}
+
 BOOST_AUTO_TEST_CASE(key_image_deterministic_generation)
 {
     // Test that key images are deterministic for same key
@@ -800,4 +939,53 @@ BOOST_AUTO_TEST_CASE(stealth_address_full_flow)
     BOOST_CHECK(stealthOutput.oneTimePubKey.Verify(message, signature));
 }
 
+BOOST_AUTO_TEST_CASE(fcmp_shield_script_batch)
+{
+    std::vector<curvetree::OutputTuple> outputs(privacy::MAX_FCMP_SHIELD_OUTPUTS);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        outputs[i].O.data.fill(3 * i + 1);
+        outputs[i].I.data.fill(3 * i + 2);
+        outputs[i].C.data.fill(3 * i + 3);
+    }
+
+    // One output, as shielded by the single recipient path, and a full batch
+    for (size_t count : {size_t{1}, privacy::MAX_FCMP_SHIELD_OUTPUTS}) {
+        const std::vector<curvetree::OutputTuple> batch(outputs.begin(), outputs.begin() + count);
+        const CScript script = privacy::BuildFcmpShieldScript(batch);
+        const auto parsed = privacy::ParseFcmpShieldScript(script);
+        BOOST_REQUIRE_EQUAL(parsed.size(), count);
+        for (size_t i = 0; i < count; i++) {
+            BOOST_CHECK(parsed[i].O == batch[i].O);
+            BOOST_CHECK(parsed[i].I == batch[i].I);
+            BOOST_CHECK(parsed[i].C == batch[i].C);
+        }
+
+        // Relayed even past -datacarriersize, but not with data carriers off
+        TxoutType type;
+        BOOST_CHECK(IsStandard(script, MAX_OP_RETURN_RELAY, type));
+        BOOST_CHECK(type == TxoutType::NULL_DATA);
+        BOOST_CHECK(!IsStandard(script, std::nullopt, type));
+    }
+    BOOST_CHECK_EQUAL(privacy::BuildFcmpShieldScript(outputs).size(), MAX_FCMP_SHIELD_RELAY);
+
+    // Other data of that size is still limited by -datacarriersize
+    CScript other;
+    other << OP_RETURN << std::vector<uint8_t>(4 + 96 * 2, 0x46);
+    TxoutType type;
+    BOOST_CHECK(!IsStandard(other, MAX_OP_RETURN_RELAY, type));
+
+    // Malformed shield scripts carry no outputs
+    outputs.push_back(outputs.front());
+    BOOST_CHECK(privacy::ParseFcmpShieldScript(privacy::BuildFcmpShieldScript(outputs)).empty());
+    BOOST_CHECK(privacy::ParseFcmpShieldScript(privacy::BuildFcmpShieldScript({})).empty());
+    CScript truncated;
+    std::vector<uint8_t> payload{'F', 'C', 'M', 'P'};
+    payload.resize(4 + 96 + 95);
+    truncated << OP_RETURN << payload;
+    BOOST_CHECK(privacy::ParseFcmpShieldScript(truncated).empty());
+    CScript trailing = privacy::BuildFcmpShieldScript({outputs.front()});
+    trailing << OP_TRUE;
+    BOOST_CHECK(privacy::ParseFcmpShieldScript(trailing).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
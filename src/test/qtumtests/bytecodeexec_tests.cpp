@@ -387,6 +387,60 @@ BOOST_AUTO_TEST_CASE(bytecodeexec_contract_create_contracts){
     BOOST_CHECK(result.second.valueTransfers.size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(bytecodeexec_private_state){
+    genesisLoading();
+    QtumTransaction txEthCreate = createQtumTransaction(CODE[0], 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address());
+    executeBC(std::vector<QtumTransaction>(1, txEthCreate), *m_node.chainman);
+    dev::Address newAddress(createQtumAddress(txEthCreate.getHashWith(), txEthCreate.getNVout()));
+    const dev::h256 stateRoot = globalState->rootHash();
+    const dev::h256 utxoRoot = globalState->rootHashUTXO();
+
+    // A state over copies of the global databases, as used for read-only calls
+    QtumState state(dev::u256(0), globalState->db(), globalState->dbUtxo());
+    state.setRoot(stateRoot);
+    state.setRootUTXO(utxoRoot);
+    BOOST_CHECK(state.addressInUse(newAddress));
+    dev::eth::ChainParams cp(Params().EVMGenesisInfo());
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine(cp.createSealEngine());
+
+    std::vector<QtumTransaction> txs;
+    txs.push_back(createQtumTransaction(valtype(), 0, GASLIMIT, dev::u256(1), HASHTX, newAddress));
+    txs.push_back(createQtumTransaction(valtype(), 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address("abababababababababababababababababababab"), 1));
+    CBlock block(generateBlock());
+    ChainstateManager& chainman = *m_node.chainman;
+    LOCK(cs_main);
+    ByteCodeExec exec(block, txs, GASLIMIT.convert_to<uint64_t>() * 2, chainman.ActiveChain().Tip(), chainman.ActiveChain(), state, *sealEngine);
+    BOOST_CHECK(exec.performByteCode(dev::eth::Permanence::Reverted));
+    BOOST_REQUIRE(exec.getResult().size() == 2);
+    BOOST_CHECK(exec.getResult()[0].execRes.excepted == dev::eth::TransactionException::None);
+    BOOST_CHECK(exec.getResult()[1].execRes.excepted == dev::eth::TransactionException::Unknown);
+    BOOST_CHECK(sealEngine->deleteAddresses.empty());
+
+    // The global state is untouched
+    BOOST_CHECK(globalState->rootHash() == stateRoot);
+    BOOST_CHECK(globalState->rootHashUTXO() == utxoRoot);
+}
+
+BOOST_AUTO_TEST_CASE(bytecodeexec_shared_cache){
+    genesisLoading();
+    auto cache = std::make_shared<dev::eth::StateCache>(1 << 20);
+    globalState->setSharedCache(cache);
+    QtumTransaction txEthCreate = createQtumTransaction(CODE[0], 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address());
+    executeBC(std::vector<QtumTransaction>(1, txEthCreate), *m_node.chainman);
+    dev::Address newAddress(createQtumAddress(txEthCreate.getHashWith(), txEthCreate.getNVout()));
+    BOOST_CHECK(globalState->addressInUse(newAddress));
+    BOOST_CHECK(cache->memoryUsage() > 0);
+
+    // A state without the cache reads the same accounts from the trie
+    QtumState state(dev::u256(0), globalState->db(), globalState->dbUtxo());
+    state.setRoot(globalState->rootHash());
+    state.setRootUTXO(globalState->rootHashUTXO());
+    BOOST_CHECK(state.addressInUse(newAddress));
+    BOOST_CHECK(state.code(newAddress) == globalState->code(newAddress));
+    BOOST_CHECK(state.balance(SENDERADDRESS) == globalState->balance(SENDERADDRESS));
+    globalState->setSharedCache(nullptr);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -0,0 +1,23 @@
+#include <boost/test/unit_test.hpp>
+#include <qtum/evmprefetch.h>
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+
+BOOST_FIXTURE_TEST_SUITE(evmprefetch_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(constant_storage_keys){
+    // PUSH1 1 SLOAD, PUSH0 SLOAD, PUSH2 0x0102 SLOAD, PUSH1 1 SLOAD again, CALLER SLOAD
+    const dev::bytes code = ParseHex("600154" "5f54" "61010254" "600154" "3354");
+    std::vector<dev::u256> keys = EvmStatePrefetcher::ConstantStorageKeys(code, EvmStatePrefetcher::MAX_CONSTANT_SLOTS);
+    BOOST_CHECK(keys == std::vector<dev::u256>({1, 0, 0x0102}));
+
+    BOOST_CHECK_EQUAL(EvmStatePrefetcher::ConstantStorageKeys(code, 2).size(), 2U);
+
+    // The pushed bytes are data, not an SLOAD after a push
+    BOOST_CHECK(EvmStatePrefetcher::ConstantStorageKeys(ParseHex("615454605454"), 8) == std::vector<dev::u256>({0x54}));
+
+    // A push cut off by the end of the code
+    BOOST_CHECK(EvmStatePrefetcher::ConstantStorageKeys(ParseHex("6301"), 8).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+#include <boost/test/unit_test.hpp>
+#include <chainparams.h>
+#include <qtum/evmstats.h>
+#include <test/qtumtests/test_utils.h>
+
+namespace EvmStatsTest{
+
+const dev::u256 GASLIMIT = dev::u256(500000);
+const dev::h256 HASHTX = dev::h256(ParseHex("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"));
+const dev::h256 HASHTX_CALL = dev::h256(ParseHex("bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"));
+
+// Reads slot 0, then writes 1 to it
+const valtype CODE = ParseHex("600a600c600039600a6000f3" "60005450600160005500");
+
+void genesisLoading(){
+    const CChainParams& chainparams = Params();
+    dev::eth::ChainParams cp(chainparams.EVMGenesisInfo(0x7fffffff));
+    globalState->populateFrom(cp.genesisState);
+    globalSealEngine = std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
+    globalState->db().commit();
+}
+
+std::optional<EvmContractStats> contractStats(const dev::Address& contract){
+    for(const auto& [address, stats] : GetEvmContractStats()){
+        if(address == contract) return stats;
+    }
+    return std::nullopt;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(evmstats_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(evmstats_per_contract){
+    using namespace EvmStatsTest;
+    genesisLoading();
+    ResetEvmContractStats();
+    const dev::Address contract = createQtumAddress(HASHTX, 0);
+    executeBC({createQtumTransaction(CODE, 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address())}, *m_node.chainman);
+    // Executions without a source are not counted
+    BOOST_CHECK(GetEvmContractStats().empty());
+
+    CBlock block(generateBlock());
+    const QtumTransaction tx = createQtumTransaction(valtype(), 0, GASLIMIT, dev::u256(1), HASHTX_CALL, contract);
+    for(int i = 0; i < 2; i++){
+        ByteCodeExec exec(block, {tx}, uint64_t(GASLIMIT), m_node.chainman->ActiveChain().Tip(), m_node.chainman->ActiveChain());
+        exec.setStatsSource(i == 0 ? EvmStatsSource::BLOCK : EvmStatsSource::CALL);
+        exec.performByteCode(dev::eth::Permanence::Reverted);
+    }
+
+    std::optional<EvmContractStats> stats = contractStats(contract);
+    BOOST_REQUIRE(stats);
+    BOOST_CHECK_EQUAL(stats->blockExecutions, 1U);
+    BOOST_CHECK_EQUAL(stats->callExecutions, 1U);
+    BOOST_CHECK(stats->gasUsed > 0);
+    BOOST_CHECK_EQUAL(stats->sloads, 2U);
+    BOOST_CHECK_EQUAL(stats->sstores, 2U);
+
+    ResetEvmContractStats();
+    BOOST_CHECK(GetEvmContractStats().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
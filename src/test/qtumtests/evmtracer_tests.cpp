@@ -0,0 +1,134 @@
+#include <boost/test/unit_test.hpp>
+#include <chainparams.h>
+#include <eth_client/libevm/EVMC.h>
+#include <qtum/evmtracer.h>
+#include <test/qtumtests/test_utils.h>
+#include <univalue.h>
+
+namespace EvmTracerTest{
+
+const dev::u256 GASLIMIT = dev::u256(500000);
+const dev::h256 HASHTX_CALLEE = dev::h256(ParseHex("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"));
+const dev::h256 HASHTX_CALLER = dev::h256(ParseHex("bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"));
+const dev::h256 HASHTX_CALL = dev::h256(ParseHex("cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc"));
+
+// Callee: returns 42 as a word
+const valtype CALLEE_CODE = ParseHex("600a600c600039600a6000f3" "602a60005260206000f3");
+
+// Caller: calls the callee without input and stores the success flag in slot 1
+valtype callerCode(const dev::Address& callee){
+    return ParseHex("6025600c60003960256000f3" "60206000600060006000" "73" + callee.hex() + "5af1600155" "00");
+}
+
+void genesisLoading(){
+    const CChainParams& chainparams = Params();
+    dev::eth::ChainParams cp(chainparams.EVMGenesisInfo(0x7fffffff));
+    globalState->populateFrom(cp.genesisState);
+    globalSealEngine = std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
+    globalState->db().commit();
+}
+
+template <typename Tracer>
+std::vector<ResultExecute> executeTraced(const QtumTransaction& tx, Tracer& tracer, ChainstateManager& chainman){
+    CBlock block(generateBlock());
+    QtumDGP qtumDGP(globalState.get(), chainman.ActiveChainstate(), fGettingValuesDGP);
+    uint64_t blockGasLimit = qtumDGP.getBlockGasLimit(chainman.ActiveChain().Tip()->nHeight + 1);
+    ByteCodeExec exec(block, {tx}, blockGasLimit, chainman.ActiveChain().Tip(), chainman.ActiveChain());
+    exec.setOnExecute([&](size_t){ tracer.BeginExecution(); });
+    {
+        dev::eth::ScopedEVMCTracer scope(tracer);
+        exec.performByteCode();
+    }
+    std::vector<ResultExecute> res = exec.getResult();
+    globalState->db().commit();
+    globalState->dbUtxo().commit();
+    return res;
+}
+
+std::string hex(const dev::Address& address){
+    return "0x" + address.hex();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(evmtracer_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(json_text_writer){
+    std::string json;
+    JsonTextWriter out(json);
+    out.BeginObject();
+    out.Key("a");
+    out.BeginArray();
+    out.Number(1);
+    out.Quantity(0);
+    out.Quantity(255);
+    out.EndArray();
+    out.Key("b");
+    out.String("q\"\\\n");
+    out.Key("c");
+    const uint8_t bytes[] = {0x00, 0xab};
+    out.Hex(bytes, sizeof(bytes));
+    out.Key("d");
+    out.BeginObject();
+    out.EndObject();
+    out.EndObject();
+    BOOST_CHECK_EQUAL(json, "{\"a\":[1,\"0x0\",\"0xff\"],\"b\":\"q\\\"\\\\\\u000a\",\"c\":\"0x00ab\",\"d\":{}}");
+
+    UniValue value;
+    BOOST_CHECK(value.read(json));
+}
+
+BOOST_AUTO_TEST_CASE(call_and_prestate_tracers){
+    using namespace EvmTracerTest;
+    genesisLoading();
+    const dev::Address callee = createQtumAddress(HASHTX_CALLEE, 0);
+    const dev::Address caller = createQtumAddress(HASHTX_CALLER, 0);
+    executeBC({createQtumTransaction(CALLEE_CODE, 0, GASLIMIT, dev::u256(1), HASHTX_CALLEE, dev::Address())}, *m_node.chainman);
+    executeBC({createQtumTransaction(callerCode(callee), 0, GASLIMIT, dev::u256(1), HASHTX_CALLER, dev::Address())}, *m_node.chainman);
+    BOOST_REQUIRE(!globalState->code(caller).empty());
+
+    const QtumTransaction tx = createQtumTransaction(valtype(), 0, GASLIMIT, dev::u256(1), HASHTX_CALL, caller);
+    EvmCallTracer callTracer(/*onlyTopCall=*/false);
+    std::vector<ResultExecute> res = executeTraced(tx, callTracer, *m_node.chainman);
+    BOOST_REQUIRE_EQUAL(res.size(), 1U);
+    BOOST_CHECK(res[0].execRes.excepted == dev::eth::TransactionException::None);
+
+    std::string json;
+    JsonTextWriter out(json);
+    callTracer.WriteExecution(0, tx, res[0].execRes, out);
+    UniValue trace;
+    BOOST_REQUIRE(trace.read(json));
+    BOOST_CHECK_EQUAL(trace["type"].get_str(), "CALL");
+    BOOST_CHECK_EQUAL(trace["to"].get_str(), hex(caller));
+    BOOST_CHECK_EQUAL(trace["gasUsed"].get_str(), strprintf("0x%x", uint64_t(res[0].execRes.gasUsed)));
+    BOOST_CHECK(trace.find_value("error").isNull());
+    const UniValue& calls = trace["calls"];
+    BOOST_REQUIRE_EQUAL(calls.size(), 1U);
+    BOOST_CHECK_EQUAL(calls[0]["type"].get_str(), "CALL");
+    BOOST_CHECK_EQUAL(calls[0]["from"].get_str(), hex(caller));
+    BOOST_CHECK_EQUAL(calls[0]["to"].get_str(), hex(callee));
+    BOOST_CHECK_EQUAL(calls[0]["input"].get_str(), "0x");
+    BOOST_CHECK_EQUAL(calls[0]["output"].get_str(), "0x" + std::string(62, '0') + "2a");
+
+    // Slot 1 holds the flag stored by the traced call
+    EvmPrestateTracer prestateTracer;
+    const QtumTransaction tx2 = createQtumTransaction(valtype(), 0, GASLIMIT, dev::u256(1), HASHTX_CALL, caller, 1);
+    res = executeTraced(tx2, prestateTracer, *m_node.chainman);
+    BOOST_REQUIRE_EQUAL(res.size(), 1U);
+
+    json.clear();
+    JsonTextWriter out2(json);
+    prestateTracer.WriteExecution(0, tx2, *globalState, out2);
+    UniValue prestate;
+    BOOST_REQUIRE(prestate.read(json));
+    BOOST_CHECK(prestate.exists(hex(tx2.sender())));
+    BOOST_REQUIRE(prestate.exists(hex(callee)));
+    BOOST_CHECK(prestate[hex(callee)].exists("code"));
+    BOOST_REQUIRE(prestate.exists(hex(caller)));
+    const UniValue& storage = prestate[hex(caller)]["storage"];
+    const std::string slot = "0x" + std::string(63, '0') + "1";
+    BOOST_REQUIRE(storage.exists(slot));
+    BOOST_CHECK_EQUAL(storage[slot].get_str(), slot);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
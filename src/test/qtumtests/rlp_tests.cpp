@@ -0,0 +1,131 @@
+#include <boost/test/unit_test.hpp>
+#include <libdevcore/CommonData.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/StateCacheDB.h>
+#include <libdevcore/TrieDB.h>
+
+#include <array>
+
+namespace rlpTest{
+
+template <class T>
+dev::bytes writerEncode(T const& value){
+    std::array<dev::byte, 1100> buffer;
+    dev::RLPWriter writer(dev::bytesRef(buffer.data(), buffer.size()));
+    writer << value;
+    BOOST_CHECK_EQUAL(writer.out().size(), dev::rlpSize(value));
+    return writer.out().toBytes();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(rlp_tests)
+
+BOOST_AUTO_TEST_CASE(rlp_integers){
+    using namespace rlpTest;
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(dev::u256(0))), "80");
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(dev::u256(0x7f))), "7f");
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(dev::u256(0x80))), "8180");
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(dev::u256(0x0400))), "820400");
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(dev::u160(0x0400))), "820400");
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(1024u)), "820400");
+
+    dev::u256 values[] = {0, 1, 0x7f, 0x80, 0xff, 0x100, dev::u256(1) << 128, (dev::u256(1) << 200) + 0x1234, ~dev::u256(0)};
+    for(const dev::u256& value : values){
+        dev::bytes stream = dev::rlp(value);
+        BOOST_CHECK(writerEncode(value) == stream);
+        BOOST_CHECK(dev::rlp(dev::bigint(value)) == stream);
+        BOOST_CHECK(dev::RLP(stream).toInt<dev::u256>() == value);
+    }
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp(~dev::u256(0))), "a0" + std::string(64, 'f'));
+}
+
+BOOST_AUTO_TEST_CASE(rlp_strings_and_lists){
+    using namespace rlpTest;
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp("")), "80");
+    BOOST_CHECK_EQUAL(dev::toHex(dev::rlp("dog")), "83646f67");
+
+    for(size_t size : {0, 1, 2, 55, 56, 255, 256, 1024}){
+        for(dev::byte fill : {0x00, 0x7f, 0x80}){
+            dev::bytes data(size, fill);
+            dev::bytes stream = dev::rlp(data);
+            BOOST_CHECK(writerEncode(dev::bytesConstRef(&data)) == stream);
+            BOOST_CHECK(dev::RLP(stream).toBytes() == data);
+        }
+    }
+
+    // Lists whose payload straddles the 55 byte short form.
+    for(size_t size : {1, 20, 52, 53, 54, 100}){
+        dev::bytes data(size, 0xaa);
+        dev::RLPStream stream(2);
+        stream << dev::u256(7) << data;
+
+        std::array<dev::byte, 128> buffer;
+        dev::RLPWriter writer(dev::bytesRef(buffer.data(), buffer.size()));
+        size_t payload = dev::rlpSize(dev::u256(7)) + dev::rlpSize(dev::bytesConstRef(&data));
+        writer.appendList(payload) << dev::u256(7) << dev::bytesConstRef(&data);
+        BOOST_CHECK_EQUAL(writer.out().size(), dev::rlpPrefixSize(payload) + payload);
+        BOOST_CHECK(writer.out().toBytes() == stream.out());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rlp_account){
+    // Same shape as the accounts written by dev::eth::commit.
+    dev::u256 nonce = 3;
+    dev::u256 balance = dev::u256(1) << 100;
+    dev::h256 storageRoot = dev::sha3(dev::rlp(1u));
+    dev::h256 codeHash = dev::sha3(dev::rlp(2u));
+    dev::u256 version = 1;
+
+    dev::RLPStream stream(5);
+    stream << nonce << balance << storageRoot << codeHash << version;
+
+    std::array<dev::byte, 2 + 5 * 33> buffer;
+    dev::RLPWriter writer(dev::bytesRef(buffer.data(), buffer.size()));
+    writer.appendList(dev::rlpSize(nonce) + dev::rlpSize(balance) + dev::rlpSize(storageRoot) + dev::rlpSize(codeHash) + dev::rlpSize(version));
+    writer << nonce << balance << storageRoot << codeHash << version;
+    BOOST_CHECK(writer.out().toBytes() == stream.out());
+
+    dev::RLP account(writer.out());
+    BOOST_CHECK_EQUAL(account.itemCount(), 5U);
+    BOOST_CHECK(account[1].toInt<dev::u256>() == balance);
+    BOOST_CHECK(account[3].toHash<dev::h256>() == codeHash);
+}
+
+BOOST_AUTO_TEST_CASE(rlp_writer_overflow){
+    std::array<dev::byte, 4> buffer;
+    dev::RLPWriter writer(dev::bytesRef(buffer.data(), buffer.size()));
+    writer << dev::u256(0x0400);
+    BOOST_CHECK_THROW(writer << dev::u256(0x0400), dev::RLPException);
+}
+
+BOOST_AUTO_TEST_CASE(trie_proofs){
+    dev::StateCacheDB db;
+    dev::GenericTrieDB<dev::StateCacheDB> trie(&db);
+    trie.init();
+    for(unsigned i = 0; i < 300; i++){
+        dev::bytes value(i % 70 + 1, dev::byte(i));
+        trie.insert(dev::sha3(dev::rlp(i)).ref(), dev::bytesConstRef(&value));
+    }
+
+    for(unsigned i : {0u, 1u, 150u, 299u, 300u, 1000u}){
+        dev::h256 key = dev::sha3(dev::rlp(i));
+        std::vector<dev::bytes> proof;
+        std::string value = trie.prove(key.ref(), proof);
+        BOOST_CHECK_EQUAL(value, trie.at(key.ref()));
+        BOOST_CHECK_EQUAL(value.empty(), i >= 300);
+        BOOST_REQUIRE(!proof.empty());
+        BOOST_CHECK(dev::sha3(proof.front()) == trie.root());
+
+        // The proof alone is enough to look the key up again.
+        dev::StateCacheDB proofDB;
+        for(const dev::bytes& node : proof){
+            proofDB.insert(dev::sha3(node), dev::bytesConstRef(&node));
+        }
+        dev::GenericTrieDB<dev::StateCacheDB> proofTrie(&proofDB, trie.root());
+        BOOST_CHECK_EQUAL(proofTrie.at(key.ref()), value);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
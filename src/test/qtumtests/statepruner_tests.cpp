@@ -0,0 +1,175 @@
+#include <boost/test/unit_test.hpp>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/TrieDB.h>
+#include <qtum/qtumstate.h>
+#include <qtum/statepruner.h>
+#include <test/util/setup_common.h>
+#include <util/fs.h>
+
+#include <map>
+
+namespace statePrunerTest{
+
+using Trie = dev::GenericTrieDB<dev::OverlayDB>;
+
+const auto notInterrupted = [] { return false; };
+
+dev::h256 key(unsigned i){
+    return dev::sha3(dev::rlp(i));
+}
+
+void checkTrie(dev::OverlayDB& db, const dev::h256& root, const std::map<dev::h256, std::string>& values){
+    Trie trie(&db);
+    trie.setRoot(root);
+    for(const auto& [k, v] : values){
+        BOOST_CHECK_EQUAL(trie.at(k.ref()), v);
+    }
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(statepruner_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(prune_unreachable_nodes){
+    using namespace statePrunerTest;
+    dev::OverlayDB db = QtumState::openDB(fs::PathToString(m_path_root / "state"), dev::h256(), dev::WithExisting::Trust);
+
+    Trie trie(&db);
+    trie.init();
+    std::map<dev::h256, std::string> values;
+    for(unsigned i = 0; i < 200; i++){
+        values[key(i)] = std::string(40, char(i));
+        trie.insert(key(i).ref(), dev::bytesConstRef(&values[key(i)]));
+    }
+    const dev::h256 oldRoot = trie.root();
+    db.commit();
+
+    for(unsigned i = 0; i < 50; i++){
+        values[key(i)] = std::string(40, char(i + 1));
+        trie.insert(key(i).ref(), dev::bytesConstRef(&values[key(i)]));
+    }
+    const dev::h256 root = trie.root();
+    db.commit();
+
+    // Nodes written after tracking started are kept even though the roots do not reach them
+    db.setWriteTracking(true);
+    const std::string value("new");
+    trie.insert(key(1000).ref(), dev::bytesConstRef(&value));
+    const dev::h256 newRoot = trie.root();
+    db.commit();
+
+    std::optional<size_t> killed = PruneStateDB(db, {root}, /*accounts=*/false, notInterrupted);
+    db.setWriteTracking(false);
+    BOOST_REQUIRE(killed);
+    BOOST_CHECK(*killed > 0);
+    BOOST_CHECK(!db.exists(oldRoot));
+    BOOST_CHECK(db.exists(newRoot));
+    checkTrie(db, root, values);
+
+    // Nothing is left to collect
+    db.setWriteTracking(true);
+    BOOST_CHECK_EQUAL(PruneStateDB(db, {root, newRoot}, /*accounts=*/false, notInterrupted).value_or(1), 0U);
+    db.setWriteTracking(false);
+
+    // A root that is not on disk leaves the database alone
+    db.setWriteTracking(true);
+    BOOST_CHECK(!PruneStateDB(db, {oldRoot}, /*accounts=*/false, notInterrupted));
+    db.setWriteTracking(false);
+    checkTrie(db, root, values);
+}
+
+BOOST_AUTO_TEST_CASE(prune_keeps_account_storage_and_code){
+    using namespace statePrunerTest;
+    dev::OverlayDB db = QtumState::openDB(fs::PathToString(m_path_root / "state"), dev::h256(), dev::WithExisting::Trust);
+
+    Trie storage(&db);
+    storage.init();
+    std::map<dev::h256, std::string> slots;
+    for(unsigned i = 0; i < 100; i++){
+        slots[key(i)] = dev::asString(dev::rlp(dev::u256(i + 1) << 200));
+        storage.insert(key(i).ref(), dev::bytesConstRef(&slots[key(i)]));
+    }
+    const dev::bytes code(100, 0x5b);
+    const dev::h256 codeHash = dev::sha3(code);
+    db.insert(codeHash, dev::bytesConstRef(&code));
+
+    dev::RLPStream account(4);
+    account << dev::u256(0) << dev::u256(0) << storage.root() << codeHash;
+    Trie accounts(&db);
+    accounts.init();
+    accounts.insert(key(0).ref(), dev::bytesConstRef(&account.out()));
+    const dev::h256 root = accounts.root();
+    db.commit();
+
+    // Storage the account does not point to
+    const std::string garbage(40, 'x');
+    storage.insert(key(500).ref(), dev::bytesConstRef(&garbage));
+    const dev::h256 orphanRoot = storage.root();
+    db.commit();
+
+    db.setWriteTracking(true);
+    std::optional<size_t> killed = PruneStateDB(db, {root}, /*accounts=*/true, notInterrupted);
+    db.setWriteTracking(false);
+    BOOST_REQUIRE(killed);
+    BOOST_CHECK(*killed > 0);
+    BOOST_CHECK(!db.exists(orphanRoot));
+    BOOST_CHECK(db.exists(codeHash));
+    checkTrie(db, dev::RLP(accounts.at(key(0).ref()))[2].toHash<dev::h256>(), slots);
+}
+
+BOOST_AUTO_TEST_CASE(walk_copies_reachable_state){
+    using namespace statePrunerTest;
+    dev::OverlayDB db = QtumState::openDB(fs::PathToString(m_path_root / "state"), dev::h256(), dev::WithExisting::Trust);
+
+    Trie storage(&db);
+    storage.init();
+    std::map<dev::h256, std::string> slots;
+    for(unsigned i = 0; i < 100; i++){
+        slots[key(i)] = dev::asString(dev::rlp(dev::u256(i + 1) << 200));
+        storage.insert(key(i).ref(), dev::bytesConstRef(&slots[key(i)]));
+    }
+    const dev::bytes code(100, 0x5b);
+    const dev::h256 codeHash = dev::sha3(code);
+    db.insert(codeHash, dev::bytesConstRef(&code));
+
+    dev::RLPStream account(4);
+    account << dev::u256(0) << dev::u256(0) << storage.root() << codeHash;
+    Trie accounts(&db);
+    accounts.init();
+    accounts.insert(key(0).ref(), dev::bytesConstRef(&account.out()));
+    const dev::h256 root = accounts.root();
+    db.commit();
+
+    // The nodes a snapshot would carry are enough to rebuild the state
+    dev::OverlayDB copy = QtumState::openDB(fs::PathToString(m_path_root / "copy"), dev::h256(), dev::WithExisting::Trust);
+    dev::h256Hash visited;
+    BOOST_REQUIRE(WalkStateDB(db, {root}, /*accounts=*/true, visited, [&](const dev::h256& hash, const std::string& node) {
+        BOOST_CHECK_EQUAL(dev::sha3(node), hash);
+        copy.insert(hash, dev::bytesConstRef(&node));
+        return true;
+    }, notInterrupted));
+    copy.commit();
+    BOOST_CHECK(copy.exists(codeHash));
+    Trie copied(&copy);
+    copied.setRoot(root);
+    checkTrie(copy, dev::RLP(copied.at(key(0).ref()))[2].toHash<dev::h256>(), slots);
+
+    dev::h256Hash checked;
+    BOOST_CHECK(WalkStateDB(copy, {root}, /*accounts=*/true, checked, {}, notInterrupted));
+    BOOST_CHECK(checked == visited);
+
+    // A missing node fails the walk
+    dev::OverlayDB partial = QtumState::openDB(fs::PathToString(m_path_root / "partial"), dev::h256(), dev::WithExisting::Trust);
+    for(const dev::h256& hash : visited){
+        if(hash != storage.root()){
+            const std::string node = db.lookup(hash);
+            partial.insert(hash, dev::bytesConstRef(&node));
+        }
+    }
+    partial.commit();
+    checked.clear();
+    BOOST_CHECK(!WalkStateDB(partial, {root}, /*accounts=*/true, checked, {}, notInterrupted));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -641,4 +641,68 @@ BOOST_AUTO_TEST_CASE(rpc_arg_helper)
     CheckRpc(params, UniValue{JSON(R"([5, "hello", 4, "test", true, 1.23, "world"])")}, check_positional);
 }
 
+//! A transport that streams everything into a string, flushing in the pieces it is given
+class StreamingTestRequest : public JSONRPCRequest
+{
+public:
+    mutable std::string out;
+    mutable size_t writes{0};
+    bool StreamStart() const override { isStreaming = true; return true; }
+    bool StreamWrite(const std::string& json) const override { out += json; ++writes; return true; }
+};
+
+static UniValue WriteTestResult(JSONRPCResultWriter& result)
+{
+    result.BeginObject();
+    result.KV("height", 7);
+    result.Key("logs");
+    result.BeginArray();
+    for (int i = 0; i < 3; ++i) {
+        UniValue log(UniValue::VOBJ);
+        log.pushKV("index", i);
+        result.Value(std::move(log));
+    }
+    result.End();
+    result.Key("empty");
+    result.BeginArray();
+    result.End();
+    result.KV("name", "a\"b");
+    result.End();
+    return result.Finish();
+}
+
+BOOST_AUTO_TEST_CASE(rpc_result_writer)
+{
+    const std::string expected{R"({"height":7,"logs":[{"index":0},{"index":1},{"index":2}],"empty":[],"name":"a\"b"})"};
+
+    // Collected into a UniValue when the transport doesn't stream
+    JSONRPCRequest plain;
+    JSONRPCResultWriter collected{plain};
+    const UniValue value{WriteTestResult(collected)};
+    BOOST_CHECK(!plain.isStreaming);
+    BOOST_CHECK_EQUAL(value.write(), expected);
+
+    // Streamed as the same JSON text otherwise
+    StreamingTestRequest streaming;
+    JSONRPCResultWriter streamed{streaming};
+    BOOST_CHECK(WriteTestResult(streamed).isNull());
+    BOOST_CHECK(streaming.isStreaming);
+    BOOST_CHECK_EQUAL(streaming.out, expected);
+    BOOST_CHECK_EQUAL(streaming.writes, 1U);
+
+    // Large results go out in several pieces
+    StreamingTestRequest large;
+    JSONRPCResultWriter writer{large};
+    writer.BeginArray();
+    for (int i = 0; i < 20000; ++i) {
+        writer.Value(std::string(10, 'x'));
+    }
+    writer.End();
+    BOOST_CHECK(writer.Finish().isNull());
+    BOOST_CHECK_GT(large.writes, 1U);
+    UniValue parsed;
+    BOOST_REQUIRE(parsed.read(large.out));
+    BOOST_CHECK_EQUAL(parsed.size(), 20000U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 
 #include <common/system.h>
 #include <core_io.h>
+#include <crypto/dilithium.h>
 #include <key.h>
 #include <rpc/util.h>
 #include <script/script.h>
@@ -1744,4 +1745,32 @@ BOOST_AUTO_TEST_CASE(compute_tapleaf)
     BOOST_CHECK_EQUAL(ComputeTapleafHash(0xc2, Span(script)), tlc2);
 }
 
+BOOST_AUTO_TEST_CASE(dilithium_signature_cache)
+{
+    // Random bytes of the right sizes: only a cache hit can make them verify
+    const std::vector<unsigned char> pubkey{m_rng.randbytes(dilithium::PUBLIC_KEY_SIZE)};
+    const std::vector<unsigned char> sig{m_rng.randbytes(dilithium::SIGNATURE_SIZE)};
+    const CScript script_pubkey = CScript() << pubkey << OP_CHECKSIG_DILITHIUM;
+    const CScript script_sig = CScript() << sig;
+
+    const CTransaction tx{BuildSpendingTransaction(script_sig, CScriptWitness(), CTransaction(BuildCreditingTransaction(script_pubkey, 1)))};
+    PrecomputedTransactionData txdata;
+    txdata.Init(tx, {CTxOut(1, script_pubkey)});
+    SignatureCache signature_cache{DEFAULT_SIGNATURE_CACHE_BYTES};
+
+    // The message is the hash of the executed script code
+    uint256 entry, ecdsa_entry;
+    signature_cache.ComputeEntryDilithium(entry, Hash(script_pubkey), sig, pubkey);
+    signature_cache.ComputeEntryECDSA(ecdsa_entry, Hash(script_pubkey), sig, CPubKey{});
+    BOOST_CHECK(entry != ecdsa_entry);
+
+    ScriptError err;
+    CachingTransactionSignatureChecker uncached{&tx, 0, 1, /*storeIn=*/false, signature_cache, txdata};
+    BOOST_CHECK(!VerifyScript(script_sig, script_pubkey, nullptr, SCRIPT_VERIFY_NONE, uncached, &err));
+
+    signature_cache.Set(entry);
+    CachingTransactionSignatureChecker checker{&tx, 0, 1, /*storeIn=*/false, signature_cache, txdata};
+    BOOST_CHECK(VerifyScript(script_sig, script_pubkey, nullptr, SCRIPT_VERIFY_NONE, checker, &err));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
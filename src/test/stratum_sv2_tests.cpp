@@ -0,0 +1,142 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <key.h>
+#include <random.h>
+#include <stratum/sv2_messages.h>
+#include <stratum/sv2_noise.h>
+#include <stratum/sv2_transport.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <vector>
+
+using namespace stratum;
+
+namespace {
+
+struct Sv2Pair {
+    CKey authority{GenerateRandomKey()};
+    CKey static_key{GenerateRandomKey()};
+    Sv2Certificate certificate;
+    uint32_t now{1'700'000'000};
+
+    Sv2Pair()
+    {
+        certificate.valid_from = now - 3600;
+        certificate.not_valid_after = now + 3600;
+        BOOST_REQUIRE(certificate.Sign(authority, XOnlyPubKey{static_key.GetPubKey()}));
+    }
+
+    //! Run the handshake, feeding bytes one at a time to exercise buffering
+    bool Handshake(Sv2Transport& miner, Sv2Transport& pool, uint32_t at)
+    {
+        std::vector<std::byte> reply, unused;
+        for (std::byte b : miner.Connect()) {
+            if (!pool.Receive(Span{&b, 1}, reply, at)) return false;
+        }
+        for (std::byte b : reply) {
+            if (!miner.Receive(Span{&b, 1}, unused, at)) return false;
+        }
+        return miner.Established() && pool.Established() && unused.empty();
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(stratum_sv2_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(message_round_trip)
+{
+    Sv2NewMiningJob job;
+    job.channel_id = 1;
+    job.job_id = 42;
+    job.version = 0x20000000;
+    job.merkle_root.assign(32, 0xab);
+
+    const std::vector<std::byte> frame = Sv2EncodeFrame(job);
+    const Sv2FrameHeader header = Sv2FrameHeader::Deserialize(frame.data());
+    BOOST_CHECK_EQUAL(header.extension_type, SV2_CHANNEL_MSG_BIT);
+    BOOST_CHECK_EQUAL(header.msg_type, static_cast<uint8_t>(Sv2MsgType::NEW_MINING_JOB));
+    // u32 + u32 + OPTION (1) + u32 + B0_32 (1 + 32)
+    BOOST_CHECK_EQUAL(header.msg_length, 4 + 4 + 1 + 4 + 33);
+    BOOST_REQUIRE_EQUAL(frame.size(), SV2_FRAME_HEADER_SIZE + header.msg_length);
+
+    Sv2NewMiningJob decoded;
+    BOOST_REQUIRE(Sv2DecodePayload(Span{frame}.subspan(SV2_FRAME_HEADER_SIZE), decoded));
+    BOOST_CHECK_EQUAL(decoded.job_id, 42U);
+    BOOST_CHECK(!decoded.min_ntime);
+    BOOST_CHECK_EQUAL(decoded.version, 0x20000000U);
+    BOOST_CHECK(decoded.merkle_root == job.merkle_root);
+
+    // Truncated or trailing bytes are refused
+    BOOST_CHECK(!Sv2DecodePayload(Span{frame}.subspan(SV2_FRAME_HEADER_SIZE + 1), decoded));
+    std::vector<std::byte> longer{frame.begin() + SV2_FRAME_HEADER_SIZE, frame.end()};
+    longer.push_back(std::byte{0});
+    BOOST_CHECK(!Sv2DecodePayload(longer, decoded));
+}
+
+BOOST_AUTO_TEST_CASE(handshake_and_encrypted_frames)
+{
+    Sv2Pair pair;
+    Sv2Transport miner{XOnlyPubKey{pair.authority.GetPubKey()}};
+    Sv2Transport pool{pair.static_key, pair.certificate};
+    BOOST_REQUIRE(pair.Handshake(miner, pool, pair.now));
+
+    Sv2SetupConnection setup;
+    setup.min_version = setup.max_version = 2;
+    setup.vendor = "test";
+    std::vector<std::byte> unused;
+    BOOST_REQUIRE(pool.Receive(miner.Seal(Sv2EncodeFrame(setup)), unused, pair.now));
+
+    Sv2Transport::Message message;
+    BOOST_REQUIRE(pool.NextMessage(message));
+    BOOST_CHECK_EQUAL(message.header.msg_type, static_cast<uint8_t>(Sv2MsgType::SETUP_CONNECTION));
+    Sv2SetupConnection received;
+    BOOST_REQUIRE(Sv2DecodePayload(message.payload, received));
+    BOOST_CHECK_EQUAL(received.vendor, "test");
+    BOOST_CHECK(!pool.NextMessage(message));
+
+    // Several frames in one read, the other way round
+    Sv2SetTarget target;
+    target.channel_id = 1;
+    target.maximum_target = GetRandHash();
+    std::vector<std::byte> stream = pool.Seal(Sv2EncodeFrame(target));
+    const std::vector<std::byte> second = pool.Seal(Sv2EncodeFrame(target));
+    stream.insert(stream.end(), second.begin(), second.end());
+    BOOST_REQUIRE(miner.Receive(stream, unused, pair.now));
+    for (int i = 0; i < 2; ++i) {
+        Sv2SetTarget got;
+        BOOST_REQUIRE(miner.NextMessage(message));
+        BOOST_REQUIRE(Sv2DecodePayload(message.payload, got));
+        BOOST_CHECK(got.maximum_target == target.maximum_target);
+    }
+
+    // A flipped bit fails the MAC
+    std::vector<std::byte> tampered = miner.Seal(Sv2EncodeFrame(setup));
+    tampered.back() ^= std::byte{1};
+    BOOST_CHECK(!pool.Receive(tampered, unused, pair.now));
+}
+
+BOOST_AUTO_TEST_CASE(handshake_rejects_bad_certificate)
+{
+    Sv2Pair pair;
+    {
+        // Certificate from another authority
+        Sv2Transport miner{XOnlyPubKey{GenerateRandomKey().GetPubKey()}};
+        Sv2Transport pool{pair.static_key, pair.certificate};
+        BOOST_CHECK(!pair.Handshake(miner, pool, pair.now));
+    }
+    {
+        // Expired certificate
+        Sv2Transport miner{XOnlyPubKey{pair.authority.GetPubKey()}};
+        Sv2Transport pool{pair.static_key, pair.certificate};
+        BOOST_CHECK(!pair.Handshake(miner, pool, pair.certificate.not_valid_after + 1));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
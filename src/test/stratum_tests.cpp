@@ -0,0 +1,400 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/merkle.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <stratum/coinbase_template.h>
+#include <stratum/job_payload.h>
+#include <stratum/mining_rewards.h>
+#include <stratum/rpc_client.h>
+#include <stratum/share_stats.h>
+#include <stratum/share_validation.h>
+#include <stratum/stratum_framing.h>
+#include <stratum/stratum_metrics.h>
+#include <stratum/vardiff.h>
+#include <tinyformat.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <string_view>
+#include <vector>
+
+using namespace stratum;
+
+static std::vector<std::string> DrainLines(StratumLineFramer& framer)
+{
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (framer.NextLine(line)) lines.emplace_back(line);
+    return lines;
+}
+
+static bool Feed(StratumLineFramer& framer, std::string_view data)
+{
+    return framer.Append(data.data(), data.size());
+}
+
+BOOST_AUTO_TEST_SUITE(stratum_tests)
+
+BOOST_AUTO_TEST_CASE(framer_splits_lines)
+{
+    StratumLineFramer framer(64);
+    BOOST_CHECK(Feed(framer, "{\"a\":1}\n\r\n{\"b\""));
+    auto lines = DrainLines(framer);
+    BOOST_REQUIRE_EQUAL(lines.size(), 1U);
+    BOOST_CHECK_EQUAL(lines[0], "{\"a\":1}");
+
+    // Partial message stays buffered until its newline arrives
+    BOOST_CHECK(Feed(framer, ":2}\r\n"));
+    lines = DrainLines(framer);
+    BOOST_REQUIRE_EQUAL(lines.size(), 1U);
+    BOOST_CHECK_EQUAL(lines[0], "{\"b\":2}");
+    BOOST_CHECK_EQUAL(framer.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(framer_wraps_and_overflows)
+{
+    StratumLineFramer framer(64);
+    BOOST_CHECK_EQUAL(framer.Capacity(), 64U);
+
+    // Push the read position close to the end so the next line wraps
+    std::string filler(50, 'x');
+    BOOST_CHECK(Feed(framer, filler + "\n"));
+    BOOST_CHECK_EQUAL(DrainLines(framer).size(), 1U);
+
+    std::string wrapped = "0123456789abcdefghijklmnopqrstuvwxyz";
+    BOOST_CHECK(Feed(framer, wrapped + "\n"));
+    auto lines = DrainLines(framer);
+    BOOST_REQUIRE_EQUAL(lines.size(), 1U);
+    BOOST_CHECK_EQUAL(lines[0], wrapped);
+
+    // A full ring without a newline is an overflow
+    std::string big(64, 'y');
+    BOOST_CHECK(Feed(framer, big));
+    BOOST_CHECK(DrainLines(framer).empty());
+    BOOST_CHECK(framer.Overflowed());
+    BOOST_CHECK(!Feed(framer, "z"));
+}
+
+BOOST_AUTO_TEST_CASE(parse_submit_xmrig)
+{
+    StratumSubmitView view;
+    BOOST_REQUIRE(ParseStratumSubmit(R"({"id":7,"jsonrpc":"2.0","method":"submit","params":{"id":"sess","job_id":"0000000000000001","nonce":"deadbeef","result":"00ff","algo":["rx/0"]}})", view));
+    BOOST_CHECK_EQUAL(view.method, "submit");
+    BOOST_CHECK_EQUAL(view.id, "7");
+    BOOST_CHECK_EQUAL(view.worker, "sess");
+    BOOST_CHECK_EQUAL(view.job_id, "0000000000000001");
+    BOOST_CHECK_EQUAL(view.nonce, "deadbeef");
+    BOOST_CHECK_EQUAL(view.result, "00ff");
+}
+
+BOOST_AUTO_TEST_CASE(parse_submit_standard)
+{
+    StratumSubmitView view;
+    BOOST_REQUIRE(ParseStratumSubmit(R"({ "params": ["wallet.rig", "job1", "00000001", "5f5e1000", "1234abcd"], "id": "abc", "method": "mining.submit" })", view));
+    BOOST_CHECK_EQUAL(view.id, "\"abc\"");
+    BOOST_CHECK_EQUAL(view.worker, "wallet.rig");
+    BOOST_CHECK_EQUAL(view.job_id, "job1");
+    BOOST_CHECK_EQUAL(view.extranonce2, "00000001");
+    BOOST_CHECK_EQUAL(view.ntime, "5f5e1000");
+    BOOST_CHECK_EQUAL(view.nonce, "1234abcd");
+}
+
+BOOST_AUTO_TEST_CASE(parse_submit_falls_back)
+{
+    StratumSubmitView view;
+    // Other methods, truncated input, escaped strings and short params go to the slow path
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"login","params":{"login":"x"}})", view));
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"submit","params":{"job_id":"1","nonce":"2")", view));
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"submit","params":{"job_id":"a\"b","nonce":"2"}})", view));
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"mining.submit","params":["w","j","e"]})", view));
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"submit","params":{"job_id":"1"}})", view));
+
+    // Ids that are not a JSON string, number or null
+    const std::string_view params{R"("method":"submit","params":{"job_id":"1","nonce":"2"}})"};
+    for (const std::string_view id : {"abc", "1abc", "01", "1.", "-", "1e", "true", "nul", "[1]", "{}"}) {
+        BOOST_CHECK_MESSAGE(!ParseStratumSubmit(strprintf("{\"id\":%s,%s", id, params), view), id);
+    }
+    for (const std::string_view id : {"-1.5e+3", "0", "null", "\"x\""}) {
+        BOOST_CHECK_MESSAGE(ParseStratumSubmit(strprintf("{\"id\":%s,%s", id, params), view), id);
+    }
+
+    // Anything but whitespace after the object
+    BOOST_CHECK(ParseStratumSubmit(strprintf("{\"id\":1,%s \t\r\n", params), view));
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"submit","params":{"job_id":"1","nonce":"2"}}x)", view));
+    BOOST_CHECK(!ParseStratumSubmit(R"({"id":1,"method":"submit","params":{"job_id":"1","nonce":"2"}}{"id":2})", view));
+}
+
+BOOST_AUTO_TEST_CASE(prepared_job_shared_and_patched)
+{
+    auto job = PreparedJobBuilder{}
+                   .Str("blob", "0707ab")
+                   .Str("job_id", "7")
+                   .Target("b88d0600")
+                   .Num("height", 42)
+                   .Build();
+
+    BOOST_CHECK_EQUAL(job->JobObject(), R"({"blob":"0707ab","job_id":"7","target":"b88d0600","height":42})");
+    BOOST_CHECK_EQUAL(*job->Notify(),
+                      R"({"jsonrpc":"2.0","method":"job","params":{"blob":"0707ab","job_id":"7","target":"b88d0600","height":42}})" "\n");
+
+    // Clients on the default target share the buffer; others get a patched copy
+    BOOST_CHECK(job->Notify("b88d0600") == job->Notify());
+    auto patched = job->Notify("ffffffff00000000");
+    BOOST_CHECK(patched != job->Notify());
+    BOOST_CHECK_EQUAL(*patched,
+                      R"({"jsonrpc":"2.0","method":"job","params":{"blob":"0707ab","job_id":"7","target":"ffffffff00000000","height":42}})" "\n");
+    BOOST_CHECK_EQUAL(job->JobObject("00ff"), R"({"blob":"0707ab","job_id":"7","target":"00ff","height":42})");
+}
+
+BOOST_AUTO_TEST_CASE(prepared_job_patches_blob)
+{
+    auto job = PreparedJobBuilder{}
+                   .Blob("0707ab")
+                   .Str("job_id", "7")
+                   .Target("b88d0600")
+                   .Build();
+
+    BOOST_CHECK(job->Notify("b88d0600", "0707ab") == job->Notify());
+    BOOST_CHECK_EQUAL(*job->Notify("b88d0600", "0808cd"),
+                      R"({"jsonrpc":"2.0","method":"job","params":{"blob":"0808cd","job_id":"7","target":"b88d0600"}})" "\n");
+    BOOST_CHECK_EQUAL(job->JobObject("00ff", "0909ef"), R"({"blob":"0909ef","job_id":"7","target":"00ff"})");
+    BOOST_CHECK_EQUAL(job->JobObject("00ff"), R"({"blob":"0707ab","job_id":"7","target":"00ff"})");
+}
+
+BOOST_AUTO_TEST_CASE(coinbase_template_extranonce_merkle_root)
+{
+    CBlock block;
+    for (int i = 0; i < 5; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vout.resize(1);
+        if (i == 0) {
+            tx.vin[0].prevout.SetNull();
+            tx.vin[0].scriptSig = CScript() << 1000 << OP_0;
+        } else {
+            tx.vin[0].prevout.n = i;
+        }
+        tx.vout[0].nValue = i;
+        block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+    }
+
+    const CoinbaseTemplate coinbase{block};
+    BOOST_CHECK_EQUAL(coinbase.Branch().size(), 3U);
+    for (uint32_t extranonce1 : {0U, 1U, 0xdeadbeefU}) {
+        CBlock client_block{block};
+        client_block.vtx[0] = coinbase.Coinbase(extranonce1);
+        BOOST_CHECK(coinbase.MerkleRoot(extranonce1) == BlockMerkleRoot(client_block));
+    }
+    BOOST_CHECK(coinbase.MerkleRoot(1) != coinbase.MerkleRoot(2));
+}
+
+BOOST_AUTO_TEST_CASE(validation_pool_bounded_queue)
+{
+    ShareValidationPool pool;
+    BOOST_REQUIRE(pool.Start(1, 2, "test-share"));
+
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    std::promise<void> started;
+    std::atomic<int> done{0};
+
+    // Occupy the only thread, then fill the queue behind it
+    BOOST_CHECK(pool.Submit([&] { started.set_value(); gate.wait(); ++done; }));
+    started.get_future().wait();
+    BOOST_CHECK(pool.Submit([&] { ++done; }));
+    BOOST_CHECK(pool.Submit([&] { ++done; }));
+    BOOST_CHECK(!pool.Submit([&] { ++done; }));
+    BOOST_CHECK_EQUAL(pool.GetQueueDepth(), 2U);
+    BOOST_CHECK_EQUAL(pool.GetRejectedCount(), 1U);
+
+    release.set_value();
+    for (int i = 0; i < 500 && done.load() < 3; ++i) std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    BOOST_CHECK_EQUAL(done.load(), 3);
+
+    pool.Stop();
+    BOOST_CHECK(!pool.Submit([&] { ++done; }));
+}
+
+BOOST_AUTO_TEST_CASE(vardiff_retargets_toward_interval)
+{
+    VardiffConfig config;
+    config.min_difficulty = 100;
+    config.max_difficulty = 1000000;
+    config.target_share_seconds = 10;
+    config.retarget_seconds = 60;
+
+    VardiffState state;
+    state.Init(config, 10000, 0);
+
+    // A share every second is ten times too fast; one step is capped at 4x
+    bool changed = false;
+    for (int64_t t = 1; t <= 60; ++t) changed |= state.RecordShare(config, t);
+    BOOST_CHECK(changed);
+    BOOST_CHECK_EQUAL(state.Difficulty(), 40000U);
+
+    // Old-target shares are still honoured right after the change
+    BOOST_CHECK_EQUAL(state.AcceptDifficulty(61), 10000U);
+    BOOST_CHECK_EQUAL(state.AcceptDifficulty(60 + VARDIFF_GRACE_SECONDS), 40000U);
+
+    // On-target rate is left alone
+    for (int64_t t = 70; t <= 120; t += 10) BOOST_CHECK(!state.RecordShare(config, t));
+    BOOST_CHECK_EQUAL(state.Difficulty(), 40000U);
+
+    // A silent miner is eased down and clamped to the floor
+    for (int64_t t = 300; t <= 3000; t += 300) state.CheckIdle(config, t);
+    BOOST_CHECK_EQUAL(state.Difficulty(), 100U);
+
+    config.enabled = false;
+    state.Init(config, 5000, 0);
+    BOOST_CHECK(!state.CheckIdle(config, 10000));
+    BOOST_CHECK_EQUAL(state.Difficulty(), 5000U);
+}
+
+BOOST_AUTO_TEST_CASE(vardiff_targets)
+{
+    BOOST_CHECK_EQUAL(DifficultyToCompactTarget(10000), "b88d0600");
+    BOOST_CHECK_EQUAL(DifficultyToCompactTarget(1), "ffffffff");
+
+    // Little-endian hash 0x00..01 meets any difficulty, 0xff..ff only difficulty 1
+    uint256 low{"0000000000000000000000000000000000000000000000000000000000000001"};
+    uint256 high{"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"};
+    BOOST_CHECK(HashMeetsDifficulty(low, 1000000));
+    BOOST_CHECK(HashMeetsDifficulty(high, 1));
+    BOOST_CHECK(!HashMeetsDifficulty(high, 2));
+}
+
+BOOST_AUTO_TEST_CASE(share_stats_window)
+{
+    // Ten 60s buckets
+    MinerShareStats stats{600};
+    BOOST_CHECK_EQUAL(stats.WindowSeconds(), 600);
+
+    stats.Record("alice", "btc", 100, 0);
+    stats.Record("alice", "btc", 50, 59);
+    stats.Record("alice", "ltc", 10, 300);
+    stats.Record("bob", "btc", 7, 300);
+
+    auto snapshot = stats.Collect(300);
+    BOOST_CHECK_EQUAL(snapshot["btc"]["alice"], 150U);
+    BOOST_CHECK_EQUAL(snapshot["btc"]["bob"], 7U);
+    BOOST_CHECK_EQUAL(snapshot["ltc"]["alice"], 10U);
+
+    // The first bucket falls out of the window, and its slot is reused
+    stats.Record("alice", "btc", 1, 600);
+    snapshot = stats.Collect(600);
+    BOOST_CHECK_EQUAL(snapshot["btc"]["alice"], 1U);
+
+    // Idle miners are dropped
+    snapshot = stats.Collect(1200);
+    BOOST_CHECK(snapshot.empty());
+    stats.Record("bob", "btc", 3, 1200);
+    BOOST_CHECK_EQUAL(stats.Collect(1200)["btc"]["bob"], 3U);
+}
+BOOST_AUTO_TEST_CASE(latency_histogram_buckets)
+{
+    // Every value is in a bucket whose bound is within 1/8 above it
+    for (uint64_t v : {0ULL, 7ULL, 8ULL, 15ULL, 16ULL, 1000ULL, 123456ULL, 60000000ULL}) {
+        const uint64_t bound = LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketIndex(v));
+        BOOST_CHECK(bound >= v);
+        BOOST_CHECK(bound - v <= v / LatencyHistogram::SUB_BUCKETS);
+    }
+    BOOST_CHECK_EQUAL(LatencyHistogram::BucketIndex(uint64_t{1} << 40), LatencyHistogram::BUCKETS - 1);
+
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 100; ++i) histogram.Record(std::chrono::microseconds{i * 100});
+    const auto snapshot = histogram.Read();
+    BOOST_CHECK_EQUAL(snapshot.count, 100U);
+    BOOST_CHECK_EQUAL(snapshot.sum_us, 505000U);
+    BOOST_CHECK_EQUAL(snapshot.max_us, 10000U);
+    BOOST_CHECK(snapshot.Percentile(0.5) >= 5000 && snapshot.Percentile(0.5) <= 5000 * 9 / 8);
+    BOOST_CHECK_EQUAL(snapshot.Percentile(1.0), 10000U);
+    BOOST_CHECK_EQUAL(snapshot.CountAtOrBelow(1023), 10U);
+
+    StratumMetrics metrics;
+    metrics.Reject(ShareReject::LOW_DIFFICULTY);
+    const std::string text = FormatPrometheus("test", metrics, {}, 3);
+    BOOST_CHECK(text.find("test_share_validation_seconds_bucket{le=\"+Inf\"} 0\n") != std::string::npos);
+    BOOST_CHECK(text.find("test_shares_rejected_total{reason=\"low_difficulty\"} 1\n") != std::string::npos);
+    BOOST_CHECK(text.find("test_validation_queue_depth 3\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(http_reader_framing)
+{
+    // Content-Length, with the next pipelined response left in the buffer
+    std::string buf = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhelloHTTP/1.1 500 Internal\r\nContent-Len";
+    HttpResponseReader first;
+    BOOST_CHECK(first.Parse(buf, false) == HttpResponseReader::Status::DONE);
+    BOOST_CHECK_EQUAL(first.Body(), "hello");
+    BOOST_CHECK(first.KeepAlive());
+
+    HttpResponseReader second;
+    BOOST_CHECK(second.Parse(buf, false) == HttpResponseReader::Status::NEED_MORE);
+    buf += "gth: 2\r\nConnection: close\r\n\r\n{}";
+    BOOST_CHECK(second.Parse(buf, false) == HttpResponseReader::Status::DONE);
+    BOOST_CHECK_EQUAL(second.StatusCode(), 500);
+    BOOST_CHECK_EQUAL(second.Body(), "{}");
+    BOOST_CHECK(!second.KeepAlive());
+    BOOST_CHECK(buf.empty());
+
+    // Chunked, arriving in pieces
+    HttpResponseReader chunked;
+    buf = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n4\r\n{\"a\"\r\n";
+    BOOST_CHECK(chunked.Parse(buf, false) == HttpResponseReader::Status::NEED_MORE);
+    buf += "3;ext=1\r\n:1}\r\n0\r\n\r\n";
+    BOOST_CHECK(chunked.Parse(buf, false) == HttpResponseReader::Status::DONE);
+    BOOST_CHECK_EQUAL(chunked.Body(), "{\"a\":1}");
+    BOOST_CHECK(buf.empty());
+
+    // Unframed HTTP/1.0 body runs to EOF; truncated framing fails
+    HttpResponseReader legacy;
+    buf = "HTTP/1.0 200 OK\r\n\r\nbody";
+    BOOST_CHECK(legacy.Parse(buf, false) == HttpResponseReader::Status::NEED_MORE);
+    BOOST_CHECK(legacy.Parse(buf, true) == HttpResponseReader::Status::DONE);
+    BOOST_CHECK_EQUAL(legacy.Body(), "body");
+    BOOST_CHECK(!legacy.KeepAlive());
+
+    HttpResponseReader truncated;
+    buf = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc";
+    BOOST_CHECK(truncated.Parse(buf, true) == HttpResponseReader::Status::FAILED);
+}
+
+
+BOOST_AUTO_TEST_CASE(rewards_batch_calldata)
+{
+    using namespace mining_rewards;
+    std::vector<ShareBatchEntry> entries(2);
+    entries[0].miner_address = "0x00000000000000000000000000000000000000aa";
+    entries[0].difficulty = 0x2710;
+    entries[0].coin = SHARE_COIN_XMR;
+    entries[1].miner_address = "00000000000000000000000000000000000000bb";
+    entries[1].difficulty = 1;
+    entries[1].coin = SHARE_COIN_XMR | SHARE_COIN_WTX;
+
+    std::string data = MiningRewardsManager::BuildSubmitSharesBatchCalldata(entries, 3000000, 42);
+    auto word = [&](size_t i) { return data.substr(10 + 64 * i, 64); };
+    auto num = [](uint64_t v) { std::string hex = strprintf("%x", v); return std::string(64 - hex.size(), '0') + hex; };
+
+    BOOST_CHECK_EQUAL(data.substr(0, 10), "0xa10f60d4");
+    BOOST_CHECK_EQUAL(data.size(), 10U + 64 * (4 + 3 * 2));
+    BOOST_CHECK_EQUAL(word(0), num(0x60));     // offset of the tuple array
+    BOOST_CHECK_EQUAL(word(1), num(3000000));
+    BOOST_CHECK_EQUAL(word(2), num(42));
+    BOOST_CHECK_EQUAL(word(3), num(2));        // array length
+    BOOST_CHECK_EQUAL(word(4), num(0xaa));
+    BOOST_CHECK_EQUAL(word(5), num(0x2710));
+    BOOST_CHECK_EQUAL(word(6), num(1));
+    BOOST_CHECK_EQUAL(word(7), num(0xbb));
+    BOOST_CHECK_EQUAL(word(8), num(1));
+    BOOST_CHECK_EQUAL(word(9), num(3));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
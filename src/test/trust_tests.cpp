@@ -0,0 +1,249 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <key.h>
+#include <pos.h>
+#include <streams.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <trust/heartbeat_net.h>
+#include <uint256.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(trust_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(heartbeat_replay_filter)
+{
+    trust::HeartbeatReplayFilter filter(/*windowBlocks=*/10, /*maxRecent=*/50);
+    std::vector<uint256> hashes;
+    for (int height = 0; height < 20; height++) {
+        hashes.push_back(m_rng.rand256());
+        BOOST_CHECK(filter.Insert(hashes.back(), height));
+        BOOST_CHECK(!filter.Insert(hashes.back(), height));
+    }
+    BOOST_CHECK_EQUAL(filter.RecentSize(), 20U);
+
+    // Expired heights leave the exact set but are still seen
+    filter.Expire(25);
+    BOOST_CHECK_EQUAL(filter.RecentSize(), 5U);
+    for (const uint256& hash : hashes) {
+        BOOST_CHECK(filter.Contains(hash));
+        BOOST_CHECK(!filter.Insert(hash, 30));
+    }
+    // A new heartbeat for an expired height only goes to the bloom filter
+    const uint256 old = m_rng.rand256();
+    BOOST_CHECK(filter.Insert(old, 3));
+    BOOST_CHECK(filter.Contains(old));
+    BOOST_CHECK_EQUAL(filter.RecentSize(), 5U);
+
+    // Beyond the exact limit the lowest heights expire first
+    for (int i = 0; i < 60; i++) {
+        BOOST_CHECK(filter.Insert(m_rng.rand256(), 100 + i));
+    }
+    BOOST_CHECK_LE(filter.RecentSize(), 50U);
+    BOOST_CHECK(filter.Contains(hashes.back()));
+    BOOST_CHECK(filter.DynamicMemoryUsage() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(compact_heartbeat_relay)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    trust::TrustScoreManager sender_trust(params);
+    trust::TrustScoreManager receiver_trust(params);
+    trust::HeartbeatManager sender(sender_trust, params, /*workerThreads=*/2);
+    trust::HeartbeatManager receiver(receiver_trust, params);
+
+    const CKey key = GenerateRandomKey();
+    trust::ValidatorRegistration reg;
+    reg.validatorPubKey = key.GetPubKey();
+    reg.stakeAmount = params.nMinValidatorStake;
+    BOOST_REQUIRE(reg.Sign(key));
+    BOOST_REQUIRE(sender.ProcessValidatorRegistration(reg, 0));
+    BOOST_REQUIRE(receiver.ProcessValidatorRegistration(reg, 0));
+
+    trust::Heartbeat hb;
+    hb.validatorId = key.GetPubKey().GetID();
+    hb.blockHeight = params.nHeartbeatInterval;
+    hb.blockHash = m_rng.rand256();
+    hb.timestamp = 1700000000;
+    BOOST_REQUIRE(hb.Sign(key));
+    BOOST_CHECK_EQUAL(sender.ProcessHeartbeats({hb}, 0), 1U);
+
+    // A forged signature rejects the batch and does not mark the heartbeat seen
+    trust::Heartbeat forged = hb;
+    BOOST_REQUIRE(forged.Sign(GenerateRandomKey()));
+    BOOST_CHECK_EQUAL(receiver.ProcessHeartbeats({forged}, 1), 0U);
+
+    std::vector<trust::CompactHeartbeats> announcements = sender.GetHeartbeatAnnouncements(m_rng.rand64());
+    BOOST_REQUIRE_EQUAL(announcements.size(), 1U);
+    BOOST_CHECK(sender.GetHeartbeatAnnouncements(m_rng.rand64()).empty());
+
+    DataStream stream{};
+    stream << announcements[0];
+    trust::CompactHeartbeats compact;
+    stream >> compact;
+    BOOST_REQUIRE_EQUAL(compact.shortids.size(), 1U);
+    BOOST_CHECK_EQUAL(compact.GetShortID(hb.GetHash()), announcements[0].shortids[0]);
+
+    trust::HeartbeatsRequest request;
+    BOOST_REQUIRE(receiver.GetMissingHeartbeats(compact, request));
+    BOOST_REQUIRE_EQUAL(request.indexes.size(), 1U);
+    trust::BlockHeartbeats response;
+    BOOST_REQUIRE(sender.GetRequestedHeartbeats(request, response));
+    BOOST_CHECK_EQUAL(receiver.ProcessHeartbeats(response.heartbeats, 1), 1U);
+    BOOST_CHECK(!receiver.GetMissingHeartbeats(compact, request));
+
+    request.indexes = {1};
+    BOOST_CHECK(!sender.GetRequestedHeartbeats(request, response));
+}
+
+BOOST_AUTO_TEST_CASE(validator_list_cache)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    trust::TrustScoreManager trust_manager(params);
+    trust::HeartbeatManager manager(trust_manager, params);
+
+    const auto empty = manager.GetSerializedValidatorList();
+    BOOST_CHECK(manager.GetSerializedValidatorList() == empty);
+
+    // A registration invalidates the cached reply
+    const CKey key = GenerateRandomKey();
+    trust::ValidatorRegistration reg;
+    reg.validatorPubKey = key.GetPubKey();
+    reg.stakeAmount = params.nMinValidatorStake;
+    BOOST_REQUIRE(reg.Sign(key));
+    BOOST_REQUIRE(manager.ProcessValidatorRegistration(reg, 0));
+    const auto registered = manager.GetSerializedValidatorList();
+    BOOST_CHECK(registered != empty);
+    BOOST_CHECK(manager.GetSerializedValidatorList() == registered);
+
+    trust::ValidatorList list;
+    SpanReader{*registered} >> list;
+    BOOST_REQUIRE_EQUAL(list.validators.size(), 1U);
+    BOOST_CHECK(list.validators[0].validatorId == key.GetPubKey().GetID());
+
+    // So does a new block
+    trust_manager.SetHeight(1);
+    BOOST_CHECK(manager.GetSerializedValidatorList() != registered);
+}
+
+BOOST_AUTO_TEST_CASE(trust_store_deadlines)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    const int interval = params.nHeartbeatInterval;
+    const fs::path path = m_path_root / "trust";
+    const CKeyID id = GenerateRandomKey().GetPubKey().GetID();
+    {
+        trust::TrustScoreManager manager(params, path);
+        BOOST_REQUIRE(manager.RegisterValidator(id, params.nMinValidatorStake, 100, 0));
+
+        manager.UpdateHeartbeatExpectations(interval - 1);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsExpected, 0);
+        manager.UpdateHeartbeatExpectations(interval);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsExpected, 1);
+
+        // One miss after two silent intervals, then one per interval
+        manager.RecordMissedCheckIns(2 * interval);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 0);
+        manager.RecordMissedCheckIns(2 * interval + 1);
+        manager.RecordMissedCheckIns(2 * interval + 2);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 1);
+        manager.RecordMissedCheckIns(3 * interval + 1);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 2);
+
+        // A heartbeat moves the deadline
+        trust::Heartbeat hb;
+        hb.validatorId = id;
+        BOOST_REQUIRE(manager.ProcessHeartbeat(hb, 3 * interval));
+        manager.RecordMissedCheckIns(4 * interval + 1);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 2);
+
+        manager.UpdateHeartbeatExpectations(4 * interval + 1);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsExpected, 4);
+        manager.RecordMissedCheckIns(6 * interval + 1);
+        manager.UpdateHeartbeatExpectations(6 * interval + 1);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 3);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsExpected, 6);
+
+        // Disconnecting reverts the block's changes only
+        BOOST_CHECK(manager.DisconnectBlock(6 * interval + 1));
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 2);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsExpected, 4);
+        BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsReceived, 1);
+        BOOST_CHECK(!manager.DisconnectBlock(6 * interval + 1));
+    }
+
+    // The state survives a restart, deadlines included
+    trust::TrustScoreManager manager(params, path);
+    BOOST_REQUIRE(manager.GetValidator(id));
+    BOOST_CHECK_EQUAL(manager.GetHeight(), 6 * interval);
+    BOOST_CHECK_EQUAL(manager.GetValidator(id)->heartbeatsExpected, 4);
+    BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 2);
+    BOOST_CHECK(manager.GetTierSnapshot()->Find(id));
+    // Deeper than the kept undo data
+    BOOST_CHECK(!manager.DisconnectBlock(4 * interval + 1));
+
+    manager.RecordMissedCheckIns(6 * interval + 1);
+    BOOST_CHECK_EQUAL(manager.GetValidator(id)->missedCheckIns, 3);
+}
+
+BOOST_AUTO_TEST_CASE(validator_relay_candidates)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    const int interval = params.nHeartbeatInterval;
+    trust::TrustScoreManager manager(params);
+    trust::PeerDiscoveryManager discovery;
+
+    const CKeyID reliable = GenerateRandomKey().GetPubKey().GetID();
+    const CKeyID silent = GenerateRandomKey().GetPubKey().GetID();
+    BOOST_REQUIRE(manager.RegisterValidator(reliable, params.nMinValidatorStake, 100, 0));
+    BOOST_REQUIRE(manager.RegisterValidator(silent, params.nMinValidatorStake, 100, 0));
+
+    const CService reliable_addr{LookupNumeric("10.0.0.1", 1337)};
+    const CService silent_addr{LookupNumeric("10.0.0.2", 1337)};
+    const CService config_addr{LookupNumeric("10.0.0.3", 1337)};
+    BOOST_REQUIRE(manager.UpdateValidatorAddress(silent, silent_addr, 1700000000));
+    BOOST_REQUIRE(manager.UpdateValidatorAddress(reliable, reliable_addr, 1700000000));
+
+    trust::Heartbeat hb;
+    hb.validatorId = reliable;
+    BOOST_REQUIRE(manager.ProcessHeartbeat(hb, interval));
+    BOOST_REQUIRE(manager.ProcessHeartbeat(hb, 2 * interval));
+    manager.UpdateHeartbeatExpectations(2 * interval);
+    BOOST_REQUIRE(manager.GetValidator(reliable)->GetTrustTier(params) > manager.GetValidator(silent)->GetTrustTier(params));
+
+    // Higher tiers first, then known peers without a tier, each once
+    BOOST_CHECK(discovery.ProcessValidatorAddress(config_addr, CKeyID()));
+    BOOST_CHECK(discovery.ProcessValidatorAddress(reliable_addr, reliable));
+    const std::vector<CService> expected{reliable_addr, silent_addr, config_addr};
+    BOOST_CHECK(discovery.GetRelayCandidates(manager) == expected);
+
+    BOOST_REQUIRE(manager.DeactivateValidator(silent));
+    const std::vector<CService> active{reliable_addr, config_addr};
+    BOOST_CHECK(discovery.GetRelayCandidates(manager) == active);
+}
+
+BOOST_AUTO_TEST_CASE(tiered_reward_schedule)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    const int height = params.nLastBigReward + 1;
+    const auto schedule = GetTieredRewardSchedule(height, params);
+    BOOST_CHECK_EQUAL(schedule->baseReward, GetBlockSubsidy(height, params));
+    for (const auto tier : {trust::TrustTier::NONE, trust::TrustTier::BRONZE, trust::TrustTier::SILVER,
+                            trust::TrustTier::GOLD, trust::TrustTier::PLATINUM}) {
+        BOOST_CHECK_EQUAL(schedule->Get(tier).multiplier, GetTierRewardMultiplier(tier, params));
+        BOOST_CHECK_EQUAL(schedule->Get(tier).reward, CalculateTieredBlockReward(schedule->baseReward, tier, params));
+    }
+
+    // Heights with the same subsidy share the schedule
+    BOOST_CHECK_EQUAL(GetBlockSubsidy(height + 1, params), schedule->baseReward);
+    BOOST_CHECK(GetTieredRewardSchedule(height + 1, params) == schedule);
+    BOOST_CHECK(GetTieredRewardSchedule(params.nLastBigReward, params) != schedule);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
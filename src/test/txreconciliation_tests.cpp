@@ -8,6 +8,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RegisterPeerTest)
@@ -81,4 +84,80 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    // One node initiates reconciliation with the other through an outbound connection
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    const NodeId peer_id{0};
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(peer_id)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(peer_id)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(peer_id, /*is_peer_inbound=*/false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(peer_id, /*is_peer_inbound=*/true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    auto random_txs = [&](size_t count) {
+        std::vector<Wtxid> txs;
+        for (size_t i = 0; i < count; ++i) txs.push_back(Wtxid::FromUint256(m_rng.rand256()));
+        return txs;
+    };
+    const std::vector<Wtxid> common{random_txs(20)}, initiator_only{random_txs(2)}, responder_only{random_txs(2)};
+    const std::vector<Wtxid> responder_private{random_txs(3)};
+    for (const Wtxid& wtxid : common) {
+        BOOST_CHECK(initiator.AddToSet(peer_id, wtxid, ReconciliationSet::DEFAULT));
+        BOOST_CHECK(responder.AddToSet(peer_id, wtxid, ReconciliationSet::DEFAULT));
+    }
+    for (const Wtxid& wtxid : initiator_only) BOOST_CHECK(initiator.AddToSet(peer_id, wtxid, ReconciliationSet::DEFAULT));
+    for (const Wtxid& wtxid : responder_only) BOOST_CHECK(responder.AddToSet(peer_id, wtxid, ReconciliationSet::DEFAULT));
+    for (const Wtxid& wtxid : responder_private) BOOST_CHECK(responder.AddToSet(peer_id, wtxid, ReconciliationSet::PRIVACY));
+    // Unregistered peers get everything by flooding
+    BOOST_CHECK(!initiator.AddToSet(/*peer_id=*/1, common[0], ReconciliationSet::DEFAULT));
+    BOOST_CHECK(initiator.ShouldFanoutTo(common[0], /*peer_id=*/1));
+
+    auto now{1000s};
+    BOOST_CHECK(!responder.InitiateReconciliationRequest(peer_id, now));
+    const auto request{initiator.InitiateReconciliationRequest(peer_id, now)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->set_sizes[0], common.size() + initiator_only.size());
+    BOOST_CHECK_EQUAL(request->set_sizes[2], 0U);
+    // One round at a time
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(peer_id, now + RECON_REQUEST_INTERVAL));
+
+    std::vector<std::vector<uint8_t>> sketches;
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(peer_id, now, *request, sketches));
+    BOOST_REQUIRE_EQUAL(sketches.size(), RECON_SET_COUNT);
+    BOOST_CHECK(sketches[1].empty());
+    BOOST_CHECK(!responder.HandleReconciliationRequest(peer_id, now, *request, sketches));
+
+    std::vector<Wtxid> initiator_announces;
+    ReconciliationDifference difference;
+    BOOST_REQUIRE(initiator.HandleSketch(peer_id, sketches, initiator_announces, difference));
+    BOOST_CHECK(std::is_permutation(initiator_announces.begin(), initiator_announces.end(), initiator_only.begin(), initiator_only.end()));
+    BOOST_CHECK(difference.success == std::vector<uint8_t>(RECON_SET_COUNT, 1));
+    BOOST_CHECK_EQUAL(difference.ask_shortids[0].size(), responder_only.size());
+    BOOST_CHECK(difference.ask_shortids[1].empty());
+    BOOST_CHECK_EQUAL(difference.ask_shortids[2].size(), responder_private.size());
+
+    std::vector<Wtxid> responder_announces;
+    BOOST_REQUIRE(responder.HandleReconciliationDifference(peer_id, difference, responder_announces));
+    std::vector<Wtxid> expected{responder_only};
+    expected.insert(expected.end(), responder_private.begin(), responder_private.end());
+    BOOST_CHECK(std::is_permutation(responder_announces.begin(), responder_announces.end(), expected.begin(), expected.end()));
+
+    // The next round starts from empty sets
+    now += RECON_REQUEST_INTERVAL;
+    const auto next_request{initiator.InitiateReconciliationRequest(peer_id, now)};
+    BOOST_REQUIRE(next_request);
+    BOOST_CHECK_EQUAL(next_request->set_sizes[0], 0U);
+
+    // A responder that does not answer is flooded to after the timeout
+    BOOST_CHECK(initiator.AddToSet(peer_id, common[0], ReconciliationSet::DEFAULT));
+    std::vector<Wtxid> flooded;
+    initiator.ExpireStaleRounds(peer_id, now + RECON_TIMEOUT, flooded);
+    BOOST_CHECK(flooded.empty());
+    initiator.ExpireStaleRounds(peer_id, now + RECON_TIMEOUT + 1s, flooded);
+    BOOST_REQUIRE_EQUAL(flooded.size(), 1U);
+    BOOST_CHECK(flooded[0] == common[0]);
+    BOOST_CHECK(!initiator.AddToSet(peer_id, common[1], ReconciliationSet::DEFAULT));
+    BOOST_CHECK(initiator.ShouldFanoutTo(common[1], peer_id));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
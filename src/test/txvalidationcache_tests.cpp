@@ -4,6 +4,7 @@
 
 #include <consensus/validation.h>
 #include <key.h>
+#include <privacy/ed25519/ed25519_types.h>
 #include <random.h>
 #include <script/sigcache.h>
 #include <script/sign.h>
@@ -385,4 +386,32 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(privacy_proof_cache_entry, BasicTestingSetup)
+{
+    ValidationCache cache{/*script_execution_cache_bytes=*/0, /*signature_cache_bytes=*/0, /*privacy_proof_cache_bytes=*/1 << 20};
+    ValidationCache other_cache{0, 0, 0};
+
+    CMutableTransaction mtx;
+    mtx.vout.emplace_back(1, CScript() << OP_TRUE);
+    const CTransaction tx{mtx};
+    ed25519::Point root_a, root_b;
+    root_a.data.fill(0x01);
+    root_b.data.fill(0x02);
+
+    const uint256 ring_entry{PrivacyProofCacheEntry(cache, tx)};
+    const uint256 fcmp_entry{PrivacyProofCacheEntry(cache, tx, &root_a)};
+    BOOST_CHECK(ring_entry == PrivacyProofCacheEntry(cache, tx));
+    // FCMP proofs are only reused against the root they were verified with
+    BOOST_CHECK(fcmp_entry != ring_entry);
+    BOOST_CHECK(fcmp_entry != PrivacyProofCacheEntry(cache, tx, &root_b));
+    // Entries are salted per cache
+    BOOST_CHECK(ring_entry != PrivacyProofCacheEntry(other_cache, tx));
+
+    LOCK(cs_main);
+    BOOST_CHECK(!cache.m_privacy_proof_cache.contains(fcmp_entry, /*erase=*/false));
+    cache.m_privacy_proof_cache.insert(fcmp_entry);
+    BOOST_CHECK(cache.m_privacy_proof_cache.contains(fcmp_entry, /*erase=*/false));
+    BOOST_CHECK(!cache.m_privacy_proof_cache.contains(PrivacyProofCacheEntry(cache, tx, &root_b), /*erase=*/false));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
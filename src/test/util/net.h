@@ -122,6 +122,7 @@ constexpr ConnectionType ALL_CONNECTION_TYPES[]{
     ConnectionType::FEELER,
     ConnectionType::BLOCK_RELAY,
     ConnectionType::ADDR_FETCH,
+    ConnectionType::VALIDATOR_RELAY,
 };
 
 constexpr auto ALL_NETWORKS = std::array{
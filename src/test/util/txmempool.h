@@ -25,6 +25,7 @@ struct TestMemPoolEntryHelper {
     bool spendsCoinbase{false};
     unsigned int sigOpCost{4};
     LockPoints lp;
+    MempoolGasSummary gas;
 
     CTxMemPoolEntry FromTx(const CMutableTransaction& tx) const;
     CTxMemPoolEntry FromTx(const CTransactionRef& tx) const;
@@ -36,6 +37,7 @@ struct TestMemPoolEntryHelper {
     TestMemPoolEntryHelper& Sequence(uint64_t _seq) { m_sequence = _seq; return *this; }
     TestMemPoolEntryHelper& SpendsCoinbase(bool _flag) { spendsCoinbase = _flag; return *this; }
     TestMemPoolEntryHelper& SigOpsCost(unsigned int _sigopsCost) { sigOpCost = _sigopsCost; return *this; }
+    TestMemPoolEntryHelper& Gas(uint64_t gas_limit, CAmount gas_price, const uint160& sender = {}) { gas = {gas_limit, gas_price, sender}; return *this; }
 };
 
 /** Check expected properties for every PackageMempoolAcceptResult, regardless of value. Returns
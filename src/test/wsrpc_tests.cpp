@@ -0,0 +1,99 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <wsrpc.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace wsrpc;
+
+/** Mask a server frame the way a client would send it */
+static std::string MaskFrame(const std::string& frame, const std::string& mask)
+{
+    const size_t header = (static_cast<uint8_t>(frame[1]) == 126) ? 4 : (static_cast<uint8_t>(frame[1]) == 127) ? 10 : 2;
+    std::string masked = frame.substr(0, header);
+    masked[1] = static_cast<char>(masked[1] | 0x80);
+    masked += mask;
+    for (size_t i = header; i < frame.size(); ++i) {
+        masked.push_back(frame[i] ^ mask[(i - header) % 4]);
+    }
+    return masked;
+}
+
+BOOST_FIXTURE_TEST_SUITE(wsrpc_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(accept_key)
+{
+    // The example of RFC 6455 section 1.3
+    BOOST_CHECK_EQUAL(AcceptKey("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+BOOST_AUTO_TEST_CASE(frame_roundtrip)
+{
+    const std::string mask{"\x37\xfa\x21\x3d", 4};
+    for (size_t length : {size_t{0}, size_t{5}, size_t{125}, size_t{126}, size_t{65535}, size_t{65536}}) {
+        const std::string payload(length, 'x');
+        const std::string data = MaskFrame(EncodeFrame(Opcode::TEXT, payload), mask);
+        Frame frame;
+        size_t consumed = 0;
+        BOOST_CHECK(ParseFrame(data, 1 << 20, frame, consumed) == ParseResult::FRAME);
+        BOOST_CHECK_EQUAL(consumed, data.size());
+        BOOST_CHECK(frame.fin);
+        BOOST_CHECK(frame.opcode == Opcode::TEXT);
+        BOOST_CHECK(frame.payload == payload);
+
+        // Any prefix is incomplete
+        BOOST_CHECK(ParseFrame(std::string_view{data}.substr(0, data.size() - 1), 1 << 20, frame, consumed) == ParseResult::INCOMPLETE);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(frame_masked_hello)
+{
+    // The masked "Hello" of RFC 6455 section 5.7
+    const std::string data{"\x81\x85\x37\xfa\x21\x3d\x7f\x9f\x4d\x51\x58", 11};
+    Frame frame;
+    size_t consumed = 0;
+    BOOST_CHECK(ParseFrame(data, 125, frame, consumed) == ParseResult::FRAME);
+    BOOST_CHECK_EQUAL(frame.payload, "Hello");
+    BOOST_CHECK_EQUAL(consumed, 11U);
+
+    // Server frames are not masked
+    BOOST_CHECK_EQUAL(EncodeFrame(Opcode::TEXT, "Hello"), std::string("\x81\x05Hello", 7));
+}
+
+BOOST_AUTO_TEST_CASE(frame_errors)
+{
+    const std::string mask{"\x01\x02\x03\x04", 4};
+    Frame frame;
+    size_t consumed = 0;
+
+    // Unmasked client frame
+    BOOST_CHECK(ParseFrame(EncodeFrame(Opcode::TEXT, "Hello"), 125, frame, consumed) == ParseResult::ERROR);
+
+    // Reserved bits set
+    std::string data = MaskFrame(EncodeFrame(Opcode::TEXT, "Hello"), mask);
+    data[0] = static_cast<char>(data[0] | 0x40);
+    BOOST_CHECK(ParseFrame(data, 125, frame, consumed) == ParseResult::ERROR);
+
+    // Unknown opcode
+    data = MaskFrame(EncodeFrame(Opcode::TEXT, "Hello"), mask);
+    data[0] = static_cast<char>(0x83);
+    BOOST_CHECK(ParseFrame(data, 125, frame, consumed) == ParseResult::ERROR);
+
+    // Fragmented control frame
+    data = MaskFrame(EncodeFrame(Opcode::PING, "Hello"), mask);
+    data[0] = static_cast<char>(data[0] & 0x7F);
+    BOOST_CHECK(ParseFrame(data, 125, frame, consumed) == ParseResult::ERROR);
+
+    // Control frame over 125 bytes
+    data = MaskFrame(EncodeFrame(Opcode::PING, std::string(126, 'x')), mask);
+    BOOST_CHECK(ParseFrame(data, 1024, frame, consumed) == ParseResult::ERROR);
+
+    // Over the message size, rejected from the header alone
+    data = MaskFrame(EncodeFrame(Opcode::TEXT, std::string(1000, 'x')), mask);
+    BOOST_CHECK(ParseFrame(std::string_view{data}.substr(0, 8), 999, frame, consumed) == ParseResult::ERROR);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,11 +5,28 @@
 #include <boost/test/unit_test.hpp>
 
 #include <crypto/x25x/x25x.h>
+#include <crypto/x25x/ethash_cache.h>
+#include <crypto/x25x/scrypt.h>
+#include <crypto/x25x/x11_hasher.h>
+#include <crypto/equihash/equihash.h>
+#include <arith_uint256.h>
+#include <chain.h>
+#include <node/x25x_miner.h>
+#include <opencl/gpu_miner.h>
+#include <opencl/multi_gpu_sieve.h>
 #include <primitives/block.h>
 #include <uint256.h>
+#include <util/strencodings.h>
 #include <streams.h>
+#include <test/util/setup_common.h>
 
+#include <ethash/ethash.h>
+
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <set>
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE(x25x_tests)
 
@@ -169,6 +186,22 @@ BOOST_AUTO_TEST_CASE(x11_hash_test)
     BOOST_CHECK(hash != sha256hash);
 }
 
+BOOST_AUTO_TEST_CASE(x11_engine_matches_reference)
+{
+    // The engine's specialised Groestl and CubeHash stages must agree with sphlib
+    x25x::X11Hasher hasher;
+    std::vector<unsigned char> data;
+    for (size_t len = 0; len <= 300; len += 13) {
+        data.resize(len);
+        for (size_t i = 0; i < len; i++) data[i] = static_cast<unsigned char>(i * 31 + len);
+
+        uint256 expected;
+        x11_hash(data.data(), data.size(), expected.begin());
+        BOOST_CHECK(hasher.Hash(data.data(), data.size()) == expected);
+        BOOST_CHECK(x25x::hash::X11(data.data(), data.size()) == expected);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(kheavyhash_hash_test)
 {
     CBlockHeader header = CreateTestHeader();
@@ -184,6 +217,20 @@ BOOST_AUTO_TEST_CASE(kheavyhash_hash_test)
     BOOST_CHECK(hash == hash2);
 }
 
+BOOST_AUTO_TEST_CASE(kheavyhash_known_answer)
+{
+    // Expected values from the materialized 64x64 matrix (generateMatrix +
+    // matrixMultiply) that the fused row sums replaced
+    const unsigned char data[] = "WATTx X25X Multi-Algorithm Test";
+    BOOST_CHECK_EQUAL(x25x::hash::KHeavyHash(data, sizeof(data) - 1),
+                      uint256{"d0dd1035cef8f8c74f49d5606f19ef9acb6afccd32dcb4fac239f3aa56fca8cf"});
+
+    CBlockHeader header = CreateTestHeader();
+    header.nVersion = x25x::SetBlockAlgorithm(header.nVersion, x25x::Algorithm::KHEAVYHASH);
+    BOOST_CHECK_EQUAL(x25x::HashBlockHeader(header, x25x::Algorithm::KHEAVYHASH),
+                      uint256{"99b6e3fa2158e028eeb974080c4c2bebdccec9ec7143ac82bf486e97af5ed182"});
+}
+
 BOOST_AUTO_TEST_CASE(all_algorithms_different_output)
 {
     // Test that all algorithms produce different hashes for the same input
@@ -213,6 +260,166 @@ BOOST_AUTO_TEST_CASE(all_algorithms_different_output)
     }
 }
 
+BOOST_AUTO_TEST_CASE(header_hasher_matches_full_hash)
+{
+    // The template hasher must agree with hashing the whole header at every nonce
+    CBlockHeader header = CreateTestHeader();
+    header.vchBlockSigDlgt = {0x01, 0x02, 0x03};
+
+    for (auto algo : {x25x::Algorithm::SHA256D, x25x::Algorithm::SCRYPT,
+                      x25x::Algorithm::X11, x25x::Algorithm::KHEAVYHASH}) {
+        header.nVersion = x25x::SetBlockAlgorithm(header.nVersion, algo);
+        x25x::HeaderHasher hasher(header);
+        BOOST_CHECK(hasher.GetAlgorithm() == algo);
+
+        for (uint32_t nonce : {0U, 1U, 12345U, 0x80000000U, 0xffffffffU}) {
+            CBlockHeader expected = header;
+            expected.nNonce = nonce;
+            BOOST_CHECK(hasher.Hash(nonce) == x25x::HashBlockHeader(expected, algo));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(gpu_backend_candidates)
+{
+    // Algorithms without a kernel are rejected before OpenCL is touched
+    node::X25XMiner miner;
+    BOOST_CHECK(!miner.Initialize(x25x::Algorithm::SCRYPT, node::X25XMiner::Backend::GPU));
+    BOOST_CHECK(miner.GetBackend() == node::X25XMiner::Backend::CPU);
+    BOOST_CHECK(!node::X25XMiner::IsGpuAvailable(x25x::Algorithm::X11));
+
+    // The rest needs an OpenCL device
+    if (!node::X25XMiner::IsGpuAvailable(x25x::Algorithm::SHA256D)) return;
+
+    CBlockHeader header = CreateTestHeader();
+    const uint256 target = ArithToUint256(arith_uint256(1) << 244);
+    const uint32_t count = 1 << 14;
+
+    for (auto algo : {x25x::Algorithm::SHA256D, x25x::Algorithm::KHEAVYHASH}) {
+        header.nVersion = x25x::SetBlockAlgorithm(header.nVersion, algo);
+        x25x::HeaderHasher hasher(header);
+        std::set<uint32_t> expected;
+        for (uint32_t nonce = 0; nonce < count; nonce++) {
+            if (UintToArith256(hasher.Hash(nonce)) <= UintToArith256(target)) expected.insert(nonce);
+        }
+        BOOST_REQUIRE(expected.size() <= opencl::GpuMiner::MAX_RESULTS);
+
+        opencl::GpuMiner gpu;
+        BOOST_REQUIRE(gpu.Initialize(0, 0, algo));
+        BOOST_REQUIRE(gpu.SetJob(header, target));
+        BOOST_REQUIRE(gpu.Submit(0, count));
+        opencl::GpuBatch batch;
+        BOOST_REQUIRE(gpu.Wait(batch));
+        BOOST_CHECK_EQUAL(batch.jobId, gpu.GetJobId());
+        BOOST_CHECK(std::set<uint32_t>(batch.candidates.begin(), batch.candidates.end()) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(miner_telemetry)
+{
+    node::MinerTelemetry telemetry;
+    telemetry.Start(3);
+    {
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < 3; i++) {
+            threads.emplace_back([&telemetry, i] {
+                for (int n = 0; n < 1000; n++) telemetry.AddHashes(i, 64);
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+    // Threads past MAX_THREADS share a counter
+    telemetry.AddHashes(node::MinerTelemetry::MAX_THREADS, 1);
+    telemetry.BlockFound();
+
+    node::MiningStats stats = telemetry.GetStats();
+    BOOST_CHECK(stats.mining);
+    BOOST_CHECK_EQUAL(stats.threads, 3U);
+    BOOST_CHECK_EQUAL(stats.total_hashes, 3U * 1000 * 64 + 1);
+    BOOST_CHECK_EQUAL(stats.blocks_found, 1U);
+
+    telemetry.Stop();
+    stats = telemetry.GetStats();
+    BOOST_CHECK(!stats.mining);
+    BOOST_CHECK_EQUAL(stats.total_hashes, 3U * 1000 * 64 + 1);
+    BOOST_CHECK(stats.hashrate > 0);
+
+    // A miner counts its hashes and blocks without any lock
+    node::X25XMiner miner;
+    BOOST_REQUIRE(miner.Initialize(x25x::Algorithm::SHA256D));
+    CBlock block;
+    static_cast<CBlockHeader&>(block) = CreateTestHeader();
+    std::atomic<bool> found{false};
+    miner.StartMining(block, ArithToUint256(~arith_uint256{0}), 1, [&](const CBlock&) { found = true; });
+    for (int i = 0; i < 500 && !found; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    miner.StopMining();
+    BOOST_REQUIRE(found.load());
+    stats = miner.GetStats();
+    BOOST_CHECK(!stats.mining);
+    BOOST_CHECK_EQUAL(stats.blocks_found, 1U);
+    BOOST_CHECK_EQUAL(stats.total_hashes, miner.GetTotalHashes());
+    BOOST_CHECK(stats.total_hashes >= 1);
+}
+
+BOOST_AUTO_TEST_CASE(multi_gpu_segment_scheduler)
+{
+    // Three workers share 100 segments; worker 0 is fast and steals
+    opencl::SegmentScheduler scheduler(1000, 100, 3);
+    std::set<uint64_t> seen;
+    uint64_t begin, end;
+    auto take = [&](size_t worker, uint64_t max) {
+        if (!scheduler.Take(worker, max, begin, end)) return false;
+        BOOST_CHECK(begin < end && end - begin <= max);
+        for (uint64_t s = begin; s < end; s++) BOOST_CHECK(seen.insert(s).second);
+        return true;
+    };
+
+    BOOST_CHECK(take(1, 4));
+    BOOST_CHECK_EQUAL(begin, 1034U);
+    // Worker 2 fails mid-chunk and hands back the tail
+    BOOST_CHECK(scheduler.Take(2, 8, begin, end));
+    BOOST_CHECK_EQUAL(begin, 1067U);
+    for (uint64_t s = begin; s < begin + 3; s++) seen.insert(s);
+    scheduler.Return(2, begin + 3, end);
+    BOOST_CHECK_EQUAL(scheduler.GetRemaining(), 100U - 4 - 3);
+
+    while (take(0, 5)) {}
+    BOOST_CHECK_EQUAL(scheduler.GetRemaining(), 0U);
+    BOOST_CHECK_EQUAL(seen.size(), 100U);
+    BOOST_CHECK_EQUAL(*seen.begin(), 1000U);
+    BOOST_CHECK_EQUAL(*seen.rbegin(), 1099U);
+    BOOST_CHECK(!take(1, 4));
+}
+
+BOOST_AUTO_TEST_CASE(scrypt_engine_vectors_and_batch)
+{
+    // Litecoin block header with its known scrypt_1024_1_1_256 hash
+    const std::vector<unsigned char> ltc = ParseHex(
+        "020000004c1271c211717198227392b029a64a7971931d351b387bb80db027f270411e39"
+        "8a07046f7d4a08dd815412a8712f874a7ebf0507e3878bd24e20a3b73fd750a667d2f451"
+        "eac7471b00de6659");
+    BOOST_CHECK_EQUAL(x25x::hash::Scrypt(ltc.data(), ltc.size()).GetHex(),
+                      "00000000002bef4107f882f6115e0b01f348d21195dacd3582aa2dabd7985806");
+
+    // Batches must match single hashes, including a tail shorter than the lane count
+    CBlockHeader header = CreateTestHeader();
+    header.nVersion = x25x::SetBlockAlgorithm(header.nVersion, x25x::Algorithm::SCRYPT);
+    header.vchBlockSigDlgt = {0x01, 0x02, 0x03};
+    x25x::HeaderHasher hasher(header);
+    BOOST_CHECK_EQUAL(hasher.GetBatchSize(), x25x::ScryptHasher::GetLanes());
+
+    const size_t count = 2 * x25x::ScryptHasher::MAX_LANES + 3;
+    std::vector<uint256> hashes(count);
+    hasher.HashMany(1000U, count, hashes.data());
+    for (size_t i = 0; i < count; i++) {
+        CBlockHeader expected = header;
+        expected.nNonce = 1000U + i;
+        BOOST_CHECK(hashes[i] == x25x::HashBlockHeader(expected, x25x::Algorithm::SCRYPT));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(hash_raw_data_test)
 {
     // Test hashing raw data directly
@@ -244,4 +451,157 @@ BOOST_AUTO_TEST_CASE(hash_raw_data_test)
     BOOST_CHECK(x11 != kheavy);
 }
 
+BOOST_FIXTURE_TEST_CASE(ethash_cache_persistence, BasicTestingSetup)
+{
+    // A cache loaded back from disk must hash exactly like a freshly built one,
+    // and a damaged file must be rejected and rebuilt
+    const fs::path dir = m_path_root / "ethash";
+    ethash_hash256 header_hash{};
+    header_hash.bytes[0] = 0x42;
+
+    ethash_result built;
+    {
+        x25x::EthashCache cache;
+        cache.SetDirectory(dir);
+        auto context = cache.GetContext(0);
+        BOOST_REQUIRE(context);
+        built = ethash_hash(context.get(), &header_hash, 7);
+        BOOST_CHECK(fs::exists(cache.GetCachePath(0)));
+    }
+    {
+        x25x::EthashCache cache;
+        cache.SetDirectory(dir);
+        auto context = cache.GetContext(0);
+        BOOST_REQUIRE(context);
+        ethash_result loaded = ethash_hash(context.get(), &header_hash, 7);
+        BOOST_CHECK(std::memcmp(&built, &loaded, sizeof(built)) == 0);
+    }
+
+    FILE* file = fsbridge::fopen(dir / "epoch-0.cache", "r+b");
+    BOOST_REQUIRE(file);
+    std::fseek(file, 4096, SEEK_SET);
+    std::fputc(0x5a, file);
+    std::fclose(file);
+    {
+        x25x::EthashCache cache;
+        cache.SetDirectory(dir);
+        auto context = cache.GetContext(0);
+        BOOST_REQUIRE(context);
+        ethash_result rebuilt = ethash_hash(context.get(), &header_hash, 7);
+        BOOST_CHECK(std::memcmp(&built, &rebuilt, sizeof(built)) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(equihash_leaf_hash_and_batch)
+{
+    // Leaf hashes are BLAKE2b-400 personalized "ZcashPoW"||200||9 over
+    // input||index; vectors cross-checked against an independent BLAKE2b
+    unsigned char input[140];
+    for (size_t i = 0; i < sizeof(input); i++) input[i] = (i * 7 + 3) & 0xff;
+
+    unsigned char hash[equihash::HASH_LENGTH];
+    equihash::GenerateHash(input, 80, 0, hash);
+    BOOST_CHECK_EQUAL(HexStr(hash), "8fe4499db46b2d7caefa0558a054aca2969a72cc91879940e26203469282");
+    equihash::GenerateHash(input, 80, 0x1fffff, hash);
+    BOOST_CHECK_EQUAL(HexStr(hash), "c6289382de53f1b505d57f22ea569cc10e1a60519d7b27a448d09fb3121c");
+    // Index split across two BLAKE2b blocks
+    equihash::GenerateHash(input, 126, 1, hash);
+    BOOST_CHECK_EQUAL(HexStr(hash), "03fbe8cdec312be8fffc2d8bf4901b16689c4767d160a292f0df06c43e5b");
+    equihash::GenerateHash(input, 140, 1, hash);
+    BOOST_CHECK_EQUAL(HexStr(hash), "2026bccad215c3fa84bb95249ced9d3e8fb10fd3270c508858d63381e3ca");
+
+    std::vector<uint32_t> indices(equihash::NUM_INDICES);
+    for (size_t i = 0; i < indices.size(); i++) indices[i] = i * 4000 + 1;
+    std::vector<unsigned char> ordered, duplicate, short_solution(equihash::COMPRESSED_SOL_SIZE - 1);
+    BOOST_REQUIRE(equihash::CompressSolution(indices, ordered));
+    indices[3] = indices[2];
+    BOOST_REQUIRE(equihash::CompressSolution(indices, duplicate));
+    BOOST_CHECK(!equihash::VerifySolution(input, 80, ordered));
+    BOOST_CHECK(!equihash::VerifySolution(input, 80, duplicate));
+
+    std::vector<equihash::SolutionCheck> checks;
+    for (int i = 0; i < 40; i++) {
+        checks.push_back({input, 80, i % 3 == 0 ? &short_solution : &ordered});
+    }
+    std::vector<bool> results = equihash::VerifySolutions(checks);
+    BOOST_REQUIRE_EQUAL(results.size(), checks.size());
+    for (size_t i = 0; i < checks.size(); i++) {
+        BOOST_CHECK_EQUAL(results[i], equihash::VerifySolution(checks[i].input, checks[i].inputLen, *checks[i].solution));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(equihash_solver)
+{
+    unsigned char input[84];
+    for (size_t i = 0; i < sizeof(input); i++) input[i] = (i * 7 + 1) & 0xff;
+
+    // Batched leaf hashes match the single ones, across the four-lane groups
+    std::vector<unsigned char> hashes(7 * equihash::HASH_LENGTH);
+    equihash::GenerateHashes(input, sizeof(input), 1000, 7, hashes.data());
+    for (uint32_t i = 0; i < 7; i++) {
+        unsigned char hash[equihash::HASH_LENGTH];
+        equihash::GenerateHash(input, sizeof(input), 1000 + i, hash);
+        BOOST_CHECK(std::memcmp(hash, hashes.data() + i * equihash::HASH_LENGTH, equihash::HASH_LENGTH) == 0);
+    }
+
+    equihash::Solver solver(2);
+    std::vector<std::vector<unsigned char>> solutions;
+    const size_t found = solver.Solve(input, sizeof(input), [&](const std::vector<uint32_t>& indices) {
+        BOOST_CHECK(equihash::HasValidIndicesOrder(indices));
+        BOOST_REQUIRE(equihash::CompressSolution(indices, solutions.emplace_back()));
+        return solutions.size() == 3;
+    });
+    BOOST_CHECK_EQUAL(found, 3U);
+    BOOST_REQUIRE_EQUAL(solutions.size(), 3U);
+    for (const auto& solution : solutions) {
+        BOOST_CHECK(equihash::VerifySolution(input, sizeof(input), solution));
+    }
+
+    // A solution is bound to its input
+    std::vector<unsigned char> other_input(input, input + sizeof(input));
+    other_input[80] ^= 1;
+    BOOST_CHECK(!equihash::VerifySolution(other_input.data(), other_input.size(), solutions[0]));
+
+    // An interrupted search ends before reporting anything
+    std::atomic<bool> interrupt{true};
+    BOOST_CHECK_EQUAL(solver.Solve(input, sizeof(input), [](const std::vector<uint32_t>&) { return true; }, &interrupt), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(per_algorithm_block_index)
+{
+    // Mostly SHA256D with a rare RandomX block, as in a skewed hashrate mix
+    std::vector<CBlockIndex> blocks(2000);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        x25x::Algorithm algo = (i % 97 == 5) ? x25x::Algorithm::RANDOMX :
+                               (i % 3 == 0) ? x25x::Algorithm::SCRYPT : x25x::Algorithm::SHA256D;
+        blocks[i].nHeight = i;
+        blocks[i].nTime = 1700000000 + i * 60 + (i % 7);
+        blocks[i].nVersion = x25x::SetBlockAlgorithm(0x20000000, algo);
+        blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+        blocks[i].BuildSkip();
+    }
+
+    const x25x::Algorithm algos[] = {x25x::Algorithm::SHA256D, x25x::Algorithm::SCRYPT,
+                                     x25x::Algorithm::RANDOMX, x25x::Algorithm::X11};
+    for (size_t i = 0; i < blocks.size(); i += 37) {
+        for (x25x::Algorithm algo : algos) {
+            // Reference: walk pprev one block at a time
+            const CBlockIndex* last = nullptr;
+            std::vector<int64_t> times;
+            int count = 0;
+            for (const CBlockIndex* p = &blocks[i]; p; p = p->pprev) {
+                if (x25x::GetBlockAlgorithm(p->nVersion) != algo) continue;
+                if (!last) last = p;
+                if (p->nHeight > blocks[i].nHeight - 100) count++;
+                if (times.size() < 11) times.push_back(p->GetBlockTime());
+            }
+            int64_t average = times.size() < 2 ? 0 : (times.front() - times.back()) / int64_t(times.size() - 1);
+
+            BOOST_CHECK(x25x::MultiAlgoDifficultyManager::GetLastBlockForAlgorithm(&blocks[i], algo) == last);
+            BOOST_CHECK_EQUAL(x25x::MultiAlgoDifficultyManager::CountBlocksForAlgorithm(&blocks[i], 100, algo), count);
+            BOOST_CHECK_EQUAL(x25x::MultiAlgoDifficultyManager::GetAverageBlockTimeForAlgorithm(&blocks[i], algo, 10), average);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,18 +3,26 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <trust/heartbeat_net.h>
+#include <crypto/siphash.h>
 #include <hash.h>
 #include <logging.h>
+#include <memusage.h>
 #include <net.h>
+#include <streams.h>
 #include <util/time.h>
+#include <util/trace.h>
+
+#include <algorithm>
+
+TRACEPOINT_SEMAPHORE(trust, heartbeats_processed);
 
 namespace trust {
 
 // Global instance
 std::unique_ptr<HeartbeatManager> g_heartbeat_manager;
 
-void InitHeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params) {
-    g_heartbeat_manager = std::make_unique<HeartbeatManager>(trustManager, params);
+void InitHeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params, int workerThreads) {
+    g_heartbeat_manager = std::make_unique<HeartbeatManager>(trustManager, params, workerThreads);
 }
 
 void ShutdownHeartbeatManager() {
@@ -42,15 +50,100 @@ bool ValidatorRegistration::Verify() const {
     return validatorPubKey.Verify(hash, signature);
 }
 
+// CompactHeartbeats implementation
+
+CompactHeartbeats::CompactHeartbeats(const uint256& hash, int height, uint64_t nonceIn, const std::vector<Heartbeat>& heartbeats)
+    : blockHash(hash), blockHeight(height), nonce(nonceIn) {
+    FillShortIDSelector();
+    shortids.reserve(heartbeats.size());
+    for (const Heartbeat& hb : heartbeats) {
+        shortids.push_back(GetShortID(hb.GetHash()));
+    }
+}
+
+void CompactHeartbeats::FillShortIDSelector() const {
+    HashWriter ss{};
+    ss << blockHash << blockHeight << nonce;
+    uint256 shortidhash = ss.GetSHA256();
+    shortidk0 = shortidhash.GetUint64(0);
+    shortidk1 = shortidhash.GetUint64(1);
+}
+
+uint64_t CompactHeartbeats::GetShortID(const uint256& heartbeatHash) const {
+    static_assert(SHORTIDS_LENGTH == 6, "short ID calculation assumes 6-byte short IDs");
+    return SipHashUint256(shortidk0, shortidk1, heartbeatHash) & 0xffffffffffffL;
+}
+
+std::optional<bool> HeartbeatSignatureCheck::operator()() {
+    if (m_heartbeat->Verify(m_pubkey)) {
+        return std::nullopt;
+    }
+    return false;
+}
+
+// HeartbeatReplayFilter implementation
+
+HeartbeatReplayFilter::HeartbeatReplayFilter(int windowBlocks, size_t maxRecent)
+    : m_window_blocks(windowBlocks), m_max_recent(maxRecent) {}
+
+bool HeartbeatReplayFilter::Insert(const uint256& hash, int height) {
+    if (Contains(hash)) {
+        return false;
+    }
+
+    if (height < m_expired_height) {
+        m_old.insert(hash);
+        return true;
+    }
+
+    m_recent.insert(hash);
+    m_buckets[height].push_back(hash);
+    while (m_recent.size() > m_max_recent) {
+        ExpireBucket(m_buckets.begin());
+    }
+    return true;
+}
+
+bool HeartbeatReplayFilter::Contains(const uint256& hash) const {
+    return m_recent.count(hash) > 0 || m_old.contains(hash);
+}
+
+void HeartbeatReplayFilter::Expire(int height) {
+    m_expired_height = std::max(m_expired_height, height - m_window_blocks);
+    // One bucket per block in the steady state
+    while (!m_buckets.empty() && m_buckets.begin()->first < m_expired_height) {
+        ExpireBucket(m_buckets.begin());
+    }
+}
+
+void HeartbeatReplayFilter::ExpireBucket(std::map<int, std::vector<uint256>>::iterator it) {
+    for (const uint256& hash : it->second) {
+        m_recent.erase(hash);
+        m_old.insert(hash);
+    }
+    m_buckets.erase(it);
+}
+
+size_t HeartbeatReplayFilter::DynamicMemoryUsage() const {
+    size_t usage = memusage::DynamicUsage(m_recent) + memusage::DynamicUsage(m_buckets) + m_old.DynamicMemoryUsage();
+    for (const auto& [height, bucket] : m_buckets) {
+        usage += memusage::DynamicUsage(bucket);
+    }
+    return usage;
+}
+
 // HeartbeatManager implementation
 
-HeartbeatManager::HeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params)
-    : m_trust_manager(trustManager), m_consensus_params(params) {}
+HeartbeatManager::HeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params, int workerThreads)
+    : m_trust_manager(trustManager), m_consensus_params(params),
+      m_seen_heartbeats(2 * params.nHeartbeatInterval, MAX_SEEN_HEARTBEATS),
+      m_check_queue(/*batch_size=*/16, workerThreads, "Heartbeat signature", "heartbch") {}
 
 void HeartbeatManager::SetValidatorKey(const CKey& key) {
     LOCK(cs_heartbeat);
     m_validator_key = std::make_unique<CKey>(key);
     m_is_validator = true;
+    m_validator_pubkeys[key.GetPubKey().GetID()] = key.GetPubKey();
     LogPrintf("HeartbeatManager: Configured as validator with pubkey %s\n",
               HexStr(key.GetPubKey()));
 }
@@ -109,13 +202,13 @@ bool HeartbeatManager::BroadcastHeartbeat(int blockHeight, const uint256& blockH
     }
 
     // Record that we've seen our own heartbeat
-    m_seen_heartbeats.insert(hb.GetHash());
+    m_seen_heartbeats.Insert(hb.GetHash(), hb.blockHeight);
 
     // Update last broadcast height
     m_last_heartbeat_height = blockHeight;
 
-    // TODO: Broadcast to network via net_processing when fully integrated
-    // The heartbeat message will be relayed via the P2P protocol
+    // Relayed with the next announcement of the block's heartbeats
+    AddRelayHeartbeat(hb, /*accepted=*/true);
 
     LogPrintf("HeartbeatManager: Broadcast heartbeat at height %d from %s\n",
               blockHeight, hb.GetNodeAddressString());
@@ -123,27 +216,90 @@ bool HeartbeatManager::BroadcastHeartbeat(int blockHeight, const uint256& blockH
 }
 
 bool HeartbeatManager::ProcessHeartbeat(const Heartbeat& heartbeat, NodeId from) {
-    LOCK(cs_heartbeat);
+    const bool traced{TRACEPOINT_ACTIVE(trust, heartbeats_processed)};
+    const auto start{traced ? SteadyClock::now() : SteadyClock::time_point{}};
+    bool accepted{false};
+    {
+        LOCK(cs_heartbeat);
+        if (m_seen_heartbeats.Contains(heartbeat.GetHash())) {
+            // Already processed
+        } else if (auto it = m_validator_pubkeys.find(heartbeat.validatorId);
+                   it != m_validator_pubkeys.end() && !heartbeat.Verify(it->second)) {
+            // The hash does not cover the signature, so a forgery must not reach the seen set
+            LogPrintf("HeartbeatManager: Invalid heartbeat signature from peer=%d\n", from);
+        } else {
+            accepted = ProcessCheckedHeartbeat(heartbeat);
+        }
+    }
+    TRACEPOINT(trust, heartbeats_processed,
+        from,
+        uint32_t{1},
+        static_cast<uint32_t>(accepted),
+        Ticks<std::chrono::microseconds>(SteadyClock::now() - start)
+    );
+    return accepted;
+}
 
-    // Check if we've already seen this heartbeat
-    uint256 hbHash = heartbeat.GetHash();
-    if (m_seen_heartbeats.count(hbHash) > 0) {
-        return false; // Already processed
+size_t HeartbeatManager::ProcessHeartbeats(const std::vector<Heartbeat>& heartbeats, NodeId from) {
+    const bool traced{TRACEPOINT_ACTIVE(trust, heartbeats_processed)};
+    const auto start{traced ? SteadyClock::now() : SteadyClock::time_point{}};
+    std::vector<const Heartbeat*> fresh;
+    std::vector<HeartbeatSignatureCheck> checks;
+    {
+        LOCK(cs_heartbeat);
+        for (const Heartbeat& hb : heartbeats) {
+            if (m_seen_heartbeats.Contains(hb.GetHash())) {
+                continue;
+            }
+            fresh.push_back(&hb);
+            auto it = m_validator_pubkeys.find(hb.validatorId);
+            if (it != m_validator_pubkeys.end()) {
+                checks.emplace_back(hb, it->second);
+            }
+        }
     }
 
-    // Add to seen set
-    m_seen_heartbeats.insert(hbHash);
+    // Check the signatures without holding cs_heartbeat
+    if (!checks.empty()) {
+        CCheckQueueControl<HeartbeatSignatureCheck> control(&m_check_queue);
+        control.Add(std::move(checks));
+        if (control.Complete().has_value()) {
+            LogPrintf("HeartbeatManager: Invalid heartbeat signature in batch from peer=%d\n", from);
+            fresh.clear();
+        }
+    }
+
+    size_t processed = 0;
+    {
+        LOCK(cs_heartbeat);
+        for (const Heartbeat* hb : fresh) {
+            if (ProcessCheckedHeartbeat(*hb)) {
+                processed++;
+            }
+        }
+    }
+    TRACEPOINT(trust, heartbeats_processed,
+        from,
+        static_cast<uint32_t>(heartbeats.size()),
+        static_cast<uint32_t>(processed),
+        Ticks<std::chrono::microseconds>(SteadyClock::now() - start)
+    );
+    return processed;
+}
 
-    // Clean up if too many
-    if (m_seen_heartbeats.size() > MAX_SEEN_HEARTBEATS) {
-        CleanupSeenHeartbeats();
+bool HeartbeatManager::ProcessCheckedHeartbeat(const Heartbeat& heartbeat) {
+    // Check if we've already seen this heartbeat, and add it to the seen set
+    if (!m_seen_heartbeats.Insert(heartbeat.GetHash(), heartbeat.blockHeight)) {
+        return false; // Already processed
     }
 
     // Process the heartbeat in the trust manager
     if (!m_trust_manager.ProcessHeartbeat(heartbeat, heartbeat.blockHeight)) {
         LogPrintf("HeartbeatManager: Failed to process heartbeat from validator\n");
+        AddRelayHeartbeat(heartbeat, /*accepted=*/false);
         return false;
     }
+    AddRelayHeartbeat(heartbeat, /*accepted=*/true);
 
     // WATTx: Process IP address for trust scoring and peer discovery
     if (heartbeat.nodeAddress.IsValid()) {
@@ -173,13 +329,92 @@ bool HeartbeatManager::ProcessHeartbeat(const Heartbeat& heartbeat, NodeId from)
         }
     }
 
-    // TODO: Relay to other peers via net_processing when fully integrated
-
     LogPrintf("HeartbeatManager: Processed heartbeat from validator at height %d (IP: %s)\n",
               heartbeat.blockHeight, heartbeat.GetNodeAddressString());
     return true;
 }
 
+void HeartbeatManager::AddRelayHeartbeat(const Heartbeat& heartbeat, bool accepted) {
+    auto it = m_relay_blocks.find(heartbeat.blockHash);
+    if (it == m_relay_blocks.end()) {
+        // Rejected heartbeats only need remembering for blocks we announce
+        if (!accepted) {
+            return;
+        }
+        if (m_relay_blocks.size() >= MAX_RELAY_BLOCKS) {
+            auto lowest = std::min_element(m_relay_blocks.begin(), m_relay_blocks.end(),
+                [](const auto& a, const auto& b) { return a.second.height < b.second.height; });
+            if (lowest->second.height >= heartbeat.blockHeight) {
+                return;
+            }
+            m_relay_blocks.erase(lowest);
+        }
+        it = m_relay_blocks.emplace(heartbeat.blockHash, RelayBlock{}).first;
+        it->second.height = heartbeat.blockHeight;
+    }
+
+    RelayBlock& block = it->second;
+    if (!block.known.insert(heartbeat.GetHash()).second) {
+        return;
+    }
+    if (accepted && block.heartbeats.size() < MAX_RELAY_HEARTBEATS) {
+        block.heartbeats.push_back(heartbeat);
+        block.announced = false;
+    }
+}
+
+std::vector<CompactHeartbeats> HeartbeatManager::GetHeartbeatAnnouncements(uint64_t nonce) {
+    LOCK(cs_heartbeat);
+    std::vector<CompactHeartbeats> announcements;
+    for (auto& [hash, block] : m_relay_blocks) {
+        if (block.announced) {
+            continue;
+        }
+        // The whole set, so peers that missed an earlier announcement catch up
+        announcements.emplace_back(hash, block.height, nonce, block.heartbeats);
+        block.announced = true;
+    }
+    return announcements;
+}
+
+bool HeartbeatManager::GetMissingHeartbeats(const CompactHeartbeats& compact, HeartbeatsRequest& request) const {
+    LOCK(cs_heartbeat);
+    request.blockHash = compact.blockHash;
+    request.indexes.clear();
+
+    std::unordered_set<uint64_t> have;
+    auto it = m_relay_blocks.find(compact.blockHash);
+    if (it != m_relay_blocks.end()) {
+        for (const uint256& hash : it->second.known) {
+            have.insert(compact.GetShortID(hash));
+        }
+    }
+    for (size_t i = 0; i < compact.shortids.size(); i++) {
+        if (!have.count(compact.shortids[i])) {
+            request.indexes.push_back(i);
+        }
+    }
+    return !request.indexes.empty();
+}
+
+bool HeartbeatManager::GetRequestedHeartbeats(const HeartbeatsRequest& request, BlockHeartbeats& response) const {
+    LOCK(cs_heartbeat);
+    auto it = m_relay_blocks.find(request.blockHash);
+    if (it == m_relay_blocks.end()) {
+        return false;
+    }
+
+    response.blockHash = request.blockHash;
+    response.heartbeats.clear();
+    for (uint16_t index : request.indexes) {
+        if (index >= it->second.heartbeats.size()) {
+            return false;
+        }
+        response.heartbeats.push_back(it->second.heartbeats[index]);
+    }
+    return true;
+}
+
 bool HeartbeatManager::ProcessValidatorRegistration(const ValidatorRegistration& reg, NodeId from) {
     // Verify signature
     if (!reg.Verify()) {
@@ -202,6 +437,12 @@ bool HeartbeatManager::ProcessValidatorRegistration(const ValidatorRegistration&
         return false;
     }
 
+    {
+        LOCK(cs_heartbeat);
+        m_validator_pubkeys[validatorId] = reg.validatorPubKey;
+        m_validator_list_cache.reset();
+    }
+
     // TODO: Relay to other peers via net_processing when fully integrated
 
     LogPrintf("HeartbeatManager: Registered validator with stake %lld\n", reg.stakeAmount);
@@ -234,22 +475,53 @@ ValidatorList HeartbeatManager::GetValidatorList() const {
     return list;
 }
 
+std::shared_ptr<const std::vector<unsigned char>> HeartbeatManager::GetSerializedValidatorList() const {
+    LOCK(cs_heartbeat);
+    const int height = m_trust_manager.GetHeight();
+    if (!m_validator_list_cache || m_validator_list_cache_height != height) {
+        auto data = std::make_shared<std::vector<unsigned char>>();
+        VectorWriter{*data, 0, GetValidatorList()};
+        m_validator_list_cache = std::move(data);
+        m_validator_list_cache_height = height;
+    }
+    return m_validator_list_cache;
+}
+
 void HeartbeatManager::ProcessValidatorList(const ValidatorList& list) {
     // Process each validator in the list
     // This is used for initial sync when connecting to the network
+    bool added = false;
     for (const auto& info : list.validators) {
         if (info.isActive && info.MeetsMinimumStake(m_consensus_params)) {
             // Re-register the validator if we don't know about them
             const ValidatorInfo* existing = m_trust_manager.GetValidator(info.validatorId);
             if (!existing) {
-                m_trust_manager.RegisterValidator(info.validatorId, info.stakeAmount,
-                                                  info.poolFeeRate, info.registrationHeight);
+                added |= m_trust_manager.RegisterValidator(info.validatorId, info.stakeAmount,
+                                                           info.poolFeeRate, info.registrationHeight);
             }
         }
     }
+    if (added) {
+        WITH_LOCK(cs_heartbeat, m_validator_list_cache.reset());
+    }
+}
+
+std::vector<CService> HeartbeatManager::GetValidatorRelayPeers() const {
+    LOCK(cs_heartbeat);
+    if (!g_peer_discovery) {
+        return {};
+    }
+    return g_peer_discovery->GetRelayCandidates(m_trust_manager);
 }
 
 void HeartbeatManager::OnNewBlock(int height) {
+    {
+        LOCK(cs_heartbeat);
+        m_seen_heartbeats.Expire(height);
+        const int relayCutoff = height - 2 * m_consensus_params.nHeartbeatInterval;
+        std::erase_if(m_relay_blocks, [&](const auto& entry) { return entry.second.height < relayCutoff; });
+    }
+
     // Update heartbeat expectations in trust manager
     m_trust_manager.UpdateHeartbeatExpectations(height);
     m_trust_manager.SetHeight(height);
@@ -262,15 +534,15 @@ void HeartbeatManager::OnNewBlock(int height) {
     }
 }
 
-void HeartbeatManager::CleanupSeenHeartbeats() {
+void HeartbeatManager::OnBlockDisconnected(int height) {
+    m_trust_manager.DisconnectBlock(height);
+    m_trust_manager.SetHeight(height - 1);
+}
+
+bool HeartbeatManager::LoadTrustState(const CDBWrapper::Records& records) {
     LOCK(cs_heartbeat);
-    // Simple cleanup: just clear half when we hit the limit
-    // In production, would want time-based expiry
-    if (m_seen_heartbeats.size() > MAX_SEEN_HEARTBEATS / 2) {
-        auto it = m_seen_heartbeats.begin();
-        std::advance(it, m_seen_heartbeats.size() / 2);
-        m_seen_heartbeats.erase(m_seen_heartbeats.begin(), it);
-    }
+    m_validator_list_cache.reset();
+    return m_trust_manager.LoadDBRecords(records);
 }
 
 HeartbeatManager::Stats HeartbeatManager::GetStats() const {
@@ -278,7 +550,9 @@ HeartbeatManager::Stats HeartbeatManager::GetStats() const {
     Stats stats;
     stats.isValidator = m_is_validator;
     stats.lastHeartbeatHeight = m_last_heartbeat_height;
-    stats.seenHeartbeats = m_seen_heartbeats.size();
+    stats.seenHeartbeats = m_seen_heartbeats.RecentSize();
+    stats.seenFilterBytes = m_seen_heartbeats.DynamicMemoryUsage();
+    stats.seenFalsePositiveRate = HeartbeatReplayFilter::OLD_FALSE_POSITIVE_RATE;
     stats.activeValidators = m_trust_manager.GetActiveValidators().size();
     return stats;
 }
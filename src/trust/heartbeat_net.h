@@ -6,15 +6,22 @@
 #define WATTX_TRUST_HEARTBEAT_NET_H
 
 #include <trust/trustscore.h>
+#include <blockencodings.h>
+#include <checkqueue.h>
+#include <common/bloom.h>
 #include <net.h>
 #include <protocol.h>
 #include <sync.h>
 #include <uint256.h>
+#include <util/hasher.h>
 #include <key.h>
 
 #include <atomic>
+#include <map>
 #include <memory>
-#include <set>
+#include <optional>
+#include <unordered_set>
+#include <vector>
 
 class CChainState;
 class CConnman;
@@ -56,6 +63,128 @@ public:
     }
 };
 
+/**
+ * Announcement of the heartbeats a node holds for one block, sent once per
+ * block instead of relaying each heartbeat on its own. Heartbeats are named by
+ * short IDs salted with the block hash and a per-announcement nonce, as in
+ * compact blocks, so peers only fetch the ones they are missing.
+ */
+class CompactHeartbeats {
+public:
+    static constexpr int SHORTIDS_LENGTH = 6;
+
+    uint256 blockHash;
+    int blockHeight{0};
+    uint64_t nonce{0};
+    std::vector<uint64_t> shortids;
+
+    CompactHeartbeats() = default;
+    CompactHeartbeats(const uint256& hash, int height, uint64_t nonceIn, const std::vector<Heartbeat>& heartbeats);
+
+    uint64_t GetShortID(const uint256& heartbeatHash) const;
+
+    SERIALIZE_METHODS(CompactHeartbeats, obj) {
+        READWRITE(obj.blockHash, obj.blockHeight, obj.nonce,
+                  Using<VectorFormatter<CustomUintFormatter<SHORTIDS_LENGTH>>>(obj.shortids));
+        if (ser_action.ForRead()) {
+            if (obj.shortids.size() > std::numeric_limits<uint16_t>::max()) {
+                throw std::ios_base::failure("indexes overflowed 16 bits");
+            }
+            obj.FillShortIDSelector();
+        }
+    }
+
+private:
+    mutable uint64_t shortidk0{0}, shortidk1{0};
+
+    void FillShortIDSelector() const;
+};
+
+/**
+ * Request for heartbeats of a CompactHeartbeats announcement, by index
+ */
+class HeartbeatsRequest {
+public:
+    uint256 blockHash;
+    std::vector<uint16_t> indexes;
+
+    SERIALIZE_METHODS(HeartbeatsRequest, obj) {
+        READWRITE(obj.blockHash, Using<VectorFormatter<DifferenceFormatter>>(obj.indexes));
+    }
+};
+
+/**
+ * Heartbeats sent in response to a HeartbeatsRequest
+ */
+class BlockHeartbeats {
+public:
+    uint256 blockHash;
+    std::vector<Heartbeat> heartbeats;
+
+    SERIALIZE_METHODS(BlockHeartbeats, obj) {
+        READWRITE(obj.blockHash, obj.heartbeats);
+    }
+};
+
+/**
+ * Verifies a heartbeat signature on a CCheckQueue worker
+ */
+class HeartbeatSignatureCheck {
+private:
+    const Heartbeat* m_heartbeat;
+    CPubKey m_pubkey;
+
+public:
+    HeartbeatSignatureCheck(const Heartbeat& heartbeat, const CPubKey& pubkey) : m_heartbeat(&heartbeat), m_pubkey(pubkey) {}
+
+    std::optional<bool> operator()();
+};
+
+/**
+ * Replay filter for heartbeats. Heartbeats of recent heights are kept in an
+ * exact set, bucketed by height. Expiring a height moves its bucket into a
+ * rolling bloom filter, which still catches old replays. Its false positives
+ * only drop old heartbeats.
+ */
+class HeartbeatReplayFilter {
+public:
+    static constexpr unsigned int MAX_OLD_HEARTBEATS = 50000;
+    static constexpr double OLD_FALSE_POSITIVE_RATE = 0.000001;
+
+    /**
+     * @param windowBlocks Heights kept exact below the last expiry height
+     * @param maxRecent    Heartbeats kept exact, the lowest heights expire first beyond it
+     */
+    HeartbeatReplayFilter(int windowBlocks, size_t maxRecent);
+
+    /**
+     * Remember a heartbeat
+     * @return false if it was already seen
+     */
+    bool Insert(const uint256& hash, int height);
+
+    bool Contains(const uint256& hash) const;
+
+    /**
+     * Expire the heights older than the window below height
+     */
+    void Expire(int height);
+
+    size_t RecentSize() const { return m_recent.size(); }
+    size_t DynamicMemoryUsage() const;
+
+private:
+    void ExpireBucket(std::map<int, std::vector<uint256>>::iterator it);
+
+    const int m_window_blocks;
+    const size_t m_max_recent;
+    // Heartbeats of heights below this are only in the bloom filter
+    int m_expired_height{0};
+    std::unordered_set<uint256, SaltedSipHasher> m_recent;
+    std::map<int, std::vector<uint256>> m_buckets;
+    CRollingBloomFilter m_old{MAX_OLD_HEARTBEATS, OLD_FALSE_POSITIVE_RATE};
+};
+
 /**
  * Heartbeat network manager - handles broadcasting and receiving heartbeats
  */
@@ -74,17 +203,54 @@ private:
     const Consensus::Params& m_consensus_params;
 
     // Recently seen heartbeats (to prevent replay)
-    std::set<uint256> m_seen_heartbeats GUARDED_BY(cs_heartbeat);
     static constexpr size_t MAX_SEEN_HEARTBEATS = 10000;
+    HeartbeatReplayFilter m_seen_heartbeats GUARDED_BY(cs_heartbeat);
 
     // Last heartbeat height we broadcast
     int m_last_heartbeat_height GUARDED_BY(cs_heartbeat){0};
 
+    // Public keys from verified registrations, to check heartbeat signatures
+    std::map<CKeyID, CPubKey> m_validator_pubkeys GUARDED_BY(cs_heartbeat);
+
+    // Heartbeats accepted per block, relayed in the next block's announcement.
+    // Only appended to, as announced indexes must stay valid.
+    struct RelayBlock {
+        int height{0};
+        std::vector<Heartbeat> heartbeats;
+        // Hashes of all heartbeats processed for the block, accepted or not
+        std::unordered_set<uint256, SaltedSipHasher> known;
+        bool announced{false};
+    };
+    static constexpr size_t MAX_RELAY_BLOCKS = 16;
+    static constexpr size_t MAX_RELAY_HEARTBEATS = std::numeric_limits<uint16_t>::max();
+    std::map<uint256, RelayBlock> m_relay_blocks GUARDED_BY(cs_heartbeat);
+
+    // Serialized reply to getvalidators, rebuilt once per block height or
+    // after the validator set changed, so repeated requests cost one copy
+    mutable std::shared_ptr<const std::vector<unsigned char>> m_validator_list_cache GUARDED_BY(cs_heartbeat);
+    mutable int m_validator_list_cache_height GUARDED_BY(cs_heartbeat){-1};
+
+    // Verifies the signatures of heartbeat batches in parallel
+    CCheckQueue<HeartbeatSignatureCheck> m_check_queue;
+
     // Connection manager for broadcasting
     CConnman* m_connman{nullptr};
 
+    /**
+     * Process a heartbeat whose signature has been checked
+     */
+    bool ProcessCheckedHeartbeat(const Heartbeat& heartbeat) EXCLUSIVE_LOCKS_REQUIRED(cs_heartbeat);
+
+    /**
+     * Remember a heartbeat for the next announcement of its block
+     */
+    void AddRelayHeartbeat(const Heartbeat& heartbeat, bool accepted) EXCLUSIVE_LOCKS_REQUIRED(cs_heartbeat);
+
 public:
-    HeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params);
+    /**
+     * @param workerThreads Threads checking heartbeat signatures besides the calling one
+     */
+    HeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params, int workerThreads = 0);
 
     /**
      * Set this node as a validator with the given key
@@ -122,6 +288,31 @@ public:
      */
     bool ProcessHeartbeat(const Heartbeat& heartbeat, NodeId from);
 
+    /**
+     * Process heartbeats received in one message. Signatures are checked in
+     * parallel, and the whole batch is dropped if one of them is invalid.
+     * Returns the number of heartbeats that were valid and new
+     */
+    size_t ProcessHeartbeats(const std::vector<Heartbeat>& heartbeats, NodeId from);
+
+    /**
+     * Get the announcements of blocks whose heartbeats changed since they
+     * were last announced. Called once per block.
+     */
+    std::vector<CompactHeartbeats> GetHeartbeatAnnouncements(uint64_t nonce);
+
+    /**
+     * Find the heartbeats of an announcement we do not know yet
+     * Returns false if none are missing
+     */
+    bool GetMissingHeartbeats(const CompactHeartbeats& compact, HeartbeatsRequest& request) const;
+
+    /**
+     * Look up the heartbeats requested by a peer
+     * Returns false if the block is unknown or an index is out of range
+     */
+    bool GetRequestedHeartbeats(const HeartbeatsRequest& request, BlockHeartbeats& response) const;
+
     /**
      * Process a validator registration message
      */
@@ -138,20 +329,37 @@ public:
      */
     ValidatorList GetValidatorList() const;
 
+    /**
+     * Get the serialized validator list for responding to getvalidators,
+     * cached per block height
+     */
+    std::shared_ptr<const std::vector<unsigned char>> GetSerializedValidatorList() const;
+
     /**
      * Process received validator list
      */
     void ProcessValidatorList(const ValidatorList& list);
 
+    /**
+     * Get the addresses to fill the validator relay connection slots with,
+     * ranked by peer discovery from the trust tiers, best first
+     */
+    std::vector<CService> GetValidatorRelayPeers() const;
+
     /**
      * Update heartbeat expectations at new block height
      */
     void OnNewBlock(int height);
 
     /**
-     * Clean up old seen heartbeats to prevent memory growth
+     * Revert the heartbeat expectations of a disconnected block
+     */
+    void OnBlockDisconnected(int height);
+
+    /**
+     * Replace the trust state with the records of a validator state snapshot
      */
-    void CleanupSeenHeartbeats();
+    bool LoadTrustState(const CDBWrapper::Records& records);
 
     /**
      * Get statistics for logging/RPC
@@ -159,7 +367,9 @@ public:
     struct Stats {
         bool isValidator;
         int lastHeartbeatHeight;
-        size_t seenHeartbeats;
+        size_t seenHeartbeats;        // Heartbeats of recent heights, kept exact
+        size_t seenFilterBytes;       // Memory used by the replay filter
+        double seenFalsePositiveRate; // Upper bound for heartbeats older than the exact window
         int activeValidators;
     };
     Stats GetStats() const;
@@ -179,7 +389,7 @@ extern std::unique_ptr<HeartbeatManager> g_heartbeat_manager;
 /**
  * Initialize the heartbeat manager
  */
-void InitHeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params);
+void InitHeartbeatManager(TrustScoreManager& trustManager, const Consensus::Params& params, int workerThreads = 0);
 
 /**
  * Shutdown the heartbeat manager
@@ -6,9 +6,12 @@
 #include <hash.h>
 #include <logging.h>
 #include <netbase.h>
+#include <random.h>
 #include <util/time.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 namespace trust {
 
@@ -132,10 +135,171 @@ bool Heartbeat::Verify(const CPubKey& pubkey) const {
     return pubkey.Verify(hash, signature);
 }
 
+// TrustTierSnapshot implementation
+
+const TrustTierSnapshot::Entry* TrustTierSnapshot::Find(const CKeyID& validatorId) const {
+    auto it = validators.find(validatorId);
+    if (it == validators.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+TrustTier TrustTierSnapshot::GetTier(const CKeyID& validatorId) const {
+    const Entry* entry = Find(validatorId);
+    return entry ? entry->tier : TrustTier::NONE;
+}
+
 // TrustScoreManager implementation
 
 TrustScoreManager::TrustScoreManager(const Consensus::Params& params)
-    : consensusParams(params), currentHeight(0) {}
+    : consensusParams(params), currentHeight(0),
+      m_tier_snapshot(std::make_shared<const TrustTierSnapshot>()) {}
+
+TrustScoreManager::TrustScoreManager(const Consensus::Params& params, const fs::path& path, size_t cache_size, bool memory_only)
+    : TrustScoreManager(params)
+{
+    DBParams db_params{};
+    db_params.path = path;
+    db_params.cache_bytes = cache_size;
+    db_params.memory_only = memory_only;
+    db_params.wipe_data = false;
+    db_params.obfuscate = true;
+
+    m_db = std::make_unique<CDBWrapper>(db_params);
+
+    if (!LoadFromDB()) {
+        LogPrintf("TrustScoreManager: No existing trust state loaded (new database)\n");
+    }
+}
+
+bool TrustScoreManager::WriteValidatorToDB(const ValidatorInfo& info) {
+    if (!m_db) return false;
+    auto deadline = m_checkin_deadlines.find(info.validatorId);
+    const int checkInDeadline = deadline != m_checkin_deadlines.end() ? deadline->second : NO_DEADLINE;
+    return m_db->Write(std::make_pair(DB_VALIDATOR, info.validatorId), std::make_pair(info, checkInDeadline));
+}
+
+bool TrustScoreManager::WriteBlockToDB(int height, const BlockUndo& undo, bool disconnected) {
+    if (!m_db) return false;
+
+    CDBBatch batch(*m_db);
+    for (const auto& [id, entry] : undo) {
+        auto it = validators.find(id);
+        if (it == validators.end()) continue;
+        auto deadline = m_checkin_deadlines.find(id);
+        const int checkInDeadline = deadline != m_checkin_deadlines.end() ? deadline->second : NO_DEADLINE;
+        batch.Write(std::make_pair(DB_VALIDATOR, id), std::make_pair(it->second, checkInDeadline));
+    }
+    if (undo.empty() || disconnected) {
+        batch.Erase(std::make_pair(DB_UNDO, height));
+    } else {
+        batch.Write(std::make_pair(DB_UNDO, height), undo);
+    }
+    batch.Write(DB_HEIGHT, currentHeight);
+    return m_db->WriteBatch(batch);
+}
+
+bool TrustScoreManager::LoadFromDB() {
+    if (!m_db) return false;
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(DB_VALIDATOR, CKeyID()));
+
+    size_t count = 0;
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CKeyID> key;
+        if (!pcursor->GetKey(key) || key.first != DB_VALIDATOR) {
+            break;
+        }
+
+        std::pair<ValidatorInfo, int> record;
+        if (pcursor->GetValue(record)) {
+            const ValidatorInfo& info = record.first;
+            validators[info.validatorId] = info;
+            if (const int next = NextExpectationHeight(info); next != NO_DEADLINE) {
+                m_expectation_queue.push({next, info.validatorId});
+            }
+            if (record.second != NO_DEADLINE) {
+                ScheduleCheckIn(info.validatorId, record.second);
+            }
+            count++;
+        }
+
+        pcursor->Next();
+    }
+
+    pcursor->Seek(std::make_pair(DB_UNDO, 0));
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, int> key;
+        if (!pcursor->GetKey(key) || key.first != DB_UNDO) {
+            break;
+        }
+        BlockUndo undo;
+        if (pcursor->GetValue(undo)) {
+            m_undo[key.second] = std::move(undo);
+        }
+        pcursor->Next();
+    }
+
+    m_db->Read(DB_HEIGHT, currentHeight);
+    if (count == 0) {
+        return false;
+    }
+
+    // Consensus checks can read the tiers right away
+    PublishTierSnapshot(currentHeight);
+    LogPrintf("TrustScoreManager: Loaded %u validators at height %d\n", count, currentHeight);
+    return true;
+}
+
+CDBWrapper::Records TrustScoreManager::GetDBRecords() const {
+    if (!m_db) return {};
+    return m_db->ReadAllRecords();
+}
+
+bool TrustScoreManager::LoadDBRecords(const CDBWrapper::Records& records) {
+    if (!m_db || !m_db->ReplaceAllRecords(records)) return false;
+
+    validators.clear();
+    m_expectation_queue = {};
+    m_checkin_queue = {};
+    m_checkin_deadlines.clear();
+    m_undo.clear();
+    if (!LoadFromDB()) {
+        // Nothing loaded, drop the tiers of the replaced set
+        PublishTierSnapshot(currentHeight);
+    }
+    return true;
+}
+
+int TrustScoreManager::NextExpectationHeight(const ValidatorInfo& info) const {
+    const int interval = consensusParams.nHeartbeatInterval;
+    const int next = info.heartbeatsExpected + 1;
+    if (!info.isActive || interval <= 0 || next > consensusParams.nUptimeWindow / interval) {
+        return NO_DEADLINE;
+    }
+    return info.registrationHeight + next * interval;
+}
+
+void TrustScoreManager::PruneUndo(int height) {
+    // Undo data is only kept as deep as a reorg is expected to go
+    for (auto it = m_undo.begin(); it != m_undo.end() && it->first <= height - MAX_UNDO_BLOCKS;) {
+        if (m_db) m_db->Erase(std::make_pair(DB_UNDO, it->first));
+        it = m_undo.erase(it);
+    }
+}
+
+void TrustScoreManager::ScheduleCheckIn(const CKeyID& validatorId, int deadline) {
+    m_checkin_deadlines[validatorId] = deadline;
+    m_checkin_queue.push({deadline, validatorId});
+}
+
+void TrustScoreManager::SaveUndo(BlockUndo& undo, const ValidatorInfo& info) const {
+    auto deadline = m_checkin_deadlines.find(info.validatorId);
+    undo.try_emplace(info.validatorId, UndoEntry{info.heartbeatsExpected, info.missedCheckIns, info.consecutiveCheckIns,
+                                                 deadline != m_checkin_deadlines.end() ? deadline->second : NO_DEADLINE});
+}
 
 bool TrustScoreManager::RegisterValidator(const CKeyID& validatorId,
                                           int64_t stakeAmount,
@@ -171,6 +335,11 @@ bool TrustScoreManager::RegisterValidator(const CKeyID& validatorId,
     info.isActive = true;
 
     validators[validatorId] = info;
+    if (const int next = NextExpectationHeight(info); next != NO_DEADLINE) {
+        m_expectation_queue.push({next, validatorId});
+    }
+    ScheduleCheckIn(validatorId, height + 2 * consensusParams.nHeartbeatInterval + 1);
+    WriteValidatorToDB(info);
 
     LogPrintf("TrustScoreManager: Registered validator with stake %lld, fee rate %lld bps\n",
               stakeAmount, poolFeeRate);
@@ -191,6 +360,7 @@ bool TrustScoreManager::UpdateStake(const CKeyID& validatorId, int64_t newStakeA
         LogPrintf("TrustScoreManager: Validator deactivated - stake below minimum\n");
     }
 
+    WriteValidatorToDB(it->second);
     return true;
 }
 
@@ -205,6 +375,7 @@ bool TrustScoreManager::UpdatePoolFee(const CKeyID& validatorId, int64_t newFeeR
     }
 
     it->second.poolFeeRate = newFeeRate;
+    WriteValidatorToDB(it->second);
     return true;
 }
 
@@ -232,6 +403,8 @@ bool TrustScoreManager::ProcessHeartbeat(const Heartbeat& heartbeat, int height)
     // Record heartbeat
     it->second.heartbeatsReceived++;
     it->second.lastHeartbeatHeight = height;
+    ScheduleCheckIn(heartbeat.validatorId, height + 2 * expectedInterval + 1);
+    WriteValidatorToDB(it->second);
 
     LogPrintf("TrustScoreManager: Processed heartbeat from validator at height %d\n", height);
     return true;
@@ -239,22 +412,88 @@ bool TrustScoreManager::ProcessHeartbeat(const Heartbeat& heartbeat, int height)
 
 void TrustScoreManager::UpdateHeartbeatExpectations(int height) {
     currentHeight = height;
+    BlockUndo& undo = m_undo[height];
 
-    for (auto& [id, info] : validators) {
-        if (!info.isActive) continue;
+    while (!m_expectation_queue.empty() && m_expectation_queue.top().height <= height) {
+        const Deadline next = m_expectation_queue.top();
+        m_expectation_queue.pop();
 
-        // Calculate expected heartbeats since registration
-        int blocksSinceRegistration = height - info.registrationHeight;
-        if (blocksSinceRegistration > 0) {
-            info.heartbeatsExpected = blocksSinceRegistration / consensusParams.nHeartbeatInterval;
+        auto it = validators.find(next.validatorId);
+        if (it == validators.end() || NextExpectationHeight(it->second) != next.height) {
+            continue; // Stale entry
         }
+        ValidatorInfo& info = it->second;
+        SaveUndo(undo, info);
+
+        // Expected heartbeats since registration, limited to the uptime window
+        int windowBlocks = std::min(height - info.registrationHeight, consensusParams.nUptimeWindow);
+        info.heartbeatsExpected = windowBlocks / consensusParams.nHeartbeatInterval;
 
-        // Apply uptime window limit
-        int windowBlocks = std::min(blocksSinceRegistration, consensusParams.nUptimeWindow);
-        if (windowBlocks > 0) {
-            info.heartbeatsExpected = windowBlocks / consensusParams.nHeartbeatInterval;
+        if (const int after = NextExpectationHeight(info); after != NO_DEADLINE) {
+            m_expectation_queue.push({after, next.validatorId});
         }
     }
+
+    WriteBlockToDB(height, undo);
+    PruneUndo(height);
+    PublishTierSnapshot(height);
+}
+
+bool TrustScoreManager::DisconnectBlock(int height) {
+    currentHeight = height - 1;
+
+    auto undo = m_undo.find(height);
+    if (undo == m_undo.end()) {
+        LogPrintf("TrustScoreManager: No undo data to disconnect block %d\n", height);
+        WriteBlockToDB(height, {}, /*disconnected=*/true);
+        PublishTierSnapshot(currentHeight);
+        return false;
+    }
+
+    for (const auto& [id, entry] : undo->second) {
+        auto it = validators.find(id);
+        if (it == validators.end()) continue;
+        ValidatorInfo& info = it->second;
+        info.heartbeatsExpected = entry.heartbeatsExpected;
+        info.missedCheckIns = entry.missedCheckIns;
+        info.consecutiveCheckIns = entry.consecutiveCheckIns;
+
+        if (const int next = NextExpectationHeight(info); next != NO_DEADLINE) {
+            m_expectation_queue.push({next, id});
+        }
+        if (entry.checkInDeadline != NO_DEADLINE) {
+            ScheduleCheckIn(id, entry.checkInDeadline);
+        }
+    }
+
+    WriteBlockToDB(height, undo->second, /*disconnected=*/true);
+    m_undo.erase(undo);
+    PublishTierSnapshot(currentHeight);
+    return true;
+}
+
+void TrustScoreManager::PublishTierSnapshot(int height) {
+    // Build outside the lock, readers only wait for the swap
+    auto snapshot = std::make_shared<TrustTierSnapshot>();
+    snapshot->height = height;
+    for (const auto& [id, info] : validators) {
+        snapshot->validators.emplace_hint(snapshot->validators.end(), id,
+            TrustTierSnapshot::Entry{info.GetTrustTier(consensusParams),
+                                     info.GetRewardMultiplier(consensusParams),
+                                     info.GetUptimePercentage()});
+    }
+
+    std::shared_ptr<const TrustTierSnapshot> old;
+    {
+        LOCK(cs_snapshot);
+        old = std::exchange(m_tier_snapshot, std::move(snapshot));
+    }
+    // The old snapshot is freed here, or by its last reader
+}
+
+std::shared_ptr<const TrustTierSnapshot> TrustScoreManager::GetTierSnapshot() const {
+    LOCK(cs_snapshot);
+    return m_tier_snapshot;
 }
 
 const ValidatorInfo* TrustScoreManager::GetValidator(const CKeyID& validatorId) const {
@@ -315,6 +554,7 @@ bool TrustScoreManager::DeactivateValidator(const CKeyID& validatorId) {
         return false;
     }
     it->second.isActive = false;
+    WriteValidatorToDB(it->second);
     return true;
 }
 
@@ -338,6 +578,7 @@ bool TrustScoreManager::UpdateValidatorAddress(const CKeyID& validatorId, const
     it->second.lastKnownAddress = address;
     it->second.lastCheckInTime = timestamp;
     it->second.consecutiveCheckIns++;
+    WriteValidatorToDB(it->second);
 
     LogPrintf("TrustScoreManager: Validator %s checked in from %s (consecutive: %d)\n",
               validatorId.ToString(), address.ToStringAddrPort(), it->second.consecutiveCheckIns);
@@ -393,20 +634,33 @@ CKeyID TrustScoreManager::GetValidatorIdByAddress(const CService& address) const
 
 void TrustScoreManager::RecordMissedCheckIns(int currentHeight) {
     int expectedInterval = consensusParams.nHeartbeatInterval;
+    BlockUndo& undo = m_undo[currentHeight];
+
+    while (!m_checkin_queue.empty() && m_checkin_queue.top().height <= currentHeight) {
+        const Deadline next = m_checkin_queue.top();
+        m_checkin_queue.pop();
 
-    for (auto& [id, info] : validators) {
-        if (!info.isActive) continue;
-
-        // Check if validator should have checked in by now
-        int blocksSinceLastCheckIn = currentHeight - info.lastHeartbeatHeight;
-        if (blocksSinceLastCheckIn > expectedInterval * 2) {
-            // Missed at least one check-in
-            info.missedCheckIns++;
-            info.consecutiveCheckIns = 0;
-            LogPrintf("TrustScoreManager: Validator %s missed check-in (total missed: %d)\n",
-                      id.ToString(), info.missedCheckIns);
+        auto deadline = m_checkin_deadlines.find(next.validatorId);
+        if (deadline == m_checkin_deadlines.end() || deadline->second != next.height) {
+            continue; // A heartbeat moved the deadline
         }
+        auto it = validators.find(next.validatorId);
+        if (it == validators.end() || !it->second.isActive) {
+            continue;
+        }
+        ValidatorInfo& info = it->second;
+        SaveUndo(undo, info);
+
+        // No check-in for two intervals, or for one more since the last miss
+        info.missedCheckIns++;
+        info.consecutiveCheckIns = 0;
+        LogPrintf("TrustScoreManager: Validator %s missed check-in (total missed: %d)\n",
+                  next.validatorId.ToString(), info.missedCheckIns);
+        ScheduleCheckIn(next.validatorId, next.height + expectedInterval);
     }
+
+    WriteBlockToDB(currentHeight, undo);
+    PruneUndo(currentHeight);
 }
 
 //////////////////////////////////////////////////
@@ -551,4 +805,31 @@ size_t PeerDiscoveryManager::GetKnownPeerCount() const {
     return knownValidatorPeers.size();
 }
 
+std::vector<CService> PeerDiscoveryManager::GetRelayCandidates(const TrustScoreManager& trustManager) const {
+    LOCK(cs_peers);
+
+    std::vector<CService> result;
+    std::set<CService> added;
+    FastRandomContext rng;
+
+    // Each lower tier also returns the tiers above it, which are already added
+    for (int tier = static_cast<int>(TrustTier::PLATINUM); tier >= static_cast<int>(TrustTier::NONE); --tier) {
+        const size_t tierStart = result.size();
+        for (const CService& address : trustManager.GetTrustedValidatorAddresses(static_cast<TrustTier>(tier))) {
+            if (added.insert(address).second) {
+                result.push_back(address);
+            }
+        }
+        // Spread the connections of different nodes over validators of a tier
+        std::shuffle(result.begin() + tierStart, result.end(), rng);
+    }
+
+    for (const CService& address : knownValidatorPeers) {
+        if (added.insert(address).second) {
+            result.push_back(address);
+        }
+    }
+    return result;
+}
+
 } // namespace trust
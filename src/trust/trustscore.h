@@ -6,6 +6,7 @@
 #define WATTX_TRUST_TRUSTSCORE_H
 
 #include <consensus/params.h>
+#include <dbwrapper.h>
 #include <key.h>
 #include <pubkey.h>
 #include <uint256.h>
@@ -13,9 +14,14 @@
 #include <netaddress.h>
 #include <netbase.h>
 #include <sync.h>
+#include <util/fs.h>
 
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <map>
+#include <memory>
+#include <queue>
 #include <set>
 #include <string>
 #include <vector>
@@ -202,8 +208,42 @@ public:
     std::string GetNodeAddressString() const;
 };
 
+/**
+ * Trust tiers of the registered validators as of a block, for consensus checks
+ */
+class TrustTierSnapshot {
+public:
+    struct Entry {
+        TrustTier tier;
+        int rewardMultiplier;     // Percentage, 100 = 1.0x
+        int uptime;               // Uptime percentage multiplied by 10
+    };
+
+    int height{-1};               // Block height the tiers were computed at
+    std::map<CKeyID, Entry> validators;
+
+    /**
+     * Get the entry of a registered validator, nullptr if not registered
+     */
+    const Entry* Find(const CKeyID& validatorId) const;
+
+    /**
+     * Get trust tier for a validator, NONE if not registered
+     */
+    TrustTier GetTier(const CKeyID& validatorId) const;
+};
+
 /**
  * Trust score manager - handles validator registration, heartbeat tracking, and tier calculation
+ *
+ * Block processing only visits validators whose next change is due: the
+ * heights at which their expected heartbeat count grows and at which they
+ * miss a check-in are kept in min-heaps. Entries are never removed from a
+ * heap, they are skipped once they no longer match the validator's state.
+ *
+ * With a database, validators, their check-in deadlines and the undo data of
+ * the last MAX_UNDO_BLOCKS blocks are persisted, so a restart does not need
+ * to relearn the validator set from heartbeats.
  */
 class TrustScoreManager {
 private:
@@ -211,9 +251,71 @@ private:
     const Consensus::Params& consensusParams;
     int currentHeight;
 
+    // Tiers published by the last UpdateHeartbeatExpectations(), replaced as a whole
+    mutable Mutex cs_snapshot;
+    std::shared_ptr<const TrustTierSnapshot> m_tier_snapshot GUARDED_BY(cs_snapshot);
+
+    struct Deadline {
+        int height;
+        CKeyID validatorId;
+
+        bool operator>(const Deadline& other) const { return height > other.height; }
+    };
+    using DeadlineQueue = std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>>;
+
+    static constexpr int NO_DEADLINE = std::numeric_limits<int>::max();
+
+    // Heights at which heartbeatsExpected grows, until it covers the uptime window
+    DeadlineQueue m_expectation_queue;
+    // Heights at which a validator without a newer heartbeat misses a check-in
+    DeadlineQueue m_checkin_queue;
+    std::map<CKeyID, int> m_checkin_deadlines;
+
+    // Validator state before a block changed it
+    struct UndoEntry {
+        int heartbeatsExpected;
+        int missedCheckIns;
+        int consecutiveCheckIns;
+        int checkInDeadline;
+
+        SERIALIZE_METHODS(UndoEntry, obj) {
+            READWRITE(obj.heartbeatsExpected, obj.missedCheckIns, obj.consecutiveCheckIns, obj.checkInDeadline);
+        }
+    };
+    using BlockUndo = std::map<CKeyID, UndoEntry>;
+    std::map<int, BlockUndo> m_undo;
+
+    // LevelDB persistence, null when not persisted
+    std::unique_ptr<CDBWrapper> m_db;
+
+    // Database keys
+    static constexpr uint8_t DB_VALIDATOR = 'v';
+    static constexpr uint8_t DB_UNDO = 'u';
+    static constexpr uint8_t DB_HEIGHT = 'h';
+
+    void PublishTierSnapshot(int height);
+
+    int NextExpectationHeight(const ValidatorInfo& info) const;
+    void ScheduleCheckIn(const CKeyID& validatorId, int deadline);
+    void SaveUndo(BlockUndo& undo, const ValidatorInfo& info) const;
+
+    bool WriteValidatorToDB(const ValidatorInfo& info);
+    // Write the validators a block changed, its undo data unless disconnected, and the height
+    bool WriteBlockToDB(int height, const BlockUndo& undo, bool disconnected = false);
+    void PruneUndo(int height);
+    bool LoadFromDB();
+
 public:
     explicit TrustScoreManager(const Consensus::Params& params);
 
+    /**
+     * Persist the trust state in a database at path, loading what it holds
+     */
+    TrustScoreManager(const Consensus::Params& params, const fs::path& path, size_t cache_size = 1 << 20, bool memory_only = false);
+
+    // Blocks whose changes can be reverted by DisconnectBlock()
+    static constexpr int MAX_UNDO_BLOCKS = 100;
+
     /**
      * Register a new validator
      */
@@ -236,10 +338,24 @@ public:
     bool ProcessHeartbeat(const Heartbeat& heartbeat, int height);
 
     /**
-     * Update expected heartbeats for all validators at new block height
+     * Update expected heartbeats at new block height, and publish the
+     * resulting tiers. Only visits validators whose expectation grows.
      */
     void UpdateHeartbeatExpectations(int height);
 
+    /**
+     * Revert what UpdateHeartbeatExpectations() and RecordMissedCheckIns()
+     * changed at height, when the block is disconnected
+     * Returns false if the block's undo data is no longer kept
+     */
+    bool DisconnectBlock(int height);
+
+    /**
+     * Get the tiers published at the last block. Never waits for heartbeat
+     * or registration processing, only for the pointer copy.
+     */
+    std::shared_ptr<const TrustTierSnapshot> GetTierSnapshot() const;
+
     /**
      * Get validator info by ID
      */
@@ -280,6 +396,17 @@ public:
      */
     void SetHeight(int height) { currentHeight = height; }
 
+    /**
+     * Raw database records, for a validator state snapshot
+     */
+    CDBWrapper::Records GetDBRecords() const;
+
+    /**
+     * Replace the database and the in-memory state with snapshot records,
+     * and publish the tiers they hold
+     */
+    bool LoadDBRecords(const CDBWrapper::Records& records);
+
     //////////////////////////////////////////////////
     // WATTx IP-Based Trust & Peer Discovery
     //////////////////////////////////////////////////
@@ -310,9 +437,15 @@ public:
     CKeyID GetValidatorIdByAddress(const CService& address) const;
 
     /**
-     * Record a missed check-in for validators that didn't report
+     * Record a missed check-in for validators that didn't report within two
+     * heartbeat intervals, and one more for each interval after
      */
     void RecordMissedCheckIns(int currentHeight);
+
+    /**
+     * Get the height of the last block processed
+     */
+    int GetHeight() const { return currentHeight; }
 };
 
 /**
@@ -374,6 +507,13 @@ public:
      * Get count of known validator peers
      */
     size_t GetKnownPeerCount() const;
+
+    /**
+     * Rank validator addresses for the validator relay connection slots,
+     * highest trust tier first and in random order within a tier. Known
+     * peers the trust manager has no address for come last.
+     */
+    std::vector<CService> GetRelayCandidates(const TrustScoreManager& trustManager) const;
 };
 
 /**
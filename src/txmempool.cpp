@@ -14,6 +14,7 @@
 #include <logging.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
+#include <privacy/consensus.h>
 #include <random.h>
 #include <tinyformat.h>
 #include <util/check.h>
@@ -493,6 +494,12 @@ void CTxMemPool::addNewTransaction(CTxMemPool::txiter newit, CTxMemPool::setEntr
         mapNextTx.insert(std::make_pair(&tx.vin[i].prevout, &tx));
         setParentTransactions.insert(tx.vin[i].prevout.hash);
     }
+    for (const uint256& key_image : privacy::GetTxKeyImageHashes(tx)) {
+        mapKeyImages.emplace(key_image, &tx);
+    }
+    if (entry.GetGasLimit() > 0) {
+        mapSenderTxs[entry.GetGasSummary().sender].insert(newit);
+    }
     // Don't bother worrying about child transactions of this one.
     // Normal case of a new transaction arriving is that there can't be any
     // children, because such children would be orphans.
@@ -544,6 +551,19 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 
     for (const CTxIn& txin : it->GetTx().vin)
         mapNextTx.erase(txin.prevout);
+    for (const uint256& key_image : privacy::GetTxKeyImageHashes(it->GetTx())) {
+        const auto ki_it = mapKeyImages.find(key_image);
+        if (ki_it != mapKeyImages.end() && ki_it->second == &it->GetTx()) {
+            mapKeyImages.erase(ki_it);
+        }
+    }
+    if (it->GetGasLimit() > 0) {
+        const auto sender_it = mapSenderTxs.find(it->GetGasSummary().sender);
+        if (sender_it != mapSenderTxs.end()) {
+            sender_it->second.erase(it);
+            if (sender_it->second.empty()) mapSenderTxs.erase(sender_it);
+        }
+    }
 
     RemoveUnbroadcastTx(it->GetTx().GetHash(), true /* add logging because unchecked */);
 
@@ -663,6 +683,18 @@ void CTxMemPool::removeConflicts(const CTransaction &tx)
             }
         }
     }
+    // ... and transactions which spend the same key images
+    for (const uint256& key_image : privacy::GetTxKeyImageHashes(tx)) {
+        auto it = mapKeyImages.find(key_image);
+        if (it != mapKeyImages.end()) {
+            const CTransaction &txConflict = *it->second;
+            if (txConflict != tx)
+            {
+                ClearPrioritisation(txConflict.GetHash());
+                removeRecursive(txConflict, MemPoolRemovalReason::CONFLICT);
+            }
+        }
+    }
 }
 
 /**
@@ -711,6 +743,8 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
     CAmount check_total_fee{0};
     uint64_t innerUsage = 0;
     uint64_t prev_ancestor_count{0};
+    size_t key_image_count{0};
+    size_t sender_tx_count{0};
 
     CCoinsViewCache mempoolDuplicate(const_cast<CCoinsViewCache*>(&active_coins_tip));
 
@@ -739,6 +773,20 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
             assert(it3->first == &txin.prevout);
             assert(it3->second == &tx);
         }
+        // Check whether its key images are marked in mapKeyImages.
+        for (const uint256& key_image : privacy::GetTxKeyImageHashes(tx)) {
+            auto it4 = mapKeyImages.find(key_image);
+            assert(it4 != mapKeyImages.end());
+            assert(it4->second == &tx);
+            ++key_image_count;
+        }
+        // Check whether it is indexed by its sender.
+        if (it->GetGasLimit() > 0) {
+            auto it5 = mapSenderTxs.find(it->GetGasSummary().sender);
+            assert(it5 != mapSenderTxs.end());
+            assert(it5->second.count(it));
+            ++sender_tx_count;
+        }
         auto comp = [](const CTxMemPoolEntry& a, const CTxMemPoolEntry& b) -> bool {
             return a.GetTx().GetHash() == b.GetTx().GetHash();
         };
@@ -796,6 +844,12 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
         assert(it2 != mapTx.end());
         assert(&tx == it->second);
     }
+    assert(mapKeyImages.size() == key_image_count);
+    for (const auto& [sender, txs] : mapSenderTxs) {
+        assert(!txs.empty());
+        sender_tx_count -= txs.size();
+    }
+    assert(sender_tx_count == 0);
 
     assert(totalTxSize == checkTotal);
     assert(m_total_fee == check_total_fee);
@@ -898,6 +952,15 @@ CTransactionRef CTxMemPool::get(const uint256& hash) const
     return i->GetSharedTx();
 }
 
+std::shared_ptr<const CachedQtumTX> CTxMemPool::GetQtumTX(const uint256& hash) const
+{
+    LOCK(cs);
+    indexed_transaction_set::const_iterator i = mapTx.find(hash);
+    if (i == mapTx.end())
+        return nullptr;
+    return i->GetQtumTX();
+}
+
 TxMempoolInfo CTxMemPool::info(const GenTxid& gtxid) const
 {
     LOCK(cs);
@@ -907,6 +970,24 @@ TxMempoolInfo CTxMemPool::info(const GenTxid& gtxid) const
     return GetInfo(i);
 }
 
+size_t CTxMemPool::GetSenderTxCount(const uint160& sender) const
+{
+    LOCK(cs);
+    const auto it = mapSenderTxs.find(sender);
+    return it == mapSenderTxs.end() ? 0 : it->second.size();
+}
+
+std::vector<CTransactionRef> CTxMemPool::GetSenderTxs(const uint160& sender) const
+{
+    LOCK(cs);
+    std::vector<CTransactionRef> result;
+    const auto it = mapSenderTxs.find(sender);
+    if (it == mapSenderTxs.end()) return result;
+    result.reserve(it->second.size());
+    for (const txiter& tx_it : it->second) result.push_back(tx_it->GetSharedTx());
+    return result;
+}
+
 TxMempoolInfo CTxMemPool::info_for_relay(const GenTxid& gtxid, uint64_t last_sequence) const
 {
     LOCK(cs);
@@ -992,6 +1073,12 @@ const CTransaction* CTxMemPool::GetConflictTx(const COutPoint& prevout) const
     return it == mapNextTx.end() ? nullptr : it->second;
 }
 
+const CTransaction* CTxMemPool::GetKeyImageConflictTx(const uint256& key_image) const
+{
+    const auto it = mapKeyImages.find(key_image);
+    return it == mapKeyImages.end() ? nullptr : it->second;
+}
+
 std::optional<CTxMemPool::txiter> CTxMemPool::GetIter(const uint256& txid) const
 {
     auto it = mapTx.find(txid);
@@ -1077,7 +1164,7 @@ void CCoinsViewMemPool::Reset()
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapKeyImages) + memusage::DynamicUsage(mapSenderTxs) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked) {
@@ -1419,11 +1506,12 @@ util::Result<std::pair<std::vector<FeeFrac>, std::vector<FeeFrac>>> CTxMemPool::
     return std::make_pair(old_chunks, new_chunks);
 }
 
-CTxMemPool::ChangeSet::TxHandle CTxMemPool::ChangeSet::StageAddition(const CTransactionRef& tx, const CAmount fee, int64_t time, unsigned int entry_height, uint64_t entry_sequence, bool spends_coinbase, int64_t sigops_cost, LockPoints lp, CAmount min_gas_price)
+CTxMemPool::ChangeSet::TxHandle CTxMemPool::ChangeSet::StageAddition(const CTransactionRef& tx, const CAmount fee, int64_t time, unsigned int entry_height, uint64_t entry_sequence, bool spends_coinbase, int64_t sigops_cost, LockPoints lp, MempoolGasSummary gas,
+                                                                      std::shared_ptr<const CachedQtumTX> qtum_tx)
 {
     LOCK(m_pool->cs);
     Assume(m_to_add.find(tx->GetHash()) == m_to_add.end());
-    auto newit = m_to_add.emplace(tx, fee, time, entry_height, entry_sequence, spends_coinbase, sigops_cost, lp, min_gas_price).first;
+    auto newit = m_to_add.emplace(tx, fee, time, entry_height, entry_sequence, spends_coinbase, sigops_cost, lp, gas, std::move(qtum_tx)).first;
     CAmount delta{0};
     m_pool->ApplyDelta(tx->GetHash(), delta);
     if (delta) m_to_add.modify(newit, [&delta](CTxMemPoolEntry& e) { e.UpdateModifiedFee(delta); });
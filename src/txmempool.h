@@ -37,6 +37,7 @@
 #include <set>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -335,12 +336,27 @@ public:
     }
 };
 
+/** Sort contract txs by the gas price they pay, highest first, ahead of all other txs. */
+class CompareTxMemPoolEntryByGasPrice
+{
+public:
+    bool operator()(const CTxMemPoolEntry& a, const CTxMemPoolEntry& b) const
+    {
+        const bool a_has_gas{a.GetGasLimit() > 0};
+        const bool b_has_gas{b.GetGasLimit() > 0};
+        if (a_has_gas != b_has_gas) return a_has_gas;
+        if (a.GetMinGasPrice() != b.GetMinGasPrice()) return a.GetMinGasPrice() > b.GetMinGasPrice();
+        return a.GetTx().GetHash() < b.GetTx().GetHash();
+    }
+};
+
 // Multi_index tag names
 struct descendant_score {};
 struct entry_time {};
 struct ancestor_score {};
 struct index_by_wtxid {};
 struct ancestor_score_or_gas_price {};
+struct gas_price {};
 
 /**
  * Information about a mempool transaction.
@@ -384,6 +400,7 @@ struct TxMempoolInfo
  * - descendant feerate [we use max(feerate of tx, feerate of tx with all descendants)]
  * - time in mempool
  * - ancestor feerate [we use min(feerate of tx, feerate of tx with all unconfirmed ancestors)]
+ * - gas price of contract txs (see MempoolGasSummary)
  *
  * Note: the term "descendant" refers to in-mempool transactions that depend on
  * this one, while "ancestor" refers to in-mempool transactions that a given
@@ -497,6 +514,12 @@ public:
                 boost::multi_index::tag<ancestor_score_or_gas_price>,
                 boost::multi_index::identity<CTxMemPoolEntry>,
                 CompareTxMemPoolEntryByAncestorFeeOrGasPrice
+            >,
+            // sorted by contract gas price
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<gas_price>,
+                boost::multi_index::identity<CTxMemPoolEntry>,
+                CompareTxMemPoolEntryByGasPrice
             >
         >
         {};
@@ -587,6 +610,18 @@ private:
 
 public:
     indirectmap<COutPoint, const CTransaction*> mapNextTx GUARDED_BY(cs);
+    /** Key images spent by privacy transactions in the pool: the mapNextTx of privacy inputs */
+    std::unordered_map<uint256, const CTransaction*, SaltedTxidHasher> mapKeyImages GUARDED_BY(cs);
+    /** Order of acceptance: entry sequence, which is 0 for txs re-added from disconnected blocks, then txid */
+    struct CompareIteratorBySequence {
+        bool operator()(const txiter& a, const txiter& b) const
+        {
+            if (a->GetSequence() != b->GetSequence()) return a->GetSequence() < b->GetSequence();
+            return a->GetTx().GetHash() < b->GetTx().GetHash();
+        }
+    };
+    /** Contract transactions in the pool by the sender they execute as (see MempoolGasSummary), in order of acceptance */
+    std::map<uint160, std::set<txiter, CompareIteratorBySequence>> mapSenderTxs GUARDED_BY(cs);
     std::map<uint256, CAmount> mapDeltas GUARDED_BY(cs);
 
     using Options = kernel::MemPoolOptions;
@@ -662,6 +697,9 @@ public:
     /** Get the transaction in the pool that spends the same prevout */
     const CTransaction* GetConflictTx(const COutPoint& prevout) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** Get the transaction in the pool that spends the same key image (see privacy::GetTxKeyImageHashes()) */
+    const CTransaction* GetKeyImageConflictTx(const uint256& key_image) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** Returns an iterator to the given hash, if found */
     std::optional<txiter> GetIter(const uint256& txid) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -828,6 +866,8 @@ public:
     }
 
     CTransactionRef get(const uint256& hash) const;
+    /** Contract transactions extracted when the transaction was accepted, null if not in the mempool */
+    std::shared_ptr<const CachedQtumTX> GetQtumTX(const uint256& hash) const;
     txiter get_iter_from_wtxid(const uint256& wtxid) const EXCLUSIVE_LOCKS_REQUIRED(cs)
     {
         AssertLockHeld(cs);
@@ -835,6 +875,11 @@ public:
     }
     TxMempoolInfo info(const GenTxid& gtxid) const;
 
+    /** Number of contract transactions in the pool executing as @p sender, its pending nonce offset */
+    size_t GetSenderTxCount(const uint160& sender) const;
+    /** Contract transactions in the pool executing as @p sender, in order of acceptance */
+    std::vector<CTransactionRef> GetSenderTxs(const uint160& sender) const;
+
     /** Returns info for a transaction if its entry_sequence < last_sequence */
     TxMempoolInfo info_for_relay(const GenTxid& gtxid, uint64_t last_sequence) const;
 
@@ -1001,7 +1046,8 @@ public:
 
         using TxHandle = CTxMemPool::txiter;
 
-        TxHandle StageAddition(const CTransactionRef& tx, const CAmount fee, int64_t time, unsigned int entry_height, uint64_t entry_sequence, bool spends_coinbase, int64_t sigops_cost, LockPoints lp, CAmount min_gas_price = 0);
+        TxHandle StageAddition(const CTransactionRef& tx, const CAmount fee, int64_t time, unsigned int entry_height, uint64_t entry_sequence, bool spends_coinbase, int64_t sigops_cost, LockPoints lp, MempoolGasSummary gas = {},
+                               std::shared_ptr<const CachedQtumTX> qtum_tx = nullptr);
         void StageRemoval(CTxMemPool::txiter it) { m_to_remove.insert(it); }
 
         const CTxMemPool::setEntries& GetRemovals() const { return m_to_remove; }
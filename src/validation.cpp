@@ -25,6 +25,7 @@
 #include <cuckoocache.h>
 #include <flatfile.h>
 #include <hash.h>
+#include <index/addressindex.h>
 #include <kernel/chain.h>
 #include <kernel/chainparams.h>
 #include <kernel/coinstats.h>
@@ -45,9 +46,11 @@
 #include <policy/truc_policy.h>
 #include <pow.h>
 #include <pos.h>
+#include <pos_mpos_cache.h>
 #include <pos_utxo_tracker.h>
 #include <primitives/block.h>
 #include <node/randomx_miner.h>
+#include <node/randomx_verifier.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <script/script.h>
@@ -67,6 +70,7 @@
 #include <util/result.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/threadnames.h>
 #include <util/string.h>
 #include <util/time.h>
 #include <util/trace.h>
@@ -76,8 +80,10 @@
 #include <libethcore/ABI.h>
 #include <univalue.h>
 #include <util/signstr.h>
+#include <qtum/evmprefetch.h>
 #include <qtum/qtumutils.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <addresstype.h>
 #include <validators/validatordb.h>
 #include <validators/delegation.h>
@@ -85,13 +91,17 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <future>
 #include <numeric>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 #include <fstream>
 
@@ -129,11 +139,16 @@ const std::vector<std::string> CHECKLEVEL_DOC {
  *  noticeably interfere with the pruning mechanism.
  * */
 static constexpr int PRUNE_LOCK_BUFFER{10};
+/** Range proofs per batch when connecting a block. Larger batches share more
+ *  of the work, smaller ones spread it over more check queue threads. */
+static constexpr size_t RANGE_PROOF_BATCH_SIZE{64};
 
 TRACEPOINT_SEMAPHORE(validation, block_connected);
 TRACEPOINT_SEMAPHORE(utxocache, flush);
 TRACEPOINT_SEMAPHORE(mempool, replaced);
 TRACEPOINT_SEMAPHORE(mempool, rejected);
+TRACEPOINT_SEMAPHORE(evm, contract_executed);
+TRACEPOINT_SEMAPHORE(evm, bytecode_executed);
 
 std::unique_ptr<QtumState> globalState;
 std::shared_ptr<dev::eth::SealEngineFace> globalSealEngine;
@@ -141,6 +156,8 @@ std::unique_ptr<StorageResults> pstorageresult;
 bool fRecordLogOpcodes = false;
 bool fIsVMlogFile = false;
 bool fGettingValuesDGP = false;
+int nEvmPrefetchThreads = DEFAULT_EVM_PREFETCH_THREADS;
+int64_t nEvmCacheSize = DEFAULT_EVM_CACHE_SIZE << 20;
 std::set<std::pair<COutPoint, unsigned int>> setStakeSeen;
 bool fAddressIndex = false; // qtum
 bool fLogEvents = false;
@@ -669,6 +686,8 @@ private:
         CTxMemPool::setEntries m_iters_conflicting;
         /** All mempool ancestors of this transaction. */
         CTxMemPool::setEntries m_ancestors;
+        /** Key images spent by this transaction (privacy::GetTxKeyImageHashes()). */
+        std::vector<uint256> m_key_images;
         /* Handle to the tx in the changeset */
         CTxMemPool::ChangeSet::TxHandle m_tx_handle;
         /** Whether RBF-related data structures (m_conflicts, m_iters_conflicting,
@@ -885,6 +904,19 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
         }
     }
 
+    // WATTx Privacy: a key image is spent by at most one mempool transaction,
+    // so a transaction reusing one conflicts with (and may replace) it
+    ws.m_key_images = privacy::GetTxKeyImageHashes(tx);
+    for (const uint256& key_image : ws.m_key_images) {
+        const CTransaction* ptxConflicting = m_pool.GetKeyImageConflictTx(key_image);
+        if (ptxConflicting) {
+            if (!args.m_allow_replacement) {
+                return state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "bip125-replacement-disallowed");
+            }
+            ws.m_conflicts.insert(ptxConflicting->GetHash());
+        }
+    }
+
     m_view.SetBackend(m_viewmempool);
 
     const CCoinsViewCache& coins_cache = m_active_chainstate.CoinsTip();
@@ -949,24 +981,42 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
         return false; // state filled in by CheckTxInputs
     }
 
-    // WATTx FCMP: Validate FCMP inputs with full context (key images, proofs)
+    // WATTx FCMP: Validate FCMP inputs with full context (key images, proofs).
+    // Verified proofs go to the privacy proof cache, for re-acceptance after
+    // a reorg.
     if (privacy::IsFcmpStateAvailable() && privacy::GetFcmpState().IsInitialized()) {
         int nSpendHeight = m_active_chainstate.m_chain.Height() + 1;
-        if (!privacy::GetFcmpState().CheckFcmpInputs(tx, state, m_view, nSpendHeight)) {
+        std::optional<uint256> fcmp_entry;
+        if (privacy::HasFcmpInputs(tx)) {
+            const ed25519::Point fcmp_root{privacy::GetFcmpState().GetTreeRoot()};
+            fcmp_entry = PrivacyProofCacheEntry(GetValidationCache(), tx, &fcmp_root);
+        }
+        const bool proofs_cached{fcmp_entry && GetValidationCache().m_privacy_proof_cache.contains(*fcmp_entry, /*erase=*/false)};
+        if (!privacy::GetFcmpState().CheckFcmpInputs(tx, state, m_view, nSpendHeight, /*verifyProofs=*/!proofs_cached)) {
             return false; // state filled in by CheckFcmpInputs
         }
+        if (fcmp_entry && !proofs_cached) {
+            GetValidationCache().m_privacy_proof_cache.insert(*fcmp_entry);
+        }
     }
 
-    // WATTx Privacy: Validate key images not already spent
+    // WATTx Privacy: Validate key images not already spent, then the proofs
+    // unless the privacy proof cache has them. CheckPrivacyTransaction() ran above.
     if (privacy::IsPrivacyActive(m_active_chainstate.m_chain.Height() + 1, chainparams.GetConsensus()) &&
         privacy::HasPrivacyData(tx)) {
         auto privTx = privacy::ExtractPrivacyTransaction(tx);
         if (privTx.has_value()) {
             auto keyImageDB = privacy::GetKeyImageDB();
             if (keyImageDB) {
-                int nSpendHeight = m_active_chainstate.m_chain.Height() + 1;
-                if (!privacy::ContextualCheckPrivacyTransaction(*privTx, *keyImageDB, state, nSpendHeight)) {
-                    return false; // state filled in by ContextualCheckPrivacyTransaction
+                if (!privacy::CheckPrivacyKeyImagesUnspent(*privTx, *keyImageDB, state)) {
+                    return false; // state filled in by CheckPrivacyKeyImagesUnspent
+                }
+                const uint256 proof_entry{PrivacyProofCacheEntry(GetValidationCache(), tx)};
+                if (!GetValidationCache().m_privacy_proof_cache.contains(proof_entry, /*erase=*/false)) {
+                    if (!privacy::VerifyPrivacyTransactionProofs(*privTx, state)) {
+                        return false; // state filled in by VerifyPrivacyTransactionProofs
+                    }
+                    GetValidationCache().m_privacy_proof_cache.insert(proof_entry);
                 }
             }
         }
@@ -984,6 +1034,8 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     int64_t nSigOpsCost = GetTransactionSigOpCost(tx, m_view, STANDARD_SCRIPT_VERIFY_FLAGS);
 
     dev::u256 txMinGasPrice = 0;
+    MempoolGasSummary gasSummary;
+    std::shared_ptr<CachedQtumTX> cachedQtumTX;
 
     //////////////////////////////////////////////////////////// // qtum
     if(!CheckOpSender(tx, chainparams, m_active_chainstate.m_chain.Height() + 1)){
@@ -1002,13 +1054,15 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
         for(const CTxOut& o : tx.vout)
             count += o.scriptPubKey.HasOpCreate() || o.scriptPubKey.HasOpCall() ? 1 : 0;
         unsigned int contractflags = GetContractScriptFlags(m_active_chainstate.m_chain.Height() + 1, chainparams.GetConsensus());
-        QtumTxConverter converter(tx, m_active_chainstate, &m_pool, NULL, NULL, contractflags);
-        ExtractQtumTX resultConverter;
-        if(!converter.extractionQtumTransactions(resultConverter)){
+        // Look the sender up in the view, as ConnectBlock does, so the result can be cached in the entry
+        QtumTxConverter converter(tx, m_active_chainstate, &m_pool, &m_view, NULL, contractflags);
+        cachedQtumTX = std::make_shared<CachedQtumTX>();
+        cachedQtumTX->flags = contractflags;
+        if(!converter.extractionQtumTransactions(cachedQtumTX->extracted)){
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-tx-bad-contract-format", "AcceptToMempool(): Contract transaction of the wrong format");
         }
-        std::vector<QtumTransaction> qtumTransactions = resultConverter.first;
-        std::vector<EthTransactionParams> qtumETP = resultConverter.second;
+        const std::vector<QtumTransaction>& qtumTransactions = cachedQtumTX->extracted.first;
+        std::vector<EthTransactionParams>& qtumETP = cachedQtumTX->extracted.second;
 
         dev::u256 sumGas = dev::u256(0);
         dev::u256 gasAllTxs = dev::u256(0);
@@ -1063,6 +1117,12 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
 
         if(count > qtumTransactions.size())
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-incorrect-format");
+
+        // Bounded by the block gas limit and INT64_MAX above
+        gasSummary.gas_limit = static_cast<uint64_t>(gasAllTxs);
+        gasSummary.min_gas_price = CAmount(txMinGasPrice);
+        if(!qtumTransactions.empty())
+            gasSummary.sender = uint160(qtumTransactions.front().sender().asBytes());
     }
     ////////////////////////////////////////////////////////////
 
@@ -1083,7 +1143,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     if (!m_subpackage.m_changeset) {
         m_subpackage.m_changeset = m_pool.GetChangeSet();
     }
-    ws.m_tx_handle = m_subpackage.m_changeset->StageAddition(ptx, ws.m_base_fees, nAcceptTime, m_active_chainstate.m_chain.Height(), entry_sequence, fSpendsCoinbase, nSigOpsCost, lock_points.value(), CAmount(txMinGasPrice));
+    ws.m_tx_handle = m_subpackage.m_changeset->StageAddition(ptx, ws.m_base_fees, nAcceptTime, m_active_chainstate.m_chain.Height(), entry_sequence, fSpendsCoinbase, nSigOpsCost, lock_points.value(), gasSummary, std::move(cachedQtumTX));
 
     // ws.m_modified_fees includes any fee deltas from PrioritiseTransaction
     ws.m_modified_fees = ws.m_tx_handle->GetModifiedFee();
@@ -1588,6 +1648,7 @@ bool MemPoolAccept::SubmitPackage(const ATMPArgs& args, std::vector<Workspace>&
         results.emplace(ws.m_ptx->GetWitnessHash(),
                         MempoolAcceptResult::Success(std::move(m_subpackage.m_replaced_transactions), ws.m_vsize,
                                          ws.m_base_fees, effective_feerate, effective_feerate_wtxids));
+        if (g_mempool_evm_warmer && (*iter)->GetQtumTX()) g_mempool_evm_warmer->Add((*iter)->GetQtumTX());
         if (!m_pool.m_opts.signals) continue;
         const CTransaction& tx = *ws.m_ptx;
         const auto tx_info = NewMempoolTransactionInfo(ws.m_ptx, ws.m_base_fees,
@@ -1674,6 +1735,11 @@ MempoolAcceptResult MemPoolAccept::AcceptSingleTransaction(const CTransactionRef
         m_pool.addSpentIndex(tx, m_view);
     }
 
+    if (g_mempool_evm_warmer) {
+        auto iter = m_pool.GetIter(ws.m_ptx->GetHash());
+        if (iter && (*iter)->GetQtumTX()) g_mempool_evm_warmer->Add((*iter)->GetQtumTX());
+    }
+
     if (m_pool.m_opts.signals) {
         const CTransaction& tx = *ws.m_ptx;
         auto iter = m_pool.GetIter(tx.GetHash());
@@ -1745,6 +1811,19 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::
         m_viewmempool.PackageAddTransaction(ws.m_ptx);
     }
 
+    // WATTx Privacy: as IsConsistentPackage() does for inputs, don't allow two
+    // transactions in a package to spend the same key image.
+    std::unordered_set<uint256, SaltedTxidHasher> key_images_seen;
+    for (const Workspace& ws : workspaces) {
+        for (const uint256& key_image : ws.m_key_images) {
+            if (key_images_seen.count(key_image)) {
+                package_state.Invalid(PackageValidationResult::PCKG_POLICY, "conflict-in-package");
+                return PackageMempoolAcceptResult(package_state, {});
+            }
+        }
+        key_images_seen.insert(ws.m_key_images.begin(), ws.m_key_images.end());
+    }
+
     // At this point we have all in-mempool ancestors, and we know every transaction's vsize.
     // Run the TRUC checks on the package.
     for (Workspace& ws : workspaces) {
@@ -2147,49 +2226,18 @@ bool IsConfirmedInNPrevBlocks(const CDiskTxPos& txindex, const CBlockIndex* pind
     return false;
 }
 
-// RandomX key management for PoW validation
-static Mutex g_randomx_pow_mutex;
-static bool g_randomx_pow_initialized = false;
-
-static bool EnsureRandomXInitializedForPow(const uint256& genesisHash) {
-    LOCK(g_randomx_pow_mutex);
-
-    if (g_randomx_pow_initialized) {
-        return true;
-    }
-
-    node::RandomXMiner& miner = node::GetRandomXMiner();
-
-    // If miner is already initialized (e.g., for mining), just use it
-    // Don't reinitialize or we'll destroy the mining context!
-    if (miner.IsInitialized()) {
-        g_randomx_pow_initialized = true;
-        return true;
-    }
-
-    LogPrintf("RandomX PoW: Initializing with genesis hash key (FULL mode for faster validation)\n");
-    if (!miner.Initialize(genesisHash.data(), 32, node::RandomXMiner::Mode::FULL)) {
-        LogPrintf("RandomX PoW: Failed to initialize with genesis hash\n");
-        return false;
-    }
-    g_randomx_pow_initialized = true;
-
-    return true;
-}
-
 uint256 GetRandomXHash(const CBlockHeader& header, const uint256& genesisHash) {
-    // Ensure RandomX is initialized
-    if (!EnsureRandomXInitializedForPow(genesisHash)) {
-        LogPrintf("RandomX: Failed to ensure initialization, returning null hash\n");
-        return uint256();
-    }
-
     // Serialize the block header
     auto headerData = node::RandomXMiner::SerializeBlockHeader(header);
 
-    // Calculate RandomX hash
+    // Hash on the dedicated verification pool rather than the miner's VM, so
+    // validation neither waits behind local mining nor depends on the key the
+    // miner was initialized with
     uint256 hash;
-    node::GetRandomXMiner().CalculateHash(headerData.data(), headerData.size(), hash.data());
+    if (!node::GetRandomXVerifier().CalculateHash(genesisHash, headerData.data(), headerData.size(), hash.data())) {
+        LogPrintf("RandomX: Failed to create verification context, returning null hash\n");
+        return uint256();
+    }
 
     return hash;
 }
@@ -2222,6 +2270,44 @@ bool CheckHeaderPoW(const CBlockHeader& block, const Consensus::Params& consensu
     return CheckProofOfWorkRandomX(block, block.nBits, consensusParams);
 }
 
+namespace {
+/**
+ * Headers whose proof of work checked out at a given height. AcceptBlockHeader
+ * and CheckBlock both verify every block, and the block import pipeline
+ * verifies ahead on worker threads, so remembering the (RandomX, Ethash, ...)
+ * verdict makes the expensive hash run once per header. Only successes are
+ * kept; the oldest entries go first.
+ */
+class PowCheckCache
+{
+    static constexpr size_t MAX_ENTRIES{16384};
+
+    Mutex m_mutex;
+    std::set<std::pair<uint256, int>> m_checked GUARDED_BY(m_mutex);
+    std::deque<std::pair<uint256, int>> m_order GUARDED_BY(m_mutex);
+
+public:
+    bool Contains(const uint256& hash, int height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        return m_checked.count({hash, height});
+    }
+
+    void Insert(const uint256& hash, int height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (!m_checked.emplace(hash, height).second) return;
+        m_order.emplace_back(hash, height);
+        if (m_order.size() > MAX_ENTRIES) {
+            m_checked.erase(m_order.front());
+            m_order.pop_front();
+        }
+    }
+};
+
+PowCheckCache g_pow_check_cache;
+} // namespace
+
 /**
  * Check proof of work with height-awareness for X25X activation
  * @param block The block header to validate
@@ -2232,8 +2318,9 @@ bool CheckHeaderPoW(const CBlockHeader& block, const Consensus::Params& consensu
 bool CheckHeaderPoWAtHeight(const CBlockHeader& block, int nHeight, const Consensus::Params& consensusParams)
 {
     // Genesis block always uses SHA256d
-    if (block.GetHash() == consensusParams.hashGenesisBlock) {
-        return CheckProofOfWorkImpl(block.GetHash(), block.nBits, consensusParams);
+    const uint256 hash{block.GetHash()};
+    if (hash == consensusParams.hashGenesisBlock) {
+        return CheckProofOfWorkImpl(hash, block.nBits, consensusParams);
     }
 
     // Check if this is an AuxPoW (merged-mined) block
@@ -2257,19 +2344,27 @@ bool CheckHeaderPoWAtHeight(const CBlockHeader& block, int nHeight, const Consen
         return true;
     }
 
+    if (g_pow_check_cache.Contains(hash, nHeight)) return true;
+
+    bool valid;
     // Check if X25X is active at this height
     if (consensusParams.IsX25XActive(nHeight)) {
         // Use X25X multi-algorithm validation
-        return CheckProofOfWorkX25X(block, block.nBits, consensusParams);
+        valid = CheckProofOfWorkX25X(block, block.nBits, consensusParams);
     } else {
         // Pre-X25X: use RandomX validation (base algorithm for Fluorine Fermie)
-        return CheckProofOfWorkRandomX(block, block.nBits, consensusParams);
+        valid = CheckProofOfWorkRandomX(block, block.nBits, consensusParams);
     }
+    if (valid) g_pow_check_cache.Insert(hash, nHeight);
+    return valid;
 }
 
 bool CheckHeaderPoS(const CBlockHeader& block, const Consensus::Params& consensusParams, Chainstate& chainstate)
 {
     LOCK(cs_main);
+    // Verified on the header check queue against the current tip
+    if (chainstate.m_chainman.m_stake_checked_headers.count(block.GetHash())) return true;
+
     // Check for proof of stake block header
     // Get prev block index
     BlockMap::iterator mi = chainstate.m_blockman.m_block_index.find(block.hashPrevBlock);
@@ -2304,12 +2399,19 @@ bool CheckIndexProof(const CBlockIndex& block, const Consensus::Params& consensu
         //blocks are loaded out of order, so checking PoS kernels here is not practical
         return true; //CheckKernel(block.pprev, block.nBits, block.nTime, block.prevoutStake);
     }else{
-        // For PoW blocks, use height-aware validation (X25X after activation)
-        CBlockHeader header = block.GetBlockHeader();
-        return CheckHeaderPoWAtHeight(header, block.nHeight, consensusParams);
+        return CheckIndexProof(block.GetBlockHeader(), block.nHeight, consensusParams);
     }
 }
 
+bool CheckIndexProof(const CBlockHeader& header, int nHeight, const Consensus::Params& consensusParams)
+{
+    if(header.IsProofOfStake()){
+        return true;
+    }
+    // For PoW blocks, use height-aware validation (X25X after activation)
+    return CheckHeaderPoWAtHeight(header, nHeight, consensusParams);
+}
+
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
 {
     // WATTx: Initial PoW phase gets larger reward for bootstrap
@@ -2351,10 +2453,10 @@ CoinsViews::CoinsViews(DBParams db_params, CoinsViewOptions options)
     : m_dbview{std::move(db_params), std::move(options)},
       m_catcherview(&m_dbview) {}
 
-void CoinsViews::InitCache()
+void CoinsViews::InitCache(bool large_pages)
 {
     AssertLockHeld(::cs_main);
-    m_cacheview = std::make_unique<CCoinsViewCache>(&m_catcherview);
+    m_cacheview = std::make_unique<CCoinsViewCache>(&m_catcherview, /*deterministic=*/false, large_pages);
 }
 
 Chainstate::Chainstate(
@@ -2367,6 +2469,27 @@ Chainstate::Chainstate(
       m_chainman(chainman),
       m_from_snapshot_blockhash(from_snapshot_blockhash) {}
 
+privacy::CFcmpConsensusState* Chainstate::FcmpState()
+{
+    AssertLockHeld(::cs_main);
+    if (!m_from_snapshot_blockhash && m_chainman.m_snapshot_fcmp) {
+        return m_chainman.m_snapshot_fcmp.get();
+    }
+    if (!privacy::IsFcmpStateAvailable() || !privacy::GetFcmpState().IsInitialized()) {
+        return nullptr;
+    }
+    return &privacy::GetFcmpState();
+}
+
+std::shared_ptr<privacy::CKeyImageDB> Chainstate::KeyImageDB()
+{
+    AssertLockHeld(::cs_main);
+    if (!m_from_snapshot_blockhash && m_chainman.m_snapshot_key_images) {
+        return m_chainman.m_snapshot_key_images;
+    }
+    return privacy::GetKeyImageDB();
+}
+
 const CBlockIndex* Chainstate::SnapshotBase()
 {
     if (!m_from_snapshot_blockhash) return nullptr;
@@ -2402,7 +2525,7 @@ void Chainstate::InitCoinsCache(size_t cache_size_bytes)
     AssertLockHeld(::cs_main);
     assert(m_coins_views != nullptr);
     m_coinstip_cache_size_bytes = cache_size_bytes;
-    m_coins_views->InitCache();
+    m_coins_views->InitCache(m_chainman.m_options.coins_large_pages);
 }
 
 // Note that though this is marked const, we may end up modifying `m_cached_finished_ibd`, which
@@ -2543,7 +2666,8 @@ std::optional<std::pair<ScriptError, std::string>> CScriptCheck::operator()() {
     }
 }
 
-ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, const size_t signature_cache_bytes)
+ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, const size_t signature_cache_bytes,
+                                 const size_t privacy_proof_cache_bytes)
     : m_signature_cache{signature_cache_bytes}
 {
     // Setup the salted hasher
@@ -2557,6 +2681,28 @@ ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, cons
     const auto [num_elems, approx_size_bytes] = m_script_execution_cache.setup_bytes(script_execution_cache_bytes);
     LogPrintf("Using %zu MiB out of %zu MiB requested for script execution cache, able to store %zu elements\n",
               approx_size_bytes >> 20, script_execution_cache_bytes >> 20, num_elems);
+
+    // The privacy proof cache gets its own salt
+    nonce = GetRandHash();
+    m_privacy_proof_cache_hasher.Write(nonce.begin(), 32);
+    m_privacy_proof_cache_hasher.Write(nonce.begin(), 32);
+
+    const auto [privacy_elems, privacy_size_bytes] = m_privacy_proof_cache.setup_bytes(privacy_proof_cache_bytes);
+    LogPrintf("Using %zu MiB out of %zu MiB requested for privacy proof cache, able to store %zu elements\n",
+              privacy_size_bytes >> 20, privacy_proof_cache_bytes >> 20, privacy_elems);
+}
+
+uint256 PrivacyProofCacheEntry(const ValidationCache& validation_cache, const CTransaction& tx,
+                               const ed25519::Point* fcmp_root)
+{
+    uint256 entry;
+    CSHA256 hasher = validation_cache.PrivacyProofCacheHasher();
+    hasher.Write(UCharCast(tx.GetWitnessHash().begin()), 32);
+    if (fcmp_root) {
+        hasher.Write(fcmp_root->data.data(), fcmp_root->data.size());
+    }
+    hasher.Finalize(entry.begin());
+    return entry;
 }
 
 /**
@@ -2729,6 +2875,8 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, bool* pfClean)
 {
     AssertLockHeld(::cs_main);
+    // The mempool warm-up reads the active chain, which is about to change
+    if (g_mempool_evm_warmer) g_mempool_evm_warmer->Pause();
     if (pfClean)
         *pfClean = false;
     bool fClean = true;
@@ -2744,11 +2892,6 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
         return DISCONNECT_FAILED;
     }
 
-    /////////////////////////////////////////////////////////// // qtum
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    ///////////////////////////////////////////////////////////
-
     // WATTx: Unmark coinstake UTXO when disconnecting a PoS block (reorg)
     if (block.IsProofOfStake() && block.vtx.size() > 1 && block.vtx[1]->IsCoinStake()) {
         const CTransaction& coinstakeTx = *block.vtx[1];
@@ -2788,30 +2931,6 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
             }
         }
 
-        /////////////////////////////////////////////////////////// // qtum
-        if (pfClean == NULL && fAddressIndex) {
-
-            for (unsigned int k = tx.vout.size(); k-- > 0;) {
-                const CTxOut &out = tx.vout[k];
-
-                CTxDestination dest;
-                if (ExtractDestination({hash, k}, out.scriptPubKey, dest)) {
-                    valtype bytesID(std::visit(DataVisitor(), dest));
-                    if(bytesID.empty()) {
-                        continue;
-                    }
-                    valtype addressBytes(32);
-                    std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
-                    int addressIndexType = GetAddressIndexType(dest);
-                    // undo receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(addressIndexType, uint256(addressBytes), pindex->nHeight, i, hash, k, false), out.nValue));
-                    // undo unspent index
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressIndexType, uint256(addressBytes), hash, k), CAddressUnspentValue()));
-                }
-            }
-        }
-        ///////////////////////////////////////////////////////////
-
         // restore inputs
         if (i > 0) { // not coinbases
             CTxUndo &txundo = blockUndo.vtxundo[i-1];
@@ -2825,28 +2944,6 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
                 int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
                 if (res == DISCONNECT_FAILED) return DISCONNECT_FAILED;
                 fClean = fClean && res != DISCONNECT_UNCLEAN;
-
-                if (pfClean == NULL && fAddressIndex) {
-                    const auto &undo = txundo.vprevout[j];
-                    const bool isTxCoinStake = tx.IsCoinStake();
-                    const CTxIn input = tx.vin[j];
-                    const CTxOut &prevout = view.GetOutputFor(input);
-
-                    CTxDestination dest;
-                    if (ExtractDestination(input.prevout, prevout.scriptPubKey, dest)) {
-                        valtype bytesID(std::visit(DataVisitor(), dest));
-                        if(bytesID.empty()) {
-                            continue;
-                        }
-                        valtype addressBytes(32);
-                        std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
-                        int addressIndexType = GetAddressIndexType(dest);
-                        // undo spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(addressIndexType, uint256(addressBytes), pindex->nHeight, i, hash, j, true), prevout.nValue * -1));
-                        // restore unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressIndexType, uint256(addressBytes), input.prevout.hash, input.prevout.n), CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undo.nHeight, isTxCoinStake)));
-                    }
-                }
             }
             // At this point, all of txundo.vprevout should have been moved out.
         }
@@ -2858,43 +2955,57 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
     globalState->setRoot(uintToh256(pindex->pprev->hashStateRoot)); // qtum
     globalState->setRootUTXO(uintToh256(pindex->pprev->hashUTXORoot)); // qtum
 
-    if(pfClean == NULL && fLogEvents){
-        pstorageresult->deleteResults(block.vtx);
-        m_blockman.m_block_tree_db->EraseHeightIndex(pindex->nHeight);
-    }
-
-    // The stake and delegate index is needed for MPoS, update it while MPoS is active
+    // The stake and delegate index is needed for MPoS, it is updated while MPoS is active
     const CChainParams& chainparams{m_chainman.GetParams()};
-    if(pindex->nHeight <= chainparams.GetConsensus().nLastMPoSBlock)
-    {
+    const bool fStakeIndex = pindex->nHeight <= chainparams.GetConsensus().nLastMPoSBlock;
+
+    if(pfClean == NULL){
+        // Blocks with contract transactions recorded what they added to the log
+        // indexes and receipts, so each database is undone in a single batch
+        bool fContracts = fLogEvents && std::any_of(block.vtx.begin(), block.vtx.end(), [](const CTransactionRef& tx) { return tx->HasCreateOrCall(); });
+        CLogIndexUndo logIndexUndo;
+        bool fLogIndexUndo = fContracts && m_blockman.m_block_tree_db->ReadLogIndexUndo(pindex->nHeight, logIndexUndo) &&
+                             logIndexUndo.blockHash == pindex->GetBlockHash();
+        if(fContracts && !fLogIndexUndo){
+            // Connected before the records were written, find the entries from the receipts
+            std::vector<CTopicTxIndexKey> topicIndex;
+            for(const CTransactionRef& tx : block.vtx){
+                if(!tx->HasCreateOrCall())
+                    continue;
+                for(const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))){
+                    for(const dev::eth::LogEntry& log : receipt.logs){
+                        if(!log.topics.empty())
+                            topicIndex.emplace_back(log.topics[0], pindex->nHeight, log.address);
+                    }
+                }
+            }
+            m_blockman.m_block_tree_db->EraseTopicIndex(topicIndex);
+            pstorageresult->deleteResults(block.vtx);
+            pstorageresult->deleteBlockBloom(pindex->nHeight);
+            m_blockman.m_block_tree_db->EraseHeightIndex(pindex->nHeight);
+        }else if(fLogEvents){
+            pstorageresult->deleteBlockResults(pindex->nHeight, logIndexUndo.receipts);
+        }
+        if(fLogIndexUndo || fStakeIndex)
+            m_blockman.m_block_tree_db->EraseBlockIndexes(pindex->nHeight, fLogIndexUndo ? &logIndexUndo : nullptr, fStakeIndex);
+    }else if(fStakeIndex){
         m_blockman.m_block_tree_db->EraseStakeIndex(pindex->nHeight);
         if(pindex->IsProofOfStake() && pindex->HasProofOfDelegation())
             m_blockman.m_block_tree_db->EraseDelegateIndex(pindex->nHeight);
     }
-
-    //////////////////////////////////////////////////// // qtum
-    if (pfClean == NULL && fAddressIndex) {
-        if (!m_blockman.m_block_tree_db->EraseAddressIndex(addressIndex)) {
-            LogError("Failed to delete address index");
-            return DISCONNECT_FAILED;
-        }
-        if (!m_blockman.m_block_tree_db->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            LogError("Failed to write address unspent index");
-            return DISCONNECT_FAILED;
-        }
-    }
-    ////////////////////////////////////////////////////
+    if(fStakeIndex)
+        GetMPoSRecipientCache().Remove(pindex->nHeight);
 
     // WATTx FCMP: Revert curve tree and key image changes for reorg
-    if (privacy::IsFcmpStateAvailable() && privacy::GetFcmpState().IsInitialized()) {
-        if (!privacy::GetFcmpState().DisconnectBlock(block, pindex)) {
+    if (auto* fcmp{FcmpState()}) {
+        if (!fcmp->DisconnectBlock(block, pindex)) {
             LogPrintf("FCMP: Failed to disconnect block %d from FCMP state\n", pindex->nHeight);
             // Note: Non-fatal for now
         }
     }
 
     // WATTx Privacy: Remove key images for reorg
-    auto keyImageDB = privacy::GetKeyImageDB();
+    auto keyImageDB = KeyImageDB();
     if (keyImageDB) {
         for (const auto& ptx : block.vtx) {
             const CTransaction& tx = *ptx;
@@ -3060,6 +3171,19 @@ bool GetSpentCoinFromMainChain(const CBlockIndex* pforkPrev, COutPoint prevoutSt
         }
     }
 
+    // A coin staked in the active chain is found from memory. The entry is only
+    // trusted if the active chain still has that coinstake at its height.
+    {
+        int nSpentHeight;
+        if (GetCoinstakeTracker().GetSpentCoin(prevoutStake, nSpentHeight, *coin)) {
+            const CBlockIndex* pspent = chainstate.m_chain[nSpentHeight];
+            if (pspent && pspent->prevoutStake == prevoutStake) {
+                // Spent at or below the fork base, so it was spent in the fork as well
+                return nSpentHeight > pforkBase->nHeight;
+            }
+        }
+    }
+
     // Scan through blocks until we reach the forkbase to check if the prevoutStake has been spent in one of those blocks
     // If it not in any of those blocks, and not in the utxo set, it can't be spendable in the orphan chain.
     {
@@ -3195,6 +3319,7 @@ std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::v
 
 
     ByteCodeExec exec(block, std::vector<QtumTransaction>(1, callTransaction), blockGasLimit, pblockindex, chainstate.m_chain);
+    exec.setStatsSource(EvmStatsSource::CALL);
     exec.performByteCode(dev::eth::Permanence::Reverted);
     return exec.getResult();
 }
@@ -3444,24 +3569,36 @@ void LastHashes::clear()
 class ExecTransientStorage
 {
 public:
+    explicit ExecTransientStorage(QtumState& _state) : state(_state) {}
     void init() {
-        globalState->clearTransientStorage();
+        state.clearTransientStorage();
     }
     ~ExecTransientStorage() {
-        globalState->clearTransientStorage();
+        state.clearTransientStorage();
     }
+private:
+    QtumState& state;
 };
 
 bool ByteCodeExec::performByteCode(dev::eth::Permanence type){
-    ExecTransientStorage storage;
+    QtumState& execState = state ? *state : *globalState;
+    dev::eth::SealEngineFace& execSealEngine = sealEngine ? *sealEngine : *globalSealEngine;
+    ExecTransientStorage storage(execState);
     storage.init();
-    for(QtumTransaction& tx : txs){
+    const bool traced{TRACEPOINT_ACTIVE(evm, bytecode_executed)};
+    const auto start{traced ? SteadyClock::now() : SteadyClock::time_point{}};
+    const size_t firstResult{result.size()};
+    for(size_t i = 0; i < txs.size(); i++){
+        QtumTransaction& tx = txs[i];
         //validate VM version
         if(tx.getVersion().toRaw() != VersionVM::GetEVMDefault().toRaw()){
             return false;
         }
+        if(onExecute){
+            onExecute(i);
+        }
         dev::eth::EnvInfo envInfo(BuildEVMEnvironment());
-        if(!tx.isCreation() && !globalState->addressInUse(tx.receiveAddress())){
+        if(!tx.isCreation() && !execState.addressInUse(tx.receiveAddress())){
             dev::eth::ExecutionResult execRes;
             execRes.excepted = dev::eth::TransactionException::Unknown;
             result.push_back(ResultExecute{
@@ -3471,11 +3608,43 @@ bool ByteCodeExec::performByteCode(dev::eth::Permanence type){
             });
             continue;
         }
-        result.push_back(globalState->execute(envInfo, *globalSealEngine.get(), tx, chain, type, OnOpFunc()));
+        std::optional<EvmExecutionStats> stats;
+        if(statsSource){
+            stats.emplace();
+        }
+        result.push_back(execState.execute(envInfo, execSealEngine, tx, chain, type, OnOpFunc()));
+        if(stats){
+            const dev::eth::ExecutionResult& execRes = result.back().execRes;
+            const dev::Address contract = tx.isCreation() ? execRes.newAddress : tx.receiveAddress();
+            [[maybe_unused]] const EvmContractStats execution = stats->Record(*statsSource, contract, static_cast<uint64_t>(execRes.gasUsed));
+            TRACEPOINT(evm, contract_executed,
+                contract.data(),
+                static_cast<int>(*statsSource),
+                execution.gasUsed,
+                execution.micros,
+                execution.sloads,
+                execution.sstores,
+                execution.dbReads
+            );
+        }
+    }
+    if(!state){
+        globalState->db().commit();
+        globalState->dbUtxo().commit();
+    }
+    execSealEngine.deleteAddresses.clear();
+    if(traced){
+        uint64_t gasUsed = 0;
+        for(size_t i = firstResult; i < result.size(); i++){
+            gasUsed += static_cast<uint64_t>(result[i].execRes.gasUsed);
+        }
+        TRACEPOINT(evm, bytecode_executed,
+            static_cast<uint32_t>(txs.size()),
+            gasUsed,
+            static_cast<int>(type),
+            Ticks<std::chrono::microseconds>(SteadyClock::now() - start)
+        );
     }
-    globalState->db().commit();
-    globalState->dbUtxo().commit();
-    globalSealEngine.get()->deleteAddresses.clear();
     return true;
 }
 
@@ -3544,7 +3713,7 @@ dev::eth::EnvInfo ByteCodeExec::BuildEVMEnvironment(){
         header.setAuthor(EthAddrFromScript(block.vtx[0]->vout[0].scriptPubKey));
     }
     dev::u256 gasUsed;
-    int &chainID = const_cast<int&>(globalSealEngine->chainParams().chainID);
+    int &chainID = const_cast<int&>((sealEngine ? sealEngine : globalSealEngine.get())->chainParams().chainID);
     chainID = qtumutils::eth_getChainId(tip->nHeight);
     dev::eth::EnvInfo env(header, lastHashes, gasUsed, chainID);
     return env;
@@ -3591,6 +3760,20 @@ bool QtumTxConverter::extractionQtumTransactions(ExtractQtumTX& qtumtx){
     return true;
 }
 
+bool ExtractQtumTransactions(const CTransaction& tx, Chainstate& chainstate, const CTxMemPool* mempool, CCoinsViewCache* view,
+                             const std::vector<CTransactionRef>* blockTxs, unsigned int flags, ExtractQtumTX& extracted)
+{
+    if (mempool) {
+        std::shared_ptr<const CachedQtumTX> cached = mempool->GetQtumTX(tx.GetHash());
+        if (cached && cached->flags == flags) {
+            extracted = cached->extracted;
+            return true;
+        }
+    }
+    QtumTxConverter convert(tx, chainstate, mempool, view, blockTxs, flags);
+    return convert.extractionQtumTransactions(extracted);
+}
+
 bool QtumTxConverter::receiveStack(const CScript& scriptPubKey){
     sender = false;
     EvalScript(stack, scriptPubKey, nFlags, BaseSignatureChecker(), SigVersion::BASE, nullptr);
@@ -3724,7 +3907,10 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     uint256 block_hash{block.GetHash()};
     assert(*pindex->phashBlock == block_hash);
+    // The mempool warm-up reads the active chain, and leaves the workers to the block's own prefetch
+    if (!fJustCheck && g_mempool_evm_warmer) g_mempool_evm_warmer->Pause();
     const bool parallel_script_checks{m_chainman.GetCheckQueue().HasThreads()};
+    const bool parallel_privacy_checks{m_chainman.GetPrivacyCheckQueue().HasThreads()};
 
     const auto time_start{SteadyClock::now()};
     const CChainParams& params{m_chainman.GetParams()};
@@ -3842,6 +4028,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     const auto time_1{SteadyClock::now()};
     m_chainman.time_check += time_1 - time_start;
+    m_chainman.connect_times.Add(node::ConnectPhase::CHECKS, time_1 - time_start);
     LogDebug(BCLog::BENCH, "    - Sanity checks: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_1 - time_start),
              Ticks<SecondsDouble>(m_chainman.time_check),
@@ -3945,6 +4132,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     const auto time_2{SteadyClock::now()};
     m_chainman.time_forks += time_2 - time_1;
+    m_chainman.connect_times.Add(node::ConnectPhase::FORKS, time_2 - time_1);
     LogDebug(BCLog::BENCH, "    - Fork checks: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_2 - time_1),
              Ticks<SecondsDouble>(m_chainman.time_forks),
@@ -3960,6 +4148,29 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && parallel_script_checks ? &m_chainman.GetCheckQueue() : nullptr);
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
 
+    // WATTx Privacy: Privacy proofs are verified on their own queue while the
+    // transactions are connected, key images are checked serially below
+    CCheckQueueControl<PrivacyCheck> privacy_control(parallel_privacy_checks ? &m_chainman.GetPrivacyCheckQueue() : nullptr);
+    std::set<uint256> block_key_images;
+
+    // Range proofs of the block's transactions are verified in batches of
+    // RANGE_PROOF_BATCH_SIZE proofs, each batch one privacy_control job
+    auto range_proofs = std::make_shared<privacy::CRangeProofBatch>();
+    auto flush_range_proofs = [&]() -> bool {
+        if (range_proofs->Size() == 0) return true;
+        PrivacyCheck check(std::move(range_proofs));
+        range_proofs = std::make_shared<privacy::CRangeProofBatch>();
+        if (parallel_privacy_checks) {
+            std::vector<PrivacyCheck> vPrivacyChecks;
+            vPrivacyChecks.push_back(std::move(check));
+            privacy_control.Add(std::move(vPrivacyChecks));
+        } else if (auto result = check()) {
+            state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, result->first, result->second);
+            return false;
+        }
+        return true;
+    };
+
     std::vector<int> prevheights;
     CAmount nFees = 0;
     CAmount nActualStakeReward = 0;
@@ -3969,13 +4180,13 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
 
     ///////////////////////////////////////////////////////// // qtum
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
     std::map<dev::Address, std::pair<CHeightTxIndexKey, std::vector<uint256>>> heightIndexes;
+    std::map<std::pair<dev::h256, dev::Address>, std::vector<uint256>> topicIndexes;
+    std::vector<uint256> receiptTxs;
     /////////////////////////////////////////////////////////
 
     uint64_t blockGasUsed = 0;
+    dev::eth::LogBloom blockLogBloom;
     CAmount gasRefunds=0;
 
     uint64_t nValueOut=0;
@@ -3992,6 +4203,29 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
         }
     }
 
+    // Warm the state for the block's contract executions on worker threads
+    std::unique_ptr<EvmStatePrefetcher> prefetcher;
+    if (nEvmPrefetchThreads > 0 && state.IsValid()) {
+        std::vector<std::vector<QtumTransaction>> executions;
+        for (const CTransactionRef& ptx : block.vtx) {
+            if (!ptx->HasCreateOrCall() || ptx->HasOpSpend()) continue;
+            try {
+                ExtractQtumTX extracted;
+                if (ExtractQtumTransactions(*ptx, *this, m_mempool, &view, &block.vtx, contractflags, extracted)) {
+                    executions.push_back(std::move(extracted.first));
+                }
+            } catch (...) {
+                // Malformed transactions are rejected by the sequential pass
+            }
+        }
+        if (executions.size() >= EvmStatePrefetcher::MIN_EXECUTIONS) {
+            prefetcher = std::make_unique<EvmStatePrefetcher>(block, pindex->pprev, m_chain, blockGasLimit, std::move(executions), nEvmPrefetchThreads);
+        }
+    }
+
+    // Contract execution and privacy checks are reported apart from the rest of the transactions
+    SteadyClock::duration time_evm{};
+    SteadyClock::duration time_privacy{};
     for (unsigned int i = 0; i < block.vtx.size(); i++)
     {
         if (!state.IsValid()) break;
@@ -4031,49 +4265,49 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 break;
             }
 
-            // WATTx Privacy: Validate privacy transaction in block
+            // WATTx Privacy: Validate privacy transaction in block. Key images
+            // are checked here in block order, the proofs go to privacy_control.
             if (privacy::IsPrivacyActive(pindex->nHeight, params.GetConsensus()) &&
                 privacy::HasPrivacyData(tx)) {
+                const auto privacy_start{SteadyClock::now()};
                 auto privTx = privacy::ExtractPrivacyTransaction(tx);
                 if (privTx.has_value()) {
-                    auto keyImageDB = privacy::GetKeyImageDB();
+                    auto keyImageDB = KeyImageDB();
                     if (keyImageDB) {
+                        // Proofs already verified by the mempool are skipped
+                        const bool proofs_cached{m_chainman.m_validation_cache.m_privacy_proof_cache.contains(
+                            PrivacyProofCacheEntry(m_chainman.m_validation_cache, tx), /*erase=*/!fJustCheck)};
                         TxValidationState tx_state;
-                        if (!privacy::ContextualCheckPrivacyTransaction(*privTx, *keyImageDB, tx_state, pindex->nHeight)) {
+                        if (!privacy::CheckPrivacyTransaction(*privTx, tx_state, pindex->nHeight) ||
+                            !privacy::CheckPrivacyKeyImagesUnspent(*privTx, *keyImageDB, tx_state) ||
+                            (params.GetConsensus().IsPrivacyKeyImageUniqueActive(pindex->nHeight) &&
+                             !privacy::CheckPrivacyKeyImagesUniqueInBlock(*privTx, block_key_images, tx_state)) ||
+                            (!proofs_cached && !privacy::AddPrivacyRangeProofs(*privTx, *range_proofs, tx_state))) {
                             state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
                                           tx_state.GetRejectReason(),
                                           tx_state.GetDebugMessage());
                             break;
                         }
-                    }
-                }
-            }
 
-            ////////////////////////////////////////////////////////////////// // qtum
-            if (fAddressIndex)
-            {
-                for (size_t j = 0; j < tx.vin.size(); j++) {
-                    const CTxIn input = tx.vin[j];
-                    const CTxOut &prevout = view.GetOutputFor(tx.vin[j]);
-
-                    CTxDestination dest;
-                    if (ExtractDestination(input.prevout, prevout.scriptPubKey, dest)) {
-                        valtype bytesID(std::visit(DataVisitor(), dest));
-                        if(bytesID.empty()) {
-                            continue;
+                        if (!proofs_cached) {
+                            PrivacyCheck check(std::make_shared<const privacy::CPrivacyTransaction>(std::move(*privTx)), tx.GetHash());
+                            if (parallel_privacy_checks) {
+                                std::vector<PrivacyCheck> vPrivacyChecks;
+                                vPrivacyChecks.push_back(std::move(check));
+                                privacy_control.Add(std::move(vPrivacyChecks));
+                            } else if (auto result = check()) {
+                                state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, result->first, result->second);
+                                break;
+                            }
+                        }
+                        if (range_proofs->Size() >= RANGE_PROOF_BATCH_SIZE && !flush_range_proofs()) {
+                            break;
                         }
-                        valtype addressBytes(32);
-                        std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
-                        int addressIndexType = GetAddressIndexType(dest);
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(addressIndexType, uint256(addressBytes), pindex->nHeight, i, tx.GetHash(), j, true), prevout.nValue * -1));
-
-                        // remove address from unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressIndexType, uint256(addressBytes), input.prevout.hash, input.prevout.n), CAddressUnspentValue()));
-                        spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue(tx.GetHash(), j, pindex->nHeight, prevout.nValue, addressIndexType, uint256(addressBytes))));
                     }
                 }
+                time_privacy += SteadyClock::now() - privacy_start;
             }
-            //////////////////////////////////////////////////////////////////
+
         }
 
         // GetTransactionSigOpCost counts 3 types of sigops:
@@ -4140,10 +4374,8 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 break;
             }
 
-            QtumTxConverter convert(tx, *this, m_mempool, &view, &block.vtx, contractflags);
-
             ExtractQtumTX resultConvertQtumTX;
-            if(!convert.extractionQtumTransactions(resultConvertQtumTX)){
+            if(!ExtractQtumTransactions(tx, *this, m_mempool, &view, &block.vtx, contractflags, resultConvertQtumTX)){
                 state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-tx-bad-contract-format", "ConnectBlock(): Contract transaction of the wrong format");
                 break;
             }
@@ -4154,6 +4386,9 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
             dev::u256 gasAllTxs = dev::u256(0);
             ByteCodeExec exec(block, resultConvertQtumTX.first, blockGasLimit, pindex->pprev, m_chain);
+            if(!fJustCheck){
+                exec.setStatsSource(EvmStatsSource::BLOCK);
+            }
             //validate VM version and other ETH params before execution
             //Reject anything unknown (could be changed later by DGP)
             //TODO evaluate if this should be relaxed for soft-fork purposes
@@ -4233,6 +4468,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 }
             }
 
+            const auto evm_start{SteadyClock::now()};
             if(!exec.performByteCode()){
                 state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-tx-unknown-error", "ConnectBlock(): Unknown error during contract execution");
                 break;
@@ -4244,6 +4480,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-vm-exec-processing", "ConnectBlock(): Error processing VM execution results");
                 break;
             }
+            time_evm += SteadyClock::now() - evm_start;
 
             std::vector<TransactionReceiptInfo> tri;
             if (fLogEvents && !fJustCheck)
@@ -4255,7 +4492,13 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                             heightIndexes[log.address].first = CHeightTxIndexKey(pindex->nHeight, log.address);
                         }
                         heightIndexes[log.address].second.push_back(tx.GetHash());
+                        if(!log.topics.empty()) {
+                            std::vector<uint256>& topicHashes = topicIndexes[std::make_pair(log.topics[0], log.address)];
+                            if(topicHashes.empty() || topicHashes.back() != tx.GetHash())
+                                topicHashes.push_back(tx.GetHash());
+                        }
                     }
+                    blockLogBloom |= resultExec[k].txRec.bloom();
                     uint64_t gasUsed = uint64_t(resultExec[k].execRes.gasUsed);
                     countCumulativeGasUsed += gasUsed;
                     tri.push_back(TransactionReceiptInfo{
@@ -4281,6 +4524,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 }
 
                 pstorageresult->addResult(uintToh256(tx.GetHash()), tri);
+                receiptTxs.push_back(tx.GetHash());
             }
 
             blockGasUsed += bcer.usedGas;
@@ -4306,30 +4550,6 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
         }
 /////////////////////////////////////////////////////////////////////////////////////////
 
-        /////////////////////////////////////////////////////////////////////////////////// // qtum
-        if (fAddressIndex) {
-
-            for (unsigned int k = 0; k < tx.vout.size(); k++) {
-                const CTxOut &out = tx.vout[k];
-                const bool isTxCoinStake = tx.IsCoinStake();
-
-                CTxDestination dest;
-                if (ExtractDestination({tx.GetHash(), k}, out.scriptPubKey, dest)) {
-                    valtype bytesID(std::visit(DataVisitor(), dest));
-                    if(bytesID.empty()) {
-                        continue;
-                    }
-                    valtype addressBytes(32);
-                    std::copy(bytesID.begin(), bytesID.end(), addressBytes.begin());
-                    int addressIndexType = GetAddressIndexType(dest);
-                    // record receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(addressIndexType, uint256(addressBytes), pindex->nHeight, i, tx.GetHash(), k, false), out.nValue));
-                    // record unspent output
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressIndexType, uint256(addressBytes), tx.GetHash(), k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight, isTxCoinStake)));
-                }
-            }
-        }
-        ///////////////////////////////////////////////////////////////////////////////////
 
         CTxUndo undoDummy;
         if (i > 0) {
@@ -4337,8 +4557,13 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
         }
         UpdateCoins(tx, view, i == 0 ? undoDummy : blockundo.vtxundo.back(), pindex->nHeight);
     }
+    if (state.IsValid()) {
+        flush_range_proofs();
+    }
     const auto time_3{SteadyClock::now()};
     m_chainman.time_connect += time_3 - time_2;
+    m_chainman.connect_times.Add(node::ConnectPhase::TRANSACTIONS, time_3 - time_2 - time_evm - time_privacy);
+    m_chainman.connect_times.Add(node::ConnectPhase::EVM, time_evm);
     LogDebug(BCLog::BENCH, "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs (%.2fms/blk)]\n", (unsigned)block.vtx.size(),
              Ticks<MillisecondsDouble>(time_3 - time_2), Ticks<MillisecondsDouble>(time_3 - time_2) / block.vtx.size(),
              nInputs <= 1 ? 0 : Ticks<MillisecondsDouble>(time_3 - time_2) / (nInputs - 1),
@@ -4350,16 +4575,25 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     }
     if(state.IsValid() && !CheckReward(block, state, pindex->nHeight, params.GetConsensus(), nFees, gasRefunds, nActualStakeReward, checkVouts, nValueCoinPrev, delegateOutputExist, m_chain, m_blockman))
         state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "block-reward-invalid", "ConnectBlock(): Reward check failed");
+    const auto time_reward{SteadyClock::now()};
+    m_chainman.connect_times.Add(node::ConnectPhase::REWARD, time_reward - time_3);
 
     auto parallel_result = control.Complete();
     if (parallel_result.has_value() && state.IsValid()) {
         state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, strprintf("mandatory-script-verify-flag-failed (%s)", ScriptErrorString(parallel_result->first)), parallel_result->second);
     }
+    const auto time_scripts{SteadyClock::now()};
+    m_chainman.connect_times.Add(node::ConnectPhase::SCRIPTS, time_scripts - time_reward);
+    auto privacy_result = privacy_control.Complete();
+    if (privacy_result.has_value() && state.IsValid()) {
+        state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, privacy_result->first, privacy_result->second);
+    }
     if (!state.IsValid()) {
         LogInfo("Block validation error: %s", state.ToString());
         return false;
     }
     const auto time_4{SteadyClock::now()};
+    m_chainman.connect_times.Add(node::ConnectPhase::PRIVACY, time_4 - time_scripts + time_privacy);
     m_chainman.time_verify += time_4 - time_2;
     LogDebug(BCLog::BENCH, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n", nInputs - 1,
              Ticks<MillisecondsDouble>(time_4 - time_2),
@@ -4452,12 +4686,15 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
         }
     }
 
+    const auto time_state{SteadyClock::now()};
+    m_chainman.connect_times.Add(node::ConnectPhase::STATE, time_state - time_4);
     if (!m_blockman.WriteBlockUndo(blockundo, state, *pindex)) {
         return false;
     }
 
     const auto time_5{SteadyClock::now()};
     m_chainman.time_undo += time_5 - time_4;
+    m_chainman.connect_times.Add(node::ConnectPhase::UNDO, time_5 - time_state);
     LogDebug(BCLog::BENCH, "    - Write undo data: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_5 - time_4),
              Ticks<SecondsDouble>(m_chainman.time_undo),
@@ -4475,11 +4712,36 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             if (!m_blockman.m_block_tree_db->WriteHeightIndex(e.second.first, e.second.second))
                 return FatalError(m_chainman.GetNotifications(), state, _("Failed to write height index"));
         }
+
+        std::vector<std::pair<CTopicTxIndexKey, std::vector<uint256>>> topicIndex;
+        for (auto& e: topicIndexes)
+        {
+            topicIndex.emplace_back(CTopicTxIndexKey(e.first.first, pindex->nHeight, e.first.second), std::move(e.second));
+        }
+        if (!m_blockman.m_block_tree_db->WriteTopicIndex(topicIndex))
+            return FatalError(m_chainman.GetNotifications(), state, _("Failed to write topic index"));
+
+        // DisconnectBlock undoes the indexes and receipts from this record
+        if (!receiptTxs.empty())
+        {
+            CLogIndexUndo logIndexUndo;
+            logIndexUndo.blockHash = block_hash;
+            for (const auto& e: heightIndexes)
+                logIndexUndo.heightIndex.push_back(e.second.first);
+            for (const auto& e: topicIndex)
+                logIndexUndo.topicIndex.push_back(e.first);
+            logIndexUndo.receipts = std::move(receiptTxs);
+            if (!m_blockman.m_block_tree_db->WriteLogIndexUndo(pindex->nHeight, logIndexUndo))
+                return FatalError(m_chainman.GetNotifications(), state, _("Failed to write log index undo"));
+        }
     }
 
     // The stake and delegate index is needed for MPoS, update it while MPoS is active
     if(pindex->nHeight <= params.GetConsensus().nLastMPoSBlock)
     {
+        // Keep the MPoS recipient cache in step with the index
+        MPoSRecipientCache::Recipient recipient;
+        recipient.blockHash = pindex->GetBlockHash();
         if(block.IsProofOfStake()){
             // Read the public key from the second output
             std::vector<unsigned char> vchPubKey;
@@ -4491,6 +4753,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             }else{
                 m_blockman.m_block_tree_db->WriteStakeIndex(pindex->nHeight, uint160());
             }
+            recipient.stakerAddress = pkh;
 
             if(block.HasProofOfDelegation())
             {
@@ -4498,44 +4761,21 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 uint8_t fee = 0;
                 GetBlockDelegation(block, pkh, address, fee, view, *this);
                 m_blockman.m_block_tree_db->WriteDelegateIndex(pindex->nHeight, address, fee);
+                recipient.hasDelegate = true;
+                recipient.delegateAddress = address;
+                recipient.fee = fee;
             }
         }else{
             m_blockman.m_block_tree_db->WriteStakeIndex(pindex->nHeight, uint160());
         }
-    }
 
-    ///////////////////////////////////////////////////////////// // qtum
-    if (fAddressIndex) {
-        if (!m_blockman.m_block_tree_db->WriteAddressIndex(addressIndex)) {
-            return FatalError(m_chainman.GetNotifications(), state, _("Failed to write address index"));
-        }
-        if (!m_blockman.m_block_tree_db->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            return FatalError(m_chainman.GetNotifications(), state, _("Failed to write address unspent index"));
-        }
-
-        if (!m_blockman.m_block_tree_db->UpdateSpentIndex(spentIndex))
-            return FatalError(m_chainman.GetNotifications(), state, _("Failed to write transaction index"));
-
-        unsigned int logicalTS = pindex->nTime;
-        unsigned int prevLogicalTS = 0;
-
-        // retrieve logical timestamp of the previous block
-        if (pindex->pprev)
-            if (!m_blockman.m_block_tree_db->ReadTimestampBlockIndex(pindex->pprev->GetBlockHash(), prevLogicalTS))
-                LogPrintf("%s: Failed to read previous block's logical timestamp\n", __func__);
-
-        if (logicalTS <= prevLogicalTS) {
-            logicalTS = prevLogicalTS + 1;
-            LogDebug(BCLog::INDEX, "%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, pindex->nTime, prevLogicalTS, logicalTS);
-        }
-
-        if (!m_blockman.m_block_tree_db->WriteTimestampIndex(CTimestampIndexKey(logicalTS, pindex->GetBlockHash())))
-            return FatalError(m_chainman.GetNotifications(), state, _("Failed to write timestamp index"));
-
-        if (!m_blockman.m_block_tree_db->WriteTimestampBlockIndex(CTimestampBlockIndexKey(pindex->GetBlockHash()), CTimestampBlockIndexValue(logicalTS)))
-            return FatalError(m_chainman.GetNotifications(), state, _("Failed to write blockhash index"));
+        MPoSRecipientCache& recipientCache = GetMPoSRecipientCache();
+        recipientCache.Add(pindex->nHeight, recipient);
+        // New blocks pay the recipients of the blocks one coinbase maturity back
+        const Consensus::Params& consensus = params.GetConsensus();
+        recipientCache.Prune(pindex->nHeight - consensus.CoinbaseMaturity(pindex->nHeight + 1) - consensus.nMPoSRewardRecipients);
     }
-    /////////////////////////////////////////////////////////////
+
 
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
@@ -4557,7 +4797,12 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     );
 
     if (fLogEvents)
+    {
+        pstorageresult->addBlockBloom(pindex->nHeight, blockLogBloom);
         pstorageresult->commitResults();
+    }
+    const auto time_logs{SteadyClock::now()};
+    m_chainman.connect_times.Add(node::ConnectPhase::INDEX, time_logs - time_5);
 
     // Distribute delegation rewards for PoS blocks
     if (block.IsProofOfStake() && validators::g_validator_db && validators::g_delegation_db) {
@@ -4604,15 +4849,18 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     if (block.IsProofOfStake() && block.vtx.size() > 1 && block.vtx[1]->IsCoinStake()) {
         const CTransaction& coinstakeTx = *block.vtx[1];
         if (!coinstakeTx.vin.empty()) {
-            GetCoinstakeTracker().MarkUTXOUsed(coinstakeTx.vin[0].prevout, pindex->nHeight);
+            // vtxundo[0] belongs to the coinstake, the first transaction after the coinbase
+            GetCoinstakeTracker().MarkUTXOUsed(coinstakeTx.vin[0].prevout, pindex->nHeight, &blockundo.vtxundo[0].vprevout[0]);
         }
     }
 
+    const auto time_delegation{SteadyClock::now()};
+    m_chainman.connect_times.Add(node::ConnectPhase::DELEGATION, time_delegation - time_logs);
+
     // WATTx FCMP: Update curve tree and key image database
     // This adds FCMP outputs to the tree and marks key images as spent
-    if (privacy::IsFcmpActive(pindex->nHeight, params.GetConsensus()) &&
-        privacy::IsFcmpStateAvailable() && privacy::GetFcmpState().IsInitialized()) {
-        if (!privacy::GetFcmpState().ConnectBlock(block, pindex)) {
+    if (auto* fcmp{FcmpState()}; privacy::IsFcmpActive(pindex->nHeight, params.GetConsensus()) && fcmp) {
+        if (!fcmp->ConnectBlock(block, pindex)) {
             LogPrintf("FCMP: Failed to connect block %d for FCMP state\n", pindex->nHeight);
             // Note: Non-fatal for now - FCMP is optional until fully activated
         }
@@ -4620,7 +4868,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     // WATTx Privacy: Register spent key images
     if (privacy::IsPrivacyActive(pindex->nHeight, params.GetConsensus())) {
-        auto keyImageDB = privacy::GetKeyImageDB();
+        auto keyImageDB = KeyImageDB();
         if (keyImageDB) {
             for (size_t i = 0; i < block.vtx.size(); i++) {
                 const CTransaction& tx = *block.vtx[i];
@@ -4635,6 +4883,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             }
         }
     }
+    m_chainman.connect_times.Add(node::ConnectPhase::CURVE_TREE, SteadyClock::now() - time_delegation);
 
     return true;
 }
@@ -4783,6 +5032,12 @@ bool Chainstate::FlushStateToDisk(
             }
             m_last_write = nNow;
         }
+        // Writing contract state trie nodes ahead of the coins is always safe, so do it whenever they take too much memory
+        if (!fDoFullFlush && globalState && globalState->db().pendingSize() + globalState->dbUtxo().pendingSize() > MAX_EVM_STATE_PENDING_SIZE) {
+            LOG_TIME_MILLIS_WITH_CATEGORY("write contract state to disk", BCLog::BENCH);
+            globalState->db().flush();
+            globalState->dbUtxo().flush();
+        }
         // Flush best chain related state. This can only be done if the blocks / block index write was also done.
         if (fDoFullFlush && !CoinsTip().GetBestBlock().IsNull()) {
             if (coins_mem_usage >= WARN_FLUSH_COINS_SIZE) LogWarning("Flushing large (%d GiB) UTXO set to disk, it may take several minutes", coins_mem_usage >> 30);
@@ -4797,11 +5052,20 @@ bool Chainstate::FlushStateToDisk(
             if (!CheckDiskSpace(m_chainman.m_options.datadir, 48 * 2 * 2 * CoinsTip().GetCacheSize())) {
                 return FatalError(m_chainman.GetNotifications(), state, _("Disk space is too low!"));
             }
+            // The contract state roots of the flushed tip must be readable after a restart
+            if (globalState) {
+                globalState->db().flush();
+                globalState->dbUtxo().flush();
+            }
             // Flush the chainstate (which may refer to block index entries).
             const auto empty_cache{(mode == FlushStateMode::ALWAYS) || fCacheLarge || fCacheCritical};
             if (empty_cache ? !CoinsTip().Flush() : !CoinsTip().Sync()) {
                 return FatalError(m_chainman.GetNotifications(), state, _("Failed to write to coin database."));
             }
+            // The curve tree buffers its writes until the coins they go with are written
+            if (auto* fcmp{FcmpState()}; fcmp && !fcmp->Flush()) {
+                return FatalError(m_chainman.GetNotifications(), state, _("Failed to write to curve tree database."));
+            }
             m_last_flush = nNow;
             full_flush_completed = true;
             TRACEPOINT(utxocache, flush,
@@ -5054,6 +5318,8 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     const CBlock& blockConnecting = *pthisBlock;
     // Apply the block atomically to the chain state.
     const auto time_2{SteadyClock::now()};
+    m_chainman.connect_times = {};
+    m_chainman.connect_times.Add(node::ConnectPhase::LOAD, time_2 - time_1);
     SteadyClock::time_point time_3;
     // When adding aggregate statistics in the future, keep in mind that
     // num_blocks_total may be zero until the ConnectBlock() call below.
@@ -5062,6 +5328,14 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     {
         CCoinsViewCache view(&CoinsTip());
 
+        // qtum: While a snapshot is validated in the background both
+        // chainstates connect blocks to the shared state databases, so the
+        // state is set to this chainstate's tip first
+        if (m_chainman.GetAll().size() > 1 && pindexNew->pprev &&
+            !pindexNew->pprev->hashStateRoot.IsNull() && !pindexNew->pprev->hashUTXORoot.IsNull()) {
+            globalState->setRoot(uintToh256(pindexNew->pprev->hashStateRoot));
+            globalState->setRootUTXO(uintToh256(pindexNew->pprev->hashUTXORoot));
+        }
         dev::h256 oldHashStateRoot(globalState->rootHash()); // qtum
         dev::h256 oldHashUTXORoot(globalState->rootHashUTXO()); // qtum
         bool rv = ConnectBlock(blockConnecting, state, pindexNew, view);
@@ -5090,6 +5364,7 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     }
     const auto time_4{SteadyClock::now()};
     m_chainman.time_flush += time_4 - time_3;
+    m_chainman.connect_times.Add(node::ConnectPhase::FLUSH, time_4 - time_3);
     LogDebug(BCLog::BENCH, "  - Flush: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_4 - time_3),
              Ticks<SecondsDouble>(m_chainman.time_flush),
@@ -5100,6 +5375,7 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     }
     const auto time_5{SteadyClock::now()};
     m_chainman.time_chainstate += time_5 - time_4;
+    m_chainman.connect_times.Add(node::ConnectPhase::CHAINSTATE, time_5 - time_4);
     LogDebug(BCLog::BENCH, "  - Writing chainstate: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_5 - time_4),
              Ticks<SecondsDouble>(m_chainman.time_chainstate),
@@ -5116,6 +5392,10 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     const auto time_6{SteadyClock::now()};
     m_chainman.time_post_connect += time_6 - time_5;
     m_chainman.time_total += time_6 - time_1;
+    m_chainman.connect_times.Add(node::ConnectPhase::POSTPROCESS, time_6 - time_5);
+    m_chainman.connect_times.height = pindexNew->nHeight;
+    m_chainman.connect_times.hash = pindexNew->GetBlockHash();
+    node::g_block_connect_stats.Record(m_chainman.connect_times);
     LogDebug(BCLog::BENCH, "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_6 - time_5),
              Ticks<SecondsDouble>(m_chainman.time_post_connect),
@@ -5450,6 +5730,12 @@ bool Chainstate::ActivateBestChain(BlockValidationState& state, std::shared_ptr<
                     m_chainman.m_options.signals->UpdatedBlockTip(pindexNewTip, pindexFork, still_in_ibd);
                 }
 
+                // Warm the state for the next block's contract transactions from the mempool
+                if (g_mempool_evm_warmer && !still_in_ibd) {
+                    QtumDGP qtumDGP(globalState.get(), *this, fGettingValuesDGP);
+                    g_mempool_evm_warmer->Resume(pindexNewTip, m_chain, qtumDGP.getBlockGasLimit(pindexNewTip->nHeight + 1));
+                }
+
                 if (kernel::IsInterrupted(m_chainman.GetNotifications().blockTip(GetSynchronizationState(still_in_ibd, m_chainman.m_blockman.m_blockfiles_indexed), *pindexNewTip))) {
                     // Just breaking and returning success for now. This could
                     // be changed to bubble up the kernel::Interrupted value to
@@ -5938,6 +6224,52 @@ bool GetBlockDelegation(const CBlock& block, const uint160& staker, uint160& add
     return true;
 }
 
+std::optional<std::pair<std::string, std::string>> PrivacyCheck::operator()()
+{
+    if (m_range_proofs) {
+        if (!m_range_proofs->Verify()) {
+            return std::make_pair("privacy-invalid-range-proof",
+                                  strprintf("Batch of %u range proofs failed to verify", m_range_proofs->Size()));
+        }
+        return std::nullopt;
+    }
+
+    // Range proofs were added to a block batch by ConnectBlock
+    TxValidationState state;
+    if (!privacy::VerifyPrivacyTransactionProofs(*m_privacy_tx, state, /*checkRangeProofs=*/false)) {
+        return std::make_pair(state.GetRejectReason(),
+                              strprintf("%s in tx %s", state.GetDebugMessage(), m_txid.ToString()));
+    }
+    return std::nullopt;
+}
+
+std::optional<bool> HeaderCheck::operator()()
+{
+    const CBlockHeader& header{*m_header};
+    if (header.IsProofOfWork()) {
+        CheckHeaderPoWAtHeight(header, m_height, *m_params);
+        return std::nullopt;
+    }
+
+    if (header.GetBlockSignature().size() == CPubKey::COMPACT_SIGNATURE_SIZE) {
+        CPubKey pubkey;
+        RecoverBlockSignaturePubKey(header, pubkey);
+    }
+    if (m_stake) {
+        // Same checks as CheckHeaderPoS(), with the stake cache-less CheckKernel()
+        const StakeContext& stake{*m_stake};
+        const int prev_height{m_height - 1};
+        bool valid{prev_height < m_params->nEnableHeaderSignatureHeight ||
+                   CheckRecoveredPubKeyFromBlockSignature(prev_height, header, stake.coin)};
+        valid = valid && !stake.coin.IsSpent() && m_height - int(stake.coin.nHeight) >= m_params->CoinbaseMaturity(m_height);
+        uint256 hash_proof, target;
+        valid = valid && CheckStakeKernelHash(prev_height, stake.prev_stake_modifier, header.nBits, stake.block_from_time, stake.coin.out.nValue,
+                                              header.prevoutStake, header.StakeTime(), hash_proof, target);
+        *m_stake_verified = valid;
+    }
+    return std::nullopt;
+}
+
 bool CheckBlockSignature(const CBlock& block)
 {
     std::vector<unsigned char> vchBlockSig = block.GetBlockSignature();
@@ -5955,7 +6287,7 @@ bool CheckBlockSignature(const CBlock& block)
     if(vchBlockSig.size() == CPubKey::COMPACT_SIGNATURE_SIZE)
     {
         CPubKey pubkey;
-        if(pubkey.RecoverCompact(hash, vchBlockSig) && pubkey == CPubKey(vchPubKey))
+        if(RecoverBlockSignaturePubKey(block, pubkey) && pubkey == CPubKey(vchPubKey))
             return true;
     }
 
@@ -6627,6 +6959,8 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_LOW_WORK, "too-little-chainwork");
     }
     CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, m_best_header)};
+    // CheckBlockHeader verified the proof of work at this height above
+    if (pindex->IsProofOfWork() && pindex->pprev) pindex->nStatus |= BLOCK_POW_CHECKED;
 
     if (ppindex)
         *ppindex = pindex;
@@ -6651,6 +6985,77 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
     return true;
 }
 
+void ChainstateManager::PrecomputeHeaderChecks(std::span<const CBlockHeader> headers, const CBlockIndex*& checked_tip,
+                                                std::vector<uint256>& stake_checked)
+{
+    checked_tip = nullptr;
+    stake_checked.clear();
+    if (headers.size() < 2 || !m_header_check_queue.HasThreads()) return;
+
+    // Capture what the checks need in one short locked section. The previous
+    // block of every header but the first is in the batch itself, so heights
+    // and stake modifiers are carried along as AddToBlockIndex() would set them.
+    std::vector<HeaderCheck> checks;
+    std::vector<uint8_t> verified(headers.size(), 0);
+    {
+        LOCK(::cs_main);
+        const CBlockIndex* prev{m_blockman.LookupBlockIndex(headers[0].hashPrevBlock)};
+        // Do not spend hashes on a batch that cannot connect
+        if (!prev) return;
+        // AcceptBlockHeader() only checks the stake of headers outside IBD
+        const bool check_stake{!IsInitialBlockDownload()};
+        CCoinsViewCache& view{ActiveChainstate().CoinsTip()};
+        checked_tip = ActiveChain().Tip();
+
+        int height{prev->nHeight};
+        uint256 stake_modifier{prev->nStakeModifier};
+        uint256 prev_hash{headers[0].hashPrevBlock};
+        for (size_t i = 0; i < headers.size(); ++i) {
+            const CBlockHeader& header{headers[i]};
+            if (header.hashPrevBlock != prev_hash) break;
+            prev_hash = header.GetHash();
+            ++height;
+            const uint256 prev_stake_modifier{stake_modifier};
+            stake_modifier = ComputeStakeModifier(stake_modifier, header.IsProofOfWork() ? prev_hash : header.prevoutStake.hash.ToUint256());
+
+            // Known headers are not checked again
+            if (const CBlockIndex* known{m_blockman.LookupBlockIndex(prev_hash)}) {
+                height = known->nHeight;
+                stake_modifier = known->nStakeModifier;
+                continue;
+            }
+            if (header.IsProofOfWork()) {
+                checks.emplace_back(header, height, GetConsensus());
+                continue;
+            }
+            if (!check_stake) continue;
+
+            // Stakes that are not in the UTXO set, or are newer than the batch's
+            // first previous block, are left to the serial check
+            const std::optional<Coin> coin{view.GetCoin(header.prevoutStake)};
+            const CBlockIndex* block_from{coin && int(coin->nHeight) <= prev->nHeight ? prev->GetAncestor(coin->nHeight) : nullptr};
+            if (!block_from) {
+                checks.emplace_back(header, height, GetConsensus());
+                continue;
+            }
+            checks.emplace_back(header, height, GetConsensus(),
+                                HeaderCheck::StakeContext{prev_stake_modifier, *coin, block_from->nTime}, verified[i]);
+        }
+    }
+    if (checks.size() < 2) {
+        checked_tip = nullptr;
+        return;
+    }
+
+    CCheckQueueControl<HeaderCheck> control(&m_header_check_queue);
+    control.Add(std::move(checks));
+    control.Complete();
+
+    for (size_t i = 0; i < headers.size(); ++i) {
+        if (verified[i]) stake_checked.push_back(headers[i].GetHash());
+    }
+}
+
 // Exposed wrapper for AcceptBlockHeader
 bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex,  const CBlockIndex** pindexFirst)
 {
@@ -6664,8 +7069,15 @@ bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> hea
         }
     }
     AssertLockNotHeld(cs_main);
+    const CBlockIndex* checked_tip;
+    std::vector<uint256> stake_checked;
+    PrecomputeHeaderChecks(headers, checked_tip, stake_checked);
     {
         LOCK(cs_main);
+        // The stake checks only hold while the coins they saw are unchanged
+        if (checked_tip && checked_tip == ActiveChain().Tip()) {
+            m_stake_checked_headers.insert(stake_checked.begin(), stake_checked.end());
+        }
         bool bFirst = true;
         bool fInstantBan = false;
         for (size_t i = 0; i < headers.size(); ++i) {
@@ -6675,6 +7087,7 @@ bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> hea
             if (!m_blockman.LoadingBlocks() && !IsInitialBlockDownload() && header.IsProofOfStake() && setStakeSeen.count(std::make_pair(header.prevoutStake, header.nTime)) && !BlockIndex().count(header.GetHash())) {
                 // if it is the last header of the list
                 if(i+1 == headers.size()) {
+                    m_stake_checked_headers.clear();
                     if(fInstantBan) {
                         // if we've seen a dupe stake header already in this list, then instaban
                         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "dupe-stake", strprintf("%s: duplicate proof-of-stake instant ban (%s, %d) for header %s", __func__, header.prevoutStake.ToString(), header.nTime, header.GetHash().ToString()));
@@ -6696,6 +7109,7 @@ bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> hea
                 if(fInstantBan) {
                     state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, state.GetRejectReason(), "instant ban, due to duplicate header in the chain");
                 }
+                m_stake_checked_headers.clear();
                 return false;
             }
             if (ppindex) {
@@ -6707,6 +7121,7 @@ bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> hea
                 }
             }
         }
+        m_stake_checked_headers.clear();
     }
     if (NotifyHeaderTip()) {
         if (IsInitialBlockDownload() && ppindex && *ppindex) {
@@ -6863,6 +7278,9 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
 
     // Header is valid/has work, merkle tree and segwit merkle tree are good...RELAY NOW
     // (but if it does not build on our best tip, let the SendMessages loop relay it)
+    if (!IsInitialBlockDownload() && ActiveTip() == pindex->pprev && m_options.signals) {
+        m_options.signals->NewPoWValidBlock(pindex, pblock);
+    }
 
     // Write block to history file
     if (fNewBlock) *fNewBlock = true;
@@ -7413,10 +7831,6 @@ bool ChainstateManager::LoadBlockIndex()
         // Use the provided setting for -logevents in the new database
         fLogEvents = gArgs.GetBoolArg("-logevents", DEFAULT_LOGEVENTS);
         m_blockman.m_block_tree_db->WriteFlag("logevents", fLogEvents);
-        /////////////////////////////////////////////////////////////// // qtum
-        fAddressIndex = gArgs.GetBoolArg("-addrindex", DEFAULT_ADDRINDEX);
-        m_blockman.m_block_tree_db->WriteFlag("addrindex", fAddressIndex);
-        ///////////////////////////////////////////////////////////////
     }
     return true;
 }
@@ -7452,6 +7866,90 @@ bool Chainstate::LoadGenesisBlock()
     return true;
 }
 
+namespace {
+//! Blocks LoadExternalBlockFile reads ahead of the one it is connecting
+static constexpr size_t MAX_IMPORT_READAHEAD_BLOCKS{256};
+static constexpr size_t MAX_IMPORT_READAHEAD_BYTES{64 << 20};
+//! Maximum number of block import worker threads
+static constexpr int MAX_IMPORT_THREADS{16};
+
+/**
+ * Worker threads of LoadExternalBlockFile. The blocks read ahead of the one
+ * being connected are deserialized here and get their proof of work checked,
+ * which leaves the verdict in the PoW check cache for validation to find.
+ */
+class BlockImportWorkers
+{
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::packaged_task<void()>> m_jobs GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void Loop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            std::packaged_task<void()> job;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                while (m_jobs.empty() && !m_stop) m_cv.wait(lock);
+                // Queued jobs are dropped on stop, nobody waits for them
+                if (m_stop) return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    explicit BlockImportWorkers(int n_threads)
+    {
+        for (int n = 0; n < n_threads; ++n) {
+            m_threads.emplace_back([this, n] {
+                util::ThreadRename(strprintf("loadblk.%i", n));
+                Loop();
+            });
+        }
+    }
+
+    ~BlockImportWorkers()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    //! Queue @p job, or run it right away when there are no worker threads
+    std::future<void> Submit(std::function<void()> job) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::packaged_task<void()> task{std::move(job)};
+        std::future<void> result{task.get_future()};
+        if (m_threads.empty()) {
+            task();
+        } else {
+            WITH_LOCK(m_mutex, m_jobs.push_back(std::move(task)));
+            m_cv.notify_one();
+        }
+        return result;
+    }
+};
+
+//! A block LoadExternalBlockFile read ahead, in file order
+struct ImportedBlock {
+    uint64_t rewind; //!< scan position after its message start
+    uint64_t pos;    //!< file offset of the block data
+    size_t size;     //!< serialized size of the block
+    CBlockHeader header;
+    uint256 hash;
+    //! Serialized block, kept when no worker was asked to deserialize it
+    std::vector<unsigned char> data;
+    //! Block deserialized by a worker, valid once ready completes
+    std::shared_ptr<CBlock> block;
+    std::future<void> ready;
+};
+} // namespace
+
 void ChainstateManager::LoadExternalBlockFile(
     AutoFile& file_in,
     FlatFilePos* dbp,
@@ -7469,44 +7967,116 @@ void ChainstateManager::LoadExternalBlockFile(
         // nRewind indicates where to resume scanning in case something goes wrong,
         // such as a block fails to deserialize.
         uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
-            if (m_interrupt) return;
 
-            blkdat.SetPos(nRewind);
-            nRewind++; // start one byte further next time, in case of failure
-            blkdat.SetLimit(); // remove former limit
-            unsigned int nSize = 0;
-            try {
-                // locate a header
-                MessageStartChars buf;
-                blkdat.FindByte(std::byte(params.MessageStart()[0]));
-                nRewind = blkdat.GetPos() + 1;
-                blkdat >> buf;
-                if (buf != params.MessageStart()) {
-                    continue;
+        // Blocks are read and framed on this thread, then deserialized and
+        // their proof of work checked on the workers while the blocks before
+        // them are connected here, in file order.
+        BlockImportWorkers workers{std::clamp(GetNumCores() - 1, 0, MAX_IMPORT_THREADS)};
+        std::deque<ImportedBlock> pending;
+        size_t pending_bytes{0};
+        //! Heights of the pending blocks, for the PoW checks of their children
+        std::unordered_map<uint256, int, BlockHasher> pending_heights;
+        bool read_all{false};
+
+        // Frame the next block in the file and queue it, false at the end of the file
+        auto read_ahead = [&]() -> bool {
+            while (!blkdat.eof()) {
+                blkdat.SetPos(nRewind);
+                nRewind++; // start one byte further next time, in case of failure
+                blkdat.SetLimit(); // remove former limit
+                unsigned int nSize = 0;
+                try {
+                    // locate a header
+                    MessageStartChars buf;
+                    blkdat.FindByte(std::byte(params.MessageStart()[0]));
+                    nRewind = blkdat.GetPos() + 1;
+                    blkdat >> buf;
+                    if (buf != params.MessageStart()) {
+                        continue;
+                    }
+                    // read size
+                    blkdat >> nSize;
+                    if (nSize < 80 || nSize > dgpMaxBlockSerSize)
+                        continue;
+                } catch (const std::exception&) {
+                    // no valid block header found; don't complain
+                    // (this happens at the end of every blk.dat file)
+                    return false;
                 }
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > dgpMaxBlockSerSize)
-                    continue;
-            } catch (const std::exception&) {
-                // no valid block header found; don't complain
-                // (this happens at the end of every blk.dat file)
-                break;
+                try {
+                    ImportedBlock next;
+                    next.rewind = nRewind;
+                    next.pos = blkdat.GetPos();
+                    next.size = nSize;
+                    blkdat.SetLimit(next.pos + nSize);
+                    // Resume past this block, it is framed now
+                    nRewind = next.pos + nSize;
+                    next.data.resize(nSize);
+                    blkdat.read(MakeWritableByteSpan(next.data));
+                    SpanReader{next.data} >> next.header;
+                    next.hash = next.header.GetHash();
+
+                    // Only blocks that can be connected in order are worth
+                    // deserializing now; the others are read again later
+                    int height{-1};
+                    bool have_data{false};
+                    if (next.hash == params.GetConsensus().hashGenesisBlock) {
+                        height = 0;
+                    } else if (auto it{pending_heights.find(next.header.hashPrevBlock)}; it != pending_heights.end()) {
+                        height = it->second + 1;
+                    }
+                    {
+                        LOCK(cs_main);
+                        const CBlockIndex* pindex{m_blockman.LookupBlockIndex(next.hash)};
+                        have_data = pindex && (pindex->nStatus & BLOCK_HAVE_DATA);
+                        if (height < 0) {
+                            const CBlockIndex* prev{m_blockman.LookupBlockIndex(next.header.hashPrevBlock)};
+                            if (prev) height = prev->nHeight + 1;
+                        }
+                    }
+                    if (height >= 0) pending_heights.emplace(next.hash, height);
+
+                    pending_bytes += nSize;
+                    if (height >= 0 && !have_data) {
+                        next.block = std::make_shared<CBlock>();
+                        next.ready = workers.Submit([data = std::move(next.data), block = next.block, height, &params] {
+                            SpanReader{data} >> TX_WITH_WITNESS(*block);
+                            if (block->IsProofOfWork()) {
+                                // Leaves a valid proof of work in the PoW check cache
+                                (void)CheckHeaderPoWAtHeight(*block, height, params.GetConsensus());
+                            }
+                        });
+                        next.data.clear();
+                    }
+                    pending.push_back(std::move(next));
+                    return true;
+                } catch (const std::exception& e) {
+                    LogDebug(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (nRewind - 1), e.what());
+                }
+            }
+            return false;
+        };
+
+        while (true) {
+            if (m_interrupt) return;
+
+            while (!read_all && pending.size() < MAX_IMPORT_READAHEAD_BLOCKS && pending_bytes < MAX_IMPORT_READAHEAD_BYTES) {
+                read_all = !read_ahead();
             }
+            if (pending.empty()) break;
+
+            ImportedBlock imported{std::move(pending.front())};
+            pending.pop_front();
+            pending_bytes -= imported.size;
+            pending_heights.erase(imported.hash);
+            const uint256& hash{imported.hash};
+            const CBlockHeader& header{imported.header};
+
             try {
-                // read block header
-                const uint64_t nBlockPos{blkdat.GetPos()};
                 if (dbp)
-                    dbp->nPos = nBlockPos;
-                blkdat.SetLimit(nBlockPos + nSize);
-                CBlockHeader header;
-                blkdat >> header;
-                const uint256 hash{header.GetHash()};
-                // Skip the rest of this block (this may read from disk into memory); position to the marker before the
-                // next block, but it's still possible to rewind to the start of the current block (without a disk read).
-                nRewind = nBlockPos + nSize;
-                blkdat.SkipTo(nRewind);
+                    dbp->nPos = imported.pos;
+                // Rethrows if the block failed to deserialize
+                if (imported.ready.valid()) imported.ready.get();
 
                 std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
 
@@ -7525,11 +8095,12 @@ void ChainstateManager::LoadExternalBlockFile(
                     // process in case the block isn't known yet
                     const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
                     if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                        // This block can be processed immediately; rewind to its start, read and deserialize it.
-                        blkdat.SetPos(nBlockPos);
-                        pblock = std::make_shared<CBlock>();
-                        blkdat >> TX_WITH_WITNESS(*pblock);
-                        nRewind = blkdat.GetPos();
+                        // This block can be processed immediately; deserialize it unless a worker did already.
+                        pblock = imported.block;
+                        if (!pblock) {
+                            pblock = std::make_shared<CBlock>();
+                            SpanReader{imported.data} >> TX_WITH_WITNESS(*pblock);
+                        }
 
                         BlockValidationState state;
                         if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
@@ -7616,7 +8187,7 @@ void ChainstateManager::LoadExternalBlockFile(
                 // the reindex process is not the place to attempt to clean and/or compact the block files. if so desired, a studious node operator
                 // may use knowledge of the fact that the block files are not entirely pristine in order to prepare a set of pristine, and
                 // perhaps ordered, block files for later reindexing.
-                LogDebug(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (nRewind - 1), e.what());
+                LogDebug(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (imported.rewind - 1), e.what());
             }
         }
     } catch (const std::runtime_error& e) {
@@ -8187,6 +8758,14 @@ util::Result<CBlockIndex*> ChainstateManager::ActivateSnapshot(
         if (mempool && mempool->size() > 0) {
             return util::Error{Untranslated("Can't activate a snapshot when mempool not empty")};
         }
+
+        // The privacy state of the snapshot replaces the global one, which
+        // the background chainstate then rebuilds on its own
+        auto* fcmp{m_active_chainstate->FcmpState()};
+        auto key_images{m_active_chainstate->KeyImageDB()};
+        if ((fcmp && !fcmp->IsEmpty()) || (key_images && !key_images->IsEmpty())) {
+            return util::Error{Untranslated("Can't activate a snapshot after privacy transactions have been connected")};
+        }
     }
 
     int64_t current_coinsdb_cache_size{0};
@@ -8253,7 +8832,8 @@ util::Result<CBlockIndex*> ChainstateManager::ActivateSnapshot(
         return util::Error{std::move(reason)};
     };
 
-    if (auto res{this->PopulateAndValidateSnapshot(*snapshot_chainstate, coins_file, metadata)}; !res) {
+    node::SnapshotPrivacyState privacy_state;
+    if (auto res{this->PopulateAndValidateSnapshot(*snapshot_chainstate, coins_file, metadata, privacy_state)}; !res) {
         LOCK(::cs_main);
         return cleanup_bad_snapshot(Untranslated(strprintf("Population failed: %s", util::ErrorString(res).original)));
     }
@@ -8274,6 +8854,29 @@ util::Result<CBlockIndex*> ChainstateManager::ActivateSnapshot(
         }
     }
 
+    // The background chainstate starts over with a privacy state of its own,
+    // the global one becomes the snapshot's
+    const fs::path privacy_dir{m_options.datadir / node::SNAPSHOT_PRIVACY_DIRNAME};
+    auto cleanup_privacy_state = [&]() EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+        if (m_snapshot_fcmp) m_snapshot_fcmp->Shutdown();
+        m_snapshot_fcmp.reset();
+        m_snapshot_key_images.reset();
+        std::error_code ec;
+        fs::remove_all(privacy_dir, ec);
+    };
+    cleanup_privacy_state();
+    m_snapshot_fcmp = std::make_unique<privacy::CFcmpConsensusState>();
+    if (!m_snapshot_fcmp->Initialize(privacy_dir)) {
+        cleanup_privacy_state();
+        return cleanup_bad_snapshot(Untranslated("could not create the background privacy state"));
+    }
+    m_snapshot_key_images = std::make_shared<privacy::CKeyImageDB>(privacy_dir / "keyimages", 1 << 20);
+    auto* fcmp{privacy::IsFcmpStateAvailable() && privacy::GetFcmpState().IsInitialized() ? &privacy::GetFcmpState() : nullptr};
+    if (auto res{node::LoadSnapshotPrivacyState(privacy_state, fcmp, privacy::GetKeyImageDB().get(), snapshot_start_block->nHeight)}; !res) {
+        cleanup_privacy_state();
+        return cleanup_bad_snapshot(Untranslated(strprintf("Loading the privacy state failed: %s", util::ErrorString(res).original)));
+    }
+
     assert(!m_snapshot_chainstate);
     m_snapshot_chainstate.swap(snapshot_chainstate);
     const bool chaintip_loaded = m_snapshot_chainstate->LoadChainTip();
@@ -8323,7 +8926,8 @@ static void SnapshotUTXOHashBreakpoint(const util::SignalInterrupt& interrupt)
 util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     Chainstate& snapshot_chainstate,
     AutoFile& coins_file,
-    const SnapshotMetadata& metadata)
+    const SnapshotMetadata& metadata,
+    node::SnapshotPrivacyState& privacy_state)
 {
     // It's okay to release cs_main before we're done using `coins_cache` because we know
     // that nothing else will be referencing the newly created snapshot_chainstate yet.
@@ -8438,6 +9042,30 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     // method.
     coins_cache.SetBestBlock(base_blockhash);
 
+    // qtum: The contract state follows the coins. Its nodes are
+    // content-addressed, so they go straight into the shared state databases.
+    LogPrintf("[snapshot] loading contract state from snapshot %s\n", base_blockhash.ToString());
+    const auto contract_state_hash{node::LoadSnapshotContractState(coins_file, *snapshot_start_block,
+                                                                   [&interrupt = m_interrupt] { return bool(interrupt); })};
+    if (!contract_state_hash) {
+        return util::Error{Untranslated(strprintf("Bad snapshot contract state: %s", util::ErrorString(contract_state_hash).original))};
+    }
+    if (!au_data.hash_contract_state.IsNull() && *contract_state_hash != au_data.hash_contract_state) {
+        return util::Error{Untranslated(strprintf("Bad snapshot contract state hash: expected %s, got %s",
+            au_data.hash_contract_state.ToString(), contract_state_hash->ToString()))};
+    }
+
+    // WATTx Privacy: Followed by the curve tree and key images, loaded by
+    // ActivateSnapshot() once nothing else can fail
+    try {
+        coins_file >> privacy_state;
+    } catch (const std::ios_base::failure&) {
+        return util::Error{Untranslated("Bad snapshot format or truncated snapshot privacy state")};
+    }
+    if (auto res{node::CheckSnapshotPrivacyState(privacy_state, au_data)}; !res) {
+        return util::Error{Untranslated(strprintf("Bad snapshot privacy state: %s", util::ErrorString(res).original))};
+    }
+
     bool out_of_coins{false};
     try {
         std::byte left_over_byte;
@@ -8447,7 +9075,7 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
         out_of_coins = true;
     }
     if (!out_of_coins) {
-        return util::Error{Untranslated(strprintf("Bad snapshot - coins left over after deserializing %d coins",
+        return util::Error{Untranslated(strprintf("Bad snapshot - data left over after deserializing %d coins",
             coins_count))};
     }
 
@@ -8659,15 +9287,59 @@ SnapshotCompletionResult ChainstateManager::MaybeCompleteSnapshotValidation()
         return SnapshotCompletionResult::HASH_MISMATCH;
     }
 
+    // The contract state of the snapshot was checked by the background
+    // chainstate through the state roots of its blocks, the privacy state it
+    // built is checked against the assumeutxo hashes here
+    if (m_snapshot_fcmp && !m_snapshot_fcmp->Flush()) {
+        LogPrintf("[snapshot] failed to flush the background privacy state\n");
+        handle_invalid_snapshot();
+        return SnapshotCompletionResult::STATS_FAILED;
+    }
+    const auto ibd_privacy_state{node::ReadSnapshotPrivacyState(m_snapshot_fcmp.get(), m_snapshot_key_images.get())};
+    if (!ibd_privacy_state) {
+        LogPrintf("[snapshot] %s\n", util::ErrorString(ibd_privacy_state).original);
+        handle_invalid_snapshot();
+        return SnapshotCompletionResult::STATS_FAILED;
+    }
+    if (auto res{node::CheckSnapshotPrivacyState(*ibd_privacy_state, au_data)}; !res) {
+        LogPrintf("[snapshot] privacy state mismatch: %s\n", util::ErrorString(res).original);
+        handle_invalid_snapshot();
+        return SnapshotCompletionResult::HASH_MISMATCH;
+    }
+
     LogPrintf("[snapshot] snapshot beginning at %s has been fully validated\n",
         snapshot_blockhash.ToString());
 
+    if (m_snapshot_fcmp) m_snapshot_fcmp->Shutdown();
+    m_snapshot_fcmp.reset();
+    m_snapshot_key_images.reset();
+    std::error_code ec;
+    fs::remove_all(m_options.datadir / node::SNAPSHOT_PRIVACY_DIRNAME, ec);
+
     m_ibd_chainstate->m_disabled = true;
     this->MaybeRebalanceCaches();
 
     return SnapshotCompletionResult::SUCCESS;
 }
 
+bool ChainstateManager::LoadBackgroundPrivacyState()
+{
+    LOCK(::cs_main);
+    if (!BackgroundSyncInProgress() || m_snapshot_fcmp) return true;
+    if (!privacy::IsFcmpStateAvailable() || !privacy::GetFcmpState().IsInitialized()) return true;
+
+    const fs::path privacy_dir{m_options.datadir / node::SNAPSHOT_PRIVACY_DIRNAME};
+    m_snapshot_fcmp = std::make_unique<privacy::CFcmpConsensusState>();
+    if (!m_snapshot_fcmp->Initialize(privacy_dir)) {
+        m_snapshot_fcmp.reset();
+        LogError("[snapshot] could not open the background privacy state in %s\n", fs::PathToString(privacy_dir));
+        return false;
+    }
+    m_snapshot_key_images = std::make_shared<privacy::CKeyImageDB>(privacy_dir / "keyimages", 1 << 20);
+    LogPrintf("[snapshot] opened the background privacy state in %s\n", fs::PathToString(privacy_dir));
+    return true;
+}
+
 Chainstate& ChainstateManager::ActiveChainstate() const
 {
     LOCK(::cs_main);
@@ -8739,10 +9411,13 @@ static ChainstateManager::Options&& Flatten(ChainstateManager::Options&& opts)
 
 ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Options options, node::BlockManager::Options blockman_options)
     : m_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)},
+      m_header_check_queue{/*batch_size=*/16, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS), "Header check", "headerch"},
+      m_privacy_check_queue{/*batch_size=*/1, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS), "Privacy check", "privch"},
       m_interrupt{interrupt},
       m_options{Flatten(std::move(options))},
       m_blockman{interrupt, std::move(blockman_options)},
-      m_validation_cache{m_options.script_execution_cache_bytes, m_options.signature_cache_bytes}
+      m_validation_cache{m_options.script_execution_cache_bytes, m_options.signature_cache_bytes,
+                         m_options.privacy_proof_cache_bytes}
 {
 }
 
@@ -9014,14 +9689,31 @@ std::pair<int, int> ChainstateManager::GetPruneRange(const Chainstate& chainstat
 }
 
 ////////////////////////////////////////////////////////////////////////////////// // qtum
-bool GetAddressIndex(uint256 addressHash, int type, std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, node::BlockManager& blockman, int start, int end)
+bool GetAddressIndex(uint256 addressHash, int type, std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
+{
+    if (!g_addressindex) {
+        LogError("address index not enabled");
+        return false;
+    }
+
+    if (!g_addressindex->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
+        LogError("unable to get txids for address");
+        return false;
+    }
+
+    return true;
+}
+
+bool GetAddressIndexPage(uint256 addressHash, int type, int start, int end, const CAddressIndexKey* after,
+                         size_t limit, bool reverse, std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                         bool& more)
 {
-    if (!fAddressIndex) {
+    if (!g_addressindex) {
         LogError("address index not enabled");
         return false;
     }
 
-    if (!blockman.m_block_tree_db->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
+    if (!g_addressindex->ReadAddressIndexPage(addressHash, type, start, end, after, limit, reverse, addressIndex, more)) {
         LogError("unable to get txids for address");
         return false;
     }
@@ -9029,28 +9721,60 @@ bool GetAddressIndex(uint256 addressHash, int type, std::vector<std::pair<CAddre
     return true;
 }
 
-bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool& mempool, node::BlockManager& blockman)
+bool GetAddressBalance(uint256 addressHash, int type, int height, CAddressBalanceValue& value)
 {
-    if (!fAddressIndex)
+    if (!g_addressindex) {
+        LogError("address index not enabled");
+        return false;
+    }
+
+    if (!g_addressindex->ReadAddressBalance(addressHash, type, height, value)) {
+        LogError("unable to get balance for address");
+        return false;
+    }
+
+    return true;
+}
+
+bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool& mempool)
+{
+    if (!g_addressindex)
         return false;
 
     if (mempool.getSpentIndex(key, value))
         return true;
 
-    if (!blockman.m_block_tree_db->ReadSpentIndex(key, value))
+    if (!g_addressindex->ReadSpentIndex(key, value))
         return false;
 
     return true;
 }
 
-bool GetAddressUnspent(uint256 addressHash, int type, std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs, node::BlockManager& blockman)
+bool GetAddressUnspent(uint256 addressHash, int type, std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
+{
+    if (!g_addressindex) {
+        LogError("address index not enabled");
+        return false;
+    }
+
+    if (!g_addressindex->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
+        LogError("unable to get txids for address");
+        return false;
+    }
+
+    return true;
+}
+
+bool GetAddressUnspentPage(uint256 addressHash, int type, const CAddressUnspentKey* after, size_t limit,
+                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                           bool& more)
 {
-    if (!fAddressIndex) {
+    if (!g_addressindex) {
         LogError("address index not enabled");
         return false;
     }
 
-    if (!blockman.m_block_tree_db->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
+    if (!g_addressindex->ReadAddressUnspentIndexPage(addressHash, type, after, limit, unspentOutputs, more)) {
         LogError("unable to get txids for address");
         return false;
     }
@@ -9058,14 +9782,14 @@ bool GetAddressUnspent(uint256 addressHash, int type, std::vector<std::pair<CAdd
     return true;
 }
 
-bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes, ChainstateManager& chainman)
+bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes)
 {
-    if (!fAddressIndex) {
+    if (!g_addressindex) {
         LogError("Timestamp index not enabled");
         return false;
     }
 
-    if (!chainman.m_blockman.m_block_tree_db->ReadTimestampIndex(high, low, fActiveOnly, hashes, chainman)) {
+    if (!g_addressindex->ReadTimestampIndex(high, low, fActiveOnly, hashes)) {
         LogError("Unable to get hashes for timestamps");
         return false;
     }
@@ -9099,18 +9823,18 @@ CAmount GetTxGasFee(const CMutableTransaction& _tx, const CTxMemPool& mempool, C
     return nGasFee;
 }
 
-bool GetAddressWeight(uint256 addressHash, int type, const std::map<COutPoint, uint32_t>& immatureStakes, int32_t nHeight, uint64_t& nWeight, node::BlockManager& blockman)
+bool GetAddressWeight(uint256 addressHash, int type, const std::map<COutPoint, uint32_t>& immatureStakes, int32_t nHeight, uint64_t& nWeight)
 {
     nWeight = 0;
 
-    if (!fAddressIndex) {
+    if (!g_addressindex) {
         LogError("address index not enabled");
         return false;
     }
 
     // Get address utxos
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
-    if (!GetAddressUnspent(addressHash, type, unspentOutputs, blockman)) {
+    if (!GetAddressUnspent(addressHash, type, unspentOutputs)) {
         LogError("No information available for address");
         return false;
     }
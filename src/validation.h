@@ -18,6 +18,7 @@
 #include <kernel/chainstatemanager_opts.h>
 #include <kernel/cs_main.h> // IWYU pragma: export
 #include <node/blockstorage.h>
+#include <node/connect_stats.h>
 #include <policy/feerate.h>
 #include <policy/packages.h>
 #include <policy/policy.h>
@@ -35,6 +36,7 @@
 #include <versionbits.h>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -43,6 +45,7 @@
 #include <stdint.h>
 #include <string>
 #include <type_traits>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -51,6 +54,7 @@
 /////////////////////////////////////////// qtum
 #include <qtum/qtumstate.h>
 #include <qtum/qtumDGP.h>
+#include <qtum/evmstats.h>
 #include <libethereum/ChainParams.h>
 #include <libethereum/LastBlockHashesFace.h>
 #include <libethashseal/GenesisInfo.h>
@@ -64,6 +68,10 @@ extern std::unique_ptr<StorageResults> pstorageresult;
 extern bool fRecordLogOpcodes;
 extern bool fIsVMlogFile;
 extern bool fGettingValuesDGP;
+/** Worker threads warming the state for a block's contract executions, see EvmStatePrefetcher */
+extern int nEvmPrefetchThreads;
+/** Memory for contract accounts, storage and code kept across blocks, in bytes */
+extern int64_t nEvmCacheSize;
 
 struct EthTransactionParams;
 using valtype = std::vector<unsigned char>;
@@ -80,6 +88,7 @@ struct LockPoints;
 struct AssumeutxoData;
 namespace node {
 class SnapshotMetadata;
+struct SnapshotPrivacyState;
 } // namespace node
 namespace Consensus {
 struct Params;
@@ -87,6 +96,15 @@ struct Params;
 namespace util {
 class SignalInterrupt;
 } // namespace util
+namespace privacy {
+class CFcmpConsensusState;
+class CKeyImageDB;
+class CPrivacyTransaction;
+class CRangeProofBatch;
+} // namespace privacy
+namespace ed25519 {
+class Point;
+} // namespace ed25519
 
 /** Minimum gas limit that is allowed in a transaction within a block - prevent various types of tx and mempool spam **/
 static const uint64_t MINIMUM_GAS_LIMIT = 10000;
@@ -95,7 +113,6 @@ static const uint64_t MEMPOOL_MIN_GAS_LIMIT = 22000;
 
 static const uint64_t ADD_DELEGATION_MIN_GAS_LIMIT = 2200000;
 
-static const bool DEFAULT_ADDRINDEX = false;
 static const bool DEFAULT_LOGEVENTS = false;
 /** Block files containing a block-height within MIN_BLOCKS_TO_KEEP of ActiveChain().Tip() will not be pruned. */
 static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
@@ -120,6 +137,10 @@ static const CAmount DEFAULT_GAS_PRICE=0.00000040*COIN;
 static const CAmount MAX_RPC_GAS_PRICE=0.00000100*COIN;
 
 static const size_t MAX_CONTRACT_VOUTS = 1000; // qtum
+/** Contract state trie nodes held in memory between chainstate flushes before they are written early */
+static const size_t MAX_EVM_STATE_PENDING_SIZE = 64 * 1024 * 1024;
+/** Default for -evmcachesize, in MiB */
+static const int64_t DEFAULT_EVM_CACHE_SIZE = 64;
 
 //! -stakingminutxovalue default
 static const CAmount DEFAULT_STAKING_MIN_UTXO_VALUE = 100 * COIN;
@@ -431,46 +452,141 @@ static_assert(std::is_nothrow_move_constructible_v<CScriptCheck>);
 static_assert(std::is_nothrow_destructible_v<CScriptCheck>);
 
 /**
- * Convenience class for initializing and passing the script execution cache
- * and signature cache.
+ * Checks one header of a headers message on the header check queue, before
+ * AcceptBlockHeader() checks the batch under cs_main: the proof of work at
+ * its height, whose verdict CheckHeaderPoWAtHeight() caches, or the recovery
+ * of the proof-of-stake signature key and, given the chain state captured
+ * under cs_main, the whole proof of stake. Never fails: whatever is not
+ * verified here is checked again serially, which rejects it.
+ */
+class HeaderCheck
+{
+public:
+    //! Chain state a proof-of-stake header is checked against
+    struct StakeContext {
+        uint256 prev_stake_modifier;
+        Coin coin;
+        uint32_t block_from_time;
+    };
+
+private:
+    const CBlockHeader* m_header;
+    int m_height;
+    const Consensus::Params* m_params;
+    std::optional<StakeContext> m_stake;
+    uint8_t* m_stake_verified{nullptr};
+
+public:
+    HeaderCheck(const CBlockHeader& header, int height, const Consensus::Params& params)
+        : m_header(&header), m_height(height), m_params(&params) {}
+    HeaderCheck(const CBlockHeader& header, int height, const Consensus::Params& params, StakeContext stake, uint8_t& stake_verified)
+        : m_header(&header), m_height(height), m_params(&params), m_stake(std::move(stake)), m_stake_verified(&stake_verified) {}
+
+    std::optional<bool> operator()();
+};
+
+/**
+ * Closure verifying the cryptographic part of privacy transactions on the
+ * check queue threads, next to the script checks: either the ring signature
+ * and commitment balance of one transaction, or a batch of range proofs from
+ * several transactions. Key images are checked serially before the jobs are
+ * queued. Returns the reject reason and debug message on failure.
+ */
+class PrivacyCheck
+{
+private:
+    std::shared_ptr<const privacy::CPrivacyTransaction> m_privacy_tx;
+    uint256 m_txid;
+    std::shared_ptr<const privacy::CRangeProofBatch> m_range_proofs;
+
+public:
+    PrivacyCheck(std::shared_ptr<const privacy::CPrivacyTransaction> privacy_tx, const uint256& txid) :
+        m_privacy_tx(std::move(privacy_tx)), m_txid(txid) { }
+    explicit PrivacyCheck(std::shared_ptr<const privacy::CRangeProofBatch> range_proofs) :
+        m_range_proofs(std::move(range_proofs)) { }
+
+    PrivacyCheck(const PrivacyCheck&) = delete;
+    PrivacyCheck& operator=(const PrivacyCheck&) = delete;
+    PrivacyCheck(PrivacyCheck&&) = default;
+    PrivacyCheck& operator=(PrivacyCheck&&) = default;
+
+    std::optional<std::pair<std::string, std::string>> operator()();
+};
+
+/**
+ * Convenience class for initializing and passing the script execution cache,
+ * signature cache and privacy proof cache.
+ *
+ * The privacy proof cache holds privacy transactions whose ring signatures,
+ * range proofs or FCMP proofs verified when they entered the mempool.
+ * ConnectBlock does not verify ring signatures and range proofs again, and
+ * the mempool skips the FCMP proofs of transactions it accepts again after a
+ * reorg. See PrivacyProofCacheEntry().
  */
 class ValidationCache
 {
 private:
     //! Pre-initialized hasher to avoid having to recreate it for every hash calculation.
     CSHA256 m_script_execution_cache_hasher;
+    CSHA256 m_privacy_proof_cache_hasher;
 
 public:
     CuckooCache::cache<uint256, SignatureCacheHasher> m_script_execution_cache;
     SignatureCache m_signature_cache;
+    CuckooCache::cache<uint256, SignatureCacheHasher> m_privacy_proof_cache;
 
-    ValidationCache(size_t script_execution_cache_bytes, size_t signature_cache_bytes);
+    ValidationCache(size_t script_execution_cache_bytes, size_t signature_cache_bytes,
+                    size_t privacy_proof_cache_bytes = DEFAULT_PRIVACY_PROOF_CACHE_BYTES);
 
     ValidationCache(const ValidationCache&) = delete;
     ValidationCache& operator=(const ValidationCache&) = delete;
 
     //! Return a copy of the pre-initialized hasher.
     CSHA256 ScriptExecutionCacheHasher() const { return m_script_execution_cache_hasher; }
+    CSHA256 PrivacyProofCacheHasher() const { return m_privacy_proof_cache_hasher; }
 };
 
+/**
+ * Privacy proof cache entry of a transaction: its wtxid, plus for FCMP
+ * inputs the curve tree root the proofs were verified against. Ring members
+ * carry their keys and commitments inside the transaction, so the wtxid
+ * alone covers them.
+ */
+uint256 PrivacyProofCacheEntry(const ValidationCache& validation_cache, const CTransaction& tx,
+                               const ed25519::Point* fcmp_root = nullptr);
+
 ///////////////////////////////////////////////////////////////// // qtum
 bool GetAddressIndex(uint256 addressHash, int type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, node::BlockManager& blockman,
+                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
                      int start = 0, int end = 0);
 
-bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool& mempool, node::BlockManager& blockman);
+/** One page of the address index, see AddressIndex::ReadAddressIndexPage */
+bool GetAddressIndexPage(uint256 addressHash, int type, int start, int end, const CAddressIndexKey* after,
+                         size_t limit, bool reverse, std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                         bool& more);
+
+/** Balance of an address as of a block height, zero if it had none yet */
+bool GetAddressBalance(uint256 addressHash, int type, int height, CAddressBalanceValue& value);
+
+bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value, const CTxMemPool& mempool);
 
 bool GetAddressUnspent(uint256 addressHash, int type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs, node::BlockManager& blockman);
+                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
 
-bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes, ChainstateManager& chainman);
+bool GetAddressUnspentPage(uint256 addressHash, int type, const CAddressUnspentKey* after, size_t limit,
+                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                           bool& more);
 
-bool GetAddressWeight(uint256 addressHash, int type, const std::map<COutPoint, uint32_t>& immatureStakes, int32_t nHeight, uint64_t& nWeight, node::BlockManager& blockman);
+bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes);
+
+bool GetAddressWeight(uint256 addressHash, int type, const std::map<COutPoint, uint32_t>& immatureStakes, int32_t nHeight, uint64_t& nWeight);
 
 std::map<COutPoint, uint32_t> GetImmatureStakes(ChainstateManager& chainman);
 /////////////////////////////////////////////////////////////////
 
 bool CheckIndexProof(const CBlockIndex& block, const Consensus::Params& consensusParams);
+/** Same check for a header read from the block tree before its index entry is linked. */
+bool CheckIndexProof(const CBlockHeader& header, int nHeight, const Consensus::Params& consensusParams);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -602,6 +718,24 @@ private:
     const CTxMemPool* mempool;
 };
 
+/**
+ * Contract transactions of a mempool transaction, extracted once when it is
+ * accepted and reused by block assembly and by ConnectBlock.
+ *
+ * The extraction only depends on the transaction and the script flags: the
+ * sender comes from the script of the first input's coin, which is the same
+ * wherever it is looked up.
+ */
+struct CachedQtumTX {
+    ExtractQtumTX extracted;
+    //! Contract script flags the outputs were evaluated with
+    unsigned int flags{0};
+};
+
+/** Extract the contract transactions of tx, reusing those cached by the mempool when the flags match */
+bool ExtractQtumTransactions(const CTransaction& tx, Chainstate& chainstate, const CTxMemPool* mempool, CCoinsViewCache* view,
+                             const std::vector<CTransactionRef>* blockTxs, unsigned int flags, ExtractQtumTX& extracted);
+
 class LastHashes: public dev::eth::LastBlockHashesFace
 {
 public:
@@ -623,8 +757,18 @@ public:
 
     ByteCodeExec(const CBlock& _block, std::vector<QtumTransaction> _txs, const uint64_t _blockGasLimit, CBlockIndex* _pindex, CChain& _chain) : txs(_txs), block(_block), blockGasLimit(_blockGasLimit), pindex(_pindex), chain(_chain) {}
 
+    // Execute against a private state and seal engine instead of the global ones, e.g. a
+    // read-only snapshot; the state's databases are never committed
+    ByteCodeExec(const CBlock& _block, std::vector<QtumTransaction> _txs, const uint64_t _blockGasLimit, CBlockIndex* _pindex, CChain& _chain, QtumState& _state, dev::eth::SealEngineFace& _sealEngine) : txs(_txs), block(_block), blockGasLimit(_blockGasLimit), pindex(_pindex), chain(_chain), state(&_state), sealEngine(&_sealEngine) {}
+
     bool performByteCode(dev::eth::Permanence type = dev::eth::Permanence::Committed);
 
+    // Called with the index of each transaction right before it executes, e.g. to trace them one by one
+    void setOnExecute(std::function<void(size_t)> _onExecute){ onExecute = std::move(_onExecute); }
+
+    // Add each execution to the per contract statistics of getevmstats, as run by source
+    void setStatsSource(EvmStatsSource _source){ statsSource = _source; }
+
     bool processingResults(ByteCodeExecResult& result);
 
     std::vector<ResultExecute>& getResult(){ return result; }
@@ -648,6 +792,14 @@ private:
     LastHashes lastHashes;
 
     CChain& chain;
+
+    QtumState* state{nullptr};
+
+    dev::eth::SealEngineFace* sealEngine{nullptr};
+
+    std::function<void(size_t)> onExecute;
+
+    std::optional<EvmStatsSource> statsSource;
 };
 
 enum DisconnectResult
@@ -698,8 +850,8 @@ public:
     //! All arguments forwarded onto CCoinsViewDB.
     CoinsViews(DBParams db_params, CoinsViewOptions options);
 
-    //! Initialize the CCoinsViewCache member.
-    void InitCache() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    //! Initialize the CCoinsViewCache member, its entries on large pages if requested.
+    void InitCache(bool large_pages) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 };
 
 enum class CoinsCacheSizeState
@@ -852,6 +1004,15 @@ public:
         return m_mempool;
     }
 
+    //! @returns The FCMP state this chainstate connects blocks to, or nullptr
+    //!     if there is none. While a snapshot is validated in the background,
+    //!     the background chainstate has its own.
+    privacy::CFcmpConsensusState* FcmpState() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    //! @returns The ring signature key image database of this chainstate, see
+    //!     FcmpState().
+    std::shared_ptr<privacy::CKeyImageDB> KeyImageDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
     //! @returns A reference to a wrapped view of the in-memory UTXO set that
     //!     handles disk read errors gracefully.
     CCoinsViewErrorCatcher& CoinsErrorCatcher() EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
@@ -1126,6 +1287,13 @@ private:
     //! most-work chain.
     Chainstate* m_active_chainstate GUARDED_BY(::cs_main) {nullptr};
 
+    //! The FCMP state and ring signature key images of the background
+    //! chainstate while a snapshot is validated, kept in
+    //! node::SNAPSHOT_PRIVACY_DIRNAME. The global ones are the snapshot
+    //! chainstate's, loaded from the snapshot.
+    std::unique_ptr<privacy::CFcmpConsensusState> m_snapshot_fcmp GUARDED_BY(::cs_main);
+    std::shared_ptr<privacy::CKeyImageDB> m_snapshot_key_images GUARDED_BY(::cs_main);
+
     CBlockIndex* m_best_invalid GUARDED_BY(::cs_main){nullptr};
 
     /** The last header for which a headerTip notification was issued. */
@@ -1140,10 +1308,23 @@ private:
     //! To reduce space the serialization format of the snapshot avoids
     //! duplication of tx hashes. The code takes advantage of the guarantee by
     //! leveldb that keys are lexicographically sorted.
+    //! The contract state is loaded into the state databases, the privacy
+    //! state is checked and returned for ActivateSnapshot() to load.
     [[nodiscard]] util::Result<void> PopulateAndValidateSnapshot(
         Chainstate& snapshot_chainstate,
         AutoFile& coins_file,
-        const node::SnapshotMetadata& metadata);
+        const node::SnapshotMetadata& metadata,
+        node::SnapshotPrivacyState& privacy_state);
+
+    /**
+     * Check a batch of headers on the header check queue with no lock held,
+     * before AcceptBlockHeader() checks them one by one under cs_main. The
+     * previous blocks and stake coins are captured in one short cs_main
+     * section; the headers whose proof of stake was fully verified against
+     * @p checked_tip are returned in @p stake_checked.
+     */
+    void PrecomputeHeaderChecks(std::span<const CBlockHeader> headers, const CBlockIndex*& checked_tip,
+                                std::vector<uint256>& stake_checked) LOCKS_EXCLUDED(::cs_main);
 
     /**
      * If a block header hasn't already been seen, call CheckBlockHeader on it, ensure
@@ -1176,6 +1357,12 @@ private:
     //! A queue for script verifications that have to be performed by worker threads.
     CCheckQueue<CScriptCheck> m_script_check_queue;
 
+    //! A queue to check a batch of headers on worker threads.
+    CCheckQueue<HeaderCheck> m_header_check_queue;
+
+    //! A queue for privacy proof verifications, run alongside the script checks.
+    CCheckQueue<PrivacyCheck> m_privacy_check_queue;
+
     //! Timers and counters used for benchmarking validation in both background
     //! and active chainstates.
     SteadyClock::duration GUARDED_BY(::cs_main) time_check{};
@@ -1190,6 +1377,8 @@ private:
     SteadyClock::duration GUARDED_BY(::cs_main) time_flush{};
     SteadyClock::duration GUARDED_BY(::cs_main) time_chainstate{};
     SteadyClock::duration GUARDED_BY(::cs_main) time_post_connect{};
+    //! Phases of the block being connected, for g_block_connect_stats
+    node::BlockConnectTimes GUARDED_BY(::cs_main) connect_times{};
 
 public:
     using Options = kernel::ChainstateManagerOpts;
@@ -1200,6 +1389,11 @@ public:
     //! dependency on `base/index.cpp`.
     std::function<void()> snapshot_download_completed = std::function<void()>();
 
+    //! Headers of the batch ProcessNewBlockHeaders() is accepting whose proof
+    //! of stake was verified ahead against the current tip; CheckHeaderPoS()
+    //! does not check them again. Empty outside ProcessNewBlockHeaders().
+    std::unordered_set<uint256, BlockHasher> m_stake_checked_headers GUARDED_BY(::cs_main);
+
     const CChainParams& GetParams() const { return m_options.chainparams; }
     const Consensus::Params& GetConsensus() const { return m_options.chainparams.GetConsensus(); }
     bool ShouldCheckBlockIndex() const;
@@ -1330,6 +1524,10 @@ public:
     //! Otherwise, revert to using the ibd chainstate and shutdown.
     SnapshotCompletionResult MaybeCompleteSnapshotValidation() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    //! Open the privacy state of the background chainstate when a snapshot is
+    //! still being validated. Called on init after the global privacy state.
+    bool LoadBackgroundPrivacyState() EXCLUSIVE_LOCKS_REQUIRED(!::cs_main);
+
     //! Returns nullptr if no snapshot has been loaded.
     const CBlockIndex* GetSnapshotBaseBlock() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
@@ -1397,6 +1595,9 @@ public:
      * This function can also be used to read blocks from user-specified block files using the
      * -loadblock= option. There's no unknown-parent tracking, so the last two arguments are omitted.
      *
+     * Blocks are read ahead of the one being connected. Those that can be connected in order are
+     * deserialized and have their proof of work checked on worker threads, and are then handed to
+     * validation in file order.
      *
      * @param[in]     file_in                       File containing blocks to read
      * @param[in]     dbp                           (optional) Disk block position (only for reindex)
@@ -1550,6 +1751,7 @@ public:
     void RecalculateBestHeader() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     CCheckQueue<CScriptCheck>& GetCheckQueue() { return m_script_check_queue; }
+    CCheckQueue<PrivacyCheck>& GetPrivacyCheckQueue() { return m_privacy_check_queue; }
 
     ~ChainstateManager();
 };
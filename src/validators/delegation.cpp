@@ -124,6 +124,7 @@ DelegationDB::DelegationDB(const Consensus::Params& params, const fs::path& path
     db_params.memory_only = memory_only;
     db_params.wipe_data = false;
     db_params.obfuscate = true;
+    db_params.shared_cache = true;
 
     m_db = std::make_unique<CDBWrapper>(db_params);
 
@@ -133,15 +134,149 @@ DelegationDB::DelegationDB(const Consensus::Params& params, const fs::path& path
     }
 }
 
-bool DelegationDB::WriteDelegationToDB(const DelegationEntry& entry) {
+bool DelegationDB::WriteDelegationToDB(const DelegationEntry& entry, bool isNew) {
     if (!m_db) return false;
     uint256 delegationId = entry.GetDelegationId();
-    return m_db->Write(std::make_pair(DB_DELEGATION, delegationId), entry);
+
+    CDBBatch batch(*m_db);
+    batch.Write(std::make_pair(DB_DELEGATION, delegationId), entry);
+    // Kept apart from the entry, so entries written before checkpoints existed still load
+    batch.Write(std::make_pair(DB_REWARD_CHECKPOINT, delegationId), entry.rewardCheckpoint);
+    if (isNew) {
+        // The index keys never change, they are written with the delegation once
+        batch.Write(std::make_pair(DB_DELEGATOR_INDEX, std::make_pair(entry.delegatorId, delegationId)), uint8_t{0});
+        batch.Write(std::make_pair(DB_VALIDATOR_INDEX, std::make_pair(entry.validatorId, delegationId)), uint8_t{0});
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool DelegationDB::WriteRewardPoolToDB(const CKeyID& validatorId) {
+    if (!m_db) return false;
+    auto it = rewardPools.find(validatorId);
+    if (it == rewardPools.end()) return false;
+    return m_db->Write(std::make_pair(DB_REWARD_POOL, validatorId), ArithToUint256(it->second.rewardPerStake));
 }
 
 bool DelegationDB::EraseDelegationFromDB(const uint256& delegationId) {
     if (!m_db) return false;
-    return m_db->Erase(std::make_pair(DB_DELEGATION, delegationId));
+    CDBBatch batch(*m_db);
+    batch.Erase(std::make_pair(DB_DELEGATION, delegationId));
+    batch.Erase(std::make_pair(DB_REWARD_CHECKPOINT, delegationId));
+    auto it = delegations.find(delegationId);
+    if (it != delegations.end()) {
+        batch.Erase(std::make_pair(DB_DELEGATOR_INDEX, std::make_pair(it->second.delegatorId, delegationId)));
+        batch.Erase(std::make_pair(DB_VALIDATOR_INDEX, std::make_pair(it->second.validatorId, delegationId)));
+    }
+    return m_db->WriteBatch(batch);
+}
+
+void DelegationDB::BuildDiskIndexes() {
+    // Databases written before the indexes existed
+    CDBBatch batch(*m_db);
+    for (const auto& [id, entry] : delegations) {
+        batch.Write(std::make_pair(DB_DELEGATOR_INDEX, std::make_pair(entry.delegatorId, id)), uint8_t{0});
+        batch.Write(std::make_pair(DB_VALIDATOR_INDEX, std::make_pair(entry.validatorId, id)), uint8_t{0});
+    }
+    batch.Write(DB_INDEXED, uint8_t{1});
+    m_db->WriteBatch(batch);
+    LogPrintf("DelegationDB: Built on-disk indexes for %zu delegations\n", delegations.size());
+}
+
+void DelegationDB::AddToIndexes(const uint256& delegationId, const DelegationEntry& entry) {
+    delegatorIndex.emplace(entry.delegatorId, delegationId);
+    validatorIndex.emplace(entry.validatorId, delegationId);
+    if (!entry.delegationOutpoint.IsNull()) {
+        outpointIndex[entry.delegationOutpoint] = delegationId;
+    }
+    if (entry.IsActive()) {
+        rewardPools[entry.validatorId].activeStake += entry.amount;
+    }
+    ScheduleStatusChange(delegationId, entry);
+}
+
+void DelegationDB::ScheduleStatusChange(const uint256& delegationId, const DelegationEntry& entry) {
+    if (entry.status == DelegationStatus::PENDING) {
+        statusDeadlines.emplace(entry.delegationHeight + DELEGATION_MATURITY, delegationId);
+    } else if (entry.status == DelegationStatus::UNBONDING) {
+        statusDeadlines.emplace(entry.unbondingStartHeight + DELEGATION_UNBONDING_PERIOD, delegationId);
+    }
+}
+
+CAmount DelegationDB::GetAccruedRewards(const DelegationEntry& entry) const {
+    if (!entry.IsActive() || entry.amount <= 0) return 0;
+    auto it = rewardPools.find(entry.validatorId);
+    if (it == rewardPools.end()) return 0;
+
+    const arith_uint256 checkpoint = UintToArith256(entry.rewardCheckpoint);
+    if (it->second.rewardPerStake <= checkpoint) return 0;
+    const arith_uint256 accrued = (it->second.rewardPerStake - checkpoint) * arith_uint256(uint64_t(entry.amount)) / arith_uint256(REWARD_PRECISION);
+    return CAmount(accrued.GetLow64());
+}
+
+void DelegationDB::SettleRewards(DelegationEntry& entry) {
+    entry.pendingRewards += GetAccruedRewards(entry);
+    auto it = rewardPools.find(entry.validatorId);
+    entry.rewardCheckpoint = it != rewardPools.end() ? ArithToUint256(it->second.rewardPerStake) : uint256();
+}
+
+void DelegationDB::ChangeStatus(DelegationEntry& entry, DelegationStatus status) {
+    SettleRewards(entry);
+    const bool active = status == DelegationStatus::ACTIVE;
+    if (entry.IsActive() != active) {
+        rewardPools[entry.validatorId].activeStake += active ? entry.amount : -entry.amount;
+    }
+    entry.status = status;
+}
+
+DelegationEntry DelegationDB::WithAccruedRewards(const DelegationEntry& entry) const {
+    DelegationEntry copy = entry;
+    copy.pendingRewards += GetAccruedRewards(entry);
+    return copy;
+}
+
+uint256 DelegationDB::PageDiskIndex(uint8_t prefix, const CKeyID& keyId, const uint256& after, size_t limit,
+                                    const DelegationVisitor& visit) const {
+    LOCK(cs_delegations);
+    if (!m_db) return uint256();
+
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+    pcursor->Seek(std::make_pair(prefix, std::make_pair(keyId, after)));
+
+    uint256 last;
+    size_t visited = 0;
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, std::pair<CKeyID, uint256>> key;
+        if (!pcursor->GetKey(key) || key.first != prefix || key.second.first != keyId) {
+            break;
+        }
+        const uint256& delegationId = key.second.second;
+        if (!after.IsNull() && delegationId == after) {
+            pcursor->Next();
+            continue;
+        }
+        if (limit > 0 && visited == limit) {
+            return last; // More to come
+        }
+
+        auto it = delegations.find(delegationId);
+        if (it != delegations.end()) {
+            visit(WithAccruedRewards(it->second));
+        }
+        last = delegationId;
+        visited++;
+        pcursor->Next();
+    }
+    return uint256();
+}
+
+uint256 DelegationDB::ForEachDelegationForDelegator(const CKeyID& delegatorId, const uint256& after, size_t limit,
+                                                    const DelegationVisitor& visit) const {
+    return PageDiskIndex(DB_DELEGATOR_INDEX, delegatorId, after, limit, visit);
+}
+
+uint256 DelegationDB::ForEachDelegationForValidator(const CKeyID& validatorId, const uint256& after, size_t limit,
+                                                    const DelegationVisitor& visit) const {
+    return PageDiskIndex(DB_VALIDATOR_INDEX, validatorId, after, limit, visit);
 }
 
 bool DelegationDB::LoadFromDB() {
@@ -160,23 +295,36 @@ bool DelegationDB::LoadFromDB() {
         DelegationEntry entry;
         if (pcursor->GetValue(entry)) {
             uint256 delegationId = entry.GetDelegationId();
+            m_db->Read(std::make_pair(DB_REWARD_CHECKPOINT, delegationId), entry.rewardCheckpoint);
             delegations[delegationId] = entry;
 
             // Rebuild indexes
-            delegatorIndex[entry.delegatorId].push_back(delegationId);
-            validatorIndex[entry.validatorId].push_back(delegationId);
-            if (!entry.delegationOutpoint.IsNull()) {
-                outpointIndex[entry.delegationOutpoint] = delegationId;
-            }
+            AddToIndexes(delegationId, entry);
             count++;
         }
 
         pcursor->Next();
     }
 
+    pcursor->Seek(std::make_pair(DB_REWARD_POOL, CKeyID()));
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CKeyID> key;
+        if (!pcursor->GetKey(key) || key.first != DB_REWARD_POOL) {
+            break;
+        }
+        uint256 rewardPerStake;
+        if (pcursor->GetValue(rewardPerStake)) {
+            rewardPools[key.second].rewardPerStake = UintToArith256(rewardPerStake);
+        }
+        pcursor->Next();
+    }
+
     if (count > 0) {
         LogPrintf("DelegationDB: Loaded %zu delegations from database\n", count);
     }
+    if (!m_db->Exists(DB_INDEXED)) {
+        BuildDiskIndexes();
+    }
     return count > 0;
 }
 
@@ -235,14 +383,10 @@ bool DelegationDB::ProcessDelegation(const DelegationRequest& request, const COu
     delegations[delegationId] = entry;
 
     // Update indexes
-    delegatorIndex[entry.delegatorId].push_back(delegationId);
-    validatorIndex[entry.validatorId].push_back(delegationId);
-    if (!outpoint.IsNull()) {
-        outpointIndex[outpoint] = delegationId;
-    }
+    AddToIndexes(delegationId, entry);
 
     // Persist to LevelDB
-    if (!WriteDelegationToDB(entry)) {
+    if (!WriteDelegationToDB(entry, /*isNew=*/true)) {
         LogPrintf("DelegationDB: WARNING - Failed to persist delegation %s to database\n",
                   delegationId.ToString());
     }
@@ -263,8 +407,8 @@ bool DelegationDB::ProcessUndelegation(const UndelegationRequest& request) {
     LOCK(cs_delegations);
 
     // Find delegations from this delegator to this validator
-    auto it = delegatorIndex.find(request.delegatorId);
-    if (it == delegatorIndex.end()) {
+    auto it = delegatorIndex.lower_bound({request.delegatorId, uint256()});
+    if (it == delegatorIndex.end() || it->first != request.delegatorId) {
         LogPrintf("DelegationDB: No delegations found for delegator %s\n",
                   request.delegatorId.ToString());
         return false;
@@ -273,7 +417,8 @@ bool DelegationDB::ProcessUndelegation(const UndelegationRequest& request) {
     CAmount remainingToUndelegate = request.amount;
     bool anyUndelegated = false;
 
-    for (const auto& delegationId : it->second) {
+    for (; it != delegatorIndex.end() && it->first == request.delegatorId; ++it) {
+        const uint256& delegationId = it->second;
         auto delIt = delegations.find(delegationId);
         if (delIt == delegations.end()) continue;
 
@@ -296,8 +441,9 @@ bool DelegationDB::ProcessUndelegation(const UndelegationRequest& request) {
         }
 
         // Start unbonding
-        entry.status = DelegationStatus::UNBONDING;
+        ChangeStatus(entry, DelegationStatus::UNBONDING);
         entry.unbondingStartHeight = currentHeight;
+        ScheduleStatusChange(delegationId, entry);
 
         // Persist to LevelDB
         WriteDelegationToDB(entry);
@@ -324,23 +470,19 @@ CAmount DelegationDB::ProcessRewardClaim(const RewardClaimRequest& request) {
     CAmount totalClaimed = 0;
 
     // Find delegations for this delegator
-    auto it = delegatorIndex.find(request.delegatorId);
-    if (it == delegatorIndex.end()) {
-        return 0;
-    }
-
-    for (const auto& delegationId : it->second) {
+    ForEachIndexed(delegatorIndex, request.delegatorId, [&](const uint256& delegationId) {
         auto delIt = delegations.find(delegationId);
-        if (delIt == delegations.end()) continue;
+        if (delIt == delegations.end()) return;
 
         DelegationEntry& entry = delIt->second;
 
         // If specific validator requested, filter
         if (!request.validatorId.IsNull() && entry.validatorId != request.validatorId) {
-            continue;
+            return;
         }
 
         // Claim pending rewards
+        SettleRewards(entry);
         if (entry.pendingRewards > 0) {
             totalClaimed += entry.pendingRewards;
             entry.pendingRewards = 0;
@@ -349,7 +491,7 @@ CAmount DelegationDB::ProcessRewardClaim(const RewardClaimRequest& request) {
             // Persist to LevelDB
             WriteDelegationToDB(entry);
         }
-    }
+    });
 
     if (totalClaimed > 0) {
         LogPrintf("DelegationDB: Claimed %lld rewards for delegator %s\n",
@@ -385,17 +527,12 @@ std::vector<DelegationEntry> DelegationDB::GetDelegationsForDelegator(const CKey
     LOCK(cs_delegations);
     std::vector<DelegationEntry> result;
 
-    auto it = delegatorIndex.find(delegatorId);
-    if (it == delegatorIndex.end()) {
-        return result;
-    }
-
-    for (const auto& delegationId : it->second) {
+    ForEachIndexed(delegatorIndex, delegatorId, [&](const uint256& delegationId) {
         auto delIt = delegations.find(delegationId);
         if (delIt != delegations.end()) {
-            result.push_back(delIt->second);
+            result.push_back(WithAccruedRewards(delIt->second));
         }
-    }
+    });
 
     return result;
 }
@@ -404,17 +541,12 @@ std::vector<DelegationEntry> DelegationDB::GetDelegationsForValidator(const CKey
     LOCK(cs_delegations);
     std::vector<DelegationEntry> result;
 
-    auto it = validatorIndex.find(validatorId);
-    if (it == validatorIndex.end()) {
-        return result;
-    }
-
-    for (const auto& delegationId : it->second) {
+    ForEachIndexed(validatorIndex, validatorId, [&](const uint256& delegationId) {
         auto delIt = delegations.find(delegationId);
         if (delIt != delegations.end()) {
-            result.push_back(delIt->second);
+            result.push_back(WithAccruedRewards(delIt->second));
         }
-    }
+    });
 
     return result;
 }
@@ -423,17 +555,12 @@ CAmount DelegationDB::GetTotalDelegationForValidator(const CKeyID& validatorId)
     LOCK(cs_delegations);
     CAmount total = 0;
 
-    auto it = validatorIndex.find(validatorId);
-    if (it == validatorIndex.end()) {
-        return total;
-    }
-
-    for (const auto& delegationId : it->second) {
+    ForEachIndexed(validatorIndex, validatorId, [&](const uint256& delegationId) {
         auto delIt = delegations.find(delegationId);
         if (delIt != delegations.end() && delIt->second.status == DelegationStatus::ACTIVE) {
             total += delIt->second.amount;
         }
-    }
+    });
 
     return total;
 }
@@ -442,17 +569,12 @@ CAmount DelegationDB::GetPendingRewardsForDelegator(const CKeyID& delegatorId) c
     LOCK(cs_delegations);
     CAmount total = 0;
 
-    auto it = delegatorIndex.find(delegatorId);
-    if (it == delegatorIndex.end()) {
-        return total;
-    }
-
-    for (const auto& delegationId : it->second) {
+    ForEachIndexed(delegatorIndex, delegatorId, [&](const uint256& delegationId) {
         auto delIt = delegations.find(delegationId);
         if (delIt != delegations.end()) {
-            total += delIt->second.pendingRewards;
+            total += delIt->second.pendingRewards + GetAccruedRewards(delIt->second);
         }
-    }
+    });
 
     return total;
 }
@@ -483,52 +605,21 @@ bool DelegationDB::DistributeBlockReward(const CKeyID& validatorId, CAmount dele
         return true;
     }
 
-    // Get total active delegation for this validator - use internal version that doesn't lock
-    CAmount totalDelegation = 0;
-    auto vit = validatorIndex.find(validatorId);
-    if (vit != validatorIndex.end()) {
-        for (const auto& delegationId : vit->second) {
-            auto delIt = delegations.find(delegationId);
-            if (delIt != delegations.end() && delIt->second.status == DelegationStatus::ACTIVE) {
-                totalDelegation += delIt->second.amount;
-            }
-        }
-    }
-    LogPrintf("DelegationDB: DistributeBlockReward totalDelegation=%lld\n", totalDelegation);
-
-    if (totalDelegation == 0) {
+    // Credit the validator's active stake as a whole, delegations settle their share lazily
+    auto pool = rewardPools.find(validatorId);
+    if (pool == rewardPools.end() || pool->second.activeStake <= 0) {
         LogPrintf("DelegationDB: DistributeBlockReward - no active delegations\n");
         return true;
     }
 
-    // Distribute proportionally to each delegator
-    auto it = validatorIndex.find(validatorId);
-    if (it == validatorIndex.end()) {
-        return true;
-    }
+    pool->second.rewardPerStake += arith_uint256(uint64_t(delegatorsShare)) * arith_uint256(REWARD_PRECISION) /
+                                   arith_uint256(uint64_t(pool->second.activeStake));
 
-    int count = 0;
-    for (const auto& delegationId : it->second) {
-        auto delIt = delegations.find(delegationId);
-        if (delIt == delegations.end()) continue;
-
-        DelegationEntry& entry = delIt->second;
-        if (entry.status != DelegationStatus::ACTIVE) continue;
-
-        // Calculate proportional share
-        CAmount share = (delegatorsShare * entry.amount) / totalDelegation;
-        if (share > 0) {
-            entry.pendingRewards += share;
-            // Persist to LevelDB
-            WriteDelegationToDB(entry);
-            count++;
-            LogPrintf("DelegationDB: Rewarded delegation %s with %lld (pending=%lld)\n",
-                      delegationId.ToString().substr(0, 16), share, entry.pendingRewards);
-        }
-    }
+    // Persist to LevelDB
+    WriteRewardPoolToDB(validatorId);
 
-    LogPrintf("DelegationDB: Distributed %lld to %d delegators of validator %s\n",
-              delegatorsShare, count, validatorId.ToString());
+    LogPrintf("DelegationDB: Distributed %lld over %lld active stake of validator %s\n",
+              delegatorsShare, pool->second.activeStake, validatorId.ToString());
 
     return true;
 }
@@ -539,7 +630,8 @@ bool DelegationDB::SetDelegationStatus(const uint256& delegationId, DelegationSt
     if (it == delegations.end()) {
         return false;
     }
-    it->second.status = status;
+    ChangeStatus(it->second, status);
+    ScheduleStatusChange(delegationId, it->second);
 
     // Persist to LevelDB
     WriteDelegationToDB(it->second);
@@ -582,13 +674,20 @@ void DelegationDB::ProcessBlock(int height) {
     LOCK(cs_delegations);
     currentHeight = height;
 
-    for (auto& [id, entry] : delegations) {
+    // Only the delegations whose maturity or unbonding period may end by now
+    while (!statusDeadlines.empty() && statusDeadlines.begin()->first <= height) {
+        const uint256 id = statusDeadlines.begin()->second;
+        statusDeadlines.erase(statusDeadlines.begin());
+        auto it = delegations.find(id);
+        if (it == delegations.end()) continue;
+
+        DelegationEntry& entry = it->second;
         bool needsWrite = false;
 
         // Activate pending delegations after maturity
         if (entry.status == DelegationStatus::PENDING) {
             if (height - entry.delegationHeight >= DELEGATION_MATURITY) {
-                entry.status = DelegationStatus::ACTIVE;
+                ChangeStatus(entry, DelegationStatus::ACTIVE);
                 LogPrintf("DelegationDB: Delegation %s is now active\n",
                           id.ToString().substr(0, 16));
                 needsWrite = true;
@@ -598,7 +697,7 @@ void DelegationDB::ProcessBlock(int height) {
         // Complete unbonding
         if (entry.status == DelegationStatus::UNBONDING) {
             if (height - entry.unbondingStartHeight >= DELEGATION_UNBONDING_PERIOD) {
-                entry.status = DelegationStatus::WITHDRAWN;
+                ChangeStatus(entry, DelegationStatus::WITHDRAWN);
                 LogPrintf("DelegationDB: Delegation %s unbonding complete\n",
                           id.ToString().substr(0, 16));
                 needsWrite = true;
@@ -626,19 +725,34 @@ size_t DelegationDB::GetDelegatorCountForValidator(const CKeyID& validatorId) co
     LOCK(cs_delegations);
     std::set<CKeyID> uniqueDelegators;
 
-    auto it = validatorIndex.find(validatorId);
-    if (it == validatorIndex.end()) {
-        return 0;
-    }
-
-    for (const auto& delegationId : it->second) {
+    ForEachIndexed(validatorIndex, validatorId, [&](const uint256& delegationId) {
         auto delIt = delegations.find(delegationId);
         if (delIt != delegations.end() && delIt->second.status == DelegationStatus::ACTIVE) {
             uniqueDelegators.insert(delIt->second.delegatorId);
         }
-    }
+    });
 
     return uniqueDelegators.size();
 }
 
+CDBWrapper::Records DelegationDB::GetDBRecords() const {
+    LOCK(cs_delegations);
+    if (!m_db) return {};
+    return m_db->ReadAllRecords();
+}
+
+bool DelegationDB::LoadDBRecords(const CDBWrapper::Records& records) {
+    LOCK(cs_delegations);
+    if (!m_db || !m_db->ReplaceAllRecords(records)) return false;
+
+    delegations.clear();
+    delegatorIndex.clear();
+    validatorIndex.clear();
+    outpointIndex.clear();
+    rewardPools.clear();
+    statusDeadlines.clear();
+    LoadFromDB();
+    return true;
+}
+
 } // namespace validators
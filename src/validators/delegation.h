@@ -5,6 +5,7 @@
 #ifndef WATTX_VALIDATORS_DELEGATION_H
 #define WATTX_VALIDATORS_DELEGATION_H
 
+#include <arith_uint256.h>
 #include <consensus/params.h>
 #include <dbwrapper.h>
 #include <key.h>
@@ -16,8 +17,11 @@
 #include <util/fs.h>
 
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
+#include <set>
+#include <utility>
 #include <vector>
 
 namespace validators {
@@ -51,6 +55,7 @@ public:
     COutPoint delegationOutpoint; // UTXO holding the delegated stake
     int unbondingStartHeight;     // Height when unbonding started
     CAmount pendingRewards;       // Accumulated unclaimed rewards
+    uint256 rewardCheckpoint;     // Validator's reward per stake when pendingRewards was settled, stored separately
 
     DelegationEntry() : amount(0), delegationHeight(0), lastRewardHeight(0),
                         status(DelegationStatus::PENDING), unbondingStartHeight(0),
@@ -183,23 +188,51 @@ public:
  * Delegation database manager
  * Handles delegation, undelegation, and reward distribution
  * Uses LevelDB for persistent storage
+ *
+ * The delegations of a delegator or a validator are also indexed on disk
+ * under prefix keys (key ID, delegation ID), which the paging methods walk
+ * with a database iterator instead of copying every entry out.
+ *
+ * Block rewards accrue lazily: each validator has a running total of reward
+ * per unit of active stake, and a delegation settles its share against the
+ * checkpoint it last saw only when it is claimed, read, or changes status.
+ * Status changes due at a height are queued, so a block only visits the
+ * delegations that mature or finish unbonding in it.
  */
 class DelegationDB {
+public:
+    // Visitor for the paging methods, called with cs_delegations held
+    using DelegationVisitor = std::function<void(const DelegationEntry&)>;
+
 private:
     mutable Mutex cs_delegations;
 
     // Delegations indexed by delegation ID
     std::map<uint256, DelegationEntry> delegations;
 
-    // Index: delegator -> list of delegation IDs
-    std::map<CKeyID, std::vector<uint256>> delegatorIndex;
+    // (key ID, delegation ID) pairs, so the delegations of a key are one ordered range
+    using KeyIndex = std::set<std::pair<CKeyID, uint256>>;
+
+    // Index: delegator -> delegation IDs
+    KeyIndex delegatorIndex;
 
-    // Index: validator -> list of delegation IDs
-    std::map<CKeyID, std::vector<uint256>> validatorIndex;
+    // Index: validator -> delegation IDs
+    KeyIndex validatorIndex;
 
     // Index: outpoint -> delegation ID
     std::map<COutPoint, uint256> outpointIndex;
 
+    // Active stake and accumulated reward per unit of it, scaled by REWARD_PRECISION
+    struct RewardPool {
+        CAmount activeStake{0};
+        arith_uint256 rewardPerStake;
+    };
+    std::map<CKeyID, RewardPool> rewardPools;
+    static constexpr uint64_t REWARD_PRECISION = 1000000000000000000ULL;
+
+    // Heights at which a delegation may mature or finish unbonding, stale entries are skipped
+    std::multimap<int, uint256> statusDeadlines;
+
     const Consensus::Params& consensusParams;
     int currentHeight;
 
@@ -208,11 +241,43 @@ private:
 
     // Database keys
     static constexpr uint8_t DB_DELEGATION = 'd';
+    static constexpr uint8_t DB_DELEGATOR_INDEX = 'D';
+    static constexpr uint8_t DB_VALIDATOR_INDEX = 'V';
+    static constexpr uint8_t DB_INDEXED = 'x';
+    static constexpr uint8_t DB_REWARD_POOL = 'r';
+    static constexpr uint8_t DB_REWARD_CHECKPOINT = 'c';
 
     // Internal persistence methods
-    bool WriteDelegationToDB(const DelegationEntry& entry);
+    bool WriteDelegationToDB(const DelegationEntry& entry, bool isNew = false);
     bool EraseDelegationFromDB(const uint256& delegationId);
     bool LoadFromDB();
+    void BuildDiskIndexes();
+
+    bool WriteRewardPoolToDB(const CKeyID& validatorId);
+
+    // Add a new or loaded entry to the indexes, its validator's active stake and the status queue
+    void AddToIndexes(const uint256& delegationId, const DelegationEntry& entry);
+    void ScheduleStatusChange(const uint256& delegationId, const DelegationEntry& entry);
+
+    // Rewards accrued since the entry's checkpoint, not yet in pendingRewards
+    CAmount GetAccruedRewards(const DelegationEntry& entry) const;
+    // Move the accrued rewards into pendingRewards
+    void SettleRewards(DelegationEntry& entry);
+    // Settle, then change status, keeping the validator's active stake in step
+    void ChangeStatus(DelegationEntry& entry, DelegationStatus status);
+    // Copy of the entry with its accrued rewards settled, for callers
+    DelegationEntry WithAccruedRewards(const DelegationEntry& entry) const;
+
+    // Call fn with each delegation ID indexed under keyId
+    template<typename Fn>
+    void ForEachIndexed(const KeyIndex& index, const CKeyID& keyId, Fn&& fn) const {
+        for (auto it = index.lower_bound({keyId, uint256()}); it != index.end() && it->first == keyId; ++it) {
+            fn(it->second);
+        }
+    }
+
+    uint256 PageDiskIndex(uint8_t prefix, const CKeyID& keyId, const uint256& after, size_t limit,
+                          const DelegationVisitor& visit) const;
 
 public:
     DelegationDB(const Consensus::Params& params, const fs::path& path, size_t cache_size = 1 << 20, bool memory_only = false);
@@ -233,7 +298,8 @@ public:
     CAmount ProcessRewardClaim(const RewardClaimRequest& request);
 
     /**
-     * Get delegation by ID
+     * Get delegation by ID. Its pendingRewards leave out rewards accrued
+     * since it was last settled, the queries returning copies include them.
      */
     const DelegationEntry* GetDelegation(const uint256& delegationId) const;
 
@@ -252,6 +318,22 @@ public:
      */
     std::vector<DelegationEntry> GetDelegationsForValidator(const CKeyID& validatorId) const;
 
+    /**
+     * Visit up to limit delegations of a delegator in delegation ID order,
+     * from the on-disk index
+     * @param after Continue after this delegation ID, null for the first page
+     * @param limit Page size, 0 for no limit
+     * @return ID to continue after, null when there are no more
+     */
+    uint256 ForEachDelegationForDelegator(const CKeyID& delegatorId, const uint256& after, size_t limit,
+                                          const DelegationVisitor& visit) const;
+
+    /**
+     * Visit up to limit delegations of a validator, as ForEachDelegationForDelegator()
+     */
+    uint256 ForEachDelegationForValidator(const CKeyID& validatorId, const uint256& after, size_t limit,
+                                          const DelegationVisitor& visit) const;
+
     /**
      * Get total delegation amount for a validator
      */
@@ -308,6 +390,16 @@ public:
      */
     size_t GetDelegatorCountForValidator(const CKeyID& validatorId) const;
 
+    /**
+     * Raw database records, for a validator state snapshot
+     */
+    CDBWrapper::Records GetDBRecords() const;
+
+    /**
+     * Replace the database and the in-memory state with snapshot records
+     */
+    bool LoadDBRecords(const CDBWrapper::Records& records);
+
     /**
      * Serialize delegations to stream (for persistence)
      */
@@ -329,11 +421,7 @@ public:
         validatorIndex.clear();
         outpointIndex.clear();
         for (const auto& [id, entry] : delegations) {
-            delegatorIndex[entry.delegatorId].push_back(id);
-            validatorIndex[entry.validatorId].push_back(id);
-            if (!entry.delegationOutpoint.IsNull()) {
-                outpointIndex[entry.delegationOutpoint] = id;
-            }
+            AddToIndexes(id, entry);
         }
     }
 };
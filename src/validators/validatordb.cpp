@@ -139,6 +139,7 @@ ValidatorDB::ValidatorDB(const Consensus::Params& params, const fs::path& path,
     db_params.memory_only = memory_only;
     db_params.wipe_data = false;
     db_params.obfuscate = true;
+    db_params.shared_cache = true;
 
     m_db = std::make_unique<CDBWrapper>(db_params);
 
@@ -183,12 +184,45 @@ bool ValidatorDB::LoadFromDB() {
         pcursor->Next();
     }
 
+    RebuildStakeIndex();
+
     if (count > 0) {
         LogPrintf("ValidatorDB: Loaded %zu validators from database\n", count);
     }
     return count > 0;
 }
 
+void ValidatorDB::AddToStakeIndex(const ValidatorEntry& entry) {
+    if (!entry.IsActive()) return;
+    const StakeKey key{entry.GetTotalStake(), entry.validatorId};
+    stakeIndex.insert(std::lower_bound(stakeIndex.begin(), stakeIndex.end(), key, StakeOrder{}), key);
+}
+
+void ValidatorDB::RemoveFromStakeIndex(bool wasActive, CAmount totalStake, const CKeyID& validatorId) {
+    if (!wasActive) return;
+    const StakeKey key{totalStake, validatorId};
+    auto it = std::lower_bound(stakeIndex.begin(), stakeIndex.end(), key, StakeOrder{});
+    if (it != stakeIndex.end() && *it == key) {
+        stakeIndex.erase(it);
+    }
+}
+
+void ValidatorDB::UpdateStakeIndex(bool wasActive, CAmount totalStake, const ValidatorEntry& entry) {
+    if (wasActive == entry.IsActive() && totalStake == entry.GetTotalStake()) return;
+    RemoveFromStakeIndex(wasActive, totalStake, entry.validatorId);
+    AddToStakeIndex(entry);
+}
+
+void ValidatorDB::RebuildStakeIndex() {
+    stakeIndex.clear();
+    for (const auto& [id, entry] : validators) {
+        if (entry.IsActive()) {
+            stakeIndex.emplace_back(entry.GetTotalStake(), id);
+        }
+    }
+    std::sort(stakeIndex.begin(), stakeIndex.end(), StakeOrder{});
+}
+
 bool ValidatorDB::RegisterValidator(const ValidatorEntry& entry) {
     LOCK(cs_validators);
 
@@ -226,6 +260,7 @@ bool ValidatorDB::RegisterValidator(const ValidatorEntry& entry) {
     if (!entry.stakeOutpoint.IsNull()) {
         outpointIndex[entry.stakeOutpoint] = entry.validatorId;
     }
+    AddToStakeIndex(entry);
 
     // Persist to LevelDB
     if (!WriteValidatorToDB(entry)) {
@@ -257,6 +292,9 @@ bool ValidatorDB::ProcessUpdate(const ValidatorUpdate& update) {
         return false;
     }
 
+    const bool wasActive = entry.IsActive();
+    const CAmount oldStake = entry.GetTotalStake();
+
     switch (update.updateType) {
         case ValidatorUpdateType::UPDATE_FEE:
             if (update.newValue < MIN_POOL_FEE || update.newValue > MAX_POOL_FEE) {
@@ -318,6 +356,7 @@ bool ValidatorDB::ProcessUpdate(const ValidatorUpdate& update) {
                       entry.validatorId.ToString(), update.newValue, entry.stakeAmount);
             break;
     }
+    UpdateStakeIndex(wasActive, oldStake, entry);
 
     // Persist updated entry to LevelDB
     WriteValidatorToDB(entry);
@@ -380,29 +419,31 @@ bool ValidatorDB::IsValidatorStake(const COutPoint& outpoint) const {
 }
 
 std::vector<ValidatorEntry> ValidatorDB::GetActiveValidators() const {
+    return GetValidatorsByStake();
+}
+
+std::vector<ValidatorEntry> ValidatorDB::GetValidatorsByStake(size_t offset, size_t count) const {
     LOCK(cs_validators);
     std::vector<ValidatorEntry> result;
-    for (const auto& [id, entry] : validators) {
-        if (entry.status == ValidatorStatus::ACTIVE) {
-            result.push_back(entry);
-        }
+    if (offset >= stakeIndex.size()) return result;
+
+    const size_t end = count == 0 || count >= stakeIndex.size() - offset ? stakeIndex.size() : offset + count;
+    result.reserve(end - offset);
+    for (size_t i = offset; i < end; i++) {
+        result.push_back(validators.at(stakeIndex[i].second));
     }
     return result;
 }
 
-std::vector<ValidatorEntry> ValidatorDB::GetValidatorsByStake() const {
+std::optional<size_t> ValidatorDB::GetStakeRank(const CKeyID& validatorId) const {
     LOCK(cs_validators);
-    std::vector<ValidatorEntry> result;
-    for (const auto& [id, entry] : validators) {
-        if (entry.status == ValidatorStatus::ACTIVE) {
-            result.push_back(entry);
-        }
-    }
-    std::sort(result.begin(), result.end(),
-              [](const ValidatorEntry& a, const ValidatorEntry& b) {
-                  return a.GetTotalStake() > b.GetTotalStake();
-              });
-    return result;
+    auto it = validators.find(validatorId);
+    if (it == validators.end() || !it->second.IsActive()) return std::nullopt;
+
+    const StakeKey key{it->second.GetTotalStake(), validatorId};
+    auto pos = std::lower_bound(stakeIndex.begin(), stakeIndex.end(), key, StakeOrder{});
+    if (pos == stakeIndex.end() || *pos != key) return std::nullopt;
+    return pos - stakeIndex.begin();
 }
 
 std::vector<ValidatorEntry> ValidatorDB::GetValidatorsByMaxFee(int64_t maxFeeRate) const {
@@ -426,10 +467,12 @@ bool ValidatorDB::SetValidatorStatus(const CKeyID& validatorId, ValidatorStatus
     if (it == validators.end()) {
         return false;
     }
+    const bool wasActive = it->second.IsActive();
     it->second.status = status;
     if (status == ValidatorStatus::ACTIVE) {
         it->second.lastActiveHeight = currentHeight;
     }
+    UpdateStakeIndex(wasActive, it->second.GetTotalStake(), it->second);
 
     // Persist to LevelDB
     WriteValidatorToDB(it->second);
@@ -443,6 +486,7 @@ bool ValidatorDB::JailValidator(const CKeyID& validatorId, int jailBlocks) {
     if (it == validators.end()) {
         return false;
     }
+    RemoveFromStakeIndex(it->second.IsActive(), it->second.GetTotalStake(), validatorId);
     it->second.status = ValidatorStatus::JAILED;
     it->second.jailReleaseHeight = currentHeight + jailBlocks;
     LogPrintf("ValidatorDB: Jailed validator %s until height %d\n",
@@ -470,6 +514,7 @@ bool ValidatorDB::UnjailValidator(const CKeyID& validatorId) {
     }
     it->second.status = ValidatorStatus::ACTIVE;
     it->second.jailReleaseHeight = 0;
+    AddToStakeIndex(it->second);
     LogPrintf("ValidatorDB: Unjailed validator %s\n", validatorId.ToString());
 
     // Persist to LevelDB
@@ -485,13 +530,7 @@ size_t ValidatorDB::GetValidatorCount() const {
 
 size_t ValidatorDB::GetActiveValidatorCount() const {
     LOCK(cs_validators);
-    size_t count = 0;
-    for (const auto& [id, entry] : validators) {
-        if (entry.status == ValidatorStatus::ACTIVE) {
-            count++;
-        }
-    }
-    return count;
+    return stakeIndex.size();
 }
 
 bool ValidatorDB::AddDelegation(const CKeyID& validatorId, CAmount amount) {
@@ -500,8 +539,10 @@ bool ValidatorDB::AddDelegation(const CKeyID& validatorId, CAmount amount) {
     if (it == validators.end()) {
         return false;
     }
+    const CAmount oldStake = it->second.GetTotalStake();
     it->second.totalDelegated += amount;
     it->second.delegatorCount++;
+    UpdateStakeIndex(it->second.IsActive(), oldStake, it->second);
     LogPrintf("ValidatorDB: Added delegation of %lld to validator %s (total: %lld, delegators: %d)\n",
               amount, validatorId.ToString(), it->second.totalDelegated, it->second.delegatorCount);
 
@@ -520,10 +561,12 @@ bool ValidatorDB::RemoveDelegation(const CKeyID& validatorId, CAmount amount) {
     if (amount > it->second.totalDelegated) {
         return false;
     }
+    const CAmount oldStake = it->second.GetTotalStake();
     it->second.totalDelegated -= amount;
     if (it->second.delegatorCount > 0) {
         it->second.delegatorCount--;
     }
+    UpdateStakeIndex(it->second.IsActive(), oldStake, it->second);
     LogPrintf("ValidatorDB: Removed delegation of %lld from validator %s (total: %lld, delegators: %d)\n",
               amount, validatorId.ToString(), it->second.totalDelegated, it->second.delegatorCount);
 
@@ -561,4 +604,20 @@ void ValidatorDB::ProcessBlock(int height) {
     }
 }
 
+CDBWrapper::Records ValidatorDB::GetDBRecords() const {
+    LOCK(cs_validators);
+    if (!m_db) return {};
+    return m_db->ReadAllRecords();
+}
+
+bool ValidatorDB::LoadDBRecords(const CDBWrapper::Records& records) {
+    LOCK(cs_validators);
+    if (!m_db || !m_db->ReplaceAllRecords(records)) return false;
+
+    validators.clear();
+    outpointIndex.clear();
+    LoadFromDB();
+    return true;
+}
+
 } // namespace validators
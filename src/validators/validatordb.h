@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -161,6 +162,10 @@ public:
  * Validator database manager
  * Handles registration, updates, and queries for validators
  * Uses LevelDB for persistent storage
+ *
+ * Active validators are also kept ordered by total stake, updated whenever an
+ * entry changes, so that listing them or looking up a rank does not sort the
+ * whole set on every call.
  */
 class ValidatorDB {
 private:
@@ -172,6 +177,15 @@ private:
     // Index by stake outpoint for quick lookup
     std::map<COutPoint, CKeyID> outpointIndex;
 
+    //! (total stake, id) of the active validators, highest stake first
+    using StakeKey = std::pair<CAmount, CKeyID>;
+    struct StakeOrder {
+        bool operator()(const StakeKey& a, const StakeKey& b) const {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        }
+    };
+    std::vector<StakeKey> stakeIndex;
+
     // LevelDB persistence
     std::unique_ptr<CDBWrapper> m_db;
 
@@ -184,6 +198,12 @@ private:
     bool EraseValidatorFromDB(const CKeyID& validatorId);
     bool LoadFromDB();
 
+    // Stake index maintenance, called with the entry's state before and after a change
+    void AddToStakeIndex(const ValidatorEntry& entry);
+    void RemoveFromStakeIndex(bool wasActive, CAmount totalStake, const CKeyID& validatorId);
+    void UpdateStakeIndex(bool wasActive, CAmount totalStake, const ValidatorEntry& entry);
+    void RebuildStakeIndex();
+
 public:
     ValidatorDB(const Consensus::Params& params, const fs::path& path, size_t cache_size = 1 << 20, bool memory_only = false);
 
@@ -218,14 +238,22 @@ public:
     bool IsValidatorStake(const COutPoint& outpoint) const;
 
     /**
-     * Get all active validators
+     * Get all active validators, sorted by total stake (descending)
      */
     std::vector<ValidatorEntry> GetActiveValidators() const;
 
     /**
-     * Get validators sorted by total stake (descending)
+     * Get active validators sorted by total stake (descending)
+     * @param offset Number of top validators to skip
+     * @param count Maximum number to return, 0 for all
+     */
+    std::vector<ValidatorEntry> GetValidatorsByStake(size_t offset = 0, size_t count = 0) const;
+
+    /**
+     * Get the 0-based position of an active validator in stake order
+     * @return std::nullopt if the validator is unknown or not active
      */
-    std::vector<ValidatorEntry> GetValidatorsByStake() const;
+    std::optional<size_t> GetStakeRank(const CKeyID& validatorId) const;
 
     /**
      * Get validators with pool fee at or below given rate
@@ -277,6 +305,16 @@ public:
      */
     void ProcessBlock(int height);
 
+    /**
+     * Raw database records, for a validator state snapshot
+     */
+    CDBWrapper::Records GetDBRecords() const;
+
+    /**
+     * Replace the database and the in-memory state with snapshot records
+     */
+    bool LoadDBRecords(const CDBWrapper::Records& records);
+
     /**
      * Serialize validators to stream (for persistence)
      */
@@ -300,6 +338,7 @@ public:
                 outpointIndex[entry.stakeOutpoint] = id;
             }
         }
+        RebuildStakeIndex();
     }
 };
 
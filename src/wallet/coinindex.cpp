@@ -0,0 +1,64 @@
+// Copyright (c) 2024-2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/coinindex.h>
+
+namespace wallet {
+
+void SpendableCoinIndex::Reset()
+{
+    m_built = false;
+    m_coins.clear();
+    m_buckets.clear();
+    m_dirty_txs.clear();
+}
+
+void SpendableCoinIndex::MarkTxDirty(const uint256& txid)
+{
+    // Building the index looks at every transaction anyway
+    if (m_built) m_dirty_txs.insert(txid);
+}
+
+void SpendableCoinIndex::Add(const COutPoint& outpoint, const Coin& coin)
+{
+    Remove(outpoint);
+    m_coins.emplace(outpoint, coin);
+    m_buckets[coin.type].emplace(coin.value, outpoint);
+}
+
+void SpendableCoinIndex::Remove(const COutPoint& outpoint)
+{
+    auto it = m_coins.find(outpoint);
+    if (it == m_coins.end()) return;
+    auto bucket = m_buckets.find(it->second.type);
+    bucket->second.erase({it->second.value, outpoint});
+    if (bucket->second.empty()) m_buckets.erase(bucket);
+    m_coins.erase(it);
+}
+
+void SpendableCoinIndex::RemoveTx(const uint256& txid)
+{
+    const Txid hash{Txid::FromUint256(txid)};
+    for (auto it = m_coins.lower_bound(COutPoint(hash, 0)); it != m_coins.end() && it->first.hash == hash;) {
+        const COutPoint outpoint{(it++)->first};
+        Remove(outpoint);
+    }
+}
+
+const SpendableCoinIndex::Coin* SpendableCoinIndex::Find(const COutPoint& outpoint) const
+{
+    auto it = m_coins.find(outpoint);
+    return it == m_coins.end() ? nullptr : &it->second;
+}
+
+std::vector<uint256> SpendableCoinIndex::GetTxids() const
+{
+    std::vector<uint256> txids;
+    for (const auto& [outpoint, coin] : m_coins) {
+        if (txids.empty() || txids.back() != outpoint.hash.ToUint256()) txids.push_back(outpoint.hash.ToUint256());
+    }
+    return txids;
+}
+
+} // namespace wallet
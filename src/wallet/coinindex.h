@@ -0,0 +1,85 @@
+// Copyright (c) 2024-2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_COININDEX_H
+#define BITCOIN_WALLET_COININDEX_H
+
+#include <consensus/amount.h>
+#include <outputtype.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+#include <wallet/types.h>
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace wallet {
+
+/**
+ * SpendableCoinIndex - Unspent outputs of the wallet, bucketed by output type and sorted by value.
+ *
+ * Keeps what AvailableCoins() works out for an output that does not change
+ * over its life (ownership, output type, signed input size), so that a send
+ * or a staking round only looks at the unspent outputs instead of solving
+ * every output of every wallet transaction again.
+ *
+ * The wallet marks the transactions whose outputs may have been added, spent
+ * or unspent; they are re-examined the next time the index is used. Anything
+ * that can change what the wallet owns resets the index, which is then built
+ * again from the whole wallet.
+ */
+class SpendableCoinIndex
+{
+public:
+    struct Coin {
+        CAmount value;
+        isminetype mine;
+        OutputType type;
+        //! Signed input size with low-R and with maximum size signatures, -1 if not solvable
+        int input_bytes;
+        int input_bytes_max_sig;
+    };
+
+    //! Outputs of a type, by increasing value
+    using Bucket = std::set<std::pair<CAmount, COutPoint>>;
+
+    bool IsBuilt() const { return m_built; }
+
+    //! Drop everything, the index is built again on its next use
+    void Reset();
+
+    //! The index has all of the wallet's unspent outputs
+    void SetBuilt() { m_built = true; }
+
+    //! Re-examine the outputs of a transaction on the next use
+    void MarkTxDirty(const uint256& txid);
+
+    std::set<uint256> TakeDirtyTxs() { return std::exchange(m_dirty_txs, {}); }
+
+    void Add(const COutPoint& outpoint, const Coin& coin);
+    void Remove(const COutPoint& outpoint);
+    //! Remove the outputs of a transaction that left the wallet
+    void RemoveTx(const uint256& txid);
+
+    const Coin* Find(const COutPoint& outpoint) const;
+
+    const std::map<OutputType, Bucket>& Buckets() const { return m_buckets; }
+
+    //! Transactions with indexed outputs
+    std::vector<uint256> GetTxids() const;
+
+    size_t Size() const { return m_coins.size(); }
+
+private:
+    bool m_built{false};
+    std::map<COutPoint, Coin> m_coins;
+    std::map<OutputType, Bucket> m_buckets;
+    std::set<uint256> m_dirty_txs;
+};
+
+} // namespace wallet
+
+#endif // BITCOIN_WALLET_COININDEX_H
@@ -179,6 +179,17 @@ public:
 
     /** Make a DatabaseBatch connected to this database */
     virtual std::unique_ptr<DatabaseBatch> MakeBatch(bool flush_on_close = true) = 0;
+
+    /**
+     * Write everything the calling thread writes through any batch in one
+     * database transaction until EndBulkWrite(). Transactions the thread's
+     * batches begin meanwhile are nested in it, other threads' writes wait.
+     *
+     * @return false if the backend does not support it or a bulk write is already active
+     */
+    virtual bool BeginBulkWrite() { return false; }
+    /** Commit the bulk write transaction */
+    virtual bool EndBulkWrite() { return false; }
 };
 
 enum class DatabaseFormat {
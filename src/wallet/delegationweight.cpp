@@ -0,0 +1,167 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/delegationweight.h>
+
+#include <addresstype.h>
+#include <primitives/block.h>
+
+#include <set>
+
+namespace wallet {
+
+//! Key hash an output is indexed under in the address index, as a delegate is looked up there
+static bool GetOutputKeyHash(const COutPoint& prevout, const CScript& scriptPubKey, uint160& keyHash)
+{
+    CTxDestination dest;
+    if (!ExtractDestination(prevout, scriptPubKey, dest)) return false;
+    if (const PKHash* pkhash = std::get_if<PKHash>(&dest)) {
+        keyHash = ToKeyID(*pkhash);
+        return true;
+    }
+    if (const PubKeyDestination* pubkey = std::get_if<PubKeyDestination>(&dest)) {
+        keyHash = ToKeyID(PKHash(pubkey->GetPubKey()));
+        return true;
+    }
+    return false;
+}
+
+void DelegationWeightTracker::SetDelegates(const std::vector<uint160>& delegates)
+{
+    LOCK(m_mutex);
+    const std::set<uint160> wanted(delegates.begin(), delegates.end());
+    for (auto it = m_delegates.begin(); it != m_delegates.end();) {
+        if (wanted.count(it->first)) {
+            ++it;
+            continue;
+        }
+        for (const auto& [prevout, coin] : it->second.coins) m_owners.erase(prevout);
+        it = m_delegates.erase(it);
+    }
+    for (const uint160& delegate : wanted) {
+        m_delegates.try_emplace(delegate);
+    }
+}
+
+void DelegationWeightTracker::Seed(const uint160& delegate, const std::vector<std::pair<COutPoint, Coin>>& coins)
+{
+    LOCK(m_mutex);
+    auto it = m_delegates.find(delegate);
+    if (it == m_delegates.end()) return;
+
+    for (const auto& [prevout, coin] : it->second.coins) m_owners.erase(prevout);
+    it->second.coins.clear();
+    it->second.seeded = true;
+    for (const auto& [prevout, coin] : coins) {
+        AddCoin(delegate, prevout, coin);
+    }
+}
+
+bool DelegationWeightTracker::GetCoins(const uint160& delegate, std::vector<std::pair<COutPoint, Coin>>& coins) const
+{
+    LOCK(m_mutex);
+    coins.clear();
+    auto it = m_delegates.find(delegate);
+    if (it == m_delegates.end() || !it->second.seeded) return false;
+    coins.assign(it->second.coins.begin(), it->second.coins.end());
+    return true;
+}
+
+void DelegationWeightTracker::AddCoin(const uint160& delegate, const COutPoint& prevout, const Coin& coin)
+{
+    // The seed may already include outputs of blocks the wallet is yet to be notified of
+    if (m_delegates[delegate].coins.emplace(prevout, coin).second) {
+        m_owners.emplace(prevout, delegate);
+    }
+}
+
+void DelegationWeightTracker::BlockConnected(const CBlock& block, int height)
+{
+    LOCK(m_mutex);
+    BlockUndo undo;
+    undo.hash = block.GetHash();
+    if (!m_delegates.empty()) {
+        for (const CTransactionRef& tx : block.vtx) {
+            if (!tx->IsCoinBase()) {
+                for (const CTxIn& txin : tx->vin) {
+                    auto owner = m_owners.find(txin.prevout);
+                    if (owner == m_owners.end()) continue;
+                    Delegate& delegate = m_delegates[owner->second];
+                    auto coin = delegate.coins.find(txin.prevout);
+                    undo.spent.push_back({owner->second, txin.prevout, coin->second});
+                    delegate.coins.erase(coin);
+                    m_owners.erase(owner);
+                }
+            }
+            for (uint32_t n = 0; n < tx->vout.size(); n++) {
+                const COutPoint prevout(tx->GetHash(), n);
+                uint160 keyHash;
+                if (!GetOutputKeyHash(prevout, tx->vout[n].scriptPubKey, keyHash)) continue;
+                auto it = m_delegates.find(keyHash);
+                if (it == m_delegates.end() || !it->second.seeded) continue;
+                AddCoin(keyHash, prevout, {tx->vout[n].nValue, height});
+            }
+        }
+    }
+
+    m_undo.push_back(std::move(undo));
+    if (m_undo.size() > MAX_UNDO_BLOCKS) m_undo.pop_front();
+}
+
+void DelegationWeightTracker::BlockDisconnected(const CBlock& block)
+{
+    LOCK(m_mutex);
+    if (m_undo.empty() || m_undo.back().hash != block.GetHash()) {
+        InvalidateAll();
+        return;
+    }
+
+    // Restore before removing, so an output created and spent in the block ends up gone
+    for (const SpentCoin& spent : m_undo.back().spent) {
+        auto it = m_delegates.find(spent.delegate);
+        if (it != m_delegates.end() && it->second.seeded) {
+            AddCoin(spent.delegate, spent.prevout, spent.coin);
+        }
+    }
+    m_undo.pop_back();
+
+    for (const CTransactionRef& tx : block.vtx) {
+        for (uint32_t n = 0; n < tx->vout.size(); n++) {
+            auto owner = m_owners.find(COutPoint(tx->GetHash(), n));
+            if (owner == m_owners.end()) continue;
+            m_delegates[owner->second].coins.erase(owner->first);
+            m_owners.erase(owner);
+        }
+    }
+}
+
+void DelegationWeightTracker::InvalidateAll()
+{
+    for (auto& [keyHash, delegate] : m_delegates) {
+        delegate.seeded = false;
+        delegate.coins.clear();
+    }
+    m_owners.clear();
+    m_undo.clear();
+}
+
+void DelegationWeightTracker::SetSnapshot(Snapshot snapshot)
+{
+    LOCK(m_mutex);
+    m_snapshot = std::move(snapshot);
+}
+
+DelegationWeightTracker::Snapshot DelegationWeightTracker::GetSnapshot() const
+{
+    LOCK(m_mutex);
+    return m_snapshot;
+}
+
+bool DelegationWeightTracker::HasDelegates() const
+{
+    LOCK(m_mutex);
+    return !m_delegates.empty();
+}
+
+} // namespace wallet
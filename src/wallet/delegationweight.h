@@ -0,0 +1,119 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_DELEGATIONWEIGHT_H
+#define BITCOIN_WALLET_DELEGATIONWEIGHT_H
+
+#include <consensus/amount.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class CBlock;
+
+namespace wallet {
+
+/**
+ * DelegationWeightTracker - Unspent outputs of the addresses delegated to a super staker.
+ *
+ * A delegate is seeded once from the address index. From then on its coins
+ * are kept current from the wallet's block connected and disconnected
+ * notifications, so a staking round or a weight query does not have to walk
+ * the address index of every delegate again.
+ *
+ * The weights computed from the coins after each block are published as a
+ * snapshot that can be read without holding cs_wallet.
+ */
+class DelegationWeightTracker
+{
+public:
+    struct Coin {
+        CAmount value;
+        //! Height of the block that created the output
+        int height;
+    };
+
+    struct Snapshot {
+        //! Chain height the weights are for, -1 before the first update
+        int height{-1};
+        CAmount total{0};
+        std::map<uint160, CAmount> weights;
+    };
+
+    //! Blocks whose spent coins are kept to undo a reorg without reseeding
+    static constexpr size_t MAX_UNDO_BLOCKS = 100;
+
+    /**
+     * Track exactly these delegates. New ones start unseeded, the coins of
+     * removed ones are dropped.
+     */
+    void SetDelegates(const std::vector<uint160>& delegates) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Set the unspent outputs of a tracked delegate, read from the address index.
+     */
+    void Seed(const uint160& delegate, const std::vector<std::pair<COutPoint, Coin>>& coins) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Get the unspent outputs of a delegate.
+     *
+     * @return false if the delegate is not tracked or not seeded yet
+     */
+    bool GetCoins(const uint160& delegate, std::vector<std::pair<COutPoint, Coin>>& coins) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Add the outputs a block pays to delegates and remove the ones it spends.
+     */
+    void BlockConnected(const CBlock& block, int height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Revert BlockConnected(). If the block's spent coins are no longer
+     * known, every delegate is reseeded.
+     */
+    void BlockDisconnected(const CBlock& block) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    void SetSnapshot(Snapshot snapshot) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Snapshot GetSnapshot() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    bool HasDelegates() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Delegate {
+        bool seeded{false};
+        std::map<COutPoint, Coin> coins;
+    };
+
+    struct SpentCoin {
+        uint160 delegate;
+        COutPoint prevout;
+        Coin coin;
+    };
+
+    struct BlockUndo {
+        uint256 hash;
+        std::vector<SpentCoin> spent;
+    };
+
+    void AddCoin(const uint160& delegate, const COutPoint& prevout, const Coin& coin) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void InvalidateAll() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    mutable Mutex m_mutex;
+    std::map<uint160, Delegate> m_delegates GUARDED_BY(m_mutex);
+    //! Delegate owning each tracked coin, to find the coins a block spends
+    std::unordered_map<COutPoint, uint160, SaltedOutpointHasher> m_owners GUARDED_BY(m_mutex);
+    std::deque<BlockUndo> m_undo GUARDED_BY(m_mutex);
+    Snapshot m_snapshot GUARDED_BY(m_mutex);
+};
+
+} // namespace wallet
+
+#endif // BITCOIN_WALLET_DELEGATIONWEIGHT_H
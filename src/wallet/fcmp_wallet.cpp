@@ -3,11 +3,15 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <wallet/fcmp_wallet.h>
+#include <wallet/coincontrol.h>
+#include <wallet/spend.h>
 #include <wallet/wallet.h>
 #include <privacy/ed25519/pedersen.h>
+#include <privacy/fcmp_consensus.h>
 #include <privacy/stealth.h>
 #include <hash.h>
 #include <logging.h>
+#include <util/moneystr.h>
 #include <util/time.h>
 
 #include <algorithm>
@@ -96,6 +100,12 @@ CFcmpTransactionResult CFcmpWalletManager::CreateFcmpTransaction(
         return result;
     }
 
+    // Inputs are proven from the cached witnesses; catch them up if a block
+    // arrived without UpdateWitnesses() being called
+    if (m_curveTree->GetOutputCount() != m_witnessTreeSize) {
+        UpdateWitnesses();
+    }
+
     // Build privacy transaction
     result.privacyTx.privacyType = privacy::PrivacyType::FCMP;
     result.privacyTx.nFee = fee;
@@ -223,94 +233,184 @@ CFcmpShieldResult CFcmpWalletManager::CreateShieldTransaction(
     const privacy::CStealthAddress& recipient,
     CAmount amount,
     int minConfirmations)
+{
+    CFcmpRecipient single;
+    single.stealthAddress = recipient;
+    single.amount = amount;
+    return CreateShieldTransaction(std::vector<CFcmpRecipient>{single}, minConfirmations);
+}
+
+CFcmpShieldResult CFcmpWalletManager::CreateShieldTransaction(
+    const std::vector<CFcmpRecipient>& recipients,
+    int minConfirmations)
 {
     CFcmpShieldResult result;
     result.success = false;
 
     LOCK(cs_fcmp);
 
-    if (amount <= 0) {
-        result.error = "Invalid amount";
+    if (recipients.empty() || recipients.size() > privacy::MAX_FCMP_SHIELD_OUTPUTS) {
+        result.error = strprintf("A shield transaction pays 1 to %u recipients", privacy::MAX_FCMP_SHIELD_OUTPUTS);
         return result;
     }
 
+    CAmount total = 0;
+    for (const auto& recipient : recipients) {
+        if (recipient.amount <= 0) {
+            result.error = "Invalid amount";
+            return result;
+        }
+        total += recipient.amount;
+        if (!MoneyRange(total)) {
+            result.error = "Amounts out of range";
+            return result;
+        }
+    }
+
     // Estimate fee for shielding transaction
-    // Shield txs are simpler: transparent inputs -> FCMP output in OP_RETURN
+    // Shield txs are simpler: transparent inputs -> FCMP outputs in OP_RETURN
     CAmount fee = 1000; // 0.00001 WATTx minimum fee
 
     // Create a standard transaction that:
     // 1. Spends transparent inputs
-    // 2. Has an OP_RETURN output with FCMP output data (O, I, C)
+    // 2. Has one OP_RETURN output with the FCMP output data (O, I, C) of
+    //    every recipient
     // 3. May have change output back to wallet
-
-    // Generate output tuple for curve tree
-    ed25519::Scalar blinding = ed25519::Scalar::Random();
-    std::optional<ed25519::Scalar> privKey;
-    curvetree::OutputTuple outputTuple = CreateOutputTuple(recipient, amount, blinding, privKey);
-
-    // Create the OP_RETURN script with FCMP output marker
-    // Format: OP_RETURN <FCMP_MARKER> <O:32> <I:32> <C:32>
-    CScript opReturnScript;
-    opReturnScript << OP_RETURN;
-
-    std::vector<uint8_t> fcmpData;
-    fcmpData.reserve(4 + 96); // marker + 3 points
-
-    // FCMP marker "FCMP"
-    fcmpData.push_back(0x46); // 'F'
-    fcmpData.push_back(0x43); // 'C'
-    fcmpData.push_back(0x4D); // 'M'
-    fcmpData.push_back(0x50); // 'P'
-
-    // Add O, I, C points
-    fcmpData.insert(fcmpData.end(), outputTuple.O.data.begin(), outputTuple.O.data.end());
-    fcmpData.insert(fcmpData.end(), outputTuple.I.data.begin(), outputTuple.I.data.end());
-    fcmpData.insert(fcmpData.end(), outputTuple.C.data.begin(), outputTuple.C.data.end());
-
-    opReturnScript << fcmpData;
+    //
+    // The shielded amounts are public on the transparent side, so the
+    // outputs need no range proof; a batch only saves transactions and fees.
+    result.outputs.reserve(recipients.size());
+    for (const auto& recipient : recipients) {
+        ed25519::Scalar blinding;
+        std::optional<ed25519::Scalar> privKey;
+        result.outputs.push_back(CreateOutputTuple(recipient.stealthAddress, recipient.amount, blinding, privKey));
+        // Note: Outputs we own are added when the transaction confirms
+    }
 
     // Build the transaction
     CMutableTransaction mtx;
     mtx.version = 2;
 
     // Add OP_RETURN output (FCMP data)
-    mtx.vout.push_back(CTxOut(0, opReturnScript));
+    mtx.vout.push_back(CTxOut(0, privacy::BuildFcmpShieldScript(result.outputs)));
 
     // The wallet will add inputs and change output
     // For now, return a template that the wallet can complete
 
     result.standardTx = MakeTransactionRef(std::move(mtx));
     result.fee = fee;
+    result.amount = total;
 
-    // If this is our own stealth address, track the output
-    if (privKey) {
-        CFcmpOutputInfo outputInfo;
-        outputInfo.amount = amount;
-        outputInfo.privKey = *privKey;
-        outputInfo.blinding = blinding;
-        outputInfo.outputTuple = outputTuple;
-        outputInfo.blockHeight = -1; // Unconfirmed
-        outputInfo.spent = false;
-        outputInfo.nTime = GetTime();
-
-        // Generate key image
-        auto keyImage = GenerateKeyImage(*privKey, outputTuple.O);
-        outputInfo.keyImageHash = keyImage.GetHash();
-
-        // Leaf index will be assigned when added to tree
-        if (m_curveTree) {
-            result.leafIndex = m_curveTree->GetOutputCount(); // Next index
-        }
-        outputInfo.treeLeafIndex = result.leafIndex;
+    // Leaf indexes will be assigned when added to tree
+    if (m_curveTree) {
+        result.leafIndex = m_curveTree->GetOutputCount(); // Next index
+    }
+
+    result.success = true;
+    return result;
+}
+
+CFcmpShieldResult CFcmpWalletManager::SendShieldTransaction(
+    const std::vector<CFcmpRecipient>& recipients,
+    int minConfirmations)
+{
+    CFcmpShieldResult result;
+    if (!m_wallet) {
+        result.error = "No wallet";
+        return result;
+    }
+
+    LOCK(m_wallet->cs_wallet);
+
+    result = CreateShieldTransaction(recipients, minConfirmations);
+    if (!result.success) return result;
+    result.success = false;
+
+    // The shielded value goes to a wallet-controlled address; the OP_RETURN
+    // commitments prove ownership of the shielded value. When spending, the
+    // FCMP proof demonstrates membership without revealing which output.
+    auto destResult = m_wallet->GetNewDestination(OutputType::BECH32, "fcmp_shield");
+    if (!destResult) {
+        result.error = strprintf("Failed to generate shield destination: %s", util::ErrorString(destResult).original);
+        return result;
+    }
 
-        // Note: Output will be added when transaction confirms
-        // For now, store pending info
+    std::vector<CRecipient> txRecipients;
+    txRecipients.push_back(CRecipient{*destResult, result.amount, false});                           // Shielded value output first
+    txRecipients.push_back(CRecipient{CNoDestination{result.standardTx->vout[0].scriptPubKey}, 0, false}); // FCMP commitment output
+
+    CCoinControl coinControl;
+    coinControl.m_min_depth = minConfirmations;
+
+    auto txResult = CreateTransaction(*m_wallet, txRecipients, std::nullopt, coinControl, true);
+    if (!txResult) {
+        result.error = strprintf("Failed to create transaction: %s", util::ErrorString(txResult).original);
+        return result;
     }
 
+    mapValue_t mapValue;
+    mapValue["comment"] = recipients.size() == 1 ? "FCMP shield transaction" :
+                          strprintf("FCMP shield transaction (%u recipients)", recipients.size());
+    m_wallet->CommitTransaction(txResult->tx, std::move(mapValue), {});
+
+    result.standardTx = txResult->tx;
+    result.fee = txResult->fee;
     result.success = true;
     return result;
 }
 
+// ============================================================================
+// Shield Queue
+// ============================================================================
+
+size_t CFcmpWalletManager::QueueShield(const CFcmpRecipient& recipient, int minConfirmations)
+{
+    LOCK(m_shield_queue_mutex);
+
+    if (m_shield_queue.empty()) {
+        m_shield_queue_min_conf = minConfirmations;
+    } else {
+        m_shield_queue_min_conf = std::max(m_shield_queue_min_conf, minConfirmations);
+    }
+    m_shield_queue.push_back(recipient);
+    return m_shield_queue.size();
+}
+
+std::vector<CFcmpShieldResult> CFcmpWalletManager::FlushShieldQueue()
+{
+    std::vector<CFcmpRecipient> pending;
+    int minConfirmations;
+    {
+        LOCK(m_shield_queue_mutex);
+        pending.swap(m_shield_queue);
+        minConfirmations = m_shield_queue_min_conf;
+        m_shield_queue_min_conf = 1;
+    }
+
+    std::vector<CFcmpShieldResult> results;
+    for (size_t begin = 0; begin < pending.size(); begin += privacy::MAX_FCMP_SHIELD_OUTPUTS) {
+        const size_t end = std::min(pending.size(), begin + privacy::MAX_FCMP_SHIELD_OUTPUTS);
+        const std::vector<CFcmpRecipient> batch(pending.begin() + begin, pending.begin() + end);
+
+        auto result = SendShieldTransaction(batch, minConfirmations);
+        if (result.success) {
+            LogPrintf("FCMP: Shielded %s to %u recipients in tx %s\n",
+                      FormatMoney(result.amount), batch.size(), result.standardTx->GetHash().ToString());
+        } else {
+            LogPrintf("FCMP: Dropped %u queued shield requests: %s\n", batch.size(), result.error);
+        }
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+size_t CFcmpWalletManager::GetPendingShieldCount() const
+{
+    LOCK(m_shield_queue_mutex);
+    return m_shield_queue.size();
+}
+
 // ============================================================================
 // Output Management
 // ============================================================================
@@ -384,6 +484,7 @@ bool CFcmpWalletManager::MarkFcmpOutputSpent(const COutPoint& outpoint, const ui
     }
 
     it->second.spent = true;
+    m_witnesses.erase(outpoint);
 
     // Track the spending
     if (!it->second.keyImageHash.IsNull()) {
@@ -508,6 +609,9 @@ void CFcmpWalletManager::SetCurveTree(std::shared_ptr<curvetree::CurveTree> tree
 {
     LOCK(cs_fcmp);
     m_curveTree = std::move(tree);
+    m_witnesses.clear();
+    m_witnessTreeSize = 0;
+    UpdateWitnesses();
 }
 
 ed25519::Point CFcmpWalletManager::GetTreeRoot() const
@@ -521,6 +625,44 @@ ed25519::Point CFcmpWalletManager::GetTreeRoot() const
     return m_curveTree->GetRoot();
 }
 
+void CFcmpWalletManager::UpdateWitnesses()
+{
+    LOCK(cs_fcmp);
+
+    if (!m_curveTree) {
+        return;
+    }
+
+    const uint64_t treeSize = m_curveTree->GetOutputCount();
+    if (treeSize < m_witnessTreeSize) {
+        // The tree was rewound: the branches may hold outputs it no longer has
+        m_witnesses.clear();
+    } else if (treeSize > m_witnessTreeSize && !m_witnesses.empty()) {
+        auto frontier = m_curveTree->GetFrontier(m_witnessTreeSize);
+        for (auto it = m_witnesses.begin(); it != m_witnesses.end();) {
+            if (frontier && curvetree::CurveTree::UpdateBranch(it->second, *frontier)) {
+                ++it;
+            } else {
+                it = m_witnesses.erase(it);
+            }
+        }
+    }
+    m_witnessTreeSize = treeSize;
+    m_witnessRoot = m_curveTree->GetRoot();
+
+    // Outputs that reached the tree since the last call
+    for (const auto& [outpoint, info] : m_fcmpOutputs) {
+        if (info.spent || info.blockHeight < 0 || info.treeLeafIndex >= treeSize ||
+            m_witnesses.count(outpoint)) {
+            continue;
+        }
+        auto branch = m_curveTree->GetBranch(info.treeLeafIndex);
+        if (branch) {
+            m_witnesses.emplace(outpoint, std::move(*branch));
+        }
+    }
+}
+
 // ============================================================================
 // Transaction Scanning
 // ============================================================================
@@ -543,9 +685,35 @@ int CFcmpWalletManager::ScanBlockForFcmpOutputs(
     for (const auto& tx : block.vtx) {
         found += ScanTransactionForFcmpOutputs(*tx, blockHeight);
     }
+    UpdateWitnesses();
     return found;
 }
 
+namespace {
+
+class FcmpRescanDetector : public PrivacyBlockDetector
+{
+public:
+    explicit FcmpRescanDetector(CFcmpWalletManager& manager) : m_manager(manager) {}
+
+    PrivacyBlockCommit ScanBlock(const std::shared_ptr<const CBlock>& block, int height) const override
+    {
+        return [&manager = m_manager, block, height](WalletBatch&) {
+            manager.ScanBlockForFcmpOutputs(*block, height);
+        };
+    }
+
+private:
+    CFcmpWalletManager& m_manager;
+};
+
+} // namespace
+
+std::unique_ptr<PrivacyBlockDetector> CFcmpWalletManager::MakeRescanDetector()
+{
+    return std::make_unique<FcmpRescanDetector>(*this);
+}
+
 // ============================================================================
 // Persistence
 // ============================================================================
@@ -687,21 +855,21 @@ std::optional<privacy::CFcmpInput> CFcmpWalletManager::BuildFcmpInput(
     auto rH = rerandomizer * H;
     fcmpInput.inputTuple.C_tilde = output.outputTuple.C + rH;
 
-    // Generate membership proof
-    auto branch = m_curveTree->GetBranch(output.treeLeafIndex);
-    if (!branch) {
-        LogPrintf("FCMP: Failed to get branch for leaf %lu\n",
+    // Generate membership proof from the cached witness
+    auto witness = m_witnesses.find(output.outpoint);
+    if (witness == m_witnesses.end()) {
+        LogPrintf("FCMP: No witness for leaf %lu\n",
                   output.treeLeafIndex);
         return std::nullopt;
     }
 
 #ifdef HAVE_FCMP
     try {
-        privacy::fcmp::FcmpProver prover(m_curveTree);
-        auto proofBytes = prover.GenerateProof(output.outputTuple, output.treeLeafIndex);
+        auto proofBytes = privacy::fcmp::FcmpProver::GenerateProof(
+            output.outputTuple, witness->second, m_witnessRoot);
         fcmpInput.membershipProof = privacy::CFcmpProof(
             std::move(proofBytes),
-            m_curveTree->GetRoot()
+            m_witnessRoot
         );
     } catch (const std::exception& e) {
         LogPrintf("FCMP: Proof generation failed: %s\n", e.what());
@@ -710,7 +878,7 @@ std::optional<privacy::CFcmpInput> CFcmpWalletManager::BuildFcmpInput(
 #else
     // Placeholder proof for testing
     fcmpInput.membershipProof.version = 1;
-    fcmpInput.membershipProof.treeRoot = m_curveTree->GetRoot();
+    fcmpInput.membershipProof.treeRoot = m_witnessRoot;
     fcmpInput.membershipProof.proofData.resize(64, 0);
     HashWriter hasher{};
     hasher << output.treeLeafIndex;
@@ -28,10 +28,12 @@
 #include <privacy/fcmp_tx.h>
 #include <privacy/ed25519/ed25519_types.h>
 #include <privacy/curvetree/curve_tree.h>
+#include <wallet/privacy_rescan.h>
 #include <wallet/stealth_wallet.h>
 #include <policy/feerate.h>
 #include <sync.h>
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <optional>
@@ -41,6 +43,9 @@ class CWallet;
 
 namespace wallet {
 
+/** How long shield requests are coalesced before the queue is flushed */
+static constexpr std::chrono::seconds FCMP_SHIELD_QUEUE_WINDOW{10};
+
 /**
  * @brief FCMP output owned by wallet
  *
@@ -130,9 +135,16 @@ struct CFcmpShieldResult
     // Fee paid
     CAmount fee;
 
-    // Leaf index in curve tree for the new output
+    // Leaf index in curve tree for the first new output; the outputs of a
+    // batch take consecutive leaves in recipient order
     uint64_t leafIndex{0};
 
+    // Output tuples added to the curve tree, one per recipient
+    std::vector<curvetree::OutputTuple> outputs;
+
+    // Total amount shielded
+    CAmount amount{0};
+
     // Success flag
     bool success{false};
 
@@ -227,6 +239,54 @@ public:
         CAmount amount,
         int minConfirmations = 1);
 
+    /**
+     * @brief Create one shield transaction paying several recipients
+     *
+     * All output tuples go into a single OP_RETURN, so a batch costs one
+     * transaction and one fee instead of one per recipient.
+     * @param recipients Up to privacy::MAX_FCMP_SHIELD_OUTPUTS recipients
+     * @param minConfirmations Minimum confirmations for inputs
+     * @return Shield result holding the unfunded template transaction
+     */
+    CFcmpShieldResult CreateShieldTransaction(
+        const std::vector<CFcmpRecipient>& recipients,
+        int minConfirmations = 1);
+
+    /**
+     * @brief Fund, sign and broadcast a shield transaction from transparent coins
+     * @param recipients Up to privacy::MAX_FCMP_SHIELD_OUTPUTS recipients
+     * @param minConfirmations Minimum confirmations for inputs
+     * @return Shield result holding the committed transaction and its fee
+     */
+    CFcmpShieldResult SendShieldTransaction(
+        const std::vector<CFcmpRecipient>& recipients,
+        int minConfirmations = 1);
+
+    // ========================================================================
+    // Shield Queue
+    // ========================================================================
+
+    /**
+     * @brief Queue a shield to be sent together with others
+     *
+     * Requests are coalesced until FlushShieldQueue() is called, which the
+     * caller schedules FCMP_SHIELD_QUEUE_WINDOW after the first request of a
+     * batch, or until a batch is full.
+     * @return Number of requests now pending
+     */
+    size_t QueueShield(const CFcmpRecipient& recipient, int minConfirmations = 1);
+
+    /**
+     * @brief Send the pending shield requests, in batches as large as allowed
+     * @return One result per transaction attempted; failed batches are dropped
+     */
+    std::vector<CFcmpShieldResult> FlushShieldQueue();
+
+    /**
+     * @brief Number of shield requests waiting for the next flush
+     */
+    size_t GetPendingShieldCount() const;
+
     // ========================================================================
     // Output Management
     // ========================================================================
@@ -340,6 +400,17 @@ public:
      */
     ed25519::Point GetTreeRoot() const;
 
+    /**
+     * @brief Bring the membership witnesses of owned outputs up to date
+     *
+     * Each unspent confirmed output keeps its branch in the curve tree. On
+     * every call only the right edge of the tree that changed since the last
+     * one is read, once for all outputs; a branch is taken from the tree
+     * only for an output that has none yet, or for all of them after the
+     * tree was rewound. Call after every connected or disconnected block.
+     */
+    void UpdateWitnesses();
+
     // ========================================================================
     // Transaction Scanning
     // ========================================================================
@@ -364,6 +435,15 @@ public:
         const CBlock& block,
         int blockHeight);
 
+    /**
+     * @brief Detector for CWallet::ScanForPrivacyOutputs()
+     *
+     * There is no output detection to run in parallel yet (see
+     * ScanTransactionForFcmpOutputs()), so each block is handed to
+     * ScanBlockForFcmpOutputs() in the ordered commit stage.
+     */
+    std::unique_ptr<PrivacyBlockDetector> MakeRescanDetector();
+
     // ========================================================================
     // Persistence
     // ========================================================================
@@ -419,6 +499,18 @@ private:
     // Global curve tree (shared with consensus)
     std::shared_ptr<curvetree::CurveTree> m_curveTree;
 
+    // Branches of owned outputs in the tree as of m_witnessTreeSize outputs
+    // with root m_witnessRoot, so transactions are built without tree reads
+    std::map<COutPoint, curvetree::TreeBranch> m_witnesses GUARDED_BY(cs_fcmp);
+    uint64_t m_witnessTreeSize GUARDED_BY(cs_fcmp){0};
+    ed25519::Point m_witnessRoot GUARDED_BY(cs_fcmp);
+
+    // Shield requests waiting for FlushShieldQueue(), with the strictest
+    // confirmation requirement among them
+    mutable Mutex m_shield_queue_mutex;
+    std::vector<CFcmpRecipient> m_shield_queue GUARDED_BY(m_shield_queue_mutex);
+    int m_shield_queue_min_conf GUARDED_BY(m_shield_queue_mutex){1};
+
     /**
      * @brief Select inputs for transaction
      * @param targetAmount Amount needed
@@ -968,6 +968,14 @@ public:
     {
         return m_wallet->IsTokenTxMine(MakeTokenTx(wtx));
     }
+    bool getTokenBalance(const uint256& id, uint256& balance) override
+    {
+        return m_wallet->GetTokenBalance(id, balance);
+    }
+    bool setTokenBalance(const uint256& id, const uint256& balance, const uint256& block_hash) override
+    {
+        return m_wallet->SetTokenBalance(id, balance, block_hash);
+    }
     ContractBookData getContractBook(const std::string& id) override
     {
         LOCK(m_wallet->cs_wallet);
@@ -1331,6 +1339,7 @@ public:
     void setEnabledStaking(bool enabled) override
     {
         m_wallet->m_enabled_staking = enabled;
+        m_wallet->WakeStaker();
     }
     bool getEnabledStaking() override
     {
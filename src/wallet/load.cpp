@@ -164,6 +164,9 @@ void StartWallets(WalletContext& context)
         context.scheduler->scheduleEvery([&context] { MaybeCompactWalletDB(context); }, 500ms);
     }
     context.scheduler->scheduleEvery([&context] { MaybeResendWalletTxs(context); }, 1min);
+    if (context.args->GetBoolArg("-consolidatedust", DEFAULT_CONSOLIDATE_DUST)) {
+        context.scheduler->scheduleEvery([&context] { MaybeConsolidateWalletCoins(context); }, 10min);
+    }
 }
 
 void FlushWallets(WalletContext& context)
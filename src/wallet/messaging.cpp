@@ -120,28 +120,62 @@ static bool ExtractPubKeyFromInput(const CTxIn& txin, CPubKey& pubkey) {
     return false;
 }
 
+// What a message scan looks up for every message, built once per scan
+struct MessageScanContext {
+    // Hashes of our addresses, which a message's cleartext recipient hash is
+    // checked against before anything is decrypted
+    std::set<uint160> ourAddressHashes;
+    // ECDH secrets by our address and the other party's key, as all the
+    // messages of a conversation share one
+    std::map<std::pair<uint160, CPubKey>, std::vector<unsigned char>> sharedSecrets;
+};
+
+static MessageScanContext MakeScanContext(const CWallet& wallet)
+{
+    MessageScanContext context;
+    for (const auto& [dest, data] : wallet.m_address_book) {
+        if (std::holds_alternative<PKHash>(dest)) {
+            context.ourAddressHashes.insert(uint160(std::get<PKHash>(dest)));
+        }
+    }
+
+    // Also add addresses from our keys
+    auto spk_man = wallet.GetLegacyScriptPubKeyMan();
+    if (spk_man) {
+        for (const CKeyID& keyId : spk_man->GetKeys()) {
+            context.ourAddressHashes.insert(uint160(keyId));
+        }
+    }
+    return context;
+}
+
 // Try to decrypt a message using wallet keys
 static bool TryDecryptMessage(const CWallet& wallet,
+                               MessageScanContext& context,
                                const std::vector<unsigned char>& encryptedData,
                                const CPubKey& otherPartyPubKey,
                                const uint160& ourAddressHash,
                                std::string& decryptedText) {
-    // Get our private key for this address
-    CKeyID ourKeyId(ourAddressHash);
-    CKey ourKey;
+    auto it = context.sharedSecrets.find({ourAddressHash, otherPartyPubKey});
+    if (it == context.sharedSecrets.end()) {
+        // Get our private key for this address
+        CKeyID ourKeyId(ourAddressHash);
+        CKey ourKey;
 
-    if (!GetKeyFromWallet(wallet, ourKeyId, ourKey)) {
-        return false;
-    }
+        if (!GetKeyFromWallet(wallet, ourKeyId, ourKey)) {
+            return false;
+        }
 
-    // Derive shared secret using ECDH
-    std::vector<unsigned char> sharedSecret;
-    if (!DeriveSharedSecret(ourKey, otherPartyPubKey, sharedSecret)) {
-        return false;
+        // Derive shared secret using ECDH
+        std::vector<unsigned char> sharedSecret;
+        if (!DeriveSharedSecret(ourKey, otherPartyPubKey, sharedSecret)) {
+            return false;
+        }
+        it = context.sharedSecrets.emplace(std::make_pair(ourAddressHash, otherPartyPubKey), std::move(sharedSecret)).first;
     }
 
     // Decrypt the message
-    if (!DecryptMessage(encryptedData, sharedSecret, decryptedText)) {
+    if (!DecryptMessage(encryptedData, it->second, decryptedText)) {
         return false;
     }
 
@@ -604,31 +638,15 @@ std::string SendMessage(CWallet& wallet,
     return "";  // Success
 }
 
-int ScanTransactionForMessages(const CWallet& wallet,
-                               const CTransaction& tx,
-                               int blockHeight,
-                               int64_t blockTime,
-                               std::vector<OnChainMessage>& messages)
+static int ScanTransactionForMessages(const CWallet& wallet,
+                                      MessageScanContext& context,
+                                      const CTransaction& tx,
+                                      int blockHeight,
+                                      int64_t blockTime,
+                                      std::vector<OnChainMessage>& messages)
 {
     int found = 0;
 
-    // Get our addresses
-    std::set<uint160> ourAddressHashes;
-    for (const auto& [dest, data] : wallet.m_address_book) {
-        if (std::holds_alternative<PKHash>(dest)) {
-            ourAddressHashes.insert(uint160(std::get<PKHash>(dest)));
-        }
-    }
-
-    // Also add addresses from our keys
-    auto spk_man = wallet.GetLegacyScriptPubKeyMan();
-    if (spk_man) {
-        std::set<CKeyID> keyIds = spk_man->GetKeys();
-        for (const CKeyID& keyId : keyIds) {
-            ourAddressHashes.insert(uint160(keyId));
-        }
-    }
-
     // Check each output for OP_RETURN messages
     for (const CTxOut& txout : tx.vout) {
         uint8_t version, msgType;
@@ -637,7 +655,7 @@ int ScanTransactionForMessages(const CWallet& wallet,
 
         if (ParseMessageScript(txout.scriptPubKey, version, msgType, recipientHash, payload)) {
             // Check if this message is for one of our addresses
-            bool isForUs = ourAddressHashes.count(recipientHash) > 0;
+            bool isForUs = context.ourAddressHashes.count(recipientHash) > 0;
 
             // Also check if we sent it (check inputs)
             bool isFromUs = false;
@@ -700,7 +718,7 @@ int ScanTransactionForMessages(const CWallet& wallet,
                     if (canDecrypt) {
                         // Decrypt using our key (recipient) and sender's pubkey
                         std::string decrypted;
-                        if (TryDecryptMessage(wallet, payload, otherPartyPubKey, recipientHash, decrypted)) {
+                        if (TryDecryptMessage(wallet, context, payload, otherPartyPubKey, recipientHash, decrypted)) {
                             msg.decryptedText = decrypted;
                         }
                     }
@@ -755,7 +773,7 @@ int ScanTransactionForMessages(const CWallet& wallet,
 
                         if (!senderKeyId.IsNull()) {
                             std::string decrypted;
-                            if (TryDecryptMessage(wallet, payload, otherPartyPubKey, uint160(senderKeyId), decrypted)) {
+                            if (TryDecryptMessage(wallet, context, payload, otherPartyPubKey, uint160(senderKeyId), decrypted)) {
                                 msg.decryptedText = decrypted;
                             }
                         }
@@ -771,6 +789,16 @@ int ScanTransactionForMessages(const CWallet& wallet,
     return found;
 }
 
+int ScanTransactionForMessages(const CWallet& wallet,
+                               const CTransaction& tx,
+                               int blockHeight,
+                               int64_t blockTime,
+                               std::vector<OnChainMessage>& messages)
+{
+    MessageScanContext context{MakeScanContext(wallet)};
+    return ScanTransactionForMessages(wallet, context, tx, blockHeight, blockTime, messages);
+}
+
 bool GetMessages(const CWallet& wallet,
                  std::vector<OnChainMessage>& messages,
                  bool includeOutgoing)
@@ -778,6 +806,8 @@ bool GetMessages(const CWallet& wallet,
     LOCK(wallet.cs_wallet);
     messages.clear();
 
+    MessageScanContext context{MakeScanContext(wallet)};
+
     // Scan all wallet transactions
     for (const auto& [txid, wtx] : wallet.mapWallet) {
         int blockHeight = -1;
@@ -788,7 +818,7 @@ bool GetMessages(const CWallet& wallet,
         }
 
         std::vector<OnChainMessage> txMessages;
-        ScanTransactionForMessages(wallet, *wtx.tx, blockHeight, blockTime, txMessages);
+        ScanTransactionForMessages(wallet, context, *wtx.tx, blockHeight, blockTime, txMessages);
 
         for (auto& msg : txMessages) {
             if (includeOutgoing || !msg.isOutgoing) {
@@ -0,0 +1,536 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/monero_sync.h>
+
+#include <cstring>
+
+namespace monero_wallet {
+
+namespace {
+
+//! Bounds-checked cursor over a byte string
+class BlobReader {
+public:
+    explicit BlobReader(const std::string& data, size_t pos = 0) : m_data(data), m_pos(pos) {}
+
+    size_t Pos() const { return m_pos; }
+    size_t Left() const { return m_data.size() - m_pos; }
+
+    bool Bytes(void* out, size_t len) {
+        if (Left() < len) return false;
+        std::memcpy(out, m_data.data() + m_pos, len);
+        m_pos += len;
+        return true;
+    }
+
+    bool Skip(size_t len) {
+        if (Left() < len) return false;
+        m_pos += len;
+        return true;
+    }
+
+    bool Byte(uint8_t& out) { return Bytes(&out, 1); }
+
+    bool Hash(MoneroHash& out) { return Bytes(out.data(), out.size()); }
+
+    // Little-endian fixed width integer
+    bool Fixed(uint64_t& out, size_t width) {
+        uint8_t buf[8];
+        if (!Bytes(buf, width)) return false;
+        out = 0;
+        for (size_t i = 0; i < width; i++) out |= uint64_t{buf[i]} << (8 * i);
+        return true;
+    }
+
+    // Monero LEB128 varint
+    bool Varint(uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!Byte(b)) return false;
+            out |= uint64_t{b & 0x7fu} << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // A count of items each at least min_size bytes long
+    bool Count(uint64_t& out, size_t min_size) {
+        return Varint(out) && out <= Left() / min_size;
+    }
+
+private:
+    const std::string& m_data;
+    size_t m_pos;
+};
+
+} // namespace
+
+void WriteMoneroVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// ============================================================================
+// Portable storage
+// ============================================================================
+
+namespace epee {
+
+namespace {
+
+constexpr uint8_t SIGNATURE[] = {0x01, 0x11, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01};
+constexpr int MAX_DEPTH = 64;
+
+enum : uint8_t {
+    TYPE_INT64 = 1, TYPE_INT32, TYPE_INT16, TYPE_INT8,
+    TYPE_UINT64, TYPE_UINT32, TYPE_UINT16, TYPE_UINT8,
+    TYPE_DOUBLE, TYPE_STRING, TYPE_BOOL, TYPE_OBJECT, TYPE_ARRAY,
+    FLAG_ARRAY = 0x80,
+};
+
+// epee varint: the two low bits give the width (1, 2, 4 or 8 bytes)
+void WriteVarint(std::string& out, uint64_t value)
+{
+    size_t width;
+    uint8_t mark;
+    if (value <= 63) {
+        width = 1; mark = 0;
+    } else if (value <= 16383) {
+        width = 2; mark = 1;
+    } else if (value <= 1073741823) {
+        width = 4; mark = 2;
+    } else {
+        width = 8; mark = 3;
+    }
+    value = (value << 2) | mark;
+    for (size_t i = 0; i < width; i++) out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+bool ReadVarint(BlobReader& r, uint64_t& out)
+{
+    uint8_t first;
+    if (!r.Byte(first)) return false;
+    const size_t width = size_t{1} << (first & 3);
+    out = first;
+    for (size_t i = 1; i < width; i++) {
+        uint8_t b;
+        if (!r.Byte(b)) return false;
+        out |= uint64_t{b} << (8 * i);
+    }
+    out >>= 2;
+    return true;
+}
+
+void WriteSection(std::string& out, const StorageValue& obj);
+
+uint8_t TypeOf(const StorageValue& v)
+{
+    switch (v.kind) {
+    case StorageValue::Kind::UINT: return TYPE_UINT64;
+    case StorageValue::Kind::INT: return TYPE_INT64;
+    case StorageValue::Kind::DOUBLE: return TYPE_DOUBLE;
+    case StorageValue::Kind::STRING: return TYPE_STRING;
+    case StorageValue::Kind::BOOL: return TYPE_BOOL;
+    case StorageValue::Kind::OBJECT: return TYPE_OBJECT;
+    case StorageValue::Kind::ARRAY:
+    case StorageValue::Kind::NONE: break;
+    }
+    return TYPE_ARRAY;
+}
+
+void WritePayload(std::string& out, const StorageValue& v)
+{
+    switch (v.kind) {
+    case StorageValue::Kind::UINT:
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<char>((v.u >> (8 * i)) & 0xff));
+        break;
+    case StorageValue::Kind::INT:
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<char>((uint64_t(v.i) >> (8 * i)) & 0xff));
+        break;
+    case StorageValue::Kind::DOUBLE: {
+        char buf[8];
+        std::memcpy(buf, &v.d, 8);
+        out.append(buf, 8);
+        break;
+    }
+    case StorageValue::Kind::STRING:
+        WriteVarint(out, v.str.size());
+        out += v.str;
+        break;
+    case StorageValue::Kind::BOOL:
+        out.push_back(v.b ? 1 : 0);
+        break;
+    case StorageValue::Kind::OBJECT:
+        WriteSection(out, v);
+        break;
+    case StorageValue::Kind::ARRAY:
+    case StorageValue::Kind::NONE:
+        break;
+    }
+}
+
+void WriteValue(std::string& out, const StorageValue& v)
+{
+    if (v.kind != StorageValue::Kind::ARRAY) {
+        out.push_back(static_cast<char>(TypeOf(v)));
+        WritePayload(out, v);
+        return;
+    }
+    // Arrays are homogeneous; the element type comes from the first element
+    const uint8_t type = v.array.empty() ? uint8_t{TYPE_UINT64} : TypeOf(v.array[0]);
+    out.push_back(static_cast<char>(type | FLAG_ARRAY));
+    WriteVarint(out, v.array.size());
+    for (const StorageValue& elem : v.array) {
+        if (type == TYPE_ARRAY) {
+            WriteValue(out, elem);
+        } else {
+            WritePayload(out, elem);
+        }
+    }
+}
+
+void WriteSection(std::string& out, const StorageValue& obj)
+{
+    WriteVarint(out, obj.object.size());
+    for (const auto& [name, value] : obj.object) {
+        out.push_back(static_cast<char>(name.size()));
+        out += name;
+        WriteValue(out, value);
+    }
+}
+
+bool ReadSection(BlobReader& r, StorageValue& obj, int depth);
+bool ReadValue(BlobReader& r, StorageValue& v, int depth);
+
+bool ReadPayload(BlobReader& r, uint8_t type, StorageValue& v, int depth)
+{
+    uint64_t raw;
+    switch (type) {
+    case TYPE_INT64:
+    case TYPE_INT32:
+    case TYPE_INT16:
+    case TYPE_INT8: {
+        const size_t width = size_t{8} >> (type - TYPE_INT64);
+        if (!r.Fixed(raw, width)) return false;
+        // Sign-extend from the stored width
+        const int shift = 64 - 8 * int(width);
+        v.kind = StorageValue::Kind::INT;
+        v.i = int64_t(raw << shift) >> shift;
+        return true;
+    }
+    case TYPE_UINT64:
+    case TYPE_UINT32:
+    case TYPE_UINT16:
+    case TYPE_UINT8:
+        if (!r.Fixed(raw, size_t{8} >> (type - TYPE_UINT64))) return false;
+        v.kind = StorageValue::Kind::UINT;
+        v.u = raw;
+        return true;
+    case TYPE_DOUBLE:
+        if (!r.Bytes(&v.d, 8)) return false;
+        v.kind = StorageValue::Kind::DOUBLE;
+        return true;
+    case TYPE_STRING: {
+        uint64_t len;
+        if (!ReadVarint(r, len) || len > r.Left()) return false;
+        v.kind = StorageValue::Kind::STRING;
+        v.str.resize(len);
+        return r.Bytes(v.str.data(), len);
+    }
+    case TYPE_BOOL: {
+        uint8_t b;
+        if (!r.Byte(b)) return false;
+        v.kind = StorageValue::Kind::BOOL;
+        v.b = b != 0;
+        return true;
+    }
+    case TYPE_OBJECT:
+        return ReadSection(r, v, depth + 1);
+    case TYPE_ARRAY:
+        // Array of arrays: each element carries its own type byte
+        return ReadValue(r, v, depth + 1);
+    }
+    return false;
+}
+
+bool ReadValue(BlobReader& r, StorageValue& v, int depth)
+{
+    if (depth > MAX_DEPTH) return false;
+    uint8_t type;
+    if (!r.Byte(type)) return false;
+    if (!(type & FLAG_ARRAY)) {
+        return ReadPayload(r, type, v, depth);
+    }
+    type &= ~FLAG_ARRAY;
+    uint64_t count;
+    if (!ReadVarint(r, count) || count > r.Left()) return false;
+    v.kind = StorageValue::Kind::ARRAY;
+    v.array.resize(count);
+    for (StorageValue& elem : v.array) {
+        if (!ReadPayload(r, type, elem, depth)) return false;
+    }
+    return true;
+}
+
+bool ReadSection(BlobReader& r, StorageValue& obj, int depth)
+{
+    if (depth > MAX_DEPTH) return false;
+    uint64_t count;
+    if (!ReadVarint(r, count) || count > r.Left()) return false;
+    obj.kind = StorageValue::Kind::OBJECT;
+    obj.object.resize(count);
+    for (auto& [name, value] : obj.object) {
+        uint8_t len;
+        if (!r.Byte(len)) return false;
+        name.resize(len);
+        if (!r.Bytes(name.data(), len) || !ReadValue(r, value, depth)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+StorageValue StorageValue::Uint(uint64_t value)
+{
+    StorageValue v;
+    v.kind = Kind::UINT;
+    v.u = value;
+    return v;
+}
+
+StorageValue StorageValue::Bool(bool value)
+{
+    StorageValue v;
+    v.kind = Kind::BOOL;
+    v.b = value;
+    return v;
+}
+
+StorageValue StorageValue::String(std::string value)
+{
+    StorageValue v;
+    v.kind = Kind::STRING;
+    v.str = std::move(value);
+    return v;
+}
+
+StorageValue StorageValue::Object()
+{
+    StorageValue v;
+    v.kind = Kind::OBJECT;
+    return v;
+}
+
+StorageValue& StorageValue::Add(std::string name, StorageValue value)
+{
+    object.emplace_back(std::move(name), std::move(value));
+    return *this;
+}
+
+const StorageValue* StorageValue::Find(const std::string& name) const
+{
+    if (kind != Kind::OBJECT) return nullptr;
+    for (const auto& [key, value] : object) {
+        if (key == name) return &value;
+    }
+    return nullptr;
+}
+
+uint64_t StorageValue::GetUint(uint64_t fallback) const
+{
+    if (kind == Kind::UINT) return u;
+    if (kind == Kind::INT && i >= 0) return uint64_t(i);
+    return fallback;
+}
+
+std::string Serialize(const StorageValue& root)
+{
+    std::string out(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+    WriteSection(out, root);
+    return out;
+}
+
+bool Parse(const std::string& data, StorageValue& root)
+{
+    if (data.size() < sizeof(SIGNATURE) || std::memcmp(data.data(), SIGNATURE, sizeof(SIGNATURE)) != 0) {
+        return false;
+    }
+    BlobReader r(data, sizeof(SIGNATURE));
+    root = StorageValue{};
+    return ReadSection(r, root, 0);
+}
+
+} // namespace epee
+
+// ============================================================================
+// Blocks and transactions
+// ============================================================================
+
+namespace {
+
+enum : uint8_t {
+    TXIN_GEN = 0xff,
+    TXIN_TO_KEY = 0x02,
+    TXOUT_TO_KEY = 0x02,
+    TXOUT_TO_TAGGED_KEY = 0x03,
+
+    EXTRA_PADDING = 0x00,
+    EXTRA_PUBKEY = 0x01,
+    EXTRA_NONCE = 0x02,
+    EXTRA_MERGE_MINING = 0x03,
+    EXTRA_ADDITIONAL_PUBKEYS = 0x04,
+    EXTRA_MINERGATE = 0xde,
+};
+
+// Highest RingCT type whose base layout is known
+constexpr uint8_t RCT_TYPE_MAX = 6;
+// From this type on ecdhInfo is an 8-byte amount per output
+constexpr uint8_t RCT_TYPE_COMPACT_ECDH = 4;
+
+// Pull the keys out of tx_extra. Like monerod, stop at the first field that
+// does not parse and keep what came before it.
+void ParseExtra(const std::string& extra, MoneroTx& tx)
+{
+    BlobReader r(extra);
+    uint8_t tag;
+    while (r.Byte(tag)) {
+        uint64_t len;
+        switch (tag) {
+        case EXTRA_PADDING:
+            return;
+        case EXTRA_PUBKEY: {
+            MoneroHash key;
+            if (!r.Hash(key)) return;
+            if (!tx.tx_pubkey) tx.tx_pubkey = key;
+            break;
+        }
+        case EXTRA_ADDITIONAL_PUBKEYS:
+            if (!r.Count(len, 32)) return;
+            tx.additional_pubkeys.resize(len);
+            for (MoneroHash& key : tx.additional_pubkeys) r.Hash(key);
+            break;
+        case EXTRA_NONCE:
+        case EXTRA_MERGE_MINING:
+        case EXTRA_MINERGATE:
+            if (!r.Varint(len) || !r.Skip(len)) return;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+bool ParseTransactionAt(BlobReader& r, MoneroTx& tx)
+{
+    const size_t start = r.Pos();
+    uint64_t count;
+
+    if (!r.Varint(tx.version) || !r.Varint(tx.unlock_time)) return false;
+
+    if (!r.Count(count, 2)) return false;
+    for (uint64_t i = 0; i < count; i++) {
+        uint8_t tag;
+        uint64_t value;
+        if (!r.Byte(tag)) return false;
+        if (tag == TXIN_GEN) {
+            if (!r.Varint(value)) return false;
+            tx.coinbase = true;
+        } else if (tag == TXIN_TO_KEY) {
+            uint64_t offsets;
+            MoneroHash key_image;
+            if (!r.Varint(value) || !r.Count(offsets, 1)) return false;
+            for (uint64_t j = 0; j < offsets; j++) {
+                if (!r.Varint(value)) return false;
+            }
+            if (!r.Hash(key_image)) return false;
+            tx.key_images.push_back(key_image);
+        } else {
+            return false;
+        }
+    }
+
+    if (!r.Count(count, 34)) return false;
+    tx.outputs.resize(count);
+    for (MoneroTxOut& out : tx.outputs) {
+        uint8_t tag;
+        if (!r.Varint(out.amount) || !r.Byte(tag) || !r.Hash(out.key)) return false;
+        if (tag == TXOUT_TO_TAGGED_KEY) {
+            uint8_t view_tag;
+            if (!r.Byte(view_tag)) return false;
+            out.view_tag = view_tag;
+        } else if (tag != TXOUT_TO_KEY) {
+            return false;
+        }
+    }
+
+    std::string extra;
+    if (!r.Count(count, 1)) return false;
+    extra.resize(count);
+    if (!r.Bytes(extra.data(), count)) return false;
+    ParseExtra(extra, tx);
+
+    tx.prefix_size = r.Pos() - start;
+    if (tx.version < 2) return true;
+
+    // RingCT base: type, fee, ecdhInfo, outPk
+    const size_t base_start = r.Pos();
+    if (!r.Byte(tx.rct_type)) return false;
+    if (tx.rct_type != 0) {
+        uint64_t fee;
+        if (!r.Varint(fee)) return false;
+        if (tx.rct_type <= RCT_TYPE_MAX) {
+            const bool compact = tx.rct_type >= RCT_TYPE_COMPACT_ECDH;
+            tx.ecdh_amounts.resize(tx.outputs.size());
+            for (MoneroHash& amount : tx.ecdh_amounts) {
+                amount.fill(0);
+                if (compact) {
+                    if (!r.Bytes(amount.data(), 8)) return false;
+                } else if (!r.Skip(32) || !r.Hash(amount)) {
+                    return false;
+                }
+            }
+            if (!r.Skip(32 * tx.outputs.size())) return false;
+        }
+    }
+    tx.rct_base_size = r.Pos() - base_start;
+    return true;
+}
+
+} // namespace
+
+bool ParseMoneroTransaction(const std::string& blob, MoneroTx& tx)
+{
+    BlobReader r(blob);
+    tx = MoneroTx{};
+    return ParseTransactionAt(r, tx);
+}
+
+bool ParseMoneroBlock(const std::string& blob, MoneroBlock& block)
+{
+    BlobReader r(blob);
+    uint64_t version, nonce, count;
+    block = MoneroBlock{};
+
+    if (!r.Varint(version) || !r.Varint(version) || !r.Varint(block.timestamp) ||
+        !r.Hash(block.prev_id) || !r.Fixed(nonce, 4)) {
+        return false;
+    }
+
+    const size_t miner_start = r.Pos();
+    if (!ParseTransactionAt(r, block.miner_tx) || !block.miner_tx.coinbase) return false;
+    block.miner_tx_blob = blob.substr(miner_start, r.Pos() - miner_start);
+
+    if (!r.Count(count, 32)) return false;
+    block.tx_hashes.resize(count);
+    for (MoneroHash& hash : block.tx_hashes) r.Hash(hash);
+    return true;
+}
+
+} // namespace monero_wallet
@@ -0,0 +1,119 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_MONERO_SYNC_H
+#define WATTX_MONERO_SYNC_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Decoding for monerod's binary endpoints (get_blocks.bin and friends)
+ *
+ * MoneroLightWallet syncs by pulling whole blocks from the daemon instead of
+ * asking a wallet RPC about each transfer. The requests and responses are in
+ * epee's portable storage format, and the blocks and transactions inside are
+ * Monero's binary serialization; both are decoded here, without crypto, so
+ * the scanner can run on several threads over already parsed data.
+ */
+namespace monero_wallet {
+
+using MoneroHash = std::array<uint8_t, 32>;
+
+namespace epee {
+
+/**
+ * Value in epee portable storage
+ *
+ * Integers of every width decode to UINT or INT. Arrays of one type decode
+ * to ARRAY; containers of plain data, such as block_ids, travel as STRING.
+ */
+struct StorageValue {
+    enum class Kind { NONE, UINT, INT, DOUBLE, STRING, BOOL, OBJECT, ARRAY };
+
+    Kind kind{Kind::NONE};
+    uint64_t u{0};
+    int64_t i{0};
+    double d{0};
+    bool b{false};
+    std::string str;
+    std::vector<std::pair<std::string, StorageValue>> object;
+    std::vector<StorageValue> array;
+
+    static StorageValue Uint(uint64_t value);
+    static StorageValue Bool(bool value);
+    static StorageValue String(std::string value);
+    static StorageValue Object();
+
+    // Append a field to an object
+    StorageValue& Add(std::string name, StorageValue value);
+
+    // Field of an object, nullptr if absent or not an object
+    const StorageValue* Find(const std::string& name) const;
+
+    uint64_t GetUint(uint64_t fallback = 0) const;
+};
+
+// Encode an object as a portable storage document
+std::string Serialize(const StorageValue& root);
+
+// Decode a portable storage document; fails on malformed or truncated input
+bool Parse(const std::string& data, StorageValue& root);
+
+} // namespace epee
+
+/**
+ * Transaction fields the scanner needs, from a (possibly pruned) blob
+ */
+struct MoneroTxOut {
+    uint64_t amount{0};          // cleartext amount, 0 for RingCT outputs
+    MoneroHash key{};            // one-time output public key
+    std::optional<uint8_t> view_tag;
+};
+
+struct MoneroTx {
+    uint64_t version{0};
+    uint64_t unlock_time{0};
+    bool coinbase{false};
+    std::vector<MoneroHash> key_images;
+    std::vector<MoneroTxOut> outputs;
+
+    // From tx_extra
+    std::optional<MoneroHash> tx_pubkey;
+    std::vector<MoneroHash> additional_pubkeys;
+
+    // RingCT base; ecdh_amounts holds 8 bytes per output for the compact
+    // types (4 and up), the 32-byte amount field for the older ones
+    uint8_t rct_type{0};
+    std::vector<MoneroHash> ecdh_amounts;
+
+    // Byte lengths of the prefix and the RingCT base, for computing the txid
+    size_t prefix_size{0};
+    size_t rct_base_size{0};
+};
+
+// Parse a transaction blob. Data after the RingCT base is ignored, so pruned
+// and full blobs both work; v1 signatures are not parsed.
+bool ParseMoneroTransaction(const std::string& blob, MoneroTx& tx);
+
+struct MoneroBlock {
+    uint64_t timestamp{0};
+    MoneroHash prev_id{};
+    std::string miner_tx_blob;
+    MoneroTx miner_tx;
+    std::vector<MoneroHash> tx_hashes;
+};
+
+bool ParseMoneroBlock(const std::string& blob, MoneroBlock& block);
+
+// Monero's LEB128 varint, as used in blobs and key derivations
+void WriteMoneroVarint(std::string& out, uint64_t value);
+
+} // namespace monero_wallet
+
+#endif // WATTX_MONERO_SYNC_H
@@ -4,23 +4,25 @@
 
 #include <wallet/monero_wallet.h>
 #include <crypto/sha256.h>
+#include <crypto/sha3.h>
 #include <logging.h>
+#include <privacy/ed25519/extended_point.h>
+#include <streams.h>
+#include <util/fs_helpers.h>
 #include <util/strencodings.h>
+#include <util/time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <future>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sstream>
 #include <sys/socket.h>
+#include <thread>
 #include <unistd.h>
 
-// Keccak-256 implementation (simplified)
-extern "C" {
-    // We'll use a basic keccak implementation
-    void keccak(const uint8_t *in, size_t inlen, uint8_t *md, int mdlen);
-}
-
 // Ed25519 operations (simplified - in production, use libsodium or similar)
 namespace ed25519 {
     // Curve order l = 2^252 + 27742317777372353535851937790883648493
@@ -132,6 +134,10 @@ bool MoneroLightWallet::InitFromSeed(const std::vector<uint8_t>& seed, MoneroNet
     m_keys.spend_public_key = DerivePublicKey(m_keys.spend_secret_key);
     m_keys.view_public_key = DerivePublicKey(m_keys.view_secret_key);
 
+    {
+        LOCK(m_state_mutex);
+        m_state_loaded = false;
+    }
     m_initialized = true;
 
     LogPrintf("MoneroWallet: Initialized from WATTx seed\n");
@@ -148,6 +154,10 @@ bool MoneroLightWallet::InitFromKeys(const MoneroSecretKey& spend_key, const Mon
     m_keys.spend_public_key = DerivePublicKey(spend_key);
     m_keys.view_public_key = DerivePublicKey(view_key);
 
+    {
+        LOCK(m_state_mutex);
+        m_state_loaded = false;
+    }
     m_initialized = true;
 
     LogPrintf("MoneroWallet: Initialized from keys\n");
@@ -205,41 +215,10 @@ void MoneroLightWallet::SetDaemonConnection(const std::string& host, uint16_t po
 }
 
 bool MoneroLightWallet::QueryBalance(MoneroBalance& balance) {
-    if (!m_initialized || m_daemon_host.empty()) {
+    if (!Sync()) {
         return false;
     }
-
-    // Query daemon for balance
-    // This uses the get_balance RPC call
-    std::string params = "{\"account_index\":0}";
-    std::string response = DaemonRPC("get_balance", params);
-
-    if (response.empty()) {
-        return false;
-    }
-
-    // Parse balance from response (simplified parsing)
-    // In production, use proper JSON parser
-    size_t pos = response.find("\"balance\":");
-    if (pos != std::string::npos) {
-        pos += 10;
-        size_t end = response.find_first_of(",}", pos);
-        if (end != std::string::npos) {
-            std::string bal_str = response.substr(pos, end - pos);
-            balance.balance = std::stoull(bal_str);
-        }
-    }
-
-    pos = response.find("\"unlocked_balance\":");
-    if (pos != std::string::npos) {
-        pos += 19;
-        size_t end = response.find_first_of(",}", pos);
-        if (end != std::string::npos) {
-            std::string bal_str = response.substr(pos, end - pos);
-            balance.unlocked_balance = std::stoull(bal_str);
-        }
-    }
-
+    balance = GetSyncedBalance();
     return true;
 }
 
@@ -284,6 +263,397 @@ bool MoneroLightWallet::IsOurAddress(const std::string& address) const {
     return false;
 }
 
+// ============================================================================
+// Daemon Sync
+// ============================================================================
+
+struct MoneroLightWallet::ScanContext {
+    ed25519::Scalar view_secret;
+    ed25519::ExtendedPoint spend_public;
+};
+
+struct MoneroLightWallet::BlockBatch {
+    uint64_t start_height{0};
+    uint64_t chain_height{0};
+    // Block blob and its transaction blobs (pruned), from start_height on
+    std::vector<std::pair<std::string, std::vector<std::string>>> blocks;
+};
+
+namespace {
+
+// Hs(): Keccak output reduced mod l. libsodium's reduction reads 64 bytes.
+ed25519::Scalar HashToScalar(const std::array<uint8_t, 32>& hash) {
+    uint8_t wide[64] = {};
+    std::memcpy(wide, hash.data(), 32);
+    return ed25519::Scalar::FromBytesModOrder(wide, sizeof(wide));
+}
+
+// D = 8 * a * R
+std::optional<MoneroHash> KeyDerivation(const ed25519::Scalar& view_secret, const MoneroHash& tx_pubkey) {
+    ed25519::ExtendedPoint R;
+    if (!ed25519::ExtendedPoint::Decode(ed25519::Point(tx_pubkey), R)) {
+        return std::nullopt;
+    }
+    return (R * view_secret).Double().Double().Double().Encode().data;
+}
+
+uint64_t ReadLE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= uint64_t{p[i]} << (8 * i);
+    return v;
+}
+
+} // namespace
+
+MoneroLightWallet::ScanContext MoneroLightWallet::MakeScanContext() const {
+    ScanContext ctx;
+    ctx.view_secret = ed25519::Scalar(m_keys.view_secret_key.data());
+    ctx.spend_public = ed25519::FixedBaseTable::Base().Mul(ed25519::Scalar(m_keys.spend_secret_key.data()));
+    return ctx;
+}
+
+void MoneroLightWallet::ScanTransaction(const ScanContext& ctx, const MoneroTx& tx, const std::string& tx_hash,
+                                        uint64_t height, std::vector<MoneroOutput>& found) {
+    std::optional<MoneroHash> main_derivation;
+    if (tx.tx_pubkey) {
+        main_derivation = KeyDerivation(ctx.view_secret, *tx.tx_pubkey);
+    }
+    // Outputs to subaddresses may each come with their own tx public key
+    const bool per_output_keys = tx.additional_pubkeys.size() == tx.outputs.size();
+
+    for (size_t i = 0; i < tx.outputs.size(); i++) {
+        const MoneroTxOut& out = tx.outputs[i];
+
+        std::vector<MoneroHash> derivations;
+        if (main_derivation) derivations.push_back(*main_derivation);
+        if (per_output_keys) {
+            if (auto d = KeyDerivation(ctx.view_secret, tx.additional_pubkeys[i])) derivations.push_back(*d);
+        }
+
+        for (const MoneroHash& derivation : derivations) {
+            std::string buf(derivation.begin(), derivation.end());
+            WriteMoneroVarint(buf, i);
+
+            // The view tag rejects almost every foreign output with one hash
+            if (out.view_tag) {
+                const std::string tagged = "view_tag" + buf;
+                if (Keccak256(tagged.data(), tagged.size())[0] != *out.view_tag) continue;
+            }
+
+            // P == Hs(D || i)*G + B
+            const ed25519::Scalar shared = HashToScalar(Keccak256(buf.data(), buf.size()));
+            const ed25519::ExtendedPoint expected = ed25519::FixedBaseTable::Base().Mul(shared) + ctx.spend_public;
+            if (expected.Encode().data != out.key) continue;
+
+            MoneroOutput output;
+            output.tx_hash = tx_hash;
+            output.output_index = i;
+            output.block_height = height;
+            output.unlock_time = tx.unlock_time;
+            output.output_public_key = out.key;
+            output.amount = out.amount;
+            if (tx.rct_type != 0 && i < tx.ecdh_amounts.size()) {
+                const MoneroHash& masked = tx.ecdh_amounts[i];
+                if (tx.rct_type >= 4) {
+                    // amount XOR Keccak("amount" || Hs(D || i))
+                    std::string key_data = "amount";
+                    key_data.append(shared.data.begin(), shared.data.end());
+                    output.amount = ReadLE64(masked.data()) ^ ReadLE64(Keccak256(key_data.data(), key_data.size()).data());
+                } else {
+                    // amount - Hs(Hs(Hs(D || i))) as scalars
+                    const ed25519::Scalar mask_key = HashToScalar(Keccak256(shared.data.data(), 32));
+                    const ed25519::Scalar amount_key = HashToScalar(Keccak256(mask_key.data.data(), 32));
+                    output.amount = ReadLE64((ed25519::Scalar(masked.data()) - amount_key).data.data());
+                }
+            }
+            found.push_back(std::move(output));
+            break;
+        }
+    }
+}
+
+bool MoneroLightWallet::ScanBlock(const ScanContext& ctx, const std::string& block_blob,
+                                  const std::vector<std::string>& tx_blobs, uint64_t height,
+                                  MoneroHash& prev_id, std::vector<MoneroOutput>& found) {
+    MoneroBlock block;
+    if (!ParseMoneroBlock(block_blob, block) || block.tx_hashes.size() != tx_blobs.size()) {
+        return false;
+    }
+    prev_id = block.prev_id;
+
+    // Miner transaction id: H(blob) for v1, H(H(prefix) || H(rct base) || 0) for v2
+    std::array<uint8_t, 32> miner_hash;
+    const std::string& miner_blob = block.miner_tx_blob;
+    if (block.miner_tx.version < 2) {
+        miner_hash = Keccak256(miner_blob.data(), miner_blob.size());
+    } else {
+        uint8_t parts[96] = {};
+        const auto prefix_hash = Keccak256(miner_blob.data(), block.miner_tx.prefix_size);
+        const auto base_hash = Keccak256(miner_blob.data() + block.miner_tx.prefix_size, block.miner_tx.rct_base_size);
+        std::memcpy(parts, prefix_hash.data(), 32);
+        std::memcpy(parts + 32, base_hash.data(), 32);
+        miner_hash = Keccak256(parts, sizeof(parts));
+    }
+    ScanTransaction(ctx, block.miner_tx, HexStr(miner_hash), height, found);
+
+    for (size_t i = 0; i < tx_blobs.size(); i++) {
+        MoneroTx tx;
+        if (!ParseMoneroTransaction(tx_blobs[i], tx)) {
+            return false;
+        }
+        ScanTransaction(ctx, tx, HexStr(block.tx_hashes[i]), height, found);
+    }
+    return true;
+}
+
+bool MoneroLightWallet::FetchBlocks(uint64_t start_height, BlockBatch& batch) {
+    epee::StorageValue req = epee::StorageValue::Object();
+    req.Add("requested_info", epee::StorageValue::Uint(0))
+       .Add("block_ids", epee::StorageValue::String(""))
+       .Add("start_height", epee::StorageValue::Uint(start_height))
+       .Add("prune", epee::StorageValue::Bool(true))
+       .Add("no_miner_tx", epee::StorageValue::Bool(false))
+       .Add("pool_info_since", epee::StorageValue::Uint(0))
+       .Add("max_block_count", epee::StorageValue::Uint(MONERO_SYNC_BATCH_BLOCKS));
+
+    const std::string response = DaemonPost("/get_blocks.bin", "application/octet-stream", epee::Serialize(req));
+    epee::StorageValue res;
+    if (response.empty() || !epee::Parse(response, res)) {
+        LogPrintf("MoneroWallet: get_blocks.bin from height %d failed\n", start_height);
+        return false;
+    }
+    const epee::StorageValue* status = res.Find("status");
+    const epee::StorageValue* start = res.Find("start_height");
+    const epee::StorageValue* current = res.Find("current_height");
+    const epee::StorageValue* blocks = res.Find("blocks");
+    if (!status || status->str != "OK" || !start || start->GetUint() != start_height || !current ||
+        !blocks || blocks->kind != epee::StorageValue::Kind::ARRAY || blocks->array.empty()) {
+        LogPrintf("MoneroWallet: get_blocks.bin from height %d returned %s\n", start_height,
+                  status ? status->str : "no status");
+        return false;
+    }
+
+    batch.start_height = start_height;
+    batch.chain_height = current->GetUint();
+    batch.blocks.clear();
+    batch.blocks.reserve(blocks->array.size());
+    for (const epee::StorageValue& entry : blocks->array) {
+        const epee::StorageValue* block = entry.Find("block");
+        if (!block) return false;
+        std::vector<std::string> txs;
+        if (const epee::StorageValue* tx_list = entry.Find("txs")) {
+            for (const epee::StorageValue& tx : tx_list->array) {
+                // Pruned responses wrap each blob in an object
+                const epee::StorageValue* blob = tx.kind == epee::StorageValue::Kind::OBJECT ? tx.Find("blob") : &tx;
+                if (!blob) return false;
+                txs.push_back(blob->str);
+            }
+        }
+        batch.blocks.emplace_back(block->str, std::move(txs));
+    }
+    return true;
+}
+
+bool MoneroLightWallet::Sync() {
+    if (!m_initialized || m_daemon_host.empty()) {
+        return false;
+    }
+
+    LOCK(m_sync_mutex);
+    const ScanContext ctx = MakeScanContext();
+
+    // Re-read the last scanned block, so a reorg shows in its prev_id
+    uint64_t start_height;
+    {
+        LOCK(m_state_mutex);
+        if (!m_state_loaded) LoadState();
+        start_height = m_state.prev_ids.count(m_state.next_height - 1) ? m_state.next_height - 1 : m_state.next_height;
+    }
+
+    auto fetch = [this](uint64_t height) {
+        auto batch = std::make_unique<BlockBatch>();
+        if (!FetchBlocks(height, *batch)) batch.reset();
+        return batch;
+    };
+    auto pending = std::async(std::launch::async, fetch, start_height);
+    uint64_t reorg_step = 1;
+
+    while (true) {
+        std::unique_ptr<BlockBatch> batch = pending.get();
+        if (!batch) {
+            return false;
+        }
+
+        MoneroBlock first;
+        if (!ParseMoneroBlock(batch->blocks[0].first, first)) {
+            return false;
+        }
+
+        // Step back until the first block links to the chain we scanned
+        {
+            LOCK(m_state_mutex);
+            auto it = m_state.prev_ids.find(batch->start_height);
+            if (it != m_state.prev_ids.end() && it->second != first.prev_id) {
+                const uint64_t oldest = m_state.prev_ids.begin()->first;
+                if (batch->start_height > oldest) {
+                    const uint64_t back = batch->start_height - oldest < reorg_step ? oldest : batch->start_height - reorg_step;
+                    reorg_step *= 2;
+                    pending = std::async(std::launch::async, fetch, back);
+                    continue;
+                }
+                LogPrintf("MoneroWallet: Reorg deeper than %d blocks, rescanning from height %d\n",
+                          MONERO_SYNC_REORG_WINDOW, batch->start_height);
+            }
+        }
+
+        // Fetch the next batch while this one is scanned
+        const uint64_t end_height = batch->start_height + batch->blocks.size();
+        const bool more = end_height < batch->chain_height;
+        if (more) {
+            pending = std::async(std::launch::async, fetch, end_height - 1);
+        }
+
+        const size_t count = batch->blocks.size();
+        std::vector<std::vector<MoneroOutput>> found(count);
+        std::vector<MoneroHash> prev_ids(count);
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        auto worker = [&] {
+            for (size_t i; (i = next++) < count && !failed;) {
+                if (!ScanBlock(ctx, batch->blocks[i].first, batch->blocks[i].second, batch->start_height + i,
+                               prev_ids[i], found[i])) {
+                    failed = true;
+                }
+            }
+        };
+        const size_t thread_count = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < thread_count; t++) threads.emplace_back(worker);
+        worker();
+        for (std::thread& thread : threads) thread.join();
+        if (failed) {
+            LogPrintf("MoneroWallet: Malformed block in batch from height %d\n", batch->start_height);
+            return false;
+        }
+
+        {
+            LOCK(m_state_mutex);
+            RollBack(batch->start_height);
+            for (size_t i = 0; i < count; i++) {
+                m_state.prev_ids[batch->start_height + i] = prev_ids[i];
+                for (MoneroOutput& output : found[i]) {
+                    LogPrintf("MoneroWallet: Received %d at height %d\n", output.amount, output.block_height);
+                    m_state.total += output.amount;
+                    m_state.outputs.push_back(std::move(output));
+                }
+            }
+            m_state.next_height = end_height;
+            m_state.chain_height = batch->chain_height;
+            while (!m_state.prev_ids.empty() && m_state.prev_ids.begin()->first + MONERO_SYNC_REORG_WINDOW < end_height) {
+                m_state.prev_ids.erase(m_state.prev_ids.begin());
+            }
+            SaveState();
+        }
+
+        if (!more) {
+            return true;
+        }
+    }
+}
+
+void MoneroLightWallet::RollBack(uint64_t height) {
+    while (!m_state.outputs.empty() && m_state.outputs.back().block_height >= height) {
+        m_state.total -= m_state.outputs.back().amount;
+        m_state.outputs.pop_back();
+    }
+    m_state.prev_ids.erase(m_state.prev_ids.lower_bound(height), m_state.prev_ids.end());
+    m_state.next_height = std::min(m_state.next_height, height);
+}
+
+void MoneroLightWallet::LoadState() {
+    m_state_loaded = true;
+    m_state = SyncState{};
+    m_state.spend_public_key = m_keys.spend_public_key;
+    m_state.next_height = m_restore_height;
+    if (m_state_file.empty() || !fs::exists(m_state_file)) {
+        return;
+    }
+
+    AutoFile file{fsbridge::fopen(m_state_file, "rb")};
+    SyncState loaded;
+    try {
+        file >> loaded;
+    } catch (const std::exception& e) {
+        LogPrintf("MoneroWallet: Ignoring unreadable sync state %s: %s\n", fs::PathToString(m_state_file), e.what());
+        return;
+    }
+    if (loaded.spend_public_key != m_keys.spend_public_key) {
+        LogPrintf("MoneroWallet: Sync state %s belongs to another wallet, ignoring it\n", fs::PathToString(m_state_file));
+        return;
+    }
+    m_state = std::move(loaded);
+    LogPrintf("MoneroWallet: Resuming sync at height %d with %d outputs\n", m_state.next_height, m_state.outputs.size());
+}
+
+void MoneroLightWallet::SaveState() const {
+    if (m_state_file.empty()) {
+        return;
+    }
+
+    const fs::path tmp = m_state_file + ".new";
+    AutoFile file{fsbridge::fopen(tmp, "wb")};
+    if (file.IsNull()) {
+        LogPrintf("MoneroWallet: Cannot write sync state %s\n", fs::PathToString(tmp));
+        return;
+    }
+    try {
+        file << m_state;
+    } catch (const std::exception& e) {
+        LogPrintf("MoneroWallet: Writing sync state failed: %s\n", e.what());
+        return;
+    }
+    if (!file.Commit() || file.fclose() != 0 || !RenameOver(tmp, m_state_file)) {
+        LogPrintf("MoneroWallet: Saving sync state %s failed\n", fs::PathToString(m_state_file));
+    }
+}
+
+void MoneroLightWallet::SetRestoreHeight(uint64_t height) {
+    LOCK(m_state_mutex);
+    // Height 0 is the genesis block, which get_blocks.bin cannot start from
+    m_restore_height = std::max<uint64_t>(height, 1);
+    m_state_loaded = false;
+}
+
+void MoneroLightWallet::SetStateFile(const fs::path& path) {
+    LOCK(m_state_mutex);
+    m_state_file = path;
+    m_state_loaded = false;
+}
+
+uint64_t MoneroLightWallet::GetScannedHeight() const {
+    LOCK(m_state_mutex);
+    return m_state_loaded ? m_state.next_height : m_restore_height;
+}
+
+MoneroBalance MoneroLightWallet::GetSyncedBalance() const {
+    MoneroBalance balance{};
+    const int64_t now = GetTime();
+
+    LOCK(m_state_mutex);
+    balance.balance = m_state.total;
+    for (const MoneroOutput& output : m_state.outputs) {
+        bool unlocked = output.block_height + MONERO_SPENDABLE_AGE <= m_state.chain_height;
+        if (output.unlock_time != 0) {
+            unlocked &= output.unlock_time < MONERO_MAX_BLOCK_NUMBER
+                ? output.unlock_time <= m_state.chain_height
+                : int64_t(output.unlock_time) <= now;
+        }
+        if (unlocked) balance.unlocked_balance += output.amount;
+        balance.outputs.push_back(output);
+    }
+    return balance;
+}
+
 // ============================================================================
 // Private Methods
 // ============================================================================
@@ -418,18 +788,7 @@ bool MoneroLightWallet::DecodeAddress(const std::string& address,
 
 std::array<uint8_t, 32> MoneroLightWallet::Keccak256(const void* data, size_t len) {
     std::array<uint8_t, 32> hash;
-
-    // Use the keccak function if available, otherwise fall back to SHA256
-    // In production, must use actual Keccak-256 (not SHA3-256!)
-#ifdef HAVE_KECCAK
-    keccak((const uint8_t*)data, len, hash.data(), 32);
-#else
-    // Fallback: use SHA256 (not cryptographically equivalent, but functional for testing)
-    CSHA256 hasher;
-    hasher.Write((const uint8_t*)data, len);
-    hasher.Finalize(hash.data());
-#endif
-
+    ::Keccak256({static_cast<const uint8_t*>(data), len}, hash);
     return hash;
 }
 
@@ -438,6 +797,19 @@ void MoneroLightWallet::ScalarReduce(MoneroSecretKey& key) {
 }
 
 std::string MoneroLightWallet::DaemonRPC(const std::string& method, const std::string& params) {
+    // Build JSON-RPC request
+    std::ostringstream body;
+    body << "{\"jsonrpc\":\"2.0\",\"id\":\"0\",\"method\":\"" << method << "\"";
+    if (!params.empty()) {
+        body << ",\"params\":" << params;
+    }
+    body << "}";
+
+    return DaemonPost("/json_rpc", "application/json", body.str());
+}
+
+std::string MoneroLightWallet::DaemonPost(const std::string& path, const std::string& content_type,
+                                          const std::string& body) {
     int sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock < 0) return "";
 
@@ -463,35 +835,26 @@ std::string MoneroLightWallet::DaemonRPC(const std::string& method, const std::s
         return "";
     }
 
-    // Build JSON-RPC request
-    std::ostringstream body;
-    body << "{\"jsonrpc\":\"2.0\",\"id\":\"0\",\"method\":\"" << method << "\"";
-    if (!params.empty()) {
-        body << ",\"params\":" << params;
-    }
-    body << "}";
-    std::string body_str = body.str();
-
     std::ostringstream request;
-    request << "POST /json_rpc HTTP/1.1\r\n";
+    request << "POST " << path << " HTTP/1.1\r\n";
     request << "Host: " << m_daemon_host << ":" << m_daemon_port << "\r\n";
-    request << "Content-Type: application/json\r\n";
-    request << "Content-Length: " << body_str.length() << "\r\n";
+    request << "Content-Type: " << content_type << "\r\n";
+    request << "Content-Length: " << body.length() << "\r\n";
     request << "Connection: close\r\n\r\n";
-    request << body_str;
+    request << body;
 
     std::string req_str = request.str();
-    if (send(sock, req_str.c_str(), req_str.length(), 0) < 0) {
+    if (send(sock, req_str.data(), req_str.length(), 0) < 0) {
         close(sock);
         return "";
     }
 
+    // Binary endpoints return bytes of any value, so append by length
     std::string response;
-    char buffer[4096];
+    char buffer[16384];
     ssize_t bytes;
-    while ((bytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes] = '\0';
-        response += buffer;
+    while ((bytes = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, bytes);
     }
 
     close(sock);
@@ -499,6 +862,9 @@ std::string MoneroLightWallet::DaemonRPC(const std::string& method, const std::s
     // Extract body
     size_t body_start = response.find("\r\n\r\n");
     if (body_start != std::string::npos) {
+        if (response.compare(0, 12, "HTTP/1.1 200") != 0 && response.compare(0, 12, "HTTP/1.0 200") != 0) {
+            return "";
+        }
         return response.substr(body_start + 4);
     }
 
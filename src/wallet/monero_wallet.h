@@ -5,9 +5,16 @@
 #ifndef WATTX_MONERO_WALLET_H
 #define WATTX_MONERO_WALLET_H
 
+#include <serialize.h>
+#include <sync.h>
+#include <util/fs.h>
+#include <wallet/monero_sync.h>
+
 #include <array>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -60,11 +67,18 @@ struct MoneroAddress {
  */
 struct MoneroOutput {
     std::string tx_hash;
-    uint64_t output_index;
-    uint64_t amount;
-    uint64_t block_height;
-    bool spent;
-    MoneroPublicKey output_public_key;
+    uint64_t output_index{0};
+    uint64_t amount{0};
+    uint64_t block_height{0};
+    uint64_t unlock_time{0};
+    bool spent{false};
+    MoneroPublicKey output_public_key{};
+
+    SERIALIZE_METHODS(MoneroOutput, obj)
+    {
+        READWRITE(obj.tx_hash, obj.output_index, obj.amount, obj.block_height, obj.unlock_time, obj.spent,
+                  obj.output_public_key);
+    }
 };
 
 /**
@@ -77,6 +91,15 @@ struct MoneroBalance {
     std::vector<MoneroOutput> outputs;
 };
 
+//! Blocks asked for per get_blocks.bin request while syncing
+static constexpr uint64_t MONERO_SYNC_BATCH_BLOCKS = 200;
+//! Block prev_ids kept to notice reorgs; a deeper reorg rescans the whole window
+static constexpr uint64_t MONERO_SYNC_REORG_WINDOW = 720;
+//! Confirmations before a received output can be spent
+static constexpr uint64_t MONERO_SPENDABLE_AGE = 10;
+//! unlock_time values below this are block heights, above it timestamps
+static constexpr uint64_t MONERO_MAX_BLOCK_NUMBER = 500000000;
+
 /**
  * Light Monero Wallet for WATTx
  *
@@ -138,11 +161,43 @@ public:
     void SetDaemonConnection(const std::string& host, uint16_t port);
 
     /**
-     * Query balance from Monero daemon
-     * Note: This is a simplified light wallet query, not full wallet sync
+     * Sync with the daemon, then report the balance of the outputs found
      */
     bool QueryBalance(MoneroBalance& balance);
 
+    /**
+     * Bring the wallet up to the daemon's tip through get_blocks.bin
+     *
+     * Blocks are pulled in batches from the scanned-height cursor. The next
+     * batch is fetched while the current one is scanned with the view key on
+     * several threads, and found outputs update the balance as each batch is
+     * applied. Every request re-reads the last scanned block, so a reorg is
+     * noticed and the replaced blocks are rescanned. With a state file set,
+     * the cursor and outputs are saved after each batch.
+     */
+    bool Sync();
+
+    /**
+     * Height a wallet without sync state starts scanning from
+     */
+    void SetRestoreHeight(uint64_t height);
+
+    /**
+     * File keeping the sync cursor and found outputs across restarts; it is
+     * read on the next Sync()
+     */
+    void SetStateFile(const fs::path& path);
+
+    /**
+     * Next block height Sync() will scan
+     */
+    uint64_t GetScannedHeight() const;
+
+    /**
+     * Balance of the outputs found so far, without contacting the daemon
+     */
+    MoneroBalance GetSyncedBalance() const;
+
     /**
      * Get mnemonic seed (25 words)
      */
@@ -191,12 +246,57 @@ private:
     // HTTP RPC call to daemon
     std::string DaemonRPC(const std::string& method, const std::string& params);
 
+    // HTTP POST to the daemon, returning the response body ("" on failure)
+    std::string DaemonPost(const std::string& path, const std::string& content_type, const std::string& body);
+
+    // View key and spend public key in decoded form, shared by the scan threads
+    struct ScanContext;
+    // Blocks and transaction blobs returned by one get_blocks.bin call
+    struct BlockBatch;
+
+    ScanContext MakeScanContext() const;
+    bool FetchBlocks(uint64_t start_height, BlockBatch& batch);
+    static bool ScanBlock(const ScanContext& ctx, const std::string& block_blob,
+                          const std::vector<std::string>& tx_blobs, uint64_t height,
+                          MoneroHash& prev_id, std::vector<MoneroOutput>& found);
+    static void ScanTransaction(const ScanContext& ctx, const MoneroTx& tx, const std::string& tx_hash,
+                                uint64_t height, std::vector<MoneroOutput>& found);
+
+    /**
+     * What Sync() has learned about the chain, saved to the state file
+     */
+    struct SyncState {
+        MoneroPublicKey spend_public_key{};      // wallet the state belongs to
+        uint64_t next_height{0};                 // first block not yet scanned
+        uint64_t chain_height{0};                // daemon block count at the last sync
+        std::map<uint64_t, MoneroHash> prev_ids; // height -> prev_id of that block
+        std::vector<MoneroOutput> outputs;       // in chain order
+        uint64_t total{0};                       // sum of outputs[].amount
+
+        SERIALIZE_METHODS(SyncState, obj)
+        {
+            READWRITE(obj.spend_public_key, obj.next_height, obj.chain_height, obj.prev_ids, obj.outputs, obj.total);
+        }
+    };
+
+    void LoadState() EXCLUSIVE_LOCKS_REQUIRED(m_state_mutex);
+    void SaveState() const EXCLUSIVE_LOCKS_REQUIRED(m_state_mutex);
+    void RollBack(uint64_t height) EXCLUSIVE_LOCKS_REQUIRED(m_state_mutex);
+
     MoneroAccountKeys m_keys;
     MoneroNetworkType m_network{MoneroNetworkType::MAINNET};
     bool m_initialized{false};
 
     std::string m_daemon_host;
     uint16_t m_daemon_port{18081};
+
+    // Held for a whole Sync(); m_state_mutex only while the state is touched
+    Mutex m_sync_mutex;
+    mutable Mutex m_state_mutex;
+    SyncState m_state GUARDED_BY(m_state_mutex);
+    bool m_state_loaded GUARDED_BY(m_state_mutex){false};
+    uint64_t m_restore_height GUARDED_BY(m_state_mutex){1};
+    fs::path m_state_file GUARDED_BY(m_state_mutex);
 };
 
 /**
@@ -0,0 +1,42 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_WALLET_PRIVACY_RESCAN_H
+#define WATTX_WALLET_PRIVACY_RESCAN_H
+
+#include <functional>
+#include <memory>
+
+class CBlock;
+
+namespace wallet {
+
+class WalletBatch;
+
+/**
+ * Applies what a detector found in one block. Commits run on a single thread
+ * in chain order, so they may update wallet state and write to the batch.
+ */
+using PrivacyBlockCommit = std::function<void(WalletBatch& batch)>;
+
+/**
+ * One kind of privacy output detection taking part in
+ * CWallet::ScanForPrivacyOutputs().
+ *
+ * The rescan reads each block once and hands it to every detector. ScanBlock()
+ * is called for different blocks on several threads at once and must not
+ * change wallet state: it does the expensive trial decoding and returns the
+ * findings as a commit, or nullptr when the block holds nothing for us.
+ */
+class PrivacyBlockDetector
+{
+public:
+    virtual ~PrivacyBlockDetector() = default;
+
+    virtual PrivacyBlockCommit ScanBlock(const std::shared_ptr<const CBlock>& block, int height) const = 0;
+};
+
+} // namespace wallet
+
+#endif // WATTX_WALLET_PRIVACY_RESCAN_H
@@ -11,6 +11,8 @@
 #include <random.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
+
 namespace wallet {
 
 CPrivacyWalletManager::CPrivacyWalletManager(CWallet* wallet)
@@ -323,6 +325,69 @@ privacy::CKeyImage CPrivacyWalletManager::GenerateKeyImage(const CKey& privKey)
     return keyImage;
 }
 
+std::optional<CAmount> CPrivacyWalletManager::GetConfidentialAmount(
+    const COutPoint& outpoint,
+    const privacy::CPrivacyOutput& output,
+    const std::vector<CStealthAddressData>& addresses)
+{
+    // Identify the scan keys, so a negative entry made with other keys is redone
+    std::vector<CPubKey> scanPubKeys;
+    for (const auto& addr : addresses) {
+        scanPubKeys.push_back(addr.address.scanPubKey);
+    }
+    std::sort(scanPubKeys.begin(), scanPubKeys.end());
+    HashWriter keyset;
+    keyset << scanPubKeys;
+    const uint256 keysetHash = keyset.GetHash();
+
+    {
+        LOCK(cs_privacy);
+        if (!m_amountCacheLoaded) {
+            if (m_wallet && !WalletBatch(m_wallet->GetDatabase()).ReadConfidentialAmounts(m_amountCache)) {
+                LogPrintf("Privacy wallet manager: failed to read confidential amount cache\n");
+            }
+            m_amountCacheLoaded = true;
+        }
+        auto it = m_amountCache.find(outpoint);
+        if (it != m_amountCache.end()) {
+            if (it->second.fMine) {
+                return it->second.nAmount;
+            }
+            if (it->second.keysetHash == keysetHash) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // Not cached: one ECDH per address until one matches
+    CConfidentialAmountEntry entry;
+    for (const auto& addr : addresses) {
+        CKey unused;
+        uint256 sharedSecretHash;
+        if (!privacy::ScanStealthOutput(output.stealthOutput, addr.scanPrivKey, addr.address.spendPubKey,
+                                        unused, &sharedSecretHash)) {
+            continue;
+        }
+        CAmount amount;
+        if (privacy::DecryptAmount(output.confidentialOutput.encryptedAmount, sharedSecretHash, amount) &&
+            MoneyRange(amount)) {
+            entry.fMine = true;
+            entry.nAmount = amount;
+        }
+        break;
+    }
+    if (!entry.fMine) {
+        entry.keysetHash = keysetHash;
+    }
+
+    LOCK(cs_privacy);
+    m_amountCache[outpoint] = entry;
+    if (m_wallet && !WalletBatch(m_wallet->GetDatabase()).WriteConfidentialAmount(outpoint, entry)) {
+        LogPrintf("Privacy wallet manager: failed to write confidential amount for %s\n", outpoint.ToString());
+    }
+    return entry.fMine ? std::optional<CAmount>{entry.nAmount} : std::nullopt;
+}
+
 bool CPrivacyWalletManager::Load()
 {
     // Stub - would load from wallet database
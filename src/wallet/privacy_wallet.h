@@ -124,6 +124,20 @@ public:
     //! Generate key image for an output
     privacy::CKeyImage GenerateKeyImage(const CKey& privKey) const;
 
+    /**
+     * Amount of a confidential output if it pays one of the given stealth
+     * addresses, nullopt if it does not.
+     *
+     * The outcome is cached by outpoint and written to the wallet database,
+     * outputs that are not ours included, so rescans and balance queries run
+     * the ECDH and decryption once per output. A negative entry is redone
+     * only when the scan keys have changed since it was made.
+     */
+    std::optional<CAmount> GetConfidentialAmount(
+        const COutPoint& outpoint,
+        const privacy::CPrivacyOutput& output,
+        const std::vector<CStealthAddressData>& addresses);
+
     //! Load from wallet
     bool Load();
 
@@ -140,6 +154,10 @@ private:
     // Key images we've generated (hash -> outpoint)
     std::map<uint256, COutPoint> m_keyImages GUARDED_BY(cs_privacy);
 
+    // Examined confidential outputs (outpoint -> amount or not ours), loaded on first use
+    std::map<COutPoint, CConfidentialAmountEntry> m_amountCache GUARDED_BY(cs_privacy);
+    bool m_amountCacheLoaded GUARDED_BY(cs_privacy){false};
+
     //! Select inputs for transaction
     bool SelectInputs(
         CAmount targetAmount,
@@ -2,12 +2,16 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chainparams.h>
 #include <consensus/amount.h>
 #include <consensus/consensus.h>
 #include <wallet/receive.h>
 #include <wallet/transaction.h>
 #include <wallet/wallet.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace wallet {
 isminetype InputIsMine(const CWallet& wallet, const CTxIn& txin)
 {
@@ -301,18 +305,55 @@ bool CachedTxIsTrusted(const CWallet& wallet, const CWalletTx& wtx)
     return CachedTxIsTrusted(wallet, wtx, trusted_parents);
 }
 
+//! Snapshots of the wallet, if a snapshot is still current
+static BalanceSnapshots& GetBalanceSnapshots(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+    if (!wallet.m_balance_snapshots) wallet.m_balance_snapshots = std::make_shared<BalanceSnapshots>();
+    return *wallet.m_balance_snapshots;
+}
+
+template <typename T>
+static bool IsSnapshotCurrent(const CWallet& wallet, const BalanceSnapshots::Snapshot<T>& snapshot) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+    return snapshot.epoch == wallet.GetBalanceEpoch() && wallet.GetLastBlockHeight() < snapshot.stale_height;
+}
+
+//! Lower stale_height to the tip height at which an immature transaction matures
+static void UpdateMaturityStaleHeight(const CWallet& wallet, const CWalletTx& wtx, int& stale_height) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+    const int blocks_to_maturity{wallet.GetTxBlocksToMaturity(wtx)};
+    if (blocks_to_maturity <= 0) return;
+    const int tip_height{wallet.GetLastBlockHeight()};
+    stale_height = std::min(stale_height, tip_height + blocks_to_maturity);
+    // The maturity itself changes once
+    const int maturity_change{Params().GetConsensus().nReduceBlocktimeHeight - 1};
+    if (tip_height < maturity_change) stale_height = std::min(stale_height, maturity_change);
+}
+
 Balance GetBalance(const CWallet& wallet, const int min_depth, bool avoid_reuse)
 {
     Balance ret;
     isminefilter reuse_filter = avoid_reuse ? ISMINE_NO : ISMINE_USED;
     {
         LOCK(wallet.cs_wallet);
+        BalanceSnapshots& snapshots{GetBalanceSnapshots(wallet)};
+        const auto cached{snapshots.balances.find({min_depth, avoid_reuse})};
+        if (cached != snapshots.balances.end() && IsSnapshotCurrent(wallet, cached->second)) return cached->second.result;
+
+        int stale_height{std::numeric_limits<int>::max()};
         std::set<uint256> trusted_parents;
         for (const auto& entry : wallet.mapWallet)
         {
             const CWalletTx& wtx = entry.second;
             const bool is_trusted{CachedTxIsTrusted(wallet, wtx, trusted_parents)};
             const int tx_depth{wallet.GetTxDepthInMainChain(wtx)};
+            UpdateMaturityStaleHeight(wallet, wtx, stale_height);
+            if (tx_depth > 0 && tx_depth < min_depth) {
+                stale_height = std::min(stale_height, wallet.GetLastBlockHeight() + min_depth - tx_depth);
+            }
             const CAmount tx_credit_mine{CachedTxGetAvailableCredit(wallet, wtx, ISMINE_SPENDABLE | reuse_filter)};
             const CAmount tx_credit_watchonly{CachedTxGetAvailableCredit(wallet, wtx, ISMINE_WATCH_ONLY | reuse_filter)};
             if (is_trusted && tx_depth >= min_depth) {
@@ -328,6 +369,7 @@ Balance GetBalance(const CWallet& wallet, const int min_depth, bool avoid_reuse)
             ret.m_mine_stake += CachedTxGetStakeCredit(wallet, wtx, ISMINE_SPENDABLE);
             ret.m_watchonly_stake += CachedTxGetStakeCredit(wallet, wtx, ISMINE_WATCH_ONLY);
         }
+        snapshots.balances.insert_or_assign({min_depth, avoid_reuse}, BalanceSnapshots::Snapshot<Balance>{wallet.GetBalanceEpoch(), stale_height, ret});
     }
     return ret;
 }
@@ -338,6 +380,10 @@ std::map<CTxDestination, CAmount> GetAddressBalances(const CWallet& wallet)
 
     {
         LOCK(wallet.cs_wallet);
+        BalanceSnapshots& snapshots{GetBalanceSnapshots(wallet)};
+        if (snapshots.address_balances && IsSnapshotCurrent(wallet, *snapshots.address_balances)) return snapshots.address_balances->result;
+
+        int stale_height{std::numeric_limits<int>::max()};
         std::set<uint256> trusted_parents;
         for (const auto& walletEntry : wallet.mapWallet)
         {
@@ -346,8 +392,10 @@ std::map<CTxDestination, CAmount> GetAddressBalances(const CWallet& wallet)
             if (!CachedTxIsTrusted(wallet, wtx, trusted_parents))
                 continue;
 
-            if (wallet.IsTxImmature(wtx))
+            if (wallet.IsTxImmature(wtx)) {
+                UpdateMaturityStaleHeight(wallet, wtx, stale_height);
                 continue;
+            }
 
             int nDepth = wallet.GetTxDepthInMainChain(wtx);
             if (nDepth < (CachedTxIsFromMe(wallet, wtx, ISMINE_ALL) ? 0 : 1))
@@ -365,6 +413,7 @@ std::map<CTxDestination, CAmount> GetAddressBalances(const CWallet& wallet)
                 balances[addr] += n;
             }
         }
+        snapshots.address_balances = BalanceSnapshots::Snapshot<std::map<CTxDestination, CAmount>>{wallet.GetBalanceEpoch(), stale_height, balances};
     }
 
     return balances;
@@ -10,6 +10,10 @@
 #include <wallet/types.h>
 #include <wallet/wallet.h>
 
+#include <map>
+#include <optional>
+#include <utility>
+
 namespace wallet {
 isminetype InputIsMine(const CWallet& wallet, const CTxIn& txin) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
 
@@ -62,6 +66,25 @@ struct Balance {
 };
 Balance GetBalance(const CWallet& wallet, int min_depth = 0, bool avoid_reuse = true);
 
+/**
+ * Results of GetBalance() and GetAddressBalances(), reused while the wallet's
+ * balance epoch is unchanged and its tip is below the height at which one of
+ * the transactions matures or reaches the requested depth. Connecting blocks
+ * that do not touch the wallet then costs nothing.
+ */
+struct BalanceSnapshots {
+    template <typename T>
+    struct Snapshot {
+        uint64_t epoch;
+        //! Tip height at which the result goes out of date
+        int stale_height;
+        T result;
+    };
+    //! By min_depth and avoid_reuse
+    std::map<std::pair<int, bool>, Snapshot<Balance>> balances;
+    std::optional<Snapshot<std::map<CTxDestination, CAmount>>> address_balances;
+};
+
 std::map<CTxDestination, CAmount> GetAddressBalances(const CWallet& wallet);
 std::set<std::set<CTxDestination>> GetAddressGroupings(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
 } // namespace wallet
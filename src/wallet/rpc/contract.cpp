@@ -12,6 +12,7 @@
 #include <wallet/coincontrol.h>
 #include <wallet/spend.h>
 #include <wallet/receive.h>
+#include <qtum/evmcallpool.h>
 #include <qtum/qtumdelegation.h>
 #include <validation.h>
 #include <wallet/rpc/contract.h>
@@ -406,6 +407,138 @@ RPCHelpMan createcontract()
     };
 }
 
+/**
+ * Select the coin of the contract sender and return the address to sign
+ * OP_SENDER with, which is unset before QIP5.
+ */
+static CTxDestination SetContractSender(CWallet& wallet, CCoinControl& coinControl, bool fHasSender, const CTxDestination& senderAddress, bool fChangeToSender, int height)
+{
+    CTxDestination signSenderAddress = CNoDestination();
+    if(fHasSender){
+        // Find a UTXO with sender address
+        coinControl.m_allow_other_inputs = true;
+
+        std::vector<COutput> vecOutputs = AvailableCoins(wallet, &coinControl).All();
+
+        for (const COutput& out : vecOutputs) {
+
+            CTxDestination destAdress;
+            const CScript& scriptPubKey = out.txout.scriptPubKey;
+            bool fValidAddress = out.spendable && ExtractDestination(scriptPubKey, destAdress, nullptr, true);
+
+            if (!fValidAddress || senderAddress != destAdress)
+                continue;
+
+            coinControl.Select(out.outpoint);
+
+            break;
+
+        }
+
+        if(coinControl.HasSelected())
+        {
+            // Change to the sender
+            if(fChangeToSender){
+                coinControl.destChange=senderAddress;
+            }
+        }
+        else
+        {
+            // Create op sender transaction when op sender is activated
+            if(!(height >= Params().GetConsensus().QIP5Height))
+                throw JSONRPCError(RPC_TYPE_ERROR, "Sender address does not have any unspent outputs");
+        }
+
+        if(height >= Params().GetConsensus().QIP5Height)
+        {
+            // Set the sender address
+            signSenderAddress = senderAddress;
+        }
+    }
+    else
+    {
+        if(height >= Params().GetConsensus().QIP5Height)
+        {
+            // If no sender address provided set to the default sender address
+            SetDefaultSignSenderAddress(wallet, signSenderAddress, coinControl);
+        }
+    }
+
+    return signSenderAddress;
+}
+
+//! Prefix an OP_CALL or OP_CREATE script with the OP_SENDER of the address
+static CScript AddOpSender(CWallet& wallet, const CCoinControl& coinControl, const CTxDestination& signSenderAddress, const CScript& scriptPubKey)
+{
+    if(IsValidDestination(signSenderAddress))
+    {
+        if (!wallet.HasPrivateKey(signSenderAddress, coinControl.fAllowWatchOnly)) {
+            throw JSONRPCError(RPC_WALLET_ERROR, "Private key not available");
+        }
+        CKeyID key_id = wallet.GetKeyForDestination(signSenderAddress);
+        std::vector<unsigned char> scriptSig;
+        return (CScript() << CScriptNum(addresstype::PUBKEYHASH) << ToByteVector(key_id) << ToByteVector(scriptSig) << OP_SENDER) + scriptPubKey;
+    }
+
+    // OP_SENDER will always be used when QIP5Height is active
+    throw JSONRPCError(RPC_TYPE_ERROR, "Sender address fail to set for OP_SENDER.");
+}
+
+//! The PSBT, txid or raw transaction of a contract transaction, depending on the mode
+static UniValue ContractTxResult(CWallet& wallet, const CTransactionRef& tx, bool fPsbt, bool fBroadcast, const CTxDestination& txSenderDest)
+{
+    UniValue result(UniValue::VOBJ);
+
+    if(fPsbt){
+        // Make a blank psbt
+        PartiallySignedTransaction psbtx;
+        CMutableTransaction rawTx = CMutableTransaction(*tx);
+        psbtx.tx = rawTx;
+        for (unsigned int i = 0; i < rawTx.vin.size(); ++i) {
+            psbtx.inputs.push_back(PSBTInput());
+        }
+        for (unsigned int i = 0; i < rawTx.vout.size(); ++i) {
+            psbtx.outputs.push_back(GetPsbtOutput(rawTx.vout[i], wallet));
+        }
+
+        // Fill transaction with out data but don't sign
+        bool bip32derivs = true;
+        bool complete = true;
+        const auto err{wallet.FillPSBT(psbtx, complete, 1, false, bip32derivs)};
+        if (err) {
+            throw JSONRPCPSBTError(*err);
+        }
+
+        // Serialize the PSBT
+        DataStream ssTx;
+        ssTx << psbtx;
+        result.pushKV("psbt", EncodeBase64(ssTx.str()));
+
+        // Add sender information
+        CTxDestination txSenderAdress(txSenderDest);
+        CKeyID keyid = wallet.GetKeyForDestination(txSenderAdress);
+        result.pushKV("sender", EncodeDestination(txSenderAdress));
+        result.pushKV("hash160", HexStr(valtype(keyid.begin(),keyid.end())));
+    }
+    else if(fBroadcast){
+        wallet.CommitTransaction(tx, {}, {});
+
+        std::string txId=tx->GetHash().GetHex();
+        result.pushKV("txid", txId);
+
+        CTxDestination txSenderAdress(txSenderDest);
+        CKeyID keyid = wallet.GetKeyForDestination(txSenderAdress);
+
+        result.pushKV("sender", EncodeDestination(txSenderAdress));
+        result.pushKV("hash160", HexStr(valtype(keyid.begin(),keyid.end())));
+    }else{
+        std::string strHex = EncodeHexTx(*tx);
+        result.pushKV("raw transaction", strHex);
+    }
+
+    return result;
+}
+
 UniValue SendToContract(CWallet& wallet, const UniValue& params, ChainstateManager& chainman)
 {
     uint64_t blockGasLimit = 0, minGasPrice = 0;
@@ -488,56 +621,7 @@ UniValue SendToContract(CWallet& wallet, const UniValue& params, ChainstateManag
     CCoinControl coinControl;
     if(fPsbt) coinControl.fAllowWatchOnly = true;
 
-    CTxDestination signSenderAddress = CNoDestination();
-    if(fHasSender){
-        // Find a UTXO with sender address
-        coinControl.m_allow_other_inputs = true;
-
-        std::vector<COutput> vecOutputs = AvailableCoins(wallet, &coinControl).All();
-
-        for (const COutput& out : vecOutputs) {
-
-            CTxDestination destAdress;
-            const CScript& scriptPubKey = out.txout.scriptPubKey;
-            bool fValidAddress = out.spendable && ExtractDestination(scriptPubKey, destAdress, nullptr, true);
-
-            if (!fValidAddress || senderAddress != destAdress)
-                continue;
-
-            coinControl.Select(out.outpoint);
-
-            break;
-
-        }
-
-        if(coinControl.HasSelected())
-        {
-            // Change to the sender
-            if(fChangeToSender){
-                coinControl.destChange=senderAddress;
-            }
-        }
-        else
-        {
-            // Create op sender transaction when op sender is activated
-            if(!(height >= Params().GetConsensus().QIP5Height))
-                throw JSONRPCError(RPC_TYPE_ERROR, "Sender address does not have any unspent outputs");
-        }
-
-        if(height >= Params().GetConsensus().QIP5Height)
-        {
-            // Set the sender address
-            signSenderAddress = senderAddress;
-        }
-    }
-    else
-    {
-        if(height >= Params().GetConsensus().QIP5Height)
-        {
-            // If no sender address provided set to the default sender address
-            SetDefaultSignSenderAddress(wallet, signSenderAddress, coinControl);
-        }
-    }
+    CTxDestination signSenderAddress = SetContractSender(wallet, coinControl, fHasSender, senderAddress, fChangeToSender, height);
 
     EnsureWalletIsUnlocked(wallet);
 
@@ -561,22 +645,7 @@ UniValue SendToContract(CWallet& wallet, const UniValue& params, ChainstateManag
     // Build OP_EXEC_ASSIGN script
     CScript scriptPubKey = CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(nGasLimit) << CScriptNum(nGasPrice) << ParseHex(datahex) << ParseHex(contractaddress) << OP_CALL;
     if(height >= Params().GetConsensus().QIP5Height)
-    {
-        if(IsValidDestination(signSenderAddress))
-        {
-            if (!wallet.HasPrivateKey(signSenderAddress, coinControl.fAllowWatchOnly)) {
-                throw JSONRPCError(RPC_WALLET_ERROR, "Private key not available");
-            }
-            CKeyID key_id = wallet.GetKeyForDestination(signSenderAddress);
-            std::vector<unsigned char> scriptSig;
-            scriptPubKey = (CScript() << CScriptNum(addresstype::PUBKEYHASH) << ToByteVector(key_id) << ToByteVector(scriptSig) << OP_SENDER) + scriptPubKey;
-        }
-        else
-        {
-            // OP_SENDER will always be used when QIP5Height is active
-            throw JSONRPCError(RPC_TYPE_ERROR, "Sender address fail to set for OP_SENDER.");
-        }
-    }
+        scriptPubKey = AddOpSender(wallet, coinControl, signSenderAddress, scriptPubKey);
 
     // Create and send the transaction
     std::vector<CRecipient> vecSend;
@@ -597,55 +666,197 @@ UniValue SendToContract(CWallet& wallet, const UniValue& params, ChainstateManag
         throw JSONRPCError(RPC_TYPE_ERROR, "Sender could not be set, transaction was not committed!");
     }
 
-    UniValue result(UniValue::VOBJ);
+    return ContractTxResult(wallet, tx, fPsbt, fBroadcast, txSenderDest);
+}
 
-    if(fPsbt){
-        // Make a blank psbt
-        PartiallySignedTransaction psbtx;
-        CMutableTransaction rawTx = CMutableTransaction(*tx);
-        psbtx.tx = rawTx;
-        for (unsigned int i = 0; i < rawTx.vin.size(); ++i) {
-            psbtx.inputs.push_back(PSBTInput());
-        }
-        for (unsigned int i = 0; i < rawTx.vout.size(); ++i) {
-            psbtx.outputs.push_back(GetPsbtOutput(rawTx.vout[i], wallet));
+/**
+ * Send several contract calls in one transaction.
+ *
+ * Every call is an OP_CALL output of the same transaction, so they share one
+ * coin selection, one set of input signatures and one change output, and the
+ * gas fee of the whole batch is paid from the same inputs. The gas limit of
+ * the calls that have none is estimated on one snapshot of the tip state, the
+ * same one the contract addresses are checked against.
+ */
+UniValue SendManyToContract(CWallet& wallet, const UniValue& params, ChainstateManager& chainman)
+{
+    uint64_t blockGasLimit = 0, minGasPrice = 0;
+    CAmount nGasPrice = 0;
+    int height = 0;
+    getDgpData(blockGasLimit, minGasPrice, nGasPrice, &height, &chainman);
+
+    const UniValue& calls = params[0].get_array();
+    if (calls.empty())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "No contract calls");
+
+    if (!params[1].isNull()){
+        nGasPrice = AmountFromValue(params[1]);
+        if (nGasPrice <= 0)
+            throw JSONRPCError(RPC_TYPE_ERROR, "Invalid value for gasPrice");
+        CAmount maxRpcGasPrice = gArgs.GetIntArg("-rpcmaxgasprice", MAX_RPC_GAS_PRICE);
+        if (nGasPrice > (int64_t)maxRpcGasPrice)
+            throw JSONRPCError(RPC_TYPE_ERROR, "Invalid value for gasPrice, Maximum allowed in RPC calls is: "+FormatMoney(maxRpcGasPrice)+" (use -rpcmaxgasprice to change it)");
+        if (nGasPrice < (int64_t)minGasPrice)
+            throw JSONRPCError(RPC_TYPE_ERROR, "Invalid value for gasPrice (Minimum is: "+FormatMoney(minGasPrice)+")");
+    }
+
+    bool fHasSender=false;
+    CTxDestination senderAddress;
+    if (!params[2].isNull()){
+        senderAddress = DecodeDestination(params[2].get_str());
+        if (!IsValidDestination(senderAddress))
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid Qtum address to send from");
+        if (!IsValidContractSenderAddress(senderAddress))
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid contract sender address. Only P2PK and P2PKH allowed");
+        else
+            fHasSender=true;
+    }
+
+    bool fBroadcast=true;
+    if (!params[3].isNull()){
+        fBroadcast=params[3].get_bool();
+    }
+
+    bool fChangeToSender=true;
+    if (!params[4].isNull()){
+        fChangeToSender=params[4].get_bool();
+    }
+
+    bool fPsbt=wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
+    if (!params[5].isNull()){
+        fPsbt=params[5].get_bool();
+    }
+    if(fPsbt) fBroadcast=false;
+
+    CCoinControl coinControl;
+    if(fPsbt) coinControl.fAllowWatchOnly = true;
+
+    CTxDestination signSenderAddress = SetContractSender(wallet, coinControl, fHasSender, senderAddress, fChangeToSender, height);
+
+    // All the calls are checked and estimated against the same state
+    std::shared_ptr<const EvmStateSnapshot> snapshot = GetEvmCallPool().GetSnapshot(chainman.ActiveChainstate());
+    if (!snapshot)
+        throw JSONRPCError(RPC_MISC_ERROR, "Contract state not available");
+    std::unique_ptr<QtumState> state = snapshot->MakeState();
+
+    struct ContractCall {
+        std::string contractaddress;
+        std::vector<unsigned char> data;
+        CAmount nAmount{0};
+        uint64_t nGasLimit{0};
+    };
+    std::vector<ContractCall> vecCalls;
+    uint64_t nTotalGas = 0;
+    for (size_t i = 0; i < calls.size(); ++i) {
+        const UniValue& call = calls[i].get_obj();
+        RPCTypeCheckObj(call,
+            {
+                {"contractaddress", UniValueType(UniValue::VSTR)},
+                {"datahex", UniValueType(UniValue::VSTR)},
+                {"amount", UniValueType()},
+                {"gaslimit", UniValueType(UniValue::VNUM)},
+            }, true, true);
+
+        ContractCall entry;
+        if (!NormalizeEvmAddress(call["contractaddress"].get_str(), entry.contractaddress))
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Incorrect contract address (expected 40 hex chars, with optional 0x prefix)");
+        if (!state->addressInUse(dev::Address(entry.contractaddress)))
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "contract address does not exist: " + entry.contractaddress);
+
+        std::string datahex = call["datahex"].get_str();
+        if(datahex.size() % 2 != 0 || !CheckHex(datahex))
+            throw JSONRPCError(RPC_TYPE_ERROR, "Invalid data (data not hex)");
+        entry.data = ParseHex(datahex);
+
+        if (!call["amount"].isNull()){
+            entry.nAmount = AmountFromValue(call["amount"]);
+            if (entry.nAmount < 0)
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid amount for send");
         }
 
-        // Fill transaction with out data but don't sign
-        bool bip32derivs = true;
-        bool complete = true;
-        const auto err{wallet.FillPSBT(psbtx, complete, 1, false, bip32derivs)};
-        if (err) {
-            throw JSONRPCPSBTError(*err);
+        if (!call["gaslimit"].isNull()){
+            entry.nGasLimit = call["gaslimit"].getInt<int64_t>();
+            if (entry.nGasLimit > blockGasLimit)
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid value for gasLimit (Maximum is: "+i64tostr(blockGasLimit)+")");
+            if (entry.nGasLimit < MINIMUM_GAS_LIMIT)
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid value for gasLimit (Minimum is: "+i64tostr(MINIMUM_GAS_LIMIT)+")");
+            nTotalGas += entry.nGasLimit;
         }
+        vecCalls.push_back(std::move(entry));
+    }
+
+    // Estimate the missing gas limits within what the block has left
+    dev::Address estimateSender;
+    if (IsValidDestination(signSenderAddress) || fHasSender) {
+        CKeyID keyid = wallet.GetKeyForDestination(IsValidDestination(signSenderAddress) ? signSenderAddress : senderAddress);
+        estimateSender = dev::Address(HexStr(valtype(keyid.begin(), keyid.end())));
+    }
+    const uint64_t nMinGasLimit = std::max<uint64_t>(MINIMUM_GAS_LIMIT, gArgs.GetIntArg("-minmempoolgaslimit", MEMPOOL_MIN_GAS_LIMIT));
+    for (ContractCall& entry : vecCalls) {
+        if (entry.nGasLimit != 0) continue;
+        if (nTotalGas >= blockGasLimit)
+            throw JSONRPCError(RPC_TYPE_ERROR, "Total gasLimit of the calls exceeds the block gas limit ("+i64tostr(blockGasLimit)+")");
+        EvmGasEstimate estimate = GetEvmCallPool().EstimateGas(*snapshot, dev::Address(entry.contractaddress), entry.data, estimateSender, blockGasLimit - nTotalGas, entry.nAmount);
+        if (!estimate.success) {
+            if (estimate.capResult.excepted == dev::eth::TransactionException::RevertInstruction)
+                throw JSONRPCError(RPC_MISC_ERROR, "Call to " + entry.contractaddress + " reverted: 0x" + HexStr(estimate.capResult.output));
+            throw JSONRPCError(RPC_MISC_ERROR, strprintf("Call to %s requires more gas than the block has left (%d)", entry.contractaddress, estimate.gas));
+        }
+        entry.nGasLimit = std::max(estimate.gas, nMinGasLimit);
+        nTotalGas += entry.nGasLimit;
+    }
+    if (nTotalGas > blockGasLimit)
+        throw JSONRPCError(RPC_TYPE_ERROR, "Total gasLimit of the calls exceeds the block gas limit ("+i64tostr(blockGasLimit)+")");
 
-        // Serialize the PSBT
-        DataStream ssTx;
-        ssTx << psbtx;
-        result.pushKV("psbt", EncodeBase64(ssTx.str()));
+    EnsureWalletIsUnlocked(wallet);
 
-        // Add sender information
-        CTxDestination txSenderAdress(txSenderDest);
-        CKeyID keyid = wallet.GetKeyForDestination(txSenderAdress);
-        result.pushKV("sender", EncodeDestination(txSenderAdress));
-        result.pushKV("hash160", HexStr(valtype(keyid.begin(),keyid.end())));
+    CAmount nGasFee=nGasPrice*nTotalGas;
+    CAmount nAmount=0;
+    for (const ContractCall& entry : vecCalls) nAmount += entry.nAmount;
+
+    const auto bal = GetBalance(wallet);
+    CAmount curBalance = bal.m_mine_trusted;
+    if(fPsbt) curBalance += bal.m_watchonly_trusted;
+
+    // Check amount
+    if (nGasFee <= 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid amount for gas fee");
+
+    if (nAmount+nGasFee > curBalance)
+        throw JSONRPCError(RPC_WALLET_INSUFFICIENT_FUNDS, "Insufficient funds");
+
+    // Select default coin that will pay for the contract if none selected
+    if(!coinControl.HasSelected() && !SetDefaultPayForContractAddress(wallet, coinControl))
+        throw JSONRPCError(RPC_TYPE_ERROR, "Does not have any P2PK or P2PKH unspent outputs to pay for the contract.");
+
+    // Build one OP_EXEC_ASSIGN output per call
+    std::vector<CRecipient> vecSend;
+    UniValue gasLimits(UniValue::VARR);
+    for (const ContractCall& entry : vecCalls) {
+        CScript scriptPubKey = CScript() << CScriptNum(VersionVM::GetEVMDefault().toRaw()) << CScriptNum(entry.nGasLimit) << CScriptNum(nGasPrice) << entry.data << ParseHex(entry.contractaddress) << OP_CALL;
+        if(height >= Params().GetConsensus().QIP5Height)
+            scriptPubKey = AddOpSender(wallet, coinControl, signSenderAddress, scriptPubKey);
+        vecSend.push_back({CNoDestination(scriptPubKey), entry.nAmount, false});
+        gasLimits.push_back(entry.nGasLimit);
     }
-    else if(fBroadcast){
-        wallet.CommitTransaction(tx, {}, {});
 
-        std::string txId=tx->GetHash().GetHex();
-        result.pushKV("txid", txId);
+    // Create and send the transaction
+    bool sign = !fPsbt;
+    auto res = CreateTransaction(wallet, vecSend,  std::nullopt, coinControl, sign, nGasFee, true, signSenderAddress);
+    if (!res) {
+        throw JSONRPCError(RPC_WALLET_ERROR, util::ErrorString(res).original);
+    }
+    CTransactionRef tx = res->tx;
 
-        CTxDestination txSenderAdress(txSenderDest);
-        CKeyID keyid = wallet.GetKeyForDestination(txSenderAdress);
+    CTxDestination txSenderDest;
+    wallet.GetSenderDest(*tx, txSenderDest, sign);
 
-        result.pushKV("sender", EncodeDestination(txSenderAdress));
-        result.pushKV("hash160", HexStr(valtype(keyid.begin(),keyid.end())));
-    }else{
-        std::string strHex = EncodeHexTx(*tx);
-        result.pushKV("raw transaction", strHex);
+    if (fHasSender && !(senderAddress == txSenderDest)){
+        throw JSONRPCError(RPC_TYPE_ERROR, "Sender could not be set, transaction was not committed!");
     }
 
+    UniValue result = ContractTxResult(wallet, tx, fPsbt, fBroadcast, txSenderDest);
+    result.pushKV("gaslimits", gasLimits);
     return result;
 }
 
@@ -862,6 +1073,81 @@ RPCHelpMan sendtocontract()
     };
 }
 
+RPCHelpMan sendmanytocontract()
+{
+    uint64_t blockGasLimit = 0, minGasPrice = 0;
+    CAmount nGasPrice = 0;
+    getDgpData(blockGasLimit, minGasPrice, nGasPrice);
+
+    return RPCHelpMan{"sendmanytocontract",
+                    "\nSend funds and data to several contracts in one transaction.\n"
+                    "The calls execute in order and share the inputs, change and sender of the transaction.\n"
+                    "Gas limits left out are estimated on the current state, each call without the effects of the calls before it." +
+                    HELP_REQUIRING_PASSPHRASE,
+                    {
+                        {"calls", RPCArg::Type::ARR, RPCArg::Optional::NO, "The contract calls",
+                            {
+                                {"", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
+                                    {
+                                        {"contractaddress", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The contract address that will receive the funds and data."},
+                                        {"datahex", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "data to send."},
+                                        {"amount", RPCArg::Type::AMOUNT, RPCArg::Optional::OMITTED, "The amount in " + CURRENCY_UNIT + " to send. eg 0.1, default: 0"},
+                                        {"gaslimit", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "gasLimit, default: estimated, max: "+i64tostr(blockGasLimit)+" for all the calls"},
+                                    },
+                                },
+                            },
+                        },
+                        {"gasprice", RPCArg::Type::AMOUNT, RPCArg::Optional::OMITTED, "gasPrice Qtum price per gas unit, default: "+FormatMoney(nGasPrice)+", min:"+FormatMoney(minGasPrice)},
+                        {"senderaddress", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The qtum address that will be used as sender."},
+                        {"broadcast", RPCArg::Type::BOOL, RPCArg::Default{true}, "Whether to broadcast the transaction or not."},
+                        {"changetosender", RPCArg::Type::BOOL, RPCArg::Default{true}, "Return the change to the sender."},
+                        {"psbt", RPCArg::Type::BOOL, RPCArg::Optional::OMITTED, "Create partially signed transaction."},
+                    },
+                    {
+                        RPCResult{"if broadcast is set to true",
+                            RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR_HEX, "txid", "The transaction id. Only returned when wallet private keys are enabled."},
+                                {RPCResult::Type::STR, "sender", CURRENCY_UNIT + " address of the sender"},
+                                {RPCResult::Type::STR_HEX, "hash160", "Ripemd-160 hash of the sender"},
+                                {RPCResult::Type::ARR, "gaslimits", "The gas limit of each call", {{RPCResult::Type::NUM, "", ""}}},
+                            },
+                        },
+                        RPCResult{"if broadcast is set to false",
+                            RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR_HEX, "raw transaction", "The hex string of the raw transaction"},
+                                {RPCResult::Type::ARR, "gaslimits", "The gas limit of each call", {{RPCResult::Type::NUM, "", ""}}},
+                            },
+                        },
+                        RPCResult{"if psbt is set to true",
+                            RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR, "psbt", "The base64-encoded unsigned PSBT of the new transaction. Only returned when wallet private keys are disabled."},
+                                {RPCResult::Type::STR, "sender", CURRENCY_UNIT + " address of the sender"},
+                                {RPCResult::Type::STR_HEX, "hash160", "Ripemd-160 hash of the sender"},
+                                {RPCResult::Type::ARR, "gaslimits", "The gas limit of each call", {{RPCResult::Type::NUM, "", ""}}},
+                            },
+                        },
+                    },
+                    RPCExamples{
+                    HelpExampleCli("sendmanytocontract", "\"[{\\\"contractaddress\\\":\\\"c6ca2697719d00446d4ea51f6fac8fd1e9310214\\\",\\\"datahex\\\":\\\"54f6127f\\\"},{\\\"contractaddress\\\":\\\"c6ca2697719d00446d4ea51f6fac8fd1e9310214\\\",\\\"datahex\\\":\\\"54f6127f\\\",\\\"gaslimit\\\":250000}]\"")
+                    + HelpExampleCli("sendmanytocontract", "\"[{\\\"contractaddress\\\":\\\"c6ca2697719d00446d4ea51f6fac8fd1e9310214\\\",\\\"datahex\\\":\\\"54f6127f\\\",\\\"amount\\\":12.0015}]\" "+FormatMoney(minGasPrice)+" \"QM72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd\"")
+                    },
+            [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!pwallet) return NullUniValue;
+
+    ChainstateManager& chainman = pwallet->chain().chainman();
+
+    LOCK(pwallet->cs_wallet);
+
+    return SendManyToContract(*pwallet, request.params, chainman);
+},
+    };
+}
+
 RPCHelpMan removedelegationforaddress()
 {
     uint64_t blockGasLimit = 0, minGasPrice = 0;
@@ -1621,6 +1907,7 @@ static const CRPCCommand commands[] =
   //  ------------------    ------------------------
     { "wallet",             &createcontract,                 },
     { "wallet",             &sendtocontract,                 },
+    { "wallet",             &sendmanytocontract,             },
     { "wallet",             &removedelegationforaddress,     },
     { "wallet",             &setdelegateforaddress,          },
     { "wallet",             &qrc20approve,                    },
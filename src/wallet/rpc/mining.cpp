@@ -5,8 +5,11 @@
 #include <rpc/mining.h>
 #include <wallet/rpc/util.h>
 #include <wallet/rpc/mining.h>
+#include <wallet/stake.h>
 #include <wallet/wallet.h>
 #include <node/miner.h>
+#include <node/mining_stats.h>
+#include <pos.h>
 #include <node/context.h>
 #include <pow.h>
 #include <node/warnings.h>
@@ -75,6 +78,15 @@ RPCHelpMan getmininginfo()
                             {RPCResult::Type::NUM, "maximum", "The maximum stake weight"},
                             {RPCResult::Type::NUM, "combined", "The combined stake weight"},
                         }},
+                        {RPCResult::Type::OBJ, "localmining", "The X25X and RandomX miners of this node",
+                        {
+                            {RPCResult::Type::BOOL, "mining", "Whether a miner is running"},
+                            {RPCResult::Type::NUM, "threads", "Number of mining threads"},
+                            {RPCResult::Type::NUM, "hashps", "Hashes per second since mining started, or of the last run"},
+                            {RPCResult::Type::NUM, "total_hashes", "Hashes since mining started"},
+                            {RPCResult::Type::NUM, "blocks_found", "Blocks found since mining started"},
+                            {RPCResult::Type::NUM, "uptime", "Seconds since mining started"},
+                        }},
                     }},
                 RPCExamples{
                     HelpExampleCli("getmininginfo", "")
@@ -131,6 +143,16 @@ RPCHelpMan getmininginfo()
     weight.pushKV("combined",      (uint64_t)nWeight);
     obj.pushKV("stakeweight",      weight);
 
+    const node::MiningStats mining_stats = node::GetMiningStats();
+    UniValue localmining(UniValue::VOBJ);
+    localmining.pushKV("mining",       mining_stats.mining);
+    localmining.pushKV("threads",      (uint64_t)mining_stats.threads);
+    localmining.pushKV("hashps",       mining_stats.hashrate);
+    localmining.pushKV("total_hashes", mining_stats.total_hashes);
+    localmining.pushKV("blocks_found", mining_stats.blocks_found);
+    localmining.pushKV("uptime",       mining_stats.uptime);
+    obj.pushKV("localmining",      localmining);
+
     obj.pushKV("chain", chainman.GetParams().GetChainTypeString());
 
     UniValue next(UniValue::VOBJ);
@@ -183,6 +205,7 @@ RPCHelpMan setstaking()
         else throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid boolean value: " + str);
     }
     pwallet->m_enabled_staking = enable;
+    pwallet->WakeStaker();
 
     return pwallet->m_enabled_staking.load();
 },
@@ -213,6 +236,11 @@ RPCHelpMan getstakinginfo()
                         {RPCResult::Type::NUM, "delegateweight", "Delegate weight"},
                         {RPCResult::Type::NUM, "netstakeweight", "Network stake weight"},
                         {RPCResult::Type::NUM, "expectedtime", "Expected time to earn reward"},
+                        {RPCResult::Type::STR_AMOUNT, "stakesplittarget", "Size of the stake outputs the wallet aims for, smaller ones are combined and coinstakes worth several are split"},
+                        {RPCResult::Type::NUM, "expectedstakesperday", "Blocks the wallet is expected to stake per day at the current weights"},
+                        {RPCResult::Type::NUM, "lockedstakeshare", "Share of the wallet's weight expected to be locked in immature coinstakes at the target size"},
+                        {RPCResult::Type::NUM, "stakecacheentries", "Prevouts in the wallet's stake caches"},
+                        {RPCResult::Type::NUM, "stakecachememory", "Memory used by the wallet's stake caches, in bytes"},
                     }
                 },
                 RPCExamples{
@@ -231,12 +259,18 @@ RPCHelpMan getstakinginfo()
     uint64_t nStakerWeight = 0;
     uint64_t nDelegateWeight = 0;
     uint64_t lastCoinStakeSearchInterval = 0;
+    uint64_t nStakeCacheEntries = 0;
+    uint64_t nStakeCacheMemory = 0;
 
     if (pwallet)
     {
         LOCK(pwallet->cs_wallet);
         nWeight = pwallet->GetStakeWeight(&nStakerWeight, &nDelegateWeight);
         lastCoinStakeSearchInterval = pwallet->m_enabled_staking ? pwallet->m_last_coin_stake_search_interval : 0;
+        for (const StakeCacheMap* cache : {&pwallet->minerStakeCache, &pwallet->stakeCache, &pwallet->stakeDelegateCache}) {
+            nStakeCacheEntries += cache->Size();
+            nStakeCacheMemory += cache->DynamicMemoryUsage();
+        }
     }
 
     LOCK(cs_main);
@@ -245,6 +279,7 @@ RPCHelpMan getstakinginfo()
     const Consensus::Params& consensusParams = Params().GetConsensus();
     int64_t nTargetSpacing = consensusParams.TargetSpacing(chainman.m_best_header->nHeight);
     uint64_t nExpectedTime = staking ? (nTargetSpacing * nNetworkWeight / nWeight) : 0;
+    const StakeSplitPlan plan = GetStakeSplitPlan(*pwallet, nStakerWeight);
 
     UniValue obj(UniValue::VOBJ);
 
@@ -274,6 +309,91 @@ RPCHelpMan getstakinginfo()
     obj.pushKV("netstakeweight", (uint64_t)nNetworkWeight);
 
     obj.pushKV("expectedtime", nExpectedTime);
+    obj.pushKV("stakesplittarget", ValueFromAmount(plan.nTargetValue));
+    obj.pushKV("expectedstakesperday", plan.dExpectedStakesPerDay);
+    obj.pushKV("lockedstakeshare", plan.dLockedShare);
+    obj.pushKV("stakecacheentries", nStakeCacheEntries);
+    obj.pushKV("stakecachememory", nStakeCacheMemory);
+
+    return obj;
+},
+    };
+}
+
+RPCHelpMan getstakerstats()
+{
+    return RPCHelpMan{"getstakerstats",
+                "\nReturns counters of the wallet's staking thread, to tune the staker polling and stake split/combine settings.\n"
+                "Times are averages in milliseconds.",
+                {
+                    {"reset", RPCArg::Type::BOOL, RPCArg::Default{false}, "Reset the counters after reading them"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM_TIME, "since", "The " + UNIX_EPOCH_TIME + " the counters were last reset"},
+                        {RPCResult::Type::NUM, "kernels", "Stake kernels evaluated"},
+                        {RPCResult::Type::NUM, "kernelspersecond", "Kernels evaluated per second of kernel search"},
+                        {RPCResult::Type::NUM, "cachehits", "Kernel checks whose prevout was in the stake cache"},
+                        {RPCResult::Type::NUM, "cachemisses", "Kernel checks whose prevout was not in the stake cache"},
+                        {RPCResult::Type::NUM, "cachehitrate", "Fraction of kernel checks served by the stake cache"},
+                        {RPCResult::Type::NUM, "tips", "Chain tips the staker prepared for"},
+                        {RPCResult::Type::NUM, "candidates", "Candidate blocks built after finding a kernel"},
+                        {RPCResult::Type::NUM, "tiptocandidate", "Time from noticing a tip to the first candidate block on it"},
+                        {RPCResult::Type::NUM, "lasttiptocandidate", "The same, for the last tip with a candidate block"},
+                        {RPCResult::Type::NUM, "signatures", "Blocks signed with the wallet's keys"},
+                        {RPCResult::Type::NUM, "signaturetime", "Time to sign a block with the wallet's keys"},
+                        {RPCResult::Type::NUM, "hardwaresignatures", "Blocks signed by a hardware device"},
+                        {RPCResult::Type::NUM, "hardwaresignaturetime", "Time for a hardware device to sign a block header"},
+                        {RPCResult::Type::NUM, "blocks", "Blocks submitted and accepted"},
+                        {RPCResult::Type::NUM, "missedslots", "Timestamps with a valid kernel that did not produce an accepted block"},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getstakerstats", "")
+            + HelpExampleCli("getstakerstats", "true")
+            + HelpExampleRpc("getstakerstats", "")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!pwallet) return NullUniValue;
+
+    const StakerStats& stats = pwallet->m_staker_stats;
+    auto average = [](uint64_t micros, uint64_t count) {
+        return count ? micros / 1000.0 / count : 0.0;
+    };
+    const uint64_t kernels = stats.kernels;
+    const uint64_t kernelMicros = stats.kernel_micros;
+    const uint64_t cacheHits = stats.cache_hits;
+    const uint64_t cacheMisses = stats.cache_misses;
+    const uint64_t tips = stats.tips;
+    const uint64_t candidates = stats.candidates;
+    const uint64_t signatures = stats.signatures;
+    const uint64_t hardwareSignatures = stats.hardware_signatures;
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("since", stats.reset_time.load());
+    obj.pushKV("kernels", kernels);
+    obj.pushKV("kernelspersecond", kernelMicros ? kernels * 1e6 / kernelMicros : 0.0);
+    obj.pushKV("cachehits", cacheHits);
+    obj.pushKV("cachemisses", cacheMisses);
+    obj.pushKV("cachehitrate", cacheHits + cacheMisses ? double(cacheHits) / (cacheHits + cacheMisses) : 0.0);
+    obj.pushKV("tips", tips);
+    obj.pushKV("candidates", candidates);
+    // Only the first candidate on each tip is timed
+    obj.pushKV("tiptocandidate", average(stats.tip_to_candidate_micros, std::min(tips, candidates)));
+    obj.pushKV("lasttiptocandidate", stats.last_tip_to_candidate_micros / 1000.0);
+    obj.pushKV("signatures", signatures);
+    obj.pushKV("signaturetime", average(stats.signature_micros, signatures));
+    obj.pushKV("hardwaresignatures", hardwareSignatures);
+    obj.pushKV("hardwaresignaturetime", average(stats.hardware_signature_micros, hardwareSignatures));
+    obj.pushKV("blocks", stats.blocks.load());
+    obj.pushKV("missedslots", stats.missed_slots.load());
+
+    if (!request.params[0].isNull() && request.params[0].get_bool()) {
+        pwallet->m_staker_stats.Reset(GetTime());
+    }
 
     return obj;
 },
@@ -288,6 +408,7 @@ static const CRPCCommand commands[] =
   //  ------------------    ------------------------
     { "mining",             &getmininginfo,                  },
     { "mining",             &getstakinginfo,                 },
+    { "mining",             &getstakerstats,                 },
     { "mining",             &setstaking,                     },
 };
 // clang-format on
@@ -6,6 +6,8 @@
 #include <rpc/server_util.h>
 #include <rpc/util.h>
 #include <core_io.h>
+#include <scheduler.h>
+#include <wallet/context.h>
 #include <wallet/rpc/util.h>
 #include <wallet/wallet.h>
 #include <wallet/receive.h>
@@ -15,6 +17,7 @@
 #include <wallet/privacy_wallet.h>
 #include <wallet/fcmp_wallet.h>
 #include <privacy/privacy.h>
+#include <privacy/fcmp_consensus.h>
 #include <privacy/curvetree/curve_tree.h>
 #include <key_io.h>
 #include <util/strencodings.h>
@@ -22,6 +25,8 @@
 
 #include <univalue.h>
 
+using interfaces::FoundBlock;
+
 // Global FCMP wallet managers (keyed by wallet name)
 static std::map<std::string, std::unique_ptr<wallet::CFcmpWalletManager>> g_fcmpManagers;
 static RecursiveMutex g_fcmpManagersMutex;
@@ -37,6 +42,21 @@ static wallet::CFcmpWalletManager* GetFcmpManager(const std::shared_ptr<const wa
     return g_fcmpManagers[walletName].get();
 }
 
+// Global stealth address managers (keyed by wallet name)
+static std::map<std::string, std::unique_ptr<wallet::CStealthAddressManager>> g_stealthManagers;
+static RecursiveMutex g_stealthManagersMutex;
+
+// Helper to get or create stealth address manager
+static wallet::CStealthAddressManager* GetStealthManager(const std::shared_ptr<const wallet::CWallet>& pwallet) {
+    LOCK(g_stealthManagersMutex);
+    const std::string walletName = pwallet->GetName();
+    if (g_stealthManagers.find(walletName) == g_stealthManagers.end()) {
+        g_stealthManagers[walletName] = std::make_unique<wallet::CStealthAddressManager>(
+            const_cast<wallet::CWallet*>(pwallet.get()));
+    }
+    return g_stealthManagers[walletName].get();
+}
+
 namespace wallet {
 
 static RPCHelpMan getnewstealthaddress()
@@ -71,18 +91,8 @@ static RPCHelpMan getnewstealthaddress()
                 label = request.params[0].get_str();
             }
 
-            // Get or create stealth address manager
-            // Note: In full implementation, this would be a member of CWallet
-            static std::map<std::string, std::unique_ptr<CStealthAddressManager>> s_managers;
-
-            const std::string walletName = pwallet->GetName();
-            if (s_managers.find(walletName) == s_managers.end()) {
-                s_managers[walletName] = std::make_unique<CStealthAddressManager>(
-                    const_cast<CWallet*>(pwallet.get()));
-            }
-
             CStealthAddressData addressData;
-            if (!s_managers[walletName]->GenerateStealthAddress(label, addressData)) {
+            if (!GetStealthManager(pwallet)->GenerateStealthAddress(label, addressData)) {
                 throw JSONRPCError(RPC_WALLET_ERROR, "Failed to generate stealth address");
             }
 
@@ -125,17 +135,8 @@ static RPCHelpMan liststealthaddresses()
 
             LOCK(pwallet->cs_wallet);
 
-            // Get stealth address manager
-            static std::map<std::string, std::unique_ptr<CStealthAddressManager>> s_managers;
-
-            const std::string walletName = pwallet->GetName();
-            if (s_managers.find(walletName) == s_managers.end()) {
-                s_managers[walletName] = std::make_unique<CStealthAddressManager>(
-                    const_cast<CWallet*>(pwallet.get()));
-            }
-
             UniValue result(UniValue::VARR);
-            for (const auto& addr : s_managers[walletName]->GetStealthAddresses()) {
+            for (const auto& addr : GetStealthManager(pwallet)->GetStealthAddresses()) {
                 UniValue obj(UniValue::VOBJ);
                 obj.pushKV("address", addr.address.ToString());
                 obj.pushKV("label", addr.label);
@@ -174,23 +175,19 @@ static RPCHelpMan getprivacybalance()
             LOCK(pwallet->cs_wallet);
 
             // Get managers
-            static std::map<std::string, std::unique_ptr<CStealthAddressManager>> s_stealthManagers;
             static std::map<std::string, std::unique_ptr<CPrivacyWalletManager>> s_privacyManagers;
 
             const std::string walletName = pwallet->GetName();
-            if (s_stealthManagers.find(walletName) == s_stealthManagers.end()) {
-                s_stealthManagers[walletName] = std::make_unique<CStealthAddressManager>(
-                    const_cast<CWallet*>(pwallet.get()));
-            }
+            auto* stealthManager = GetStealthManager(pwallet);
             if (s_privacyManagers.find(walletName) == s_privacyManagers.end()) {
                 s_privacyManagers[walletName] = std::make_unique<CPrivacyWalletManager>(
                     const_cast<CWallet*>(pwallet.get()));
             }
 
-            CAmount stealthBalance = s_stealthManagers[walletName]->GetStealthBalance();
+            CAmount stealthBalance = stealthManager->GetStealthBalance();
             CAmount privacyBalance = s_privacyManagers[walletName]->GetPrivacyBalance();
             CAmount spendable = s_privacyManagers[walletName]->GetSpendablePrivacyBalance();
-            size_t outputs = s_stealthManagers[walletName]->GetUnspentStealthOutputs().size();
+            size_t outputs = stealthManager->GetUnspentStealthOutputs().size();
 
             UniValue result(UniValue::VOBJ);
             result.pushKV("balance", ValueFromAmount(privacyBalance));
@@ -641,15 +638,8 @@ static RPCHelpMan shieldfcmp()
             std::string stealthAddrStr;
             if (!stealthAddr) {
                 // Use the stealth address manager to generate a new one
-                static std::map<std::string, std::unique_ptr<CStealthAddressManager>> s_managers;
-                const std::string walletName = pwallet->GetName();
-                if (s_managers.find(walletName) == s_managers.end()) {
-                    s_managers[walletName] = std::make_unique<CStealthAddressManager>(
-                        const_cast<CWallet*>(pwallet.get()));
-                }
-
                 CStealthAddressData addressData;
-                if (!s_managers[walletName]->GenerateStealthAddress("fcmp_shield", addressData)) {
+                if (!GetStealthManager(pwallet)->GenerateStealthAddress("fcmp_shield", addressData)) {
                     throw JSONRPCError(RPC_WALLET_ERROR, "Failed to generate stealth address");
                 }
                 stealthAddr = addressData.address;
@@ -663,73 +653,165 @@ static RPCHelpMan shieldfcmp()
             // 1. Spends transparent inputs
             // 2. Creates an OP_RETURN output with FCMP output data (O, I, C)
             // 3. The FCMP output gets added to curve tree on block confirmation
-
-            auto shieldResult = fcmpManager->CreateShieldTransaction(*stealthAddr, amount, minConf);
+            CFcmpRecipient recipient;
+            recipient.stealthAddress = *stealthAddr;
+            recipient.amount = amount;
+            auto shieldResult = fcmpManager->SendShieldTransaction({recipient}, minConf);
 
             if (!shieldResult.success) {
                 throw JSONRPCError(RPC_WALLET_ERROR,
                     strprintf("Failed to create shield transaction: %s", shieldResult.error));
             }
 
-            // Get the OP_RETURN script from the template transaction
-            CScript opReturnScript;
-            for (const auto& txout : shieldResult.standardTx->vout) {
-                if (txout.scriptPubKey.size() > 0 && txout.scriptPubKey[0] == OP_RETURN) {
-                    opReturnScript = txout.scriptPubKey;
-                    break;
+            UniValue ret(UniValue::VOBJ);
+            ret.pushKV("txid", shieldResult.standardTx->GetHash().GetHex());
+            ret.pushKV("amount", ValueFromAmount(amount));
+            ret.pushKV("fee", ValueFromAmount(shieldResult.fee));
+            ret.pushKV("stealth_address", stealthAddrStr);
+            ret.pushKV("leaf_index", static_cast<uint64_t>(shieldResult.leafIndex));
+
+            return ret;
+        },
+    };
+}
+
+static RPCHelpMan shieldfcmpmany()
+{
+    return RPCHelpMan{"shieldfcmpmany",
+        "\nShield transparent coins to several stealth addresses in one transaction.\n"
+        "All FCMP outputs share one transaction and one fee.\n",
+        {
+            {"amounts", RPCArg::Type::OBJ_USER_KEYS, RPCArg::Optional::NO, strprintf("The stealth addresses with amounts, at most %u", privacy::MAX_FCMP_SHIELD_OUTPUTS),
+                {
+                    {"address", RPCArg::Type::AMOUNT, RPCArg::Optional::NO, "The stealth address is the key, the amount to shield is the value"},
+                },
+            },
+            {"minconf", RPCArg::Type::NUM, RPCArg::Default{1}, "Minimum confirmations for inputs."},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "txid", "The transaction ID"},
+                {RPCResult::Type::STR_AMOUNT, "amount", "Total amount shielded"},
+                {RPCResult::Type::STR_AMOUNT, "fee", "Fee paid"},
+                {RPCResult::Type::NUM, "leaf_index", "Curve tree leaf index for the first new output, the others follow in order"},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("shieldfcmpmany", "\"{\\\"sx1...\\\":1.0,\\\"sx1...\\\":2.5}\"")
+            + HelpExampleRpc("shieldfcmpmany", "{\"sx1...\":1.0,\"sx1...\":2.5}")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            const std::shared_ptr<const CWallet> pwallet = GetWalletForJSONRPCRequest(request);
+            if (!pwallet) return UniValue::VNULL;
+
+            const UniValue& amounts = request.params[0].get_obj();
+            std::vector<CFcmpRecipient> recipients;
+            for (const std::string& address : amounts.getKeys()) {
+                auto stealthAddr = privacy::CStealthAddress::FromString(address);
+                if (!stealthAddr) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Invalid stealth address: %s", address));
                 }
+                CFcmpRecipient recipient;
+                recipient.stealthAddress = *stealthAddr;
+                recipient.amount = AmountFromValue(amounts[address]);
+                recipients.push_back(recipient);
             }
 
-            if (opReturnScript.empty()) {
-                throw JSONRPCError(RPC_WALLET_ERROR, "Failed to create FCMP OP_RETURN script");
+            int minConf = 1;
+            if (!request.params[1].isNull()) {
+                minConf = request.params[1].getInt<int>();
             }
 
-            // Create recipient for the OP_RETURN output (0 value)
-            CRecipient opReturnRecipient{CNoDestination{opReturnScript}, 0, false};
+            LOCK(pwallet->cs_wallet);
 
-            // Create recipient for the shielded value
-            // The shielded amount is sent to a one-time address derived from the stealth address
-            // In FCMP, this creates a UTXO that can only be spent with a valid membership proof
-            auto destResult = const_cast<CWallet*>(pwallet.get())->GetNewDestination(OutputType::BECH32, "fcmp_shield");
-            if (!destResult) {
+            auto shieldResult = GetFcmpManager(pwallet)->SendShieldTransaction(recipients, minConf);
+            if (!shieldResult.success) {
                 throw JSONRPCError(RPC_WALLET_ERROR,
-                    strprintf("Failed to generate shield destination: %s", util::ErrorString(destResult).original));
+                    strprintf("Failed to create shield transaction: %s", shieldResult.error));
             }
-            CTxDestination shieldDest = *destResult;
 
-            // The shielded amount goes to a wallet-controlled address
-            // The OP_RETURN commitment proves ownership of the shielded value
-            // When spending, the FCMP proof demonstrates membership without revealing which output
-            CRecipient shieldRecipient{shieldDest, amount, false};
+            UniValue ret(UniValue::VOBJ);
+            ret.pushKV("txid", shieldResult.standardTx->GetHash().GetHex());
+            ret.pushKV("amount", ValueFromAmount(shieldResult.amount));
+            ret.pushKV("fee", ValueFromAmount(shieldResult.fee));
+            ret.pushKV("leaf_index", static_cast<uint64_t>(shieldResult.leafIndex));
 
-            // Build recipients list
-            std::vector<CRecipient> recipients;
-            recipients.push_back(shieldRecipient);  // Shielded value output first
-            recipients.push_back(opReturnRecipient); // FCMP commitment output
+            return ret;
+        },
+    };
+}
 
-            // Create the transaction
-            CCoinControl coinControl;
-            coinControl.m_min_depth = minConf;
+static RPCHelpMan queueshieldfcmp()
+{
+    return RPCHelpMan{"queueshieldfcmp",
+        strprintf("\nQueue a shield to a stealth address, to be sent together with other queued shields.\n"
+                  "Queued requests are sent %d seconds after the first one, or as soon as %u are pending,\n"
+                  "in as few transactions as possible. Failures are only logged; check the wallet\n"
+                  "transactions for the outcome.\n",
+                  count_seconds(FCMP_SHIELD_QUEUE_WINDOW), privacy::MAX_FCMP_SHIELD_OUTPUTS),
+        {
+            {"amount", RPCArg::Type::AMOUNT, RPCArg::Optional::NO, "The amount to shield."},
+            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The stealth address to shield to."},
+            {"minconf", RPCArg::Type::NUM, RPCArg::Default{1}, "Minimum confirmations for inputs. A batch uses the highest value among its requests."},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::NUM, "pending", "Shield requests waiting to be sent"},
+                {RPCResult::Type::ARR, "txids", "Transactions sent because the queue filled up",
+                    {
+                        {RPCResult::Type::STR_HEX, "", "The transaction ID"},
+                    }},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("queueshieldfcmp", "1.0 \"sx1...\"")
+            + HelpExampleRpc("queueshieldfcmp", "1.0, \"sx1...\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            const std::shared_ptr<const CWallet> pwallet = GetWalletForJSONRPCRequest(request);
+            if (!pwallet) return UniValue::VNULL;
 
-            auto txResult = CreateTransaction(*const_cast<CWallet*>(pwallet.get()), recipients, std::nullopt, coinControl, true);
+            CFcmpRecipient recipient;
+            recipient.amount = AmountFromValue(request.params[0]);
+            if (recipient.amount <= 0) {
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid amount");
+            }
+            auto stealthAddr = privacy::CStealthAddress::FromString(request.params[1].get_str());
+            if (!stealthAddr) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid stealth address");
+            }
+            recipient.stealthAddress = *stealthAddr;
 
-            if (!txResult) {
-                throw JSONRPCError(RPC_WALLET_ERROR,
-                    strprintf("Failed to create transaction: %s", util::ErrorString(txResult).original));
+            int minConf = 1;
+            if (!request.params[2].isNull()) {
+                minConf = request.params[2].getInt<int>();
             }
 
-            // Commit the transaction
-            mapValue_t mapValue;
-            mapValue["comment"] = "FCMP shield transaction";
+            auto* fcmpManager = GetFcmpManager(pwallet);
+            const size_t pending = fcmpManager->QueueShield(recipient, minConf);
 
-            const_cast<CWallet*>(pwallet.get())->CommitTransaction(txResult->tx, std::move(mapValue), {});
+            UniValue txids(UniValue::VARR);
+            WalletContext& context = EnsureWalletContext(request.context);
+            if (pending >= privacy::MAX_FCMP_SHIELD_OUTPUTS || !context.scheduler) {
+                for (const auto& result : fcmpManager->FlushShieldQueue()) {
+                    if (result.success) txids.push_back(result.standardTx->GetHash().GetHex());
+                }
+            } else if (pending == 1) {
+                // The first request of a batch starts the window. The wallet
+                // is looked up again when it ends, as it may be unloaded.
+                context.scheduler->scheduleFromNow([&context, name = pwallet->GetName()] {
+                    const std::shared_ptr<const CWallet> wallet = GetWallet(context, name);
+                    if (wallet) GetFcmpManager(wallet)->FlushShieldQueue();
+                }, FCMP_SHIELD_QUEUE_WINDOW);
+            }
 
             UniValue ret(UniValue::VOBJ);
-            ret.pushKV("txid", txResult->tx->GetHash().GetHex());
-            ret.pushKV("amount", ValueFromAmount(amount));
-            ret.pushKV("fee", ValueFromAmount(txResult->fee));
-            ret.pushKV("stealth_address", stealthAddrStr);
-            ret.pushKV("leaf_index", static_cast<uint64_t>(shieldResult.leafIndex));
+            ret.pushKV("pending", static_cast<uint64_t>(fcmpManager->GetPendingShieldCount()));
+            ret.pushKV("txids", std::move(txids));
 
             return ret;
         },
@@ -826,6 +908,115 @@ static RPCHelpMan importfcmpoutput()
     };
 }
 
+static RPCHelpMan rescanprivacy()
+{
+    return RPCHelpMan{"rescanprivacy",
+        "\nRescan the local blockchain for stealth payments and FCMP outputs.\n"
+        "Blocks are read once and scanned on all cores. Progress is checkpointed in the wallet,\n"
+        "and without a start_height the rescan resumes after the last block scanned.\n"
+        "Note: Use \"abortrescan\" to stop it and \"getwalletinfo\" to query the scanning progress.\n",
+        {
+            {"start_height", RPCArg::Type::NUM, RPCArg::DefaultHint{"the block after the last privacy rescan, or 0"}, "block height where the rescan should start"},
+            {"stop_height", RPCArg::Type::NUM, RPCArg::Optional::OMITTED, "the last block height that should be scanned. If none is provided it will rescan up to the tip at return time of this call."},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::NUM, "start_height", "The block height where the rescan started"},
+                {RPCResult::Type::NUM, "stop_height", /*optional=*/true, "The height of the last rescanned block, if any block was scanned"},
+                {RPCResult::Type::NUM, "stealth_payments", "Number of stealth payments known to the wallet"},
+                {RPCResult::Type::NUM, "fcmp_outputs", "Number of FCMP outputs known to the wallet"},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("rescanprivacy", "")
+            + HelpExampleCli("rescanprivacy", "100000 120000")
+            + HelpExampleRpc("rescanprivacy", "100000, 120000")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+            if (!pwallet) return UniValue::VNULL;
+
+            pwallet->BlockUntilSyncedToCurrentChain();
+
+            WalletRescanReserver reserver(*pwallet);
+            if (!reserver.reserve()) {
+                throw JSONRPCError(RPC_WALLET_ERROR, "Wallet is currently rescanning. Abort existing rescan or wait.");
+            }
+
+            int start_height = 0;
+            std::optional<int> stop_height;
+            uint256 start_block;
+            {
+                LOCK(pwallet->cs_wallet);
+                const int tip_height = pwallet->GetLastBlockHeight();
+
+                if (!request.params[0].isNull()) {
+                    start_height = request.params[0].getInt<int>();
+                    if (start_height < 0 || start_height > tip_height) {
+                        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid start_height");
+                    }
+                } else {
+                    // Resume after the last checkpoint that is still in the active chain
+                    CBlockLocator locator;
+                    if (WalletBatch(pwallet->GetDatabase()).ReadPrivacyRescanProgress(locator)) {
+                        if (const auto fork_height = pwallet->chain().findLocatorFork(locator)) {
+                            start_height = *fork_height + 1;
+                        }
+                    }
+                }
+
+                if (!request.params[1].isNull()) {
+                    stop_height = request.params[1].getInt<int>();
+                    if (*stop_height < 0 || *stop_height > tip_height) {
+                        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid stop_height");
+                    } else if (*stop_height < start_height) {
+                        throw JSONRPCError(RPC_INVALID_PARAMETER, "stop_height must be greater than start_height");
+                    }
+                }
+
+                if (start_height <= tip_height) {
+                    if (!pwallet->chain().hasBlocks(pwallet->GetLastBlockHash(), start_height, stop_height)) {
+                        throw JSONRPCError(RPC_MISC_ERROR, "Can't rescan unavailable blocks. Pruned or missing block data?");
+                    }
+                    CHECK_NONFATAL(pwallet->chain().findAncestorByHeight(pwallet->GetLastBlockHash(), start_height, FoundBlock().hash(start_block)));
+                }
+            }
+
+            auto* stealthManager = GetStealthManager(pwallet);
+            auto* fcmpManager = GetFcmpManager(pwallet);
+
+            CWallet::ScanResult result;
+            if (!start_block.IsNull()) {
+                std::vector<std::unique_ptr<PrivacyBlockDetector>> detectors;
+                detectors.push_back(stealthManager->MakeRescanDetector());
+                detectors.push_back(fcmpManager->MakeRescanDetector());
+
+                result = pwallet->ScanForPrivacyOutputs(start_block, start_height, stop_height, reserver, detectors, /*save_progress=*/true);
+                switch (result.status) {
+                case CWallet::ScanResult::SUCCESS:
+                    break;
+                case CWallet::ScanResult::FAILURE:
+                    throw JSONRPCError(RPC_MISC_ERROR, "Rescan failed. Potentially corrupted data files.");
+                case CWallet::ScanResult::USER_ABORT:
+                    throw JSONRPCError(RPC_MISC_ERROR, "Rescan aborted.");
+                    // no default case, so the compiler can warn about missing cases
+                }
+            }
+
+            UniValue response(UniValue::VOBJ);
+            response.pushKV("start_height", start_height);
+            if (result.last_scanned_height) {
+                response.pushKV("stop_height", *result.last_scanned_height);
+            }
+            response.pushKV("stealth_payments", static_cast<uint64_t>(stealthManager->GetStealthPayments(/*includeSpent=*/true).size()));
+            response.pushKV("fcmp_outputs", static_cast<uint64_t>(fcmpManager->GetFcmpOutputs(/*includeSpent=*/true).size()));
+            return response;
+        },
+    };
+}
+
 Span<const CRPCCommand> GetPrivacyRPCCommands()
 {
     static const CRPCCommand commands[]{
@@ -835,10 +1026,13 @@ Span<const CRPCCommand> GetPrivacyRPCCommands()
         {"privacy", &getprivacybalance},
         {"privacy", &decodestealthaddress},
         {"privacy", &getprivacyinfo},
+        {"privacy", &rescanprivacy},
         // FCMP commands
         {"privacy", &getfcmpbalance},
         {"privacy", &listfcmpoutputs},
         {"privacy", &shieldfcmp},
+        {"privacy", &shieldfcmpmany},
+        {"privacy", &queueshieldfcmp},
         {"privacy", &sendfcmp},
         {"privacy", &getfcmpinfo},
         {"privacy", &importfcmpoutput},
@@ -2282,8 +2282,10 @@ bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int siz
         m_wallet_descriptor.range_start = 0;
     }
 
+    // The private keys are only needed to derive hardened paths the cache
+    // does not have yet, and decrypting them is slow
     FlatSigningProvider provider;
-    provider.keys = GetKeys();
+    bool have_keys{false};
 
     uint256 id = GetID();
     for (int32_t i = m_max_cached_index + 1; i < new_range_end; ++i) {
@@ -2292,6 +2294,10 @@ bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int siz
         DescriptorCache temp_cache;
         // Maybe we have a cached xpub and we can expand from the cache first
         if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
+            if (!have_keys) {
+                provider.keys = GetKeys();
+                have_keys = true;
+            }
             if (!m_wallet_descriptor.descriptor->Expand(i, provider, scripts_temp, out_keys, &temp_cache)) return false;
         }
         // Add all of the scriptPubKeys to the scriptPubKey set
@@ -2299,8 +2305,11 @@ bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int siz
         for (const CScript& script : scripts_temp) {
             m_map_script_pub_keys[script] = i;
         }
+        DerivedScripts& derived = m_unsaved_derived[i];
+        derived = DerivedScripts{scripts_temp, {}};
         for (const auto& pk_pair : out_keys.pubkeys) {
             const CPubKey& pubkey = pk_pair.second;
+            derived.pubkeys.push_back(pubkey);
             if (m_map_pubkeys.count(pubkey) != 0) {
                 // We don't need to give an error here.
                 // It doesn't matter which of many valid indexes the pubkey has, we just need an index where we can derive it and it's private key
@@ -2317,6 +2326,11 @@ bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int siz
     }
     m_wallet_descriptor.range_end = new_range_end;
     batch.WriteDescriptor(GetID(), m_wallet_descriptor);
+    if (m_wallet_descriptor.descriptor->IsRange()) {
+        WriteDerivedScripts(batch);
+    } else {
+        m_unsaved_derived.clear();
+    }
 
     // By this point, the cache size should be the size of the entire range
     assert(m_wallet_descriptor.range_end - 1 == m_max_cached_index);
@@ -2345,9 +2359,11 @@ std::vector<WalletDestination> DescriptorScriptPubKeyMan::MarkUnusedAddresses(co
                 result.push_back({dest, std::nullopt});
                 m_wallet_descriptor.next_index++;
             }
-        }
-        if (!TopUp()) {
-            WalletLogPrintf("%s: Topping up keypool failed (locked wallet)\n", __func__);
+            // The keypool is only short of its size once an item was used,
+            // so a rescan does not write the descriptor for every output
+            if (!TopUp()) {
+                WalletLogPrintf("%s: Topping up keypool failed (locked wallet)\n", __func__);
+            }
         }
     }
 
@@ -2699,22 +2715,47 @@ void DescriptorScriptPubKeyMan::SetCache(const DescriptorCache& cache)
     LOCK(cs_desc_man);
     std::set<CScript> new_spks;
     m_wallet_descriptor.cache = cache;
-    for (int32_t i = m_wallet_descriptor.range_start; i < m_wallet_descriptor.range_end; ++i) {
+    const bool ranged{m_wallet_descriptor.descriptor->IsRange()};
+
+    // Check the first index of each derived scripts record against the cache, a record that
+    // does not match is dropped and its indexes are derived again
+    for (auto it = m_loaded_derived.begin(); it != m_loaded_derived.end();) {
         FlatSigningProvider out_keys;
         std::vector<CScript> scripts_temp;
-        if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
-            throw std::runtime_error("Error: Unable to expand wallet descriptor from cache");
+        if (!ranged || it->second.empty() ||
+            !m_wallet_descriptor.descriptor->ExpandFromCache(it->first, m_wallet_descriptor.cache, scripts_temp, out_keys) ||
+            scripts_temp != it->second.front().scripts) {
+            WalletLogPrintf("%s: Dropping derived scripts at index %d that do not match the descriptor\n", __func__, it->first);
+            it = m_loaded_derived.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (int32_t i = m_wallet_descriptor.range_start; i < m_wallet_descriptor.range_end; ++i) {
+        DerivedScripts derived;
+        auto record = m_loaded_derived.upper_bound(i);
+        if (record != m_loaded_derived.begin() && i - std::prev(record)->first < (int32_t)std::prev(record)->second.size()) {
+            derived = std::move(std::prev(record)->second[i - std::prev(record)->first]);
+        } else {
+            FlatSigningProvider out_keys;
+            if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, derived.scripts, out_keys)) {
+                throw std::runtime_error("Error: Unable to expand wallet descriptor from cache");
+            }
+            for (const auto& pk_pair : out_keys.pubkeys) {
+                derived.pubkeys.push_back(pk_pair.second);
+            }
+            if (ranged) m_unsaved_derived[i] = derived;
         }
         // Add all of the scriptPubKeys to the scriptPubKey set
-        new_spks.insert(scripts_temp.begin(), scripts_temp.end());
-        for (const CScript& script : scripts_temp) {
+        new_spks.insert(derived.scripts.begin(), derived.scripts.end());
+        for (const CScript& script : derived.scripts) {
             if (m_map_script_pub_keys.count(script) != 0) {
                 throw std::runtime_error(strprintf("Error: Already loaded script at index %d as being at index %d", i, m_map_script_pub_keys[script]));
             }
             m_map_script_pub_keys[script] = i;
         }
-        for (const auto& pk_pair : out_keys.pubkeys) {
-            const CPubKey& pubkey = pk_pair.second;
+        for (const CPubKey& pubkey : derived.pubkeys) {
             if (m_map_pubkeys.count(pubkey) != 0) {
                 // We don't need to give an error here.
                 // It doesn't matter which of many valid indexes the pubkey has, we just need an index where we can derive it and it's private key
@@ -2724,10 +2765,37 @@ void DescriptorScriptPubKeyMan::SetCache(const DescriptorCache& cache)
         }
         m_max_cached_index++;
     }
+    m_loaded_derived.clear();
     // Make sure the wallet knows about our new spks
     m_storage.TopUpCallback(new_spks, this);
 }
 
+void DescriptorScriptPubKeyMan::LoadDerivedScripts(int32_t first_index, std::vector<DerivedScripts> derived)
+{
+    LOCK(cs_desc_man);
+    m_loaded_derived[first_index] = std::move(derived);
+}
+
+void DescriptorScriptPubKeyMan::WriteDerivedScripts(WalletBatch& batch)
+{
+    AssertLockHeld(cs_desc_man);
+    uint256 id = GetID();
+    while (m_unsaved_derived.size() >= DERIVED_SCRIPTS_PER_RECORD) {
+        const int32_t first_index = m_unsaved_derived.begin()->first;
+        std::vector<DerivedScripts> derived;
+        auto it = m_unsaved_derived.begin();
+        while (it != m_unsaved_derived.end() && derived.size() < DERIVED_SCRIPTS_PER_RECORD && it->first == first_index + (int32_t)derived.size()) {
+            derived.push_back(std::move(it->second));
+            ++it;
+        }
+        // A run cut short by a gap is derived again at the next load
+        if (derived.size() == DERIVED_SCRIPTS_PER_RECORD && !batch.WriteDescriptorDerivedScripts(id, first_index, derived)) {
+            throw std::runtime_error(std::string(__func__) + ": writing derived scripts failed");
+        }
+        m_unsaved_derived.erase(m_unsaved_derived.begin(), it);
+    }
+}
+
 bool DescriptorScriptPubKeyMan::AddKey(const CKeyID& key_id, const CKey& key)
 {
     LOCK(cs_desc_man);
@@ -2844,6 +2912,7 @@ void DescriptorScriptPubKeyMan::UpdateWalletDescriptor(WalletDescriptor& descrip
 
     m_map_pubkeys.clear();
     m_map_script_pub_keys.clear();
+    m_unsaved_derived.clear();
     m_max_cached_index = -1;
     m_wallet_descriptor = descriptor;
 
@@ -608,6 +608,14 @@ private:
     PubKeyMap m_map_pubkeys GUARDED_BY(cs_desc_man);
     int32_t m_max_cached_index = -1;
 
+    //! Derived scripts records read from the wallet file, by first index, until SetCache() uses them
+    std::map<int32_t, std::vector<DerivedScripts>> m_loaded_derived GUARDED_BY(cs_desc_man);
+    //! Scripts derived from the cache that are not in a derived scripts record yet
+    std::map<int32_t, DerivedScripts> m_unsaved_derived GUARDED_BY(cs_desc_man);
+
+    //! Write the unsaved derived scripts in records of DERIVED_SCRIPTS_PER_RECORD consecutive indexes
+    void WriteDerivedScripts(WalletBatch& batch) EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man);
+
     KeyMap m_map_keys GUARDED_BY(cs_desc_man);
     CryptedKeyMap m_map_crypted_keys GUARDED_BY(cs_desc_man);
 
@@ -701,6 +709,8 @@ public:
     uint256 GetID() const override;
 
     void SetCache(const DescriptorCache& cache);
+    //! Load a derived scripts record, must be called before SetCache()
+    void LoadDerivedScripts(int32_t first_index, std::vector<DerivedScripts> derived);
 
     bool AddKey(const CKeyID& key_id, const CKey& key);
     bool AddCryptedKey(const CKeyID& key_id, const CPubKey& pubkey, const std::vector<unsigned char>& crypted_key);
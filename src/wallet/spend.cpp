@@ -12,6 +12,7 @@
 #include <node/types.h>
 #include <numeric>
 #include <policy/policy.h>
+#include <pos.h>
 #include <primitives/transaction.h>
 #include <script/script.h>
 #include <script/signingprovider.h>
@@ -25,6 +26,7 @@
 #include <wallet/fees.h>
 #include <wallet/receive.h>
 #include <wallet/spend.h>
+#include <wallet/stake.h>
 #include <wallet/transaction.h>
 #include <wallet/wallet.h>
 
@@ -311,6 +313,86 @@ util::Result<PreSelectedInputs> FetchSelectedInputs(const CWallet& wallet, const
     return result;
 }
 
+//! What SpendableCoinIndex keeps of an output of the wallet, nullopt if it is not a candidate
+static std::optional<SpendableCoinIndex::Coin> MakeIndexCoin(const CWallet& wallet, const CTxOut& output)
+{
+    const isminetype mine{wallet.IsMine(output)};
+    if (mine == ISMINE_NO) return std::nullopt;
+
+    std::unique_ptr<SigningProvider> provider = wallet.GetSolvingProvider(output.scriptPubKey);
+    const bool can_grind_r = wallet.CanGrindR();
+    // Only fAllowWatchOnly of the coin control changes the size of an input without a prevout
+    CCoinControl max_sig;
+    max_sig.fAllowWatchOnly = true;
+    const int input_bytes{CalculateMaximumSignedInputSize(output, COutPoint(), provider.get(), can_grind_r, nullptr)};
+    const int input_bytes_max_sig{can_grind_r ? CalculateMaximumSignedInputSize(output, COutPoint(), provider.get(), can_grind_r, &max_sig) : input_bytes};
+    // Because CalculateMaximumSignedInputSize infers a solvable descriptor to get the satisfaction size,
+    // it is safe to assume that this input is solvable if input_bytes is greater than -1.
+    const bool solvable = input_bytes > -1;
+
+    // Obtain script type
+    std::vector<std::vector<uint8_t>> script_solutions;
+    TxoutType type = Solver(output.scriptPubKey, script_solutions);
+
+    // If the output is P2SH and solvable, we want to know if it is
+    // a P2SH (legacy) or one of P2SH-P2WPKH, P2SH-P2WSH (P2SH-Segwit). We can determine
+    // this from the redeemScript. If the output is not solvable, it will be classified
+    // as a P2SH (legacy), since we have no way of knowing otherwise without the redeemScript
+    bool is_from_p2sh{false};
+    if (type == TxoutType::SCRIPTHASH && solvable) {
+        CScript script;
+        if (!provider->GetCScript(CScriptID(uint160(script_solutions[0])), script)) return std::nullopt;
+        type = Solver(script, script_solutions);
+        is_from_p2sh = true;
+    }
+
+    return SpendableCoinIndex::Coin{output.nValue, mine, GetOutputType(type, is_from_p2sh), input_bytes, input_bytes_max_sig};
+}
+
+void UpdateCoinIndex(const CWallet& wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+    SpendableCoinIndex& index = wallet.m_coin_index;
+
+    auto index_outputs = [&](const CWalletTx& wtx, const std::set<CScript>* scripts) {
+        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+            const CTxOut& output = wtx.tx->vout[i];
+            if (scripts && !scripts->count(output.scriptPubKey)) continue;
+            const COutPoint outpoint(wtx.GetHash(), i);
+            if (wallet.IsSpent(outpoint)) {
+                index.Remove(outpoint);
+            } else if (scripts || !index.Find(outpoint)) {
+                // Scripts new to the wallet can make an output ours, or solvable
+                if (auto coin = MakeIndexCoin(wallet, output)) {
+                    index.Add(outpoint, *coin);
+                } else {
+                    index.Remove(outpoint);
+                }
+            }
+        }
+    };
+
+    std::set<CScript> new_scripts{wallet.TakeNewScriptPubKeys()};
+    if (!index.IsBuilt()) {
+        index.Reset();
+        for (const auto& [txid, wtx] : wallet.mapWallet) index_outputs(wtx, nullptr);
+        index.SetBuilt();
+        return;
+    }
+
+    for (const uint256& txid : index.TakeDirtyTxs()) {
+        auto it = wallet.mapWallet.find(txid);
+        if (it == wallet.mapWallet.end()) {
+            index.RemoveTx(txid);
+        } else {
+            index_outputs(it->second, nullptr);
+        }
+    }
+    if (!new_scripts.empty()) {
+        for (const auto& [txid, wtx] : wallet.mapWallet) index_outputs(wtx, &new_scripts);
+    }
+}
+
 CoinsResult AvailableCoins(const CWallet& wallet,
                            const CCoinControl* coinControl,
                            std::optional<CFeeRate> feerate,
@@ -325,26 +407,38 @@ CoinsResult AvailableCoins(const CWallet& wallet,
     const int min_depth = {coinControl ? coinControl->m_min_depth : DEFAULT_MIN_DEPTH};
     const int max_depth = {coinControl ? coinControl->m_max_depth : DEFAULT_MAX_DEPTH};
     const bool only_safe = {coinControl ? !coinControl->m_include_unsafe_inputs : true};
-    const bool can_grind_r = wallet.CanGrindR();
+    const bool max_sig = coinControl && coinControl->fAllowWatchOnly;
     std::vector<COutPoint> outpoints;
 
     std::set<uint256> trusted_parents;
-    for (const auto& entry : wallet.mapWallet)
-    {
-        const uint256& txid = entry.first;
-        const CWalletTx& wtx = entry.second;
+    struct TxCandidate {
+        const CWalletTx* wtx{nullptr};
+        int depth{0};
+        bool safe{false};
+        bool from_me{false};
+    };
+    //! Transaction checks of the coins seen so far, wtx null if its coins are not available
+    std::map<uint256, TxCandidate> tx_candidates;
+    auto get_tx_candidate = [&](const uint256& txid) -> const TxCandidate& {
+        auto [it, inserted] = tx_candidates.try_emplace(txid);
+        if (!inserted) return it->second;
+        TxCandidate& candidate = it->second;
+
+        auto wit = wallet.mapWallet.find(txid);
+        if (wit == wallet.mapWallet.end()) return candidate;
+        const CWalletTx& wtx = wit->second;
 
         if (wallet.IsTxImmature(wtx) && !params.include_immature_coinbase)
-            continue;
+            return candidate;
 
         int nDepth = wallet.GetTxDepthInMainChain(wtx);
         if (nDepth < 0)
-            continue;
+            return candidate;
 
         // We should not consider coins which aren't at least in our mempool
         // It's possible for these to be conflicted via ancestors which we may never be able to detect
         if (nDepth == 0 && !wtx.InMempool())
-            continue;
+            return candidate;
 
         bool safeTx = CachedTxIsTrusted(wallet, wtx, trusted_parents);
 
@@ -380,21 +474,23 @@ CoinsResult AvailableCoins(const CWallet& wallet,
         }
 
         if (only_safe && !safeTx) {
-            continue;
+            return candidate;
         }
 
         if (nDepth < min_depth || nDepth > max_depth) {
-            continue;
+            return candidate;
         }
 
-        bool tx_from_me = CachedTxIsFromMe(wallet, wtx, ISMINE_ALL);
-
-        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
-            const CTxOut& output = wtx.tx->vout[i];
-            const COutPoint outpoint(Txid::FromUint256(txid), i);
+        candidate = {&wtx, nDepth, safeTx, CachedTxIsFromMe(wallet, wtx, ISMINE_ALL)};
+        return candidate;
+    };
 
-            if (output.nValue < params.min_amount || output.nValue > params.max_amount)
-                continue;
+    // Only the unspent outputs of the wallet, by type and increasing value
+    UpdateCoinIndex(wallet);
+    for (const auto& [type, bucket] : wallet.m_coin_index.Buckets()) {
+        for (auto it = bucket.lower_bound({params.min_amount, COutPoint()}); it != bucket.end() && it->first <= params.max_amount; ++it) {
+            const COutPoint& outpoint = it->second;
+            const SpendableCoinIndex::Coin& coin = *Assert(wallet.m_coin_index.Find(outpoint));
 
             // Skip manually selected coins (the caller can fetch them directly)
             if (coinControl && coinControl->HasSelected() && coinControl->IsSelected(outpoint))
@@ -403,48 +499,26 @@ CoinsResult AvailableCoins(const CWallet& wallet,
             if (wallet.IsLockedCoin(outpoint) && params.skip_locked)
                 continue;
 
-            if (wallet.IsSpent(outpoint))
-                continue;
-
-            isminetype mine = wallet.IsMine(output);
+            const TxCandidate& candidate = get_tx_candidate(outpoint.hash.ToUint256());
+            if (!candidate.wtx) continue;
+            const CTxOut& output = candidate.wtx->tx->vout[outpoint.n];
 
-            if (mine == ISMINE_NO) {
+            if (wallet.IsSpent(outpoint))
                 continue;
-            }
 
             if (!allow_used_addresses && wallet.IsSpentKey(output.scriptPubKey)) {
                 continue;
             }
 
-            std::unique_ptr<SigningProvider> provider = wallet.GetSolvingProvider(output.scriptPubKey);
-
-            int input_bytes = CalculateMaximumSignedInputSize(output, COutPoint(), provider.get(), can_grind_r, coinControl);
-            // Because CalculateMaximumSignedInputSize infers a solvable descriptor to get the satisfaction size,
-            // it is safe to assume that this input is solvable if input_bytes is greater than -1.
+            int input_bytes = max_sig ? coin.input_bytes_max_sig : coin.input_bytes;
             bool solvable = input_bytes > -1;
-            bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && (coinControl && coinControl->fAllowWatchOnly && solvable));
+            bool spendable = ((coin.mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((coin.mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && (coinControl && coinControl->fAllowWatchOnly && solvable));
 
             // Filter by spendable outputs only
             if (!spendable && params.only_spendable) continue;
 
-            // Obtain script type
-            std::vector<std::vector<uint8_t>> script_solutions;
-            TxoutType type = Solver(output.scriptPubKey, script_solutions);
-
-            // If the output is P2SH and solvable, we want to know if it is
-            // a P2SH (legacy) or one of P2SH-P2WPKH, P2SH-P2WSH (P2SH-Segwit). We can determine
-            // this from the redeemScript. If the output is not solvable, it will be classified
-            // as a P2SH (legacy), since we have no way of knowing otherwise without the redeemScript
-            bool is_from_p2sh{false};
-            if (type == TxoutType::SCRIPTHASH && solvable) {
-                CScript script;
-                if (!provider->GetCScript(CScriptID(uint160(script_solutions[0])), script)) continue;
-                type = Solver(script, script_solutions);
-                is_from_p2sh = true;
-            }
-
-            result.Add(GetOutputType(type, is_from_p2sh),
-                       COutput(outpoint, output, nDepth, input_bytes, spendable, solvable, safeTx, wtx.GetTxTime(), tx_from_me, feerate));
+            result.Add(type,
+                       COutput(outpoint, output, candidate.depth, input_bytes, spendable, solvable, candidate.safe, candidate.wtx->GetTxTime(), candidate.from_me, feerate));
 
             outpoints.push_back(outpoint);
 
@@ -1528,4 +1602,50 @@ util::Result<CreatedTransactionResult> FundTransaction(CWallet& wallet, const CM
 
     return res;
 }
+
+util::Result<CreatedTransactionResult> CreateConsolidationTransaction(CWallet& wallet)
+{
+    LOCK(wallet.cs_wallet);
+
+    CCoinControl coin_control;
+    coin_control.m_min_depth = 1;
+    coin_control.m_allow_other_inputs = false;
+    CoinsResult available_coins = AvailableCoins(wallet, &coin_control);
+
+    // Legacy outputs are the ones that stake, merge the ones below the planned stake output size, smallest first
+    std::vector<COutput>& stake_coins = available_coins.coins[OutputType::LEGACY];
+    uint64_t weight{0};
+    for (const COutput& output : stake_coins) weight += output.txout.nValue;
+    const StakeSplitPlan plan{GetStakeSplitPlan(wallet, weight)};
+    std::sort(stake_coins.begin(), stake_coins.end(), [](const COutput& a, const COutput& b) { return a.txout.nValue < b.txout.nValue; });
+
+    CAmount total{0};
+    size_t count{0};
+    for (const COutput& output : stake_coins) {
+        if (output.txout.nValue >= plan.nTargetValue) break;
+        if (count >= GetStakeMaxCombineInputs() || total + output.txout.nValue > GetStakeSplitOutputs() * plan.nTargetValue) break;
+        coin_control.Select(output.outpoint);
+        total += output.txout.nValue;
+        ++count;
+    }
+    if (count < MIN_CONSOLIDATION_INPUTS) {
+        return util::Error{_("Not enough small outputs to consolidate")};
+    }
+
+    auto dest = wallet.GetNewChangeDestination(OutputType::LEGACY);
+    if (!dest) return util::Error{util::ErrorString(dest)};
+    return CreateTransaction(wallet, {{*dest, total, /*fSubtractFeeFromAmount=*/true}}, /*change_pos=*/std::nullopt, coin_control);
+}
+
+void MaybeConsolidateWalletCoins(WalletContext& context)
+{
+    for (const std::shared_ptr<CWallet>& pwallet : GetWallets(context)) {
+        if (pwallet->IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS) || pwallet->IsLocked() || pwallet->m_wallet_unlock_staking_only) continue;
+        auto res = CreateConsolidationTransaction(*pwallet);
+        if (!res) continue;
+        pwallet->WalletLogPrintf("%s: merging %u outputs in %s\n", __func__, res->tx->vin.size(), res->tx->GetHash().ToString());
+        pwallet->CommitTransaction(res->tx, {}, /*orderForm=*/{});
+    }
+}
+
 } // namespace wallet
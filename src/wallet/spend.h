@@ -80,8 +80,15 @@ struct CoinFilterParams {
     bool skip_locked{true};
 };
 
+/**
+ * Bring the wallet's SpendableCoinIndex up to date with the transactions
+ * changed since its last use, building it first if needed.
+ */
+void UpdateCoinIndex(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+
 /**
  * Populate the CoinsResult struct with vectors of available COutputs, organized by OutputType.
+ * Outputs of a type are in increasing value, taken from the wallet's SpendableCoinIndex.
  */
 CoinsResult AvailableCoins(const CWallet& wallet,
                            const CCoinControl* coinControl = nullptr,
@@ -225,6 +232,23 @@ util::Result<CreatedTransactionResult> CreateTransaction(CWallet& wallet, const
  * calling CreateTransaction();
  */
 util::Result<CreatedTransactionResult> FundTransaction(CWallet& wallet, const CMutableTransaction& tx, const std::vector<CRecipient>& recipients, std::optional<unsigned int> change_pos, bool lockUnspents, CCoinControl);
+
+//! Fewest outputs worth a consolidation transaction
+static constexpr size_t MIN_CONSOLIDATION_INPUTS{10};
+
+/**
+ * Merge the smallest confirmed legacy outputs below the planned stake output
+ * size (see GetStakeSplitPlan()) into one output of at most GetStakeSplitOutputs()
+ * times that size, paying the fee from it. Takes up to GetStakeMaxCombineInputs()
+ * outputs, the transaction still has to be committed.
+ */
+util::Result<CreatedTransactionResult> CreateConsolidationTransaction(CWallet& wallet);
+
+/**
+ * Called periodically by the scheduler with -consolidatedust. Commits a
+ * consolidation transaction for each unlocked wallet that has enough small outputs.
+ */
+void MaybeConsolidateWalletCoins(WalletContext& context);
 } // namespace wallet
 
 #endif // BITCOIN_WALLET_SPEND_H
@@ -148,6 +148,15 @@ SQLiteDatabase::SQLiteDatabase(const fs::path& dir_path, const fs::path& file_pa
 
 void SQLiteBatch::SetupSQLStatements()
 {
+    if (const auto statements{m_database.TakeStatements()}) {
+        m_read_stmt = (*statements)[0];
+        m_insert_stmt = (*statements)[1];
+        m_overwrite_stmt = (*statements)[2];
+        m_delete_stmt = (*statements)[3];
+        m_delete_prefix_stmt = (*statements)[4];
+        return;
+    }
+
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "SELECT value FROM main WHERE key = ?"},
         {&m_insert_stmt, "INSERT INTO main VALUES(?, ?)"},
@@ -372,6 +381,8 @@ bool SQLiteDatabase::Backup(const std::string& dest) const
 
 void SQLiteDatabase::Close()
 {
+    // Statements have to be finalized before the connection can be closed
+    FinalizeStatements();
     int res = sqlite3_close(m_db);
     if (res != SQLITE_OK) {
         throw std::runtime_error(strprintf("SQLiteDatabase: Failed to close database: %s\n", sqlite3_errstr(res)));
@@ -379,6 +390,56 @@ void SQLiteDatabase::Close()
     m_db = nullptr;
 }
 
+std::optional<SQLiteDatabase::Statements> SQLiteDatabase::TakeStatements()
+{
+    LOCK(m_statements_mutex);
+    if (m_statements.empty()) return std::nullopt;
+    Statements statements{m_statements.back()};
+    m_statements.pop_back();
+    return statements;
+}
+
+void SQLiteDatabase::ReturnStatements(const Statements& statements)
+{
+    LOCK(m_statements_mutex);
+    m_statements.push_back(statements);
+}
+
+void SQLiteDatabase::FinalizeStatements()
+{
+    LOCK(m_statements_mutex);
+    for (const Statements& statements : m_statements) {
+        for (sqlite3_stmt* stmt : statements) sqlite3_finalize(stmt);
+    }
+    m_statements.clear();
+}
+
+bool SQLiteDatabase::BeginBulkWrite()
+{
+    if (!m_db || InBulkWrite()) return false;
+    m_write_semaphore.wait();
+    if (HasActiveTxn() || sqlite3_exec(m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        LogPrintf("SQLiteDatabase: Failed to begin the bulk write transaction\n");
+        m_write_semaphore.post();
+        return false;
+    }
+    m_bulk_thread = std::this_thread::get_id();
+    return true;
+}
+
+bool SQLiteDatabase::EndBulkWrite()
+{
+    if (!m_db || !InBulkWrite()) return false;
+    int res = sqlite3_exec(m_db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+    if (res != SQLITE_OK) {
+        LogPrintf("SQLiteDatabase: Failed to commit the bulk write transaction: %s\n", sqlite3_errstr(res));
+        sqlite3_exec(m_db, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
+    }
+    m_bulk_thread = std::thread::id{};
+    m_write_semaphore.post();
+    return res == SQLITE_OK;
+}
+
 bool SQLiteDatabase::HasActiveTxn()
 {
     // 'sqlite3_get_autocommit' returns true by default, and false if a transaction has begun and not been committed or rolled back.
@@ -410,7 +471,11 @@ void SQLiteBatch::Close()
     bool force_conn_refresh = false;
 
     // If we began a transaction, and it wasn't committed, abort the transaction in progress
-    if (m_txn) {
+    if (m_txn && m_savepoint) {
+        if (TxnAbort()) {
+            LogPrintf("SQLiteBatch: Batch closed unexpectedly without the transaction being explicitly committed or aborted\n");
+        }
+    } else if (m_txn) {
         if (TxnAbort()) {
             LogPrintf("SQLiteBatch: Batch closed unexpectedly without the transaction being explicitly committed or aborted\n");
         } else {
@@ -422,6 +487,13 @@ void SQLiteBatch::Close()
         }
     }
 
+    // Hand the prepared statements to the next batch, unless the connection is reset
+    if (!force_conn_refresh && m_read_stmt && m_insert_stmt && m_overwrite_stmt && m_delete_stmt && m_delete_prefix_stmt) {
+        m_database.ReturnStatements({m_read_stmt, m_insert_stmt, m_overwrite_stmt, m_delete_stmt, m_delete_prefix_stmt});
+        m_read_stmt = m_insert_stmt = m_overwrite_stmt = m_delete_stmt = m_delete_prefix_stmt = nullptr;
+        return;
+    }
+
     // Free all of the prepared statements
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "read"},
@@ -497,8 +569,10 @@ bool SQLiteBatch::WriteKey(DataStream&& key, DataStream&& value, bool overwrite)
     if (!BindBlobToStatement(stmt, 1, key, "key")) return false;
     if (!BindBlobToStatement(stmt, 2, value, "value")) return false;
 
-    // Acquire semaphore if not previously acquired when creating a transaction.
-    if (!m_txn) m_database.m_write_semaphore.wait();
+    // Acquire semaphore if not previously acquired when creating a transaction,
+    // or by the bulk write of this thread.
+    const bool acquire{!m_txn && !m_database.InBulkWrite()};
+    if (acquire) m_database.m_write_semaphore.wait();
 
     // Execute
     int res = sqlite3_step(stmt);
@@ -508,7 +582,7 @@ bool SQLiteBatch::WriteKey(DataStream&& key, DataStream&& value, bool overwrite)
         LogPrintf("%s: Unable to execute statement: %s\n", __func__, sqlite3_errstr(res));
     }
 
-    if (!m_txn) m_database.m_write_semaphore.post();
+    if (acquire) m_database.m_write_semaphore.post();
 
     return res == SQLITE_DONE;
 }
@@ -521,8 +595,10 @@ bool SQLiteBatch::ExecStatement(sqlite3_stmt* stmt, Span<const std::byte> blob)
     // Bind: leftmost parameter in statement is index 1
     if (!BindBlobToStatement(stmt, 1, blob, "key")) return false;
 
-    // Acquire semaphore if not previously acquired when creating a transaction.
-    if (!m_txn) m_database.m_write_semaphore.wait();
+    // Acquire semaphore if not previously acquired when creating a transaction,
+    // or by the bulk write of this thread.
+    const bool acquire{!m_txn && !m_database.InBulkWrite()};
+    if (acquire) m_database.m_write_semaphore.wait();
 
     // Execute
     int res = sqlite3_step(stmt);
@@ -532,7 +608,7 @@ bool SQLiteBatch::ExecStatement(sqlite3_stmt* stmt, Span<const std::byte> blob)
         LogPrintf("%s: Unable to execute statement: %s\n", __func__, sqlite3_errstr(res));
     }
 
-    if (!m_txn) m_database.m_write_semaphore.post();
+    if (acquire) m_database.m_write_semaphore.post();
 
     return res == SQLITE_DONE;
 }
@@ -651,6 +727,15 @@ std::unique_ptr<DatabaseCursor> SQLiteBatch::GetNewPrefixCursor(Span<const std::
 bool SQLiteBatch::TxnBegin()
 {
     if (!m_database.m_db || m_txn) return false;
+    if (m_database.InBulkWrite()) {
+        // Nested in the bulk write, which already holds the semaphore
+        if (Assert(m_exec_handler)->Exec(m_database, "SAVEPOINT batch") != SQLITE_OK) {
+            LogPrintf("SQLiteBatch: Failed to begin the transaction\n");
+            return false;
+        }
+        m_txn = m_savepoint = true;
+        return true;
+    }
     m_database.m_write_semaphore.wait();
     Assert(!m_database.HasActiveTxn());
     int res = Assert(m_exec_handler)->Exec(m_database, "BEGIN TRANSACTION");
@@ -667,6 +752,15 @@ bool SQLiteBatch::TxnCommit()
 {
     if (!m_database.m_db || !m_txn) return false;
     Assert(m_database.HasActiveTxn());
+    if (m_savepoint) {
+        int res = Assert(m_exec_handler)->Exec(m_database, "RELEASE SAVEPOINT batch");
+        if (res != SQLITE_OK) {
+            LogPrintf("SQLiteBatch: Failed to commit the transaction\n");
+        } else {
+            m_txn = m_savepoint = false;
+        }
+        return res == SQLITE_OK;
+    }
     int res = Assert(m_exec_handler)->Exec(m_database, "COMMIT TRANSACTION");
     if (res != SQLITE_OK) {
         LogPrintf("SQLiteBatch: Failed to commit the transaction\n");
@@ -681,6 +775,16 @@ bool SQLiteBatch::TxnAbort()
 {
     if (!m_database.m_db || !m_txn) return false;
     Assert(m_database.HasActiveTxn());
+    if (m_savepoint) {
+        int res = Assert(m_exec_handler)->Exec(m_database, "ROLLBACK TRANSACTION TO SAVEPOINT batch");
+        if (res == SQLITE_OK) res = Assert(m_exec_handler)->Exec(m_database, "RELEASE SAVEPOINT batch");
+        if (res != SQLITE_OK) {
+            LogPrintf("SQLiteBatch: Failed to abort the transaction\n");
+        } else {
+            m_txn = m_savepoint = false;
+        }
+        return res == SQLITE_OK;
+    }
     int res = Assert(m_exec_handler)->Exec(m_database, "ROLLBACK TRANSACTION");
     if (res != SQLITE_OK) {
         LogPrintf("SQLiteBatch: Failed to abort the transaction\n");
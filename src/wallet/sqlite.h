@@ -8,6 +8,12 @@
 #include <sync.h>
 #include <wallet/db.h>
 
+#include <array>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
 struct bilingual_str;
 
 struct sqlite3_stmt;
@@ -69,6 +75,9 @@ private:
      * not just when any batch has started a transaction.
      */
     bool m_txn{false};
+    /** Whether the transaction this batch began is a savepoint nested in a bulk write, see
+     * SQLiteDatabase::BeginBulkWrite(). The bulk write owns the semaphore then. */
+    bool m_savepoint{false};
 
     void SetupSQLStatements();
     bool ExecStatement(sqlite3_stmt* stmt, Span<const std::byte> blob);
@@ -165,6 +174,19 @@ public:
 
     void IncrementUpdateCounter() override { ++nUpdateCounter; }
 
+    bool BeginBulkWrite() override;
+    bool EndBulkWrite() override;
+
+    /** Whether the calling thread has a bulk write active, its batches write without the semaphore */
+    bool InBulkWrite() const { return m_bulk_thread.load() == std::this_thread::get_id(); }
+
+    //! read, insert, overwrite, delete and delete prefix statements of a batch
+    using Statements = std::array<sqlite3_stmt*, 5>;
+
+    /** Prepared statements of a closed batch, to be reused by a new one */
+    std::optional<Statements> TakeStatements() EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
+    void ReturnStatements(const Statements& statements) EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
+
     std::string Filename() override { return m_file_path; }
     std::string Format() override { return "sqlite"; }
 
@@ -176,6 +198,13 @@ public:
 
     sqlite3* m_db{nullptr};
     bool m_use_unsafe_sync;
+
+private:
+    std::atomic<std::thread::id> m_bulk_thread{};
+
+    Mutex m_statements_mutex;
+    std::vector<Statements> m_statements GUARDED_BY(m_statements_mutex);
+    void FinalizeStatements() EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
 };
 
 std::unique_ptr<SQLiteDatabase> MakeSQLiteDatabase(const fs::path& path, const DatabaseOptions& options, DatabaseStatus& status, bilingual_str& error);
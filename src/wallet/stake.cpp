@@ -1,13 +1,17 @@
 #include <wallet/stake.h>
 #include <wallet/receive.h>
+#include <wallet/spend.h>
 #include <node/miner.h>
 #include <qtum/qtumledger.h>
 #include <pos.h>
+#include <rpc/server.h>
 #include <key_io.h>
 #include <common/args.h>
 #include <chainparams.h>
 #include <util/moneystr.h>
 
+#include <unordered_set>
+
 namespace wallet {
 
 void StakeQtums(CWallet& wallet, bool fStake)
@@ -44,6 +48,7 @@ void StopStake(CWallet& wallet)
     {
         wallet.m_stop_staking_thread = true;
         wallet.m_enabled_staking = false;
+        wallet.WakeStaker();
         StakeQtums(wallet, false);
         wallet.stakeThread = 0;
         wallet.m_stop_staking_thread = false;
@@ -52,6 +57,15 @@ void StopStake(CWallet& wallet)
     wallet.m_is_staking_thread_stopped = true;
 }
 
+StakeSplitPlan GetStakeSplitPlan(const CWallet& wallet, uint64_t nWeight)
+{
+    ChainstateManager& chainman = wallet.chain().chainman();
+    LOCK(cs_main);
+    int nHeight = chainman.m_best_header ? chainman.m_best_header->nHeight : 0;
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    return ::GetStakeSplitPlan(GetPoSKernelPS(chainman), nWeight, consensusParams.StakeMinConfirmations(nHeight), consensusParams.TargetSpacing(nHeight));
+}
+
 bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, PKHash& pkhash, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, std::vector<COutPoint>& setSelectedCoins, bool selectedOnly, bool sign, COutPoint& headerPrevout)
 {
     bool fAllowWatchOnly = wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
@@ -82,10 +96,13 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
     if (setCoins.empty())
         return false;
 
-    if(wallet.stakeCache.size() > setCoins.size() + 100){
-        //Determining if the cache is still valid is harder than just clearing it when it gets too big, so instead just clear it
-        //when it has more than 100 entries more than the actual setCoins.
-        wallet.stakeCache.clear();
+    if(wallet.stakeCache.Size() > setCoins.size() + 100){
+        //Spent coins are dropped as blocks connect, so entries only pile up for coins no longer staked.
+        //Drop those when there are more than 100 of them instead of reloading every coin.
+        std::unordered_set<COutPoint, SaltedOutpointHasher> staked;
+        for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+            staked.insert(COutPoint(pcoin.first->GetHash(), pcoin.second));
+        wallet.stakeCache.EraseIf([&staked](const COutPoint& prevout) { return staked.count(prevout) == 0; });
     }
     if(!wallet.fHasMinerStakeCache && gArgs.GetBoolArg("-stakecache", node::DEFAULT_STAKE_CACHE)) {
 
@@ -96,7 +113,7 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
             CacheKernel(wallet.stakeCache, prevoutStake, pindexPrev, wallet.chain().getCoinsTip()); //this will do a 2 disk loads per op
         }
     }
-    std::map<COutPoint, CStakeCache>& cache = wallet.fHasMinerStakeCache ? wallet.minerStakeCache : wallet.stakeCache;
+    StakeCacheMap& cache = wallet.fHasMinerStakeCache ? wallet.minerStakeCache : wallet.stakeCache;
     int64_t nCredit = 0;
     CScript scriptPubKeyKernel;
     CScript aggregateScriptPubKeyHashKernel;
@@ -122,6 +139,7 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
         // Search backward in time from the given txNew timestamp
         // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
         COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+        StakerStats::Add(cache.Contains(prevoutStake) ? wallet.m_staker_stats.cache_hits : wallet.m_staker_stats.cache_misses, 1);
         if (CheckKernel(pindexPrev, nBits, nTimeBlock, prevoutStake, wallet.chain().getCoinsTip(), cache, wallet.chain().chainman().ActiveChainstate()))
         {
             // Found a kernel
@@ -197,6 +215,12 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
     if (nCredit == 0 || nCredit > nBalance - wallet.m_reserve_balance)
         return false;
 
+    // Combine the outputs below the planned size into the kernel, and split it when it is worth several of them
+    uint64_t nWeight = 0;
+    for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+        nWeight += pcoin.first->tx->vout[pcoin.second].nValue;
+    const StakeSplitPlan plan = GetStakeSplitPlan(wallet, nWeight);
+
     for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
     {
         // Attempt to add more inputs
@@ -211,7 +235,7 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
             if (nCredit + pcoin.first->tx->vout[pcoin.second].nValue > nBalance - wallet.m_reserve_balance)
                 break;
             // Do not add additional significant input
-            if (pcoin.first->tx->vout[pcoin.second].nValue >= GetStakeCombineThreshold())
+            if (pcoin.first->tx->vout[pcoin.second].nValue >= plan.nTargetValue)
                 continue;
 
             txNew.vin.push_back(CTxIn(pcoin.first->GetHash(), pcoin.second));
@@ -254,19 +278,17 @@ bool CreateCoinStakeFromMine(CWallet& wallet, unsigned int nBits, const CAmount&
         }
    }
 
-    if (nCredit >= GetStakeSplitThreshold())
-    {
-        for(unsigned int i = 0; i < GetStakeSplitOutputs() - 1; i++)
-            txNew.vout.push_back(CTxOut(0, txNew.vout[1].scriptPubKey)); //split stake
-    }
+    const unsigned int nSplitOutputs = plan.SplitOutputs(nCredit);
+    for(unsigned int i = 1; i < nSplitOutputs; i++)
+        txNew.vout.push_back(CTxOut(0, txNew.vout[1].scriptPubKey)); //split stake
 
     // Set output amount
-    if (txNew.vout.size() == GetStakeSplitOutputs() + 1)
+    if (nSplitOutputs > 1)
     {
-        CAmount nValue = (nCredit / GetStakeSplitOutputs() / CENT) * CENT;
-        for(unsigned int i = 1; i < GetStakeSplitOutputs(); i++)
+        CAmount nValue = (nCredit / nSplitOutputs / CENT) * CENT;
+        for(unsigned int i = 1; i < nSplitOutputs; i++)
             txNew.vout[i].nValue = nValue;
-        txNew.vout[GetStakeSplitOutputs()].nValue = nCredit - nValue * (GetStakeSplitOutputs() - 1);
+        txNew.vout[nSplitOutputs].nValue = nCredit - nValue * (nSplitOutputs - 1);
     }
     else
         txNew.vout[1].nValue = nCredit;
@@ -316,10 +338,11 @@ bool CreateCoinStakeFromDelegate(CWallet& wallet, unsigned int nBits, const CAmo
     if (setDelegateCoins.empty())
         return false;
 
-    if(wallet.stakeDelegateCache.size() > setDelegateCoins.size() + 100){
-        //Determining if the cache is still valid is harder than just clearing it when it gets too big, so instead just clear it
-        //when it has more than 100 entries more than the actual setCoins.
-        wallet.stakeDelegateCache.clear();
+    if(wallet.stakeDelegateCache.Size() > setDelegateCoins.size() + 100){
+        //Spent coins are dropped as blocks connect, so entries only pile up for coins no longer staked.
+        //Drop those when there are more than 100 of them instead of reloading every coin.
+        std::unordered_set<COutPoint, SaltedOutpointHasher> staked(setDelegateCoins.begin(), setDelegateCoins.end());
+        wallet.stakeDelegateCache.EraseIf([&staked](const COutPoint& prevout) { return staked.count(prevout) == 0; });
     }
     if(!wallet.fHasMinerStakeCache && gArgs.GetBoolArg("-stakecache", node::DEFAULT_STAKE_CACHE)) {
 
@@ -329,7 +352,7 @@ bool CreateCoinStakeFromDelegate(CWallet& wallet, unsigned int nBits, const CAmo
             CacheKernel(wallet.stakeDelegateCache, prevoutStake, pindexPrev, wallet.chain().getCoinsTip()); //this will do a 2 disk loads per op
         }
     }
-    std::map<COutPoint, CStakeCache>& cache = wallet.fHasMinerStakeCache ? wallet.minerStakeCache : wallet.stakeDelegateCache;
+    StakeCacheMap& cache = wallet.fHasMinerStakeCache ? wallet.minerStakeCache : wallet.stakeDelegateCache;
     int64_t nCredit = 0;
     CScript scriptPubKeyKernel;
     CScript scriptPubKeyStaker;
@@ -342,6 +365,7 @@ bool CreateCoinStakeFromDelegate(CWallet& wallet, unsigned int nBits, const CAmo
         boost::this_thread::interruption_point();
         // Search backward in time from the given txNew timestamp
         // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
+        StakerStats::Add(cache.Contains(prevoutStake) ? wallet.m_staker_stats.cache_hits : wallet.m_staker_stats.cache_misses, 1);
         if (CheckKernel(pindexPrev, nBits, nTimeBlock, prevoutStake, wallet.chain().getCoinsTip(), cache, wallet.chain().chainman().ActiveChainstate()))
         {
             // Found a kernel
@@ -588,6 +612,33 @@ void AvailableCoinsForStaking(const CWallet& wallet, const std::vector<uint256>&
     }
 }
 
+//! Get the unspent outputs of a delegate, seeding its tracker entry from the address index the first time
+static bool GetDelegateCoins(const CWallet& wallet, const uint160& delegate, std::vector<std::pair<COutPoint, DelegationWeightTracker::Coin>>& coins)
+{
+    if (wallet.m_delegations_tracker.GetCoins(delegate, coins))
+        return true;
+
+    // Decode address
+    uint256 hashBytes;
+    int type = 0;
+    if (!DecodeIndexKey(EncodeDestination(PKHash(delegate)), hashBytes, type)) {
+        LogError("Invalid address");
+        return false;
+    }
+
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
+    if (!GetAddressUnspent(hashBytes, type, unspentOutputs)) {
+        LogError("No information available for address");
+        return false;
+    }
+
+    for (const auto& [key, value] : unspentOutputs) {
+        coins.emplace_back(COutPoint(Txid::FromUint256(key.txhash), key.index), DelegationWeightTracker::Coin{value.satoshis, value.blockHeight});
+    }
+    wallet.m_delegations_tracker.Seed(delegate, coins);
+    return true;
+}
+
 bool AvailableDelegateCoinsForStaking(const CWallet& wallet, const std::vector<uint160>& delegations, size_t from, size_t to, int32_t height, const std::map<COutPoint, uint32_t>& immatureStakes,  const std::map<uint256, CSuperStakerInfo>& mapStakers, std::vector<std::pair<COutPoint,CAmount>>& vUnsortedDelegateCoins, std::map<uint160, CAmount> &mDelegateWeight)
 {
     for(size_t i = from; i < to; i++)
@@ -595,7 +646,6 @@ bool AvailableDelegateCoinsForStaking(const CWallet& wallet, const std::vector<u
         std::map<uint160, Delegation>::const_iterator it = wallet.m_delegations_staker.find(delegations[i]);
         if(it == wallet.m_delegations_staker.end()) continue;
 
-        const PKHash& keyid = PKHash(it->first);
         const Delegation* delegation = &(*it).second;
 
         // Set default delegate stake weight
@@ -622,37 +672,27 @@ bool AvailableDelegateCoinsForStaking(const CWallet& wallet, const std::vector<u
         if(delegation->fee < staking_min_fee)
             continue;
 
-        // Decode address
-        uint256 hashBytes;
-        int type = 0;
-        if (!DecodeIndexKey(EncodeDestination(keyid), hashBytes, type)) {
-            LogError("Invalid address");
-            return false;
-        }
-
         // Get address utxos
-        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
-        if (!GetAddressUnspent(hashBytes, type, unspentOutputs, wallet.chain().chainman().m_blockman)) {
-            LogError("No information available for address");
+        std::vector<std::pair<COutPoint, DelegationWeightTracker::Coin>> coins;
+        if (!GetDelegateCoins(wallet, it->first, coins)) {
             return false;
         }
 
         // Add the utxos to the list if they are mature and at least the minimum value
         int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(height + 1);
-        for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator i=unspentOutputs.begin(); i!=unspentOutputs.end(); i++) {
+        for (const auto& [prevout, coin] : coins) {
 
-            int nDepth = height - i->second.blockHeight + 1;
+            int nDepth = height - coin.height + 1;
             if (nDepth < coinbaseMaturity)
                 continue;
 
-            if(i->second.satoshis < staking_min_utxo_value)
+            if(coin.value < staking_min_utxo_value)
                 continue;
 
-            COutPoint prevout = COutPoint(Txid::FromUint256(i->first.txhash), i->first.index);
             if(immatureStakes.find(prevout) == immatureStakes.end())
             {
-                vUnsortedDelegateCoins.push_back(std::make_pair(prevout, i->second.satoshis));
-                weight+= i->second.satoshis;
+                vUnsortedDelegateCoins.push_back(std::make_pair(prevout, coin.value));
+                weight+= coin.value;
             }
         }
 
@@ -713,15 +753,19 @@ bool SelectCoinsForStaking(const CWallet& wallet, CAmount &nTargetValue, std::se
     std::vector<uint256> maturedTx;
     const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
     const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
-    for (auto it = wallet.mapWallet.begin(); it != wallet.mapWallet.end(); ++it)
+    // Only the transactions with unspent outputs of the wallet
+    UpdateCoinIndex(wallet);
+    for (const uint256& wtxid : wallet.m_coin_index.GetTxids())
     {
+        auto it = wallet.mapWallet.find(wtxid);
+        if (it == wallet.mapWallet.end()) continue;
+
         // Check the cached data for available coins for the tx
         const CWalletTx* pcoin = &(*it).second;
         const CAmount tx_credit_mine{CachedTxGetAvailableCredit(wallet, *pcoin, is_mine_filter | ISMINE_NO)};
         if(tx_credit_mine == 0)
             continue;
 
-        const uint256& wtxid = it->first;
         int nDepth = wallet.GetTxDepthInMainChain(*pcoin);
 
         if (nDepth < 1)
@@ -944,8 +988,10 @@ void SelectAddress(const CWallet& wallet, std::map<uint160, bool> &mapAddress)
 
 void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<COutPoint> &prevouts, CBlockIndex *pindexPrev )
 {
-    if(wallet.minerStakeCache.size() > prevouts.size() + 100){
-        wallet.minerStakeCache.clear();
+    if(wallet.minerStakeCache.Size() > prevouts.size() + 100){
+        // Spent coins are dropped as blocks connect; drop the ones no longer staked
+        std::unordered_set<COutPoint, SaltedOutpointHasher> staked(prevouts.begin(), prevouts.end());
+        wallet.minerStakeCache.EraseIf([&staked](const COutPoint& prevout) { return staked.count(prevout) == 0; });
     }
 
     if(fStakeCache)
@@ -959,6 +1005,26 @@ void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<
     }
 }
 
+void RefreshDelegationsWeight(CWallet& wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+
+    DelegationWeightTracker::Snapshot snapshot;
+    snapshot.height = wallet.chain().getHeight().value_or(-1);
+    if(snapshot.height < 0)
+        return;
+
+    std::vector<COutPoint> vDelegateCoins;
+    if(!SelectDelegateCoinsForStaking(wallet, vDelegateCoins, snapshot.weights))
+        return;
+
+    for(const auto& [delegate, weight] : snapshot.weights)
+        snapshot.total += weight;
+
+    wallet.updateDelegationsWeight(snapshot.weights);
+    wallet.m_delegations_tracker.SetSnapshot(std::move(snapshot));
+}
+
 uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight, uint64_t* pDelegateWeight)
 {
     uint64_t nWeight = 0;
@@ -1005,19 +1071,16 @@ uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight, uint64_t
 
     if(canSuperStake)
     {
-        // Get the weight of the delegated coins
-        std::vector<COutPoint> vDelegateCoins;
-        std::map<uint160, CAmount> mDelegateWeight;
-        SelectDelegateCoinsForStaking(wallet, vDelegateCoins, mDelegateWeight);
-        for(const COutPoint &prevout : vDelegateCoins)
+        // Get the weight of the delegated coins, as of the last block the wallet processed
+        DelegationWeightTracker::Snapshot snapshot = wallet.m_delegations_tracker.GetSnapshot();
+        if(snapshot.height < 0)
         {
-            Coin coinPrev;
-            if(!wallet.chain().getUnspentOutput(prevout, coinPrev)){
-                continue;
-            }
-
-            nDelegateWeight += coinPrev.out.nValue;
+            std::vector<COutPoint> vDelegateCoins;
+            SelectDelegateCoinsForStaking(wallet, vDelegateCoins, snapshot.weights);
+            for(const auto& [delegate, weight] : snapshot.weights)
+                snapshot.total += weight;
         }
+        nDelegateWeight = snapshot.total;
     }
 
     nWeight = nStakerWeight + nDelegateWeight;
@@ -5,6 +5,8 @@
 #include <wallet/transaction.h>
 #include <wallet/wallet.h>
 
+struct StakeSplitPlan;
+
 namespace wallet {
 /* Start staking qtums */
 void StartStake(CWallet& wallet);
@@ -12,6 +14,9 @@ void StartStake(CWallet& wallet);
 /* Stop staking qtums */
 void StopStake(CWallet& wallet);
 
+/* Plan the size of the wallet's stake outputs for its weight, from the network weight at the tip */
+StakeSplitPlan GetStakeSplitPlan(const CWallet& wallet, uint64_t nWeight);
+
 /* Create coin stake */
 bool CreateCoinStake(CWallet& wallet, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, PKHash& pkhash, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, std::vector<COutPoint>& setSelectedCoins, std::vector<COutPoint>& setDelegateCoins, bool selectedOnly, bool sign, std::vector<unsigned char>& vchPoD, COutPoint& headerPrevout);
 
@@ -27,6 +32,9 @@ void SelectAddress(const CWallet& wallet, std::map<uint160, bool>& mapAddress);
 //! update miner stake cache.
 void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<COutPoint>& prevouts, CBlockIndex* pindexPrev);
 
+//! recompute the delegations weight snapshot from the tracked delegate coins.
+void RefreshDelegationsWeight(CWallet& wallet);
+
 //! get stake weight.
 uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr);
 
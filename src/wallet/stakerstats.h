@@ -0,0 +1,73 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_STAKERSTATS_H
+#define BITCOIN_WALLET_STAKERSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace wallet {
+
+/**
+ * StakerStats - Counters of a wallet's staking thread, reported by getstakerstats.
+ *
+ * Updated with relaxed atomics from the staking loop, so reading them never
+ * waits on the staker. Durations are accumulated in microseconds.
+ */
+struct StakerStats {
+    //! Kernel hashes evaluated, and the time spent evaluating them
+    std::atomic<uint64_t> kernels{0};
+    std::atomic<uint64_t> kernel_micros{0};
+
+    //! Stake cache lookups for kernel checks, found and not found
+    std::atomic<uint64_t> cache_hits{0};
+    std::atomic<uint64_t> cache_misses{0};
+
+    //! Tips the staker prepared for, and the candidate blocks it built on them
+    std::atomic<uint64_t> tips{0};
+    std::atomic<uint64_t> candidates{0};
+    //! From noticing a tip to the first candidate block built on it
+    std::atomic<uint64_t> tip_to_candidate_micros{0};
+    std::atomic<uint64_t> last_tip_to_candidate_micros{0};
+
+    //! Block signatures by the wallet's keys and by a hardware device
+    std::atomic<uint64_t> signatures{0};
+    std::atomic<uint64_t> signature_micros{0};
+    std::atomic<uint64_t> hardware_signatures{0};
+    std::atomic<uint64_t> hardware_signature_micros{0};
+
+    //! Blocks submitted and accepted, and slots with a kernel that produced none
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> missed_slots{0};
+
+    //! When the counters were last reset
+    std::atomic<int64_t> reset_time{0};
+
+    static void Add(std::atomic<uint64_t>& counter, uint64_t value)
+    {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static uint64_t Micros(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+
+    void Reset(int64_t now)
+    {
+        for (std::atomic<uint64_t>* counter : {&kernels, &kernel_micros, &cache_hits, &cache_misses, &tips, &candidates,
+                                               &tip_to_candidate_micros, &last_tip_to_candidate_micros, &signatures,
+                                               &signature_micros, &hardware_signatures, &hardware_signature_micros,
+                                               &blocks, &missed_slots}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        reset_time = now;
+    }
+};
+
+} // namespace wallet
+
+#endif // BITCOIN_WALLET_STAKERSTATS_H
@@ -13,10 +13,130 @@
 #include <streams.h>
 #include <util/fs.h>
 
+#include <secp256k1.h>
+
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <thread>
 
 namespace wallet {
 
+namespace {
+
+const secp256k1_context* StealthScanContext()
+{
+    static secp256k1_context* const ctx{secp256k1_context_create(SECP256K1_CONTEXT_NONE)};
+    return ctx;
+}
+
+//! The keys of one stealth address, parsed once for a whole scan
+struct ScanKey
+{
+    uint256 addrHash;
+    CKey scanPrivKey;
+    CKey spendPrivKey;
+    secp256k1_pubkey spendPubKey;
+};
+
+std::vector<ScanKey> MakeScanKeys(const std::map<uint256, CStealthAddressData>& addresses)
+{
+    std::vector<ScanKey> keys;
+    keys.reserve(addresses.size());
+    for (const auto& [addrHash, addrData] : addresses) {
+        ScanKey key;
+        key.addrHash = addrHash;
+        key.scanPrivKey = addrData.scanPrivKey;
+        key.spendPrivKey = addrData.spendPrivKey;
+        const CPubKey& spendPubKey = addrData.address.spendPubKey;
+        if (!key.spendPrivKey.IsValid() ||
+            !secp256k1_ec_pubkey_parse(StealthScanContext(), &key.spendPubKey, spendPubKey.data(), spendPubKey.size())) {
+            continue;
+        }
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+/**
+ * Find the outputs of a transaction paying one of the keys. Reads no wallet
+ * state, so blocks can be scanned on several threads.
+ *
+ * An output with one-time key P pays an address when
+ * P == spend_pubkey + H(scan_privkey * R, index)*G. The ephemeral key R is
+ * not yet carried by the transaction, so the output key stands in for it.
+ * Per address and output this costs one ECDH and one fixed-base
+ * multiplication; the spending key is only derived for a match.
+ */
+std::vector<CStealthPayment> ScanTransaction(const std::vector<ScanKey>& keys, const CTransaction& tx, int blockHeight)
+{
+    const secp256k1_context* ctx = StealthScanContext();
+    std::vector<CStealthPayment> payments;
+
+    for (uint32_t i = 0; i < tx.vout.size(); i++) {
+        const CTxOut& txout = tx.vout[i];
+
+        // Only compressed P2PK outputs can be stealth
+        std::vector<std::vector<unsigned char>> solutions;
+        if (Solver(txout.scriptPubKey, solutions) != TxoutType::PUBKEY || solutions.empty() ||
+            solutions[0].size() != CPubKey::COMPRESSED_SIZE) {
+            continue;
+        }
+        secp256k1_pubkey outputPoint;
+        if (!secp256k1_ec_pubkey_parse(ctx, &outputPoint, solutions[0].data(), solutions[0].size())) {
+            continue;
+        }
+        const CPubKey outputPubKey(solutions[0]);
+
+        for (const ScanKey& key : keys) {
+            // S = scan_privkey * R
+            secp256k1_pubkey shared = outputPoint;
+            if (!secp256k1_ec_pubkey_tweak_mul(ctx, &shared, UCharCast(key.scanPrivKey.begin()))) {
+                continue;
+            }
+            unsigned char sharedData[CPubKey::COMPRESSED_SIZE];
+            size_t len = sizeof(sharedData);
+            secp256k1_ec_pubkey_serialize(ctx, sharedData, &len, &shared, SECP256K1_EC_COMPRESSED);
+            const uint256 scalarHash = privacy::HashSharedSecret(CPubKey(sharedData, sharedData + len), i);
+
+            // P' = spend_pubkey + h*G
+            secp256k1_pubkey expected = key.spendPubKey;
+            if (!secp256k1_ec_pubkey_tweak_add(ctx, &expected, scalarHash.begin())) {
+                continue;
+            }
+            unsigned char expectedData[CPubKey::COMPRESSED_SIZE];
+            len = sizeof(expectedData);
+            secp256k1_ec_pubkey_serialize(ctx, expectedData, &len, &expected, SECP256K1_EC_COMPRESSED);
+            if (!std::equal(expectedData, expectedData + len, outputPubKey.begin())) {
+                continue;
+            }
+
+            // Spending key: spend_privkey + h
+            unsigned char derivedData[32];
+            std::copy(UCharCast(key.spendPrivKey.begin()), UCharCast(key.spendPrivKey.end()), derivedData);
+            if (!secp256k1_ec_seckey_tweak_add(ctx, derivedData, scalarHash.begin())) {
+                continue;
+            }
+
+            CStealthPayment payment;
+            payment.txid = tx.GetHash();
+            payment.nOutput = i;
+            payment.nValue = txout.nValue;
+            payment.oneTimePubKey = outputPubKey;
+            payment.derivedPrivKey.Set(derivedData, derivedData + 32, true);
+            payment.stealthAddressHash = key.addrHash;
+            payment.blockHeight = blockHeight;
+            payment.spent = false;
+            payments.push_back(std::move(payment));
+            break;
+        }
+    }
+
+    return payments;
+}
+
+} // namespace
+
 CStealthAddressManager::CStealthAddressManager(CWallet* wallet)
     : m_wallet(wallet)
 {
@@ -119,67 +239,26 @@ std::optional<CStealthAddressData> CStealthAddressManager::GetStealthAddressByHa
     return std::nullopt;
 }
 
-std::optional<CStealthPayment> CStealthAddressManager::TryDetectPayment(
-    const CTxOut& txout,
-    uint32_t outputIndex,
-    const uint256& txid,
-    int blockHeight)
+void CStealthAddressManager::RecordPayment(const CStealthPayment& payment)
 {
-    // Extract pubkey from output
-    std::vector<std::vector<unsigned char>> solutions;
-    TxoutType type = Solver(txout.scriptPubKey, solutions);
-
-    CPubKey outputPubKey;
-    if (type == TxoutType::PUBKEY && solutions.size() >= 1) {
-        outputPubKey = CPubKey(solutions[0]);
-    } else {
-        // Not a P2PK output, can't be stealth
-        return std::nullopt;
-    }
-
-    if (!outputPubKey.IsFullyValid()) {
-        return std::nullopt;
-    }
+    const COutPoint outpoint = payment.GetOutpoint();
 
-    // Look for ephemeral pubkey in OP_RETURN output (would need context of full tx)
-    // For now, this is a simplified detection that tries each address
-    // In practice, ephemeral pubkey would be encoded in a preceding OP_RETURN output
-
-    // Try each of our stealth addresses
-    for (const auto& [addrHash, addrData] : m_stealthAddresses) {
-        // In a full implementation, we would:
-        // 1. Find the ephemeral pubkey R from OP_RETURN
-        // 2. Compute shared secret S = scan_privkey * R
-        // 3. Derive expected pubkey P = spend_pubkey + H(S)*G
-        // 4. Check if P matches outputPubKey
-
-        // For now, use the basic detection with ephemeral pubkey assumed from context
-        // This is a placeholder - real implementation needs full tx context
-
-        CKey derivedKey;
-        // Try with output pubkey as ephemeral (simplified - not correct protocol)
-        if (privacy::DeriveStealthSpendingKey(addrData.scanPrivKey, addrData.spendPrivKey,
-                                               outputPubKey, outputIndex, derivedKey)) {
-            // Verify the derived public key matches
-            if (derivedKey.GetPubKey() == outputPubKey) {
-                CStealthPayment payment;
-                payment.txid = txid;
-                payment.nOutput = outputIndex;
-                payment.nValue = txout.nValue;
-                payment.oneTimePubKey = outputPubKey;
-                payment.derivedPrivKey = derivedKey;
-                payment.stealthAddressHash = addrHash;
-                payment.blockHeight = blockHeight;
-                payment.spent = false;
-
-                LogPrintf("Detected stealth payment: %s:%d, amount=%d, to address=%s\n",
-                          txid.ToString(), outputIndex, txout.nValue, addrData.address.ToString());
-                return payment;
-            }
+    // Update height if we already have it from mempool
+    auto it = m_payments.find(outpoint);
+    if (it != m_payments.end()) {
+        if (payment.blockHeight >= 0) {
+            it->second.blockHeight = payment.blockHeight;
         }
+        return;
     }
 
-    return std::nullopt;
+    m_payments[outpoint] = payment;
+    m_paymentKeys[outpoint] = payment.derivedPrivKey;
+
+    auto addr = m_stealthAddresses.find(payment.stealthAddressHash);
+    LogPrintf("Detected stealth payment: %s:%d, amount=%d, to address=%s\n",
+              payment.txid.ToString(), payment.nOutput, payment.nValue,
+              addr != m_stealthAddresses.end() ? addr->second.address.ToString() : "");
 }
 
 std::vector<CStealthPayment> CStealthAddressManager::ScanTransactionForPayments(
@@ -192,21 +271,9 @@ std::vector<CStealthPayment> CStealthAddressManager::ScanTransactionForPayments(
         return payments;
     }
 
-    uint256 txid = tx.GetHash();
-
-    for (uint32_t i = 0; i < tx.vout.size(); i++) {
-        auto payment = TryDetectPayment(tx.vout[i], i, txid, -1);
-        if (payment) {
-            COutPoint outpoint(Txid::FromUint256(txid), i);
-
-            // Check if we already have this payment
-            if (m_payments.find(outpoint) == m_payments.end()) {
-                m_payments[outpoint] = *payment;
-                m_paymentKeys[outpoint] = payment->derivedPrivKey;
-            }
-
-            payments.push_back(*payment);
-        }
+    payments = ScanTransaction(MakeScanKeys(m_stealthAddresses), tx, -1);
+    for (const auto& payment : payments) {
+        RecordPayment(payment);
     }
 
     return payments;
@@ -215,36 +282,98 @@ std::vector<CStealthPayment> CStealthAddressManager::ScanTransactionForPayments(
 std::vector<CStealthPayment> CStealthAddressManager::ScanBlockForPayments(
     const CBlock& block, int height)
 {
-    LOCK(cs_stealth);
-    std::vector<CStealthPayment> payments;
+    return ScanBlocksForPayments({{&block, height}});
+}
 
-    if (m_stealthAddresses.empty()) {
-        return payments;
+std::vector<CStealthPayment> CStealthAddressManager::ScanBlocksForPayments(
+    const std::vector<std::pair<const CBlock*, int>>& blocks)
+{
+    std::vector<ScanKey> keys;
+    {
+        LOCK(cs_stealth);
+        keys = MakeScanKeys(m_stealthAddresses);
+    }
+    if (keys.empty() || blocks.empty()) {
+        return {};
+    }
+
+    // Blocks are scanned without the lock, spread over the available cores
+    std::vector<std::vector<CStealthPayment>> found(blocks.size());
+    const auto scan_block = [&](size_t b) {
+        const auto& [block, height] = blocks[b];
+        for (const auto& tx : block->vtx) {
+            auto payments = ScanTransaction(keys, *tx, height);
+            found[b].insert(found[b].end(), std::make_move_iterator(payments.begin()), std::make_move_iterator(payments.end()));
+        }
+    };
+
+    const size_t num_threads = std::min<size_t>(blocks.size(), std::max(1U, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{0};
+    const auto worker = [&] {
+        for (size_t b = next++; b < blocks.size(); b = next++) scan_block(b);
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
     }
 
-    for (const auto& tx : block.vtx) {
-        uint256 txid = tx->GetHash();
+    // Payments are recorded in the order of the blocks given
+    LOCK(cs_stealth);
+    std::vector<CStealthPayment> payments;
+    for (auto& block_payments : found) {
+        for (auto& payment : block_payments) {
+            RecordPayment(payment);
+            payments.push_back(std::move(payment));
+        }
+    }
+    return payments;
+}
 
-        for (uint32_t i = 0; i < tx->vout.size(); i++) {
-            auto payment = TryDetectPayment(tx->vout[i], i, txid, height);
-            if (payment) {
-                COutPoint outpoint(Txid::FromUint256(txid), i);
+class CStealthAddressManager::RescanDetector : public PrivacyBlockDetector
+{
+public:
+    RescanDetector(CStealthAddressManager& manager, std::vector<ScanKey> keys)
+        : m_manager(manager), m_keys(std::move(keys)) {}
+
+    PrivacyBlockCommit ScanBlock(const std::shared_ptr<const CBlock>& block, int height) const override
+    {
+        if (m_keys.empty()) {
+            return nullptr;
+        }
 
-                // Update height if we already have it from mempool
-                auto it = m_payments.find(outpoint);
-                if (it != m_payments.end()) {
-                    it->second.blockHeight = height;
-                } else {
-                    m_payments[outpoint] = *payment;
-                    m_paymentKeys[outpoint] = payment->derivedPrivKey;
-                }
+        std::vector<CStealthPayment> payments;
+        for (const auto& tx : block->vtx) {
+            auto found = ScanTransaction(m_keys, *tx, height);
+            payments.insert(payments.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+        }
+        if (payments.empty()) {
+            return nullptr;
+        }
 
-                payments.push_back(*payment);
+        return [&manager = m_manager, payments = std::move(payments)](WalletBatch& batch) {
+            LOCK(manager.cs_stealth);
+            for (const auto& payment : payments) {
+                manager.RecordPayment(payment);
+                StealthAddressDB::WriteStealthPayment(batch, payment);
+                StealthAddressDB::WriteStealthKey(batch, payment.GetOutpoint(), payment.derivedPrivKey);
             }
-        }
+        };
     }
 
-    return payments;
+private:
+    CStealthAddressManager& m_manager;
+    const std::vector<ScanKey> m_keys;
+};
+
+std::unique_ptr<PrivacyBlockDetector> CStealthAddressManager::MakeRescanDetector()
+{
+    LOCK(cs_stealth);
+    return std::make_unique<RescanDetector>(*this, MakeScanKeys(m_stealthAddresses));
 }
 
 std::vector<CStealthPayment> CStealthAddressManager::GetStealthPayments(bool includeSpent) const
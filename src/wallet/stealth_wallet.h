@@ -11,12 +11,14 @@
 #include <sync.h>
 #include <uint256.h>
 #include <primitives/transaction.h>
+#include <wallet/privacy_rescan.h>
 #include <wallet/walletdb.h>
 
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
+#include <utility>
 #include <vector>
 
 class CWallet;
@@ -100,6 +102,15 @@ public:
     //! Scan a block for stealth payments
     std::vector<CStealthPayment> ScanBlockForPayments(const CBlock& block, int height);
 
+    //! Scan blocks (with their heights) for stealth payments, for rescans.
+    //! The blocks are scanned in parallel and the payments recorded in the
+    //! order given.
+    std::vector<CStealthPayment> ScanBlocksForPayments(const std::vector<std::pair<const CBlock*, int>>& blocks);
+
+    //! Detector for CWallet::ScanForPrivacyOutputs(), looking for payments to
+    //! the addresses held when it is made
+    std::unique_ptr<PrivacyBlockDetector> MakeRescanDetector();
+
     //! Get all received stealth payments
     std::vector<CStealthPayment> GetStealthPayments(bool includeSpent = false) const;
 
@@ -137,6 +148,8 @@ public:
     size_t GetStealthAddressCount() const;
 
 private:
+    class RescanDetector;
+
     CWallet* m_wallet;
     mutable RecursiveMutex cs_stealth;
 
@@ -149,12 +162,8 @@ private:
     // Derived private keys for payments (outpoint -> key)
     std::map<COutPoint, CKey> m_paymentKeys GUARDED_BY(cs_stealth);
 
-    //! Try to detect payment to one of our stealth addresses
-    std::optional<CStealthPayment> TryDetectPayment(
-        const CTxOut& txout,
-        uint32_t outputIndex,
-        const uint256& txid,
-        int blockHeight);
+    //! Record a detected payment, or the block height of one seen in the mempool
+    void RecordPayment(const CStealthPayment& payment) EXCLUSIVE_LOCKS_REQUIRED(cs_stealth);
 
     //! Compute hash of stealth address for indexing
     static uint256 HashStealthAddress(const privacy::CStealthAddress& addr);
@@ -385,6 +385,43 @@ BOOST_AUTO_TEST_CASE(concurrent_txn_dont_interfere)
     BOOST_CHECK(handler2->Read(key, read_value));
     BOOST_CHECK_EQUAL(read_value, value2);
 }
+
+BOOST_AUTO_TEST_CASE(bulk_write_joins_batches)
+{
+    DatabaseOptions options;
+    DatabaseStatus status;
+    bilingual_str error;
+    const auto& database = MakeSQLiteDatabase(m_path_root / "sqlite", options, status, error);
+
+    BOOST_CHECK(database->BeginBulkWrite());
+    BOOST_CHECK(!database->BeginBulkWrite());
+    {
+        // Batches of the thread write into the bulk transaction without waiting for it
+        std::unique_ptr<DatabaseBatch> batch = database->MakeBatch();
+        BOOST_CHECK(batch->Write(std::string{"a"}, std::string{"1"}));
+        BOOST_CHECK(database->HasActiveTxn());
+
+        // Their own transactions nest in it and can be rolled back alone
+        std::unique_ptr<DatabaseBatch> batch2 = database->MakeBatch();
+        BOOST_CHECK(batch2->TxnBegin());
+        BOOST_CHECK(batch2->Write(std::string{"b"}, std::string{"2"}));
+        BOOST_CHECK(batch2->TxnAbort());
+        BOOST_CHECK(batch2->TxnBegin());
+        BOOST_CHECK(batch2->Write(std::string{"c"}, std::string{"3"}));
+        BOOST_CHECK(batch2->TxnCommit());
+    }
+    BOOST_CHECK(database->EndBulkWrite());
+    BOOST_CHECK(!database->HasActiveTxn());
+    BOOST_CHECK(!database->EndBulkWrite());
+
+    // Batches made after the earlier ones closed reuse their statements
+    std::unique_ptr<DatabaseBatch> batch = database->MakeBatch();
+    BOOST_CHECK(batch->Exists(std::string{"a"}));
+    BOOST_CHECK(!batch->Exists(std::string{"b"}));
+    BOOST_CHECK(batch->Exists(std::string{"c"}));
+    BOOST_CHECK(batch->TxnBegin());
+    BOOST_CHECK(batch->TxnCommit());
+}
 #endif // USE_SQLITE
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,85 @@
+// Copyright (c) 2024 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <wallet/delegationweight.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(delegationweight_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(delegation_weight_tracker)
+{
+    using Coins = std::vector<std::pair<COutPoint, DelegationWeightTracker::Coin>>;
+    auto rand160 = [&] { return uint160{m_rng.randbytes<unsigned char>(20)}; };
+    const uint160 delegateA = rand160();
+    const uint160 delegateB = rand160();
+    const COutPoint seeded(Txid::FromUint256(m_rng.rand256()), 1);
+
+    DelegationWeightTracker tracker;
+    tracker.SetDelegates({delegateA, delegateB});
+    BOOST_CHECK(tracker.HasDelegates());
+    tracker.Seed(delegateA, {{seeded, {10 * COIN, 5}}});
+
+    // Spend the seeded coin and pay both delegates and a stranger
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(seeded);
+    mtx.vout.emplace_back(4 * COIN, GetScriptForDestination(PKHash(delegateA)));
+    mtx.vout.emplace_back(3 * COIN, GetScriptForDestination(PKHash(delegateB)));
+    mtx.vout.emplace_back(2 * COIN, GetScriptForDestination(PKHash(rand160())));
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(mtx));
+    const Txid txid = block.vtx[0]->GetHash();
+
+    Coins coins;
+    tracker.BlockConnected(block, 20);
+    BOOST_REQUIRE(tracker.GetCoins(delegateA, coins));
+    BOOST_REQUIRE_EQUAL(coins.size(), 1U);
+    BOOST_CHECK(coins[0].first == COutPoint(txid, 0));
+    BOOST_CHECK_EQUAL(coins[0].second.value, 4 * COIN);
+    BOOST_CHECK_EQUAL(coins[0].second.height, 20);
+    // Unseeded delegates are left to the address index
+    BOOST_CHECK(!tracker.GetCoins(delegateB, coins));
+
+    // Reconnecting a block the seed already covers changes nothing
+    tracker.Seed(delegateB, {{COutPoint(txid, 1), {3 * COIN, 20}}});
+    tracker.BlockConnected(block, 20);
+    BOOST_REQUIRE(tracker.GetCoins(delegateB, coins));
+    BOOST_CHECK_EQUAL(coins.size(), 1U);
+
+    tracker.BlockDisconnected(block);
+    tracker.BlockDisconnected(block);
+    BOOST_REQUIRE(tracker.GetCoins(delegateA, coins));
+    BOOST_REQUIRE_EQUAL(coins.size(), 1U);
+    BOOST_CHECK(coins[0].first == seeded);
+    BOOST_CHECK_EQUAL(coins[0].second.height, 5);
+    BOOST_REQUIRE(tracker.GetCoins(delegateB, coins));
+    BOOST_CHECK(coins.empty());
+
+    // A block the tracker has no undo data for forces a reseed
+    tracker.BlockDisconnected(block);
+    BOOST_CHECK(!tracker.GetCoins(delegateA, coins));
+    BOOST_CHECK(!tracker.GetCoins(delegateB, coins));
+
+    tracker.SetDelegates({delegateB});
+    tracker.Seed(delegateA, {{seeded, {10 * COIN, 5}}});
+    BOOST_CHECK(!tracker.GetCoins(delegateA, coins));
+
+    BOOST_CHECK_EQUAL(tracker.GetSnapshot().height, -1);
+    DelegationWeightTracker::Snapshot snapshot;
+    snapshot.height = 20;
+    snapshot.total = 3 * COIN;
+    snapshot.weights[delegateB] = 3 * COIN;
+    tracker.SetSnapshot(snapshot);
+    BOOST_CHECK_EQUAL(tracker.GetSnapshot().height, 20);
+    BOOST_CHECK_EQUAL(tracker.GetSnapshot().weights.at(delegateB), 3 * COIN);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
@@ -0,0 +1,169 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+#include <wallet/monero_sync.h>
+
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+namespace monero_wallet {
+BOOST_FIXTURE_TEST_SUITE(monero_sync_tests, BasicTestingSetup)
+
+static void AppendHash(std::string& out, uint8_t fill)
+{
+    out.append(32, static_cast<char>(fill));
+}
+
+static MoneroHash FilledHash(uint8_t fill)
+{
+    MoneroHash hash;
+    hash.fill(fill);
+    return hash;
+}
+
+BOOST_AUTO_TEST_CASE(portable_storage_encoding)
+{
+    epee::StorageValue req = epee::StorageValue::Object();
+    req.Add("start_height", epee::StorageValue::Uint(5));
+    const std::string encoded = epee::Serialize(req);
+    BOOST_CHECK_EQUAL(HexStr(encoded),
+                      "011101010101020101"             // signature and version
+                      "04"                             // one field
+                      "0c" + HexStr(std::string("start_height")) +
+                      "05" "0500000000000000");        // uint64 5
+
+    // Nested objects, arrays and long strings survive a round trip
+    epee::StorageValue inner = epee::StorageValue::Object();
+    inner.Add("block", epee::StorageValue::String(std::string(20000, 'x')));
+    epee::StorageValue blocks;
+    blocks.kind = epee::StorageValue::Kind::ARRAY;
+    blocks.array = {inner, inner};
+    epee::StorageValue root = epee::StorageValue::Object();
+    root.Add("blocks", blocks).Add("status", epee::StorageValue::String("OK")).Add("prune", epee::StorageValue::Bool(true));
+
+    epee::StorageValue parsed;
+    const std::string data = epee::Serialize(root);
+    BOOST_REQUIRE(epee::Parse(data, parsed));
+    BOOST_CHECK_EQUAL(parsed.Find("status")->str, "OK");
+    BOOST_CHECK(parsed.Find("prune")->b);
+    BOOST_REQUIRE_EQUAL(parsed.Find("blocks")->array.size(), 2U);
+    BOOST_CHECK_EQUAL(parsed.Find("blocks")->array[1].Find("block")->str.size(), 20000U);
+    BOOST_CHECK(parsed.Find("missing") == nullptr);
+
+    // Truncated documents and foreign data are rejected
+    BOOST_CHECK(!epee::Parse(data.substr(0, data.size() - 1), parsed));
+    BOOST_CHECK(!epee::Parse("{\"status\":\"OK\"}", parsed));
+}
+
+BOOST_AUTO_TEST_CASE(parse_transaction)
+{
+    std::string blob;
+    WriteMoneroVarint(blob, 2);   // version
+    WriteMoneroVarint(blob, 0);   // unlock_time
+    WriteMoneroVarint(blob, 1);   // one input
+    blob.push_back(0x02);         // txin_to_key
+    WriteMoneroVarint(blob, 0);
+    WriteMoneroVarint(blob, 2);
+    WriteMoneroVarint(blob, 300);
+    WriteMoneroVarint(blob, 5);
+    AppendHash(blob, 0x11);       // key image
+    WriteMoneroVarint(blob, 2);   // two outputs
+    WriteMoneroVarint(blob, 0);
+    blob.push_back(0x02);         // txout_to_key
+    AppendHash(blob, 0x44);
+    WriteMoneroVarint(blob, 0);
+    blob.push_back(0x03);         // txout_to_tagged_key
+    AppendHash(blob, 0x55);
+    blob.push_back(0x7a);
+    std::string extra;
+    extra.push_back(0x01);
+    AppendHash(extra, 0x22);
+    extra.push_back(0x04);
+    WriteMoneroVarint(extra, 2);
+    AppendHash(extra, 0x66);
+    AppendHash(extra, 0x77);
+    WriteMoneroVarint(blob, extra.size());
+    blob += extra;
+    const size_t prefix_size = blob.size();
+    blob.push_back(0x06);         // RCTTypeBulletproofPlus
+    WriteMoneroVarint(blob, 30000);
+    blob += std::string("\x01\x02\x03\x04\x05\x06\x07\x08", 8);
+    blob += std::string(8, '\x09');
+    AppendHash(blob, 0x88);       // outPk
+    AppendHash(blob, 0x99);
+    const size_t base_size = blob.size() - prefix_size;
+    blob += "prunable data is not parsed";
+
+    MoneroTx tx;
+    BOOST_REQUIRE(ParseMoneroTransaction(blob, tx));
+    BOOST_CHECK_EQUAL(tx.version, 2U);
+    BOOST_CHECK(!tx.coinbase);
+    BOOST_REQUIRE_EQUAL(tx.key_images.size(), 1U);
+    BOOST_CHECK(tx.key_images[0] == FilledHash(0x11));
+    BOOST_REQUIRE_EQUAL(tx.outputs.size(), 2U);
+    BOOST_CHECK(tx.outputs[0].key == FilledHash(0x44));
+    BOOST_CHECK(!tx.outputs[0].view_tag);
+    BOOST_CHECK(tx.outputs[1].view_tag == 0x7a);
+    BOOST_CHECK(tx.tx_pubkey == FilledHash(0x22));
+    BOOST_REQUIRE_EQUAL(tx.additional_pubkeys.size(), 2U);
+    BOOST_CHECK(tx.additional_pubkeys[1] == FilledHash(0x77));
+    BOOST_CHECK_EQUAL(tx.rct_type, 6);
+    BOOST_REQUIRE_EQUAL(tx.ecdh_amounts.size(), 2U);
+    BOOST_CHECK_EQUAL(tx.ecdh_amounts[0][7], 0x08);
+    BOOST_CHECK_EQUAL(tx.ecdh_amounts[0][8], 0x00);
+    BOOST_CHECK_EQUAL(tx.prefix_size, prefix_size);
+    BOOST_CHECK_EQUAL(tx.rct_base_size, base_size);
+
+    // Cut inside the RingCT base
+    BOOST_CHECK(!ParseMoneroTransaction(blob.substr(0, prefix_size + 5), tx));
+}
+
+BOOST_AUTO_TEST_CASE(parse_block)
+{
+    std::string miner;
+    WriteMoneroVarint(miner, 2);
+    WriteMoneroVarint(miner, 70); // unlock_time
+    WriteMoneroVarint(miner, 1);
+    miner.push_back(static_cast<char>(0xff)); // txin_gen
+    WriteMoneroVarint(miner, 10);
+    WriteMoneroVarint(miner, 1);
+    WriteMoneroVarint(miner, 600000000000);
+    miner.push_back(0x03);
+    AppendHash(miner, 0x44);
+    miner.push_back(0x5c);        // view tag
+    WriteMoneroVarint(miner, 33); // extra
+    miner.push_back(0x01);
+    AppendHash(miner, 0x22);
+    miner.push_back(0x00);        // RCTTypeNull
+
+    std::string blob;
+    WriteMoneroVarint(blob, 16);
+    WriteMoneroVarint(blob, 16);
+    WriteMoneroVarint(blob, 1700000000);
+    AppendHash(blob, 0x33);       // prev_id
+    blob += std::string(4, '\0'); // nonce
+    blob += miner;
+    WriteMoneroVarint(blob, 1);
+    AppendHash(blob, 0xab);
+
+    MoneroBlock block;
+    BOOST_REQUIRE(ParseMoneroBlock(blob, block));
+    BOOST_CHECK_EQUAL(block.timestamp, 1700000000U);
+    BOOST_CHECK(block.prev_id == FilledHash(0x33));
+    BOOST_CHECK(block.miner_tx_blob == miner);
+    BOOST_CHECK(block.miner_tx.coinbase);
+    BOOST_CHECK_EQUAL(block.miner_tx.unlock_time, 70U);
+    BOOST_CHECK_EQUAL(block.miner_tx.outputs[0].amount, 600000000000U);
+    BOOST_CHECK_EQUAL(block.miner_tx.rct_base_size, 1U);
+    BOOST_REQUIRE_EQUAL(block.tx_hashes.size(), 1U);
+    BOOST_CHECK(block.tx_hashes[0] == FilledHash(0xab));
+
+    BOOST_CHECK(!ParseMoneroBlock(blob.substr(0, blob.size() - 1), block));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace monero_wallet
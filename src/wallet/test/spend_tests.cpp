@@ -104,5 +104,57 @@ BOOST_FIXTURE_TEST_CASE(wallet_duplicated_preset_inputs_test, TestChain100Setup)
     BOOST_CHECK(!CreateTransaction(*wallet, recipients, /*change_pos=*/std::nullopt, coin_control));
 }
 
+BOOST_FIXTURE_TEST_CASE(coin_index_follows_wallet, TestChain100Setup)
+{
+    for (int i = 0; i < 4; i++) CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    auto wallet = CreateSyncedWallet(*m_node.chain, WITH_LOCK(Assert(m_node.chainman)->GetMutex(), return m_node.chainman->ActiveChain()), coinbaseKey);
+
+    auto available = [&] {
+        CCoinControl coin_control;
+        coin_control.m_include_unsafe_inputs = true;
+        coin_control.m_min_depth = 0;
+        std::set<COutPoint> outpoints;
+        for (const COutput& output : AvailableCoins(*wallet, &coin_control).All()) outpoints.insert(output.outpoint);
+        return outpoints;
+    };
+    // What the incrementally kept index gives must match building it again
+    auto check_index = [&] {
+        LOCK(wallet->cs_wallet);
+        const std::set<COutPoint> incremental{available()};
+        wallet->m_coin_index.Reset();
+        BOOST_CHECK(incremental == available());
+        return incremental;
+    };
+
+    const std::set<COutPoint> before{check_index()};
+    BOOST_CHECK(!before.empty());
+    {
+        LOCK(wallet->cs_wallet);
+        for (const auto& [type, bucket] : wallet->m_coin_index.Buckets()) {
+            BOOST_CHECK(std::is_sorted(bucket.begin(), bucket.end()));
+        }
+    }
+
+    // Spending a coin to the wallet replaces it with the new outputs
+    CRecipient recipient{*Assert(wallet->GetNewDestination(OutputType::BECH32, "")), 1 * COIN, /*fSubtractFeeFromAmount=*/false};
+    auto res = CreateTransaction(*wallet, {recipient}, /*change_pos=*/std::nullopt, CCoinControl());
+    BOOST_REQUIRE(res);
+    wallet->CommitTransaction(res->tx, {}, {});
+    const std::set<COutPoint> after{check_index()};
+    for (const CTxIn& txin : res->tx->vin) {
+        BOOST_CHECK(before.count(txin.prevout));
+        BOOST_CHECK(!after.count(txin.prevout));
+    }
+    for (unsigned int i = 0; i < res->tx->vout.size(); i++) {
+        BOOST_CHECK(after.count(COutPoint(res->tx->GetHash(), i)));
+    }
+
+    // New blocks confirm them without changing the set
+    auto handler = m_node.chain->handleNotifications({wallet.get(), [](CWallet*) {}});
+    CreateAndProcessBlock({CMutableTransaction(*res->tx)}, GetScriptForRawPubKey(GenerateRandomKey().GetPubKey()));
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(after == check_index());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 } // namespace wallet
@@ -0,0 +1,102 @@
+// Copyright (c) 2024-2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <interfaces/chain.h>
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+#include <wallet/tokenwatcher.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(tokenwatcher_tests, BasicTestingSetup)
+
+//! Indexed address topic
+static uint256 AddressTopic(const uint160& address)
+{
+    uint256 topic;
+    std::copy(address.begin(), address.end(), topic.begin() + 12);
+    return topic;
+}
+
+//! Big-endian token value
+static uint256 Value(uint8_t amount)
+{
+    uint256 value;
+    *(value.end() - 1) = amount;
+    return value;
+}
+
+static interfaces::ContractLog TransferLog(const uint256& tx_hash, const uint160& contract, const uint160& from, const uint160& to, uint8_t amount)
+{
+    interfaces::ContractLog log;
+    log.tx_hash = tx_hash;
+    log.address = contract;
+    log.topics = {uint256{ParseHex("ddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef")}, AddressTopic(from), AddressTopic(to)};
+    const uint256 value{Value(amount)};
+    log.data.assign(value.begin(), value.end());
+    return log;
+}
+
+BOOST_AUTO_TEST_CASE(token_watcher)
+{
+    auto rand160 = [&] { return uint160{m_rng.randbytes<unsigned char>(20)}; };
+    const uint160 contract{rand160()}, other_contract{rand160()};
+    const uint160 holder{rand160()}, stranger{rand160()};
+    const uint256 token{m_rng.rand256()};
+    const uint256 tx1{m_rng.rand256()}, tx2{m_rng.rand256()};
+    const uint256 block1{m_rng.rand256()}, block2{m_rng.rand256()};
+
+    TokenWatcher watcher;
+    BOOST_CHECK(!watcher.HasTokens());
+    watcher.SetTokens({{token, {contract, holder}}});
+    BOOST_CHECK(watcher.HasTokens());
+    BOOST_CHECK(!watcher.GetBalance(token));
+    BOOST_CHECK(watcher.SetBalance(token, Value(100)));
+    BOOST_CHECK(!watcher.SetBalance(m_rng.rand256(), Value(1)));
+
+    // Two events of a transaction to the holder are one transfer, other logs are ignored
+    std::vector<TokenWatcher::Transfer> transfers{watcher.BlockConnected(block1, {
+        TransferLog(tx1, contract, stranger, holder, 5),
+        TransferLog(tx1, contract, stranger, holder, 7),
+        TransferLog(tx1, contract, stranger, rand160(), 9),
+        TransferLog(tx1, other_contract, stranger, holder, 11),
+    })};
+    BOOST_REQUIRE_EQUAL(transfers.size(), 1U);
+    BOOST_CHECK(transfers[0].tx_hash == tx1);
+    BOOST_CHECK(transfers[0].sender == stranger);
+    BOOST_CHECK(transfers[0].receiver == holder);
+    BOOST_CHECK(transfers[0].value == Value(12));
+    BOOST_CHECK(*watcher.GetBalance(token) == Value(112));
+
+    transfers = watcher.BlockConnected(block2, {TransferLog(tx2, contract, holder, stranger, 30)});
+    BOOST_REQUIRE_EQUAL(transfers.size(), 1U);
+    BOOST_CHECK(*watcher.GetBalance(token) == Value(82));
+
+    // Reorgs roll the balance back
+    watcher.BlockDisconnected(block2);
+    BOOST_CHECK(*watcher.GetBalance(token) == Value(112));
+    watcher.BlockDisconnected(block1);
+    BOOST_CHECK(*watcher.GetBalance(token) == Value(100));
+
+    // Without the block's changes the balance has to be read again
+    watcher.BlockDisconnected(m_rng.rand256());
+    BOOST_CHECK(!watcher.GetBalance(token));
+
+    // Spending more than the seed says also unseeds it
+    BOOST_CHECK(watcher.SetBalance(token, Value(10)));
+    watcher.BlockConnected(block2, {TransferLog(tx2, contract, holder, stranger, 30)});
+    BOOST_CHECK(!watcher.GetBalance(token));
+
+    // Removed tokens lose their balance
+    BOOST_CHECK(watcher.SetBalance(token, Value(10)));
+    watcher.SetTokens({});
+    BOOST_CHECK(!watcher.GetBalance(token));
+    BOOST_CHECK(watcher.BlockConnected(block1, {TransferLog(tx1, contract, stranger, holder, 5)}).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
@@ -195,6 +195,92 @@ BOOST_FIXTURE_TEST_CASE(scan_for_wallet_transactions, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(scan_tops_up_keypool, TestChain100Setup)
+{
+    // Blocks are matched ahead of the one being committed. A block paying
+    // past the keypool must still be found once an earlier one tops it up.
+    CExtKey master;
+    master.SetSeed(GenerateRandomKey());
+    FlatSigningProvider provider;
+    std::string error;
+    auto descs = Parse("pkh(" + EncodeExtKey(master) + "/0/*)", provider, error, /*require_checksum=*/false);
+    BOOST_REQUIRE_EQUAL(descs.size(), 1U);
+    const auto derive = [&](int index) {
+        FlatSigningProvider out;
+        std::vector<CScript> scripts;
+        BOOST_REQUIRE(descs[0]->Expand(index, provider, scripts, out));
+        return scripts.at(0);
+    };
+
+    CBlockIndex* oldTip = WITH_LOCK(Assert(m_node.chainman)->GetMutex(), return m_node.chainman->ActiveChain().Tip());
+    CreateAndProcessBlock({}, derive(1));
+    CreateAndProcessBlock({}, derive(3));
+    for (int i = 0; i < 3; ++i) CreateAndProcessBlock({}, GetScriptForRawPubKey(GenerateRandomKey().GetPubKey()));
+
+    CWallet wallet(m_node.chain.get(), "", CreateMockableWalletDatabase());
+    wallet.m_keypool_size = 2;
+    {
+        LOCK(wallet.cs_wallet);
+        LOCK(Assert(m_node.chainman)->GetMutex());
+        wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+        wallet.SetLastBlockProcessed(m_node.chainman->ActiveChain().Height(), m_node.chainman->ActiveChain().Tip()->GetBlockHash());
+        WalletDescriptor w_desc(std::move(descs[0]), 0, 0, 0, 0);
+        BOOST_REQUIRE(wallet.AddWalletDescriptor(w_desc, provider, "", false));
+        BOOST_CHECK(!wallet.IsMine(derive(3)));
+    }
+
+    WalletRescanReserver reserver(wallet);
+    reserver.reserve();
+    CWallet::ScanResult result = wallet.ScanForWalletTransactions(/*start_block=*/oldTip->GetBlockHash(), /*start_height=*/oldTip->nHeight, /*max_height=*/{}, reserver, /*fUpdate=*/false, /*save_progress=*/false);
+    BOOST_CHECK_EQUAL(result.status, CWallet::ScanResult::SUCCESS);
+    LOCK(wallet.cs_wallet);
+    BOOST_CHECK(wallet.IsMine(derive(3)));
+    BOOST_CHECK_EQUAL(wallet.mapWallet.size(), 2U);
+}
+
+BOOST_FIXTURE_TEST_CASE(balance_snapshots, TestChain100Setup)
+{
+    CWallet wallet(m_node.chain.get(), "", CreateMockableWalletDatabase());
+    {
+        LOCK(wallet.cs_wallet);
+        LOCK(Assert(m_node.chainman)->GetMutex());
+        wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+        wallet.SetLastBlockProcessed(m_node.chainman->ActiveChain().Height(), m_node.chainman->ActiveChain().Tip()->GetBlockHash());
+    }
+    AddKey(wallet, coinbaseKey);
+    WalletRescanReserver reserver(wallet);
+    reserver.reserve();
+    const CWallet::ScanResult result = wallet.ScanForWalletTransactions(/*start_block=*/Params().GenesisBlock().GetHash(), /*start_height=*/0, /*max_height=*/{}, reserver, /*fUpdate=*/false, /*save_progress=*/false);
+    BOOST_REQUIRE_EQUAL(result.status, CWallet::ScanResult::SUCCESS);
+    auto handler = m_node.chain->handleNotifications({&wallet, [](CWallet*) {}});
+
+    auto check_fresh = [&](const Balance& balance) {
+        wallet.MarkDirty();
+        const Balance fresh{GetBalance(wallet)};
+        BOOST_CHECK_EQUAL(balance.m_mine_trusted, fresh.m_mine_trusted);
+        BOOST_CHECK_EQUAL(balance.m_mine_immature, fresh.m_mine_immature);
+        BOOST_CHECK_EQUAL(balance.m_mine_stake, fresh.m_mine_stake);
+    };
+    check_fresh(GetBalance(wallet));
+    BOOST_CHECK(GetBalance(wallet).m_mine_immature > 0);
+
+    // Blocks paying someone else leave the wallet's transactions alone, the
+    // snapshot is reused until one of the coinbases matures
+    const uint64_t epoch{WITH_LOCK(wallet.cs_wallet, return wallet.GetBalanceEpoch())};
+    for (int i = 0; i < 3; ++i) {
+        CreateAndProcessBlock({}, GetScriptForRawPubKey(GenerateRandomKey().GetPubKey()));
+        m_node.validation_signals->SyncWithValidationInterfaceQueue();
+        BOOST_CHECK_EQUAL(WITH_LOCK(wallet.cs_wallet, return wallet.GetBalanceEpoch()), epoch);
+        check_fresh(GetBalance(wallet));
+    }
+
+    // Paying the wallet invalidates it
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(WITH_LOCK(wallet.cs_wallet, return wallet.GetBalanceEpoch()) != epoch);
+    check_fresh(GetBalance(wallet));
+}
+
 BOOST_FIXTURE_TEST_CASE(importmulti_rescan, TestChain100Setup)
 {
     // Cap last block file size, and mine new block in a new block file.
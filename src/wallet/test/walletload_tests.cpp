@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 
+#include <key_io.h>
 #include <wallet/test/util.h>
 #include <wallet/wallet.h>
 #include <test/util/logging.h>
@@ -111,6 +112,65 @@ SerializeData MakeSerializeData(const Args&... args)
 }
 
 
+BOOST_FIXTURE_TEST_CASE(wallet_load_derived_scripts, TestingSetup)
+{
+    CExtKey master;
+    master.SetSeed(GenerateRandomKey());
+    FlatSigningProvider provider;
+    std::string error;
+    auto descs = Parse("pkh(" + EncodeExtKey(master) + "/0/*)", provider, error, /*require_checksum=*/false);
+    BOOST_REQUIRE_EQUAL(descs.size(), 1U);
+    const auto derive = [&](int index) {
+        FlatSigningProvider out;
+        std::vector<CScript> scripts;
+        BOOST_REQUIRE(descs[0]->Expand(index, provider, scripts, out));
+        return scripts.at(0);
+    };
+    const CScript first{derive(10)}, past_record{derive(1500)};
+
+    MockableData records;
+    uint256 desc_id;
+    {
+        // Topping up to 2000 scripts writes the first 1000 in a record
+        std::shared_ptr<CWallet> wallet(new CWallet(m_node.chain.get(), "", CreateMockableWalletDatabase()));
+        wallet->m_keypool_size = 2000;
+        LOCK(wallet->cs_wallet);
+        wallet->SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+        WalletDescriptor w_desc(std::move(descs[0]), 0, 0, 0, 0);
+        auto spkm = wallet->AddWalletDescriptor(w_desc, provider, "", false);
+        BOOST_REQUIRE(spkm);
+        desc_id = spkm->GetID();
+        BOOST_CHECK(HasAnyRecordOfType(wallet->GetDatabase(), DBKeys::WALLETDESCRIPTORSPKS));
+        records = GetMockableDatabase(*wallet).m_records;
+    }
+    const SerializeData record_key{MakeSerializeData(DBKeys::WALLETDESCRIPTORSPKS, desc_id, int32_t{0})};
+    BOOST_REQUIRE(records.count(record_key));
+
+    {
+        // The scripts come from the record, and from the xpub cache past it
+        std::shared_ptr<CWallet> wallet(new CWallet(m_node.chain.get(), "", CreateMockableWalletDatabase(records)));
+        BOOST_CHECK_EQUAL(wallet->LoadWallet(), DBErrors::LOAD_OK);
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK(wallet->IsMine(first));
+        BOOST_CHECK(wallet->IsMine(past_record));
+    }
+
+    {
+        // A record that does not match the descriptor is derived again
+        const CScript bogus{GetScriptForRawPubKey(GenerateRandomKey().GetPubKey())};
+        std::vector<DerivedScripts> derived(DERIVED_SCRIPTS_PER_RECORD);
+        derived[0].scripts = {bogus};
+        derived[10].scripts = {bogus};
+        records[record_key] = MakeSerializeData(derived);
+
+        std::shared_ptr<CWallet> wallet(new CWallet(m_node.chain.get(), "", CreateMockableWalletDatabase(records)));
+        BOOST_CHECK_EQUAL(wallet->LoadWallet(), DBErrors::LOAD_OK);
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK(wallet->IsMine(first));
+        BOOST_CHECK(!wallet->IsMine(bogus));
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(wallet_load_ckey, TestingSetup)
 {
     SerializeData ckey_record_key;
@@ -0,0 +1,145 @@
+// Copyright (c) 2024-2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/tokenwatcher.h>
+
+#include <interfaces/chain.h>
+#include <util/strencodings.h>
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+
+namespace wallet {
+
+//! Topics of Transfer(address,address,uint256) and Burn(address,uint256)
+static const uint256 TRANSFER_TOPIC{ParseHex("ddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef")};
+static const uint256 BURN_TOPIC{ParseHex("cc16f5dbb4873280815c1ee09dbd06736cffcc184412cf7a71a0fdb75d397ca5")};
+
+//! Address of an indexed address topic, in its low 20 bytes
+static uint160 TopicAddress(const uint256& topic)
+{
+    return uint160{Span{topic}.last(20)};
+}
+
+//! Token values are big-endian, arith_uint256 reads little-endian
+static arith_uint256 ValueToArith(const uint256& value)
+{
+    uint256 le{value};
+    std::reverse(le.begin(), le.end());
+    return UintToArith256(le);
+}
+
+static uint256 ArithToValue(const arith_uint256& value)
+{
+    uint256 be{ArithToUint256(value)};
+    std::reverse(be.begin(), be.end());
+    return be;
+}
+
+void TokenWatcher::SetTokens(std::map<uint256, Token> tokens)
+{
+    m_tokens = std::move(tokens);
+    for (auto it = m_balances.begin(); it != m_balances.end();) {
+        it = m_tokens.count(it->first) ? std::next(it) : m_balances.erase(it);
+    }
+}
+
+std::vector<TokenWatcher::Transfer> TokenWatcher::BlockConnected(const uint256& block_hash, const std::vector<interfaces::ContractLog>& logs)
+{
+    std::vector<Transfer> transfers;
+    BlockUndo undo{block_hash, {}};
+
+    std::set<uint160> contracts;
+    for (const auto& [hash, token] : m_tokens) contracts.insert(token.contract);
+
+    for (const interfaces::ContractLog& log : logs) {
+        if (log.topics.empty() || log.data.size() < 32 || !contracts.count(log.address)) continue;
+        Transfer transfer{log.tx_hash, log.address, {}, {}, uint256{Span{log.data}.first(32)}};
+        if (log.topics[0] == TRANSFER_TOPIC && log.topics.size() >= 3) {
+            transfer.sender = TopicAddress(log.topics[1]);
+            transfer.receiver = TopicAddress(log.topics[2]);
+        } else if (log.topics[0] == BURN_TOPIC && log.topics.size() >= 2) {
+            transfer.sender = TopicAddress(log.topics[1]);
+        } else {
+            continue;
+        }
+
+        bool watched{false};
+        const arith_uint256 value{ValueToArith(transfer.value)};
+        for (const auto& [hash, token] : m_tokens) {
+            if (token.contract != transfer.contract) continue;
+            const bool debit{token.holder == transfer.sender};
+            const bool credit{!transfer.receiver.IsNull() && token.holder == transfer.receiver};
+            if (!debit && !credit) continue;
+            watched = true;
+            undo.changes.push_back({hash, credit ? value : arith_uint256{}, debit ? value : arith_uint256{}});
+        }
+        if (!watched) continue;
+
+        // Same entry as the event log search makes for the transaction
+        auto it = std::find_if(transfers.begin(), transfers.end(), [&](const Transfer& t) {
+            return std::tie(t.tx_hash, t.contract, t.sender, t.receiver) ==
+                   std::tie(transfer.tx_hash, transfer.contract, transfer.sender, transfer.receiver);
+        });
+        if (it == transfers.end()) {
+            transfers.push_back(transfer);
+        } else {
+            it->value = ArithToValue(ValueToArith(it->value) + value);
+        }
+    }
+
+    for (const BalanceChange& change : undo.changes) {
+        auto it = m_balances.find(change.token);
+        if (it == m_balances.end()) continue;
+        arith_uint256 balance{it->second + change.credit};
+        if (balance < change.debit) {
+            // The seed was off, read the balance again
+            m_balances.erase(it);
+            continue;
+        }
+        it->second = balance - change.debit;
+    }
+
+    m_undo.push_back(std::move(undo));
+    if (m_undo.size() > MAX_UNDO_BLOCKS) m_undo.pop_front();
+    return transfers;
+}
+
+void TokenWatcher::BlockDisconnected(const uint256& block_hash)
+{
+    if (m_undo.empty() || m_undo.back().hash != block_hash) {
+        m_undo.clear();
+        m_balances.clear();
+        return;
+    }
+
+    for (const BalanceChange& change : m_undo.back().changes) {
+        auto it = m_balances.find(change.token);
+        if (it == m_balances.end()) continue;
+        arith_uint256 balance{it->second + change.debit};
+        if (balance < change.credit) {
+            m_balances.erase(it);
+            continue;
+        }
+        it->second = balance - change.credit;
+    }
+    m_undo.pop_back();
+}
+
+bool TokenWatcher::SetBalance(const uint256& token, const uint256& balance)
+{
+    if (!m_tokens.count(token)) return false;
+    m_balances[token] = ValueToArith(balance);
+    return true;
+}
+
+std::optional<uint256> TokenWatcher::GetBalance(const uint256& token) const
+{
+    auto it = m_balances.find(token);
+    if (it == m_balances.end()) return std::nullopt;
+    return ArithToValue(it->second);
+}
+
+} // namespace wallet
@@ -0,0 +1,105 @@
+// Copyright (c) 2024-2026 The WATTx developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_WALLET_TOKENWATCHER_H
+#define BITCOIN_WALLET_TOKENWATCHER_H
+
+#include <arith_uint256.h>
+#include <uint256.h>
+
+#include <deque>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace interfaces {
+struct ContractLog;
+} // namespace interfaces
+
+namespace wallet {
+
+/**
+ * TokenWatcher - Transfers and balances of the wallet's QRC20 tokens.
+ *
+ * The Transfer and Burn events of the watched tokens are matched in the
+ * receipt logs of each block the wallet is notified of, instead of searching
+ * the logs of every token from its last block on a timer.
+ *
+ * A balance is seeded once from a balanceOf call at the block the watcher is
+ * at. From then on it is kept current from the events of each connected block
+ * and rolled back on disconnection.
+ */
+class TokenWatcher
+{
+public:
+    //! A token of the wallet: a contract and the address holding it
+    struct Token {
+        uint160 contract;
+        uint160 holder;
+    };
+
+    //! Token transfer of a block, all the events of a transaction between the same addresses summed
+    struct Transfer {
+        uint256 tx_hash;
+        uint160 contract;
+        uint160 sender;
+        //! Null for a burn
+        uint160 receiver;
+        //! Big-endian, as stored in CTokenTx
+        uint256 value;
+    };
+
+    //! Blocks whose balance changes are kept to undo a reorg without reseeding
+    static constexpr size_t MAX_UNDO_BLOCKS = 100;
+
+    /**
+     * Watch exactly these tokens, keyed by their wallet hash. Balances of
+     * removed tokens are dropped, new ones start unseeded.
+     */
+    void SetTokens(std::map<uint256, Token> tokens);
+
+    bool HasTokens() const { return !m_tokens.empty(); }
+
+    /**
+     * Match the logs of a connected block and update the balances.
+     *
+     * @return the transfers from or to a watched token holder
+     */
+    std::vector<Transfer> BlockConnected(const uint256& block_hash, const std::vector<interfaces::ContractLog>& logs);
+
+    /**
+     * Revert BlockConnected(). If the block's balance changes are no longer
+     * known, every balance is unseeded.
+     */
+    void BlockDisconnected(const uint256& block_hash);
+
+    /**
+     * Seed the balance of a token. It must have been read at the last block
+     * the watcher was notified of.
+     */
+    bool SetBalance(const uint256& token, const uint256& balance);
+
+    //! Big-endian balance of a seeded token
+    std::optional<uint256> GetBalance(const uint256& token) const;
+
+private:
+    struct BalanceChange {
+        uint256 token;
+        arith_uint256 credit;
+        arith_uint256 debit;
+    };
+
+    struct BlockUndo {
+        uint256 hash;
+        std::vector<BalanceChange> changes;
+    };
+
+    std::map<uint256, Token> m_tokens;
+    std::map<uint256, arith_uint256> m_balances;
+    std::deque<BlockUndo> m_undo;
+};
+
+} // namespace wallet
+
+#endif // BITCOIN_WALLET_TOKENWATCHER_H
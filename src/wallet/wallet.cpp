@@ -66,6 +66,7 @@
 #include <wallet/crypter.h>
 #include <wallet/db.h>
 #include <wallet/external_signer_scriptpubkeyman.h>
+#include <wallet/privacy_rescan.h>
 #include <wallet/scriptpubkeyman.h>
 #include <wallet/transaction.h>
 #include <wallet/types.h>
@@ -75,11 +76,13 @@
 #include <algorithm>
 #include <cassert>
 #include <condition_variable>
+#include <deque>
 #include <exception>
 #include <optional>
 #include <stdexcept>
 #include <thread>
 #include <tuple>
+#include <unordered_set>
 #include <variant>
 
 struct KeyOriginInfo;
@@ -790,6 +793,7 @@ bool CWallet::IsSpent(const COutPoint& outpoint) const
 void CWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid, WalletBatch* batch)
 {
     mapTxSpends.insert(std::make_pair(outpoint, wtxid));
+    m_coin_index.MarkTxDirty(outpoint.hash.ToUint256());
 
     if (batch) {
         UnlockCoin(outpoint, batch);
@@ -816,6 +820,7 @@ void CWallet::RemoveFromSpends(const COutPoint& outpoint, const uint256& wtxid)
             break;
         }
     }
+    m_coin_index.MarkTxDirty(outpoint.hash.ToUint256());
     range = mapTxSpends.equal_range(outpoint);
     if(range.first != range.second)
         SyncMetaData(range);
@@ -1017,6 +1022,9 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+        MarkBalancesDirty();
+        // Also called when what the wallet owns changed
+        m_coin_index.Reset();
     }
 }
 
@@ -1104,6 +1112,7 @@ bool CWallet::IsSpentKey(const CScript& scriptPubKey) const
 CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const UpdateWalletTxFn& update_wtx, bool fFlushOnClose, bool rescanning_old_block)
 {
     LOCK(cs_wallet);
+    MarkBalancesDirty();
 
     WalletBatch batch(GetDatabase(), fFlushOnClose);
 
@@ -1126,6 +1135,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
     CWalletTx& wtx = (*ret.first).second;
     bool fInsertedNew = ret.second;
     bool fUpdated = update_wtx && update_wtx(wtx, fInsertedNew);
+    m_coin_index.MarkTxDirty(hash);
     if (fInsertedNew) {
         wtx.nTimeReceived = GetTime();
         wtx.nOrderPos = IncOrderPosNext(&batch);
@@ -1262,6 +1272,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
 
 bool CWallet::LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_wtx)
 {
+    MarkBalancesDirty();
     const auto& ins = mapWallet.emplace(std::piecewise_construct, std::forward_as_tuple(hash), std::forward_as_tuple(nullptr, TxStateInactive{}));
     CWalletTx& wtx = ins.first->second;
     if (!fill_wtx(wtx, ins.second)) {
@@ -1367,10 +1378,12 @@ bool CWallet::TransactionCanBeAbandoned(const uint256& hashTx) const
 
 void CWallet::MarkInputsDirty(const CTransactionRef& tx)
 {
+    MarkBalancesDirty();
     for (const CTxIn& txin : tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
         if (it != mapWallet.end()) {
             it->second.MarkDirty();
+            m_coin_index.MarkTxDirty(it->first);
         }
     }
 }
@@ -1452,6 +1465,7 @@ void CWallet::RecursiveUpdateTxState(const uint256& tx_hash, const TryUpdatingSt
 }
 
 void CWallet::RecursiveUpdateTxState(WalletBatch* batch, const uint256& tx_hash, const TryUpdatingStateFn& try_updating_state) {
+    MarkBalancesDirty();
     std::set<uint256> todo;
     std::set<uint256> done;
 
@@ -1596,10 +1610,18 @@ void CWallet::blockConnected(ChainstateRole role, const interfaces::BlockInfo& b
     }
     assert(block.data);
     LOCK(cs_wallet);
+    WalletBulkWrite bulk_write{GetDatabase()};
+
+    // Keep the stake caches current instead of rebuilding them on the next tip
+    minerStakeCache.BlockConnected(*block.data);
+    stakeCache.BlockConnected(*block.data);
+    stakeDelegateCache.BlockConnected(*block.data);
+    m_delegations_tracker.BlockConnected(*block.data, block.height);
 
     bool hasDelegation = block.data->HasProofOfDelegation();
     m_last_block_processed_height = block.height;
     m_last_block_processed = block.hash;
+    TokensBlockConnected(block);
 
     // No need to scan block if it was created before the wallet birthday.
     // Uses chain max time and twice the grace period to adjust time for block time variability.
@@ -1616,6 +1638,12 @@ void CWallet::blockDisconnected(const interfaces::BlockInfo& block)
 {
     assert(block.data);
     LOCK(cs_wallet);
+    WalletBulkWrite bulk_write{GetDatabase()};
+
+    minerStakeCache.BlockDisconnected(*block.data);
+    stakeCache.BlockDisconnected(*block.data);
+    stakeDelegateCache.BlockDisconnected(*block.data);
+    m_delegations_tracker.BlockDisconnected(*block.data);
 
     // At block disconnection, this will change an abandoned transaction to
     // be unconfirmed, whether or not the transaction is added back to the mempool.
@@ -1623,6 +1651,9 @@ void CWallet::blockDisconnected(const interfaces::BlockInfo& block)
     // future with a stickier abandoned state or even removing abandontransaction call.
     m_last_block_processed_height = block.height - 1;
     m_last_block_processed = *Assert(block.prev_hash);
+    // Depths go down, which the balance snapshots do not expect
+    MarkBalancesDirty();
+    TokensBlockDisconnected(block);
 
     int disconnect_height = block.height;
 
@@ -1663,6 +1694,13 @@ void CWallet::blockDisconnected(const interfaces::BlockInfo& block)
 void CWallet::updatedBlockTip()
 {
     m_best_block_time = GetTime();
+    WakeStaker();
+
+    // Reweigh the delegations once per tip rather than once per connected block
+    if (m_delegations_tracker.HasDelegates() && HaveChain() && !chain().isInitialBlockDownload()) {
+        LOCK(cs_wallet);
+        chain().refreshDelegationsWeight(*this);
+    }
 }
 
 void CWallet::BlockUntilSyncedToCurrentChain() const {
@@ -1975,8 +2013,8 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
 
     assert(reserver.isReserved());
 
-    uint256 block_hash = start_block;
     ScanResult result;
+    const size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
 
     std::unique_ptr<FastWalletRescanFilter> fast_rescan_filter;
     if (!IsLegacy() && chain().hasBlockFilterIndex(BlockFilterType::BASIC)) fast_rescan_filter = std::make_unique<FastWalletRescanFilter>(*this);
@@ -1989,72 +2027,257 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     uint256 tip_hash = WITH_LOCK(cs_wallet, return GetLastBlockHash());
     uint256 end_hash = tip_hash;
     if (max_height) chain().findAncestorByHeight(tip_hash, *max_height, FoundBlock().hash(end_hash));
-    double progress_begin = chain().guessVerificationProgress(block_hash);
+    double progress_begin = chain().guessVerificationProgress(start_block);
     double progress_end = chain().guessVerificationProgress(end_hash);
     double progress_current = progress_begin;
-    int block_height = start_height;
-    while (!fAbortRescan && !chain().shutdownRequested()) {
-        if (progress_end - progress_begin > 0.0) {
-            m_scanning_progress = (progress_current - progress_begin) / (progress_end - progress_begin);
-        } else { // avoid divide-by-zero for single block scan range (i.e. start and stop hashes are equal)
-            m_scanning_progress = 0;
-        }
-        if (block_height % 100 == 0 && progress_end - progress_begin > 0.0) {
-            ShowProgress(strprintf("%s %s", GetDisplayName(), _("Rescanning…")), std::max(1, std::min(99, (int)(m_scanning_progress * 100))));
-        }
 
-        bool next_interval = reserver.now() >= current_time + INTERVAL_TIME;
-        if (next_interval) {
-            current_time = reserver.now();
-            WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
-        }
+    // Blocks are read and their outputs matched on a pool of threads, against
+    // a copy of the descriptor scriptPubKey cache (m_cached_spks), since
+    // cs_wallet may be held by the caller for the whole rescan. Only the
+    // transactions that matched, or that involve the wallet through their
+    // inputs, are synced on this thread, in chain order.
+    //
+    // Committing a block can top up the keypool. Blocks matched against an
+    // older copy are matched again with IsMine() when committed, and the copy
+    // is replaced once it misses enough scripts to be worth rebuilding.
+    // Legacy wallets have no such cache and match every block with IsMine().
+    struct ScanScripts {
+        size_t generation{0};
+        std::unordered_set<CScript, SaltedSipHasher> scripts;
+    };
+    const bool legacy = IsLegacy();
+    const auto make_scan_scripts = [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        auto scan_scripts = std::make_shared<ScanScripts>();
+        scan_scripts->generation = m_cached_spks.size();
+        if (!legacy) {
+            scan_scripts->scripts.reserve(m_cached_spks.size());
+            for (const auto& [script, spkms] : m_cached_spks) scan_scripts->scripts.insert(script);
+        }
+        return std::shared_ptr<const ScanScripts>{std::move(scan_scripts)};
+    };
+
+    // A block moves through the pipeline read -> matched -> committed, like in
+    // ScanForPrivacyOutputs(), except that the blocks themselves are read by
+    // the workers, as reading them is the slow part here.
+    struct PendingBlock {
+        uint256 hash;
+        int height;
+        bool active{false};
+        bool fetch{true};                    // false if the block filter did not match
+        size_t generation{0};                // of the scripts the block was filtered or matched with
+        std::shared_ptr<const CBlock> block; // null if not fetched or could not be read
+        std::vector<bool> matched;           // per transaction, whether it pays to a script
+        bool scanned{false};
+    };
+    const size_t read_ahead = 2 * num_threads;
+    Mutex pipeline_mutex;
+    std::condition_variable pipeline_cv;
+    std::deque<std::shared_ptr<PendingBlock>> window; // walked and not yet committed, in chain order
+    size_t scan_pos{0};                               // index in window of the next block to read
+    bool read_done{false};
+    bool stop{false};
+    std::shared_ptr<const ScanScripts> scan_scripts{WITH_LOCK(cs_wallet, return make_scan_scripts())};
+    size_t cached_spks{scan_scripts->generation};     // size of m_cached_spks after the last commit
+
+    const auto walker = [&] {
+        uint256 block_hash = start_block;
+        int block_height = start_height;
+        while (true) {
+            {
+                WAIT_LOCK(pipeline_mutex, lock);
+                pipeline_cv.wait(lock, [&] { return stop || window.size() < read_ahead; });
+                if (stop) break;
+            }
 
-        bool fetch_block{true};
-        if (fast_rescan_filter) {
-            fast_rescan_filter->UpdateIfNeeded();
-            auto matches_block{fast_rescan_filter->MatchesBlock(block_hash)};
-            if (matches_block.has_value()) {
-                if (*matches_block) {
-                    LogDebug(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (filter matched)\n", block_height, block_hash.ToString());
+            auto pending = std::make_shared<PendingBlock>();
+            pending->hash = block_hash;
+            pending->height = block_height;
+
+            if (fast_rescan_filter) {
+                pending->generation = WITH_LOCK(pipeline_mutex, return cached_spks);
+                fast_rescan_filter->UpdateIfNeeded();
+                auto matches_block{fast_rescan_filter->MatchesBlock(block_hash)};
+                if (matches_block.has_value()) {
+                    if (*matches_block) {
+                        LogDebug(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (filter matched)\n", block_height, block_hash.ToString());
+                    } else {
+                        pending->fetch = false;
+                    }
                 } else {
-                    result.last_scanned_block = block_hash;
-                    result.last_scanned_height = block_height;
-                    fetch_block = false;
+                    LogDebug(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (WARNING: block filter not found!)\n", block_height, block_hash.ToString());
                 }
-            } else {
-                LogDebug(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (WARNING: block filter not found!)\n", block_height, block_hash.ToString());
             }
+
+            // Find next block separately from reading data, because reading
+            // is slow and there might be a reorg while it is read.
+            bool next_block = false;
+            uint256 next_block_hash;
+            chain().findBlock(block_hash, FoundBlock().inActiveChain(pending->active).nextBlock(FoundBlock().inActiveChain(next_block).hash(next_block_hash)));
+
+            // The wallet's last block is checked when committing, as cs_wallet
+            // can not be taken here
+            const bool last = !pending->active || !next_block || (max_height && block_height >= *max_height);
+            {
+                LOCK(pipeline_mutex);
+                window.push_back(std::move(pending));
+            }
+            pipeline_cv.notify_all();
+            if (last) break;
+
+            block_hash = next_block_hash;
+            ++block_height;
+        }
+        WITH_LOCK(pipeline_mutex, read_done = true);
+        pipeline_cv.notify_all();
+    };
+
+    const auto worker = [&] {
+        while (true) {
+            std::shared_ptr<PendingBlock> pending;
+            std::shared_ptr<const ScanScripts> scripts;
+            {
+                WAIT_LOCK(pipeline_mutex, lock);
+                pipeline_cv.wait(lock, [&] { return stop || read_done || scan_pos < window.size(); });
+                if (stop || scan_pos == window.size()) return;
+                pending = window[scan_pos++];
+                scripts = scan_scripts;
+            }
+
+            std::shared_ptr<CBlock> block;
+            std::vector<bool> matched;
+            if (pending->fetch) {
+                block = std::make_shared<CBlock>();
+                chain().findBlock(pending->hash, FoundBlock().data(*block));
+                if (block->IsNull()) {
+                    block.reset();
+                } else if (!legacy) {
+                    matched.resize(block->vtx.size());
+                    for (size_t i = 0; i < block->vtx.size(); ++i) {
+                        for (const CTxOut& txout : block->vtx[i]->vout) {
+                            if (scripts->scripts.count(txout.scriptPubKey)) {
+                                matched[i] = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            {
+                LOCK(pipeline_mutex);
+                if (pending->fetch) pending->generation = scripts->generation;
+                pending->block = std::move(block);
+                pending->matched = std::move(matched);
+                pending->scanned = true;
+            }
+            pipeline_cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads + 1);
+    threads.emplace_back(walker);
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    const auto stop_pipeline = [&] {
+        WITH_LOCK(pipeline_mutex, stop = true);
+        pipeline_cv.notify_all();
+        for (auto& thread : threads) {
+            if (thread.joinable()) thread.join();
         }
+    };
+
+    // Whether a transaction whose outputs did not match still concerns the
+    // wallet, the checks of AddToWalletIfInvolvingMe() that need no script
+    const auto involves_wallet_inputs = [&](const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        if (mapWallet.count(tx.GetHash())) return true;
+        for (const CTxIn& txin : tx.vin) {
+            if (mapWallet.count(txin.prevout.hash) || mapTxSpends.count(txin.prevout)) return true;
+        }
+        return false;
+    };
+
+    // Commit on this thread, one block at a time in chain order
+    int block_height = start_height;
+    try {
+        while (!fAbortRescan && !chain().shutdownRequested()) {
+            std::shared_ptr<PendingBlock> pending;
+            {
+                WAIT_LOCK(pipeline_mutex, lock);
+                pipeline_cv.wait(lock, [&] { return (!window.empty() && window.front()->scanned) || (read_done && window.empty()); });
+                if (window.empty()) break;
+                pending = std::move(window.front());
+                window.pop_front();
+                --scan_pos;
+            }
+            pipeline_cv.notify_all();
+            const uint256& block_hash = pending->hash;
+            block_height = pending->height;
+
+            if (progress_end - progress_begin > 0.0) {
+                m_scanning_progress = (progress_current - progress_begin) / (progress_end - progress_begin);
+            } else { // avoid divide-by-zero for single block scan range (i.e. start and stop hashes are equal)
+                m_scanning_progress = 0;
+            }
+            if (block_height % 100 == 0 && progress_end - progress_begin > 0.0) {
+                ShowProgress(strprintf("%s %s", GetDisplayName(), _("Rescanning…")), std::max(1, std::min(99, (int)(m_scanning_progress * 100))));
+            }
 
-        // Find next block separately from reading data above, because reading
-        // is slow and there might be a reorg while it is read.
-        bool block_still_active = false;
-        bool next_block = false;
-        uint256 next_block_hash;
-        chain().findBlock(block_hash, FoundBlock().inActiveChain(block_still_active).nextBlock(FoundBlock().inActiveChain(next_block).hash(next_block_hash)));
+            bool next_interval = reserver.now() >= current_time + INTERVAL_TIME;
+            if (next_interval) {
+                current_time = reserver.now();
+                WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
+            }
 
-        if (fetch_block) {
-            // Read block data
-            CBlock block;
-            chain().findBlock(block_hash, FoundBlock().data(block));
+            // A block the filter skipped before the scripts were last topped
+            // up may pay to the new ones
+            std::shared_ptr<const CBlock> block = pending->block;
+            if (!pending->fetch && pending->generation != WITH_LOCK(cs_wallet, return m_cached_spks.size())) {
+                auto read = std::make_shared<CBlock>();
+                chain().findBlock(block_hash, FoundBlock().data(*read));
+                if (!read->IsNull()) block = std::move(read);
+                pending->fetch = true;
+            }
 
-            if (!block.IsNull()) {
+            if (!pending->fetch) {
+                result.last_scanned_block = block_hash;
+                result.last_scanned_height = block_height;
+            } else if (block) {
                 LOCK(cs_wallet);
-                if (!block_still_active) {
+                WalletBulkWrite bulk_write{GetDatabase()};
+                if (!pending->active) {
                     // Abort scan if current block is no longer active, to prevent
                     // marking transactions as coming from the wrong block.
                     result.last_failed_block = block_hash;
                     result.status = ScanResult::FAILURE;
                     break;
                 }
-                bool hasDelegation = block.HasProofOfDelegation();
-                for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
-                    SyncTransaction(block.vtx[posInBlock], TxStateConfirmed{block_hash, block_height, static_cast<int>(posInBlock), hasDelegation}, fUpdate, /*rescanning_old_block=*/true);
+                const bool stale = legacy || pending->generation != m_cached_spks.size();
+                bool hasDelegation = block->HasProofOfDelegation();
+                for (size_t posInBlock = 0; posInBlock < block->vtx.size(); ++posInBlock) {
+                    const CTransactionRef& tx = block->vtx[posInBlock];
+                    const bool matched = stale ? IsMine(*tx) : pending->matched[posInBlock];
+                    if (!matched && !involves_wallet_inputs(*tx)) continue;
+                    SyncTransaction(tx, TxStateConfirmed{block_hash, block_height, static_cast<int>(posInBlock), hasDelegation}, fUpdate, /*rescanning_old_block=*/true);
                 }
                 // scan succeeded, record block as most recent successfully scanned
                 result.last_scanned_block = block_hash;
                 result.last_scanned_height = block_height;
 
+                // Rebuild the copy of the scripts once an eighth of them is
+                // missing from it, so that topping up one key at a time does
+                // not copy the whole cache each time
+                std::shared_ptr<const ScanScripts> scripts;
+                if (!legacy && m_cached_spks.size() - scan_scripts->generation > scan_scripts->generation / 8) {
+                    scripts = make_scan_scripts();
+                }
+                {
+                    LOCK(pipeline_mutex);
+                    cached_spks = m_cached_spks.size();
+                    if (scripts) scan_scripts = std::move(scripts);
+                }
+
                 if (save_progress && next_interval) {
                     CBlockLocator loc = m_chain->getActiveChainLocator(block_hash);
 
@@ -2069,28 +2292,15 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
                 result.last_failed_block = block_hash;
                 result.status = ScanResult::FAILURE;
             }
-        }
-        if (max_height && block_height >= *max_height) {
-            break;
-        }
-        // If rescanning was triggered with cs_wallet permanently locked (AttachChain), additional blocks that were connected during the rescan
-        // aren't processed here but will be processed with the pending blockConnected notifications after the lock is released.
-        // If rescanning without a permanent cs_wallet lock, additional blocks that were added during the rescan will be re-processed if
-        // the notification was processed and the last block height was updated.
-        if (block_height >= WITH_LOCK(cs_wallet, return GetLastBlockHeight())) {
-            break;
-        }
 
-        {
-            if (!next_block) {
-                // break successfully when rescan has reached the tip, or
-                // previous block is no longer on the chain due to a reorg
+            // If rescanning was triggered with cs_wallet permanently locked (AttachChain), additional blocks that were connected during the rescan
+            // aren't processed here but will be processed with the pending blockConnected notifications after the lock is released.
+            // If rescanning without a permanent cs_wallet lock, additional blocks that were added during the rescan will be re-processed if
+            // the notification was processed and the last block height was updated.
+            if (block_height >= WITH_LOCK(cs_wallet, return GetLastBlockHeight())) {
                 break;
             }
 
-            // increment block and verification progress
-            block_hash = next_block_hash;
-            ++block_height;
             progress_current = chain().guessVerificationProgress(block_hash);
 
             // handle updated tip hash
@@ -2101,7 +2311,12 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
                 progress_end = chain().guessVerificationProgress(tip_hash);
             }
         }
+    } catch (...) {
+        stop_pipeline();
+        throw;
     }
+    stop_pipeline();
+
     if (!max_height) {
         WalletLogPrintf("Scanning current mempool transactions.\n");
         WITH_LOCK(cs_wallet, chain().requestMempoolTransactions(*this));
@@ -2119,6 +2334,196 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     return result;
 }
 
+CWallet::ScanResult CWallet::ScanForPrivacyOutputs(const uint256& start_block, int start_height, std::optional<int> max_height, const WalletRescanReserver& reserver, const std::vector<std::unique_ptr<PrivacyBlockDetector>>& detectors, const bool save_progress)
+{
+    constexpr auto INTERVAL_TIME{60s};
+    auto current_time{reserver.now()};
+    auto start_time{reserver.now()};
+
+    assert(reserver.isReserved());
+
+    ScanResult result;
+    const size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+
+    WalletLogPrintf("Privacy rescan started from block %s with %u threads...\n", start_block.ToString(), num_threads);
+
+    fAbortRescan = false;
+    ShowProgress(strprintf("%s %s", GetDisplayName(), _("Rescanning…")), 0);
+    const int end_height = max_height ? *max_height : WITH_LOCK(cs_wallet, return GetLastBlockHeight());
+
+    // A block moves through the pipeline read -> scanned -> committed. Only
+    // the blocks between the commit position and the read position are held,
+    // so memory is bounded by the read-ahead.
+    struct PendingBlock {
+        uint256 hash;
+        int height;
+        bool active{false};
+        std::shared_ptr<const CBlock> block; // null if the block could not be read
+        bool scanned{false};
+        std::vector<PrivacyBlockCommit> commits;
+    };
+    const size_t read_ahead = 2 * num_threads;
+    Mutex pipeline_mutex;
+    std::condition_variable pipeline_cv;
+    std::deque<std::shared_ptr<PendingBlock>> window; // read and not yet committed, in chain order
+    size_t scan_pos{0};                               // index in window of the next block to scan
+    bool read_done{false};
+    bool stop{false};
+
+    const auto reader = [&] {
+        uint256 block_hash = start_block;
+        int block_height = start_height;
+        while (true) {
+            {
+                WAIT_LOCK(pipeline_mutex, lock);
+                pipeline_cv.wait(lock, [&] { return stop || window.size() < read_ahead; });
+                if (stop) break;
+            }
+
+            auto pending = std::make_shared<PendingBlock>();
+            pending->hash = block_hash;
+            pending->height = block_height;
+
+            // Find next block separately from reading data below, because
+            // reading is slow and there might be a reorg while it is read.
+            bool next_block = false;
+            uint256 next_block_hash;
+            chain().findBlock(block_hash, FoundBlock().inActiveChain(pending->active).nextBlock(FoundBlock().inActiveChain(next_block).hash(next_block_hash)));
+
+            auto block = std::make_shared<CBlock>();
+            chain().findBlock(block_hash, FoundBlock().data(*block));
+            if (!block->IsNull()) pending->block = std::move(block);
+
+            const bool last = !pending->active || !next_block || block_height >= end_height ||
+                              block_height >= WITH_LOCK(cs_wallet, return GetLastBlockHeight());
+            {
+                LOCK(pipeline_mutex);
+                window.push_back(std::move(pending));
+            }
+            pipeline_cv.notify_all();
+            if (last) break;
+
+            block_hash = next_block_hash;
+            ++block_height;
+        }
+        WITH_LOCK(pipeline_mutex, read_done = true);
+        pipeline_cv.notify_all();
+    };
+
+    const auto worker = [&] {
+        while (true) {
+            std::shared_ptr<PendingBlock> pending;
+            {
+                WAIT_LOCK(pipeline_mutex, lock);
+                pipeline_cv.wait(lock, [&] { return stop || read_done || scan_pos < window.size(); });
+                if (stop || scan_pos == window.size()) return;
+                pending = window[scan_pos++];
+            }
+
+            std::vector<PrivacyBlockCommit> commits;
+            if (pending->active && pending->block) {
+                for (const auto& detector : detectors) {
+                    if (auto commit = detector->ScanBlock(pending->block, pending->height)) {
+                        commits.push_back(std::move(commit));
+                    }
+                }
+            }
+
+            {
+                LOCK(pipeline_mutex);
+                pending->commits = std::move(commits);
+                pending->scanned = true;
+            }
+            pipeline_cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads + 1);
+    threads.emplace_back(reader);
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+
+    // Commit on this thread, one block at a time in chain order
+    WalletBatch batch(GetDatabase());
+    const auto save_scan_progress = [&](const uint256& block_hash, int block_height) {
+        CBlockLocator loc = m_chain->getActiveChainLocator(block_hash);
+        if (!loc.IsNull()) {
+            WalletLogPrintf("Saving privacy scan progress %d.\n", block_height);
+            batch.WritePrivacyRescanProgress(loc);
+        }
+    };
+    int block_height = start_height;
+    while (!fAbortRescan && !chain().shutdownRequested()) {
+        std::shared_ptr<PendingBlock> pending;
+        {
+            WAIT_LOCK(pipeline_mutex, lock);
+            pipeline_cv.wait(lock, [&] { return (!window.empty() && window.front()->scanned) || (read_done && window.empty()); });
+            if (window.empty()) break;
+            pending = std::move(window.front());
+            window.pop_front();
+            --scan_pos;
+        }
+        pipeline_cv.notify_all();
+        block_height = pending->height;
+
+        if (!pending->active) {
+            // Abort scan if current block is no longer active, to prevent
+            // recording outputs as coming from the wrong block.
+            result.last_failed_block = pending->hash;
+            result.status = ScanResult::FAILURE;
+            break;
+        }
+        if (!pending->block) {
+            // could not scan block, keep scanning but record this block as the most recent failure
+            result.last_failed_block = pending->hash;
+            result.status = ScanResult::FAILURE;
+            continue;
+        }
+
+        for (const auto& commit : pending->commits) {
+            commit(batch);
+        }
+        result.last_scanned_block = pending->hash;
+        result.last_scanned_height = block_height;
+
+        if (end_height > start_height) {
+            m_scanning_progress = double(block_height - start_height) / (end_height - start_height);
+            if (block_height % 100 == 0) {
+                ShowProgress(strprintf("%s %s", GetDisplayName(), _("Rescanning…")), std::max(1, std::min(99, (int)(m_scanning_progress * 100))));
+            }
+        }
+
+        if (reserver.now() >= current_time + INTERVAL_TIME) {
+            current_time = reserver.now();
+            WalletLogPrintf("Still rescanning privacy outputs. At block %d.\n", block_height);
+            if (save_progress) save_scan_progress(pending->hash, block_height);
+        }
+    }
+
+    WITH_LOCK(pipeline_mutex, stop = true);
+    pipeline_cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (save_progress && result.last_scanned_height) {
+        save_scan_progress(result.last_scanned_block, *result.last_scanned_height);
+    }
+    ShowProgress(strprintf("%s %s", GetDisplayName(), _("Rescanning…")), 100); // hide progress dialog in GUI
+    if (fAbortRescan) {
+        WalletLogPrintf("Privacy rescan aborted at block %d.\n", block_height);
+        result.status = ScanResult::USER_ABORT;
+    } else if (chain().shutdownRequested()) {
+        WalletLogPrintf("Privacy rescan interrupted by shutdown request at block %d.\n", block_height);
+        result.status = ScanResult::USER_ABORT;
+    } else {
+        WalletLogPrintf("Privacy rescan completed in %15dms\n", Ticks<std::chrono::milliseconds>(reserver.now() - start_time));
+    }
+    return result;
+}
+
 bool CWallet::SubmitTxMemoryPoolAndRelay(CWalletTx& wtx, std::string& err_string, bool relay) const
 {
     AssertLockHeld(cs_wallet);
@@ -2145,7 +2550,10 @@ bool CWallet::SubmitTxMemoryPoolAndRelay(CWalletTx& wtx, std::string& err_string
     // If transaction was previously in the mempool, it should be updated when
     // TransactionRemovedFromMempool fires.
     bool ret = chain().broadcastTransaction(wtx.tx, m_default_max_tx_fee, relay, err_string);
-    if (ret) wtx.m_state = TxStateInMempool{};
+    if (ret) {
+        wtx.m_state = TxStateInMempool{};
+        MarkBalancesDirty();
+    }
     return ret;
 }
 
@@ -2570,6 +2978,7 @@ OutputType CWallet::TransactionChangeType(const std::optional<OutputType>& chang
 void CWallet::CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::vector<std::pair<std::string, std::string>> orderForm)
 {
     LOCK(cs_wallet);
+    WalletBulkWrite bulk_write{GetDatabase()};
     WalletLogPrintf("CommitTransaction:\n%s\n", util::RemoveSuffixView(tx->ToString(), "\n"));
 
     // Add tx to wallet, because if it has change it's also ours,
@@ -2921,6 +3330,7 @@ std::optional<int64_t> CWallet::GetOldestKeyPoolTime() const
 }
 
 void CWallet::MarkDestinationsDirty(const std::set<CTxDestination>& destinations) {
+    MarkBalancesDirty();
     for (auto& entry : mapWallet) {
         CWalletTx& wtx = entry.second;
         if (wtx.m_is_cache_empty) continue;
@@ -2983,6 +3393,7 @@ void CWallet::DisableTransaction(const CTransaction &tx)
     if(AbandonTransaction(hash))
     {
         LOCK(cs_wallet);
+        MarkBalancesDirty();
         CWalletTx& wtx = mapWallet.at(hash);
         RemoveFromSpends(wtx);
         for(const CTxIn& txin : tx.vin)
@@ -3799,12 +4210,102 @@ bool CWallet::BackupWallet(const std::string& strDest) const
 
 bool CWallet::LoadToken(const CTokenInfo &token)
 {
+    LOCK(cs_wallet);
     uint256 hash = token.GetHash();
     mapToken[hash] = token;
+    UpdateTokenWatcher();
 
     return true;
 }
 
+void CWallet::UpdateTokenWatcher()
+{
+    AssertLockHeld(cs_wallet);
+    std::map<uint256, TokenWatcher::Token> tokens;
+    for (const auto& [hash, info] : mapToken) {
+        if (info.strContractAddress.size() != 40 || !IsHex(info.strContractAddress)) continue;
+        const CTxDestination holder = DecodeDestination(info.strSenderAddress);
+        const PKHash* pkhash = std::get_if<PKHash>(&holder);
+        if (!pkhash) continue;
+        tokens.emplace(hash, TokenWatcher::Token{uint160{ParseHex(info.strContractAddress)}, ToKeyID(*pkhash)});
+    }
+    m_token_watcher.SetTokens(std::move(tokens));
+}
+
+void CWallet::TokensBlockConnected(const interfaces::BlockInfo& block)
+{
+    AssertLockHeld(cs_wallet);
+    std::vector<interfaces::ContractLog> logs;
+    if (m_token_watcher.HasTokens()) chain().getBlockContractLogs(*block.data, logs);
+
+    for (const TokenWatcher::Transfer& transfer : m_token_watcher.BlockConnected(block.hash, logs)) {
+        CTokenTx tokenTx;
+        tokenTx.strContractAddress = HexStr(transfer.contract);
+        tokenTx.strSenderAddress = EncodeDestination(PKHash(transfer.sender));
+        if (!transfer.receiver.IsNull()) tokenTx.strReceiverAddress = EncodeDestination(PKHash(transfer.receiver));
+        tokenTx.nValue = transfer.value;
+        tokenTx.transactionHash = transfer.tx_hash;
+        tokenTx.blockHash = block.hash;
+        tokenTx.blockNumber = block.height;
+        AddTokenTxEntry(tokenTx, false);
+    }
+
+    // Tokens whose event log search reached the previous block follow the chain from here, so
+    // the search has nothing left to do. This is not written to disk: after a restart the
+    // search resumes from the last block it wrote.
+    for (auto& [hash, info] : mapToken) {
+        if (block.prev_hash && info.blockHash == *block.prev_hash) {
+            info.blockHash = block.hash;
+            info.blockNumber = block.height;
+        }
+    }
+}
+
+void CWallet::TokensBlockDisconnected(const interfaces::BlockInfo& block)
+{
+    AssertLockHeld(cs_wallet);
+    m_token_watcher.BlockDisconnected(block.hash);
+
+    WalletBatch batch(GetDatabase(), false);
+    for (auto it = mapTokenTx.begin(); it != mapTokenTx.end();) {
+        if (it->second.blockHash != block.hash) {
+            ++it;
+            continue;
+        }
+        const uint256 hash{it->first};
+        if (!batch.EraseTokenTx(hash)) {
+            ++it;
+            continue;
+        }
+        it = mapTokenTx.erase(it);
+        NotifyTokenTransactionChanged(this, hash, CT_DELETED);
+    }
+
+    for (auto& [hash, info] : mapToken) {
+        if (info.blockHash == block.hash) {
+            info.blockHash = *block.prev_hash;
+            info.blockNumber = block.height - 1;
+        }
+    }
+}
+
+bool CWallet::GetTokenBalance(const uint256& tokenHash, uint256& balance) const
+{
+    LOCK(cs_wallet);
+    const std::optional<uint256> watched{m_token_watcher.GetBalance(tokenHash)};
+    if (!watched) return false;
+    balance = *watched;
+    return true;
+}
+
+bool CWallet::SetTokenBalance(const uint256& tokenHash, const uint256& balance, const uint256& block_hash)
+{
+    LOCK(cs_wallet);
+    // A balance read at another block than the wallet is at would go out of step
+    if (block_hash != m_last_block_processed) return false;
+    return m_token_watcher.SetBalance(tokenHash, balance);
+}
+
 bool CWallet::LoadTokenTx(const CTokenTx &tokenTx)
 {
     uint256 hash = tokenTx.GetHash();
@@ -3845,6 +4346,8 @@ bool CWallet::AddTokenEntry(const CTokenInfo &token, bool fFlushOnClose)
 
     mapToken[hash] = wtoken;
 
+    UpdateTokenWatcher();
+
     NotifyTokenChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
     // Refresh token tx
@@ -5100,6 +5603,17 @@ void CWallet::TopUpCallback(const std::set<CScript>& spks, ScriptPubKeyMan* spkm
 {
     // Update scriptPubKey cache
     CacheNewScriptPubKeys(spks, spkm);
+
+    // Outputs of wallet transactions may pay to them already, cs_wallet is
+    // not necessarily held here
+    LOCK(m_new_spks_mutex);
+    m_new_spks.insert(spks.begin(), spks.end());
+}
+
+std::set<CScript> CWallet::TakeNewScriptPubKeys() const
+{
+    LOCK(m_new_spks_mutex);
+    return std::exchange(m_new_spks, {});
 }
 
 std::set<CExtPubKey> CWallet::GetActiveHDPubKeys() const
@@ -5231,6 +5745,7 @@ bool CWallet::RemoveTokenEntry(const uint256 &tokenHash, bool fFlushOnClose)
             return false;
 
         mapToken.erase(it);
+        UpdateTokenWatcher();
 
         NotifyTokenChanged(this, tokenHash, CT_DELETED);
 
@@ -5545,6 +6060,26 @@ bool CWallet::IsStakeClosing()
     return m_stop_staking_thread;
 }
 
+void CWallet::WakeStaker()
+{
+    {
+        LOCK(m_staker_wakeup_mutex);
+        m_staker_wakeup = true;
+    }
+    m_staker_wakeup_cv.notify_all();
+}
+
+bool CWallet::WaitStaker(std::chrono::milliseconds timeout, bool wakeable)
+{
+    WAIT_LOCK(m_staker_wakeup_mutex, lock);
+    m_staker_wakeup_cv.wait_for(lock, timeout, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_staker_wakeup_mutex) {
+        return IsStakeClosing() || (wakeable && m_staker_wakeup);
+    });
+    // A plain sleep leaves the wakeup to the next wakeable wait
+    if (wakeable) m_staker_wakeup = false;
+    return !IsStakeClosing();
+}
+
 void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &delegations_staker)
 {
     LOCK(cs_wallet);
@@ -5580,6 +6115,10 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
             NotifyDelegationsStakerChanged(this, it->first, CT_NEW);
         }
     }
+
+    std::vector<uint160> delegates;
+    for (const auto& [delegate, delegation] : m_delegations_staker) delegates.push_back(delegate);
+    m_delegations_tracker.SetDelegates(delegates);
 }
 
 void CWallet::updateDelegationsWeight(const std::map<uint160, CAmount>& delegations_weight)
@@ -27,18 +27,25 @@
 #include <util/string.h>
 #include <util/time.h>
 #include <util/ui_change_type.h>
+#include <wallet/coinindex.h>
 #include <wallet/crypter.h>
 #include <wallet/db.h>
+#include <wallet/delegationweight.h>
 #include <wallet/scriptpubkeyman.h>
+#include <wallet/stakerstats.h>
+#include <wallet/tokenwatcher.h>
 #include <wallet/transaction.h>
 #include <wallet/types.h>
 #include <wallet/walletutil.h>
 #include <validation.h>
 #include <consensus/params.h>
 #include <qtum/posutils.h>
+#include <pos_stake_cache.h>
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -70,6 +77,7 @@ class Wallet;
 }
 namespace wallet {
 class CWallet;
+class PrivacyBlockDetector;
 class WalletBatch;
 enum class DBErrors : int;
 } // namespace wallet
@@ -156,6 +164,9 @@ static const uint8_t DEFAULT_STAKING_MIN_FEE = 10;
 //! -minstakerutxosize default
 static const CAmount DEFAULT_STAKER_MIN_UTXO_SIZE{COIN/10};
 
+//! -consolidatedust default
+static const bool DEFAULT_CONSOLIDATE_DUST{false};
+
 //! -maxstakerutxoscriptcache default
 static const int32_t DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE = 200000;
 
@@ -168,6 +179,7 @@ class CContractBookData;
 class CDelegationInfo;
 class CSuperStakerInfo;
 class CTokenInfo;
+struct BalanceSnapshots;
 
 //! Default for -addresstype
 constexpr OutputType DEFAULT_ADDRESS_TYPE{OutputType::LEGACY};
@@ -442,6 +454,12 @@ private:
      */
     int m_last_block_processed_height GUARDED_BY(cs_wallet) = -1;
 
+    //! Bumped whenever wallet transactions, their state or what the wallet owns change
+    mutable uint64_t m_balance_epoch GUARDED_BY(cs_wallet){0};
+
+    mutable Mutex m_new_spks_mutex;
+    mutable std::set<CScript> m_new_spks GUARDED_BY(m_new_spks_mutex);
+
     std::map<OutputType, ScriptPubKeyMan*> m_external_spk_managers;
     std::map<OutputType, ScriptPubKeyMan*> m_internal_spk_managers;
 
@@ -541,13 +559,16 @@ public:
 
     std::map<uint256, CTokenTx> mapTokenTx;
 
+    //! Transfers and balances of the tokens in mapToken, from the logs of each block
+    TokenWatcher m_token_watcher GUARDED_BY(cs_wallet);
+
     std::map<uint256, CDelegationInfo> mapDelegation;
 
     std::map<uint256, CSuperStakerInfo> mapSuperStaker;
 
     bool fUpdatedSuperStaker = false;
 
-    std::map<COutPoint, CStakeCache> minerStakeCache;
+    StakeCacheMap minerStakeCache;
 
     std::map<uint160, bool> mapAddressUnspentCache;
 
@@ -646,6 +667,13 @@ public:
 
     bool LoadToken(const CTokenInfo &token);
 
+    //! Watch the tokens in mapToken
+    void UpdateTokenWatcher() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    //! Record the token transfers of a block and follow it with the tokens that are caught up
+    void TokensBlockConnected(const interfaces::BlockInfo& block) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    //! Drop the token transfers of a disconnected block
+    void TokensBlockDisconnected(const interfaces::BlockInfo& block) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     bool LoadTokenTx(const CTokenTx &tokenTx);
 
     //! Adds a contract data tuple to the store, without saving it to disk
@@ -660,6 +688,16 @@ public:
 
     void MarkDirty();
 
+    //! Invalidate the balances computed so far, see BalanceSnapshots
+    void MarkBalancesDirty() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { ++m_balance_epoch; }
+    uint64_t GetBalanceEpoch() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { return m_balance_epoch; }
+    //! Balances reused by GetBalance() and GetAddressBalances()
+    mutable std::shared_ptr<BalanceSnapshots> m_balance_snapshots GUARDED_BY(cs_wallet);
+    //! Unspent outputs AvailableCoins() and the staker select from
+    mutable SpendableCoinIndex m_coin_index GUARDED_BY(cs_wallet);
+    //! Scripts added by key pool top ups since the coin index last looked
+    std::set<CScript> TakeNewScriptPubKeys() const EXCLUSIVE_LOCKS_REQUIRED(!m_new_spks_mutex);
+
     //! Callback for updating transaction metadata in mapWallet.
     //!
     //! @param wtx - reference to mapWallet transaction to update
@@ -696,6 +734,15 @@ public:
         uint256 last_failed_block;
     };
     ScanResult ScanForWalletTransactions(const uint256& start_block, int start_height, std::optional<int> max_height, const WalletRescanReserver& reserver, bool fUpdate, const bool save_progress);
+    /**
+     * Rescan blocks for privacy outputs with the given detectors. One thread
+     * reads blocks ahead of the scan, a pool of threads runs every detector
+     * on each block, and the findings are committed to the wallet database
+     * in chain order. With save_progress the last committed block is
+     * checkpointed (WalletBatch::WritePrivacyRescanProgress) so an
+     * interrupted rescan can resume.
+     */
+    ScanResult ScanForPrivacyOutputs(const uint256& start_block, int start_height, std::optional<int> max_height, const WalletRescanReserver& reserver, const std::vector<std::unique_ptr<PrivacyBlockDetector>>& detectors, const bool save_progress);
     void transactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason) override;
     /** Set the next time this wallet should resend transactions to 12-36 hours from now, ~1 day on average. */
     void SetNextResend() { m_next_resend = GetDefaultNextResend(); }
@@ -831,12 +878,17 @@ public:
     int64_t m_last_coin_stake_search_time{0};
     int64_t m_last_coin_stake_search_interval{0};
     std::atomic<bool> m_enabled_staking{false};
+    StakerStats m_staker_stats;
     CAmount m_staking_min_utxo_value{DEFAULT_STAKING_MIN_UTXO_VALUE};
     CAmount m_staker_min_utxo_size{DEFAULT_STAKER_MIN_UTXO_SIZE};
     int32_t m_staker_max_utxo_script_cache{DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE};
     uint8_t m_staking_min_fee{DEFAULT_STAKING_MIN_FEE};
     std::atomic<bool> m_stop_staking_thread{false};
     std::atomic<bool> m_is_staking_thread_stopped{false};
+    Mutex m_staker_wakeup_mutex;
+    std::condition_variable m_staker_wakeup_cv;
+    //! Set by WakeStaker() until the staking thread waits for it
+    bool m_staker_wakeup GUARDED_BY(m_staker_wakeup_mutex){false};
 
     size_t KeypoolCountExternalKeys() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool TopUpKeyPool(unsigned int kpSize = 0);
@@ -1138,6 +1190,7 @@ public:
         AssertLockHeld(cs_wallet);
         m_last_block_processed_height = block_height;
         m_last_block_processed = block_hash;
+        MarkBalancesDirty();
     };
 
     //! Connect the signals from ScriptPubKeyMans to the signals in CWallet
@@ -1231,6 +1284,12 @@ public:
     /* Clean token transaction entries in the wallet */
     bool CleanTokenTxEntries(bool fFlushOnClose=true);
 
+    /* Get the balance of a token kept by the token watcher */
+    bool GetTokenBalance(const uint256& tokenHash, uint256& balance) const;
+
+    /* Seed the balance of a token, read at block_hash, for the token watcher to keep current */
+    bool SetTokenBalance(const uint256& tokenHash, const uint256& balance, const uint256& block_hash);
+
     /* Load delegation entry into the wallet */
     bool LoadDelegation(const CDelegationInfo &delegation);
 
@@ -1258,6 +1317,13 @@ public:
     /* Is staking closing */
     bool IsStakeClosing();
 
+    /* Wake the staking thread, e.g. for a new tip */
+    void WakeStaker() EXCLUSIVE_LOCKS_REQUIRED(!m_staker_wakeup_mutex);
+
+    /* Wait for the staking thread until timeout, staking is closing or, if wakeable, WakeStaker() is called.
+     * Return false if staking is closing */
+    bool WaitStaker(std::chrono::milliseconds timeout, bool wakeable) EXCLUSIVE_LOCKS_REQUIRED(!m_staker_wakeup_mutex);
+
     /* Clean coinstake transactions */
     void CleanCoinStake();
 
@@ -1270,14 +1336,16 @@ public:
 
     std::map<uint160, Delegation> m_delegations_staker;
     std::map<uint160, CAmount> m_delegations_weight;
+    //! Coins of the delegates in m_delegations_staker and their last computed weights
+    mutable DelegationWeightTracker m_delegations_tracker;
     std::map<uint160, Delegation> m_my_delegations;
     std::map<uint160, bool> m_have_coin_superstaker;
     int m_num_threads = 1;
     mutable boost::thread_group threads;
     std::string m_ledger_id;
     boost::thread_group* stakeThread = nullptr;
-    std::map<COutPoint, CStakeCache> stakeCache;
-    std::map<COutPoint, CStakeCache> stakeDelegateCache;
+    StakeCacheMap stakeCache;
+    StakeCacheMap stakeDelegateCache;
     bool fHasMinerStakeCache = false;
     mutable std::map<COutPoint, CScriptCache> prevoutScriptCache;
     mutable std::map<uint160, bool> addressStakeCache;
@@ -38,6 +38,7 @@ const std::string ACTIVEEXTERNALSPK{"activeexternalspk"};
 const std::string ACTIVEINTERNALSPK{"activeinternalspk"};
 const std::string BESTBLOCK_NOMERKLE{"bestblock_nomerkle"};
 const std::string BESTBLOCK{"bestblock"};
+const std::string CT_AMOUNT{"ctamount"};
 const std::string CRYPTED_KEY{"ckey"};
 const std::string CSCRIPT{"cscript"};
 const std::string DEFAULTKEY{"defaultkey"};
@@ -53,6 +54,7 @@ const std::string NAME{"name"};
 const std::string OLD_KEY{"wkey"};
 const std::string ORDERPOSNEXT{"orderposnext"};
 const std::string POOL{"pool"};
+const std::string PRIVACY_RESCAN{"privacyrescan"};
 const std::string PURPOSE{"purpose"};
 const std::string SETTINGS{"settings"};
 const std::string TX{"tx"};
@@ -60,6 +62,7 @@ const std::string VERSION{"version"};
 const std::string WALLETDESCRIPTOR{"walletdescriptor"};
 const std::string WALLETDESCRIPTORCACHE{"walletdescriptorcache"};
 const std::string WALLETDESCRIPTORLHCACHE{"walletdescriptorlhcache"};
+const std::string WALLETDESCRIPTORSPKS{"walletdescriptorspks"};
 const std::string WALLETDESCRIPTORCKEY{"walletdescriptorckey"};
 const std::string WALLETDESCRIPTORKEY{"walletdescriptorkey"};
 const std::string WATCHMETA{"watchmeta"};
@@ -197,6 +200,40 @@ bool WalletBatch::ReadBestBlock(CBlockLocator& locator)
     return m_batch->Read(DBKeys::BESTBLOCK_NOMERKLE, locator);
 }
 
+bool WalletBatch::WritePrivacyRescanProgress(const CBlockLocator& locator)
+{
+    return WriteIC(DBKeys::PRIVACY_RESCAN, locator);
+}
+
+bool WalletBatch::ReadPrivacyRescanProgress(CBlockLocator& locator)
+{
+    return m_batch->Read(DBKeys::PRIVACY_RESCAN, locator);
+}
+
+bool WalletBatch::WriteConfidentialAmount(const COutPoint& outpoint, const CConfidentialAmountEntry& entry)
+{
+    return WriteIC(std::make_pair(DBKeys::CT_AMOUNT, outpoint), entry);
+}
+
+bool WalletBatch::ReadConfidentialAmounts(std::map<COutPoint, CConfidentialAmountEntry>& entries)
+{
+    DataStream prefix;
+    prefix << DBKeys::CT_AMOUNT;
+    std::unique_ptr<DatabaseCursor> cursor = m_batch->GetNewPrefixCursor(prefix);
+    if (!cursor) return false;
+
+    DataStream key, value;
+    while (true) {
+        const DatabaseCursor::Status status = cursor->Next(key, value);
+        if (status == DatabaseCursor::Status::DONE) return true;
+        if (status == DatabaseCursor::Status::FAIL) return false;
+        std::string type;
+        COutPoint outpoint;
+        key >> type >> outpoint;
+        value >> entries[outpoint];
+    }
+}
+
 bool WalletBatch::IsEncrypted()
 {
     DataStream prefix;
@@ -291,6 +328,11 @@ bool WalletBatch::WriteDescriptorLastHardenedCache(const CExtPubKey& xpub, const
     return WriteIC(std::make_pair(std::make_pair(DBKeys::WALLETDESCRIPTORLHCACHE, desc_id), key_exp_index), ser_xpub);
 }
 
+bool WalletBatch::WriteDescriptorDerivedScripts(const uint256& desc_id, int32_t first_index, const std::vector<DerivedScripts>& derived)
+{
+    return WriteIC(std::make_pair(std::make_pair(DBKeys::WALLETDESCRIPTORSPKS, desc_id), first_index), derived);
+}
+
 bool WalletBatch::WriteDescriptorCacheItems(const uint256& desc_id, const DescriptorCache& cache)
 {
     for (const auto& parent_xpub_pair : cache.GetCachedParentExtPubKeys()) {
@@ -1005,6 +1047,23 @@ static DBErrors LoadDescriptorWalletRecords(CWallet* pwallet, DatabaseBatch& bat
         });
         result = std::max(result, lh_cache_res.m_result);
 
+        // Get the scripts derived from the cache before
+        prefix = PrefixStream(DBKeys::WALLETDESCRIPTORSPKS, id);
+        LoadResult spks_res = LoadRecords(pwallet, batch, DBKeys::WALLETDESCRIPTORSPKS, prefix,
+            [&id, &spkm] (CWallet* pwallet, DataStream& key, DataStream& value, std::string& err) {
+            uint256 desc_id;
+            int32_t first_index;
+            key >> desc_id;
+            assert(desc_id == id);
+            key >> first_index;
+
+            std::vector<DerivedScripts> derived;
+            value >> derived;
+            spkm.LoadDerivedScripts(first_index, std::move(derived));
+            return DBErrors::LOAD_OK;
+        });
+        result = std::max(result, spks_res.m_result);
+
         // Set the cache for this descriptor
         auto spk_man = (DescriptorScriptPubKeyMan*)pwallet->GetScriptPubKeyMan(id);
         assert(spk_man);
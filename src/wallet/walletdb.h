@@ -6,11 +6,14 @@
 #ifndef BITCOIN_WALLET_WALLETDB_H
 #define BITCOIN_WALLET_WALLETDB_H
 
+#include <consensus/amount.h>
+#include <primitives/transaction.h>
 #include <script/sign.h>
 #include <wallet/db.h>
 #include <wallet/walletutil.h>
 #include <key.h>
 
+#include <map>
 #include <stdint.h>
 #include <string>
 #include <vector>
@@ -68,6 +71,7 @@ extern const std::string ACTIVEEXTERNALSPK;
 extern const std::string ACTIVEINTERNALSPK;
 extern const std::string BESTBLOCK;
 extern const std::string BESTBLOCK_NOMERKLE;
+extern const std::string CT_AMOUNT;
 extern const std::string CRYPTED_KEY;
 extern const std::string CSCRIPT;
 extern const std::string DEFAULTKEY;
@@ -83,6 +87,7 @@ extern const std::string NAME;
 extern const std::string OLD_KEY;
 extern const std::string ORDERPOSNEXT;
 extern const std::string POOL;
+extern const std::string PRIVACY_RESCAN;
 extern const std::string PURPOSE;
 extern const std::string SETTINGS;
 extern const std::string TX;
@@ -90,6 +95,7 @@ extern const std::string VERSION;
 extern const std::string WALLETDESCRIPTOR;
 extern const std::string WALLETDESCRIPTORCKEY;
 extern const std::string WALLETDESCRIPTORKEY;
+extern const std::string WALLETDESCRIPTORSPKS;
 extern const std::string WATCHMETA;
 extern const std::string WATCHS;
 extern const std::string TOKEN;
@@ -189,6 +195,41 @@ public:
     }
 };
 
+/** What examining a confidential output found, so it is decrypted only once.
+ * An outpoint fixes the output's contents, so an entry never goes stale;
+ * a negative entry only holds for the scan keys it was made with.
+ */
+class CConfidentialAmountEntry
+{
+public:
+    bool fMine{false};
+    CAmount nAmount{0};
+    uint256 keysetHash; //!< Scan keys a negative entry was made with
+
+    SERIALIZE_METHODS(CConfidentialAmountEntry, obj)
+    {
+        READWRITE(obj.fMine, obj.nAmount, obj.keysetHash);
+    }
+};
+
+//! Indexes of a ranged descriptor in one derived scripts record
+static constexpr size_t DERIVED_SCRIPTS_PER_RECORD{1000};
+
+/** Scripts and public keys a ranged descriptor expands to at one index.
+ * They are stored in records of DERIVED_SCRIPTS_PER_RECORD consecutive indexes,
+ * so that loading a wallet does not derive them from the cached xpubs again.
+ */
+struct DerivedScripts
+{
+    std::vector<CScript> scripts;
+    std::vector<CPubKey> pubkeys;
+
+    SERIALIZE_METHODS(DerivedScripts, obj)
+    {
+        READWRITE(obj.scripts, obj.pubkeys);
+    }
+};
+
 struct DbTxnListener
 {
     std::function<void()> on_commit, on_abort;
@@ -274,6 +315,13 @@ public:
     bool WriteBestBlock(const CBlockLocator& locator);
     bool ReadBestBlock(CBlockLocator& locator);
 
+    //! Last block scanned by CWallet::ScanForPrivacyOutputs(), to resume from
+    bool WritePrivacyRescanProgress(const CBlockLocator& locator);
+    bool ReadPrivacyRescanProgress(CBlockLocator& locator);
+
+    bool WriteConfidentialAmount(const COutPoint& outpoint, const CConfidentialAmountEntry& entry);
+    bool ReadConfidentialAmounts(std::map<COutPoint, CConfidentialAmountEntry>& entries);
+
     // Returns true if wallet stores encryption keys
     bool IsEncrypted();
 
@@ -292,6 +340,7 @@ public:
     bool WriteDescriptorParentCache(const CExtPubKey& xpub, const uint256& desc_id, uint32_t key_exp_index);
     bool WriteDescriptorLastHardenedCache(const CExtPubKey& xpub, const uint256& desc_id, uint32_t key_exp_index);
     bool WriteDescriptorCacheItems(const uint256& desc_id, const DescriptorCache& cache);
+    bool WriteDescriptorDerivedScripts(const uint256& desc_id, int32_t first_index, const std::vector<DerivedScripts>& derived);
 
     bool WriteLockedUTXO(const COutPoint& output);
     bool EraseLockedUTXO(const COutPoint& output);
@@ -352,6 +401,30 @@ private:
  */
 bool RunWithinTxn(WalletDatabase& database, std::string_view process_desc, const std::function<bool(WalletBatch&)>& func);
 
+/**
+ * Scope whose wallet writes from the calling thread, through any WalletBatch,
+ * are committed in one database transaction when it ends instead of one by
+ * one, see WalletDatabase::BeginBulkWrite(). Used for the writes of a block
+ * connected or rescanned. Does nothing where the backend does not support it
+ * or an outer scope is active.
+ */
+class WalletBulkWrite
+{
+public:
+    explicit WalletBulkWrite(WalletDatabase& database) : m_database(database), m_active(database.BeginBulkWrite()) {}
+    ~WalletBulkWrite()
+    {
+        if (m_active) m_database.EndBulkWrite();
+    }
+
+    WalletBulkWrite(const WalletBulkWrite&) = delete;
+    WalletBulkWrite& operator=(const WalletBulkWrite&) = delete;
+
+private:
+    WalletDatabase& m_database;
+    const bool m_active;
+};
+
 //! Compacts BDB state so that wallet.dat is self-contained (if there are changes)
 void MaybeCompactWalletDB(WalletContext& context);
 
@@ -0,0 +1,983 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wsrpc.h>
+
+#include <common/args.h>
+#include <common/messages.h>
+#include <compat/compat.h>
+#include <crypto/sha1.h>
+#include <httprpc.h>
+#include <httpserver.h>
+#include <kernel/mempool_entry.h>
+#include <logging.h>
+#include <netaddress.h>
+#include <netbase.h>
+#include <node/eth_filters.h>
+#include <primitives/block.h>
+#include <rpc/eth_rpc.h>
+#include <rpc/protocol.h>
+#include <rpc/request.h>
+#include <rpc/server.h>
+#include <rpc/server_util.h>
+#include <span.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/strencodings.h>
+#include <util/string.h>
+#include <util/thread.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <event2/listener.h>
+#include <event2/util.h>
+
+using common::InvalidPortErrMsg;
+using util::SplitString;
+using util::TrimString;
+
+namespace wsrpc {
+
+/** Appended to the client's key for Sec-WebSocket-Accept, RFC 6455 section 1.3 */
+static constexpr std::string_view WS_GUID{"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"};
+
+ParseResult ParseFrame(std::string_view data, size_t max_payload, Frame& frame, size_t& consumed)
+{
+    if (data.size() < 2) return ParseResult::INCOMPLETE;
+    const uint8_t b0 = static_cast<uint8_t>(data[0]);
+    const uint8_t b1 = static_cast<uint8_t>(data[1]);
+    // No extension is negotiated, so the reserved bits must be clear
+    if (b0 & 0x70) return ParseResult::ERROR;
+    if (!(b1 & 0x80)) return ParseResult::ERROR;
+
+    const bool fin = b0 & 0x80;
+    const uint8_t opcode = b0 & 0x0F;
+    switch (static_cast<Opcode>(opcode)) {
+    case Opcode::CONTINUATION:
+    case Opcode::TEXT:
+    case Opcode::BINARY:
+    case Opcode::CLOSE:
+    case Opcode::PING:
+    case Opcode::PONG:
+        break;
+    default:
+        return ParseResult::ERROR;
+    }
+
+    uint64_t length = b1 & 0x7F;
+    size_t pos = 2;
+    if (length == 126) {
+        if (data.size() < 4) return ParseResult::INCOMPLETE;
+        length = (uint64_t{static_cast<uint8_t>(data[2])} << 8) | static_cast<uint8_t>(data[3]);
+        pos = 4;
+    } else if (length == 127) {
+        if (data.size() < 10) return ParseResult::INCOMPLETE;
+        length = 0;
+        for (size_t i = 2; i < 10; ++i) {
+            length = (length << 8) | static_cast<uint8_t>(data[i]);
+        }
+        pos = 10;
+    }
+    const bool control = opcode & 0x08;
+    if (control && (!fin || length > 125)) return ParseResult::ERROR;
+    if (length > max_payload) return ParseResult::ERROR;
+    if (data.size() - pos < 4 + length) return ParseResult::INCOMPLETE;
+
+    const std::string_view mask = data.substr(pos, 4);
+    pos += 4;
+    frame.fin = fin;
+    frame.opcode = static_cast<Opcode>(opcode);
+    frame.payload.resize(length);
+    for (size_t i = 0; i < length; ++i) {
+        frame.payload[i] = data[pos + i] ^ mask[i % 4];
+    }
+    consumed = pos + length;
+    return ParseResult::FRAME;
+}
+
+std::string EncodeFrame(Opcode opcode, std::string_view payload)
+{
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame.push_back(static_cast<char>(0x80 | static_cast<uint8_t>(opcode)));
+    const uint64_t length = payload.size();
+    if (length < 126) {
+        frame.push_back(static_cast<char>(length));
+    } else if (length <= 0xFFFF) {
+        frame.push_back(126);
+        frame.push_back(static_cast<char>(length >> 8));
+        frame.push_back(static_cast<char>(length));
+    } else {
+        frame.push_back(127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame.push_back(static_cast<char>(length >> shift));
+        }
+    }
+    frame.append(payload);
+    return frame;
+}
+
+std::string AcceptKey(std::string_view key)
+{
+    unsigned char hash[CSHA1::OUTPUT_SIZE];
+    CSHA1().Write(UCharCast(key.data()), key.size()).Write(UCharCast(WS_GUID.data()), WS_GUID.size()).Finalize(hash);
+    return EncodeBase64(hash);
+}
+
+} // namespace wsrpc
+
+namespace {
+
+using wsrpc::EncodeFrame;
+using wsrpc::Frame;
+using wsrpc::Opcode;
+using wsrpc::ParseResult;
+
+/** Longest upgrade request accepted */
+static constexpr size_t MAX_HANDSHAKE_SIZE{8192};
+/** Time a client has to complete the upgrade */
+static constexpr int HANDSHAKE_TIMEOUT_SECONDS{30};
+/** Connected blocks whose logs are kept to report them removed */
+static constexpr size_t MAX_RECENT_BLOCKS{64};
+
+/** Close status codes of RFC 6455 section 7.4.1 */
+static constexpr uint16_t WS_CLOSE_PROTOCOL_ERROR{1002};
+static constexpr uint16_t WS_CLOSE_TOO_BIG{1009};
+
+enum class SubscriptionType { NEW_HEADS, LOGS, PENDING_TRANSACTIONS, COUNT };
+
+struct Subscription
+{
+    SubscriptionType type{SubscriptionType::NEW_HEADS};
+    node::EthLogFilter filter;
+    //! Set once the eth_subscribe reply went out, so no notification overtakes it
+    bool active{false};
+};
+
+class WSRPCServer;
+
+struct WSConnection : public std::enable_shared_from_this<WSConnection>
+{
+    WSConnection(WSRPCServer& server_in, uint64_t id_in, bufferevent* bev_in, std::string peer_in)
+        : server(server_in), id(id_in), bev(bev_in), peer(std::move(peer_in)) {}
+
+    WSRPCServer& server;
+    const uint64_t id;
+    bufferevent* const bev;
+    const std::string peer;
+
+    //! Only used on the I/O thread
+    bool upgraded{false};
+    bool closing{false};
+    std::string authUser;
+    bool inMessage{false};
+    std::string message;
+
+    Mutex m_mutex;
+    //! The bufferevent is freed, or about to be
+    bool closed GUARDED_BY(m_mutex){false};
+    size_t pending GUARDED_BY(m_mutex){0};
+    std::map<std::string, Subscription> subscriptions GUARDED_BY(m_mutex);
+};
+
+using WSConnectionRef = std::shared_ptr<WSConnection>;
+
+/**
+ * WebSocket transport of the RPC table.
+ *
+ * One I/O thread runs a libevent loop over the listeners and the client
+ * connections; it does the upgrade handshake and the framing, and queues
+ * each complete message for a small pool of workers that execute it like
+ * the HTTP server does. eth_subscribe and eth_unsubscribe are handled here,
+ * as they belong to the connection, and the validation signals are turned
+ * into eth_subscription notifications, each formatted once per event.
+ *
+ * A client that does not read its notifications is dropped once its queued
+ * output exceeds MAX_WS_SEND_BUFFER, so it cannot hold memory or slow the
+ * others down. A client with MAX_WS_PENDING_REQUESTS requests queued is no
+ * longer read from until the workers catch up.
+ *
+ * Lock order is a connection's m_mutex, then the libevent locks of its
+ * bufferevent; callbacks run without the latter held.
+ */
+class WSRPCServer final : public CValidationInterface
+{
+public:
+    explicit WSRPCServer(std::any context) : m_context(std::move(context)) {}
+    ~WSRPCServer();
+
+    bool Start(const std::vector<std::pair<std::string, uint16_t>>& endpoints, int threads);
+    void Interrupt();
+    void Stop();
+
+protected:
+    //! CValidationInterface
+    void BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+    void TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence) override;
+
+private:
+    struct RecentBlock
+    {
+        uint256 hash;
+        std::vector<node::EthFilterLog> logs;
+    };
+
+    static void AcceptCallback(evconnlistener* listener, evutil_socket_t fd, sockaddr* address, int socklen, void* arg);
+    static void ReadCallback(bufferevent* bev, void* arg);
+    static void WriteCallback(bufferevent* bev, void* arg);
+    static void EventCallback(bufferevent* bev, short events, void* arg);
+    static void CloseCallback(evutil_socket_t fd, short events, void* arg);
+
+    // I/O thread
+    void OnAccept(evutil_socket_t fd, const sockaddr* address, int socklen);
+    void OnRead(WSConnection& conn);
+    bool Handshake(WSConnection& conn);
+    void Reject(WSConnection& conn, const std::string& status, const std::string& headers = "");
+    void HandleFrame(WSConnection& conn, Frame frame);
+    void Fail(WSConnection& conn, uint16_t code, const std::string& reason);
+    void CloseAfterFlush(WSConnection& conn);
+    void CloseConnection(WSConnection& conn);
+    void CloseQueued();
+
+    // Any thread
+    bool Send(WSConnection& conn, const std::string& frame) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex);
+    void CloseSoon(WSConnection& conn) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex);
+    void ReleaseSubscriptions(WSConnection& conn) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex);
+
+    // Workers
+    void WorkerThread();
+    void Post(std::function<void()> task);
+    void HandleMessage(const WSConnectionRef& conn, const std::string& message);
+    std::optional<UniValue> HandleRequest(WSConnection& conn, const UniValue& request, std::vector<std::string>& subscribed);
+    UniValue Subscribe(WSConnection& conn, const JSONRPCRequest& jreq, std::vector<std::string>& subscribed);
+    UniValue Unsubscribe(WSConnection& conn, const JSONRPCRequest& jreq);
+
+    // Notifications
+    std::atomic<size_t>& Subscribers(SubscriptionType type) { return m_subscribers[static_cast<size_t>(type)]; }
+    void ForEachSubscription(SubscriptionType type, const std::function<void(WSConnection&, const std::string&, const Subscription&)>& fn);
+    void NotifyLogs(const std::vector<node::EthFilterLog>& logs);
+
+    const std::any m_context;
+
+    event_base* m_base{nullptr};
+    event* m_close_event{nullptr};
+    std::vector<evconnlistener*> m_listeners;
+    std::thread m_io_thread;
+    std::vector<std::thread> m_workers;
+
+    Mutex m_mutex;
+    std::map<uint64_t, WSConnectionRef> m_connections GUARDED_BY(m_mutex);
+    std::vector<uint64_t> m_close_queue GUARDED_BY(m_mutex);
+    uint64_t m_next_connection GUARDED_BY(m_mutex){0};
+
+    Mutex m_queue_mutex;
+    std::condition_variable m_queue_cond;
+    std::deque<std::function<void()>> m_queue GUARDED_BY(m_queue_mutex);
+    bool m_interrupted GUARDED_BY(m_queue_mutex){false};
+
+    std::atomic<uint64_t> m_next_subscription{1};
+    std::array<std::atomic<size_t>, static_cast<size_t>(SubscriptionType::COUNT)> m_subscribers{};
+
+    Mutex m_recent_mutex;
+    //! Logs of the recently connected blocks, oldest first
+    std::deque<RecentBlock> m_recent_blocks GUARDED_BY(m_recent_mutex);
+};
+
+static std::string SubscriptionNotification(const std::string& id, const std::string& result)
+{
+    return EncodeFrame(Opcode::TEXT, strprintf(R"({"jsonrpc":"2.0","method":"eth_subscription","params":{"subscription":"%s","result":%s}})", id, result));
+}
+
+WSRPCServer::~WSRPCServer()
+{
+    Stop();
+}
+
+bool WSRPCServer::Start(const std::vector<std::pair<std::string, uint16_t>>& endpoints, int threads)
+{
+    m_base = event_base_new();
+    if (!m_base) {
+        LogPrintf("Couldn't create an event_base for the WebSocket RPC server\n");
+        return false;
+    }
+    m_close_event = event_new(m_base, -1, 0, CloseCallback, this);
+
+    for (const auto& [host, port] : endpoints) {
+        LogPrintf("Binding WebSocket RPC on address %s port %i\n", host, port);
+        const std::optional<CService> service{Lookup(host, port, false)};
+        sockaddr_storage storage;
+        socklen_t len = sizeof(storage);
+        if (!service || !service->GetSockAddr(reinterpret_cast<sockaddr*>(&storage), &len)) {
+            LogPrintf("Binding WebSocket RPC on address %s port %i failed, invalid address\n", host, port);
+            continue;
+        }
+        evconnlistener* listener = evconnlistener_new_bind(m_base, AcceptCallback, this, LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE,
+                                                           -1, reinterpret_cast<sockaddr*>(&storage), len);
+        if (!listener) {
+            LogPrintf("Binding WebSocket RPC on address %s port %i failed.\n", host, port);
+            continue;
+        }
+        if (service->IsBindAny()) {
+            LogPrintf("WARNING: the WebSocket RPC server is not safe to expose to untrusted networks such as the public internet\n");
+        }
+        m_listeners.push_back(listener);
+    }
+    if (m_listeners.empty()) {
+        LogPrintf("Unable to bind any endpoint for WebSocket RPC server\n");
+        return false;
+    }
+
+    m_io_thread = std::thread(&util::TraceThread, "wsrpc", [this] { event_base_dispatch(m_base); });
+    for (int i = 0; i < threads; ++i) {
+        m_workers.emplace_back(&util::TraceThread, strprintf("wsrpc.%i", i), [this] { WorkerThread(); });
+    }
+    return true;
+}
+
+void WSRPCServer::Interrupt()
+{
+    {
+        LOCK(m_queue_mutex);
+        m_interrupted = true;
+    }
+    m_queue_cond.notify_all();
+}
+
+void WSRPCServer::Stop()
+{
+    Interrupt();
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    m_workers.clear();
+    if (m_base) event_base_loopbreak(m_base);
+    if (m_io_thread.joinable()) m_io_thread.join();
+
+    std::map<uint64_t, WSConnectionRef> connections;
+    {
+        LOCK(m_mutex);
+        connections.swap(m_connections);
+    }
+    for (const auto& [id, conn] : connections) {
+        LOCK(conn->m_mutex);
+        ReleaseSubscriptions(*conn);
+        conn->closed = true;
+        bufferevent_free(conn->bev);
+    }
+    for (evconnlistener* listener : m_listeners) {
+        evconnlistener_free(listener);
+    }
+    m_listeners.clear();
+    if (m_close_event) {
+        event_free(m_close_event);
+        m_close_event = nullptr;
+    }
+    if (m_base) {
+        event_base_free(m_base);
+        m_base = nullptr;
+    }
+}
+
+void WSRPCServer::AcceptCallback(evconnlistener* listener, evutil_socket_t fd, sockaddr* address, int socklen, void* arg)
+{
+    static_cast<WSRPCServer*>(arg)->OnAccept(fd, address, socklen);
+}
+
+void WSRPCServer::ReadCallback(bufferevent* bev, void* arg)
+{
+    WSConnection& conn = *static_cast<WSConnection*>(arg);
+    conn.server.OnRead(conn);
+}
+
+void WSRPCServer::WriteCallback(bufferevent* bev, void* arg)
+{
+    WSConnection& conn = *static_cast<WSConnection*>(arg);
+    if (conn.closing && evbuffer_get_length(bufferevent_get_output(bev)) == 0) {
+        conn.server.CloseConnection(conn);
+    }
+}
+
+void WSRPCServer::EventCallback(bufferevent* bev, short events, void* arg)
+{
+    WSConnection& conn = *static_cast<WSConnection*>(arg);
+    if (events & (BEV_EVENT_EOF | BEV_EVENT_ERROR | BEV_EVENT_TIMEOUT)) {
+        conn.server.CloseConnection(conn);
+    }
+}
+
+void WSRPCServer::CloseCallback(evutil_socket_t fd, short events, void* arg)
+{
+    static_cast<WSRPCServer*>(arg)->CloseQueued();
+}
+
+void WSRPCServer::OnAccept(evutil_socket_t fd, const sockaddr* address, int socklen)
+{
+    CService peer;
+    peer.SetSockAddr(address, socklen);
+    if (!ClientAllowed(peer)) {
+        LogDebug(BCLog::HTTP, "WebSocket RPC connection from %s not allowed\n", peer.ToStringAddrPort());
+        evutil_closesocket(fd);
+        return;
+    }
+    // Callbacks are deferred to the loop and run unlocked, see the lock order above
+    bufferevent* bev = bufferevent_socket_new(m_base, fd, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_THREADSAFE |
+                                                          BEV_OPT_DEFER_CALLBACKS | BEV_OPT_UNLOCK_CALLBACKS);
+    if (!bev) {
+        evutil_closesocket(fd);
+        return;
+    }
+
+    WSConnectionRef conn;
+    {
+        LOCK(m_mutex);
+        conn = std::make_shared<WSConnection>(*this, m_next_connection++, bev, peer.ToStringAddrPort());
+        m_connections.emplace(conn->id, conn);
+    }
+    LogDebug(BCLog::HTTP, "WebSocket RPC connection from %s\n", conn->peer);
+
+    const timeval timeout{HANDSHAKE_TIMEOUT_SECONDS, 0};
+    bufferevent_setcb(bev, ReadCallback, WriteCallback, EventCallback, conn.get());
+    bufferevent_set_timeouts(bev, &timeout, nullptr);
+    // Stop reading from the socket while a whole message is buffered and unprocessed
+    bufferevent_setwatermark(bev, EV_READ, 0, MAX_WS_MESSAGE_SIZE + 14);
+    bufferevent_enable(bev, EV_READ | EV_WRITE);
+}
+
+void WSRPCServer::OnRead(WSConnection& conn)
+{
+    if (conn.closing) return;
+    if (!conn.upgraded && !Handshake(conn)) return;
+
+    evbuffer* input = bufferevent_get_input(conn.bev);
+    while (!conn.closing) {
+        {
+            // Resumed by the worker that brings the queue below the limit
+            LOCK(conn.m_mutex);
+            if (conn.pending >= MAX_WS_PENDING_REQUESTS) return;
+        }
+        const size_t length = std::min(evbuffer_get_length(input), MAX_WS_MESSAGE_SIZE + 14);
+        if (length == 0) return;
+        const unsigned char* data = evbuffer_pullup(input, length);
+        Frame frame;
+        size_t consumed = 0;
+        const ParseResult result = wsrpc::ParseFrame({reinterpret_cast<const char*>(data), length}, MAX_WS_MESSAGE_SIZE, frame, consumed);
+        if (result == ParseResult::INCOMPLETE) return;
+        if (result == ParseResult::ERROR) {
+            Fail(conn, WS_CLOSE_PROTOCOL_ERROR, "Protocol error");
+            return;
+        }
+        evbuffer_drain(input, consumed);
+        HandleFrame(conn, std::move(frame));
+    }
+}
+
+bool WSRPCServer::Handshake(WSConnection& conn)
+{
+    evbuffer* input = bufferevent_get_input(conn.bev);
+    const evbuffer_ptr end = evbuffer_search(input, "\r\n\r\n", 4, nullptr);
+    if (end.pos < 0) {
+        if (evbuffer_get_length(input) > MAX_HANDSHAKE_SIZE) Reject(conn, "431 Request Header Fields Too Large");
+        return false;
+    }
+    std::string request(end.pos + 4, '\0');
+    evbuffer_remove(input, request.data(), request.size());
+
+    std::vector<std::string> lines = SplitString(request, '\n');
+    const std::vector<std::string> requestLine = SplitString(TrimString(lines[0]), ' ');
+    std::map<std::string, std::string> headers;
+    for (size_t i = 1; i < lines.size(); ++i) {
+        const size_t colon = lines[i].find(':');
+        if (colon == std::string::npos) continue;
+        headers[ToLower(TrimString(lines[i].substr(0, colon)))] = TrimString(lines[i].substr(colon + 1));
+    }
+
+    if (requestLine.size() != 3 || requestLine[0] != "GET" || requestLine[2] != "HTTP/1.1") {
+        Reject(conn, "400 Bad Request");
+        return false;
+    }
+    const std::string connection = ToLower(headers["connection"]);
+    if (ToLower(headers["upgrade"]) != "websocket" || connection.find("upgrade") == std::string::npos ||
+        headers["sec-websocket-key"].empty()) {
+        Reject(conn, "400 Bad Request");
+        return false;
+    }
+    if (headers["sec-websocket-version"] != "13") {
+        Reject(conn, "426 Upgrade Required", "Sec-WebSocket-Version: 13\r\n");
+        return false;
+    }
+    if (headers["authorization"].empty()) {
+        Reject(conn, "401 Unauthorized", "WWW-Authenticate: Basic realm=\"jsonrpc\"\r\n");
+        return false;
+    }
+    if (!CheckRPCAuthorization(headers["authorization"], conn.authUser)) {
+        LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", conn.peer);
+        Reject(conn, "401 Unauthorized", "WWW-Authenticate: Basic realm=\"jsonrpc\"\r\n");
+        return false;
+    }
+
+    const std::string response = strprintf("HTTP/1.1 101 Switching Protocols\r\n"
+                                           "Upgrade: websocket\r\n"
+                                           "Connection: Upgrade\r\n"
+                                           "Sec-WebSocket-Accept: %s\r\n\r\n",
+                                           wsrpc::AcceptKey(headers["sec-websocket-key"]));
+    {
+        LOCK(conn.m_mutex);
+        Send(conn, response);
+    }
+    conn.upgraded = true;
+    // Subscribers may stay silent for as long as they like
+    bufferevent_set_timeouts(conn.bev, nullptr, nullptr);
+    return true;
+}
+
+void WSRPCServer::Reject(WSConnection& conn, const std::string& status, const std::string& headers)
+{
+    {
+        LOCK(conn.m_mutex);
+        Send(conn, strprintf("HTTP/1.1 %s\r\n%sContent-Length: 0\r\nConnection: close\r\n\r\n", status, headers));
+    }
+    CloseAfterFlush(conn);
+}
+
+void WSRPCServer::HandleFrame(WSConnection& conn, Frame frame)
+{
+    switch (frame.opcode) {
+    case Opcode::PING: {
+        LOCK(conn.m_mutex);
+        Send(conn, EncodeFrame(Opcode::PONG, frame.payload));
+        return;
+    }
+    case Opcode::PONG:
+        return;
+    case Opcode::CLOSE: {
+        // Echo the status code, and close once it is out
+        {
+            LOCK(conn.m_mutex);
+            Send(conn, EncodeFrame(Opcode::CLOSE, std::string_view{frame.payload}.substr(0, 2)));
+        }
+        CloseAfterFlush(conn);
+        return;
+    }
+    case Opcode::TEXT:
+    case Opcode::BINARY:
+        if (conn.inMessage) return Fail(conn, WS_CLOSE_PROTOCOL_ERROR, "Expected a continuation frame");
+        conn.message = std::move(frame.payload);
+        break;
+    case Opcode::CONTINUATION:
+        if (!conn.inMessage) return Fail(conn, WS_CLOSE_PROTOCOL_ERROR, "Unexpected continuation frame");
+        if (conn.message.size() + frame.payload.size() > MAX_WS_MESSAGE_SIZE) return Fail(conn, WS_CLOSE_TOO_BIG, "Message too big");
+        conn.message += frame.payload;
+        break;
+    }
+    conn.inMessage = !frame.fin;
+    if (conn.inMessage) return;
+
+    {
+        LOCK(conn.m_mutex);
+        if (++conn.pending >= MAX_WS_PENDING_REQUESTS) bufferevent_disable(conn.bev, EV_READ);
+    }
+    Post([this, ref = conn.shared_from_this(), message = std::move(conn.message)] { HandleMessage(ref, message); });
+    conn.message.clear();
+}
+
+void WSRPCServer::Fail(WSConnection& conn, uint16_t code, const std::string& reason)
+{
+    LogDebug(BCLog::HTTP, "WebSocket RPC connection from %s failed: %s\n", conn.peer, reason);
+    std::string payload;
+    payload.push_back(static_cast<char>(code >> 8));
+    payload.push_back(static_cast<char>(code));
+    payload += reason;
+    {
+        LOCK(conn.m_mutex);
+        Send(conn, EncodeFrame(Opcode::CLOSE, payload));
+    }
+    CloseAfterFlush(conn);
+}
+
+void WSRPCServer::CloseAfterFlush(WSConnection& conn)
+{
+    conn.closing = true;
+    bufferevent_disable(conn.bev, EV_READ);
+    if (evbuffer_get_length(bufferevent_get_output(conn.bev)) == 0) CloseConnection(conn);
+}
+
+void WSRPCServer::CloseConnection(WSConnection& conn)
+{
+    // Keep the connection alive until the bufferevent is gone
+    WSConnectionRef ref;
+    {
+        LOCK(m_mutex);
+        auto it = m_connections.find(conn.id);
+        if (it == m_connections.end()) return;
+        ref = std::move(it->second);
+        m_connections.erase(it);
+    }
+    LogDebug(BCLog::HTTP, "WebSocket RPC connection from %s closed\n", conn.peer);
+    LOCK(conn.m_mutex);
+    ReleaseSubscriptions(conn);
+    conn.closed = true;
+    bufferevent_free(conn.bev);
+}
+
+void WSRPCServer::CloseQueued()
+{
+    std::vector<uint64_t> ids;
+    std::vector<WSConnectionRef> connections;
+    {
+        LOCK(m_mutex);
+        ids.swap(m_close_queue);
+        for (uint64_t id : ids) {
+            auto it = m_connections.find(id);
+            if (it != m_connections.end()) connections.push_back(it->second);
+        }
+    }
+    for (const WSConnectionRef& conn : connections) {
+        CloseConnection(*conn);
+    }
+}
+
+bool WSRPCServer::Send(WSConnection& conn, const std::string& frame)
+{
+    if (conn.closed) return false;
+    evbuffer* output = bufferevent_get_output(conn.bev);
+    if (evbuffer_get_length(output) + frame.size() > MAX_WS_SEND_BUFFER) {
+        LogPrintf("WebSocket RPC client %s is not reading its messages, disconnecting\n", conn.peer);
+        CloseSoon(conn);
+        return false;
+    }
+    bufferevent_write(conn.bev, frame.data(), frame.size());
+    return true;
+}
+
+void WSRPCServer::CloseSoon(WSConnection& conn)
+{
+    // Stop sending right away, the bufferevent itself is freed on the I/O thread
+    conn.closed = true;
+    {
+        LOCK(m_mutex);
+        m_close_queue.push_back(conn.id);
+    }
+    event_active(m_close_event, EV_TIMEOUT, 0);
+}
+
+void WSRPCServer::ReleaseSubscriptions(WSConnection& conn)
+{
+    for (const auto& [id, subscription] : conn.subscriptions) {
+        --Subscribers(subscription.type);
+    }
+    conn.subscriptions.clear();
+}
+
+void WSRPCServer::WorkerThread()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            WAIT_LOCK(m_queue_mutex, lock);
+            m_queue_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_queue_mutex) { return m_interrupted || !m_queue.empty(); });
+            if (m_interrupted) return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        task();
+    }
+}
+
+void WSRPCServer::Post(std::function<void()> task)
+{
+    {
+        LOCK(m_queue_mutex);
+        m_queue.push_back(std::move(task));
+    }
+    m_queue_cond.notify_one();
+}
+
+void WSRPCServer::HandleMessage(const WSConnectionRef& conn, const std::string& message)
+{
+    UniValue reply;
+    std::vector<std::string> subscribed;
+    UniValue valRequest;
+    if (!valRequest.read(message)) {
+        reply = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, "Parse error"), NullUniValue, JSONRPCVersion::V2);
+    } else if (valRequest.isArray()) {
+        UniValue responses(UniValue::VARR);
+        for (size_t i = 0; i < valRequest.size(); ++i) {
+            if (std::optional<UniValue> response = HandleRequest(*conn, valRequest[i], subscribed)) {
+                responses.push_back(std::move(*response));
+            }
+        }
+        // No response for an all-notification batch, as over HTTP
+        if (!responses.empty() || valRequest.empty()) reply = std::move(responses);
+    } else if (std::optional<UniValue> response = HandleRequest(*conn, valRequest, subscribed)) {
+        reply = std::move(*response);
+    }
+
+    LOCK(conn->m_mutex);
+    if (!reply.isNull()) Send(*conn, EncodeFrame(Opcode::TEXT, reply.write()));
+    for (const std::string& id : subscribed) {
+        auto it = conn->subscriptions.find(id);
+        if (it != conn->subscriptions.end()) it->second.active = true;
+    }
+    if (conn->pending-- == MAX_WS_PENDING_REQUESTS && !conn->closed) {
+        // Read the messages left in the input buffer, and from the socket again
+        bufferevent_enable(conn->bev, EV_READ);
+        bufferevent_trigger(conn->bev, EV_READ, BEV_TRIG_IGNORE_WATERMARKS | BEV_TRIG_DEFER_CALLBACKS);
+    }
+}
+
+std::optional<UniValue> WSRPCServer::HandleRequest(WSConnection& conn, const UniValue& request, std::vector<std::string>& subscribed)
+{
+    JSONRPCRequest jreq;
+    jreq.context = m_context;
+    jreq.URI = "/";
+    jreq.peerAddr = conn.peer;
+    jreq.authUser = conn.authUser;
+    try {
+        jreq.parse(request);
+        if (!RPCMethodAllowed(jreq.authUser, jreq.strMethod)) {
+            LogPrintf("RPC User %s not allowed to call method %s\n", jreq.authUser, jreq.strMethod);
+            throw JSONRPCError(RPC_INVALID_REQUEST, "Method not allowed");
+        }
+
+        UniValue response;
+        if (jreq.strMethod == "eth_subscribe") {
+            response = JSONRPCReplyObj(Subscribe(conn, jreq, subscribed), NullUniValue, jreq.id, jreq.m_json_version);
+        } else if (jreq.strMethod == "eth_unsubscribe") {
+            response = JSONRPCReplyObj(Unsubscribe(conn, jreq), NullUniValue, jreq.id, jreq.m_json_version);
+        } else {
+            response = JSONRPCExec(jreq, /*catch_errors=*/true);
+        }
+        if (jreq.IsNotification()) return std::nullopt;
+        return response;
+    } catch (UniValue& e) {
+        return JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
+    } catch (const std::exception& e) {
+        return JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
+    }
+}
+
+UniValue WSRPCServer::Subscribe(WSConnection& conn, const JSONRPCRequest& jreq, std::vector<std::string>& subscribed)
+{
+    std::string status;
+    if (RPCIsInWarmup(&status)) {
+        throw JSONRPCError(RPC_IN_WARMUP, status);
+    }
+    const UniValue& params = jreq.params;
+    if (!params.isArray() || params.empty() || !params[0].isStr()) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Expected the subscription name");
+    }
+
+    Subscription subscription;
+    const std::string& name = params[0].get_str();
+    if (name == "newHeads") {
+        subscription.type = SubscriptionType::NEW_HEADS;
+    } else if (name == "logs") {
+        if (!fLogEvents) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
+        }
+        subscription.type = SubscriptionType::LOGS;
+        if (params.size() > 1 && !params[1].isNull()) {
+            if (!params[1].isObject()) {
+                throw JSONRPCError(RPC_INVALID_PARAMS, "Expected a filter object");
+            }
+            subscription.filter = ParseEthLogFilter(params[1].get_obj(), EnsureAnyChainman(m_context));
+            // A subscription follows the tip, a block range does not apply
+            subscription.filter.fromBlock = -1;
+            subscription.filter.toBlock = -1;
+        }
+    } else if (name == "newPendingTransactions") {
+        subscription.type = SubscriptionType::PENDING_TRANSACTIONS;
+    } else {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Unsupported subscription type " + name);
+    }
+
+    LOCK(conn.m_mutex);
+    if (conn.closed) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Connection closed");
+    }
+    if (conn.subscriptions.size() >= MAX_WS_SUBSCRIPTIONS) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("At most %u subscriptions per connection", MAX_WS_SUBSCRIPTIONS));
+    }
+    const std::string id = strprintf("0x%x", m_next_subscription++);
+    ++Subscribers(subscription.type);
+    conn.subscriptions.emplace(id, std::move(subscription));
+    subscribed.push_back(id);
+    return id;
+}
+
+UniValue WSRPCServer::Unsubscribe(WSConnection& conn, const JSONRPCRequest& jreq)
+{
+    const UniValue& params = jreq.params;
+    if (!params.isArray() || params.empty() || !params[0].isStr()) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Expected the subscription id");
+    }
+    LOCK(conn.m_mutex);
+    auto it = conn.subscriptions.find(params[0].get_str());
+    if (it == conn.subscriptions.end()) return false;
+    --Subscribers(it->second.type);
+    conn.subscriptions.erase(it);
+    return true;
+}
+
+void WSRPCServer::ForEachSubscription(SubscriptionType type, const std::function<void(WSConnection&, const std::string&, const Subscription&)>& fn)
+{
+    std::vector<WSConnectionRef> connections;
+    {
+        LOCK(m_mutex);
+        connections.reserve(m_connections.size());
+        for (const auto& [id, conn] : m_connections) {
+            connections.push_back(conn);
+        }
+    }
+    for (const WSConnectionRef& conn : connections) {
+        LOCK(conn->m_mutex);
+        for (const auto& [id, subscription] : conn->subscriptions) {
+            if (conn->closed) break;
+            if (subscription.type == type && subscription.active) fn(*conn, id, subscription);
+        }
+    }
+}
+
+void WSRPCServer::NotifyLogs(const std::vector<node::EthFilterLog>& logs)
+{
+    if (logs.empty()) return;
+    // Format each log once, for all the subscriptions it matches
+    std::vector<std::string> formatted;
+    formatted.reserve(logs.size());
+    for (const node::EthFilterLog& log : logs) {
+        formatted.push_back(EthFilterLogToJSON(log).write());
+    }
+    ForEachSubscription(SubscriptionType::LOGS, [&](WSConnection& conn, const std::string& id, const Subscription& subscription) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex) {
+        for (size_t i = 0; i < logs.size(); ++i) {
+            if (!subscription.filter.Matches(logs[i].address, logs[i].topics, logs[i].blockNumber)) continue;
+            if (!Send(conn, SubscriptionNotification(id, formatted[i]))) break;
+        }
+    });
+}
+
+void WSRPCServer::BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    // The background chainstate of an assumeutxo snapshot is not followed
+    if (role == ChainstateRole::BACKGROUND) return;
+
+    if (Subscribers(SubscriptionType::NEW_HEADS) > 0) {
+        const std::string header = FormatEthBlockHeader(*block, pindex).write();
+        ForEachSubscription(SubscriptionType::NEW_HEADS, [&](WSConnection& conn, const std::string& id, const Subscription&) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex) {
+            Send(conn, SubscriptionNotification(id, header));
+        });
+    }
+    if (Subscribers(SubscriptionType::LOGS) > 0) {
+        std::vector<node::EthFilterLog> logs = node::ReadBlockLogs(*block, pindex);
+        NotifyLogs(logs);
+        LOCK(m_recent_mutex);
+        m_recent_blocks.push_back(RecentBlock{block->GetHash(), std::move(logs)});
+        if (m_recent_blocks.size() > MAX_RECENT_BLOCKS) m_recent_blocks.pop_front();
+    }
+}
+
+void WSRPCServer::BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    std::vector<node::EthFilterLog> logs;
+    {
+        LOCK(m_recent_mutex);
+        // Blocks are disconnected from the tip, so the block is the newest one if it is kept at all
+        if (m_recent_blocks.empty() || m_recent_blocks.back().hash != block->GetHash()) return;
+        logs = std::move(m_recent_blocks.back().logs);
+        m_recent_blocks.pop_back();
+    }
+    for (node::EthFilterLog& log : logs) {
+        log.removed = true;
+    }
+    NotifyLogs(logs);
+}
+
+void WSRPCServer::TransactionAddedToMempool(const NewMempoolTransactionInfo& tx, uint64_t mempool_sequence)
+{
+    if (Subscribers(SubscriptionType::PENDING_TRANSACTIONS) == 0) return;
+    const std::string hash = strprintf("\"0x%s\"", tx.info.m_tx->GetHash().GetHex());
+    ForEachSubscription(SubscriptionType::PENDING_TRANSACTIONS, [&](WSConnection& conn, const std::string& id, const Subscription&) EXCLUSIVE_LOCKS_REQUIRED(conn.m_mutex) {
+        Send(conn, SubscriptionNotification(id, hash));
+    });
+}
+
+static std::shared_ptr<WSRPCServer> g_wsrpc;
+static std::mutex g_wsrpcMutex;
+
+/** The endpoints to listen on, by the rules of HTTPBindAddresses */
+static bool WSBindAddresses(std::vector<std::pair<std::string, uint16_t>>& endpoints)
+{
+    const uint16_t port{static_cast<uint16_t>(gArgs.GetIntArg("-wsport", DEFAULT_WS_PORT))};
+    if (gArgs.GetArgs("-rpcallowip").empty() || gArgs.GetArgs("-wsbind").empty()) {
+        endpoints.emplace_back("::1", port);
+        endpoints.emplace_back("127.0.0.1", port);
+        if (!gArgs.GetArgs("-wsbind").empty()) {
+            LogPrintf("WARNING: option -wsbind was ignored because -rpcallowip was not specified, refusing to allow everyone to connect\n");
+        }
+        return true;
+    }
+    for (const std::string& bind : gArgs.GetArgs("-wsbind")) {
+        uint16_t bindPort{port};
+        std::string host;
+        if (!SplitHostPort(bind, bindPort, host)) {
+            LogError("%s\n", InvalidPortErrMsg("-wsbind", bind).original);
+            return false;
+        }
+        endpoints.emplace_back(host, bindPort);
+    }
+    return true;
+}
+
+} // namespace
+
+bool StartWSRPC(const std::any& context, ValidationSignals* signals)
+{
+    LogDebug(BCLog::RPC, "Starting WebSocket RPC server\n");
+    std::vector<std::pair<std::string, uint16_t>> endpoints;
+    if (!WSBindAddresses(endpoints)) return false;
+
+    auto server = std::make_shared<WSRPCServer>(context);
+    const int threads = std::max<int>(gArgs.GetIntArg("-wsthreads", DEFAULT_WS_THREADS), 1);
+    if (!server->Start(endpoints, threads)) return false;
+
+    std::lock_guard<std::mutex> lock(g_wsrpcMutex);
+    g_wsrpc = std::move(server);
+    if (signals) signals->RegisterSharedValidationInterface(g_wsrpc);
+    return true;
+}
+
+void InterruptWSRPC()
+{
+    std::lock_guard<std::mutex> lock(g_wsrpcMutex);
+    if (g_wsrpc) g_wsrpc->Interrupt();
+}
+
+void StopWSRPC(ValidationSignals* signals)
+{
+    std::shared_ptr<WSRPCServer> server;
+    {
+        std::lock_guard<std::mutex> lock(g_wsrpcMutex);
+        server.swap(g_wsrpc);
+    }
+    if (!server) return;
+    LogDebug(BCLog::RPC, "Stopping WebSocket RPC server\n");
+    // A notification still in progress finds the connections closed
+    if (signals) signals->UnregisterSharedValidationInterface(server);
+    server->Stop();
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2024-2026 The WATTx Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef WATTX_WSRPC_H
+#define WATTX_WSRPC_H
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class ValidationSignals;
+
+/** Default for -ws */
+static constexpr bool DEFAULT_WS_ENABLE{false};
+/** Default for -wsport, the port web3 tooling expects */
+static constexpr uint16_t DEFAULT_WS_PORT{8546};
+/** Default for -wsthreads */
+static constexpr int DEFAULT_WS_THREADS{4};
+/** Largest message, after reassembly of its fragments, accepted from a client */
+static constexpr size_t MAX_WS_MESSAGE_SIZE{4 * 1024 * 1024};
+/** Queued outbound bytes after which a slow client is dropped */
+static constexpr size_t MAX_WS_SEND_BUFFER{16 * 1024 * 1024};
+/** Requests of a connection waiting for a worker before reading from it pauses */
+static constexpr size_t MAX_WS_PENDING_REQUESTS{16};
+/** Subscriptions a connection may hold */
+static constexpr size_t MAX_WS_SUBSCRIPTIONS{128};
+
+namespace wsrpc {
+
+/** Frame opcodes of RFC 6455 */
+enum class Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA,
+};
+
+struct Frame {
+    bool fin{false};
+    Opcode opcode{Opcode::CONTINUATION};
+    //! Unmasked payload
+    std::string payload;
+};
+
+enum class ParseResult {
+    INCOMPLETE, //!< More data is needed
+    FRAME,      //!< A frame was parsed
+    ERROR,      //!< Protocol violation, the connection should fail
+};
+
+/**
+ * Parse the frame at the start of data, as sent by a client.
+ *
+ * Client frames must be masked and carry no extension bits. Control frames
+ * must not be fragmented or longer than 125 bytes, and no payload may be
+ * longer than max_payload.
+ *
+ * @param[out] frame the frame parsed
+ * @param[out] consumed the bytes of data making up the frame
+ */
+ParseResult ParseFrame(std::string_view data, size_t max_payload, Frame& frame, size_t& consumed);
+
+/** Encode a single, unmasked frame, as sent by the server */
+std::string EncodeFrame(Opcode opcode, std::string_view payload);
+
+/** Sec-WebSocket-Accept value answering a Sec-WebSocket-Key */
+std::string AcceptKey(std::string_view key);
+
+} // namespace wsrpc
+
+/** Start the WebSocket RPC server.
+ * It serves the RPC table, with the same credentials and -rpcwhitelist as
+ * the HTTP server, and adds eth_subscribe and eth_unsubscribe.
+ * Precondition; HTTP RPC has been started.
+ */
+bool StartWSRPC(const std::any& context, ValidationSignals* signals);
+/** Interrupt the WebSocket RPC server, no new requests are executed.
+ */
+void InterruptWSRPC();
+/** Stop the WebSocket RPC server and close all connections.
+ */
+void StopWSRPC(ValidationSignals* signals);
+
+#endif // WATTX_WSRPC_H
@@ -42,3 +42,8 @@ bool CZMQAbstractNotifier::NotifyTransactionRemoval(const CTransaction &/*transa
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyBlockContents(const CBlock &/*block*/, const CBlockIndex * /*CBlockIndex*/, bool /*connected*/)
+{
+    return true;
+}
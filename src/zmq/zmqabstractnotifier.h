@@ -5,17 +5,54 @@
 #ifndef BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 #define BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 
+#include <consensus/amount.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+class CBlock;
 class CBlockIndex;
 class CTransaction;
 class CZMQAbstractNotifier;
 
 using CZMQNotifierFactory = std::function<std::unique_ptr<CZMQAbstractNotifier>()>;
 
+//! An EVM log emitted by a transaction of a connected block
+struct CZMQContractLog {
+    uint256 txid;
+    uint32_t output_index{0};
+    uint32_t log_index{0};
+    std::array<uint8_t, 20> address{};
+    std::vector<std::array<uint8_t, 32>> topics;
+    std::vector<uint8_t> data;
+
+    SERIALIZE_METHODS(CZMQContractLog, obj) { READWRITE(obj.txid, obj.output_index, obj.log_index, obj.address, obj.topics, obj.data); }
+};
+
+//! The coinstake of a proof-of-stake block
+struct CZMQStake {
+    CScript staker;
+    CAmount reward{0};
+    uint8_t trust_tier{0};
+
+    SERIALIZE_METHODS(CZMQStake, obj) { READWRITE(obj.staker, obj.reward, obj.trust_tier); }
+};
+
+//! Block data kept outside the block itself, read by the node for the notifiers
+struct CZMQBlockDataSources {
+    std::function<std::vector<CZMQContractLog>(const CBlock&, const CBlockIndex&)> get_logs;
+    std::function<std::optional<CZMQStake>(const CBlock&, const CBlockIndex&)> get_stake;
+    std::function<std::vector<uint256>(const CBlock&, const CBlockIndex&)> get_key_images;
+};
+
 class CZMQAbstractNotifier
 {
 public:
@@ -56,6 +93,8 @@ public:
     virtual bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence);
     // Notifies of transactions added to mempool or appearing in blocks
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    // Notifies of every block connection and disconnection, with the block itself
+    virtual bool NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected);
 
 protected:
     void* psocket{nullptr};
@@ -11,6 +11,7 @@
 #include <netbase.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <util/strencodings.h>
 #include <validationinterface.h>
 #include <zmq/zmqabstractnotifier.h>
 #include <zmq/zmqpublishnotifier.h>
@@ -18,8 +19,12 @@
 
 #include <zmq.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <map>
+#include <optional>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -40,8 +45,32 @@ std::list<const CZMQAbstractNotifier*> CZMQNotificationInterface::GetActiveNotif
     return result;
 }
 
-std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std::function<bool(std::vector<uint8_t>&, const CBlockIndex&)> get_block_by_index)
+// Parse the hex encoded values of a rawlogs filter option
+template <size_t N>
+static bool ParseLogFilter(const std::string& arg, std::set<std::array<uint8_t, N>>& filter)
 {
+    for (const std::string& value : gArgs.GetArgs(arg)) {
+        const std::optional<std::vector<uint8_t>> bytes{TryParseHex<uint8_t>(value)};
+        if (!bytes || bytes->size() != N) {
+            LogPrintf("Error: invalid %s=%s, expected %u hex encoded bytes\n", arg, value, N);
+            return false;
+        }
+        std::array<uint8_t, N> entry;
+        std::copy(bytes->begin(), bytes->end(), entry.begin());
+        filter.insert(entry);
+    }
+    return true;
+}
+
+std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std::function<bool(std::vector<uint8_t>&, const CBlockIndex&)> get_block_by_index,
+                                                                             CZMQBlockDataSources block_data)
+{
+    std::set<std::array<uint8_t, 20>> log_addresses;
+    std::set<std::array<uint8_t, 32>> log_topics;
+    if (!ParseLogFilter("-zmqpubrawlogsaddress", log_addresses) || !ParseLogFilter("-zmqpubrawlogstopic", log_topics)) {
+        return nullptr;
+    }
+
     std::map<std::string, CZMQNotifierFactory> factories;
     factories["pubhashblock"] = CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>;
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
@@ -50,6 +79,15 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std
     };
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
+    factories["pubrawlogs"] = [&block_data, &log_addresses, &log_topics]() -> std::unique_ptr<CZMQAbstractNotifier> {
+        return std::make_unique<CZMQPublishRawLogsNotifier>(block_data.get_logs, log_addresses, log_topics);
+    };
+    factories["pubstake"] = [&block_data]() -> std::unique_ptr<CZMQAbstractNotifier> {
+        return std::make_unique<CZMQPublishStakeNotifier>(block_data.get_stake);
+    };
+    factories["pubkeyimage"] = [&block_data]() -> std::unique_ptr<CZMQAbstractNotifier> {
+        return std::make_unique<CZMQPublishKeyImageNotifier>(block_data.get_key_images);
+    };
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto& entry : factories)
@@ -189,8 +227,8 @@ void CZMQNotificationInterface::BlockConnected(ChainstateRole role, const std::s
     }
 
     // Next we notify BlockConnect listeners for *all* blocks
-    TryForEachAndRemoveFailed(notifiers, [pindexConnected](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyBlockConnect(pindexConnected);
+    TryForEachAndRemoveFailed(notifiers, [&pblock, pindexConnected](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockConnect(pindexConnected) && notifier->NotifyBlockContents(*pblock, pindexConnected, /*connected=*/true);
     });
 }
 
@@ -204,8 +242,8 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
     }
 
     // Next we notify BlockDisconnect listeners for *all* blocks
-    TryForEachAndRemoveFailed(notifiers, [pindexDisconnected](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyBlockDisconnect(pindexDisconnected);
+    TryForEachAndRemoveFailed(notifiers, [&pblock, pindexDisconnected](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockDisconnect(pindexDisconnected) && notifier->NotifyBlockContents(*pblock, pindexDisconnected, /*connected=*/false);
     });
 }
 
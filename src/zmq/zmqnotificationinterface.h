@@ -7,6 +7,7 @@
 
 #include <primitives/transaction.h>
 #include <validationinterface.h>
+#include <zmq/zmqabstractnotifier.h>
 
 #include <cstdint>
 #include <functional>
@@ -16,7 +17,6 @@
 
 class CBlock;
 class CBlockIndex;
-class CZMQAbstractNotifier;
 struct NewMempoolTransactionInfo;
 
 class CZMQNotificationInterface final : public CValidationInterface
@@ -26,7 +26,8 @@ public:
 
     std::list<const CZMQAbstractNotifier*> GetActiveNotifiers() const;
 
-    static std::unique_ptr<CZMQNotificationInterface> Create(std::function<bool(std::vector<uint8_t>&, const CBlockIndex&)> get_block_by_index);
+    static std::unique_ptr<CZMQNotificationInterface> Create(std::function<bool(std::vector<uint8_t>&, const CBlockIndex&)> get_block_by_index,
+                                                             CZMQBlockDataSources block_data);
 
 protected:
     bool Initialize();
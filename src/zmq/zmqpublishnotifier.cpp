@@ -23,6 +23,7 @@
 
 #include <zmq.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstddef>
@@ -45,6 +46,9 @@ static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_SEQUENCE  = "sequence";
+static const char *MSG_RAWLOGS   = "rawlogs";
+static const char *MSG_STAKE     = "stake";
+static const char *MSG_KEYIMAGE  = "keyimage";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -301,3 +305,66 @@ bool CZMQPublishSequenceNotifier::NotifyTransactionRemoval(const CTransaction &t
     LogDebug(BCLog::ZMQ, "Publish hashtx mempool removal %s to %s\n", hash.GetHex(), this->address);
     return SendSequenceMsg(*this, hash, /* Mempool (R)emoval */ 'R', mempool_sequence);
 }
+
+// Block contents topics start with the block they belong to, so that subscribers can undo what
+// a disconnected block told them:
+//    <32-byte block hash> | <4-byte LE height> | <1-byte label> | <payload>
+// The label is 'C' for a connected and 'D' for a disconnected block. Like rawblock, everything
+// is in serialization order.
+static DataStream BlockContentsHeader(const CBlockIndex& index, bool connected)
+{
+    DataStream ss;
+    ss << index.GetBlockHash() << static_cast<uint32_t>(index.nHeight) << static_cast<uint8_t>(connected ? 'C' : 'D');
+    return ss;
+}
+
+bool CZMQPublishRawLogsNotifier::Matches(const CZMQContractLog& log) const
+{
+    if (!m_addresses.empty() && !m_addresses.count(log.address)) return false;
+    return m_topics.empty() || std::any_of(log.topics.begin(), log.topics.end(), [this](const auto& topic) { return m_topics.count(topic) > 0; });
+}
+
+bool CZMQPublishRawLogsNotifier::NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected)
+{
+    // Every block is published, a disconnect without payload retracts the logs of its connect
+    DataStream ss{BlockContentsHeader(*pindex, connected)};
+    if (connected) {
+        std::vector<CZMQContractLog> logs{m_get_logs(block, *pindex)};
+        logs.erase(std::remove_if(logs.begin(), logs.end(), [this](const CZMQContractLog& log) { return !Matches(log); }), logs.end());
+        ss << logs;
+        LogDebug(BCLog::ZMQ, "Publish rawlogs %s (%u logs) to %s\n", pindex->GetBlockHash().GetHex(), logs.size(), this->address);
+    } else {
+        LogDebug(BCLog::ZMQ, "Publish rawlogs disconnect %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
+    }
+    return SendZmqMessage(MSG_RAWLOGS, ss.data(), ss.size());
+}
+
+bool CZMQPublishStakeNotifier::NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected)
+{
+    if (!block.IsProofOfStake()) return true;
+
+    // Payload: <staker script> | <8-byte LE reward> | <1-byte trust tier>, on connect only
+    DataStream ss{BlockContentsHeader(*pindex, connected)};
+    if (connected) {
+        const std::optional<CZMQStake> stake{m_get_stake(block, *pindex)};
+        if (!stake) {
+            zmqError("Can't read the stake of the block");
+            return false;
+        }
+        ss << *stake;
+    }
+    LogDebug(BCLog::ZMQ, "Publish stake %s %s to %s\n", connected ? "connect" : "disconnect", pindex->GetBlockHash().GetHex(), this->address);
+    return SendZmqMessage(MSG_STAKE, ss.data(), ss.size());
+}
+
+bool CZMQPublishKeyImageNotifier::NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected)
+{
+    // Key images become spent on connect and unspent again on disconnect
+    const std::vector<uint256> key_images{m_get_key_images(block, *pindex)};
+    if (key_images.empty()) return true;
+
+    DataStream ss{BlockContentsHeader(*pindex, connected)};
+    ss << key_images;
+    LogDebug(BCLog::ZMQ, "Publish keyimage %s %s (%u key images) to %s\n", connected ? "spent" : "unspent", pindex->GetBlockHash().GetHex(), key_images.size(), this->address);
+    return SendZmqMessage(MSG_KEYIMAGE, ss.data(), ss.size());
+}
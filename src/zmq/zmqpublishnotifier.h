@@ -7,11 +7,15 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <optional>
+#include <set>
 #include <vector>
 
+class CBlock;
 class CBlockIndex;
 class CTransaction;
 
@@ -72,4 +76,43 @@ public:
     bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence) override;
 };
 
+class CZMQPublishRawLogsNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    const std::function<std::vector<CZMQContractLog>(const CBlock&, const CBlockIndex&)> m_get_logs;
+    //! Publish only logs of these contracts, and with one of these topics; empty matches all
+    const std::set<std::array<uint8_t, 20>> m_addresses;
+    const std::set<std::array<uint8_t, 32>> m_topics;
+
+    bool Matches(const CZMQContractLog& log) const;
+
+public:
+    CZMQPublishRawLogsNotifier(std::function<std::vector<CZMQContractLog>(const CBlock&, const CBlockIndex&)> get_logs,
+                               std::set<std::array<uint8_t, 20>> addresses, std::set<std::array<uint8_t, 32>> topics)
+        : m_get_logs{std::move(get_logs)}, m_addresses{std::move(addresses)}, m_topics{std::move(topics)} {}
+    bool NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected) override;
+};
+
+class CZMQPublishStakeNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    const std::function<std::optional<CZMQStake>(const CBlock&, const CBlockIndex&)> m_get_stake;
+
+public:
+    CZMQPublishStakeNotifier(std::function<std::optional<CZMQStake>(const CBlock&, const CBlockIndex&)> get_stake)
+        : m_get_stake{std::move(get_stake)} {}
+    bool NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected) override;
+};
+
+class CZMQPublishKeyImageNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    const std::function<std::vector<uint256>(const CBlock&, const CBlockIndex&)> m_get_key_images;
+
+public:
+    CZMQPublishKeyImageNotifier(std::function<std::vector<uint256>(const CBlock&, const CBlockIndex&)> get_key_images)
+        : m_get_key_images{std::move(get_key_images)} {}
+    bool NotifyBlockContents(const CBlock &block, const CBlockIndex *pindex, bool connected) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H